@@ -24,6 +24,7 @@
 
 #include "storage/cwrapper/hdfs-file-system-c.h"
 #include "cdb/cdbfilesystemcredential.h"
+#include "cdb/cdbmetadatacache.h"
 #include "cdb/cdbvars.h"
 #include "postgres.h"
 
@@ -38,6 +39,66 @@ Datum hdfsprotocol_validate(PG_FUNCTION_ARGS);
 
 static char * getIpBySocket(const char * socket);
 #define EXPECTED_MAX_HDFS_CONNECTIONS 10
+
+/*
+ * File system instance kept between calls of hdfsprotocol_blocklocation, so
+ * that planning a query does not connect to the name node for every hdfs
+ * table again. It is taken out while in use, an error raised meanwhile
+ * simply leaks it.
+ */
+static FscHdfsFileSystemC *cached_fs = NULL;
+static char *cached_fs_host = NULL;
+static int cached_fs_port = 0;
+
+static FscHdfsFileSystemC *
+get_file_system(const char *host, int port)
+{
+	FscHdfsFileSystemC *fs = NULL;
+
+	if (cached_fs != NULL)
+	{
+		if (strcmp(cached_fs_host, host) == 0 && cached_fs_port == port)
+		{
+			fs = cached_fs;
+		}
+		else
+		{
+			FscHdfsFreeFileSystemC(&cached_fs);
+		}
+		cached_fs = NULL;
+	}
+
+	if (fs == NULL)
+	{
+		fs = FscHdfsNewFileSystem(host, port);
+	}
+	return fs;
+}
+
+static void
+release_file_system(FscHdfsFileSystemC *fs, const char *host, int port)
+{
+	/* the kerberos ticket is refreshed per call, don't keep instance then */
+	if (enable_secure_filesystem)
+	{
+		FscHdfsFreeFileSystemC(&fs);
+		return;
+	}
+
+	if (cached_fs_host != NULL)
+	{
+		free(cached_fs_host);
+	}
+	cached_fs_host = strdup(host);
+	if (cached_fs_host == NULL)
+	{
+		FscHdfsFreeFileSystemC(&fs);
+		return;
+	}
+	cached_fs_port = port;
+	cached_fs = fs;
+}
+
 Datum hdfsprotocol_blocklocation(PG_FUNCTION_ARGS)
 {
 	/* Build the result instance */
@@ -83,13 +144,15 @@ Datum hdfsprotocol_blocklocation(PG_FUNCTION_ARGS)
 	}
 
 	/* Create file system instance */
-	FscHdfsFileSystemC *fs = FscHdfsNewFileSystem(uri->hostname, uri->port);
+	FscHdfsFileSystemC *fs = get_file_system(uri->hostname, uri->port);
 	if (fs == NULL)
 	{
 		elog(ERROR, "hdfsprotocol_blocklocation : "
 		"failed to create HDFS instance to connect to %s:%d",
 		uri->hostname, uri->port);
 	}
+	char *fs_host = pstrdup(uri->hostname);
+	int fs_port = uri->port;
 
 	/* Clean up uri instance as we don't need it any longer */
 	FreeExternalTableUri(uri);
@@ -160,6 +223,24 @@ Datum hdfsprotocol_blocklocation(PG_FUNCTION_ARGS)
 				continue;
 			}
 
+			/* Reuse the block locations fetched for this file before */
+			int cached_block_num = 0;
+			BlockLocation *cached_locations =
+					GetExtFileBlockLocations(fullpath, len, &cached_block_num);
+			if (cached_locations != NULL)
+			{
+				blocklocation_file *blf = palloc0(sizeof(blocklocation_file));
+				blf->file_uri = fullpath;
+				blf->block_num = cached_block_num;
+				blf->locations = cached_locations;
+
+				elog(DEBUG3, "hdfsprotocol_blocklocation : "
+				"file %s has %d cached blocks", fullpath, blf->block_num);
+
+				bldata->files = lappend(bldata->files, (void *) (blf));
+				continue;
+			}
+
 			/* Get block location data for this file */
 			FscHdfsFileBlockLocationArrayC *bla =
 					FscHdfsGetPathFileBlockLocation(fs, fullpath, 0, len);
@@ -217,6 +298,9 @@ Datum hdfsprotocol_blocklocation(PG_FUNCTION_ARGS)
 
 			bldata->files = lappend(bldata->files, (void *) (blf));
 
+			PutExtFileBlockLocations(blf->file_uri, len, blf->locations,
+					blf->block_num);
+
 			/* Clean up block location instances created by the lib. */
 			FscHdfsFreeFileBlockLocationArrayC(&bla);
 		}
@@ -228,8 +312,9 @@ Datum hdfsprotocol_blocklocation(PG_FUNCTION_ARGS)
 		FscHdfsFreeFileInfoArrayC(&fiarray);
 	}
 
-	/* destroy fs instance */
-	FscHdfsFreeFileSystemC(&fs);
+	/* keep fs instance for the next call */
+	release_file_system(fs, fs_host, fs_port);
+	pfree(fs_host);
 	PG_RETURN_VOID() ;
 }
 
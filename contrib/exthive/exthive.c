@@ -20,6 +20,7 @@
 #include "c.h"
 #include "cdb/cdbdatalocality.h"
 #include "cdb/cdbfilesystemcredential.h"
+#include "cdb/cdbmetadatacache.h"
 #include "cdb/cdbvars.h"
 #include "common.h"
 #include "postgres.h"
@@ -38,6 +39,54 @@ PG_MODULE_MAGIC;
 Datum hiveprotocol_validate(PG_FUNCTION_ARGS);
 Datum hiveprotocol_blocklocation(PG_FUNCTION_ARGS);
 
+/*
+ * File system instance kept between calls of hiveprotocol_blocklocation, so
+ * that planning a query does not connect to the name node for every hive
+ * table again. It is taken out while in use, an error raised meanwhile
+ * simply leaks it.
+ */
+static FscHdfsFileSystemC *cached_fs = NULL;
+static char *cached_fs_host = NULL;
+static int cached_fs_port = 0;
+
+static FscHdfsFileSystemC *get_file_system(const char *host, int port) {
+  FscHdfsFileSystemC *fs = NULL;
+
+  if (cached_fs != NULL) {
+    if (strcmp(cached_fs_host, host) == 0 && cached_fs_port == port) {
+      fs = cached_fs;
+    } else {
+      FscHdfsFreeFileSystemC(&cached_fs);
+    }
+    cached_fs = NULL;
+  }
+
+  if (fs == NULL) {
+    fs = FscHdfsNewFileSystem(host, port);
+  }
+  return fs;
+}
+
+static void release_file_system(FscHdfsFileSystemC *fs, const char *host,
+                                int port) {
+  /* the credentials of the instance may expire, don't keep it then */
+  if (enable_secure_filesystem) {
+    FscHdfsFreeFileSystemC(&fs);
+    return;
+  }
+
+  if (cached_fs_host != NULL) {
+    free(cached_fs_host);
+  }
+  cached_fs_host = strdup(host);
+  if (cached_fs_host == NULL) {
+    FscHdfsFreeFileSystemC(&fs);
+    return;
+  }
+  cached_fs_port = port;
+  cached_fs = fs;
+}
+
 Datum hiveprotocol_blocklocation(PG_FUNCTION_ARGS) {
   /* Build the result instance */
   ExtProtocolBlockLocationData *bldata =
@@ -67,13 +116,15 @@ Datum hiveprotocol_blocklocation(PG_FUNCTION_ARGS) {
        uri->hostname, uri->port);
 
   /* Create file system instance */
-  FscHdfsFileSystemC *fs = FscHdfsNewFileSystem(uri->hostname, uri->port);
+  FscHdfsFileSystemC *fs = get_file_system(uri->hostname, uri->port);
   if (fs == NULL) {
     elog(ERROR,
          "hiveprotocol_blocklocation : "
          "failed to create HIVE instance to connect to %s:%d",
          uri->hostname, uri->port);
   }
+  char *fs_host = pstrdup(uri->hostname);
+  int fs_port = uri->port;
 
   /* Clean up uri instance as we don't need it any longer */
   FreeExternalTableUri(uri);
@@ -143,6 +194,23 @@ Datum hiveprotocol_blocklocation(PG_FUNCTION_ARGS) {
         continue;
       }
 
+      /* Reuse the block locations fetched for this file before */
+      int cached_block_num = 0;
+      BlockLocation *cached_locations =
+          GetExtFileBlockLocations(fullpath, len, &cached_block_num);
+      if (cached_locations != NULL) {
+        blocklocation_file *blf = palloc0(sizeof(blocklocation_file));
+        blf->file_uri = fullpath;
+        blf->block_num = cached_block_num;
+        blf->locations = cached_locations;
+
+        elog(DEBUG3, "hiveprotocol_blocklocation : file %s has %d cached blocks",
+             fullpath, blf->block_num);
+
+        bldata->files = lappend(bldata->files, (void *)(blf));
+        continue;
+      }
+
       /* Get block location data for this file */
       FscHdfsFileBlockLocationArrayC *bla =
           FscHdfsGetPathFileBlockLocation(fs, fullpath, 0, len);
@@ -196,6 +264,9 @@ Datum hiveprotocol_blocklocation(PG_FUNCTION_ARGS) {
 
       bldata->files = lappend(bldata->files, (void *)(blf));
 
+      PutExtFileBlockLocations(blf->file_uri, len, blf->locations,
+                               blf->block_num);
+
       /* Clean up block location instances created by the lib. */
       FscHdfsFreeFileBlockLocationArrayC(&bla);
     }
@@ -207,8 +278,9 @@ Datum hiveprotocol_blocklocation(PG_FUNCTION_ARGS) {
     FscHdfsFreeFileInfoArrayC(&fiarray);
   }
 
-  /* destroy fs instance */
-  FscHdfsFreeFileSystemC(&fs);
+  /* keep fs instance for the next call */
+  release_file_system(fs, fs_host, fs_port);
+  pfree(fs_host);
   PG_RETURN_VOID();
 }
 
@@ -180,7 +180,8 @@ typedef struct MagmaFormatUserData {
   char *schemaname;
   char *tablename;
   bool isMagmatp;
-  int *colIndexes;
+  int *colIndexes;  /* the columns to read, for converting their values */
+  int32_t numberOfColumnsToRead;
   bool *colIsNulls;
 
   char **colNames;
@@ -277,6 +278,7 @@ static void magma_clear(PlugStorage ps, bool clearSlot) {
         pfree(user_data->colRawValues);
         pfree(user_data->colValues);
         pfree(user_data->colToReads);
+        if (user_data->colIndexes) pfree(user_data->colIndexes);
         pfree(user_data->colValLength);
         for (int i = 0; i < user_data->numberOfColumns; ++i)
           pfree(user_data->colNames[i]);
@@ -1415,8 +1417,10 @@ Datum magma_getnext(PG_FUNCTION_ARGS) {
       old_context = MemoryContextSwitchTo(fsd->fs_pstate->rowcontext);
     }
 
-    for (int32_t i = 0; i < user_data->numberOfColumns; ++i) {
-      // Column not to read or column is null
+    // Only the columns read can have values, the others are left null
+    for (int32_t j = 0; j < user_data->numberOfColumnsToRead; ++j) {
+      int32_t i = user_data->colIndexes[j];
+
       if (nulls[i]) continue;
 
       switch (fsd->attr[i]->atttypid) {
@@ -1731,6 +1735,7 @@ Datum magma_stopscan(PG_FUNCTION_ARGS) {
     pfree(user_data->colRawValues);
     pfree(user_data->colValues);
     pfree(user_data->colToReads);
+    if (user_data->colIndexes) pfree(user_data->colIndexes);
     pfree(user_data->colValLength);
     for (int i = 0; i < user_data->numberOfColumns; ++i)
       pfree(user_data->colNames[i]);
@@ -3556,6 +3561,17 @@ static void build_magma_tuple_descrition_for_read(
 //      if (i == user_data->numberOfColumns) user_data->colToReads[0] = true;
 //    }
   }
+
+  /*
+   * magma_getnext() converts the values of these columns only, a scan often
+   * reads a few columns of a wide table.
+   */
+  user_data->colIndexes = palloc(sizeof(int) * Max(user_data->numberOfColumns, 1));
+  user_data->numberOfColumnsToRead = 0;
+  for (int i = 0; i < user_data->numberOfColumns; ++i) {
+    if (user_data->colToReads[i])
+      user_data->colIndexes[user_data->numberOfColumnsToRead++] = i;
+  }
 }
 
 static void magma_scan_error_callback(void *arg) {
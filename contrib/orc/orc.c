@@ -25,6 +25,7 @@
 #include "funcapi.h"
 #include "nodes/pg_list.h"
 #include "utils/hawq_type_mapping.h"
+#include "utils/datum.h"
 #include "utils/memutils.h"
 #include "utils/relcache.h"
 #include "utils/uri.h"
@@ -72,6 +73,7 @@ PG_FUNCTION_INFO_V1(orc_validate_datatypes);
 PG_FUNCTION_INFO_V1(orc_beginscan);
 PG_FUNCTION_INFO_V1(orc_getnext_init);
 PG_FUNCTION_INFO_V1(orc_getnext);
+PG_FUNCTION_INFO_V1(orc_getnext_batch);
 PG_FUNCTION_INFO_V1(orc_rescan);
 PG_FUNCTION_INFO_V1(orc_endscan);
 PG_FUNCTION_INFO_V1(orc_stopscan);
@@ -89,6 +91,7 @@ Datum orc_validate_datatypes(PG_FUNCTION_ARGS);
 Datum orc_beginscan(PG_FUNCTION_ARGS);
 Datum orc_getnext_init(PG_FUNCTION_ARGS);
 Datum orc_getnext(PG_FUNCTION_ARGS);
+Datum orc_getnext_batch(PG_FUNCTION_ARGS);
 Datum orc_rescan(PG_FUNCTION_ARGS);
 Datum orc_endscan(PG_FUNCTION_ARGS);
 Datum orc_stopscan(PG_FUNCTION_ARGS);
@@ -696,85 +699,81 @@ Datum orc_getnext_init(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(ext_select_desc);
 }
 
-Datum orc_getnext(PG_FUNCTION_ARGS) {
-  PlugStorage ps = (PlugStorage)(fcinfo->context);
-  FileScanDesc fsd = ps->ps_file_scan_desc;
-  ORCFormatUserData *user_data = (ORCFormatUserData *)(fsd->fs_ps_user_data);
-  TupleTableSlot *slot = ps->ps_tuple_table_slot;
-  bool *nulls = slot_get_isnull(slot);
-  memset(nulls, true, user_data->numberOfColumns);
-
-  bool res = ORCFormatNextORCFormatC(user_data->fmt, user_data->colRawValues,
-                                     user_data->colValLength, nulls);
-  if (res) {
-    for (int32_t i = 0; i < user_data->numberOfColumns; ++i) {
-      // Column not to read or column is null
-      if (nulls[i]) continue;
-
-      switch (fsd->attr[i]->atttypid) {
-        case HAWQ_TYPE_BOOL: {
-          user_data->colValues[i] =
-              BoolGetDatum(*(bool *)(user_data->colRawValues[i]));
-          break;
-        }
-        case HAWQ_TYPE_INT2: {
-          user_data->colValues[i] =
-              Int16GetDatum(*(int16_t *)(user_data->colRawValues[i]));
-          break;
-        }
-        case HAWQ_TYPE_INT4: {
-          user_data->colValues[i] =
-              Int32GetDatum(*(int32_t *)(user_data->colRawValues[i]));
-          break;
-        }
-        case HAWQ_TYPE_INT8:
-        case HAWQ_TYPE_TIME:
-        case HAWQ_TYPE_TIMESTAMP:
-        case HAWQ_TYPE_TIMESTAMPTZ: {
-          user_data->colValues[i] =
-              Int64GetDatum(*(int64_t *)(user_data->colRawValues[i]));
-          break;
-        }
-        case HAWQ_TYPE_FLOAT4: {
-          user_data->colValues[i] =
-              Float4GetDatum(*(float *)(user_data->colRawValues[i]));
-          break;
-        }
-        case HAWQ_TYPE_FLOAT8: {
-          user_data->colValues[i] =
-              Float8GetDatum(*(double *)(user_data->colRawValues[i]));
-          break;
-        }
-        case HAWQ_TYPE_VARCHAR:
-        case HAWQ_TYPE_TEXT:
-        case HAWQ_TYPE_BPCHAR:
-        case HAWQ_TYPE_BYTE:
-        case HAWQ_TYPE_NUMERIC: {
-          SET_VARSIZE((struct varlena *)(user_data->colRawValues[i]),
-                      user_data->colValLength[i]);
-          user_data->colValues[i] = PointerGetDatum(user_data->colRawValues[i]);
-          break;
-        }
-        case HAWQ_TYPE_DATE: {
-          user_data->colValues[i] =
-              Int32GetDatum(*(int32_t *)(user_data->colRawValues[i]) -
-                            POSTGRES_EPOCH_JDATE + UNIX_EPOCH_JDATE);
-          break;
-        }
-        default: {
-          ereport(ERROR, (errmsg_internal("ORC:%d", fsd->attr[i]->atttypid)));
+/*
+ * Convert the raw values of the row just read into the datums of
+ * user_data->colValues.
+ */
+static void orc_convert_values(FileScanDesc fsd, ORCFormatUserData *user_data,
+                               bool *nulls) {
+  for (int32_t i = 0; i < user_data->numberOfColumns; ++i) {
+    // Column not to read or column is null
+    if (nulls[i]) continue;
+
+    switch (fsd->attr[i]->atttypid) {
+      case HAWQ_TYPE_BOOL: {
+        user_data->colValues[i] =
+            BoolGetDatum(*(bool *)(user_data->colRawValues[i]));
+        break;
+      }
+      case HAWQ_TYPE_INT2: {
+        user_data->colValues[i] =
+            Int16GetDatum(*(int16_t *)(user_data->colRawValues[i]));
+        break;
+      }
+      case HAWQ_TYPE_INT4: {
+        user_data->colValues[i] =
+            Int32GetDatum(*(int32_t *)(user_data->colRawValues[i]));
+        break;
+      }
+      case HAWQ_TYPE_INT8:
+      case HAWQ_TYPE_TIME:
+      case HAWQ_TYPE_TIMESTAMP:
+      case HAWQ_TYPE_TIMESTAMPTZ: {
+        user_data->colValues[i] =
+            Int64GetDatum(*(int64_t *)(user_data->colRawValues[i]));
+        break;
+      }
+      case HAWQ_TYPE_FLOAT4: {
+        user_data->colValues[i] =
+            Float4GetDatum(*(float *)(user_data->colRawValues[i]));
+        break;
+      }
+      case HAWQ_TYPE_FLOAT8: {
+        user_data->colValues[i] =
+            Float8GetDatum(*(double *)(user_data->colRawValues[i]));
+        break;
+      }
+      case HAWQ_TYPE_VARCHAR:
+      case HAWQ_TYPE_TEXT:
+      case HAWQ_TYPE_BPCHAR:
+      case HAWQ_TYPE_BYTE:
+      case HAWQ_TYPE_NUMERIC: {
+        SET_VARSIZE((struct varlena *)(user_data->colRawValues[i]),
+                    user_data->colValLength[i]);
+        user_data->colValues[i] = PointerGetDatum(user_data->colRawValues[i]);
+        break;
+      }
+      case HAWQ_TYPE_DATE: {
+        user_data->colValues[i] =
+            Int32GetDatum(*(int32_t *)(user_data->colRawValues[i]) -
+                          POSTGRES_EPOCH_JDATE + UNIX_EPOCH_JDATE);
+        break;
+      }
+      default: {
+        ereport(ERROR, (errmsg_internal("ORC:%d", fsd->attr[i]->atttypid)));
 
-          break;
-        }
+        break;
       }
     }
-
-    ps->ps_has_tuple = true;
-    slot->PRIVATE_tts_values = user_data->colValues;
-    TupSetVirtualTupleNValid(slot, user_data->numberOfColumns);
-    PG_RETURN_BOOL(true);
   }
+}
 
+/*
+ * Called once the formatter read no more row: ends the scan of the
+ * formatter and frees user_data, or reports the error of the formatter.
+ */
+static void orc_finish_reading(FileScanDesc fsd,
+                               ORCFormatUserData *user_data) {
   ORCFormatCatchedError *e = ORCFormatGetErrorORCFormatC(user_data->fmt);
   if (e->errCode == ERRCODE_SUCCESSFUL_COMPLETION) {
     ORCFormatEndORCFormatC(user_data->fmt);
@@ -805,16 +804,95 @@ Datum orc_getnext(PG_FUNCTION_ARGS) {
     pfree(user_data->colDatatypes);
     pfree(user_data);
     fsd->fs_ps_user_data = NULL;
-
-    ps->ps_has_tuple = false;
-    slot->PRIVATE_tts_values = NULL;
-    ExecClearTuple(slot);
   } else {
     ereport(ERROR, (errcode(e->errCode), errmsg("%s", e->errMessage)));
   }
+}
+
+Datum orc_getnext(PG_FUNCTION_ARGS) {
+  PlugStorage ps = (PlugStorage)(fcinfo->context);
+  FileScanDesc fsd = ps->ps_file_scan_desc;
+  ORCFormatUserData *user_data = (ORCFormatUserData *)(fsd->fs_ps_user_data);
+  TupleTableSlot *slot = ps->ps_tuple_table_slot;
+  bool *nulls = slot_get_isnull(slot);
+  memset(nulls, true, user_data->numberOfColumns);
+
+  bool res = ORCFormatNextORCFormatC(user_data->fmt, user_data->colRawValues,
+                                     user_data->colValLength, nulls);
+  if (res) {
+    orc_convert_values(fsd, user_data, nulls);
+
+    ps->ps_has_tuple = true;
+    slot->PRIVATE_tts_values = user_data->colValues;
+    TupSetVirtualTupleNValid(slot, user_data->numberOfColumns);
+    PG_RETURN_BOOL(true);
+  }
+
+  orc_finish_reading(fsd, user_data);
+
+  ps->ps_has_tuple = false;
+  slot->PRIVATE_tts_values = NULL;
+  ExecClearTuple(slot);
   PG_RETURN_BOOL(false);
 }
 
+/*
+ * int
+ * orc_getnext_batch(FileScanDesc scan, int maxRows,
+ *                   Datum **values, bool **nulls)
+ *
+ * Reads up to maxRows rows into the column vectors, only the columns of
+ * ps_batch_proj are filled. The pass-by-reference values are copied into
+ * the row context of the scan, they live until the next batch is read.
+ */
+Datum orc_getnext_batch(PG_FUNCTION_ARGS) {
+  PlugStorage ps = (PlugStorage)(fcinfo->context);
+  FileScanDesc fsd = ps->ps_file_scan_desc;
+  ORCFormatUserData *user_data = (ORCFormatUserData *)(fsd->fs_ps_user_data);
+  MemoryContext batch_context = fsd->fs_pstate->rowcontext;
+  MemoryContext old_context;
+  bool *nulls;
+  int nrows = 0;
+
+  ps->ps_batch_num_rows = 0;
+  if (user_data == NULL) PG_RETURN_INT32(0);
+
+  MemoryContextReset(batch_context);
+  old_context = MemoryContextSwitchTo(batch_context);
+  nulls = palloc(sizeof(bool) * user_data->numberOfColumns);
+
+  while (nrows < ps->ps_batch_max_rows) {
+    memset(nulls, true, user_data->numberOfColumns);
+
+    if (!ORCFormatNextORCFormatC(user_data->fmt, user_data->colRawValues,
+                                 user_data->colValLength, nulls)) {
+      orc_finish_reading(fsd, user_data);
+      break;
+    }
+
+    orc_convert_values(fsd, user_data, nulls);
+
+    for (int32_t i = 0; i < user_data->numberOfColumns; ++i) {
+      if (!ps->ps_batch_proj[i]) continue;
+
+      ps->ps_batch_nulls[i][nrows] = nulls[i];
+      if (nulls[i])
+        ps->ps_batch_values[i][nrows] = (Datum)0;
+      else if (fsd->attr[i]->attbyval)
+        ps->ps_batch_values[i][nrows] = user_data->colValues[i];
+      else
+        ps->ps_batch_values[i][nrows] =
+            datumCopy(user_data->colValues[i], false, fsd->attr[i]->attlen);
+    }
+    nrows++;
+  }
+
+  MemoryContextSwitchTo(old_context);
+
+  ps->ps_batch_num_rows = nrows;
+  PG_RETURN_INT32(nrows);
+}
+
 /*
  * void
  * orc_rescan(FileScanDesc scan)
@@ -1600,6 +1678,8 @@ static FmgrInfo *get_orc_function(char *formatter_name, char *function_name)
 
 static void get_scan_functions(FileScanDesc file_scan_desc)
 {
+	Oid batchProcOid;
+
 	file_scan_desc->fs_ps_scan_funcs.beginscan = get_orc_function("orc",
 			"beginscan");
 
@@ -1609,6 +1689,16 @@ static void get_scan_functions(FileScanDesc file_scan_desc)
 	file_scan_desc->fs_ps_scan_funcs.getnext = get_orc_function("orc",
 			"getnext");
 
+	/* optional, not registered in the catalogs of older installs */
+	file_scan_desc->fs_ps_scan_funcs.getnext_batch = NULL;
+	batchProcOid = LookupPlugStorageValidatorFunc("orc", "getnext_batch");
+	if (OidIsValid(batchProcOid))
+	{
+		file_scan_desc->fs_ps_scan_funcs.getnext_batch =
+				(FmgrInfo *) palloc(sizeof(FmgrInfo));
+		fmgr_info(batchProcOid, file_scan_desc->fs_ps_scan_funcs.getnext_batch);
+	}
+
 	file_scan_desc->fs_ps_scan_funcs.rescan = get_orc_function("orc", "rescan");
 
 	file_scan_desc->fs_ps_scan_funcs.endscan = get_orc_function("orc",
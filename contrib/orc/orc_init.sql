@@ -34,6 +34,10 @@ CREATE OR REPLACE FUNCTION pg_catalog.orc_getnext() RETURNS bytea
 AS '$libdir/orc.so', 'orc_getnext'
 LANGUAGE C STABLE;
 
+CREATE OR REPLACE FUNCTION pg_catalog.orc_getnext_batch() RETURNS int4
+AS '$libdir/orc.so', 'orc_getnext_batch'
+LANGUAGE C STABLE;
+
 CREATE OR REPLACE FUNCTION pg_catalog.orc_rescan() RETURNS void
 AS '$libdir/orc.so', 'orc_rescan'
 LANGUAGE C STABLE;
@@ -12,6 +12,7 @@ DROP FUNCTION IF EXISTS pg_catalog.orc_validate_datatypes();
 DROP FUNCTION IF EXISTS pg_catalog.orc_beginscan();
 DROP FUNCTION IF EXISTS pg_catalog.orc_getnext_init();
 DROP FUNCTION IF EXISTS pg_catalog.orc_getnext();
+DROP FUNCTION IF EXISTS pg_catalog.orc_getnext_batch();
 DROP FUNCTION IF EXISTS pg_catalog.orc_rescan();
 DROP FUNCTION IF EXISTS pg_catalog.orc_endscan();
 DROP FUNCTION IF EXISTS pg_catalog.orc_stopscan();
@@ -91,6 +92,11 @@ CREATE FUNCTION pg_catalog.orc_insert_finish() RETURNS void
 AS '$libdir/orc.so', 'orc_insert_finish'
 LANGUAGE C STABLE;
 
+set gen_new_oid_value to 10928;
+CREATE FUNCTION pg_catalog.orc_getnext_batch() RETURNS int4
+AS '$libdir/orc.so', 'orc_getnext_batch'
+LANGUAGE C STABLE;
+
 set gen_new_oid_value to 10906;
 CREATE FUNCTION pg_catalog.hdfs_validate() RETURNS void
 AS '$libdir/exthdfs.so', 'hdfsprotocol_validate'
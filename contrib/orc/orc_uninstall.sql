@@ -22,6 +22,8 @@ DROP FUNCTION IF EXISTS pg_catalog.orc_getnext_init();
 
 DROP FUNCTION IF EXISTS pg_catalog.orc_getnext();
 
+DROP FUNCTION IF EXISTS pg_catalog.orc_getnext_batch();
+
 DROP FUNCTION IF EXISTS pg_catalog.orc_rescan();
 
 DROP FUNCTION IF EXISTS pg_catalog.orc_endscan();
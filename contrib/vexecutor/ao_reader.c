@@ -19,6 +19,10 @@
 #include "ao_reader.h"
 #include "tuplebatch.h"
 #include "utils/datum.h"
+#include "utils/memutils.h"
+
+/* the initial size of the buffer of a pass-by-reference column */
+#define AOVARBUF_INITSIZE  (64 * 1024)
 
 extern  MemTuple
 appendonlygettup(AppendOnlyScanDesc scan,
@@ -37,12 +41,48 @@ BeginVScanAppendOnlyRelation(ScanState *scanState)
     vs->ao->proj = palloc0(sizeof(bool) * tb->ncols);
     GetNeededColumnsForScan((Node* )scanState->ps.plan->targetlist,vs->ao->proj,tb->ncols);
     GetNeededColumnsForScan((Node* )scanState->ps.plan->qual,vs->ao->proj,tb->ncols);
+
+    vs->ao->varbufs = palloc0(sizeof(aovarbuf) * tb->ncols);
+    for(int i = 0;i < tb->ncols;i ++)
+    {
+        if(!vs->ao->proj[i] || (vs->late && vs->lateproj[i]) ||
+           scanState->ss_ScanTupleSlot->tts_tupleDescriptor->attrs[i]->attbyval)
+            continue;
+
+        vs->ao->varbufs[i].cap = AOVARBUF_INITSIZE;
+        vs->ao->varbufs[i].data = palloc(AOVARBUF_INITSIZE);
+        vs->ao->varbufs[i].offsets = palloc(sizeof(Size) * tb->batchsize);
+    }
+
+    if(vs->late)
+    {
+        vs->ao->tuples = palloc0(sizeof(MemTuple) * tb->batchsize);
+        vs->ao->tuplecxt = AllocSetContextCreate(CurrentMemoryContext,
+                                                 "VScanAOTuples",
+                                                 ALLOCSET_DEFAULT_MINSIZE,
+                                                 ALLOCSET_DEFAULT_INITSIZE,
+                                                 ALLOCSET_DEFAULT_MAXSIZE);
+    }
 }
 
 void
 EndVScanAppendOnlyRelation(ScanState *scanState)
 {
     VectorizedState* vs = (VectorizedState*)scanState->ps.vectorized;
+    if(vs->ao->tuples)
+    {
+        pfree(vs->ao->tuples);
+        MemoryContextDelete(vs->ao->tuplecxt);
+    }
+    for(int i = 0;i < scanState->ss_ScanTupleSlot->tts_tupleDescriptor->natts;i ++)
+    {
+        if(vs->ao->varbufs[i].data)
+        {
+            pfree(vs->ao->varbufs[i].data);
+            pfree(vs->ao->varbufs[i].offsets);
+        }
+    }
+    pfree(vs->ao->varbufs);
     pfree(vs->ao->proj);
     pfree(vs->ao);
     EndScanAppendOnlyRelation(scanState);
@@ -81,6 +121,28 @@ AOScanNext(ScanState *scanState)
     return slot;
 }
 
+/*
+ * Copy a pass-by-reference value out of the ao table buffer, which may be
+ * freed before the batch is done. The buffer is reused by every batch, the
+ * values are pointed to after the batch is read since it may be moved when
+ * it grows.
+ */
+static void
+AOVarbufAppend(aovarbuf *buf, int row, Datum value, int16 attlen)
+{
+    Size size = datumGetSize(value, false, attlen);
+
+    if(buf->len + MAXALIGN(size) > buf->cap)
+    {
+        while(buf->len + MAXALIGN(size) > buf->cap)
+            buf->cap *= 2;
+        buf->data = repalloc(buf->data, buf->cap);
+    }
+
+    memcpy(buf->data + buf->len, DatumGetPointer(value), size);
+    buf->offsets[row] = buf->len;
+    buf->len += MAXALIGN(size);
+}
 
 TupleTableSlot *
 AppendOnlyVScanNext(ScanState *scanState)
@@ -95,16 +157,35 @@ AppendOnlyVScanNext(ScanState *scanState)
         return slot;
     }
 
-    for(tb->nrows = 0;tb->nrows < tb->batchsize;tb->nrows ++)
+    if(vs->late)
+        MemoryContextReset(vs->ao->tuplecxt);
+
+    for(int i = 0;i < tb->ncols ; i ++)
+        vs->ao->varbufs[i].len = 0;
+
+    for(tb->nrows = 0;tb->nrows < vs->batchrows;tb->nrows ++)
     {
         slot = AOScanNext(scanState);
 
         if(TupIsNull(slot))
             break;
 
+        /*
+         * keep the raw tuple for AppendOnlyVScanLateMaterialize, copying it is
+         * much cheaper than deforming and copying the late columns
+         */
+        if(vs->late)
+        {
+            MemTuple tup = TupGetMemTuple(slot);
+            uint32 len = memtuple_get_size(tup, slot->tts_mt_bind);
+
+            vs->ao->tuples[tb->nrows] = MemoryContextAlloc(vs->ao->tuplecxt, len);
+            memcpy(vs->ao->tuples[tb->nrows], tup, len);
+        }
+
         for(int i = 0;i < tb->ncols ; i ++)
         {
-           if(vs->ao->proj[i])
+           if(vs->ao->proj[i] && !(vs->late && vs->lateproj[i]))
             {
                 Oid hawqTypeID = slot->tts_tupleDescriptor->attrs[i]->atttypid;
                 Oid hawqVTypeID = GetVtype(hawqTypeID);
@@ -114,10 +195,11 @@ AppendOnlyVScanNext(ScanState *scanState)
                 tb->datagroup[i]->values[tb->nrows] = slot_getattr(slot,i + 1, &(tb->datagroup[i]->isnull[tb->nrows]));
 
                 /* if attribute is a reference, deep copy the data out to prevent ao table buffer free before vectorized scan batch done */
-                if(!slot->tts_mt_bind->tupdesc->attrs[i]->attbyval)
-                    tb->datagroup[i]->values[tb->nrows]= datumCopy(tb->datagroup[i]->values[tb->nrows],
-                                                                   slot->tts_mt_bind->tupdesc->attrs[i]->attbyval,
-                                                                   slot->tts_mt_bind->tupdesc->attrs[i]->attlen);
+                if(!slot->tts_mt_bind->tupdesc->attrs[i]->attbyval &&
+                   !tb->datagroup[i]->isnull[tb->nrows])
+                    AOVarbufAppend(&vs->ao->varbufs[i], tb->nrows,
+                                   tb->datagroup[i]->values[tb->nrows],
+                                   slot->tts_mt_bind->tupdesc->attrs[i]->attlen);
 
             }
         }
@@ -128,10 +210,19 @@ AppendOnlyVScanNext(ScanState *scanState)
 
     for(int i = 0;i < tb->ncols ; i ++)
     {
-        if(vs->ao->proj[i])
+        if(vs->ao->proj[i] && !(vs->late && vs->lateproj[i]))
         {
             if(tb->datagroup[i])
                 tb->datagroup[i]->dim = tb->nrows;
+
+            if(tb->datagroup[i] && vs->ao->varbufs[i].data)
+            {
+                aovarbuf *buf = &vs->ao->varbufs[i];
+
+                for(int j = 0;j < tb->nrows;j ++)
+                    if(!tb->datagroup[i]->isnull[j])
+                        tb->datagroup[i]->values[j] = PointerGetDatum(buf->data + buf->offsets[j]);
+            }
         }
     }
 
@@ -142,3 +233,41 @@ AppendOnlyVScanNext(ScanState *scanState)
     return slot;
 }
 
+/*
+ * Deform the columns left out by AppendOnlyVScanNext from the saved tuples of
+ * the rows which passed the qual. Pass-by-reference values point into the
+ * saved tuples, which live until the next batch is read.
+ */
+void
+AppendOnlyVScanLateMaterialize(ScanState *scanState)
+{
+    TupleTableSlot *slot = scanState->ss_ScanTupleSlot;
+    TupleBatch tb = (TupleBatch)slot->PRIVATE_tb;
+    VectorizedState* vs = scanState->ps.vectorized;
+
+    Assert(vs->late);
+
+    for(int i = 0;i < tb->ncols ; i ++)
+    {
+        if(!vs->lateproj[i])
+            continue;
+
+        if(!tb->datagroup[i])
+        {
+            Oid hawqTypeID = slot->tts_tupleDescriptor->attrs[i]->atttypid;
+            tbCreateColumn(tb,i,GetVtype(hawqTypeID));
+        }
+
+        vtype *vt = tb->datagroup[i];
+        vt->dim = tb->nrows;
+
+        for(int j = 0;j < tb->nrows;j ++)
+        {
+            if(tb->skip[j])
+                vt->isnull[j] = true;
+            else
+                vt->values[j] = memtuple_getattr(vs->ao->tuples[j], slot->tts_mt_bind,
+                                                 i + 1, &vt->isnull[j]);
+        }
+    }
+}
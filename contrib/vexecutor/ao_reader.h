@@ -31,6 +31,8 @@ void
 BeginVScanAppendOnlyRelation(ScanState *scanState);
 TupleTableSlot *AppendOnlyVScanNext(ScanState *node);
 void
+AppendOnlyVScanLateMaterialize(ScanState *node);
+void
 EndVScanAppendOnlyRelation(ScanState *scanState);
 
 #endif
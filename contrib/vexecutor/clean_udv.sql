@@ -47,3 +47,8 @@ drop type vfloat8 cascade;
 drop type vfloat4 cascade;
 drop type vbool cascade;
 drop type vdateadt cascade;
+drop type vtimestamp cascade;
+drop type vtext cascade;
+drop type vvarchar cascade;
+drop type vbpchar cascade;
+drop type vnumeric cascade;
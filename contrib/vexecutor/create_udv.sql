@@ -48,6 +48,11 @@ drop type vfloat8 cascade;
 drop type vfloat4 cascade;
 drop type vbool cascade;
 drop type vdateadt cascade;
+drop type vtimestamp cascade;
+drop type vtext cascade;
+drop type vvarchar cascade;
+drop type vbpchar cascade;
+drop type vnumeric cascade;
 
 
 
@@ -92,6 +97,31 @@ CREATE FUNCTION vdateadtin(cstring) RETURNS vdateadt as 'vexecutor.so' LANGUAGE
 CREATE FUNCTION vdateadtout(vdateadt) RETURNS cstring AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
 CREATE TYPE vdateadt ( INPUT = vdateadtin, OUTPUT = vdateadtout, element = date , storage=external);
 
+CREATE TYPE vtimestamp;
+CREATE FUNCTION vtimestampin(cstring) RETURNS vtimestamp AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE FUNCTION vtimestampout(vtimestamp) RETURNS cstring AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE TYPE vtimestamp ( INPUT = vtimestampin, OUTPUT = vtimestampout, element = timestamp , storage=external);
+
+CREATE TYPE vtext;
+CREATE FUNCTION vtextin(cstring) RETURNS vtext AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE FUNCTION vtextout(vtext) RETURNS cstring AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE TYPE vtext ( INPUT = vtextin, OUTPUT = vtextout, element = text , storage=external);
+
+CREATE TYPE vvarchar;
+CREATE FUNCTION vvarcharin(cstring) RETURNS vvarchar AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE FUNCTION vvarcharout(vvarchar) RETURNS cstring AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE TYPE vvarchar ( INPUT = vvarcharin, OUTPUT = vvarcharout, element = varchar , storage=external);
+
+CREATE TYPE vbpchar;
+CREATE FUNCTION vbpcharin(cstring) RETURNS vbpchar AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE FUNCTION vbpcharout(vbpchar) RETURNS cstring AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE TYPE vbpchar ( INPUT = vbpcharin, OUTPUT = vbpcharout, element = bpchar , storage=external);
+
+CREATE TYPE vnumeric;
+CREATE FUNCTION vnumericin(cstring) RETURNS vnumeric AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE FUNCTION vnumericout(vnumeric) RETURNS cstring AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE TYPE vnumeric ( INPUT = vnumericin, OUTPUT = vnumericout, element = numeric , storage=external);
+
 -- create operators for the vectorized types
 
 CREATE FUNCTION vint2vint2gt(vint2, vint2) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
@@ -1048,6 +1078,123 @@ CREATE FUNCTION vdateadt_mii_int4(vdateadt, int4) RETURNS vdateadt AS 'vexecutor
 CREATE OPERATOR - ( leftarg = vdateadt, rightarg = int4, procedure = vdateadt_mii_int4, commutator = - );
 
 
+CREATE FUNCTION timestamp(vdateadt) RETURNS vtimestamp AS 'vexecutor.so', 'vdateadt_timestamp' LANGUAGE C IMMUTABLE STRICT;
+CREATE FUNCTION date_part(text, vdateadt) RETURNS vfloat8 AS 'vexecutor.so', 'vdateadt_part' LANGUAGE C IMMUTABLE STRICT;
+
+CREATE FUNCTION vtimestamp_eq(vtimestamp, vtimestamp) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR = ( leftarg = vtimestamp, rightarg = vtimestamp, procedure = vtimestamp_eq, commutator = = );
+CREATE FUNCTION vtimestamp_ne(vtimestamp, vtimestamp) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR <> ( leftarg = vtimestamp, rightarg = vtimestamp, procedure = vtimestamp_ne, commutator = <> );
+CREATE FUNCTION vtimestamp_lt(vtimestamp, vtimestamp) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR < ( leftarg = vtimestamp, rightarg = vtimestamp, procedure = vtimestamp_lt, commutator = < );
+CREATE FUNCTION vtimestamp_le(vtimestamp, vtimestamp) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR <= ( leftarg = vtimestamp, rightarg = vtimestamp, procedure = vtimestamp_le, commutator = <= );
+CREATE FUNCTION vtimestamp_gt(vtimestamp, vtimestamp) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR > ( leftarg = vtimestamp, rightarg = vtimestamp, procedure = vtimestamp_gt, commutator = > );
+CREATE FUNCTION vtimestamp_ge(vtimestamp, vtimestamp) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR >= ( leftarg = vtimestamp, rightarg = vtimestamp, procedure = vtimestamp_ge, commutator = >= );
+
+CREATE FUNCTION vtimestamp_eq_timestamp(vtimestamp, timestamp) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR = ( leftarg = vtimestamp, rightarg = timestamp, procedure = vtimestamp_eq_timestamp, commutator = = );
+CREATE FUNCTION vtimestamp_ne_timestamp(vtimestamp, timestamp) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR <> ( leftarg = vtimestamp, rightarg = timestamp, procedure = vtimestamp_ne_timestamp, commutator = <> );
+CREATE FUNCTION vtimestamp_lt_timestamp(vtimestamp, timestamp) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR < ( leftarg = vtimestamp, rightarg = timestamp, procedure = vtimestamp_lt_timestamp, commutator = < );
+CREATE FUNCTION vtimestamp_le_timestamp(vtimestamp, timestamp) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR <= ( leftarg = vtimestamp, rightarg = timestamp, procedure = vtimestamp_le_timestamp, commutator = <= );
+CREATE FUNCTION vtimestamp_gt_timestamp(vtimestamp, timestamp) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR > ( leftarg = vtimestamp, rightarg = timestamp, procedure = vtimestamp_gt_timestamp, commutator = > );
+CREATE FUNCTION vtimestamp_ge_timestamp(vtimestamp, timestamp) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR >= ( leftarg = vtimestamp, rightarg = timestamp, procedure = vtimestamp_ge_timestamp, commutator = >= );
+CREATE FUNCTION date_part(text, vtimestamp) RETURNS vfloat8 AS 'vexecutor.so', 'vtimestamp_part' LANGUAGE C IMMUTABLE STRICT;
+
+CREATE FUNCTION vtext_eq(vtext, vtext) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR = ( leftarg = vtext, rightarg = vtext, procedure = vtext_eq, commutator = = );
+CREATE FUNCTION vtext_ne(vtext, vtext) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR <> ( leftarg = vtext, rightarg = vtext, procedure = vtext_ne, commutator = <> );
+CREATE FUNCTION vtext_lt(vtext, vtext) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR < ( leftarg = vtext, rightarg = vtext, procedure = vtext_lt, commutator = < );
+CREATE FUNCTION vtext_le(vtext, vtext) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR <= ( leftarg = vtext, rightarg = vtext, procedure = vtext_le, commutator = <= );
+CREATE FUNCTION vtext_gt(vtext, vtext) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR > ( leftarg = vtext, rightarg = vtext, procedure = vtext_gt, commutator = > );
+CREATE FUNCTION vtext_ge(vtext, vtext) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR >= ( leftarg = vtext, rightarg = vtext, procedure = vtext_ge, commutator = >= );
+
+CREATE FUNCTION vtext_eq_text(vtext, text) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR = ( leftarg = vtext, rightarg = text, procedure = vtext_eq_text, commutator = = );
+CREATE FUNCTION vtext_ne_text(vtext, text) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR <> ( leftarg = vtext, rightarg = text, procedure = vtext_ne_text, commutator = <> );
+CREATE FUNCTION vtext_lt_text(vtext, text) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR < ( leftarg = vtext, rightarg = text, procedure = vtext_lt_text, commutator = < );
+CREATE FUNCTION vtext_le_text(vtext, text) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR <= ( leftarg = vtext, rightarg = text, procedure = vtext_le_text, commutator = <= );
+CREATE FUNCTION vtext_gt_text(vtext, text) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR > ( leftarg = vtext, rightarg = text, procedure = vtext_gt_text, commutator = > );
+CREATE FUNCTION vtext_ge_text(vtext, text) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR >= ( leftarg = vtext, rightarg = text, procedure = vtext_ge_text, commutator = >= );
+CREATE FUNCTION vtext_like_text(vtext, text) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR ~~ ( leftarg = vtext, rightarg = text, procedure = vtext_like_text );
+CREATE FUNCTION vtext_nlike_text(vtext, text) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR !~~ ( leftarg = vtext, rightarg = text, procedure = vtext_nlike_text );
+
+CREATE FUNCTION vbpchar_eq(vbpchar, vbpchar) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR = ( leftarg = vbpchar, rightarg = vbpchar, procedure = vbpchar_eq, commutator = = );
+CREATE FUNCTION vbpchar_ne(vbpchar, vbpchar) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR <> ( leftarg = vbpchar, rightarg = vbpchar, procedure = vbpchar_ne, commutator = <> );
+CREATE FUNCTION vbpchar_lt(vbpchar, vbpchar) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR < ( leftarg = vbpchar, rightarg = vbpchar, procedure = vbpchar_lt, commutator = < );
+CREATE FUNCTION vbpchar_le(vbpchar, vbpchar) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR <= ( leftarg = vbpchar, rightarg = vbpchar, procedure = vbpchar_le, commutator = <= );
+CREATE FUNCTION vbpchar_gt(vbpchar, vbpchar) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR > ( leftarg = vbpchar, rightarg = vbpchar, procedure = vbpchar_gt, commutator = > );
+CREATE FUNCTION vbpchar_ge(vbpchar, vbpchar) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR >= ( leftarg = vbpchar, rightarg = vbpchar, procedure = vbpchar_ge, commutator = >= );
+
+CREATE FUNCTION vbpchar_eq_bpchar(vbpchar, bpchar) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR = ( leftarg = vbpchar, rightarg = bpchar, procedure = vbpchar_eq_bpchar, commutator = = );
+CREATE FUNCTION vbpchar_ne_bpchar(vbpchar, bpchar) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR <> ( leftarg = vbpchar, rightarg = bpchar, procedure = vbpchar_ne_bpchar, commutator = <> );
+CREATE FUNCTION vbpchar_lt_bpchar(vbpchar, bpchar) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR < ( leftarg = vbpchar, rightarg = bpchar, procedure = vbpchar_lt_bpchar, commutator = < );
+CREATE FUNCTION vbpchar_le_bpchar(vbpchar, bpchar) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR <= ( leftarg = vbpchar, rightarg = bpchar, procedure = vbpchar_le_bpchar, commutator = <= );
+CREATE FUNCTION vbpchar_gt_bpchar(vbpchar, bpchar) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR > ( leftarg = vbpchar, rightarg = bpchar, procedure = vbpchar_gt_bpchar, commutator = > );
+CREATE FUNCTION vbpchar_ge_bpchar(vbpchar, bpchar) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR >= ( leftarg = vbpchar, rightarg = bpchar, procedure = vbpchar_ge_bpchar, commutator = >= );
+CREATE FUNCTION vbpchar_like_text(vbpchar, text) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR ~~ ( leftarg = vbpchar, rightarg = text, procedure = vbpchar_like_text );
+CREATE FUNCTION vbpchar_nlike_text(vbpchar, text) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR !~~ ( leftarg = vbpchar, rightarg = text, procedure = vbpchar_nlike_text );
+
+CREATE FUNCTION vnumeric_eq(vnumeric, vnumeric) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR = ( leftarg = vnumeric, rightarg = vnumeric, procedure = vnumeric_eq, commutator = = );
+CREATE FUNCTION vnumeric_ne(vnumeric, vnumeric) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR <> ( leftarg = vnumeric, rightarg = vnumeric, procedure = vnumeric_ne, commutator = <> );
+CREATE FUNCTION vnumeric_lt(vnumeric, vnumeric) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR < ( leftarg = vnumeric, rightarg = vnumeric, procedure = vnumeric_lt, commutator = < );
+CREATE FUNCTION vnumeric_le(vnumeric, vnumeric) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR <= ( leftarg = vnumeric, rightarg = vnumeric, procedure = vnumeric_le, commutator = <= );
+CREATE FUNCTION vnumeric_gt(vnumeric, vnumeric) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR > ( leftarg = vnumeric, rightarg = vnumeric, procedure = vnumeric_gt, commutator = > );
+CREATE FUNCTION vnumeric_ge(vnumeric, vnumeric) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR >= ( leftarg = vnumeric, rightarg = vnumeric, procedure = vnumeric_ge, commutator = >= );
+
+CREATE FUNCTION vnumeric_eq_numeric(vnumeric, numeric) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR = ( leftarg = vnumeric, rightarg = numeric, procedure = vnumeric_eq_numeric, commutator = = );
+CREATE FUNCTION vnumeric_ne_numeric(vnumeric, numeric) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR <> ( leftarg = vnumeric, rightarg = numeric, procedure = vnumeric_ne_numeric, commutator = <> );
+CREATE FUNCTION vnumeric_lt_numeric(vnumeric, numeric) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR < ( leftarg = vnumeric, rightarg = numeric, procedure = vnumeric_lt_numeric, commutator = < );
+CREATE FUNCTION vnumeric_le_numeric(vnumeric, numeric) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR <= ( leftarg = vnumeric, rightarg = numeric, procedure = vnumeric_le_numeric, commutator = <= );
+CREATE FUNCTION vnumeric_gt_numeric(vnumeric, numeric) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR > ( leftarg = vnumeric, rightarg = numeric, procedure = vnumeric_gt_numeric, commutator = > );
+CREATE FUNCTION vnumeric_ge_numeric(vnumeric, numeric) RETURNS vbool AS 'vexecutor.so' LANGUAGE C IMMUTABLE STRICT;
+CREATE OPERATOR >= ( leftarg = vnumeric, rightarg = numeric, procedure = vnumeric_ge_numeric, commutator = >= );
+
+
 --create sum aggregate functions
 
 CREATE FUNCTION vint2_accum(int8, vint2) returns int8 as 'vexecutor.so' language c immutable;
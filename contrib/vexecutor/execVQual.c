@@ -19,6 +19,7 @@
 #include "postgres.h"
 #include "utils/builtins.h"
 #include "execVQual.h"
+#include "vkernel.h"
 #include "cdb/cdbhash.h"
 static bool
 ExecVTargetList(List *targetlist,
@@ -327,7 +328,6 @@ VExecEvalNot(BoolExprState *notclause, ExprContext *econtext,
 	ExprState  *clause = linitial(notclause->args);
 	Datum		expr_value;
 	vbool		*ret;
-	int			i;
 
 	if (isDone)
 		*isDone = ExprSingleResult;
@@ -335,11 +335,7 @@ VExecEvalNot(BoolExprState *notclause, ExprContext *econtext,
 	expr_value = ExecEvalExpr(clause, econtext, isNull, NULL);
 
 	ret = (vbool*)DatumGetPointer(expr_value);
-	for(i = 0; i < ret->dim; i++)
-	{
-		if(!ret->isnull[i])
-			ret->values[i] = !ret->values[i];
-	}
+	vk_bool_not(ret->values, ret->dim);
 
 	/*
 	 * evaluation of 'not' is simple.. expr is false, then return 'true' and
@@ -410,14 +406,8 @@ VExecEvalOr(BoolExprState *orExpr, ExprContext *econtext,
 		{
 			next = DatumGetPointer(clause_value);
 			Assert(NULL != res->isnull && NULL != next->isnull);
-			for(i = 0; i < res->dim; i++)
-			{
-				res->isnull[i] =
-						(res->isnull[i] || next->isnull[i]);
-				res->values[i] = (res->values[i] || next->values[i]);
-				if(skip && (res->isnull[i] || !res->values[i]))
-					skip = false;
-			}
+			skip = vkernel->bool_or(res->values, res->isnull,
+									next->values, next->isnull, res->dim);
 		}
 
 		if(skip)
@@ -483,14 +473,8 @@ VExecEvalAndInternal(List* clauses, ExprContext *econtext,
 		{
 			next = DatumGetPointer(clause_value);
 			Assert(NULL != res->isnull && NULL != next->isnull);
-			for(i = 0; i < res->dim; i++)
-			{
-				res->isnull[i] =
-						(res->isnull[i] || next->isnull[i]);
-				res->values[i] = (res->values[i] && next->values[i]);
-				if(skip && (res->isnull[i] || res->values[i]))
-					skip = false;
-			}
+			skip = vkernel->bool_and(res->values, res->isnull,
+									 next->values, next->isnull, res->dim);
 		}
 
 		if(skip)
@@ -0,0 +1,698 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * execVQualCompile.c
+ *		Compile the qual of a vectorized scan into fused selection kernels.
+ *
+ * The kernels are instantiated by the macros below for every combination
+ * of value class, operator and operand shape, and picked once when the qual
+ * is compiled. A comparison reads the Datum arrays of the batch columns and
+ * writes the row numbers passing it back into the selection vector; AND
+ * runs its children on the narrowing selection, OR on the rows its earlier
+ * children did not pass. Arithmetic is computed for the selected rows only,
+ * into a buffer owned by its operand.
+ *
+ * The kernels keep the semantics of the vtype operator functions: values
+ * are compared in the C promoted type, integer arithmetic wraps in the
+ * type of its vectorized operand, and a constant operand of arithmetic is
+ * cast to that type first.
+ */
+
+#include "postgres.h"
+
+#include "catalog/pg_type.h"
+#include "nodes/execnodes.h"
+#include "nodes/primnodes.h"
+#include "utils/lsyscache.h"
+#include "execVQualCompile.h"
+#include "vcheck.h"
+
+/* sign-extend the low 64 - s bits of a Datum */
+#define VQ_GETI(d, s)	((int64) ((uint64) (d) << (s)) >> (s))
+
+/* integer arithmetic wraps as the per-element code does */
+#define VQ_IPL(x, y)	((int64) ((uint64) (x) + (uint64) (y)))
+#define VQ_IMI(x, y)	((int64) ((uint64) (x) - (uint64) (y)))
+#define VQ_IMUL(x, y)	((int64) ((uint64) (x) * (uint64) (y)))
+#define VQ_IDIV(x, y)	vq_int_div((x), (y), res->isnull[row])
+
+#define VQ_FPL(x, y)	((x) + (y))
+#define VQ_FMI(x, y)	((x) - (y))
+#define VQ_FMUL(x, y)	((x) * (y))
+#define VQ_FDIV(x, y)	((x) / (y))
+
+static inline int64
+vq_int_div(int64 x, int64 y, bool isnull)
+{
+	if (y == 0)
+	{
+		/* the value of a null row is meaningless */
+		if (isnull)
+			return 0;
+		ereport(ERROR,
+				(errcode(ERRCODE_DIVISION_BY_ZERO),
+				 errmsg("division by zero")));
+	}
+
+	/* the only quotient which does not fit, wrap it as well */
+	if (y == -1)
+		return VQ_IMI(0, x);
+
+	return x / y;
+}
+
+/*
+ * Comparison kernels, one for a column on the right and one for a constant.
+ * The loops are free of branches: every row is written back and the output
+ * position only advances if it passed.
+ */
+#define VQ_CMP_KERNEL(cls, T, GETL, GETR, GETC, opname, OP) \
+static int \
+vq_cmp_##cls##_##opname(const VQArgs *a, int *sel, int n) \
+{ \
+	int			i; \
+	int			m = 0; \
+	for (i = 0; i < n; i++) \
+	{ \
+		int			row = sel[i]; \
+		T			x = GETL; \
+		T			y = GETR; \
+		sel[m] = row; \
+		m += !(a->lnull[row] | a->rnull[row]) & ((x OP y) != a->negate); \
+	} \
+	return m; \
+} \
+static int \
+vq_cmp_##cls##_##opname##_const(const VQArgs *a, int *sel, int n) \
+{ \
+	int			i; \
+	int			m = 0; \
+	T			y = GETC; \
+	for (i = 0; i < n; i++) \
+	{ \
+		int			row = sel[i]; \
+		T			x = GETL; \
+		sel[m] = row; \
+		m += !a->lnull[row] & ((x OP y) != a->negate); \
+	} \
+	return m; \
+}
+
+#define VQ_CMP_CLASS(cls, T, GETL, GETR, GETC) \
+	VQ_CMP_KERNEL(cls, T, GETL, GETR, GETC, eq, ==) \
+	VQ_CMP_KERNEL(cls, T, GETL, GETR, GETC, ne, !=) \
+	VQ_CMP_KERNEL(cls, T, GETL, GETR, GETC, gt, >) \
+	VQ_CMP_KERNEL(cls, T, GETL, GETR, GETC, ge, >=) \
+	VQ_CMP_KERNEL(cls, T, GETL, GETR, GETC, lt, <) \
+	VQ_CMP_KERNEL(cls, T, GETL, GETR, GETC, le, <=)
+
+VQ_CMP_CLASS(int, int64, VQ_GETI(a->l[row], a->lshift),
+			 VQ_GETI(a->r[row], a->rshift), DatumGetInt64(a->rc))
+VQ_CMP_CLASS(float4, float4, DatumGetFloat4(a->l[row]),
+			 DatumGetFloat4(a->r[row]), DatumGetFloat4(a->rc))
+VQ_CMP_CLASS(float8, float8, DatumGetFloat8(a->l[row]),
+			 DatumGetFloat8(a->r[row]), DatumGetFloat8(a->rc))
+
+#define VQ_CMP_ENTRY(cls, opname) \
+	{vq_cmp_##cls##_##opname, vq_cmp_##cls##_##opname##_const}
+
+#define VQ_CMP_ENTRIES(cls) \
+	{ \
+		VQ_CMP_ENTRY(cls, eq), VQ_CMP_ENTRY(cls, ne), \
+		VQ_CMP_ENTRY(cls, gt), VQ_CMP_ENTRY(cls, ge), \
+		VQ_CMP_ENTRY(cls, lt), VQ_CMP_ENTRY(cls, le) \
+	}
+
+/* by VQClass, by VKernelOp from VK_EQ to VK_LE, by constant right operand */
+static const VQCmpFunc vq_cmp_funcs[3][6][2] = {
+	VQ_CMP_ENTRIES(int),
+	VQ_CMP_ENTRIES(float4),
+	VQ_CMP_ENTRIES(float8)
+};
+
+/*
+ * Arithmetic kernels. The result of an integer operation is brought back
+ * to the width of the operand type, shift, of the result.
+ */
+#define VQ_ARITH_LOOP(T, X, Y, NULLS, RES) \
+	for (i = 0; i < n; i++) \
+	{ \
+		int			row = sel[i]; \
+		T			x = (X); \
+		T			y = (Y); \
+		res->isnull[row] = (NULLS); \
+		res->values[row] = (RES); \
+	}
+
+#define VQ_ARITH_KERNEL(cls, T, GETL, GETR, GETLC, GETRC, PUT, opname, OP) \
+static void \
+vq_arith_##cls##_##opname(const VQArgs *a, VQOperand *res, \
+						  const int *sel, int n) \
+{ \
+	int			i; \
+	if (a->l == NULL) \
+	{ \
+		T			c = GETLC; \
+		VQ_ARITH_LOOP(T, c, GETR, a->rnull[row], PUT(OP(x, y))); \
+	} \
+	else if (a->r == NULL) \
+	{ \
+		T			c = GETRC; \
+		VQ_ARITH_LOOP(T, GETL, c, a->lnull[row], PUT(OP(x, y))); \
+	} \
+	else \
+		VQ_ARITH_LOOP(T, GETL, GETR, a->lnull[row] | a->rnull[row], \
+					  PUT(OP(x, y))); \
+}
+
+#define VQ_PUTI(v)		Int64GetDatum(VQ_GETI((v), res->shift))
+
+VQ_ARITH_KERNEL(int, int64, VQ_GETI(a->l[row], a->lshift),
+				VQ_GETI(a->r[row], a->rshift), DatumGetInt64(a->lc),
+				DatumGetInt64(a->rc), VQ_PUTI, pl, VQ_IPL)
+VQ_ARITH_KERNEL(int, int64, VQ_GETI(a->l[row], a->lshift),
+				VQ_GETI(a->r[row], a->rshift), DatumGetInt64(a->lc),
+				DatumGetInt64(a->rc), VQ_PUTI, mi, VQ_IMI)
+VQ_ARITH_KERNEL(int, int64, VQ_GETI(a->l[row], a->lshift),
+				VQ_GETI(a->r[row], a->rshift), DatumGetInt64(a->lc),
+				DatumGetInt64(a->rc), VQ_PUTI, mul, VQ_IMUL)
+VQ_ARITH_KERNEL(int, int64, VQ_GETI(a->l[row], a->lshift),
+				VQ_GETI(a->r[row], a->rshift), DatumGetInt64(a->lc),
+				DatumGetInt64(a->rc), VQ_PUTI, div, VQ_IDIV)
+
+#define VQ_ARITH_FLOAT(cls, T, GET, PUT) \
+	VQ_ARITH_KERNEL(cls, T, GET(a->l[row]), GET(a->r[row]), GET(a->lc), \
+					GET(a->rc), PUT, pl, VQ_FPL) \
+	VQ_ARITH_KERNEL(cls, T, GET(a->l[row]), GET(a->r[row]), GET(a->lc), \
+					GET(a->rc), PUT, mi, VQ_FMI) \
+	VQ_ARITH_KERNEL(cls, T, GET(a->l[row]), GET(a->r[row]), GET(a->lc), \
+					GET(a->rc), PUT, mul, VQ_FMUL) \
+	VQ_ARITH_KERNEL(cls, T, GET(a->l[row]), GET(a->r[row]), GET(a->lc), \
+					GET(a->rc), PUT, div, VQ_FDIV)
+
+VQ_ARITH_FLOAT(float4, float4, DatumGetFloat4, Float4GetDatum)
+VQ_ARITH_FLOAT(float8, float8, DatumGetFloat8, Float8GetDatum)
+
+#define VQ_ARITH_ENTRIES(cls) \
+	{vq_arith_##cls##_pl, vq_arith_##cls##_mi, \
+	 vq_arith_##cls##_mul, vq_arith_##cls##_div}
+
+/* by VQClass, by VKernelOp from VK_PL to VK_DIV */
+static const VQArithFunc vq_arith_funcs[3][4] = {
+	VQ_ARITH_ENTRIES(int),
+	VQ_ARITH_ENTRIES(float4),
+	VQ_ARITH_ENTRIES(float8)
+};
+
+/*
+ * The class of the values of a non-vectorized type, and for integers the
+ * shift which sign-extends them. False if the type is not compiled.
+ */
+static bool
+vq_type_class(Oid type, VQClass *cls, int *shift)
+{
+	*shift = 0;
+
+	switch (type)
+	{
+		case INT2OID:
+			*cls = VQ_INT;
+			*shift = 48;
+			return true;
+		case INT4OID:
+		case DATEOID:
+			*cls = VQ_INT;
+			*shift = 32;
+			return true;
+		case INT8OID:
+			*cls = VQ_INT;
+			return true;
+		case TIMESTAMPOID:
+#ifdef HAVE_INT64_TIMESTAMP
+			*cls = VQ_INT;
+#else
+			*cls = VQ_FLOAT8;
+#endif
+			return true;
+		case FLOAT4OID:
+			*cls = VQ_FLOAT4;
+			return true;
+		case FLOAT8OID:
+			*cls = VQ_FLOAT8;
+			return true;
+		default:
+			return false;
+	}
+}
+
+/*
+ * The kernel operator of an OpExpr, by the name of its operator. vcheck.c
+ * replaced the function of the operator by the vectorized one of the same
+ * name, so the name tells what the function does.
+ */
+static bool
+vq_operator(OpExpr *opexpr, VKernelOp *op)
+{
+	static const struct
+	{
+		const char *name;
+		VKernelOp	op;
+	}			ops[] = {
+		{"=", VK_EQ}, {"<>", VK_NE}, {">", VK_GT}, {">=", VK_GE},
+		{"<", VK_LT}, {"<=", VK_LE}, {"+", VK_PL}, {"-", VK_MI},
+		{"*", VK_MUL}, {"/", VK_DIV}
+	};
+	char	   *name;
+	int			i;
+
+	if (list_length(opexpr->args) != 2)
+		return false;
+
+	name = get_opname(opexpr->opno);
+	if (name == NULL)
+		return false;
+
+	for (i = 0; i < lengthof(ops); i++)
+	{
+		if (strcmp(name, ops[i].name) == 0)
+		{
+			*op = ops[i].op;
+			pfree(name);
+			return true;
+		}
+	}
+
+	pfree(name);
+	return false;
+}
+
+static bool
+vq_is_cmp(VKernelOp op)
+{
+	return op >= VK_EQ && op <= VK_LE;
+}
+
+/* a op b is b commute(op) a */
+static VKernelOp
+vq_commute(VKernelOp op)
+{
+	switch (op)
+	{
+		case VK_GT:
+			return VK_LT;
+		case VK_GE:
+			return VK_LE;
+		case VK_LT:
+			return VK_GT;
+		case VK_LE:
+			return VK_GE;
+		default:
+			return op;
+	}
+}
+
+static VQOperand *
+vq_compile_operand(VQualProgram *prog, Expr *expr, int batchsize)
+{
+	VQOperand  *res;
+
+	while (IsA(expr, RelabelType))
+		expr = ((RelabelType *) expr)->arg;
+
+	if (IsA(expr, Var))
+	{
+		Var		   *var = (Var *) expr;
+		VQClass		cls;
+		int			shift;
+
+		if (var->varattno <= 0 ||
+			!vq_type_class(GetNtype(var->vartype), &cls, &shift))
+			return NULL;
+
+		res = palloc0(sizeof(VQOperand));
+		res->kind = VQ_COLUMN;
+		res->cls = cls;
+		res->shift = shift;
+		res->attno = var->varattno - 1;
+		return res;
+	}
+
+	if (IsA(expr, Const))
+	{
+		Const	   *c = (Const *) expr;
+		VQClass		cls;
+		int			shift;
+
+		if (c->constisnull || !vq_type_class(c->consttype, &cls, &shift))
+			return NULL;
+
+		res = palloc0(sizeof(VQOperand));
+		res->kind = VQ_CONST;
+		res->cls = cls;
+		res->value = c->constvalue;
+		if (cls == VQ_INT)
+			res->value = Int64GetDatum(VQ_GETI(c->constvalue, shift));
+		return res;
+	}
+
+	if (IsA(expr, OpExpr))
+	{
+		OpExpr	   *opexpr = (OpExpr *) expr;
+		VQOperand  *left;
+		VQOperand  *right;
+		VQOperand  *typed;
+		VKernelOp	op;
+
+		if (!vq_operator(opexpr, &op) || vq_is_cmp(op))
+			return NULL;
+
+		left = vq_compile_operand(prog, linitial(opexpr->args), batchsize);
+		right = vq_compile_operand(prog, lsecond(opexpr->args), batchsize);
+		if (left == NULL || right == NULL || left->cls != right->cls ||
+			(left->kind == VQ_CONST && right->kind == VQ_CONST))
+			return NULL;
+
+		/* the vectorized operand gives the type of the operation */
+		typed = left->kind == VQ_CONST ? right : left;
+		if (left->kind == VQ_CONST && left->cls == VQ_INT)
+			left->value = Int64GetDatum(VQ_GETI(left->value, typed->shift));
+		if (right->kind == VQ_CONST && right->cls == VQ_INT)
+			right->value = Int64GetDatum(VQ_GETI(right->value, typed->shift));
+
+		res = palloc0(sizeof(VQOperand));
+		res->kind = VQ_ARITH;
+		res->cls = typed->cls;
+		res->shift = typed->shift;
+		res->func = vq_arith_funcs[res->cls][op - VK_PL];
+		res->left = left;
+		res->right = right;
+		res->values = palloc(sizeof(Datum) * batchsize);
+		res->isnull = palloc(sizeof(bool) * batchsize);
+
+		prog->nkernels++;
+		return res;
+	}
+
+	return NULL;
+}
+
+/*
+ * Compile a boolean clause, or its negation. NOT is pushed down to the
+ * comparisons by De Morgan's laws, which hold for the three-valued logic
+ * as well, and a negated comparison passes the rows on which it is false,
+ * so that NaN and null keep their meaning.
+ */
+static VQNode *
+vq_compile_clause(VQualProgram *prog, Expr *expr, bool negate, int batchsize)
+{
+	VQNode	   *node;
+
+	if (IsA(expr, BoolExpr))
+	{
+		BoolExpr   *boolexpr = (BoolExpr *) expr;
+		ListCell   *lc;
+
+		if (boolexpr->boolop == NOT_EXPR)
+			return vq_compile_clause(prog, linitial(boolexpr->args),
+									 !negate, batchsize);
+
+		node = palloc0(sizeof(VQNode));
+		node->kind = (boolexpr->boolop == AND_EXPR) != negate ? VQ_AND : VQ_OR;
+
+		foreach(lc, boolexpr->args)
+		{
+			VQNode	   *child = vq_compile_clause(prog, lfirst(lc),
+												  negate, batchsize);
+
+			if (child == NULL)
+				return NULL;
+			node->children = lappend(node->children, child);
+		}
+
+		if (node->kind == VQ_OR)
+		{
+			node->rest = palloc(sizeof(int) * batchsize);
+			node->pass = palloc(sizeof(int) * batchsize);
+			node->merged = palloc(sizeof(int) * batchsize);
+		}
+
+		return node;
+	}
+
+	if (IsA(expr, OpExpr))
+	{
+		OpExpr	   *opexpr = (OpExpr *) expr;
+		VQOperand  *left;
+		VQOperand  *right;
+		VKernelOp	op;
+
+		if (!vq_operator(opexpr, &op) || !vq_is_cmp(op))
+			return NULL;
+
+		left = vq_compile_operand(prog, linitial(opexpr->args), batchsize);
+		right = vq_compile_operand(prog, lsecond(opexpr->args), batchsize);
+		if (left == NULL || right == NULL || left->cls != right->cls ||
+			(left->kind == VQ_CONST && right->kind == VQ_CONST))
+			return NULL;
+
+		if (left->kind == VQ_CONST)
+		{
+			VQOperand  *tmp = left;
+
+			left = right;
+			right = tmp;
+			op = vq_commute(op);
+		}
+
+		node = palloc0(sizeof(VQNode));
+		node->kind = VQ_CMP;
+		node->func = vq_cmp_funcs[left->cls][op - VK_EQ][right->kind == VQ_CONST];
+		node->negate = negate;
+		node->left = left;
+		node->right = right;
+
+		prog->nkernels++;
+		return node;
+	}
+
+	return NULL;
+}
+
+/*
+ * Compile the clauses of a qual, a list of ExprStates. Returns NULL if none
+ * of them can be compiled.
+ */
+VQualProgram *
+VQualCompile(List *qual, int batchsize)
+{
+	VQualProgram *prog = palloc0(sizeof(VQualProgram));
+	ListCell   *lc;
+
+	prog->root = palloc0(sizeof(VQNode));
+	prog->root->kind = VQ_AND;
+
+	foreach(lc, qual)
+	{
+		ExprState  *clause = lfirst(lc);
+		VQNode	   *node = vq_compile_clause(prog, clause->expr, false,
+											 batchsize);
+
+		if (node)
+			prog->root->children = lappend(prog->root->children, node);
+		else
+			prog->residual = lappend(prog->residual, clause);
+	}
+
+	if (prog->root->children == NIL)
+		return NULL;
+
+	prog->sel = palloc(sizeof(int) * batchsize);
+
+	elog(DEBUG1, "vectorized qual compiled into %d kernels, %d clauses left",
+		 prog->nkernels, list_length(prog->residual));
+
+	return prog;
+}
+
+static void
+vq_resolve(VQOperand *op, TupleBatch tb,
+		   const Datum **values, const bool **isnull, int *shift, Datum *c)
+{
+	switch (op->kind)
+	{
+		case VQ_COLUMN:
+			*values = tb->datagroup[op->attno]->values;
+			*isnull = tb->datagroup[op->attno]->isnull;
+			*shift = op->shift;
+			break;
+		case VQ_CONST:
+			*values = NULL;
+			*isnull = NULL;
+			*shift = 0;
+			*c = op->value;
+			break;
+		case VQ_ARITH:
+			/* sign-extended already */
+			*values = op->values;
+			*isnull = op->isnull;
+			*shift = 0;
+			break;
+	}
+}
+
+static void
+vq_resolve_args(VQArgs *args, VQOperand *left, VQOperand *right,
+				TupleBatch tb)
+{
+	vq_resolve(left, tb, &args->l, &args->lnull, &args->lshift, &args->lc);
+	vq_resolve(right, tb, &args->r, &args->rnull, &args->rshift, &args->rc);
+}
+
+static void
+vq_eval_operand(VQOperand *op, TupleBatch tb, const int *sel, int n)
+{
+	VQArgs		args;
+
+	if (op->kind != VQ_ARITH)
+		return;
+
+	vq_eval_operand(op->left, tb, sel, n);
+	vq_eval_operand(op->right, tb, sel, n);
+
+	vq_resolve_args(&args, op->left, op->right, tb);
+	op->func(&args, op, sel, n);
+}
+
+/* the union of two ascending selections, into a */
+static int
+vq_union(int *a, int na, const int *b, int nb, int *merged)
+{
+	int			i = 0;
+	int			j = 0;
+	int			m = 0;
+
+	while (i < na && j < nb)
+		merged[m++] = a[i] < b[j] ? a[i++] : b[j++];
+	while (i < na)
+		merged[m++] = a[i++];
+	while (j < nb)
+		merged[m++] = b[j++];
+
+	memcpy(a, merged, sizeof(int) * m);
+	return m;
+}
+
+/* the rows of a not in b, b being a subset of a */
+static int
+vq_minus(int *a, int na, const int *b, int nb)
+{
+	int			i;
+	int			j = 0;
+	int			m = 0;
+
+	for (i = 0; i < na; i++)
+	{
+		if (j < nb && a[i] == b[j])
+			j++;
+		else
+			a[m++] = a[i];
+	}
+
+	return m;
+}
+
+/*
+ * Narrow the n selected rows of sel to those passing the node, returns
+ * their number.
+ */
+static int
+vq_eval(VQNode *node, TupleBatch tb, int *sel, int n)
+{
+	ListCell   *lc;
+	VQArgs		args;
+
+	switch (node->kind)
+	{
+		case VQ_CMP:
+			vq_eval_operand(node->left, tb, sel, n);
+			vq_eval_operand(node->right, tb, sel, n);
+			vq_resolve_args(&args, node->left, node->right, tb);
+			args.negate = node->negate;
+			return node->func(&args, sel, n);
+
+		case VQ_AND:
+			foreach(lc, node->children)
+			{
+				if (n == 0)
+					break;
+				n = vq_eval(lfirst(lc), tb, sel, n);
+			}
+			return n;
+
+		case VQ_OR:
+			{
+				int			nrest = n;
+				int			nout = 0;
+
+				memcpy(node->rest, sel, sizeof(int) * n);
+
+				foreach(lc, node->children)
+				{
+					int			npass;
+
+					memcpy(node->pass, node->rest, sizeof(int) * nrest);
+					npass = vq_eval(lfirst(lc), tb, node->pass, nrest);
+					if (npass == 0)
+						continue;
+
+					nout = vq_union(sel, nout, node->pass, npass, node->merged);
+					nrest = vq_minus(node->rest, nrest, node->pass, npass);
+					if (nrest == 0)
+						break;
+				}
+				return nout;
+			}
+	}
+
+	return 0;
+}
+
+/*
+ * Run the compiled clauses on a batch: the rows which do not pass them are
+ * marked skipped.
+ */
+void
+VQualRun(VQualProgram *prog, TupleBatch tb)
+{
+	int			n = 0;
+	int			i;
+
+	for (i = 0; i < tb->nrows; i++)
+	{
+		prog->sel[n] = i;
+		n += !tb->skip[i];
+	}
+
+	n = vq_eval(prog->root, tb, prog->sel, n);
+
+	memset(tb->skip, true, sizeof(bool) * tb->nrows);
+	for (i = 0; i < n; i++)
+		tb->skip[prog->sel[i]] = false;
+}
@@ -0,0 +1,133 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __EXEC_VQUAL_COMPILE_H___
+#define __EXEC_VQUAL_COMPILE_H___
+
+#include "postgres.h"
+#include "nodes/pg_list.h"
+#include "tuplebatch.h"
+#include "vkernel.h"
+
+/*
+ * A scan qual compiled into fused selection kernels.
+ *
+ * The clauses made of AND, OR, NOT, comparisons and arithmetic on integer,
+ * date, timestamp and float columns and constants are compiled once into a
+ * tree of VQNodes. Each comparison is a kernel specialized for its type,
+ * operator and operand shape, which narrows a selection vector, the
+ * ascending row numbers of the batch still passing, in place. No vbool is
+ * built and no function is called per clause.
+ *
+ * The clauses which cannot be compiled are left in `residual', and run
+ * through ExecVQual on the rows the compiled ones let through.
+ */
+
+/* how the values of an operand are compared and computed */
+typedef enum VQClass
+{
+	VQ_INT,						/* int2, int4, int8, date, int64 timestamp */
+	VQ_FLOAT4,
+	VQ_FLOAT8					/* float8, float timestamp */
+} VQClass;
+
+typedef enum VQOperandKind
+{
+	VQ_COLUMN,
+	VQ_CONST,
+	VQ_ARITH
+} VQOperandKind;
+
+/*
+ * The operands of a kernel, resolved for the current batch. A constant
+ * operand has no values, only lc or rc. The constant of a comparison is
+ * always on its right.
+ */
+typedef struct VQArgs
+{
+	const Datum *l;
+	const bool *lnull;
+	int			lshift;
+	Datum		lc;
+	const Datum *r;
+	const bool *rnull;
+	int			rshift;
+	Datum		rc;
+	bool		negate;
+} VQArgs;
+
+struct VQOperand;
+
+typedef int (*VQCmpFunc) (const VQArgs *args, int *sel, int n);
+typedef void (*VQArithFunc) (const VQArgs *args, struct VQOperand *res,
+							 const int *sel, int n);
+
+typedef struct VQOperand
+{
+	VQOperandKind kind;
+	VQClass		cls;
+	int			shift;			/* VQ_INT: 64 less the width of the value */
+
+	AttrNumber	attno;			/* VQ_COLUMN: 0-based column of the batch */
+	Datum		value;			/* VQ_CONST, an int64 for VQ_INT */
+
+	/* VQ_ARITH, the result is valid for the selected rows only */
+	VQArithFunc func;
+	struct VQOperand *left;
+	struct VQOperand *right;
+	Datum	   *values;
+	bool	   *isnull;
+} VQOperand;
+
+typedef enum VQNodeKind
+{
+	VQ_AND,
+	VQ_OR,
+	VQ_CMP
+} VQNodeKind;
+
+typedef struct VQNode
+{
+	VQNodeKind	kind;
+
+	/* VQ_AND, VQ_OR */
+	List	   *children;
+	int		   *rest;			/* VQ_OR: rows not passed yet */
+	int		   *pass;			/* VQ_OR: rows passing the current child */
+	int		   *merged;
+
+	/* VQ_CMP */
+	VQCmpFunc	func;
+	bool		negate;			/* passes if non-null and false */
+	VQOperand  *left;
+	VQOperand  *right;
+} VQNode;
+
+typedef struct VQualProgram
+{
+	VQNode	   *root;			/* an AND of the compiled clauses */
+	List	   *residual;		/* ExprStates of the other clauses */
+	int			nkernels;
+	int		   *sel;
+} VQualProgram;
+
+extern VQualProgram *VQualCompile(List *qual, int batchsize);
+extern void VQualRun(VQualProgram *prog, TupleBatch tb);
+
+#endif
@@ -20,11 +20,41 @@
 #include "execVScan.h"
 #include "miscadmin.h"
 #include "execVQual.h"
+#include "execVQualCompile.h"
 #include "parquet_reader.h"
 #include "ao_reader.h"
+#include "orc_reader.h"
+#include "ext_reader.h"
+#include "vkernel.h"
+#include "executor/nodeHash.h"
+#include "lib/stringinfo.h"
+#include "utils/bloomfilter.h"
+#include "utils/lsyscache.h"
+
+extern bool vectorized_batch_adaptive;
+extern int vectorized_batch_cache_size;
+extern bool vectorized_qual_compile;
+
+/* re-tune the batch size of a scan every so many batches */
+#define VSCAN_RETUNE_BATCHES	16
+#define VSCAN_MIN_BATCHROWS		64
 
 static TupleTableSlot*
 ExecVScan(ScanState *node, ExecScanAccessMtd accessMtd);
+static void
+InitVScanLateMaterialize(ScanState *scanState);
+static void
+VScanLateMaterialize(ScanState *scanState);
+static void
+InitVScanQualCompile(ScanState *scanState);
+static void
+InitVScanBatchSizing(ScanState *scanState);
+static void
+VScanRetuneBatchSize(ScanState *scanState);
+static bool
+VScanRuntimeFilter(ScanState *scanState, TupleBatch tb);
+static void
+VScanExplainEnd(PlanState *planstate, struct StringInfoData *buf);
 
 static const ScanMethod *
 getVScanMethod(int tableType)
@@ -43,6 +73,11 @@ getVScanMethod(int tableType)
                     {
                             &ParquetVScanNext, &BeginScanParquetRelation, &EndScanParquetRelation,
                             &ReScanParquetRelation, &MarkRestrNotAllowed, &MarkRestrNotAllowed
+                    },
+                    //ORCSCAN
+                    {
+                            &OrcVScanNext, &BeginVScanOrcRelation, &EndVScanOrcRelation,
+                            &orcReScan, &MarkRestrNotAllowed, &MarkRestrNotAllowed
                     }
             };
 
@@ -56,6 +91,24 @@ getVScanMethod(int tableType)
     return &scanMethods[tableType];
 }
 
+/*
+ * External tables have no table type, their scan is taken by the state node.
+ */
+static const ScanMethod *
+getScanStateVScanMethod(ScanState *scanState)
+{
+    static const ScanMethod externalScanMethod =
+            {
+                    &ExternalVScanNext, &BeginVScanExternalRelation, &EndVScanExternalRelation,
+                    &ReScanVExternalRelation, &MarkRestrNotAllowed, &MarkRestrNotAllowed
+            };
+
+    if (IsA(scanState, ExternalScanState))
+        return &externalScanMethod;
+
+    return getVScanMethod(scanState->tableType);
+}
+
 
 /*
  * ExecTableVScanVirtualLayer
@@ -99,23 +152,380 @@ TupleTableSlot *ExecTableVScan(ScanState *scanState)
 {
     if (scanState->scan_state == SCAN_INIT ||
         scanState->scan_state == SCAN_DONE)
-    {
-        getVScanMethod(scanState->tableType)->beginScanMethod(scanState);
-    }
+        BeginTableVScan(scanState);
 
     tbReset(scanState->ss_ScanTupleSlot->PRIVATE_tb);
     tbReset(scanState->ps.ps_ResultTupleSlot->PRIVATE_tb);
-    TupleTableSlot *slot = ExecVScan(scanState,getVScanMethod(scanState->tableType)->accessMethod);
+    TupleTableSlot *slot = ExecVScan(scanState,getScanStateVScanMethod(scanState)->accessMethod);
 
     if (TupIsNull(slot) && !scanState->ps.delayEagerFree)
     {
-        getVScanMethod(scanState->tableType)->endScanMethod(scanState);
+        EndTableVScan(scanState);
     }
 
     return slot;
 
 }
 
+void BeginTableVScan(ScanState *scanState)
+{
+    InitVScanLateMaterialize(scanState);
+    InitVScanQualCompile(scanState);
+    InitVScanBatchSizing(scanState);
+    getScanStateVScanMethod(scanState)->beginScanMethod(scanState);
+}
+
+void EndTableVScan(ScanState *scanState)
+{
+    getScanStateVScanMethod(scanState)->endScanMethod(scanState);
+}
+
+/*
+ * Forget the state the scan derived from the qual, the target list and the
+ * columns of its relation; the next BeginTableVScan sets it up again. Used
+ * when a dynamic scan moves to a partition of another column layout, the
+ * memory is freed by the caller.
+ */
+void ResetTableVScan(ScanState *scanState)
+{
+    VectorizedState* vs = (VectorizedState*)scanState->ps.vectorized;
+
+    vs->late = false;
+    vs->lateproj = NULL;
+    vs->qualcompiled = false;
+    vs->qualprog = NULL;
+    vs->sizing = NULL;
+}
+
+/*
+ * Late materialization: with a qual, the projected columns it does not
+ * reference are decoded only after it ran, and only for the rows which
+ * passed it. The scan access method leaves the lateproj columns out of the
+ * batch, VScanLateMaterialize fills them in.
+ */
+static void
+InitVScanLateMaterialize(ScanState *scanState)
+{
+    VectorizedState* vs = (VectorizedState*)scanState->ps.vectorized;
+    TupleBatch tb = scanState->ss_ScanTupleSlot->PRIVATE_tb;
+    bool *qualproj;
+
+    /* the needed columns do not change across rescans */
+    if (vs->lateproj || !scanState->ps.plan->qual)
+        return;
+
+    if (scanState->tableType != TableTypeAppendOnly &&
+        scanState->tableType != TableTypeParquet)
+        return;
+
+    qualproj = palloc0(sizeof(bool) * tb->ncols);
+    vs->lateproj = palloc0(sizeof(bool) * tb->ncols);
+
+    GetNeededColumnsForScan((Node* )scanState->ps.plan->targetlist,vs->lateproj,tb->ncols);
+    GetNeededColumnsForScan((Node* )scanState->ps.plan->qual,qualproj,tb->ncols);
+
+    for (int i = 0; i < tb->ncols; i++)
+    {
+        vs->lateproj[i] = vs->lateproj[i] && !qualproj[i];
+        vs->late = vs->late || vs->lateproj[i];
+    }
+
+    pfree(qualproj);
+}
+
+static void
+VScanLateMaterialize(ScanState *scanState)
+{
+    switch (scanState->tableType)
+    {
+        case TableTypeAppendOnly:
+            AppendOnlyVScanLateMaterialize(scanState);
+            break;
+        case TableTypeParquet:
+            ParquetVScanLateMaterialize(scanState);
+            break;
+        default:
+            Insist(false);
+            break;
+    }
+}
+
+/*
+ * Compile the qual into fused selection kernels, see execVQualCompile.c.
+ * The clauses the compiler does not handle are still run by ExecVQual.
+ */
+static void
+InitVScanQualCompile(ScanState *scanState)
+{
+    VectorizedState* vs = (VectorizedState*)scanState->ps.vectorized;
+    TupleBatch tb = scanState->ss_ScanTupleSlot->PRIVATE_tb;
+
+    /* the qual does not change across rescans */
+    if (vs->qualcompiled)
+        return;
+    vs->qualcompiled = true;
+
+    if (!vectorized_qual_compile || !scanState->ps.qual)
+        return;
+
+    vs->qualprog = VQualCompile(scanState->ps.qual, tb->batchsize);
+}
+
+/*
+ * Batch sizing: the number of rows of a scan batch is chosen so that the
+ * decoded columns fit in vectorized_batch_cache_size, between
+ * VSCAN_MIN_BATCHROWS and the capacity of the batch, vectorized_batch_size.
+ *
+ * With late materialization the columns out of the qual are decoded only
+ * for the passed rows, so the footprint of a batch shrinks with the
+ * selectivity of the qual; the size is re-tuned from the selectivity
+ * observed every VSCAN_RETUNE_BATCHES batches.
+ */
+static int
+VScanColumnWidth(Relation rel, int attno)
+{
+    Form_pg_attribute attr = RelationGetDescr(rel)->attrs[attno];
+    int width = sizeof(Datum) + sizeof(bool);
+
+    if (!attr->attbyval)
+    {
+        int32 avgwidth = get_attavgwidth(RelationGetRelid(rel), attno + 1);
+
+        if (avgwidth <= 0)
+            avgwidth = get_typavgwidth(attr->atttypid, attr->atttypmod);
+        width += avgwidth;
+    }
+
+    return width;
+}
+
+static int
+VScanBatchRows(VBatchSizing *sizing, double selectivity)
+{
+    double width = sizing->qualwidth + selectivity * sizing->latewidth;
+    double rows = (double) vectorized_batch_cache_size * 1024 / Max(width, 1);
+
+    rows = Min(rows, sizing->capacity);
+    rows = Max(rows, Min(VSCAN_MIN_BATCHROWS, sizing->capacity));
+
+    return (int) rows;
+}
+
+static void
+InitVScanBatchSizing(ScanState *scanState)
+{
+    VectorizedState* vs = (VectorizedState*)scanState->ps.vectorized;
+    TupleBatch tb = scanState->ss_ScanTupleSlot->PRIVATE_tb;
+    VBatchSizing *sizing;
+    bool *cols;
+    bool *qualcols;
+
+    vs->batchrows = tb->batchsize;
+
+    if (!vectorized_batch_adaptive)
+        return;
+
+    /* keep the statistics across rescans */
+    if (vs->sizing)
+    {
+        vs->batchrows = vs->sizing->initrows;
+        return;
+    }
+
+    sizing = palloc0(sizeof(VBatchSizing));
+    sizing->capacity = tb->batchsize;
+    cols = palloc0(sizeof(bool) * tb->ncols);
+    qualcols = palloc0(sizeof(bool) * tb->ncols);
+
+    GetNeededColumnsForScan((Node* )scanState->ps.plan->targetlist,cols,tb->ncols);
+    GetNeededColumnsForScan((Node* )scanState->ps.plan->qual,cols,tb->ncols);
+    GetNeededColumnsForScan((Node* )scanState->ps.plan->qual,qualcols,tb->ncols);
+
+    for (int i = 0; i < tb->ncols; i++)
+    {
+        if (!cols[i])
+            continue;
+
+        if (vs->late && !qualcols[i])
+            sizing->latewidth += VScanColumnWidth(scanState->ss_currentRelation, i);
+        else
+            sizing->qualwidth += VScanColumnWidth(scanState->ss_currentRelation, i);
+    }
+
+    pfree(cols);
+    pfree(qualcols);
+
+    sizing->initrows = VScanBatchRows(sizing, 1.0);
+    sizing->minrows = sizing->initrows;
+    sizing->maxrows = sizing->initrows;
+    vs->batchrows = sizing->initrows;
+    vs->sizing = sizing;
+
+    if (scanState->ps.state->es_instrument)
+        scanState->ps.cdbexplainfun = VScanExplainEnd;
+}
+
+/*
+ * Account the batch just filtered by the qual, and re-tune the batch size
+ * at the end of a window.
+ */
+static void
+VScanRetuneBatchSize(ScanState *scanState)
+{
+    VectorizedState* vs = (VectorizedState*)scanState->ps.vectorized;
+    VBatchSizing *sizing = vs->sizing;
+    TupleBatch tb = scanState->ss_ScanTupleSlot->PRIVATE_tb;
+    int passed = 0;
+    int rows;
+
+    if (!sizing)
+        return;
+
+    for (int i = 0; i < tb->nrows; i++)
+        passed += !tb->skip[i];
+
+    sizing->nbatches++;
+    sizing->rowsin += tb->nrows;
+    sizing->rowsout += passed;
+    sizing->winrowsin += tb->nrows;
+    sizing->winrowsout += passed;
+
+    if (++sizing->winbatches < VSCAN_RETUNE_BATCHES || sizing->latewidth == 0)
+        return;
+
+    rows = VScanBatchRows(sizing, (double) sizing->winrowsout / Max(sizing->winrowsin, 1));
+    if (rows != vs->batchrows)
+    {
+        vs->batchrows = rows;
+        sizing->nretunes++;
+        sizing->minrows = Min(sizing->minrows, rows);
+        sizing->maxrows = Max(sizing->maxrows, rows);
+    }
+
+    sizing->winbatches = 0;
+    sizing->winrowsin = 0;
+    sizing->winrowsout = 0;
+}
+
+/*
+ * Runtime filter: a hash join above the scan pushes down the Bloom filter
+ * and the key ranges of its inner side, see CreateRuntimeFilterState. The
+ * rows of the batch whose join keys cannot match are skipped, the keys are
+ * hashed as ExecHashGetHashValue does. Returns false if there is no filter
+ * to apply.
+ */
+#define VSCAN_BLOOM_CHUNK 256
+
+/* Skip the n rows whose hash keys are not in the Bloom filter. */
+static void
+VScanProbeBloomFilter(RuntimeFilterState *rf, TupleBatch tb,
+                      const uint32 *hashkeys, const int *rows, int n)
+{
+    bool found[VSCAN_BLOOM_CHUNK];
+
+    FindBloomFilterBatch(rf->bloomfilter, hashkeys, n, found);
+    for (int i = 0; i < n; i++)
+        tb->skip[rows[i]] = !found[i];
+}
+
+static bool
+VScanRuntimeFilter(ScanState *scanState, TupleBatch tb)
+{
+    RuntimeFilterState *rf = scanState->runtimeFilter;
+    uint32 hashkeys[VSCAN_BLOOM_CHUNK];
+    int rows[VSCAN_BLOOM_CHUNK];
+    int n = 0;
+
+    if (rf == NULL || !rf->hasRuntimeFilter || rf->stopRuntimeFilter)
+        return false;
+
+    /*
+     * The keys of the rows in range are collected and probed in chunks, so
+     * that the buckets of the Bloom filter are prefetched ahead of the probes.
+     */
+    for (int row = 0; row < tb->nrows; row++)
+    {
+        uint32 hashkey = 0;
+        bool pass = true;
+        ListCell *hk;
+        int i = 0;
+
+        if (tb->skip[row])
+            continue;
+
+        foreach(hk, rf->joinkeys)
+        {
+            vtype *column = tb->datagroup[lfirst_int(hk) - 1];
+
+            /* rotate hashkey left 1 bit at each step */
+            hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+
+            if (!column->isnull[row])
+            {
+                if (rf->ranges != NULL &&
+                    !RuntimeFilterRangeMatch(&rf->ranges[i], column->values[row]))
+                {
+                    pass = false;
+                    break;
+                }
+                hashkey ^= DatumGetUInt32(FunctionCall1(&rf->hashfunctions[i],
+                                                        column->values[row]));
+            }
+            i++;
+        }
+
+        if (!pass)
+        {
+            tb->skip[row] = true;
+            continue;
+        }
+
+        hashkeys[n] = hashkey;
+        rows[n++] = row;
+        if (n == VSCAN_BLOOM_CHUNK)
+        {
+            VScanProbeBloomFilter(rf, tb, hashkeys, rows, n);
+            n = 0;
+        }
+    }
+
+    if (n > 0)
+        VScanProbeBloomFilter(rf, tb, hashkeys, rows, n);
+
+    return true;
+}
+
+/*
+ * Report the batch sizes in EXPLAIN ANALYZE.
+ */
+static void
+VScanExplainEnd(PlanState *planstate, struct StringInfoData *buf)
+{
+    VectorizedState* vs = (VectorizedState*)planstate->vectorized;
+    VBatchSizing *sizing = vs->sizing;
+
+    appendStringInfo(buf,
+                     "Vectorized batches of %d rows (%d bytes per row)",
+                     sizing->initrows, sizing->qualwidth + sizing->latewidth);
+
+    if (sizing->nretunes > 0)
+        appendStringInfo(buf,
+                         ", re-tuned %d times between %d and %d rows",
+                         sizing->nretunes, sizing->minrows, sizing->maxrows);
+
+    if (vs->qualprog)
+        appendStringInfo(buf, "; qual compiled into %d kernels",
+                         vs->qualprog->nkernels);
+
+    appendStringInfo(buf, "; " INT64_FORMAT " batches", sizing->nbatches);
+
+    if (sizing->rowsin > 0)
+        appendStringInfo(buf, ", %.1f%% of rows passed the qual",
+                         100.0 * sizing->rowsout / sizing->rowsin);
+
+    appendStringInfo(buf, ".\n");
+}
+
 TupleTableSlot*
 ExecVScan(ScanState *node, ExecScanAccessMtd accessMtd)
 {
@@ -123,6 +533,7 @@ ExecVScan(ScanState *node, ExecScanAccessMtd accessMtd)
     List	   *qual;
     ProjectionInfo *projInfo;
     vbool *skip = NULL;
+    bool filtered;
 
     /*
      * Fetch data from node
@@ -134,7 +545,7 @@ ExecVScan(ScanState *node, ExecScanAccessMtd accessMtd)
      * If we have neither a qual to check nor a projection to do, just skip
      * all the overhead and return the raw scan tuple.
      */
-    if (!qual && !projInfo)
+    if (!qual && !projInfo && !node->runtimeFilter)
         return (*accessMtd) (node);
 
     /*
@@ -183,35 +594,54 @@ ExecVScan(ScanState *node, ExecScanAccessMtd accessMtd)
          * when the qual is nil ... saves only a few cycles, but they add up
          * ...
          */
-        if (!qual || (NULL != (skip = ExecVQual(qual, econtext, false))))
+        filtered = false;
+        if (qual)
         {
-            /*
-             * Found a satisfactory scan tuple.
-             */
-            if (projInfo)
+            TupleBatch tb = (TupleBatch)slot->PRIVATE_tb;
+            VectorizedState *vs = (VectorizedState*)node->ps.vectorized;
+            List *residual = qual;
+
+            if (vs->qualprog)
             {
-                int i;
+                VQualRun(vs->qualprog, tb);
+                residual = vs->qualprog->residual;
+            }
 
-                /* first construct the skip array */
-                if(NULL != skip)
-                {
-                    for(i = 0; i < skip->dim; i++)
-                    {
-                        ((TupleBatch)projInfo->pi_slot->PRIVATE_tb)->skip[i] =
-                                          ((!DatumGetBool(skip->values[i])) ||
-                                          (skip->isnull[i]) ||
-                                          ((TupleBatch)slot->PRIVATE_tb)->skip[i]);
-                    }
-                }
-                else
-                {
-                    Assert(((TupleBatch)projInfo->pi_slot->PRIVATE_tb)->batchsize ==
-                           ((TupleBatch)slot->PRIVATE_tb)->batchsize);
+            if (residual && !vk_all(tb->skip, tb->nrows))
+            {
+                skip = ExecVQual(residual, econtext, false);
 
-                    memcpy(((TupleBatch)projInfo->pi_slot->PRIVATE_tb)->skip,
-                            ((TupleBatch)slot->PRIVATE_tb)->skip,
-                            ((TupleBatch)slot->PRIVATE_tb)->batchsize * sizeof(bool));
-                }
+                /* merge the qual result into the skip array of the scan batch */
+                vk_skip_merge(tb->skip, skip->values, skip->isnull, tb->skip, skip->dim);
+            }
+
+            /* the late columns must be read, or skipped, for every batch */
+            if (vs->late)
+                VScanLateMaterialize(node);
+
+            VScanRetuneBatchSize(node);
+            filtered = true;
+        }
+
+        /* the runtime filter of a hash join above, after the late columns */
+        if (VScanRuntimeFilter(node, (TupleBatch)slot->PRIVATE_tb))
+            filtered = true;
+
+        /*
+         * Found a satisfactory scan tuple, unless every row of the batch
+         * failed the qual.
+         */
+        if (!filtered || !vk_all(((TupleBatch)slot->PRIVATE_tb)->skip,
+                                 ((TupleBatch)slot->PRIVATE_tb)->nrows))
+        {
+            if (projInfo)
+            {
+                Assert(((TupleBatch)projInfo->pi_slot->PRIVATE_tb)->batchsize ==
+                       ((TupleBatch)slot->PRIVATE_tb)->batchsize);
+
+                memcpy(((TupleBatch)projInfo->pi_slot->PRIVATE_tb)->skip,
+                        ((TupleBatch)slot->PRIVATE_tb)->skip,
+                        ((TupleBatch)slot->PRIVATE_tb)->batchsize * sizeof(bool));
 
                 /*
                  * Form a projection tuple, store it in the result tuple slot
@@ -27,4 +27,10 @@
 TupleTableSlot *ExecTableVScanVirtualLayer(ScanState *scanState);
 
 TupleTableSlot *ExecTableVScan(ScanState *scanState);
+
+void BeginTableVScan(ScanState *scanState);
+
+void EndTableVScan(ScanState *scanState);
+
+void ResetTableVScan(ScanState *scanState);
 #endif
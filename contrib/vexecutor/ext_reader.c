@@ -0,0 +1,210 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "ext_reader.h"
+#include "tuplebatch.h"
+#include "access/fileam.h"
+#include "access/plugstorage.h"
+#include "executor/nodeExternalscan.h"
+#include "utils/datum.h"
+#include "utils/memutils.h"
+
+/*
+ * The batches of an external table are read by the getnext_batch function
+ * of its pluggable format, which fills the columns of the TupleBatch in one
+ * call. The formats without one, the TEXT and CSV formatters of the hdfs
+ * protocol among them, are read row by row through ExternalNext and the
+ * rows are gathered into the columns; their pass-by-reference values are
+ * copied into a context which is reset at each batch.
+ */
+static int
+ExternalVScanGatherRows(ExternalScanState *node, int maxrows);
+
+void
+BeginVScanExternalRelation(ScanState *scanState)
+{
+    VectorizedState* vs = (VectorizedState*)scanState->ps.vectorized;
+    TupleBatch tb = scanState->ss_ScanTupleSlot->PRIVATE_tb;
+
+    /* a rescan starts over with the state of the previous scan */
+    if (NULL == vs->ao)
+    {
+        vs->ao = palloc0(sizeof(aoinfo));
+        vs->ao->proj = palloc0(sizeof(bool) * tb->ncols);
+        GetNeededColumnsForScan((Node* )scanState->ps.plan->targetlist,vs->ao->proj,tb->ncols);
+        GetNeededColumnsForScan((Node* )scanState->ps.plan->qual,vs->ao->proj,tb->ncols);
+
+        vs->ao->colvalues = palloc0(sizeof(Datum *) * tb->ncols);
+        vs->ao->colnulls = palloc0(sizeof(bool *) * tb->ncols);
+        vs->ao->batchcxt = AllocSetContextCreate(CurrentMemoryContext,
+                                                 "VScanExternalBatch",
+                                                 ALLOCSET_DEFAULT_MINSIZE,
+                                                 ALLOCSET_DEFAULT_INITSIZE,
+                                                 ALLOCSET_DEFAULT_MAXSIZE);
+    }
+
+    vs->ao->isDone = false;
+    scanState->scan_state = SCAN_SCAN;
+}
+
+void
+EndVScanExternalRelation(ScanState *scanState)
+{
+    VectorizedState* vs = (VectorizedState*)scanState->ps.vectorized;
+
+    if (NULL == vs->ao)
+        return;
+
+    MemoryContextDelete(vs->ao->batchcxt);
+    pfree(vs->ao->colnulls);
+    pfree(vs->ao->colvalues);
+    pfree(vs->ao->proj);
+    pfree(vs->ao);
+    vs->ao = NULL;
+    scanState->scan_state = SCAN_INIT;
+}
+
+/*
+ * The file scan itself is restarted by ExecExternalReScan.
+ */
+void
+ReScanVExternalRelation(ScanState *scanState)
+{
+    VectorizedState* vs = (VectorizedState*)scanState->ps.vectorized;
+
+    if (NULL != vs->ao)
+        vs->ao->isDone = false;
+}
+
+TupleTableSlot *
+ExternalVScanNext(ScanState *scanState)
+{
+    ExternalScanState *node = (ExternalScanState *)scanState;
+    FileScanDesc scandesc = node->ess_ScanDesc;
+    TupleTableSlot *slot = scanState->ss_ScanTupleSlot;
+    TupleBatch tb = (TupleBatch)slot->PRIVATE_tb;
+    VectorizedState* vs = scanState->ps.vectorized;
+    FmgrInfo *batchFunc = NULL;
+
+    Assert((scanState->scan_state & SCAN_SCAN) != 0);
+
+    if(vs->ao->isDone)
+    {
+        ExecClearTuple(slot);
+        return slot;
+    }
+
+    for(int i = 0;i < tb->ncols ; i ++)
+    {
+        if(!vs->ao->proj[i])
+            continue;
+
+        if(!tb->datagroup[i])
+        {
+            Oid hawqTypeID = slot->tts_tupleDescriptor->attrs[i]->atttypid;
+            tbCreateColumn(tb,i,GetVtype(hawqTypeID));
+        }
+
+        vs->ao->colvalues[i] = tb->datagroup[i]->values;
+        vs->ao->colnulls[i] = tb->datagroup[i]->isnull;
+    }
+
+    if (scandesc->fs_formatter_type == ExternalTableType_PLUG)
+        batchFunc = scandesc->fs_ps_scan_funcs.getnext_batch;
+
+    if (batchFunc)
+    {
+        tb->nrows = InvokePlugStorageFormatGetNextBatch(batchFunc, scandesc, scanState,
+                                                        vs->batchrows, vs->ao->proj,
+                                                        vs->ao->colvalues, vs->ao->colnulls);
+
+        /* as ExternalNext does once the data is exhausted */
+        if (tb->nrows == 0 && !scanState->ps.delayEagerFree)
+            ExecEagerFreeExternalScan(node);
+    }
+    else
+        tb->nrows = ExternalVScanGatherRows(node, vs->batchrows);
+
+    for(int i = 0;i < tb->ncols ; i ++)
+    {
+        if(vs->ao->proj[i])
+            tb->datagroup[i]->dim = tb->nrows;
+    }
+
+    if (tb->nrows == 0)
+    {
+        /* begin again if the scan is called after a rescan */
+        vs->ao->isDone = true;
+        scanState->scan_state = SCAN_DONE;
+        ExecClearTuple(slot);
+    }
+    else
+        TupSetVirtualTupleNValid(slot, tb->ncols);
+    return slot;
+}
+
+/*
+ * Reads up to maxrows rows through ExternalNext into the column vectors of
+ * the batch, ExternalNext ends the file scan once the data is exhausted.
+ */
+static int
+ExternalVScanGatherRows(ExternalScanState *node, int maxrows)
+{
+    VectorizedState* vs = node->ss.ps.vectorized;
+    TupleDesc tupdesc = node->ss.ss_ScanTupleSlot->tts_tupleDescriptor;
+    MemoryContext oldcxt;
+    int nrows = 0;
+
+    MemoryContextReset(vs->ao->batchcxt);
+
+    while (nrows < maxrows)
+    {
+        TupleTableSlot *slot = ExternalNext(node);
+        Datum *values;
+        bool *nulls;
+
+        if (TupIsNull(slot))
+            break;
+
+        slot_getallattrs(slot);
+        values = slot_get_values(slot);
+        nulls = slot_get_isnull(slot);
+
+        oldcxt = MemoryContextSwitchTo(vs->ao->batchcxt);
+        for (int i = 0; i < tupdesc->natts; i++)
+        {
+            Form_pg_attribute attr = tupdesc->attrs[i];
+
+            if (!vs->ao->proj[i])
+                continue;
+
+            vs->ao->colnulls[i][nrows] = nulls[i];
+            if (nulls[i])
+                vs->ao->colvalues[i][nrows] = (Datum) 0;
+            else if (attr->attbyval)
+                vs->ao->colvalues[i][nrows] = values[i];
+            else
+                vs->ao->colvalues[i][nrows] = datumCopy(values[i], false, attr->attlen);
+        }
+        MemoryContextSwitchTo(oldcxt);
+
+        nrows++;
+    }
+
+    return nrows;
+}
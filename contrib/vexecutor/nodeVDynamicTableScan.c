@@ -0,0 +1,297 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * nodeVDynamicTableScan.c
+ *    The vectorized dynamic table scan: the partitions chosen at run time
+ * are scanned one after the other by the vectorized scan of execVScan.c,
+ * and their batches are returned as they are.
+ *
+ * The partition loop follows nodeDynamicTableScan.c. The batches, the late
+ * materialization and the compiled qual depend on the columns of the
+ * partition, they are set up again in the per-partition memory context
+ * whenever the expressions of the scan are, that is for the first partition
+ * and for those of another column layout.
+ */
+#include "nodeVDynamicTableScan.h"
+#include "access/filesplit.h"
+#include "cdb/cdbpartition.h"
+#include "cdb/cdbvars.h"
+#include "commands/tablecmds.h"
+#include "executor/instrument.h"
+#include "postmaster/identity.h"
+#include "utils/guc.h"
+#include "utils/hsearch.h"
+#include "utils/memutils.h"
+#include "execVScan.h"
+#include "execVQual.h"
+#include "tuplebatch.h"
+
+extern int BATCHSIZE;
+
+/* as in nodeDynamicTableScan.c */
+#define DYNAMIC_TABLE_SCAN_NSLOTS 2
+
+static bool VInitNextTableToScan(DynamicTableScanState *node);
+static void VSetPidIndex(DynamicTableScanState *node);
+static void VCleanupOnePartition(ScanState *scanState);
+
+/*
+ * ExecVDynamicTableScanVirtualLayer
+ *          translate the batches to single tuples if the parent of the scan
+ *          is a normal execution node, see ExecTableVScanVirtualLayer.
+ */
+TupleTableSlot *
+ExecVDynamicTableScanVirtualLayer(DynamicTableScanState *node)
+{
+	ScanState *scanState = (ScanState *)node;
+	VectorizedState *vs = (VectorizedState *)scanState->ps.vectorized;
+	TupleTableSlot *slot;
+
+	if(vs->parent && vs->parent->vectorized &&
+	   ((VectorizedState *)vs->parent->vectorized)->vectorized)
+		return ExecVDynamicTableScan(node);
+
+	slot = scanState->ps.ps_ProjInfo ? scanState->ps.ps_ResultTupleSlot : scanState->ss_ScanTupleSlot;
+	while(1)
+	{
+		/* the slots have no batch until the first partition is opened */
+		if(!slot->PRIVATE_tb || !VirtualNodeProc(slot))
+		{
+			slot = ExecVDynamicTableScan(node);
+			if(TupIsNull(slot))
+				break;
+			else
+				continue;
+		}
+
+		break;
+	}
+
+	return slot;
+}
+
+/*
+ * copied from ExecDynamicTableScan, the partitions are scanned by
+ * ExecTableVScan.
+ */
+TupleTableSlot *
+ExecVDynamicTableScan(DynamicTableScanState *node)
+{
+	ScanState *scanState = (ScanState *)node;
+	TupleTableSlot *slot = NULL;
+
+	if (node->pidIndex == NULL)
+	{
+		VSetPidIndex(node);
+		Assert(node->pidIndex != NULL);
+
+		hash_seq_init(&node->pidStatus, node->pidIndex);
+		node->shouldCallHashSeqTerm = true;
+	}
+
+	while (TupIsNull(slot) &&
+		   VInitNextTableToScan(node))
+	{
+		slot = ExecTableVScan(scanState);
+
+		if (!TupIsNull(slot))
+		{
+			Gpmon_M_Incr_Rows_Out(GpmonPktFromDynamicTableScanState(node));
+			CheckSendPlanStateGpmonPkt(&scanState->ps);
+		}
+		else
+		{
+			VCleanupOnePartition(scanState);
+		}
+	}
+
+	return slot;
+}
+
+/*
+ * copied from initNextTableToScan of nodeDynamicTableScan.c, the scan of
+ * the partition is begun by BeginTableVScan.
+ */
+static bool
+VInitNextTableToScan(DynamicTableScanState *node)
+{
+	ScanState *scanState = (ScanState *)node;
+	EState *estate = scanState->ps.state;
+
+	if (scanState->scan_state == SCAN_INIT ||
+		scanState->scan_state == SCAN_DONE)
+	{
+		Oid *pid = hash_seq_search(&node->pidStatus);
+		if (pid == NULL)
+		{
+			node->shouldCallHashSeqTerm = false;
+			return false;
+		}
+
+		/* Collect number of partitions scanned in EXPLAIN ANALYZE */
+		if (NULL != scanState->ps.instrument)
+		{
+			Instrumentation *instr = scanState->ps.instrument;
+			instr->numPartScanned ++;
+		}
+
+		/* the slots must have the oid of the partition, see MPP-20736 */
+		for (int i = 0; i < DYNAMIC_TABLE_SCAN_NSLOTS; i++)
+		{
+			scanState->ss_ScanTupleSlot[i].tts_tableOid = *pid;
+		}
+
+		scanState->ss_currentRelation = OpenScanRelationByOid(*pid);
+
+		if (RelationIsAo(scanState->ss_currentRelation))
+		{
+			scanState->splits = GetFileSplitsOfSegment(
+					estate->es_plannedstmt->scantable_splits,
+					scanState->ss_currentRelation->rd_id, GetQEIndex());
+		}
+
+		Relation lastScannedRel = OpenScanRelationByOid(node->lastRelOid);
+		TupleDesc lastTupDesc = RelationGetDescr(lastScannedRel);
+		CloseScanRelation(lastScannedRel);
+
+		TupleDesc partTupDesc = RelationGetDescr(scanState->ss_currentRelation);
+
+		ExecAssignScanType(scanState, partTupDesc);
+
+		AttrNumber	*attMap = NULL;
+
+		attMap = varattnos_map(lastTupDesc, partTupDesc);
+
+		if (attMap)
+		{
+			change_varattnos_of_a_varno((Node*)scanState->ps.plan->qual, attMap, node->scanrelid);
+			change_varattnos_of_a_varno((Node*)scanState->ps.plan->targetlist, attMap, node->scanrelid);
+
+			node->lastRelOid = *pid;
+		}
+
+		/*
+		 * The expressions and the vectorized state of the first partition,
+		 * and of those with another column layout, are set up in the
+		 * per-partition memory context.
+		 */
+		bool relayout = (attMap != NULL || node->firstPartition);
+
+		node->firstPartition = false;
+		if (relayout)
+			MemoryContextReset(node->partitionMemoryContext);
+
+		MemoryContext oldCxt = MemoryContextSwitchTo(node->partitionMemoryContext);
+
+		if (relayout)
+		{
+			/* Initialize child expressions */
+			scanState->ps.qual = (List *)ExecInitExpr((Expr *)scanState->ps.plan->qual, (PlanState*)scanState);
+			scanState->ps.targetlist = (List *)ExecInitExpr((Expr *)scanState->ps.plan->targetlist, (PlanState*)scanState);
+
+			/* the batches have one column per attribute of the partition */
+			scanState->ss_ScanTupleSlot->PRIVATE_tb = PointerGetDatum(tbGenerate(partTupDesc->natts, BATCHSIZE));
+			scanState->ps.ps_ResultTupleSlot->PRIVATE_tb = PointerGetDatum(tbGenerate(partTupDesc->natts, BATCHSIZE));
+			ResetTableVScan(scanState);
+		}
+
+		if (attMap)
+		{
+			pfree(attMap);
+		}
+
+		ExecAssignScanProjectionInfo(scanState);
+
+		scanState->tableType = getTableType(scanState->ss_currentRelation);
+		if (scanState->tableType != TableTypeAppendOnly &&
+			scanState->tableType != TableTypeParquet &&
+			scanState->tableType != TableTypeOrc)
+			elog(ERROR, "vectorized dynamic table scan cannot scan partition \"%s\"",
+				 RelationGetRelationName(scanState->ss_currentRelation));
+
+		BeginTableVScan(scanState);
+		MemoryContextSwitchTo(oldCxt);
+	}
+
+	return true;
+}
+
+/*
+ * copied from setPidIndex of nodeDynamicTableScan.c
+ */
+static void
+VSetPidIndex(DynamicTableScanState *node)
+{
+	Assert(node->pidIndex == NULL);
+
+	ScanState *scanState = (ScanState *)node;
+	EState *estate = scanState->ps.state;
+	DynamicTableScan *plan = (DynamicTableScan *)scanState->ps.plan;
+	Assert(estate->dynamicTableScanInfo != NULL);
+
+	/* the dynahash must exist even if no partition was selected, MPP-24169 */
+	InsertPidIntoDynamicTableScanInfo(plan->partIndex, InvalidOid, InvalidPartitionSelectorId);
+
+	Assert(NULL != estate->dynamicTableScanInfo->pidIndexes);
+	Assert(estate->dynamicTableScanInfo->numScans >= plan->partIndex);
+	node->pidIndex = estate->dynamicTableScanInfo->pidIndexes[plan->partIndex - 1];
+	Assert(node->pidIndex != NULL);
+
+	if (optimizer_partition_selection_log)
+	{
+		LogSelectedPartitionOids(node->pidIndex);
+	}
+}
+
+/*
+ * End the scan of the current partition, unless ExecTableVScan ended it
+ * already, and close its relation.
+ */
+static void
+VCleanupOnePartition(ScanState *scanState)
+{
+	Assert(NULL != scanState);
+	if ((scanState->scan_state & SCAN_SCAN) != 0)
+		EndTableVScan(scanState);
+
+	if (scanState->ss_currentRelation != NULL)
+	{
+		ExecCloseScanRelation(scanState->ss_currentRelation);
+		scanState->ss_currentRelation = NULL;
+	}
+}
+
+/*
+ * copied from ExecEndDynamicTableScan
+ */
+void
+VExecEndDynamicTableScan(DynamicTableScanState *node)
+{
+	VCleanupOnePartition((ScanState *)node);
+
+	if (node->shouldCallHashSeqTerm)
+	{
+		hash_seq_term(&node->pidStatus);
+		node->shouldCallHashSeqTerm = false;
+	}
+
+	FreeScanRelationInternal((ScanState *)node, false /* closeCurrentRelation */);
+	EndPlanStateGpmonPkt(&node->tableScanState.ss.ps);
+}
@@ -0,0 +1,775 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * nodeVHashjoin.c
+ *	  Vectorized hash join.
+ *
+ * The build side is consumed batch by batch straight from the child of the
+ * Hash node, so the Hash node itself is never executed. Probing is done a
+ * whole outer batch at a time: the hash values of all rows are computed
+ * column by column first, the buckets are prefetched, and then the chains
+ * are walked.
+ *
+ * For inner joins the matching pairs are gathered into the result batch.
+ * For semi (JOIN_IN) and anti (JOIN_LASJ) joins the result batch shares the
+ * columns of the outer batch and only the skip vector is filled.
+ *
+ * The build side is kept entirely in memory, vcheck.c only picks this node
+ * when the planner estimate of the inner relation fits in work_mem.
+ */
+
+#include "postgres.h"
+
+#include <math.h>
+
+#include "access/hash.h"
+#include "catalog/pg_type.h"
+#include "executor/nodeHash.h"
+#include "miscadmin.h"
+#include "parser/parsetree.h"
+#include "utils/datum.h"
+#include "utils/date.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+
+#include "nodeVHashjoin.h"
+#include "execVQual.h"
+#include "tuplebatch.h"
+#include "vcheck.h"
+
+extern int BATCHSIZE;
+
+#define VHJ_INITIAL_INNER_ROWS 1024
+
+static void VHashJoinBuild(HashJoinState *node, VHashJoinData *hj);
+static void VHashJoinComputeHash(VHashJoinData *hj, TupleBatch tb,
+								 bool isOuter, int first, int nrows,
+								 uint32 *hashes, bool *haskey);
+static bool VHashJoinKeysEqual(VHashJoinData *hj, TupleBatch outer,
+							   int outerRow, int innerRow);
+static TupleTableSlot *VHashJoinInner(HashJoinState *node, VHashJoinData *hj);
+static TupleTableSlot *VHashJoinSemi(HashJoinState *node, VHashJoinData *hj);
+static bool VHashJoinNextOuter(HashJoinState *node, VHashJoinData *hj);
+
+static inline VHashJoinData *
+GetVHashJoinData(HashJoinState *node)
+{
+	return ((VectorizedState *) node->js.ps.vectorized)->hashjoin;
+}
+
+static VHashKeyKind
+GetKeyKind(Oid type)
+{
+	switch (type)
+	{
+		case INT2OID:
+		case INT4OID:
+		case INT8OID:
+		case DATEOID:
+			return VHJ_KEY_INT;
+		case FLOAT4OID:
+		case FLOAT8OID:
+			return VHJ_KEY_FLOAT;
+		default:
+			return VHJ_KEY_GENERIC;
+	}
+}
+
+static inline int64
+KeyGetInt64(Datum d, Oid type)
+{
+	switch (type)
+	{
+		case INT2OID:
+			return (int64) DatumGetInt16(d);
+		case INT4OID:
+			return (int64) DatumGetInt32(d);
+		case DATEOID:
+			return (int64) DatumGetDateADT(d);
+		default:
+			return DatumGetInt64(d);
+	}
+}
+
+static inline float8
+KeyGetFloat8(Datum d, Oid type)
+{
+	float8 v = (type == FLOAT4OID) ? (float8) DatumGetFloat4(d) : DatumGetFloat8(d);
+
+	/* -0 and +0 are equal and must hash alike */
+	if (v == 0)
+		v = 0;
+	return v;
+}
+
+static inline uint32
+HashInt64Key(int64 v)
+{
+	uint32 lohalf = (uint32) v;
+	uint32 hihalf = (uint32) (v >> 32);
+
+	/* same folding as hashint8, so small values of int2/int4/int8 agree */
+	lohalf ^= (v >= 0) ? hihalf : ~hihalf;
+	return DatumGetUInt32(hash_uint32(lohalf));
+}
+
+static inline uint32
+HashFloat8Key(float8 v)
+{
+	/* all NaNs are equal to each other */
+	if (isnan(v))
+		return 0x7ff80000;
+	return DatumGetUInt32(hash_any((unsigned char *) &v, sizeof(v)));
+}
+
+/*
+ * Map a Var of the join to a 0-based column of the outer batch or of the
+ * build side. INNER Vars reference the Hash node's target list, which in
+ * turn references the output of its child.
+ */
+static AttrNumber
+ResolveJoinVar(HashJoinState *node, Var *var)
+{
+	if (var->varno == INNER)
+	{
+		Plan *hashplan = innerPlan(node->js.ps.plan);
+		TargetEntry *tle = get_tle_by_resno(hashplan->targetlist, var->varattno);
+
+		Insist(NULL != tle && IsA(tle->expr, Var));
+		return ((Var *) tle->expr)->varattno - 1;
+	}
+
+	Insist(var->varno == OUTER);
+	return var->varattno - 1;
+}
+
+/*
+ * VExecInitHashJoin
+ *		Set up the vectorized hash join data after the regular initialization
+ *		of the HashJoinState has been done.
+ */
+void
+VExecInitHashJoin(HashJoinState *node)
+{
+	HashJoin   *plan = (HashJoin *) node->js.ps.plan;
+	PlanState  *hashnode = innerPlanState(node);
+	TupleDesc	innerdesc = ExecGetResultType(outerPlanState(hashnode));
+	VHashJoinData *hj;
+	MemoryContext oldcxt;
+	ListCell   *lc;
+	int			i;
+
+	hj = palloc0(sizeof(VHashJoinData));
+	hj->hjcxt = AllocSetContextCreate(CurrentMemoryContext,
+									  "VHashJoinContext",
+									  ALLOCSET_DEFAULT_MINSIZE,
+									  ALLOCSET_DEFAULT_INITSIZE,
+									  ALLOCSET_DEFAULT_MAXSIZE);
+	oldcxt = MemoryContextSwitchTo(hj->hjcxt);
+
+	hj->jointype = plan->join.jointype;
+
+	/* hash keys */
+	hj->nkeys = list_length(plan->hashclauses);
+	hj->keys = palloc0(sizeof(VHashKeyInfo) * hj->nkeys);
+
+	hj->ninnercols = innerdesc->natts;
+	hj->innerNeeded = palloc0(sizeof(bool) * hj->ninnercols);
+
+	i = 0;
+	foreach(lc, plan->hashclauses)
+	{
+		OpExpr	   *op = (OpExpr *) lfirst(lc);
+		Var		   *outervar = (Var *) linitial(op->args);
+		Var		   *innervar = (Var *) lsecond(op->args);
+		VHashKeyInfo *key = &hj->keys[i++];
+		Oid			hashfn;
+
+		Assert(IsA(op, OpExpr) && IsA(outervar, Var) && IsA(innervar, Var));
+
+		key->outerAttno = ResolveJoinVar(node, outervar);
+		key->innerAttno = ResolveJoinVar(node, innervar);
+		key->outerType = GetNtype(outervar->vartype);
+		if (InvalidOid == key->outerType)
+			key->outerType = outervar->vartype;
+		key->innerType = GetNtype(innervar->vartype);
+		if (InvalidOid == key->innerType)
+			key->innerType = innervar->vartype;
+
+		key->kind = GetKeyKind(key->outerType);
+		if (key->kind != GetKeyKind(key->innerType))
+			key->kind = VHJ_KEY_GENERIC;
+
+		/* generic keys use the operator's own hash and equality functions */
+		hashfn = get_op_hash_function(op->opno);
+		if (!OidIsValid(hashfn))
+			elog(ERROR, "could not find hash function for hash operator %u",
+				 op->opno);
+		fmgr_info(hashfn, &key->hashfn);
+		fmgr_info(get_opcode(op->opno), &key->eqfn);
+
+		hj->innerNeeded[key->innerAttno] = true;
+	}
+
+	/* output columns */
+	hj->noutcols = list_length(plan->join.plan.targetlist);
+	hj->outVarno = palloc0(sizeof(int) * hj->noutcols);
+	hj->outAttno = palloc0(sizeof(AttrNumber) * hj->noutcols);
+	i = 0;
+	foreach(lc, plan->join.plan.targetlist)
+	{
+		TargetEntry *tle = (TargetEntry *) lfirst(lc);
+		Var		   *var = (Var *) tle->expr;
+
+		Assert(IsA(var, Var));
+		hj->outVarno[i] = var->varno;
+		hj->outAttno[i] = ResolveJoinVar(node, var);
+		if (var->varno == INNER)
+			hj->innerNeeded[hj->outAttno[i]] = true;
+		i++;
+	}
+
+	/* build side storage, grown while the inner relation is consumed */
+	hj->innerCap = VHJ_INITIAL_INNER_ROWS;
+	hj->innerValues = palloc0(sizeof(Datum *) * hj->ninnercols);
+	hj->innerIsnull = palloc0(sizeof(bool *) * hj->ninnercols);
+	hj->innerTypLen = palloc0(sizeof(int16) * hj->ninnercols);
+	hj->innerTypByVal = palloc0(sizeof(bool) * hj->ninnercols);
+	for (i = 0; i < hj->ninnercols; i++)
+	{
+		if (!hj->innerNeeded[i])
+			continue;
+
+		hj->innerValues[i] = palloc(sizeof(Datum) * hj->innerCap);
+		hj->innerIsnull[i] = palloc(sizeof(bool) * hj->innerCap);
+		get_typlenbyval(innerdesc->attrs[i]->atttypid,
+						&hj->innerTypLen[i], &hj->innerTypByVal[i]);
+	}
+	hj->innerHash = palloc(sizeof(uint32) * hj->innerCap);
+
+	/* probe side */
+	hj->outerHash = palloc(sizeof(uint32) * BATCHSIZE);
+	hj->outerHasKey = palloc(sizeof(bool) * BATCHSIZE);
+	hj->curMatch = -1;
+
+	MemoryContextSwitchTo(oldcxt);
+
+	((VectorizedState *) node->js.ps.vectorized)->hashjoin = hj;
+}
+
+/*
+ * Compute the hash values of rows [first, first + nrows) of a batch, one key
+ * column at a time. haskey[i] is set to false for rows that have a NULL key
+ * or that are skipped; such rows never match.
+ */
+static void
+VHashJoinComputeHash(VHashJoinData *hj, TupleBatch tb, bool isOuter,
+					 int first, int nrows, uint32 *hashes, bool *haskey)
+{
+	int k, i;
+
+	for (i = 0; i < nrows; i++)
+	{
+		hashes[i] = 0;
+		haskey[i] = !tb->skip[first + i];
+	}
+
+	for (k = 0; k < hj->nkeys; k++)
+	{
+		VHashKeyInfo *key = &hj->keys[k];
+		vtype	   *col = tb->datagroup[isOuter ? key->outerAttno : key->innerAttno];
+		Oid			type = isOuter ? key->outerType : key->innerType;
+		Datum	   *values = col->values + first;
+		bool	   *isnull = col->isnull + first;
+
+		/* rotate hashkey left 1 bit at each step, as ExecHashGetHashValue */
+		for (i = 0; i < nrows; i++)
+			hashes[i] = (hashes[i] << 1) | ((hashes[i] & 0x80000000) ? 1 : 0);
+
+		switch (key->kind)
+		{
+			case VHJ_KEY_INT:
+				for (i = 0; i < nrows; i++)
+				{
+					haskey[i] &= !isnull[i];
+					if (haskey[i])
+						hashes[i] ^= HashInt64Key(KeyGetInt64(values[i], type));
+				}
+				break;
+			case VHJ_KEY_FLOAT:
+				for (i = 0; i < nrows; i++)
+				{
+					haskey[i] &= !isnull[i];
+					if (haskey[i])
+						hashes[i] ^= HashFloat8Key(KeyGetFloat8(values[i], type));
+				}
+				break;
+			default:
+				for (i = 0; i < nrows; i++)
+				{
+					haskey[i] &= !isnull[i];
+					if (haskey[i])
+						hashes[i] ^= DatumGetUInt32(FunctionCall1(&key->hashfn, values[i]));
+				}
+				break;
+		}
+	}
+}
+
+static bool
+VHashJoinKeysEqual(VHashJoinData *hj, TupleBatch outer, int outerRow, int innerRow)
+{
+	int k;
+
+	for (k = 0; k < hj->nkeys; k++)
+	{
+		VHashKeyInfo *key = &hj->keys[k];
+		Datum		ov = outer->datagroup[key->outerAttno]->values[outerRow];
+		Datum		iv = hj->innerValues[key->innerAttno][innerRow];
+
+		switch (key->kind)
+		{
+			case VHJ_KEY_INT:
+				if (KeyGetInt64(ov, key->outerType) != KeyGetInt64(iv, key->innerType))
+					return false;
+				break;
+			case VHJ_KEY_FLOAT:
+				{
+					float8 of = KeyGetFloat8(ov, key->outerType);
+					float8 inf = KeyGetFloat8(iv, key->innerType);
+
+					if (of != inf && !(isnan(of) && isnan(inf)))
+						return false;
+				}
+				break;
+			default:
+				if (!DatumGetBool(FunctionCall2(&key->eqfn, ov, iv)))
+					return false;
+				break;
+		}
+	}
+
+	return true;
+}
+
+static void
+VHashJoinGrowInner(VHashJoinData *hj)
+{
+	int i;
+
+	hj->innerCap *= 2;
+	for (i = 0; i < hj->ninnercols; i++)
+	{
+		if (!hj->innerNeeded[i])
+			continue;
+		hj->innerValues[i] = repalloc(hj->innerValues[i], sizeof(Datum) * hj->innerCap);
+		hj->innerIsnull[i] = repalloc(hj->innerIsnull[i], sizeof(bool) * hj->innerCap);
+	}
+	hj->innerHash = repalloc(hj->innerHash, sizeof(uint32) * hj->innerCap);
+}
+
+/*
+ * Consume the whole inner relation and build the hash table.
+ */
+static void
+VHashJoinBuild(HashJoinState *node, VHashJoinData *hj)
+{
+	PlanState  *innerNode = outerPlanState(innerPlanState(node));
+	MemoryContext oldcxt;
+	uint32	   *hashes;
+	bool	   *haskey;
+	uint32		mask;
+	int			i;
+
+	oldcxt = MemoryContextSwitchTo(hj->hjcxt);
+	hashes = palloc(sizeof(uint32) * BATCHSIZE);
+	haskey = palloc(sizeof(bool) * BATCHSIZE);
+	MemoryContextSwitchTo(oldcxt);
+
+	for (;;)
+	{
+		TupleTableSlot *slot;
+		TupleBatch	tb;
+		int			row;
+
+		CHECK_FOR_INTERRUPTS();
+
+		slot = ExecProcNode(innerNode);
+		if (TupIsNull(slot))
+			break;
+
+		tb = (TupleBatch) slot->PRIVATE_tb;
+		if (NULL == tb || tb->nrows == 0)
+			continue;
+
+		Assert(tb->nrows <= BATCHSIZE);
+		VHashJoinComputeHash(hj, tb, false, 0, tb->nrows, hashes, haskey);
+
+		oldcxt = MemoryContextSwitchTo(hj->hjcxt);
+		for (row = 0; row < tb->nrows; row++)
+		{
+			/* a row with a NULL key can never match an inner join */
+			if (!haskey[row])
+				continue;
+
+			if (hj->ninner == hj->innerCap)
+				VHashJoinGrowInner(hj);
+
+			for (i = 0; i < hj->ninnercols; i++)
+			{
+				vtype	   *col;
+				Datum		value;
+
+				if (!hj->innerNeeded[i])
+					continue;
+
+				col = tb->datagroup[i];
+				value = col->values[row];
+				hj->innerIsnull[i][hj->ninner] = col->isnull[row];
+				if (!col->isnull[row] && !hj->innerTypByVal[i])
+					value = datumCopy(value, false, hj->innerTypLen[i]);
+				hj->innerValues[i][hj->ninner] = value;
+			}
+			hj->innerHash[hj->ninner] = hashes[row];
+			hj->ninner++;
+		}
+		MemoryContextSwitchTo(oldcxt);
+	}
+
+	/* chain the build rows, nbuckets is the next power of 2 of ninner */
+	hj->nbuckets = 1024;
+	while (hj->nbuckets < (uint32) hj->ninner && hj->nbuckets < (1U << 30))
+		hj->nbuckets <<= 1;
+	mask = hj->nbuckets - 1;
+
+	oldcxt = MemoryContextSwitchTo(hj->hjcxt);
+	hj->buckets = palloc(sizeof(int) * hj->nbuckets);
+	hj->next = palloc(sizeof(int) * Max(hj->ninner, 1));
+	MemoryContextSwitchTo(oldcxt);
+
+	memset(hj->buckets, -1, sizeof(int) * hj->nbuckets);
+	for (i = 0; i < hj->ninner; i++)
+	{
+		uint32 bucket = hj->innerHash[i] & mask;
+
+		hj->next[i] = hj->buckets[bucket];
+		hj->buckets[bucket] = i;
+	}
+
+	pfree(hashes);
+	pfree(haskey);
+
+	hj->built = true;
+	node->hj_InnerEmpty = (hj->ninner == 0);
+}
+
+/*
+ * Fetch the next outer batch and hash it. Returns false at the end of the
+ * outer relation.
+ */
+static bool
+VHashJoinNextOuter(HashJoinState *node, VHashJoinData *hj)
+{
+	TupleBatch	tb;
+	uint32		mask = hj->nbuckets - 1;
+	int			i;
+
+	for (;;)
+	{
+		TupleTableSlot *slot = ExecProcNode(outerPlanState(node));
+
+		if (TupIsNull(slot))
+		{
+			hj->outerSlot = NULL;
+			hj->outerDone = true;
+			return false;
+		}
+
+		tb = (TupleBatch) slot->PRIVATE_tb;
+		if (NULL == tb || tb->nrows == 0)
+			continue;
+
+		hj->outerSlot = slot;
+		break;
+	}
+
+	VHashJoinComputeHash(hj, tb, true, 0, tb->nrows, hj->outerHash, hj->outerHasKey);
+
+	/* bring the bucket heads in before the chains are walked */
+	for (i = 0; i < tb->nrows; i++)
+	{
+		if (hj->outerHasKey[i])
+			__builtin_prefetch(&hj->buckets[hj->outerHash[i] & mask]);
+	}
+
+	hj->outerIdx = 0;
+	hj->curMatch = -1;
+	return true;
+}
+
+/*
+ * Inner join: write the matching pairs into the result batch. A result
+ * batch never spans two outer batches, so Datums of the outer side stay
+ * valid until the parent is done with it.
+ */
+static TupleTableSlot *
+VHashJoinInner(HashJoinState *node, VHashJoinData *hj)
+{
+	TupleTableSlot *resultSlot = node->js.ps.ps_ResultTupleSlot;
+	TupleBatch	restb = (TupleBatch) resultSlot->PRIVATE_tb;
+	uint32		mask = hj->nbuckets - 1;
+	int			i;
+
+	tbReset(restb);
+	restb->ncols = hj->noutcols;
+
+	for (i = 0; i < hj->noutcols; i++)
+	{
+		if (NULL == restb->datagroup[i])
+			tbCreateColumn(restb, i, resultSlot->tts_tupleDescriptor->attrs[i]->atttypid);
+	}
+
+	while (restb->nrows == 0)
+	{
+		TupleBatch	outertb;
+
+		if (NULL == hj->outerSlot && !VHashJoinNextOuter(node, hj))
+			return ExecClearTuple(resultSlot);
+
+		outertb = (TupleBatch) hj->outerSlot->PRIVATE_tb;
+
+		while (hj->outerIdx < outertb->nrows && restb->nrows < restb->batchsize)
+		{
+			int row = hj->outerIdx;
+			int match;
+
+			if (!hj->outerHasKey[row])
+			{
+				hj->outerIdx++;
+				continue;
+			}
+
+			match = (hj->curMatch >= 0) ? hj->curMatch :
+				hj->buckets[hj->outerHash[row] & mask];
+
+			for (; match >= 0 && restb->nrows < restb->batchsize; match = hj->next[match])
+			{
+				int out = restb->nrows;
+
+				if (hj->innerHash[match] != hj->outerHash[row] ||
+					!VHashJoinKeysEqual(hj, outertb, row, match))
+					continue;
+
+				for (i = 0; i < hj->noutcols; i++)
+				{
+					vtype *dst = restb->datagroup[i];
+					AttrNumber attno = hj->outAttno[i];
+
+					if (hj->outVarno[i] == INNER)
+					{
+						dst->values[out] = hj->innerValues[attno][match];
+						dst->isnull[out] = hj->innerIsnull[attno][match];
+					}
+					else
+					{
+						dst->values[out] = outertb->datagroup[attno]->values[row];
+						dst->isnull[out] = outertb->datagroup[attno]->isnull[row];
+					}
+				}
+				restb->nrows++;
+			}
+
+			/* the result batch is full, resume this chain on the next call */
+			if (match >= 0)
+			{
+				hj->curMatch = match;
+				break;
+			}
+
+			hj->curMatch = -1;
+			hj->outerIdx++;
+		}
+
+		if (hj->outerIdx >= outertb->nrows)
+			hj->outerSlot = NULL;
+	}
+
+	for (i = 0; i < hj->noutcols; i++)
+		restb->datagroup[i]->dim = restb->nrows;
+
+	TupSetVirtualTupleNValid(resultSlot, restb->ncols);
+	return resultSlot;
+}
+
+/*
+ * Semi and anti join: the result batch is the outer batch with the rows
+ * that do (JOIN_IN) or do not (JOIN_LASJ) have a match left unskipped.
+ */
+static TupleTableSlot *
+VHashJoinSemi(HashJoinState *node, VHashJoinData *hj)
+{
+	TupleTableSlot *resultSlot = node->js.ps.ps_ResultTupleSlot;
+	TupleBatch	restb = (TupleBatch) resultSlot->PRIVATE_tb;
+	TupleBatch	outertb;
+	uint32		mask = hj->nbuckets - 1;
+	bool		wantMatch = (hj->jointype == JOIN_IN);
+	int			row;
+	int			i;
+
+	if (!VHashJoinNextOuter(node, hj))
+		return ExecClearTuple(resultSlot);
+
+	outertb = (TupleBatch) hj->outerSlot->PRIVATE_tb;
+
+	tbReset(restb);
+	restb->ncols = hj->noutcols;
+	restb->nrows = outertb->nrows;
+	for (i = 0; i < hj->noutcols; i++)
+		restb->datagroup[i] = outertb->datagroup[hj->outAttno[i]];
+
+	for (row = 0; row < outertb->nrows; row++)
+	{
+		bool matched = false;
+		int match;
+
+		if (outertb->skip[row])
+		{
+			restb->skip[row] = true;
+			continue;
+		}
+
+		if (hj->outerHasKey[row])
+		{
+			for (match = hj->buckets[hj->outerHash[row] & mask]; match >= 0; match = hj->next[match])
+			{
+				if (hj->innerHash[match] == hj->outerHash[row] &&
+					VHashJoinKeysEqual(hj, outertb, row, match))
+				{
+					matched = true;
+					break;
+				}
+			}
+		}
+
+		restb->skip[row] = (matched != wantMatch);
+	}
+
+	hj->outerSlot = NULL;
+
+	TupSetVirtualTupleNValid(resultSlot, restb->ncols);
+	return resultSlot;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecVHashJoin
+ * ----------------------------------------------------------------
+ */
+TupleTableSlot *
+ExecVHashJoin(HashJoinState *node)
+{
+	VHashJoinData *hj = GetVHashJoinData(node);
+
+	Assert(NULL != hj);
+
+	if (!hj->built)
+	{
+		VHashJoinBuild(node, hj);
+
+		/*
+		 * An empty inner side produces nothing for inner and semi joins; the
+		 * outer side may be squelched right away.
+		 */
+		if (hj->ninner == 0 && hj->jointype != JOIN_LASJ)
+		{
+			ExecSquelchNode(outerPlanState(node));
+			hj->outerDone = true;
+		}
+	}
+
+	if (hj->outerDone)
+		return ExecClearTuple(node->js.ps.ps_ResultTupleSlot);
+
+	CHECK_FOR_INTERRUPTS();
+
+	if (hj->jointype == JOIN_INNER)
+		return VHashJoinInner(node, hj);
+	else
+		return VHashJoinSemi(node, hj);
+}
+
+/*
+ * ExecVHashJoinVirtualLayer
+ *		pop up one tuple at a time if the parent is not vectorized.
+ */
+TupleTableSlot *
+ExecVHashJoinVirtualLayer(HashJoinState *node)
+{
+	VectorizedState *vs = (VectorizedState *) node->js.ps.vectorized;
+
+	if (vs->parent && vs->parent->vectorized &&
+		((VectorizedState *) vs->parent->vectorized)->vectorized)
+		return ExecVHashJoin(node);
+	else
+	{
+		TupleTableSlot *slot = node->js.ps.ps_ResultTupleSlot;
+
+		while (1)
+		{
+			bool succ = VirtualNodeProc(slot);
+
+			if (!succ)
+			{
+				slot = ExecVHashJoin(node);
+				if (TupIsNull(slot))
+					break;
+				else
+					continue;
+			}
+
+			break;
+		}
+
+		return slot;
+	}
+}
+
+void
+VExecEndHashJoin(HashJoinState *node)
+{
+	VectorizedState *vs = (VectorizedState *) node->js.ps.vectorized;
+	VHashJoinData *hj = vs->hashjoin;
+
+	if (NULL == hj)
+		return;
+
+	/* semi joins borrow the columns of the outer batch, don't free them */
+	if (hj->jointype != JOIN_INNER)
+	{
+		TupleBatch restb = (TupleBatch) node->js.ps.ps_ResultTupleSlot->PRIVATE_tb;
+		int i;
+
+		for (i = 0; i < restb->ncols; i++)
+			restb->datagroup[i] = NULL;
+	}
+
+	MemoryContextDelete(hj->hjcxt);
+	pfree(hj);
+	vs->hashjoin = NULL;
+}
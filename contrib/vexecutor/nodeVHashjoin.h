@@ -0,0 +1,105 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef NODEVHASHJOIN_H
+#define NODEVHASHJOIN_H
+
+#include "postgres.h"
+#include "executor/executor.h"
+#include "executor/nodeHashjoin.h"
+#include "nodes/execnodes.h"
+
+/*
+ * The way the key of one hash clause is hashed and compared.
+ *
+ * VHJ_KEY_INT and VHJ_KEY_FLOAT are evaluated inline on the Datum values of
+ * the batch column; VHJ_KEY_GENERIC goes through the hash and equality
+ * functions of the operator, one value at a time.
+ */
+typedef enum VHashKeyKind
+{
+	VHJ_KEY_INT,
+	VHJ_KEY_FLOAT,
+	VHJ_KEY_GENERIC
+} VHashKeyKind;
+
+typedef struct VHashKeyInfo
+{
+	VHashKeyKind	kind;
+	AttrNumber		outerAttno;		/* 0-based column of the outer batch */
+	AttrNumber		innerAttno;		/* 0-based column of the build side */
+	Oid				outerType;		/* non-vectorized type of outer key */
+	Oid				innerType;		/* non-vectorized type of inner key */
+	FmgrInfo		hashfn;
+	FmgrInfo		eqfn;
+} VHashKeyInfo;
+
+/*
+ * Vectorized hash join data, hung off VectorizedState.
+ *
+ * The build side is stored column-wise: innerValues[col][row]. Only the
+ * columns referenced by the hash clauses or the target list are kept.
+ * The hash table is a chained table over the row numbers of the build
+ * side: buckets[] holds the first row of each chain, next[] the following
+ * one, -1 terminates a chain.
+ */
+typedef struct VHashJoinData
+{
+	MemoryContext	hjcxt;
+
+	JoinType		jointype;
+	int				nkeys;
+	VHashKeyInfo   *keys;
+
+	/* build side */
+	int				ninnercols;
+	bool		   *innerNeeded;
+	Datum		  **innerValues;
+	bool		  **innerIsnull;
+	int16		   *innerTypLen;
+	bool		   *innerTypByVal;
+	uint32		   *innerHash;
+	int				ninner;
+	int				innerCap;
+
+	int			   *buckets;
+	int			   *next;
+	uint32			nbuckets;
+	bool			built;
+
+	/* probe side */
+	TupleTableSlot *outerSlot;
+	uint32		   *outerHash;
+	bool		   *outerHasKey;
+	int				outerIdx;
+	int				curMatch;
+	bool			outerDone;
+
+	/* output columns, taken from the OUTER or the INNER side */
+	int				noutcols;
+	int			   *outVarno;
+	AttrNumber	   *outAttno;
+} VHashJoinData;
+
+extern void VExecInitHashJoin(HashJoinState *node);
+extern TupleTableSlot *ExecVHashJoinVirtualLayer(HashJoinState *node);
+extern TupleTableSlot *ExecVHashJoin(HashJoinState *node);
+extern void VExecEndHashJoin(HashJoinState *node);
+
+#endif
@@ -29,7 +29,8 @@ TupleTableSlot *ExecVMotion(MotionState * node);
 static void doSendTupleBatch(Motion * motion, MotionState * node, TupleTableSlot *outerTupleSlot);
 static SendReturnCode
 SendTupleBatch(MotionLayerState *mlStates, ChunkTransportState *transportStates,
-               int16 motNodeID, TupleBatch tuplebatch, int16 targetRoute);
+               int16 motNodeID, TupleBatchWire wire, TupleBatch tuplebatch,
+               int16 targetRoute);
 /*=========================================================================
  */
 
@@ -269,6 +270,7 @@ doSendTupleBatch(Motion * motion, MotionState * node, TupleTableSlot *outerTuple
     sendRC = SendTupleBatch(node->ps.state->motionlayer_context,
                             node->ps.state->interconnect_context,
                             motion->motionID,
+                            ((VectorizedState *)node->ps.vectorized)->wire,
                             outerTupleSlot->PRIVATE_tb,
                             targetRoute);
 
@@ -319,7 +321,8 @@ TupleTableSlot *execVMotionUnsortedReceiver(MotionState * node)
 
     /* store it in our result slot and return this. */
     slot = node->ps.ps_ResultTupleSlot;
-    bool succ = tbDeserialization(((MemTuple)tuple)->PRIVATE_mt_bits,&slot->PRIVATE_tb);
+    bool succ = tbDeserialization(((VectorizedState *)node->ps.vectorized)->wire,
+                                  (MemTuple)tuple,slot->PRIVATE_tb);
 
     if(!succ)
         elog(ERROR,"Deserialization process Failed");
@@ -335,6 +338,7 @@ SendReturnCode
 SendTupleBatch(MotionLayerState *mlStates,
                ChunkTransportState *transportStates,
                int16 motNodeID,
+               TupleBatchWire wire,
                TupleBatch tuplebatch,
                int16 targetRoute)
 {
@@ -356,7 +360,12 @@ SendTupleBatch(MotionLayerState *mlStates,
      */
     pMNEntry = getMotionNodeEntry(mlStates, motNodeID, "SendTuple");
 
-    MemTuple tuple = tbSerialization(tuplebatch);
+    /* the tuple is the send buffer of wire, it must not be freed */
+    MemTuple tuple = tbSerialization(wire, tuplebatch);
+
+    /* every row of the batch is skipped, nothing to send */
+    if (tuple == NULL)
+        return SEND_COMPLETE;
 
     if (targetRoute != BROADCAST_SEGIDX)
     {
@@ -388,7 +397,6 @@ SendTupleBatch(MotionLayerState *mlStates,
 
 
     SerializeTupleIntoChunks(tuple, &pMNEntry->ser_tup_info, &tcList);
-    pfree(tuple);
 
     MemoryContextSwitchTo(oldCtxt);
 
@@ -0,0 +1,103 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "orc_reader.h"
+#include "tuplebatch.h"
+
+/*
+ * The batches of an orc table are read by orcReadNextBatch, the format
+ * library hands over whole column vectors which are converted into the
+ * columns of the TupleBatch. The pass-by-reference values point into the
+ * buffers of the library, they live until the next batch is read.
+ */
+void
+BeginVScanOrcRelation(ScanState *scanState)
+{
+    orcBeginScan(scanState);
+    VectorizedState* vs = (VectorizedState*)scanState->ps.vectorized;
+    TupleBatch tb = scanState->ss_ScanTupleSlot->PRIVATE_tb;
+    vs->ao = palloc0(sizeof(aoinfo));
+    vs->ao->proj = palloc0(sizeof(bool) * tb->ncols);
+    GetNeededColumnsForScan((Node* )scanState->ps.plan->targetlist,vs->ao->proj,tb->ncols);
+    GetNeededColumnsForScan((Node* )scanState->ps.plan->qual,vs->ao->proj,tb->ncols);
+
+    vs->ao->colvalues = palloc0(sizeof(Datum *) * tb->ncols);
+    vs->ao->colnulls = palloc0(sizeof(bool *) * tb->ncols);
+}
+
+void
+EndVScanOrcRelation(ScanState *scanState)
+{
+    VectorizedState* vs = (VectorizedState*)scanState->ps.vectorized;
+
+    pfree(vs->ao->colnulls);
+    pfree(vs->ao->colvalues);
+    pfree(vs->ao->proj);
+    pfree(vs->ao);
+    orcEndScan(scanState);
+}
+
+TupleTableSlot *
+OrcVScanNext(ScanState *scanState)
+{
+    TupleTableSlot *slot = scanState->ss_ScanTupleSlot;
+    TupleBatch tb = (TupleBatch)slot->PRIVATE_tb;
+    VectorizedState* vs = scanState->ps.vectorized;
+    OrcScanDescData *scandesc = ((OrcScanState *)scanState)->scandesc;
+
+    Assert((scanState->scan_state & SCAN_SCAN) != 0);
+
+    if(vs->ao->isDone)
+    {
+        ExecClearTuple(slot);
+        return slot;
+    }
+
+    for(int i = 0;i < tb->ncols ; i ++)
+    {
+        if(!vs->ao->proj[i])
+            continue;
+
+        if(!tb->datagroup[i])
+        {
+            Oid hawqTypeID = slot->tts_tupleDescriptor->attrs[i]->atttypid;
+            tbCreateColumn(tb,i,GetVtype(hawqTypeID));
+        }
+
+        vs->ao->colvalues[i] = tb->datagroup[i]->values;
+        vs->ao->colnulls[i] = tb->datagroup[i]->isnull;
+    }
+
+    tb->nrows = orcReadNextBatch(scandesc, slot->tts_tupleDescriptor, vs->batchrows,
+                                 vs->ao->colvalues, vs->ao->colnulls);
+
+    for(int i = 0;i < tb->ncols ; i ++)
+    {
+        if(vs->ao->proj[i])
+            tb->datagroup[i]->dim = tb->nrows;
+    }
+
+    if (tb->nrows == 0)
+    {
+        vs->ao->isDone = true;
+        ExecClearTuple(slot);
+    }
+    else
+        TupSetVirtualTupleNValid(slot, tb->ncols);
+    return slot;
+}
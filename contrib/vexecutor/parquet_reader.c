@@ -29,24 +29,94 @@ ParquetRowGroupReader_ScanNextTupleBatch(
 		ParquetRowGroupReader	*rowGroupReader,
 		int						*hawqAttrToParquetColNum,
 		bool 					*projs,
+		bool					*lateproj,
+		int						batchrows,
 		TupleTableSlot 			*slot);
 
 static void
-parquet_vgetnext(ParquetScanDesc scan, ScanDirection direction, TupleTableSlot *slot);
+parquet_vgetnext(ParquetScanDesc scan, ScanDirection direction,
+				 bool *lateproj, int batchrows, TupleTableSlot *slot);
 
 TupleTableSlot *
 ParquetVScanNext(ScanState *scanState)
 {
 	Assert(IsA(scanState, TableScanState) || IsA(scanState, DynamicTableScanState));
 	ParquetScanState *node = (ParquetScanState *)scanState;
+	VectorizedState *vs = (VectorizedState *)scanState->ps.vectorized;
 	Assert(node->opaque != NULL && node->opaque->scandesc != NULL);
 
-	parquet_vgetnext(node->opaque->scandesc, node->ss.ps.state->es_direction, node->ss.ss_ScanTupleSlot);
+	parquet_vgetnext(node->opaque->scandesc, node->ss.ps.state->es_direction,
+					 vs->late ? vs->lateproj : NULL, vs->batchrows,
+					 node->ss.ss_ScanTupleSlot);
 	return node->ss.ss_ScanTupleSlot;
 }
 
+/*
+ * Read the columns left out by ParquetVScanNext for the rows of the batch
+ * which passed the qual. The column readers are moved past the other rows
+ * without decoding them; pages with no such row are not even decompressed.
+ *
+ * Must be called once for every batch returned, before the next one is read.
+ */
+void
+ParquetVScanLateMaterialize(ScanState *scanState)
+{
+	ParquetScanState *node = (ParquetScanState *)scanState;
+	VectorizedState *vs = (VectorizedState *)scanState->ps.vectorized;
+	ParquetScanDesc scan = node->opaque->scandesc;
+	TupleDesc tupDesc = scan->pqs_tupDesc;
+	TupleBatch tb = (TupleBatch)node->ss.ss_ScanTupleSlot->PRIVATE_tb;
+	int colReaderIndex = 0;
+
+	Assert(vs->late);
+
+	for(int i = 0; i < tb->ncols; i++)
+	{
+		if(scan->proj[i] == false)
+			continue;
+
+		if(vs->lateproj[i] && scan->hawqAttrToParquetColChunks[i] == 1)
+		{
+			Oid hawqTypeID = tupDesc->attrs[i]->atttypid;
+			ParquetColumnReader *reader =
+				&scan->rowGroupReader.columnReaders[colReaderIndex];
+			int j = 0;
+
+			if(!tb->datagroup[i])
+				tbCreateColumn(tb,i,hawqTypeID);
+
+			vtype* vt = tb->datagroup[i];
+			vt->dim = tb->nrows;
+
+			while(j < tb->nrows)
+			{
+				if(tb->skip[j])
+				{
+					int start = j;
+
+					while(j < tb->nrows && tb->skip[j])
+						vt->isnull[j++] = true;
+					ParquetColumnReader_skipValues(reader, j - start, hawqTypeID);
+				}
+				else
+				{
+					int start = j;
+
+					while(j < tb->nrows && !tb->skip[j])
+						j++;
+					ParquetColumnReader_readValues(reader, vt->values + start, vt->isnull + start,
+												   j - start, hawqTypeID);
+				}
+			}
+		}
+
+		colReaderIndex += scan->hawqAttrToParquetColChunks[i];
+	}
+}
+
 static void
-parquet_vgetnext(ParquetScanDesc scan, ScanDirection direction, TupleTableSlot *slot)
+parquet_vgetnext(ParquetScanDesc scan, ScanDirection direction,
+				 bool *lateproj, int batchrows, TupleTableSlot *slot)
 {
 
 	//AOTupleId aoTupleId;
@@ -78,6 +148,8 @@ parquet_vgetnext(ParquetScanDesc scan, ScanDirection direction, TupleTableSlot *
 								&scan->rowGroupReader,
 								scan->hawqAttrToParquetColChunks,
 								scan->proj,
+								lateproj,
+								batchrows,
 								slot);
 		if(row_num > 0)
 			return;
@@ -90,6 +162,10 @@ parquet_vgetnext(ParquetScanDesc scan, ScanDirection direction, TupleTableSlot *
 /*
  * Get next tuple batch from current row group into slot.
  *
+ * The columns of lateproj, if not NULL, are left for
+ * ParquetVScanLateMaterialize, their readers stay at the first row of the batch.
+ * At most batchrows rows are read.
+ *
  * Return the number of tuples fetch out.
  */
 static int
@@ -98,6 +174,8 @@ ParquetRowGroupReader_ScanNextTupleBatch(
 	ParquetRowGroupReader	*rowGroupReader,
 	int						*hawqAttrToParquetColNum,
 	bool 					*projs,
+	bool					*lateproj,
+	int						batchrows,
 	TupleTableSlot 			*slot)
 {
 	Assert(slot);
@@ -115,13 +193,13 @@ ParquetRowGroupReader_ScanNextTupleBatch(
 	TupleBatch tb = (TupleBatch )slot->PRIVATE_tb;
 
 	tb->nrows = 0;
-	if (rowGroupReader->rowRead + tb->batchsize > rowGroupReader->rowCount) {
+	if (rowGroupReader->rowRead + batchrows > rowGroupReader->rowCount) {
 		tb->nrows = rowGroupReader->rowCount-rowGroupReader->rowRead;
 		rowGroupReader->rowRead = rowGroupReader->rowCount;
 	}
 	else {
-		tb->nrows = tb->batchsize ;
-		rowGroupReader->rowRead += tb->batchsize;
+		tb->nrows = batchrows;
+		rowGroupReader->rowRead += batchrows;
 	}
 
 	int colReaderIndex = 0;
@@ -130,6 +208,12 @@ ParquetRowGroupReader_ScanNextTupleBatch(
 		if(projs[i] == false)
 			continue;
 
+		if(lateproj && lateproj[i] && hawqAttrToParquetColNum[i] == 1)
+		{
+			colReaderIndex += hawqAttrToParquetColNum[i];
+			continue;
+		}
+
 		Oid hawqTypeID = tupDesc->attrs[i]->atttypid;
 		if(!tb->datagroup[i])
 			tbCreateColumn(tb,i,hawqTypeID);
@@ -142,48 +226,48 @@ ParquetRowGroupReader_ScanNextTupleBatch(
 		ParquetColumnReader *nextReader =
 			&rowGroupReader->columnReaders[colReaderIndex];
 
+		if(hawqAttrToParquetColNum[i] == 1)
+		{
+			/* the levels and values of the batch are decoded in blocks */
+			ParquetColumnReader_readValues(nextReader, vt->values, vt->isnull, tb->nrows, hawqTypeID);
+			colReaderIndex += hawqAttrToParquetColNum[i];
+			continue;
+		}
+
 		for(int j = 0;j < tb->nrows; j++)
 		{
+			/*
+			 * Because there are some memory reused inside the whole column reader, so need
+			 * to switch the context from PerTupleContext to rowgroup->context
+			 */
+			MemoryContext oldContext = MemoryContextSwitchTo(rowGroupReader->memoryContext);
 
-			if(hawqAttrToParquetColNum[i] == 1)
+			switch(hawqTypeID)
 			{
-				ParquetColumnReader_readValue(nextReader, vt->values + j , vt->isnull + j, hawqTypeID);
+				case HAWQ_TYPE_POINT:
+					ParquetColumnReader_readPoint(nextReader, vt->values + j, vt->isnull + j);
+					break;
+				case HAWQ_TYPE_PATH:
+					ParquetColumnReader_readPATH(nextReader, vt->values + j, vt->isnull + j);
+					break;
+				case HAWQ_TYPE_LSEG:
+					ParquetColumnReader_readLSEG(nextReader, vt->values + j, vt->isnull + j);
+					break;
+				case HAWQ_TYPE_BOX:
+					ParquetColumnReader_readBOX(nextReader, vt->values + j, vt->isnull + j);
+					break;
+				case HAWQ_TYPE_CIRCLE:
+					ParquetColumnReader_readCIRCLE(nextReader, vt->values + j, vt->isnull + j);
+					break;
+				case HAWQ_TYPE_POLYGON:
+					ParquetColumnReader_readPOLYGON(nextReader, vt->values + j, vt->isnull + j);
+					break;
+				default:
+					Insist(false);
+					break;
 			}
-			else
-			{
-				/*
-				 * Because there are some memory reused inside the whole column reader, so need
-				 * to switch the context from PerTupleContext to rowgroup->context
-				 */
-				MemoryContext oldContext = MemoryContextSwitchTo(rowGroupReader->memoryContext);
 
-				switch(hawqTypeID)
-				{
-					case HAWQ_TYPE_POINT:
-						ParquetColumnReader_readPoint(nextReader, vt->values + j, vt->isnull + j);
-						break;
-					case HAWQ_TYPE_PATH:
-						ParquetColumnReader_readPATH(nextReader, vt->values + j, vt->isnull + j);
-						break;
-					case HAWQ_TYPE_LSEG:
-						ParquetColumnReader_readLSEG(nextReader, vt->values + j, vt->isnull + j);
-						break;
-					case HAWQ_TYPE_BOX:
-						ParquetColumnReader_readBOX(nextReader, vt->values + j, vt->isnull + j);
-						break;
-					case HAWQ_TYPE_CIRCLE:
-						ParquetColumnReader_readCIRCLE(nextReader, vt->values + j, vt->isnull + j);
-						break;
-					case HAWQ_TYPE_POLYGON:
-						ParquetColumnReader_readPOLYGON(nextReader, vt->values + j, vt->isnull + j);
-						break;
-					default:
-						Insist(false);
-						break;
-				}
-
-				MemoryContextSwitchTo(oldContext);
-			}
+			MemoryContextSwitchTo(oldContext);
 		}
 
 		colReaderIndex += hawqAttrToParquetColNum[i];
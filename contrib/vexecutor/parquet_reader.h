@@ -35,5 +35,6 @@
 #include "nodes/print.h"
 
 TupleTableSlot *ParquetVScanNext(ScanState *node);
+void ParquetVScanLateMaterialize(ScanState *node);
 
 #endif
@@ -17,6 +17,9 @@
  * under the License.
  */
 #include "postgres.h"
+#include "access/tuptoaster.h"
+#include "utils/datum.h"
+#include "utils/lsyscache.h"
 #include "tuplebatch.h"
 
 TupleBatch tbGenerate(int colnum,int batchsize)
@@ -73,147 +76,465 @@ void tbfreeColumn(vtype** vh,int colid)
     destroyvtype(&vh[colid]);
 }
 
-static size_t
-tbSerializationSize(TupleBatch tb)
+/*
+ * Columnar wire format of a TupleBatch, used by the vectorized motions.
+ *
+ * Only the rows not marked in skip are shipped, column by column. A batch
+ * is a MemTuple, so that it goes through the interconnect as a whole:
+ *
+ *   MemTuple length | TBWireHeader | column | column | ...
+ *
+ * and each column is
+ *
+ *   TBWireColumn | null bitmap, if any null | values
+ *
+ * Every part starts MAXALIGNed from the start of the MemTuple, and the
+ * receiver gets the MemTuple in a palloc'd buffer of its own, so values of
+ * pass-by-reference types are used in place instead of being copied out.
+ *
+ * Pass-by-value columns are shipped as whole Datums, or, with
+ * vectorized_motion_compress, as a base value and narrower deltas when the
+ * values of the batch fit (frame of reference). A column holding a single
+ * value is shipped once. Both are lossless on the Datum bits, whatever the
+ * type.
+ */
+#define TBW_MAGIC	0x56544231		/* "VTB1" */
+
+typedef enum TBWireEncoding
 {
-    //buffer size stick in the head of the buffer
-    size_t len = sizeof(size_t);
+	TBW_PLAIN,		/* a Datum per row */
+	TBW_CONST,		/* one value for all the non-null rows */
+	TBW_FOR,		/* int64 base, then 1, 2 or 4 bytes of delta per row */
+	TBW_VARLEN		/* by-reference values, an offset per row */
+} TBWireEncoding;
 
-    //get TupleBatch structure size
-    len += offsetof(TupleBatchData ,skip);
+typedef struct TBWireHeader
+{
+	uint32	magic;
+	int32	nrows;
+	int32	ncols;		/* number of columns shipped */
+} TBWireHeader;
+
+typedef struct TBWireColumn
+{
+	int16	colid;
+	uint8	encoding;
+	uint8	width;		/* bytes of delta per row for TBW_FOR */
+	Oid		elemtype;
+	int16	typlen;
+	bool	hasnull;
+	uint32	size;		/* of the whole column, header included */
+} TBWireColumn;
 
-    //get skip tag size
-    len += sizeof( bool ) * tb->nrows;
+#define TBW_BITMAPLEN(nrows)	(((nrows) + 7) / 8)
 
-    int vtypeSz = VTYPESIZE(tb->nrows);
-    //get all un-null columns data size
-    for(int i = 0;i < tb->ncols; i++ )
+extern bool vectorized_motion_compress;
+
+TupleBatchWire
+tbWireCreate(int ncols)
+{
+    TupleBatchWire wire = palloc0(sizeof(TupleBatchWireData));
+
+    wire->ncols = ncols;
+    wire->typlen = palloc0(sizeof(int16) * ncols);
+    wire->typbyval = palloc0(sizeof(bool) * ncols);
+
+    return wire;
+}
+
+/*
+ * Make room for len more bytes in the send buffer, starting MAXALIGNed.
+ * Returns the offset of the room; the buffer may move.
+ */
+static Size
+tbwReserve(TupleBatchWire wire, Size len)
+{
+    Size off = MAXALIGN(wire->len);
+
+    if (off + len > wire->buflen)
     {
-        if(tb->datagroup[i])
-        {
-            len += sizeof(int);
-            len += vtypeSz;
-        }
+        Size newlen = Max(wire->buflen * 2, MAXALIGN(off + len));
+
+        newlen = Max(newlen, 8192);
+        if (wire->buf)
+            wire->buf = repalloc(wire->buf, newlen);
+        else
+            wire->buf = palloc(newlen);
+        wire->buflen = newlen;
     }
-    return len;
+
+    /* keep the padding deterministic */
+    memset((char *) wire->buf + wire->len, 0, off - wire->len);
+    wire->len = off + len;
+
+    return off;
 }
 
-MemTuple
-tbSerialization(TupleBatch tb )
+#define TBW_PTR(wire, off)	((char *) (wire)->buf + (off))
+
+static void
+tbwTypeInfo(TupleBatchWire wire, int colid, Oid elemtype)
 {
-    MemTuple ret;
-    size_t len = 0;
-    size_t tmplen = 0;
-    //calculate total size for TupleBatch
-    size_t size = tbSerializationSize(tb);
-    //makes buffer length about 8-bytes alignment for motion
-    size = (size + 0x8) & (~0x7);
+    Oid ntype;
 
-    ret = palloc0(size);
-    unsigned char *buffer = ret->PRIVATE_mt_bits;
+    if (wire->typlen[colid] != 0)
+        return;
 
-    //copy TupleBatch header
-    memcpy(buffer,&size,sizeof(size_t));
-    buffer += sizeof(size_t);
+    ntype = GetNtype(elemtype);
+    if (!OidIsValid(ntype))
+        ntype = elemtype;
+    get_typlenbyval(ntype, &wire->typlen[colid], &wire->typbyval[colid]);
+}
+
+static void
+tbwEncodeByVal(TupleBatchWire wire, vtype *vt, const int *sel, int nsel,
+               Size coloff, bool hasnull)
+{
+    TBWireColumn *col;
+    int64 minval = 0;
+    int64 maxval = 0;
+    bool first = true;
+    uint64 range;
+    int width;
+    Size off;
+    int j;
+
+    for (j = 0; j < nsel; j++)
+    {
+        int64 v = (int64) vt->values[sel[j]];
+
+        if (hasnull && vt->isnull[sel[j]])
+            continue;
+        if (first || v < minval)
+            minval = v;
+        if (first || v > maxval)
+            maxval = v;
+        first = false;
+    }
 
-    tmplen = offsetof(TupleBatchData ,skip);
-    memcpy(buffer,tb,tmplen);
-    buffer +=tmplen;
+    range = (uint64) maxval - (uint64) minval;
+    if (range == 0)
+        width = 0;
+    else if (range <= 0xFF)
+        width = 1;
+    else if (range <= 0xFFFF)
+        width = 2;
+    else if (range <= 0xFFFFFFFF)
+        width = 4;
+    else
+        width = 8;
 
-    tmplen = sizeof(bool) * tb->nrows;
-    memcpy(buffer,tb->skip,tmplen);
-    buffer += tmplen;
+    if (!vectorized_motion_compress)
+        width = 8;
 
+    col = (TBWireColumn *) TBW_PTR(wire, coloff);
+    if (width == 0)
+    {
+        col->encoding = TBW_CONST;
+        off = tbwReserve(wire, sizeof(int64));
+        memcpy(TBW_PTR(wire, off), &minval, sizeof(int64));
+        return;
+    }
 
-    for(int i = 0;i < tb->ncols; i++ )
+    if (width == 8)
     {
-        if(tb->datagroup[i])
+        col->encoding = TBW_PLAIN;
+        off = tbwReserve(wire, sizeof(Datum) * nsel);
         {
-            memcpy(buffer,&i,sizeof(int));
-            buffer += sizeof(int);
+            Datum *dst = (Datum *) TBW_PTR(wire, off);
+
+            for (j = 0; j < nsel; j++)
+                dst[j] = vt->values[sel[j]];
+        }
+        return;
+    }
+
+    col->encoding = TBW_FOR;
+    col->width = width;
+    off = tbwReserve(wire, sizeof(int64) + width * nsel);
+    memcpy(TBW_PTR(wire, off), &minval, sizeof(int64));
+    off += sizeof(int64);
+
+    /* the deltas of the null rows are garbage, they are never read back */
+#define TBW_ENCODE_DELTA(type) \
+    do { \
+        type *dst = (type *) TBW_PTR(wire, off); \
+        for (j = 0; j < nsel; j++) \
+            dst[j] = (type) ((uint64) vt->values[sel[j]] - (uint64) minval); \
+    } while (0)
+
+    switch (width)
+    {
+        case 1:
+            TBW_ENCODE_DELTA(uint8);
+            break;
+        case 2:
+            TBW_ENCODE_DELTA(uint16);
+            break;
+        default:
+            TBW_ENCODE_DELTA(uint32);
+            break;
+    }
+#undef TBW_ENCODE_DELTA
+}
+
+static void
+tbwEncodeByRef(TupleBatchWire wire, vtype *vt, const int *sel, int nsel,
+               Size coloff, bool hasnull, int16 typlen)
+{
+    Size offsoff;
+    int j;
 
-            unsigned char* ptr = buffer;
-            memcpy(ptr,tb->datagroup[i],offsetof(vtype,isnull));
-            ptr+= offsetof(vtype,isnull);
+    ((TBWireColumn *) TBW_PTR(wire, coloff))->encoding = TBW_VARLEN;
 
-            tmplen = VDATUMSZ(tb->nrows);
-            memcpy(ptr,tb->datagroup[i]->values, tmplen);
-            ptr += tmplen;
+    offsoff = tbwReserve(wire, sizeof(uint32) * nsel);
+    for (j = 0; j < nsel; j++)
+    {
+        Pointer src;
+        Size len;
+        Size off;
 
-            tmplen = ISNULLSZ(tb->nrows);
-            memcpy(ptr,tb->datagroup[i]->isnull,tmplen);
-            buffer += VTYPESIZE(tb->nrows);
+        if (hasnull && vt->isnull[sel[j]])
+        {
+            ((uint32 *) TBW_PTR(wire, offsoff))[j] = 0;
+            continue;
         }
-    }
 
-    memtuple_set_size(ret,NULL,size);
-    return ret;
+        src = DatumGetPointer(vt->values[sel[j]]);
+
+        /* a toast pointer is meaningless on the other side */
+        if (typlen == -1 && VARATT_IS_EXTERNAL(src))
+            src = (Pointer) heap_tuple_fetch_attr((struct varlena *) src);
+
+        len = datumGetSize(PointerGetDatum(src), false, typlen);
+        off = tbwReserve(wire, len);
+        memcpy(TBW_PTR(wire, off), src, len);
+        ((uint32 *) TBW_PTR(wire, offsoff))[j] = off;
+
+        if (src != DatumGetPointer(vt->values[sel[j]]))
+            pfree(src);
+    }
 }
 
-bool tbDeserialization(unsigned char *buffer,TupleBatch* pTB )
+/*
+ * Serialize the rows of tb not marked in skip into the columnar wire format.
+ *
+ * The result is the send buffer of wire, valid until the next call, or NULL
+ * if no row is left to ship.
+ */
+MemTuple
+tbSerialization(TupleBatchWire wire, TupleBatch tb)
 {
-    size_t buflen;
-    size_t len = 0;
-    size_t tmplen = 0;
-    tmplen = sizeof(size_t);
-    TupleBatch tb;
-    memcpy(&buflen,buffer,tmplen);
-    len += tmplen;
-
-    if(buflen < sizeof(TupleBatchData))
-        return false;
+    TBWireHeader *hdr;
+    Size hdroff;
+    int nsel = 0;
+    int ncols = 0;
+    int i;
 
-    if(!*pTB)
-        tb = palloc0(sizeof(TupleBatchData));
-    else
+    if (wire->selcap < tb->nrows)
     {
-        tb = *pTB;
-        tbReset(tb);
+        if (wire->sel)
+            pfree(wire->sel);
+        wire->sel = palloc(sizeof(int) * tb->nrows);
+        wire->selcap = tb->nrows;
     }
 
-    //deserial tb main data
-    tmplen = offsetof(TupleBatchData,skip);
-    memcpy(tb,buffer + len,tmplen);
-    len += tmplen;
+    for (i = 0; i < tb->nrows; i++)
+    {
+        wire->sel[nsel] = i;
+        nsel += !tb->skip[i];
+    }
 
-    //deserial member value -- skip
-    if(tb->nrows != 0)
+    if (nsel == 0)
+        return NULL;
+
+    if (wire->ncols < tb->ncols)
     {
-        tmplen = sizeof(bool) * tb->nrows;
-        if(!tb->skip)
-            tb->skip = palloc(tmplen);
-        memcpy(tb->skip,buffer+len,tmplen);
-        len += tmplen;
+        wire->typlen = repalloc(wire->typlen, sizeof(int16) * tb->ncols);
+        wire->typbyval = repalloc(wire->typbyval, sizeof(bool) * tb->ncols);
+        memset(wire->typlen + wire->ncols, 0, sizeof(int16) * (tb->ncols - wire->ncols));
+        wire->ncols = tb->ncols;
     }
 
-    //deserial member value -- datagroup
-    if(tb->ncols != 0)
+    wire->len = offsetof(MemTupleData, PRIVATE_mt_bits);
+    hdroff = tbwReserve(wire, sizeof(TBWireHeader));
+
+    for (i = 0; i < tb->ncols; i++)
     {
-        int colid;
-        tmplen = sizeof(vtype*) * tb->ncols;
-        //the buffer length is 8-bytes alignment, 
-        //so we need align the current length before comparing.
-        if(!tb->datagroup)
-            tb->datagroup = palloc0(tmplen);
-        while (((len + 0x8) & (~0x7)) < buflen)
+        vtype *vt = tb->datagroup[i];
+        TBWireColumn *col;
+        Size coloff;
+        bool hasnull = false;
+        int j;
+
+        if (!vt)
+            continue;
+
+        tbwTypeInfo(wire, i, vt->elemtype);
+
+        for (j = 0; j < nsel && !hasnull; j++)
+            hasnull = vt->isnull[wire->sel[j]];
+
+        coloff = tbwReserve(wire, sizeof(TBWireColumn));
+        col = (TBWireColumn *) TBW_PTR(wire, coloff);
+        memset(col, 0, sizeof(TBWireColumn));
+        col->colid = i;
+        col->elemtype = vt->elemtype;
+        col->typlen = wire->typlen[i];
+        col->hasnull = hasnull;
+
+        if (hasnull)
         {
-            memcpy(&colid,buffer + len,sizeof(int));
-            len += sizeof(int);
+            Size off = tbwReserve(wire, TBW_BITMAPLEN(nsel));
+            uint8 *bits = (uint8 *) TBW_PTR(wire, off);
 
-            vtype* src = (vtype*)(buffer + len);
+            memset(bits, 0, TBW_BITMAPLEN(nsel));
+            for (j = 0; j < nsel; j++)
+                bits[j >> 3] |= vt->isnull[wire->sel[j]] << (j & 7);
+        }
+
+        if (wire->typbyval[i])
+            tbwEncodeByVal(wire, vt, wire->sel, nsel, coloff, hasnull);
+        else
+            tbwEncodeByRef(wire, vt, wire->sel, nsel, coloff, hasnull,
+                           wire->typlen[i]);
 
-            if(!tb->datagroup[colid])
-                tb->datagroup[colid] = buildvtype(src->elemtype,tb->batchsize,tb->skip);
+        ((TBWireColumn *) TBW_PTR(wire, coloff))->size = wire->len - coloff;
+        ncols++;
+    }
+
+    hdr = (TBWireHeader *) TBW_PTR(wire, hdroff);
+    hdr->magic = TBW_MAGIC;
+    hdr->nrows = nsel;
+    hdr->ncols = ncols;
+
+    /* the length of a MemTuple is a multiple of 8 */
+    tbwReserve(wire, 0);
+    wire->buf->PRIVATE_mt_len = 0;
+    memtuple_set_size(wire->buf, NULL, wire->len);
+    return wire->buf;
+}
+
+/*
+ * Deserialize a batch of the columnar wire format into the pre-allocated tb.
+ *
+ * The values of pass-by-reference columns point into tuple, which wire keeps
+ * until the next batch is received.
+ */
+bool
+tbDeserialization(TupleBatchWire wire, MemTuple tuple, TupleBatch tb)
+{
+    char *base = (char *) tuple;
+    Size len = memtuple_get_size(tuple, NULL);
+    Size off = MAXALIGN(offsetof(MemTupleData, PRIVATE_mt_bits));
+    TBWireHeader *hdr = (TBWireHeader *) (base + off);
+    int i;
+    int j;
+
+    if (len < off + sizeof(TBWireHeader) || hdr->magic != TBW_MAGIC ||
+        hdr->nrows <= 0 || hdr->nrows > tb->batchsize)
+        return false;
 
-            tmplen = VDATUMSZ(tb->nrows);
-            //in vtype pointer isnull and skipref are't serialized
-            memcpy(tb->datagroup[colid]->values,src->values - 2,tmplen);
+    tbReset(tb);
+    tb->nrows = hdr->nrows;
+    off = MAXALIGN(off + sizeof(TBWireHeader));
 
-            memcpy(tb->datagroup[colid]->isnull,(unsigned char *)(src->values - 2) + tmplen,tb->nrows * sizeof(bool));
+    for (i = 0; i < hdr->ncols; i++)
+    {
+        TBWireColumn *col = (TBWireColumn *) (base + off);
+        Size coloff = off;
+        uint8 *bits = NULL;
+        vtype *vt;
+
+        if (off + sizeof(TBWireColumn) > len || off + col->size > len ||
+            col->colid < 0 || col->colid >= tb->ncols)
+            return false;
+
+        if (!tb->datagroup[col->colid])
+            tb->datagroup[col->colid] = buildvtype(col->elemtype, tb->batchsize, tb->skip);
+        vt = tb->datagroup[col->colid];
+        vt->dim = tb->nrows;
+
+        off = MAXALIGN(off + sizeof(TBWireColumn));
+        if (col->hasnull)
+        {
+            bits = (uint8 *) (base + off);
+            for (j = 0; j < tb->nrows; j++)
+                vt->isnull[j] = (bits[j >> 3] >> (j & 7)) & 1;
+            off = MAXALIGN(off + TBW_BITMAPLEN(tb->nrows));
+        }
+        else
+            memset(vt->isnull, false, ISNULLSZ(tb->nrows));
 
-            len += VTYPESIZE(tb->nrows);
+        switch (col->encoding)
+        {
+            case TBW_PLAIN:
+                memcpy(vt->values, base + off, VDATUMSZ(tb->nrows));
+                break;
+
+            case TBW_CONST:
+            {
+                int64 v;
+
+                memcpy(&v, base + off, sizeof(int64));
+                for (j = 0; j < tb->nrows; j++)
+                    vt->values[j] = (Datum) v;
+                break;
+            }
+
+            case TBW_FOR:
+            {
+                uint64 minval;
+                char *deltas = base + off + sizeof(int64);
+
+                memcpy(&minval, base + off, sizeof(int64));
+
+#define TBW_DECODE_DELTA(type) \
+                do { \
+                    type *src = (type *) deltas; \
+                    for (j = 0; j < tb->nrows; j++) \
+                        vt->values[j] = (Datum) (minval + src[j]); \
+                } while (0)
+
+                switch (col->width)
+                {
+                    case 1:
+                        TBW_DECODE_DELTA(uint8);
+                        break;
+                    case 2:
+                        TBW_DECODE_DELTA(uint16);
+                        break;
+                    case 4:
+                        TBW_DECODE_DELTA(uint32);
+                        break;
+                    default:
+                        return false;
+                }
+#undef TBW_DECODE_DELTA
+                break;
+            }
+
+            case TBW_VARLEN:
+            {
+                uint32 *offsets = (uint32 *) (base + off);
+
+                for (j = 0; j < tb->nrows; j++)
+                    vt->values[j] = vt->isnull[j] ? (Datum) 0 :
+                                    PointerGetDatum(base + offsets[j]);
+                break;
+            }
+
+            default:
+                return false;
         }
+
+        off = MAXALIGN(coloff + col->size);
     }
-    *pTB = tb;
+
+    /* the previous batch is no longer referenced */
+    if (wire->recvtup)
+        pfree(wire->recvtup);
+    wire->recvtup = tuple;
+
     return true;
 }
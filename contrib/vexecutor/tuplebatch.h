@@ -50,7 +50,8 @@
  * datagroup's secound level pointers are null in this step. Since it does not know which column
  * should be decoded and stored. User should create column buffer manually through tbCreateColumn.
  * Before decode tuple from disk, tbRset must be invoked to clean meta info including ncols, nrows and skip.
- * tbSerialization and tbDeserialization are the pair of serialization function.
+ * tbSerialization and tbDeserialization are the pair of serialization function,
+ * they ship the batch in a columnar format, see tuplebatch.c.
  * --------
  */
 
@@ -74,9 +75,28 @@ void tbReset(TupleBatch tb);
 void tbDestroy(TupleBatch* tb);
 /* free one column */
 void tbfreeColumn(vtype** vh,int colid);
+
+/*
+ * State of one side of a vectorized motion: the type of each column, and the
+ * buffer of the last batch sent or received, which is reused.
+ */
+typedef struct TupleBatchWireData
+{
+    int         ncols;
+    int16      *typlen;     /* of the non-vectorized type, 0 if not known yet */
+    bool       *typbyval;
+    int        *sel;        /* rows of the batch being sent */
+    int         selcap;
+    MemTuple    buf;        /* send buffer */
+    Size        buflen;
+    Size        len;
+    MemTuple    recvtup;    /* batch the receiving TupleBatch points into */
+} TupleBatchWireData, *TupleBatchWire;
+
+TupleBatchWire tbWireCreate(int ncols);
 /* TupleBatch serialization function */
-MemTuple tbSerialization(TupleBatch tb);
+MemTuple tbSerialization(TupleBatchWire wire, TupleBatch tb);
 /* TupleBatch deserialization function */
-bool tbDeserialization(unsigned char *buffer,TupleBatch* pTB);
+bool tbDeserialization(TupleBatchWire wire, MemTuple tuple, TupleBatch tb);
 
 #endif
@@ -78,6 +78,16 @@ extern int BATCHSIZE;
 #define HAVE_FREESPACE(hashtable) \
    (GET_TOTAL_USED_SIZE(hashtable) < (hashtable)->max_mem)
 
+#define BUCKET_IDX(hashtable, hashkey) \
+		(((hashkey) >> (hashtable)->pshift) & ((hashtable)->nbuckets - 1))
+
+/*
+ * How many rows ahead of the current one the hash table is prefetched. The
+ * bucket slot is fetched twice as far ahead, so that it is in cache by the
+ * time the head of its chain is prefetched.
+ */
+#define VAGG_PREFETCH_DISTANCE 8
+
 
 /*
  * implement the SUM aggregate functions.
@@ -669,6 +679,150 @@ calc_hash_value(AggState* aggstate, TupleTableSlot *inputslot)
 	return (uint32) hash_any((unsigned char *) hashtable->hashkey_buf, agg->numCols * sizeof(HashKey));
 }
 
+/*
+ * Calculate the hash values of all the rows of a batch, from row start on.
+ *
+ * The result is the same as calc_hash_value() for each row, but the hash
+ * functions are applied one grouping column at a time directly on the
+ * columns of the batch. The hash values are left in vstate->hashKeys.
+ * Returns the number of rows not skipped.
+ */
+static int
+calc_hash_value_batch(AggState *aggstate, TupleBatch tb, int start)
+{
+	Agg *agg = (Agg*)aggstate->ss.ps.plan;
+	VectorizedState *vstate = ((PlanState*)aggstate)->vectorized;
+	ExprContext *econtext = aggstate->tmpcontext;
+	HashKey *keybuf = vstate->hashKeyBuf;
+	int numCols = agg->numCols;
+	MemoryContext oldContext;
+	int nvalid = 0;
+	int i;
+	int row;
+
+	Assert(tb->nrows <= vstate->hashKeyCap);
+
+	oldContext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+	for (i = 0; i < numCols; i++)
+	{
+		FmgrInfo *info = &aggstate->hashfunctions[i];
+		vtype *column = tb->datagroup[agg->grpColIdx[i] - 1];
+
+		Assert(NULL != column);
+
+		for (row = start; row < tb->nrows; row++)
+		{
+			if (tb->skip[row])
+				continue;
+
+			if (!column->isnull[row])	/* treat nulls as having hash key 0 */
+				keybuf[row * numCols + i] =
+					DatumGetUInt32(FunctionCall1(info, column->values[row]));
+			else
+				keybuf[row * numCols + i] = 0xdeadbeef;
+		}
+	}
+
+	for (row = start; row < tb->nrows; row++)
+	{
+		if (tb->skip[row])
+			continue;
+
+		vstate->hashKeys[row] = (uint32)
+			hash_any((unsigned char *) &keybuf[row * numCols],
+					 numCols * sizeof(HashKey));
+		nvalid++;
+	}
+
+	MemoryContextSwitchTo(oldContext);
+	return nvalid;
+}
+
+/*
+ * Prefetch the hash table for the rows ahead of the current one, so that
+ * the probes of a batch do not wait on a cache miss each.
+ */
+static inline void
+prefetch_hash_entries(HashAggTable *hashtable, uint32 *hashkeys,
+					  int row, int nrows)
+{
+	int ahead = row + VAGG_PREFETCH_DISTANCE;
+	unsigned int bucket_idx;
+
+	if (ahead + VAGG_PREFETCH_DISTANCE < nrows)
+	{
+		bucket_idx = BUCKET_IDX(hashtable, hashkeys[ahead + VAGG_PREFETCH_DISTANCE]);
+		__builtin_prefetch(&hashtable->buckets[bucket_idx]);
+		__builtin_prefetch(&hashtable->bloom[bucket_idx]);
+	}
+
+	if (ahead < nrows)
+	{
+		HashAggEntry *entry;
+
+		bucket_idx = BUCKET_IDX(hashtable, hashkeys[ahead]);
+		entry = hashtable->buckets[bucket_idx];
+		if (NULL != entry)
+			__builtin_prefetch(entry);
+	}
+}
+
+/*
+ * Forget the groups collected from the current batch.
+ */
+static inline void
+reset_batch_groups(VectorizedState *vstate)
+{
+	BatchAggGroupData *agg_groupdata = vstate->batchGroupData;
+
+	memset(vstate->batchGroupData, 0, sizeof(BatchAggGroupData));
+	memset(vstate->groupData, 0, sizeof(GroupData) * vstate->hashKeyCap);
+	memset(vstate->indexList, -1, sizeof(int) * vstate->hashKeyCap);
+	memset(vstate->groupSlots, -1, sizeof(int) * (vstate->groupSlotsMask + 1));
+
+	agg_groupdata->group_header = vstate->groupData;
+	agg_groupdata->idx_list = vstate->indexList;
+}
+
+/*
+ * Add row of the current batch to the group of entry.
+ *
+ * The group header of an entry is found through groupSlots, a small open
+ * addressing table from the hash value of the entry to its group header.
+ * It has at least twice as many slots as the batch has rows, so a batch
+ * spread over many groups costs one probe per row instead of a scan of all
+ * the groups found so far.
+ */
+static inline void
+add_batch_group(VectorizedState *vstate, HashAggEntry *entry, int row)
+{
+	BatchAggGroupData *agg_groupdata = vstate->batchGroupData;
+	uint32 mask = vstate->groupSlotsMask;
+	uint32 slot = entry->hashvalue & mask;
+	int hdr;
+
+	while ((hdr = vstate->groupSlots[slot]) != -1)
+	{
+		GroupData *cur_header = &(agg_groupdata->group_header[hdr]);
+
+		if (cur_header->entry == entry)
+		{
+			/* group header already exists, insert the row to the "neck" */
+			agg_groupdata->idx_list[row] = cur_header->idx;
+			cur_header->idx = row;
+			return;
+		}
+		slot = (slot + 1) & mask;
+	}
+
+	/* add a new group header */
+	hdr = agg_groupdata->group_cnt++;
+	agg_groupdata->group_header[hdr].idx = row;
+	agg_groupdata->group_header[hdr].entry = entry;
+	vstate->groupSlots[slot] = hdr;
+}
+
 /*
  * Vectorized Data
  *
@@ -928,6 +1082,37 @@ agg_retrieve_direct(AggState *aggstate)
 }
 
 
+/*
+ * Advance the aggregates of every group collected from the current batch,
+ * then forget the groups.
+ */
+static void
+advance_batch_groups(AggState *aggstate, TupleBatch tb)
+{
+	HashAggTable *hashtable = aggstate->hhashtable;
+	VectorizedState *vstate = ((PlanState*)aggstate)->vectorized;
+	VectorizedAggData *trans = (VectorizedAggData*)vstate->transdata;
+	BatchAggGroupData *agg_groupdata = vstate->batchGroupData;
+	int i;
+
+	for (i = 0; i < agg_groupdata->group_cnt; i++)
+	{
+		GroupData *cur_header = &(agg_groupdata->group_header[i]);
+		agg_groupdata->group_idx = i;
+
+		//set hashtable->groupaggs to the agg_hash_entry
+		setGroupAggs(hashtable, aggstate->hashslot->tts_mt_bind, cur_header->entry);
+
+		/* HACK... */
+		AddAggVectorizedData(aggstate, hashtable->groupaggs->aggs, trans, agg_groupdata, tb->skip, tb->nrows);
+		advance_vaggregates(aggstate, hashtable->groupaggs->aggs, &(aggstate->mem_manager));
+		RemoveAggVectorizedData(aggstate, hashtable->groupaggs->aggs);
+	}
+
+	if (agg_groupdata->group_cnt > 0)
+		reset_batch_groups(vstate);
+}
+
 /* copy from src/backend/executor/execHHashagg.c*/
 static bool
 agg_hash_initial_1pass(AggState *aggstate)
@@ -939,7 +1124,6 @@ agg_hash_initial_1pass(AggState *aggstate)
 	bool tuple_remaining = true;
 	MemTupleBinding *mt_bind = aggstate->hashslot->tts_mt_bind;
 	VectorizedState *vstate = ((PlanState*)aggstate)->vectorized;
-	VectorizedAggData *trans = (VectorizedAggData*)vstate->transdata;
 
 	Assert(hashtable);
 	AssertImply(!streaming, hashtable->state == HASHAGG_BEFORE_FIRST_PASS);
@@ -1007,8 +1191,7 @@ agg_hash_initial_1pass(AggState *aggstate)
 		HashAggEntry *entry;
 		TupleBatch tb;
 		int i = 0;
-		BatchAggGroupData *agg_groupdata;
-		GroupData *cur_header = NULL;
+		int aggno;
 
 		/* no more tuple. Done */
 		if (TupIsNull(outerslot))
@@ -1017,17 +1200,6 @@ agg_hash_initial_1pass(AggState *aggstate)
 			break;
 		}
 
-		Assert(NULL != vstate->batchGroupData);
-		Assert(NULL != vstate->groupData);
-		Assert(NULL != vstate->indexList);
-		memset(vstate->batchGroupData, 0, sizeof(BatchAggGroupData));
-		memset(vstate->groupData, 0, sizeof(GroupData) * BATCHSIZE);
-		memset(vstate->indexList, -1, sizeof(int) * BATCHSIZE);
-
-		agg_groupdata = vstate->batchGroupData;
-		agg_groupdata->group_header = vstate->groupData;
-		agg_groupdata->idx_list = vstate->indexList;
-
 		tb = (TupleBatch)outerslot->PRIVATE_tb;
 
 		if(NULL == tb || tb->nrows == 0)
@@ -1036,46 +1208,63 @@ agg_hash_initial_1pass(AggState *aggstate)
 			break;
 		}
 
+		if (aggstate->hashslot->tts_tupleDescriptor == NULL)
+		{
+			int size;
+
+			/* Initialize hashslot by cloning input slot. */
+			ExecSetSlotDescriptor(aggstate->hashslot, outerslot->tts_tupleDescriptor);
+			ExecStoreAllNullTuple(aggstate->hashslot);
+			mt_bind = aggstate->hashslot->tts_mt_bind;
+
+			size = ((Agg *)aggstate->ss.ps.plan)->numCols * sizeof(HashKey);
+
+			hashtable->hashkey_buf = (HashKey *)palloc0(size);
+			hashtable->mem_for_metadata += size;
+		}
+
+		reset_batch_groups(vstate);
+
 		/*
-		 * we have to convert the vectorized tuple to non-vectorized tuple,
-		 * and process it one by one.
-		 * the initialize value of i is -1, because outerslot may have no
-		 * valid tuple(all tuple can not pass the qualification), then -1
-		 * indicate that no valid tuple. if there have valid tuple, we will
-		 * reset the i to correct value.
+		 * Hash the grouping keys of the whole batch first. A batch kept in
+		 * prev_slot is resumed from the row it stopped at.
 		 */
+		if (calc_hash_value_batch(aggstate, tb, tb->iter) == 0)
+		{
+			/* all tuple in outerslot is invalid, we need not to process it. */
+			outerslot = ExecProcNode(outerPlanState(aggstate));
+			continue;
+		}
 
-		for (i = -1; i < tb->nrows; i++)
+		/* To avoid wasteful duplication of work, we do the projection here */
+		tmpcontext->ecxt_scantuple = outerslot;
+		for (aggno = 0; aggno < aggstate->numaggs; aggno++)
 		{
-			if(!VirtualNodeProc(outerslot))
-				break;
+			AggStatePerAgg peraggstate = &aggstate->peragg[aggno];
+
+			/* Evaluate the current input expressions for this aggregate */
+			vstate->aggslot[aggno] = ExecVProject(peraggstate->evalproj, NULL);
+		}
 
-			/* set the correct value */
+		/*
+		 * we have to convert the vectorized tuple to non-vectorized tuple,
+		 * to find the hash entry of each row, and link the rows of the
+		 * batch by group.
+		 */
+		while (VirtualNodeProc(outerslot))
+		{
 			i = tb->iter - 1;
 
 			Gpmon_M_Incr(GpmonPktFromAggState(aggstate), GPMON_QEXEC_M_ROWSIN);
 
-			if (aggstate->hashslot->tts_tupleDescriptor == NULL)
-			{
-				int size;
-
-				/* Initialize hashslot by cloning input slot. */
-				ExecSetSlotDescriptor(aggstate->hashslot, outerslot->tts_tupleDescriptor);
-				ExecStoreAllNullTuple(aggstate->hashslot);
-				mt_bind = aggstate->hashslot->tts_mt_bind;
-
-				size = ((Agg *)aggstate->ss.ps.plan)->numCols * sizeof(HashKey);
-
-				hashtable->hashkey_buf = (HashKey *)palloc0(size);
-				hashtable->mem_for_metadata += size;
-			}
+			prefetch_hash_entries(hashtable, vstate->hashKeys, i, tb->nrows);
 
 			/* set up for advance_aggregates call */
 			tmpcontext->ecxt_scantuple = outerslot;
 
 			/* Find or (if there's room) build a hash table entry for the
 			 * input tuple's group. */
-			hashkey = calc_hash_value(aggstate, outerslot);
+			hashkey = vstate->hashKeys[i];
 			entry = lookup_agg_hash_entry(aggstate, (void *)outerslot,
 										  INPUT_RECORD_TUPLE, 0, hashkey, 0, &isNew);
 
@@ -1090,12 +1279,20 @@ agg_hash_initial_1pass(AggState *aggstate)
 									 ERRMSG_GP_INSUFFICIENT_STATEMENT_MEMORY));
 
 				/*
-				 * If stream_bottom is on, we store outerslot into hashslot, so that
-				 * we can process it later.
+				 * The rows already linked to a group have to be aggregated
+				 * now: their entries are gone once the hash table is
+				 * spilled or streamed out.
+				 */
+				advance_batch_groups(aggstate, tb);
+
+				/*
+				 * If stream_bottom is on, we keep outerslot in prev_slot,
+				 * and the batch is resumed from this row later.
 				 */
 				if (streaming)
 				{
 					Assert(tuple_remaining);
+					tb->iter = i;
 					hashtable->prev_slot = outerslot;
 					break;
 				}
@@ -1120,77 +1317,26 @@ agg_hash_initial_1pass(AggState *aggstate)
 									  &(aggstate->mem_manager));
 			}
 
-			//find current group_header if exists, just O(n) find
-			for (int j = 0; j < agg_groupdata->group_cnt; j++)
-			{
-				cur_header = NULL;
-				if (agg_groupdata->group_header[j].entry == entry)
-				{
-					cur_header = &(agg_groupdata->group_header[j]);
-					break;
-				}
-			}
-
-			if (cur_header == NULL)
-			{
-				// add a new group header
-				agg_groupdata->group_header[agg_groupdata->group_cnt].idx = i;
-				agg_groupdata->group_header[agg_groupdata->group_cnt].entry = entry;
-				agg_groupdata->group_cnt++;
-			}
-			else
-			{
-				//group header already exists, just insert the current tuple to the "neck"
-				agg_groupdata->idx_list[i] = cur_header->idx;
-				cur_header->idx = i;
-			}
+			add_batch_group(vstate, entry, i);
 		}
 
-		/*
-		 * if i == -1, it indicate that all tuple in outerslot is invalid,
-		 * we need not to process it.
-		 */
-		if(-1 != i)
-		{
-			tmpcontext->ecxt_scantuple = outerslot;
-
-			/* To avoid wasteful duplication of work, we do the projection here */
-			int aggno;
-			for (aggno = 0; aggno < aggstate->numaggs; aggno++)
-			{
-				AggStatePerAgg peraggstate = &aggstate->peragg[aggno];
-
-				/* Evaluate the current input expressions for this aggregate */
-				vstate->aggslot[aggno] = ExecVProject(peraggstate->evalproj, NULL);
-			}
-
-			/* we have known the group counts, so we process it one by one. */
-			for (int i = 0; i < agg_groupdata->group_cnt; i++) {
-				GroupData *cur_header = &(agg_groupdata->group_header[i]);
-				agg_groupdata->group_idx = i;
-
-				//set hashtable->groupaggs to the agg_hash_entry
-				setGroupAggs(hashtable, aggstate->hashslot->tts_mt_bind, cur_header->entry);
-
-				/* HACK... */
-				AddAggVectorizedData(aggstate, hashtable->groupaggs->aggs, trans, agg_groupdata, tb->skip, tb->nrows);
-				advance_vaggregates(aggstate, hashtable->groupaggs->aggs, &(aggstate->mem_manager));
-				RemoveAggVectorizedData(aggstate, hashtable->groupaggs->aggs);
+		if (hashtable->prev_slot == outerslot)
+			break;
 
-			}
+		/* we have known the group counts, so we process it one by one. */
+		advance_batch_groups(aggstate, tb);
 
-			/* it is batch count now */
-			hashtable->num_tuples++;
+		/* it is batch count now */
+		hashtable->num_tuples++;
 
-			/* Reset per-input-tuple context after each tuple */
-			ResetExprContext(tmpcontext);
+		/* Reset per-input-tuple context after each tuple */
+		ResetExprContext(tmpcontext);
 
-			if (streaming && !HAVE_FREESPACE(hashtable))
-			{
-				Assert(tuple_remaining);
-				ExecClearTuple(aggstate->hashslot);
-				break;
-			}
+		if (streaming && !HAVE_FREESPACE(hashtable))
+		{
+			Assert(tuple_remaining);
+			ExecClearTuple(aggstate->hashslot);
+			break;
 		}
 
 		/* Read the next tuple */
@@ -19,17 +19,23 @@
 
 #include "postgres.h"
 #include "access/htup.h"
+#include "access/plugstorage.h"
 #include "catalog/catquery.h"
+#include "catalog/pg_class.h"
 #include "catalog/pg_operator.h"
 #include "catalog/pg_proc.h"
 #include "cdb/cdbappendonlyam.h"
 #include "cdb/cdbllize.h"
+#include "parser/parse_func.h"
 #include "parser/parse_oper.h"
 #include "nodes/makefuncs.h"
 #include "nodes/primnodes.h"
 #include "nodes/plannodes.h"
 #include "nodes/relation.h"
+#include "optimizer/var.h"
 #include "optimizer/walkers.h"
+#include "parser/parsetree.h"
+#include "miscadmin.h"
 #include "utils/lsyscache.h"
 #include "utils/syscache.h"
 #include "vcheck.h"
@@ -279,23 +285,85 @@ CheckVectorizedExpression(Node *node, VectorizedContext *ctx)
 
 	/*
 	 * if there are const in expressions, it may need to convert
-	 * type implicitly by FuncExpr, we only check if the arguments
-	 * of the FuncExpr is constant.
+	 * type implicitly by FuncExpr, a function of constants only is
+	 * evaluated as it is. Otherwise, there must exists a function of
+	 * the same name taking the vectorized arguments, such as a cast
+	 * or date_part, see vtype_ext.c.
 	 */
 	if(IsA(node, FuncExpr))
 	{
 		FuncExpr *f = (FuncExpr*)node;
 		ListCell *l = NULL;
-		Node* expr = NULL;
+		Oid argtypes[FUNC_MAX_ARGS];
+		int nargs = 0;
+		bool allconst = true;
+		Oid rettype, vfunc;
 
-		if(1 != list_length(f->args))
+		if(f->funcretset || list_length(f->args) > FUNC_MAX_ARGS)
 			return true;
 
-		expr = (Node*)linitial(f->args);
-		if(!IsA(expr, Const))
+		foreach(l, f->args)
+		{
+			Node *expr = (Node*)lfirst(l);
+
+			if(CheckVectorizedExpression(expr, ctx))
+				return true;
+			if(!IsA(expr, Const))
+				allconst = false;
+			argtypes[nargs++] = ctx->retType;
+		}
+
+		if(allconst)
+		{
+			ctx->retType = f->funcresulttype;
+			return false;
+		}
+
+		rettype = GetVtype(f->funcresulttype);
+		if(InvalidOid == rettype)
+			return true;
+
+		vfunc = LookupFuncName(list_make1(makeString(get_func_name(f->funcid))),
+							   nargs, argtypes, true);
+		if(InvalidOid == vfunc || get_func_rettype(vfunc) != rettype)
+			return true;
+
+		if(ctx->replace)
+		{
+			f->funcid = vfunc;
+			f->funcresulttype = rettype;
+		}
+
+		ctx->retType = rettype;
+		return false;
+	}
+
+	/*
+	 * A binary compatible cast, e.g. varchar to text. The values of
+	 * the vectorized types are binary compatible as well.
+	 */
+	if(IsA(node, RelabelType))
+	{
+		RelabelType *r = (RelabelType*)node;
+		Oid rettype;
+
+		if(CheckVectorizedExpression((Node*)r->arg, ctx))
+			return true;
+
+		if(IsA(r->arg, Const))
+		{
+			ctx->retType = r->resulttype;
+			return false;
+		}
+
+		rettype = GetVtype(r->resulttype);
+		if(InvalidOid == rettype)
 			return true;
 
-		ctx->retType = f->funcresulttype;
+		if(ctx->replace)
+			r->resulttype = rettype;
+
+		ctx->retType = rettype;
 		return false;
 	}
 	
@@ -309,6 +377,170 @@ CheckVectorizedExpression(Node *node, VectorizedContext *ctx)
 	return plan_tree_walker(node, CheckVectorizedExpression, ctx);;
 }
 
+/*
+ * The vectorized hash join supports inner, semi and anti joins whose hash
+ * clauses compare two plain columns, whose target list only contains plain
+ * columns and that have no other join qualification. The build side is not
+ * spilled, so the inner relation has to fit in work_mem.
+ */
+static bool
+CheckHashJoinVectorized(HashJoin *hj)
+{
+	Plan *inner = innerPlan(hj);
+	ListCell *lc;
+	JoinType jointype = hj->join.jointype;
+
+	if(jointype != JOIN_INNER && jointype != JOIN_IN && jointype != JOIN_LASJ)
+		return false;
+
+	if(NULL != hj->join.joinqual || NULL != hj->join.plan.qual)
+		return false;
+
+	if(NULL == hj->hashclauses)
+		return false;
+
+	foreach(lc, hj->hashclauses)
+	{
+		OpExpr *op = (OpExpr*)lfirst(lc);
+		if(!IsA(op, OpExpr) || 2 != list_length(op->args) ||
+		   !IsA(linitial(op->args), Var) || !IsA(lsecond(op->args), Var))
+			return false;
+	}
+
+	foreach(lc, hj->join.plan.targetlist)
+	{
+		TargetEntry *tle = (TargetEntry*)lfirst(lc);
+		if(!IsA(tle->expr, Var))
+			return false;
+		/* semi and anti joins only return the outer side */
+		if(jointype != JOIN_INNER && ((Var*)tle->expr)->varno != OUTER)
+			return false;
+	}
+
+	if(NULL == inner || !IsA(inner, Hash))
+		return false;
+
+	foreach(lc, inner->targetlist)
+	{
+		TargetEntry *tle = (TargetEntry*)lfirst(lc);
+		if(!IsA(tle->expr, Var))
+			return false;
+	}
+
+	if(inner->plan_rows * (inner->plan_width + sizeof(Datum)) > (double)work_mem * 1024L)
+		return false;
+
+	return true;
+}
+
+/*
+ * An Append returns the batches of its children as they are, so all of them
+ * must be vectorized and the Append must not project, see append_need_prj.
+ */
+static bool
+CheckAppendVectorized(Append *append)
+{
+	ListCell *lc;
+	int attno = 1;
+
+	foreach(lc, append->appendplans)
+	{
+		if(!((Plan*)lfirst(lc))->vectorized)
+			return false;
+	}
+
+	if(append->isTarget)
+		return false;
+	if(!append->isZapped)
+		return true;
+
+	if(NULL != append->plan.qual)
+		return false;
+
+	foreach(lc, append->plan.targetlist)
+	{
+		TargetEntry *tle = (TargetEntry*)lfirst(lc);
+
+		if(!IsA(tle->expr, Var) || ((Var*)tle->expr)->varattno != attno)
+			return false;
+		attno++;
+	}
+
+	return true;
+}
+
+/*
+ * The vectorized scans read append only, parquet and orc tables only, so a
+ * dynamic scan is vectorized if every leaf partition of its table is stored
+ * in one of them. The partitions are opened one by one at run time, the
+ * columns are remapped for the ones of another layout.
+ */
+static bool
+CheckDynamicTableScanVectorized(PlannerInfo *root, Scan *scan)
+{
+	List *rtable;
+	RangeTblEntry *rte;
+	List *relids;
+	ListCell *lc;
+	bool result = true;
+
+	if(NULL == root || NULL == root->glob)
+		return false;
+
+	rtable = (NIL != root->glob->finalrtable) ? root->glob->finalrtable : root->parse->rtable;
+	if(scan->scanrelid <= 0 || scan->scanrelid > list_length(rtable))
+		return false;
+
+	rte = rt_fetch(scan->scanrelid, rtable);
+	if(rte->rtekind != RTE_RELATION)
+		return false;
+
+	relids = find_all_inheritors(rte->relid);
+	foreach(lc, relids)
+	{
+		Oid relid = lfirst_oid(lc);
+		char relstorage;
+
+		if(has_subclass(relid))
+			continue;
+
+		relstorage = get_rel_relstorage(relid);
+		if(relstorage != RELSTORAGE_AOROWS && relstorage != RELSTORAGE_PARQUET &&
+		   relstorage != RELSTORAGE_ORC)
+		{
+			result = false;
+			break;
+		}
+	}
+
+	list_free(relids);
+	return result;
+}
+
+/*
+ * An external scan is vectorized unless it runs on the master or needs the
+ * ctid of its rows. The formats of the custom protocols are read row by row
+ * into the batches, a pluggable format only if it reads whole batches.
+ */
+static bool
+CheckExternalScanVectorized(ExternalScan *scan)
+{
+	int formatterType = ExternalTableType_Invalid;
+	char *formatterName = NULL;
+
+	if(!IsA(scan, ExternalScan) || scan->isMasterOnly ||
+	   contain_ctid_var_reference(&scan->scan))
+		return false;
+
+	getExternalTableTypeList(scan->fmtType, scan->fmtOpts,
+							 &formatterType, &formatterName);
+
+	if(formatterType == ExternalTableType_PLUG)
+		return OidIsValid(LookupPlugStorageValidatorFunc(formatterName, "getnext_batch"));
+
+	return formatterType != ExternalTableType_Invalid;
+}
+
 /*
  * check an plan node, all the expressions in it should be checked
  * set the flag if an plan node can be vectorized
@@ -336,6 +568,26 @@ CheckPlanNodeWalker(PlannerInfo *root, Plan *plan)
 		return true;
 	}
 
+	if(IsA(plan, Append) && !CheckAppendVectorized((Append*)plan))
+	{
+		plan->vectorized = false;
+		return true;
+	}
+
+	if(IsA(plan, DynamicTableScan) &&
+	   !CheckDynamicTableScanVectorized(root, (Scan*)plan))
+	{
+		plan->vectorized = false;
+		return true;
+	}
+
+	if(IsA(plan, ExternalScan) &&
+	   !CheckExternalScanVectorized((ExternalScan*)plan))
+	{
+		plan->vectorized = false;
+		return true;
+	}
+
 	/* the result of aggregate functions is scalar */
 	if(IsA(plan, Motion) && IsA((plan->lefttree), Agg))
 	{
@@ -343,6 +595,12 @@ CheckPlanNodeWalker(PlannerInfo *root, Plan *plan)
 		return true;
 	}
 
+	if(IsA(plan, HashJoin) && !CheckHashJoinVectorized((HashJoin*)plan))
+	{
+		plan->vectorized = false;
+		return true;
+	}
+
 	/* Don't support SORT Aggregate so far */
 	if(IsA(plan, Agg) && ((Agg*)plan)->aggstrategy == AGG_SORTED)
 		return true;
@@ -387,8 +645,19 @@ CheckPlanVectorzied(PlannerInfo *root, Plan *plan)
 
 	CheckPlanVectorzied(root, plan->lefttree);
 	CheckPlanVectorzied(root, plan->righttree);
+	if(IsA(plan, Append))
+	{
+		ListCell *lc;
+
+		foreach(lc, ((Append*)plan)->appendplans)
+			CheckPlanVectorzied(root, (Plan*)lfirst(lc));
+	}
 	CheckPlanNodeWalker(root, plan);
 
+	/* only the vectorized hash join knows how to read a vectorized Hash */
+	if(IsA(plan, HashJoin) && !plan->vectorized && NULL != plan->righttree)
+		plan->righttree->vectorized = false;
+
 	return plan;
 }
 
@@ -434,6 +703,13 @@ ReplacePlanVectorzied(PlannerInfo *root, Plan *plan)
 
 	ReplacePlanVectorzied(root, plan->lefttree);
 	ReplacePlanVectorzied(root, plan->righttree);
+	if(IsA(plan, Append))
+	{
+		ListCell *lc;
+
+		foreach(lc, ((Append*)plan)->appendplans)
+			ReplacePlanVectorzied(root, (Plan*)lfirst(lc));
+	}
 	ReplacePlanNodeWalker(root, plan);
 
 	return plan;
@@ -25,11 +25,59 @@
 #include "tuplebatch.h"
 #include "nodes/execnodes.h"
 
+struct VHashJoinData;
+struct TupleBatchWireData;
+
+/*
+ * The pass-by-reference values of a column of the current batch, packed
+ * into one buffer: the value of row i is at data + offsets[i].
+ */
+typedef struct aovarbuf {
+	char *data;
+	Size len;
+	Size cap;
+	Size *offsets;
+} aovarbuf;
+
 typedef struct aoinfo {
 	bool* proj;
 	bool isDone;
+
+	/* one per column, only set for the projected pass-by-reference ones */
+	aovarbuf *varbufs;
+
+	/* for late materialization, a copy of each row of the current batch */
+	MemTuple *tuples;
+	MemoryContext tuplecxt;
+
+	/* for orc and external tables, the vectors of the columns the batch is read into */
+	Datum **colvalues;
+	bool **colnulls;
+
+	/* for external tables read row by row, holds the values of the current batch */
+	MemoryContext batchcxt;
 } aoinfo;
 
+/*
+ * Batch sizing of a vectorized scan, see execVScan.c. The widths are the
+ * bytes per row of the decoded columns in the batch.
+ */
+typedef struct VBatchSizing {
+	int qualwidth;			/* of the columns of the qual, or of all */
+	int latewidth;			/* of the columns decoded for passed rows only */
+	int capacity;			/* batchsize of the scan TupleBatch */
+	int initrows;
+	int minrows;
+	int maxrows;
+	int nretunes;
+	int64 nbatches;
+	int64 rowsin;			/* scanned and passed rows, in total */
+	int64 rowsout;
+	int winbatches;			/* since the last re-tune */
+	int64 winrowsin;
+	int64 winrowsout;
+} VBatchSizing;
+
 /* vectorized executor state */
 typedef struct VectorizedState
 {
@@ -38,6 +86,12 @@ typedef struct VectorizedState
 
 	/* for table scan */
 	aoinfo *ao;
+	bool late;				/* decode lateproj columns after the qual */
+	bool *lateproj;			/* projected columns not referenced by the qual */
+	int batchrows;			/* rows per batch read by the scan */
+	VBatchSizing *sizing;
+	struct VQualProgram *qualprog;	/* the qual compiled into kernels */
+	bool qualcompiled;			/* qualprog was set up */
 
 	/* for aggregate */
 	void *transdata;
@@ -45,6 +99,17 @@ typedef struct VectorizedState
 	BatchAggGroupData *batchGroupData;
 	GroupData *groupData;
 	int *indexList;
+	uint32 *hashKeys;		/* hash value of each row of the batch */
+	HashKey *hashKeyBuf;	/* hash of each grouping key of each row */
+	int hashKeyCap;			/* rows hashKeys and groupData can hold */
+	int *groupSlots;		/* group header of an entry, by hash value */
+	uint32 groupSlotsMask;
+
+	/* for hash join */
+	struct VHashJoinData *hashjoin;
+
+	/* for motion */
+	struct TupleBatchWireData *wire;
 }VectorizedState;
 
 
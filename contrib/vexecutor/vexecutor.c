@@ -33,12 +33,19 @@
 #include "execVQual.h"
 #include "vexecutor.h"
 #include "nodeVMotion.h"
+#include "nodeVHashjoin.h"
+#include "nodeVDynamicTableScan.h"
 #include "vagg.h"
+#include "vkernel.h"
 
 PG_MODULE_MAGIC;
 int BATCHSIZE = 1024;
 static int MINBATCHSIZE = 1;
 static int MAXBATCHSIZE = 4096;
+bool vectorized_motion_compress = true;
+bool vectorized_batch_adaptive = true;
+int vectorized_batch_cache_size = 256;
+bool vectorized_qual_compile = true;
 /*
  * hook function
  */
@@ -65,6 +72,8 @@ _PG_init(void)
 	vmthd.ExecEndNode_Hook = VExecEndNode;
 	vmthd.GetNType = GetNtype;
 
+	vkernel_init();
+
 	vmthd.vectorized_executor_enable = true;
 	DefineCustomBoolVariable("vectorized_executor_enable",
 	                         gettext_noop("enable vectorized executor"),
@@ -80,6 +89,35 @@ _PG_init(void)
                             MINBATCHSIZE,MAXBATCHSIZE,
 							PGC_USERSET,
 							NULL,NULL);
+
+	DefineCustomBoolVariable("vectorized_batch_adaptive",
+	                         gettext_noop("size the batches of vectorized scans from the width of their columns"),
+	                         NULL,
+	                         &vectorized_batch_adaptive,
+	                         PGC_USERSET,
+	                         NULL,NULL);
+
+	DefineCustomIntVariable("vectorized_batch_cache_size",
+							gettext_noop("set the cache footprint targeted by adaptive batch sizing, in kB"),
+							NULL,
+							&vectorized_batch_cache_size,
+							16,65536,
+							PGC_USERSET,
+							NULL,NULL);
+
+	DefineCustomBoolVariable("vectorized_qual_compile",
+	                         gettext_noop("compile the quals of vectorized scans into fused kernels"),
+	                         NULL,
+	                         &vectorized_qual_compile,
+	                         PGC_USERSET,
+	                         NULL,NULL);
+
+	DefineCustomBoolVariable("vectorized_motion_compress",
+	                         gettext_noop("compress the batches sent by vectorized motions"),
+	                         NULL,
+	                         &vectorized_motion_compress,
+	                         PGC_USERSET,
+	                         NULL,NULL);
 }
 
 /*
@@ -194,6 +232,40 @@ VExecVecTableScan(PlanState *node, PlanState *parentNode, EState *eState,int efl
 	return;
 }
 
+/*
+ * The batches of a dynamic scan are made per partition, once the columns of
+ * the partition are known, see nodeVDynamicTableScan.c.
+ */
+static void
+VExecVecDynamicTableScan(PlanState *node, PlanState *parentNode, EState *eState,int eflags)
+{
+	/* if V->N */
+	if( NULL == parentNode ||
+		NULL == parentNode->vectorized ||
+		!((VectorizedState *)parentNode->vectorized)->vectorized)
+	{
+		BackportTupleDescriptor(node,node->ps_ResultTupleSlot->tts_tupleDescriptor);
+		ExecAssignResultType(node, node->ps_ResultTupleSlot->tts_tupleDescriptor);
+	}
+}
+
+/*
+ * An Append returns the slots of its children as they are. Below a normal
+ * node it is not vectorized, each child then translates its batches itself.
+ */
+static void
+VExecVecAppend(PlanState *node, PlanState *parentNode, EState *eState,int eflags)
+{
+	if( NULL == parentNode ||
+		NULL == parentNode->vectorized ||
+		!((VectorizedState *)parentNode->vectorized)->vectorized)
+	{
+		((VectorizedState *)node->vectorized)->vectorized = false;
+		BackportTupleDescriptor(node,node->ps_ResultTupleSlot->tts_tupleDescriptor);
+		ExecAssignResultType(node, node->ps_ResultTupleSlot->tts_tupleDescriptor);
+	}
+}
+
 static void
 VExecVecAgg(PlanState *node, PlanState *parentNode, EState *eState,int eflags)
 {
@@ -215,6 +287,22 @@ VExecVecAgg(PlanState *node, PlanState *parentNode, EState *eState,int eflags)
 	vstate->batchGroupData = (BatchAggGroupData*)palloc0(sizeof(BatchAggGroupData));
 	vstate->groupData = (GroupData*)palloc0(sizeof(GroupData) * BATCHSIZE);
 	vstate->indexList = (int*)palloc0(sizeof(int) * BATCHSIZE);
+	vstate->hashKeyCap = BATCHSIZE;
+
+	if (((Agg*)node->plan)->aggstrategy == AGG_HASHED)
+	{
+		int numCols = ((Agg*)node->plan)->numCols;
+		int nslots = 2;
+
+		/* group slots are kept at most half full */
+		while (nslots < 2 * BATCHSIZE)
+			nslots <<= 1;
+
+		vstate->hashKeys = (uint32*)palloc0(sizeof(uint32) * BATCHSIZE);
+		vstate->hashKeyBuf = (HashKey*)palloc0(sizeof(HashKey) * BATCHSIZE * numCols);
+		vstate->groupSlots = (int*)palloc(sizeof(int) * nslots);
+		vstate->groupSlotsMask = nslots - 1;
+	}
 
 	return;
 }
@@ -239,7 +327,32 @@ VExecVecMotion(PlanState *node, PlanState *parentNode, EState *eState,int eflags
 	}
 	else
 	{
+		TupleDesc td = node->ps_ResultTupleSlot->tts_tupleDescriptor;
+
 		((VectorizedState *)node->vectorized)->vectorized = true;
+		((VectorizedState *)node->vectorized)->wire = tbWireCreate(td->natts);
+
+		/* received batches are decoded into this one */
+		if (((MotionState *)node)->mstype == MOTIONSTATE_RECV)
+			node->ps_ResultTupleSlot->PRIVATE_tb = PointerGetDatum(tbGenerate(td->natts,BATCHSIZE));
+	}
+}
+
+static void
+VExecVecHashJoin(PlanState *node, PlanState *parentNode, EState *eState,int eflags)
+{
+	TupleDesc td = node->ps_ResultTupleSlot->tts_tupleDescriptor;
+	node->ps_ResultTupleSlot->PRIVATE_tb = PointerGetDatum(tbGenerate(td->natts,BATCHSIZE));
+
+	VExecInitHashJoin((HashJoinState *)node);
+
+	/* if V->N */
+	if( NULL == parentNode ||
+		NULL == parentNode->vectorized ||
+		!((VectorizedState *)parentNode->vectorized)->vectorized)
+	{
+		BackportTupleDescriptor(node,node->ps_ResultTupleSlot->tts_tupleDescriptor);
+		ExecAssignResultType(node, node->ps_ResultTupleSlot->tts_tupleDescriptor);
 	}
 }
 
@@ -280,6 +393,37 @@ VExecVecNode(PlanState *node, PlanState *parentNode, EState *eState,int eflags)
 					VExecVecTableScan(node, parentNode, eState, eflags);
 			}
 			break;
+		case T_ExternalScanState:
+			/* the scan state of an external table starts with a ScanState too */
+			if(Gp_role != GP_ROLE_DISPATCH && vstate->vectorized)
+			{
+				if(HAS_EXECUTOR_MEMORY_ACCOUNT(plan, ExternalScan))
+				{
+					START_MEMORY_ACCOUNT(plan->memoryAccount);
+					VExecVecTableScan(node, parentNode, eState, eflags);
+					END_MEMORY_ACCOUNT();
+				}
+				else
+					VExecVecTableScan(node, parentNode, eState, eflags);
+			}
+			break;
+		case T_DynamicTableScanState:
+			if(Gp_role != GP_ROLE_DISPATCH && vstate->vectorized)
+			{
+				if(HAS_EXECUTOR_MEMORY_ACCOUNT(plan, DynamicTableScan))
+				{
+					START_MEMORY_ACCOUNT(plan->memoryAccount);
+					VExecVecDynamicTableScan(node, parentNode, eState, eflags);
+					END_MEMORY_ACCOUNT();
+				}
+				else
+					VExecVecDynamicTableScan(node, parentNode, eState, eflags);
+			}
+			break;
+		case T_AppendState:
+			if(Gp_role != GP_ROLE_DISPATCH && vstate->vectorized)
+				VExecVecAppend(node, parentNode, eState, eflags);
+			break;
 		case T_AggState:
 			if(Gp_role != GP_ROLE_DISPATCH && vstate->vectorized)
 			{
@@ -306,6 +450,29 @@ VExecVecNode(PlanState *node, PlanState *parentNode, EState *eState,int eflags)
 					VExecVecMotion(node, parentNode, eState, eflags);
 			}
 			break;
+		case T_HashJoinState:
+			if(Gp_role != GP_ROLE_DISPATCH && vstate->vectorized)
+			{
+				if(HAS_EXECUTOR_MEMORY_ACCOUNT(plan, HashJoin))
+				{
+					START_MEMORY_ACCOUNT(plan->memoryAccount);
+					VExecVecHashJoin(node, parentNode, eState, eflags);
+					END_MEMORY_ACCOUNT();
+				}
+				else
+					VExecVecHashJoin(node, parentNode, eState, eflags);
+			}
+			break;
+		case T_HashState:
+			/*
+			 * The vectorized hash join reads the child of the Hash node
+			 * directly, the Hash node only passes the vectorized flag on.
+			 */
+			if( NULL == parentNode ||
+				!IsA(parentNode, HashJoinState) ||
+				!((VectorizedState *)parentNode->vectorized)->vectorized)
+				vstate->vectorized = false;
+			break;
 		default:
 			((VectorizedState *)node->vectorized)->vectorized = false;
 			break;
@@ -316,6 +483,14 @@ VExecVecNode(PlanState *node, PlanState *parentNode, EState *eState,int eflags)
 		VExecVecNode(node->lefttree, node, eState, eflags);
 	if(NULL != node->righttree)
 		VExecVecNode(node->righttree, node, eState, eflags);
+	if(IsA(node, AppendState))
+	{
+		AppendState *appendstate = (AppendState *)node;
+
+		for(int i = 0; i < appendstate->as_nplans; i++)
+			if(NULL != appendstate->appendplans[i])
+				VExecVecNode(appendstate->appendplans[i], node, eState, eflags);
+	}
 
 	return node;
 }
@@ -334,12 +509,21 @@ static bool VExecProcNode(PlanState *node,TupleTableSlot** pRtr)
         case T_TableScanState:
             result = ExecTableVScanVirtualLayer((TableScanState*)node);
             break;
+        case T_ExternalScanState:
+            result = ExecTableVScanVirtualLayer((ScanState*)node);
+            break;
+        case T_DynamicTableScanState:
+            result = ExecVDynamicTableScanVirtualLayer((DynamicTableScanState*)node);
+            break;
         case T_AggState:
             result = ExecVAgg((AggState*)node);
             break;
 	case T_MotionState:
 			result = ExecVMotionVirtualLayer((MotionState*)node);
 			break;
+        case T_HashJoinState:
+            result = ExecVHashJoinVirtualLayer((HashJoinState*)node);
+            break;
         default:
 			ret = false;
             break;
@@ -363,6 +547,23 @@ static bool VExecEndNode(PlanState *node)
 			ExecEndTableScan((TableScanState *)node);
 			ret = true;
 			break;
+		case T_DynamicTableScanState:
+			if(NULL != node->vectorized &&
+			   ((VectorizedState *)node->vectorized)->vectorized)
+			{
+				VExecEndDynamicTableScan((DynamicTableScanState *)node);
+				ret = true;
+			}
+			break;
+		case T_HashJoinState:
+			if(NULL != node->vectorized &&
+			   ((VectorizedState *)node->vectorized)->vectorized)
+			{
+				VExecEndHashJoin((HashJoinState *)node);
+				ExecEndHashJoin((HashJoinState *)node);
+				ret = true;
+			}
+			break;
 		default:
 			break;
 	}
@@ -380,7 +581,12 @@ HasVecExecOprator(Plan* plan)
 	{
 	case T_AppendOnlyScan:
 	case T_ParquetScan:
+	case T_DynamicTableScan:
+	case T_ExternalScan:
+	case T_Append:
 	case T_Agg:
+	case T_HashJoin:
+	case T_Hash:
 		result = true;
 		break;
 	case T_Motion:
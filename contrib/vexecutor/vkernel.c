@@ -0,0 +1,285 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * vkernel.c
+ *		Portable batch kernels for the vtype operators, and the choice of
+ *		the SIMD implementation at load time.
+ */
+
+#include "postgres.h"
+
+#ifdef HAVE__GET_CPUID
+#include <cpuid.h>
+#endif
+
+#include "vkernel.h"
+
+const VKernelRoutine *vkernel = &vkernel_scalar;
+
+#define SCALAR_LOOP(expr) \
+	do { \
+		int		i; \
+		for (i = 0; i < n; i++) \
+			res[i] = (expr); \
+	} while (0)
+
+#define SCALAR_CMP(GET, A, B) \
+	do { \
+		switch (op) \
+		{ \
+			case VK_EQ: SCALAR_LOOP(BoolGetDatum(GET(A) == GET(B))); break; \
+			case VK_NE: SCALAR_LOOP(BoolGetDatum(GET(A) != GET(B))); break; \
+			case VK_GT: SCALAR_LOOP(BoolGetDatum(GET(A) > GET(B))); break; \
+			case VK_GE: SCALAR_LOOP(BoolGetDatum(GET(A) >= GET(B))); break; \
+			case VK_LT: SCALAR_LOOP(BoolGetDatum(GET(A) < GET(B))); break; \
+			case VK_LE: SCALAR_LOOP(BoolGetDatum(GET(A) <= GET(B))); break; \
+			default: elog(ERROR, "invalid comparison kernel %d", op); \
+		} \
+	} while (0)
+
+#define SCALAR_ARITH(GET, PUT, A, B) \
+	do { \
+		switch (op) \
+		{ \
+			case VK_PL: SCALAR_LOOP(PUT(GET(A) + GET(B))); break; \
+			case VK_MI: SCALAR_LOOP(PUT(GET(A) - GET(B))); break; \
+			case VK_MUL: SCALAR_LOOP(PUT(GET(A) * GET(B))); break; \
+			case VK_DIV: SCALAR_LOOP(PUT(GET(A) / GET(B))); break; \
+			default: elog(ERROR, "invalid arithmetic kernel %d", op); \
+		} \
+	} while (0)
+
+static void
+scalar_cmp(VKernelType type, VKernelOp op,
+		   const Datum *a, const Datum *b, Datum *res, int n)
+{
+	switch (type)
+	{
+		case VK_INT16:
+			SCALAR_CMP(DatumGetInt16, a[i], b[i]);
+			break;
+		case VK_INT32:
+			SCALAR_CMP(DatumGetInt32, a[i], b[i]);
+			break;
+		case VK_INT64:
+			SCALAR_CMP(DatumGetInt64, a[i], b[i]);
+			break;
+		case VK_FLOAT8:
+			SCALAR_CMP(DatumGetFloat8, a[i], b[i]);
+			break;
+		default:
+			elog(ERROR, "no comparison kernel for type %d", type);
+	}
+}
+
+static void
+scalar_cmp_const(VKernelType type, VKernelOp op,
+				 const Datum *a, Datum b, Datum *res, int n)
+{
+	switch (type)
+	{
+		case VK_INT16:
+			SCALAR_CMP(DatumGetInt16, a[i], b);
+			break;
+		case VK_INT32:
+			SCALAR_CMP(DatumGetInt32, a[i], b);
+			break;
+		case VK_INT64:
+			SCALAR_CMP(DatumGetInt64, a[i], b);
+			break;
+		case VK_FLOAT8:
+			SCALAR_CMP(DatumGetFloat8, a[i], b);
+			break;
+		default:
+			elog(ERROR, "no comparison kernel for type %d", type);
+	}
+}
+
+static void
+scalar_arith(VKernelType type, VKernelOp op,
+			 const Datum *a, const Datum *b, Datum *res, int n)
+{
+	Assert(VK_ARITH_SUPPORTED(type, op));
+
+	switch (type)
+	{
+		case VK_INT16:
+			SCALAR_ARITH(DatumGetInt16, Int16GetDatum, a[i], b[i]);
+			break;
+		case VK_INT32:
+			SCALAR_ARITH(DatumGetInt32, Int32GetDatum, a[i], b[i]);
+			break;
+		case VK_INT64:
+			SCALAR_ARITH(DatumGetInt64, Int64GetDatum, a[i], b[i]);
+			break;
+		case VK_FLOAT8:
+			SCALAR_ARITH(DatumGetFloat8, Float8GetDatum, a[i], b[i]);
+			break;
+		default:
+			elog(ERROR, "no arithmetic kernel for type %d", type);
+	}
+}
+
+static void
+scalar_arith_const(VKernelType type, VKernelOp op,
+				   const Datum *a, Datum b, bool lconst, Datum *res, int n)
+{
+	Assert(VK_ARITH_SUPPORTED(type, op));
+
+	switch (type)
+	{
+		case VK_INT16:
+			if (lconst)
+				SCALAR_ARITH(DatumGetInt16, Int16GetDatum, b, a[i]);
+			else
+				SCALAR_ARITH(DatumGetInt16, Int16GetDatum, a[i], b);
+			break;
+		case VK_INT32:
+			if (lconst)
+				SCALAR_ARITH(DatumGetInt32, Int32GetDatum, b, a[i]);
+			else
+				SCALAR_ARITH(DatumGetInt32, Int32GetDatum, a[i], b);
+			break;
+		case VK_INT64:
+			if (lconst)
+				SCALAR_ARITH(DatumGetInt64, Int64GetDatum, b, a[i]);
+			else
+				SCALAR_ARITH(DatumGetInt64, Int64GetDatum, a[i], b);
+			break;
+		case VK_FLOAT8:
+			if (lconst)
+				SCALAR_ARITH(DatumGetFloat8, Float8GetDatum, b, a[i]);
+			else
+				SCALAR_ARITH(DatumGetFloat8, Float8GetDatum, a[i], b);
+			break;
+		default:
+			elog(ERROR, "no arithmetic kernel for type %d", type);
+	}
+}
+
+static void
+scalar_null_or(bool *res, const bool *a, const bool *b, int n)
+{
+	int			i;
+
+	for (i = 0; i < n; i++)
+		res[i] = a[i] | b[i];
+}
+
+static bool
+scalar_bool_and(Datum *res, bool *resnull,
+				const Datum *next, const bool *nextnull, int n)
+{
+	bool		undecided = false;
+	int			i;
+
+	for (i = 0; i < n; i++)
+	{
+		resnull[i] = resnull[i] | nextnull[i];
+		res[i] = BoolGetDatum((res[i] != 0) & (next[i] != 0));
+		undecided |= resnull[i] | (res[i] != 0);
+	}
+
+	return !undecided;
+}
+
+static bool
+scalar_bool_or(Datum *res, bool *resnull,
+			   const Datum *next, const bool *nextnull, int n)
+{
+	bool		undecided = false;
+	int			i;
+
+	for (i = 0; i < n; i++)
+	{
+		resnull[i] = resnull[i] | nextnull[i];
+		res[i] = BoolGetDatum((res[i] != 0) | (next[i] != 0));
+		undecided |= resnull[i] | (res[i] == 0);
+	}
+
+	return !undecided;
+}
+
+const VKernelRoutine vkernel_scalar = {
+	"scalar",
+	scalar_cmp,
+	scalar_cmp_const,
+	scalar_arith,
+	scalar_arith_const,
+	scalar_null_or,
+	scalar_bool_and,
+	scalar_bool_or
+};
+
+#if defined(__x86_64__) && defined(HAVE__GET_CPUID)
+
+static bool
+vkernel_sse42_available(void)
+{
+	unsigned int exx[4] = {0, 0, 0, 0};
+
+	__get_cpuid(1, &exx[0], &exx[1], &exx[2], &exx[3]);
+
+	return (exx[2] & (1 << 20)) != 0;	/* SSE 4.2 */
+}
+
+static bool
+vkernel_avx2_available(void)
+{
+	unsigned int exx[4] = {0, 0, 0, 0};
+	unsigned int xcr0_lo;
+	unsigned int xcr0_hi;
+
+	__get_cpuid(1, &exx[0], &exx[1], &exx[2], &exx[3]);
+	if ((exx[2] & (1 << 27)) == 0)		/* OSXSAVE */
+		return false;
+
+	/* the OS must save the ymm registers on context switch */
+	__asm__ __volatile__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+	if ((xcr0_lo & 0x6) != 0x6)
+		return false;
+
+	if (__get_cpuid_max(0, NULL) < 7)
+		return false;
+	__cpuid_count(7, 0, exx[0], exx[1], exx[2], exx[3]);
+
+	return (exx[1] & (1 << 5)) != 0;	/* AVX2 */
+}
+
+#endif
+
+/*
+ * Choose the best kernel routine for the cpu we are running on. Called
+ * once from _PG_init.
+ */
+void
+vkernel_init(void)
+{
+	vkernel = &vkernel_scalar;
+
+#if defined(__x86_64__) && defined(HAVE__GET_CPUID)
+	if (vkernel_avx2_available())
+		vkernel = &vkernel_avx2;
+	else if (vkernel_sse42_available())
+		vkernel = &vkernel_sse42;
+#endif
+
+	elog(DEBUG1, "vectorized executor uses %s kernels", vkernel->name);
+}
@@ -0,0 +1,188 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __VKERNEL_H___
+#define __VKERNEL_H___
+
+#include "postgres.h"
+
+/*
+ * Batch kernels for the vtype operators.
+ *
+ * A kernel works on the Datum arrays of a vtype and ignores the null flags:
+ * every lane is computed, the caller merges the isnull arrays separately.
+ * This keeps the loops free of branches, so the same kernel serves both
+ * the no-null fast path and the general path of the operator functions.
+ *
+ * The implementation is chosen once at load time according to the cpu,
+ * see vkernel_init().
+ */
+
+/*
+ * The representation of the values in the Datum lanes. Int16 and Int32
+ * values are sign-extended to the whole Datum, see Int32GetDatum.
+ */
+typedef enum VKernelType
+{
+	VK_NONE = 0,		/* no kernel, use the per-element loop */
+	VK_INT16,
+	VK_INT32,
+	VK_INT64,
+	VK_FLOAT8
+} VKernelType;
+
+typedef enum VKernelOp
+{
+	VK_EQ,
+	VK_NE,
+	VK_GT,
+	VK_GE,
+	VK_LT,
+	VK_LE,
+	VK_PL,
+	VK_MI,
+	VK_MUL,
+	VK_DIV
+} VKernelOp;
+
+/*
+ * Map the type and operator names used by the macros of vtype.c and
+ * vtype_ext.c to the kernel enums. float4 and bool have no kernel.
+ */
+#define VK_TYPE_int2	VK_INT16
+#define VK_TYPE_int4	VK_INT32
+#define VK_TYPE_int8	VK_INT64
+#define VK_TYPE_float4	VK_NONE
+#define VK_TYPE_float8	VK_FLOAT8
+#define VK_TYPE_bool	VK_NONE
+#define VK_TYPE_dateadt	VK_INT32
+#ifdef HAVE_INT64_TIMESTAMP
+#define VK_TYPE_timestamp	VK_INT64
+#else
+#define VK_TYPE_timestamp	VK_FLOAT8
+#endif
+
+#define VK_OP_eq	VK_EQ
+#define VK_OP_ne	VK_NE
+#define VK_OP_gt	VK_GT
+#define VK_OP_ge	VK_GE
+#define VK_OP_lt	VK_LT
+#define VK_OP_le	VK_LE
+#define VK_OP_pl	VK_PL
+#define VK_OP_mi	VK_MI
+#define VK_OP_mul	VK_MUL
+#define VK_OP_div	VK_DIV
+
+#define VK_CMP_SUPPORTED(type)	((type) != VK_NONE)
+
+/*
+ * Integer kernels only do addition and subtraction, which wrap the same
+ * way as the per-element code. Multiplication has no 64-bit lane
+ * instruction below AVX-512 and division must not run on the garbage
+ * values of null lanes.
+ */
+#define VK_ARITH_SUPPORTED(type, op) \
+	((type) == VK_FLOAT8 || \
+	 ((type) != VK_NONE && ((op) == VK_PL || (op) == VK_MI)))
+
+typedef struct VKernelRoutine
+{
+	const char *name;
+
+	/* res[i] = a[i] op b[i], res is a vbool */
+	void		(*cmp) (VKernelType type, VKernelOp op,
+						const Datum *a, const Datum *b, Datum *res, int n);
+	/* res[i] = a[i] op b, res is a vbool */
+	void		(*cmp_const) (VKernelType type, VKernelOp op,
+							  const Datum *a, Datum b, Datum *res, int n);
+	/* res[i] = a[i] op b[i] */
+	void		(*arith) (VKernelType type, VKernelOp op,
+						  const Datum *a, const Datum *b, Datum *res, int n);
+	/* res[i] = a[i] op b, or b op a[i] if lconst */
+	void		(*arith_const) (VKernelType type, VKernelOp op,
+								const Datum *a, Datum b, bool lconst,
+								Datum *res, int n);
+	/* res[i] = a[i] || b[i] */
+	void		(*null_or) (bool *res, const bool *a, const bool *b, int n);
+
+	/*
+	 * Merge the next clause of an AND (OR) into res. Returns true if every
+	 * lane of the result is known to be false (true), so the rest of the
+	 * clauses need not be evaluated.
+	 */
+	bool		(*bool_and) (Datum *res, bool *resnull,
+							 const Datum *next, const bool *nextnull, int n);
+	bool		(*bool_or) (Datum *res, bool *resnull,
+							const Datum *next, const bool *nextnull, int n);
+} VKernelRoutine;
+
+extern const VKernelRoutine *vkernel;
+
+extern void vkernel_init(void);
+
+/* The portable routine, also used for the tail of the SIMD loops */
+extern const VKernelRoutine vkernel_scalar;
+
+#if defined(__x86_64__)
+extern const VKernelRoutine vkernel_sse42;
+extern const VKernelRoutine vkernel_avx2;
+#endif
+
+/* true if any of the n flags is set */
+static inline bool
+vk_any(const bool *flags, int n)
+{
+	return n > 0 && memchr(flags, true, n) != NULL;
+}
+
+/* true if all of the n flags are set */
+static inline bool
+vk_all(const bool *flags, int n)
+{
+	return memchr(flags, false, n) == NULL;
+}
+
+/*
+ * NOT of a vbool, null lanes are flipped as well since their value is
+ * meaningless.
+ */
+static inline void
+vk_bool_not(Datum *values, int n)
+{
+	int			i;
+
+	for (i = 0; i < n; i++)
+		values[i] = BoolGetDatum(values[i] == 0);
+}
+
+/*
+ * Build the skip array of a batch from the result of its qual: a row is
+ * skipped if the qual is false or null, or it was skipped already.
+ */
+static inline void
+vk_skip_merge(bool *dst, const Datum *values, const bool *isnull,
+			  const bool *skip, int n)
+{
+	int			i;
+
+	for (i = 0; i < n; i++)
+		dst[i] = (values[i] == 0) | isnull[i] | skip[i];
+}
+
+#endif
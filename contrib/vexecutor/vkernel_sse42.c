@@ -0,0 +1,337 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * vkernel_sse42.c
+ *		Batch kernels for the vtype operators using SSE4.2, two Datum lanes
+ *		per instruction.
+ *
+ * This file must be compiled with CFLAGS_SSE42, and is only called when
+ * the cpu supports it, see vkernel_init(). The tail of every loop is left
+ * to the scalar routine.
+ */
+
+#include "postgres.h"
+
+#if defined(__x86_64__)
+
+#include <nmmintrin.h>
+
+#include "vkernel.h"
+
+#define LANES 2
+
+/*
+ * Shifting Int16 and Int32 values to the top of the lane turns the signed
+ * 64-bit compare into a compare of the original type, whatever the upper
+ * bits of the Datum hold.
+ */
+static inline __m128i
+int_lane(__m128i v, VKernelType type)
+{
+	switch (type)
+	{
+		case VK_INT16:
+			return _mm_slli_epi64(v, 48);
+		case VK_INT32:
+			return _mm_slli_epi64(v, 32);
+		default:
+			return v;
+	}
+}
+
+static inline __m128i
+int_cmp(VKernelOp op, __m128i a, __m128i b)
+{
+	const __m128i ones = _mm_set1_epi64x(-1);
+
+	switch (op)
+	{
+		case VK_EQ:
+			return _mm_cmpeq_epi64(a, b);
+		case VK_NE:
+			return _mm_xor_si128(_mm_cmpeq_epi64(a, b), ones);
+		case VK_GT:
+			return _mm_cmpgt_epi64(a, b);
+		case VK_GE:
+			return _mm_xor_si128(_mm_cmpgt_epi64(b, a), ones);
+		case VK_LT:
+			return _mm_cmpgt_epi64(b, a);
+		default:
+			return _mm_xor_si128(_mm_cmpgt_epi64(a, b), ones);
+	}
+}
+
+static inline __m128i
+float_cmp(VKernelOp op, __m128i a, __m128i b)
+{
+	__m128d		x = _mm_castsi128_pd(a);
+	__m128d		y = _mm_castsi128_pd(b);
+	__m128d		r;
+
+	/* same NaN behaviour as the C operators */
+	switch (op)
+	{
+		case VK_EQ:
+			r = _mm_cmpeq_pd(x, y);
+			break;
+		case VK_NE:
+			r = _mm_cmpneq_pd(x, y);
+			break;
+		case VK_GT:
+			r = _mm_cmpgt_pd(x, y);
+			break;
+		case VK_GE:
+			r = _mm_cmpge_pd(x, y);
+			break;
+		case VK_LT:
+			r = _mm_cmplt_pd(x, y);
+			break;
+		default:
+			r = _mm_cmple_pd(x, y);
+			break;
+	}
+
+	return _mm_castpd_si128(r);
+}
+
+/*
+ * Sign-extend the low 16 or 32 bits of each lane, as Int16GetDatum and
+ * Int32GetDatum do. There is no 64-bit arithmetic shift below AVX-512, so
+ * the upper half of each lane is filled with the sign of the lower half.
+ */
+static inline __m128i
+int_sext(__m128i v, VKernelType type)
+{
+	__m128i		sign;
+
+	if (type == VK_INT64)
+		return v;
+	if (type == VK_INT16)
+		v = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+
+	sign = _mm_shuffle_epi32(_mm_srai_epi32(v, 31), _MM_SHUFFLE(2, 2, 0, 0));
+	return _mm_blend_epi16(v, sign, 0xcc);
+}
+
+static inline __m128i
+arith(VKernelType type, VKernelOp op, __m128i a, __m128i b)
+{
+	if (type == VK_FLOAT8)
+	{
+		__m128d		x = _mm_castsi128_pd(a);
+		__m128d		y = _mm_castsi128_pd(b);
+
+		switch (op)
+		{
+			case VK_PL:
+				return _mm_castpd_si128(_mm_add_pd(x, y));
+			case VK_MI:
+				return _mm_castpd_si128(_mm_sub_pd(x, y));
+			case VK_MUL:
+				return _mm_castpd_si128(_mm_mul_pd(x, y));
+			default:
+				return _mm_castpd_si128(_mm_div_pd(x, y));
+		}
+	}
+
+	/* wraps like the scalar code, the result is extended back afterwards */
+	if (op == VK_PL)
+		return int_sext(_mm_add_epi64(a, b), type);
+	return int_sext(_mm_sub_epi64(a, b), type);
+}
+
+#define LOADU(p)		_mm_loadu_si128((const __m128i *) (p))
+#define STOREU(p, v)	_mm_storeu_si128((__m128i *) (p), (v))
+
+static void
+sse42_cmp(VKernelType type, VKernelOp op,
+		 const Datum *a, const Datum *b, Datum *res, int n)
+{
+	const __m128i one = _mm_set1_epi64x(1);
+	int			i;
+
+	if (type == VK_FLOAT8)
+	{
+		for (i = 0; i + LANES <= n; i += LANES)
+			STOREU(res + i, _mm_and_si128(float_cmp(op, LOADU(a + i),
+													   LOADU(b + i)), one));
+	}
+	else
+	{
+		for (i = 0; i + LANES <= n; i += LANES)
+			STOREU(res + i,
+				   _mm_and_si128(int_cmp(op,
+											int_lane(LOADU(a + i), type),
+											int_lane(LOADU(b + i), type)),
+									one));
+	}
+
+	vkernel_scalar.cmp(type, op, a + i, b + i, res + i, n - i);
+}
+
+static void
+sse42_cmp_const(VKernelType type, VKernelOp op,
+			   const Datum *a, Datum b, Datum *res, int n)
+{
+	const __m128i one = _mm_set1_epi64x(1);
+	__m128i		y = _mm_set1_epi64x((int64) b);
+	int			i;
+
+	if (type == VK_FLOAT8)
+	{
+		for (i = 0; i + LANES <= n; i += LANES)
+			STOREU(res + i,
+				   _mm_and_si128(float_cmp(op, LOADU(a + i), y), one));
+	}
+	else
+	{
+		y = int_lane(y, type);
+		for (i = 0; i + LANES <= n; i += LANES)
+			STOREU(res + i,
+				   _mm_and_si128(int_cmp(op,
+											int_lane(LOADU(a + i), type),
+											y),
+									one));
+	}
+
+	vkernel_scalar.cmp_const(type, op, a + i, b, res + i, n - i);
+}
+
+static void
+sse42_arith(VKernelType type, VKernelOp op,
+		   const Datum *a, const Datum *b, Datum *res, int n)
+{
+	int			i;
+
+	Assert(VK_ARITH_SUPPORTED(type, op));
+
+	for (i = 0; i + LANES <= n; i += LANES)
+		STOREU(res + i, arith(type, op, LOADU(a + i), LOADU(b + i)));
+
+	vkernel_scalar.arith(type, op, a + i, b + i, res + i, n - i);
+}
+
+static void
+sse42_arith_const(VKernelType type, VKernelOp op,
+				 const Datum *a, Datum b, bool lconst, Datum *res, int n)
+{
+	const __m128i y = _mm_set1_epi64x((int64) b);
+	int			i;
+
+	Assert(VK_ARITH_SUPPORTED(type, op));
+
+	if (lconst)
+	{
+		for (i = 0; i + LANES <= n; i += LANES)
+			STOREU(res + i, arith(type, op, y, LOADU(a + i)));
+	}
+	else
+	{
+		for (i = 0; i + LANES <= n; i += LANES)
+			STOREU(res + i, arith(type, op, LOADU(a + i), y));
+	}
+
+	vkernel_scalar.arith_const(type, op, a + i, b, lconst, res + i, n - i);
+}
+
+static void
+sse42_null_or(bool *res, const bool *a, const bool *b, int n)
+{
+	int			i;
+
+	for (i = 0; i + (int) sizeof(__m128i) <= n; i += sizeof(__m128i))
+		STOREU(res + i, _mm_or_si128(LOADU(a + i), LOADU(b + i)));
+
+	vkernel_scalar.null_or(res + i, a + i, b + i, n - i);
+}
+
+/*
+ * AND/OR of two vbools. The value lanes are normalized to 0/1 on the way,
+ * `undecided' collects the lanes which do not let us stop the evaluation.
+ */
+static bool
+sse42_bool_and(Datum *res, bool *resnull,
+			  const Datum *next, const bool *nextnull, int n)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi64x(1);
+	__m128i		undecided = zero;
+	__m128i		r;
+	int			i;
+
+	sse42_null_or(resnull, resnull, nextnull, n);
+
+	for (i = 0; i + LANES <= n; i += LANES)
+	{
+		r = _mm_or_si128(_mm_cmpeq_epi64(LOADU(res + i), zero),
+							_mm_cmpeq_epi64(LOADU(next + i), zero));
+		r = _mm_andnot_si128(r, one);
+		STOREU(res + i, r);
+		undecided = _mm_or_si128(undecided, r);
+	}
+
+	/* the null flags are merged already */
+	if (!vkernel_scalar.bool_and(res + i, resnull + i,
+								 next + i, resnull + i, n - i))
+		return false;
+
+	return _mm_testz_si128(undecided, undecided) && !vk_any(resnull, i);
+}
+
+static bool
+sse42_bool_or(Datum *res, bool *resnull,
+			 const Datum *next, const bool *nextnull, int n)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi64x(1);
+	__m128i		undecided = zero;
+	__m128i		r;
+	int			i;
+
+	sse42_null_or(resnull, resnull, nextnull, n);
+
+	for (i = 0; i + LANES <= n; i += LANES)
+	{
+		r = _mm_and_si128(_mm_cmpeq_epi64(LOADU(res + i), zero),
+							 _mm_cmpeq_epi64(LOADU(next + i), zero));
+		STOREU(res + i, _mm_andnot_si128(r, one));
+		undecided = _mm_or_si128(undecided, r);
+	}
+
+	/* the null flags are merged already */
+	if (!vkernel_scalar.bool_or(res + i, resnull + i,
+								next + i, resnull + i, n - i))
+		return false;
+
+	return _mm_testz_si128(undecided, undecided) && !vk_any(resnull, i);
+}
+
+const VKernelRoutine vkernel_sse42 = {
+	"sse42",
+	sse42_cmp,
+	sse42_cmp_const,
+	sse42_arith,
+	sse42_arith_const,
+	sse42_null_or,
+	sse42_bool_and,
+	sse42_bool_or
+};
+
+#endif
@@ -21,6 +21,7 @@
 #include "catalog/pg_type.h"
 #include "utils/builtins.h"
 #include "vtype.h"
+#include "vkernel.h"
 
 #define MAX_NUM_LEN 64
 extern int BATCHSIZE;
@@ -129,6 +130,9 @@ v##type##out(PG_FUNCTION_ARGS) \
  * e.g. extern Datum vint2vint2pl(PG_FUNCTION_ARGS);
  * NOTE:we assum that return type is same with the type of arg1,
  * we have not processed the overflow so far.
+ * If both sides have the same kernel type the batch kernel computes every
+ * lane and the null flags are merged apart, see vkernel.h. Otherwise a
+ * batch without null is done in a loop without the null check.
  */
 #define __FUNCTION_OP(type1, XTYPE1, type2, XTYPE2, opsym, opstr) \
 PG_FUNCTION_INFO_V1(v##type1##v##type2##opstr); \
@@ -142,12 +146,27 @@ v##type1##v##type2##opstr(PG_FUNCTION_ARGS) \
     v##type1 *res = buildv##type1(BATCHSIZE, NULL); \
     Assert(arg1->dim == arg2->dim); \
     size = arg1->dim; \
-    while(i < size) \
+    if (VK_TYPE_##type1 == VK_TYPE_##type2 && \
+        VK_ARITH_SUPPORTED(VK_TYPE_##type1, VK_OP_##opstr)) \
     { \
-        res->isnull[i] = arg1->isnull[i] || arg2->isnull[i]; \
-        if(!res->isnull[i]) \
+        vkernel->arith(VK_TYPE_##type1, VK_OP_##opstr, \
+                       arg1->values, arg2->values, res->values, size); \
+        vkernel->null_or(res->isnull, arg1->isnull, arg2->isnull, size); \
+    } \
+    else if (!vk_any(arg1->isnull, size) && !vk_any(arg2->isnull, size)) \
+    { \
+        for (i = 0; i < size; i++) \
             res->values[i] = XTYPE1##GetDatum((DatumGet##XTYPE1(arg1->values[i])) opsym (DatumGet##XTYPE2(arg2->values[i]))); \
-        i++; \
+    } \
+    else \
+    { \
+        while(i < size) \
+        { \
+            res->isnull[i] = arg1->isnull[i] || arg2->isnull[i]; \
+            if(!res->isnull[i]) \
+                res->values[i] = XTYPE1##GetDatum((DatumGet##XTYPE1(arg1->values[i])) opsym (DatumGet##XTYPE2(arg2->values[i]))); \
+            i++; \
+        } \
     } \
     res->dim = arg1->dim; \
     PG_RETURN_POINTER(res); \
@@ -157,6 +176,7 @@ v##type1##v##type2##opstr(PG_FUNCTION_ARGS) \
  * Operator function for the abstract data types, this MACRO is used for the 
  * V-types OP Consts.
  * e.g. extern Datum vint2int2pl(PG_FUNCTION_ARGS);
+ * The const is cast to the type of the V-type, as the per-element code does.
  */
 #define __FUNCTION_OP_RCONST(type, XTYPE, const_type, CONST_ARG_MACRO, opsym, opstr) \
 PG_FUNCTION_INFO_V1(v##type##const_type##opstr); \
@@ -169,12 +189,27 @@ v##type##const_type##opstr(PG_FUNCTION_ARGS) \
     const_type arg2 = CONST_ARG_MACRO(1); \
     v##type *res = buildv##type(BATCHSIZE, NULL); \
     size = arg1->dim;\
-    while(i < size) \
+    if (VK_ARITH_SUPPORTED(VK_TYPE_##type, VK_OP_##opstr)) \
+    { \
+        vkernel->arith_const(VK_TYPE_##type, VK_OP_##opstr, arg1->values, \
+                             XTYPE##GetDatum((type)arg2), false, \
+                             res->values, size); \
+        memcpy(res->isnull, arg1->isnull, size * sizeof(bool)); \
+    } \
+    else if (!vk_any(arg1->isnull, size)) \
     { \
-        res->isnull[i] = arg1->isnull[i]; \
-        if(!res->isnull[i]) \
+        for (i = 0; i < size; i++) \
             res->values[i] = XTYPE##GetDatum((DatumGet##XTYPE(arg1->values[i])) opsym ((type)arg2)); \
-        i ++ ;\
+    } \
+    else \
+    { \
+        while(i < size) \
+        { \
+            res->isnull[i] = arg1->isnull[i]; \
+            if(!res->isnull[i]) \
+                res->values[i] = XTYPE##GetDatum((DatumGet##XTYPE(arg1->values[i])) opsym ((type)arg2)); \
+            i ++ ;\
+        } \
     } \
     res->dim = arg1->dim; \
     PG_RETURN_POINTER(res); \
@@ -196,12 +231,27 @@ const_type##v##type##opstr(PG_FUNCTION_ARGS) \
     v##type *arg2 = PG_GETARG_POINTER(1); \
     v##type *res = buildv##type(BATCHSIZE, NULL); \
     size = arg2->dim;\
-    while(i < size) \
+    if (VK_ARITH_SUPPORTED(VK_TYPE_##type, VK_OP_##opstr)) \
+    { \
+        vkernel->arith_const(VK_TYPE_##type, VK_OP_##opstr, arg2->values, \
+                             XTYPE##GetDatum((type)arg1), true, \
+                             res->values, size); \
+        memcpy(res->isnull, arg2->isnull, size * sizeof(bool)); \
+    } \
+    else if (!vk_any(arg2->isnull, size)) \
     { \
-        res->isnull[i] = arg2->isnull[i]; \
-        if(!res->isnull[i]) \
+        for (i = 0; i < size; i++) \
             res->values[i] = XTYPE##GetDatum(((type)arg1) opsym (DatumGet##XTYPE(arg2->values[i]))); \
-        i ++ ;\
+    } \
+    else \
+    { \
+        while(i < size) \
+        { \
+            res->isnull[i] = arg2->isnull[i]; \
+            if(!res->isnull[i]) \
+                res->values[i] = XTYPE##GetDatum(((type)arg1) opsym (DatumGet##XTYPE(arg2->values[i]))); \
+            i ++ ;\
+        } \
     } \
     res->dim = arg2->dim; \
     PG_RETURN_POINTER(res); \
@@ -225,12 +275,27 @@ v##type1##v##type2##cmpstr(PG_FUNCTION_ARGS) \
     Assert(arg1->dim == arg2->dim); \
     vbool *res = buildvtype(BOOLOID, BATCHSIZE, NULL); \
     size = arg1->dim; \
-    while(i < size) \
+    if (VK_TYPE_##type1 == VK_TYPE_##type2 && \
+        VK_CMP_SUPPORTED(VK_TYPE_##type1)) \
     { \
-        res->isnull[i] = arg1->isnull[i] || arg2->isnull[i]; \
-        if(!res->isnull[i]) \
+        vkernel->cmp(VK_TYPE_##type1, VK_OP_##cmpstr, \
+                     arg1->values, arg2->values, res->values, size); \
+        vkernel->null_or(res->isnull, arg1->isnull, arg2->isnull, size); \
+    } \
+    else if (!vk_any(arg1->isnull, size) && !vk_any(arg2->isnull, size)) \
+    { \
+        for (i = 0; i < size; i++) \
             res->values[i] = BoolGetDatum(DatumGet##XTYPE1(arg1->values[i]) cmpsym (DatumGet##XTYPE2(arg2->values[i]))); \
-        i++; \
+    } \
+    else \
+    { \
+        while(i < size) \
+        { \
+            res->isnull[i] = arg1->isnull[i] || arg2->isnull[i]; \
+            if(!res->isnull[i]) \
+                res->values[i] = BoolGetDatum(DatumGet##XTYPE1(arg1->values[i]) cmpsym (DatumGet##XTYPE2(arg2->values[i]))); \
+            i++; \
+        } \
     } \
     res->dim = arg1->dim; \
     PG_RETURN_POINTER(res); \
@@ -252,12 +317,27 @@ v##type##const_type##cmpstr(PG_FUNCTION_ARGS) \
     const_type arg2 = CONST_ARG_MACRO(1); \
     vbool *res = buildvtype(BOOLOID, BATCHSIZE, NULL); \
     size = arg1->dim; \
-    while(i < size) \
+    if (VK_TYPE_##type == VK_TYPE_##const_type && \
+        VK_CMP_SUPPORTED(VK_TYPE_##type)) \
+    { \
+        vkernel->cmp_const(VK_TYPE_##type, VK_OP_##cmpstr, arg1->values, \
+                           XTYPE##GetDatum(arg2), res->values, size); \
+        memcpy(res->isnull, arg1->isnull, size * sizeof(bool)); \
+    } \
+    else if (!vk_any(arg1->isnull, size)) \
     { \
-        res->isnull[i] = arg1->isnull[i]; \
-        if(!res->isnull[i]) \
+        for (i = 0; i < size; i++) \
             res->values[i] = BoolGetDatum((DatumGet##XTYPE(arg1->values[i])) cmpsym arg2); \
-        i++; \
+    } \
+    else \
+    { \
+        while(i < size) \
+        { \
+            res->isnull[i] = arg1->isnull[i]; \
+            if(!res->isnull[i]) \
+                res->values[i] = BoolGetDatum((DatumGet##XTYPE(arg1->values[i])) cmpsym arg2); \
+            i++; \
+        } \
     } \
     res->dim = arg1->dim; \
     PG_RETURN_POINTER(res); \
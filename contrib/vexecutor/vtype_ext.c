@@ -17,7 +17,13 @@
  * under the License.
  */
 #include "vtype_ext.h"
+#include "access/tuptoaster.h"
+#include "lib/stringinfo.h"
+#include "mb/pg_wchar.h"
+#include "parser/scansup.h"
 #include "utils/builtins.h"
+#include "utils/datetime.h"
+#include "vkernel.h"
 
 #define MAX_NUM_LEN 64
 extern int BATCHSIZE;
@@ -87,6 +93,10 @@ vdateadtout(PG_FUNCTION_ARGS)
     PG_RETURN_CSTRING(result);
 }
 
+/*
+ * Comparison functions of the fixed width types. The values are integers
+ * in the Datum lanes, so the batch kernels do the work, see vkernel.h.
+ */
 #define EXT_TYPE_CMP(TYPE,TYPEEXPR,cmpsym,cmpstr) \
 PG_FUNCTION_INFO_V1(v##TYPE##_##cmpstr); \
 Datum v##TYPE##_##cmpstr(PG_FUNCTION_ARGS) \
@@ -98,12 +108,21 @@ Datum v##TYPE##_##cmpstr(PG_FUNCTION_ARGS) \
     Assert(arg1->dim == arg2->dim); \
     vbool *res = buildvtype(BOOLOID, BATCHSIZE, NULL); \
     size = arg1->dim; \
-    while(i < size) \
+    if (VK_CMP_SUPPORTED(VK_TYPE_##TYPE)) \
+    { \
+        vkernel->cmp(VK_TYPE_##TYPE, VK_OP_##cmpstr, \
+                     arg1->values, arg2->values, res->values, size); \
+        vkernel->null_or(res->isnull, arg1->isnull, arg2->isnull, size); \
+    } \
+    else \
     { \
-        res->isnull[i] = arg1->isnull[i] || arg2->isnull[i]; \
-        if(!res->isnull[i]) \
-            res->values[i] = BoolGetDatum(DatumGet##TYPEEXPR(arg1->values[i]) cmpsym (DatumGet##TYPEEXPR(arg2->values[i]))); \
-        i++; \
+        while(i < size) \
+        { \
+            res->isnull[i] = arg1->isnull[i] || arg2->isnull[i]; \
+            if(!res->isnull[i]) \
+                res->values[i] = BoolGetDatum(DatumGet##TYPEEXPR(arg1->values[i]) cmpsym (DatumGet##TYPEEXPR(arg2->values[i]))); \
+            i++; \
+        } \
     } \
     res->dim = arg1->dim; \
     PG_RETURN_POINTER(res);\
@@ -120,12 +139,21 @@ v##type##_##cmpstr##_##type(PG_FUNCTION_ARGS) \
     const_type arg2 = CONST_ARG_MACRO(1); \
     vbool *res = buildvtype(BOOLOID, BATCHSIZE, NULL); \
     size = arg1->dim; \
-    while(i < size) \
+    if (VK_CMP_SUPPORTED(VK_TYPE_##type)) \
     { \
-        res->isnull[i] = arg1->isnull[i]; \
-        if(!res->isnull[i]) \
-            res->values[i] = BoolGetDatum((DatumGet##XTYPE(arg1->values[i])) cmpsym arg2); \
-        i++; \
+        vkernel->cmp_const(VK_TYPE_##type, VK_OP_##cmpstr, arg1->values, \
+                           XTYPE##GetDatum(arg2), res->values, size); \
+        memcpy(res->isnull, arg1->isnull, size * sizeof(bool)); \
+    } \
+    else \
+    { \
+        while(i < size) \
+        { \
+            res->isnull[i] = arg1->isnull[i]; \
+            if(!res->isnull[i]) \
+                res->values[i] = BoolGetDatum((DatumGet##XTYPE(arg1->values[i])) cmpsym arg2); \
+            i++; \
+        } \
     } \
     res->dim = arg1->dim; \
     PG_RETURN_POINTER(res); \
@@ -145,6 +173,20 @@ EXT_TYPE_CMP_RCONST(dateadt, DateADT, DateADT, PG_GETARG_DATEADT, <=, le)
 EXT_TYPE_CMP_RCONST(dateadt, DateADT, DateADT, PG_GETARG_DATEADT, >, gt)
 EXT_TYPE_CMP_RCONST(dateadt, DateADT, DateADT, PG_GETARG_DATEADT, >=, ge)
 
+EXT_TYPE_CMP(timestamp,Timestamp,==,eq)
+EXT_TYPE_CMP(timestamp,Timestamp,!=,ne)
+EXT_TYPE_CMP(timestamp,Timestamp,<,lt)
+EXT_TYPE_CMP(timestamp,Timestamp,<=,le)
+EXT_TYPE_CMP(timestamp,Timestamp,>,gt)
+EXT_TYPE_CMP(timestamp,Timestamp,>=,ge)
+
+EXT_TYPE_CMP_RCONST(timestamp, Timestamp, Timestamp, PG_GETARG_TIMESTAMP, ==, eq)
+EXT_TYPE_CMP_RCONST(timestamp, Timestamp, Timestamp, PG_GETARG_TIMESTAMP, !=, ne)
+EXT_TYPE_CMP_RCONST(timestamp, Timestamp, Timestamp, PG_GETARG_TIMESTAMP, <, lt)
+EXT_TYPE_CMP_RCONST(timestamp, Timestamp, Timestamp, PG_GETARG_TIMESTAMP, <=, le)
+EXT_TYPE_CMP_RCONST(timestamp, Timestamp, Timestamp, PG_GETARG_TIMESTAMP, >, gt)
+EXT_TYPE_CMP_RCONST(timestamp, Timestamp, Timestamp, PG_GETARG_TIMESTAMP, >=, ge)
+
 PG_FUNCTION_INFO_V1(vdateadt_mi_dateadt);
 Datum vdateadt_mi_dateadt(PG_FUNCTION_ARGS)
 {
@@ -283,3 +325,623 @@ Datum vdateadt_pli(PG_FUNCTION_ARGS)
     res->dim = arg1->dim; 
     PG_RETURN_POINTER(res); 
 }
+
+/*
+ * IN and OUT functions of the types below. Timestamps and strings may
+ * contain white space, so the OUT function double-quotes every value and
+ * escapes the quotes and backslashes in it; an unquoted NULL is a null.
+ */
+static vtype *
+vtype_ext_in(char *str, Oid elemtype, PGFunction infunc)
+{
+    StringInfoData buf;
+    vtype *res = buildvtype(elemtype, BATCHSIZE, NULL);
+    int n = 0;
+
+    initStringInfo(&buf);
+    for (n = 0; n < BATCHSIZE; n++)
+    {
+        bool quoted = false;
+
+        while (*str && isspace((unsigned char) *str))
+            str++;
+        if (*str == '\0')
+            break;
+
+        resetStringInfo(&buf);
+        if (*str == '"')
+        {
+            quoted = true;
+            str++;
+            while (*str && *str != '"')
+            {
+                if (*str == '\\' && str[1] != '\0')
+                    str++;
+                appendStringInfoChar(&buf, *str++);
+            }
+            if (*str != '"')
+                ereport(ERROR,
+                        (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+                                errmsg("unterminated quoted value in vectorized type input")));
+            str++;
+        }
+        else
+        {
+            while (*str && !isspace((unsigned char) *str))
+                appendStringInfoChar(&buf, *str++);
+        }
+
+        res->isnull[n] = !quoted && pg_strcasecmp(buf.data, "NULL") == 0;
+        if (!res->isnull[n])
+            res->values[n] = DirectFunctionCall3(infunc,
+                                                 CStringGetDatum(buf.data),
+                                                 ObjectIdGetDatum(InvalidOid),
+                                                 Int32GetDatum(-1));
+    }
+    while (*str && isspace((unsigned char) *str))
+        str++;
+    if (*str)
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                        errmsg("vectorized type has too many elements")));
+    pfree(buf.data);
+
+    res->dim = n;
+    SET_VARSIZE(res, VTYPESIZE(n));
+    return res;
+}
+
+static char *
+vtype_ext_out(vtype *arg, PGFunction outfunc)
+{
+    StringInfoData buf;
+    int i = 0;
+
+    initStringInfo(&buf);
+    for (i = 0; i < arg->dim; i++)
+    {
+        char *p;
+
+        if (i != 0)
+            appendStringInfoChar(&buf, ' ');
+        if (arg->isnull[i])
+        {
+            appendStringInfoString(&buf, "NULL");
+            continue;
+        }
+
+        appendStringInfoChar(&buf, '"');
+        for (p = DatumGetCString(DirectFunctionCall1(outfunc, arg->values[i])); *p; p++)
+        {
+            if (*p == '"' || *p == '\\')
+                appendStringInfoChar(&buf, '\\');
+            appendStringInfoChar(&buf, *p);
+        }
+        appendStringInfoChar(&buf, '"');
+    }
+    return buf.data;
+}
+
+#define EXT_TYPE_IN_OUT(type, typeoid, infunc, outfunc) \
+PG_FUNCTION_INFO_V1(v##type##in); \
+Datum \
+v##type##in(PG_FUNCTION_ARGS) \
+{ \
+    PG_RETURN_POINTER(vtype_ext_in(PG_GETARG_CSTRING(0), typeoid, infunc)); \
+} \
+PG_FUNCTION_INFO_V1(v##type##out); \
+Datum \
+v##type##out(PG_FUNCTION_ARGS) \
+{ \
+    PG_RETURN_CSTRING(vtype_ext_out((vtype *) PG_GETARG_POINTER(0), outfunc)); \
+}
+
+EXT_TYPE_IN_OUT(timestamp, TIMESTAMPOID, timestamp_in, timestamp_out)
+EXT_TYPE_IN_OUT(text, TEXTOID, textin, textout)
+EXT_TYPE_IN_OUT(varchar, VARCHAROID, varcharin, varcharout)
+EXT_TYPE_IN_OUT(bpchar, BPCHAROID, bpcharin, bpcharout)
+EXT_TYPE_IN_OUT(numeric, NUMERICOID, numeric_in, numeric_out)
+
+/* the result of a three-way comparison for the operator */
+static inline bool
+ext_cmp_result(VKernelOp op, int cmp)
+{
+    switch (op)
+    {
+        case VK_EQ:
+            return cmp == 0;
+        case VK_NE:
+            return cmp != 0;
+        case VK_GT:
+            return cmp > 0;
+        case VK_GE:
+            return cmp >= 0;
+        case VK_LT:
+            return cmp < 0;
+        default:
+            return cmp <= 0;
+    }
+}
+
+/* vdateadt_timestamp
+ * cast vdateadt to vtimestamp, the same as date_timestamp
+ * */
+PG_FUNCTION_INFO_V1(vdateadt_timestamp);
+Datum vdateadt_timestamp(PG_FUNCTION_ARGS)
+{
+    int size = 0;
+    int i = 0;
+    vdateadt* arg1 = PG_GETARG_POINTER(0);
+    vtimestamp* res = buildvtype(TIMESTAMPOID, BATCHSIZE, NULL);
+    size = arg1->dim;
+    while(i < size)
+    {
+        res->isnull[i] = arg1->isnull[i];
+        if(!res->isnull[i])
+            res->values[i] = DirectFunctionCall1(date_timestamp, arg1->values[i]);
+        i++;
+    }
+    res->dim = arg1->dim;
+    PG_RETURN_POINTER(res);
+}
+
+/*
+ * date_part() of a vdateadt or a vtimestamp.
+ *
+ * The fields which only depend on the day are computed from the julian day
+ * number here, once the units are decoded for the whole batch. The others,
+ * and the infinite values, go through timestamp_part one by one.
+ */
+static int
+vdate_part_field(text *units)
+{
+    char *lowunits;
+    int type;
+    int val;
+
+    lowunits = downcase_truncate_identifier(VARDATA(units),
+                                            VARSIZE(units) - VARHDRSZ,
+                                            false);
+    type = DecodeUnits(0, lowunits, &val);
+    pfree(lowunits);
+
+    if (type == UNITS &&
+        (val == DTK_DAY || val == DTK_MONTH || val == DTK_QUARTER || val == DTK_YEAR))
+        return val;
+    if (type == RESERV && (val == DTK_DOW || val == DTK_DOY))
+        return val;
+
+    return -1;
+}
+
+static float8
+vdate_part_julian(int field, int jd)
+{
+    int year;
+    int mon;
+    int mday;
+
+    j2date(jd, &year, &mon, &mday);
+
+    switch (field)
+    {
+        case DTK_DAY:
+            return mday;
+        case DTK_MONTH:
+            return mon;
+        case DTK_QUARTER:
+            return (mon - 1) / 3 + 1;
+        case DTK_YEAR:
+            /* there is no year 0, just 1 BC and 1 AD */
+            return year > 0 ? year : year - 1;
+        case DTK_DOW:
+            return j2day(jd);
+        default:
+            Assert(field == DTK_DOY);
+            return jd - date2j(year, 1, 1) + 1;
+    }
+}
+
+PG_FUNCTION_INFO_V1(vdateadt_part);
+Datum vdateadt_part(PG_FUNCTION_ARGS)
+{
+    int size = 0;
+    int i = 0;
+    text *units = PG_GETARG_TEXT_P(0);
+    vdateadt* arg2 = PG_GETARG_POINTER(1);
+    vfloat8 *res = buildvfloat8(BATCHSIZE, NULL);
+    int field = vdate_part_field(units);
+    size = arg2->dim;
+    while(i < size)
+    {
+        res->isnull[i] = arg2->isnull[i];
+        if(!res->isnull[i])
+        {
+            DateADT date = DatumGetDateADT(arg2->values[i]);
+
+            if (field >= 0 && !DATE_NOT_FINITE(date))
+                res->values[i] = Float8GetDatum(vdate_part_julian(field, date + POSTGRES_EPOCH_JDATE));
+            else
+                res->values[i] = DirectFunctionCall2(timestamp_part, PointerGetDatum(units),
+                                                     DirectFunctionCall1(date_timestamp, arg2->values[i]));
+        }
+        i++;
+    }
+    res->dim = arg2->dim;
+    PG_RETURN_POINTER(res);
+}
+
+PG_FUNCTION_INFO_V1(vtimestamp_part);
+Datum vtimestamp_part(PG_FUNCTION_ARGS)
+{
+    int size = 0;
+    int i = 0;
+    text *units = PG_GETARG_TEXT_P(0);
+    vtimestamp* arg2 = PG_GETARG_POINTER(1);
+    vfloat8 *res = buildvfloat8(BATCHSIZE, NULL);
+#ifdef HAVE_INT64_TIMESTAMP
+    int field = vdate_part_field(units);
+#else
+    /* leave the rounding of float timestamps to timestamp2tm */
+    int field = -1;
+#endif
+    size = arg2->dim;
+    while(i < size)
+    {
+        res->isnull[i] = arg2->isnull[i];
+        if(!res->isnull[i])
+        {
+            Timestamp ts = DatumGetTimestamp(arg2->values[i]);
+            int64 jd = 0;
+
+#ifdef HAVE_INT64_TIMESTAMP
+            jd = ts / USECS_PER_DAY;
+            if (ts % USECS_PER_DAY < 0)
+                jd--;
+            jd += POSTGRES_EPOCH_JDATE;
+#endif
+            if (field >= 0 && !TIMESTAMP_NOT_FINITE(ts) && jd >= 0 && jd <= INT_MAX)
+                res->values[i] = Float8GetDatum(vdate_part_julian(field, (int) jd));
+            else
+                res->values[i] = DirectFunctionCall2(timestamp_part, PointerGetDatum(units),
+                                                     arg2->values[i]);
+        }
+        i++;
+    }
+    res->dim = arg2->dim;
+    PG_RETURN_POINTER(res);
+}
+
+/*
+ * Comparison and LIKE of vtext, vvarchar and vbpchar.
+ *
+ * Equality is a memcmp of the bytes, as texteq does; the ordering goes
+ * through varstr_cmp, which is a memcmp as well in the C locale. The
+ * trailing blanks of bpchar values are not significant, as in bpcmp.
+ * The const of the *_<type> variants is detoasted once per batch.
+ */
+static inline int
+vtext_truelen(const char *p, int len)
+{
+    while (len > 0 && p[len - 1] == ' ')
+        len--;
+    return len;
+}
+
+static inline int
+vtext_cmp(VKernelOp op, char *p1, int len1, char *p2, int len2)
+{
+    if (op == VK_EQ || op == VK_NE)
+        return (len1 != len2) ? 1 : memcmp(p1, p2, len1);
+    return varstr_cmp(p1, len1, p2, len2);
+}
+
+static vbool *
+vtext_compare(vtype *arg1, vtype *arg2, Datum rconst, VKernelOp op, bool bpchar)
+{
+    vbool *res = buildvtype(BOOLOID, BATCHSIZE, NULL);
+    char *cp = NULL;
+    int clen = 0;
+    void *cfree = NULL;
+    int i = 0;
+
+    if (arg2 == NULL)
+    {
+        varattrib_untoast_ptr_len(rconst, &cp, &clen, &cfree);
+        if (bpchar)
+            clen = vtext_truelen(cp, clen);
+    }
+    else
+        Assert(arg1->dim == arg2->dim);
+
+    for (i = 0; i < arg1->dim; i++)
+    {
+        char *p1;
+        int len1;
+        void *free1;
+        char *p2 = cp;
+        int len2 = clen;
+        void *free2 = NULL;
+
+        res->isnull[i] = arg1->isnull[i] || (arg2 != NULL && arg2->isnull[i]);
+        if (res->isnull[i])
+            continue;
+
+        varattrib_untoast_ptr_len(arg1->values[i], &p1, &len1, &free1);
+        if (arg2 != NULL)
+            varattrib_untoast_ptr_len(arg2->values[i], &p2, &len2, &free2);
+        if (bpchar)
+        {
+            len1 = vtext_truelen(p1, len1);
+            if (arg2 != NULL)
+                len2 = vtext_truelen(p2, len2);
+        }
+
+        res->values[i] = BoolGetDatum(ext_cmp_result(op, vtext_cmp(op, p1, len1, p2, len2)));
+
+        if (free1)
+            pfree(free1);
+        if (free2)
+            pfree(free2);
+    }
+
+    if (cfree)
+        pfree(cfree);
+    res->dim = arg1->dim;
+    return res;
+}
+
+/*
+ * LIKE of a vector and a const pattern. A pattern without wildcards is an
+ * equality, and 'abc%' is a prefix test; both only compare bytes, which is
+ * what the LIKE matcher does for the literal part of a pattern in every
+ * server encoding. Any other pattern runs textlike for each value.
+ */
+static vbool *
+vtext_like(vtype *arg1, text *pattern, bool negate)
+{
+    vbool *res = buildvtype(BOOLOID, BATCHSIZE, NULL);
+    char *pat = VARDATA(pattern);
+    int patlen = VARSIZE(pattern) - VARHDRSZ;
+    int prefixlen = 0;
+    bool exact = true;
+    bool simple = true;
+    int i = 0;
+
+    while (prefixlen < patlen && pat[prefixlen] != '%')
+    {
+        if (pat[prefixlen] == '_' || pat[prefixlen] == '\\')
+            simple = false;
+        prefixlen++;
+    }
+    for (i = prefixlen; i < patlen; i++)
+    {
+        exact = false;
+        if (pat[i] != '%')
+            simple = false;
+    }
+
+    for (i = 0; i < arg1->dim; i++)
+    {
+        char *p;
+        int len;
+        void *tofree;
+        bool match;
+
+        res->isnull[i] = arg1->isnull[i];
+        if (res->isnull[i])
+            continue;
+
+        if (simple)
+        {
+            varattrib_untoast_ptr_len(arg1->values[i], &p, &len, &tofree);
+            if (exact)
+                match = (len == prefixlen && memcmp(p, pat, prefixlen) == 0);
+            else
+                match = (len >= prefixlen && memcmp(p, pat, prefixlen) == 0);
+            if (tofree)
+                pfree(tofree);
+        }
+        else
+            match = DatumGetBool(DirectFunctionCall2(textlike, arg1->values[i],
+                                                     PointerGetDatum(pattern)));
+
+        res->values[i] = BoolGetDatum(match != negate);
+    }
+
+    res->dim = arg1->dim;
+    return res;
+}
+
+#define VTEXT_CMP(type, cmpstr, bpchar) \
+PG_FUNCTION_INFO_V1(v##type##_##cmpstr); \
+Datum \
+v##type##_##cmpstr(PG_FUNCTION_ARGS) \
+{ \
+    PG_RETURN_POINTER(vtext_compare(PG_GETARG_POINTER(0), PG_GETARG_POINTER(1), \
+                                    (Datum) 0, VK_OP_##cmpstr, bpchar)); \
+} \
+PG_FUNCTION_INFO_V1(v##type##_##cmpstr##_##type); \
+Datum \
+v##type##_##cmpstr##_##type(PG_FUNCTION_ARGS) \
+{ \
+    PG_RETURN_POINTER(vtext_compare(PG_GETARG_POINTER(0), NULL, \
+                                    PG_GETARG_DATUM(1), VK_OP_##cmpstr, bpchar)); \
+}
+
+#define VTEXT_LIKE(type) \
+PG_FUNCTION_INFO_V1(v##type##_like_text); \
+Datum \
+v##type##_like_text(PG_FUNCTION_ARGS) \
+{ \
+    PG_RETURN_POINTER(vtext_like(PG_GETARG_POINTER(0), PG_GETARG_TEXT_P(1), false)); \
+} \
+PG_FUNCTION_INFO_V1(v##type##_nlike_text); \
+Datum \
+v##type##_nlike_text(PG_FUNCTION_ARGS) \
+{ \
+    PG_RETURN_POINTER(vtext_like(PG_GETARG_POINTER(0), PG_GETARG_TEXT_P(1), true)); \
+}
+
+VTEXT_CMP(text, eq, false)
+VTEXT_CMP(text, ne, false)
+VTEXT_CMP(text, lt, false)
+VTEXT_CMP(text, le, false)
+VTEXT_CMP(text, gt, false)
+VTEXT_CMP(text, ge, false)
+VTEXT_LIKE(text)
+
+VTEXT_CMP(bpchar, eq, true)
+VTEXT_CMP(bpchar, ne, true)
+VTEXT_CMP(bpchar, lt, true)
+VTEXT_CMP(bpchar, le, true)
+VTEXT_CMP(bpchar, gt, true)
+VTEXT_CMP(bpchar, ge, true)
+VTEXT_LIKE(bpchar)
+
+/*
+ * Comparison of vnumeric.
+ *
+ * Two numerics are compared as int64 integers scaled by ten to the larger
+ * of their display scales whenever both fit, which covers the DECIMAL(p,s)
+ * columns with p up to 18. The rest, NaN included, goes through
+ * numeric_cmp. The layout of the digits is the one of numeric.c.
+ */
+typedef int16 NumericDigit;
+#define NBASE		10000
+#define DEC_DIGITS	4
+#define VNUMERIC_INT64_MAX	INT64CONST(0x7FFFFFFFFFFFFFFF)
+
+/*
+ * The fields of a plain numeric Datum. The values read by the scans may
+ * have a short varlena header, so the fields are not aligned.
+ */
+typedef struct VNumeric
+{
+    int16 weight;
+    uint16 sign_dscale;
+    const char *digits;
+    int ndigits;
+} VNumeric;
+
+static inline bool
+vnumeric_unpack(Datum d, VNumeric *num)
+{
+    struct varlena *v = (struct varlena *) DatumGetPointer(d);
+    const char *data;
+
+    if (VARATT_IS_COMPRESSED(v) || VARATT_IS_EXTERNAL(v))
+        return false;
+
+    data = VARDATA_ANY(v);
+    memcpy(&num->weight, data, sizeof(int16));
+    memcpy(&num->sign_dscale, data + sizeof(int16), sizeof(uint16));
+    num->digits = data + sizeof(int16) + sizeof(uint16);
+    num->ndigits = (VARSIZE_ANY_EXHDR(v) - sizeof(int16) - sizeof(uint16)) / sizeof(NumericDigit);
+
+    return (num->sign_dscale & NUMERIC_SIGN_MASK) != NUMERIC_NAN;
+}
+
+static bool
+vnumeric_scaled(const VNumeric *num, int scale, int64 *result)
+{
+    int exp10 = 0;
+    int64 val = 0;
+    int i = 0;
+
+    for (i = 0; i < num->ndigits; i++)
+    {
+        NumericDigit digit;
+
+        memcpy(&digit, num->digits + i * sizeof(NumericDigit), sizeof(NumericDigit));
+        if (val > (VNUMERIC_INT64_MAX - (NBASE - 1)) / NBASE)
+            return false;
+        val = val * NBASE + digit;
+    }
+
+    /*
+     * val is the number times NBASE^(ndigits - 1 - weight). The digits
+     * beyond the display scale are zero, so the division below is exact.
+     */
+    if (val != 0)
+    {
+        for (exp10 = scale - (num->ndigits - 1 - num->weight) * DEC_DIGITS; exp10 > 0; exp10--)
+        {
+            if (val > VNUMERIC_INT64_MAX / 10)
+                return false;
+            val *= 10;
+        }
+        for (; exp10 < 0; exp10++)
+            val /= 10;
+    }
+
+    *result = ((num->sign_dscale & NUMERIC_SIGN_MASK) == NUMERIC_NEG) ? -val : val;
+    return true;
+}
+
+static inline int
+vnumeric_cmp(Datum d1, Datum d2)
+{
+    VNumeric n1;
+    VNumeric n2;
+    int64 v1;
+    int64 v2;
+
+    if (vnumeric_unpack(d1, &n1) && vnumeric_unpack(d2, &n2))
+    {
+        int scale = Max(n1.sign_dscale & NUMERIC_DSCALE_MASK,
+                        n2.sign_dscale & NUMERIC_DSCALE_MASK);
+
+        if (vnumeric_scaled(&n1, scale, &v1) && vnumeric_scaled(&n2, scale, &v2))
+            return (v1 > v2) - (v1 < v2);
+    }
+
+    return DatumGetInt32(DirectFunctionCall2(numeric_cmp, d1, d2));
+}
+
+static vbool *
+vnumeric_compare(vtype *arg1, vtype *arg2, Datum rconst, VKernelOp op)
+{
+    vbool *res = buildvtype(BOOLOID, BATCHSIZE, NULL);
+    int i = 0;
+
+    if (arg2 == NULL)
+        rconst = PointerGetDatum(DatumGetNumeric(rconst));
+    else
+        Assert(arg1->dim == arg2->dim);
+
+    for (i = 0; i < arg1->dim; i++)
+    {
+        res->isnull[i] = arg1->isnull[i] || (arg2 != NULL && arg2->isnull[i]);
+        if (!res->isnull[i])
+            res->values[i] = BoolGetDatum(ext_cmp_result(op,
+                                          vnumeric_cmp(arg1->values[i],
+                                                       arg2 ? arg2->values[i] : rconst)));
+    }
+
+    res->dim = arg1->dim;
+    return res;
+}
+
+#define VNUMERIC_CMP(cmpstr) \
+PG_FUNCTION_INFO_V1(vnumeric_##cmpstr); \
+Datum \
+vnumeric_##cmpstr(PG_FUNCTION_ARGS) \
+{ \
+    PG_RETURN_POINTER(vnumeric_compare(PG_GETARG_POINTER(0), PG_GETARG_POINTER(1), \
+                                       (Datum) 0, VK_OP_##cmpstr)); \
+} \
+PG_FUNCTION_INFO_V1(vnumeric_##cmpstr##_numeric); \
+Datum \
+vnumeric_##cmpstr##_numeric(PG_FUNCTION_ARGS) \
+{ \
+    PG_RETURN_POINTER(vnumeric_compare(PG_GETARG_POINTER(0), NULL, \
+                                       PG_GETARG_DATUM(1), VK_OP_##cmpstr)); \
+}
+
+VNUMERIC_CMP(eq)
+VNUMERIC_CMP(ne)
+VNUMERIC_CMP(lt)
+VNUMERIC_CMP(le)
+VNUMERIC_CMP(gt)
+VNUMERIC_CMP(ge)
@@ -22,9 +22,21 @@
 #include "fmgr.h"
 #include "catalog/pg_type.h"
 #include "utils/date.h"
+#include "utils/timestamp.h"
+#include "utils/numeric.h"
 #include "vtype.h"
 
 typedef struct vtype vdateadt;
+typedef struct vtype vtimestamp;
+typedef struct vtype vnumeric;
+
+/*
+ * The values of the string types are the varlena Datums of the row
+ * executor, see ao_reader.c for how the scan packs them.
+ */
+typedef struct vtype vtext;
+typedef struct vtype vvarchar;
+typedef struct vtype vbpchar;
 
 extern Datum vdateadtin(PG_FUNCTION_ARGS);
 extern Datum vdateadtout(PG_FUNCTION_ARGS);
@@ -47,4 +59,73 @@ extern Datum vdateadt_ge_dateadt(PG_FUNCTION_ARGS);
 extern Datum vdateadt_mi_dateadt(PG_FUNCTION_ARGS);
 extern Datum vdateadt_mii_int4(PG_FUNCTION_ARGS);
 extern Datum vdateadt_pli_int4(PG_FUNCTION_ARGS);
+extern Datum vdateadt_timestamp(PG_FUNCTION_ARGS);
+extern Datum vdateadt_part(PG_FUNCTION_ARGS);
+
+extern Datum vtimestampin(PG_FUNCTION_ARGS);
+extern Datum vtimestampout(PG_FUNCTION_ARGS);
+extern Datum vtimestamp_eq(PG_FUNCTION_ARGS);
+extern Datum vtimestamp_ne(PG_FUNCTION_ARGS);
+extern Datum vtimestamp_lt(PG_FUNCTION_ARGS);
+extern Datum vtimestamp_le(PG_FUNCTION_ARGS);
+extern Datum vtimestamp_gt(PG_FUNCTION_ARGS);
+extern Datum vtimestamp_ge(PG_FUNCTION_ARGS);
+extern Datum vtimestamp_eq_timestamp(PG_FUNCTION_ARGS);
+extern Datum vtimestamp_ne_timestamp(PG_FUNCTION_ARGS);
+extern Datum vtimestamp_lt_timestamp(PG_FUNCTION_ARGS);
+extern Datum vtimestamp_le_timestamp(PG_FUNCTION_ARGS);
+extern Datum vtimestamp_gt_timestamp(PG_FUNCTION_ARGS);
+extern Datum vtimestamp_ge_timestamp(PG_FUNCTION_ARGS);
+extern Datum vtimestamp_part(PG_FUNCTION_ARGS);
+
+extern Datum vtextin(PG_FUNCTION_ARGS);
+extern Datum vtextout(PG_FUNCTION_ARGS);
+extern Datum vvarcharin(PG_FUNCTION_ARGS);
+extern Datum vvarcharout(PG_FUNCTION_ARGS);
+extern Datum vtext_eq(PG_FUNCTION_ARGS);
+extern Datum vtext_ne(PG_FUNCTION_ARGS);
+extern Datum vtext_lt(PG_FUNCTION_ARGS);
+extern Datum vtext_le(PG_FUNCTION_ARGS);
+extern Datum vtext_gt(PG_FUNCTION_ARGS);
+extern Datum vtext_ge(PG_FUNCTION_ARGS);
+extern Datum vtext_eq_text(PG_FUNCTION_ARGS);
+extern Datum vtext_ne_text(PG_FUNCTION_ARGS);
+extern Datum vtext_lt_text(PG_FUNCTION_ARGS);
+extern Datum vtext_le_text(PG_FUNCTION_ARGS);
+extern Datum vtext_gt_text(PG_FUNCTION_ARGS);
+extern Datum vtext_ge_text(PG_FUNCTION_ARGS);
+extern Datum vtext_like_text(PG_FUNCTION_ARGS);
+extern Datum vtext_nlike_text(PG_FUNCTION_ARGS);
+
+extern Datum vbpcharin(PG_FUNCTION_ARGS);
+extern Datum vbpcharout(PG_FUNCTION_ARGS);
+extern Datum vbpchar_eq(PG_FUNCTION_ARGS);
+extern Datum vbpchar_ne(PG_FUNCTION_ARGS);
+extern Datum vbpchar_lt(PG_FUNCTION_ARGS);
+extern Datum vbpchar_le(PG_FUNCTION_ARGS);
+extern Datum vbpchar_gt(PG_FUNCTION_ARGS);
+extern Datum vbpchar_ge(PG_FUNCTION_ARGS);
+extern Datum vbpchar_eq_bpchar(PG_FUNCTION_ARGS);
+extern Datum vbpchar_ne_bpchar(PG_FUNCTION_ARGS);
+extern Datum vbpchar_lt_bpchar(PG_FUNCTION_ARGS);
+extern Datum vbpchar_le_bpchar(PG_FUNCTION_ARGS);
+extern Datum vbpchar_gt_bpchar(PG_FUNCTION_ARGS);
+extern Datum vbpchar_ge_bpchar(PG_FUNCTION_ARGS);
+extern Datum vbpchar_like_text(PG_FUNCTION_ARGS);
+extern Datum vbpchar_nlike_text(PG_FUNCTION_ARGS);
+
+extern Datum vnumericin(PG_FUNCTION_ARGS);
+extern Datum vnumericout(PG_FUNCTION_ARGS);
+extern Datum vnumeric_eq(PG_FUNCTION_ARGS);
+extern Datum vnumeric_ne(PG_FUNCTION_ARGS);
+extern Datum vnumeric_lt(PG_FUNCTION_ARGS);
+extern Datum vnumeric_le(PG_FUNCTION_ARGS);
+extern Datum vnumeric_gt(PG_FUNCTION_ARGS);
+extern Datum vnumeric_ge(PG_FUNCTION_ARGS);
+extern Datum vnumeric_eq_numeric(PG_FUNCTION_ARGS);
+extern Datum vnumeric_ne_numeric(PG_FUNCTION_ARGS);
+extern Datum vnumeric_lt_numeric(PG_FUNCTION_ARGS);
+extern Datum vnumeric_le_numeric(PG_FUNCTION_ARGS);
+extern Datum vnumeric_gt_numeric(PG_FUNCTION_ARGS);
+extern Datum vnumeric_ge_numeric(PG_FUNCTION_ARGS);
 #endif
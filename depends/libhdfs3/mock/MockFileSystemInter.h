@@ -64,12 +64,13 @@ public:
   MOCK_CONST_METHOD0(getWorkingDirectory, std::string());
   MOCK_METHOD1(exist, bool(const char * path));
   MOCK_METHOD0(getFsStats, Hdfs::FileSystemStats());
+  MOCK_METHOD0(getIoStats, Hdfs::Internal::shared_ptr<Hdfs::Internal::IoStatsCounter>());
   MOCK_METHOD2(truncate, bool(const char * src, int64_t size));
   MOCK_METHOD1(getDelegationToken, std::string(const char * renewer));
   MOCK_METHOD0(getDelegationToken, std::string());
   MOCK_METHOD1(renewDelegationToken, int64_t(const std::string & token));
   MOCK_METHOD1(cancelDelegationToken, void(const std::string & token));
-  MOCK_METHOD6(create, void(const std::string & src, const Hdfs::Permission & masked, int flag, bool createParent, short replication, int64_t blockSize));
+  MOCK_METHOD6(create, Hdfs::Internal::shared_ptr<Hdfs::FileStatus>(const std::string & src, const Hdfs::Permission & masked, int flag, bool createParent, short replication, int64_t blockSize));
   MOCK_METHOD1(append, std::pair<Hdfs::Internal::shared_ptr<Hdfs::Internal::LocatedBlock>,
                Hdfs::Internal::shared_ptr<Hdfs::FileStatus> >(const std::string & src));
   MOCK_METHOD2(abandonBlock, void(const Hdfs::Internal::ExtendedBlock & b, const std::string & srcr));
@@ -93,12 +94,14 @@ public:
   MOCK_CONST_METHOD0(getConf, const Hdfs::Internal::SessionConfig &());
   MOCK_CONST_METHOD0(getUserInfo, const Hdfs::Internal::UserInfo &());
   MOCK_METHOD4(getBlockLocations, void(const std::string & src, int64_t offset, int64_t length, Hdfs::Internal::LocatedBlocks & lbs));
+  MOCK_METHOD1(invalidateMetadata, void(const std::string & src));
   MOCK_METHOD4(getListing, bool(const std::string & src, const std::string & , bool needLocation, std::vector<Hdfs::FileStatus> &));
   MOCK_METHOD2(listDirectory, Hdfs::DirectoryIterator(const char *, bool));
   MOCK_METHOD0(renewLease, bool());
   MOCK_METHOD0(registerOpenedOutputStream, void());
   MOCK_METHOD0(unregisterOpenedOutputStream, bool());
   MOCK_METHOD3(getFileBlockLocations, std::vector<Hdfs::BlockLocation> (const char * path, int64_t start, int64_t len));
+  MOCK_METHOD3(getFileBlockLocations, std::vector<std::vector<Hdfs::BlockLocation> > (const std::vector<std::string> & paths, int64_t start, int64_t len));
   MOCK_METHOD2(listAllDirectoryItems, std::vector<Hdfs::FileStatus> (const char * path, bool needLocation));
   MOCK_METHOD0(getPeerCache, Hdfs::Internal::PeerCache &());
   MOCK_METHOD2(createEncryptionZone, bool(const char * path, const char * keyName));
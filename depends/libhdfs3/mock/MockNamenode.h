@@ -39,7 +39,10 @@ class MockNamenode: public Namenode {
 public:
     MOCK_METHOD4(getBlockLocations, void(const std::string & src, int64_t offset,
                             int64_t length, LocatedBlocks & lbs));
-    MOCK_METHOD7(create, void(const std::string & src, const Permission & masked,
+    MOCK_METHOD4(getBlockLocationsBatch, void(const std::vector<std::string> & srcs,
+                            int64_t offset, int64_t length,
+                            std::vector<shared_ptr<LocatedBlocks> > & lbs));
+    MOCK_METHOD7(create, shared_ptr<FileStatus>(const std::string & src, const Permission & masked,
           const std::string & clientName, int flag, bool createParent,
           short replication, int64_t blockSize));
     MOCK_METHOD2(append, std::pair<shared_ptr<LocatedBlock>,
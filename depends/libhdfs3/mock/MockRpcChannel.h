@@ -32,6 +32,9 @@ class MockRpcChannel: public Hdfs::Internal::RpcChannel {
 public:
 	MOCK_METHOD0(close, void());
 	MOCK_METHOD1(invoke, void(const Hdfs::Internal::RpcCall &));
+	MOCK_METHOD2(invokeAsync, Hdfs::Internal::RpcFuture(const Hdfs::Internal::RpcCall &,
+			const Hdfs::Internal::RpcCallback &));
+	MOCK_METHOD1(waitFor, void(Hdfs::Internal::RpcRemoteCallPtr));
 	MOCK_METHOD0(checkIdle, bool());
 	MOCK_METHOD0(waitForExit, void());
 	MOCK_METHOD0(addRef, void());
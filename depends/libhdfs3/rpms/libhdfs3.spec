@@ -35,6 +35,7 @@ BuildRequires: libuuid-devel
 BuildRequires: libxml2-devel
 BuildRequires: krb5-devel
 BuildRequires: libgsasl-devel
+BuildRequires: openssl-devel
 BuildRequires: protobuf-devel
 
 %description
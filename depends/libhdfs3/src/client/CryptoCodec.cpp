@@ -0,0 +1,126 @@
+/********************************************************************
+ * 2014 -
+ * open source under Apache License Version 2.0
+ ********************************************************************/
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "CryptoCodec.h"
+#include "Exception.h"
+#include "ExceptionInternal.h"
+
+#include <inttypes.h>
+#include <limits>
+#include <openssl/evp.h>
+
+namespace Hdfs {
+namespace Internal {
+
+/* CipherSuiteProto::AES_CTR_NOPADDING */
+static const int AesCtrNoPadding = 2;
+static const int AesBlockSize = 16;
+
+CryptoCodec::CryptoCodec(const FileEncryptionInfo & info, const std::string & key) :
+    ctx(NULL), next(-1), iv(info.getIv()), key(key) {
+    if (info.getSuite() != AesCtrNoPadding) {
+        THROW(UnsupportedOperationException,
+              "CryptoCodec: unsupported cipher suite %d of encryption key %s.",
+              info.getSuite(), info.getKeyName().c_str());
+    }
+
+    if (iv.size() != AesBlockSize || (key.size() != 16 && key.size() != 32)) {
+        THROW(HdfsIOException,
+              "CryptoCodec: invalid IV or data encryption key of key %s, %d and %d bytes.",
+              info.getKeyName().c_str(), static_cast<int>(iv.size()),
+              static_cast<int>(key.size()));
+    }
+
+    if (NULL == (ctx = EVP_CIPHER_CTX_new())) {
+        throw std::bad_alloc();
+    }
+}
+
+CryptoCodec::~CryptoCodec() {
+    EVP_CIPHER_CTX_free(ctx);
+}
+
+/*
+ * Set the counter to the block of the offset, and skip the key stream of
+ * the bytes of the block before the offset. The counter is the file IV plus
+ * the block number, as a 128 bit big endian number.
+ */
+void CryptoCodec::resetCounter(int64_t offset) {
+    unsigned char counter[AesBlockSize];
+    unsigned char skip[AesBlockSize];
+    uint64_t block = static_cast<uint64_t>(offset / AesBlockSize);
+    int padding = static_cast<int>(offset % AesBlockSize);
+    int sum = 0, len;
+
+    for (int i = AesBlockSize - 1; i >= 0; --i) {
+        sum = static_cast<unsigned char>(iv[i]) + (sum >> 8);
+
+        if (i >= AesBlockSize - 8) {
+            sum += static_cast<int>(block & 0xFF);
+            block >>= 8;
+        }
+
+        counter[i] = static_cast<unsigned char>(sum);
+    }
+
+    const EVP_CIPHER * cipher = key.size() == 16 ? EVP_aes_128_ctr() : EVP_aes_256_ctr();
+
+    if (1 != EVP_EncryptInit_ex(ctx, cipher, NULL,
+                                reinterpret_cast<const unsigned char *>(key.data()), counter)
+            || 1 != EVP_CIPHER_CTX_set_padding(ctx, 0)
+            || (padding > 0 && 1 != EVP_EncryptUpdate(ctx, skip, &len, skip, padding))) {
+        next = -1;
+        THROW(HdfsIOException, "CryptoCodec: cannot set the cipher to offset %" PRId64 ".",
+              offset);
+    }
+
+    next = offset;
+}
+
+void CryptoCodec::process(const char * in, char * out, int64_t size, int64_t offset) {
+    int len;
+
+    if (offset != next) {
+        resetCounter(offset);
+    }
+
+    while (size > 0) {
+        int batch = size < std::numeric_limits<int>::max() ?
+                    static_cast<int>(size) : std::numeric_limits<int>::max();
+
+        if (1 != EVP_EncryptUpdate(ctx, reinterpret_cast<unsigned char *>(out), &len,
+                                   reinterpret_cast<const unsigned char *>(in), batch)
+                || len != batch) {
+            int64_t at = next;
+            next = -1;
+            THROW(HdfsIOException, "CryptoCodec: cannot process %d bytes at offset %" PRId64 ".",
+                  batch, at);
+        }
+
+        in += batch;
+        out += batch;
+        size -= batch;
+        next += batch;
+    }
+}
+
+}
+}
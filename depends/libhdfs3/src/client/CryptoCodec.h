@@ -0,0 +1,78 @@
+/********************************************************************
+ * 2014 -
+ * open source under Apache License Version 2.0
+ ********************************************************************/
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HDFS_LIBHDFS3_CLIENT_CRYPTOCODEC_H_
+#define _HDFS_LIBHDFS3_CLIENT_CRYPTOCODEC_H_
+
+#include "FileEncryptionInfo.h"
+
+#include <stdint.h>
+#include <string>
+
+typedef struct evp_cipher_ctx_st EVP_CIPHER_CTX;
+
+namespace Hdfs {
+namespace Internal {
+
+/**
+ * The AES/CTR/NoPadding cipher of the files in an encryption zone, through
+ * OpenSSL EVP, which uses AES-NI where the cpu has it.
+ *
+ * In counter mode encryption and decryption are the same operation, and
+ * the key stream at any offset of the file can be computed directly from
+ * the file IV, so a range of the file is processed without the bytes
+ * before it. Not thread safe, each stream has its own codec.
+ */
+class CryptoCodec {
+public:
+    /**
+     * @param info the encryption information of the file.
+     * @param key the decrypted data encryption key of the file.
+     */
+    CryptoCodec(const FileEncryptionInfo & info, const std::string & key);
+    ~CryptoCodec();
+
+    /**
+     * Encrypt or decrypt size bytes of the file.
+     * @param in the bytes to process.
+     * @param out where to put the result, it may be in.
+     * @param size the number of bytes.
+     * @param offset the offset of the first byte in the file.
+     */
+    void process(const char * in, char * out, int64_t size, int64_t offset);
+
+private:
+    CryptoCodec(const CryptoCodec & other);
+    CryptoCodec & operator =(const CryptoCodec & other);
+
+    void resetCounter(int64_t offset);
+
+private:
+    EVP_CIPHER_CTX * ctx;
+    int64_t next; // offset the context is at, -1 if unknown
+    std::string iv;
+    std::string key;
+};
+
+}
+}
+
+#endif /* _HDFS_LIBHDFS3_CLIENT_CRYPTOCODEC_H_ */
@@ -26,6 +26,7 @@
 #include "FileSystem.h"
 #include "FileSystemImpl.h"
 #include "FileSystemKey.h"
+#include "FileSystemPool.h"
 #include "Hash.h"
 #include "SessionConfig.h"
 #include "Thread.h"
@@ -143,7 +144,7 @@ FileSystem::FileSystem(const Config & conf) :
 FileSystem::FileSystem(const FileSystem & other) :
     conf(other.conf), impl(NULL) {
     if (other.impl) {
-        impl = new FileSystemWrapper(other.impl->filesystem);
+        impl = new FileSystemWrapper(other.impl->filesystem, other.impl->poolKey);
     }
 }
 
@@ -160,7 +161,7 @@ FileSystem & FileSystem::operator =(const FileSystem & other) {
     }
 
     if (other.impl) {
-        impl = new FileSystemWrapper(other.impl->filesystem);
+        impl = new FileSystemWrapper(other.impl->filesystem, other.impl->poolKey);
     }
 
     return *this;
@@ -188,19 +189,35 @@ void FileSystem::connect(const char * uri) {
     connect(uri, NULL, NULL);
 }
 
+/**
+ * Take a file system connected with the same credentials out of the pool,
+ * or connect a new one.
+ */
 static FileSystemWrapper * ConnectInternal(const char * uri,
         const std::string & principal, const Token * token, Config & conf) {
     if (NULL == uri || 0 == strlen(uri)) {
         THROW(InvalidParameter, "Invalid HDFS uri.");
     }
 
-    FileSystemKey key(uri, principal.c_str());
+    SessionConfig sconf(conf);
+    FileSystemPool pool(sconf);
+    std::string poolKey = FileSystemPool::BuildKey(uri, principal, token, conf);
+    shared_ptr<FileSystemInter> fs = pool.getFileSystem(poolKey);
+
+    if (fs) {
+        fs->setWorkingDirectory(fs->getHomeDirectory().c_str());
+    } else {
+        FileSystemKey key(uri, principal.c_str());
 
-    if (token) {
-        key.addToken(*token);
+        if (token) {
+            key.addToken(*token);
+        }
+
+        fs = shared_ptr<FileSystemInter>(new FileSystemImpl(key, conf));
+        fs->connect();
     }
 
-    return new FileSystemWrapper(shared_ptr<FileSystemInter>(new FileSystemImpl(key, conf)));
+    return new FileSystemWrapper(fs, poolKey);
 }
 
 /**
@@ -227,7 +244,6 @@ void FileSystem::connect(const char * uri, const char * username, const char * t
             t.fromString(token);
             principal = ExtractPrincipalFromToken(t);
             impl = ConnectInternal(uri, principal, &t, conf);
-            impl->filesystem->connect();
             return;
         } else if (username) {
             principal = username;
@@ -238,7 +254,6 @@ void FileSystem::connect(const char * uri, const char * username, const char * t
         }
 
         impl = ConnectInternal(uri, principal, NULL, conf);
-        impl->filesystem->connect();
     } catch (...) {
         delete impl;
         impl = NULL;
@@ -247,9 +262,16 @@ void FileSystem::connect(const char * uri, const char * username, const char * t
 }
 
 /**
- * disconnect from hdfs
+ * disconnect from hdfs, the file system is kept in the pool if no other
+ * FileSystem or stream uses it.
  */
 void FileSystem::disconnect() {
+    if (impl && !impl->poolKey.empty() && impl->filesystem.use_count() == 1) {
+        SessionConfig sconf(conf);
+        FileSystemPool pool(sconf);
+        pool.addFileSystem(impl->poolKey, impl->filesystem);
+    }
+
     delete impl;
     impl = NULL;
 }
@@ -369,6 +391,24 @@ std::vector<BlockLocation> FileSystem::getFileBlockLocations(const char * path,
     return impl->filesystem->getFileBlockLocations(path, start, len);
 }
 
+/**
+ * Return the locations of the same range of several files, asked to the
+ * namenode in parallel.
+ *
+ * @param paths the files
+ * @param start offset into the given files
+ * @param len length for which to get locations for
+ * @return the locations of each file, in the order of paths
+ */
+std::vector<std::vector<BlockLocation> > FileSystem::getFileBlockLocations(
+    const std::vector<std::string> & paths, int64_t start, int64_t len) {
+    if (!impl) {
+        THROW(HdfsIOException, "FileSystem: not connected.");
+    }
+
+    return impl->filesystem->getFileBlockLocations(paths, start, len);
+}
+
 /**
  * list the contents of a directory.
  * @param path the directory path.
@@ -516,6 +556,18 @@ FileSystemStats FileSystem::getStats() const {
     return impl->filesystem->getFsStats();
 }
 
+/**
+ * To get the I/O statistics of all the streams of the file system.
+ * @return the I/O statistics.
+ */
+IoStatistics FileSystem::getIoStatistics() const {
+    if (!impl) {
+        THROW(HdfsIOException, "FileSystem: not connected.");
+    }
+
+    return impl->filesystem->getIoStats()->get();
+}
+
 /**
  * Truncate the file in the indicated path to the indicated size.
  * @param src The path to the file to be truncated
@@ -27,6 +27,7 @@
 #include "EncryptionZoneIterator.h"
 #include "FileStatus.h"
 #include "FileSystemStats.h"
+#include "IoStatistics.h"
 #include "EncryptionZoneInfo.h"
 #include "Permission.h"
 #include "XmlConfig.h"
@@ -154,6 +155,18 @@ public:
     std::vector<BlockLocation> getFileBlockLocations(const char * path,
             int64_t start, int64_t len);
 
+    /**
+     * Return the locations of the same range of several files, asked to the
+     * namenode in parallel.
+     *
+     * @param paths the files
+     * @param start offset into the given files
+     * @param len length for which to get locations for
+     * @return the locations of each file, in the order of paths
+     */
+    std::vector<std::vector<BlockLocation> > getFileBlockLocations(
+        const std::vector<std::string> & paths, int64_t start, int64_t len);
+
     /**
      * list the contents of a directory.
      * @param path The directory path.
@@ -234,6 +247,12 @@ public:
      */
     FileSystemStats getStats() const;
 
+    /**
+     * To get the I/O statistics of all the streams of the file system.
+     * @return the I/O statistics.
+     */
+    IoStatistics getIoStatistics() const;
+
     /**
      * Truncate the file in the indicated path to the indicated size.
      * @param src The path to the file to be truncated
@@ -32,6 +32,7 @@
 #include "InputStream.h"
 #include "LeaseRenewer.h"
 #include "Logger.h"
+#include "MetadataCache.h"
 #include "OutputStream.h"
 #include "OutputStreamImpl.h"
 #include "server/LocatedBlocks.h"
@@ -112,6 +113,13 @@ FileSystemImpl::FileSystemImpl(const FileSystemKey& key, const Config& c)
     clientName = ss.str();
     workingDir = std::string("/user/") + user.getEffectiveUser();
     peerCache = shared_ptr<PeerCache>(new PeerCache(sconf));
+    ioStats = shared_ptr<IoStatsCounter>(new IoStatsCounter);
+
+    if (sconf.getMetadataCacheSize() > 0) {
+        metadataCache = shared_ptr<MetadataCache>(new MetadataCache(
+                            sconf.getMetadataCacheSize(), sconf.getMetadataCacheExpiry()));
+    }
+
 #ifdef MOCK
     stub = NULL;
 #endif
@@ -235,6 +243,10 @@ bool FileSystemImpl::deletePath(const char * path, bool recursive) {
         THROW(InvalidParameter, "Invalid input: path should not be empty");
     }
 
+    if (metadataCache) {
+        metadataCache->invalidateAll();
+    }
+
     return nn->deleteFile(getStandardPath(path), recursive);
 }
 
@@ -291,7 +303,20 @@ FileStatus FileSystemImpl::getFileStatus(const char * path) {
         THROW(InvalidParameter, "Invalid input: path should not be empty");
     }
 
-    return nn->getFileInfo(getStandardPath(path), NULL);
+    std::string absPath = getStandardPath(path);
+    FileStatus retval;
+
+    if (metadataCache && metadataCache->getFileStatus(absPath, retval)) {
+        return retval;
+    }
+
+    retval = nn->getFileInfo(absPath, NULL);
+
+    if (metadataCache) {
+        metadataCache->putFileStatus(absPath, retval);
+    }
+
+    return retval;
 }
 
 static void Convert(BlockLocation & bl, const LocatedBlock & lb) {
@@ -314,6 +339,15 @@ static void Convert(BlockLocation & bl, const LocatedBlock & lb) {
     bl.setTopologyPaths(topologyPaths);
 }
 
+static void Convert(std::vector<BlockLocation> & bls, LocatedBlocks & lbs) {
+    const std::vector<LocatedBlock> & blocks = lbs.getBlocks();
+    bls.resize(blocks.size());
+
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        Convert(bls[i], blocks[i]);
+    }
+}
+
 std::vector<BlockLocation> FileSystemImpl::getFileBlockLocations(
     const char * path, int64_t start, int64_t len) {
     if (!nn) {
@@ -333,14 +367,9 @@ std::vector<BlockLocation> FileSystemImpl::getFileBlockLocations(
     }
 
     LocatedBlocksImpl lbs;
-    nn->getBlockLocations(getStandardPath(path), start, len, lbs);
-    std::vector<LocatedBlock> blocks = lbs.getBlocks();
-    std::vector<BlockLocation> retval(blocks.size());
-
-    for (size_t i = 0; i < blocks.size(); ++i) {
-        Convert(retval[i], blocks[i]);
-    }
-
+    getBlockLocations(getStandardPath(path), start, len, lbs);
+    std::vector<BlockLocation> retval;
+    Convert(retval, lbs);
     return retval;
 }
 
@@ -411,6 +440,7 @@ void FileSystemImpl::setOwner(const char * path, const char * username,
               "Invalid input: username and groupname should not be empty");
     }
 
+    invalidateMetadata(getStandardPath(path));
     nn->setOwner(getStandardPath(path), username != NULL ? username : "",
                  groupname != NULL ? groupname : "");
 }
@@ -430,6 +460,7 @@ void FileSystemImpl::setTimes(const char * path, int64_t mtime, int64_t atime) {
         THROW(InvalidParameter, "Invalid input: path should not be empty");
     }
 
+    invalidateMetadata(getStandardPath(path));
     nn->setTimes(getStandardPath(path), mtime, atime);
 }
 
@@ -448,6 +479,7 @@ void FileSystemImpl::setPermission(const char * path,
         THROW(InvalidParameter, "Invalid input: path should not be empty");
     }
 
+    invalidateMetadata(getStandardPath(path));
     nn->setPermission(getStandardPath(path), permission);
 }
 
@@ -467,6 +499,7 @@ bool FileSystemImpl::setReplication(const char * path, short replication) {
         THROW(InvalidParameter, "Invalid input: path should not be empty");
     }
 
+    invalidateMetadata(getStandardPath(path));
     return nn->setReplication(getStandardPath(path), replication);
 }
 
@@ -490,6 +523,10 @@ bool FileSystemImpl::rename(const char * src, const char * dst) {
         THROW(InvalidParameter, "Invalid input: dst should not be empty");
     }
 
+    if (metadataCache) {
+        metadataCache->invalidateAll();
+    }
+
     return nn->rename(getStandardPath(src), getStandardPath(dst));
 }
 
@@ -536,7 +573,19 @@ bool FileSystemImpl::exist(const char * path) {
 
     try {
         bool retval = true;
-        nn->getFileInfo(getStandardPath(path), &retval);
+        std::string absPath = getStandardPath(path);
+        FileStatus status;
+
+        if (metadataCache && metadataCache->getFileStatus(absPath, status)) {
+            return true;
+        }
+
+        status = nn->getFileInfo(absPath, &retval);
+
+        if (retval && metadataCache) {
+            metadataCache->putFileStatus(absPath, status);
+        }
+
         return retval;
     } catch (const FileNotFoundException & e) {
         return false;
@@ -559,6 +608,10 @@ FileSystemStats FileSystemImpl::getFsStats() {
     return FileSystemStats(retval[0], retval[1], retval[2]);
 }
 
+shared_ptr<IoStatsCounter> FileSystemImpl::getIoStats() {
+    return ioStats;
+}
+
 /**
  * Truncate the file in the indicated path to the indicated size.
  * @param path The path to the file to be truncated
@@ -579,7 +632,7 @@ bool FileSystemImpl::truncate(const char * path, int64_t size) {
     }
 
     std::string absPath = getStandardPath(path);
-
+    invalidateMetadata(absPath);
     return nn->truncate(absPath, size, clientName);
 }
 
@@ -627,17 +680,101 @@ void FileSystemImpl::getBlockLocations(const std::string & src, int64_t offset,
         THROW(HdfsIOException, "FileSystemImpl: not connected.");
     }
 
+    if (metadataCache && metadataCache->getBlockLocations(src, offset, length, lbs)) {
+        return;
+    }
+
     nn->getBlockLocations(src, offset, length, lbs);
+
+    if (metadataCache) {
+        metadataCache->putBlockLocations(src, offset, length, lbs);
+    }
 }
 
-void FileSystemImpl::create(const std::string & src, const Permission & masked,
+/*
+ * The lookups missing from the cache are sent to the namenode together,
+ * dfs.client.metadata.batch.parallelism of them at a time.
+ */
+std::vector<std::vector<BlockLocation> > FileSystemImpl::getFileBlockLocations(
+    const std::vector<std::string> & paths, int64_t start, int64_t len) {
+    if (!nn) {
+        THROW(HdfsIOException, "FileSystemImpl: not connected.");
+    }
+
+    if (start < 0) {
+        THROW(InvalidParameter, "Invalid input: start offset should be positive");
+    }
+
+    if (len < 0) {
+        THROW(InvalidParameter, "Invalid input: length should be positive");
+    }
+
+    std::vector<std::vector<BlockLocation> > retval(paths.size());
+    std::vector<std::string> srcs;
+    std::vector<size_t> index;
+
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (paths[i].empty()) {
+            THROW(InvalidParameter, "Invalid input: path should not be empty");
+        }
+
+        LocatedBlocksImpl lbs;
+        std::string src = getStandardPath(paths[i].c_str());
+
+        if (metadataCache && metadataCache->getBlockLocations(src, start, len, lbs)) {
+            Convert(retval[i], lbs);
+        } else {
+            srcs.push_back(src);
+            index.push_back(i);
+        }
+    }
+
+    size_t window = sconf.getMetadataBatchParallelism();
+
+    for (size_t s = 0; s < srcs.size(); s += window) {
+        size_t e = std::min(srcs.size(), s + window);
+        std::vector<std::string> batch(srcs.begin() + s, srcs.begin() + e);
+        std::vector<shared_ptr<LocatedBlocks> > lbs;
+        nn->getBlockLocationsBatch(batch, start, len, lbs);
+
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (metadataCache) {
+                metadataCache->putBlockLocations(batch[i], start, len, *lbs[i]);
+            }
+
+            Convert(retval[index[s + i]], *lbs[i]);
+        }
+    }
+
+    return retval;
+}
+
+void FileSystemImpl::invalidateMetadata(const std::string & src) {
+    if (metadataCache) {
+        metadataCache->invalidate(src);
+    }
+}
+
+shared_ptr<FileStatus> FileSystemImpl::create(const std::string & src, const Permission & masked,
                             int flag, bool createParent, short replication, int64_t blockSize) {
     if (!nn) {
         THROW(HdfsIOException, "FileSystemImpl: not connected.");
     }
 
-    nn->create(src, masked, clientName, flag, createParent, replication,
-               blockSize);
+    if (metadataCache) {
+        metadataCache->beginWrite(src);
+    }
+
+    try {
+        return nn->create(src, masked, clientName, flag, createParent, replication,
+                          blockSize);
+    } catch (...) {
+        if (metadataCache) {
+            metadataCache->endWrite(src);
+        }
+
+        throw;
+    }
 }
 
 std::pair<shared_ptr<LocatedBlock>, shared_ptr<FileStatus> >
@@ -646,7 +783,19 @@ FileSystemImpl::append(const std::string& src) {
         THROW(HdfsIOException, "FileSystemImpl: not connected.");
     }
 
-    return nn->append(src, clientName);
+    if (metadataCache) {
+        metadataCache->beginWrite(src);
+    }
+
+    try {
+        return nn->append(src, clientName);
+    } catch (...) {
+        if (metadataCache) {
+            metadataCache->endWrite(src);
+        }
+
+        throw;
+    }
 }
 
 void FileSystemImpl::abandonBlock(const ExtendedBlock & b,
@@ -687,7 +836,13 @@ bool FileSystemImpl::complete(const std::string & src,
         THROW(HdfsIOException, "FileSystemImpl: not connected.");
     }
 
-    return nn->complete(src, clientName, last);
+    bool retval = nn->complete(src, clientName, last);
+
+    if (retval && metadataCache) {
+        metadataCache->endWrite(src);
+    }
+
+    return retval;
 }
 
 /*void FileSystemImpl::reportBadBlocks(const std::vector<LocatedBlock> & blocks) {
@@ -703,6 +858,7 @@ void FileSystemImpl::fsync(const std::string & src) {
         THROW(HdfsIOException, "FileSystemImpl: not connected.");
     }
 
+    invalidateMetadata(src);
     nn->fsync(src, clientName);
 }
 
@@ -47,6 +47,7 @@ namespace Hdfs {
 namespace Internal {
 
 class InputStreamInter;
+class MetadataCache;
 class OutputStreamInter;
 
 class FileSystemImpl: public FileSystemInter {
@@ -153,6 +154,17 @@ public:
     std::vector<BlockLocation> getFileBlockLocations(
         const char * path, int64_t start, int64_t len);
 
+    /**
+     * Return the block locations of the same range of several files, the
+     * requests are sent to the namenode in parallel.
+     * @param paths the files.
+     * @param start offset into the given files.
+     * @param len length for which to get locations for.
+     * @return the locations of each file, in the order of paths.
+     */
+    std::vector<std::vector<BlockLocation> > getFileBlockLocations(
+        const std::vector<std::string> & paths, int64_t start, int64_t len);
+
     /**
      * list the contents of a directory.
      * @param path the directory path.
@@ -234,6 +246,12 @@ public:
      */
     FileSystemStats getFsStats();
 
+    /**
+     * Get the I/O counters shared by all the streams of the file system.
+     * @return the I/O counters of the file system.
+     */
+    shared_ptr<IoStatsCounter> getIoStats();
+
     /**
      * Truncate the file in the indicated path to the indicated size.
      * @param path The path to the file to be truncated
@@ -294,6 +312,13 @@ public:
     void getBlockLocations(const std::string & src, int64_t offset,
                            int64_t length, LocatedBlocks & lbs);
 
+    /**
+     * Drop the cached status and block locations of the file, so they are
+     * asked to the namenode next time.
+     * @param src file name
+     */
+    void invalidateMetadata(const std::string & src);
+
     /**
      * Create a new file entry in the namespace.
      *
@@ -304,8 +329,9 @@ public:
      * @param createParent create missing parent directory if true
      * @param replication block replication factor.
      * @param blockSize maximum block size.
+     * @return the status of the new file, if the namenode returns it.
      */
-    void create(const std::string & src, const Permission & masked, int flag,
+    shared_ptr<FileStatus> create(const std::string & src, const Permission & masked, int flag,
                 bool createParent, short replication, int64_t blockSize);
 
     /**
@@ -524,6 +550,8 @@ private:
     mutex mutWorkingDir;
     Namenode * nn;
     SessionConfig sconf;
+    shared_ptr<IoStatsCounter> ioStats;
+    shared_ptr<MetadataCache> metadataCache;
     shared_ptr<PeerCache> peerCache;
     std::string clientName;
     std::string tokenService;
@@ -32,6 +32,7 @@
 #include "FileSystemKey.h"
 #include "FileSystemStats.h"
 #include "EncryptionZoneInfo.h"
+#include "IoStatsCounter.h"
 #include "PeerCache.h"
 #include "Permission.h"
 #include "server/LocatedBlocks.h"
@@ -52,11 +53,13 @@ class FileSystemInter;
 
 struct FileSystemWrapper {
 public:
-    FileSystemWrapper(shared_ptr<FileSystemInter> fs) :
-        filesystem(fs) {
+    FileSystemWrapper(shared_ptr<FileSystemInter> fs,
+                      const std::string & poolKey = std::string()) :
+        filesystem(fs), poolKey(poolKey) {
     }
 
     shared_ptr<FileSystemInter> filesystem;
+    std::string poolKey; //the key of the file system in FileSystemPool
 };
 
 class FileSystemInter {
@@ -157,6 +160,17 @@ public:
     virtual std::vector<BlockLocation> getFileBlockLocations(
         const char * path, int64_t start, int64_t len) = 0;
 
+    /**
+     * Return the block locations of the same range of several files, the
+     * requests are sent to the namenode in parallel.
+     * @param paths the files.
+     * @param start offset into the given files.
+     * @param len length for which to get locations for.
+     * @return the locations of each file, in the order of paths.
+     */
+    virtual std::vector<std::vector<BlockLocation> > getFileBlockLocations(
+        const std::vector<std::string> & paths, int64_t start, int64_t len) = 0;
+
     /**
      * list the contents of a directory.
      * @param path the directory path.
@@ -240,6 +254,12 @@ public:
      */
     virtual FileSystemStats getFsStats() = 0;
 
+    /**
+     * Get the I/O counters shared by all the streams of the file system.
+     * @return the I/O counters of the file system.
+     */
+    virtual shared_ptr<IoStatsCounter> getIoStats() = 0;
+
     /**
      * Truncate the file in the indicated path to the indicated size.
      * @param src The path we will find the file to be truncated.
@@ -299,6 +319,13 @@ public:
     virtual void getBlockLocations(const std::string & src, int64_t offset,
                                    int64_t length, LocatedBlocks & lbs) = 0;
 
+    /**
+     * Drop the cached status and block locations of the file, so they are
+     * asked to the namenode next time.
+     * @param src file name
+     */
+    virtual void invalidateMetadata(const std::string & src) = 0;
+
     /**
      * Create a new file entry in the namespace.
      *
@@ -309,8 +336,9 @@ public:
      * @param createParent create missing parent directory if true
      * @param replication block replication factor.
      * @param blockSize maximum block size.
+     * @return the status of the new file, if the namenode returns it.
      */
-    virtual void create(const std::string & src, const Permission & masked,
+    virtual shared_ptr<FileStatus> create(const std::string & src, const Permission & masked,
                         int flag, bool createParent, short replication,
                         int64_t blockSize) = 0;
 
@@ -0,0 +1,75 @@
+/********************************************************************
+ * 2014 -
+ * open source under Apache License Version 2.0
+ ********************************************************************/
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "FileSystemPool.h"
+#include "Logger.h"
+
+#include <inttypes.h>
+#include <sstream>
+
+namespace Hdfs {
+namespace Internal {
+
+LruMap<std::string, FileSystemPool::value_type> & FileSystemPool::Map =
+    *new LruMap<std::string, FileSystemPool::value_type>;
+
+FileSystemPool::FileSystemPool(const SessionConfig & conf) :
+    poolSize(conf.getFileSystemPoolSize()),
+    expireTimeInterval(conf.getFileSystemPoolExpiry()) {
+    Map.setMaxSize(poolSize);
+}
+
+std::string FileSystemPool::BuildKey(const char * uri, const std::string & principal,
+                                     const Token * token, const Config & conf) {
+    std::stringstream ss;
+    ss.imbue(std::locale::classic());
+    ss << uri << '\n' << principal << '\n' << (token ? token->toString() : "")
+       << '\n' << conf.hash_value();
+    return ss.str();
+}
+
+shared_ptr<FileSystemInter> FileSystemPool::getFileSystem(const std::string & key) {
+    value_type value;
+    int64_t elapsed;
+
+    if (poolSize <= 0 || !Map.findAndErase(key, &value)) {
+        return shared_ptr<FileSystemInter>();
+    }
+
+    if ((elapsed = ToMilliSeconds(value.second, steady_clock::now())) > expireTimeInterval) {
+        LOG(DEBUG1, "FileSystemPool expire for file system idle %" PRId64 " ms.", elapsed);
+        return shared_ptr<FileSystemInter>();
+    }
+
+    LOG(DEBUG1, "FileSystemPool hit for file system idle %" PRId64 " ms.", elapsed);
+    return value.first;
+}
+
+void FileSystemPool::addFileSystem(const std::string & key, shared_ptr<FileSystemInter> fs) {
+    if (poolSize <= 0) {
+        return;
+    }
+
+    Map.insert(key, value_type(fs, steady_clock::now()));
+}
+
+}
+}
@@ -0,0 +1,81 @@
+/********************************************************************
+ * 2014 -
+ * open source under Apache License Version 2.0
+ ********************************************************************/
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HDFS_LIBHDFS3_CLIENT_FILESYSTEMPOOL_H_
+#define _HDFS_LIBHDFS3_CLIENT_FILESYSTEMPOOL_H_
+
+#include <string>
+#include <utility>
+
+#include "DateTime.h"
+#include "FileSystemInter.h"
+#include "LruMap.h"
+#include "Memory.h"
+#include "SessionConfig.h"
+#include "Token.h"
+#include "XmlConfig.h"
+
+namespace Hdfs {
+namespace Internal {
+
+/**
+ * The file systems disconnected by the process, kept to be reused by the
+ * next connection with the same key. The key is made of the uri, the
+ * user, the token and the configuration, so that a file system is only
+ * reused with the credentials it was connected with.
+ */
+class FileSystemPool {
+public:
+    explicit FileSystemPool(const SessionConfig & conf);
+
+    /**
+     * Take a file system out of the pool.
+     * @param key the key of the connection.
+     * @return the file system, or empty if none or if it expired.
+     */
+    shared_ptr<FileSystemInter> getFileSystem(const std::string & key);
+
+    /**
+     * Keep a disconnected file system in the pool.
+     * @param key the key of the connection.
+     * @param fs the file system, with no stream open.
+     */
+    void addFileSystem(const std::string & key, shared_ptr<FileSystemInter> fs);
+
+    static std::string BuildKey(const char * uri, const std::string & principal,
+                                const Token * token, const Config & conf);
+
+    typedef std::pair<shared_ptr<FileSystemInter>, steady_clock::time_point> value_type;
+
+private:
+    const int poolSize;
+    int64_t expireTimeInterval; // milliseconds
+
+    /*
+     * never destroyed, a file system closes its rpc channels when it is.
+     */
+    static LruMap<std::string, value_type> & Map;
+};
+
+}
+}
+
+#endif /* _HDFS_LIBHDFS3_CLIENT_FILESYSTEMPOOL_H_ */
@@ -26,6 +26,7 @@
 #include "FileSystem.h"
 #include "hdfs.h"
 #include "InputStream.h"
+#include "InputStreamInter.h"
 #include "Logger.h"
 #include "Logger.h"
 #include "Memory.h"
@@ -92,6 +93,26 @@ using Hdfs::Internal::shared_ptr;
 using Hdfs::NamenodeInfo;
 using Hdfs::FileNotFoundException;
 
+struct hadoopRzOptions {
+    hadoopRzOptions() :
+        skipChecksum(false) {
+    }
+
+    bool skipChecksum;
+};
+
+struct hadoopRzBuffer {
+    hadoopRzBuffer() :
+        buffer(NULL) {
+    }
+
+    ~hadoopRzBuffer() {
+        delete buffer;
+    }
+
+    Hdfs::Internal::ZeroCopyBuffer * buffer;
+};
+
 struct HdfsFileInternalWrapper {
 public:
     HdfsFileInternalWrapper() :
@@ -791,6 +812,96 @@ tSize hdfsRead(hdfsFS fs, hdfsFile file, void * buffer, tSize length) {
     return -1;
 }
 
+int hdfsPreadv(hdfsFS fs, hdfsFile file, const hdfsReadRange * ranges, int count) {
+    PARAMETER_ASSERT(fs && file && ranges && count > 0, -1, EINVAL);
+    PARAMETER_ASSERT(file->isInput(), -1, EINVAL);
+
+    try {
+        std::vector<Hdfs::ReadRange> v(count);
+
+        for (int i = 0; i < count; ++i) {
+            v[i].offset = ranges[i].offset;
+            v[i].length = ranges[i].length;
+            v[i].buf = static_cast<char *>(ranges[i].buffer);
+        }
+
+        file->getInputStream().preadv(&v[0], count);
+        return 0;
+    } catch (const std::bad_alloc & e) {
+        SetErrorMessage("Out of memory");
+        errno = ENOMEM;
+    } catch (...) {
+        SetLastException(Hdfs::current_exception());
+        handleException(Hdfs::current_exception());
+    }
+
+    return -1;
+}
+
+struct hadoopRzOptions * hadoopRzOptionsAlloc(void) {
+    try {
+        return new hadoopRzOptions;
+    } catch (const std::bad_alloc & e) {
+        SetErrorMessage("Out of memory");
+        errno = ENOMEM;
+    }
+
+    return NULL;
+}
+
+int hadoopRzOptionsSetSkipChecksum(struct hadoopRzOptions * opts, int skip) {
+    PARAMETER_ASSERT(opts, -1, EINVAL);
+    opts->skipChecksum = skip != 0;
+    return 0;
+}
+
+void hadoopRzOptionsFree(struct hadoopRzOptions * opts) {
+    delete opts;
+}
+
+struct hadoopRzBuffer * hadoopReadZero(hdfsFile file, struct hadoopRzOptions * opts,
+                                       int32_t maxLength) {
+    PARAMETER_ASSERT(file && opts && maxLength > 0, NULL, EINVAL);
+    PARAMETER_ASSERT(file->isInput(), NULL, EINVAL);
+    hadoopRzBuffer * retval = NULL;
+
+    try {
+        retval = new hadoopRzBuffer;
+
+        try {
+            retval->buffer = file->getInputStream().readZeroCopy(maxLength, opts->skipChecksum);
+        } catch (const Hdfs::HdfsEndOfStream & e) {
+            retval->buffer = new Hdfs::Internal::ZeroCopyBuffer;
+        }
+
+        return retval;
+    } catch (const std::bad_alloc & e) {
+        delete retval;
+        SetErrorMessage("Out of memory");
+        errno = ENOMEM;
+    } catch (...) {
+        delete retval;
+        SetLastException(Hdfs::current_exception());
+        handleException(Hdfs::current_exception());
+    }
+
+    return NULL;
+}
+
+int32_t hadoopRzBufferLength(const struct hadoopRzBuffer * buffer) {
+    PARAMETER_ASSERT(buffer && buffer->buffer, -1, EINVAL);
+    return buffer->buffer->length;
+}
+
+const void * hadoopRzBufferGet(const struct hadoopRzBuffer * buffer) {
+    PARAMETER_ASSERT(buffer && buffer->buffer, NULL, EINVAL);
+    return buffer->buffer->length > 0 ? buffer->buffer->data : NULL;
+}
+
+void hadoopRzBufferFree(hdfsFile file, struct hadoopRzBuffer * buffer) {
+    delete buffer;
+}
+
 tSize hdfsWrite(hdfsFS fs, hdfsFile file, const void * buffer, tSize length) {
     PARAMETER_ASSERT(fs && file && buffer && length > 0, -1, EINVAL);
     PARAMETER_ASSERT(!file->isInput(), -1, EINVAL);
@@ -1214,6 +1325,61 @@ tOffset hdfsGetUsed(hdfsFS fs) {
     return -1;
 }
 
+static void ConstructHdfsIoStatistics(const Hdfs::IoStatistics & from,
+                                      hdfsIoStatistics * to) {
+    to->bytesRead = from.getBytesRead();
+    to->bytesReadLocal = from.getBytesReadLocal();
+    to->bytesReadRemote = from.getBytesReadRemote();
+    to->bytesReadShortCircuit = from.getBytesReadShortCircuit();
+    to->bytesReadZeroCopy = from.getBytesReadZeroCopy();
+    to->blockReads = from.getBlockReads();
+
+    for (int i = 0; i < HDFS_READ_LATENCY_BUCKETS; ++i) {
+        to->readLatency[i] = from.getReadLatency(i);
+    }
+
+    to->reconnects = from.getReconnects();
+    to->checksumTime = from.getChecksumTime();
+    to->bytesWritten = from.getBytesWritten();
+    to->pipelineRecoveries = from.getPipelineRecoveries();
+}
+
+int hdfsFileGetIoStatistics(hdfsFS fs, hdfsFile file, hdfsIoStatistics * stats) {
+    PARAMETER_ASSERT(fs && file && stats, -1, EINVAL);
+
+    try {
+        ConstructHdfsIoStatistics(file->isInput() ?
+                                  file->getInputStream().getIoStatistics() :
+                                  file->getOutputStream().getIoStatistics(), stats);
+        return 0;
+    } catch (const std::bad_alloc & e) {
+        SetErrorMessage("Out of memory");
+        errno = ENOMEM;
+    } catch (...) {
+        SetLastException(Hdfs::current_exception());
+        handleException(Hdfs::current_exception());
+    }
+
+    return -1;
+}
+
+int hdfsGetIoStatistics(hdfsFS fs, hdfsIoStatistics * stats) {
+    PARAMETER_ASSERT(fs && stats, -1, EINVAL);
+
+    try {
+        ConstructHdfsIoStatistics(fs->getFilesystem().getIoStatistics(), stats);
+        return 0;
+    } catch (const std::bad_alloc & e) {
+        SetErrorMessage("Out of memory");
+        errno = ENOMEM;
+    } catch (...) {
+        SetLastException(Hdfs::current_exception());
+        handleException(Hdfs::current_exception());
+    }
+
+    return -1;
+}
+
 int hdfsChown(hdfsFS fs, const char * path, const char * owner,
               const char * group) {
     PARAMETER_ASSERT(fs && path && strlen(path) > 0, -1, EINVAL);
@@ -1491,6 +1657,62 @@ void hdfsFreeFileBlockLocations(BlockLocation * locations, int numOfBlock) {
     delete [] locations;
 }
 
+BlockLocation ** hdfsGetFileBlockLocationsBatch(hdfsFS fs, const char ** paths,
+        int count, tOffset start, tOffset length, int * numOfBlocks) {
+    PARAMETER_ASSERT(fs && paths && count > 0 && numOfBlocks, NULL, EINVAL);
+    PARAMETER_ASSERT(start >= 0 && length > 0, NULL, EINVAL);
+    BlockLocation ** retval = NULL;
+
+    for (int i = 0; i < count; ++i) {
+        PARAMETER_ASSERT(paths[i] && strlen(paths[i]), NULL, EINVAL);
+    }
+
+    memset(numOfBlocks, 0, sizeof(int) * count);
+
+    try {
+        std::vector<std::string> files(paths, paths + count);
+        std::vector<std::vector<Hdfs::BlockLocation> > locations =
+            fs->getFilesystem().getFileBlockLocations(files, start, length);
+        retval = new BlockLocation *[count];
+        memset(retval, 0, sizeof(BlockLocation *) * count);
+
+        for (int i = 0; i < count; ++i) {
+            int size = locations[i].size();
+            retval[i] = new BlockLocation[size];
+
+            for (int j = 0; j < size; ++j) {
+                ConstructFileBlockLocation(locations[i][j], &retval[i][j]);
+                numOfBlocks[i] = j + 1;
+            }
+        }
+
+        return retval;
+    } catch (const std::bad_alloc & e) {
+        SetErrorMessage("Out of memory");
+        hdfsFreeFileBlockLocationsBatch(retval, numOfBlocks, count);
+        errno = ENOMEM;
+    } catch (...) {
+        SetLastException(Hdfs::current_exception());
+        hdfsFreeFileBlockLocationsBatch(retval, numOfBlocks, count);
+        handleException(Hdfs::current_exception());
+    }
+
+    return NULL;
+}
+
+void hdfsFreeFileBlockLocationsBatch(BlockLocation ** locations,
+        int * numOfBlocks, int count) {
+    if (!locations) {
+        return;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        hdfsFreeFileBlockLocations(locations[i], numOfBlocks[i]);
+    }
+
+    delete [] locations;
+}
+
 int hdfsCreateEncryptionZone(hdfsFS fs, const char * path, const char * keyName) {
     PARAMETER_ASSERT(fs && path && strlen(path) > 0 && keyName && strlen(keyName) > 0, -1, EINVAL);
 
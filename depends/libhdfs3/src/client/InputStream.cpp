@@ -71,6 +71,14 @@ void InputStream::readFully(char * buf, int64_t size) {
     impl->readFully(buf, size);
 }
 
+void InputStream::preadv(const ReadRange * ranges, int count) {
+    impl->preadv(ranges, count);
+}
+
+Internal::ZeroCopyBuffer * InputStream::readZeroCopy(int32_t size, bool skipChecksum) {
+    return impl->readZeroCopy(size, skipChecksum);
+}
+
 int64_t InputStream::available() {
     return impl->available();
 }
@@ -98,4 +106,12 @@ void InputStream::close() {
     impl->close();
 }
 
+/**
+ * To get the I/O statistics of the stream.
+ * @return the I/O statistics.
+ */
+IoStatistics InputStream::getIoStatistics() {
+    return impl->getIoStatistics();
+}
+
 }
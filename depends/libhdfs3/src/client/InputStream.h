@@ -27,8 +27,18 @@
 namespace Hdfs {
 namespace Internal {
 class InputStreamInter;
+struct ZeroCopyBuffer;
 }
 
+/**
+ * A range of a file read by InputStream::preadv.
+ */
+struct ReadRange {
+    int64_t offset;
+    int64_t length;
+    char * buf;
+};
+
 /**
  * A input stream used read data from hdfs.
  */
@@ -61,6 +71,22 @@ public:
      */
     void readFully(char * buf, int64_t size);
 
+    /**
+     * To read several ranges of the file, without moving the file point.
+     * @param ranges the ranges to read, each one is filled in full.
+     * @param count the number of ranges.
+     */
+    void preadv(const ReadRange * ranges, int count);
+
+    /**
+     * To read data from hdfs without copying it, if the block is read from
+     * a memory mapped local replica, see hadoopReadZero.
+     * @param size the max number of bytes to be read.
+     * @param skipChecksum do not verify the checksums of the bytes read in place.
+     * @return return the buffer of the bytes read, the caller deletes it.
+     */
+    Internal::ZeroCopyBuffer * readZeroCopy(int32_t size, bool skipChecksum);
+
     /**
      * Get how many bytes can be read without blocking.
      * @return The number of bytes can be read without blocking.
@@ -84,6 +110,12 @@ public:
      */
     void close();
 
+    /**
+     * To get the I/O statistics of the stream.
+     * @return the I/O statistics.
+     */
+    IoStatistics getIoStatistics();
+
 private:
     Internal::InputStreamInter * impl;
 };
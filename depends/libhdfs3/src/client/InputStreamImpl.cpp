@@ -19,11 +19,13 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "DateTime.h"
 #include "Exception.h"
 #include "ExceptionInternal.h"
 #include "FileSystemInter.h"
 #include "InputStreamImpl.h"
 #include "InputStreamInter.h"
+#include "KmsClientProvider.h"
 #include "LocalBlockReader.h"
 #include "Logger.h"
 #include "RemoteBlockReader.h"
@@ -121,13 +123,18 @@ unordered_set<std::string> BuildLocalAddrSet() {
 InputStreamImpl::InputStreamImpl() :
     closed(true), localRead(true), readFromUnderConstructedBlock(false), verify(
         true), maxGetBlockInfoRetry(3), cursor(0), endOfCurBlock(0), lastBlockBeingWrittenLength(
-            0), prefetchSize(0), peerCache(NULL) {
+            0), prefetchSize(0), peerCache(NULL), curReaderBuffer(0), readAhead(false),
+    readAheadStarted(false), readAheadSize(0), hedgedReadThreshold(0), hedgedReadOps(0),
+    hedgedReadWins(0) {
+    ioStats = shared_ptr<IoStatsCounter>(new IoStatsCounter);
 #ifdef MOCK
     stub = NULL;
 #endif
 }
 
 InputStreamImpl::~InputStreamImpl() {
+    finishReadAhead(false);
+    joinHedgedReads(true);
 }
 
 void InputStreamImpl::checkStatus() {
@@ -294,33 +301,56 @@ void InputStreamImpl::seekToBlock(const LocatedBlock & lb) {
 }
 
 bool InputStreamImpl::choseBestNode() {
-    const std::vector<DatanodeInfo> & nodes = curBlock->getLocations();
+    return choseBestNode(*curBlock, failedNodes, curNode);
+}
+
+bool InputStreamImpl::choseBestNode(const LocatedBlock & lb,
+                                    const std::vector<DatanodeInfo> & failed, DatanodeInfo & node) {
+    const std::vector<DatanodeInfo> & nodes = lb.getLocations();
 
     for (size_t i = 0; i < nodes.size(); ++i) {
-        if (std::binary_search(failedNodes.begin(), failedNodes.end(),
+        if (std::binary_search(failed.begin(), failed.end(),
                                nodes[i])) {
             continue;
         }
 
-        curNode = nodes[i];
+        node = nodes[i];
         return true;
     }
 
     return false;
 }
 
-bool InputStreamImpl::isLocalNode() {
+bool InputStreamImpl::isLocalNode(const DatanodeInfo & node) {
     static const unordered_set<std::string> LocalAddrSet = BuildLocalAddrSet();
-    bool retval = LocalAddrSet.find(curNode.getIpAddr()) != LocalAddrSet.end();
+    bool retval = LocalAddrSet.find(node.getIpAddr()) != LocalAddrSet.end();
     return retval;
 }
 
 void InputStreamImpl::setupBlockReader(bool temporaryDisableLocalRead) {
+    int64_t offset = cursor - curBlock->getOffset();
+    blockReader = createBlockReader(*curBlock, offset, curBlock->getNumBytes() - offset,
+                                    readFromUnderConstructedBlock, temporaryDisableLocalRead,
+                                    failedNodes, curNode, localReaderBuffers[curReaderBuffer]);
+}
+
+/**
+ * Setup a block reader of len bytes of the given block from the given
+ * offset, trying the replicas not in failed, and set node to the datanode
+ * it reads from.
+ *
+ * It only uses the parameters and the configuration of the stream, so it can
+ * be called from the read ahead thread.
+ */
+shared_ptr<BlockReader> InputStreamImpl::createBlockReader(const LocatedBlock & lb,
+        int64_t offset, int64_t len, bool underConstruction, bool temporaryDisableLocalRead,
+        std::vector<DatanodeInfo> & failed, DatanodeInfo & node,
+        std::vector<char> & buffer) {
     bool lastReadFromLocal = false;
     exception_ptr lastException;
 
     while (true) {
-        if (!choseBestNode()) {
+        if (!choseBestNode(lb, failed, node)) {
             try {
                 if (lastException) {
                     rethrow_exception(lastException);
@@ -328,39 +358,36 @@ void InputStreamImpl::setupBlockReader(bool temporaryDisableLocalRead) {
             } catch (...) {
                 NESTED_THROW(HdfsIOException,
                              "InputStreamImpl: all nodes have been tried and no valid replica can be read for Block: %s.",
-                             curBlock->toString().c_str());
+                             lb.toString().c_str());
             }
 
             THROW(HdfsIOException,
                   "InputStreamImpl: all nodes have been tried and no valid replica can be read for Block: %s.",
-                  curBlock->toString().c_str());
+                  lb.toString().c_str());
         }
 
         try {
-            int64_t offset, len;
-            offset = cursor - curBlock->getOffset();
             assert(offset >= 0);
-            len = curBlock->getNumBytes() - offset;
-            assert(len > 0);
+            assert(len > 0 && offset + len <= lb.getNumBytes());
 
             if (!temporaryDisableLocalRead && !lastReadFromLocal &&
-                !readFromUnderConstructedBlock && localRead && isLocalNode()) {
+                !underConstruction && localRead && isLocalNode(node)) {
                 lastReadFromLocal = true;
 
                 shared_ptr<ReadShortCircuitInfo> info;
-                ReadShortCircuitInfoBuilder builder(curNode, auth, *conf);
+                ReadShortCircuitInfoBuilder builder(node, auth, *conf);
 
                 try {
-                    info = builder.fetchOrCreate(*curBlock, curBlock->getToken());
+                    info = builder.fetchOrCreate(lb, lb.getToken());
 
                     if (!info) {
                         continue;
                     }
 
                     assert(info->isValid());
-                    blockReader = shared_ptr<BlockReader>(
-                        new LocalBlockReader(info, *curBlock, offset, verify,
-                                             *conf, localReaderBuffer));
+                    return shared_ptr<BlockReader>(
+                        new LocalBlockReader(info, lb, offset, verify,
+                                             *conf, buffer, *ioStats));
                 } catch (...) {
                     if (info) {
                         info->setValid(false);
@@ -371,22 +398,22 @@ void InputStreamImpl::setupBlockReader(bool temporaryDisableLocalRead) {
             } else {
                 const char * clientName = filesystem->getClientName();
                 lastReadFromLocal = false;
-                blockReader = shared_ptr<BlockReader>(new RemoteBlockReader(
-                    *curBlock, curNode, *peerCache, offset, len,
-                    curBlock->getToken(), clientName, verify, *conf));
+                return shared_ptr<BlockReader>(new RemoteBlockReader(
+                    lb, node, *peerCache, offset, len,
+                    lb.getToken(), clientName, verify, *conf,
+                    isLocalNode(node), *ioStats));
             }
-
-            break;
         } catch (const HdfsIOException & e) {
             lastException = current_exception();
+            ioStats->addReconnect();
             std::string buffer;
 
             if (lastReadFromLocal) {
                 LOG(LOG_ERROR,
                     "cannot setup block reader for Block: %s file %s on Datanode: %s.\n%s\n"
                     "retry the same node but disable read shortcircuit feature",
-                    curBlock->toString().c_str(), path.c_str(),
-                    curNode.formatAddress().c_str(), GetExceptionDetail(e, buffer));
+                    lb.toString().c_str(), path.c_str(),
+                    node.formatAddress().c_str(), GetExceptionDetail(e, buffer));
                 /*
                  * do not add node into failedNodes since we will retry the same node but
                  * disable local block reading
@@ -394,15 +421,102 @@ void InputStreamImpl::setupBlockReader(bool temporaryDisableLocalRead) {
             } else {
                 LOG(LOG_ERROR,
                     "cannot setup block reader for Block: %s file %s on Datanode: %s.\n%s\nretry another node",
-                    curBlock->toString().c_str(), path.c_str(),
-                    curNode.formatAddress().c_str(), GetExceptionDetail(e, buffer));
-                failedNodes.push_back(curNode);
-                std::sort(failedNodes.begin(), failedNodes.end());
+                    lb.toString().c_str(), path.c_str(),
+                    node.formatAddress().c_str(), GetExceptionDetail(e, buffer));
+                failed.push_back(node);
+                std::sort(failed.begin(), failed.end());
             }
         }
     }
 }
 
+/**
+ * Start setting up the reader of the block after the current one in the
+ * background, if the current block is about to end.
+ *
+ * Only complete blocks are read ahead, the length of the block being
+ * written is not known in advance.
+ */
+void InputStreamImpl::startReadAhead() {
+    if (!readAhead || readAheadStarted || readFromUnderConstructedBlock
+            || endOfCurBlock - cursor > readAheadSize
+            || endOfCurBlock >= lbs->getFileLength()) {
+        return;
+    }
+
+    const LocatedBlock * lb = lbs->findBlock(endOfCurBlock);
+
+    if (!lb || lb->getOffset() != endOfCurBlock || lb->getNumBytes() <= 0) {
+        return;
+    }
+
+    readAheadBlock = shared_ptr<LocatedBlock>(new LocatedBlock(*lb));
+    readAheadReader.reset();
+
+    try {
+        CREATE_THREAD(readAheadWorker, bind(&InputStreamImpl::readAheadNextBlock, this));
+    } catch (...) {
+        LOG(WARNING, "InputStreamImpl: cannot start the read ahead thread for file %s, "
+            "read ahead is disabled", path.c_str());
+        readAhead = false;
+        readAheadBlock.reset();
+        return;
+    }
+
+    readAheadStarted = true;
+}
+
+/**
+ * The read ahead thread, setup the reader of readAheadBlock from its start.
+ *
+ * A failure is not reported, the block is read as if there were no read
+ * ahead, which reports it.
+ */
+void InputStreamImpl::readAheadNextBlock() {
+    std::vector<DatanodeInfo> failed;
+
+    try {
+        readAheadReader = createBlockReader(*readAheadBlock, 0, readAheadBlock->getNumBytes(),
+                                            false, false, failed,
+                                            readAheadNode, localReaderBuffers[1 - curReaderBuffer]);
+    } catch (const HdfsException & e) {
+        std::string buffer;
+        LOG(INFO, "InputStreamImpl: failed to read ahead Block: %s file %s\n%s",
+            readAheadBlock->toString().c_str(), path.c_str(), GetExceptionDetail(e, buffer));
+        readAheadReader.reset();
+    } catch (...) {
+        readAheadReader.reset();
+    }
+}
+
+/**
+ * Wait for the read ahead thread. If adopt is set and the read ahead block
+ * starts at the cursor, its reader becomes the reader of the current block,
+ * otherwise it is dropped.
+ */
+void InputStreamImpl::finishReadAhead(bool adopt) {
+    if (!readAheadStarted) {
+        return;
+    }
+
+    readAheadWorker.join();
+    readAheadStarted = false;
+
+    if (adopt && readAheadReader && curBlock
+            && readAheadBlock->getOffset() == cursor
+            && readAheadBlock->getBlockId() == curBlock->getBlockId()) {
+        LOG(DEBUG2, "%p read ahead Block: %s file %s from Datanode: %s",
+            this, curBlock->toString().c_str(), path.c_str(),
+            readAheadNode.formatAddress().c_str());
+        blockReader = readAheadReader;
+        curNode = readAheadNode;
+        curReaderBuffer = 1 - curReaderBuffer;
+    }
+
+    readAheadReader.reset();
+    readAheadBlock.reset();
+}
+
 void InputStreamImpl::open(shared_ptr<FileSystemInter> fs, const char * path,
                            bool verifyChecksum) {
     if (NULL == path || 0 == strlen(path)) {
@@ -428,9 +542,20 @@ void InputStreamImpl::openInternal(shared_ptr<FileSystemInter> fs, const char *
         this->auth = RpcAuth(fs->getUserInfo(), RpcAuth::ParseMethod(conf->getRpcAuthMethod()));
         prefetchSize = conf->getDefaultBlockSize() * conf->getPrefetchSize();
         localRead = conf->isReadFromLocal();
+        readAhead = conf->isReadAhead();
+        readAheadSize = conf->getReadAheadSize();
+        hedgedReadThreshold = conf->getHedgedReadThreshold();
         maxGetBlockInfoRetry = conf->getMaxGetBlockInfoRetry();
         peerCache = &fs->getPeerCache();
+        ioStats = shared_ptr<IoStatsCounter>(new IoStatsCounter(fs->getIoStats()));
         updateBlockInfos();
+
+        if (lbs->isFileEncrypted()) {
+            FileEncryptionInfo * info = lbs->getFileEncryption();
+            KmsClientProvider kms(*conf, fs->getUserInfo());
+            codec = shared_ptr<CryptoCodec>(new CryptoCodec(*info, kms.decryptEncryptedKey(*info)));
+        }
+
         closed = false;
     } catch (const HdfsCanceled & e) {
         throw;
@@ -459,7 +584,56 @@ int32_t InputStreamImpl::read(char * buf, int32_t size) {
     }
 }
 
-int32_t InputStreamImpl::readOneBlock(char * buf, int32_t size, bool shouldUpdateMetadataOnFailure) {
+ZeroCopyBuffer * InputStreamImpl::readZeroCopy(int32_t size, bool skipChecksum) {
+    checkStatus();
+    ZeroCopyBuffer * zc = new ZeroCopyBuffer;
+    zc->skipChecksum = skipChecksum;
+
+    try {
+        int64_t prvious = cursor;
+        readInternal(NULL, size, zc);
+        LOG(DEBUG3, "%p zero-copy read file %s size is %d, offset %" PRId64 " done %d%s, next pos %" PRId64,
+            this, path.c_str(), size, prvious, zc->length, (zc->mapped ? " in place" : ""), cursor);
+        return zc;
+    } catch (const HdfsEndOfStream & e) {
+        delete zc;
+        throw;
+    } catch (...) {
+        delete zc;
+        lastError = current_exception();
+        throw;
+    }
+}
+
+/*
+ * Read from the current block reader into zc, in place if it is a local
+ * reader of a mapped replica.
+ */
+int32_t InputStreamImpl::readZeroCopyFromBlock(int32_t size, ZeroCopyBuffer & zc) {
+    LocalBlockReader * local = dynamic_cast<LocalBlockReader *>(blockReader.get());
+
+    /*
+     * the bytes of an encrypted file are decrypted in the copy.
+     */
+    if (local && !codec) {
+        int32_t done = local->readMapped(size, zc.skipChecksum, &zc.data, zc.mapping);
+
+        if (done >= 0) {
+            zc.mapped = true;
+            zc.length = done;
+            return done;
+        }
+    }
+
+    zc.copy.resize(size);
+    zc.mapped = false;
+    zc.length = blockReader->read(&zc.copy[0], size);
+    zc.data = &zc.copy[0];
+    return zc.length;
+}
+
+int32_t InputStreamImpl::readOneBlock(char * buf, int32_t size, bool shouldUpdateMetadataOnFailure,
+                                      ZeroCopyBuffer * zc) {
     bool temporaryDisableLocalRead = false;
     std::string buffer;
 
@@ -505,8 +679,9 @@ int32_t InputStreamImpl::readOneBlock(char * buf, int32_t size, bool shouldUpdat
             todo = todo < endOfCurBlock - cursor ?
                    todo : static_cast<int32_t>(endOfCurBlock - cursor);
             assert(blockReader);
-            todo = blockReader->read(buf, todo);
+            todo = zc ? readZeroCopyFromBlock(todo, *zc) : blockReader->read(buf, todo);
             cursor += todo;
+            startReadAhead();
             /*
              * Exit the loop and function from here if success.
              */
@@ -549,6 +724,7 @@ int32_t InputStreamImpl::readOneBlock(char * buf, int32_t size, bool shouldUpdat
             std::sort(failedNodes.begin(), failedNodes.end());
         }
 
+        ioStats->addReconnect();
         blockReader.reset();
     }
 }
@@ -559,7 +735,7 @@ int32_t InputStreamImpl::readOneBlock(char * buf, int32_t size, bool shouldUpdat
  * @param size buffer size.
  * @return return the number of bytes filled in the buffer, it may less than size.
  */
-int32_t InputStreamImpl::readInternal(char * buf, int32_t size) {
+int32_t InputStreamImpl::readInternal(char * buf, int32_t size, ZeroCopyBuffer * zc) {
     int updateMetadataOnFailure = conf->getMaxReadBlockRetry();
 
     try {
@@ -606,9 +782,10 @@ int32_t InputStreamImpl::readInternal(char * buf, int32_t size) {
                  * but do not setup block reader, setup it latter.
                  */
                 seekToBlock(*lb);
+                finishReadAhead(true);
             }
 
-            int32_t retval = readOneBlock(buf, size, updateMetadataOnFailure > 0);
+            int32_t retval = readOneBlock(buf, size, updateMetadataOnFailure > 0, zc);
 
             /*
              * Now we have tried all replicas and failed.
@@ -616,6 +793,7 @@ int32_t InputStreamImpl::readInternal(char * buf, int32_t size) {
              */
             if (retval < 0) {
                 lbs.reset();
+                filesystem->invalidateMetadata(path);
                 endOfCurBlock = 0;
                 --updateMetadataOnFailure;
 
@@ -627,6 +805,11 @@ int32_t InputStreamImpl::readInternal(char * buf, int32_t size) {
                 continue;
             }
 
+            if (codec) {
+                char * data = zc ? &zc->copy[0] : buf;
+                codec->process(data, data, retval, cursor - retval);
+            }
+
             return retval;
         } while (true);
     } catch (const HdfsCanceled & e) {
@@ -687,6 +870,538 @@ void InputStreamImpl::readFullyInternal(char * buf, int64_t size) {
     }
 }
 
+/*
+ * A part of a range of preadv, within one block.
+ */
+struct InputStreamImpl::ReadPiece {
+    int64_t offset; // in the block
+    int64_t length;
+    char * buf;
+
+    bool operator <(const ReadPiece & other) const {
+        return offset < other.offset;
+    }
+};
+
+/*
+ * The pieces of preadv read through one block reader, from start to end of
+ * the block. The pieces are sorted and do not overlap, the gaps between
+ * them are skipped.
+ */
+struct InputStreamImpl::ReadRun {
+    const LocatedBlock * block;
+    int64_t start;
+    int64_t end;
+    std::vector<ReadPiece> pieces;
+};
+
+/*
+ * The runs of preadv, taken in turn by the reading threads.
+ */
+struct InputStreamImpl::ReadRunQueue {
+    std::vector<ReadRun> * runs;
+    size_t next;
+    bool failed;
+    mutex mut;
+};
+
+void InputStreamImpl::preadv(const ReadRange * ranges, int count) {
+    LOG(DEBUG3, "%p preadv file %s %d ranges", this, path.c_str(), count);
+    checkStatus();
+
+    try {
+        preadvInternal(ranges, count);
+
+        for (int i = 0; codec && i < count; ++i) {
+            codec->process(ranges[i].buf, ranges[i].buf, ranges[i].length,
+                           ranges[i].offset);
+        }
+    } catch (const HdfsEndOfStream & e) {
+        throw;
+    } catch (...) {
+        lastError = current_exception();
+        throw;
+    }
+}
+
+void InputStreamImpl::preadvInternal(const ReadRange * ranges, int count) {
+    int64_t start = std::numeric_limits<int64_t>::max(), end = 0;
+
+    for (int i = 0; i < count; ++i) {
+        if (ranges[i].offset < 0 || ranges[i].length < 0
+                || (ranges[i].length > 0 && NULL == ranges[i].buf)) {
+            THROW(InvalidParameter, "InputStreamImpl: invalid read range %d for file: %s.",
+                  i, path.c_str());
+        }
+
+        if (ranges[i].length > 0) {
+            start = std::min(start, ranges[i].offset);
+            end = std::max(end, ranges[i].offset + ranges[i].length);
+        }
+    }
+
+    if (end == 0) {
+        return;
+    }
+
+    try {
+        LocatedBlocksImpl blocks;
+        filesystem->getBlockLocations(path, start, end - start, blocks);
+
+        /*
+         * The visible length of the block being written is asked to the
+         * datanodes by the sequential read, which also reports the ranges
+         * over the end of the file.
+         */
+        if (!blocks.isLastBlockComplete() || end > blocks.getFileLength()) {
+            preadvSerial(ranges, count);
+            return;
+        }
+
+        /*
+         * Cut the ranges into pieces of one block.
+         */
+        std::vector<LocatedBlock> & lbv = blocks.getBlocks();
+        std::vector<std::vector<ReadPiece> > pieces(lbv.size());
+
+        for (int i = 0; i < count; ++i) {
+            int64_t pos = ranges[i].offset, todo = ranges[i].length;
+            char * buf = ranges[i].buf;
+
+            while (todo > 0) {
+                const LocatedBlock * lb = blocks.findBlock(pos);
+
+                if (!lb) {
+                    THROW(HdfsIOException,
+                          "InputStreamImpl: cannot find block information at position: %" PRId64 " for file: %s",
+                          pos, path.c_str());
+                }
+
+                ReadPiece piece;
+                piece.offset = pos - lb->getOffset();
+                piece.length = std::min(todo, lb->getNumBytes() - piece.offset);
+                piece.buf = buf;
+                pieces[lb - &lbv[0]].push_back(piece);
+                pos += piece.length;
+                buf += piece.length;
+                todo -= piece.length;
+            }
+        }
+
+        /*
+         * Merge the pieces of a block closer than the merge gap into runs,
+         * each run is read with one request.
+         */
+        int64_t gap = conf->getReadMergeGap();
+        std::vector<ReadRun> runs;
+
+        for (size_t b = 0; b < pieces.size(); ++b) {
+            std::sort(pieces[b].begin(), pieces[b].end());
+
+            for (size_t i = 0; i < pieces[b].size(); ++i) {
+                const ReadPiece & piece = pieces[b][i];
+
+                if (runs.empty() || runs.back().block != &lbv[b]
+                        || piece.offset < runs.back().end
+                        || piece.offset - runs.back().end > gap) {
+                    runs.push_back(ReadRun());
+                    runs.back().block = &lbv[b];
+                    runs.back().start = piece.offset;
+                }
+
+                runs.back().end = piece.offset + piece.length;
+                runs.back().pieces.push_back(piece);
+            }
+        }
+
+        /*
+         * Read the runs, this thread and up to parallelism - 1 others.
+         */
+        size_t nthreads = std::min(runs.size(),
+                                   static_cast<size_t>(conf->getReadParallelism()));
+        std::vector<exception_ptr> errors(nthreads);
+        std::vector<thread> workers;
+        ReadRunQueue queue;
+        queue.runs = &runs;
+        queue.next = 0;
+        queue.failed = false;
+
+        for (size_t i = 1; i < nthreads; ++i) {
+            try {
+                thread worker;
+                CREATE_THREAD(worker, bind(&InputStreamImpl::readRuns, this, &queue, &errors[i]));
+                workers.push_back(std::move(worker));
+            } catch (...) {
+                break;
+            }
+        }
+
+        readRuns(&queue, &errors[0]);
+
+        for (size_t i = 0; i < workers.size(); ++i) {
+            workers[i].join();
+        }
+
+        for (size_t i = 0; i < errors.size(); ++i) {
+            if (errors[i]) {
+                rethrow_exception(errors[i]);
+            }
+        }
+    } catch (const HdfsCanceled & e) {
+        throw;
+    } catch (const HdfsEndOfStream & e) {
+        throw;
+    } catch (const HdfsException & e) {
+        NESTED_THROW(HdfsIOException,
+                     "InputStreamImpl: cannot read %d ranges of file: %s.",
+                     count, path.c_str());
+    }
+}
+
+/*
+ * Read the ranges of preadv one after the other with the block reader of
+ * the stream, and move the file point back.
+ */
+void InputStreamImpl::preadvSerial(const ReadRange * ranges, int count) {
+    int64_t pos = cursor;
+
+    try {
+        for (int i = 0; i < count; ++i) {
+            if (ranges[i].length > 0) {
+                seekInternal(ranges[i].offset);
+                readFullyInternal(ranges[i].buf, ranges[i].length);
+            }
+        }
+    } catch (...) {
+        try {
+            seekInternal(pos);
+        } catch (...) {
+        }
+
+        throw;
+    }
+
+    seekInternal(pos);
+}
+
+/*
+ * Take the runs of preadv from the queue and read them until it is empty,
+ * or another thread failed.
+ */
+void InputStreamImpl::readRuns(ReadRunQueue * queue, exception_ptr * error) {
+    std::vector<char> buffer;
+
+    try {
+        while (true) {
+            const ReadRun * run;
+
+            {
+                lock_guard<mutex> lock(queue->mut);
+
+                if (queue->failed || queue->next >= queue->runs->size()) {
+                    return;
+                }
+
+                run = &(*queue->runs)[queue->next++];
+            }
+
+            readRun(*run, buffer);
+        }
+    } catch (...) {
+        *error = current_exception();
+        lock_guard<mutex> lock(queue->mut);
+        queue->failed = true;
+    }
+}
+
+/*
+ * Read a run of preadv through one block reader, which asks the datanode
+ * for the bytes of the run only, so that its connection goes back to the
+ * peer cache once they are read.
+ */
+void InputStreamImpl::readRun(const ReadRun & run, std::vector<char> & buffer) {
+    bool temporaryDisableLocalRead = false;
+    std::vector<DatanodeInfo> failed;
+    DatanodeInfo node;
+    std::string detail;
+
+    if (hedgedReadThreshold > 0 && run.block->getLocations().size() > 1
+            && readRunHedged(run)) {
+        return;
+    }
+
+    while (true) {
+        shared_ptr<BlockReader> reader = createBlockReader(*run.block, run.start,
+                                         run.end - run.start, false, temporaryDisableLocalRead,
+                                         failed, node, buffer);
+
+        try {
+            int64_t pos = run.start;
+
+            for (size_t i = 0; i < run.pieces.size(); ++i) {
+                const ReadPiece & piece = run.pieces[i];
+
+                if (piece.offset > pos) {
+                    reader->skip(piece.offset - pos);
+                }
+
+                for (int64_t done = 0; done < piece.length;) {
+                    int32_t todo = static_cast<int32_t>(std::min<int64_t>(piece.length - done,
+                                                        std::numeric_limits<int32_t>::max()));
+                    int32_t n = reader->read(piece.buf + done, todo);
+
+                    if (n <= 0) {
+                        THROW(HdfsIOException,
+                              "InputStreamImpl: unexpected end of Block: %s file %s from Datanode: %s.",
+                              run.block->toString().c_str(), path.c_str(),
+                              node.formatAddress().c_str());
+                    }
+
+                    done += n;
+                }
+
+                pos = piece.offset + piece.length;
+            }
+
+            return;
+        } catch (const HdfsIOException & e) {
+            LOG(LOG_ERROR,
+                "InputStreamImpl: failed to read Block: %s file %s from Datanode: %s, \n%s, "
+                "retry read again from another Datanode.",
+                run.block->toString().c_str(), path.c_str(),
+                node.formatAddress().c_str(), GetExceptionDetail(e, detail));
+
+            if (conf->doesNotRetryAnotherNode()) {
+                throw;
+            }
+        } catch (const ChecksumException & e) {
+            LOG(LOG_ERROR,
+                "InputStreamImpl: failed to read Block: %s file %s from Datanode: %s, \n%s, "
+                "retry read again from another Datanode.",
+                run.block->toString().c_str(), path.c_str(),
+                node.formatAddress().c_str(), GetExceptionDetail(e, detail));
+        }
+
+        /*
+         * As readOneBlock, a local reader is retried remotely on the
+         * same node, a remote one on another node.
+         */
+        if (dynamic_cast<LocalBlockReader *>(reader.get())) {
+            temporaryDisableLocalRead = true;
+        } else {
+            temporaryDisableLocalRead = false;
+            failed.push_back(node);
+            std::sort(failed.begin(), failed.end());
+        }
+
+        ioStats->addReconnect();
+    }
+}
+
+/*
+ * The reads of a run from two replicas. Each one reads the whole run into
+ * its own buffer, the one which finishes first is copied into the pieces.
+ * It lives until the read which lost finishes.
+ */
+struct InputStreamImpl::HedgedRead {
+    HedgedRead() :
+        started(0), finished(0), winner(-1) {
+    }
+
+    int started;
+    int finished;
+    int winner;
+    std::vector<char> data[2];
+    std::vector<char> localBuffers[2];
+    condition_variable cond;
+    mutex mut;
+};
+
+/*
+ * Read a run from the first replica, and also from another one if it is not
+ * done within the threshold. Return false if the reads failed, the run is
+ * then read again as usual.
+ */
+bool InputStreamImpl::readRunHedged(const ReadRun & run) {
+    shared_ptr<HedgedRead> hr(new HedgedRead);
+    std::vector<DatanodeInfo> failed;
+    DatanodeInfo node, other;
+
+    if (!choseBestNode(*run.block, failed, node)) {
+        return false;
+    }
+
+    joinHedgedReads(false);
+    startHedgedRead(hr, 0, run, failed);
+    unique_lock<mutex> lock(hr->mut);
+    steady_clock::time_point deadline = steady_clock::now()
+                                        + milliseconds(hedgedReadThreshold);
+
+    while (0 == hr->finished && steady_clock::now() < deadline) {
+        hr->cond.wait_until(lock, deadline);
+    }
+
+    if (0 == hr->finished) {
+        failed.push_back(node);
+
+        if (choseBestNode(*run.block, failed, other)) {
+            LOG(DEBUG1, "InputStreamImpl: Block: %s file %s is not read from Datanode: %s "
+                "within %d ms, also read it from Datanode: %s.",
+                run.block->toString().c_str(), path.c_str(), node.formatAddress().c_str(),
+                hedgedReadThreshold, other.formatAddress().c_str());
+            lock.unlock();
+            startHedgedRead(hr, 1, run, failed);
+
+            {
+                lock_guard<mutex> hedgeLock(hedgeMut);
+                ++hedgedReadOps;
+            }
+
+            lock.lock();
+        }
+    }
+
+    while (hr->winner < 0 && hr->finished < hr->started) {
+        hr->cond.wait(lock);
+    }
+
+    int winner = hr->winner;
+    lock.unlock();
+
+    if (winner < 0) {
+        return false;
+    }
+
+    if (1 == winner) {
+        lock_guard<mutex> hedgeLock(hedgeMut);
+        ++hedgedReadWins;
+    }
+
+    const std::vector<char> & data = hr->data[winner];
+
+    for (size_t i = 0; i < run.pieces.size(); ++i) {
+        const ReadPiece & piece = run.pieces[i];
+        memcpy(piece.buf, &data[piece.offset - run.start], piece.length);
+    }
+
+    return true;
+}
+
+void InputStreamImpl::startHedgedRead(shared_ptr<HedgedRead> hr, int index,
+                                      const ReadRun & run, const std::vector<DatanodeInfo> & failed) {
+    shared_ptr<thread> worker(new thread);
+
+    {
+        lock_guard<mutex> lock(hr->mut);
+        ++hr->started;
+    }
+
+    try {
+        CREATE_THREAD(*worker, bind(&InputStreamImpl::readHedged, this, hr, index,
+                                    *run.block, run.start, run.end - run.start, failed));
+    } catch (...) {
+        lock_guard<mutex> lock(hr->mut);
+        ++hr->finished;
+        throw;
+    }
+
+    lock_guard<mutex> lock(hedgeMut);
+    hedgeWorkers.push_back(std::make_pair(worker, hr));
+}
+
+/*
+ * One read of a hedged run, the block is a copy since the read may outlive
+ * the preadv call.
+ */
+void InputStreamImpl::readHedged(shared_ptr<HedgedRead> hr, int index, LocatedBlock block,
+                                 int64_t offset, int64_t len, std::vector<DatanodeInfo> failed) {
+    bool success = false;
+    DatanodeInfo node;
+    std::vector<char> & data = hr->data[index];
+
+    try {
+        data.resize(len);
+        shared_ptr<BlockReader> reader = createBlockReader(block, offset, len, false, false,
+                                         failed, node, hr->localBuffers[index]);
+
+        for (int64_t done = 0; done < len;) {
+            int32_t todo = static_cast<int32_t>(std::min<int64_t>(len - done,
+                                                std::numeric_limits<int32_t>::max()));
+            int32_t n = reader->read(&data[done], todo);
+
+            if (n <= 0) {
+                THROW(HdfsIOException,
+                      "InputStreamImpl: unexpected end of Block: %s file %s from Datanode: %s.",
+                      block.toString().c_str(), path.c_str(), node.formatAddress().c_str());
+            }
+
+            done += n;
+        }
+
+        success = true;
+    } catch (const HdfsException & e) {
+        std::string detail;
+        LOG(LOG_ERROR,
+            "InputStreamImpl: hedged read of Block: %s file %s from Datanode: %s failed.\n%s",
+            block.toString().c_str(), path.c_str(), node.formatAddress().c_str(),
+            GetExceptionDetail(e, detail));
+    } catch (...) {
+    }
+
+    lock_guard<mutex> lock(hr->mut);
+    ++hr->finished;
+
+    if (success && hr->winner < 0) {
+        hr->winner = index;
+    }
+
+    hr->cond.notify_all();
+}
+
+/*
+ * Join the workers of the hedged reads which are done, or of all of them.
+ */
+void InputStreamImpl::joinHedgedReads(bool all) {
+    std::vector<shared_ptr<thread> > workers;
+
+    {
+        lock_guard<mutex> lock(hedgeMut);
+
+        for (size_t i = 0; i < hedgeWorkers.size();) {
+            shared_ptr<HedgedRead> hr = hedgeWorkers[i].second;
+            bool done = all;
+
+            if (!done) {
+                lock_guard<mutex> hrLock(hr->mut);
+                done = hr->finished == hr->started;
+            }
+
+            if (done) {
+                workers.push_back(hedgeWorkers[i].first);
+                hedgeWorkers.erase(hedgeWorkers.begin() + i);
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < workers.size(); ++i) {
+        if (workers[i]->joinable()) {
+            workers[i]->join();
+        }
+    }
+}
+
+int64_t InputStreamImpl::getHedgedReadOps() {
+    lock_guard<mutex> lock(hedgeMut);
+    return hedgedReadOps;
+}
+
+int64_t InputStreamImpl::getHedgedReadWins() {
+    lock_guard<mutex> lock(hedgeMut);
+    return hedgedReadWins;
+}
+
 int64_t InputStreamImpl::available() {
     checkStatus();
 
@@ -775,6 +1490,14 @@ int64_t InputStreamImpl::tell() {
  */
 void InputStreamImpl::close() {
     LOG(DEBUG2, "%p close file %s for read", this, path.c_str());
+    finishReadAhead(false);
+    joinHedgedReads(true);
+
+    if (hedgedReadOps > 0) {
+        LOG(INFO, "%p, %" PRId64 " hedged reads of file %s, %" PRId64 " of them won",
+            this, hedgedReadOps, path.c_str(), hedgedReadWins);
+    }
+
     closed = true;
     localRead = true;
     readFromUnderConstructedBlock = false;
@@ -790,7 +1513,15 @@ void InputStreamImpl::close() {
     conf.reset();
     failedNodes.clear();
     path.clear();
-    localReaderBuffer.resize(0);
+    curReaderBuffer = 0;
+    localReaderBuffers[0].resize(0);
+    localReaderBuffers[1].resize(0);
+    readAhead = false;
+    readAheadSize = 0;
+    hedgedReadThreshold = 0;
+    hedgedReadOps = 0;
+    hedgedReadWins = 0;
+    codec.reset();
     lastError = exception_ptr();
 }
 
@@ -802,5 +1533,9 @@ std::string InputStreamImpl::toString() {
     }
 }
 
+IoStatistics InputStreamImpl::getIoStatistics() {
+    return ioStats->get();
+}
+
 }
 }
@@ -25,10 +25,13 @@
 #include "platform.h"
 
 #include "BlockReader.h"
+#include "CryptoCodec.h"
 #include "ExceptionInternal.h"
 #include "FileSystem.h"
 #include "Hash.h"
+#include "InputStream.h"
 #include "InputStreamInter.h"
+#include "IoStatsCounter.h"
 #include "Memory.h"
 #include "PeerCache.h"
 #include "rpc/RpcAuth.h"
@@ -36,6 +39,7 @@
 #include "server/LocatedBlock.h"
 #include "server/LocatedBlocks.h"
 #include "SessionConfig.h"
+#include "Thread.h"
 #include "Unordered.h"
 
 #ifdef MOCK
@@ -76,6 +80,25 @@ public:
      */
     void readFully(char * buf, int64_t size);
 
+    /**
+     * To read several ranges of the file, without moving the file point.
+     * The nearby ranges of a block are read through one block reader, the
+     * ranges of different blocks are read in parallel.
+     * @param ranges the ranges to read, each one is filled in full.
+     * @param count the number of ranges.
+     */
+    void preadv(const ReadRange * ranges, int count);
+
+    /**
+     * To read data from hdfs without copying it, if the block is read from
+     * a memory mapped local replica. Otherwise the bytes are copied into the
+     * returned buffer.
+     * @param size the max number of bytes to be read.
+     * @param skipChecksum do not verify the checksums of the bytes read in place.
+     * @return return the buffer of the bytes read, the caller deletes it.
+     */
+    ZeroCopyBuffer * readZeroCopy(int32_t size, bool skipChecksum);
+
     int64_t available();
 
     /**
@@ -102,21 +125,64 @@ public:
      */
     std::string toString();
 
+    /**
+     * Get the I/O statistics of this input stream.
+     * @return the statistics.
+     */
+    IoStatistics getIoStatistics();
+
+    /**
+     * @return the number of hedged reads issued to a second replica.
+     */
+    int64_t getHedgedReadOps();
+
+    /**
+     * @return the number of hedged reads finished before the first read.
+     */
+    int64_t getHedgedReadWins();
+
+private:
+    struct HedgedRead;
+    struct ReadPiece;
+    struct ReadRun;
+    struct ReadRunQueue;
+
 private:
     bool choseBestNode();
-    bool isLocalNode();
-    int32_t readInternal(char * buf, int32_t size);
-    int32_t readOneBlock(char * buf, int32_t size, bool shouldUpdateMetadataOnFailure);
+    bool choseBestNode(const LocatedBlock & lb,
+                       const std::vector<DatanodeInfo> & failed, DatanodeInfo & node);
+    bool isLocalNode(const DatanodeInfo & node);
+    shared_ptr<BlockReader> createBlockReader(const LocatedBlock & lb, int64_t offset,
+            int64_t len, bool underConstruction, bool temporaryDisableLocalRead,
+            std::vector<DatanodeInfo> & failed, DatanodeInfo & node,
+            std::vector<char> & buffer);
+    int32_t readInternal(char * buf, int32_t size, ZeroCopyBuffer * zc = NULL);
+    int32_t readOneBlock(char * buf, int32_t size, bool shouldUpdateMetadataOnFailure,
+                         ZeroCopyBuffer * zc);
+    int32_t readZeroCopyFromBlock(int32_t size, ZeroCopyBuffer & zc);
     int64_t getFileLength();
     int64_t readBlockLength(const LocatedBlock & b);
     void checkStatus();
     void openInternal(shared_ptr<FileSystemInter> fs, const char * path,
                       bool verifyChecksum);
     void readFullyInternal(char * buf, int64_t size);
+    void preadvInternal(const ReadRange * ranges, int count);
+    void preadvSerial(const ReadRange * ranges, int count);
+    void readRuns(ReadRunQueue * queue, exception_ptr * error);
+    void readRun(const ReadRun & run, std::vector<char> & buffer);
+    bool readRunHedged(const ReadRun & run);
+    void startHedgedRead(shared_ptr<HedgedRead> hr, int index, const ReadRun & run,
+                         const std::vector<DatanodeInfo> & failed);
+    void readHedged(shared_ptr<HedgedRead> hr, int index, LocatedBlock block,
+                    int64_t offset, int64_t len, std::vector<DatanodeInfo> failed);
+    void joinHedgedReads(bool all);
     void seekInternal(int64_t pos);
     void seekToBlock(const LocatedBlock & lb);
     void setupBlockReader(bool temporaryDisableLocalRead);
     void updateBlockInfos();
+    void startReadAhead();
+    void readAheadNextBlock();
+    void finishReadAhead(bool adopt);
 
 private:
     bool closed;
@@ -135,12 +201,51 @@ private:
     RpcAuth auth;
     shared_ptr<BlockReader> blockReader;
     shared_ptr<FileSystemInter> filesystem;
+    shared_ptr<IoStatsCounter> ioStats;
     shared_ptr<LocatedBlock> curBlock;
     shared_ptr<LocatedBlocks> lbs;
     shared_ptr<SessionConfig> conf;
     std::string path;
     std::vector<DatanodeInfo> failedNodes;
-    std::vector<char> localReaderBuffer;
+
+    /*
+     * The local block readers read into localReaderBuffers[curReaderBuffer],
+     * the reader of the next block set up by the read ahead thread uses the
+     * other one.
+     */
+    int curReaderBuffer;
+    std::vector<char> localReaderBuffers[2];
+
+    /*
+     * Read ahead: when the rest of the current block falls under
+     * readAheadSize, a background thread sets up the reader of the next
+     * block, so the datanode starts sending it before we reach its start.
+     */
+    bool readAhead;
+    bool readAheadStarted;
+    int64_t readAheadSize;
+    thread readAheadWorker;
+    DatanodeInfo readAheadNode;
+    shared_ptr<BlockReader> readAheadReader;
+    shared_ptr<LocatedBlock> readAheadBlock;
+
+    /*
+     * Hedged reads: a run of preadv not read within hedgedReadThreshold
+     * milliseconds is also read from another replica. The read which lost
+     * goes on in the background and is joined later, hedgeMut protects
+     * the workers and the counters.
+     */
+    int hedgedReadThreshold;
+    int64_t hedgedReadOps;
+    int64_t hedgedReadWins;
+    mutex hedgeMut;
+    std::vector<std::pair<shared_ptr<thread>, shared_ptr<HedgedRead> > > hedgeWorkers;
+
+    /*
+     * The cipher of a file in an encryption zone. The bytes are decrypted
+     * in the buffers they are read into.
+     */
+    shared_ptr<CryptoCodec> codec;
 
 #ifdef MOCK
 private:
@@ -22,14 +22,37 @@
 #ifndef _HDFS_LIBHDFS3_CLIENT_INPUTSTREAMINTER_H_
 #define _HDFS_LIBHDFS3_CLIENT_INPUTSTREAMINTER_H_
 
+#include <IoStatistics.h>
 #include <Memory.h>
 
 #include <string>
+#include <vector>
 
 namespace Hdfs {
+
+struct ReadRange;
+
 namespace Internal {
 
 class FileSystemInter;
+class FileWrapper;
+
+/**
+ * The result of a zero-copy read. data points into a memory mapped local
+ * replica, kept valid by mapping, or into copy if the bytes could not be
+ * read in place.
+ */
+struct ZeroCopyBuffer {
+    ZeroCopyBuffer() : skipChecksum(false), mapped(false), length(0), data(NULL) {
+    }
+
+    bool skipChecksum;
+    bool mapped;
+    int32_t length;
+    const char * data;
+    shared_ptr<FileWrapper> mapping;
+    std::vector<char> copy;
+};
 
 /**
  * A input stream used read data from hdfs.
@@ -64,6 +87,21 @@ public:
      */
     virtual void readFully(char * buf, int64_t size) = 0;
 
+    /**
+     * To read several ranges of the file, without moving the file point.
+     * @param ranges the ranges to read, each one is filled in full.
+     * @param count the number of ranges.
+     */
+    virtual void preadv(const ReadRange * ranges, int count) = 0;
+
+    /**
+     * To read data from hdfs without copying it.
+     * @param size the max number of bytes to be read.
+     * @param skipChecksum do not verify the checksums of the bytes read in place.
+     * @return return the buffer of the bytes read, the caller deletes it.
+     */
+    virtual ZeroCopyBuffer * readZeroCopy(int32_t size, bool skipChecksum) = 0;
+
     /**
      * Get how many bytes can be read without blocking.
      * @return The number of bytes can be read without blocking.
@@ -91,6 +129,12 @@ public:
      * Output a readable string of this input stream.
      */
     virtual std::string toString() = 0;
+
+    /**
+     * Get the I/O statistics of this input stream.
+     * @return the statistics.
+     */
+    virtual IoStatistics getIoStatistics() = 0;
 };
 
 }
@@ -0,0 +1,196 @@
+/********************************************************************
+ * 2014 -
+ * open source under Apache License Version 2.0
+ ********************************************************************/
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HDFS_LIBHDFS3_CLIENT_IOSTATISTICS_H_
+#define _HDFS_LIBHDFS3_CLIENT_IOSTATISTICS_H_
+
+#include <stdint.h>
+
+namespace Hdfs {
+
+/**
+ * I/O statistics of a stream, or of all the streams of a file system.
+ */
+class IoStatistics {
+public:
+    /**
+     * The number of buckets of the read latency histogram.
+     */
+    static const int ReadLatencyBuckets = 20;
+
+    IoStatistics() :
+        bytesRead(0), bytesReadLocal(0), bytesReadShortCircuit(0),
+        bytesReadZeroCopy(0), blockReads(0), reconnects(0), checksumTime(0),
+        bytesWritten(0), pipelineRecoveries(0) {
+        for (int i = 0; i < ReadLatencyBuckets; ++i) {
+            readLatency[i] = 0;
+        }
+    }
+
+    /**
+     * Return the number of bytes read.
+     * @return bytes read.
+     */
+    int64_t getBytesRead() const {
+        return bytesRead;
+    }
+
+    void setBytesRead(int64_t bytesRead) {
+        this->bytesRead = bytesRead;
+    }
+
+    /**
+     * Return the number of bytes read from a datanode on this host,
+     * include the bytes read by short-circuit.
+     * @return bytes read locally.
+     */
+    int64_t getBytesReadLocal() const {
+        return bytesReadLocal;
+    }
+
+    void setBytesReadLocal(int64_t bytesReadLocal) {
+        this->bytesReadLocal = bytesReadLocal;
+    }
+
+    /**
+     * Return the number of bytes read from a datanode on another host.
+     * @return bytes read remotely.
+     */
+    int64_t getBytesReadRemote() const {
+        return bytesRead - bytesReadLocal;
+    }
+
+    /**
+     * Return the number of bytes read directly from the block files.
+     * @return bytes read by short-circuit.
+     */
+    int64_t getBytesReadShortCircuit() const {
+        return bytesReadShortCircuit;
+    }
+
+    void setBytesReadShortCircuit(int64_t bytesReadShortCircuit) {
+        this->bytesReadShortCircuit = bytesReadShortCircuit;
+    }
+
+    /**
+     * Return the number of bytes read without copy from the mapped block files.
+     * @return bytes read by zero copy.
+     */
+    int64_t getBytesReadZeroCopy() const {
+        return bytesReadZeroCopy;
+    }
+
+    void setBytesReadZeroCopy(int64_t bytesReadZeroCopy) {
+        this->bytesReadZeroCopy = bytesReadZeroCopy;
+    }
+
+    /**
+     * Return the number of reads served by the block readers.
+     * @return block reads.
+     */
+    int64_t getBlockReads() const {
+        return blockReads;
+    }
+
+    void setBlockReads(int64_t blockReads) {
+        this->blockReads = blockReads;
+    }
+
+    /**
+     * Return a bucket of the read latency histogram. The bucket i counts
+     * the block reads which took less than 2^i microseconds and at least
+     * 2^(i-1), the last bucket counts the slower ones too.
+     * @param bucket the bucket, from 0 to ReadLatencyBuckets - 1.
+     * @return the number of block reads.
+     */
+    int64_t getReadLatency(int bucket) const {
+        return readLatency[bucket];
+    }
+
+    void setReadLatency(int bucket, int64_t count) {
+        readLatency[bucket] = count;
+    }
+
+    /**
+     * Return the number of times a datanode connection was set up again
+     * after a failure.
+     * @return reconnects.
+     */
+    int64_t getReconnects() const {
+        return reconnects;
+    }
+
+    void setReconnects(int64_t reconnects) {
+        this->reconnects = reconnects;
+    }
+
+    /**
+     * Return the time spent verifying checksums of the data read.
+     * @return checksum time in microseconds.
+     */
+    int64_t getChecksumTime() const {
+        return checksumTime;
+    }
+
+    void setChecksumTime(int64_t checksumTime) {
+        this->checksumTime = checksumTime;
+    }
+
+    /**
+     * Return the number of bytes written.
+     * @return bytes written.
+     */
+    int64_t getBytesWritten() const {
+        return bytesWritten;
+    }
+
+    void setBytesWritten(int64_t bytesWritten) {
+        this->bytesWritten = bytesWritten;
+    }
+
+    /**
+     * Return the number of times a write pipeline was recovered.
+     * @return pipeline recoveries.
+     */
+    int64_t getPipelineRecoveries() const {
+        return pipelineRecoveries;
+    }
+
+    void setPipelineRecoveries(int64_t pipelineRecoveries) {
+        this->pipelineRecoveries = pipelineRecoveries;
+    }
+
+private:
+    int64_t bytesRead;
+    int64_t bytesReadLocal;
+    int64_t bytesReadShortCircuit;
+    int64_t bytesReadZeroCopy;
+    int64_t blockReads;
+    int64_t readLatency[ReadLatencyBuckets];
+    int64_t reconnects;
+    int64_t checksumTime;
+    int64_t bytesWritten;
+    int64_t pipelineRecoveries;
+};
+
+}
+
+#endif /* _HDFS_LIBHDFS3_CLIENT_IOSTATISTICS_H_ */
@@ -0,0 +1,134 @@
+/********************************************************************
+ * 2014 -
+ * open source under Apache License Version 2.0
+ ********************************************************************/
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "IoStatsCounter.h"
+
+namespace Hdfs {
+namespace Internal {
+
+IoStatsCounter::IoStatsCounter() :
+    bytesRead(0), bytesReadLocal(0), bytesReadShortCircuit(0),
+    bytesReadZeroCopy(0), blockReads(0), reconnects(0), checksumTime(0),
+    bytesWritten(0), pipelineRecoveries(0) {
+    for (int i = 0; i < IoStatistics::ReadLatencyBuckets; ++i) {
+        readLatency[i] = 0;
+    }
+}
+
+IoStatsCounter::IoStatsCounter(shared_ptr<IoStatsCounter> parent) :
+    bytesRead(0), bytesReadLocal(0), bytesReadShortCircuit(0),
+    bytesReadZeroCopy(0), blockReads(0), reconnects(0), checksumTime(0),
+    bytesWritten(0), pipelineRecoveries(0), parent(parent) {
+    for (int i = 0; i < IoStatistics::ReadLatencyBuckets; ++i) {
+        readLatency[i] = 0;
+    }
+}
+
+void IoStatsCounter::addRead(int64_t bytes, int64_t micros, bool local,
+                             bool shortCircuit) {
+    int bucket = 0;
+
+    while (bucket < IoStatistics::ReadLatencyBuckets - 1
+            && micros >= (static_cast<int64_t>(1) << bucket)) {
+        ++bucket;
+    }
+
+    bytesRead += bytes;
+    ++blockReads;
+    ++readLatency[bucket];
+
+    if (local) {
+        bytesReadLocal += bytes;
+    }
+
+    if (shortCircuit) {
+        bytesReadShortCircuit += bytes;
+    }
+
+    if (parent) {
+        parent->addRead(bytes, micros, local, shortCircuit);
+    }
+}
+
+void IoStatsCounter::addZeroCopyRead(int64_t bytes) {
+    bytesRead += bytes;
+    bytesReadLocal += bytes;
+    bytesReadShortCircuit += bytes;
+    bytesReadZeroCopy += bytes;
+
+    if (parent) {
+        parent->addZeroCopyRead(bytes);
+    }
+}
+
+void IoStatsCounter::addReconnect() {
+    ++reconnects;
+
+    if (parent) {
+        parent->addReconnect();
+    }
+}
+
+void IoStatsCounter::addChecksumTime(int64_t micros) {
+    checksumTime += micros;
+
+    if (parent) {
+        parent->addChecksumTime(micros);
+    }
+}
+
+void IoStatsCounter::addWrite(int64_t bytes) {
+    bytesWritten += bytes;
+
+    if (parent) {
+        parent->addWrite(bytes);
+    }
+}
+
+void IoStatsCounter::addPipelineRecovery() {
+    ++pipelineRecoveries;
+
+    if (parent) {
+        parent->addPipelineRecovery();
+    }
+}
+
+IoStatistics IoStatsCounter::get() const {
+    IoStatistics retval;
+    retval.setBytesRead(bytesRead);
+    retval.setBytesReadLocal(bytesReadLocal);
+    retval.setBytesReadShortCircuit(bytesReadShortCircuit);
+    retval.setBytesReadZeroCopy(bytesReadZeroCopy);
+    retval.setBlockReads(blockReads);
+    retval.setReconnects(reconnects);
+    retval.setChecksumTime(checksumTime);
+    retval.setBytesWritten(bytesWritten);
+    retval.setPipelineRecoveries(pipelineRecoveries);
+
+    for (int i = 0; i < IoStatistics::ReadLatencyBuckets; ++i) {
+        retval.setReadLatency(i, readLatency[i]);
+    }
+
+    return retval;
+}
+
+}
+}
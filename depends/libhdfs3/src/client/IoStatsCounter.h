@@ -0,0 +1,93 @@
+/********************************************************************
+ * 2014 -
+ * open source under Apache License Version 2.0
+ ********************************************************************/
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HDFS_LIBHDFS3_CLIENT_IOSTATSCOUNTER_H_
+#define _HDFS_LIBHDFS3_CLIENT_IOSTATSCOUNTER_H_
+
+#include "Atomic.h"
+#include "IoStatistics.h"
+#include "Memory.h"
+
+namespace Hdfs {
+namespace Internal {
+
+/**
+ * The I/O counters of a stream or of a file system, updated by the threads
+ * reading and writing. The counters of a stream are added to those of its
+ * file system too.
+ */
+class IoStatsCounter {
+public:
+    IoStatsCounter();
+
+    /**
+     * Construct the counters of a stream.
+     * @param parent the counters of the file system, may be empty.
+     */
+    IoStatsCounter(shared_ptr<IoStatsCounter> parent);
+
+    /**
+     * Count a read of a block reader.
+     * @param bytes the number of bytes read.
+     * @param micros the time the read took in microseconds.
+     * @param local read from a datanode on this host.
+     * @param shortCircuit read directly from the block file.
+     */
+    void addRead(int64_t bytes, int64_t micros, bool local, bool shortCircuit);
+
+    /**
+     * Count a read of a mapped block file.
+     * @param bytes the number of bytes read.
+     */
+    void addZeroCopyRead(int64_t bytes);
+
+    void addReconnect();
+
+    void addChecksumTime(int64_t micros);
+
+    void addWrite(int64_t bytes);
+
+    void addPipelineRecovery();
+
+    /**
+     * Get a snapshot of the counters.
+     * @return the statistics.
+     */
+    IoStatistics get() const;
+
+private:
+    atomic<int64_t> bytesRead;
+    atomic<int64_t> bytesReadLocal;
+    atomic<int64_t> bytesReadShortCircuit;
+    atomic<int64_t> bytesReadZeroCopy;
+    atomic<int64_t> blockReads;
+    atomic<int64_t> readLatency[IoStatistics::ReadLatencyBuckets];
+    atomic<int64_t> reconnects;
+    atomic<int64_t> checksumTime;
+    atomic<int64_t> bytesWritten;
+    atomic<int64_t> pipelineRecoveries;
+    shared_ptr<IoStatsCounter> parent;
+};
+
+}
+}
+
+#endif /* _HDFS_LIBHDFS3_CLIENT_IOSTATSCOUNTER_H_ */
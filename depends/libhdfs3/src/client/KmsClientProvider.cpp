@@ -0,0 +1,329 @@
+/********************************************************************
+ * 2014 -
+ * open source under Apache License Version 2.0
+ ********************************************************************/
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "DateTime.h"
+#include "Exception.h"
+#include "ExceptionInternal.h"
+#include "KmsClientProvider.h"
+#include "Logger.h"
+#include "LruMap.h"
+#include "network/TcpSocket.h"
+#include "Token.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+namespace Hdfs {
+namespace Internal {
+
+static const size_t MaxResponseSize = 1024 * 1024;
+
+struct CachedKey {
+    steady_clock::time_point time;
+    std::string key;
+};
+
+/*
+ * The decrypted keys, by the version of the zone key, the encrypted key and
+ * the IV of the file.
+ */
+static LruMap<std::string, CachedKey> & KeyCache() {
+    static LruMap<std::string, CachedKey> cache;
+    return cache;
+}
+
+static std::string UrlEncode(const std::string & str) {
+    static const char hex[] = "0123456789ABCDEF";
+    std::string retval;
+
+    for (size_t i = 0; i < str.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(str[i]);
+
+        if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+            retval.push_back(c);
+        } else {
+            retval.push_back('%');
+            retval.push_back(hex[c >> 4]);
+            retval.push_back(hex[c & 0xF]);
+        }
+    }
+
+    return retval;
+}
+
+static std::string JsonEscape(const std::string & str) {
+    std::string retval;
+    char buf[8];
+
+    for (size_t i = 0; i < str.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(str[i]);
+
+        if (c == '"' || c == '\\') {
+            retval.push_back('\\');
+            retval.push_back(c);
+        } else if (c < 0x20) {
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            retval.append(buf);
+        } else {
+            retval.push_back(c);
+        }
+    }
+
+    return retval;
+}
+
+/*
+ * Get a string member of a flat json object, which is all the responses of
+ * the key management server are.
+ */
+static bool GetJsonString(const std::string & json, const char * name,
+                          std::string & value) {
+    std::string key = std::string("\"") + name + "\"";
+    size_t pos = json.find(key);
+
+    if (pos == json.npos) {
+        return false;
+    }
+
+    pos = json.find_first_not_of(" \t\r\n", pos + key.size());
+
+    if (pos == json.npos || json[pos] != ':') {
+        return false;
+    }
+
+    pos = json.find_first_not_of(" \t\r\n", pos + 1);
+
+    if (pos == json.npos || json[pos] != '"') {
+        return false;
+    }
+
+    value.clear();
+
+    for (++pos; pos < json.size() && json[pos] != '"'; ++pos) {
+        if (json[pos] == '\\' && pos + 1 < json.size()) {
+            ++pos;
+        }
+
+        value.push_back(json[pos]);
+    }
+
+    return pos < json.size();
+}
+
+KmsClientProvider::KmsClientProvider(const SessionConfig & conf, const UserInfo & user) :
+    port(0), timeout(conf.getKmsTimeout()), cacheSize(conf.getKeyCacheSize()),
+    cacheExpiry(conf.getKeyCacheExpiry()), realUser(user.getRealUser()),
+    user(user.getEffectiveUser()) {
+    if (conf.getKeyProviderUri().empty()) {
+        THROW(HdfsIOException,
+              "KmsClientProvider: no key management server is set by dfs.encryption.key.provider.uri for the encrypted files.");
+    }
+
+    parseUri(conf.getKeyProviderUri());
+
+    if (cacheSize > 0) {
+        KeyCache().setMaxSize(cacheSize);
+    }
+}
+
+void KmsClientProvider::parseUri(const std::string & uri) {
+    static const std::string prefix = "kms://";
+    size_t at = uri.find('@');
+
+    if (uri.compare(0, prefix.size(), prefix) != 0 || at == uri.npos) {
+        THROW(HdfsConfigInvalid,
+              "Invalid configure item: \"dfs.encryption.key.provider.uri\", value: %s, expected kms://http@host:port/path",
+              uri.c_str());
+    }
+
+    std::string scheme = uri.substr(prefix.size(), at - prefix.size());
+
+    if (scheme != "http") {
+        THROW(UnsupportedOperationException,
+              "KmsClientProvider: the %s key management server %s is not supported.",
+              scheme.c_str(), uri.c_str());
+    }
+
+    size_t slash = uri.find('/', at + 1);
+    std::string authority = uri.substr(at + 1, slash == uri.npos ? uri.npos : slash - at - 1);
+    path = slash == uri.npos ? "" : uri.substr(slash);
+
+    while (!path.empty() && path[path.size() - 1] == '/') {
+        path.resize(path.size() - 1);
+    }
+
+    size_t colon = authority.rfind(':');
+
+    if (colon != authority.npos) {
+        port = atoi(authority.c_str() + colon + 1);
+    }
+
+    std::stringstream ss(authority.substr(0, colon));
+    std::string host;
+
+    while (std::getline(ss, host, ';')) {
+        if (!host.empty()) {
+            hosts.push_back(host);
+        }
+    }
+
+    if (port <= 0 || hosts.empty()) {
+        THROW(HdfsConfigInvalid,
+              "Invalid configure item: \"dfs.encryption.key.provider.uri\", value: %s, expected kms://http@host:port/path",
+              uri.c_str());
+    }
+}
+
+std::string KmsClientProvider::decryptEncryptedKey(const FileEncryptionInfo & info) {
+    std::string id = info.getEzKeyVersionName() + '\0' + info.getKey() + '\0' + info.getIv();
+    exception_ptr lastError;
+    CachedKey cached;
+
+    if (cacheSize > 0 && KeyCache().find(id, &cached)) {
+        if (ToMilliSeconds(cached.time, steady_clock::now()) < cacheExpiry) {
+            return cached.key;
+        }
+
+        KeyCache().erase(id);
+    }
+
+    for (size_t i = 0; i < hosts.size(); ++i) {
+        try {
+            cached.key = decryptFromServer(hosts[i], info);
+            cached.time = steady_clock::now();
+
+            if (cacheSize > 0) {
+                KeyCache().insert(id, cached);
+            }
+
+            return cached.key;
+        } catch (const AccessControlException & e) {
+            throw;
+        } catch (const HdfsException & e) {
+            std::string buffer;
+            LOG(LOG_ERROR,
+                "KmsClientProvider: failed to decrypt a key of %s on key management server %s:%d\n%s",
+                info.getEzKeyVersionName().c_str(), hosts[i].c_str(), port,
+                GetExceptionDetail(e, buffer));
+            lastError = current_exception();
+        }
+    }
+
+    rethrow_exception(lastError);
+}
+
+/*
+ * The decrypt call of the REST API of the key management server, over
+ * HTTP/1.0 so the response is neither chunked nor kept alive.
+ */
+std::string KmsClientProvider::decryptFromServer(const std::string & host,
+        const FileEncryptionInfo & info) {
+    std::stringstream body, request;
+    body.imbue(std::locale::classic());
+    request.imbue(std::locale::classic());
+    body << "{\"name\":\"" << JsonEscape(info.getKeyName())
+         << "\",\"iv\":\"" << Base64UrlEncode(info.getIv().data(), info.getIv().size())
+         << "\",\"material\":\"" << Base64UrlEncode(info.getKey().data(), info.getKey().size())
+         << "\"}";
+    std::string content = body.str();
+    request << "POST " << path << "/v1/keyversion/" << UrlEncode(info.getEzKeyVersionName())
+            << "/_eek?eek_op=decrypt&user.name=" << UrlEncode(realUser.empty() ? user : realUser);
+
+    if (!realUser.empty()) {
+        request << "&doAs=" << UrlEncode(user);
+    }
+
+    request << " HTTP/1.0\r\n"
+            << "Host: " << host << ":" << port << "\r\n"
+            << "Content-Type: application/json\r\n"
+            << "Content-Length: " << content.size() << "\r\n\r\n"
+            << content;
+    std::string out = request.str();
+    std::string response;
+    std::vector<char> buffer(4096);
+    TcpSocketImpl sock;
+    sock.connect(host.c_str(), port, timeout);
+    sock.writeFully(out.data(), out.size(), timeout);
+
+    while (true) {
+        if (!sock.poll(true, false, timeout)) {
+            THROW(HdfsTimeoutException,
+                  "KmsClientProvider: read from key management server %s:%d timed out.",
+                  host.c_str(), port);
+        }
+
+        try {
+            int32_t done = sock.read(&buffer[0], buffer.size());
+            response.append(&buffer[0], done);
+        } catch (const HdfsEndOfStream & e) {
+            break;
+        }
+
+        if (response.size() > MaxResponseSize) {
+            THROW(HdfsIOException,
+                  "KmsClientProvider: the response of key management server %s:%d is too large.",
+                  host.c_str(), port);
+        }
+    }
+
+    int status = 0;
+    size_t header = response.find("\r\n\r\n");
+
+    if (header == response.npos
+            || 1 != sscanf(response.c_str(), "HTTP/%*d.%*d %d", &status)) {
+        THROW(HdfsIOException,
+              "KmsClientProvider: invalid response from key management server %s:%d.",
+              host.c_str(), port);
+    }
+
+    content = response.substr(header + 4);
+
+    if (status == 401 || status == 403) {
+        THROW(AccessControlException,
+              "KmsClientProvider: key management server %s:%d denied user %s to decrypt a key of %s: %.256s",
+              host.c_str(), port, user.c_str(), info.getKeyName().c_str(), content.c_str());
+    }
+
+    std::string material;
+
+    if (status != 200 || !GetJsonString(content, "material", material)) {
+        THROW(HdfsIOException,
+              "KmsClientProvider: key management server %s:%d failed to decrypt a key of %s, status %d: %.256s",
+              host.c_str(), port, info.getKeyName().c_str(), status, content.c_str());
+    }
+
+    std::vector<char> key;
+
+    try {
+        Base64UrlDecode(material, key);
+    } catch (const std::invalid_argument & e) {
+        THROW(HdfsIOException,
+              "KmsClientProvider: key management server %s:%d returned an invalid key of %s.",
+              host.c_str(), port, info.getKeyName().c_str());
+    }
+
+    return std::string(key.begin(), key.end());
+}
+
+}
+}
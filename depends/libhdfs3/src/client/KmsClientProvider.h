@@ -0,0 +1,76 @@
+/********************************************************************
+ * 2014 -
+ * open source under Apache License Version 2.0
+ ********************************************************************/
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HDFS_LIBHDFS3_CLIENT_KMSCLIENTPROVIDER_H_
+#define _HDFS_LIBHDFS3_CLIENT_KMSCLIENTPROVIDER_H_
+
+#include "FileEncryptionInfo.h"
+#include "SessionConfig.h"
+#include "UserInfo.h"
+
+#include <string>
+#include <vector>
+
+namespace Hdfs {
+namespace Internal {
+
+/**
+ * A client of the Hadoop key management server, to decrypt the data
+ * encryption key of a file in an encryption zone with the key of the zone.
+ *
+ * The server is given by dfs.encryption.key.provider.uri, for example
+ * kms://http@host1;host2:16000/kms, the hosts are tried in turn. Only http
+ * with simple authentication is supported.
+ *
+ * The decrypted keys are kept in a cache shared by the whole process, so
+ * only the first open of a file asks the server.
+ */
+class KmsClientProvider {
+public:
+    KmsClientProvider(const SessionConfig & conf, const UserInfo & user);
+
+    /**
+     * Get the decrypted data encryption key of a file.
+     * @param info the encryption information of the file.
+     * @return the key.
+     */
+    std::string decryptEncryptedKey(const FileEncryptionInfo & info);
+
+private:
+    void parseUri(const std::string & uri);
+    std::string decryptFromServer(const std::string & host,
+                                  const FileEncryptionInfo & info);
+
+private:
+    int port;
+    int timeout;
+    int32_t cacheSize;
+    int32_t cacheExpiry;
+    std::string path;
+    std::string realUser;
+    std::string user;
+    std::vector<std::string> hosts;
+};
+
+}
+}
+
+#endif /* _HDFS_LIBHDFS3_CLIENT_KMSCLIENTPROVIDER_H_ */
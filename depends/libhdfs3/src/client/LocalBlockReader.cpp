@@ -21,6 +21,7 @@
  */
 #include "BigEndian.h"
 #include "datatransfer.pb.h"
+#include "DateTime.h"
 #include "Exception.h"
 #include "ExceptionInternal.h"
 #include "HWCrc32c.h"
@@ -41,7 +42,8 @@ namespace Internal {
 LocalBlockReader::LocalBlockReader(const shared_ptr<ReadShortCircuitInfo>& info,
                                    const ExtendedBlock& block, int64_t offset,
                                    bool verify, SessionConfig& conf,
-                                   std::vector<char>& buffer)
+                                   std::vector<char>& buffer,
+                                   IoStatsCounter& stats)
     : verify(verify),
       pbuffer(NULL),
       pMetaBuffer(NULL),
@@ -52,6 +54,7 @@ LocalBlockReader::LocalBlockReader(const shared_ptr<ReadShortCircuitInfo>& info,
       size(0),
       cursor(0),
       length(block.getNumBytes()),
+      stats(stats),
       info(info),
       buffer(buffer) {
     try {
@@ -131,20 +134,16 @@ void LocalBlockReader::readAndVerify(int32_t bufferSize) {
     int chunks = (bufferSize + chunkSize - 1) / chunkSize;
     pbuffer = dataFd->read(buffer, bufferSize);
     pMetaBuffer = metaFd->read(metaBuffer, chunks * checksumSize);
+    sums.resize(chunks);
+    steady_clock::time_point s = steady_clock::now();
+    checksum->updateChunks(pbuffer, bufferSize, chunkSize, &sums[0]);
+    stats.addChecksumTime(ToMicroSeconds(s, steady_clock::now()));
 
     for (int i = 0; i < chunks; ++i) {
-        checksum->reset();
-        int chunk = chunkSize;
-
-        if (chunkSize * (i + 1) > bufferSize) {
-            chunk = bufferSize % chunkSize;
-        }
-
-        checksum->update(&pbuffer[i * chunkSize], chunk);
         uint32_t target = ReadBigEndian32FromArray(
                               &pMetaBuffer[i * checksumSize]);
 
-        if (target != checksum->getValue()) {
+        if (target != sums[i]) {
             THROW(ChecksumException,
                   "LocalBlockReader checksum not match for block: %s",
                   block.toString().c_str());
@@ -206,7 +205,10 @@ int32_t LocalBlockReader::readInternal(char * buf, int32_t len) {
 
 int32_t LocalBlockReader::read(char * buf, int32_t size) {
     try {
-        return readInternal(buf, size);
+        steady_clock::time_point s = steady_clock::now();
+        int32_t done = readInternal(buf, size);
+        stats.addRead(done, ToMicroSeconds(s, steady_clock::now()), true, true);
+        return done;
     } catch (const HdfsCanceled & e) {
         throw;
     } catch (const HdfsException & e) {
@@ -220,6 +222,97 @@ int32_t LocalBlockReader::read(char * buf, int32_t size) {
     return 0;
 }
 
+int32_t LocalBlockReader::readMapped(int32_t len, bool skipChecksum,
+                                     const char ** data, shared_ptr<FileWrapper> & mapping) {
+    if (!dataFd->isMapped()) {
+        return -1;
+    }
+
+    try {
+        int32_t done = readMappedInternal(len, skipChecksum, data);
+        mapping = dataFd;
+        stats.addZeroCopyRead(done);
+        return done;
+    } catch (const HdfsCanceled & e) {
+        throw;
+    } catch (const HdfsException & e) {
+        info->setValid(false);
+        NESTED_THROW(HdfsIOException,
+                     "LocalBlockReader failed to read from position: %" PRId64 ", length: %d, block: %s.",
+                     cursor, len, block.toString().c_str());
+    }
+
+    assert(!"cannot reach here");
+    return 0;
+}
+
+/*
+ * As readInternal, but the buffer of a mapped replica points into the
+ * mapping, so its bytes are returned in place.
+ */
+int32_t LocalBlockReader::readMappedInternal(int32_t len, bool skipChecksum,
+        const char ** data) {
+    int32_t todo = len;
+
+    /*
+     * read from buffer, it has been verified.
+     */
+    if (position < size) {
+        todo = todo < size - position ? todo : size - position;
+        *data = &pbuffer[position];
+        position += todo;
+        cursor += todo;
+        return todo;
+    }
+
+    /*
+     * end of block
+     */
+    todo = todo < length - cursor ? todo : length - cursor;
+
+    if (0 == todo) {
+        return 0;
+    }
+
+    /*
+     * bypass the buffer and the checksums. The cursor stays on a chunk
+     * boundary, where the verified reads after this one start.
+     */
+    if (!verify || skipChecksum) {
+        if (verify && todo < length - cursor) {
+            todo = todo / chunkSize * chunkSize;
+        }
+
+        if (todo > 0) {
+            *data = dataFd->read(buffer, todo);
+            cursor += todo;
+
+            if (verify) {
+                metaFd->seek(HEADER_SIZE + checksumSize * (cursor / chunkSize));
+            }
+
+            return todo;
+        }
+    }
+
+    /*
+     * fill buffer.
+     */
+    int bufferSize = localBufferSize;
+    bufferSize = bufferSize < length - cursor ? bufferSize : length - cursor;
+    assert(bufferSize > 0);
+
+    if (verify) {
+        readAndVerify(bufferSize);
+    } else {
+        pbuffer = dataFd->read(buffer, bufferSize);
+    }
+
+    position = 0;
+    size = bufferSize;
+    return readMappedInternal(len, skipChecksum, data);
+}
+
 void LocalBlockReader::skip(int64_t len) {
     assert(len < length - cursor);
 
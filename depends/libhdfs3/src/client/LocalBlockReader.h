@@ -25,6 +25,7 @@
 #include "BlockReader.h"
 #include "Checksum.h"
 #include "FileWrapper.h"
+#include "IoStatsCounter.h"
 #include "Memory.h"
 #include "ReadShortCircuitInfo.h"
 #include "SessionConfig.h"
@@ -38,7 +39,8 @@ class LocalBlockReader: public BlockReader {
 public:
     LocalBlockReader(const shared_ptr<ReadShortCircuitInfo>& info,
                      const ExtendedBlock & block, int64_t offset, bool verify,
-                     SessionConfig & conf, std::vector<char> & buffer);
+                     SessionConfig & conf, std::vector<char> & buffer,
+                     IoStatsCounter & stats);
 
     ~LocalBlockReader();
 
@@ -65,6 +67,19 @@ public:
      */
     virtual void skip(int64_t len);
 
+    /**
+     * To read data from block without copying it, if the replica is
+     * memory mapped.
+     * @param len the max number of bytes to be read.
+     * @param skipChecksum do not verify the checksums of the bytes.
+     * @param data set to the bytes in the mapping.
+     * @param mapping set to the file which keeps the mapping valid.
+     * @return return the number of bytes read, 0 if reach the end of
+     *  block, -1 if the replica is not memory mapped.
+     */
+    int32_t readMapped(int32_t len, bool skipChecksum, const char ** data,
+                       shared_ptr<FileWrapper> & mapping);
+
 private:
     /**
      * Fill buffer and verify checksum.
@@ -72,6 +87,7 @@ private:
      */
     void readAndVerify(int32_t bufferSize);
     int32_t readInternal(char * buf, int32_t len);
+    int32_t readMappedInternal(int32_t len, bool skipChecksum, const char ** data);
 
 private:
     bool verify; //verify checksum or not.
@@ -88,9 +104,11 @@ private:
     shared_ptr<Checksum> checksum;
     shared_ptr<FileWrapper> dataFd;
     shared_ptr<FileWrapper> metaFd;
+    IoStatsCounter & stats;
     shared_ptr<ReadShortCircuitInfo> info;
     std::vector<char> & buffer;
     std::vector<char> metaBuffer;
+    std::vector<uint32_t> sums;
 };
 
 }
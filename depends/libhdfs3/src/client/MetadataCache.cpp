@@ -0,0 +1,158 @@
+/********************************************************************
+ * 2014 -
+ * open source under Apache License Version 2.0
+ ********************************************************************/
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "MetadataCache.h"
+
+namespace Hdfs {
+namespace Internal {
+
+MetadataCache::MetadataCache(size_t size, int expiry) :
+    expiry(expiry), statuses(size), locations(size) {
+}
+
+bool MetadataCache::isExpired(const steady_clock::time_point & time) {
+    return ToMilliSeconds(time, steady_clock::now()) >= expiry;
+}
+
+bool MetadataCache::isWriting(const std::string & path) {
+    lock_guard<mutex> lock(mut);
+    return writing.find(path) != writing.end();
+}
+
+bool MetadataCache::getFileStatus(const std::string & path, FileStatus & status) {
+    CachedStatus cached;
+
+    if (!statuses.find(path, &cached)) {
+        return false;
+    }
+
+    if (isExpired(cached.time)) {
+        statuses.erase(path);
+        return false;
+    }
+
+    status = cached.status;
+    return true;
+}
+
+void MetadataCache::putFileStatus(const std::string & path, const FileStatus & status) {
+    if (isWriting(path)) {
+        return;
+    }
+
+    CachedStatus cached;
+    cached.time = steady_clock::now();
+    cached.status = status;
+    statuses.insert(path, cached);
+}
+
+bool MetadataCache::getBlockLocations(const std::string & path, int64_t offset,
+                                      int64_t length, LocatedBlocks & lbs) {
+    CachedBlocks cached;
+
+    if (!locations.find(path, &cached)) {
+        return false;
+    }
+
+    if (isExpired(cached.time)) {
+        locations.erase(path);
+        return false;
+    }
+
+    int64_t end = cached.offset + cached.length;
+
+    if (cached.offset > offset
+            || (offset + length > end && end < cached.blocks->getFileLength())) {
+        return false;
+    }
+
+    std::vector<LocatedBlock> & from = cached.blocks->getBlocks();
+    std::vector<LocatedBlock> & to = lbs.getBlocks();
+    to.clear();
+
+    for (size_t i = 0; i < from.size(); ++i) {
+        if (from[i].getOffset() + from[i].getNumBytes() > offset
+                && from[i].getOffset() < offset + length) {
+            to.push_back(from[i]);
+        }
+    }
+
+    lbs.setFileLength(cached.blocks->getFileLength());
+    lbs.setIsLastBlockComplete(true);
+    lbs.setUnderConstruction(false);
+    lbs.setLastBlock(shared_ptr<LocatedBlock>());
+    *lbs.getFileEncryption() = *cached.blocks->getFileEncryption();
+    return true;
+}
+
+void MetadataCache::putBlockLocations(const std::string & path, int64_t offset,
+                                      int64_t length, LocatedBlocks & lbs) {
+    if (!lbs.isLastBlockComplete() || lbs.isUnderConstruction() || isWriting(path)) {
+        return;
+    }
+
+    CachedBlocks cached;
+    cached.time = steady_clock::now();
+    cached.offset = offset;
+    cached.length = length;
+    cached.blocks = shared_ptr<LocatedBlocksImpl>(new LocatedBlocksImpl);
+    cached.blocks->getBlocks() = lbs.getBlocks();
+    cached.blocks->setFileLength(lbs.getFileLength());
+    cached.blocks->setIsLastBlockComplete(true);
+    cached.blocks->setUnderConstruction(false);
+    *cached.blocks->getFileEncryption() = *lbs.getFileEncryption();
+    locations.insert(path, cached);
+}
+
+void MetadataCache::beginWrite(const std::string & path) {
+    {
+        lock_guard<mutex> lock(mut);
+        ++writing[path];
+    }
+
+    invalidate(path);
+}
+
+void MetadataCache::endWrite(const std::string & path) {
+    {
+        lock_guard<mutex> lock(mut);
+        unordered_map<std::string, int>::iterator it = writing.find(path);
+
+        if (it != writing.end() && --it->second <= 0) {
+            writing.erase(it);
+        }
+    }
+
+    invalidate(path);
+}
+
+void MetadataCache::invalidate(const std::string & path) {
+    statuses.erase(path);
+    locations.erase(path);
+}
+
+void MetadataCache::invalidateAll() {
+    statuses.clear();
+    locations.clear();
+}
+
+}
+}
@@ -0,0 +1,105 @@
+/********************************************************************
+ * 2014 -
+ * open source under Apache License Version 2.0
+ ********************************************************************/
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HDFS_LIBHDFS3_CLIENT_METADATACACHE_H_
+#define _HDFS_LIBHDFS3_CLIENT_METADATACACHE_H_
+
+#include "DateTime.h"
+#include "FileStatus.h"
+#include "LruMap.h"
+#include "Memory.h"
+#include "server/LocatedBlocks.h"
+#include "Thread.h"
+#include "Unordered.h"
+
+#include <string>
+
+namespace Hdfs {
+namespace Internal {
+
+/*
+ * A client side cache of the file status and the block locations returned
+ * by the namenode, so the files opened and stated again and again are not
+ * asked for every time.
+ *
+ * The entries expire after a while, since other clients may change the
+ * files. The changes done through this client invalidate them. The block
+ * locations are only cached for complete files, and nothing is cached for
+ * the files this client holds the lease of, from create or append to
+ * complete.
+ */
+class MetadataCache {
+public:
+    MetadataCache(size_t size, int expiry);
+
+    bool getFileStatus(const std::string & path, FileStatus & status);
+
+    void putFileStatus(const std::string & path, const FileStatus & status);
+
+    /*
+     * Get the blocks overlapping the given range, if a cached range covers
+     * it, or covers it up to the end of the file.
+     */
+    bool getBlockLocations(const std::string & path, int64_t offset,
+                           int64_t length, LocatedBlocks & lbs);
+
+    void putBlockLocations(const std::string & path, int64_t offset,
+                           int64_t length, LocatedBlocks & lbs);
+
+    /*
+     * The lease of the file is taken or released by this client.
+     */
+    void beginWrite(const std::string & path);
+
+    void endWrite(const std::string & path);
+
+    void invalidate(const std::string & path);
+
+    void invalidateAll();
+
+private:
+    struct CachedStatus {
+        steady_clock::time_point time;
+        FileStatus status;
+    };
+
+    struct CachedBlocks {
+        steady_clock::time_point time;
+        int64_t offset;
+        int64_t length;
+        shared_ptr<LocatedBlocksImpl> blocks;
+    };
+
+    bool isWriting(const std::string & path);
+    bool isExpired(const steady_clock::time_point & time);
+
+private:
+    int expiry;
+    LruMap<std::string, CachedStatus> statuses;
+    LruMap<std::string, CachedBlocks> locations;
+    mutex mut;
+    unordered_map<std::string, int> writing;
+};
+
+}
+}
+
+#endif /* _HDFS_LIBHDFS3_CLIENT_METADATACACHE_H_ */
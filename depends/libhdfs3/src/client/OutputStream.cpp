@@ -87,4 +87,12 @@ void OutputStream::close() {
     impl->close();
 }
 
+/**
+ * To get the I/O statistics of the stream.
+ * @return the I/O statistics.
+ */
+IoStatistics OutputStream::getIoStatistics() {
+    return impl->getIoStatistics();
+}
+
 }
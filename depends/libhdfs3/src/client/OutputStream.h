@@ -116,6 +116,12 @@ public:
      */
     void close();
 
+    /**
+     * To get the I/O statistics of the stream.
+     * @return the I/O statistics.
+     */
+    IoStatistics getIoStatistics();
+
 private:
     Internal::OutputStreamInter * impl;
 
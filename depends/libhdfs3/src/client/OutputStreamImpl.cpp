@@ -25,6 +25,7 @@
 #include "ExceptionInternal.h"
 #include "FileSystemInter.h"
 #include "HWCrc32c.h"
+#include "KmsClientProvider.h"
 #include "LeaseRenewer.h"
 #include "Logger.h"
 #include "OutputStream.h"
@@ -52,6 +53,7 @@ OutputStreamImpl::OutputStreamImpl() :
 
     checksumSize = sizeof(int32_t);
     lastSend = steady_clock::now();
+    ioStats = shared_ptr<IoStatsCounter>(new IoStatsCounter);
 #ifdef MOCK
     stub = NULL;
 #endif
@@ -149,6 +151,7 @@ void OutputStreamImpl::initAppend() {
     try {
         this->blockSize = fileInfo.getBlockSize();
         cursor = fileInfo.getLength();
+        setupCodec(fileInfo);
 
         if (lastBlock) {
             isAppend = true;
@@ -197,6 +200,7 @@ void OutputStreamImpl::openInternal(shared_ptr<FileSystemInter> fs, const char *
                                     int flag, const Permission & permission, bool createParent,
                                     int replication, int64_t blockSize) {
     filesystem = fs;
+    ioStats = shared_ptr<IoStatsCounter>(new IoStatsCounter(fs->getIoStats()));
     this->path = fs->getStandardPath(path);
     this->replication = replication;
     this->blockSize = blockSize;
@@ -247,9 +251,20 @@ void OutputStreamImpl::openInternal(shared_ptr<FileSystemInter> fs, const char *
     }
 
     assert((flag & Create) || (flag & Overwrite));
-    fs->create(this->path, permission, flag, createParent, this->replication,
-               this->blockSize);
+    shared_ptr<FileStatus> status = fs->create(this->path, permission, flag, createParent,
+                                               this->replication, this->blockSize);
     closed = false;
+
+    try {
+        if (status) {
+            setupCodec(*status);
+        }
+    } catch (...) {
+        completeFile(false);
+        reset();
+        throw;
+    }
+
     computePacketChunkSize();
     LeaseRenewer::GetLeaseRenewer().StartRenew(filesystem);
 }
@@ -269,7 +284,13 @@ void OutputStreamImpl::append(const char * buf, int64_t size) {
     checkStatus();
 
     try {
-        appendInternal(buf, size);
+        if (codec) {
+            appendEncrypted(buf, size);
+        } else {
+            appendInternal(buf, size);
+        }
+
+        ioStats->addWrite(size);
     } catch (...) {
         setError(current_exception());
         throw;
@@ -326,6 +347,35 @@ void OutputStreamImpl::appendInternal(const char * buf, int64_t size) {
     cursor += size;
 }
 
+/*
+ * Encrypt the bytes of a file in an encryption zone into cryptoBuffer, a
+ * batch at a time, and append them.
+ */
+void OutputStreamImpl::appendEncrypted(const char * buf, int64_t size) {
+    if (cryptoBuffer.empty()) {
+        cryptoBuffer.resize(conf->getDefaultPacketSize());
+    }
+
+    for (int64_t done = 0; done < size;) {
+        int64_t batch = static_cast<int64_t>(cryptoBuffer.size());
+        batch = batch < size - done ? batch : size - done;
+        codec->process(buf + done, &cryptoBuffer[0], batch, cursor);
+        appendInternal(&cryptoBuffer[0], batch);
+        done += batch;
+    }
+}
+
+/*
+ * Set up the cipher of the file, if it is in an encryption zone.
+ */
+void OutputStreamImpl::setupCodec(FileStatus & status) {
+    if (status.isFileEncrypted()) {
+        FileEncryptionInfo * info = status.getFileEncryption();
+        KmsClientProvider kms(*conf, filesystem->getUserInfo());
+        codec = shared_ptr<CryptoCodec>(new CryptoCodec(*info, kms.decryptEncryptedKey(*info)));
+    }
+}
+
 void OutputStreamImpl::appendChunkToPacket(const char * buf, int size) {
     assert(NULL != buf && size > 0);
 
@@ -356,7 +406,7 @@ void OutputStreamImpl::setupPipeline() {
 #else
     pipeline = shared_ptr<Pipeline>(new PipelineImpl(isAppend, path.c_str(), *conf, filesystem,
                                     CHECKSUM_TYPE_CRC32C, conf->getDefaultChunkSize(), replication,
-                                    currentPacket->getOffsetInBlock(), packets, lastBlock));
+                                    currentPacket->getOffsetInBlock(), packets, lastBlock, ioStats));
 #endif
     lastSend = steady_clock::now();
     /*
@@ -425,6 +475,10 @@ void OutputStreamImpl::flushInternal(bool needSync) {
  * return the current file length.
  * @return current file length.
  */
+IoStatistics OutputStreamImpl::getIoStatistics() {
+    return ioStats->get();
+}
+
 int64_t OutputStreamImpl::tell() {
     checkStatus();
     return cursor;
@@ -564,7 +618,9 @@ void OutputStreamImpl::reset() {
     chunksPerPacket = 0;
     closed = true;
     closeTimeout = 0;
+    codec.reset();
     conf.reset();
+    cryptoBuffer.clear();
     currentPacket.reset();
     cursor = 0;
     filesystem.reset();
@@ -24,8 +24,10 @@
 
 #include "Atomic.h"
 #include "Checksum.h"
+#include "CryptoCodec.h"
 #include "DateTime.h"
 #include "ExceptionInternal.h"
+#include "FileStatus.h"
 #include "FileSystem.h"
 #include "Memory.h"
 #include "OutputStreamInter.h"
@@ -104,8 +106,15 @@ public:
      */
     void setError(const exception_ptr & error);
 
+    /**
+     * Get the I/O statistics of this output stream.
+     * @return the statistics.
+     */
+    IoStatistics getIoStatistics();
+
 private:
     void appendChunkToPacket(const char * buf, int size);
+    void appendEncrypted(const char * buf, int64_t size);
     void appendInternal(const char * buf, int64_t size);
     void checkStatus();
     void closePipeline();
@@ -119,6 +128,7 @@ private:
                       int64_t blockSize);
     void reset();
     void sendPacket(shared_ptr<Packet> packet);
+    void setupCodec(FileStatus & status);
     void setupPipeline();
 
 private:
@@ -144,13 +154,16 @@ private:
     mutex mut;
     PacketPool packets;
     shared_ptr<Checksum> checksum;
+    shared_ptr<CryptoCodec> codec; //the cipher of a file in an encryption zone.
     shared_ptr<FileSystemInter> filesystem;
+    shared_ptr<IoStatsCounter> ioStats;
     shared_ptr<LocatedBlock> lastBlock;
     shared_ptr<Packet> currentPacket;
     shared_ptr<Pipeline> pipeline;
     shared_ptr<SessionConfig> conf;
     std::string path;
     std::vector<char> buffer;
+    std::vector<char> cryptoBuffer; //the encrypted bytes being appended.
     steady_clock::time_point lastSend;
     //thread heartBeatSender;
 
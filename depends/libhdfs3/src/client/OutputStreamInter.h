@@ -84,6 +84,12 @@ public:
     virtual std::string toString() = 0;
 
     virtual void setError(const exception_ptr & error) = 0;
+
+    /**
+     * Get the I/O statistics of this output stream.
+     * @return the statistics.
+     */
+    virtual IoStatistics getIoStatistics() = 0;
 };
 
 }
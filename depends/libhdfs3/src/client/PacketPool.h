@@ -22,6 +22,7 @@
 #ifndef _HDFS_LIBHDFS3_CLIENT_PACKETPOOL_H_
 #define _HDFS_LIBHDFS3_CLIENT_PACKETPOOL_H_
 #include "Memory.h"
+#include "Thread.h"
 
 #include <deque>
 
@@ -38,6 +39,8 @@ class Packet;
  * The Pipeline's packet queue size is not larger than the PacketPool's max size,
  * otherwise the write operation will be pending for the ack.
  * Once the ack is received, packet will reutrn back to the PacketPool to reuse.
+ * The acks may be processed by the responder thread of the Pipeline, so the
+ * packets are returned and taken under a lock.
  */
 class PacketPool {
 public:
@@ -56,6 +59,7 @@ public:
 
 private:
     int maxSize;
+    mutex mut;
     std::deque<shared_ptr<Packet> > packets;
 };
 
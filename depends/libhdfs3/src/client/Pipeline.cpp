@@ -36,10 +36,12 @@ namespace Internal {
 
 PipelineImpl::PipelineImpl(bool append, const char * path, const SessionConfig & conf,
                            shared_ptr<FileSystemInter> filesystem, int checksumType, int chunkSize,
-                           int replication, int64_t bytesSent, PacketPool & packetPool, shared_ptr<LocatedBlock> lastBlock) :
-    checksumType(checksumType), chunkSize(chunkSize), errorIndex(-1), replication(replication), bytesAcked(
-        bytesSent), bytesSent(bytesSent), packetPool(packetPool), filesystem(filesystem), lastBlock(lastBlock), path(
+                           int replication, int64_t bytesSent, PacketPool & packetPool, shared_ptr<LocatedBlock> lastBlock,
+                           shared_ptr<IoStatsCounter> stats) :
+    responderFailed(false), responderStop(true), checksumType(checksumType), chunkSize(chunkSize), errorIndex(-1), replication(replication), bytesAcked(
+        bytesSent), bytesSent(bytesSent), packetPool(packetPool), filesystem(filesystem), stats(stats), lastBlock(lastBlock), path(
             path) {
+    asyncAck = conf.isAsyncAck();
     canAddDatanode = conf.canAddDatanode();
     blockWriteRetry = conf.getBlockWriteRetry();
     connectTimeout = conf.getOutputConnTimeout();
@@ -62,6 +64,17 @@ PipelineImpl::PipelineImpl(bool append, const char * path, const SessionConfig &
         buildForNewBlock();
         stage = DATA_STREAMING;
     }
+
+    if (asyncAck) {
+        startResponder();
+    }
+}
+
+PipelineImpl::~PipelineImpl() {
+    try {
+        stopResponder();
+    } catch (...) {
+    }
 }
 
 int PipelineImpl::findNewDatanode(const std::vector<DatanodeInfo> & original) {
@@ -196,6 +209,10 @@ void PipelineImpl::buildForAppendOrRecovery(bool recovery) {
     shared_ptr<LocatedBlock> lb;
     std::string buffer;
 
+    if (recovery) {
+        stats->addPipelineRecovery();
+    }
+
     do {
         /*
          * Remove bad datanode from list of datanodes.
@@ -596,6 +613,11 @@ void PipelineImpl::resend() {
 }
 
 void PipelineImpl::send(shared_ptr<Packet> packet) {
+    if (asyncAck) {
+        sendAsync(packet);
+        return;
+    }
+
     ConstPacketBuffer buffer = packet->getBuffer();
 
     if (!packet->isHeartbeat()) {
@@ -652,6 +674,12 @@ void PipelineImpl::processAck(PipelineAck & ack) {
         return;
     }
 
+    unique_lock<mutex> lock(mut, defer_lock_t());
+
+    if (asyncAck) {
+        lock.lock();
+    }
+
     assert(!packets.empty());
     Packet & packet = *packets[0];
 
@@ -667,7 +695,11 @@ void PipelineImpl::processAck(PipelineAck & ack) {
         assert(lastBlock);
         lastBlock->setNumBytes(bytesAcked);
 
-        if (packet.isLastPacketInBlock()) {
+        /*
+         * the responder reads from the socket, it is closed after the
+         * responder is stopped.
+         */
+        if (packet.isLastPacketInBlock() && !asyncAck) {
             sock.reset();
         }
 
@@ -720,7 +752,11 @@ void PipelineImpl::checkResponse(bool wait) {
 }
 
 void PipelineImpl::flush() {
-    waitForAcks(true);
+    if (asyncAck) {
+        waitForAcksAsync();
+    } else {
+        waitForAcks(true);
+    }
 }
 
 void PipelineImpl::waitForAcks(bool force) {
@@ -769,11 +805,12 @@ void PipelineImpl::waitForAcks(bool force) {
 }
 
 shared_ptr<LocatedBlock> PipelineImpl::close(shared_ptr<Packet> lastPacket) {
-    waitForAcks(true);
+    flush();
     lastPacket->setLastPacketInBlock(true);
     stage = PIPELINE_CLOSE;
     send(lastPacket);
-    waitForAcks(true);
+    flush();
+    stopResponder();
     sock.reset();
     lastBlock->setNumBytes(bytesAcked);
     LOG(DEBUG2, "close pipeline for file %s, block %s with length %" PRId64,
@@ -782,5 +819,186 @@ shared_ptr<LocatedBlock> PipelineImpl::close(shared_ptr<Packet> lastPacket) {
     return lastBlock;
 }
 
+void PipelineImpl::startResponder() {
+    assert(!responderWorker.joinable());
+    responderStop = false;
+    responderFailed = false;
+    responderError = exception_ptr();
+    CREATE_THREAD(responderWorker, bind(&PipelineImpl::responder, this));
+}
+
+void PipelineImpl::stopResponder() {
+    {
+        lock_guard<mutex> lock(mut);
+        responderStop = true;
+        cond.notify_all();
+    }
+
+    if (responderWorker.joinable()) {
+        responderWorker.join();
+    }
+
+    responderFailed = false;
+}
+
+/*
+ * process the acks until stopped or failed, the error is left for the
+ * writer thread, which rebuilds the pipeline.
+ */
+void PipelineImpl::responder() {
+    int interval = readTimeout < 100 ? readTimeout : 100;
+    interval = interval > 0 ? interval : 1;
+
+    try {
+        while (true) {
+            {
+                unique_lock<mutex> lock(mut);
+
+                while (!responderStop && packets.empty()) {
+                    cond.wait(lock);
+                }
+
+                if (responderStop) {
+                    return;
+                }
+            }
+
+            /*
+             * wake up in time to be stopped while waiting for the ack.
+             */
+            for (int waited = 0; !reader->poll(interval);) {
+                {
+                    lock_guard<mutex> lock(mut);
+
+                    if (responderStop) {
+                        return;
+                    }
+                }
+
+                waited += interval;
+
+                if (waited >= readTimeout) {
+                    THROW(HdfsIOException, "Timeout when reading response for block %s, datanode %s do not response.",
+                          lastBlock->toString().c_str(),
+                          nodes[0].formatAddress().c_str());
+                }
+            }
+
+            processResponse();
+            cond.notify_all();
+        }
+    } catch (...) {
+        lock_guard<mutex> lock(mut);
+        responderError = current_exception();
+        responderFailed = true;
+        cond.notify_all();
+    }
+}
+
+void PipelineImpl::sendAsync(shared_ptr<Packet> packet) {
+    ConstPacketBuffer buffer = packet->getBuffer();
+    bool failover;
+
+    {
+        unique_lock<mutex> lock(mut);
+
+        /*
+         * too many packets pending on the ack. wait in case of consuming to much memory.
+         */
+        while (!responderFailed
+                && static_cast<int>(packets.size()) >= packetPool.getMaxSize()) {
+            cond.wait(lock);
+        }
+
+        if (!packet->isHeartbeat()) {
+            packets.push_back(packet);
+            cond.notify_all();
+        }
+
+        failover = responderFailed;
+    }
+
+    if (!failover) {
+        try {
+            assert(sock);
+            sock->writeFully(buffer.getBuffer(), buffer.getSize(), writeTimeout);
+            int64_t tmp = packet->getLastByteOffsetBlock();
+            bytesSent = bytesSent > tmp ? bytesSent : tmp;
+            return;
+        } catch (const HdfsIOException & e) {
+            std::string detail;
+            LOG(LOG_ERROR,
+                "Failed to send packet to pipeline on datanode %s for block %s file %s.\n%s",
+                nodes[0].formatAddress().c_str(), lastBlock->toString().c_str(),
+                path.c_str(), GetExceptionDetail(e, detail));
+        }
+    }
+
+    failoverAsync();
+}
+
+void PipelineImpl::waitForAcksAsync() {
+    while (true) {
+        {
+            unique_lock<mutex> lock(mut);
+
+            while (!responderFailed && !packets.empty()) {
+                cond.wait(lock);
+            }
+
+            if (!responderFailed) {
+                return;
+            }
+        }
+
+        failoverAsync();
+    }
+}
+
+void PipelineImpl::failoverAsync() {
+    std::string buffer;
+
+    do {
+        stopResponder();
+
+        if (responderError) {
+            exception_ptr error = responderError;
+            responderError = exception_ptr();
+
+            try {
+                rethrow_exception(error);
+            } catch (const HdfsIOException & e) {
+                LOG(LOG_ERROR,
+                    "Failed to receive the acks of pipeline for block %s file %s.\n%s",
+                    lastBlock->toString().c_str(), path.c_str(), GetExceptionDetail(e, buffer));
+            }
+        }
+
+        if (errorIndex < 0) {
+            errorIndex = 0;
+        }
+
+        LOG(INFO, "Rebuild pipeline for block %s file %s.", lastBlock->toString().c_str(), path.c_str());
+        sock.reset();
+        buildForAppendOrRecovery(true);
+
+        if (stage == PIPELINE_CLOSE) {
+            assert(packets.size() == 1 && packets[0]->isLastPacketInBlock());
+            packets.clear();
+            return;
+        }
+
+        try {
+            resend();
+            startResponder();
+            return;
+        } catch (const HdfsIOException & e) {
+            LOG(LOG_ERROR,
+                "Failed to resend packets to pipeline for block %s file %s.\n%s",
+                lastBlock->toString().c_str(), path.c_str(), GetExceptionDetail(e, buffer));
+        }
+    } while (true);
+}
+
 }
 }
@@ -22,6 +22,7 @@
 #ifndef _HDFS_LIBHDFS3_CLIENT_PIPELINE_H_
 #define _HDFS_LIBHDFS3_CLIENT_PIPELINE_H_
 
+#include "ExceptionInternal.h"
 #include "FileSystemInter.h"
 #include "Memory.h"
 #include "network/BufferedSocketReader.h"
@@ -127,7 +128,12 @@ public:
     PipelineImpl(bool append, const char * path, const SessionConfig & conf,
                  shared_ptr<FileSystemInter> filesystem, int checksumType, int chunkSize,
                  int replication, int64_t bytesSent, PacketPool & packetPool,
-                 shared_ptr<LocatedBlock> lastBlock);
+                 shared_ptr<LocatedBlock> lastBlock, shared_ptr<IoStatsCounter> stats);
+
+    /**
+     * stop the responder thread.
+     */
+    ~PipelineImpl();
 
     /**
      * send all data and wait for all ack.
@@ -162,12 +168,28 @@ private:
                   const Token & token);
     int findNewDatanode(const std::vector<DatanodeInfo> & original);
 
+    /*
+     * With output.ack.async, the acks are processed by a responder thread
+     * while the packets are sent, and the packets waiting for the ack are
+     * bounded by the max size of the packet pool. The pipeline is rebuilt
+     * on the writer thread, after the responder is stopped.
+     */
+    void failoverAsync();
+    void responder();
+    void sendAsync(shared_ptr<Packet> packet);
+    void startResponder();
+    void stopResponder();
+    void waitForAcksAsync();
+
 private:
     static void checkBadLinkFormat(const std::string & node);
 
 private:
     BlockConstructionStage stage;
+    bool asyncAck;
     bool canAddDatanode;
+    bool responderFailed;
+    bool responderStop;
     int blockWriteRetry;
     int checksumType;
     int chunkSize;
@@ -181,6 +203,7 @@ private:
     PacketPool & packetPool;
     shared_ptr<BufferedSocketReader> reader;
     shared_ptr<FileSystemInter> filesystem;
+    shared_ptr<IoStatsCounter> stats;
     shared_ptr<LocatedBlock> lastBlock;
     shared_ptr<Socket> sock;
     std::deque<shared_ptr<Packet> > packets;
@@ -189,6 +212,14 @@ private:
     std::vector<DatanodeInfo> nodes;
     std::vector<std::string> storageIDs;
 
+    /*
+     * the responder thread, mut protects packets while it runs.
+     */
+    condition_variable cond;
+    exception_ptr responderError;
+    mutex mut;
+    thread responderWorker;
+
 };
 
 }
@@ -21,6 +21,7 @@
  */
 #include "BigEndian.h"
 #include "DataTransferProtocolSender.h"
+#include "DateTime.h"
 #include "Exception.h"
 #include "ExceptionInternal.h"
 #include "HWCrc32c.h"
@@ -39,8 +40,10 @@ RemoteBlockReader::RemoteBlockReader(const ExtendedBlock& eb,
                                      PeerCache& peerCache, int64_t start,
                                      int64_t len, const Token& token,
                                      const char* clientName, bool verify,
-                                     SessionConfig& conf)
-    : sentStatus(false),
+                                     SessionConfig& conf, bool local,
+                                     IoStatsCounter& stats)
+    : local(local),
+      sentStatus(false),
       verify(verify),
       binfo(eb),
       datanode(datanode),
@@ -51,6 +54,7 @@ RemoteBlockReader::RemoteBlockReader(const ExtendedBlock& eb,
       cursor(start),
       endOffset(len + start),
       lastSeqNo(-1),
+      stats(stats),
       peerCache(peerCache) {
 
     assert(start >= 0);
@@ -284,16 +288,15 @@ void RemoteBlockReader::verifyChecksum(int chunks) {
     int dataSize = lastHeader->getDataLen();
     char * pchecksum = &buffer[0];
     char * pdata = &buffer[0] + (chunks * checksumSize);
+    sums.resize(chunks);
+    steady_clock::time_point s = steady_clock::now();
+    checksum->updateChunks(pdata, dataSize, chunkSize, &sums[0]);
+    stats.addChecksumTime(ToMicroSeconds(s, steady_clock::now()));
 
     for (int i = 0; i < chunks; ++i) {
-        int size = chunkSize < dataSize ? chunkSize : dataSize;
-        dataSize -= size;
-        checksum->reset();
-        checksum->update(pdata + (i * chunkSize), size);
-        uint32_t result = checksum->getValue();
         uint32_t target = ReadBigEndian32FromArray(pchecksum + (i * checksumSize));
 
-        if (result != target) {
+        if (sums[i] != target) {
             THROW(ChecksumException, "RemoteBlockReader: checksum not match for Block: %s, on Datanode: %s",
                   binfo.toString().c_str(), datanode.formatAddress().c_str());
         }
@@ -315,6 +318,8 @@ int32_t RemoteBlockReader::read(char * buf, int32_t len) {
     }
 
     try {
+        steady_clock::time_point s = steady_clock::now();
+
         if (position >= size) {
             readNextPacket();
         }
@@ -323,6 +328,7 @@ int32_t RemoteBlockReader::read(char * buf, int32_t len) {
         memcpy(buf, &buffer[position], todo);
         position += todo;
         cursor += todo;
+        stats.addRead(todo, ToMicroSeconds(s, steady_clock::now()), local, false);
         return todo;
     } catch (const HdfsTimeoutException & e) {
         NESTED_THROW(HdfsIOException, "RemoteBlockReader: failed to read Block: %s from Datanode: %s.",
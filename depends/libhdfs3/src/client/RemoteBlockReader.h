@@ -25,6 +25,7 @@
 #include "BlockReader.h"
 #include "Checksum.h"
 #include "DataTransferProtocol.h"
+#include "IoStatsCounter.h"
 #include "Memory.h"
 #include "network/BufferedSocketReader.h"
 #include "network/TcpSocket.h"
@@ -42,7 +43,7 @@ public:
     RemoteBlockReader(const ExtendedBlock& eb, DatanodeInfo& datanode,
                       PeerCache& peerCache, int64_t start, int64_t len,
                       const Token& token, const char* clientName, bool verify,
-                      SessionConfig& conf);
+                      SessionConfig& conf, bool local, IoStatsCounter& stats);
 
     ~RemoteBlockReader();
 
@@ -77,6 +78,7 @@ private:
     void verifyChecksum(int chunks);
 
 private:
+    bool local; //the datanode is on this host.
     bool sentStatus;
     bool verify; //verify checksum or not.
     const ExtendedBlock & binfo;
@@ -91,6 +93,7 @@ private:
     int64_t cursor; //point in block.
     int64_t endOffset; //offset in block requested to read to.
     int64_t lastSeqNo; //segno of the last chunk received
+    IoStatsCounter& stats;
     PeerCache& peerCache;
     shared_ptr<BufferedSocketReader> in;
     shared_ptr<Checksum> checksum;
@@ -98,6 +101,7 @@ private:
     shared_ptr<PacketHeader> lastHeader;
     shared_ptr<Socket> sock;
     std::vector<char> buffer;
+    std::vector<uint32_t> sums;
 };
 
 }
@@ -32,7 +32,7 @@ using namespace Hdfs::Internal;
 namespace Hdfs {
 namespace Internal {
 
-static std::string Base64Encode(const char * input, size_t len) {
+std::string Base64UrlEncode(const char * input, size_t len) {
     int rc = 0;
     size_t outLen;
     char * output = NULL;
@@ -69,8 +69,8 @@ static std::string Base64Encode(const char * input, size_t len) {
     return retval;
 }
 
-static void Base64Decode(const std::string & urlSafe,
-                         std::vector<char> & buffer) {
+void Base64UrlDecode(const std::string & urlSafe,
+                     std::vector<char> & buffer) {
     int retval = 0, append = 0;
     size_t outLen;
     char * output = NULL;
@@ -135,7 +135,7 @@ std::string Token::toString() const {
         len += out.WriteRaw(&password[0], password.size());
         len += out.WriteText(kind);
         len += out.WriteText(service);
-        return Base64Encode(&buffer[0], len);
+        return Base64UrlEncode(&buffer[0], len);
     } catch (...) {
         NESTED_THROW(HdfsIOException, "cannot convert token to string");
     }
@@ -146,7 +146,7 @@ Token & Token::fromString(const std::string & str) {
 
     try {
         std::vector<char> buffer;
-        Base64Decode(str, buffer);
+        Base64UrlDecode(str, buffer);
         WritableUtils in(&buffer[0], buffer.size());
         len = in.ReadInt32();
         identifier.resize(len);
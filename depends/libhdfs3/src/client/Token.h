@@ -23,10 +23,18 @@
 #define _HDFS_LIBHDFS3_CLIENT_TOKEN_H_
 
 #include <string>
+#include <vector>
 
 namespace Hdfs {
 namespace Internal {
 
+/*
+ * The url safe base64 of Hadoop, without padding. The decoding accepts the
+ * standard alphabet and padding too.
+ */
+std::string Base64UrlEncode(const char * input, size_t len);
+void Base64UrlDecode(const std::string & urlSafe, std::vector<char> & buffer);
+
 class Token {
 public:
     const std::string & getIdentifier() const {
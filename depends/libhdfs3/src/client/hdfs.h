@@ -359,6 +359,96 @@ tOffset hdfsTell(hdfsFS fs, hdfsFile file);
  */
 tSize hdfsRead(hdfsFS fs, hdfsFile file, void * buffer, tSize length);
 
+/**
+ * hdfsReadRange - A range of a file read by hdfsPreadv.
+ */
+typedef struct {
+    tOffset offset; /* the position of the range in the file */
+    tSize length; /* the number of bytes to read */
+    void * buffer; /* the buffer of at least length bytes */
+} hdfsReadRange;
+
+/**
+ * hdfsPreadv - Read several ranges of an open file, without moving the
+ * current offset in the file.
+ * The nearby ranges of a block are read from the datanode with one request,
+ * the ranges of different blocks are read in parallel.
+ * @param fs The configured filesystem handle.
+ * @param file The file handle.
+ * @param ranges The ranges to read, each one is read in full.
+ * @param count The number of ranges.
+ * @return Returns 0 on success, -1 on error. A range over the end of the
+ *         file is an error.
+ */
+int hdfsPreadv(hdfsFS fs, hdfsFile file, const hdfsReadRange * ranges, int count);
+
+/**
+ * The options and the buffers of the zero-copy reads.
+ */
+struct hadoopRzOptions;
+
+struct hadoopRzBuffer;
+
+/**
+ * hadoopRzOptionsAlloc - Allocate the options of zero-copy reads.
+ * @return Returns the options, to be freed by hadoopRzOptionsFree;
+ *         NULL on error.
+ */
+struct hadoopRzOptions * hadoopRzOptionsAlloc(void);
+
+/**
+ * hadoopRzOptionsSetSkipChecksum - Set whether the checksums of the bytes
+ * read in place are verified.
+ * @param opts The options.
+ * @param skip Nonzero to leave the checksums unverified. The bytes are then
+ *        read in place even when the stream verifies checksums.
+ * @return Returns 0 on success, -1 on error.
+ */
+int hadoopRzOptionsSetSkipChecksum(struct hadoopRzOptions * opts, int skip);
+
+/**
+ * hadoopRzOptionsFree - Free the options of zero-copy reads.
+ * @param opts The options.
+ */
+void hadoopRzOptionsFree(struct hadoopRzOptions * opts);
+
+/**
+ * hadoopReadZero - Read data from an open file without copying it.
+ * The bytes are returned in place when the block is read from a local
+ * replica memory mapped with input.localread.mappedfile, otherwise they are
+ * copied into the returned buffer.
+ * The buffer stays valid until hadoopRzBufferFree, even after the file is
+ * closed.
+ * @param file The file handle.
+ * @param opts The options.
+ * @param maxLength The max number of bytes to read.
+ * @return Returns the buffer, its length is 0 at the end of the file;
+ *         NULL on error, and sets errno.
+ */
+struct hadoopRzBuffer * hadoopReadZero(hdfsFile file, struct hadoopRzOptions * opts,
+                                       int32_t maxLength);
+
+/**
+ * hadoopRzBufferLength - The number of bytes in a zero-copy buffer.
+ * @param buffer The buffer.
+ * @return Returns the number of bytes.
+ */
+int32_t hadoopRzBufferLength(const struct hadoopRzBuffer * buffer);
+
+/**
+ * hadoopRzBufferGet - The bytes of a zero-copy buffer.
+ * @param buffer The buffer.
+ * @return Returns a pointer to the bytes; NULL if the buffer is empty.
+ */
+const void * hadoopRzBufferGet(const struct hadoopRzBuffer * buffer);
+
+/**
+ * hadoopRzBufferFree - Release a zero-copy buffer.
+ * @param file The file handle the buffer was read from.
+ * @param buffer The buffer.
+ */
+void hadoopRzBufferFree(hdfsFile file, struct hadoopRzBuffer * buffer);
+
 /**
  * hdfsWrite - Write data into an open file.
  * @param fs The configured filesystem handle.
@@ -608,6 +698,46 @@ tOffset hdfsGetCapacity(hdfsFS fs);
  */
 tOffset hdfsGetUsed(hdfsFS fs);
 
+#define HDFS_READ_LATENCY_BUCKETS 20
+
+/**
+ * The I/O statistics of a file, or of all the files of a filesystem.
+ * The bucket i of readLatency counts the block reads which took less than
+ * 2^i microseconds and at least 2^(i-1), the last bucket counts the slower
+ * ones too.
+ */
+typedef struct {
+    int64_t bytesRead;
+    int64_t bytesReadLocal;
+    int64_t bytesReadRemote;
+    int64_t bytesReadShortCircuit;
+    int64_t bytesReadZeroCopy;
+    int64_t blockReads;
+    int64_t readLatency[HDFS_READ_LATENCY_BUCKETS];
+    int64_t reconnects;
+    int64_t checksumTime; /* in microseconds */
+    int64_t bytesWritten;
+    int64_t pipelineRecoveries;
+} hdfsIoStatistics;
+
+/**
+ * hdfsFileGetIoStatistics - Get the I/O statistics of an open file.
+ * @param fs The configured filesystem handle.
+ * @param file The file handle.
+ * @param stats Output the statistics.
+ * @return Returns 0 on success, -1 on error.
+ */
+int hdfsFileGetIoStatistics(hdfsFS fs, hdfsFile file, hdfsIoStatistics * stats);
+
+/**
+ * hdfsGetIoStatistics - Get the I/O statistics of all the files opened
+ * in the filesystem.
+ * @param fs The configured filesystem handle.
+ * @param stats Output the statistics.
+ * @return Returns 0 on success, -1 on error.
+ */
+int hdfsGetIoStatistics(hdfsFS fs, hdfsIoStatistics * stats);
+
 /**
  * Change the user and/or group of a file or directory.
  *
@@ -759,6 +889,32 @@ BlockLocation * hdfsGetFileBlockLocations(hdfsFS fs, const char * path,
  */
 void hdfsFreeFileBlockLocations(BlockLocation * locations, int numOfBlock);
 
+/**
+ * Get the block locations of the same range of several files, the requests
+ * are sent to the namenode in parallel.
+ *
+ * @param fs The file system
+ * @param paths The paths to the files
+ * @param count The number of elements in paths
+ * @param start The start offset into the given files
+ * @param length The length for which to get locations for
+ * @param numOfBlocks Output the number of blocks of each file, an array of count elements
+ *
+ * @return An array of count arrays of BlockLocation struct, in the order of paths.
+ */
+BlockLocation ** hdfsGetFileBlockLocationsBatch(hdfsFS fs, const char ** paths,
+        int count, tOffset start, tOffset length, int * numOfBlocks);
+
+/**
+ * Free the arrays returned by hdfsGetFileBlockLocationsBatch
+ *
+ * @param locations The array returned by hdfsGetFileBlockLocationsBatch
+ * @param numOfBlocks The number of blocks of each file
+ * @param count The number of files
+ */
+void hdfsFreeFileBlockLocationsBatch(BlockLocation ** locations,
+        int * numOfBlocks, int count);
+
 /**
  * Create encryption zone for the directory with specific key name
  * @param fs The configured filesystem handle.
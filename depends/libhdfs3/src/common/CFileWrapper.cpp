@@ -117,5 +117,9 @@ void CFileWrapper::seek(int64_t offset) {
     } while (todo > 0);
 }
 
+bool CFileWrapper::isMapped() const {
+    return false;
+}
+
 }
 }
@@ -53,6 +53,30 @@ public:
      */
     virtual void update(const void * b, int len) = 0;
 
+    /**
+     * Calculates the checksums of the consecutive chunks of a buffer, the
+     * current checksum is reset.
+     * @param b The buffer of data.
+     * @param len The buffer length, the last chunk may be shorter.
+     * @param chunkSize The length of a chunk.
+     * @param sums The checksums of the chunks, one per chunk.
+     */
+    virtual void updateChunks(const void * b, int len, int chunkSize,
+                              uint32_t * sums) {
+        const char * p = static_cast<const char *>(b);
+
+        for (int i = 0; len > 0; ++i) {
+            int chunk = chunkSize < len ? chunkSize : len;
+            reset();
+            update(p, chunk);
+            sums[i] = getValue();
+            p += chunk;
+            len -= chunk;
+        }
+
+        reset();
+    }
+
     /**
      * Destroy the instance.
      */
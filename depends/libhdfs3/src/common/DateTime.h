@@ -67,6 +67,12 @@ static int64_t ToMilliSeconds(TimeStamp const & s, TimeStamp const & e) {
     return duration_cast<milliseconds>(e - s).count();
 }
 
+template<typename TimeStamp>
+static int64_t ToMicroSeconds(TimeStamp const & s, TimeStamp const & e) {
+    assert(e >= s);
+    return duration_cast<microseconds>(e - s).count();
+}
+
 }
 }
 
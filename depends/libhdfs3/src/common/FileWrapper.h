@@ -42,6 +42,12 @@ public:
     virtual const char * read(std::vector<char> & buffer, int32_t size) = 0;
     virtual void copy(char * buffer, int32_t size) = 0;
     virtual void seek(int64_t position) = 0;
+
+    /**
+     * Whether read() returns pointers into a mapping of the file, valid as
+     * long as the wrapper.
+     */
+    virtual bool isMapped() const = 0;
 };
 
 class CFileWrapper: public FileWrapper {
@@ -54,6 +60,7 @@ public:
     const char * read(std::vector<char> & buffer, int32_t size);
     void copy(char * buffer, int32_t size);
     void seek(int64_t offset);
+    bool isMapped() const;
 
 private:
     FILE * file;
@@ -70,6 +77,7 @@ public:
     const char * read(std::vector<char> & buffer, int32_t size);
     void copy(char * buffer, int32_t size);
     void seek(int64_t offset);
+    bool isMapped() const;
 
 private:
     bool openInternal(int fd, bool delegate, size_t size);
@@ -21,6 +21,7 @@
  */
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
 
 #include "HWCrc32c.h"
 
@@ -121,13 +122,145 @@ bool HWCrc32c::available() {
 #endif
 }
 
-void HWCrc32c::update(const void * b, int len) {
-    const char * p = static_cast<const char *>(b);
+
+/*
+ * The CRCs of long buffers are calculated on three streams interleaved, so
+ * the latency of the crc32 instruction is hidden, and the CRCs of the
+ * streams are combined by shifting them over the bytes of the streams after
+ * them, with tables made once for the two stream lengths.
+ */
+#define CRC32C_POLY 0x82F63B78u
+#define CRC32C_LONG 8192
+#define CRC32C_SHORT 256
+
 #if defined(__LP64__)
-    const size_t bytes = sizeof(uint64_t);
+static const int CrcWordSize = sizeof(uint64_t);
+
+static inline uint32_t CrcWord(uint32_t crc, const char * p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return static_cast<uint32_t>(_mm_crc32_u64(crc, value));
+}
 #else
-    const size_t bytes = sizeof(uint32_t);
+static const int CrcWordSize = sizeof(uint32_t);
+
+static inline uint32_t CrcWord(uint32_t crc, const char * p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return _mm_crc32_u32(crc, value);
+}
 #endif
+
+/*
+ * Multiply a vector by a 32x32 matrix over GF(2).
+ */
+static uint32_t Gf2MatrixTimes(const uint32_t * mat, uint32_t vec) {
+    uint32_t sum = 0;
+
+    for (; vec; vec >>= 1, ++mat) {
+        if (vec & 1) {
+            sum ^= *mat;
+        }
+    }
+
+    return sum;
+}
+
+static void Gf2MatrixSquare(uint32_t * square, const uint32_t * mat) {
+    for (int n = 0; n < 32; ++n) {
+        square[n] = Gf2MatrixTimes(mat, mat[n]);
+    }
+}
+
+class CrcShiftTable {
+public:
+    /*
+     * Make the table shifting a CRC over len zero bytes.
+     */
+    explicit CrcShiftTable(int len) {
+        uint32_t even[32], odd[32], op[32];
+        /* the operator of one zero bit */
+        odd[0] = CRC32C_POLY;
+
+        for (int n = 1; n < 32; ++n) {
+            odd[n] = 1u << (n - 1);
+        }
+
+        Gf2MatrixSquare(even, odd); /* two zero bits */
+        Gf2MatrixSquare(odd, even); /* four zero bits */
+        Gf2MatrixSquare(even, odd); /* one zero byte */
+        bool first = true;
+
+        /* raise it to the power of len, the operator is in op */
+        for (;;) {
+            if (len & 1) {
+                if (first) {
+                    memcpy(op, even, sizeof(op));
+                    first = false;
+                } else {
+                    uint32_t tmp[32];
+
+                    for (int n = 0; n < 32; ++n) {
+                        tmp[n] = Gf2MatrixTimes(even, op[n]);
+                    }
+
+                    memcpy(op, tmp, sizeof(op));
+                }
+            }
+
+            len >>= 1;
+
+            if (0 == len) {
+                break;
+            }
+
+            Gf2MatrixSquare(odd, even);
+            memcpy(even, odd, sizeof(even));
+        }
+
+        for (int k = 0; k < 4; ++k) {
+            for (uint32_t b = 0; b < 256; ++b) {
+                table[k][b] = Gf2MatrixTimes(op, b << (8 * k));
+            }
+        }
+    }
+
+    uint32_t shift(uint32_t crc) const {
+        return table[0][crc & 0xff] ^ table[1][(crc >> 8) & 0xff]
+               ^ table[2][(crc >> 16) & 0xff] ^ table[3][crc >> 24];
+    }
+
+private:
+    uint32_t table[4][256];
+};
+
+static const CrcShiftTable CrcShiftLong(CRC32C_LONG);
+static const CrcShiftTable CrcShiftShort(CRC32C_SHORT);
+
+/*
+ * Extend a CRC over three consecutive streams of len bytes each.
+ */
+static inline uint32_t CrcThreeStreams(uint32_t crc, const char * p, int len,
+                                       const CrcShiftTable & shift) {
+    uint32_t crc1 = 0, crc2 = 0;
+    const char * end = p + len;
+
+    for (; p < end; p += CrcWordSize) {
+        crc = CrcWord(crc, p);
+        crc1 = CrcWord(crc1, p + len);
+        crc2 = CrcWord(crc2, p + 2 * len);
+    }
+
+    crc = shift.shift(crc) ^ crc1;
+    return shift.shift(crc) ^ crc2;
+}
+
+void HWCrc32c::update(const void * b, int len) {
+    crc = extend(crc, static_cast<const char *>(b), len);
+}
+
+uint32_t HWCrc32c::extend(uint32_t crc, const char * p, int len) {
+    const size_t bytes = CrcWordSize;
     int align = bytes - reinterpret_cast<uint64_t>(p) % bytes;
     align = bytes == static_cast<size_t>(align) ? 0 : align;
 
@@ -135,28 +268,73 @@ void HWCrc32c::update(const void * b, int len) {
         align = len;
     }
 
-    updateInt64(p, align);
+    crc = updateInt64(crc, p, align);
     p = p + align;
     len -= align;
 
     if (len > 0) {
         assert(0 == reinterpret_cast<uint64_t>(p) % bytes);
 
+        for (; len >= 3 * CRC32C_LONG; len -= 3 * CRC32C_LONG) {
+            crc = CrcThreeStreams(crc, p, CRC32C_LONG, CrcShiftLong);
+            p = p + 3 * CRC32C_LONG;
+        }
+
+        for (; len >= 3 * CRC32C_SHORT; len -= 3 * CRC32C_SHORT) {
+            crc = CrcThreeStreams(crc, p, CRC32C_SHORT, CrcShiftShort);
+            p = p + 3 * CRC32C_SHORT;
+        }
+
         for (int i = len / bytes; i > 0; --i) {
-#if defined(__LP64__)
-            crc = _mm_crc32_u64(crc, *reinterpret_cast<const uint64_t *>(p));
-#else
-            crc = _mm_crc32_u32(crc, *reinterpret_cast<const uint32_t *>(p));
-#endif
+            crc = CrcWord(crc, p);
             p = p + bytes;
         }
 
         len &= bytes - 1;
-        updateInt64(p, len);
+        crc = updateInt64(crc, p, len);
+    }
+
+    return crc;
+}
+
+void HWCrc32c::updateChunks(const void * b, int len, int chunkSize,
+                            uint32_t * sums) {
+    const char * p = static_cast<const char *>(b);
+    int words = chunkSize / CrcWordSize;
+    int tail = chunkSize % CrcWordSize;
+
+    /*
+     * three chunks at a time, each one is a stream of its own.
+     */
+    for (; len >= 3 * chunkSize; len -= 3 * chunkSize) {
+        uint32_t crc0 = 0xFFFFFFFF, crc1 = 0xFFFFFFFF, crc2 = 0xFFFFFFFF;
+        const char * p0 = p, * p1 = p + chunkSize, * p2 = p + 2 * chunkSize;
+
+        for (int i = words; i > 0; --i) {
+            crc0 = CrcWord(crc0, p0);
+            crc1 = CrcWord(crc1, p1);
+            crc2 = CrcWord(crc2, p2);
+            p0 += CrcWordSize;
+            p1 += CrcWordSize;
+            p2 += CrcWordSize;
+        }
+
+        *sums++ = ~updateInt64(crc0, p0, tail);
+        *sums++ = ~updateInt64(crc1, p1, tail);
+        *sums++ = ~updateInt64(crc2, p2, tail);
+        p = p + 3 * chunkSize;
+    }
+
+    for (; len > 0; len -= chunkSize) {
+        int chunk = chunkSize < len ? chunkSize : len;
+        *sums++ = ~extend(0xFFFFFFFF, p, chunk);
+        p = p + chunk;
     }
+
+    reset();
 }
 
-void HWCrc32c::updateInt64(const char * b, int len) {
+uint32_t HWCrc32c::updateInt64(uint32_t crc, const char * b, int len) {
     assert(len < 8);
 
     switch (len) {
@@ -190,8 +368,9 @@ void HWCrc32c::updateInt64(const char * b, int len) {
     case 0:
         break;
     }
+
+    return crc;
 }
 
 }
 }
-
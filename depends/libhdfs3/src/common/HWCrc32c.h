@@ -55,6 +55,12 @@ public:
      */
     void update(const void * b, int len);
 
+    /**
+     * @ref Checksum#updateChunks(const void *, int, int, uint32_t *)
+     * Three chunks are calculated at a time, interleaved.
+     */
+    void updateChunks(const void * b, int len, int chunkSize, uint32_t * sums);
+
     /**
      * Destory an HWCrc32 instance.
      */
@@ -68,7 +74,8 @@ public:
     static bool available();
 
 private:
-    void updateInt64(const char * b, int len);
+    static uint32_t extend(uint32_t crc, const char * b, int len);
+    static uint32_t updateInt64(uint32_t crc, const char * b, int len);
 
 private:
     uint32_t crc;
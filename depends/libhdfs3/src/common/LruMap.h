@@ -94,6 +94,13 @@ public:
         }
     }
 
+    void clear() {
+        lock_guard<mutex> lock(mut);
+        map.clear();
+        list.clear();
+        count = 0;
+    }
+
     bool find(const KeyType& key, ValueType* value) {
         lock_guard<mutex> lock(mut);
         return findAndEraseInternal(key, value, false);
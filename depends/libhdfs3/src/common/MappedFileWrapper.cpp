@@ -144,5 +144,9 @@ void MappedFileWrapper::seek(int64_t offset) {
     position = begin + offset;
 }
 
+bool MappedFileWrapper::isMapped() const {
+    return true;
+}
+
 }
 }
@@ -63,6 +63,10 @@ SessionConfig::SessionConfig(const Config & conf) {
             &useMappedFile, "input.localread.mappedfile", false
         }, {
             &legacyLocalBlockReader, "dfs.client.use.legacy.blockreader.local", false
+        }, {
+            &readAhead, "input.read.ahead", false
+        }, {
+            &asyncAck, "output.ack.async", false
         }
     };
     ConfigDefault<int32_t> i32Values[] = {
@@ -82,8 +86,20 @@ SessionConfig::SessionConfig(const Config & conf) {
             &rpcMaxRetryOnConnect, "rpc.client.connect.retry", 10, bind(CheckRangeGE<int32_t>, _1, _2, 1)
         }, {
             &rpcTimeout, "rpc.client.timeout", 3600 * 1000
+        }, {
+            &rpcMaxOutstandingCalls, "rpc.client.max.outstanding.calls", 128, bind(CheckRangeGE<int32_t>, _1, _2, 1)
         }, {
             &defaultReplica, "dfs.default.replica", 3, bind(CheckRangeGE<int32_t>, _1, _2, 1)
+        }, {
+            &metadataCacheSize, "dfs.client.metadata.cache.size", 0, bind(CheckRangeGE<int32_t>, _1, _2, 0)
+        }, {
+            &metadataCacheExpiry, "dfs.client.metadata.cache.expiry", 3000, bind(CheckRangeGE<int32_t>, _1, _2, 1)
+        }, {
+            &metadataBatchParallelism, "dfs.client.metadata.batch.parallelism", 8, bind(CheckRangeGE<int32_t>, _1, _2, 1)
+        }, {
+            &fileSystemPoolSize, "dfs.client.filesystem.pool.size", 16, bind(CheckRangeGE<int32_t>, _1, _2, 0)
+        }, {
+            &fileSystemPoolExpiry, "dfs.client.filesystem.pool.expiry", 60 * 1000, bind(CheckRangeGE<int32_t>, _1, _2, 0)
         }, {
             &inputConnTimeout, "input.connect.timeout", 600 * 1000
         }, {
@@ -100,6 +116,14 @@ SessionConfig::SessionConfig(const Config & conf) {
             &maxLocalBlockInfoCacheSize, "input.localread.blockinfo.cachesize", 1000, bind(CheckRangeGE<int32_t>, _1, _2, 1)
         }, {
             &maxReadBlockRetry, "input.read.max.retry", 60, bind(CheckRangeGE<int32_t>, _1, _2, 1)
+        }, {
+            &readAheadSize, "input.read.ahead.size", 8 * 1024 * 1024, bind(CheckRangeGE<int32_t>, _1, _2, 1)
+        }, {
+            &readMergeGap, "input.read.vectored.merge.gap", 256 * 1024, bind(CheckRangeGE<int32_t>, _1, _2, 0)
+        }, {
+            &readParallelism, "input.read.vectored.parallelism", 4, bind(CheckRangeGE<int32_t>, _1, _2, 1)
+        }, {
+            &hedgedReadThreshold, "input.read.hedged.threshold", 0, bind(CheckRangeGE<int32_t>, _1, _2, 0)
         }, {
             &chunkSize, "output.default.chunksize", 512, bind(CheckMultipleOf<int32_t>, _1, _2, 512)
         }, {
@@ -126,6 +150,12 @@ SessionConfig::SessionConfig(const Config & conf) {
             &socketCacheExpiry, "dfs.client.socketcache.expiryMsec", 3000, bind(CheckRangeGE<int32_t>, _1, _2, 0)
         }, {
             &socketCacheCapacity, "dfs.client.socketcache.capacity", 16, bind(CheckRangeGE<int32_t>, _1, _2, 0)
+        }, {
+            &kmsTimeout, "dfs.client.kms.timeout", 60 * 1000, bind(CheckRangeGE<int32_t>, _1, _2, 1)
+        }, {
+            &keyCacheSize, "dfs.client.encryption.key.cache.size", 1024, bind(CheckRangeGE<int32_t>, _1, _2, 0)
+        }, {
+            &keyCacheExpiry, "dfs.client.encryption.key.cache.expiry", 600 * 1000, bind(CheckRangeGE<int32_t>, _1, _2, 0)
         }
     };
     ConfigDefault<int64_t> i64Values [] = {
@@ -138,7 +168,8 @@ SessionConfig::SessionConfig(const Config & conf) {
         {&rpcAuthMethod, "hadoop.security.authentication", "simple" },
         {&kerberosCachePath, "hadoop.security.kerberos.ticket.cache.path", "" },
         {&logSeverity, "dfs.client.log.severity", "INFO" },
-        {&domainSocketPath, "dfs.domain.socket.path", ""}
+        {&domainSocketPath, "dfs.domain.socket.path", ""},
+        {&keyProviderUri, "dfs.encryption.key.provider.uri", ""}
     };
 
     for (size_t i = 0; i < ARRAYSIZE(boolValues); ++i) {
@@ -94,6 +94,26 @@ public:
         return defaultReplica;
     }
 
+    int32_t getMetadataCacheSize() const {
+        return metadataCacheSize;
+    }
+
+    int32_t getMetadataCacheExpiry() const {
+        return metadataCacheExpiry;
+    }
+
+    int32_t getMetadataBatchParallelism() const {
+        return metadataBatchParallelism;
+    }
+
+    int32_t getFileSystemPoolSize() const {
+        return fileSystemPoolSize;
+    }
+
+    int32_t getFileSystemPoolExpiry() const {
+        return fileSystemPoolExpiry;
+    }
+
     int64_t getDefaultBlockSize() const {
         return defaultBlockSize;
     }
@@ -125,6 +145,26 @@ public:
         return readFromLocal;
     }
 
+    bool isReadAhead() const {
+        return readAhead;
+    }
+
+    int32_t getReadAheadSize() const {
+        return readAheadSize;
+    }
+
+    int32_t getReadMergeGap() const {
+        return readMergeGap;
+    }
+
+    int32_t getReadParallelism() const {
+        return readParallelism;
+    }
+
+    int32_t getHedgedReadThreshold() const {
+        return hedgedReadThreshold;
+    }
+
     int32_t getMaxGetBlockInfoRetry() const {
         return maxGetBlockInfoRetry;
     }
@@ -170,6 +210,10 @@ public:
         return addDatanode;
     }
 
+    bool isAsyncAck() const {
+        return asyncAck;
+    }
+
     int32_t getHeartBeatInterval() const {
         return heartBeatInterval;
     }
@@ -245,6 +289,10 @@ public:
         this->rpcTimeout = rpcTimeout;
     }
 
+    int32_t getRpcMaxOutstandingCalls() const {
+        return rpcMaxOutstandingCalls;
+    }
+
     bool doesNotRetryAnotherNode() const {
         return notRetryAnotherNode;
     }
@@ -301,6 +349,25 @@ public:
       return socketCacheCapacity;
     }
 
+    /*
+     * Encryption zone configure
+     */
+    const std::string & getKeyProviderUri() const {
+        return keyProviderUri;
+    }
+
+    int32_t getKmsTimeout() const {
+        return kmsTimeout;
+    }
+
+    int32_t getKeyCacheSize() const {
+        return keyCacheSize;
+    }
+
+    int32_t getKeyCacheExpiry() const {
+        return keyCacheExpiry;
+    }
+
 public:
     /*
      * rpc configure
@@ -314,6 +381,7 @@ public:
     int32_t rpcMaxHARetry;
     int32_t rpcSocketLingerTimeout;
     int32_t rpcTimeout;
+    int32_t rpcMaxOutstandingCalls;
     bool rpcTcpNoDelay;
     std::string rpcAuthMethod;
 
@@ -324,6 +392,11 @@ public:
     std::string kerberosCachePath;
     std::string logSeverity;
     int32_t defaultReplica;
+    int32_t metadataCacheSize;
+    int32_t metadataCacheExpiry;
+    int32_t metadataBatchParallelism;
+    int32_t fileSystemPoolSize;
+    int32_t fileSystemPoolExpiry;
     int64_t defaultBlockSize;
 
     /*
@@ -333,6 +406,7 @@ public:
     bool readFromLocal;
     bool notRetryAnotherNode;
     bool legacyLocalBlockReader;
+    bool readAhead;
     int32_t inputConnTimeout;
     int32_t inputReadTimeout;
     int32_t inputWriteTimeout;
@@ -342,6 +416,10 @@ public:
     int32_t maxLocalBlockInfoCacheSize;
     int32_t maxReadBlockRetry;
     int32_t prefetchSize;
+    int32_t readAheadSize;
+    int32_t readMergeGap;
+    int32_t readParallelism;
+    int32_t hedgedReadThreshold;
     int32_t socketCacheCapacity;
     int32_t socketCacheExpiry;
     std::string domainSocketPath;
@@ -350,6 +428,7 @@ public:
      * OutputStream configure
      */
     bool addDatanode;
+    bool asyncAck;
     int32_t chunkSize;
     int32_t packetSize;
     int32_t blockWriteRetry; //retry on block not replicated yet.
@@ -360,6 +439,14 @@ public:
     int32_t heartBeatInterval;
     int32_t closeFileTimeout;
 
+    /*
+     * Encryption zone configure
+     */
+    std::string keyProviderUri;
+    int32_t kmsTimeout;
+    int32_t keyCacheSize;
+    int32_t keyCacheExpiry;
+
 };
 
 }
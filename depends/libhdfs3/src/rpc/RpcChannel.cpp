@@ -328,7 +328,6 @@ void RpcChannelImpl::connect() {
 }
 
 exception_ptr RpcChannelImpl::invokeInternal(RpcRemoteCallPtr remote) {
-    const RpcCall & call = remote->getCall();
     exception_ptr lastError;
 
     try {
@@ -342,34 +341,22 @@ exception_ptr RpcChannelImpl::invokeInternal(RpcRemoteCallPtr remote) {
             sendRequest(remote);
         }
 
-        /*
-         * We use one call thread to check response,
-         * other thread will wait on RPC call complete.
-         */
-        while (client.isRunning()) {
-            if (remote->finished()) {
-                /*
-                 * Current RPC call has finished.
-                 * Wake up another thread to check response.
-                 */
-                wakeupOneCaller(remote->getIdentity());
-                break;
-            }
+        checkResponses(remote);
+    } catch (const HdfsIOException & e) {
+        lastError = wrapInvokeError(remote->getCall(), current_exception());
+    } catch (const HdfsTimeoutException & e) {
+        lastError = wrapInvokeError(remote->getCall(), current_exception());
+    }
 
-            unique_lock<mutex> lock(readMut, defer_lock_t());
+    return lastError;
+}
 
-            if (lock.try_lock()) {
-                /*
-                 * Current thread will check response.
-                 */
-                checkOneResponse();
-            } else {
-                /*
-                 * Another thread checks response, just wait.
-                 */
-                remote->wait();
-            }
-        }
+exception_ptr RpcChannelImpl::wrapInvokeError(const RpcCall & call,
+        exception_ptr error) {
+    exception_ptr lastError = error;
+
+    try {
+        rethrow_exception(error);
     } catch (const HdfsNetworkConnectException & e) {
         try {
             NESTED_THROW(HdfsFailoverException,
@@ -408,11 +395,43 @@ exception_ptr RpcChannelImpl::invokeInternal(RpcRemoteCallPtr remote) {
         } catch (const HdfsRpcException & e) {
             lastError = current_exception();
         }
+    } catch (...) {
     }
 
     return lastError;
 }
 
+void RpcChannelImpl::checkResponses(RpcRemoteCallPtr remote) {
+    /*
+     * We use one call thread to check response,
+     * other thread will wait on RPC call complete.
+     */
+    while (client.isRunning()) {
+        if (remote->finished()) {
+            /*
+             * Current RPC call has finished.
+             * Wake up another thread to check response.
+             */
+            wakeupOneCaller(remote->getIdentity());
+            break;
+        }
+
+        unique_lock<mutex> lock(readMut, defer_lock_t());
+
+        if (lock.try_lock()) {
+            /*
+             * Current thread will check response.
+             */
+            checkOneResponse();
+        } else {
+            /*
+             * Another thread checks response, just wait.
+             */
+            remote->wait();
+        }
+    }
+}
+
 void RpcChannelImpl::invoke(const RpcCall & call) {
     assert(refs > 0);
     RpcRemoteCallPtr remote;
@@ -496,6 +515,116 @@ void RpcChannelImpl::invoke(const RpcCall & call) {
     remote->check();
 }
 
+/*
+ * An asynchronous call is not retried, the caller decides what to do with
+ * the error, as NamenodeProxy does on failover.
+ */
+RpcFuture RpcChannelImpl::invokeAsync(const RpcCall & call,
+                                      const RpcCallback & callback) {
+    assert(refs > 0);
+    exception_ptr lastError;
+    RpcRemoteCallPtr remote(
+        new RpcRemoteCall(call, client.getCallId(), client.getClientId()));
+    remote->setCallback(callback);
+
+    try {
+        sendAsyncRequest(remote);
+    } catch (const HdfsIOException & e) {
+        lastError = wrapInvokeError(call, current_exception());
+    } catch (const HdfsTimeoutException & e) {
+        lastError = wrapInvokeError(call, current_exception());
+    } catch (const HdfsException & e) {
+        lastError = current_exception();
+    }
+
+    if (lastError) {
+        lock_guard<mutex> lock(writeMut);
+        shutdown(lastError);
+        remote->cancel(lastError);
+    }
+
+    addRef();
+    return RpcFuture(*this, remote);
+}
+
+void RpcChannelImpl::sendAsyncRequest(RpcRemoteCallPtr remote) {
+    size_t maxOutstanding = key.getConf().getMaxOutstandingCalls();
+
+    while (client.isRunning()) {
+        {
+            lock_guard<mutex> lock(writeMut);
+
+            if (pendingCalls.size() < maxOutstanding) {
+                if (!available) {
+                    connect();
+                }
+
+                sendRequest(remote);
+                return;
+            }
+        }
+
+        /*
+         * The window opens only when responses are read,
+         * read them unless another thread does.
+         */
+        unique_lock<mutex> lock(readMut, defer_lock_t());
+
+        if (lock.try_lock()) {
+            checkOneResponse();
+        } else {
+            unique_lock<mutex> wlock(writeMut);
+
+            if (pendingCalls.size() >= maxOutstanding) {
+                callDone.wait_for(wlock, milliseconds(500));
+            }
+        }
+    }
+
+    THROW(HdfsRpcException,
+          "Failed to invoke RPC call \"%s\", RPC channel to \"%s:%s\" is to be closed since RpcClient is closing",
+          remote->getCall().getName(), key.getServer().getHost().c_str(), key.getServer().getPort().c_str());
+}
+
+void RpcChannelImpl::waitFor(RpcRemoteCallPtr remote) {
+    exception_ptr lastError;
+
+    try {
+        checkResponses(remote);
+    } catch (const HdfsIOException & e) {
+        lastError = wrapInvokeError(remote->getCall(), current_exception());
+    } catch (const HdfsTimeoutException & e) {
+        lastError = wrapInvokeError(remote->getCall(), current_exception());
+    } catch (const HdfsException & e) {
+        lastError = current_exception();
+    }
+
+    if (lastError) {
+        lock_guard<mutex> lock(writeMut);
+        shutdown(lastError);
+    }
+
+    if (!remote->finished() || !client.isRunning()) {
+        lock_guard<mutex> lock(writeMut);
+
+        if (lastError == exception_ptr()) {
+            try {
+                THROW(Hdfs::HdfsRpcException,
+                      "Failed to invoke RPC call \"%s\", RPC channel to \"%s:%s\" is to be closed since RpcClient is closing",
+                      remote->getCall().getName(), key.getServer().getHost().c_str(), key.getServer().getPort().c_str());
+            } catch (...) {
+                lastError = current_exception();
+            }
+        }
+
+        shutdown(lastError);
+        remote->cancel(lastError);
+        rethrow_exception(lastError);
+    }
+
+    remote->check();
+}
+
 void RpcChannelImpl::shutdown(exception_ptr reason) {
     assert(reason != exception_ptr());
     available = false;
@@ -537,6 +666,7 @@ void RpcChannelImpl::cleanupPendingCalls(exception_ptr reason) {
     }
 
     pendingCalls.clear();
+    callDone.notify_all();
 }
 
 void RpcChannelImpl::checkOneResponse() {
@@ -699,6 +829,7 @@ RpcRemoteCallPtr RpcChannelImpl::getPendingCall(int32_t id) {
 
     RpcRemoteCallPtr rc = it->second;
     pendingCalls.erase(it);
+    callDone.notify_all();
     return rc;
 }
 
@@ -31,6 +31,7 @@
 #include "network/TcpSocket.h"
 #include "RpcCall.h"
 #include "RpcChannelKey.h"
+#include "RpcFuture.h"
 #include "RpcHeader.pb.h"
 #include "RpcRemoteCall.h"
 #include "SaslClient.h"
@@ -66,6 +67,24 @@ public:
      */
     virtual void invoke(const RpcCall & call) = 0;
 
+    /**
+     * Send a rpc call without waiting for its response.
+     * Block while the channel has as many calls outstanding as allowed.
+     * @param call The call to be sent, its request and response must
+     *        outlive the returned future.
+     * @param callback Called once when the call completes, on the thread
+     *        reading its response, it must not block. May be empty.
+     * @return The future of the call, an error is reported through it.
+     */
+    virtual RpcFuture invokeAsync(const RpcCall & call,
+                                  const RpcCallback & callback) = 0;
+
+    /**
+     * Wait for a call sent by invokeAsync to complete.
+     * @param remote The remote call.
+     */
+    virtual void waitFor(RpcRemoteCallPtr remote) = 0;
+
     /**
      * Close the channel if it idle expired.
      * @return true if the channel idle expired.
@@ -115,6 +134,23 @@ public:
      */
     void invoke(const RpcCall & call);
 
+    /**
+     * Send a rpc call without waiting for its response.
+     * Block while the channel has as many calls outstanding as allowed.
+     * @param call The call to be sent, its request and response must
+     *        outlive the returned future.
+     * @param callback Called once when the call completes, on the thread
+     *        reading its response, it must not block. May be empty.
+     * @return The future of the call, an error is reported through it.
+     */
+    RpcFuture invokeAsync(const RpcCall & call, const RpcCallback & callback);
+
+    /**
+     * Wait for a call sent by invokeAsync to complete.
+     * @param remote The remote call.
+     */
+    void waitFor(RpcRemoteCallPtr remote);
+
     /**
      * Close the channel if it idle expired.
      * @return true if the channel idle expired.
@@ -189,6 +225,28 @@ private:
      */
     exception_ptr invokeInternal(RpcRemoteCallPtr remote);
 
+    /**
+     * Convert the error of a call to the exception reported to the caller.
+     * @param call The call.
+     * @param e The error.
+     * @return The exception to be reported.
+     */
+    exception_ptr wrapInvokeError(const RpcCall & call, exception_ptr e);
+
+    /**
+     * Read responses until the given call finishes,
+     * or wait for the thread reading them.
+     * @param remote The remote call
+     */
+    void checkResponses(RpcRemoteCallPtr remote);
+
+    /**
+     * Send the call once the channel has fewer calls outstanding than allowed,
+     * reading responses meanwhile.
+     * @param remote The remote call
+     */
+    void sendAsyncRequest(RpcRemoteCallPtr remote);
+
     /**
      * Check response, block until get one response.
      * @pre Channel already hold read lock.
@@ -252,6 +310,7 @@ private:
 private:
     atomic<int> refs;
     bool available;
+    condition_variable callDone; // notified under writeMut when a call leaves pendingCalls
     mutex readMut;
     mutex writeMut;
     RpcChannelKey key;
@@ -0,0 +1,55 @@
+/********************************************************************
+ * 2014 -
+ * open source under Apache License Version 2.0
+ ********************************************************************/
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "Exception.h"
+#include "ExceptionInternal.h"
+#include "RpcChannel.h"
+#include "RpcFuture.h"
+
+namespace Hdfs {
+namespace Internal {
+
+RpcFuture::RpcFuture(RpcChannel & channel, RpcRemoteCallPtr remote) :
+    state(new State(channel, remote)) {
+}
+
+RpcFuture::State::~State() {
+    channel.close(false);
+}
+
+bool RpcFuture::isDone() const {
+    if (!state) {
+        THROW(HdfsIOException, "RpcFuture: no rpc call.");
+    }
+
+    return state->remote->finished();
+}
+
+void RpcFuture::get() {
+    if (!state) {
+        THROW(HdfsIOException, "RpcFuture: no rpc call.");
+    }
+
+    state->channel.waitFor(state->remote);
+}
+
+}
+}
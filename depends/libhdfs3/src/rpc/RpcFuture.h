@@ -0,0 +1,84 @@
+/********************************************************************
+ * 2014 -
+ * open source under Apache License Version 2.0
+ ********************************************************************/
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HDFS_LIBHDFS3_RPC_RPCFUTURE_H_
+#define _HDFS_LIBHDFS3_RPC_RPCFUTURE_H_
+
+#include "Memory.h"
+#include "RpcRemoteCall.h"
+
+namespace Hdfs {
+namespace Internal {
+
+class RpcChannel;
+
+/**
+ * The pending result of a rpc call sent by RpcChannel::invokeAsync.
+ *
+ * A future holds a reference to its channel until the last copy of it is
+ * destroyed. The request and the response of the call must outlive it.
+ */
+class RpcFuture {
+public:
+    RpcFuture() {
+    }
+
+    /**
+     * Construct a future, it takes over one reference to the channel.
+     * @param channel The channel the call was sent on.
+     * @param remote The remote call.
+     */
+    RpcFuture(RpcChannel & channel, RpcRemoteCallPtr remote);
+
+    /**
+     * Check if the call completed, with either a response or an error.
+     * @return true if the call completed.
+     */
+    bool isDone() const;
+
+    /**
+     * Block until the call completes, the calling thread reads the
+     * responses of the channel meanwhile if no other thread does.
+     * @throw HdfsRpcException
+     * @throw HdfsFailoverException
+     * @throw HdfsRpcServerException
+     */
+    void get();
+
+private:
+    struct State {
+        State(RpcChannel & channel, RpcRemoteCallPtr remote) :
+            channel(channel), remote(remote) {
+        }
+
+        ~State();
+
+        RpcChannel & channel;
+        RpcRemoteCallPtr remote;
+    };
+
+    shared_ptr<State> state;
+};
+
+}
+}
+
+#endif /* _HDFS_LIBHDFS3_RPC_RPCFUTURE_H_ */
@@ -24,6 +24,7 @@
 
 #include "DateTime.h"
 #include "ExceptionInternal.h"
+#include "Function.h"
 #include "Memory.h"
 #include "RpcCall.h"
 #include "RpcProtocolInfo.h"
@@ -38,6 +39,12 @@ namespace Internal {
 class RpcRemoteCall;
 typedef shared_ptr<RpcRemoteCall> RpcRemoteCallPtr;
 
+/*
+ * Called once when an asynchronous call completes, with its error or an
+ * empty exception_ptr on success.
+ */
+typedef function<void(exception_ptr)> RpcCallback;
+
 class RpcRemoteCall {
 public:
     RpcRemoteCall(const RpcCall & c, int32_t id, const std::string & clientId) :
@@ -47,10 +54,19 @@ public:
     }
 
     virtual void cancel(exception_ptr reason) {
-        unique_lock<mutex> lock(mut);
-        complete = true;
-        error = reason;
-        cond.notify_all();
+        RpcCallback cb;
+
+        {
+            unique_lock<mutex> lock(mut);
+            complete = true;
+            error = reason;
+            cb.swap(callback);
+            cond.notify_all();
+        }
+
+        if (cb) {
+            cb(reason);
+        }
     }
 
     virtual void serialize(const RpcProtocolInfo & protocol,
@@ -79,9 +95,23 @@ public:
     }
 
     void done() {
+        RpcCallback cb;
+
+        {
+            unique_lock<mutex> lock(mut);
+            complete = true;
+            cb.swap(callback);
+            cond.notify_all();
+        }
+
+        if (cb) {
+            cb(exception_ptr());
+        }
+    }
+
+    void setCallback(const RpcCallback & cb) {
         unique_lock<mutex> lock(mut);
-        complete = true;
-        cond.notify_all();
+        callback = cb;
     }
 
     void wakeup() {
@@ -103,6 +133,7 @@ private:
     exception_ptr error;
     mutex mut;
     RpcCall call;
+    RpcCallback callback;
     std::string clientId;
 };
 
@@ -22,6 +22,7 @@
 #ifndef _HDFS_LIBHDFS3_SERVER_LOCATEDBLOCKS_H_
 #define _HDFS_LIBHDFS3_SERVER_LOCATEDBLOCKS_H_
 
+#include "client/FileEncryptionInfo.h"
 #include "LocatedBlock.h"
 #include "Memory.h"
 
@@ -53,6 +54,10 @@ public:
     virtual const LocatedBlock * findBlock(int64_t position) = 0;
 
     virtual std::vector<LocatedBlock> & getBlocks() = 0;
+
+    virtual FileEncryptionInfo * getFileEncryption() = 0;
+
+    virtual bool isFileEncrypted() const = 0;
 };
 
 /**
@@ -99,12 +104,21 @@ public:
         return blocks;
     }
 
+    FileEncryptionInfo * getFileEncryption() {
+        return &fileEncryption;
+    }
+
+    bool isFileEncrypted() const {
+        return fileEncryption.getKey().length() > 0 && fileEncryption.getKeyName().length() > 0;
+    }
+
 private:
     bool lastBlockComplete;
     bool underConstruction;
     int64_t fileLength;
     shared_ptr<LocatedBlock> lastBlock;
     std::vector<LocatedBlock> blocks;
+    FileEncryptionInfo fileEncryption;
 
 };
 
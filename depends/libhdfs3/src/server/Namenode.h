@@ -81,6 +81,28 @@ public:
              FileNotFoundException, UnresolvedLinkException,
              HdfsIOException) */ = 0;
 
+    /**
+     * Get locations of the blocks of the same range of several files.
+     * The requests are sent together without waiting for each other's
+     * response.
+     *
+     * @param srcs file names
+     * @param offset range start offset
+     * @param length range length
+     * @param lbs output the returned blocks, one element per file
+     *
+     * @throw AccessControlException If access is denied
+     * @throw FileNotFoundException If one of the files does not exist
+     * @throw UnresolvedLinkException If one of the files contains a symlink
+     * @throw HdfsIOException If an I/O error occurred
+     */
+    //Idempotent
+    virtual void getBlockLocationsBatch(const std::vector<std::string> & srcs,
+                                        int64_t offset, int64_t length,
+                                        std::vector<shared_ptr<LocatedBlocks> > & lbs) /* throw (AccessControlException,
+             FileNotFoundException, UnresolvedLinkException,
+             HdfsIOException) */ = 0;
+
     /**
      * Create a new file entry in the namespace.
      * <p>
@@ -105,6 +127,7 @@ public:
      * @param createParent create missing parent directory if true
      * @param replication block replication factor.
      * @param blockSize maximum block size.
+     * @return the status of the new file, if the namenode returns it.
      *
      * @throw AccessControlException If access is denied
      * @throw AlreadyBeingCreatedException if the path does not exist.
@@ -124,7 +147,7 @@ public:
      * RuntimeExceptions:
      * @throw InvalidPathException Path <code>src</code> is invalid
      */
-    virtual void create(const std::string & src, const Permission & masked,
+    virtual shared_ptr<FileStatus> create(const std::string & src, const Permission & masked,
                         const std::string & clientName, int flag, bool createParent,
                         short replication, int64_t blockSize) /* throw (AccessControlException,
              AlreadyBeingCreatedException, DSQuotaExceededException,
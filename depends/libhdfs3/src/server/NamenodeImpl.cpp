@@ -78,7 +78,71 @@ void NamenodeImpl::getBlockLocations(const std::string & src, int64_t offset,
     }
 }
 
-void NamenodeImpl::create(const std::string & src, const Permission & masked,
+/*
+ * All the requests are sent before any response is waited for, the rpc
+ * channel bounds the number of them outstanding.
+ */
+//Idempotent
+void NamenodeImpl::getBlockLocationsBatch(const std::vector<std::string> & srcs,
+        int64_t offset, int64_t length,
+        std::vector<shared_ptr<LocatedBlocks> > & lbs) /* throw (AccessControlException,
+         FileNotFoundException, UnresolvedLinkException, HdfsIOException) */{
+    std::vector<GetBlockLocationsRequestProto> requests(srcs.size());
+    std::vector<GetBlockLocationsResponseProto> responses(srcs.size());
+    std::vector<RpcFuture> futures;
+    size_t next = 0;
+
+    try {
+        RpcChannel & channel = client.getChannel(auth, protocol, server, conf);
+
+        try {
+            for (size_t i = 0; i < srcs.size(); ++i) {
+                requests[i].set_length(length);
+                requests[i].set_offset(offset);
+                requests[i].set_src(srcs[i]);
+                futures.push_back(channel.invokeAsync(
+                                      RpcCall(true, "getBlockLocations", &requests[i], &responses[i]),
+                                      RpcCallback()));
+            }
+        } catch (...) {
+            channel.close(false);
+            throw;
+        }
+
+        channel.close(false);
+        lbs.resize(srcs.size());
+
+        while (next < futures.size()) {
+            size_t i = next++;
+
+            try {
+                futures[i].get();
+            } catch (const HdfsRpcServerException & e) {
+                UnWrapper < FileNotFoundException,
+                          UnresolvedLinkException, HdfsIOException > unwrapper(e);
+                unwrapper.unwrap(__FILE__, __LINE__);
+            }
+
+            lbs[i] = shared_ptr<LocatedBlocks>(new LocatedBlocksImpl);
+            Convert(*lbs[i], responses[i].locations());
+        }
+    } catch (...) {
+        /*
+         * The responses must not be released while calls using them are
+         * still outstanding.
+         */
+        for (; next < futures.size(); ++next) {
+            try {
+                futures[next].get();
+            } catch (...) {
+            }
+        }
+
+        throw;
+    }
+}
+
+shared_ptr<FileStatus> NamenodeImpl::create(const std::string & src, const Permission & masked,
                           const std::string & clientName, int flag, bool createParent,
                           short replication, int64_t blockSize) /* throw (AccessControlException,
          AlreadyBeingCreatedException, DSQuotaExceededException,
@@ -98,6 +162,14 @@ void NamenodeImpl::create(const std::string & src, const Permission & masked,
         request.add_cryptoprotocolversion(CryptoProtocolVersionProto::ENCRYPTION_ZONES);
         Build(masked, request.mutable_masked());
         invoke(RpcCall(false, "create", &request, &response));
+
+        if (response.has_fs()) {
+            shared_ptr<FileStatus> retval(new FileStatus);
+            Convert(src, *retval, response.fs());
+            return retval;
+        }
+
+        return shared_ptr<FileStatus>();
     } catch (const HdfsRpcServerException & e) {
         UnWrapper < AlreadyBeingCreatedException,
                   DSQuotaExceededException, FileAlreadyExistsException,
@@ -40,7 +40,14 @@ public:
              FileNotFoundException, UnresolvedLinkException,
              HdfsIOException) */;
 
-    void create(const std::string & src, const Permission & masked,
+    //Idempotent
+    void getBlockLocationsBatch(const std::vector<std::string> & srcs,
+                                int64_t offset, int64_t length,
+                                std::vector<shared_ptr<LocatedBlocks> > & lbs) /* throw (AccessControlException,
+             FileNotFoundException, UnresolvedLinkException,
+             HdfsIOException) */;
+
+    shared_ptr<FileStatus> create(const std::string & src, const Permission & masked,
                 const std::string & clientName, int flag, bool createParent,
                 short replication, int64_t blockSize) /* throw (AccessControlException,
              AlreadyBeingCreatedException, DSQuotaExceededException,
@@ -240,12 +240,22 @@ void NamenodeProxy::getBlockLocations(const std::string & src, int64_t offset,
     NAMENODE_HA_RETRY_END();
 }
 
-void NamenodeProxy::create(const std::string & src, const Permission & masked,
+void NamenodeProxy::getBlockLocationsBatch(const std::vector<std::string> & srcs,
+        int64_t offset, int64_t length,
+        std::vector<shared_ptr<LocatedBlocks> > & lbs) {
+    NAMENODE_HA_RETRY_BEGIN();
+    namenode->getBlockLocationsBatch(srcs, offset, length, lbs);
+    NAMENODE_HA_RETRY_END();
+}
+
+shared_ptr<FileStatus> NamenodeProxy::create(const std::string & src, const Permission & masked,
                            const std::string & clientName, int flag, bool createParent,
                            short replication, int64_t blockSize) {
     NAMENODE_HA_RETRY_BEGIN();
-    namenode->create(src, masked, clientName, flag, createParent, replication, blockSize);
+    return namenode->create(src, masked, clientName, flag, createParent, replication, blockSize);
     NAMENODE_HA_RETRY_END();
+    assert(!"should not reach here");
+    return shared_ptr<FileStatus>();
 }
 
 std::pair<shared_ptr<LocatedBlock>, shared_ptr<FileStatus> >
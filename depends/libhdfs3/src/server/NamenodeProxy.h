@@ -41,7 +41,11 @@ public:
     void getBlockLocations(const std::string & src, int64_t offset,
                            int64_t length, LocatedBlocks & lbs);
 
-    void create(const std::string & src, const Permission & masked,
+    void getBlockLocationsBatch(const std::vector<std::string> & srcs,
+                                int64_t offset, int64_t length,
+                                std::vector<shared_ptr<LocatedBlocks> > & lbs);
+
+    shared_ptr<FileStatus> create(const std::string & src, const Permission & masked,
                 const std::string & clientName, int flag, bool createParent,
                 short replication, int64_t blockSize);
 
@@ -148,6 +148,16 @@ static inline shared_ptr<LocatedBlock> Convert(const LocatedBlockProto & proto)
     return lb;
 }
 
+static inline void Convert(FileEncryptionInfo & info,
+                           const FileEncryptionInfoProto & proto) {
+    info.setSuite(proto.suite());
+    info.setCryptoProtocolVersion(proto.cryptoprotocolversion());
+    info.setKey(proto.key());
+    info.setKeyName(proto.keyname());
+    info.setIv(proto.iv());
+    info.setEzKeyVersionName(proto.ezkeyversionname());
+}
+
 static inline void Convert(LocatedBlocks & lbs,
                            const LocatedBlocksProto & proto) {
     shared_ptr<LocatedBlock> lb;
@@ -168,6 +178,10 @@ static inline void Convert(LocatedBlocks & lbs,
     }
 
     std::sort(blocks.begin(), blocks.end(), std::less<LocatedBlock>());
+
+    if (proto.has_fileencryptioninfo()) {
+        Convert(*lbs.getFileEncryption(), proto.fileencryptioninfo());
+    }
 }
 
 static inline void Convert(const std::string & src, FileStatus & fs,
@@ -185,14 +199,7 @@ static inline void Convert(const std::string & src, FileStatus & fs,
     fs.setIsdir(proto.filetype() == HdfsFileStatusProto::IS_DIR);
 
     if (proto.has_fileencryptioninfo()){
-        const FileEncryptionInfoProto &encrypt = proto.fileencryptioninfo();
-        FileEncryptionInfo* convert = fs.getFileEncryption();
-        convert->setSuite(encrypt.suite());
-        convert->setCryptoProtocolVersion(encrypt.cryptoprotocolversion());
-        convert->setKey(encrypt.key());
-        convert->setKeyName(encrypt.keyname());
-        convert->setIv(encrypt.iv());
-        convert->setEzKeyVersionName(encrypt.ezkeyversionname()); 
+        Convert(*fs.getFileEncryption(), proto.fileencryptioninfo());
     }
 }
 
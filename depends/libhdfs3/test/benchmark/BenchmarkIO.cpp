@@ -0,0 +1,417 @@
+/********************************************************************
+ * 2014 -
+ * open source under Apache License Version 2.0
+ ********************************************************************/
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * hdfs3bench measures the throughput and the per call latency of libhdfs3
+ * through its C interface, the way HAWQ uses it:
+ *
+ *   write  each thread writes its own file sequentially with hdfsWrite
+ *   read   each thread reads its own file sequentially with hdfsRead
+ *   pread  each thread reads random ranges of its file with hdfsPreadv
+ *
+ * Run "write" first to create the files the read modes use.  Short-circuit,
+ * remote and hedged reads are chosen with the matching client settings,
+ * e.g. -D dfs.client.read.shortcircuit=false or
+ * -D input.read.hedged.threshold=50.  The latency histogram has 8 buckets
+ * per power of two microseconds and can be exported as CSV with -o.
+ */
+#include "client/hdfs.h"
+
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#define BUCKETS_PER_OCTAVE 8
+#define NUM_BUCKETS (BUCKETS_PER_OCTAVE * 34)
+
+struct BenchOptions {
+    std::string nameNode;
+    std::string mode;
+    std::string path;
+    int64_t fileSize;
+    int bufferSize;
+    int threads;
+    int preads;
+    const char * csv;
+    std::vector<std::pair<std::string, std::string> > conf;
+};
+
+struct Histogram {
+    uint64_t buckets[NUM_BUCKETS];
+    uint64_t count;
+    double sumUs;
+    double maxUs;
+};
+
+struct ThreadState {
+    const BenchOptions * options;
+    int id;
+    Histogram histogram;
+    int64_t bytes;
+    double seconds;
+    bool failed;
+};
+
+static double NowUs() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000.0 + tv.tv_usec;
+}
+
+static int BucketOf(double us) {
+    int bucket = us < 1 ? 0 : static_cast<int>(log2(us) * BUCKETS_PER_OCTAVE);
+    return bucket < NUM_BUCKETS ? bucket : NUM_BUCKETS - 1;
+}
+
+/* Upper bound in microseconds of the latencies counted in a bucket */
+static double BucketLimit(int bucket) {
+    return pow(2.0, (bucket + 1) / static_cast<double>(BUCKETS_PER_OCTAVE));
+}
+
+static void Record(Histogram * h, double start) {
+    double us = NowUs() - start;
+    h->buckets[BucketOf(us)]++;
+    h->count++;
+    h->sumUs += us;
+    h->maxUs = us > h->maxUs ? us : h->maxUs;
+}
+
+static double Percentile(const Histogram & h, double fraction) {
+    uint64_t target = static_cast<uint64_t>(h.count * fraction);
+    uint64_t seen = 0;
+
+    for (int i = 0; i < NUM_BUCKETS; ++i) {
+        seen += h.buckets[i];
+
+        if (seen > target) {
+            return BucketLimit(i) < h.maxUs ? BucketLimit(i) : h.maxUs;
+        }
+    }
+
+    return h.maxUs;
+}
+
+static std::string FileOf(const BenchOptions & options, int id) {
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), "_%d", id);
+    return options.path + suffix;
+}
+
+static hdfsFS Connect(const BenchOptions & options) {
+    struct hdfsBuilder * builder = hdfsNewBuilder();
+
+    if (!builder) {
+        return NULL;
+    }
+
+    hdfsBuilderSetNameNode(builder, options.nameNode.c_str());
+
+    for (size_t i = 0; i < options.conf.size(); ++i) {
+        hdfsBuilderConfSetStr(builder, options.conf[i].first.c_str(),
+                              options.conf[i].second.c_str());
+    }
+
+    return hdfsBuilderConnect(builder);
+}
+
+static bool RunWrite(hdfsFS fs, ThreadState * state, char * buffer) {
+    const BenchOptions & options = *state->options;
+    std::string path = FileOf(options, state->id);
+    hdfsFile file = hdfsOpenFile(fs, path.c_str(), O_WRONLY, 0, 0, 0);
+
+    if (!file) {
+        return false;
+    }
+
+    for (int64_t done = 0; done < options.fileSize; done += options.bufferSize) {
+        double start = NowUs();
+
+        if (hdfsWrite(fs, file, buffer, options.bufferSize) != options.bufferSize) {
+            hdfsCloseFile(fs, file);
+            return false;
+        }
+
+        Record(&state->histogram, start);
+        state->bytes += options.bufferSize;
+    }
+
+    /* closing waits for the pipeline to ack the last packets */
+    return hdfsCloseFile(fs, file) == 0;
+}
+
+static bool RunRead(hdfsFS fs, ThreadState * state, char * buffer) {
+    const BenchOptions & options = *state->options;
+    std::string path = FileOf(options, state->id);
+    hdfsFile file = hdfsOpenFile(fs, path.c_str(), O_RDONLY, 0, 0, 0);
+    tSize rc;
+
+    if (!file) {
+        return false;
+    }
+
+    do {
+        double start = NowUs();
+        rc = hdfsRead(fs, file, buffer, options.bufferSize);
+
+        if (rc > 0) {
+            Record(&state->histogram, start);
+            state->bytes += rc;
+        }
+    } while (rc > 0);
+
+    hdfsCloseFile(fs, file);
+    return rc == 0;
+}
+
+static bool RunPread(hdfsFS fs, ThreadState * state, char * buffer) {
+    const BenchOptions & options = *state->options;
+    std::string path = FileOf(options, state->id);
+    hdfsFile file = hdfsOpenFile(fs, path.c_str(), O_RDONLY, 0, 0, 0);
+    hdfsFileInfo * info = hdfsGetPathInfo(fs, path.c_str());
+    unsigned int seed = state->id;
+    int64_t ranges;
+    bool ok = true;
+
+    if (!file || !info || info->mSize < options.bufferSize) {
+        if (info) {
+            hdfsFreeFileInfo(info, 1);
+        }
+
+        if (file) {
+            hdfsCloseFile(fs, file);
+        }
+
+        return false;
+    }
+
+    ranges = info->mSize / options.bufferSize;
+    hdfsFreeFileInfo(info, 1);
+
+    for (int i = 0; i < options.preads && ok; ++i) {
+        hdfsReadRange range;
+        double start = NowUs();
+        range.offset = (rand_r(&seed) % ranges) * options.bufferSize;
+        range.length = options.bufferSize;
+        range.buffer = buffer;
+        ok = hdfsPreadv(fs, file, &range, 1) == 0;
+
+        if (ok) {
+            Record(&state->histogram, start);
+            state->bytes += options.bufferSize;
+        }
+    }
+
+    hdfsCloseFile(fs, file);
+    return ok;
+}
+
+static void * RunThread(void * arg) {
+    ThreadState * state = static_cast<ThreadState *>(arg);
+    const BenchOptions & options = *state->options;
+    std::vector<char> buffer(options.bufferSize, 'x');
+    hdfsFS fs = Connect(options);
+    double start = NowUs();
+
+    if (!fs) {
+        state->failed = true;
+        return NULL;
+    }
+
+    if (options.mode == "write") {
+        state->failed = !RunWrite(fs, state, &buffer[0]);
+    } else if (options.mode == "read") {
+        state->failed = !RunRead(fs, state, &buffer[0]);
+    } else {
+        state->failed = !RunPread(fs, state, &buffer[0]);
+    }
+
+    state->seconds = (NowUs() - start) / 1000000.0;
+
+    if (state->failed) {
+        fprintf(stderr, "thread %d failed: %s\n", state->id, hdfsGetLastError());
+    }
+
+    hdfsDisconnect(fs);
+    return NULL;
+}
+
+static void Usage() {
+    fprintf(stderr,
+            "usage: hdfs3bench -n NAMENODE -m write|read|pread -p PATH [-s MB] [-b KB]\n"
+            "                  [-t THREADS] [-r PREADS] [-D KEY=VALUE]... [-o CSV]\n"
+            "       PATH is the prefix of the per thread files, _<thread> is appended\n"
+            "       MB is the size of every file written, where the default is 1024\n"
+            "       KB is the size of every read or write call, where the default is 128\n"
+            "       THREADS is the number of threads, where the default is 1\n"
+            "       PREADS is the number of reads per thread of pread, where the default is 1000\n"
+            "       KEY=VALUE sets a client configuration, it may be repeated\n"
+            "       CSV is a file to write the latency histogram to\n");
+}
+
+int main(int argc, char ** argv) {
+    BenchOptions options;
+    Histogram total;
+    int64_t bytes = 0;
+    double seconds = 0;
+    bool failed = false;
+    int c;
+
+    options.fileSize = 1024LL * 1024 * 1024;
+    options.bufferSize = 128 * 1024;
+    options.threads = 1;
+    options.preads = 1000;
+    options.csv = NULL;
+
+    while ((c = getopt(argc, argv, "n:m:p:s:b:t:r:D:o:h")) != -1) {
+        switch (c) {
+        case 'n':
+            options.nameNode = optarg;
+            break;
+
+        case 'm':
+            options.mode = optarg;
+            break;
+
+        case 'p':
+            options.path = optarg;
+            break;
+
+        case 's':
+            options.fileSize = atoll(optarg) * 1024 * 1024;
+            break;
+
+        case 'b':
+            options.bufferSize = atoi(optarg) * 1024;
+            break;
+
+        case 't':
+            options.threads = atoi(optarg);
+            break;
+
+        case 'r':
+            options.preads = atoi(optarg);
+            break;
+
+        case 'D': {
+            const char * eq = strchr(optarg, '=');
+
+            if (!eq) {
+                Usage();
+                return 1;
+            }
+
+            options.conf.push_back(std::make_pair(std::string(optarg, eq - optarg),
+                                                  std::string(eq + 1)));
+            break;
+        }
+
+        case 'o':
+            options.csv = optarg;
+            break;
+
+        default:
+            Usage();
+            return 1;
+        }
+    }
+
+    if (options.nameNode.empty() || options.path.empty()
+            || (options.mode != "write" && options.mode != "read" && options.mode != "pread")
+            || options.fileSize <= 0 || options.bufferSize <= 0
+            || options.threads < 1 || options.preads < 1) {
+        Usage();
+        return 1;
+    }
+
+    std::vector<ThreadState> states(options.threads);
+    std::vector<pthread_t> threads(options.threads);
+
+    for (int i = 0; i < options.threads; ++i) {
+        memset(&states[i], 0, sizeof(ThreadState));
+        states[i].options = &options;
+        states[i].id = i;
+
+        if (pthread_create(&threads[i], NULL, RunThread, &states[i])) {
+            fprintf(stderr, "cannot create thread %d\n", i);
+            return 1;
+        }
+    }
+
+    memset(&total, 0, sizeof(total));
+
+    for (int i = 0; i < options.threads; ++i) {
+        pthread_join(threads[i], NULL);
+        failed = failed || states[i].failed;
+        bytes += states[i].bytes;
+        seconds = states[i].seconds > seconds ? states[i].seconds : seconds;
+
+        for (int b = 0; b < NUM_BUCKETS; ++b) {
+            total.buckets[b] += states[i].histogram.buckets[b];
+        }
+
+        total.count += states[i].histogram.count;
+        total.sumUs += states[i].histogram.sumUs;
+        total.maxUs = states[i].histogram.maxUs > total.maxUs ?
+                      states[i].histogram.maxUs : total.maxUs;
+    }
+
+    printf("mode %s threads %d buffer %d bytes %lld seconds %.2f MB/s %.2f\n",
+           options.mode.c_str(), options.threads, options.bufferSize,
+           static_cast<long long>(bytes), seconds,
+           seconds > 0 ? bytes / 1048576.0 / seconds : 0.0);
+    printf("calls %llu latency us avg %.1f p50 %.1f p90 %.1f p99 %.1f p999 %.1f max %.1f\n",
+           static_cast<unsigned long long>(total.count),
+           total.count ? total.sumUs / total.count : 0.0,
+           Percentile(total, 0.5), Percentile(total, 0.9),
+           Percentile(total, 0.99), Percentile(total, 0.999), total.maxUs);
+
+    if (options.csv) {
+        FILE * out = fopen(options.csv, "w");
+
+        if (!out) {
+            perror(options.csv);
+            return 1;
+        }
+
+        fprintf(out, "le_us,count\n");
+
+        for (int b = 0; b < NUM_BUCKETS; ++b) {
+            if (total.buckets[b]) {
+                fprintf(out, "%.1f,%llu\n", BucketLimit(b),
+                        static_cast<unsigned long long>(total.buckets[b]));
+            }
+        }
+
+        fclose(out);
+    }
+
+    return failed ? 1 : 0;
+}
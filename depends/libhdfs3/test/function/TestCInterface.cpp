@@ -1114,6 +1114,43 @@ TEST_F(TestCInterface, TestRead_Success) {
     TestRead(fs, 8 * 1024, 1024 * 1024, 21 * 1024 * 1024);
 }
 
+TEST_F(TestCInterface, TestPreadv_Success) {
+    int64_t blockSize = 1024 * 1024, fileSize = 5 * 1024 * 1024;
+    hdfsFile in = NULL;
+    hdfsReadRange ranges[4];
+    std::vector<char> buf[4];
+    ASSERT_TRUE(CreateFile(fs, BASE_DIR"/testPreadv", blockSize, fileSize));
+    in = hdfsOpenFile(fs, BASE_DIR"/testPreadv", O_RDONLY, 0, 0, 0);
+    ASSERT_TRUE(in != NULL);
+    // two nearby ranges, one across a block boundary, one in the last block
+    ranges[0].offset = 100;
+    ranges[0].length = 1000;
+    ranges[1].offset = 4096;
+    ranges[1].length = 1000;
+    ranges[2].offset = blockSize - 500;
+    ranges[2].length = 1000;
+    ranges[3].offset = fileSize - 300;
+    ranges[3].length = 300;
+
+    for (int i = 0; i < 4; ++i) {
+        buf[i].resize(ranges[i].length);
+        ranges[i].buffer = &buf[i][0];
+    }
+
+    EXPECT_EQ(0, hdfsPreadv(fs, in, ranges, 4));
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(Hdfs::CheckBuffer(&buf[i][0], ranges[i].length, ranges[i].offset));
+    }
+
+    // the file position does not move
+    EXPECT_EQ(0, hdfsTell(fs, in));
+    ranges[0].offset = fileSize - 10;
+    ranges[0].length = 20;
+    EXPECT_EQ(-1, hdfsPreadv(fs, in, ranges, 1));
+    hdfsCloseFile(fs, in);
+}
+
 TEST_F(TestCInterface, TestWrite_InvalidInput) {
     int err;
     char buf[10240];
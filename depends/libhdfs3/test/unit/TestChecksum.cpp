@@ -133,3 +133,43 @@ TEST_F(TestChecksum, SWCrc32c) {
     EXPECT_EQ(result, cs.getValue());
 }
 
+
+TEST_F(TestChecksum, HWCrc32cLongAndChunks) {
+    HWCrc32c hw;
+    SWCrc32c sw;
+
+    if (!hw.available()) {
+        std::cout << "skip HWCrc32c checksum test on unsupported paltform." << std::endl;
+        return;
+    }
+
+    std::vector<char> buffer(100 * 1024 + sizeof(uint64_t));
+
+    for (size_t i = 0; i < buffer.size(); ++i) {
+        buffer[i] = static_cast<char>(i * 131 + i / 7);
+    }
+
+    int lens[] = { 767, 768, 769, 24575, 24576, 24577, 100 * 1024 };
+
+    for (size_t j = 0; j < sizeof(uint64_t); ++j) {
+        for (size_t i = 0; i < sizeof(lens) / sizeof(lens[0]); ++i) {
+            hw.reset();
+            sw.reset();
+            hw.update(&buffer[j], lens[i]);
+            sw.update(&buffer[j], lens[i]);
+            EXPECT_EQ(sw.getValue(), hw.getValue());
+        }
+    }
+
+    int chunkSizes[] = { 512, 513 };
+    int len = 64 * 1024 + 100;
+
+    for (size_t i = 0; i < sizeof(chunkSizes) / sizeof(chunkSizes[0]); ++i) {
+        int chunks = (len + chunkSizes[i] - 1) / chunkSizes[i];
+        std::vector<uint32_t> hwSums(chunks), swSums(chunks);
+        hw.updateChunks(&buffer[1], len, chunkSizes[i], &hwSums[0]);
+        sw.updateChunks(&buffer[1], len, chunkSizes[i], &swSums[0]);
+        EXPECT_TRUE(hwSums == swSums);
+        EXPECT_EQ(0u, hw.getValue());
+    }
+}
@@ -0,0 +1,109 @@
+/********************************************************************
+ * 2014 -
+ * open source under Apache License Version 2.0
+ ********************************************************************/
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "gtest/gtest.h"
+#include "client/CryptoCodec.h"
+#include "Exception.h"
+
+#include <string>
+#include <vector>
+
+using namespace Hdfs;
+using namespace Hdfs::Internal;
+
+static std::string FromHex(const char * hex) {
+    std::string retval;
+
+    for (; hex[0] && hex[1]; hex += 2) {
+        retval.push_back(static_cast<char>(strtol(std::string(hex, 2).c_str(), NULL, 16)));
+    }
+
+    return retval;
+}
+
+static FileEncryptionInfo MakeInfo(const std::string & iv) {
+    FileEncryptionInfo info;
+    info.setSuite(2);
+    info.setCryptoProtocolVersion(2);
+    info.setKeyName("key");
+    info.setKey("edek");
+    info.setIv(iv);
+    return info;
+}
+
+/*
+ * F.5.1 of NIST SP 800-38A, CTR-AES128.Encrypt.
+ */
+TEST(TestCryptoCodec, TestKnownAnswer) {
+    std::string key = FromHex("2b7e151628aed2a6abf7158809cf4f3c");
+    std::string iv = FromHex("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff");
+    std::string plain = FromHex(
+                            "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+                            "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710");
+    std::string cipher = FromHex(
+                             "874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff"
+                             "5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee");
+    CryptoCodec codec(MakeInfo(iv), key);
+    std::vector<char> buf(plain.begin(), plain.end());
+    codec.process(&buf[0], &buf[0], buf.size(), 0);
+    EXPECT_EQ(cipher, std::string(buf.begin(), buf.end()));
+    codec.process(&buf[0], &buf[0], buf.size(), 0);
+    EXPECT_EQ(plain, std::string(buf.begin(), buf.end()));
+}
+
+/*
+ * Processing any range of the file on its own gives the same bytes as
+ * processing the file from the start, across a carry of the counter.
+ */
+TEST(TestCryptoCodec, TestRandomAccess) {
+    std::string key = FromHex("603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4");
+    std::string iv = FromHex("00000000000000fffffffffffffffffe");
+    std::vector<char> plain(1000), whole(1000), part(1000);
+
+    for (size_t i = 0; i < plain.size(); ++i) {
+        plain[i] = static_cast<char>(i * 7);
+    }
+
+    CryptoCodec sequential(MakeInfo(iv), key);
+    sequential.process(&plain[0], &whole[0], plain.size(), 0);
+    CryptoCodec codec(MakeInfo(iv), key);
+    int64_t cuts[] = { 997, 1000, 500, 997, 33, 500, 17, 33, 0, 17 };
+
+    for (size_t i = 0; i < sizeof(cuts) / sizeof(cuts[0]); i += 2) {
+        codec.process(&plain[cuts[i]], &part[cuts[i]], cuts[i + 1] - cuts[i], cuts[i]);
+    }
+
+    EXPECT_TRUE(whole == part);
+
+    for (size_t i = 0; i < plain.size(); ++i) {
+        codec.process(&whole[i], &part[i], 1, i);
+    }
+
+    EXPECT_TRUE(plain == part);
+}
+
+TEST(TestCryptoCodec, TestInvalidKey) {
+    std::string iv(16, 0);
+    FileEncryptionInfo info = MakeInfo(iv);
+    EXPECT_THROW(CryptoCodec(info, std::string(15, 0)), HdfsIOException);
+    info.setSuite(1);
+    EXPECT_THROW(CryptoCodec(info, std::string(16, 0)), UnsupportedOperationException);
+}
@@ -0,0 +1,74 @@
+/********************************************************************
+ * 2014 -
+ * open source under Apache License Version 2.0
+ ********************************************************************/
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "gtest/gtest.h"
+#include "client/FileSystemPool.h"
+#include "MockFileSystemInter.h"
+#include "Thread.h"
+#include "XmlConfig.h"
+
+using namespace Hdfs;
+using namespace Hdfs::Internal;
+
+TEST(TestFileSystemPool, TestReuse) {
+    Config conf;
+    conf.set("dfs.client.filesystem.pool.size", 2);
+    SessionConfig sconf(conf);
+    FileSystemPool pool(sconf);
+    shared_ptr<FileSystemInter> fs(new MockFileSystemInter);
+    std::string key = FileSystemPool::BuildKey("hdfs://localhost:8020", "user",
+                      NULL, conf);
+    EXPECT_FALSE(pool.getFileSystem(key));
+    pool.addFileSystem(key, fs);
+    EXPECT_TRUE(fs == pool.getFileSystem(key));
+    EXPECT_FALSE(pool.getFileSystem(key));
+}
+
+TEST(TestFileSystemPool, TestKey) {
+    Config conf;
+    conf.set("dfs.client.filesystem.pool.size", 2);
+    Config other;
+    other.set("dfs.client.filesystem.pool.size", 4);
+    Token token;
+    token.setIdentifier("identifier");
+    std::string key = FileSystemPool::BuildKey("hdfs://localhost:8020", "user",
+                      NULL, conf);
+    EXPECT_NE(key, FileSystemPool::BuildKey("hdfs://localhost:8020", "other",
+                                            NULL, conf));
+    EXPECT_NE(key, FileSystemPool::BuildKey("hdfs://localhost:8020", "user",
+                                            &token, conf));
+    EXPECT_NE(key, FileSystemPool::BuildKey("hdfs://localhost:8020", "user",
+                                            NULL, other));
+}
+
+TEST(TestFileSystemPool, TestExpire) {
+    Config conf;
+    conf.set("dfs.client.filesystem.pool.size", 2);
+    conf.set("dfs.client.filesystem.pool.expiry", 0);
+    SessionConfig sconf(conf);
+    FileSystemPool pool(sconf);
+    shared_ptr<FileSystemInter> fs(new MockFileSystemInter);
+    std::string key = FileSystemPool::BuildKey("hdfs://localhost:8020", "user",
+                      NULL, conf);
+    pool.addFileSystem(key, fs);
+    sleep_for(milliseconds(10));
+    EXPECT_FALSE(pool.getFileSystem(key));
+}
@@ -0,0 +1,70 @@
+/********************************************************************
+ * 2014 -
+ * open source under Apache License Version 2.0
+ ********************************************************************/
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "gtest/gtest.h"
+#include "IoStatsCounter.h"
+
+using namespace Hdfs;
+using namespace Hdfs::Internal;
+
+TEST(TestIoStatsCounter, TestRead) {
+    IoStatsCounter counter;
+    counter.addRead(100, 0, false, false);
+    counter.addRead(200, 3, true, false);
+    counter.addRead(400, 1000, true, true);
+    counter.addZeroCopyRead(800);
+    IoStatistics stats = counter.get();
+    EXPECT_EQ(1500, stats.getBytesRead());
+    EXPECT_EQ(1400, stats.getBytesReadLocal());
+    EXPECT_EQ(100, stats.getBytesReadRemote());
+    EXPECT_EQ(1200, stats.getBytesReadShortCircuit());
+    EXPECT_EQ(800, stats.getBytesReadZeroCopy());
+    EXPECT_EQ(3, stats.getBlockReads());
+    EXPECT_EQ(1, stats.getReadLatency(0));
+    EXPECT_EQ(1, stats.getReadLatency(2));
+    EXPECT_EQ(1, stats.getReadLatency(10));
+}
+
+TEST(TestIoStatsCounter, TestSlowRead) {
+    IoStatsCounter counter;
+    counter.addRead(1, 1LL << 40, false, false);
+    IoStatistics stats = counter.get();
+    EXPECT_EQ(1, stats.getReadLatency(IoStatistics::ReadLatencyBuckets - 1));
+}
+
+TEST(TestIoStatsCounter, TestParent) {
+    shared_ptr<IoStatsCounter> fs(new IoStatsCounter);
+    IoStatsCounter first(fs), second(fs);
+    first.addRead(10, 1, false, false);
+    first.addReconnect();
+    second.addWrite(20);
+    second.addPipelineRecovery();
+    second.addChecksumTime(5);
+    EXPECT_EQ(10, first.get().getBytesRead());
+    EXPECT_EQ(0, first.get().getBytesWritten());
+    EXPECT_EQ(20, second.get().getBytesWritten());
+    IoStatistics stats = fs->get();
+    EXPECT_EQ(10, stats.getBytesRead());
+    EXPECT_EQ(1, stats.getReconnects());
+    EXPECT_EQ(20, stats.getBytesWritten());
+    EXPECT_EQ(1, stats.getPipelineRecoveries());
+    EXPECT_EQ(5, stats.getChecksumTime());
+}
@@ -311,6 +311,59 @@ TEST(TestRpcChannel, TestInvoke_RetryIdempotent) {
     channel.close(false);
 }
 
+static void CountCallback(Hdfs::Internal::atomic<int> * count, exception_ptr e) {
+    if (e == exception_ptr()) {
+        ++*count;
+    }
+}
+
+TEST(TestRpcChannel, TestInvokeAsync) {
+    std::vector<char> respBody, respBody2;
+    MockRpcClient client;
+    EXPECT_CALL(client, getClientId()).Times(AnyNumber()).WillRepeatedly(Return(""));
+    EXPECT_CALL(client, getCallId()).Times(2).WillOnce(Return(3)).WillOnce(Return(4));
+    MkdirsRequestProto request;
+    MkdirsResponseProto response1, response2, resp;
+    request.set_src("src");
+    request.set_createparent(true);
+    request.mutable_masked()->set_perm(0600u);
+    resp.set_result(true);
+    /*
+     * the responses come back out of order
+     */
+    BuildResponse(4, RpcResponseHeaderProto_RpcStatusProto_SUCCESS, NULL, NULL, &resp, respBody);
+    BuildResponse(3, RpcResponseHeaderProto_RpcStatusProto_SUCCESS, NULL, NULL, &resp, respBody2);
+    respBody.insert(respBody.end(), respBody2.begin(), respBody2.end());
+    MockSocket * sock = new MockSocket();
+    RpcChannelKey key = BuildKey();
+    GetConfig(key).setMaxOutstandingCalls(2);
+    BufferedSocketReaderImpl * in = new BufferedSocketReaderImpl(*sock, respBody);
+    EXPECT_CALL(client, isRunning()).Times(AnyNumber()).WillRepeatedly(
+        Return(true));
+    EXPECT_CALL(*sock, writeFully(_, _, _)).Times(2);
+    EXPECT_CALL(*sock, close()).Times(1);
+    Hdfs::Internal::atomic<int> count(0);
+    RpcChannelImpl channel(key, sock, in, client);
+    channel.available = true;
+    channel.addRef();
+    {
+        RpcFuture f1 = channel.invokeAsync(RpcCall(true, "mkdirs", &request, &response1),
+                                           bind(&CountCallback, &count, _1));
+        RpcFuture f2 = channel.invokeAsync(RpcCall(true, "mkdirs", &request, &response2),
+                                           bind(&CountCallback, &count, _1));
+        EXPECT_EQ(3, channel.refs);
+        EXPECT_FALSE(f1.isDone());
+        EXPECT_NO_THROW(DebugException(f1.get()));
+        EXPECT_TRUE(f2.isDone());
+        EXPECT_NO_THROW(DebugException(f2.get()));
+    }
+    EXPECT_EQ(2, count);
+    EXPECT_EQ(1, channel.refs);
+    EXPECT_TRUE(response1.result());
+    EXPECT_TRUE(response2.result());
+    channel.close(false);
+}
+
 static void InvokeConcurrently(RpcChannelImpl * channel) {
     MkdirsRequestProto request;
     MkdirsResponseProto response;
@@ -62,6 +62,8 @@ public:
     MOCK_METHOD1(findBlock, LocatedBlock * (int64_t position));
     MOCK_METHOD0(getBlocks, std::vector<LocatedBlock> & ());
     MOCK_METHOD1(setLastBlock, void(shared_ptr<LocatedBlock>));
+    MOCK_METHOD0(getFileEncryption, FileEncryptionInfo * ());
+    MOCK_CONST_METHOD0(isFileEncrypted, bool ());
 };
 
 class MockDatanodeStub: public TestDatanodeStub {
@@ -216,3 +218,17 @@ TEST(InputStreamTest, SetupBlockReader_Failed) {
     ins.failedNodes = dfv;
     EXPECT_THROW(ins.setupBlockReader(false), Hdfs::HdfsIOException);
 }
+
+TEST(InputStreamTest, StartReadAhead_LastBlock) {
+    InputStreamImpl ins;
+    MockLocatedBlocks * lbs = new MockLocatedBlocks;
+    ins.lbs = shared_ptr < MockLocatedBlocks > (lbs);
+    ins.readAhead = true;
+    ins.readAheadSize = 1024;
+    ins.cursor = 1000;
+    ins.endOfCurBlock = 1024;
+    EXPECT_CALL(*lbs, getFileLength()).Times(1).WillOnce(Return(1024));
+    EXPECT_CALL(*lbs, findBlock(_)).Times(0);
+    ins.startReadAhead();
+    EXPECT_FALSE(ins.readAheadStarted);
+}
@@ -228,7 +228,9 @@ AllocateResponse ApplicationMaster::allocate(list<ResourceRequest> &asks,
     request.setProgress(progress);
 
     RESOURCEMANAGER_SCHEDULER_HA_RETRY_BEGIN();
-    response = appMasterProto->allocate(request);
+    AllocateResponse allocated = appMasterProto->allocate(request);
+    /* swap instead of copying the containers of a big response */
+    response.getProto().Swap(&allocated.getProto());
     RESOURCEMANAGER_SCHEDULER_HA_RETRY_END();
     return response;
 }
@@ -19,6 +19,8 @@
 
 #include <sstream>
 #include <list>
+#include <vector>
+#include <algorithm>
 #include "rpc/RpcAuth.h"
 #include "common/XmlConfig.h"
 #include "common/SessionConfig.h"
@@ -33,6 +35,7 @@
 #include "common/Logger.h"
 
 using namespace Yarn::Internal;
+using std::vector;
 
 namespace libyarn {
 
@@ -747,6 +750,33 @@ int LibYarnClient::releaseResources(string &jobId,int64_t releaseContainerIds[],
    repeated ContainerExceptionMapProto failed_requests = 3;
  }
  */
+/*
+ * One container to be started on its NodeManager by an active thread.
+ */
+struct ActiveContainerTask {
+    ContainerManagement *nmClient;
+    Container *container;
+    StartContainerRequest request;
+    Token nmToken;
+    bool failed;
+    string error;
+};
+
+static void* activeContainerFunc(void* args) {
+    ActiveContainerTask *task = (ActiveContainerTask*) args;
+    try {
+        task->nmClient->startContainer(*(task->container), task->request,
+                                       task->nmToken);
+    } catch (std::exception& e) {
+        task->failed = true;
+        task->error = e.what();
+    } catch (...) {
+        task->failed = true;
+        task->error = "unexpected exception";
+    }
+    return (void *) 0;
+}
+
 int LibYarnClient::activeResources(string &jobId,int64_t activeContainerIds[],int activeContainerSize) {
     try{
         if (jobId != clientJobId) {
@@ -758,33 +788,69 @@ int LibYarnClient::activeResources(string &jobId,int64_t activeContainerIds[],in
 
         LOG(DEBUG1, "LibYarnClient::activeResources, activeResources started");
 
+        /*
+         * Every container is started by its own NodeManager, so the containers
+         * are started by concurrent threads, ACTIVE_CONTAINER_THREAD_NUM at
+         * most at one time, instead of one NodeManager round trip after
+         * another.
+         */
+        vector<ActiveContainerTask> tasks;
+        tasks.reserve(activeContainerSize);
         for (int i = 0; i < activeContainerSize; i++) {
             int64_t containerId = activeContainerIds[i];
             map<int64_t, Container*>::iterator it = jobIdContainers.find(containerId);
             if (it != jobIdContainers.end()) {
-                try {
-                    Container *container = it->second;
-                    std::ostringstream key;
-                    key << container->getNodeId().getHost() << ":" << container->getNodeId().getPort();
+                Container *container = it->second;
+                std::ostringstream key;
+                key << container->getNodeId().getHost() << ":" << container->getNodeId().getPort();
+
+                ActiveContainerTask task;
+                task.nmClient = (ContainerManagement*) nmClient;
+                task.container = container;
+                task.nmToken = nmTokenCache[key.str()];
+                string cmd("sleep 10000000000");
+                list<string> cmds;
+                cmds.push_back(cmd);
+                ContainerLaunchContext ctx;
+                ctx.setCommand(cmds);
+                task.request.setContainerLaunchCtx(ctx);
+                Token cToken = container->getContainerToken();
+                task.request.setContainerToken(cToken);
+                task.failed = false;
+                tasks.push_back(task);
+            }
+        }
 
-                    Token nmToken = nmTokenCache[key.str()];
-                    string cmd("sleep 10000000000");
-                    list<string> cmds;
-                    cmds.push_back(cmd);
-                    ContainerLaunchContext ctx;
-                    ctx.setCommand(cmds);
-                    StartContainerRequest request;
-                    request.setContainerLaunchCtx(ctx);
-                    Token cToken = container->getContainerToken();
-                    request.setContainerToken(cToken);
-                    LOG(DEBUG1, "LibYarnClient::activeResources active containerId:%ld", containerId);
-                    ((ContainerManagement*)nmClient)->startContainer((*container), request, nmToken);
-                } catch (std::exception& e) {
-                    LOG(WARNING, "LibYarnClient::activeResources, activeResources Failed Id:%ld,exception:%s",
-                                 containerId,e.what());
-                    activeFailContainerIds.insert(containerId);
+        for (size_t begin = 0; begin < tasks.size(); begin += ACTIVE_CONTAINER_THREAD_NUM) {
+            size_t end = std::min(tasks.size(), begin + ACTIVE_CONTAINER_THREAD_NUM);
+            vector<pthread_t> threads(end - begin);
+            vector<bool> started(end - begin, false);
+            for (size_t i = begin; i < end; i++) {
+                LOG(DEBUG1, "LibYarnClient::activeResources active containerId:%ld",
+                            tasks[i].container->getId().getId());
+                int rc = pthread_create(&threads[i - begin], NULL,
+                                        activeContainerFunc, &tasks[i]);
+                if (rc == 0) {
+                    started[i - begin] = true;
+                } else {
+                    /* Start it in this thread if no more thread is available. */
+                    activeContainerFunc(&tasks[i]);
                 }
             }
+            for (size_t i = begin; i < end; i++) {
+                if (started[i - begin]) {
+                    pthread_join(threads[i - begin], NULL);
+                }
+            }
+        }
+
+        for (size_t i = 0; i < tasks.size(); i++) {
+            if (tasks[i].failed) {
+                int64_t containerId = tasks[i].container->getId().getId();
+                LOG(WARNING, "LibYarnClient::activeResources, activeResources Failed Id:%ld,exception:%s",
+                             containerId, tasks[i].error.c_str());
+                activeFailContainerIds.insert(containerId);
+            }
         }
 
         LOG(INFO, "LibYarnClient::active resources, container number:%d",
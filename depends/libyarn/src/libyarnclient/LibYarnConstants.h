@@ -24,6 +24,9 @@ enum TimeInterval {
 	ALLOCATE_INTERVAL_MS =	1000 * 1000
 };
 
+/* The maximum number of containers started concurrently. */
+#define ACTIVE_CONTAINER_THREAD_NUM 32
+
 #define DEFAULT_RACK  "/default-rack"
 #define YARN_HOST_ANY "*"
 
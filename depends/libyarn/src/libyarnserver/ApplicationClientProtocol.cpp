@@ -90,7 +90,7 @@ GetNewApplicationResponse ApplicationClientProtocol::getNewApplication(
         GetNewApplicationRequest &request) {
     try {
         GetNewApplicationResponseProto responseProto;
-        GetNewApplicationRequestProto requestProto = request.getProto();
+        GetNewApplicationRequestProto &requestProto = request.getProto();
         invoke(RpcCall(true, "getNewApplication", &requestProto, &responseProto));
         return GetNewApplicationResponse(responseProto);
     } catch (const YarnRpcServerException & e) {
@@ -114,7 +114,7 @@ void ApplicationClientProtocol::submitApplication(
         SubmitApplicationRequest &request) {
     try {
         SubmitApplicationResponseProto responseProto;
-        SubmitApplicationRequestProto requestProto = request.getProto();
+        SubmitApplicationRequestProto &requestProto = request.getProto();
         invoke(RpcCall(true, "submitApplication", &requestProto, &responseProto));
     } catch (const YarnRpcServerException & e) {
         UnWrapper<UnresolvedLinkException, YarnIOException> unwrapper(e);
@@ -135,10 +135,10 @@ void ApplicationClientProtocol::submitApplication(
 GetApplicationReportResponse ApplicationClientProtocol::getApplicationReport(
         GetApplicationReportRequest &request) {
     try {
-        GetApplicationReportResponseProto responseProto;
-        GetApplicationReportRequestProto requestProto = request.getProto();
-        invoke(RpcCall(true, "getApplicationReport", &requestProto, &responseProto));
-        return GetApplicationReportResponse(responseProto);
+        GetApplicationReportResponse response;
+        GetApplicationReportRequestProto &requestProto = request.getProto();
+        invoke(RpcCall(true, "getApplicationReport", &requestProto, &response.getProto()));
+        return response;
     } catch (const YarnRpcServerException & e) {
         UnWrapper<UnresolvedLinkException, YarnIOException> unwrapper(e);
         unwrapper.unwrap(__FILE__, __LINE__);
@@ -158,10 +158,10 @@ message GetContainersResponseProto {
  */
 GetContainersResponse ApplicationClientProtocol::getContainers(GetContainersRequest &request){
     try {
-        GetContainersResponseProto responseProto;
-        GetContainersRequestProto requestProto = request.getProto();
-        invoke(RpcCall(true, "getContainers", &requestProto,&responseProto));
-        return GetContainersResponse(responseProto);
+        GetContainersResponse response;
+        GetContainersRequestProto &requestProto = request.getProto();
+        invoke(RpcCall(true, "getContainers", &requestProto,&response.getProto()));
+        return response;
     } catch (const YarnRpcServerException & e) {
         UnWrapper<UnresolvedLinkException, YarnIOException> unwrapper(e);
         unwrapper.unwrap(__FILE__, __LINE__);
@@ -182,10 +182,10 @@ GetContainersResponse ApplicationClientProtocol::getContainers(GetContainersRequ
 GetClusterNodesResponse ApplicationClientProtocol::getClusterNodes(
         GetClusterNodesRequest &request) {
     try {
-        GetClusterNodesResponseProto responseProto;
-        GetClusterNodesRequestProto requestProto = request.getProto();
-        invoke(RpcCall(true, "getClusterNodes", &requestProto, &responseProto));
-        return GetClusterNodesResponse(responseProto);
+        GetClusterNodesResponse response;
+        GetClusterNodesRequestProto &requestProto = request.getProto();
+        invoke(RpcCall(true, "getClusterNodes", &requestProto, &response.getProto()));
+        return response;
     } catch (const YarnRpcServerException & e) {
         UnWrapper<UnresolvedLinkException, YarnIOException> unwrapper(e);
         unwrapper.unwrap(__FILE__, __LINE__);
@@ -219,10 +219,10 @@ GetClusterNodesResponse ApplicationClientProtocol::getClusterNodes(
 GetQueueInfoResponse ApplicationClientProtocol::getQueueInfo(
         GetQueueInfoRequest &request) {
     try {
-        GetQueueInfoResponseProto responseProto;
-        GetQueueInfoRequestProto requestProto = request.getProto();
-        invoke(RpcCall(true, "getQueueInfo", &requestProto, &responseProto));
-        return GetQueueInfoResponse(responseProto);
+        GetQueueInfoResponse response;
+        GetQueueInfoRequestProto &requestProto = request.getProto();
+        invoke(RpcCall(true, "getQueueInfo", &requestProto, &response.getProto()));
+        return response;
     } catch (const YarnRpcServerException & e) {
         UnWrapper<UnresolvedLinkException, YarnIOException> unwrapper(e);
         unwrapper.unwrap(__FILE__, __LINE__);
@@ -237,10 +237,10 @@ GetQueueInfoResponse ApplicationClientProtocol::getQueueInfo(
 GetClusterMetricsResponse ApplicationClientProtocol::getClusterMetrics(
         GetClusterMetricsRequest &request) {
     try {
-        GetClusterMetricsResponseProto responseProto;
-        GetClusterMetricsRequestProto requestProto = request.getProto();
-        invoke(RpcCall(true, "getClusterMetrics", &requestProto, &responseProto));
-        return GetClusterMetricsResponse(responseProto);
+        GetClusterMetricsResponse response;
+        GetClusterMetricsRequestProto &requestProto = request.getProto();
+        invoke(RpcCall(true, "getClusterMetrics", &requestProto, &response.getProto()));
+        return response;
     } catch (const YarnRpcServerException & e) {
         UnWrapper<UnresolvedLinkException, YarnIOException> unwrapper(e);
         unwrapper.unwrap(__FILE__, __LINE__);
@@ -250,11 +250,11 @@ GetClusterMetricsResponse ApplicationClientProtocol::getClusterMetrics(
 KillApplicationResponse ApplicationClientProtocol::forceKillApplication(
         KillApplicationRequest &request) {
     try {
-        KillApplicationResponseProto responseProto;
-        KillApplicationRequestProto requestProto = request.getProto();
+        KillApplicationResponse response;
+        KillApplicationRequestProto &requestProto = request.getProto();
         invoke(RpcCall(true, "forceKillApplication", &requestProto,
-                        &responseProto));
-        return KillApplicationResponse(responseProto);
+                        &response.getProto()));
+        return response;
     } catch (const YarnRpcServerException & e) {
         UnWrapper<UnresolvedLinkException, YarnIOException> unwrapper(e);
         unwrapper.unwrap(__FILE__, __LINE__);
@@ -264,10 +264,10 @@ KillApplicationResponse ApplicationClientProtocol::forceKillApplication(
 GetApplicationsResponse ApplicationClientProtocol::getApplications(
         GetApplicationsRequest &request) {
     try {
-        GetApplicationsResponseProto responseProto;
-        GetApplicationsRequestProto requestProto = request.getProto();
-        invoke(RpcCall(true, "getApplications", &requestProto, &responseProto));
-        return GetApplicationsResponse(responseProto);
+        GetApplicationsResponse response;
+        GetApplicationsRequestProto &requestProto = request.getProto();
+        invoke(RpcCall(true, "getApplications", &requestProto, &response.getProto()));
+        return response;
     } catch (const YarnRpcServerException & e) {
         UnWrapper<UnresolvedLinkException, YarnIOException> unwrapper(e);
         unwrapper.unwrap(__FILE__, __LINE__);
@@ -277,10 +277,10 @@ GetApplicationsResponse ApplicationClientProtocol::getApplications(
 GetQueueUserAclsInfoResponse ApplicationClientProtocol::getQueueAclsInfo(
         GetQueueUserAclsInfoRequest &request) {
     try {
-        GetQueueUserAclsInfoResponseProto responseProto;
-        GetQueueUserAclsInfoRequestProto requestProto = request.getProto();
-        invoke(RpcCall(true, "getQueueUserAcls", &requestProto, &responseProto));
-        return GetQueueUserAclsInfoResponse(responseProto);
+        GetQueueUserAclsInfoResponse response;
+        GetQueueUserAclsInfoRequestProto &requestProto = request.getProto();
+        invoke(RpcCall(true, "getQueueUserAcls", &requestProto, &response.getProto()));
+        return response;
     } catch (const YarnRpcServerException & e) {
         UnWrapper<UnresolvedLinkException, YarnIOException> unwrapper(e);
         unwrapper.unwrap(__FILE__, __LINE__);
@@ -56,10 +56,10 @@ void ApplicationMasterProtocol::invoke(const RpcCall & call) {
 RegisterApplicationMasterResponse ApplicationMasterProtocol::registerApplicationMaster(
         RegisterApplicationMasterRequest &request) {
     try {
-        RegisterApplicationMasterResponseProto responseProto;
-        RegisterApplicationMasterRequestProto requestProto = request.getProto();
-        invoke(RpcCall(true, "registerApplicationMaster", &requestProto, &responseProto));
-        return RegisterApplicationMasterResponse(responseProto);
+        RegisterApplicationMasterResponse response;
+        RegisterApplicationMasterRequestProto &requestProto = request.getProto();
+        invoke(RpcCall(true, "registerApplicationMaster", &requestProto, &response.getProto()));
+        return response;
     } catch (const YarnRpcServerException & e) {
         UnWrapper<ApplicationMasterNotRegisteredException, YarnIOException> unwrapper(e);
         unwrapper.unwrap(__FILE__, __LINE__);
@@ -69,10 +69,10 @@ RegisterApplicationMasterResponse ApplicationMasterProtocol::registerApplication
 
 AllocateResponse ApplicationMasterProtocol::allocate(AllocateRequest &request) {
     try {
-        AllocateRequestProto requestProto = request.getProto();
-        AllocateResponseProto responseProto;
-        invoke(RpcCall(true, "allocate", &requestProto, &responseProto));
-        return AllocateResponse(responseProto);
+        AllocateRequestProto &requestProto = request.getProto();
+        AllocateResponse response;
+        invoke(RpcCall(true, "allocate", &requestProto, &response.getProto()));
+        return response;
     } catch (const YarnRpcServerException & e) {
         UnWrapper<ApplicationMasterNotRegisteredException, YarnIOException> unwrapper(e);
         unwrapper.unwrap(__FILE__, __LINE__);
@@ -82,10 +82,10 @@ AllocateResponse ApplicationMasterProtocol::allocate(AllocateRequest &request) {
 FinishApplicationMasterResponse ApplicationMasterProtocol::finishApplicationMaster(
         FinishApplicationMasterRequest &request) {
     try {
-        FinishApplicationMasterRequestProto requestProto = request.getProto();
-        FinishApplicationMasterResponseProto responseProto;
-        invoke(RpcCall(true, "finishApplicationMaster", &requestProto, &responseProto));
-        return FinishApplicationMasterResponse(responseProto);
+        FinishApplicationMasterRequestProto &requestProto = request.getProto();
+        FinishApplicationMasterResponse response;
+        invoke(RpcCall(true, "finishApplicationMaster", &requestProto, &response.getProto()));
+        return response;
     } catch (const YarnRpcServerException & e) {
         UnWrapper<ApplicationMasterNotRegisteredException, YarnIOException> unwrapper(e);
         unwrapper.unwrap(__FILE__, __LINE__);
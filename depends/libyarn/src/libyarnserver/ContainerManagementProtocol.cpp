@@ -58,10 +58,10 @@ void ContainerManagementProtocol::invoke(const RpcCall & call) {
 
 StartContainersResponse ContainerManagementProtocol::startContainers(StartContainersRequest &request) {
     try {
-        StartContainersResponseProto responseProto;
-        StartContainersRequestProto requestProto = request.getProto();
-        invoke(RpcCall(true, "startContainers", &requestProto, &responseProto));
-        return StartContainersResponse(responseProto);
+        StartContainersResponse response;
+        StartContainersRequestProto &requestProto = request.getProto();
+        invoke(RpcCall(true, "startContainers", &requestProto, &response.getProto()));
+        return response;
     } catch (const YarnRpcServerException & e) {
         UnWrapper<UnresolvedLinkException, YarnIOException> unwrapper(e);
         unwrapper.unwrap(__FILE__, __LINE__);
@@ -70,10 +70,10 @@ StartContainersResponse ContainerManagementProtocol::startContainers(StartContai
 
 StopContainersResponse ContainerManagementProtocol::stopContainers(StopContainersRequest &request) {
     try {
-        StopContainersRequestProto requestProto = request.getProto();
-        StopContainersResponseProto responseProto;
-        invoke(RpcCall(true, "stopContainers", &requestProto, &responseProto));
-        return StopContainersResponse(responseProto);
+        StopContainersRequestProto &requestProto = request.getProto();
+        StopContainersResponse response;
+        invoke(RpcCall(true, "stopContainers", &requestProto, &response.getProto()));
+        return response;
     } catch (const YarnRpcServerException & e) {
         UnWrapper<UnresolvedLinkException, YarnIOException> unwrapper(e);
         unwrapper.unwrap(__FILE__, __LINE__);
@@ -82,10 +82,10 @@ StopContainersResponse ContainerManagementProtocol::stopContainers(StopContainer
 
 GetContainerStatusesResponse ContainerManagementProtocol::getContainerStatuses(GetContainerStatusesRequest &request){
     try {
-        GetContainerStatusesRequestProto requestProto = request.getProto();
-        GetContainerStatusesResponseProto responseProto;
-        invoke(RpcCall(true, "getContainerStatuses", &requestProto, &responseProto));
-        return GetContainerStatusesResponse(responseProto);
+        GetContainerStatusesRequestProto &requestProto = request.getProto();
+        GetContainerStatusesResponse response;
+        invoke(RpcCall(true, "getContainerStatuses", &requestProto, &response.getProto()));
+        return response;
     } catch (const YarnRpcServerException & e) {
         UnWrapper<UnresolvedLinkException, YarnIOException> unwrapper(e);
         unwrapper.unwrap(__FILE__, __LINE__);
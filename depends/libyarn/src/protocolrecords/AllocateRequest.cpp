@@ -53,7 +53,7 @@ list<ResourceRequest> AllocateRequest::getAsks() {
 	list<ResourceRequest> asks;
 	int size = requestProto.ask_size();
 	for (int i = 0; i < size; i++) {
-		ResourceRequestProto proto = requestProto.ask(i);
+		const ResourceRequestProto &proto = requestProto.ask(i);
 		ResourceRequest request(proto);
 		asks.push_back(request);
 	}
@@ -76,7 +76,7 @@ list<ContainerId> AllocateRequest::getReleases() {
 	list<ContainerId> releases;
 	int size = requestProto.release_size();
 	for (int i = 0; i < size; i++) {
-		ContainerIdProto proto = requestProto.release(i);
+		const ContainerIdProto &proto = requestProto.release(i);
 		ContainerId containerId(proto);
 		releases.push_back(containerId);
 	}
@@ -64,7 +64,7 @@ list<Container> AllocateResponse::getAllocatedContainers() {
 	list<Container> allocatedContainers;
 	int size = responseProto.allocated_containers_size();
 	for (int i = 0; i < size; i++) {
-		ContainerProto proto = responseProto.allocated_containers(i);
+		const ContainerProto &proto = responseProto.allocated_containers(i);
 		Container container(proto);
 		allocatedContainers.push_back(container);
 	}
@@ -83,7 +83,7 @@ list<ContainerStatus> AllocateResponse::getCompletedContainersStatuses() {
 	list<ContainerStatus> statuses;
 	int size = responseProto.completed_container_statuses_size();
 	for (int i = 0; i < size; i++) {
-		ContainerStatusProto proto = responseProto.completed_container_statuses(i);
+		const ContainerStatusProto &proto = responseProto.completed_container_statuses(i);
 		ContainerStatus status(proto);
 		statuses.push_back(status);
 	}
@@ -145,7 +145,7 @@ list<NMToken> AllocateResponse::getNMTokens() {
 	list<NMToken> nmTokens;
 	int size = responseProto.nm_tokens_size();
 	for (int i = 0; i < size; i++) {
-		NMTokenProto proto = responseProto.nm_tokens(i);
+		const NMTokenProto &proto = responseProto.nm_tokens(i);
 		NMToken token(proto);
 		nmTokens.push_back(token);
 	}
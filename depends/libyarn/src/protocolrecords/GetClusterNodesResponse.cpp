@@ -46,7 +46,7 @@ list<NodeReport> GetClusterNodesResponse::getNodeReports() {
 	list<NodeReport> reports;
 	int size = responseProto.nodereports_size();
 	for (int i = 0; i < size; i++) {
-		NodeReportProto proto = responseProto.nodereports(i);
+		const NodeReportProto &proto = responseProto.nodereports(i);
 		NodeReport report(proto);
 		reports.push_back(report);
 	}
@@ -46,7 +46,7 @@ list<StringBytesMap> StartContainerResponse::getServicesMetaData() {
 	list<StringBytesMap> maps;
 	int size = responseProto.services_meta_data_size();
 	for (int i = 0; i < size; i++) {
-		StringBytesMapProto proto = responseProto.services_meta_data(i);
+		const StringBytesMapProto &proto = responseProto.services_meta_data(i);
 		StringBytesMap map(proto);
 		maps.push_back(map);
 	}
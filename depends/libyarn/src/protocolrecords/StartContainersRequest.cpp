@@ -48,7 +48,7 @@ list<StartContainerRequest> StartContainersRequest::getStartContainerRequests()
 	list<StartContainerRequest> requests;
 	int size = requestProto.start_container_request_size();
 	for (int i = 0; i < size; i++) {
-		StartContainerRequestProto proto = requestProto.start_container_request(i);
+		const StartContainerRequestProto &proto = requestProto.start_container_request(i);
 		StartContainerRequest request(proto);
 		requests.push_back(request);
 	}
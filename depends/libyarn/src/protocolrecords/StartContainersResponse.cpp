@@ -49,7 +49,7 @@ list<StringBytesMap> StartContainersResponse::getServicesMetaData() {
 	list<StringBytesMap> maps;
 	int size = responseProto.services_meta_data_size();
 	for (int i = 0; i < size; i++) {
-		StringBytesMapProto proto = responseProto.services_meta_data(i);
+		const StringBytesMapProto &proto = responseProto.services_meta_data(i);
 		StringBytesMap map(proto);
 		maps.push_back(map);
 	}
@@ -69,7 +69,7 @@ list<ContainerId> StartContainersResponse::getSucceededRequests() {
 	list<ContainerId> ids;
 	int size = responseProto.succeeded_requests_size();
 	for (int i = 0; i < size; i++) {
-		ContainerIdProto proto = responseProto.succeeded_requests(i);
+		const ContainerIdProto &proto = responseProto.succeeded_requests(i);
 		ids.push_back(ContainerId(proto));
 	}
 	return ids;
@@ -88,7 +88,7 @@ list<ContainerExceptionMap> StartContainersResponse::getFailedRequests() {
 	list<ContainerExceptionMap> ces;
 	int size = responseProto.failed_requests_size();
 	for (int i = 0; i < size; i++) {
-		ContainerExceptionMapProto proto = responseProto.failed_requests(i);
+		const ContainerExceptionMapProto &proto = responseProto.failed_requests(i);
 		ces.push_back(ContainerExceptionMap(proto));
 	}
 	return ces;
@@ -48,7 +48,7 @@ list<ContainerId> StopContainersRequest::getContainerIds() {
 	list<ContainerId> cids;
 	int size = requestProto.container_id_size();
 	for (int i = 0; i < size; i++) {
-		ContainerIdProto proto = requestProto.container_id(i);
+		const ContainerIdProto &proto = requestProto.container_id(i);
 		ContainerId cid(proto);
 		cids.push_back(cid);
 	}
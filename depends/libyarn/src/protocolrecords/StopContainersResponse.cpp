@@ -49,7 +49,7 @@ list<ContainerId> StopContainersResponse::getSucceededRequests() {
 	list<ContainerId> cids;
 	int size = responseProto.succeeded_requests_size();
 	for (int i = 0; i < size; i++) {
-		ContainerIdProto proto = responseProto.succeeded_requests(i);
+		const ContainerIdProto &proto = responseProto.succeeded_requests(i);
 		ContainerId cid(proto);
 		cids.push_back(cid);
 	}
@@ -69,7 +69,7 @@ list<ContainerExceptionMap> StopContainersResponse::getFailedRequests() {
 	list<ContainerExceptionMap> ces;
 	int size = responseProto.failed_requests_size();
 	for (int i = 0; i < size; i++) {
-		ContainerExceptionMapProto proto = responseProto.failed_requests(i);
+		const ContainerExceptionMapProto &proto = responseProto.failed_requests(i);
 		ces.push_back(ContainerExceptionMap(proto));
 	}
 	return ces;
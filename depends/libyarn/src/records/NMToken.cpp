@@ -42,7 +42,7 @@ void NMToken::setNodeId(NodeId &nodeId) {
 }
 
 NodeId NMToken::getNodeId() {
-	NodeIdProto proto = nmTokenProto.nodeid();
+	const NodeIdProto &proto = nmTokenProto.nodeid();
 	return NodeId(proto);
 }
 
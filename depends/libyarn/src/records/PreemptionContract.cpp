@@ -41,7 +41,7 @@ PreemptionContractProto& PreemptionContract::getProto() {
 set<PreemptionContainer> PreemptionContract::getContainers() {
 	set<PreemptionContainer> containerSets;
 	for (int i = 0; i < contractProto.container_size(); i++) {
-		PreemptionContainerProto proto = contractProto.container(i);
+		const PreemptionContainerProto &proto = contractProto.container(i);
 		PreemptionContainer container(proto);
 		containerSets.insert(container);
 	}
@@ -60,7 +60,7 @@ void PreemptionContract::setContainers(set<PreemptionContainer> &containers) {
 list<PreemptionResourceRequest> PreemptionContract::getResourceRequest() {
 	list<PreemptionResourceRequest> requestLists;
 	for (int i = 0; i < contractProto.resource_size(); i++) {
-		PreemptionResourceRequestProto proto = contractProto.resource(i);
+		const PreemptionResourceRequestProto &proto = contractProto.resource(i);
 		PreemptionResourceRequest request(proto);
 		requestLists.push_back(request);
 	}
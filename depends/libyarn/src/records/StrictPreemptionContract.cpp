@@ -41,7 +41,7 @@ StrictPreemptionContractProto& StrictPreemptionContract::getProto() {
 set<PreemptionContainer> StrictPreemptionContract::getContainers() {
 	set<PreemptionContainer> containerSet;
 	for (int i = 0; i < contractProto.container_size(); i++) {
-		PreemptionContainerProto proto = contractProto.container(i);
+		const PreemptionContainerProto &proto = contractProto.container(i);
 		PreemptionContainer container(proto);
 		containerSet.insert(container);
 	}
@@ -55,6 +55,12 @@ public class Fragment {
      */
     private String profile;
 
+    /**
+     * Fragment length in bytes, 0 if unknown. HAWQ uses it to balance the
+     * fragments between the segments.
+     */
+    private long length;
+
     /**
      * Constructs a Fragment.
      *
@@ -140,4 +146,12 @@ public class Fragment {
     public void setProfile(String profile) {
         this.profile = profile;
     }
+
+    public long getLength() {
+        return length;
+    }
+
+    public void setLength(long length) {
+        this.length = length;
+    }
 }
@@ -80,6 +80,7 @@ public class HdfsDataFragmenter extends Fragmenter {
              */
             byte[] fragmentMetadata = HdfsUtilities.prepareFragmentMetadata(fsp);
             Fragment fragment = new Fragment(filepath, hosts, fragmentMetadata);
+            fragment.setLength(fsp.getLength());
             fragments.add(fragment);
         }
 
@@ -78,6 +78,7 @@ public class ParquetDataFragmenter extends Fragmenter {
 
             byte[] fragmentMetadata = HdfsUtilities.prepareFragmentMetadata(fsp.getStart(), fsp.getLength(), fsp.getLocations());
             Fragment fragment = new Fragment(filepath, hosts, fragmentMetadata, HdfsUtilities.makeParquetUserData(schema));
+            fragment.setLength(fsp.getLength());
             fragments.add(fragment);
         }
 
@@ -317,6 +317,7 @@ public class HiveDataFragmenter extends Fragmenter {
             byte[] locationInfo = HdfsUtilities.prepareFragmentMetadata(fsp);
             Fragment fragment = new Fragment(filepath, hosts, locationInfo,
                     HiveUtilities.makeUserData(fragmenterForProfile, tablePartition, filterInFragmenter), profile);
+            fragment.setLength(fsp.getLength());
             fragments.add(fragment);
         }
     }
@@ -32,10 +32,12 @@
 
 #include "funcapi.h"
 #include "miscadmin.h"
+#include "access/appendonlywriter.h"
 #include "access/filesplit.h"
 #include "access/heapam.h"
 #include "access/genam.h"
 #include "access/aosegfiles.h"
+#include "access/transam.h"
 #include "access/orcsegfiles.h"
 #include "access/parquetsegfiles.h"
 #include "catalog/pg_type.h"
@@ -52,8 +54,32 @@
 #include "utils/lsyscache.h"
 #include "utils/syscache.h"
 #include "utils/fmgroids.h"
+#include "utils/hsearch.h"
+#include "utils/memutils.h"
 #include "utils/numeric.h"
 
+/*
+ * Backend-local cache of the segment file catalog rows, keyed by the oid of
+ * the segment file catalog. Planning and data locality read all the rows of
+ * every scanned table for each query, so on the master the rows are kept and
+ * reused while the version of the catalog published by the append only writer
+ * is unchanged and the snapshot sees the same catalog contents.
+ */
+typedef struct SegfileCatalogCacheEntry
+{
+	Oid			segrelid;		/* hash key */
+	Oid			relfilenode;	/* storage of the catalog when it was read */
+	uint64		version;		/* version of the catalog when it was read */
+	int			nentries;
+	SegfileCatalogEntry *entries;
+} SegfileCatalogCacheEntry;
+
+/* drop the whole cache once it would hold more relations than this */
+#define SEGFILE_CATALOG_CACHE_MAX_RELS 16384
+
+static HTAB *SegfileCatalogCache = NULL;
+static MemoryContext SegfileCatalogCacheContext = NULL;
+
 static Datum ao_compression_ratio_internal(Oid relid);
 
 /* ------------------------------------------------------------------------
@@ -619,6 +645,205 @@ UpdateFileSegInfo(Relation parentrel,
 	pfree(new_record_repl);
 }
 
+/*
+ * Scan all the rows of the segment file catalog segrel in physical order.
+ */
+static SegfileCatalogEntry *
+ScanSegfileCatalog(Relation segrel, bool isAoRows, Snapshot snapshot, int *nentries)
+{
+	TupleDesc	segdsc = RelationGetDescr(segrel);
+	SysScanDesc	segscan;
+	HeapTuple	tuple;
+	SegfileCatalogEntry *entries;
+	int			maxentries = AO_FILESEGINFO_ARRAY_SIZE;
+	int			n = 0;
+	bool		isNull;
+
+	entries = (SegfileCatalogEntry *) palloc(maxentries * sizeof(SegfileCatalogEntry));
+
+	segscan = systable_beginscan(segrel, InvalidOid, FALSE, snapshot, 0, NULL);
+
+	while (HeapTupleIsValid(tuple = systable_getnext(segscan)))
+	{
+		SegfileCatalogEntry *entry;
+		Datum		eof_uncompressed;
+
+		if (n == maxentries)
+		{
+			maxentries *= 2;
+			entries = (SegfileCatalogEntry *) repalloc(entries,
+						maxentries * sizeof(SegfileCatalogEntry));
+		}
+		entry = &entries[n++];
+
+		if (isAoRows)
+		{
+			entry->segno = DatumGetInt32(
+					fastgetattr(tuple, Anum_pg_aoseg_segno, segdsc, &isNull));
+			entry->eof = (int64) DatumGetFloat8(
+					fastgetattr(tuple, Anum_pg_aoseg_eof, segdsc, &isNull));
+			entry->tupcount = (int64) DatumGetFloat8(
+					fastgetattr(tuple, Anum_pg_aoseg_tupcount, segdsc, &isNull));
+			entry->varblockcount = (int64) DatumGetFloat8(
+					fastgetattr(tuple, Anum_pg_aoseg_varblockcount, segdsc, &isNull));
+			eof_uncompressed =
+					fastgetattr(tuple, Anum_pg_aoseg_eofuncompressed, segdsc, &isNull);
+		}
+		else
+		{
+			entry->segno = DatumGetInt32(
+					fastgetattr(tuple, Anum_pg_parquetseg_segno, segdsc, &isNull));
+			entry->eof = (int64) DatumGetFloat8(
+					fastgetattr(tuple, Anum_pg_parquetseg_eof, segdsc, &isNull));
+			entry->tupcount = (int64) DatumGetFloat8(
+					fastgetattr(tuple, Anum_pg_parquetseg_tupcount, segdsc, &isNull));
+			entry->varblockcount = 0;
+			eof_uncompressed =
+					fastgetattr(tuple, Anum_pg_parquetseg_eofuncompressed, segdsc, &isNull);
+		}
+
+		if (isNull)
+			entry->eof_uncompressed = InvalidUncompressedEof;
+		else
+			entry->eof_uncompressed = (int64) DatumGetFloat8(eof_uncompressed);
+
+		CHECK_FOR_INTERRUPTS();
+	}
+
+	systable_endscan(segscan);
+
+	*nentries = n;
+	return entries;
+}
+
+/*
+ * Whether snapshot sees every change of a segment file catalog counted by
+ * version, and nothing else. The changes are those of the transactions that
+ * ended up to the last one recorded in version, all of them before it.
+ */
+static bool
+SegfileCatalogVersionVisible(Snapshot snapshot, uint64 version)
+{
+	TransactionId lastXid = SegfileVersionXid(version);
+	uint32		i;
+
+	if (snapshot == SnapshotNow)
+		return true;
+
+	if (!IsMVCCSnapshot(snapshot))
+		return false;
+
+	if (!TransactionIdIsValid(lastXid))
+		return true;
+
+	if (!TransactionIdPrecedes(lastXid, snapshot->xmax))
+		return false;
+
+	for (i = 0; i < snapshot->xcnt; i++)
+	{
+		if (TransactionIdEquals(lastXid, snapshot->xip[i]))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * GetSegfileCatalogEntries
+ *
+ * Get all the rows of the segment file catalog segrel (pg_aoseg_* if isAoRows,
+ * pg_paqseg_* otherwise) visible to snapshot, in physical order, as a palloc'd
+ * array of *nentries entries.
+ *
+ * On the master the rows are cached in backend memory, see
+ * SegfileCatalogCacheEntry, unless the current transaction changed them.
+ */
+SegfileCatalogEntry *
+GetSegfileCatalogEntries(Relation segrel, bool isAoRows, Snapshot snapshot, int *nentries)
+{
+	Oid			segrelid = RelationGetRelid(segrel);
+	SegfileCatalogCacheEntry *cached;
+	SegfileCatalogEntry *entries;
+	SegfileCatalogEntry *copy;
+	uint64		version;
+	bool		found;
+	int			n;
+
+	if (!gp_enable_segfile_catalog_cache ||
+		Gp_role != GP_ROLE_DISPATCH ||
+		AppendOnlyWriter == NULL ||
+		AORelSegfileChangedLocally(segrelid))
+		return ScanSegfileCatalog(segrel, isAoRows, snapshot, nentries);
+
+	/* read the version before the rows, so that later changes bump it */
+	version = AORelGetSegfileVersion(segrelid);
+	if (!SegfileCatalogVersionVisible(snapshot, version))
+		return ScanSegfileCatalog(segrel, isAoRows, snapshot, nentries);
+
+	if (SegfileCatalogCache != NULL)
+	{
+		cached = (SegfileCatalogCacheEntry *)
+			hash_search(SegfileCatalogCache, &segrelid, HASH_FIND, NULL);
+		if (cached != NULL &&
+			cached->version == version &&
+			cached->relfilenode == segrel->rd_node.relNode)
+		{
+			entries = (SegfileCatalogEntry *)
+				palloc((cached->nentries + 1) * sizeof(SegfileCatalogEntry));
+			memcpy(entries, cached->entries,
+				   cached->nentries * sizeof(SegfileCatalogEntry));
+			*nentries = cached->nentries;
+			return entries;
+		}
+	}
+
+	entries = ScanSegfileCatalog(segrel, isAoRows, snapshot, &n);
+	*nentries = n;
+
+	if (SegfileCatalogCache != NULL &&
+		hash_get_num_entries(SegfileCatalogCache) >= SEGFILE_CATALOG_CACHE_MAX_RELS)
+	{
+		MemoryContextReset(SegfileCatalogCacheContext);
+		SegfileCatalogCache = NULL;
+	}
+
+	if (SegfileCatalogCache == NULL)
+	{
+		HASHCTL		info;
+
+		if (SegfileCatalogCacheContext == NULL)
+			SegfileCatalogCacheContext = AllocSetContextCreate(CacheMemoryContext,
+											"Segfile catalog cache",
+											ALLOCSET_DEFAULT_MINSIZE,
+											ALLOCSET_DEFAULT_INITSIZE,
+											ALLOCSET_DEFAULT_MAXSIZE);
+
+		MemSet(&info, 0, sizeof(info));
+		info.keysize = sizeof(Oid);
+		info.entrysize = sizeof(SegfileCatalogCacheEntry);
+		info.hash = oid_hash;
+		info.hcxt = SegfileCatalogCacheContext;
+		SegfileCatalogCache = hash_create("Segfile catalog cache", 256, &info,
+										  HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+	}
+
+	copy = (SegfileCatalogEntry *)
+		MemoryContextAlloc(SegfileCatalogCacheContext,
+						   (n + 1) * sizeof(SegfileCatalogEntry));
+	memcpy(copy, entries, n * sizeof(SegfileCatalogEntry));
+
+	cached = (SegfileCatalogCacheEntry *)
+		hash_search(SegfileCatalogCache, &segrelid, HASH_ENTER, &found);
+	if (found)
+		pfree(cached->entries);
+	cached->relfilenode = segrel->rd_node.relNode;
+	cached->version = version;
+	cached->nentries = n;
+	cached->entries = copy;
+
+	return entries;
+}
+
 /*
  * GetSegFilesTotals
  *
@@ -629,15 +854,10 @@ FileSegTotals *GetSegFilesTotals(Relation parentrel, Snapshot appendOnlyMetaData
 {
 
 	Relation		pg_aoseg_rel;
-	TupleDesc		pg_aoseg_dsc;
-	HeapTuple		tuple;
-	SysScanDesc		aoscan;
+	SegfileCatalogEntry *entries;
+	int				nentries;
+	int				i;
 	FileSegTotals  *result;
-	Datum			eof,
-					eof_uncompressed,
-					tupcount,
-					varblockcount;
-	bool			isNull;
 	AppendOnlyEntry *aoEntry = NULL;
 	
 	Assert(RelationIsAoRows(parentrel)); /* doesn't fit for AO column store. should implement same for CO */
@@ -647,32 +867,24 @@ FileSegTotals *GetSegFilesTotals(Relation parentrel, Snapshot appendOnlyMetaData
 	result = (FileSegTotals *) palloc0(sizeof(FileSegTotals));
 
 	pg_aoseg_rel = heap_open(aoEntry->segrelid, AccessShareLock);
-	pg_aoseg_dsc = RelationGetDescr(pg_aoseg_rel);
 
-	aoscan = systable_beginscan(pg_aoseg_rel, InvalidOid, FALSE,
-			appendOnlyMetaDataSnapshot, 0, NULL);
+	entries = GetSegfileCatalogEntries(pg_aoseg_rel, true,
+			appendOnlyMetaDataSnapshot, &nentries);
 
-	while (HeapTupleIsValid(tuple = systable_getnext(aoscan)))
+	for (i = 0; i < nentries; i++)
 	{
-		eof = fastgetattr(tuple, Anum_pg_aoseg_eof, pg_aoseg_dsc, &isNull);
-		tupcount = fastgetattr(tuple, Anum_pg_aoseg_tupcount, pg_aoseg_dsc, &isNull);
-		varblockcount = fastgetattr(tuple, Anum_pg_aoseg_varblockcount, pg_aoseg_dsc, &isNull);
-		eof_uncompressed = fastgetattr(tuple, Anum_pg_aoseg_eofuncompressed, pg_aoseg_dsc, &isNull);
-
-		if(isNull)
+		if (entries[i].eof_uncompressed == InvalidUncompressedEof)
 			result->totalbytesuncompressed = InvalidUncompressedEof;
 		else
-			result->totalbytesuncompressed += (int64)DatumGetFloat8(eof_uncompressed);
+			result->totalbytesuncompressed += entries[i].eof_uncompressed;
 
-		result->totalbytes += (int64)DatumGetFloat8(eof);
-		result->totaltuples += (int64)DatumGetFloat8(tupcount);
-		result->totalvarblocks += (int64)DatumGetFloat8(varblockcount);
+		result->totalbytes += entries[i].eof;
+		result->totaltuples += entries[i].tupcount;
+		result->totalvarblocks += entries[i].varblockcount;
 		result->totalfilesegs++;
-
-		CHECK_FOR_INTERRUPTS();
 	}
 
-	systable_endscan(aoscan);
+	pfree(entries);
 	heap_close(pg_aoseg_rel, AccessShareLock);
 
 	pfree(aoEntry);
@@ -692,12 +904,10 @@ int64 GetAOTotalBytes(Relation parentrel, Snapshot appendOnlyMetaDataSnapshot)
 {
 
 	Relation		pg_aoseg_rel;
-	TupleDesc		pg_aoseg_dsc;
-	HeapTuple		tuple;
-	SysScanDesc		aoscan;
+	SegfileCatalogEntry *entries;
+	int				nentries;
+	int				i;
 	int64		  	result;
-	Datum			eof;
-	bool			isNull;
 	AppendOnlyEntry *aoEntry = NULL;
 	
 	aoEntry = GetAppendOnlyEntry(RelationGetRelid(parentrel), appendOnlyMetaDataSnapshot);
@@ -705,24 +915,16 @@ int64 GetAOTotalBytes(Relation parentrel, Snapshot appendOnlyMetaDataSnapshot)
 	result = 0;
 
 	pg_aoseg_rel = heap_open(aoEntry->segrelid, AccessShareLock);
-	pg_aoseg_dsc = RelationGetDescr(pg_aoseg_rel);
 
 	Assert (Gp_role != GP_ROLE_EXECUTE);
 
-	aoscan = systable_beginscan(pg_aoseg_rel, InvalidOid, FALSE,
-			appendOnlyMetaDataSnapshot, 0, NULL);
+	entries = GetSegfileCatalogEntries(pg_aoseg_rel, true,
+			appendOnlyMetaDataSnapshot, &nentries);
 
-	while (HeapTupleIsValid(tuple = systable_getnext(aoscan)))
-	{
-		eof = fastgetattr(tuple, Anum_pg_aoseg_eof, pg_aoseg_dsc, &isNull);
-		Assert(!isNull);
+	for (i = 0; i < nentries; i++)
+		result += entries[i].eof;
 
-		result += (int64)DatumGetFloat8(eof);
-
-		CHECK_FOR_INTERRUPTS();
-	}
-
-	systable_endscan(aoscan);
+	pfree(entries);
 	heap_close(pg_aoseg_rel, AccessShareLock);
 
 	pfree(aoEntry);
@@ -1578,6 +1780,49 @@ get_ao_compression_ratio_oid(PG_FUNCTION_ARGS)
 	return ao_compression_ratio_internal(relid);
 }
 
+/*
+ * get_ao_tupcount_oid
+ *
+ * The total number of tuples of an append only or parquet table, summed up
+ * from the tupcount of its segment files in the pg_aoseg_* or pg_paqseg_*
+ * table on master, as seen by the snapshot of the query.  The planner answers
+ * an unfiltered count(*) with this, see optimize_segfile_count().
+ */
+Datum
+get_ao_tupcount_oid(PG_FUNCTION_ARGS)
+{
+	Oid			relid = PG_GETARG_OID(0);
+	Snapshot	snapshot = ActiveSnapshot ? ActiveSnapshot : SnapshotNow;
+	Relation	parentrel;
+	int64		tupcount;
+
+	parentrel = heap_open(relid, AccessShareLock);
+
+	if (RelationIsAoRows(parentrel))
+	{
+		FileSegTotals *fstotal = GetSegFilesTotals(parentrel, snapshot);
+
+		tupcount = fstotal->totaltuples;
+		pfree(fstotal);
+	}
+	else if (RelationIsParquet(parentrel))
+	{
+		ParquetFileSegTotals *fstotal = GetParquetSegFilesTotals(parentrel, snapshot);
+
+		tupcount = fstotal->totaltuples;
+		pfree(fstotal);
+	}
+	else
+		ereport(ERROR,
+				(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+				 errmsg("\"%s\" is not an append only or parquet table",
+						RelationGetRelationName(parentrel))));
+
+	heap_close(parentrel, AccessShareLock);
+
+	PG_RETURN_INT64(tupcount);
+}
+
 static Datum
 aorow_compression_ratio_internal(Relation parentrel)
 {
@@ -76,6 +76,7 @@
 #include "catalog/pg_appendonly.h"
 #include "catalog/pg_attribute_encoding.h"
 #include "catalog/namespace.h"
+#include "cdb/cdbutil.h"
 #include "cdb/cdbvars.h"
 #include "cdb/cdbappendonlyam.h"
 #include "pgstat.h"
@@ -99,14 +100,64 @@
 #define SCANNED_SEGNO  (&scan->aos_segfile_arr[ \
 					(scan->aos_segfiles_processed == 0 ? 0 : scan->aos_segfiles_processed - 1)])->segno
 
+/*
+ * With column groups, the blocks of a row range are written one after the
+ * other, one per group. The block of the first group has one of the plain
+ * kinds, those of the other groups have the column group kinds, so a scan
+ * knows where a row range begins.
+ */
 typedef enum AoExecutorBlockKind
 {
 	AoExecutorBlockKind_None = 0,
 	AoExecutorBlockKind_VarBlock,
 	AoExecutorBlockKind_SingleRow,
+	AoExecutorBlockKind_ColumnGroupVarBlock,
+	AoExecutorBlockKind_ColumnGroupSingleRow,
 	MaxAoExecutorBlockKind /* must always be last */
 } AoExecutorBlockKind;
 
+/*
+ * The write state of a column group.
+ */
+typedef struct AppendOnlyColumnGroupWrite
+{
+	MemTupleBinding *mt_bind;
+
+	VarBlockMaker	varBlockMaker;
+	uint8			*buffer;
+	uint8			*tempSpace;
+
+	MemTuple		tuple;			/* the columns of the row being inserted */
+	uint32			tupleLen;
+	uint8			*tupleBuf;
+	uint32			tupleBufLen;
+} AppendOnlyColumnGroupWrite;
+
+/* the read block of a column group */
+#define ColumnGroupReadBlock(scan, group) \
+	((group) == 0 ? &(scan)->executorReadBlock : &(scan)->groupReadBlocks[(group)])
+
+static inline bool
+IsColumnGroupBlockKind(int executorBlockKind)
+{
+	return (executorBlockKind == AoExecutorBlockKind_ColumnGroupVarBlock ||
+			executorBlockKind == AoExecutorBlockKind_ColumnGroupSingleRow);
+}
+
+/*
+ * The block kind of a block of a column group.
+ */
+static inline int
+ColumnGroupBlockKind(int executorBlockKind, int group)
+{
+	if (group == 0)
+		return executorBlockKind;
+
+	return (executorBlockKind == AoExecutorBlockKind_VarBlock ?
+			AoExecutorBlockKind_ColumnGroupVarBlock :
+			AoExecutorBlockKind_ColumnGroupSingleRow);
+}
+
 static void
 AppendOnlyExecutionReadBlock_SetSegmentFileNum(
 	AppendOnlyExecutorReadBlock		*executorReadBlock,
@@ -120,7 +171,7 @@ AppendOnlyExecutionReadBlock_SetPositionInfo(
 static void
 AppendOnlyExecutorReadBlock_Init(
 	AppendOnlyExecutorReadBlock		*executorReadBlock,
-	Relation						relation,
+	TupleDesc						tupleDesc,
 	MemoryContext					memoryContext,
 	AppendOnlyStorageRead			*storageRead,
 	int32							usableBlockSize);
@@ -129,6 +180,9 @@ static void
 AppendOnlyExecutorReadBlock_Finish(
 	AppendOnlyExecutorReadBlock		*executorReadBlock);
 
+static TupleDesc
+ColumnGroupTupleDesc(TupleDesc tupleDesc, int columnGroupSize, int group);
+
 static void
 AppendOnlyExecutorReadBlock_ResetCounts(
 	AppendOnlyExecutorReadBlock		*executorReadBlock);
@@ -227,12 +281,48 @@ SetNextFileSegForRead(AppendOnlyScanDesc scan)
 		/* Switch back to caller's memory context. */
 		MemoryContextSwitchTo(oldMemoryContext);
 
-		AppendOnlyExecutorReadBlock_Init(
-							&scan->executorReadBlock,
-							scan->aos_rd,
-							scan->aoScanInitContext,
-							&scan->storageRead,
-							scan->usableBlockSize);
+		if (scan->numColumnGroups > 1)
+		{
+			int		group;
+
+			AppendOnlyExecutorReadBlock_Init(
+								&scan->executorReadBlock,
+								ColumnGroupTupleDesc(RelationGetDescr(reln),
+													 scan->columnGroupSize, 0),
+								scan->aoScanInitContext,
+								&scan->storageRead,
+								scan->usableBlockSize);
+
+			/*
+			 * The blocks of the groups not needed are only skipped, they
+			 * need no buffer.
+			 */
+			for (group = 1; group < scan->numColumnGroups; group++)
+			{
+				AppendOnlyExecutorReadBlock *groupReadBlock = &scan->groupReadBlocks[group];
+
+				if (scan->groupNeeded[group])
+					AppendOnlyExecutorReadBlock_Init(
+								groupReadBlock,
+								ColumnGroupTupleDesc(RelationGetDescr(reln),
+													 scan->columnGroupSize, group),
+								scan->aoScanInitContext,
+								&scan->storageRead,
+								scan->usableBlockSize);
+				else
+				{
+					groupReadBlock->storageRead = &scan->storageRead;
+					groupReadBlock->memoryContext = scan->aoScanInitContext;
+				}
+			}
+		}
+		else
+			AppendOnlyExecutorReadBlock_Init(
+								&scan->executorReadBlock,
+								RelationGetDescr(reln),
+								scan->aoScanInitContext,
+								&scan->storageRead,
+								scan->usableBlockSize);
 
 		scan->bufferDone = true; /* so we read a new buffer right away */
 
@@ -581,15 +671,32 @@ CloseWritableFileSeg(AppendOnlyInsertDesc aoInsertDesc)
 
 //------------------------------------------------------------------------------
 
+/*
+ * Read the contents of the block found with ~_GetBlockInfo.
+ *
+ * The blocks of a column group are read one after the other, so their small
+ * content is copied out of the read buffer, and they may end past the split.
+ */
 static void
 AppendOnlyExecutorReadBlock_GetContents(
-	AppendOnlyExecutorReadBlock		*executorReadBlock)
+	AppendOnlyExecutorReadBlock		*executorReadBlock,
+	bool							isColumnGroup)
 {
 	VarBlockCheckError varBlockCheckError;
 
 	if (!executorReadBlock->isCompressed)
 	{
-		if (!executorReadBlock->isLarge)
+		if (!executorReadBlock->isLarge && isColumnGroup)
+		{
+			executorReadBlock->dataBuffer = executorReadBlock->uncompressedBuffer;
+
+			AppendOnlyStorageRead_Content(
+									executorReadBlock->storageRead,
+									executorReadBlock->dataBuffer,
+									executorReadBlock->dataLen,
+									false);
+		}
+		else if (!executorReadBlock->isLarge)
 		{
 			/*
 			 * Small content.
@@ -685,7 +792,7 @@ AppendOnlyExecutorReadBlock_GetContents(
 								executorReadBlock->storageRead,
 								executorReadBlock->dataBuffer,
 								executorReadBlock->dataLen,
-								true);
+								!isColumnGroup);
 
 		if (Debug_appendonly_print_scan)
 			elog(LOG,
@@ -849,7 +956,7 @@ AppendOnlyExecutionReadBlock_FinishedScanBlock(
 static void
 AppendOnlyExecutorReadBlock_Init(
 	AppendOnlyExecutorReadBlock		*executorReadBlock,
-	Relation						relation,
+	TupleDesc						tupleDesc,
 	MemoryContext					memoryContext,
 	AppendOnlyStorageRead			*storageRead,
 	int32							usableBlockSize)
@@ -859,7 +966,7 @@ AppendOnlyExecutorReadBlock_Init(
 	oldcontext = MemoryContextSwitchTo(memoryContext);
 	executorReadBlock->uncompressedBuffer = (uint8 *) palloc(usableBlockSize * sizeof(uint8));
 
-	executorReadBlock->mt_bind = create_memtuple_binding(RelationGetDescr(relation));
+	executorReadBlock->mt_bind = create_memtuple_binding(tupleDesc);
 
 	ItemPointerSet(&executorReadBlock->cdb_fake_ctid, 0, 0);
 
@@ -871,6 +978,33 @@ AppendOnlyExecutorReadBlock_Init(
 
 }
 
+/*
+ * The tuple descriptor of the columns of a column group.
+ *
+ * The oid of a row is stored with the columns of the first group.
+ */
+static TupleDesc
+ColumnGroupTupleDesc(TupleDesc tupleDesc, int columnGroupSize, int group)
+{
+	TupleDesc	groupDesc;
+	int			firstAttr = group * columnGroupSize;
+	int			natts = Min(tupleDesc->natts - firstAttr, columnGroupSize);
+	int			i;
+
+	Assert(natts > 0);
+
+	groupDesc = CreateTemplateTupleDesc(natts,
+										group == 0 ? tupleDesc->tdhasoid : false);
+	for (i = 0; i < natts; i++)
+	{
+		memcpy(groupDesc->attrs[i], tupleDesc->attrs[firstAttr + i],
+			   ATTRIBUTE_FIXED_PART_SIZE);
+		groupDesc->attrs[i]->attnum = i + 1;
+	}
+
+	return groupDesc;
+}
+
 /*
  * Free the space allocated inside ExexcutorReadBlock.
  */
@@ -1186,21 +1320,222 @@ LABEL_START_GETNEXTBLOCK:
 		return false;
 	}
 
-  //skip invalid small content blocks
-  if(!scan->executorReadBlock.isLarge
+  //skip invalid small content blocks, and the blocks not sampled by ANALYZE
+  if((!scan->executorReadBlock.isLarge
           && scan->executorReadBlock.executorBlockKind == AoExecutorBlockKind_SingleRow
           && scan->executorReadBlock.rowCount==0)
+     || (gp_statistics_block_sampling_fraction < 1.0
+          && cdb_rand() >= gp_statistics_block_sampling_fraction))
   {
       //skip current block
       AppendOnlyStorageRead_SkipCurrentBlock(&scan->storageRead, true);
       goto LABEL_START_GETNEXTBLOCK;
   }else{
       AppendOnlyExecutorReadBlock_GetContents(
-                &scan->executorReadBlock);
+                &scan->executorReadBlock, false);
   }
 	return true;
 }
 
+/*
+ * Get the blocks of the next row range of a relation with column groups.
+ *
+ * The row range begins with the block of the first group in the split, the
+ * blocks of the other groups follow it, possibly past the end of the split.
+ * Only the blocks of the needed groups are read, the others are skipped.
+ */
+static bool
+getNextColumnGroupBlocks(
+	AppendOnlyScanDesc 	scan)
+{
+	AppendOnlyExecutorReadBlock *firstReadBlock = &scan->executorReadBlock;
+	int		group;
+	bool	sampled;
+
+LABEL_START_GETNEXTCOLUMNGROUPBLOCKS:
+	for (;;)
+	{
+		if (scan->aos_need_new_split)
+		{
+			/*
+			 * Need to open a new segment file.
+			 */
+			if (!SetNextFileSegForRead(scan))
+				return false;
+		}
+
+		if (!AppendOnlyExecutorReadBlock_GetBlockInfo(
+										&scan->storageRead,
+										firstReadBlock,
+										true))
+		{
+			/* done reading the file */
+			if(scan->toCloseFile){
+				CloseScannedFileSeg(scan);
+			}
+			scan->aos_need_new_split = true;
+
+			return false;
+		}
+
+		/*
+		 * Skip the invalid small content blocks, and the blocks of the other
+		 * groups of a row range that begins in the previous split.
+		 */
+		if (IsColumnGroupBlockKind(firstReadBlock->executorBlockKind) ||
+			(!firstReadBlock->isLarge &&
+			 firstReadBlock->executorBlockKind == AoExecutorBlockKind_SingleRow &&
+			 firstReadBlock->rowCount == 0))
+		{
+			AppendOnlyStorageRead_SkipCurrentBlock(&scan->storageRead, false);
+			continue;
+		}
+
+		break;
+	}
+
+	/* ANALYZE samples whole row ranges */
+	sampled = (gp_statistics_block_sampling_fraction >= 1.0 ||
+			   cdb_rand() < gp_statistics_block_sampling_fraction);
+
+	if (scan->groupNeeded[0] && sampled)
+		AppendOnlyExecutorReadBlock_GetContents(firstReadBlock, true);
+	else
+		AppendOnlyStorageRead_SkipCurrentBlock(&scan->storageRead, false);
+
+	for (group = 1; group < scan->numColumnGroups; group++)
+	{
+		AppendOnlyExecutorReadBlock *groupReadBlock = &scan->groupReadBlocks[group];
+
+		if (!AppendOnlyExecutorReadBlock_GetBlockInfo(
+										&scan->storageRead,
+										groupReadBlock,
+										false) ||
+			!IsColumnGroupBlockKind(groupReadBlock->executorBlockKind) ||
+			groupReadBlock->rowCount != firstReadBlock->rowCount)
+			ereport(ERROR,
+					(errcode(ERRCODE_GP_INTERNAL_ERROR),
+					 errmsg("Missing block of column group %d for %d rows in append-only table",
+							group, firstReadBlock->rowCount),
+					 errdetail_appendonly_read_storage_content_header(&scan->storageRead),
+					 errcontext_appendonly_read_storage_block(&scan->storageRead)));
+
+		groupReadBlock->executorBlockKind =
+			(groupReadBlock->executorBlockKind == AoExecutorBlockKind_ColumnGroupVarBlock ?
+			 AoExecutorBlockKind_VarBlock : AoExecutorBlockKind_SingleRow);
+
+		if (scan->groupNeeded[group] && sampled)
+			AppendOnlyExecutorReadBlock_GetContents(groupReadBlock, true);
+		else
+			AppendOnlyStorageRead_SkipCurrentBlock(&scan->storageRead, false);
+	}
+
+	if (!sampled)
+		goto LABEL_START_GETNEXTCOLUMNGROUPBLOCKS;
+
+	scan->groupRowIndex = 0;
+
+	return true;
+}
+
+/*
+ * Get the next row of the blocks of the current row range of a relation
+ * with column groups, returns NULL when all of them were scanned.
+ *
+ * The columns of the groups not needed are set to null.
+ */
+static MemTuple
+AppendOnlyScanNextColumnGroupRow(
+	AppendOnlyScanDesc 	scan,
+	int 				nkeys,
+	ScanKey 			key,
+	TupleTableSlot 		*slot)
+{
+	AppendOnlyExecutorReadBlock *firstReadBlock = &scan->executorReadBlock;
+	AOTupleId  *aoTupleId = (AOTupleId *) &firstReadBlock->cdb_fake_ctid;
+
+	Assert(slot);
+
+	while (scan->groupRowIndex < firstReadBlock->rowCount)
+	{
+		Datum	   *values;
+		bool	   *isnull;
+		Oid			oid = InvalidOid;
+		MemTuple	tuple;
+		bool		valid = true;
+		int			group;
+
+		ExecClearTuple(slot);
+		values = slot_get_values(slot);
+		isnull = slot_get_isnull(slot);
+
+		for (group = 0; group < scan->numColumnGroups; group++)
+		{
+			AppendOnlyExecutorReadBlock *groupReadBlock = ColumnGroupReadBlock(scan, group);
+			int			firstAttr = group * scan->columnGroupSize;
+			MemTuple	groupTuple;
+			int			i;
+
+			if (!scan->groupNeeded[group])
+			{
+				for (i = firstAttr;
+					 i < Min(firstAttr + scan->columnGroupSize, RelationGetNumberOfAttributes(scan->aos_rd));
+					 i++)
+					isnull[i] = true;
+				continue;
+			}
+
+			if (groupReadBlock->executorBlockKind == AoExecutorBlockKind_VarBlock)
+			{
+				int		itemLen;
+
+				groupTuple = (MemTuple) VarBlockReaderGetNextItemPtr(
+												&groupReadBlock->varBlockReader,
+												&itemLen);
+			}
+			else
+				groupTuple = (MemTuple) groupReadBlock->singleRow;
+
+			if (groupTuple == NULL)
+				ereport(ERROR,
+						(errcode(ERRCODE_GP_INTERNAL_ERROR),
+						 errmsg("Block of column group %d has fewer than %d rows in append-only table",
+								group, firstReadBlock->rowCount),
+						 errcontext_appendonly_read_storage_block(&scan->storageRead)));
+
+			memtuple_deform(groupTuple, groupReadBlock->mt_bind,
+							values + firstAttr, isnull + firstAttr);
+
+			if (group == 0 && mtbind_has_oid(groupReadBlock->mt_bind))
+				oid = MemTupleGetOid(groupTuple, groupReadBlock->mt_bind);
+		}
+
+		AOTupleIdInit_Init(aoTupleId);
+		AOTupleIdInit_segmentFileNum(aoTupleId, firstReadBlock->segmentFileNum);
+		AOTupleIdInit_rowNum(aoTupleId, firstReadBlock->blockFirstRowNum + scan->groupRowIndex);
+
+		scan->groupRowIndex++;
+		firstReadBlock->totalRowsScannned++;
+
+		ExecStoreVirtualTuple(slot);
+		tuple = ExecFetchSlotMemTuple(slot, false);
+		if (OidIsValid(oid))
+			MemTupleSetOid(tuple, slot->tts_mt_bind, oid);
+
+		slot_set_ctid(slot, &firstReadBlock->cdb_fake_ctid);
+
+		if (key != NULL)
+			HeapKeyTestUsingSlot(slot, nkeys, key, valid);
+
+		if (valid)
+			return tuple;
+	}
+
+	AppendOnlyExecutionReadBlock_FinishedScanBlock(firstReadBlock);
+
+	return NULL;
+}
+
 
 /* ----------------
  *		appendonlygettup - fetch next heap tuple
@@ -1235,7 +1570,8 @@ appendonlygettup(AppendOnlyScanDesc scan,
 			 * successfully get a block to process, or finished reading
 			 * all the data (all 'segment' files) for this relation.
 			 */
-			while(!getNextBlock(scan))
+			while(scan->numColumnGroups > 1 ?
+				  !getNextColumnGroupBlocks(scan) : !getNextBlock(scan))
 			{
 				/* have we read all this relation's data. done! */
 				if(scan->aos_done_all_splits)
@@ -1245,7 +1581,14 @@ appendonlygettup(AppendOnlyScanDesc scan,
 			scan->bufferDone = false;
 		}
 
-		tuple = AppendOnlyExecutorReadBlock_ScanNextTuple(
+		if (scan->numColumnGroups > 1)
+			tuple = AppendOnlyScanNextColumnGroupRow(
+												scan,
+												nkeys,
+												key,
+												slot);
+		else
+			tuple = AppendOnlyExecutorReadBlock_ScanNextTuple(
 												&scan->executorReadBlock,
 												nkeys,
 												key,
@@ -1422,18 +1765,268 @@ finishWriteBlock(AppendOnlyInsertDesc aoInsertDesc)
 	Assert(!AppendOnlyStorageWrite_IsBufferAllocated(&aoInsertDesc->storageWrite));
 }
 
+/*
+ * Set up the VarBlocks and the memtuple bindings of the column groups.
+ */
+static void
+initColumnGroupWrite(AppendOnlyInsertDesc aoInsertDesc)
+{
+	TupleDesc	tupleDesc = RelationGetDescr(aoInsertDesc->aoi_rel);
+	int			group;
+
+	/*
+	 * Each group is formed into a memtuple of its own, that needs the
+	 * layout of the aligned memtuples.
+	 */
+	if (!IsAOBlockAndMemtupleAlignmentFixed(aoInsertDesc->storageAttributes.version))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("column groups are not supported by version %d of append-only table \"%s\"",
+						aoInsertDesc->storageAttributes.version,
+						RelationGetRelationName(aoInsertDesc->aoi_rel))));
+
+	aoInsertDesc->columnGroups = (AppendOnlyColumnGroupWrite *)
+		palloc0(aoInsertDesc->numColumnGroups * sizeof(AppendOnlyColumnGroupWrite));
+	aoInsertDesc->groupValues = (Datum *) palloc(tupleDesc->natts * sizeof(Datum));
+	aoInsertDesc->groupIsnull = (bool *) palloc(tupleDesc->natts * sizeof(bool));
+
+	for (group = 0; group < aoInsertDesc->numColumnGroups; group++)
+	{
+		AppendOnlyColumnGroupWrite *groupWrite = &aoInsertDesc->columnGroups[group];
+
+		groupWrite->mt_bind = create_memtuple_binding(
+			ColumnGroupTupleDesc(tupleDesc, aoInsertDesc->columnGroupSize, group));
+		groupWrite->buffer = (uint8 *) palloc(aoInsertDesc->usableBlockSize * sizeof(uint8));
+		groupWrite->tempSpace = (uint8 *) palloc(aoInsertDesc->tempSpaceLen * sizeof(uint8));
+		groupWrite->tupleBufLen = aoInsertDesc->maxDataLen;
+		groupWrite->tupleBuf = (uint8 *) palloc(groupWrite->tupleBufLen * sizeof(uint8));
+
+		VarBlockMakerInit(&groupWrite->varBlockMaker,
+						  groupWrite->buffer,
+						  aoInsertDesc->maxDataLen,
+						  groupWrite->tempSpace,
+						  aoInsertDesc->tempSpaceLen);
+	}
+}
+
+/*
+ * Write the VarBlocks of the column groups one after the other, and start
+ * new ones.
+ */
+static void
+finishWriteColumnGroupBlocks(AppendOnlyInsertDesc aoInsertDesc)
+{
+	int64	rangeLen;
+	int		group;
+
+	if (VarBlockMakerItemCount(&aoInsertDesc->columnGroups[0].varBlockMaker) == 0)
+		return;
+
+	/*
+	 * Keep the blocks of the row range in one split when they fit, so the
+	 * scan of the split does not read past its end.
+	 */
+	rangeLen = (int64) aoInsertDesc->numColumnGroups * aoInsertDesc->usableBlockSize;
+	if (rangeLen <= aoInsertDesc->storageAttributes.splitsize)
+		AppendOnlyStorageWrite_PadOutForSplit(&aoInsertDesc->storageWrite, (int32) rangeLen);
+
+	for (group = 0; group < aoInsertDesc->numColumnGroups; group++)
+	{
+		AppendOnlyColumnGroupWrite *groupWrite = &aoInsertDesc->columnGroups[group];
+		int		executorBlockKind = AoExecutorBlockKind_VarBlock;
+		int		itemCount;
+		int32	dataLen;
+
+		itemCount = VarBlockMakerItemCount(&groupWrite->varBlockMaker);
+		dataLen = VarBlockMakerFinish(&groupWrite->varBlockMaker);
+
+		if (itemCount == 1)
+		{
+			dataLen = VarBlockCollapseToSingleItem(
+						   /* target */ groupWrite->buffer,
+					       /* source */ groupWrite->buffer,
+					       /* sourceLen */ dataLen);
+			executorBlockKind = AoExecutorBlockKind_SingleRow;
+		}
+
+		AppendOnlyStorageWrite_Content(
+							&aoInsertDesc->storageWrite,
+							groupWrite->buffer,
+							dataLen,
+							ColumnGroupBlockKind(executorBlockKind, group),
+							itemCount);
+
+		VarBlockMakerReset(&groupWrite->varBlockMaker);
+
+		if (Debug_appendonly_print_insert)
+			elog(LOG,
+			     "Append-only insert finished block of column group %d for table '%s' "
+			     "(length = %d, item count %d)",
+			     group,
+			     NameStr(aoInsertDesc->aoi_rel->rd_rel->relname),
+			     dataLen,
+			     itemCount);
+	}
+
+	aoInsertDesc->varblockCount += aoInsertDesc->numColumnGroups;
+	aoInsertDesc->bufferCount += aoInsertDesc->numColumnGroups;
+}
+
+/*
+ * Insert a row into the VarBlocks of the column groups, one memtuple per
+ * group. Returns true if the row was too large for a VarBlock and was
+ * written as a large content per group.
+ */
+static bool
+insertColumnGroupsRow(AppendOnlyInsertDesc aoInsertDesc, MemTuple tup)
+{
+	int		numColumnGroups = aoInsertDesc->numColumnGroups;
+	bool	fits = true;
+	bool	retried = false;
+	int		group;
+
+	memtuple_deform(tup, aoInsertDesc->mt_bind,
+					aoInsertDesc->groupValues, aoInsertDesc->groupIsnull);
+
+	for (group = 0; group < numColumnGroups; group++)
+	{
+		AppendOnlyColumnGroupWrite *groupWrite = &aoInsertDesc->columnGroups[group];
+		int		firstAttr = group * aoInsertDesc->columnGroupSize;
+
+		groupWrite->tupleLen = groupWrite->tupleBufLen;
+		groupWrite->tuple = memtuple_form_to(groupWrite->mt_bind,
+											 aoInsertDesc->groupValues + firstAttr,
+											 aoInsertDesc->groupIsnull + firstAttr,
+											 (MemTuple) groupWrite->tupleBuf,
+											 &groupWrite->tupleLen,
+											 false);
+		if (groupWrite->tuple == NULL)
+		{
+			/* larger than a VarBlock, tupleLen is its length */
+			groupWrite->tuple = memtuple_form_to(groupWrite->mt_bind,
+												 aoInsertDesc->groupValues + firstAttr,
+												 aoInsertDesc->groupIsnull + firstAttr,
+												 (MemTuple) palloc(groupWrite->tupleLen),
+												 &groupWrite->tupleLen,
+												 false);
+		}
+	}
+
+	if (mtbind_has_oid(aoInsertDesc->mt_bind))
+		MemTupleSetOid(aoInsertDesc->columnGroups[0].tuple,
+					   aoInsertDesc->columnGroups[0].mt_bind,
+					   MemTupleGetOid(tup, aoInsertDesc->mt_bind));
+
+	/*
+	 * The row goes into the current VarBlocks if it fits in all of them,
+	 * otherwise they are written out first.
+	 */
+	for (;;)
+	{
+		fits = (VarBlockMakerItemCount(&aoInsertDesc->columnGroups[0].varBlockMaker) <
+				AOSmallContentHeader_MaxRowCount);
+		for (group = 0; group < numColumnGroups && fits; group++)
+		{
+			AppendOnlyColumnGroupWrite *groupWrite = &aoInsertDesc->columnGroups[group];
+
+			fits = VarBlockMakerItemFits(&groupWrite->varBlockMaker, groupWrite->tupleLen);
+		}
+
+		if (fits || retried ||
+			VarBlockMakerItemCount(&aoInsertDesc->columnGroups[0].varBlockMaker) == 0)
+			break;
+
+		finishWriteColumnGroupBlocks(aoInsertDesc);
+		retried = true;
+	}
+
+	if (!fits)
+	{
+		if (!aoInsertDesc->useNoToast)
+			ereport(ERROR,
+					(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+					 errmsg("Item too long: column group %d length %d, maxBufferLen %d",
+					        group - 1, aoInsertDesc->columnGroups[group - 1].tupleLen,
+							aoInsertDesc->columnGroups[group - 1].varBlockMaker.maxBufferLen),
+					 errcontext_appendonly_insert_block_user_limit(aoInsertDesc)));
+	}
+
+	/*
+	 * Copy the row into the VarBlocks, or write it as one large content per
+	 * group.
+	 */
+	for (group = 0; group < numColumnGroups; group++)
+	{
+		AppendOnlyColumnGroupWrite *groupWrite = &aoInsertDesc->columnGroups[group];
+
+		if (fits)
+		{
+			uint8  *itemPtr;
+
+			itemPtr = VarBlockMakerGetNextItemPtr(&groupWrite->varBlockMaker,
+												  groupWrite->tupleLen);
+			Assert(itemPtr != NULL);
+			if (groupWrite->tupleLen > 0)
+				memcpy(itemPtr, groupWrite->tuple, groupWrite->tupleLen);
+		}
+		else
+			AppendOnlyStorageWrite_Content(
+								&aoInsertDesc->storageWrite,
+								(uint8 *) groupWrite->tuple,
+								groupWrite->tupleLen,
+								ColumnGroupBlockKind(AoExecutorBlockKind_SingleRow, group),
+								/* rowCount */ 1);
+
+		if ((uint8 *) groupWrite->tuple != groupWrite->tupleBuf)
+			pfree(groupWrite->tuple);
+		groupWrite->tuple = NULL;
+	}
+
+	return !fits;
+}
+
 /* ----------------------------------------------------------------
  *					 append-only access method interface
  * ----------------------------------------------------------------
  */
 
 
+/*
+ * Free the read blocks of the scan, with the tuple descriptors of the column
+ * groups.
+ */
+static void
+finishReadBlocks(AppendOnlyScanDesc scan)
+{
+	int		group;
+
+	for (group = 0; group < scan->numColumnGroups; group++)
+	{
+		AppendOnlyExecutorReadBlock *groupReadBlock = ColumnGroupReadBlock(scan, group);
+
+		if (scan->numColumnGroups > 1 && groupReadBlock->mt_bind != NULL)
+		{
+			TupleDesc	groupDesc = groupReadBlock->mt_bind->tupdesc;
+
+			AppendOnlyExecutorReadBlock_Finish(groupReadBlock);
+			FreeTupleDesc(groupDesc);
+		}
+		else
+			AppendOnlyExecutorReadBlock_Finish(groupReadBlock);
+	}
+}
+
 /* ----------------
  *		appendonly_beginscan	- begin relation scan
+ *
+ * proj, if not NULL, has the columns the scan needs. With column groups,
+ * only the groups of these columns are read and the other columns of the
+ * returned rows are null.
  * ----------------
  */
 AppendOnlyScanDesc
-appendonly_beginscan(Relation relation, Snapshot appendOnlyMetaDataSnapshot, int nkeys, ScanKey key)
+appendonly_beginscan(Relation relation, Snapshot appendOnlyMetaDataSnapshot, int nkeys, ScanKey key,
+					 bool *proj)
 {
 	AppendOnlyScanDesc	scan;
 	AppendOnlyEntry		*aoentry;
@@ -1526,6 +2119,33 @@ appendonly_beginscan(Relation relation, Snapshot appendOnlyMetaDataSnapshot, int
 					scan->usableBlockSize -
 	 				AppendOnlyStorageFormat_RegularHeaderLenNeeded(scan->storageAttributes.checksum);
 
+	/*
+	 * Find the column groups to read. None are needed when no column is, as
+	 * for count(*), the rows are then only counted.
+	 */
+	scan->columnGroupSize = RelationGetColumnGroupSize(relation);
+	scan->numColumnGroups = AppendOnlyColumnGroupCount(RelationGetNumberOfAttributes(relation),
+													   scan->columnGroupSize);
+	if (scan->numColumnGroups > 1)
+	{
+		int		i;
+
+		scan->groupNeeded = (bool *) palloc0(scan->numColumnGroups * sizeof(bool));
+		for (i = 0; i < RelationGetNumberOfAttributes(relation); i++)
+		{
+			if (proj == NULL || proj[i])
+				scan->groupNeeded[i / scan->columnGroupSize] = true;
+		}
+
+		/* the oid is in the first group */
+		if (relation->rd_rel->relhasoids)
+			scan->groupNeeded[0] = true;
+
+		/* the first entry is unused, executorReadBlock has the first group */
+		scan->groupReadBlocks = (AppendOnlyExecutorReadBlock *)
+			palloc0(scan->numColumnGroups * sizeof(AppendOnlyExecutorReadBlock));
+	}
+
 
 	/*
 	 * we do this here instead of in initscan() because appendonly_rescan also calls
@@ -1562,7 +2182,7 @@ appendonly_rescan(AppendOnlyScanDesc scan,
 
 	scan->initedStorageRoutines = false;
 
-	AppendOnlyExecutorReadBlock_Finish(&scan->executorReadBlock);
+	finishReadBlocks(scan);
 
 	scan->aos_need_new_split = true;
 
@@ -1591,7 +2211,12 @@ appendonly_endscan(AppendOnlyScanDesc scan)
 
 	scan->initedStorageRoutines = false;
 
-	AppendOnlyExecutorReadBlock_Finish(&scan->executorReadBlock);
+	finishReadBlocks(scan);
+
+	if (scan->groupNeeded)
+		pfree(scan->groupNeeded);
+	if (scan->groupReadBlocks)
+		pfree(scan->groupReadBlocks);
 
 	pfree(scan->aos_filenamepath);
 
@@ -1806,7 +2431,13 @@ appendonly_insert_init(Relation rel, ResultRelSegFileInfo *segfileinfo)
 	Assert(!ItemPointerIsValid(&aoInsertDesc->fsInfo->sequence_tid));
 	Assert(aoInsertDesc->fsInfo->segno == segfileinfo->segno);
 
-	setupNextWriteBlock(aoInsertDesc);
+	aoInsertDesc->columnGroupSize = RelationGetColumnGroupSize(rel);
+	aoInsertDesc->numColumnGroups = AppendOnlyColumnGroupCount(RelationGetNumberOfAttributes(rel),
+															   aoInsertDesc->columnGroupSize);
+	if (aoInsertDesc->numColumnGroups > 1)
+		initColumnGroupWrite(aoInsertDesc);
+	else
+		setupNextWriteBlock(aoInsertDesc);
 
 	return aoInsertDesc;
 }
@@ -1911,67 +2542,29 @@ appendonly_insert_init(Relation rel, ResultRelSegFileInfo *segfileinfo)
 	itemLen = memtuple_get_size(tup, aoInsertDesc->mt_bind);
 	isLargeContent = false;
 
-	/*
-	 * If we are at the limit for append-only storage header's row count,
-	 * force this VarBlock to finish.
-	 */
-	if (VarBlockMakerItemCount(&aoInsertDesc->varBlockMaker) >= AOSmallContentHeader_MaxRowCount)
-		itemPtr = NULL;
+	if (aoInsertDesc->numColumnGroups > 1)
+		isLargeContent = insertColumnGroupsRow(aoInsertDesc, tup);
 	else
-		itemPtr = VarBlockMakerGetNextItemPtr(&aoInsertDesc->varBlockMaker, itemLen);
-
-	/*
-	 * If no more room to place items in the current varblock
-	 * finish it and start inserting into the next one.
-	 */
-	if (itemPtr == NULL)
 	{
-		if (VarBlockMakerItemCount(&aoInsertDesc->varBlockMaker) == 0)
-		{
-			/*
-			 * Case #1.  The entire tuple cannot fit within a VarBlock.  It is too large.
-			 */
-			if (aoInsertDesc->useNoToast)
-			{
-				/*
-				 * Indicate we need to write the large tuple as a large content
-				 * multiple-block set.
-				 */
-				isLargeContent = true;
-			}
-			else
-			{
-				/*
-				 * Use a different errcontext when user input (tuple contents) cause the
-				 * error.
-				 */
-				ereport(ERROR,
-						(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
-						 errmsg("Item too long (check #1): length %d, maxBufferLen %d",
-						        itemLen, aoInsertDesc->varBlockMaker.maxBufferLen),
-						 errcontext_appendonly_insert_block_user_limit(aoInsertDesc)));
-			}
-		}
+		/*
+		 * If we are at the limit for append-only storage header's row count,
+		 * force this VarBlock to finish.
+		 */
+		if (VarBlockMakerItemCount(&aoInsertDesc->varBlockMaker) >= AOSmallContentHeader_MaxRowCount)
+			itemPtr = NULL;
 		else
-		{
-			/*
-			 * Write out the current VarBlock to make room.
-			 */
-			finishWriteBlock(aoInsertDesc);
-			Assert(aoInsertDesc->nonCompressedData == NULL);
-			Assert(!AppendOnlyStorageWrite_IsBufferAllocated(&aoInsertDesc->storageWrite));
-
-			/*
-			 * Setup a new VarBlock.
-			 */
-			setupNextWriteBlock(aoInsertDesc);
-
 			itemPtr = VarBlockMakerGetNextItemPtr(&aoInsertDesc->varBlockMaker, itemLen);
 
-			if (itemPtr == NULL)
+		/*
+		 * If no more room to place items in the current varblock
+		 * finish it and start inserting into the next one.
+		 */
+		if (itemPtr == NULL)
+		{
+			if (VarBlockMakerItemCount(&aoInsertDesc->varBlockMaker) == 0)
 			{
 				/*
-				 * Case #2.  The entire tuple cannot fit within a VarBlock.  It is too large.
+				 * Case #1.  The entire tuple cannot fit within a VarBlock.  It is too large.
 				 */
 				if (aoInsertDesc->useNoToast)
 				{
@@ -1989,54 +2582,97 @@ appendonly_insert_init(Relation rel, ResultRelSegFileInfo *segfileinfo)
 					 */
 					ereport(ERROR,
 							(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
-							 errmsg("Item too long (check #2): length %d, maxBufferLen %d",
+							 errmsg("Item too long (check #1): length %d, maxBufferLen %d",
 							        itemLen, aoInsertDesc->varBlockMaker.maxBufferLen),
 							 errcontext_appendonly_insert_block_user_limit(aoInsertDesc)));
 				}
 			}
-		}
+			else
+			{
+				/*
+				 * Write out the current VarBlock to make room.
+				 */
+				finishWriteBlock(aoInsertDesc);
+				Assert(aoInsertDesc->nonCompressedData == NULL);
+				Assert(!AppendOnlyStorageWrite_IsBufferAllocated(&aoInsertDesc->storageWrite));
 
-	}
+				/*
+				 * Setup a new VarBlock.
+				 */
+				setupNextWriteBlock(aoInsertDesc);
 
-	if (!isLargeContent)
-	{
-		/*
-		 * We have room in the current VarBlock for the new tuple.
-		 */
-		Assert(itemPtr != NULL);
+				itemPtr = VarBlockMakerGetNextItemPtr(&aoInsertDesc->varBlockMaker, itemLen);
 
-		if (itemLen > 0)
-			memcpy(itemPtr, tup, itemLen);
-	}
-	else
-	{
-		/*
-		 * Write the large tuple as a large content multiple-block set.
-		 */
-		Assert(itemPtr == NULL);
-		Assert(!need_toast);
-		Assert(instup == tup);
+				if (itemPtr == NULL)
+				{
+					/*
+					 * Case #2.  The entire tuple cannot fit within a VarBlock.  It is too large.
+					 */
+					if (aoInsertDesc->useNoToast)
+					{
+						/*
+						 * Indicate we need to write the large tuple as a large content
+						 * multiple-block set.
+						 */
+						isLargeContent = true;
+					}
+					else
+					{
+						/*
+						 * Use a different errcontext when user input (tuple contents) cause the
+						 * error.
+						 */
+						ereport(ERROR,
+								(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+								 errmsg("Item too long (check #2): length %d, maxBufferLen %d",
+								        itemLen, aoInsertDesc->varBlockMaker.maxBufferLen),
+								 errcontext_appendonly_insert_block_user_limit(aoInsertDesc)));
+					}
+				}
+			}
 
-		/*
-		 * "Cancel" the last block allocation, if one.
-		 */
-		cancelLastBuffer(aoInsertDesc);
-		Assert(aoInsertDesc->nonCompressedData == NULL);
-		Assert(!AppendOnlyStorageWrite_IsBufferAllocated(&aoInsertDesc->storageWrite));
+		}
 
-		/*
-		 * Write large content.
-		 */
-		AppendOnlyStorageWrite_Content(
-							&aoInsertDesc->storageWrite,
-							(uint8*)tup,
-							itemLen,
-							AoExecutorBlockKind_SingleRow,
-							/* rowCount */ 1);
-		Assert(aoInsertDesc->nonCompressedData == NULL);
-		Assert(!AppendOnlyStorageWrite_IsBufferAllocated(&aoInsertDesc->storageWrite));
+		if (!isLargeContent)
+		{
+			/*
+			 * We have room in the current VarBlock for the new tuple.
+			 */
+			Assert(itemPtr != NULL);
 
-		setupNextWriteBlock(aoInsertDesc);
+			if (itemLen > 0)
+				memcpy(itemPtr, tup, itemLen);
+		}
+		else
+		{
+			/*
+			 * Write the large tuple as a large content multiple-block set.
+			 */
+			Assert(itemPtr == NULL);
+			Assert(!need_toast);
+			Assert(instup == tup);
+
+			/*
+			 * "Cancel" the last block allocation, if one.
+			 */
+			cancelLastBuffer(aoInsertDesc);
+			Assert(aoInsertDesc->nonCompressedData == NULL);
+			Assert(!AppendOnlyStorageWrite_IsBufferAllocated(&aoInsertDesc->storageWrite));
+
+			/*
+			 * Write large content.
+			 */
+			AppendOnlyStorageWrite_Content(
+								&aoInsertDesc->storageWrite,
+								(uint8*)tup,
+								itemLen,
+								AoExecutorBlockKind_SingleRow,
+								/* rowCount */ 1);
+			Assert(aoInsertDesc->nonCompressedData == NULL);
+			Assert(!AppendOnlyStorageWrite_IsBufferAllocated(&aoInsertDesc->storageWrite));
+
+			setupNextWriteBlock(aoInsertDesc);
+		}
 	}
 
 	aoInsertDesc->insertCount++;
@@ -2074,7 +2710,10 @@ appendonly_insert_finish(AppendOnlyInsertDesc aoInsertDesc)
 	/*
 	 * Finish up that last varblock.
 	 */
-	finishWriteBlock(aoInsertDesc);
+	if (aoInsertDesc->numColumnGroups > 1)
+		finishWriteColumnGroupBlocks(aoInsertDesc);
+	else
+		finishWriteBlock(aoInsertDesc);
 
 	CloseWritableFileSeg(aoInsertDesc);
 
@@ -34,6 +34,7 @@
 #include "access/appendonlytid.h"	  /* AOTupleId_MaxRowNum  */
 #include "access/orcsegfiles.h"
 #include "access/parquetsegfiles.h"
+#include "access/read_cache.h"
 #include "access/heapam.h"			  /* heap_open            */
 #include "access/transam.h"			  /* InvalidTransactionId */
 #include "utils/lsyscache.h"
@@ -47,6 +48,7 @@
 #include "cdb/cdbdisp.h"
 #include "cdb/cdbfilesystemcredential.h"
 
+#include "utils/atomic.h"
 #include "utils/builtins.h"
 #include "utils/tqual.h"
 #include "funcapi.h"
@@ -70,6 +72,35 @@ static HTAB *AppendOnlyHash;			/* Hash of AO tables */
 AppendOnlyWriterData	*AppendOnlyWriter;
 AOSegfileStatus *AOSegfileStatusPool;
 
+/*
+ * Segment file version slots changed by the current transaction, one bit per
+ * slot. They are bumped when the transaction ends.
+ */
+static uint64 SegfileVersionsTouched[AOSEG_VERSION_SLOTS / 64];
+static bool SegfileVersionsTouchedAny = false;
+
+/*
+ * Locking of the append only writer hash table.
+ *
+ * AOSegFileLock protects the hash table itself, the segment file status pool
+ * and the counters in AppendOnlyWriter. The contents of a hash entry and of
+ * the segment file statuses chained to it may be changed either by holding
+ * AOSegFileLock exclusively, or by holding it shared together with the
+ * partition lock of the relation exclusively. Writers of different relations
+ * therefore don't wait for each other unless one of them needs to add an
+ * entry or take segment file statuses from the pool. AOSegFileLock is always
+ * taken before the partition lock.
+ */
+#define AORelPartitionLock(relid) \
+	((LWLockId) (FirstAOSegFileLock + ((uint32) (relid) % NUM_AOSEGFILE_PARTITIONS)))
+
+/*
+ * Append only relations whose hash entries the current transaction may have
+ * changed, so that the end of transaction processing doesn't have to visit
+ * the whole hash table.
+ */
+static HTAB *AppendOnlyRelsInXact = NULL;
+
 /*
  * local functions
  */
@@ -77,6 +108,13 @@ static bool AOHashTableInit(void);
 static AORelHashEntry AppendOnlyRelHashNew(Oid relid, bool *exists);
 static AORelHashEntry AORelGetHashEntry(Oid relid);
 static AORelHashEntry AORelLookupHashEntry(Oid relid);
+static void AORelBumpSegfileVersion(int slot, TransactionId xid);
+static void AORelForgetSegfileChanges(void);
+static void AORelLockHashEntry(Oid relid, bool exclusive);
+static void AORelUnlockHashEntry(Oid relid, bool exclusive);
+static void AORelRememberInXact(Oid relid);
+static void AORelPrecheckSegfiles(Oid relid, int segment_num, bool reuse_segfilenum_in_same_xid);
+static bool CheckSegFileForWrite(Oid relid, int segno);
 static bool AORelCreateHashEntry(Oid relid);
 static int AORelGetSegfileStatus(AORelHashEntry currentEntry);
 static void AORelPutSegfileStatus(int old_status);
@@ -235,6 +273,8 @@ InitAppendOnlyWriter(void)
 
 	/* Specify that we have no AO rel information yet. */
 	AppendOnlyWriter->num_existing_aorels = 0;
+	MemSet(AppendOnlyWriter->segfile_versions, 0,
+		   sizeof(AppendOnlyWriter->segfile_versions));
 
 	/* Create AppendOnlyHash (empty at this point). */
 	ok = AOHashTableInit();
@@ -409,6 +449,7 @@ AORelCreateHashEntry(Oid relid)
 	aoHashEntry->head_rel_segfile.latestWriteXid = InvalidTransactionId;
 	aoHashEntry->head_rel_segfile.isfull = true;
 	aoHashEntry->head_rel_segfile.needCheck = true;
+	aoHashEntry->head_rel_segfile.checkGeneration = 0;
 	aoHashEntry->head_rel_segfile.tupcount = 0;
 	aoHashEntry->head_rel_segfile.tupsadded = 0;
 	aoHashEntry->max_seg_no = 0;
@@ -441,6 +482,7 @@ AORelCreateHashEntry(Oid relid)
 			status->inuse = false;
 			status->isfull = false;
             status->needCheck = true;
+			status->checkGeneration = 0;
 			status->latestWriteXid = InvalidTransactionId;
 			status->xid = InvalidTransactionId;
 			status->tupsadded = 0;
@@ -478,6 +520,7 @@ AORelCreateHashEntry(Oid relid)
 			status->inuse = false;
 			status->isfull = false;
             status->needCheck = true;
+			status->checkGeneration = 0;
 			status->latestWriteXid = InvalidTransactionId;
 			status->xid = InvalidTransactionId;
 			status->tupsadded = 0;
@@ -513,8 +556,8 @@ AORelCreateHashEntry(Oid relid)
  * AORelRemoveEntry -- remove the hash entry for a given relation.
  *
  * Notes
- *	The append only lightweight lock (AOSegFileLock) *must* be held for
- *	this operation.
+ *	The append only lightweight lock (AOSegFileLock) *must* be held
+ *	exclusively for this operation.
  */
 bool
 AORelRemoveHashEntry(Oid relid, bool checkIsStale)
@@ -575,6 +618,8 @@ AORelRemoveHashEntryOnCommit(Oid relid)
 
     Insist(Gp_role == GP_ROLE_DISPATCH);
 
+    ReadCacheHashEntryReviseOnCommit(relid, false);
+
     if (NULL == AppendOnlyHashEntryPendingDeleteCleanup)
     {
         HASHCTL         info;
@@ -611,6 +656,8 @@ AORelRemoveHashEntryOnCommit(Oid relid)
 
     node->relid = relid;
 
+    AORelRememberInXact(relid);
+
     LWLockAcquire(AOSegFileLock, LW_EXCLUSIVE);
 
     /*
@@ -696,6 +743,60 @@ AORelGetHashEntry(Oid relid)
 	return (AORelHashEntry) aoentry;
 }
 
+/*
+ * AORelLockHashEntry -- lock the hash entry of a relation for changes.
+ *
+ * In exclusive mode AOSegFileLock is taken exclusively, which is needed to
+ * add or remove hash entries and segment file statuses. Otherwise AOSegFileLock
+ * is taken shared and the partition lock of the relation exclusively.
+ */
+static void
+AORelLockHashEntry(Oid relid, bool exclusive)
+{
+	if (exclusive)
+	{
+		LWLockAcquire(AOSegFileLock, LW_EXCLUSIVE);
+	}
+	else
+	{
+		LWLockAcquire(AOSegFileLock, LW_SHARED);
+		LWLockAcquire(AORelPartitionLock(relid), LW_EXCLUSIVE);
+	}
+}
+
+static void
+AORelUnlockHashEntry(Oid relid, bool exclusive)
+{
+	if (!exclusive)
+		LWLockRelease(AORelPartitionLock(relid));
+	LWLockRelease(AOSegFileLock);
+}
+
+/*
+ * AORelRememberInXact -- note that the current transaction may change the
+ *						  hash entry of a relation.
+ */
+static void
+AORelRememberInXact(Oid relid)
+{
+	if (NULL == AppendOnlyRelsInXact)
+	{
+		HASHCTL		info;
+
+		MemSet(&info, 0, sizeof(info));
+		info.keysize = sizeof(Oid);
+		info.entrysize = sizeof(Oid);
+		info.hash = oid_hash;
+
+		AppendOnlyRelsInXact = hash_create("AppendOnlyRelsInXact",
+										   16,
+										   &info,
+										   HASH_ELEM | HASH_FUNCTION);
+	}
+
+	hash_search(AppendOnlyRelsInXact, (void *) &relid, HASH_ENTER, NULL);
+}
+
 /*
  * AppendOnlyRelHashNew -- return a new (empty) aorel hash object to initialize.
  *
@@ -962,6 +1063,88 @@ addCandidateSegno(AOSegfileStatus **maxSegno4Seg, int segment_num, AOSegfileStat
 	return remaining_num;
 }
 
+/*
+ * AORelPrecheckSegfiles
+ *
+ * Check the segment files SetSegnoForWrite is likely to pick that still need
+ * CheckSegFileForWrite, without holding any lock: the check reads the catalog
+ * and asks the file system for the file length, and would otherwise hold up
+ * every writer of the partition meanwhile. The result is applied only if
+ * nobody started using or rechecking the segment file in the meantime, so
+ * SetSegnoForWrite simply falls back to checking under the lock otherwise.
+ */
+static void
+AORelPrecheckSegfiles(Oid relid, int segment_num, bool reuse_segfilenum_in_same_xid)
+{
+	TransactionId	CurrentXid = GetTopTransactionId();
+	AORelHashEntry	aoentry;
+	AOSegfileStatus *segfilestatus;
+	int			   *segnos;
+	uint32		   *generations;
+	bool		   *results;
+	int				ncandidates = 0;
+	int				next;
+	int				i;
+
+	segnos = palloc(sizeof(int) * segment_num);
+	generations = palloc(sizeof(uint32) * segment_num);
+	results = palloc(sizeof(bool) * segment_num);
+
+	AORelLockHashEntry(relid, false);
+	aoentry = AORelLookupHashEntry(relid);
+	if (aoentry != NULL)
+	{
+		segfilestatus = &(aoentry->head_rel_segfile);
+		do
+		{
+			if (!segfilestatus->isfull && segfilestatus->needCheck &&
+				((segfilestatus->xid == CurrentXid && reuse_segfilenum_in_same_xid) ||
+				 (!segfilestatus->inuse && !usedByConcurrentTransaction(segfilestatus))))
+			{
+				segnos[ncandidates] = segfilestatus->segno;
+				generations[ncandidates] = segfilestatus->checkGeneration;
+				ncandidates++;
+			}
+			next = segfilestatus->next;
+			if (next == NEXT_END_OF_LIST)
+			{
+				break;
+			}
+			segfilestatus = &AOSegfileStatusPool[next];
+		} while (ncandidates < segment_num);
+	}
+	AORelUnlockHashEntry(relid, false);
+
+	if (ncandidates > 0)
+	{
+		for (i = 0; i < ncandidates; i++)
+			results[i] = CheckSegFileForWrite(relid, segnos[i]);
+
+		AORelLockHashEntry(relid, false);
+		aoentry = AORelLookupHashEntry(relid);
+		for (i = 0; aoentry != NULL && i < ncandidates; i++)
+		{
+			segfilestatus = AORelLookupSegfileStatus(segnos[i], aoentry);
+			if (segfilestatus == NULL || !segfilestatus->needCheck ||
+				(segfilestatus->inuse && segfilestatus->xid != CurrentXid) ||
+				segfilestatus->checkGeneration != generations[i])
+				continue;
+
+			if (!results[i])
+			{
+				segfilestatus->inuse = true;
+				segfilestatus->xid = InvalidTransactionId;
+			}
+			segfilestatus->needCheck = false;
+		}
+		AORelUnlockHashEntry(relid, false);
+	}
+
+	pfree(segnos);
+	pfree(generations);
+	pfree(results);
+}
+
 /*
  * SetSegnoForWrite
  *
@@ -1000,6 +1183,7 @@ List *SetSegnoForWrite(List *existing_segnos, Oid relid, int segment_num,
     AOSegfileStatus *segfilestatus = NULL;
     int remaining_num = segment_num;
     bool has_same_txn_status = false;
+    bool exclusive = false;
     AOSegfileStatus **maxSegno4Segment = NULL;
 
     switch(Gp_role)
@@ -1021,6 +1205,10 @@ List *SetSegnoForWrite(List *existing_segnos, Oid relid, int segment_num,
             Assert(existing_segnos == NIL);
             Assert(segment_num > 0);
 
+            /* the cached results of the relation are out of date */
+            if (OidIsValid(relid))
+                ReadCacheHashEntryReviseOnCommit(relid, false);
+
             if (forNewRel)
             {
                 int i;
@@ -1038,100 +1226,89 @@ List *SetSegnoForWrite(List *existing_segnos, Oid relid, int segment_num,
                                 get_rel_name(relid), relid)));
             }
 
-            LWLockAcquire(AOSegFileLock, LW_EXCLUSIVE);
-
             /*
-             * The most common case is likely the entry exists already.
+             * Remember the relation before touching its entry, so that the
+             * end of transaction processing releases whatever we pick even
+             * if we fail half way.
              */
-            aoentry = AORelLookupHashEntry(relid);
-            if (aoentry == NULL)
-            {
-                /*
-                 * We need to create a hash entry for this relation.
-                 *
-                 * However, we need to access the pg_appendonly system catalog
-                 * table, so AORelCreateHashEntry will carefully release the AOSegFileLock,
-                 * gather the information, and then re-acquire AOSegFileLock.
-                 */
-                if(!AORelCreateHashEntry(relid))
-                {
-                    LWLockRelease(AOSegFileLock);
-                    ereport(ERROR, (errmsg("can't have more than %d different append-only "
-                                    "tables open for writing data at the same time. "
-                                    "if tables are heavily partitioned or if your "
-                                    "workload requires, increase the value of "
-                                    "max_appendonly_tables and retry",
-                                    MaxAppendOnlyTables)));
-                }
-
-                /* get the hash entry for this relation (must exist) */
-                aoentry = AORelGetHashEntry(relid);
-            }
-            aoentry->txns_using_rel++;
-
-            if (Debug_appendonly_print_segfile_choice)
-            {
-                ereport(LOG, (errmsg("SetSegnoForWrite: got the hash entry for relation \"%s\" (%d). "
-                                "setting txns_using_rel to %d",
-                                get_rel_name(relid), relid,
-                                aoentry->txns_using_rel)));
-            }
+            AORelRememberInXact(relid);
 
             /*
-             * Now pick a segment that is not in use and is not over the
-             * allowed size threshold (90% full).
-             *
-             * However, if we already picked a segno for a previous statement
-             * in this very same transaction we are still in (explicit txn) we
-             * pick the same one to insert into it again.
+             * Ask the file system about the segment files we are likely to
+             * pick while holding no lock, see AORelPrecheckSegfiles.
              */
+            AORelPrecheckSegfiles(relid, segment_num, reuse_segfilenum_in_same_xid);
 
-            /* We go through the open segfile status first to check
-             * whether are some in the same txn.
-             */
             maxSegno4Segment = palloc0(sizeof(struct AOSegfileStatus*)*segment_num);
-            segfilestatus = &(aoentry->head_rel_segfile);
-            do
+
+            /*
+             * Try to pick the segment files holding only the partition lock of
+             * the relation. Creating the hash entry of the relation or adding
+             * segment files to it needs AOSegFileLock exclusively, so start
+             * over in that mode if we have to.
+             */
+            for (;;)
             {
-                if (!segfilestatus->isfull)
+                AORelLockHashEntry(relid, exclusive);
+
+                /*
+                 * The most common case is likely the entry exists already.
+                 */
+                aoentry = AORelLookupHashEntry(relid);
+                if (aoentry == NULL)
                 {
-                    if (segfilestatus->xid == CurrentXid && reuse_segfilenum_in_same_xid)
+                    if (!exclusive)
                     {
-                        has_same_txn_status = true;
-                        if(CheckSegFileForWriteIfNeeded(aoentry, segfilestatus)){
-                            remaining_num = addCandidateSegno(maxSegno4Segment, segment_num, segfilestatus, keepHash);
-                        }
+                        AORelUnlockHashEntry(relid, exclusive);
+                        exclusive = true;
+                        continue;
                     }
+
+                    /*
+                     * We need to create a hash entry for this relation.
+                     *
+                     * However, we need to access the pg_appendonly system catalog
+                     * table, so AORelCreateHashEntry will carefully release the AOSegFileLock,
+                     * gather the information, and then re-acquire AOSegFileLock.
+                     */
+                    if(!AORelCreateHashEntry(relid))
+                    {
+                        LWLockRelease(AOSegFileLock);
+                        ereport(ERROR, (errmsg("can't have more than %d different append-only "
+                                        "tables open for writing data at the same time. "
+                                        "if tables are heavily partitioned or if your "
+                                        "workload requires, increase the value of "
+                                        "max_appendonly_tables and retry",
+                                        MaxAppendOnlyTables)));
+                    }
+
+                    /* get the hash entry for this relation (must exist) */
+                    aoentry = AORelGetHashEntry(relid);
                 }
-                next = segfilestatus->next;
-                if (next == NEXT_END_OF_LIST)
-                {
-                    break;
-                }
-                segfilestatus = &AOSegfileStatusPool[next];
-            } while(remaining_num > 0);
 
-            /*
-             * In the same txn.
-             */
-            if (has_same_txn_status)
-            {
-                aoentry->txns_using_rel--; /* re-adjust */
-            }
+                /*
+                 * Now pick a segment that is not in use and is not over the
+                 * allowed size threshold (90% full).
+                 *
+                 * However, if we already picked a segno for a previous statement
+                 * in this very same transaction we are still in (explicit txn) we
+                 * pick the same one to insert into it again.
+                 */
+                remaining_num = segment_num;
+                has_same_txn_status = false;
+                MemSet(maxSegno4Segment, 0, sizeof(struct AOSegfileStatus*)*segment_num);
 
-            /*
-             * Go through the open segfile status again to
-             * find enough ones
-             */
-            if (remaining_num > 0)
-            {
+                /* We go through the open segfile status first to check
+                 * whether are some in the same txn.
+                 */
                 segfilestatus = &(aoentry->head_rel_segfile);
                 do
                 {
                     if (!segfilestatus->isfull)
                     {
-                        if(!segfilestatus->inuse && !usedByConcurrentTransaction(segfilestatus))
+                        if (segfilestatus->xid == CurrentXid && reuse_segfilenum_in_same_xid)
                         {
+                            has_same_txn_status = true;
                             if(CheckSegFileForWriteIfNeeded(aoentry, segfilestatus)){
                                 remaining_num = addCandidateSegno(maxSegno4Segment, segment_num, segfilestatus, keepHash);
                             }
@@ -1144,6 +1321,57 @@ List *SetSegnoForWrite(List *existing_segnos, Oid relid, int segment_num,
                     }
                     segfilestatus = &AOSegfileStatusPool[next];
                 } while(remaining_num > 0);
+
+                /*
+                 * Go through the open segfile status again to
+                 * find enough ones
+                 */
+                if (remaining_num > 0)
+                {
+                    segfilestatus = &(aoentry->head_rel_segfile);
+                    do
+                    {
+                        if (!segfilestatus->isfull)
+                        {
+                            if(!segfilestatus->inuse && !usedByConcurrentTransaction(segfilestatus))
+                            {
+                                if(CheckSegFileForWriteIfNeeded(aoentry, segfilestatus)){
+                                    remaining_num = addCandidateSegno(maxSegno4Segment, segment_num, segfilestatus, keepHash);
+                                }
+                            }
+                        }
+                        next = segfilestatus->next;
+                        if (next == NEXT_END_OF_LIST)
+                        {
+                            break;
+                        }
+                        segfilestatus = &AOSegfileStatusPool[next];
+                    } while(remaining_num > 0);
+                }
+
+                if (remaining_num == 0 || exclusive)
+                    break;
+
+                /* we need new segment files from the pool */
+                AORelUnlockHashEntry(relid, exclusive);
+                exclusive = true;
+            }
+
+            /*
+             * The relation is used by one more transaction, unless we are in
+             * the same txn.
+             */
+            if (!has_same_txn_status)
+            {
+                aoentry->txns_using_rel++;
+            }
+
+            if (Debug_appendonly_print_segfile_choice)
+            {
+                ereport(LOG, (errmsg("SetSegnoForWrite: got the hash entry for relation \"%s\" (%d). "
+                                "setting txns_using_rel to %d",
+                                get_rel_name(relid), relid,
+                                aoentry->txns_using_rel)));
             }
 
             /* If the found segfile status are still no enough,
@@ -1152,10 +1380,13 @@ List *SetSegnoForWrite(List *existing_segnos, Oid relid, int segment_num,
 			while(remaining_num>0)
 			{
 				//generate new segment_num to make sure that in keepHash mode, all segment node has at least one segfile is writable
-				int new_status = AORelGetSegfileStatus(aoentry);
+				int new_status;
+
+				Assert(exclusive);
+				new_status = AORelGetSegfileStatus(aoentry);
 				if (new_status == NEXT_END_OF_LIST)
 				{
-					LWLockRelease(AOSegFileLock);
+					AORelUnlockHashEntry(relid, exclusive);
 
 					ereport(ERROR, (errmsg("cannot open more than %d append-only table segment files concurrently",
 									MaxAORelSegFileStatus)));
@@ -1177,7 +1408,7 @@ List *SetSegnoForWrite(List *existing_segnos, Oid relid, int segment_num,
             }
             Assert(list_length(existing_segnos) == segment_num);
 
-            LWLockRelease(AOSegFileLock);
+            AORelUnlockHashEntry(relid, exclusive);
 
             if(maxSegno4Segment) pfree(maxSegno4Segment);
             return existing_segnos;
@@ -1344,13 +1575,12 @@ AtCommit_AppendOnly(bool isSubTransaction)
     HASH_SEQ_STATUS status;
     AORelHashEntry	aoentry = NULL;
     AppendOnlyHashEntryPendingCleanup *pending;
+    Oid            *relidp;
     TransactionId 	CurrentXid = GetTopTransactionId();
 
     if (Gp_role != GP_ROLE_DISPATCH)
         return;
 
-    LWLockAcquire(AOSegFileLock, LW_EXCLUSIVE);
-
     /*
      * merge into parent transaction pending delete list
      */
@@ -1369,33 +1599,42 @@ AtCommit_AppendOnly(bool isSubTransaction)
                 pending->nestedLevel = currentLevel - 1;
         }
 
-        LWLockRelease(AOSegFileLock);
         return;
     }
 
     /*
      * at top transaction commit, remove all required entry.
      */
-    hash_seq_init(&status, AppendOnlyHashEntryPendingDeleteCleanup);
-
-    while ((pending = (AppendOnlyHashEntryPendingCleanup *) hash_seq_search(&status)) != NULL)
+    if (AppendOnlyHashEntryPendingDeleteCleanup &&
+        hash_get_num_entries(AppendOnlyHashEntryPendingDeleteCleanup) > 0)
     {
-        if (InvalidOid != pending->relid)
-            AORelRemoveHashEntry(pending->relid, true);
-    }
+        LWLockAcquire(AOSegFileLock, LW_EXCLUSIVE);
+
+        hash_seq_init(&status, AppendOnlyHashEntryPendingDeleteCleanup);
+
+        while ((pending = (AppendOnlyHashEntryPendingCleanup *) hash_seq_search(&status)) != NULL)
+        {
+            if (InvalidOid != pending->relid)
+                AORelRemoveHashEntry(pending->relid, true);
+        }
 
+        LWLockRelease(AOSegFileLock);
+    }
 
-    hash_seq_init(&status, AppendOnlyHash);
+    hash_seq_init(&status, AppendOnlyRelsInXact);
 
 	/*
-	 * for each AO table hash entry
+	 * for each AO table hash entry our transaction may have used
 	 */
-	while ((aoentry = (AORelHashEntryData *) hash_seq_search(&status)) != NULL)
+	while ((relidp = (Oid *) hash_seq_search(&status)) != NULL)
 	{
+		AORelLockHashEntry(*relidp, false);
+		aoentry = AORelLookupHashEntry(*relidp);
+
 		/*
 		 * Only look at tables that are marked in use currently
 		 */
-		if(aoentry->txns_using_rel > 0)
+		if(aoentry != NULL && aoentry->txns_using_rel > 0)
 		{
 			AOSegfileStatus *segfilestat = &aoentry->head_rel_segfile;
 			int next = 0;
@@ -1446,9 +1685,9 @@ AtCommit_AppendOnly(bool isSubTransaction)
 				segfilestat = &AOSegfileStatusPool[next];
 			}while (true);
 		}
-	}
 
-	LWLockRelease(AOSegFileLock);
+		AORelUnlockHashEntry(*relidp, false);
+	}
 }
 
 /*
@@ -1470,13 +1709,12 @@ AtAbort_AppendOnly(bool isSubTransaction)
     HASH_SEQ_STATUS status;
     AORelHashEntry	aoentry = NULL;
     AppendOnlyHashEntryPendingCleanup *pending;
+    Oid            *relidp;
     TransactionId 	CurrentXid = GetTopTransactionId();
 
     if (Gp_role != GP_ROLE_DISPATCH|| CurrentXid == InvalidTransactionId)
         return;
 
-    LWLockAcquire(AOSegFileLock, LW_EXCLUSIVE);
-
     if (isSubTransaction)
     {
         int currentLevel = GetCurrentTransactionNestLevel();
@@ -1495,6 +1733,7 @@ AtAbort_AppendOnly(bool isSubTransaction)
                  * so its aoentry is not staled anymore.
                  */
 
+                AORelLockHashEntry(pending->relid, false);
                 aoentry = AORelLookupHashEntry(pending->relid);
 
                 if (aoentry)
@@ -1502,6 +1741,7 @@ AtAbort_AppendOnly(bool isSubTransaction)
                     Insist(aoentry->staleTid == CurrentXid);
                     aoentry->staleTid = InvalidTransactionId; //clear flag stale
                 }
+                AORelUnlockHashEntry(pending->relid, false);
 
                 hash_search(AppendOnlyHashEntryPendingDeleteCleanup,
                         (void *) &pending->relid,
@@ -1511,13 +1751,21 @@ AtAbort_AppendOnly(bool isSubTransaction)
         }
     }
 
-    hash_seq_init(&status, AppendOnlyHash);
+    hash_seq_init(&status, AppendOnlyRelsInXact);
 
     /*
-     * for each AO table hash entry
+     * for each AO table hash entry our transaction may have used
      */
-    while ((aoentry = (AORelHashEntryData *) hash_seq_search(&status)) != NULL)
+    while ((relidp = (Oid *) hash_seq_search(&status)) != NULL)
     {
+        AORelLockHashEntry(*relidp, false);
+        aoentry = AORelLookupHashEntry(*relidp);
+        if (aoentry == NULL)
+        {
+            AORelUnlockHashEntry(*relidp, false);
+            continue;
+        }
+
         if (!isSubTransaction)
         {
             /*
@@ -1565,6 +1813,7 @@ AtAbort_AppendOnly(bool isSubTransaction)
                         segfilestat->tupsadded = 0;
 
                     segfilestat->needCheck = true;
+                    segfilestat->checkGeneration++;
 				}
 				next = segfilestat->next;
 				if (next == NEXT_END_OF_LIST)
@@ -1574,9 +1823,9 @@ AtAbort_AppendOnly(bool isSubTransaction)
 				segfilestat = &AOSegfileStatusPool[next];
 			}while (true);
 		}
-	}
 
-	LWLockRelease(AOSegFileLock);
+		AORelUnlockHashEntry(*relidp, false);
+	}
 }
 
 /*
@@ -1596,27 +1845,41 @@ AtEOXact_AppendOnly(void)
 {
 	HASH_SEQ_STATUS status;
 	AORelHashEntry	aoentry = NULL;
+	Oid			   *relidp;
     TransactionId 	CurrentXid = GetTopTransactionId();
 	bool			entry_updated = false;
 
+	/* an aborted transaction leaves nothing visible to bump */
+	AORelForgetSegfileChanges();
+
 	if (Gp_role != GP_ROLE_DISPATCH)
 		return;
 
-	hash_seq_init(&status, AppendOnlyHash);
-
-	LWLockAcquire(AOSegFileLock, LW_EXCLUSIVE);
-
     //clean up
     if(AppendOnlyHashEntryPendingDeleteCleanup)
     {
         hash_destroy(AppendOnlyHashEntryPendingDeleteCleanup);
         AppendOnlyHashEntryPendingDeleteCleanup = NULL;
     }
+
+	if (AppendOnlyRelsInXact == NULL)
+		return;
+
+	hash_seq_init(&status, AppendOnlyRelsInXact);
+
 	/*
-	 * for each AO table hash entry
+	 * for each AO table hash entry our transaction may have used
 	 */
-	while ((aoentry = (AORelHashEntryData *) hash_seq_search(&status)) != NULL)
+	while ((relidp = (Oid *) hash_seq_search(&status)) != NULL)
 	{
+		AORelLockHashEntry(*relidp, false);
+		aoentry = AORelLookupHashEntry(*relidp);
+		if (aoentry == NULL)
+		{
+			AORelUnlockHashEntry(*relidp, false);
+			continue;
+		}
+
 	    Insist(aoentry->staleTid != CurrentXid);
 		/*
 		 * Only look at tables that are marked in use currently
@@ -1663,6 +1926,12 @@ AtEOXact_AppendOnly(void)
 			if(entry_updated)
 			{
 				aoentry->txns_using_rel--;
+
+				/*
+				 * The commit is visible now, revise the cached results of
+				 * the table against the queries that started before it.
+				 */
+				ReadCacheHashEntryRevise(aoentry->relid);
 				
 				if (Debug_appendonly_print_segfile_choice)
 				{
@@ -1673,10 +1942,12 @@ AtEOXact_AppendOnly(void)
 				
 				
 		}
-	}
 
-	LWLockRelease(AOSegFileLock);
+		AORelUnlockHashEntry(*relidp, false);
+	}
 
+	hash_destroy(AppendOnlyRelsInXact);
+	AppendOnlyRelsInXact = NULL;
 }
 
 void ValidateAppendOnlyMetaDataSnapshot(
@@ -1685,6 +1956,140 @@ void ValidateAppendOnlyMetaDataSnapshot(
 	// Placeholder.
 }
 
+#define SegfileVersionSlot(segrelid) ((int) ((uint32) (segrelid) % AOSEG_VERSION_SLOTS))
+
+/*
+ * AORelBumpSegfileVersion
+ *
+ * Increment the counter of a segment file version slot, recording xid as the
+ * last transaction that changed it unless xid is invalid. Frozen changes bump
+ * the slots without holding ProcArrayLock, hence the compare and swap.
+ */
+static void
+AORelBumpSegfileVersion(int slot, TransactionId xid)
+{
+	uint64	   *version = &AppendOnlyWriter->segfile_versions[slot];
+
+	for (;;)
+	{
+		uint64		oldVersion = *(volatile uint64 *) version;
+		uint64		newVersion;
+
+		newVersion = ((uint64) (SegfileVersionCounter(oldVersion) + 1)) << 32;
+		newVersion |= TransactionIdIsValid(xid) ? xid : SegfileVersionXid(oldVersion);
+
+		if (compare_and_swap_64(version, oldVersion, newVersion))
+			break;
+	}
+}
+
+static void
+AORelForgetSegfileChanges(void)
+{
+	if (!SegfileVersionsTouchedAny)
+		return;
+
+	MemSet(SegfileVersionsTouched, 0, sizeof(SegfileVersionsTouched));
+	SegfileVersionsTouchedAny = false;
+}
+
+/*
+ * AORelNoteSegfileChange
+ *
+ * Record that the current transaction changed the segment file catalog
+ * segrelid. Its version is bumped when the transaction ends, and at once if
+ * the change is already visible to everybody (frozen or in place writes).
+ */
+void
+AORelNoteSegfileChange(Oid segrelid, bool visibleNow)
+{
+	int			slot = SegfileVersionSlot(segrelid);
+
+	if (AppendOnlyWriter == NULL)
+		return;
+
+	SegfileVersionsTouched[slot / 64] |= ((uint64) 1) << (slot % 64);
+	SegfileVersionsTouchedAny = true;
+
+	if (visibleNow)
+		AORelBumpSegfileVersion(slot, InvalidTransactionId);
+}
+
+/*
+ * AORelSegfileChangedLocally
+ *
+ * Whether the current transaction may have changed the segment file catalog
+ * segrelid, so that its own view of it differs from everybody else's.
+ */
+bool
+AORelSegfileChangedLocally(Oid segrelid)
+{
+	int			slot = SegfileVersionSlot(segrelid);
+
+	return (SegfileVersionsTouched[slot / 64] & (((uint64) 1) << (slot % 64))) != 0;
+}
+
+/*
+ * AORelGetSegfileVersion
+ *
+ * Return the current version of the segment file catalog segrelid.
+ */
+uint64
+AORelGetSegfileVersion(Oid segrelid)
+{
+	Assert(AppendOnlyWriter != NULL);
+
+	return gp_atomic_add_uint64(&AppendOnlyWriter->segfile_versions[SegfileVersionSlot(segrelid)], 0);
+}
+
+/*
+ * AORelAdvanceSegfileVersions
+ *
+ * Bump the versions of the segment file catalogs changed by the ending
+ * transaction xid. The caller holds ProcArrayLock exclusively while it removes
+ * xid from the running transactions.
+ */
+void
+AORelAdvanceSegfileVersions(TransactionId xid)
+{
+	int			word;
+
+	if (!SegfileVersionsTouchedAny || AppendOnlyWriter == NULL)
+		return;
+
+	for (word = 0; word < AOSEG_VERSION_SLOTS / 64; word++)
+	{
+		uint64		bits = SegfileVersionsTouched[word];
+		int			bit;
+
+		for (bit = 0; bits != 0; bit++, bits >>= 1)
+		{
+			if (bits & 1)
+				AORelBumpSegfileVersion(word * 64 + bit, xid);
+		}
+	}
+
+	AORelForgetSegfileChanges();
+}
+
+/*
+ * AORelInvalidateSegfileVersions
+ *
+ * Bump every version, for when a prepared transaction that changed unknown
+ * segment file catalogs finishes.
+ */
+void
+AORelInvalidateSegfileVersions(void)
+{
+	int			slot;
+
+	if (AppendOnlyWriter == NULL)
+		return;
+
+	for (slot = 0; slot < AOSEG_VERSION_SLOTS; slot++)
+		AORelBumpSegfileVersion(slot, InvalidTransactionId);
+}
+
 static bool
 AORelFreeSegfileStatus(AORelHashEntry currentEntry)
 {
@@ -1873,7 +2278,7 @@ GetSegmentFileLengthMapping(Relation rel, Oid segrelid, int segno, int *totalseg
  *
  */
     static bool
-CheckSegFileForWrite(AORelHashEntryData *aoentry, int segno)
+CheckSegFileForWrite(Oid relid, int segno)
 {
     bool retVal=true;
     int64 len;
@@ -1889,12 +2294,12 @@ CheckSegFileForWrite(AORelHashEntryData *aoentry, int segno)
         elog(ERROR, "CheckSegFileForWrite() cannot be called on segment node");
 
 
-    rel = heap_open(aoentry->relid, RowExclusiveLock);
+    rel = heap_open(relid, RowExclusiveLock);
     node = &rel->rd_node;
     /* get necessary information before lock.
      * aohelp maybe NULL.
      */
-    aohelp = GetAOHashTableHelpEntry(aoentry->relid);
+    aohelp = GetAOHashTableHelpEntry(relid);
     if (!aohelp){
         goto ReturnPoint;
     }
@@ -1972,7 +2377,7 @@ CheckSegFileForWriteIfNeeded(AORelHashEntryData *aoentry, AOSegfileStatus * segf
     bool isOkay = true;
 
     if(segfilesstatus->needCheck){
-        isOkay = CheckSegFileForWrite(aoentry, segfilesstatus->segno);
+        isOkay = CheckSegFileForWrite(aoentry->relid, segfilesstatus->segno);
         if(!isOkay){//clear the flag
             //elog(INFO, "Segfile %d is invalid and became read only for relation %d.",  segfilesstatus->segno, aoentry->relid);
             segfilesstatus->inuse = true;
@@ -68,6 +68,7 @@ typedef struct
 	TupleDesc	attrinfo;		/* The attr info we are set up for */
 	int			nattrs;
 	PrinttupAttrInfo *myinfo;	/* Cached info about each attr */
+	StringInfoData buf;			/* DataRow buffer, reused for each row */
 } DR_printtup;
 
 /* ----------------
@@ -110,6 +111,7 @@ printtup_create_DR(CommandDest dest, Portal portal)
 	self->attrinfo = NULL;
 	self->nattrs = 0;
 	self->myinfo = NULL;
+	self->buf.data = NULL;
 
 	return (DestReceiver *) self;
 }
@@ -120,6 +122,10 @@ printtup_startup(DestReceiver *self, int operation __attribute__((unused)), Tupl
 	DR_printtup *myState = (DR_printtup *) self;
 	Portal		portal = myState->portal;
 
+	/* Buffer for the DataRows, in the context the receiver is started in */
+	if (myState->buf.data == NULL)
+		initStringInfo(&myState->buf);
+
 	if (PG_PROTOCOL_MAJOR(FrontendProtocol) < 3)
 	{
 		/*
@@ -283,22 +289,22 @@ printtup_prepare_info(DR_printtup *myState, TupleDesc typeinfo, int numAttrs)
 static void
 printtup(TupleTableSlot *slot, DestReceiver *self)
 {
-  StringInfoData buf;
+	DR_printtup *myState = (DR_printtup *) self;
+	StringInfo	buf = &myState->buf;
 
   if (readCacheEnabled()) {
     int cachedLen;
     char *cachedStr;
     cachedStr = readCache(&cachedLen);
     if (!readCacheEof()) {
-      pq_beginmessage(&buf, 'D');
-      appendBinaryStringInfo(&buf, cachedStr, cachedLen);
-      pq_endmessage(&buf);
+      pq_beginmessage_reuse(buf, 'D');
+      appendBinaryStringInfo(buf, cachedStr, cachedLen);
+      pq_endmessage_reuse(buf);
     }
     return;
   }
 
         TupleDesc	typeinfo = slot->tts_tupleDescriptor;
-	DR_printtup *myState = (DR_printtup *) self;
 	int			natts = typeinfo->natts;
 	int			i;
 
@@ -310,11 +316,11 @@ printtup(TupleTableSlot *slot, DestReceiver *self)
 	slot_getallattrs(slot);
 
 	/*
-	 * Prepare a DataRow message
+	 * Prepare a DataRow message, in the buffer of the previous one
 	 */
-	pq_beginmessage(&buf, 'D');
+	pq_beginmessage_reuse(buf, 'D');
 
-	pq_sendint(&buf, natts, 2);
+	pq_sendint(buf, natts, 2);
 
 	/*
 	 * send the attributes of this tuple
@@ -330,7 +336,7 @@ printtup(TupleTableSlot *slot, DestReceiver *self)
 		{
 			/* -1 is the same in both byte orders.  This is the same as pg_sendint */
 			int32 n32 = -1;
-			appendBinaryStringInfo(&buf, (char *) &n32, 4);
+			appendBinaryStringInfo(buf, (char *) &n32, 4);
 			continue;
 		}
 
@@ -395,8 +401,8 @@ printtup(TupleTableSlot *slot, DestReceiver *self)
 #else
 #error BYTE_ORDER must be BIG_ENDIAN or LITTLE_ENDIAN
 #endif
-					appendBinaryStringInfo(&buf, (char *) &n32, 4);
-					appendBinaryStringInfo(&buf, str, strlen(str));
+					appendBinaryStringInfo(buf, (char *) &n32, 4);
+					appendBinaryStringInfo(buf, str, strlen(str));
 				}
 				break;
 			case INT8OID: /* int8 */
@@ -429,8 +435,8 @@ printtup(TupleTableSlot *slot, DestReceiver *self)
 #else
 					n32 = (uint32) (sp-str);
 #endif
-					appendBinaryStringInfo(&buf, (char *) &n32, 4);
-					appendBinaryStringInfo(&buf, str, strlen(str));
+					appendBinaryStringInfo(buf, (char *) &n32, 4);
+					appendBinaryStringInfo(buf, str, strlen(str));
 				}
 				break;
 
@@ -455,15 +461,15 @@ printtup(TupleTableSlot *slot, DestReceiver *self)
 					{
 						len = strlen(p);
 						n32 = htonl((uint32) len);
-						appendBinaryStringInfo(&buf, (char *) &n32, 4);
-						appendBinaryStringInfo(&buf, p, len);
+						appendBinaryStringInfo(buf, (char *) &n32, 4);
+						appendBinaryStringInfo(buf, p, len);
 						pfree(p);
 					}
 					else
 					{
 						n32 = htonl((uint32) len);
-						appendBinaryStringInfo(&buf, (char *) &n32, 4);
-						appendBinaryStringInfo(&buf, s, len);
+						appendBinaryStringInfo(buf, (char *) &n32, 4);
+						appendBinaryStringInfo(buf, s, len);
 					}
 
 				}
@@ -473,7 +479,7 @@ printtup(TupleTableSlot *slot, DestReceiver *self)
 				{
 					char *outputstr;
 					outputstr = OutputFunctionCall(&thisState->finfo, attr);
-					pq_sendcountedtext(&buf, outputstr, strlen(outputstr), false);
+					pq_sendcountedtext(buf, outputstr, strlen(outputstr), false);
 					pfree(outputstr);
 				}
 			}
@@ -494,8 +500,8 @@ printtup(TupleTableSlot *slot, DestReceiver *self)
 #else
 					n32 = (uint32) 2;
 #endif
-					appendBinaryStringInfo(&buf, (char *) &n32, 4);
-					appendBinaryStringInfo(&buf, &int2, 2);
+					appendBinaryStringInfo(buf, (char *) &n32, 4);
+					appendBinaryStringInfo(buf, &int2, 2);
 				}
 				break;
 			case INT4OID: /* int4 */
@@ -507,8 +513,8 @@ printtup(TupleTableSlot *slot, DestReceiver *self)
 #else
 					n32 = (uint32) 4;
 #endif
-					appendBinaryStringInfo(&buf, (char *) &n32, 4);
-					appendBinaryStringInfo(&buf, &int4, 4);
+					appendBinaryStringInfo(buf, (char *) &n32, 4);
+					appendBinaryStringInfo(buf, &int4, 4);
 				}
 				break;
 			case INT8OID: /* int8 */
@@ -522,8 +528,8 @@ printtup(TupleTableSlot *slot, DestReceiver *self)
 #else
 					n32 = (uint32) 8;
 #endif
-					appendBinaryStringInfo(&buf, (char *) &n32, 4);
-					appendBinaryStringInfo(&buf, &int8, 8);
+					appendBinaryStringInfo(buf, (char *) &n32, 4);
+					appendBinaryStringInfo(buf, &int8, 8);
 				}
 				break;
 
@@ -548,15 +554,15 @@ printtup(TupleTableSlot *slot, DestReceiver *self)
 					{
 						len = strlen(p);
 						n32 = htonl((uint32) len);
-						appendBinaryStringInfo(&buf, (char *) &n32, 4);
-						appendBinaryStringInfo(&buf, p, len);
+						appendBinaryStringInfo(buf, (char *) &n32, 4);
+						appendBinaryStringInfo(buf, p, len);
 						pfree(p);
 					}
 					else
 					{
 						n32 = htonl((uint32) len);
-						appendBinaryStringInfo(&buf, (char *) &n32, 4);
-						appendBinaryStringInfo(&buf, s, len);
+						appendBinaryStringInfo(buf, (char *) &n32, 4);
+						appendBinaryStringInfo(buf, s, len);
 					}
 
 				}
@@ -566,8 +572,8 @@ printtup(TupleTableSlot *slot, DestReceiver *self)
 				{
 					bytea *outputbytes;
 					outputbytes = SendFunctionCall(&thisState->finfo, attr);
-					pq_sendint(&buf, VARSIZE(outputbytes) - VARHDRSZ, 4);
-					pq_sendbytes(&buf, VARDATA(outputbytes), 
+					pq_sendint(buf, VARSIZE(outputbytes) - VARHDRSZ, 4);
+					pq_sendbytes(buf, VARDATA(outputbytes), 
 					VARSIZE(outputbytes) - VARHDRSZ);
 					pfree(outputbytes);
 				}
@@ -580,9 +586,9 @@ printtup(TupleTableSlot *slot, DestReceiver *self)
 	}
 
 	if (writeCacheEnabled())
-	  writeCache(buf.data, buf.len);
+	  writeCache(buf->data, buf->len);
 
-	pq_endmessage(&buf);
+	pq_endmessage_reuse(buf);
 }
 
 void printtup_newplan(const char **value, uint64_t *len, bool *isNull,
@@ -724,6 +730,10 @@ printtup_shutdown(DestReceiver *self)
 		pfree(myState->myinfo);
 	myState->myinfo = NULL;
 
+	if (myState->buf.data)
+		pfree(myState->buf.data);
+	myState->buf.data = NULL;
+
 	myState->attrinfo = NULL;
 }
 
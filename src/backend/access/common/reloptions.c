@@ -494,6 +494,7 @@ default_reloptions(Datum reloptions, bool validate, char relkind,
 		"stripesize",
 		"rowindexstride",
 		"compressblocksize",
+		"columngroupsize",
 	};
 
 	char	   *values[ARRAY_SIZE(default_keywords)];
@@ -511,6 +512,7 @@ default_reloptions(Datum reloptions, bool validate, char relkind,
 	bool		forceHeap = false;
 	bool		errorTable = false;
 	int32 bucket_num = 0;
+	int32		columngroupsize = 0;
 	int			j = 0;
 
 	StdRdOptions *result;
@@ -697,6 +699,8 @@ default_reloptions(Datum reloptions, bool validate, char relkind,
 
 		if ((columnstore == RELSTORAGE_PARQUET) && (strcmp(compresstype, "snappy") != 0)
 				&& (strcmp(compresstype, "gzip") != 0)
+				&& (strcmp(compresstype, "lz4") != 0)
+				&& (strcmp(compresstype, "zstd") != 0)
 				&& (strcmp(compresstype, "none") != 0))
 		{
 			ereport(ERROR,
@@ -730,11 +734,13 @@ default_reloptions(Datum reloptions, bool validate, char relkind,
 							"Only valid for Append Only relations"),
 									   errOmitLocation(true)));
 
-		/*compress type snappy should not have compress level setting*/
-		if(compresstype && strcmp(compresstype, "snappy") == 0){
+		/*compress type snappy and lz4 should not have compress level setting*/
+		if(compresstype && (strcmp(compresstype, "snappy") == 0 ||
+							strcmp(compresstype, "lz4") == 0)){
 			ereport(ERROR,
 					(errcode(ERRCODE_GP_FEATURE_NOT_SUPPORTED),
-					 errmsg("invalid option \'compresslevel\' for compresstype \'snappy\'."),
+					 errmsg("invalid option \'compresslevel\' for compresstype \'%s\'.",
+							compresstype),
 					 errOmitLocation(true)));
 		}
 
@@ -748,7 +754,23 @@ default_reloptions(Datum reloptions, bool validate, char relkind,
 					 errmsg("compresstype can\'t be used with compresslevel 0"),
 							   errOmitLocation(true)));
 
-		if (compresslevel < 0 || compresslevel > 9)
+		/* zstd has levels up to 19, beyond those of zlib */
+		if (compresstype && strcmp(compresstype, "zstd") == 0)
+		{
+			if (compresslevel < 0 || compresslevel > 19)
+			{
+				if (validate)
+					ereport(ERROR,
+							(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+							 errmsg("compresslevel=%d is out of range for zstd "
+									"(should be in the range 1 to 19)",
+									compresslevel),
+							 errOmitLocation(true)));
+
+				compresslevel = setDefaultCompressionLevel(compresstype);
+			}
+		}
+		else if (compresslevel < 0 || compresslevel > 9)
 		{
 			if (validate)
 				ereport(ERROR,
@@ -943,6 +965,44 @@ default_reloptions(Datum reloptions, bool validate, char relkind,
 
 	}
 
+	/* columngroupsize */
+	if (values[16] != NULL)
+	{
+		if (relkind != RELKIND_RELATION && validate)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("usage of parameter \"columngroupsize\" in a non relation object is not supported"),
+					 errOmitLocation(false)));
+
+		if (!appendonly && validate)
+			ereport(ERROR,
+					(errcode(ERRCODE_GP_FEATURE_NOT_SUPPORTED),
+					 errmsg("invalid option \'columngroupsize\' for base relation. "
+							"Only valid for Append Only relations"),
+									   errOmitLocation(true)));
+
+		if (columnstore != RELSTORAGE_AOROWS && validate)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("invalid option \'columngroupsize\' for non row oriented table"),
+					 errOmitLocation(true)));
+
+		columngroupsize = pg_atoi(values[16], sizeof(int32), 0);
+
+		if (columngroupsize < 1 || columngroupsize > MaxHeapAttributeNumber)
+		{
+			if (validate)
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("columngroupsize=%d is out of range (should be "
+								"between 1 and %d)",
+								columngroupsize, MaxHeapAttributeNumber),
+						 errOmitLocation(true)));
+
+			columngroupsize = 0;
+		}
+	}
+
 	if((columnstore == RELSTORAGE_PARQUET) && (pagesize >= rowgroupsize)){
 		ereport(ERROR,
 			(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
@@ -969,6 +1029,7 @@ default_reloptions(Datum reloptions, bool validate, char relkind,
 	result->forceHeap = forceHeap;
 	result->errorTable = errorTable;
 	result->bucket_num = bucket_num;
+	result->columngroupsize = columngroupsize;
 
 	// extra parse and check for ORC format
 	if (columnstore == RELSTORAGE_ORC)
@@ -1166,6 +1227,8 @@ void validateAppendOnlyRelOptions(bool ao,
 	if (comptype &&
 		(pg_strcasecmp(comptype, "snappy") == 0 ||
 		 pg_strcasecmp(comptype, "zlib") == 0 ||
+		 pg_strcasecmp(comptype, "lz4") == 0 ||
+		 pg_strcasecmp(comptype, "zstd") == 0 ||
 		 pg_strcasecmp(comptype, "rle_type") == 0))
 	{
 		
@@ -1177,12 +1240,21 @@ void validateAppendOnlyRelOptions(bool ao,
 							comptype)));			
 		}
 		
-		if (comptype && (pg_strcasecmp(comptype, "snappy") != 0)&& complevel == 0)
+		if (comptype && (pg_strcasecmp(comptype, "snappy") != 0)
+				&& (pg_strcasecmp(comptype, "lz4") != 0) && complevel == 0)
 			ereport(ERROR,
 					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
 					 errmsg("compresstype cannot be used with compresslevel 0")));
 
-		if (complevel < 0 || complevel > 9)
+		if (pg_strcasecmp(comptype, "zstd") == 0)
+		{
+			if (complevel < 1 || complevel > 19)
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("compresslevel=%d is out of range for zstd "
+								"(should be in the range 1 to 19)", complevel)));
+		}
+		else if (complevel < 0 || complevel > 9)
 			ereport(ERROR,
 					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
 					 errmsg("compresslevel=%d is out of range (should be between 0 and 9)",
@@ -1229,13 +1301,14 @@ void validateAppendOnlyRelOptions(bool ao,
 
 /*
  * if no compressor type was specified, we set to no compression (level 0)
- * otherwise default for both zlib is level 1. RLE_TYPE does
- * not have a compression level.
+ * otherwise default for both zlib and zstd is level 1. RLE_TYPE, snappy and
+ * lz4 do not have a compression level.
  */
 static int setDefaultCompressionLevel(char* compresstype)
 {
 	if(!compresstype || pg_strcasecmp(compresstype, "none") == 0
-			|| pg_strcasecmp(compresstype, "snappy") == 0)
+			|| pg_strcasecmp(compresstype, "snappy") == 0
+			|| pg_strcasecmp(compresstype, "lz4") == 0)
 		return 0;
 	else
 		return 1;
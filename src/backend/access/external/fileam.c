@@ -137,6 +137,9 @@ elog(DEBUG2, "external_getnext returning tuple")
  */
 static FILE *g_dataSource = NULL;
 
+/* A data source external_open_ahead() opened, until it is read */
+static FILE *g_aheadSource = NULL;
+
 
 /* ----------------
 *		external_beginscan	- begin file scan
@@ -533,6 +536,31 @@ external_endscan(FileScanDesc scan)
 }
 
 
+/* ----------------
+*		external_open_ahead - open the external source before the scan reads it
+*
+* For a scan to be read after the one in progress, so that the external
+* server starts sending its data meanwhile.  Only the data source read
+* now is closed at abort through g_dataSource, so the one opened ahead is
+* tracked on its own until it is read.
+* ----------------
+*/
+void
+external_open_ahead(FileScanDesc scan)
+{
+	FILE	   *current = g_dataSource;
+
+	if (scan->fs_noop || scan->fs_file != NULL || g_aheadSource != NULL ||
+		scan->fs_pstate == NULL || scan->fs_formatter == NULL ||
+		!(scan->fs_formatter->fmt_mask & FMT_NEEDEXTBUFF))
+		return;
+
+	open_external_readable_source(scan);
+
+	g_aheadSource = scan->fs_file;
+	g_dataSource = current;
+}
+
 /* ----------------
 *		external_stopscan - closes an external resource without dismantling the scan context
 * ----------------
@@ -612,6 +640,12 @@ external_getnext(FileScanDesc scan,
 
 	if (scan->fs_file == NULL && (scan->fs_formatter->fmt_mask & FMT_NEEDEXTBUFF))
 		open_external_readable_source(scan);
+	else if (scan->fs_file != NULL && scan->fs_file == g_aheadSource)
+	{
+		/* the source opened ahead is the one read now */
+		g_dataSource = scan->fs_file;
+		g_aheadSource = NULL;
+	}
 
 	/* Note: no locking manipulations needed */
 	FILEDEBUG_1;
@@ -974,7 +1008,11 @@ else \
 		PG_RE_THROW(); \
 	}\
 \
-	/* save a copy of the error info */ \
+	/* \
+	 * save a copy of the error info. The previous bad row is done with, \
+	 * its error and error table values are freed here. \
+	 */ \
+	MemoryContextReset(pstate->cdbsreh->badrowcontext);\
 	oldcontext = MemoryContextSwitchTo(pstate->cdbsreh->badrowcontext);\
 	edata = CopyErrorData();\
  	MemoryContextSwitchTo(oldcontext);\
@@ -2081,7 +2119,11 @@ close_external_source(FILE *dataSource, bool failOnError, const char *relname)
 {
 	FILE *f = dataSource;
 
-	g_dataSource = dataSource = NULL;
+	if (f != NULL && f == g_aheadSource)
+		g_aheadSource = NULL;
+	else if (f == g_dataSource)
+		g_dataSource = NULL;
+	dataSource = NULL;
 
 	if (f)
 	{
@@ -2165,6 +2207,14 @@ external_scan_error_callback(void *arg)
 	StringInfoData copy_of_line_buf;
 	char buffer[20];
 
+	/*
+	 * A data error in single row error handling mode only rejects the row,
+	 * and just the message of it is logged (see FILEAM_HANDLE_ERROR).
+	 */
+	if (cstate->errMode != ALL_OR_NOTHING &&
+		ERRCODE_TO_CATEGORY(geterrcode()) == ERRCODE_DATA_EXCEPTION)
+		return;
+
 	/*
 	 * early exit for custom format error. We don't have metadata
 	 * to report on.
@@ -2254,6 +2304,8 @@ void AtAbort_ExtTables(void)
 {
 	close_external_source(g_dataSource, false, NULL);
 	g_dataSource = NULL;
+	close_external_source(g_aheadSource, false, NULL);
+	g_aheadSource = NULL;
 }
 
 void
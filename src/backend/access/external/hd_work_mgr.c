@@ -54,6 +54,7 @@ typedef struct sAllocatedDataFragment
 	char *fragment_md; /* fragment meta data */
 	char *user_data; /* additional user data */
 	char *profile; /* recommended profile to work with fragment */
+	int64 weight; /* fragment length in bytes, or 1 for all fragments when the lengths are not known */
 } AllocatedDataFragment;
 
 /*
@@ -78,6 +79,7 @@ typedef struct sDatanodeProcessingLoad
 	 */
 	int   num_fragments_read; 
 	int   num_fragments_residing; /* the total number of fragments located on this data node*/
+	int64 load_read; /* the total weight of the fragments that are going to be read */
 	List  *datanodeBlocks;
 } DatanodeProcessingLoad;
 
@@ -112,6 +114,11 @@ static DatanodeProcessingLoad* get_dn_processing_load(List **allDNProcessingLoad
 static void print_data_nodes_allocation(List *allDNProcessingLoads, int total_data_frags);
 static List* do_segment_clustering_by_host(void);
 static ListCell* pick_random_cell_in_list(List* list);
+static bool fragment_fits_segment(AllocatedDataFragment *allocated, int64 seg_load, int64 load_per_seg);
+static bool has_fitting_fragment(DatanodeProcessingLoad *dn, int64 seg_load, int64 load_per_seg);
+static int pick_least_loaded_segment(Segment **segs, int64 *segs_load, int num_segs, char *datanode_ip);
+static void set_fragment_host_to_segment(AllocatedDataFragment *allocated, Segment *seg);
+static void remove_dn_processing_load(List **allDNProcessingLoads, DatanodeProcessingLoad *dn);
 static void clean_gphosts_list(List *hosts_list);
 static AllocatedDataFragment* create_allocated_fragment(DataFragment *fragment);
 static char** create_output_strings(List **allocated_fragments, int total_segs);
@@ -164,9 +171,10 @@ char** map_hddata_2gp_segments(char* uri, int total_segs, int working_segs, Rela
 	build_http_header(&inputData);
 	
 	/*
-	 * 2. Get the fragments data from the PXF service
+	 * 2. Get the fragments data from the PXF service, or from the fragments cache
 	 */
-	data_fragments = get_data_fragment_list(hadoop_uri, &client_context);
+	data_fragments = get_data_fragment_list(hadoop_uri, &client_context,
+											RelationGetRelid(relation), inputData.filterstr);
 
 	assign_pxf_port_to_fragments(atoi(hadoop_uri->port), data_fragments);
 
@@ -346,7 +354,12 @@ distribute_work_2_gp_segments(List *whole_data_fragments_list, int total_segs, i
 	StringInfoData msg;
 	int count_total_blocks_allocated = 0;
 	int total_data_frags = 0;
-	int blks_per_seg = 0;
+	int64 total_load = 0;
+	int64 load_per_seg = 0;
+	int num_working_segs = 0;
+	Segment **working_segs_list = NULL; /* the segments that were allocated fragments, in allocation order */
+	int64 *working_segs_load = NULL; /* the weight of the fragments allocated to each of them */
+	ListCell *datanode_cell = NULL;
 	List *allDNProcessingLoads = NIL; /* how many blocks are allocated for processing on each data node */
 	List *gpHosts = NIL; /* the hosts of the gp_cluster. Every host has several gp segments */
 	List *reserve_gpHosts = NIL;
@@ -370,29 +383,30 @@ distribute_work_2_gp_segments(List *whole_data_fragments_list, int total_segs, i
 	
 	/* 
 	 * define the job at hand: how many fragments we have to allocate and what is the allocation load on each 
-	 * GP segment. We will distribute the load evenly between the segments
+	 * GP segment. We will distribute the load evenly between the segments.
+	 * The load is the total length of the fragments when the PXF fragmenter reports it, and the number of
+	 * fragments otherwise (every fragment weighs 1).
 	 */
 	total_data_frags = list_length(whole_data_fragments_list);
-	if (total_data_frags > working_segs)
-		blks_per_seg = (total_data_frags % working_segs == 0) ? total_data_frags / working_segs :
-				total_data_frags / working_segs + 1; /* rounding up - when total_data_frags is not divided by working_segs */
-	else /* total_data_frags < working_segs */
-	{
-		blks_per_seg = 1;
+	if (total_data_frags < working_segs)
 		working_segs = total_data_frags;
-	}
+	foreach(datanode_cell, allDNProcessingLoads)
+		total_load += ((DatanodeProcessingLoad*)lfirst(datanode_cell))->load_read;
+	if (working_segs > 0)
+		load_per_seg = (total_load + working_segs - 1) / working_segs; /* rounding up - when total_load is not divided by working_segs */
+	working_segs_list = (Segment **)palloc0(Max(working_segs, 1) * sizeof(Segment *));
+	working_segs_load = (int64 *)palloc0(Max(working_segs, 1) * sizeof(int64));
 	
 	print_data_nodes_allocation(allDNProcessingLoads, total_data_frags);
 	
-	/* Allocate blks_per_seg to each working segment */
+	/* Allocate load_per_seg to each working segment */
 	for (int i = 0; i < working_segs; i++) 
 	{
 		ListCell *gp_host_cell = NULL;
 		ListCell *seg_cell = NULL;
-		ListCell *datanode_cell = NULL;
-		ListCell *block_cell = NULL;
 		List *allocatedBlocksPerSegment = NIL; /* list of the data fragments for one segment */
 		Segment *seg = NULL;
+		int64 seg_load = 0;
 		
 		if (!allDNProcessingLoads) /* the blocks are finished */
 			break;
@@ -431,12 +445,18 @@ distribute_work_2_gp_segments(List *whole_data_fragments_list, int total_segs, i
 		 * Allocating blocks for this segment. We are going to look in two places.
 		 * The first place that supplies block for the segment wins.
 		 * a. Look in allDNProcessingLoads for a datanode on the same host with the segment
-		 * b. Look for a datanode at the head of the allDNProcessingLoads list
+		 * b. Look for the first datanode in the allDNProcessingLoads list
+		 * A block is only taken if it does not make the segment's load exceed load_per_seg,
+		 * unless it is the first block of the segment. The blocks which do not fit anywhere
+		 * are allocated after all the segments are filled.
 		 */
-		while (list_length(allocatedBlocksPerSegment) < blks_per_seg && count_total_blocks_allocated < total_data_frags)
+		while (seg_load < load_per_seg && count_total_blocks_allocated < total_data_frags)
 		{
 			DatanodeProcessingLoad *found_dn = NULL;
 			char *host_ip = seg->hostip;
+			ListCell *block_cell = NULL;
+			ListCell *prev_cell = NULL;
+			ListCell *next_cell = NULL;
 			
 			/* 
 			 * locality logic depends on whether we require optimizations (pxf_enable_locality_optimizations guc)
@@ -446,7 +466,7 @@ distribute_work_2_gp_segments(List *whole_data_fragments_list, int total_segs, i
 				foreach(datanode_cell, allDNProcessingLoads) /* an attempt at locality - try and find a datanode sitting on the same host with the segment */
 				{
 					DatanodeProcessingLoad *dn = (DatanodeProcessingLoad*)lfirst(datanode_cell);
-					if (are_ips_equal(host_ip, dn->dataNodeIp))
+					if (are_ips_equal(host_ip, dn->dataNodeIp) && has_fitting_fragment(dn, seg_load, load_per_seg))
 					{
 						found_dn = dn;
 						appendStringInfo(&msg, "PXF - Allocating the datanode blocks to a local segment. IP: %s\n", found_dn->dataNodeIp);
@@ -454,66 +474,184 @@ distribute_work_2_gp_segments(List *whole_data_fragments_list, int total_segs, i
 					}
 				}
 			}
-			if (allDNProcessingLoads && !found_dn) /* there is no datanode on the segment's host. Let's just pick the first data node */
+			if (!found_dn) /* there is no datanode on the segment's host. Let's just pick the first data node */
 			{
-				found_dn = linitial(allDNProcessingLoads);
-				if (found_dn)
-					appendStringInfo(&msg, "PXF - Allocating the datanode blocks to a remote segment. Datanode IP: %s Segment IP: %s\n",
-						 found_dn->dataNodeIp, host_ip);
+				foreach(datanode_cell, allDNProcessingLoads)
+				{
+					DatanodeProcessingLoad *dn = (DatanodeProcessingLoad*)lfirst(datanode_cell);
+					if (has_fitting_fragment(dn, seg_load, load_per_seg))
+					{
+						found_dn = dn;
+						appendStringInfo(&msg, "PXF - Allocating the datanode blocks to a remote segment. Datanode IP: %s Segment IP: %s\n",
+							 found_dn->dataNodeIp, host_ip);
+						break;
+					}
+				}
 			}
 			
-			if (!found_dn) /* there is no datanode found at the head of allDNProcessingLoads, it means we just finished the blocks*/
+			if (!found_dn) /* either we just finished the blocks, or none of the remaining blocks fits this segment */
 				break;
 			
 			/* we have a datanode */
-			while ( (block_cell = list_head(found_dn->datanodeBlocks)) )
+			for (block_cell = list_head(found_dn->datanodeBlocks); block_cell; block_cell = next_cell)
 			{
 				AllocatedDataFragment* allocated = (AllocatedDataFragment*)lfirst(block_cell);
-				/*
-				 * in case of remote storage, the segment host is also where the PXF will be running
-				 * so we set allocated->host accordingly, instead of the remote storage system - datanode ip.
-				 */
-				if (pxf_isilon)
+
+				next_cell = lnext(block_cell);
+				if (!fragment_fits_segment(allocated, seg_load, load_per_seg))
 				{
-					pfree(allocated->host);
-					allocated->host = pstrdup(host_ip);
+					prev_cell = block_cell;
+					continue;
 				}
+
+				set_fragment_host_to_segment(allocated, seg);
 				allocatedBlocksPerSegment = lappend(allocatedBlocksPerSegment, allocated);
+				seg_load += allocated->weight;
 				
-				found_dn->datanodeBlocks = list_delete_first(found_dn->datanodeBlocks);
+				found_dn->datanodeBlocks = list_delete_cell(found_dn->datanodeBlocks, block_cell, prev_cell);
 				found_dn->num_fragments_read--;
+				found_dn->load_read -= allocated->weight;
 				count_total_blocks_allocated++;
-				if (list_length(allocatedBlocksPerSegment) == blks_per_seg || count_total_blocks_allocated == total_data_frags) /* we load blocks on a segment up to blks_per_seg */
+				if (seg_load >= load_per_seg || count_total_blocks_allocated == total_data_frags) /* we load blocks on a segment up to load_per_seg */
 					break;
 			}
 			
 			/* test if the DatanodeProcessingLoad is empty */
 			if (found_dn->num_fragments_read == 0)
-			{
-				Assert(found_dn->datanodeBlocks == NIL); /* ensure datastructure is consistent */
-				allDNProcessingLoads = list_delete_ptr(allDNProcessingLoads, found_dn); /* clean allDNProcessingLoads */
-				pfree(found_dn->dataNodeIp); /* this one is ours */
-				pfree(found_dn);
-			}
+				remove_dn_processing_load(&allDNProcessingLoads, found_dn);
 		} /* Finished allocating blocks for this segment */
 		elog(FRAGDEBUG, "%s", msg.data);
 		resetStringInfo(&msg);
 		
 		if (allocatedBlocksPerSegment)
+		{
 			segs_data[seg->segindex] = allocatedBlocksPerSegment;
+			working_segs_list[num_working_segs] = seg;
+			working_segs_load[num_working_segs] = seg_load;
+			num_working_segs++;
+		}
 			
 	} /* i < working_segs; */
 	
+	/*
+	 * The blocks that did not fit in any segment without exceeding load_per_seg go to the
+	 * segments that are the least loaded by now. This only happens when the fragments
+	 * have different lengths.
+	 */
+	while (allDNProcessingLoads)
+	{
+		DatanodeProcessingLoad *dn = (DatanodeProcessingLoad*)linitial(allDNProcessingLoads);
+		ListCell *block_cell = NULL;
+
+		Assert(num_working_segs > 0);
+		while ( (block_cell = list_head(dn->datanodeBlocks)) )
+		{
+			AllocatedDataFragment* allocated = (AllocatedDataFragment*)lfirst(block_cell);
+			int target = pick_least_loaded_segment(working_segs_list, working_segs_load, num_working_segs, dn->dataNodeIp);
+			Segment *seg = working_segs_list[target];
+
+			set_fragment_host_to_segment(allocated, seg);
+			segs_data[seg->segindex] = lappend(segs_data[seg->segindex], allocated);
+			working_segs_load[target] += allocated->weight;
+			appendStringInfo(&msg, "PXF - Allocating a remaining datanode block to the least loaded segment. Datanode IP: %s Segment IP: %s\n",
+							 dn->dataNodeIp, seg->hostip);
+
+			dn->datanodeBlocks = list_delete_first(dn->datanodeBlocks);
+			dn->num_fragments_read--;
+			dn->load_read -= allocated->weight;
+			count_total_blocks_allocated++;
+		}
+		remove_dn_processing_load(&allDNProcessingLoads, dn);
+	}
+	if (msg.len > 0)
+		elog(FRAGDEBUG, "%s", msg.data);
+	
 	Assert(count_total_blocks_allocated == total_data_frags); /* guarantee we allocated all the blocks */ 
 	
 	/* cleanup */
 	pfree(msg.data);
+	pfree(working_segs_list);
+	pfree(working_segs_load);
 	clean_gphosts_list(gpHosts);
 	clean_gphosts_list(reserve_gpHosts);
 			
 	return segs_data;
 }
 
+/*
+ * A fragment fits a segment if it does not make the segment's load exceed load_per_seg.
+ * Any fragment fits a segment which was not allocated fragments yet, so that the fragments
+ * longer than load_per_seg are assigned too.
+ */
+static bool
+fragment_fits_segment(AllocatedDataFragment *allocated, int64 seg_load, int64 load_per_seg)
+{
+	return seg_load == 0 || seg_load + allocated->weight <= load_per_seg;
+}
+
+/* Whether one of the blocks to be read on the datanode fits a segment with load seg_load */
+static bool
+has_fitting_fragment(DatanodeProcessingLoad *dn, int64 seg_load, int64 load_per_seg)
+{
+	ListCell *block_cell = NULL;
+
+	foreach(block_cell, dn->datanodeBlocks)
+	{
+		if (fragment_fits_segment((AllocatedDataFragment*)lfirst(block_cell), seg_load, load_per_seg))
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Returns the index of the least loaded segment in segs. If there are several,
+ * a segment on the same host with the datanode is preferred.
+ */
+static int
+pick_least_loaded_segment(Segment **segs, int64 *segs_load, int num_segs, char *datanode_ip)
+{
+	int best = 0;
+	bool best_is_local = false;
+	bool use_locality = pxf_enable_locality_optimizations && !pxf_isilon;
+
+	for (int i = 0; i < num_segs; i++)
+	{
+		bool is_local = use_locality && are_ips_equal(segs[i]->hostip, datanode_ip);
+
+		if (segs_load[i] < segs_load[best] ||
+			(segs_load[i] == segs_load[best] && is_local && !best_is_local))
+		{
+			best = i;
+			best_is_local = is_local;
+		}
+	}
+	return best;
+}
+
+/*
+ * in case of remote storage, the segment host is also where the PXF will be running
+ * so we set allocated->host accordingly, instead of the remote storage system - datanode ip.
+ */
+static void
+set_fragment_host_to_segment(AllocatedDataFragment *allocated, Segment *seg)
+{
+	if (pxf_isilon)
+	{
+		pfree(allocated->host);
+		allocated->host = pstrdup(seg->hostip);
+	}
+}
+
+/* remove a DatanodeProcessingLoad which has no more blocks to be read from allDNProcessingLoads */
+static void
+remove_dn_processing_load(List **allDNProcessingLoads, DatanodeProcessingLoad *dn)
+{
+	Assert(dn->datanodeBlocks == NIL); /* ensure datastructure is consistent */
+	*allDNProcessingLoads = list_delete_ptr(*allDNProcessingLoads, dn); /* clean allDNProcessingLoads */
+	pfree(dn->dataNodeIp); /* this one is ours */
+	pfree(dn);
+}
+
 /* 
  * create the allocation strings for each segments from the list of AllocatedDataFragment instances
  * that each segment holds
@@ -670,17 +808,29 @@ allocate_fragments_to_datanodes(List *whole_data_fragments_list)
 	AllocatedDataFragment* allocated = NULL;
 	ListCell *cur_frag_cell = NULL;
 	ListCell *fragment_host_cell = NULL;
+	bool weigh_by_length = (whole_data_fragments_list != NIL);
+
+	/* the fragments are weighed by their length only if all of them report it */
+	foreach(cur_frag_cell, whole_data_fragments_list)
+	{
+		if (((DataFragment*)lfirst(cur_frag_cell))->length <= 0)
+		{
+			weigh_by_length = false;
+			break;
+		}
+	}
 		
 	foreach(cur_frag_cell, whole_data_fragments_list)
 	{
 		DatanodeProcessingLoad* previous_dn = NULL;
 		DataFragment* fragment = (DataFragment*)lfirst(cur_frag_cell);
 		allocated = create_allocated_fragment(fragment);
+		allocated->weight = weigh_by_length ? fragment->length : 1;
 		
 		/* 
 		 * From all the replicas that hold this block we are going to pick just one. 
 		 * What is the criteria for picking? We pick the data node that until now holds
-		 * the least number of blocks. The number of processing blocks for each dn is
+		 * the least load of blocks. The load of processing blocks for each dn is
 		 * held in the list allDNProcessingLoads
 		 */
 		foreach(fragment_host_cell, fragment->replicas)
@@ -690,11 +840,12 @@ allocate_fragments_to_datanodes(List *whole_data_fragments_list)
 			loc_dn->num_fragments_residing++;
 			if (!previous_dn)
 				previous_dn = loc_dn;
-			else if (previous_dn->num_fragments_read  > loc_dn->num_fragments_read)
+			else if (previous_dn->load_read > loc_dn->load_read)
 				previous_dn = loc_dn;
 				
 		}
 		previous_dn->num_fragments_read++;
+		previous_dn->load_read += allocated->weight;
 		
 		allocated->host = pstrdup(previous_dn->dataNodeIp);
 		allocated->rest_port = previous_dn->port;
@@ -747,6 +898,7 @@ static DatanodeProcessingLoad* get_dn_processing_load(List **allDNProcessingLoad
 		dn_found->port = fragment_host->rest_port;
 		dn_found->num_fragments_read = 0;
 		dn_found->num_fragments_residing = 0;
+		dn_found->load_read = 0;
 		*allDNProcessingLoads = lappend(*allDNProcessingLoads, dn_found);
 	}
 		
@@ -79,6 +79,19 @@ typedef struct
 
 	/* true on upload, false on download */
 	bool upload;
+
+	/* download is fetched ahead of being read: the transfer
+	 * is paused once that many bytes are buffered (0 - no limit)
+	 */
+	int prefetch_limit;
+
+	/* true if the transfer is paused by write_callback,
+	 * or by read_callback when there is nothing to upload yet
+	 */
+	bool paused;
+
+	/* true once all the data of an upload was written */
+	bool upload_done;
 } churl_context;
 
 /*
@@ -96,10 +109,11 @@ void set_curl_option(churl_context* context, CURLoption option, const void* data
 size_t read_callback(void *ptr, size_t size, size_t nmemb, void *userdata);
 void setup_multi_handle(churl_context* context);
 void multi_perform(churl_context* context);
+void resume_transfer(churl_context* context);
 bool internal_buffer_large_enough(churl_buffer* buffer, size_t required);
 void flush_internal_buffer(churl_context* context);
+void make_room_in_upload_buffer(churl_context* context, size_t required);
 char* get_dest_address(CURL* curl_handle);
-void enlarge_internal_buffer(churl_buffer* buffer, size_t required);
 void finish_upload(churl_context* context);
 void cleanup_curl_handle(churl_context* context);
 void multi_remove_handle(churl_context* context);
@@ -330,6 +344,10 @@ CHURL_HANDLE churl_init_upload(const char* url, CHURL_HEADERS headers)
 
 	context->upload = true;
 
+	/* rows are batched up to writable_external_table_bufsize before waiting for the network */
+	context->upload_buffer->max = writable_external_table_bufsize * 1024;
+	context->upload_buffer->ptr = palloc(context->upload_buffer->max);
+
 	set_curl_option(context, CURLOPT_POST, (const void*) TRUE);
 	set_curl_option(context, CURLOPT_READFUNCTION, read_callback);
 	set_curl_option(context, CURLOPT_READDATA, context);
@@ -375,6 +393,11 @@ void churl_download_restart(CHURL_HANDLE handle, const char* url, CHURL_HEADERS
 
 /*
  * upload
+ *
+ * The data is appended to the upload buffer, and libcurl sends it in the
+ * background whenever another CURL_MAX_WRITE_SIZE bytes are buffered.
+ * We only wait for the network when the buffer is full, and then only
+ * until there is room for the new data.
  */
 size_t churl_write(CHURL_HANDLE handle, const char* buf, size_t bufsize)
 {
@@ -384,14 +407,20 @@ size_t churl_write(CHURL_HANDLE handle, const char* buf, size_t bufsize)
 
 	if (!internal_buffer_large_enough(context_buffer, bufsize))
 	{
-		flush_internal_buffer(context);
+		make_room_in_upload_buffer(context, bufsize);
 		if (!internal_buffer_large_enough(context_buffer, bufsize))
-			enlarge_internal_buffer(context_buffer, bufsize);
+			realloc_internal_buffer(context_buffer, bufsize);
 	}
 
 	memcpy(context_buffer->ptr + context_buffer->top, buf, bufsize);
 	context_buffer->top += bufsize;
 
+	if (context_buffer->top - context_buffer->bot >= CURL_MAX_WRITE_SIZE)
+	{
+		resume_transfer(context);
+		multi_perform(context);
+	}
+
 	return bufsize;
 }
 
@@ -435,6 +464,20 @@ size_t churl_read(CHURL_HANDLE handle, char* buf, size_t max_size)
 	return n;
 }
 
+/*
+ * download ahead of reading: make progress on the transfer without waiting
+ * for data, buffering at most max_buffered bytes until the handle is read.
+ */
+void churl_read_prefetch(CHURL_HANDLE handle, size_t max_buffered)
+{
+	churl_context* context = (churl_context*)handle;
+	Assert(!context->upload);
+
+	context->prefetch_limit = max_buffered;
+	if (!context->paused && context->curl_still_running)
+		multi_perform(context);
+}
+
 void churl_cleanup(CHURL_HANDLE handle, bool after_error)
 {
 	churl_context* context = (churl_context*)handle;
@@ -512,7 +555,9 @@ void set_curl_option(churl_context* context, CURLoption option, const void* data
 /*
  * Called by libcurl perform during an upload.
  * Copies data from internal buffer to libcurl's buffer.
- * Once zero is returned, libcurl knows upload is over
+ * Once zero is returned, libcurl knows upload is over.
+ * If the buffer is empty before that, the transfer is paused
+ * until more data is written.
  */
 size_t read_callback(void *ptr, size_t size, size_t nmemb, void *userdata)
 {
@@ -521,6 +566,12 @@ size_t read_callback(void *ptr, size_t size, size_t nmemb, void *userdata)
 
 	int written = Min(size * nmemb, context_buffer->top - context_buffer->bot);
 
+	if (written == 0 && !context->upload_done)
+	{
+		context->paused = true;
+		return CURL_READFUNC_PAUSE;
+	}
+
 	memcpy(ptr, context_buffer->ptr + context_buffer->bot, written);
 	context_buffer->bot += written;
 
@@ -566,6 +617,26 @@ void multi_perform(churl_context* context)
 			 curl_error, curl_easy_strerror(curl_error));
 }
 
+/*
+ * Lifts the prefetch limit of a download that is read now,
+ * and resumes its transfer if write_callback paused it.
+ * For an upload, resumes the transfer read_callback paused
+ * once there is more data to send.
+ */
+void resume_transfer(churl_context* context)
+{
+	int curl_error;
+
+	context->prefetch_limit = 0;
+	if (!context->paused)
+		return;
+
+	context->paused = false;
+	if (CURLE_OK != (curl_error = curl_easy_pause(context->curl_handle, CURLPAUSE_CONT)))
+		elog(ERROR, "internal error: curl_easy_pause failed (%d - %s)",
+			 curl_error, curl_easy_strerror(curl_error));
+}
+
 bool internal_buffer_large_enough(churl_buffer* buffer, size_t required)
 {
 	return ((buffer->top + required) <= buffer->max);
@@ -577,6 +648,7 @@ void flush_internal_buffer(churl_context* context)
 	if (context_buffer->top == 0)
 		return;
 
+	resume_transfer(context);
 	while((context->curl_still_running != 0) &&
 		  ((context_buffer->top - context_buffer->bot) > 0))
 	{
@@ -598,6 +670,37 @@ void flush_internal_buffer(churl_context* context)
 	context_buffer->bot = 0;
 }
 
+/*
+ * Lets libcurl send the upload buffer until the data it did not send yet
+ * leaves room for required more bytes, and moves that data to the start
+ * of the buffer.
+ */
+void make_room_in_upload_buffer(churl_context* context, size_t required)
+{
+	churl_buffer* context_buffer = context->upload_buffer;
+
+	resume_transfer(context);
+	while ((context->curl_still_running != 0) &&
+		   (context_buffer->top - context_buffer->bot) > 0 &&
+		   (context_buffer->top - context_buffer->bot) + required > context_buffer->max)
+	{
+		/*
+		 * Allow canceling a query while waiting for the remote service
+		 */
+		CHECK_FOR_INTERRUPTS();
+
+		multi_perform(context);
+	}
+
+	if ((context->curl_still_running == 0) &&
+		((context_buffer->top - context_buffer->bot) > 0))
+		elog(ERROR, "failed sending to remote component %s", get_dest_address(context->curl_handle));
+
+	check_response(context);
+
+	compact_internal_buffer(context_buffer);
+}
+
 /*
  * Returns the remote ip and port of the curl response.
  * If it's not available, returns an empty string.
@@ -619,15 +722,6 @@ char* get_dest_address(CURL* curl_handle) {
 	return addr.data;
 }
 
-void enlarge_internal_buffer(churl_buffer* buffer, size_t required)
-{
-	if (buffer->ptr != NULL)
-		pfree(buffer->ptr);
-
-	buffer->max = required + 1024;
-	buffer->ptr = palloc(buffer->max);
-}
-
 /*
  * Let libcurl finish the upload by
  * calling perform repeatedly
@@ -642,6 +736,8 @@ void finish_upload(churl_context* context)
 	/* allow read_callback to say 'all done'
 	 * by returning a zero thus ending the connection
 	 */
+	context->upload_done = true;
+	resume_transfer(context);
 	while(context->curl_still_running != 0)
 		multi_perform(context);
 
@@ -707,6 +803,17 @@ size_t write_callback(char *buffer, size_t size, size_t nitems, void *userp)
     churl_context* context = (churl_context*)userp;
     churl_buffer* context_buffer = context->download_buffer;
 	const int 	nbytes = size * nitems;
+	const int	buffered = context_buffer->top - context_buffer->bot;
+
+	/* a prefetched download holds a bounded amount of data;
+	 * libcurl keeps the rest until the transfer is resumed
+	 */
+	if (context->prefetch_limit > 0 && buffered > 0 &&
+		buffered + nbytes > context->prefetch_limit)
+	{
+		context->paused = true;
+		return CURL_WRITEFUNC_PAUSE;
+	}
 
 	if (!internal_buffer_large_enough(context_buffer, nbytes))
 	{
@@ -735,6 +842,9 @@ int fill_internal_buffer(churl_context* context, int want)
     struct 	timeval timeout;
     int 	nfds, curl_error;
 
+    /* the handle may have been prefetched */
+    resume_transfer(context);
+
     /* attempt to fill buffer */
 	while (context->curl_still_running &&
 		   ((context->download_buffer->top - context->download_buffer->bot) < want))
@@ -492,6 +492,45 @@ bool InvokePlugStorageFormatGetNext(FmgrInfo *func,
 	return has_tuple;
 }
 
+int InvokePlugStorageFormatGetNextBatch(FmgrInfo *func,
+                                        FileScanDesc fileScanDesc,
+                                        ScanState *scanState,
+                                        int maxRows,
+                                        bool *proj,
+                                        Datum **values,
+                                        bool **nulls)
+{
+	PlugStorageData psdata;
+	FunctionCallInfoData fcinfo;
+
+	psdata.type                = T_PlugStorageData;
+	psdata.ps_file_scan_desc   = fileScanDesc;
+	psdata.ps_scan_state       = scanState;
+	psdata.ps_batch_max_rows   = maxRows;
+	psdata.ps_batch_num_rows   = 0;
+	psdata.ps_batch_proj       = proj;
+	psdata.ps_batch_values     = values;
+	psdata.ps_batch_nulls      = nulls;
+
+	InitFunctionCallInfoData(fcinfo,  // FunctionCallInfoData
+	                         func,    // FmgrInfo
+	                         0,       // nArgs
+	                         (Node *)(&psdata), // Call Context
+	                         NULL);             // ResultSetInfo
+
+	// Invoke function
+	FunctionCallInvoke(&fcinfo);
+
+	// We do not expect a null result
+	if (fcinfo.isnull)
+	{
+		elog(ERROR, "function %u returned NULL",
+		            fcinfo.flinfo->fn_oid);
+	}
+
+	return psdata.ps_batch_num_rows;
+}
+
 void InvokePlugStorageFormatReScan(FmgrInfo *func,
                                    FileScanDesc fileScanDesc,
                                    ScanState* scanState,
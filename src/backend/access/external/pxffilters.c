@@ -37,6 +37,7 @@ static char* pxf_serialize_filter_list(List *filters);
 static bool opexpr_to_pxffilter(OpExpr *expr, PxfFilterDesc *filter);
 static bool scalar_array_op_expr_to_pxffilter(ScalarArrayOpExpr *expr, PxfFilterDesc *filter);
 static bool var_to_pxffilter(Var *var, PxfFilterDesc *filter);
+static Node* strip_relabel_type(Node *node);
 static bool supported_filter_type(Oid type);
 static bool supported_operator_type_op_expr(Oid type, PxfFilterDesc *filter);
 static bool supported_operator_type_scalar_array_op_expr(Oid type, PxfFilterDesc *filter, bool useOr);
@@ -86,6 +87,30 @@ dbop_pxfop_map pxf_supported_opr_op_expr[] =
 	{531 /* textlt  */, PXFOP_NE},
 	{1209 /* textlike  */, PXFOP_LIKE},
 
+	/* float4 */
+	{620 /* float4eq */, PXFOP_EQ},
+	{622 /* float4lt */, PXFOP_LT},
+	{623 /* float4gt */, PXFOP_GT},
+	{624 /* float4le */, PXFOP_LE},
+	{625 /* float4ge */, PXFOP_GE},
+	{621 /* float4ne */, PXFOP_NE},
+
+	/* numeric */
+	{1752 /* numeric_eq */, PXFOP_EQ},
+	{1754 /* numeric_lt */, PXFOP_LT},
+	{1756 /* numeric_gt */, PXFOP_GT},
+	{1755 /* numeric_le */, PXFOP_LE},
+	{1757 /* numeric_ge */, PXFOP_GE},
+	{1753 /* numeric_ne */, PXFOP_NE},
+
+	/* timestamp */
+	{2060 /* timestamp_eq */, PXFOP_EQ},
+	{2062 /* timestamp_lt */, PXFOP_LT},
+	{2064 /* timestamp_gt */, PXFOP_GT},
+	{2063 /* timestamp_le */, PXFOP_LE},
+	{2065 /* timestamp_ge */, PXFOP_GE},
+	{2061 /* timestamp_ne */, PXFOP_NE},
+
 	/* int2 to int4 */
 	{Int24EqualOperator /* int24eq */, PXFOP_EQ},
 	{534  /* int24lt */, PXFOP_LT},
@@ -165,6 +190,7 @@ dbop_pxfop_map pxf_supported_opr_op_expr[] =
 	{1059 /* bpcharle */, PXFOP_LE},
 	{1061 /* bpcharge */, PXFOP_GE},
 	{1057 /* bpcharne */, PXFOP_NE},
+	{1211 /* bpcharlike */, PXFOP_LIKE},
 
 	/* boolean */
 	{BooleanEqualOperator  /* booleq */, PXFOP_EQ},
@@ -607,12 +633,14 @@ pxf_serialize_filter_list(List *expressionItems)
 			{
 				elog(DEBUG1, "pxf_serialize_filter_list: node tag %d (T_NullTest)", tag);
 				NullTest *expr = (NullTest *) node;
-				Var *var = (Var *) expr->arg;
+				Var *var = (Var *) strip_relabel_type((Node *) expr->arg);
 
-				//TODO: add check for supported operation
-				if (!supported_filter_type(var->vartype))
+				/* only a column, or a binary compatible cast of it, can be tested */
+				if (!IsA(var, Var) || var->varattno <= InvalidAttrNumber ||
+					!supported_filter_type(var->vartype))
 				{
 					elog(DEBUG1, "Query will not be optimized to use filter push-down.");
+					pfree(resbuf->data);
 					return NULL;
 				}
 
@@ -699,6 +727,9 @@ opexpr_to_pxffilter(OpExpr *expr, PxfFilterDesc *filter)
 	if (!supported_operator_type_op_expr(expr->opno, filter))
 		return false;
 
+	leftop = strip_relabel_type(leftop);
+	rightop = strip_relabel_type(rightop);
+
 	/* arguments must be VAR and CONST */
 	if (IsA(leftop,  Var) && IsA(rightop, Const))
 	{
@@ -761,6 +792,9 @@ scalar_array_op_expr_to_pxffilter(ScalarArrayOpExpr *expr, PxfFilterDesc *filter
 	if(!supported_operator_type_scalar_array_op_expr(expr->opno, filter, expr->useOr))
 		return false;
 
+	leftop = strip_relabel_type(leftop);
+	rightop = strip_relabel_type(rightop);
+
 	if (IsA(leftop, Var) && IsA(rightop, Const))
 	{
 		filter->l.opcode = PXF_ATTR_CODE;
@@ -840,6 +874,22 @@ var_to_pxffilter(Var *var, PxfFilterDesc *filter)
 	return true;
 }
 
+/*
+ * strip_relabel_type
+ *
+ * A binary compatible cast, e.g. of a varchar column compared with
+ * a text constant, doesn't change the value of its argument: look
+ * through it to the Var or Const underneath.
+ */
+static Node*
+strip_relabel_type(Node *node)
+{
+	while (node && IsA(node, RelabelType))
+		node = (Node *) ((RelabelType *) node)->arg;
+
+	return node;
+}
+
 static List*
 append_attr_from_var(Var* var, List* attrs)
 {
@@ -1285,7 +1335,13 @@ List* extractPxfAttributes(List* quals)
 			case T_NullTest:
 			{
 				NullTest* expr = (NullTest *) node;
-				attributes = append_attr_from_var((Var *) expr->arg, attributes);
+				Node* arg = strip_relabel_type((Node *) expr->arg);
+				if (!IsA(arg, Var))
+				{
+					elog(INFO, "extractPxfAttributes: unsupported argument of a null test, unable to extract attribute from qualifier");
+					return NIL;
+				}
+				attributes = append_attr_from_var((Var *) arg, attributes);
 				break;
 			}
 			case T_BooleanTest:
@@ -0,0 +1,194 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*-------------------------------------------------------------------------
+ *
+ * pxffragmentscache.c
+ *	  Session cache of the responses of the PXF Fragmenter.
+ *
+ * Fragmenting an external table can be expensive: for a Hive table with
+ * many partitions PXF lists all their files through the metastore. The QD
+ * keeps the responses of the Fragmenter for pxf_fragments_cache_ttl seconds,
+ * so that repeated queries over the same data in a session skip that call.
+ *
+ * The key of a response describes everything the Fragmenter depends on: the
+ * location of the external table, the filter pushed down to it and the user.
+ * A response is dropped when it expires, when its external table is altered
+ * or dropped (through the relcache invalidation callback), or when the cache
+ * is full and the response is the oldest one.
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/pxffragmentscache.h"
+#include "nodes/pg_list.h"
+#include "utils/guc.h"
+#include "utils/inval.h"
+#include "utils/memutils.h"
+#include "utils/timestamp.h"
+
+/* limits on the memory used by the cache */
+#define PXF_FRAGMENTS_CACHE_MAX_ENTRIES	64
+#define PXF_FRAGMENTS_CACHE_MAX_SIZE	(64 * 1024 * 1024)
+
+typedef struct PxfFragmentsCacheEntry
+{
+	Oid			relid;			/* the external table */
+	char	   *key;
+	char	   *response;		/* the JSON response of the Fragmenter */
+	Size		size;			/* length of response */
+	TimestampTz fetch_time;		/* when the Fragmenter was called */
+} PxfFragmentsCacheEntry;
+
+static MemoryContext PxfFragmentsCacheContext = NULL;
+static List *PxfFragmentsCacheEntries = NIL;	/* oldest entry first */
+static Size PxfFragmentsCacheSize = 0;
+
+static void PxfFragmentsCacheInit(void);
+static void PxfFragmentsCacheRemove(PxfFragmentsCacheEntry *entry);
+static void PxfFragmentsCacheRelcacheCallback(Datum arg, Oid relid);
+
+const char *
+PxfFragmentsCacheLookup(const char *key)
+{
+	ListCell   *lc;
+
+	if (pxf_fragments_cache_ttl <= 0)
+		return NULL;
+
+	foreach(lc, PxfFragmentsCacheEntries)
+	{
+		PxfFragmentsCacheEntry *entry = (PxfFragmentsCacheEntry *) lfirst(lc);
+
+		if (strcmp(entry->key, key) != 0)
+			continue;
+
+		if (TimestampDifferenceExceeds(entry->fetch_time, GetCurrentTimestamp(),
+									   pxf_fragments_cache_ttl * 1000))
+		{
+			elog(DEBUG2, "PXF fragments cache: response for %s expired", key);
+			PxfFragmentsCacheRemove(entry);
+			return NULL;
+		}
+
+		elog(DEBUG2, "PXF fragments cache: reusing response for %s", key);
+		return entry->response;
+	}
+
+	return NULL;
+}
+
+void
+PxfFragmentsCacheInsert(Oid relid, const char *key, const char *response)
+{
+	PxfFragmentsCacheEntry *entry;
+	MemoryContext oldcontext;
+	ListCell   *lc;
+	Size		size = strlen(response);
+
+	if (pxf_fragments_cache_ttl <= 0 || size > PXF_FRAGMENTS_CACHE_MAX_SIZE)
+		return;
+
+	PxfFragmentsCacheInit();
+
+	/* replace a previous response for the key */
+	foreach(lc, PxfFragmentsCacheEntries)
+	{
+		entry = (PxfFragmentsCacheEntry *) lfirst(lc);
+		if (strcmp(entry->key, key) == 0)
+		{
+			PxfFragmentsCacheRemove(entry);
+			break;
+		}
+	}
+
+	/* make room by evicting the oldest responses */
+	while (PxfFragmentsCacheEntries != NIL &&
+		   (list_length(PxfFragmentsCacheEntries) >= PXF_FRAGMENTS_CACHE_MAX_ENTRIES ||
+			PxfFragmentsCacheSize + size > PXF_FRAGMENTS_CACHE_MAX_SIZE))
+		PxfFragmentsCacheRemove((PxfFragmentsCacheEntry *) linitial(PxfFragmentsCacheEntries));
+
+	oldcontext = MemoryContextSwitchTo(PxfFragmentsCacheContext);
+	entry = (PxfFragmentsCacheEntry *) palloc(sizeof(PxfFragmentsCacheEntry));
+	entry->relid = relid;
+	entry->key = pstrdup(key);
+	entry->response = pstrdup(response);
+	entry->size = size;
+	entry->fetch_time = GetCurrentTimestamp();
+	PxfFragmentsCacheEntries = lappend(PxfFragmentsCacheEntries, entry);
+	MemoryContextSwitchTo(oldcontext);
+
+	PxfFragmentsCacheSize += size;
+}
+
+void
+PxfFragmentsCacheInvalidate(Oid relid)
+{
+	ListCell   *lc;
+	ListCell   *next;
+
+	for (lc = list_head(PxfFragmentsCacheEntries); lc != NULL; lc = next)
+	{
+		PxfFragmentsCacheEntry *entry = (PxfFragmentsCacheEntry *) lfirst(lc);
+
+		next = lnext(lc);
+		if (!OidIsValid(relid) || entry->relid == relid)
+			PxfFragmentsCacheRemove(entry);
+	}
+}
+
+/*
+ * Create the memory context of the cache, and register the invalidation
+ * callback, the first time a response is cached.
+ */
+static void
+PxfFragmentsCacheInit(void)
+{
+	if (PxfFragmentsCacheContext != NULL)
+		return;
+
+	PxfFragmentsCacheContext = AllocSetContextCreate(TopMemoryContext,
+													 "PXF fragments cache",
+													 ALLOCSET_DEFAULT_MINSIZE,
+													 ALLOCSET_DEFAULT_INITSIZE,
+													 ALLOCSET_DEFAULT_MAXSIZE);
+	CacheRegisterRelcacheCallback(PxfFragmentsCacheRelcacheCallback, (Datum) 0);
+}
+
+static void
+PxfFragmentsCacheRemove(PxfFragmentsCacheEntry *entry)
+{
+	PxfFragmentsCacheEntries = list_delete_ptr(PxfFragmentsCacheEntries, entry);
+	PxfFragmentsCacheSize -= entry->size;
+	pfree(entry->key);
+	pfree(entry->response);
+	pfree(entry);
+}
+
+/*
+ * An invalidation of the relcache entry of the external table means that it
+ * may have been altered or dropped. relid is InvalidOid when the whole
+ * relcache is reset.
+ */
+static void
+PxfFragmentsCacheRelcacheCallback(Datum arg, Oid relid)
+{
+	PxfFragmentsCacheInvalidate(relid);
+}
@@ -27,12 +27,15 @@
  */
 #include <json-c/json.h>
 #include "access/pxfmasterapi.h"
+#include "access/pxffragmentscache.h"
 #include "catalog/external/externalmd.h"
+#include "miscadmin.h"
+#include "utils/guc.h"
 
 static List* parse_datanodes_response(List *rest_srvrs, StringInfo rest_buf);
 static PxfFragmentStatsElem *parse_get_frag_stats_response(StringInfo rest_buf);
 static float4 normalize_size(long size, char* unit);
-static List* parse_get_fragments_response(List* fragments, StringInfo rest_buf);
+static List* parse_get_fragments_response(List* fragments, const char *response);
 static void ha_failover(GPHDUri *hadoop_uri, ClientContext *client_context, char* rest_msg);
 static void rest_request(GPHDUri *hadoop_uri, ClientContext* client_context, char *rest_msg);
 static char* concat(int num_args, ...);
@@ -279,22 +282,48 @@ char* concat(int num_args, ...)
  * get_data_fragment_list
  *
  * 1. Request a list of fragments from the PXF Fragmenter class
- * that was specified in the pxf URL.
+ * that was specified in the pxf URL, unless the fragments cache
+ * holds the response of a previous request for the same external
+ * table relid, the same filter and the same user.
  *
  * 2. Process the returned list and create a list of DataFragment with it.
  */
 List*
 get_data_fragment_list(GPHDUri *hadoop_uri,
-					   ClientContext *client_context)
+					   ClientContext *client_context,
+					   Oid relid,
+					   char *filterstr)
 {
 	List *data_fragments = NIL;
-	char *restMsg = concat(2, "http://%s:%s/%s/%s/Fragmenter/getFragments?path=", hadoop_uri->data);
+	StringInfoData cache_key;
+	const char *cached_response = NULL;
 
-	rest_request(hadoop_uri, client_context, restMsg);
+	initStringInfo(&cache_key);
+	if (pxf_fragments_cache_ttl > 0)
+	{
+		appendStringInfo(&cache_key, "%s filter=%s user=%u",
+						 hadoop_uri->uri, filterstr ? filterstr : "", GetUserId());
+		cached_response = PxfFragmentsCacheLookup(cache_key.data);
+	}
 
-	/* parse the JSON response and form a fragments list to return */
-	data_fragments = parse_get_fragments_response(data_fragments, &(client_context->the_rest_buf));
+	if (cached_response)
+	{
+		data_fragments = parse_get_fragments_response(data_fragments, cached_response);
+	}
+	else
+	{
+		char *restMsg = concat(2, "http://%s:%s/%s/%s/Fragmenter/getFragments?path=", hadoop_uri->data);
 
+		rest_request(hadoop_uri, client_context, restMsg);
+
+		/* parse the JSON response and form a fragments list to return */
+		data_fragments = parse_get_fragments_response(data_fragments, client_context->the_rest_buf.data);
+
+		if (pxf_fragments_cache_ttl > 0)
+			PxfFragmentsCacheInsert(relid, cache_key.data, client_context->the_rest_buf.data);
+	}
+
+	pfree(cache_key.data);
 	return data_fragments;
 }
 
@@ -308,9 +337,9 @@ get_data_fragment_list(GPHDUri *hadoop_uri,
  * {"PXFFragments":[{"index":0,"userData":null,"sourceName":"demo/text2.csv","metadata":"rO0ABXcQAAAAAAAAAAAAAAAAAAAABXVyABNbTGphdmEubGFuZy5TdHJpbmc7rdJW5+kde0cCAAB4cAAAAAN0ABxhZXZjZWZlcm5hczdtYnAuY29ycC5lbWMuY29tdAAcYWV2Y2VmZXJuYXM3bWJwLmNvcnAuZW1jLmNvbXQAHGFldmNlZmVybmFzN21icC5jb3JwLmVtYy5jb20=","replicas":["10.207.4.23","10.207.4.23","10.207.4.23"]},{"index":0,"userData":null,"sourceName":"demo/text_csv.csv","metadata":"rO0ABXcQAAAAAAAAAAAAAAAAAAAABnVyABNbTGphdmEubGFuZy5TdHJpbmc7rdJW5+kde0cCAAB4cAAAAAN0ABxhZXZjZWZlcm5hczdtYnAuY29ycC5lbWMuY29tdAAcYWV2Y2VmZXJuYXM3bWJwLmNvcnAuZW1jLmNvbXQAHGFldmNlZmVybmFzN21icC5jb3JwLmVtYy5jb20=","replicas":["10.207.4.23","10.207.4.23","10.207.4.23"]}]}
  */
 static List*
-parse_get_fragments_response(List *fragments, StringInfo rest_buf)
+parse_get_fragments_response(List *fragments, const char *response)
 {
-	struct json_object	*whole	= json_tokener_parse(rest_buf->data);
+	struct json_object	*whole	= json_tokener_parse(response);
 	if (whole == NULL)
 	{
 		elog(ERROR, "Failed to parse fragments list from PXF");
@@ -363,6 +392,11 @@ parse_get_fragments_response(List *fragments, StringInfo rest_buf)
 		if (js_profile)
 			fragment->profile = pstrdup(json_object_get_string(js_profile));
 
+		/* 6. length - fragment length in bytes, used to balance the fragments between the segments */
+		struct json_object *js_length = json_object_object_get(js_fragment, "length");
+		if (js_length)
+			fragment->length = json_object_get_int64(js_length);
+
 		/*
 		 * HD-2547:
 		 * Ignore fragment if it doesn't contain any host locations,
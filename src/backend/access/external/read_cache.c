@@ -21,11 +21,17 @@
 #include "miscadmin.h"
 
 #include "access/read_cache.h"
+#include "access/xact.h"
+#include "catalog/pg_class.h"
+#include "catalog/pg_exttable.h"
+#include "cdb/cdbpartition.h"
 #include "cdb/cdbvars.h"
 #include "optimizer/clauses.h"
 #include "optimizer/newPlanner.h"
 #include "storage/shmem.h"
+#include "utils/guc.h"
 #include "utils/hsearch.h"
+#include "utils/lsyscache.h"
 
 #include "executor/cwrapper/cached-result.h"
 
@@ -47,6 +53,7 @@ typedef struct ReadCacheHashEntryPendingReviseData {
 } ReadCacheHashEntryPendingReviseData;
 
 static int64_t ReadCacheLookupHashEntry(Oid relid);
+static List *ReadCacheRelationOids(List *relationOids);
 
 void InitReadCache(void) {
   HASHCTL info;
@@ -109,6 +116,27 @@ void ReadCacheHashEntryReviseOnCommit(Oid relid, bool dropTable) {
   }
 }
 
+/*
+ * Revise the relation again once the commit that wrote it is visible.
+ *
+ * AtEOXact_ReadCache revises before the commit is visible, so a query that
+ * starts between the two takes the new revision with a snapshot that does not
+ * see the new data yet, and would cache the old data under it. The appends to
+ * append only tables, which do not lock the readers out, call this after the
+ * commit so that such a result is never found.
+ */
+void ReadCacheHashEntryRevise(Oid relid) {
+  ReadCacheHashData *entry;
+
+  if (Gp_role != GP_ROLE_DISPATCH) return;
+
+  LWLockAcquire(ReadCacheLock, LW_EXCLUSIVE);
+  entry = (ReadCacheHashData *)hash_search(ReadCacheHash, (void *)&relid,
+                                           HASH_FIND, NULL);
+  if (entry) ++entry->revisionNum;
+  LWLockRelease(ReadCacheLock);
+}
+
 void AtEOXact_ReadCache(bool commit) {
   if (Gp_role != GP_ROLE_DISPATCH) return;
 
@@ -148,27 +176,70 @@ void AtEOXact_ReadCache(bool commit) {
 }
 
 void resetReadCache(bool enable) {
-  if (enable_secure_filesystem || !magma_cache_read) enable = false;
+  if (enable_secure_filesystem || !(magma_cache_read || ao_cache_read))
+    enable = false;
   CachedResultReset(MyCachedResult, enable);
 }
 
 void initReadCache(PlannedStmt *plannedStmt, const char *sourceText) {
-  if (magma_cache_read && CachedResultSafeGuard(MyCachedResult)) {
+  if ((magma_cache_read || ao_cache_read) &&
+      CachedResultSafeGuard(MyCachedResult)) {
     // check the relation oid the plan depends on
-    bool toContinue = (plannedStmt->relationOids != NIL);
+    List *relationOids = ReadCacheRelationOids(plannedStmt->relationOids);
+    bool toContinue = (relationOids != NIL);
+    bool hasAoRel = false;
     ListCell *cell = NULL;
-    foreach (cell, plannedStmt->relationOids) {
-      if (!RelationIsMagmaTable2(lfirst_oid(cell))) {
+    foreach (cell, relationOids) {
+      Oid relid = lfirst_oid(cell);
+      char relstorage = get_rel_relstorage(relid);
+
+      if (relstorage == RELSTORAGE_AOROWS || relstorage == RELSTORAGE_PARQUET) {
+        /*
+         * The revision of an append only table is only safe against the
+         * snapshot of a statement taken after it.
+         */
+        if (!ao_cache_read || IsXactIsoLevelSerializable) {
+          toContinue = false;
+          break;
+        }
+        hasAoRel = true;
+      } else if (!magma_cache_read || !RelationIsMagmaTable2(relid)) {
         toContinue = false;
         break;
       }
     }
 
+    int32_t relNum = list_length(relationOids);
+    int64_t *relids = NULL;
+    int64_t *revisions = NULL;
+    if (toContinue) {
+      relids = (int64_t *)palloc(relNum * sizeof(int64_t));
+      revisions = (int64_t *)palloc(relNum * sizeof(int64_t));
+      int32_t i = 0;
+      foreach (cell, relationOids) {
+        Oid relid = lfirst_oid(cell);
+        relids[i] = relid;
+        revisions[i] = ReadCacheLookupHashEntry(relid);
+        /*
+         * Our own transaction wrote the table, the result is not to be seen
+         * by others as the cached result of the revision.
+         */
+        if (hasAoRel && revisions[i] < 0) toContinue = false;
+        ++i;
+      }
+    }
+
+    /*
+     * The data of an append only table only changes with its revision, a
+     * stable function such as now() is not to be cached with it.
+     */
     if (toContinue) {
       CommonPlanContext ctx;
       ctx.base.node = (Node *)plannedStmt;
       toContinue = !plan_tree_walker((Node *)plannedStmt->planTree,
-                                     check_volatile_functions, &ctx);
+                                     hasAoRel ? check_mutable_functions
+                                              : check_volatile_functions,
+                                     &ctx);
     }
 
     if (toContinue) {
@@ -181,26 +252,15 @@ void initReadCache(PlannedStmt *plannedStmt, const char *sourceText) {
       char *str3 = nodeToBinaryStringFast((Node *)plannedStmt->rtable, &len3);
       outfast_workfile_mgr_end();
 
-      int32_t relNum = list_length(plannedStmt->relationOids);
-      int64_t *relids = (int64_t *)palloc(relNum * sizeof(int64_t));
-      int64_t *revisions = (int64_t *)palloc(relNum * sizeof(int64_t));
-      LWLockAcquire(ReadCacheLock, LW_SHARED);
-      int32_t i = 0;
-      foreach (cell, plannedStmt->relationOids) {
-        Oid relid = lfirst_oid(cell);
-        relids[i] = relid;
-        revisions[i] = ReadCacheLookupHashEntry(relid);
-        ++i;
-      }
-      LWLockRelease(ReadCacheLock);
       CachedResultInit(MyCachedResult, GetCurrentTransactionId(), relids,
                        revisions, relNum, sourceText, str1, len1, str2, len2,
                        str3, len3);
-      pfree(relids);
-      pfree(revisions);
     } else {
       CachedResultReset(MyCachedResult, false);
     }
+
+    if (relids) pfree(relids);
+    if (revisions) pfree(revisions);
   }
 }
 
@@ -236,9 +296,9 @@ static int64_t ReadCacheLookupHashEntry(Oid relid) {
   LWLockAcquire(ReadCacheLock, LW_SHARED);
   ReadCacheHashData *entry = (ReadCacheHashData *)hash_search(
       ReadCacheHash, (void *)&relid, HASH_FIND, &found);
+  if (entry) revisionNum = entry->revisionNum;
   LWLockRelease(ReadCacheLock);
 
-  if (entry) revisionNum = entry->revisionNum;
   if (ReadCacheHashEntryPendingRevise) {
     ReadCacheHashEntryPendingReviseData *node =
         (ReadCacheHashEntryPendingReviseData *)hash_search(
@@ -250,3 +310,22 @@ static int64_t ReadCacheLookupHashEntry(Oid relid) {
   }
   return revisionNum;
 }
+
+/*
+ * The relations of the plan, with the partitions of the partitioned ones, as
+ * a partition may be written to directly without the revision of its parent.
+ */
+static List *ReadCacheRelationOids(List *relationOids) {
+  List *result = NIL;
+  ListCell *cell;
+
+  foreach (cell, relationOids) {
+    Oid relid = lfirst_oid(cell);
+
+    if (rel_is_partitioned(relid))
+      result = list_union_oid(result, find_all_inheritors(relid));
+    else
+      result = list_append_unique_oid(result, relid);
+  }
+  return result;
+}
@@ -51,6 +51,7 @@ static void print_segments_list();
 void clean_allocated_fragments(List **allocated_fragments, int total_segs);
 static void validate_total_fragments_allocated(List **allocated_fragments, int total_segs, int input_total_fragments);
 static void validate_max_load_per_segment(List **allocated_fragments, int total_segs, int working_segs, int input_total_fragments);
+static void validate_max_length_per_segment(List **allocated_fragments, int total_segs, int working_segs, List *input_fragments);
 static int calc_load_per_segment(int input_total_fragments, int working_segs);
 static void validate_all_working_segments_engagement(List **allocated_fragments, 
 													 int total_segs, 
@@ -83,6 +84,7 @@ typedef struct sTestInputData
 	 * in createplan.c
 	 */
 	int m_num_working_segs; 
+	bool m_skewed_fragment_lengths; /* the fragments report their length, and every fourth one is much longer */
 	bool m_enable_print_input_cluster;
 	bool m_enable_print_input_fragments;
 	bool m_enable_print_input_segments;
@@ -207,6 +209,27 @@ test__distribute_work_to_gp_segments__small_cluster_few_replicas(void **state)
 	pfree(input);
 }
 
+void
+test__distribute_work_to_gp_segments__skewed_fragment_lengths(void **state)
+{
+	TestInputData *input = (TestInputData*)palloc0(sizeof(TestInputData));
+	
+	input->m_num_hosts_in_cluster = 100; /* cluster size musn't exceed 65025 - see function create_cluster() */
+	input->m_num_data_fragments = 200; /* number of fragments in the data we intend to allocate between the hawq segments */
+	input->m_num_active_data_nodes = 50; /* number of datanodes that hold the 'querried' data - there one datanode om each cluster host - so there are <num_hosts_in_cluster> datanodes */
+	input->m_num_of_fragment_replicas = 3;
+	input->m_num_segments_on_host = 4;/* number of Hawq segments on each cluster host - we assume all cluster hosts have Hawq segments installed */
+	input->m_num_working_segs = 64; /* the subset of Hawq segments that will do the processing  - not all the Hawqs segments in the cluster are involved */
+	input->m_skewed_fragment_lengths = true;
+	input->m_enable_print_input_cluster = false;
+	input->m_enable_print_input_fragments = false;
+	input->m_enable_print_input_segments = false;
+	input->m_enable_print_allocated_fragments = false;
+	
+	test__distribute_work_to_gp_segments(input);
+	pfree(input);
+}
+
 /*
  * Testing distribute_work_2_gp_segments
  */
@@ -250,6 +273,15 @@ static void test__distribute_work_to_gp_segments(TestInputData *input)
 													   num_of_fragment_replicas, /* replicas */
 													   cluster, /* the whole cluster*/
 													   num_hosts_in_cluster/* the number of hosts in the cluster */);
+	if (input->m_skewed_fragment_lengths)
+	{
+		ListCell *frag_cell = NULL;
+		foreach(frag_cell, input_fragments_list)
+		{
+			DataFragment *fragment = (DataFragment*)lfirst(frag_cell);
+			fragment->length = (fragment->index % 4 == 0) ? 1000 : 100;
+		}
+	}
 	if (enable_print_input_fragments)
 		print_fragment_list(input_fragments_list); 
 	
@@ -272,7 +304,10 @@ static void test__distribute_work_to_gp_segments(TestInputData *input)
 	
 	/* 7. The validations - verifying that the expected output was obtained */
 	validate_total_fragments_allocated(segs_allocated_data, total_segs, num_data_fragments);
-	validate_max_load_per_segment(segs_allocated_data, total_segs, num_working_segs, num_data_fragments);
+	if (input->m_skewed_fragment_lengths)
+		validate_max_length_per_segment(segs_allocated_data, total_segs, num_working_segs, input_fragments_list);
+	else
+		validate_max_load_per_segment(segs_allocated_data, total_segs, num_working_segs, num_data_fragments);
 	validate_all_working_segments_engagement(segs_allocated_data, total_segs, num_working_segs, num_data_fragments, num_hosts_in_cluster);
 	
 	/* 8. Cleanup */
@@ -518,6 +553,39 @@ static void validate_max_load_per_segment(List **allocated_fragments, int total_
 	assert_true(load_per_segment_not_exceeded);
 }
 
+/*
+ * validate that the total length of the fragments allocated to a segment does not exceed
+ * the expected length per segment by more than the longest fragment
+ */
+static void validate_max_length_per_segment(List **allocated_fragments, int total_segs, int working_segs, List *input_fragments)
+{
+	ListCell *cell = NULL;
+	int64 total_length = 0;
+	int64 max_fragment_length = 0;
+	int64 max_length = 0;
+	int64 length_per_segment = 0;
+
+	foreach(cell, input_fragments)
+	{
+		DataFragment *fragment = (DataFragment*)lfirst(cell);
+		total_length += fragment->length;
+		max_fragment_length = Max(max_fragment_length, fragment->length);
+	}
+	length_per_segment = (total_length + working_segs - 1) / working_segs;
+
+	for (int i = 0; i < total_segs; i++)
+	{
+		int64 segment_length = 0;
+		foreach(cell, allocated_fragments[i])
+			segment_length += ((AllocatedDataFragment*)lfirst(cell))->weight;
+		max_length = Max(max_length, segment_length);
+	}
+
+	bool length_per_segment_not_exceeded = length_per_segment + max_fragment_length >= max_length;
+	elog(FRAGDEBUG, "actual max_length: " INT64_FORMAT ", expected length_per_segment: " INT64_FORMAT, max_length, length_per_segment);
+	assert_true(length_per_segment_not_exceeded);
+}
+
 /* 
  * we validate that every working segment is engaged, by verifying that for the case when 
  * the load_per_segment is greater than one, then every working_segment has allocated fragments,
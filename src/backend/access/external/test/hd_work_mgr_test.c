@@ -158,7 +158,8 @@ main(int argc, char* argv[])
 			unit_test(test__distribute_work_to_gp_segments__big_cluster_many_active_nodes),
 			unit_test(test__distribute_work_to_gp_segments__small_cluster),
 			unit_test(test__distribute_work_to_gp_segments__small_cluster_many_active_nodes),
-			unit_test(test__distribute_work_to_gp_segments__small_cluster_few_replicas)
+			unit_test(test__distribute_work_to_gp_segments__small_cluster_few_replicas),
+			unit_test(test__distribute_work_to_gp_segments__skewed_fragment_lengths)
 	};
 	return run_tests(tests);
 }
@@ -113,7 +113,7 @@ test__supported_operator_type_op_expr(void **state)
 
 	/* go over pxf_supported_opr_op_expr array */
 	int nargs = sizeof(pxf_supported_opr_op_expr) / sizeof(dbop_pxfop_map);
-	assert_int_equal(nargs, 91);
+	assert_int_equal(nargs, 110);
 	for (i = 0; i < nargs; ++i)
 	{
 		assert_true(supported_operator_type_op_expr(pxf_supported_opr_op_expr[i].dbop, filter));
@@ -715,6 +715,41 @@ test__opexpr_to_pxffilter__differentTypes(void **state)
 	pfree(expr);
 }
 
+/*
+ * A varchar column compared with a text constant is wrapped
+ * in a binary compatible cast.
+ */
+void
+test__opexpr_to_pxffilter__relabeledVar(void **state)
+{
+	PxfFilterDesc *filter = (PxfFilterDesc*) palloc0(sizeof(PxfFilterDesc));
+	Var *arg_var = build_var(VARCHAROID, 2);
+	RelabelType *arg_relabel = (RelabelType*) palloc0(sizeof(RelabelType));
+	char* const_value = strdup("hawq"); /* will be free'd by const_to_str */
+	Const *arg_const = build_const(TEXTOID, const_value);
+
+	arg_relabel->xpr.type = T_RelabelType;
+	arg_relabel->arg = (Expr *) arg_var;
+	arg_relabel->resulttype = TEXTOID;
+	arg_relabel->resulttypmod = -1;
+
+	OpExpr *expr = build_op_expr(arg_relabel, arg_const, TextEqualOperator);
+
+	/* run test */
+	assert_true(opexpr_to_pxffilter(expr, filter));
+	PxfFilterDesc *expected = build_filter(
+			PXF_ATTR_CODE, 2, NULL,
+			PXF_SCALAR_CONST_CODE, 0, "hawq",
+			PXFOP_EQ);
+	compare_filters(filter, expected);
+
+	pxf_free_filter(filter);
+	pxf_free_filter(expected);
+	pfree(arg_var);
+	list_free_deep(expr->args); /* free all args */
+	pfree(expr);
+}
+
 void
 test__opexpr_to_pxffilter__unsupportedTypeCircle(void **state)
 {
@@ -859,6 +894,7 @@ main(int argc, char* argv[])
 			unit_test(test__opexpr_to_pxffilter__allSupportedTypes),
 			unit_test(test__opexpr_to_pxffilter__attributeEqualsNull),
 			unit_test(test__opexpr_to_pxffilter__differentTypes),
+			unit_test(test__opexpr_to_pxffilter__relabeledVar),
 			unit_test(test__opexpr_to_pxffilter__unsupportedTypeCircle),
 			unit_test(test__opexpr_to_pxffilter__twoVars),
 			unit_test(test__opexpr_to_pxffilter__unsupportedOpNot),
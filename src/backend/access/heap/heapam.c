@@ -38,6 +38,7 @@
  */
 #include "postgres.h"
 
+#include "access/appendonlywriter.h"
 #include "access/heapam.h"
 #include "access/hio.h"
 #include "access/multixact.h"
@@ -70,6 +71,16 @@
 static XLogRecPtr log_heap_update(Relation reln, Buffer oldbuf,
 		   ItemPointerData from, Buffer newbuf, HeapTuple newtup, bool move);
 
+/*
+ * Changes of the segment file catalogs of append only relations invalidate
+ * the rows cached by GetSegfileCatalogEntries.
+ */
+#define NoteSegfileCatalogChange(relation, visibleNow) \
+	do { \
+		if (IsAoSegmentNamespace(RelationGetNamespace(relation))) \
+			AORelNoteSegfileChange(RelationGetRelid(relation), (visibleNow)); \
+	} while (0)
+
 
 /* ----------------------------------------------------------------
  *						 heap support routines
@@ -2240,6 +2251,8 @@ heap_insert(Relation relation, HeapTuple tup, CommandId cid,
 	 */
 	CacheInvalidateHeapTuple(relation, heaptup, SysCacheInvalidate_Insert);
 
+	NoteSegfileCatalogChange(relation, isFrozen);
+
 	pgstat_count_heap_insert(relation);
 
 	/*
@@ -2658,6 +2671,8 @@ l1:
 	if (have_tuple_lock)
 		UnlockTuple(relation, &(tp.t_self), ExclusiveLock);
 
+	NoteSegfileCatalogChange(relation, false);
+
 	pgstat_count_heap_delete(relation);
 
 	return HeapTupleMayBeUpdated;
@@ -3142,6 +3157,8 @@ l2:
 	if (have_tuple_lock)
 		UnlockTuple(relation, &(oldtup.t_self), ExclusiveLock);
 
+	NoteSegfileCatalogChange(relation, false);
+
 	pgstat_count_heap_update(relation, false);
 
 	/*
@@ -3855,6 +3872,7 @@ heap_inplace_update_internal(Relation relation, HeapTuple tuple, TransactionId x
 		{
 			CacheInvalidateHeapTuple(relation, tuple, SysCacheInvalidate_Update_InPlace);
 		}
+		NoteSegfileCatalogChange(relation, true);
 		return;
 	}
 #endif
@@ -3898,6 +3916,8 @@ heap_inplace_update_internal(Relation relation, HeapTuple tuple, TransactionId x
 	/* Send out shared cache inval if necessary */
 	if (!IsBootstrapProcessingMode())
 		CacheInvalidateHeapTuple(relation, tuple, SysCacheInvalidate_Update_InPlace);
+
+	NoteSegfileCatalogChange(relation, true);
 }
 
 /*
@@ -4002,6 +4022,8 @@ heap_inplace_frozen_delete_internal(Relation relation, HeapTuple tuple, Transact
 	/* Send out shared cache inval if necessary */
 	if (!IsBootstrapProcessingMode())
 		CacheInvalidateHeapTuple(relation, tuple, SysCacheInvalidate_Delete);
+
+	NoteSegfileCatalogChange(relation, true);
 }
 
 void
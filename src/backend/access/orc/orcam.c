@@ -39,6 +39,7 @@
 #include "storage/fd.h"
 #include "storage/lmgr.h"
 #include "utils/datetime.h"
+#include "utils/datum.h"
 #include "utils/guc.h"
 #include "utils/hawq_type_mapping.h"
 #include "utils/memutils.h"
@@ -47,6 +48,9 @@
 static char dummyPlaceholder[16];
 static const int32 MAX_BUFFER_LEN = 2 * 32768;
 
+// rows buffered by orcInsertValues before they are passed as column vectors
+#define ORC_INSERT_BATCH_ROWS 1024
+
 typedef struct OrcCopyContext {
   const char *destDir;
   char *destFile;
@@ -76,6 +80,20 @@ typedef struct OrcFormatData {
   uint64 *colValLength;
   TimestampType *colTimestamp;
   struct varlena **colFixedLenUDT;
+
+  // column vectors of orcReadNextBatch
+  const char **batchRawValues;
+  const uint64 **batchValLengths;
+  const bool **batchRawNulls;
+  bool readBatchUnsupported;
+  MemoryContext readBatchCxt;  // values copied by the row at a time read
+
+  // rows buffered by orcInsertValues, see orcFlushInsertBatch
+  int32 batchRows;
+  Datum **batchValues;
+  bool **batchNulls;
+  char **batchColumns;
+  bool insertBatchUnsupported;
 } OrcFormatData;
 
 static void initOrcFormatIndexUserData(TupleDesc tup_desc,
@@ -137,6 +155,9 @@ static void initOrcFormatUserData(TupleDesc tup_desc,
   orcFormatData->colValLength = palloc0(sizeof(uint64) * natts);
   orcFormatData->colTimestamp = palloc0(sizeof(TimestampType) * natts);
   orcFormatData->colFixedLenUDT = palloc0(sizeof(struct varlena *) * natts);
+  orcFormatData->batchRawValues = palloc0(sizeof(char *) * natts);
+  orcFormatData->batchValLengths = palloc0(sizeof(uint64 *) * natts);
+  orcFormatData->batchRawNulls = palloc0(sizeof(bool *) * natts);
 
   for (int i = 0; i < orcFormatData->numberOfColumns; ++i) {
     // allocate memory for colFixedLenUDT[i] of fixed-length type in advance
@@ -162,13 +183,45 @@ static void initOrcFormatUserData(TupleDesc tup_desc,
   }
 }
 
+static void initOrcFormatInsertBatch(OrcFormatData *orcFormatData) {
+  int natts = orcFormatData->numberOfColumns;
+  orcFormatData->batchValues = palloc0(sizeof(Datum *) * natts);
+  orcFormatData->batchNulls = palloc0(sizeof(bool *) * natts);
+  orcFormatData->batchColumns = palloc0(sizeof(char *) * natts);
+  for (int i = 0; i < natts; ++i) {
+    orcFormatData->batchValues[i] =
+        palloc(sizeof(Datum) * ORC_INSERT_BATCH_ROWS);
+    orcFormatData->batchNulls[i] = palloc(sizeof(bool) * ORC_INSERT_BATCH_ROWS);
+    // large enough for the widest value, a TimestampType
+    orcFormatData->batchColumns[i] =
+        palloc(sizeof(TimestampType) * ORC_INSERT_BATCH_ROWS);
+  }
+}
+
 static freeOrcFormatUserData(OrcFormatData *orcFormatData) {
   for (int i = 0; i < orcFormatData->numberOfColumns; ++i) {
     pfree(orcFormatData->colNames[i]);
     if (orcFormatData->colFixedLenUDT[i])
       pfree(orcFormatData->colFixedLenUDT[i]);
+    if (orcFormatData->batchValues) {
+      pfree(orcFormatData->batchValues[i]);
+      pfree(orcFormatData->batchNulls[i]);
+      pfree(orcFormatData->batchColumns[i]);
+    }
   }
 
+  if (orcFormatData->batchValues) {
+    pfree(orcFormatData->batchColumns);
+    pfree(orcFormatData->batchNulls);
+    pfree(orcFormatData->batchValues);
+  }
+  if (orcFormatData->batchRawValues) {
+    pfree(orcFormatData->batchRawNulls);
+    pfree(orcFormatData->batchValLengths);
+    pfree(orcFormatData->batchRawValues);
+  }
+  if (orcFormatData->readBatchCxt)
+    MemoryContextDelete(orcFormatData->readBatchCxt);
   pfree(orcFormatData->colTimestamp);
   pfree(orcFormatData->colValLength);
   pfree(orcFormatData->colRawValues);
@@ -304,6 +357,7 @@ OrcInsertDescData *orcBeginInsert(Relation rel,
   insertDesc->orcFormatData->fmt =
       ORCFormatNewORCFormatC(option.data, segfileinfo->segno);
   initOrcFormatUserData(rel->rd_att, insertDesc->orcFormatData);
+  initOrcFormatInsertBatch(insertDesc->orcFormatData);
 
   addFilesystemCredential(hdfsPath);
 
@@ -329,6 +383,17 @@ Oid orcInsert(OrcInsertDescData *insertDesc, TupleTableSlot *tts) {
   return orcInsertValues(insertDesc, values, nulls, tts->tts_tupleDescriptor);
 }
 
+static void convertToOrcTimestamp(int64 timestamp, TimestampType *ts) {
+  ts->second = timestamp / 1000000 +
+               (POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE) * 60 * 60 * 24;
+  ts->nanosecond = timestamp % 1000000 * 1000;
+  int64_t days = ts->second / 60 / 60 / 24;
+  if (ts->nanosecond < 0 &&
+      (days > POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE || days < 0))
+    ts->nanosecond += 1000000000;
+  if (ts->second < 0 && ts->nanosecond) ts->second -= 1;
+}
+
 static void convertAndFillIntoOrcFormatData(OrcFormatData *orcFormatData,
                                             Datum *values, bool *nulls,
                                             TupleDesc tupleDesc) {
@@ -350,18 +415,8 @@ static void convertAndFillIntoOrcFormatData(OrcFormatData *orcFormatData,
       orcFormatData->colRawValues[i] = (char *)(&(values[i]));
     } else if (dataType == HAWQ_TYPE_TIMESTAMP ||
                dataType == HAWQ_TYPE_TIMESTAMPTZ) {
-      int64_t *timestamp = (int64_t *)(&(values[i]));
-      orcFormatData->colTimestamp[i].second =
-          *timestamp / 1000000 +
-          (POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE) * 60 * 60 * 24;
-      orcFormatData->colTimestamp[i].nanosecond = *timestamp % 1000000 * 1000;
-      int64_t days = orcFormatData->colTimestamp[i].second / 60 / 60 / 24;
-      if (orcFormatData->colTimestamp[i].nanosecond < 0 &&
-          (days > POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE || days < 0))
-        orcFormatData->colTimestamp[i].nanosecond += 1000000000;
-      if (orcFormatData->colTimestamp[i].second < 0 &&
-          orcFormatData->colTimestamp[i].nanosecond)
-        orcFormatData->colTimestamp[i].second -= 1;
+      convertToOrcTimestamp(DatumGetInt64(values[i]),
+                            &orcFormatData->colTimestamp[i]);
       orcFormatData->colRawValues[i] =
           (char *)(&(orcFormatData->colTimestamp[i]));
     } else if (dataType == HAWQ_TYPE_DATE) {
@@ -403,9 +458,92 @@ static void convertAndFillIntoOrcFormatData(OrcFormatData *orcFormatData,
   }
 }
 
-Oid orcInsertValues(OrcInsertDescData *insertDesc, Datum *values, bool *nulls,
-                    TupleDesc tupleDesc) {
-  if (++insertDesc->insertCount % 2048 == 0)
+#define FILL_INSERT_BATCH_COLUMN(type, getValue)                  \
+  for (int r = 0; r < numRows; ++r)                               \
+    ((type *)column)[r] = nulls[r] ? 0 : (type)getValue(values[r]);
+
+// Convert a column of the buffered rows as ORCFormatInsertBatchORCFormatC
+// takes it, the pointers to the values are allocated in the current memory
+// context.
+static void fillInsertBatchColumn(OrcFormatData *orcFormatData, int col,
+                                  Form_pg_attribute attr, int numRows) {
+  Datum *values = orcFormatData->batchValues[col];
+  bool *nulls = orcFormatData->batchNulls[col];
+  char *column = orcFormatData->batchColumns[col];
+
+  switch (attr->atttypid) {
+    case HAWQ_TYPE_BOOL:
+      FILL_INSERT_BATCH_COLUMN(bool, DatumGetBool);
+      break;
+    case HAWQ_TYPE_CHAR:
+      FILL_INSERT_BATCH_COLUMN(char, DatumGetChar);
+      break;
+    case HAWQ_TYPE_INT2:
+      FILL_INSERT_BATCH_COLUMN(int16, DatumGetInt16);
+      break;
+    case HAWQ_TYPE_INT4:
+      FILL_INSERT_BATCH_COLUMN(int32, DatumGetInt32);
+      break;
+    case HAWQ_TYPE_INT8:
+    case HAWQ_TYPE_TIME:
+      FILL_INSERT_BATCH_COLUMN(int64, DatumGetInt64);
+      break;
+    case HAWQ_TYPE_FLOAT4:
+      FILL_INSERT_BATCH_COLUMN(float, DatumGetFloat4);
+      break;
+    case HAWQ_TYPE_FLOAT8:
+      FILL_INSERT_BATCH_COLUMN(double, DatumGetFloat8);
+      break;
+    case HAWQ_TYPE_DATE:
+      for (int r = 0; r < numRows; ++r)
+        ((int32 *)column)[r] =
+            nulls[r] ? 0 : DatumGetInt32(values[r]) + POSTGRES_EPOCH_JDATE -
+                               UNIX_EPOCH_JDATE;
+      break;
+    case HAWQ_TYPE_TIMESTAMP:
+    case HAWQ_TYPE_TIMESTAMPTZ:
+      for (int r = 0; r < numRows; ++r)
+        if (!nulls[r])
+          convertToOrcTimestamp(DatumGetInt64(values[r]),
+                                &((TimestampType *)column)[r]);
+      break;
+    case HAWQ_TYPE_NUMERIC:
+      for (int r = 0; r < numRows; ++r) {
+        ((char **)column)[r] = NULL;
+        if (nulls[r]) continue;
+        Numeric num = DatumGetNumeric(values[r]);
+        if (NUMERIC_IS_NAN(num))
+          nulls[r] = true;
+        else
+          ((char **)column)[r] = (char *)num;
+      }
+      break;
+    default:
+      for (int r = 0; r < numRows; ++r) {
+        ((char **)column)[r] = NULL;
+        if (nulls[r]) continue;
+        if (attr->attlen > 0) {
+          // fixed length udt, as in convertAndFillIntoOrcFormatData
+          uint32_t totalLen = attr->attlen + sizeof(uint32_t);
+          uint32_t tmpLen = __builtin_bswap32(totalLen);
+          struct varlena *var = palloc(totalLen);
+          memcpy(var->vl_len_, &tmpLen, sizeof(uint32_t));
+          memcpy(var->vl_dat,
+                 attr->attbyval ? (char *)(&values[r])
+                                : (char *)DatumGetPointer(values[r]),
+                 attr->attlen);
+          ((char **)column)[r] = (char *)var;
+        } else {
+          ((char **)column)[r] = (char *)DatumGetPointer(values[r]);
+        }
+      }
+      break;
+  }
+}
+
+static void insertRow(OrcInsertDescData *insertDesc, Datum *values,
+                      bool *nulls, TupleDesc tupleDesc) {
+  if (insertDesc->insertCount % 2048 == 0)
     MemoryContextReset(insertDesc->memCxt);
 
   MemoryContext oldContext = MemoryContextSwitchTo(insertDesc->memCxt);
@@ -420,12 +558,99 @@ Oid orcInsertValues(OrcInsertDescData *insertDesc, Datum *values, bool *nulls,
                             orcFormatData->colRawValues, NULL, NULL, NULL,
                             nulls);
   checkOrcError(orcFormatData);
+}
+
+// Pass the rows buffered by orcInsertValues to the format library as column
+// vectors. They are inserted one by one if the library does not insert in
+// batches, and so are the next rows.
+static void orcFlushInsertBatch(OrcInsertDescData *insertDesc) {
+  OrcFormatData *orcFormatData = insertDesc->orcFormatData;
+  TupleDesc tupleDesc = RelationGetDescr(insertDesc->rel);
+  int numRows = orcFormatData->batchRows;
+
+  if (numRows == 0) return;
+
+  MemoryContext oldContext = MemoryContextSwitchTo(insertDesc->memCxt);
+  for (int i = 0; i < orcFormatData->numberOfColumns; ++i)
+    fillInsertBatchColumn(orcFormatData, i, tupleDesc->attrs[i], numRows);
+  MemoryContextSwitchTo(oldContext);
+
+  bool res = ORCFormatInsertBatchORCFormatC(
+      orcFormatData->fmt, orcFormatData->colDatatypes, numRows,
+      orcFormatData->batchColumns, orcFormatData->batchNulls);
+  checkOrcError(orcFormatData);
+
+  if (!res) {
+    orcFormatData->insertBatchUnsupported = true;
+
+    Datum *values = MemoryContextAlloc(
+        insertDesc->memCxt, sizeof(Datum) * orcFormatData->numberOfColumns);
+    bool *nulls = MemoryContextAlloc(
+        insertDesc->memCxt, sizeof(bool) * orcFormatData->numberOfColumns);
+    for (int r = 0; r < numRows; ++r) {
+      for (int i = 0; i < orcFormatData->numberOfColumns; ++i) {
+        values[i] = orcFormatData->batchValues[i][r];
+        nulls[i] = orcFormatData->batchNulls[i][r];
+      }
+
+      MemoryContextSwitchTo(insertDesc->memCxt);
+      convertAndFillIntoOrcFormatData(orcFormatData, values, nulls, tupleDesc);
+      MemoryContextSwitchTo(oldContext);
+
+      ORCFormatInsertORCFormatC(orcFormatData->fmt,
+                                orcFormatData->colDatatypes,
+                                orcFormatData->colRawValues, NULL, NULL, NULL,
+                                nulls);
+      checkOrcError(orcFormatData);
+    }
+  }
+
+  orcFormatData->batchRows = 0;
+  MemoryContextReset(insertDesc->memCxt);
+}
+
+// The rows are buffered, their pass-by-reference values copied, and passed
+// to the format library ORC_INSERT_BATCH_ROWS at a time instead of crossing
+// into it for each row.
+Oid orcInsertValues(OrcInsertDescData *insertDesc, Datum *values, bool *nulls,
+                    TupleDesc tupleDesc) {
+  OrcFormatData *orcFormatData = (OrcFormatData *)(insertDesc->orcFormatData);
+
+  ++insertDesc->insertCount;
+
+  if (orcFormatData->insertBatchUnsupported) {
+    insertRow(insertDesc, values, nulls, tupleDesc);
+    PG_RETURN_OID(InvalidOid);
+  }
+
+  int row = orcFormatData->batchRows++;
+  MemoryContext oldContext = MemoryContextSwitchTo(insertDesc->memCxt);
+  for (int i = 0; i < orcFormatData->numberOfColumns; ++i) {
+    Form_pg_attribute attr = tupleDesc->attrs[i];
+
+    orcFormatData->batchNulls[i][row] = nulls[i];
+    if (nulls[i])
+      orcFormatData->batchValues[i][row] = (Datum)0;
+    else if (attr->attbyval)
+      orcFormatData->batchValues[i][row] = values[i];
+    else if (attr->attlen == -1)
+      orcFormatData->batchValues[i][row] =
+          PointerGetDatum(PG_DETOAST_DATUM_COPY(values[i]));
+    else
+      orcFormatData->batchValues[i][row] =
+          datumCopy(values[i], false, attr->attlen);
+  }
+  MemoryContextSwitchTo(oldContext);
+
+  if (orcFormatData->batchRows == ORC_INSERT_BATCH_ROWS)
+    orcFlushInsertBatch(insertDesc);
 
   PG_RETURN_OID(InvalidOid);
 }
 
 void orcEndInsert(OrcInsertDescData *insertDesc) {
   if (insertDesc->orcFormatData->fmt) {
+    orcFlushInsertBatch(insertDesc);
     ORCFormatEndInsertORCFormatFileC(
         insertDesc->orcFormatData->fmt, &insertDesc->sendback->eof[0],
         &insertDesc->sendback->uncompressed_eof[0]);
@@ -554,6 +779,51 @@ OrcScanDescData *orcBeginReadWithOptionsStr(Relation rel, Snapshot snapshot,
   return scanDesc;
 }
 
+// Convert a value read by the format library, of length len, to a datum
+// which points into the library buffer if passed by reference.
+static Datum orcRawToDatum(Form_pg_attribute attr, char *raw, uint64 len) {
+  switch (attr->atttypid) {
+    case HAWQ_TYPE_BOOL:
+      return BoolGetDatum(*(bool *)raw);
+    case HAWQ_TYPE_INT2:
+      return Int16GetDatum(*(int16_t *)raw);
+    case HAWQ_TYPE_INT4:
+      return Int32GetDatum(*(int32_t *)raw);
+    case HAWQ_TYPE_INT8:
+    case HAWQ_TYPE_TIME:
+    case HAWQ_TYPE_TIMESTAMP:
+    case HAWQ_TYPE_TIMESTAMPTZ:
+      return Int64GetDatum(*(int64_t *)raw);
+    case HAWQ_TYPE_FLOAT4:
+      return Float4GetDatum(*(float *)raw);
+    case HAWQ_TYPE_FLOAT8:
+      return Float8GetDatum(*(double *)raw);
+    case HAWQ_TYPE_DATE:
+      return Int32GetDatum(*(int32_t *)raw - POSTGRES_EPOCH_JDATE +
+                           UNIX_EPOCH_JDATE);
+    default: {
+      // Check whether the value is fixed length udt.
+      bool isFixedLengthType = attr->attlen > 0 ? true : false;
+      bool isPassByVal = attr->attbyval;
+      if (isFixedLengthType) {
+        if (isPassByVal) {  // pass by val
+          Datum value = 0;
+          struct varlena *var = (struct varlena *)raw;
+          uint32 valLen = *(uint32 *)(var->vl_len_);
+          memcpy((void *)&value, var->vl_dat, valLen);
+          return value;
+        } else {  // pass by pointer
+          SET_VARSIZE((struct varlena *)raw, len);
+          return PointerGetDatum(raw + sizeof(uint32_t));
+        }
+      } else {
+        SET_VARSIZE((struct varlena *)raw, len);
+        return PointerGetDatum(raw);
+      }
+    }
+  }
+}
+
 void orcIndexReadNext(OrcScanDescData *scanData, TupleTableSlot *slot,
                       List *columnsInIndex) {
   OrcFormatData *orcFormatData = scanData->orcFormatData;
@@ -582,70 +852,9 @@ void orcIndexReadNext(OrcScanDescData *scanData, TupleTableSlot *slot,
         continue;
       }
       nulls[i] = false;
-      switch (tupleDesc->attrs[i]->atttypid) {
-        case HAWQ_TYPE_BOOL: {
-          values[i] = BoolGetDatum(*(bool *)(orcFormatData->colRawValues[idx]));
-          break;
-        }
-        case HAWQ_TYPE_INT2: {
-          values[i] =
-              Int16GetDatum(*(int16_t *)(orcFormatData->colRawValues[idx]));
-          break;
-        }
-        case HAWQ_TYPE_INT4: {
-          values[i] =
-              Int32GetDatum(*(int32_t *)(orcFormatData->colRawValues[idx]));
-          break;
-        }
-        case HAWQ_TYPE_INT8:
-        case HAWQ_TYPE_TIME:
-        case HAWQ_TYPE_TIMESTAMP:
-        case HAWQ_TYPE_TIMESTAMPTZ: {
-          values[i] =
-              Int64GetDatum(*(int64_t *)(orcFormatData->colRawValues[idx]));
-          break;
-        }
-        case HAWQ_TYPE_FLOAT4: {
-          values[i] =
-              Float4GetDatum(*(float *)(orcFormatData->colRawValues[idx]));
-          break;
-        }
-        case HAWQ_TYPE_FLOAT8: {
-          values[i] =
-              Float8GetDatum(*(double *)(orcFormatData->colRawValues[idx]));
-          break;
-        }
-        case HAWQ_TYPE_DATE: {
-          values[i] =
-              Int32GetDatum(*(int32_t *)(orcFormatData->colRawValues[idx]) -
-                            POSTGRES_EPOCH_JDATE + UNIX_EPOCH_JDATE);
-          break;
-        }
-        default: {
-          // Check whether value[i] is fixed length udt.
-          bool isFixedLengthType =
-              tupleDesc->attrs[i]->attlen > 0 ? true : false;
-          bool isPassByVal = tupleDesc->attrs[i]->attbyval;
-          if (isFixedLengthType) {
-            if (isPassByVal) {  // pass by val
-              struct varlena *var =
-                  (struct varlena *)(orcFormatData->colRawValues[idx]);
-              uint32 valLen = *(uint32 *)(var->vl_len_);
-              memcpy((void *)&values[i], var->vl_dat, valLen);
-            } else {  // pass by pointer
-              SET_VARSIZE((struct varlena *)(orcFormatData->colRawValues[idx]),
-                          orcFormatData->colValLength[idx]);
-              values[i] = PointerGetDatum(orcFormatData->colRawValues[idx] +
-                                          sizeof(uint32_t));
-            }
-          } else {
-            SET_VARSIZE((struct varlena *)(orcFormatData->colRawValues[idx]),
-                        orcFormatData->colValLength[idx]);
-            values[i] = PointerGetDatum(orcFormatData->colRawValues[idx]);
-          }
-          break;
-        }
-      }
+      values[i] = orcRawToDatum(tupleDesc->attrs[i],
+                                orcFormatData->colRawValues[idx],
+                                orcFormatData->colValLength[idx]);
       idx++;
     }
     TupSetVirtualTupleNValid(slot, slot->tts_tupleDescriptor->natts);
@@ -674,70 +883,9 @@ void orcReadNext(OrcScanDescData *scanData, TupleTableSlot *slot) {
       if (nulls[i])
         continue;
 
-      switch (tupleDesc->attrs[i]->atttypid) {
-        case HAWQ_TYPE_BOOL: {
-          values[i] = BoolGetDatum(*(bool *)(orcFormatData->colRawValues[i]));
-          break;
-        }
-        case HAWQ_TYPE_INT2: {
-          values[i] =
-              Int16GetDatum(*(int16_t *)(orcFormatData->colRawValues[i]));
-          break;
-        }
-        case HAWQ_TYPE_INT4: {
-          values[i] =
-              Int32GetDatum(*(int32_t *)(orcFormatData->colRawValues[i]));
-          break;
-        }
-        case HAWQ_TYPE_INT8:
-        case HAWQ_TYPE_TIME:
-        case HAWQ_TYPE_TIMESTAMP:
-        case HAWQ_TYPE_TIMESTAMPTZ: {
-          values[i] =
-              Int64GetDatum(*(int64_t *)(orcFormatData->colRawValues[i]));
-          break;
-        }
-        case HAWQ_TYPE_FLOAT4: {
-          values[i] =
-              Float4GetDatum(*(float *)(orcFormatData->colRawValues[i]));
-          break;
-        }
-        case HAWQ_TYPE_FLOAT8: {
-          values[i] =
-              Float8GetDatum(*(double *)(orcFormatData->colRawValues[i]));
-          break;
-        }
-        case HAWQ_TYPE_DATE: {
-          values[i] =
-              Int32GetDatum(*(int32_t *)(orcFormatData->colRawValues[i]) -
-                            POSTGRES_EPOCH_JDATE + UNIX_EPOCH_JDATE);
-          break;
-        }
-        default: {
-          // Check whether value[i] is fixed length udt.
-          bool isFixedLengthType =
-              tupleDesc->attrs[i]->attlen > 0 ? true : false;
-          bool isPassByVal = tupleDesc->attrs[i]->attbyval;
-          if (isFixedLengthType) {
-            if (isPassByVal) {  // pass by val
-              struct varlena *var =
-                  (struct varlena *)(orcFormatData->colRawValues[i]);
-              uint32 valLen = *(uint32 *)(var->vl_len_);
-              memcpy((void *)&values[i], var->vl_dat, valLen);
-            } else {  // pass by pointer
-              SET_VARSIZE((struct varlena *)(orcFormatData->colRawValues[i]),
-                          orcFormatData->colValLength[i]);
-              values[i] = PointerGetDatum(orcFormatData->colRawValues[i] +
-                                          sizeof(uint32_t));
-            }
-          } else {
-            SET_VARSIZE((struct varlena *)(orcFormatData->colRawValues[i]),
-                        orcFormatData->colValLength[i]);
-            values[i] = PointerGetDatum(orcFormatData->colRawValues[i]);
-          }
-          break;
-        }
-      }
+      values[i] = orcRawToDatum(tupleDesc->attrs[i],
+                                orcFormatData->colRawValues[i],
+                                orcFormatData->colValLength[i]);
     }
     TupSetVirtualTupleNValid(slot, slot->tts_tupleDescriptor->natts);
     ItemPointerSetRowIdToFakeCtid(&scanData->cdb_fake_ctid, rowId);
@@ -747,6 +895,129 @@ void orcReadNext(OrcScanDescData *scanData, TupleTableSlot *slot) {
   }
 }
 
+#define READ_BATCH_COLUMN(type, makeDatum)                 \
+  for (int r = 0; r < numRows; ++r)                        \
+    if (!nulls[r]) values[r] = makeDatum(((const type *)raw)[r]);
+
+// Convert a column vector read by ORCFormatNextBatchORCFormatC.
+static void readBatchColumn(OrcFormatData *orcFormatData, int col,
+                            Form_pg_attribute attr, int numRows,
+                            Datum *values, bool *nulls) {
+  const char *raw = orcFormatData->batchRawValues[col];
+
+  if (raw == NULL) {
+    memset(nulls, true, numRows);
+    return;
+  }
+
+  memcpy(nulls, orcFormatData->batchRawNulls[col], numRows);
+
+  switch (attr->atttypid) {
+    case HAWQ_TYPE_BOOL:
+      READ_BATCH_COLUMN(bool, BoolGetDatum);
+      break;
+    case HAWQ_TYPE_INT2:
+      READ_BATCH_COLUMN(int16_t, Int16GetDatum);
+      break;
+    case HAWQ_TYPE_INT4:
+      READ_BATCH_COLUMN(int32_t, Int32GetDatum);
+      break;
+    case HAWQ_TYPE_INT8:
+    case HAWQ_TYPE_TIME:
+    case HAWQ_TYPE_TIMESTAMP:
+    case HAWQ_TYPE_TIMESTAMPTZ:
+      READ_BATCH_COLUMN(int64_t, Int64GetDatum);
+      break;
+    case HAWQ_TYPE_FLOAT4:
+      READ_BATCH_COLUMN(float, Float4GetDatum);
+      break;
+    case HAWQ_TYPE_FLOAT8:
+      READ_BATCH_COLUMN(double, Float8GetDatum);
+      break;
+    case HAWQ_TYPE_DATE:
+      for (int r = 0; r < numRows; ++r)
+        if (!nulls[r])
+          values[r] = Int32GetDatum(((const int32_t *)raw)[r] -
+                                    POSTGRES_EPOCH_JDATE + UNIX_EPOCH_JDATE);
+      break;
+    default: {
+      char *const *ptrs = (char *const *)raw;
+      const uint64 *lens = orcFormatData->batchValLengths[col];
+      for (int r = 0; r < numRows; ++r)
+        if (!nulls[r]) values[r] = orcRawToDatum(attr, ptrs[r], lens[r]);
+      break;
+    }
+  }
+}
+
+// Read the next rows as column vectors, at most maxRows of them. The values
+// and null flags of column i are stored into values[i] and nulls[i], the
+// columns whose entry is NULL are not returned. The pass-by-reference values
+// are valid until the next call. Returns the number of rows, 0 at the end of
+// the scan.
+//
+// The rows are read one by one if the format library does not read in
+// batches, the pass-by-reference values are copied then.
+int orcReadNextBatch(OrcScanDescData *scanData, TupleDesc tupleDesc,
+                     int maxRows, Datum **values, bool **nulls) {
+  OrcFormatData *orcFormatData = scanData->orcFormatData;
+
+  Assert(maxRows > 0);
+
+  if (!orcFormatData->readBatchUnsupported) {
+    int numRows = ORCFormatNextBatchORCFormatC(
+        orcFormatData->fmt, maxRows, orcFormatData->batchRawValues,
+        orcFormatData->batchValLengths, orcFormatData->batchRawNulls);
+    checkOrcError(orcFormatData);
+
+    if (numRows >= 0) {
+      for (int i = 0; i < orcFormatData->numberOfColumns; ++i) {
+        if (values[i] == NULL) continue;
+        readBatchColumn(orcFormatData, i, tupleDesc->attrs[i], numRows,
+                        values[i], nulls[i]);
+      }
+      return numRows;
+    }
+
+    orcFormatData->readBatchUnsupported = true;
+    orcFormatData->readBatchCxt = AllocSetContextCreate(
+        GetMemoryChunkContext(orcFormatData), "NativeOrcReadBatchMemCxt",
+        ALLOCSET_DEFAULT_MINSIZE, ALLOCSET_DEFAULT_INITSIZE,
+        ALLOCSET_DEFAULT_MAXSIZE);
+  }
+
+  MemoryContextReset(orcFormatData->readBatchCxt);
+  MemoryContext oldContext = MemoryContextSwitchTo(orcFormatData->readBatchCxt);
+  bool *rowNulls = palloc(sizeof(bool) * orcFormatData->numberOfColumns);
+  int numRows = 0;
+
+  while (numRows < maxRows) {
+    uint64_t rowId;
+    memset(rowNulls, true, orcFormatData->numberOfColumns);
+    bool res = ORCFormatNextORCFormatWithRowIdC(
+        orcFormatData->fmt, orcFormatData->colRawValues,
+        orcFormatData->colValLength, rowNulls, &rowId);
+    checkOrcError(orcFormatData);
+    if (!res) break;
+
+    for (int i = 0; i < orcFormatData->numberOfColumns; ++i) {
+      if (values[i] == NULL) continue;
+
+      Form_pg_attribute attr = tupleDesc->attrs[i];
+      nulls[i][numRows] = rowNulls[i];
+      if (rowNulls[i]) continue;
+      Datum value = orcRawToDatum(attr, orcFormatData->colRawValues[i],
+                                  orcFormatData->colValLength[i]);
+      values[i][numRows] =
+          attr->attbyval ? value : datumCopy(value, false, attr->attlen);
+    }
+    numRows++;
+  }
+
+  MemoryContextSwitchTo(oldContext);
+  return numRows;
+}
+
 void orcEndRead(OrcScanDescData *scanData) {
   RelationDecrementReferenceCount(scanData->rel);
 
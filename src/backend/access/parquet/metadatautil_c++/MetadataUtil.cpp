@@ -140,6 +140,16 @@ MetadataUtil::convertPageMetadata(parquet::PageHeader& parquetHeader,
 	hawqPageMetadata->crc = parquetHeader.crc;
 	hawqPageMetadata->page_type = (enum PageType) parquetHeader.type;
 
+	if (parquetHeader.type == parquet::PageType::DICTIONARY_PAGE) {
+		hawqPageMetadata->definition_level_encoding = RLE;
+		hawqPageMetadata->repetition_level_encoding = RLE;
+		hawqPageMetadata->encoding =
+				(enum Encoding) parquetHeader.dictionary_page_header.encoding;
+		hawqPageMetadata->num_values =
+				parquetHeader.dictionary_page_header.num_values;
+		return;
+	}
+
 	hawqPageMetadata->definition_level_encoding =
 			(enum Encoding) parquetHeader.data_page_header.definition_level_encoding;
 	hawqPageMetadata->encoding =
@@ -156,6 +166,7 @@ int
 MetadataUtil::convertToPageMetadata(parquet::PageHeader *parquetHeader,
 		PageMetadata_4C* hawqPageMetadata) {
 	parquet::DataPageHeader dataPageHeader;
+	parquet::DictionaryPageHeader dictionaryPageHeader;
 
 	parquetHeader->__set_type(
 			(enum parquet::PageType::type) hawqPageMetadata->page_type);
@@ -165,6 +176,14 @@ MetadataUtil::convertToPageMetadata(parquet::PageHeader *parquetHeader,
 	parquetHeader->__set_uncompressed_page_size(
 			hawqPageMetadata->uncompressed_page_size);
 
+	if (hawqPageMetadata->page_type == DICTIONARY_PAGE) {
+		dictionaryPageHeader.__set_encoding(
+				(enum parquet::Encoding::type) hawqPageMetadata->encoding);
+		dictionaryPageHeader.__set_num_values(hawqPageMetadata->num_values);
+
+		parquetHeader->__set_dictionary_page_header(dictionaryPageHeader);
+		return 0;
+	}
 
 	dataPageHeader.__set_definition_level_encoding(
 			(enum parquet::Encoding::type) hawqPageMetadata->definition_level_encoding);
@@ -193,7 +212,9 @@ MetadataUtil::convertToColumnMetadata(
 			(parquet::CompressionCodec::type) hawqColumnMetadata->codec);
 	columnchunk_metadata->__set_data_page_offset(
 			hawqColumnMetadata->firstDataPage);
-	columnchunk_metadata->__set_dictionary_page_offset(-1);
+	columnchunk_metadata->__set_dictionary_page_offset(
+			hawqColumnMetadata->dictionaryPageOffset > 0 ?
+					hawqColumnMetadata->dictionaryPageOffset : -1);
 	columnchunk_metadata->__set_index_page_offset(-1);
 	columnchunk_metadata->__set_num_values(hawqColumnMetadata->valueCount);
 	columnchunk_metadata->__set_total_compressed_size(
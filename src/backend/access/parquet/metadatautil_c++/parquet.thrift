@@ -142,6 +142,10 @@ enum Encoding {
   /** Bit packed encoding.  This can only be used if the data has a known max
    * width.  Usable for definition/repetition levels encoding.  **/
   BIT_PACKED = 4;
+
+  /** Delta encoding for integers. This can be used for int columns and works best
+   * on sorted data */
+  DELTA_BINARY_PACKED = 5;
 }
 
 /**
@@ -152,6 +156,10 @@ enum CompressionCodec {
   SNAPPY = 1;
   GZIP = 2;
   LZO = 3;
+  BROTLI = 4;
+  LZ4 = 5;
+  ZSTD = 6;
+  LZ4_RAW = 7;
 }
 
 enum PageType {
@@ -208,6 +216,20 @@ struct PageHeader {
   7: optional DictionaryPageHeader dictionary_page_header;
 }
 
+/**
+ * Statistics per row group and per page
+ * All fields are optional.
+ */
+struct Statistics {
+   /** min and max value of the column, encoded in PLAIN encoding **/
+   1: optional binary max;
+   2: optional binary min;
+   /** count of null value in the column **/
+   3: optional i64 null_count;
+   /** count of distinct values occurring **/
+   4: optional i64 distinct_count;
+}
+
 /** 
  * Wrapper struct to store key values
  */
@@ -253,6 +275,9 @@ struct ColumnMetaData {
 
   /** Byte offset from the beginning of file to first (only) dictionary page **/
   11: optional i64 dictionary_page_offset
+
+  /** optional statistics for this column chunk, written in the file metadata only **/
+  12: optional Statistics statistics;
 }
 
 struct ColumnChunk {
@@ -84,30 +84,40 @@ int _kEncodingValues[] = {
   Encoding::GROUP_VAR_INT,
   Encoding::PLAIN_DICTIONARY,
   Encoding::RLE,
-  Encoding::BIT_PACKED
+  Encoding::BIT_PACKED,
+  Encoding::DELTA_BINARY_PACKED
 };
 const char* _kEncodingNames[] = {
   "PLAIN",
   "GROUP_VAR_INT",
   "PLAIN_DICTIONARY",
   "RLE",
-  "BIT_PACKED"
+  "BIT_PACKED",
+  "DELTA_BINARY_PACKED"
 };
-const std::map<int, const char*> _Encoding_VALUES_TO_NAMES(::apache::thrift::TEnumIterator(5, _kEncodingValues, _kEncodingNames), ::apache::thrift::TEnumIterator(-1, NULL, NULL));
+const std::map<int, const char*> _Encoding_VALUES_TO_NAMES(::apache::thrift::TEnumIterator(6, _kEncodingValues, _kEncodingNames), ::apache::thrift::TEnumIterator(-1, NULL, NULL));
 
 int _kCompressionCodecValues[] = {
   CompressionCodec::UNCOMPRESSED,
   CompressionCodec::SNAPPY,
   CompressionCodec::GZIP,
-  CompressionCodec::LZO
+  CompressionCodec::LZO,
+  CompressionCodec::BROTLI,
+  CompressionCodec::LZ4,
+  CompressionCodec::ZSTD,
+  CompressionCodec::LZ4_RAW
 };
 const char* _kCompressionCodecNames[] = {
   "UNCOMPRESSED",
   "SNAPPY",
   "GZIP",
-  "LZO"
+  "LZO",
+  "BROTLI",
+  "LZ4",
+  "ZSTD",
+  "LZ4_RAW"
 };
-const std::map<int, const char*> _CompressionCodec_VALUES_TO_NAMES(::apache::thrift::TEnumIterator(4, _kCompressionCodecValues, _kCompressionCodecNames), ::apache::thrift::TEnumIterator(-1, NULL, NULL));
+const std::map<int, const char*> _CompressionCodec_VALUES_TO_NAMES(::apache::thrift::TEnumIterator(8, _kCompressionCodecValues, _kCompressionCodecNames), ::apache::thrift::TEnumIterator(-1, NULL, NULL));
 
 int _kPageTypeValues[] = {
   PageType::DATA_PAGE,
@@ -86,7 +86,8 @@ struct Encoding {
     GROUP_VAR_INT = 1,
     PLAIN_DICTIONARY = 2,
     RLE = 3,
-    BIT_PACKED = 4
+    BIT_PACKED = 4,
+    DELTA_BINARY_PACKED = 5
   };
 };
 
@@ -97,7 +98,11 @@ struct CompressionCodec {
     UNCOMPRESSED = 0,
     SNAPPY = 1,
     GZIP = 2,
-    LZO = 3
+    LZO = 3,
+    BROTLI = 4,
+    LZ4 = 5,
+    ZSTD = 6,
+    LZ4_RAW = 7
   };
 };
 
@@ -45,6 +45,7 @@
 #include "catalog/pg_statistic.h"
 #include "cdb/cdbparquetfooterbuffer.h"
 #include "cdb/cdbparquetfooterserializer.h"
+#include "cdb/cdbparquetfootercache.h"
 
 /**For read*/
 static void initscan(ParquetScanDesc scan);
@@ -236,6 +237,16 @@ void parquet_endscan(ParquetScanDesc scan) {
 				pfree(reader->pageBuffer);
 			}
 
+			if (reader->dictionaryBuffer != NULL)
+			{
+				pfree(reader->dictionaryBuffer);
+			}
+
+			if (reader->dictionary != NULL)
+			{
+				pfree(reader->dictionary);
+			}
+
 			if (reader->geoval != NULL)
 			{
 				pfree(reader->geoval);
@@ -350,6 +361,7 @@ static bool getNextRowGroup(ParquetScanDesc scan)
 												scan->proj,
 												scan->pqs_tupDesc,
 												scan->hawqAttrToParquetColChunks,
+												scan->rowGroupFilter,
 												scan->toCloseFile)) {
 		ParquetRowGroupReader_GetContents(&scan->rowGroupReader);
 	}
@@ -711,6 +723,9 @@ void parquet_insert_finish(ParquetInsertDesc parquetInsertDesc) {
 			&(parquetInsertDesc->footerProtocol),
 			parquetInsertDesc->previous_rowgroupcnt);
 
+	/* the footer cached for the eof before the insert is not read any more */
+	ParquetFooterCache_Invalidate(parquetInsertDesc->parquetFilePathName);
+
 	CloseWritableFileSeg(parquetInsertDesc);
 
 	/** free parquet insert desc*/
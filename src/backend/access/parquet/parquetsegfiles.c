@@ -45,6 +45,7 @@
 #include "utils/syscache.h"
 #include "utils/fmgroids.h"
 #include "utils/numeric.h"
+#include "access/aosegfiles.h"
 #include "access/parquetsegfiles.h"
 
 static int
@@ -374,14 +375,10 @@ ParquetFileSegTotals *GetParquetSegFilesTotals(Relation parentrel, Snapshot parq
 {
 
 	Relation		pg_paqseg_rel;
-	TupleDesc		pg_paqseg_dsc;
-	HeapTuple		tuple;
-	SysScanDesc		paqscan;
+	SegfileCatalogEntry *entries;
+	int				nentries;
+	int				i;
 	ParquetFileSegTotals  *result;
-	Datum			eof,
-					eof_uncompressed,
-					tupcount;
-	bool			isNull;
 	AppendOnlyEntry *aoEntry = NULL;
 
 	Assert(RelationIsParquet(parentrel));
@@ -391,30 +388,23 @@ ParquetFileSegTotals *GetParquetSegFilesTotals(Relation parentrel, Snapshot parq
 	result = (ParquetFileSegTotals *) palloc0(sizeof(ParquetFileSegTotals));
 
 	pg_paqseg_rel = heap_open(aoEntry->segrelid, AccessShareLock);
-	pg_paqseg_dsc = RelationGetDescr(pg_paqseg_rel);
 
-	paqscan = systable_beginscan(pg_paqseg_rel, InvalidOid, FALSE,
-			parquetMetaDataSnapshot, 0, NULL);
+	entries = GetSegfileCatalogEntries(pg_paqseg_rel, false,
+			parquetMetaDataSnapshot, &nentries);
 
-	while (HeapTupleIsValid(tuple = systable_getnext(paqscan)))
+	for (i = 0; i < nentries; i++)
 	{
-		eof = fastgetattr(tuple, Anum_pg_parquetseg_eof, pg_paqseg_dsc, &isNull);
-		tupcount = fastgetattr(tuple, Anum_pg_parquetseg_tupcount, pg_paqseg_dsc, &isNull);
-		eof_uncompressed = fastgetattr(tuple, Anum_pg_parquetseg_eofuncompressed, pg_paqseg_dsc, &isNull);
-
-		if(isNull)
+		if (entries[i].eof_uncompressed == InvalidUncompressedEof)
 			result->totalbytesuncompressed = InvalidUncompressedEof;
 		else
-			result->totalbytesuncompressed += (int64)DatumGetFloat8(eof_uncompressed);
+			result->totalbytesuncompressed += entries[i].eof_uncompressed;
 
-		result->totalbytes += (int64)DatumGetFloat8(eof);
-		result->totaltuples += (int64)DatumGetFloat8(tupcount);
+		result->totalbytes += entries[i].eof;
+		result->totaltuples += entries[i].tupcount;
 		result->totalfilesegs++;
-
-		CHECK_FOR_INTERRUPTS();
 	}
 
-	systable_endscan(paqscan);
+	pfree(entries);
 	heap_close(pg_paqseg_rel, AccessShareLock);
 
 	pfree(aoEntry);
@@ -435,12 +425,10 @@ int64 GetParquetTotalBytes(Relation parentrel, Snapshot parquetMetaDataSnapshot)
 {
 
 	Relation		pg_paqseg_rel;
-	TupleDesc		pg_paqseg_dsc;
-	HeapTuple		tuple;
-	SysScanDesc		parquetscan;
+	SegfileCatalogEntry *entries;
+	int				nentries;
+	int				i;
 	int64		  	result;
-	Datum			eof;
-	bool			isNull;
 	AppendOnlyEntry 	*aoEntry = NULL;
 
 	aoEntry = GetAppendOnlyEntry(RelationGetRelid(parentrel), parquetMetaDataSnapshot);
@@ -448,24 +436,16 @@ int64 GetParquetTotalBytes(Relation parentrel, Snapshot parquetMetaDataSnapshot)
 	result = 0;
 
 	pg_paqseg_rel = heap_open(aoEntry->segrelid, AccessShareLock);
-	pg_paqseg_dsc = RelationGetDescr(pg_paqseg_rel);
 
 	Assert (Gp_role != GP_ROLE_EXECUTE);
 
-	parquetscan = systable_beginscan(pg_paqseg_rel, InvalidOid, FALSE,
-			parquetMetaDataSnapshot, 0, NULL);
-
-	while (HeapTupleIsValid(tuple = systable_getnext(parquetscan)))
-	{
-		eof = fastgetattr(tuple, Anum_pg_parquetseg_eof, pg_paqseg_dsc, &isNull);
-		Assert(!isNull);
+	entries = GetSegfileCatalogEntries(pg_paqseg_rel, false,
+			parquetMetaDataSnapshot, &nentries);
 
-		result += (int64)DatumGetFloat8(eof);
+	for (i = 0; i < nentries; i++)
+		result += entries[i].eof;
 
-		CHECK_FOR_INTERRUPTS();
-	}
-
-	systable_endscan(parquetscan);
+	pfree(entries);
 	heap_close(pg_paqseg_rel, AccessShareLock);
 
 	pfree(aoEntry);
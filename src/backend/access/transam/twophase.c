@@ -42,6 +42,7 @@
 #include <time.h>
 #include <unistd.h>
 
+#include "access/appendonlywriter.h"
 #include "access/heapam.h"
 #include "access/xlogmm.h"
 #include "access/subtrans.h"
@@ -1449,6 +1450,9 @@ FinishPreparedTransaction(const char *gid, bool isCommit, bool raiseErrorIfNotFo
 
         prepareAppendOnlyIntentCount = gxact->prepareAppendOnlyIntentCount;
 
+        /* we don't know which segment file catalogs it changed */
+        AORelInvalidateSegfileVersions();
+
         ProcArrayRemove(&gxact->proc, isCommit);
 
         /*
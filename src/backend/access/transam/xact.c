@@ -52,13 +52,16 @@
 #include "utils/palloc.h"
 #include "utils/relcache.h"
 #include "utils/resscheduler.h"
+#include "utils/vmem_tracker.h"
 #include "access/clog.h"
 
+#include "cdb/cdbbufferedread.h"
 #include "cdb/cdbgang.h"
 #include "cdb/cdbvars.h" /* Gp_role, Gp_is_writer, interconnect_setup_timeout */
 
 #include "cdb/cdbpersistentstore.h"
 #include "cdb/cdbquerycontextdispatching.h"
+#include "cdb/cdbsampler.h"
 #include "postmaster/primary_mirror_mode.h"
 
 /*
@@ -1373,21 +1376,13 @@ RecordTransactionCommit(void)
 		if (MyXactMadeXLogEntry)
 		{
 			/*
-			 * Sleep before flush! So we can flush more than one commit
-			 * records per single fsync.  (The idea is some other backend may
-			 * do the XLogFlush while we're sleeping.  This needs work still,
-			 * because on most Unixen, the minimum select() delay is 10msec or
-			 * more, which is way too long.)
-			 *
-			 * We do not sleep if enableFsync is not turned on, nor if there
-			 * are fewer than CommitSiblings other backends with active
-			 * transactions.
+			 * XLogFlushCommit sleeps for commit_delay before the flush if
+			 * there are at least CommitSiblings other backends with active
+			 * transactions, so that we can flush more than one commit
+			 * records per single fsync. Only the backend doing the flush
+			 * sleeps; the ones queued behind it find their records flushed.
 			 */
-			if (CommitDelay > 0 && enableFsync &&
-				CountActiveBackends() >= CommitSiblings)
-				pg_usleep(CommitDelay);
-
-			XLogFlush(recptr);
+			XLogFlushCommit(recptr);
 						
 #ifdef FAULT_INJECTOR
 			if (CurrentTransactionState->blockState == TBLOCK_END)
@@ -2519,6 +2514,7 @@ CommitTransaction(void)
 	TransactionState s = CurrentTransactionState;
 
 	bool willHaveObjectsFromSmgr;
+	bool		madeXidVisible;
 
 	ShowTransactionState("CommitTransaction");
 
@@ -2619,6 +2615,12 @@ CommitTransaction(void)
 	 */
 	s->state = TRANS_COMMIT;
 
+	/*
+	 * Whether our xid appears anywhere others may look, as decided by
+	 * RecordTransactionCommit for marking the commit in clog.
+	 */
+	madeXidVisible = (MyLastRecPtr.xrecoff != 0 || MyXactMadeTempRelUpdate);
+
 	/*
 	 * Here is where we really truly commit.
 	 */
@@ -2654,6 +2656,13 @@ CommitTransaction(void)
 		/* Clear the subtransaction-XID cache too while holding the lock */
 		MyProc->subxids.nxids = 0;
 		MyProc->subxids.overflowed = false;
+
+		/* snapshots taking us as running stay exact if nobody saw our xid */
+		if (madeXidVisible)
+			ProcArrayInvalidateSharedSnapshot();
+
+		/* publish our changes of the segment file catalogs */
+		AORelAdvanceSegfileVersions(s->transactionId);
 		LWLockRelease(ProcArrayLock);
 	}
 
@@ -2728,9 +2737,11 @@ CommitTransaction(void)
 	AtEOXact_on_commit_actions(true);
 	AtEOXact_Namespace(true);
 	/* smgrcommit already done */
+	AtEOXact_BufferedRead();
 	AtEOXact_Files();
 	AtEOXact_ComboCid();
 	AtEOXact_HashTables(true);
+	AtEOXact_RunawaySpillCallbacks();
 	AtEOXact_PgStat(true);
 	//AtEOXact_Snapshot(true);
 	pgstat_report_xact_timestamp(0);
@@ -2910,6 +2921,14 @@ PrepareTransaction(void)
 	MyProc->subxids.nxids = 0;
 	MyProc->subxids.overflowed = false;
 
+	ProcArrayInvalidateSharedSnapshot();
+
+	/*
+	 * Snapshots that see our xid completed will see the prepared changes of
+	 * the segment file catalogs once they are committed.
+	 */
+	AORelAdvanceSegfileVersions(xid);
+
 	LWLockRelease(ProcArrayLock);
 
 	/*
@@ -2959,9 +2978,11 @@ PrepareTransaction(void)
 	AtEOXact_on_commit_actions(true);
 	AtEOXact_Namespace(true);
 	/* smgrcommit already done */
+	AtEOXact_BufferedRead();
 	AtEOXact_Files();
 	AtEOXact_ComboCid();
 	AtEOXact_HashTables(true);
+	AtEOXact_RunawaySpillCallbacks();
 	/* don't call AtEOXact_PgStat here */
 
 	CurrentResourceOwner = GetTopResourceOwner();
@@ -3025,6 +3046,7 @@ AbortTransaction(void)
 	AtAbort_ResourceOwner();
 
 	AtAbort_ActiveQueryResource();
+	cdbsampler_reset();
 	/*
 	 * Release any LW locks we might be holding as quickly as possible.
 	 * (Regular locks, however, must be held till we finish aborting.)
@@ -3139,6 +3161,8 @@ AbortTransaction(void)
 		MyProc->subxids.nxids = 0;
 		MyProc->subxids.overflowed = false;
 
+		ProcArrayInvalidateSharedSnapshot();
+
 		LWLockRelease(ProcArrayLock);
 	}
 
@@ -3176,9 +3200,11 @@ AbortTransaction(void)
 	AtEOXact_on_commit_actions(false);
 	AtEOXact_Namespace(false);
 	smgrabort();
+	AtEOXact_BufferedRead();
 	AtEOXact_Files();
 	AtEOXact_ComboCid();
 	AtEOXact_HashTables(false);
+	AtEOXact_RunawaySpillCallbacks();
 	AtEOXact_PgStat(false);
 	//AtEOXact_Snapshot(false);
 	pgstat_report_xact_timestamp(0);
@@ -5076,6 +5102,8 @@ CommitSubTransaction(void)
 	AtEOSubXact_Files(true, s->subTransactionId,
 					  s->parent->subTransactionId);
 	AtEOSubXact_HashTables(true, s->nestingLevel);
+	AtEOSubXact_RunawaySpillCallbacks(true, s->subTransactionId,
+									  s->parent->subTransactionId);
 	AtEOSubXact_PgStat(true, s->nestingLevel);
 
 	/*
@@ -5209,6 +5237,8 @@ AbortSubTransaction(void)
 		AtEOSubXact_Files(false, s->subTransactionId,
 						  s->parent->subTransactionId);
 		AtEOSubXact_HashTables(false, s->nestingLevel);
+		AtEOSubXact_RunawaySpillCallbacks(false, s->subTransactionId,
+										  s->parent->subTransactionId);
 		AtEOSubXact_PgStat(false, s->nestingLevel);
 	}
 
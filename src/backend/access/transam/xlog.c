@@ -90,6 +90,9 @@ extern void FtsQDMirroringNewCheckpointLoc(XLogRecPtr *newCheckpointLocation);
 extern void disableQDMirroring_WalSendServerError(char *detail);
 extern bool QDMirroringWriteCheck(void);
 
+extern int	CommitDelay;
+extern int	CommitSiblings;
+
 /*
  *	Because O_DIRECT bypasses the kernel buffers, and because we never
  *	read those buffers except during crash recovery, it is a win to use
@@ -2480,6 +2483,8 @@ XLogWrite(XLogwrtRqst WriteRqst, bool flexible, bool xlog_switch)
 	Write->LogwrtResult = LogwrtResult;
 }
 
+static void XLogFlushInternal(XLogRecPtr record, bool groupCommit);
+
 /*
  * Ensure that all XLOG data through the given position is flushed to disk.
  *
@@ -2488,6 +2493,27 @@ XLogWrite(XLogwrtRqst WriteRqst, bool flexible, bool xlog_switch)
  */
 void
 XLogFlush(XLogRecPtr record)
+{
+	XLogFlushInternal(record, false);
+}
+
+/*
+ * Same as XLogFlush, for the commit record of a transaction.
+ *
+ * The backend that ends up doing the flush sleeps for commit_delay while
+ * holding WALWriteLock, so that the commits of the other busy backends queue
+ * up behind it and get flushed by the same fsync. The backends waiting for
+ * the lock find their records flushed and don't sleep at all, unlike sleeping
+ * before the flush in every committing backend.
+ */
+void
+XLogFlushCommit(XLogRecPtr record)
+{
+	XLogFlushInternal(record, true);
+}
+
+static void
+XLogFlushInternal(XLogRecPtr record, bool groupCommit)
 {
 	XLogRecPtr	WriteRqstPtr;
 	XLogwrtRqst WriteRqst;
@@ -2547,6 +2573,11 @@ XLogFlush(XLogRecPtr record)
 		LogwrtResult = XLogCtl->Write.LogwrtResult;
 		if (!XLByteLE(record, LogwrtResult.Flush))
 		{
+			/* give the other committing backends a chance to join the flush */
+			if (groupCommit && CommitDelay > 0 && enableFsync &&
+				CountActiveBackends() >= CommitSiblings)
+				pg_usleep(CommitDelay);
+
 			/* try to write/flush later additions to XLOG as well */
 			if (LWLockConditionalAcquire(WALInsertLock, LW_EXCLUSIVE))
 			{
@@ -2086,6 +2086,7 @@ IndexBuildAppendOnlyRowScan(Relation parentRelation,
 	aoscan = appendonly_beginscan(parentRelation,
 								  snapshot,
 								  0,
+								  NULL,
 								  NULL);
 	
 	while (appendonly_getnext(aoscan, ForwardScanDirection, slot) != NULL)
@@ -47,6 +47,8 @@
 #include "utils/syscache.h"
 
 #include "snappy-c.h"
+#include "lz4.h"
+#include "zstd.h"
 
 /* names we expect to see in ENCODING clauses */
 char *storage_directive_names[] = {"compresstype", "compresslevel",
@@ -131,6 +133,29 @@ GetCompressionImplementation(char *comptype)
 		return funcs;
 	}
 
+	/* The same hack for zstd and lz4. */
+	if (strcmp(NameStr(compname), "zstd") == 0)
+	{
+		funcs = palloc0(sizeof(PGFunction) * NUM_COMPRESS_FUNCS);
+		funcs[COMPRESSION_CONSTRUCTOR] = zstd_constructor;
+		funcs[COMPRESSION_DESTRUCTOR] = zstd_destructor;
+		funcs[COMPRESSION_COMPRESS] = zstd_compress_internal;
+		funcs[COMPRESSION_DECOMPRESS] = zstd_decompress_internal;
+		funcs[COMPRESSION_VALIDATOR] = zstd_validator;
+		return funcs;
+	}
+
+	if (strcmp(NameStr(compname), "lz4") == 0)
+	{
+		funcs = palloc0(sizeof(PGFunction) * NUM_COMPRESS_FUNCS);
+		funcs[COMPRESSION_CONSTRUCTOR] = lz4_constructor;
+		funcs[COMPRESSION_DESTRUCTOR] = lz4_destructor;
+		funcs[COMPRESSION_COMPRESS] = lz4_compress_internal;
+		funcs[COMPRESSION_DECOMPRESS] = lz4_decompress_internal;
+		funcs[COMPRESSION_VALIDATOR] = lz4_validator;
+		return funcs;
+	}
+
 	tuple = caql_getfirst(
 			NULL,
 			cql("SELECT * FROM pg_compression "
@@ -483,6 +508,215 @@ snappy_validator(PG_FUNCTION_ARGS)
 	PG_RETURN_VOID();
 }
 
+/*
+ * The zstd contexts are allocated by the library with malloc. They are kept
+ * for the life of the backend rather than of the CompressionState, so that a
+ * block compressed or decompressed does not allocate them again and an error
+ * in the middle of an insert does not leak them.
+ */
+static ZSTD_CCtx *zstd_cctx = NULL;
+static ZSTD_DCtx *zstd_dctx = NULL;
+
+typedef struct zstd_state
+{
+	int			level;			/* Compression level */
+} zstd_state;
+
+static size_t
+zstd_max_compressed_length(size_t src_sz)
+{
+	return ZSTD_compressBound(src_sz);
+}
+
+Datum
+zstd_constructor(PG_FUNCTION_ARGS)
+{
+	TupleDesc			td = PG_GETARG_POINTER(0);
+	StorageAttributes	*sa = PG_GETARG_POINTER(1);
+	CompressionState	*cs	= palloc0(sizeof(CompressionState));
+	zstd_state			*state = palloc0(sizeof(zstd_state));
+	bool				compress = PG_GETARG_BOOL(2);
+
+	cs->opaque = (void *) state;
+	cs->desired_sz = zstd_max_compressed_length;
+
+	Insist(PointerIsValid(td));
+	Insist(PointerIsValid(sa->comptype));
+
+	if (sa->complevel == 0)
+		sa->complevel = 1;
+
+	state->level = sa->complevel;
+
+	if (compress && zstd_cctx == NULL)
+		zstd_cctx = ZSTD_createCCtx();
+	if (!compress && zstd_dctx == NULL)
+		zstd_dctx = ZSTD_createDCtx();
+
+	if ((compress && zstd_cctx == NULL) || (!compress && zstd_dctx == NULL))
+		ereport(ERROR,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of memory"),
+				 errdetail("Failed to create a zstd %s context.",
+						   compress ? "compression" : "decompression")));
+
+	PG_RETURN_POINTER(cs);
+}
+
+Datum
+zstd_destructor(PG_FUNCTION_ARGS)
+{
+	CompressionState	*cs = PG_GETARG_POINTER(0);
+
+	Insist(PointerIsValid(cs->opaque));
+	pfree(cs->opaque);
+
+	PG_RETURN_VOID();
+}
+
+Datum
+zstd_compress_internal(PG_FUNCTION_ARGS)
+{
+	const char		*src = PG_GETARG_POINTER(0);
+	size_t			src_sz = PG_GETARG_INT32(1);
+	char			*dst = PG_GETARG_POINTER(2);
+	size_t			dst_sz = PG_GETARG_INT32(3);
+	int32			*dst_used = PG_GETARG_POINTER(4);
+	CompressionState *cs = (CompressionState *) PG_GETARG_POINTER(5);
+	zstd_state		*state = (zstd_state *) cs->opaque;
+	size_t			retval;
+
+	Insist(dst_sz >= ZSTD_compressBound(src_sz));
+	Insist(zstd_cctx != NULL);
+
+	retval = ZSTD_compressCCtx(zstd_cctx, dst, dst_sz, src, src_sz,
+							   state->level);
+	if (ZSTD_isError(retval))
+		elog(ERROR, "failure for ZSTD_compressCCtx(): %s: "
+			 "src_sz=%d dst_sz=%d",
+			 ZSTD_getErrorName(retval), (int) src_sz, (int) dst_sz);
+
+	*dst_used = retval;
+
+	PG_RETURN_VOID();
+}
+
+Datum
+zstd_decompress_internal(PG_FUNCTION_ARGS)
+{
+	const char		*src	= PG_GETARG_POINTER(0);
+	size_t			src_sz = PG_GETARG_INT32(1);
+	char			*dst	= PG_GETARG_POINTER(2);
+	size_t			dst_sz = PG_GETARG_INT32(3);
+	int32			*dst_used = PG_GETARG_POINTER(4);
+	size_t			retval;
+
+	Insist(src_sz > 0 && dst_sz > 0);
+	Insist(zstd_dctx != NULL);
+
+	retval = ZSTD_decompressDCtx(zstd_dctx, dst, dst_sz, src, src_sz);
+	if (ZSTD_isError(retval))
+		elog(ERROR, "failure for ZSTD_decompressDCtx(): %s: "
+			 "src_sz=%d dst_sz=%d",
+			 ZSTD_getErrorName(retval), (int) src_sz, (int) dst_sz);
+
+	*dst_used = retval;
+
+	PG_RETURN_VOID();
+}
+
+Datum
+zstd_validator(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_VOID();
+}
+
+static size_t
+lz4_max_compressed_length(size_t src_sz)
+{
+	return LZ4_compressBound(src_sz);
+}
+
+Datum
+lz4_constructor(PG_FUNCTION_ARGS)
+{
+	TupleDesc			td = PG_GETARG_POINTER(0);
+	StorageAttributes	*sa = PG_GETARG_POINTER(1);
+	CompressionState	*cs	= palloc0(sizeof(CompressionState));
+
+	cs->opaque = NULL;
+	cs->desired_sz = lz4_max_compressed_length;
+
+	Insist(PointerIsValid(td));
+	Insist(PointerIsValid(sa->comptype));
+
+	PG_RETURN_POINTER(cs);
+}
+
+Datum
+lz4_destructor(PG_FUNCTION_ARGS)
+{
+	CompressionState	*cs = PG_GETARG_POINTER(0);
+
+	if (cs->opaque)
+	{
+		Insist(PointerIsValid(cs->opaque));
+		pfree(cs->opaque);
+	}
+
+	PG_RETURN_VOID();
+}
+
+Datum
+lz4_compress_internal(PG_FUNCTION_ARGS)
+{
+	const char		*src = PG_GETARG_POINTER(0);
+	int32			src_sz = PG_GETARG_INT32(1);
+	char			*dst = PG_GETARG_POINTER(2);
+	int32			dst_sz = PG_GETARG_INT32(3);
+	int32			*dst_used = PG_GETARG_POINTER(4);
+	int				retval;
+
+	Insist(dst_sz >= LZ4_compressBound(src_sz));
+
+	retval = LZ4_compress_default(src, dst, src_sz, dst_sz);
+	if (retval <= 0)
+		elog(ERROR, "failure (return value %d) for LZ4_compress_default(): "
+			 "src_sz=%d dst_sz=%d", retval, src_sz, dst_sz);
+
+	*dst_used = retval;
+
+	PG_RETURN_VOID();
+}
+
+Datum
+lz4_decompress_internal(PG_FUNCTION_ARGS)
+{
+	const char		*src	= PG_GETARG_POINTER(0);
+	int32			src_sz = PG_GETARG_INT32(1);
+	char			*dst	= PG_GETARG_POINTER(2);
+	int32			dst_sz = PG_GETARG_INT32(3);
+	int32			*dst_used = PG_GETARG_POINTER(4);
+	int				retval;
+
+	Insist(src_sz > 0 && dst_sz > 0);
+
+	retval = LZ4_decompress_safe(src, dst, src_sz, dst_sz);
+	if (retval < 0)
+		elog(ERROR, "invalid input for LZ4_decompress_safe(): "
+			 "src_sz=%d dst_sz=%d", src_sz, dst_sz);
+
+	*dst_used = retval;
+
+	PG_RETURN_VOID();
+}
+
+Datum
+lz4_validator(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_VOID();
+}
+
 Datum
 rle_type_constructor(PG_FUNCTION_ARGS)
 {
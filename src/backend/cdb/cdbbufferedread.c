@@ -28,8 +28,89 @@
  */
 #include "cdb/cdbbufferedread.h"
 #include <unistd.h>				/* for read() */
+#include <pthread.h>
+#include "cdb/cdbgang.h"		/* gp_pthread_create */
 #include "utils/guc.h"
 
+/*
+ * Read-ahead.
+ *
+ * A helper thread does the large reads that follow the current one through
+ * a read-ahead handle of the file, see FileOpenReadAhead, into chunks that
+ * have the layout of the BufferedRead memory: the before memory and then
+ * the large read memory. The chunk of the current large read becomes the
+ * before and large read memory of the BufferedRead. The chunk of the large
+ * read before it is kept too, as BufferedReadUseBeforeBuffer copies the end
+ * of it into the before memory of the current one.
+ *
+ * The thread never calls elog or palloc, and the chunks are malloc'd, so
+ * AtEOXact_BufferedRead can stop the read-ahead of a scan whose memory is
+ * already gone.
+ */
+#define MAX_READ_AHEAD_CHUNKS (2 + 2)
+
+typedef enum BufferedReadAheadChunkState
+{
+	BufferedReadAheadChunkFree = 0,
+	BufferedReadAheadChunkQueued,
+	BufferedReadAheadChunkReading,
+	BufferedReadAheadChunkDone,
+	BufferedReadAheadChunkFailed
+} BufferedReadAheadChunkState;
+
+typedef struct BufferedReadAheadChunk
+{
+	uint8		*memory;
+	int64		position;
+	int32		len;
+	int32		actualLen;		/* of the failed read, 0 at EOF */
+	int			readErrno;
+	int64		sequence;		/* the lowest queued is read first */
+	BufferedReadAheadChunkState state;
+} BufferedReadAheadChunk;
+
+typedef struct BufferedReadAhead
+{
+	struct BufferedReadAhead *next;
+
+	pthread_t	thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;		/* any change of a chunk state */
+	bool		shutdown;
+
+	FileReadAhead handle;
+	File		file;
+	char		*filePathName;	/* malloc'd */
+
+	int32		maxBufferLen;
+	int			depth;
+	int			numChunks;
+	BufferedReadAheadChunk chunks[MAX_READ_AHEAD_CHUNKS];
+	BufferedReadAheadChunk *current;
+	BufferedReadAheadChunk *previous;
+	int64		sequence;
+} BufferedReadAhead;
+
+/* all the read-aheads of the process, for AtEOXact_BufferedRead */
+static BufferedReadAhead *activeReadAheads = NULL;
+
+static void *BufferedReadAheadThread(void *arg);
+static void BufferedReadAheadStart(
+    BufferedRead        *bufferedRead);
+static void BufferedReadAheadStop(
+    BufferedReadAhead   *readAhead);
+static void BufferedReadAheadEnd(
+    BufferedRead        *bufferedRead);
+static void BufferedReadAheadCancel(
+    BufferedReadAhead   *readAhead,
+    bool                 forgetDone);
+static void BufferedReadAheadSetFile(
+    BufferedRead        *bufferedRead);
+static void BufferedReadAheadIo(
+    BufferedRead        *bufferedRead);
+static void BufferedReadAheadQueue(
+    BufferedRead        *bufferedRead);
+
 static void BufferedReadIo(
     BufferedRead        *bufferedRead);
 static uint8 *BufferedReadUseBeforeBuffer(
@@ -122,6 +203,524 @@ void BufferedReadInit(
 	bufferedRead->temporaryLimitFileLen = 0;
 }
 
+/*
+ * The helper thread: read the queued chunks, lowest sequence first.
+ */
+static void *
+BufferedReadAheadThread(void *arg)
+{
+	BufferedReadAhead *readAhead = (BufferedReadAhead *) arg;
+
+	gp_set_thread_sigmasks();
+
+	pthread_mutex_lock(&readAhead->mutex);
+	while (!readAhead->shutdown)
+	{
+		BufferedReadAheadChunk *chunk = NULL;
+		FileReadAhead handle;
+		uint8	   *largeReadMemory;
+		int64		position;
+		int32		len;
+		int32		offset;
+		int			actualLen = 0;
+		int			i;
+
+		for (i = 0; i < readAhead->numChunks; i++)
+		{
+			BufferedReadAheadChunk *c = &readAhead->chunks[i];
+
+			if (c->state == BufferedReadAheadChunkQueued &&
+				(chunk == NULL || c->sequence < chunk->sequence))
+				chunk = c;
+		}
+
+		if (chunk == NULL)
+		{
+			pthread_cond_wait(&readAhead->cond, &readAhead->mutex);
+			continue;
+		}
+
+		chunk->state = BufferedReadAheadChunkReading;
+		handle = readAhead->handle;
+		largeReadMemory = &chunk->memory[readAhead->maxBufferLen];
+		position = chunk->position;
+		len = chunk->len;
+		pthread_mutex_unlock(&readAhead->mutex);
+
+		offset = 0;
+		while (offset < len)
+		{
+			actualLen = FileReadAheadRead(handle,
+										  (char *) &largeReadMemory[offset],
+										  len - offset,
+										  position + offset);
+			if (actualLen <= 0)
+				break;
+			offset += actualLen;
+		}
+
+		pthread_mutex_lock(&readAhead->mutex);
+		if (offset == len)
+			chunk->state = BufferedReadAheadChunkDone;
+		else
+		{
+			chunk->state = BufferedReadAheadChunkFailed;
+			chunk->actualLen = actualLen;
+			chunk->readErrno = errno;
+		}
+		pthread_cond_broadcast(&readAhead->cond);
+	}
+	pthread_mutex_unlock(&readAhead->mutex);
+
+	return NULL;
+}
+
+/*
+ * Set up the read-ahead of a BufferedRead, which is left synchronous if
+ * the thread or the chunks cannot be had.
+ */
+static void
+BufferedReadAheadStart(
+    BufferedRead        *bufferedRead)
+{
+	BufferedReadAhead *readAhead;
+	int32		chunkLen;
+	int			i;
+	int			pthread_err;
+
+	Assert(bufferedRead->readAhead == NULL);
+
+	readAhead = (BufferedReadAhead *) calloc(1, sizeof(BufferedReadAhead));
+	if (readAhead == NULL)
+		return;
+
+	readAhead->file = -1;
+	readAhead->maxBufferLen = bufferedRead->maxBufferLen;
+	readAhead->depth = gp_appendonly_read_ahead_buffers;
+	readAhead->numChunks = readAhead->depth + 2;
+	Assert(readAhead->numChunks <= MAX_READ_AHEAD_CHUNKS);
+
+	chunkLen = BufferedReadMemoryLen(bufferedRead->maxBufferLen,
+									 bufferedRead->maxLargeReadLen);
+	for (i = 0; i < readAhead->numChunks; i++)
+	{
+		readAhead->chunks[i].memory = (uint8 *) malloc(chunkLen);
+		if (readAhead->chunks[i].memory == NULL)
+		{
+			while (--i >= 0)
+				free(readAhead->chunks[i].memory);
+			free(readAhead);
+			elog(LOG, "could not allocate the read-ahead buffers for table \"%s\", reading synchronously",
+				 bufferedRead->relationName);
+			return;
+		}
+	}
+
+	pthread_mutex_init(&readAhead->mutex, NULL);
+	pthread_cond_init(&readAhead->cond, NULL);
+
+	pthread_err = gp_pthread_create(&readAhead->thread, BufferedReadAheadThread,
+									readAhead, "BufferedReadAheadStart");
+	if (pthread_err != 0)
+	{
+		elog(LOG, "could not create the read-ahead thread for table \"%s\" (error %d), reading synchronously",
+			 bufferedRead->relationName, pthread_err);
+		pthread_cond_destroy(&readAhead->cond);
+		pthread_mutex_destroy(&readAhead->mutex);
+		for (i = 0; i < readAhead->numChunks; i++)
+			free(readAhead->chunks[i].memory);
+		free(readAhead);
+		return;
+	}
+
+	readAhead->next = activeReadAheads;
+	activeReadAheads = readAhead;
+
+	bufferedRead->readAhead = readAhead;
+}
+
+/*
+ * Stop the thread of a read-ahead and free it. The BufferedRead is not
+ * looked at, it may be gone.
+ */
+static void
+BufferedReadAheadStop(
+    BufferedReadAhead   *readAhead)
+{
+	BufferedReadAhead **prev;
+	int			i;
+
+	pthread_mutex_lock(&readAhead->mutex);
+	readAhead->shutdown = true;
+	pthread_cond_broadcast(&readAhead->cond);
+	pthread_mutex_unlock(&readAhead->mutex);
+
+	pthread_join(readAhead->thread, NULL);
+
+	for (prev = &activeReadAheads; *prev != NULL; prev = &(*prev)->next)
+	{
+		if (*prev == readAhead)
+		{
+			*prev = readAhead->next;
+			break;
+		}
+	}
+
+	if (readAhead->handle != NULL)
+		FileCloseReadAhead(readAhead->handle);
+	if (readAhead->filePathName != NULL)
+		free(readAhead->filePathName);
+
+	pthread_cond_destroy(&readAhead->cond);
+	pthread_mutex_destroy(&readAhead->mutex);
+	for (i = 0; i < readAhead->numChunks; i++)
+		free(readAhead->chunks[i].memory);
+	free(readAhead);
+}
+
+/*
+ * Go back to synchronous reads, in the memory given to BufferedReadInit.
+ */
+static void
+BufferedReadAheadEnd(
+    BufferedRead        *bufferedRead)
+{
+	if (bufferedRead->readAhead == NULL)
+		return;
+
+	BufferedReadAheadStop(bufferedRead->readAhead);
+	bufferedRead->readAhead = NULL;
+
+	bufferedRead->beforeBufferMemory = bufferedRead->memory;
+	bufferedRead->largeReadMemory =
+						&bufferedRead->memory[bufferedRead->maxBufferLen];
+}
+
+/*
+ * Forget the queued reads, and the done ones too if forgetDone, and wait
+ * for the one being read. The current and the previous chunks are kept.
+ *
+ * Called with the mutex held.
+ */
+static void
+BufferedReadAheadCancel(
+    BufferedReadAhead   *readAhead,
+    bool                 forgetDone)
+{
+	bool		reading;
+	int			i;
+
+	do
+	{
+		reading = false;
+		for (i = 0; i < readAhead->numChunks; i++)
+		{
+			BufferedReadAheadChunk *chunk = &readAhead->chunks[i];
+
+			if (chunk == readAhead->current || chunk == readAhead->previous)
+				continue;
+
+			if (chunk->state == BufferedReadAheadChunkReading)
+				reading = true;
+			else if (chunk->state == BufferedReadAheadChunkQueued ||
+					 (forgetDone && chunk->state != BufferedReadAheadChunkFree))
+				chunk->state = BufferedReadAheadChunkFree;
+		}
+
+		if (reading)
+			pthread_cond_wait(&readAhead->cond, &readAhead->mutex);
+	} while (reading);
+}
+
+/*
+ * Point the read-ahead at the file given to BufferedReadSetFile. The done
+ * chunks are kept for another split of the same file. The read-ahead is
+ * ended if the file cannot be opened a second time.
+ */
+static void
+BufferedReadAheadSetFile(
+    BufferedRead        *bufferedRead)
+{
+	BufferedReadAhead *readAhead = bufferedRead->readAhead;
+	bool		sameFile;
+
+	sameFile = (readAhead->handle != NULL &&
+				readAhead->file == bufferedRead->file &&
+				strcmp(readAhead->filePathName, bufferedRead->filePathName) == 0);
+
+	pthread_mutex_lock(&readAhead->mutex);
+	readAhead->current = NULL;
+	readAhead->previous = NULL;
+	BufferedReadAheadCancel(readAhead, !sameFile);
+	pthread_mutex_unlock(&readAhead->mutex);
+
+	bufferedRead->beforeBufferMemory = bufferedRead->memory;
+	bufferedRead->largeReadMemory =
+						&bufferedRead->memory[bufferedRead->maxBufferLen];
+
+	if (sameFile)
+		return;
+
+	/* no chunk is queued or being read, the thread does not use the handle */
+	if (readAhead->handle != NULL)
+	{
+		FileCloseReadAhead(readAhead->handle);
+		readAhead->handle = NULL;
+	}
+	if (readAhead->filePathName != NULL)
+	{
+		free(readAhead->filePathName);
+		readAhead->filePathName = NULL;
+	}
+	readAhead->file = -1;
+
+	readAhead->filePathName = strdup(bufferedRead->filePathName);
+	if (readAhead->filePathName != NULL)
+		readAhead->handle = FileOpenReadAhead(bufferedRead->file);
+
+	if (readAhead->handle == NULL)
+	{
+		elog(LOG, "could not open the read-ahead handle of table \"%s\" in file \"%s\", reading synchronously",
+			 bufferedRead->relationName, bufferedRead->filePathName);
+		BufferedReadAheadEnd(bufferedRead);
+		return;
+	}
+
+	readAhead->file = bufferedRead->file;
+}
+
+/*
+ * Queue the large reads that follow the current one, up to the temporary
+ * limit or to the end of the split, and forget the queued reads that are
+ * no longer needed.
+ *
+ * Called with the mutex held.
+ */
+static void
+BufferedReadAheadQueue(
+    BufferedRead        *bufferedRead)
+{
+	BufferedReadAhead *readAhead = bufferedRead->readAhead;
+	int64		wantedPosition[MAX_READ_AHEAD_CHUNKS];
+	int32		wantedLen[MAX_READ_AHEAD_CHUNKS];
+	bool		wantedFound[MAX_READ_AHEAD_CHUNKS];
+	bool		kept[MAX_READ_AHEAD_CHUNKS];
+	int			numWanted;
+	int64		limit;
+	int64		position;
+	int			i;
+	int			w;
+
+	if (bufferedRead->haveTemporaryLimitInEffect)
+		limit = bufferedRead->temporaryLimitFileLen;
+	else
+		limit = bufferedRead->splitLen;
+	if (limit > bufferedRead->fileLen)
+		limit = bufferedRead->fileLen;
+
+	numWanted = 0;
+	position = bufferedRead->largeReadPosition + bufferedRead->largeReadLen;
+	while (numWanted < readAhead->depth && position < limit)
+	{
+		int64		remainingLen = limit - position;
+
+		wantedPosition[numWanted] = position;
+		if (remainingLen > bufferedRead->maxLargeReadLen)
+			wantedLen[numWanted] = bufferedRead->maxLargeReadLen;
+		else
+			wantedLen[numWanted] = (int32) remainingLen;
+		wantedFound[numWanted] = false;
+
+		position += wantedLen[numWanted];
+		numWanted++;
+	}
+
+	for (i = 0; i < readAhead->numChunks; i++)
+	{
+		BufferedReadAheadChunk *chunk = &readAhead->chunks[i];
+
+		kept[i] = false;
+		if (chunk == readAhead->current || chunk == readAhead->previous)
+			continue;
+
+		if (chunk->state == BufferedReadAheadChunkQueued ||
+			chunk->state == BufferedReadAheadChunkReading ||
+			chunk->state == BufferedReadAheadChunkDone)
+		{
+			for (w = 0; w < numWanted; w++)
+			{
+				if (!wantedFound[w] &&
+					chunk->position == wantedPosition[w] &&
+					chunk->len >= wantedLen[w])
+				{
+					wantedFound[w] = true;
+					kept[i] = true;
+					break;
+				}
+			}
+		}
+
+		if (!kept[i] && chunk->state == BufferedReadAheadChunkQueued)
+			chunk->state = BufferedReadAheadChunkFree;
+	}
+
+	for (w = 0; w < numWanted; w++)
+	{
+		BufferedReadAheadChunk *chunk = NULL;
+
+		if (wantedFound[w])
+			continue;
+
+		for (i = 0; i < readAhead->numChunks; i++)
+		{
+			BufferedReadAheadChunk *c = &readAhead->chunks[i];
+
+			if (kept[i] || c == readAhead->current || c == readAhead->previous ||
+				c->state == BufferedReadAheadChunkReading)
+				continue;
+
+			/* a free chunk rather than a done one */
+			if (chunk == NULL || c->state == BufferedReadAheadChunkFree)
+			{
+				chunk = c;
+				if (c->state == BufferedReadAheadChunkFree)
+					break;
+			}
+		}
+
+		if (chunk == NULL)
+			break;
+
+		kept[chunk - readAhead->chunks] = true;
+		chunk->position = wantedPosition[w];
+		chunk->len = wantedLen[w];
+		chunk->sequence = ++readAhead->sequence;
+		chunk->state = BufferedReadAheadChunkQueued;
+	}
+
+	pthread_cond_broadcast(&readAhead->cond);
+}
+
+/*
+ * The large read of BufferedReadIo with read-ahead: wait for the chunk of
+ * the large read, queueing it first if it is not already, and make it the
+ * before and large read memory.
+ */
+static void
+BufferedReadAheadIo(
+    BufferedRead        *bufferedRead)
+{
+	BufferedReadAhead *readAhead = bufferedRead->readAhead;
+	BufferedReadAheadChunk *chunk = NULL;
+	int64		position = bufferedRead->largeReadPosition;
+	int32		len = bufferedRead->largeReadLen;
+	int			actualLen;
+	int			readErrno;
+	int			i;
+
+	pthread_mutex_lock(&readAhead->mutex);
+
+	/* the chunk before the previous one is no longer needed */
+	readAhead->previous = readAhead->current;
+	readAhead->current = NULL;
+
+	for (i = 0; i < readAhead->numChunks; i++)
+	{
+		BufferedReadAheadChunk *c = &readAhead->chunks[i];
+
+		if (c != readAhead->previous &&
+			(c->state == BufferedReadAheadChunkQueued ||
+			 c->state == BufferedReadAheadChunkReading ||
+			 c->state == BufferedReadAheadChunkDone) &&
+			c->position == position && c->len >= len)
+		{
+			chunk = c;
+			break;
+		}
+	}
+
+	while (chunk == NULL)
+	{
+		for (i = 0; i < readAhead->numChunks; i++)
+		{
+			BufferedReadAheadChunk *c = &readAhead->chunks[i];
+
+			if (c == readAhead->previous ||
+				c->state == BufferedReadAheadChunkReading)
+				continue;
+
+			/* a free chunk rather than a queued or done one */
+			if (chunk == NULL || c->state == BufferedReadAheadChunkFree)
+			{
+				chunk = c;
+				if (c->state == BufferedReadAheadChunkFree)
+					break;
+			}
+		}
+
+		if (chunk == NULL)
+		{
+			pthread_cond_wait(&readAhead->cond, &readAhead->mutex);
+			continue;
+		}
+
+		chunk->position = position;
+		chunk->len = len;
+		chunk->state = BufferedReadAheadChunkQueued;
+	}
+
+	if (chunk->state == BufferedReadAheadChunkQueued)
+	{
+		/* ahead of the others */
+		chunk->sequence = 0;
+		pthread_cond_broadcast(&readAhead->cond);
+	}
+
+	while (chunk->state == BufferedReadAheadChunkQueued ||
+		   chunk->state == BufferedReadAheadChunkReading)
+		pthread_cond_wait(&readAhead->cond, &readAhead->mutex);
+
+	if (chunk->state == BufferedReadAheadChunkFailed)
+	{
+		actualLen = chunk->actualLen;
+		readErrno = chunk->readErrno;
+		chunk->state = BufferedReadAheadChunkFree;
+		pthread_mutex_unlock(&readAhead->mutex);
+
+		if (actualLen == 0)
+			ereport(ERROR, (errcode_for_file_access(),
+							errmsg("read beyond eof in table \"%s\" in file \"%s\"",
+								   bufferedRead->relationName,
+							       bufferedRead->filePathName)));
+
+		errno = readErrno;
+		ereport(ERROR, (errcode_for_file_access(),
+						errmsg("unable to read table \"%s\" file \"%s\" (errcode %d)",
+							   bufferedRead->relationName,
+							   bufferedRead->filePathName,
+							   readErrno)));
+	}
+
+	readAhead->current = chunk;
+	bufferedRead->beforeBufferMemory = chunk->memory;
+	bufferedRead->largeReadMemory = &chunk->memory[bufferedRead->maxBufferLen];
+
+	BufferedReadAheadQueue(bufferedRead);
+
+	pthread_mutex_unlock(&readAhead->mutex);
+
+	if (Debug_appendonly_print_read_block)
+	{
+		elog(LOG,
+			 "Append-Only storage read: table '%s', segment file '%s', read postition " INT64_FORMAT ", "
+			 "large read length %d done ahead",
+			 bufferedRead->relationName,
+			 bufferedRead->filePathName,
+			 bufferedRead->largeReadPosition,
+			 bufferedRead->largeReadLen);
+	}
+}
+
 /*
  * Takes an open file handle for the next file.
  */
@@ -155,6 +754,22 @@ void BufferedReadSetFile(
 	bufferedRead->haveTemporaryLimitInEffect = false;
 	bufferedRead->temporaryLimitFileLen = 0;
 
+	/*
+	 * Read-ahead is set when a file is taken, a file is read either all
+	 * synchronously or all ahead.
+	 */
+	if (bufferedRead->readAhead != NULL &&
+		bufferedRead->readAhead->depth != gp_appendonly_read_ahead_buffers)
+		BufferedReadAheadEnd(bufferedRead);
+
+	if (gp_appendonly_read_ahead_buffers > 0)
+	{
+		if (bufferedRead->readAhead == NULL)
+			BufferedReadAheadStart(bufferedRead);
+		if (bufferedRead->readAhead != NULL)
+			BufferedReadAheadSetFile(bufferedRead);
+	}
+
     int64 real_fileLen = fileLen - bufferedRead->largeReadPosition;
 	if (real_fileLen > 0)
 	{
@@ -181,6 +796,13 @@ static void BufferedReadIo(
 
 	largeReadLen = bufferedRead->largeReadLen;
 	Assert(bufferedRead->largeReadLen > 0);
+
+	if (bufferedRead->readAhead != NULL)
+	{
+		BufferedReadAheadIo(bufferedRead);
+		return;
+	}
+
 	largeReadMemory = bufferedRead->largeReadMemory;
 
 #ifdef USE_ASSERT_CHECKING
@@ -263,6 +885,7 @@ static uint8 *BufferedReadUseBeforeBuffer(
 	int32 beforeLen;
 	int32 beforeOffset;
 	int32 extraLen;
+	uint8 *previousLargeReadMemory;
 
 	Assert(bufferedRead->largeReadLen - bufferedRead->bufferOffset > 0);
 	
@@ -305,10 +928,14 @@ static uint8 *BufferedReadUseBeforeBuffer(
 	
 	/*
 	 * Copy data from the current large-read buffer into the before memory.
+	 * With read-ahead, the next read comes in other memory, the copy is
+	 * done after it into its before memory.
 	 */
-	memcpy(&bufferedRead->beforeBufferMemory[beforeOffset],
-	       &bufferedRead->largeReadMemory[bufferedRead->bufferOffset],
-	       beforeLen);
+	previousLargeReadMemory = bufferedRead->largeReadMemory;
+	if (bufferedRead->readAhead == NULL)
+		memcpy(&bufferedRead->beforeBufferMemory[beforeOffset],
+			   &bufferedRead->largeReadMemory[bufferedRead->bufferOffset],
+			   beforeLen);
 
 	/*
 	 * Do the next read.
@@ -333,6 +960,11 @@ static uint8 *BufferedReadUseBeforeBuffer(
 	
 	BufferedReadIo(bufferedRead);
 
+	if (bufferedRead->readAhead != NULL)
+		memcpy(&bufferedRead->beforeBufferMemory[beforeOffset],
+			   &previousLargeReadMemory[bufferedRead->bufferOffset],
+			   beforeLen);
+
 	extraLen = maxReadAheadLen - beforeLen;
 	Assert(extraLen > 0);
 	if (extraLen > nextReadLen)
@@ -420,6 +1052,12 @@ void BufferedReadSetTemporaryRange(
 		}
 	}
 
+	/*
+	 * The read-ahead of the new read stops at the temporary limit.
+	 */
+	bufferedRead->haveTemporaryLimitInEffect = true;
+	bufferedRead->temporaryLimitFileLen = afterFileOffset;
+
 	if (newReadNeeded)
 	{
 		int64	remainingFileLen;
@@ -430,7 +1068,11 @@ void BufferedReadSetTemporaryRange(
 		 * this could happen during index scan, if we do look up for a
 		 * block directory entry at the end of the segment file, followed
 		 * by a look up for a block directory entry at the beginning of file.
+		 *
+		 * The read-ahead reads at given positions, it does not seek.
 		 */
+		if (bufferedRead->readAhead == NULL)
+		{
 			int64 seekOffset = beginFileOffset - largeReadAfterPos;
 			int64 seekPos = FileSeek(bufferedRead->file, seekOffset, SEEK_CUR);
 			if (seekPos != beginFileOffset)
@@ -440,6 +1082,7 @@ void BufferedReadSetTemporaryRange(
 									   bufferedRead->filePathName,
 									   errno),
 						    errdetail("%s", HdfsGetLastError())));
+		}
 
 		bufferedRead->bufferOffset = 0;
 
@@ -454,10 +1097,6 @@ void BufferedReadSetTemporaryRange(
 		if (bufferedRead->largeReadLen > 0)
 			BufferedReadIo(bufferedRead);
 	}
-
-	bufferedRead->haveTemporaryLimitInEffect = true;
-	bufferedRead->temporaryLimitFileLen = afterFileOffset;
-	
 }
 
 /*
@@ -713,6 +1352,9 @@ void BufferedReadCompleteFile(
 	Assert(bufferedRead != NULL);
 	Assert(bufferedRead->file >= 0);
 
+	/* the caller closes the file, so does the read-ahead with its handle */
+	BufferedReadAheadEnd(bufferedRead);
+
 	bufferedRead->file = -1;
 	bufferedRead->filePathName = NULL;
 	bufferedRead->fileLen = 0;
@@ -738,6 +1380,8 @@ void BufferedReadFinish(BufferedRead *bufferedRead)
 	Assert(bufferedRead->bufferOffset == 0);
 	Assert(bufferedRead->bufferLen == 0);	
 
+	BufferedReadAheadEnd(bufferedRead);
+
 	if(bufferedRead->memory)
 	{
 		pfree(bufferedRead->memory);
@@ -751,3 +1395,13 @@ void BufferedReadFinish(BufferedRead *bufferedRead)
 		bufferedRead->relationName = NULL;
 	}
 }
+
+/*
+ * Stop the read-ahead of the scans that did not get to BufferedReadFinish,
+ * at the end of a transaction. Their BufferedRead may be freed already.
+ */
+void AtEOXact_BufferedRead(void)
+{
+	while (activeReadAheads != NULL)
+		BufferedReadAheadStop(activeReadAheads);
+}
@@ -54,6 +54,7 @@
 #include "nodes/nodes.h"
 #include "nodes/parsenodes.h"
 #include "optimizer/walkers.h"
+#include "optimizer/cost.h"
 #include "optimizer/planmain.h"
 #include "parser/parsetree.h"
 #include "storage/fd.h"
@@ -354,6 +355,7 @@ typedef struct split_to_segment_mapping_context {
     int metadata_cache_time_us;
     int alloc_resource_time_us;
     int cal_datalocality_time_us;
+    int split_assign_time_us;
     bool isMagmaTableExist;
     bool isTargetNoMagma;
     int magmaRangeNum;
@@ -415,6 +417,9 @@ static void check_keep_hash_and_external_table(
 static int64 get_block_locations_and_calculate_table_size(
 		split_to_segment_mapping_context *collector_context);
 
+static void prefetch_hdfs_data_block_locations(
+		split_to_segment_mapping_context *context);
+
 static bool dataStoredInHdfs(Relation rel);
 
 static List *get_virtual_segments(QueryResource *resource);
@@ -512,6 +517,10 @@ static int remedy_non_localRead(int fileIndex, int splitIndex, int parentPos,
 		TargetSegmentIDMap* idMap,
 		Relation_Assignment_Context* assignment_context);
 
+static bool mark_split_of_file_in_vseg(Relation_File** file_vector,
+		int fileIndex, int vseg, int vsegNum, int *vsegMarks, int *markedFile,
+		int *markGeneration);
+
 static int select_random_host_algorithm(Relation_Assignment_Context *context,
 		int64 splitsize, int64 maxExtendedSizePerSegment, TargetSegmentIDMap *idMap,
 		Block_Host_Index** hostid,int fileindex, Oid partition_parent_oid, bool* isLocality);
@@ -678,6 +687,7 @@ static void init_datalocality_context(PlannedStmt *plannedstmt,
 	context->total_metadata_logic_len = 0;
 
     context->metadata_cache_time_us = 0;
+    context->split_assign_time_us = 0;
     context->alloc_resource_time_us = 0;
     context->cal_datalocality_time_us = 0;
 	return;
@@ -970,6 +980,112 @@ get_virtual_segments(QueryResource *resource) {
 	return result;
 }
 
+/*
+ * prefetch_hdfs_data_block_locations: put the block locations of the segment
+ * files of all the required relations into metadata cache before they are
+ * fetched one by one, so the misses are fetched from the namenode in parallel.
+ * The files the split allocation will not fetch, those of hash relations
+ * when the hash distribution is kept, are skipped.
+ */
+static void prefetch_hdfs_data_block_locations(
+		split_to_segment_mapping_context *context) {
+	HdfsFileInfo **file_infos;
+	uint64_t *filesizes;
+	int maxfiles = 64;
+	int nfiles = 0;
+	ListCell *lc;
+
+	if (!metadata_cache_enable || metadata_cache_prefetch_threads <= 0
+			|| debug_fake_datalocality
+			|| (metadata_cache_testfile && metadata_cache_testfile[0])) {
+		return;
+	}
+
+	file_infos = (HdfsFileInfo **) palloc(maxfiles * sizeof(HdfsFileInfo *));
+	filesizes = (uint64_t *) palloc(maxfiles * sizeof(uint64_t));
+
+	foreach(lc, context->srtc_context.range_tables)
+	{
+		Oid rel_oid = lfirst_oid(lc);
+		Relation rel = relation_open(rel_oid, AccessShareLock);
+		AppendOnlyEntry *aoEntry;
+		GpPolicy *targetPolicy;
+		Relation segrel;
+		SegfileCatalogEntry *segfiles;
+		int nsegfiles;
+		int i;
+		bool isAoRows;
+
+		if (!RelationIsAo(rel)) {
+			relation_close(rel, AccessShareLock);
+			continue;
+		}
+
+		isAoRows = RelationIsAoRows(rel);
+		if (!isAoRows
+				&& !list_member_oid(context->srtc_context.parquetscan_range_tables,
+						rel_oid)) {
+			relation_close(rel, AccessShareLock);
+			continue;
+		}
+
+		targetPolicy = GpPolicyFetch(CurrentMemoryContext, rel_oid);
+		if (context->keep_hash && targetPolicy->nattrs > 0) {
+			pfree(targetPolicy);
+			relation_close(rel, AccessShareLock);
+			continue;
+		}
+		pfree(targetPolicy);
+
+		aoEntry = GetAppendOnlyEntry(rel_oid, ActiveSnapshot);
+		segrel = heap_open(aoEntry->segrelid, AccessShareLock);
+		segfiles = GetSegfileCatalogEntries(segrel, isAoRows, ActiveSnapshot,
+				&nsegfiles);
+		for (i = 0; i < nsegfiles; i++) {
+			int segno = segfiles[i].segno;
+			int64 logic_len = segfiles[i].eof;
+
+			if (logic_len == 0) {
+				continue;
+			}
+
+			if (nfiles == maxfiles) {
+				maxfiles *= 2;
+				file_infos = (HdfsFileInfo **) repalloc(file_infos,
+						maxfiles * sizeof(HdfsFileInfo *));
+				filesizes = (uint64_t *) repalloc(filesizes,
+						maxfiles * sizeof(uint64_t));
+			}
+			file_infos[nfiles] = CreateHdfsFileInfo(rel->rd_node, segno);
+			filesizes[nfiles] = logic_len;
+			nfiles++;
+		}
+		pfree(segfiles);
+		heap_close(segrel, AccessShareLock);
+		pfree(aoEntry);
+
+		relation_close(rel, AccessShareLock);
+	}
+
+	if (nfiles > 1) {
+		uint64_t beginTime = gettime_microsec();
+
+		PrefetchHdfsFileBlockLocations(file_infos, filesizes, nfiles);
+
+		if (debug_print_split_alloc_result) {
+			int eclaspeTime = gettime_microsec() - beginTime;
+			elog(LOG, "prefetch blocks of %d files execution time: %d us",
+					nfiles, eclaspeTime);
+		}
+	}
+
+	for (int i = 0; i < nfiles; i++) {
+		DestroyHdfsFileInfo(file_infos[i]);
+	}
+	pfree(file_infos);
+	pfree(filesizes);
+}
+
 /*
  * get_block_locations_and_calculate_table_size: the HDFS block information
  * corresponding to the required relations, and calculate relation size
@@ -1000,6 +1116,8 @@ int64 get_block_locations_and_calculate_table_size(split_to_segment_mapping_cont
     ActiveSnapshot->curcid = GetCurrentCommandId();
   }
 
+  prefetch_hdfs_data_block_locations(context);
+
   List* magmaTableFullNames = NIL;
   List* magmaNonResultRelations = NIL;
 	foreach(lc, context->srtc_context.range_tables)
@@ -1636,9 +1754,9 @@ static void AOGetSegFileDataLocation(Relation relation,
 	int filepath_maxlen;
 
 	Relation pg_aoseg_rel;
-	TupleDesc pg_aoseg_dsc;
-	HeapTuple tuple;
-	SysScanDesc aoscan;
+	SegfileCatalogEntry *segfiles;
+	int nsegfiles;
+	int seg_idx;
 
 	int64 total_size = 0;
 
@@ -1823,20 +1941,16 @@ static void AOGetSegFileDataLocation(Relation relation,
 		}
 	} else {
 		pg_aoseg_rel = heap_open(aoEntry->segrelid, AccessShareLock);
-		pg_aoseg_dsc = RelationGetDescr(pg_aoseg_rel);
-		aoscan = systable_beginscan(pg_aoseg_rel, InvalidOid, FALSE,
-				metadataSnapshot, 0, NULL);
+		segfiles = GetSegfileCatalogEntries(pg_aoseg_rel, true, metadataSnapshot,
+				&nsegfiles);
 
-		while (HeapTupleIsValid(tuple = systable_getnext(aoscan))) {
+		for (seg_idx = 0; seg_idx < nsegfiles; seg_idx++) {
 			BlockLocation *locations = NULL;
 			int block_num = 0;
 			Relation_File *file;
 
-			int segno = DatumGetInt32(
-					fastgetattr(tuple, Anum_pg_aoseg_segno, pg_aoseg_dsc,
-					NULL));
-			int64 logic_len = (int64) DatumGetFloat8(
-					fastgetattr(tuple, Anum_pg_aoseg_eof, pg_aoseg_dsc, NULL));
+			int segno = segfiles[seg_idx].segno;
+			int64 logic_len = segfiles[seg_idx].eof;
 			context->total_metadata_logic_len += logic_len;
 			bool isRelationHash = true;
 			if (targetPolicy->nattrs == 0) {
@@ -1973,7 +2087,7 @@ static void AOGetSegFileDataLocation(Relation relation,
 			}
 		}
 
-		systable_endscan(aoscan);
+		pfree(segfiles);
 		heap_close(pg_aoseg_rel, AccessShareLock);
 	}
 
@@ -2023,7 +2137,10 @@ static void ParquetGetSegFileDataLocation(Relation relation,
 	Relation pg_parquetseg_rel;
 	TupleDesc pg_parquetseg_dsc;
 	HeapTuple tuple;
-	SysScanDesc parquetscan;
+	SysScanDesc parquetscan = NULL;
+	SegfileCatalogEntry *segfiles = NULL;
+	int nsegfiles = 0;
+	int seg_idx = 0;
 
 	basepath = relpath(relation->rd_node);
 	filepath_maxlen = strlen(basepath) + 25;
@@ -2031,10 +2148,15 @@ static void ParquetGetSegFileDataLocation(Relation relation,
 
 	pg_parquetseg_rel = heap_open(segrelid, AccessShareLock);
 	pg_parquetseg_dsc = RelationGetDescr(pg_parquetseg_rel);
-	parquetscan = systable_beginscan(pg_parquetseg_rel, InvalidOid, FALSE,
-			metadataSnapshot, 0, NULL);
+	if (index_scan) {
+		parquetscan = systable_beginscan(pg_parquetseg_rel, InvalidOid, FALSE,
+				metadataSnapshot, 0, NULL);
+	} else {
+		segfiles = GetSegfileCatalogEntries(pg_parquetseg_rel, false,
+				metadataSnapshot, &nsegfiles);
+	}
 
-	while (HeapTupleIsValid(tuple = systable_getnext(parquetscan))) {
+	for (;;) {
 		BlockLocation *locations;
 		int block_num = 0;
 		Relation_File *file;
@@ -2042,6 +2164,7 @@ static void ParquetGetSegFileDataLocation(Relation relation,
 		int64 logic_len = 0;
 		Oid idx_scan_id = InvalidOid;
 		if (index_scan){
+		  if (!HeapTupleIsValid(tuple = systable_getnext(parquetscan))) break;
 		  idx_scan_id = DatumGetObjectId(
 		      fastgetattr(tuple, Anum_pg_orcseg_idx_idxoid, pg_parquetseg_dsc, NULL));
 		 if  (!list_member_oid(idx_scan_ids, idx_scan_id)) continue;
@@ -2050,10 +2173,10 @@ static void ParquetGetSegFileDataLocation(Relation relation,
 		  logic_len = (int64) DatumGetFloat8(
 		      fastgetattr(tuple, Anum_pg_orcseg_idx_eof, pg_parquetseg_dsc, NULL));
 		} else {
-		  segno = DatumGetInt32(
-		      fastgetattr(tuple, Anum_pg_parquetseg_segno, pg_parquetseg_dsc, NULL));
-		  logic_len = (int64) DatumGetFloat8(
-		      fastgetattr(tuple, Anum_pg_parquetseg_eof, pg_parquetseg_dsc, NULL));
+		  if (seg_idx >= nsegfiles) break;
+		  segno = segfiles[seg_idx].segno;
+		  logic_len = segfiles[seg_idx].eof;
+		  seg_idx++;
 		}
 		context->total_metadata_logic_len += logic_len;
 		bool isRelationHash = true;
@@ -2173,7 +2296,11 @@ static void ParquetGetSegFileDataLocation(Relation relation,
 		}
 	}
 
-	systable_endscan(parquetscan);
+	if (index_scan) {
+		systable_endscan(parquetscan);
+	} else {
+		pfree(segfiles);
+	}
 	heap_close(pg_parquetseg_rel, AccessShareLock);
 
 	pfree(segfile_path);
@@ -3083,6 +3210,15 @@ static int select_random_host_algorithm(Relation_Assignment_Context *context,
 		Block_Host_Index **hostID, int fileindex, Oid partition_parent_oid, bool* isLocality) {
 
 	*isLocality = false;
+
+	/* look the partition volumes up once instead of for every candidate vseg */
+	int64 *parentPartitionvolsWithPenalty = NULL;
+	if (partition_parent_oid > 0) {
+		PAIR p = getHASHTABLENode(context->partitionvols_with_penalty_map,
+				TYPCONVERT(void *, partition_parent_oid));
+		parentPartitionvolsWithPenalty = (int64 *) (p->Value);
+	}
+
 	bool isExceedVolume = false;
 	bool isExceedWholeSize =false;
 	bool isExceedPartitionTableSize =false;
@@ -3108,9 +3244,7 @@ static int select_random_host_algorithm(Relation_Assignment_Context *context,
 							> context->avg_size_of_whole_query;
 			int64** partitionvols_with_penalty=NULL;
 			if(partition_parent_oid > 0){
-				PAIR p = getHASHTABLENode(context->partitionvols_with_penalty_map,
-						TYPCONVERT(void *, partition_parent_oid));
-				partitionvols_with_penalty = (int64 **) (&(p->Value));
+				partitionvols_with_penalty = &parentPartitionvolsWithPenalty;
 				isExceedPartitionTableSize = balance_on_partition_table_level && splitsize
 						+ (*partitionvols_with_penalty)[j]
 						> context->avg_size_of_whole_partition_table;
@@ -3162,9 +3296,7 @@ static int select_random_host_algorithm(Relation_Assignment_Context *context,
 						> context->avg_size_of_whole_query;
 		int64** partitionvols_with_penalty=NULL;
 		if(partition_parent_oid > 0){
-			PAIR p = getHASHTABLENode(context->partitionvols_with_penalty_map,
-					TYPCONVERT(void *, partition_parent_oid));
-			partitionvols_with_penalty = (int64 **) (&(p->Value));
+			partitionvols_with_penalty = &parentPartitionvolsWithPenalty;
 			isExceedPartitionTableSize = balance_on_partition_table_level &&
 					splitsize + (*partitionvols_with_penalty)[j]
 					> context->avg_size_of_whole_partition_table;
@@ -3206,9 +3338,7 @@ static int select_random_host_algorithm(Relation_Assignment_Context *context,
 					continue;
 				}
 				if (partition_parent_oid > 0) {
-					PAIR p = getHASHTABLENode(context->partitionvols_with_penalty_map,
-							TYPCONVERT(void *, partition_parent_oid));
-					int64** partitionvols_with_penalty = (int64 **) (&(p->Value));
+					int64** partitionvols_with_penalty = &parentPartitionvolsWithPenalty;
 					if (balance_on_partition_table_level
 							&& splitsize + (*partitionvols_with_penalty)[j]
 									> context->avg_size_of_whole_partition_table
@@ -3239,9 +3369,7 @@ static int select_random_host_algorithm(Relation_Assignment_Context *context,
 				continue;
 			}
 			if (partition_parent_oid > 0) {
-				PAIR p = getHASHTABLENode(context->partitionvols_with_penalty_map,
-						TYPCONVERT(void *, partition_parent_oid));
-				int64** partitionvols_with_penalty = (int64 **) (&(p->Value));
+				int64** partitionvols_with_penalty = &parentPartitionvolsWithPenalty;
 				if (balance_on_partition_table_level
 						&& net_disk_ratio * splitsize + (*partitionvols_with_penalty)[j]
 								> context->avg_size_of_whole_partition_table
@@ -4729,8 +4857,12 @@ static void allocate_random_relation(Relation_Data* rel_data,
 	/*find the insert node for each block*/
 	uint64_t before_run_find_insert_host = gettime_microsec();
 	int *hostOccurTimes = (int *) palloc(sizeof(int) * context->dds_context.size);
+	int maxSplitNum = 0;
 	for (int fi = 0; fi < fileCount; fi++) {
 		Relation_File *rel_file = file_vector[fi];
+		if (rel_file->split_num > maxSplitNum) {
+			maxSplitNum = rel_file->split_num;
+		}
 		/*for hash file whose bucket number doesn't equal to segment number*/
 		if (rel_file->hostIDs == NULL) {
 			rel_file->splits[0].host = 0;
@@ -4777,6 +4909,11 @@ static void allocate_random_relation(Relation_Data* rel_data,
 		elog(LOG, "find insert host time: %d us. \n", run_find_insert_host);
 	}
 
+	/* splitSizeSum[i] is the size of the splits before split i of the file,
+	 * so the size of a sequence of continue blocks is found in constant time.
+	 */
+	int64 *splitSizeSum = (int64 *) palloc(sizeof(int64) * (maxSplitNum + 1));
+
 	/*three stage allocation algorithm*/
 	for (int fi = 0; fi < fileCount; fi++) {
 		Relation_File *rel_file = file_vector[fi];
@@ -4795,16 +4932,17 @@ static void allocate_random_relation(Relation_Data* rel_data,
 		for (i = 0; i < assignment_context->virtual_segment_num; i++) {
 			isBlockContinue[i] = 0;
 		}
+		splitSizeSum[0] = 0;
+		for (i = 0; i < rel_file->split_num; i++) {
+			splitSizeSum[i + 1] = splitSizeSum[i] + rel_file->splits[i].length;
+		}
 		/* we assign split(block) to host base on continuity
 		 * the length of continue blocks of local host determines
 		 * the final assignment (we prefer longer one).
 		 */
 		for (i = 0; i < rel_file->split_num; i++) {
 			int64 split_size = rel_file->splits[i].length;
-			int64 currentSequenceSize = 0;
-			for (int r = beginIndex; r <= i; r++) {
-				currentSequenceSize += rel_file->splits[r].length;
-			}
+			int64 currentSequenceSize = splitSizeSum[i + 1] - splitSizeSum[beginIndex];
 			/* first block in one file doesn't need to consider continuity,
 			 * but the following blocks must consider it.
 			 */
@@ -5005,6 +5143,8 @@ static void allocate_random_relation(Relation_Data* rel_data,
 		assignment_context->total_split_num += rel_file->split_num;
 	}
 
+	pfree(splitSizeSum);
+
 	uint64_t after_continue_block = gettime_microsec();
 	int time_of_continue = after_continue_block - after_change_order;
 	if ( debug_fake_datalocality ){
@@ -5012,6 +5152,12 @@ static void allocate_random_relation(Relation_Data* rel_data,
 		fprintf(fp, "The size of nonContinueLocalQueue is : %d .\n", list_length(nonContinueLocalQueue));
 	}
 
+	/* the vsegs holding splits of the file being processed in the queues */
+	int *vsegMarks = (int *) palloc0(
+			sizeof(int) * assignment_context->virtual_segment_num);
+	int markedFile = -1;
+	int markGeneration = 0;
+
 	/*process non cotinue local queue*/
 	ListCell *file_split;
 	foreach(file_split, nonContinueLocalQueue)
@@ -5047,12 +5193,10 @@ static void allocate_random_relation(Relation_Data* rel_data,
 			if (debug_print_split_alloc_result) {
 				elog(LOG, "local1 split %d offset "INT64_FORMAT"of file %d is assigned to host %d",onesplit->splitIndex,cur_file->splits[onesplit->splitIndex].offset ,cur_file->segno,assignedVSeg);
 			}
-			bool isSplitOfFileExistInVseg = false;
-			for (int splitindex = 0; splitindex < cur_file->split_num; splitindex++) {
-				if (assignedVSeg == cur_file->splits[splitindex].host) {
-					isSplitOfFileExistInVseg = true;
-				}
-			}
+			bool isSplitOfFileExistInVseg = mark_split_of_file_in_vseg(file_vector,
+					onesplit->fileIndex, assignedVSeg,
+					assignment_context->virtual_segment_num, vsegMarks, &markedFile,
+					&markGeneration);
 			if(!isSplitOfFileExistInVseg){
 				assignment_context->continue_split_num[assignedVSeg]++;
 			}
@@ -5116,6 +5260,8 @@ static void allocate_random_relation(Relation_Data* rel_data,
 						onesplit->splitIndex, 0, file_vector, fileCount,
 						maxExtendedSizePerSegment, idMap, assignment_context);
 				if(remedyVseg != -1){
+					/* the remedy moved a split, the marked vsegs may be stale */
+					markedFile = -1;
 					assignedVSeg = remedyVseg;
 					log_context->localDataSizePerRelation += cur_split_size;
 					network_split_size = cur_split_size;
@@ -5153,12 +5299,10 @@ static void allocate_random_relation(Relation_Data* rel_data,
 			}
 		}
 
-		bool isSplitOfFileExistInVseg = false;
-		for (int splitindex = 0; splitindex < cur_file->split_num; splitindex++) {
-			if (assignedVSeg == cur_file->splits[splitindex].host) {
-				isSplitOfFileExistInVseg = true;
-			}
-		}
+		bool isSplitOfFileExistInVseg = mark_split_of_file_in_vseg(file_vector,
+				onesplit->fileIndex, assignedVSeg,
+				assignment_context->virtual_segment_num, vsegMarks, &markedFile,
+				&markGeneration);
 		if (!isSplitOfFileExistInVseg) {
 			assignment_context->continue_split_num[assignedVSeg]++;
 		}
@@ -5227,6 +5371,38 @@ static void allocate_random_relation(Relation_Data* rel_data,
 		pfree(file_vector);
 	}
 	pfree(isBlockContinue);
+	pfree(vsegMarks);
+}
+
+/*
+ * mark_split_of_file_in_vseg: return whether a split of the file is already
+ * assigned to vseg, and mark vseg as holding a split of the file.
+ *
+ * The vsegs of the splits of a file are collected once, when the queues move
+ * to the file, instead of scanning all its splits for every split assigned.
+ * Reset *markedFile to -1 when splits are moved behind its back.
+ */
+static bool mark_split_of_file_in_vseg(Relation_File** file_vector,
+		int fileIndex, int vseg, int vsegNum, int *vsegMarks, int *markedFile,
+		int *markGeneration) {
+	bool isMarked;
+
+	if (*markedFile != fileIndex) {
+		Relation_File *file = file_vector[fileIndex];
+
+		(*markGeneration)++;
+		for (int i = 0; i < file->split_num; i++) {
+			int host = file->splits[i].host;
+			if (host >= 0 && host < vsegNum) {
+				vsegMarks[host] = *markGeneration;
+			}
+		}
+		*markedFile = fileIndex;
+	}
+
+	isMarked = vsegMarks[vseg] == *markGeneration;
+	vsegMarks[vseg] = *markGeneration;
+	return isMarked;
 }
 
 /*
@@ -5997,7 +6173,7 @@ run_allocation_algorithm(SplitAllocResult *result, List *virtual_segments, Query
 			allocate_random_relation(rel_data, &log_context,&idMap, &assignment_context, context);
 		}
 		uint64_t after_run_allocate_hash_or_random = gettime_microsec();
-		allocate_hash_or_random_time = after_run_allocate_hash_or_random - before_run_allocate_hash_or_random;
+		allocate_hash_or_random_time += after_run_allocate_hash_or_random - before_run_allocate_hash_or_random;
 
 		caculate_per_relation_data_locality_result(rel_data, &log_context,&assignment_context);
 	}
@@ -6066,14 +6242,16 @@ run_allocation_algorithm(SplitAllocResult *result, List *virtual_segments, Query
 	int dl_overall_time = run_datalocality - before_run_allocation;
 
     context->cal_datalocality_time_us = dl_overall_time;
+    context->split_assign_time_us = allocate_hash_or_random_time;
 
 	if(debug_datalocality_time){
 		elog(LOG, "datalocality overall execution time: %d us. \n", dl_overall_time);
 	}
 
     result->datalocalityTime = (double)(context->metadata_cache_time_us + context->alloc_resource_time_us + context->cal_datalocality_time_us)/ 1000;
-    appendStringInfo(result->datalocalityInfo, "DFS metadatacache: %.3f ms; resource allocation: %.3f ms; datalocality calculation: %.3f ms.",
-            (double)context->metadata_cache_time_us/1000, (double)context->alloc_resource_time_us/1000, (double)context->cal_datalocality_time_us/1000);
+    appendStringInfo(result->datalocalityInfo, "DFS metadatacache: %.3f ms; resource allocation: %.3f ms; datalocality calculation: %.3f ms (split assignment: %.3f ms).",
+            (double)context->metadata_cache_time_us/1000, (double)context->alloc_resource_time_us/1000, (double)context->cal_datalocality_time_us/1000,
+            (double)context->split_assign_time_us/1000);
 
 	return alloc_result;
 }
@@ -6307,7 +6485,7 @@ calculate_planner_segment_num(PlannedStmt *plannedstmt, Query *query,
 				context.host_context.hostnameVolInfos = NULL;
 			}
 
-			/* determine the random table segment number by the following 4 steps*/
+			/* determine the random table segment number by the following 5 steps*/
 			/* Step1 we expect one split(block) processed by one virtual segment*/
 			context.randomSegNum = context.total_split_count;
 			/* Step2 combine segment when splits are with small size*/
@@ -6325,7 +6503,26 @@ calculate_planner_segment_num(PlannedStmt *plannedstmt, Query *query,
 			if (context.randomSegNum < expected_segment_num_with_max_filecount) {
 				context.randomSegNum = expected_segment_num_with_max_filecount;
 			}
-			/* Step4 we at least use one segment*/
+			/*
+			 * Step4 size the random segment number by the work of the plan
+			 * rather than by the data it scans: the plan was costed for
+			 * planner_segment_count() segments, we want one virtual segment
+			 * per started cost_per_virtual_segment of its total cost.
+			 */
+			if (cost_per_virtual_segment > 0) {
+				double total_cost = plannedstmt->planTree->total_cost * planner_segment_count();
+				double expected_segment_num_with_cost = total_cost / cost_per_virtual_segment + 1;
+				int max_segment_num = GetQueryVsegNum();
+
+				context.randomSegNum =
+						expected_segment_num_with_cost > max_segment_num ?
+						max_segment_num : (int) expected_segment_num_with_cost;
+				if (debug_datalocality_time) {
+					elog(LOG, "plan cost %.2f for %d segments, expect %d virtual segments",
+							plannedstmt->planTree->total_cost, planner_segment_count(), context.randomSegNum);
+				}
+			}
+			/* Step5 we at least use one segment*/
 			if (context.randomSegNum < context.minimum_segment_num) {
 				context.randomSegNum = context.minimum_segment_num;
 			}
@@ -65,6 +65,7 @@ typedef struct CdbExplain_StatInst
     double      execmemused;    /* executor memory used (bytes) */
     double      workmemused;    /* work_mem actually used (bytes) */
     double      workmemwanted;  /* work_mem to avoid workfile i/o (bytes) */
+    double      workfilespilled;    /* bytes written to workfiles */
 	bool        workfileReused; /* workfile reused in this node */
 	bool        workfileCreated;/* workfile created in this node */
 	instr_time	firststart;		/* Start time of first iteration of node */
@@ -81,6 +82,10 @@ typedef struct CdbExplain_SliceWorker
     double      peakmemused;    /* bytes alloc in per-query mem context tree */
     double		vmem_reserved;	/* vmem reserved by a QE */
     double		memory_accounting_global_peak;	/* peak memory observed during memory accounting */
+    double		hdfs_io_time;	/* msecs blocked on HDFS reads and writes */
+    double		local_io_time;	/* msecs blocked on local file reads and writes */
+    double		interconnect_time;	/* msecs waited for interconnect data */
+    double		lock_time;		/* msecs waited for locks */
 } CdbExplain_SliceWorker;
 
 
@@ -131,6 +136,7 @@ typedef struct CdbExplain_NodeSummary
     CdbExplain_Agg  execmemused;
     CdbExplain_Agg  workmemused;
     CdbExplain_Agg  workmemwanted;
+    CdbExplain_Agg  workfilespilled;
 	CdbExplain_Agg  totalWorkfileReused;
 	CdbExplain_Agg  totalWorkfileCreated;
     CdbExplain_Agg  peakMemBalance;
@@ -164,6 +170,11 @@ typedef struct CdbExplain_SliceSummary
 
     CdbExplain_Agg	memory_accounting_global_peak; /* Peak memory accounting balance by QEs */
 
+    CdbExplain_Agg	hdfs_io_time;	/* Time QEs were blocked, see WaitUsage */
+    CdbExplain_Agg	local_io_time;
+    CdbExplain_Agg	interconnect_time;
+    CdbExplain_Agg	lock_time;
+
     /* Rollup of per-node stats over all of the slice's workers and nodes */
     double          workmemused_max;
     double          workmemwanted_max;
@@ -417,6 +428,7 @@ static void convert_Instrumentation_CdbExplain_StatInst(
   si->execmemused = instr->execmemused;
   si->workmemused = instr->workmemused;
   si->workmemwanted = instr->workmemwanted;
+  si->workfilespilled = instr->workfilespilled;
   si->workfileReused = instr->workfileReused;
   si->workfileCreated = instr->workfileCreated;
   si->peakMemBalance = 0;
@@ -901,6 +913,11 @@ cdbexplain_collectSliceStats(PlanState                 *planstate,
 
     out_worker->memory_accounting_global_peak = (double) MemoryAccountingPeakBalance;
 
+    out_worker->hdfs_io_time = (double) pgWaitUsage.hdfs_io_time / 1000.0;
+    out_worker->local_io_time = (double) pgWaitUsage.local_io_time / 1000.0;
+    out_worker->interconnect_time = (double) pgWaitUsage.interconnect_time / 1000.0;
+    out_worker->lock_time = (double) pgWaitUsage.lock_time / 1000.0;
+
 }                               /* cdbexplain_collectSliceStats */
 
 
@@ -984,6 +1001,10 @@ cdbexplain_depositSliceStats(CdbExplain_StatHdr        *hdr,
     cdbexplain_agg_upd(&ss->peakmemused, hdr->worker.peakmemused, hdr->segindex, hdr->hostname);
     cdbexplain_agg_upd(&ss->vmem_reserved, hdr->worker.vmem_reserved, hdr->segindex, hdr->hostname);
     cdbexplain_agg_upd(&ss->memory_accounting_global_peak, hdr->worker.memory_accounting_global_peak, hdr->segindex, hdr->hostname);
+    cdbexplain_agg_upd(&ss->hdfs_io_time, hdr->worker.hdfs_io_time, hdr->segindex, hdr->hostname);
+    cdbexplain_agg_upd(&ss->local_io_time, hdr->worker.local_io_time, hdr->segindex, hdr->hostname);
+    cdbexplain_agg_upd(&ss->interconnect_time, hdr->worker.interconnect_time, hdr->segindex, hdr->hostname);
+    cdbexplain_agg_upd(&ss->lock_time, hdr->worker.lock_time, hdr->segindex, hdr->hostname);
 
     /* Rollup of per-node stats over all nodes of the slice into SliceSummary */
     ss->workmemused_max = recvstatctx->workmemused_max;
@@ -1048,6 +1069,7 @@ cdbexplain_collectStatsFromNode(PlanState *planstate, CdbExplain_SendStatCtx *ct
     si->execmemused     = instr->execmemused;
     si->workmemused     = instr->workmemused;
     si->workmemwanted   = instr->workmemwanted;
+    si->workfilespilled = instr->workfilespilled;
     si->workfileReused   = instr->workfileReused;
     si->workfileCreated  = instr->workfileCreated;
 	si->peakMemBalance	 = MemoryAccounting_GetPeak(planstate->plan->memoryAccount);
@@ -1189,6 +1211,7 @@ cdbexplain_depositStatsToNode(PlanState *planstate, CdbExplain_RecvStatCtx *ctx)
     CdbExplain_DepStatAcc       execmemused;
     CdbExplain_DepStatAcc       workmemused;
     CdbExplain_DepStatAcc       workmemwanted;
+    CdbExplain_DepStatAcc       workfilespilled;
     CdbExplain_DepStatAcc       totalWorkfileReused;
     CdbExplain_DepStatAcc       totalWorkfileCreated;
     CdbExplain_DepStatAcc       peakmemused;
@@ -1226,6 +1249,7 @@ cdbexplain_depositStatsToNode(PlanState *planstate, CdbExplain_RecvStatCtx *ctx)
     cdbexplain_depStatAcc_init0(&execmemused);
     cdbexplain_depStatAcc_init0(&workmemused);
     cdbexplain_depStatAcc_init0(&workmemwanted);
+    cdbexplain_depStatAcc_init0(&workfilespilled);
 	cdbexplain_depStatAcc_init0(&totalWorkfileReused);
 	cdbexplain_depStatAcc_init0(&totalWorkfileCreated);
     cdbexplain_depStatAcc_init0(&peakMemBalance);
@@ -1308,6 +1332,7 @@ cdbexplain_depositStatsToNode(PlanState *planstate, CdbExplain_RecvStatCtx *ctx)
         cdbexplain_depStatAcc_upd(&execmemused, rsi->execmemused, rsh, rsi, nsi);
         cdbexplain_depStatAcc_upd(&workmemused, rsi->workmemused, rsh, rsi, nsi);
         cdbexplain_depStatAcc_upd(&workmemwanted, rsi->workmemwanted, rsh, rsi, nsi);
+        cdbexplain_depStatAcc_upd(&workfilespilled, rsi->workfilespilled, rsh, rsi, nsi);
         cdbexplain_depStatAcc_upd(&totalWorkfileReused, (rsi->workfileReused ? 1 : 0), rsh, rsi, nsi);
         cdbexplain_depStatAcc_upd(&totalWorkfileCreated, (rsi->workfileCreated ? 1 : 0), rsh, rsi, nsi);
         cdbexplain_depStatAcc_upd(&peakMemBalance, rsi->peakMemBalance, rsh, rsi, nsi);
@@ -1345,6 +1370,7 @@ cdbexplain_depositStatsToNode(PlanState *planstate, CdbExplain_RecvStatCtx *ctx)
     ns->execmemused = execmemused.agg;
     ns->workmemused = workmemused.agg;
     ns->workmemwanted = workmemwanted.agg;
+    ns->workfilespilled = workfilespilled.agg;
     ns->totalWorkfileReused = totalWorkfileReused.agg;
     ns->totalWorkfileCreated = totalWorkfileCreated.agg;
     ns->peakMemBalance = peakMemBalance.agg;
@@ -1375,6 +1401,7 @@ cdbexplain_depositStatsToNode(PlanState *planstate, CdbExplain_RecvStatCtx *ctx)
       instr->execmemused      = ntuples.nsimax->execmemused;
       instr->workmemused      = ntuples.nsimax->workmemused;
       instr->workmemwanted    = ntuples.nsimax->workmemwanted;
+      instr->workfilespilled  = ntuples.nsimax->workfilespilled;
       instr->workfileReused   = ntuples.nsimax->workfileReused;
       instr->workfileCreated  = ntuples.nsimax->workfileCreated;
       instr->firststart       = ntuples.nsimax->firststart;
@@ -1659,6 +1686,32 @@ cdbexplain_formatSegNoParenthesis(char *outbuf, int bufsize, int segindex, int n
     }
 }                               /* cdbexplain_formatSeg */
 
+/*
+ * cdbexplain_formatWaitTime
+ *    Append the milliseconds the workers of a slice were blocked on one kind
+ *    of wait to the slice statistics line, if they were at all.
+ */
+static void
+cdbexplain_formatWaitTime(StringInfo str, const char *label, CdbExplain_Agg *agg)
+{
+    char        segbuf[MAX_TMP_BUF_SIZE];
+
+    if (agg->vcnt == 0)
+        return;
+
+    if (agg->vcnt == 1)
+    {
+        cdbexplain_formatSeg(segbuf, sizeof(segbuf), agg->imax, 999, agg->hostnamemax);
+        appendStringInfo(str, "  %s: %.3f ms%s.", label, agg->vmax, segbuf);
+    }
+    else
+    {
+        cdbexplain_formatSeg(segbuf, sizeof(segbuf), agg->imax, agg->vcnt, agg->hostnamemax);
+        appendStringInfo(str, "  %s: %.3f ms avg x %d workers, %.3f ms max%s.",
+                         label, cdbexplain_agg_avg(agg), agg->vcnt, agg->vmax, segbuf);
+    }
+}                               /* cdbexplain_formatWaitTime */
+
 
 /*
  * cdbexplain_showExecStatsBegin
@@ -1982,6 +2035,33 @@ cdbexplain_showExecStats(struct PlanState              *planstate,
 		}
     }
 
+    /*
+     * How much did the workers write to workfiles?
+     */
+    if (ns->workfilespilled.vcnt > 0)
+    {
+        appendStringInfoFill(str, 2*indent, ' ');
+        cdbexplain_formatMemory(maxbuf, sizeof(maxbuf), ns->workfilespilled.vmax);
+        if (ns->ninst == 1)
+        {
+            appendStringInfo(str,
+                "Workfile spilled: %s.\n",
+                maxbuf);
+        }
+        else
+        {
+            cdbexplain_formatMemory(avgbuf, sizeof(avgbuf), cdbexplain_agg_avg(&ns->workfilespilled));
+            cdbexplain_formatSeg(segbuf, sizeof(segbuf), ns->workfilespilled.imax, ns->ninst,ns->ntuples.hostnamemax);
+            appendStringInfo(str,
+                             "Workfile spilled: %s avg, %s max%s"
+                             " by %d workers.\n",
+                             avgbuf,
+                             maxbuf,
+                             segbuf,
+                             ns->workfilespilled.vcnt);
+        }
+    }
+
     /*
      * What value of work_mem would suffice to eliminate workfile I/O?
      */
@@ -2401,6 +2481,12 @@ cdbexplain_showExecStatsEnd(struct PlannedStmt *stmt,
             appendStringInfoChar(str, '.');
        }
 
+       /* Time blocked on I/O, the interconnect and locks */
+       cdbexplain_formatWaitTime(str, "HDFS I/O", &ss->hdfs_io_time);
+       cdbexplain_formatWaitTime(str, "Local file I/O", &ss->local_io_time);
+       cdbexplain_formatWaitTime(str, "Interconnect wait", &ss->interconnect_time);
+       cdbexplain_formatWaitTime(str, "Lock wait", &ss->lock_time);
+
        appendStringInfoChar(str, '\n');
     }
     
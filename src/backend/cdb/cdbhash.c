@@ -27,6 +27,9 @@
 #include "postgres.h"
 
 #include <ctype.h>
+#ifdef HAVE__GET_CPUID
+#include <cpuid.h>
+#endif
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <assert.h>
@@ -669,6 +672,296 @@ cdbhashnokey(CdbHash *h)
 	h->rrindex++; /* increment for next time around */
 }
 
+/*================================================================
+ *
+ * BATCHED HASH API FUNCTIONS
+ *
+ *================================================================
+ */
+
+/*
+ * The batched functions hash one key column of many rows in one call.
+ * hashes[i] carries the running hash of row i across the key columns, as
+ * h->hash does for cdbhashinit()/cdbhash(), and ends up bit for bit equal
+ * to what the row at a time functions compute for that row, so existing
+ * distributions stay valid.
+ *
+ * For the fixed width types that hashDatum() casts to an integer, the
+ * kernels below run FNV-1 over the bytes of that integer directly, without
+ * a buffer, a type switch or a function call per row, and with no
+ * dependency between rows, which lets the compiler vectorize the loops.
+ * All other types go through hashDatum() one row at a time.
+ */
+
+/* The k-th octet in memory of an integer that is width octets wide */
+#ifdef WORDS_BIGENDIAN
+#define FNV_OCTET(v, k, width)	((uint32) ((v) >> (8 * ((width) - 1 - (k)))) & 0xFF)
+#else
+#define FNV_OCTET(v, k, width)	((uint32) ((v) >> (8 * (k))) & 0xFF)
+#endif
+
+/* one step of fnv1_32_buf(); the multiply is the same as its shifts */
+#define FNV1_32_STEP(hval, octet)	(((hval) * FNV_32_PRIME) ^ (octet))
+
+static inline uint32
+fnv1_32_int8(uint32 hval, uint64 v)
+{
+	int			k;
+
+	for (k = 0; k < 8; k++)
+		hval = FNV1_32_STEP(hval, FNV_OCTET(v, k, 8));
+	return hval;
+}
+
+static inline uint32
+fnv1_32_int4(uint32 hval, uint32 v)
+{
+	int			k;
+
+	for (k = 0; k < 4; k++)
+		hval = FNV1_32_STEP(hval, FNV_OCTET(v, k, 4));
+	return hval;
+}
+
+static inline uint32
+fnv1_32_int1(uint32 hval, uint32 v)
+{
+	return FNV1_32_STEP(hval, v & 0xFF);
+}
+
+/*
+ * Hash rows i to nrows - 1 with the kernel, and pick the hash of a NULL for
+ * the null rows afterwards rather than branching on them.
+ */
+#define FNV1_32_BATCH(kernel, getval) \
+	do { \
+		if (isnull == NULL) \
+		{ \
+			for (; i < nrows; i++) \
+				hashes[i] = kernel(hashes[i], getval(values[i])); \
+		} \
+		else \
+		{ \
+			for (; i < nrows; i++) \
+			{ \
+				uint32	hv = kernel(hashes[i], getval(values[i])); \
+				uint32	hn = fnv1_32_int4(hashes[i], NULL_VAL); \
+				hashes[i] = isnull[i] ? hn : hv; \
+			} \
+		} \
+	} while (0)
+
+/* the integer hashDatum() hashes for each type, see there */
+#define BATCH_INT2(d)		((uint64) (int64) DatumGetInt16(d))
+#define BATCH_INT4(d)		((uint64) (int64) DatumGetInt32(d))
+#define BATCH_INT8(d)		((uint64) DatumGetInt64(d))
+#define BATCH_OID(d)		((uint64) DatumGetUInt32(d))
+#define BATCH_DATE(d)		((uint32) DatumGetDateADT(d))
+#define BATCH_BOOL(d)		((uint32) DatumGetBool(d))
+#define BATCH_CHAR(d)		((uint32) (unsigned char) DatumGetChar(d))
+
+/*
+ * The kernel that hashes a type the way hashDatum() does, or
+ * CDBHASH_KERNEL_NONE if there is none.
+ */
+static CdbHashBatchKernel
+cdbhash_batch_kernel(Oid typid)
+{
+	switch (typid)
+	{
+		case INT2OID:
+			return CDBHASH_KERNEL_INT2;
+
+		case INT4OID:
+			return CDBHASH_KERNEL_INT4;
+
+		case INT8OID:
+#ifdef HAVE_INT64_TIMESTAMP
+		case TIMESTAMPOID:
+		case TIMESTAMPTZOID:
+		case TIMEOID:
+#endif
+			return CDBHASH_KERNEL_INT8;
+
+		case OIDOID:
+		case REGPROCOID:
+		case REGPROCEDUREOID:
+		case REGOPEROID:
+		case REGOPERATOROID:
+		case REGCLASSOID:
+		case REGTYPEOID:
+			return CDBHASH_KERNEL_OID;
+
+		case DATEOID:
+			return CDBHASH_KERNEL_DATE;
+
+		case BOOLOID:
+			return CDBHASH_KERNEL_BOOL;
+
+		case CHAROID:
+			return CDBHASH_KERNEL_CHAR;
+
+		default:
+			return CDBHASH_KERNEL_NONE;
+	}
+}
+
+#if defined(__x86_64__) && defined(HAVE__GET_CPUID)
+
+static bool
+cdbhashAVX2Available(void)
+{
+	static int	available = -1;
+	unsigned int exx[4] = {0, 0, 0, 0};
+	unsigned int xcr0_lo;
+	unsigned int xcr0_hi;
+
+	if (available >= 0)
+		return available;
+
+	available = 0;
+
+	__get_cpuid(1, &exx[0], &exx[1], &exx[2], &exx[3]);
+	if ((exx[2] & (1 << 27)) == 0)		/* OSXSAVE */
+		return false;
+
+	/* the OS must save the ymm registers on context switch */
+	__asm__ __volatile__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+	if ((xcr0_lo & 0x6) != 0x6)
+		return false;
+
+	if (__get_cpuid_max(0, NULL) < 7)
+		return false;
+	__cpuid_count(7, 0, exx[0], exx[1], exx[2], exx[3]);
+
+	available = (exx[1] & (1 << 5)) != 0;	/* AVX2 */
+	return available;
+}
+
+#endif
+
+typedef struct BatchHashRow
+{
+	CdbHash    *h;
+	uint32	   *hash;
+} BatchHashRow;
+
+/**
+ * Implements datumHashFunction for the rows hashed by hashDatum()
+ */
+static void
+addToBatchHash(void *clientData, void *buf, size_t len)
+{
+	BatchHashRow *row = (BatchHashRow *) clientData;
+
+	*row->hash = (row->h->hashfn) (buf, len, *row->hash);
+}
+
+/*
+ * Initialize the hashes of nrows rows for hashing their values.
+ */
+void
+cdbhashinit_batch(CdbHash *h, uint32 *hashes, int nrows)
+{
+	int			i;
+
+	for (i = 0; i < nrows; i++)
+		hashes[i] = FNV1_32_INIT;
+}
+
+/*
+ * Add a column of nrows values to the hashes of their rows.  isnull may be
+ * NULL if no value is null.  As for cdbhash(), typid must be the base type
+ * of a domain and ANYARRAYOID for an array.
+ */
+void
+cdbhash_batch(CdbHash *h, uint32 *hashes, int nrows,
+			  const Datum *values, const bool *isnull, Oid typid)
+{
+	CdbHashBatchKernel kernel = CDBHASH_KERNEL_NONE;
+	BatchHashRow row;
+	int			i = 0;
+
+	if (h->hashalg == HASH_FNV_1)
+		kernel = cdbhash_batch_kernel(typid);
+
+#if defined(__x86_64__) && defined(HAVE__GET_CPUID)
+	/* the AVX2 kernel hashes whole groups of rows, the rest is done below */
+	if (kernel != CDBHASH_KERNEL_NONE && kernel <= CDBHASH_AVX2_MAX_KERNEL &&
+		cdbhashAVX2Available())
+		i = cdbhash_batch_avx2(hashes, nrows, values, isnull, kernel);
+#endif
+
+	switch (kernel)
+	{
+		case CDBHASH_KERNEL_INT2:
+			FNV1_32_BATCH(fnv1_32_int8, BATCH_INT2);
+			break;
+
+		case CDBHASH_KERNEL_INT4:
+			FNV1_32_BATCH(fnv1_32_int8, BATCH_INT4);
+			break;
+
+		case CDBHASH_KERNEL_INT8:
+			FNV1_32_BATCH(fnv1_32_int8, BATCH_INT8);
+			break;
+
+		case CDBHASH_KERNEL_OID:
+			FNV1_32_BATCH(fnv1_32_int8, BATCH_OID);
+			break;
+
+		case CDBHASH_KERNEL_DATE:
+			FNV1_32_BATCH(fnv1_32_int4, BATCH_DATE);
+			break;
+
+		case CDBHASH_KERNEL_BOOL:
+			FNV1_32_BATCH(fnv1_32_int1, BATCH_BOOL);
+			break;
+
+		case CDBHASH_KERNEL_CHAR:
+			FNV1_32_BATCH(fnv1_32_int1, BATCH_CHAR);
+			break;
+
+		case CDBHASH_KERNEL_NONE:
+			row.h = h;
+			for (; i < nrows; i++)
+			{
+				row.hash = &hashes[i];
+				if (isnull != NULL && isnull[i])
+					hashNullDatum(addToBatchHash, &row);
+				else
+					hashDatum(values[i], typid, addToBatchHash, &row);
+			}
+			break;
+	}
+}
+
+/*
+ * Hash nrows rows of a relation with an empty policy, as nrows calls of
+ * cdbhashnokey() would.
+ */
+void
+cdbhashnokey_batch(CdbHash *h, uint32 *hashes, int nrows)
+{
+	int			i;
+
+	if (h->hashalg == HASH_FNV_1)
+	{
+		for (i = 0; i < nrows; i++)
+			hashes[i] = fnv1_32_int4(hashes[i], h->rrindex + (uint32) i);
+		h->rrindex += nrows;
+	}
+	else
+	{
+		for (i = 0; i < nrows; i++)
+		{
+			h->hash = hashes[i];
+			cdbhashnokey(h);
+			hashes[i] = h->hash;
+		}
+	}
+}
+
 int32 jumpConsistentHash(uint64 key, int32 num_buckets) {
   int64 b = -1, j = 0;
   while (j < num_buckets) {
@@ -767,6 +1060,46 @@ unsigned int magichashreduce(CdbHash *h, int *map, int nmap)
   return map[result];
 }
 
+/*
+ * Reduce the hashes of nrows rows to segment numbers.
+ */
+void
+cdbhashreduce_batch(CdbHash *h, const uint32 *hashes, int nrows,
+					unsigned int *segs)
+{
+	uint32		numsegs = (uint32) h->numsegs;
+	int			i;
+
+	assert(h->reducealg == REDUCE_BITMASK || h->reducealg == REDUCE_LAZYMOD);
+
+	if (h->reducealg == REDUCE_BITMASK)
+	{
+		for (i = 0; i < nrows; i++)
+			segs[i] = FASTMOD(hashes[i], numsegs);
+	}
+	else
+	{
+		for (i = 0; i < nrows; i++)
+			segs[i] = hashes[i] % numsegs;
+	}
+}
+
+/*
+ * Reduce the hashes of nrows rows to segment numbers through the map, as
+ * magichashreduce() does.  The jump hash map is looked up once per batch.
+ */
+void
+magichashreduce_batch(CdbHash *h, const uint32 *hashes, int nrows,
+					  int *map, int nmap, unsigned int *segs)
+{
+	int		   *jumpHashMap = get_jump_hash_map(nmap);
+	int			i;
+
+	Assert(jumpHashMap);
+	for (i = 0; i < nrows; i++)
+		segs[i] = map[jumpHashMap[hashes[i] % JUMP_HASH_MAP_LENGTH]];
+}
+
 
 bool
 typeIsArrayType(Oid typeoid)
@@ -0,0 +1,124 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * cdbhash_avx2.c
+ *		AVX2 kernel of cdbhash_batch(), the FNV-1 hashes of 8 rows per
+ *		iteration.
+ *
+ * Each 64-bit value is split into its low and high 32 bits, which are
+ * octets 0-3 and 4-7 of the buffer fnv1_32_buf() hashes on x86_64.  This
+ * file must be compiled with -mavx2, and is only called when the cpu
+ * supports it.  The rows after the last whole group are left to the
+ * caller.
+ */
+
+#include "postgres.h"
+#include "cdb/cdbhash.h"
+
+#if defined(__x86_64__)
+
+#include <immintrin.h>
+
+#define LANES 8
+
+/* must match cdbhash.c */
+#define FNV_32_PRIME ((uint32)0x01000193)
+#define NULL_VAL ((uint32)0XF0F0F0F1)
+
+/* hash the 4 octets of each lane of v, lowest first */
+static inline __m256i
+fnv1_32_octets4(__m256i hval, __m256i v)
+{
+	const __m256i prime = _mm256_set1_epi32((int) FNV_32_PRIME);
+	const __m256i octet = _mm256_set1_epi32(0xFF);
+	int			k;
+
+	for (k = 0; k < 4; k++)
+	{
+		hval = _mm256_mullo_epi32(hval, prime);
+		hval = _mm256_xor_si256(hval, _mm256_and_si256(v, octet));
+		v = _mm256_srli_epi32(v, 8);
+	}
+	return hval;
+}
+
+int
+cdbhash_batch_avx2(uint32 *hashes, int nrows, const Datum *values,
+				   const bool *isnull, CdbHashBatchKernel kernel)
+{
+	/* gathers the low halves of 4 Datums, then the high halves */
+	const __m256i split = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+	const __m256i nullval = _mm256_set1_epi32((int) NULL_VAL);
+	int			i;
+
+	Assert(kernel != CDBHASH_KERNEL_NONE && kernel <= CDBHASH_AVX2_MAX_KERNEL);
+
+	for (i = 0; i + LANES <= nrows; i += LANES)
+	{
+		__m256i		a = _mm256_loadu_si256((const __m256i *) &values[i]);
+		__m256i		b = _mm256_loadu_si256((const __m256i *) &values[i + 4]);
+		__m256i		lo;
+		__m256i		hi;
+		__m256i		h;
+		__m256i		hv;
+
+		a = _mm256_permutevar8x32_epi32(a, split);
+		b = _mm256_permutevar8x32_epi32(b, split);
+		lo = _mm256_permute2x128_si256(a, b, 0x20);
+		hi = _mm256_permute2x128_si256(a, b, 0x31);
+
+		/* the integer hashDatum() hashes, as BATCH_INT2() etc. do */
+		switch (kernel)
+		{
+			case CDBHASH_KERNEL_INT2:
+				lo = _mm256_srai_epi32(_mm256_slli_epi32(lo, 16), 16);
+				hi = _mm256_srai_epi32(lo, 31);
+				break;
+			case CDBHASH_KERNEL_INT4:
+				hi = _mm256_srai_epi32(lo, 31);
+				break;
+			case CDBHASH_KERNEL_OID:
+				hi = _mm256_setzero_si256();
+				break;
+			default:
+				break;
+		}
+
+		h = _mm256_loadu_si256((const __m256i *) &hashes[i]);
+		hv = fnv1_32_octets4(h, lo);
+		if (kernel != CDBHASH_KERNEL_DATE)
+			hv = fnv1_32_octets4(hv, hi);
+
+		if (isnull != NULL)
+		{
+			__m128i		nulls8 = _mm_loadl_epi64((const __m128i *) &isnull[i]);
+			__m256i		mask = _mm256_cmpgt_epi32(_mm256_cvtepu8_epi32(nulls8),
+												  _mm256_setzero_si256());
+
+			hv = _mm256_blendv_epi8(hv, fnv1_32_octets4(h, nullval), mask);
+		}
+
+		_mm256_storeu_si256((__m256i *) &hashes[i], hv);
+	}
+
+	return i;
+}
+
+#endif
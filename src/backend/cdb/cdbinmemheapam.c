@@ -490,11 +490,15 @@ InMemHeap_GetNext(InMemHeapScanDesc scan, ScanDirection direction)
             {
             	if (BackwardScanDirection == direction)
             	{
-            		/* if direction is backward, reverse list */
+            		/*
+            		 * if direction is backward, walk a reversed copy of the
+            		 * list, which is freed at the end of the scan
+            		 */
             		scan->indexReverseList = list_reverse_ints(entry->values);
-            		entry->values = scan->indexReverseList;
+            		scan->indexNext = list_head(scan->indexReverseList);
             	}
-                scan->indexNext = list_head(entry->values);
+            	else
+            		scan->indexNext = list_head(entry->values);
             }
             else
             	scan->indexNext = NULL;
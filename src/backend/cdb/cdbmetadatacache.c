@@ -60,6 +60,7 @@
 #include "utils/ps_status.h"
 #include "libpq/pqsignal.h"
 #include "utils/memutils.h"
+#include "utils/timestamp.h"
 
 #include "funcapi.h"
 #include "fmgr.h"
@@ -91,17 +92,6 @@ typedef struct BlockInfoEntry
     uint16_t            index;            
 } BlockInfoEntry;
 
-typedef struct RevertBlockInfoKey
-{
-    uint16_t            index;
-} RevertBlockInfoKey;
-
-typedef struct RevertBlockInfoEntry
-{
-    RevertBlockInfoKey  key;
-    char                block_info[MAX_BLOCK_INFO_LEN];
-} RevertBlockInfoEntry;
-
 /*
  * Metadata Cache Global Initialization Functions
  */
@@ -123,6 +113,9 @@ MetadataCacheHdfsBlockArrayInit(void);
 static void                 
 InitMetadataCacheKey(MetadataCacheKey *key, const HdfsFileInfo *file_info);
 
+static LWLockId
+MetadataCacheKeyPartitionLock(const MetadataCacheKey *key);
+
 static MetadataCacheEntry *
 MetadataCacheExists(const HdfsFileInfo *file_info);
 
@@ -158,9 +151,17 @@ static HTAB                     *BlockHostsMap = NULL;
 static HTAB                     *BlockNamesMap = NULL;
 static HTAB                     *BlockTopologyPathsMap = NULL;
 
-static HTAB                     *RevertBlockHostsMap = NULL;
-static HTAB                     *RevertBlockNamesMap = NULL;
-static HTAB                     *RevertBlockTopologyPathsMap = NULL;
+/*
+ * The revert maps are arrays indexed by the block info index, index 0 is
+ * unused. Their slots are only appended, under MetadataCacheLock, and an
+ * index is published to the blocks after its slot is filled, so the
+ * readers of the blocks of an entry read them without MetadataCacheLock.
+ */
+typedef char RevertBlockInfo[MAX_BLOCK_INFO_LEN];
+
+static RevertBlockInfo          *RevertBlockHostsMap = NULL;
+static RevertBlockInfo          *RevertBlockNamesMap = NULL;
+static RevertBlockInfo          *RevertBlockTopologyPathsMap = NULL;
 
 //static BlockLocation *CreateHdfsFileBlockLocations(BlockLocation *hdfs_locations, int block_num);
 //static BlockLocation *MergeHdfsFileBlockLocations(BlockLocation *locations1, int block_num1, BlockLocation *locations2, int block_num2);
@@ -175,6 +176,7 @@ static BlockLocation *GetHdfsFileBlockLocationsFromCache(MetadataCacheEntry *ent
  *  Estimate metadata cache shared memory size
  *      - Metadata cache hash size
  *      - Block info (3 types) hash size
+ *      - Revert block info (3 types) array size
  *      - Metadata cache shared structure size
  *      - Metadata hdfs block array size
  */
@@ -187,6 +189,8 @@ MetadataCache_ShmemSize(void)
 
     size = add_size(size, hash_estimate_size((Size)MAX_HDFS_HOST_NUM, sizeof(BlockInfoEntry)) * METADATA_BLOCK_INFO_TYPE_NUM);
 
+    size = add_size(size, mul_size(MAX_HDFS_HOST_NUM + 1, sizeof(RevertBlockInfo)) * METADATA_BLOCK_INFO_TYPE_NUM);
+
     size = add_size(size, sizeof(MetadataCacheSharedData));
 
     size = add_size(size, metadata_cache_block_capacity* sizeof(MetadataHdfsBlockInfo));
@@ -199,6 +203,7 @@ MetadataCache_ShmemSize(void)
  *      - Metadata cache shared data structure
  *      - Metadata cache hash table
  *      - Metadata cache block info hash tables (3 types) 
+ *      - Metadata cache revert block info arrays (3 types)
  *      - Metadata hdfs block array
  */
 void 
@@ -237,7 +242,7 @@ MetadataCache_ShmemInit(void)
 
     if (!MetadataRevertBlockInfoTablesInit())
     {
-        elog(FATAL, "[MetadataCache] fail to allocate share memory for metadata cache revert block info hash tables");
+        elog(FATAL, "[MetadataCache] fail to allocate share memory for metadata cache revert block info arrays");
     }
 
     if (!MetadataCacheHdfsBlockArrayInit())
@@ -264,7 +269,8 @@ MetadataCacheHashTableInit(void)
     info.keysize = sizeof(MetadataCacheKey);
     info.entrysize = sizeof(MetadataCacheEntry);
     info.hash = tag_hash;
-    hash_flags = (HASH_ELEM | HASH_FUNCTION);
+    info.num_partitions = NUM_METADATA_CACHE_PARTITIONS;
+    hash_flags = (HASH_ELEM | HASH_FUNCTION | HASH_PARTITION);
 
     MetadataCache = ShmemInitHash("Metadata Cache", metadata_cache_max_hdfs_file_num, metadata_cache_max_hdfs_file_num, &info, hash_flags);
     if (NULL == MetadataCache)
@@ -315,38 +321,36 @@ MetadataBlockInfoTablesInit(void)
 }
 
 /*
- *  Initialize metadata revert block info hash tables
+ *  Initialize metadata revert block info arrays
  */
 bool 
 MetadataRevertBlockInfoTablesInit(void)
 {
-    HASHCTL     info;
-    int         hash_flags;
- 
-    MemSet(&info, 0, sizeof(info));
-
-    info.keysize = sizeof(RevertBlockInfoKey);
-    info.entrysize = sizeof(RevertBlockInfoEntry);
-    hash_flags = HASH_ELEM;
+    Size        size = (MAX_HDFS_HOST_NUM + 1) * sizeof(RevertBlockInfo);
+    bool        found;
 
-    RevertBlockHostsMap = ShmemInitHash("Metadata Revert Block Hosts Map", MAX_HDFS_HOST_NUM, MAX_HDFS_HOST_NUM, &info, hash_flags);
+    RevertBlockHostsMap = (RevertBlockInfo *)ShmemInitStruct("Metadata Revert Block Hosts Map", size, &found);
     if (NULL == RevertBlockHostsMap)
     {
         return false;
     }
  
-    RevertBlockNamesMap = ShmemInitHash("Metadata Revert Block Names Map", MAX_HDFS_HOST_NUM, MAX_HDFS_HOST_NUM, &info, hash_flags);
+    RevertBlockNamesMap = (RevertBlockInfo *)ShmemInitStruct("Metadata Revert Block Names Map", size, &found);
     if (NULL == RevertBlockNamesMap)
     {
         return false;
     }
     
-    RevertBlockTopologyPathsMap = ShmemInitHash("Metadata Revert Block TopologyPaths Map", MAX_HDFS_HOST_NUM, MAX_HDFS_HOST_NUM, &info, hash_flags);
+    RevertBlockTopologyPathsMap = (RevertBlockInfo *)ShmemInitStruct("Metadata Revert Block TopologyPaths Map", size, &found);
     if (NULL == RevertBlockTopologyPathsMap)
     {
         return false;
     }
 
+    MemSet(RevertBlockHostsMap, 0, size);
+    MemSet(RevertBlockNamesMap, 0, size);
+    MemSet(RevertBlockTopologyPathsMap, 0, size);
+
     return true;
 }
 
@@ -443,6 +447,53 @@ InitMetadataCacheKey(MetadataCacheKey *key, const HdfsFileInfo *file_info)
     key->segno = file_info->segno;
 }
 
+/*
+ *  Metadata cache partition lock of a file
+ */
+LWLockId
+MetadataCachePartitionLock(const HdfsFileInfo *file_info)
+{
+    Insist(file_info != NULL);
+
+    MetadataCacheKey key;
+
+    InitMetadataCacheKey(&key, file_info);
+    return MetadataCacheKeyPartitionLock(&key);
+}
+
+static LWLockId
+MetadataCacheKeyPartitionLock(const MetadataCacheKey *key)
+{
+    uint32 hashcode = get_hash_value(MetadataCache, (void *)key);
+
+    return (LWLockId) (FirstMetadataCacheLock + (hashcode % NUM_METADATA_CACHE_PARTITIONS));
+}
+
+/*
+ *  Lock all the metadata cache partitions, to scan the whole cache
+ */
+void
+MetadataCacheLockAllPartitions(LWLockMode mode)
+{
+    int i;
+
+    for (i=0;i<NUM_METADATA_CACHE_PARTITIONS;i++)
+    {
+        LWLockAcquire(FirstMetadataCacheLock + i, mode);
+    }
+}
+
+void
+MetadataCacheUnlockAllPartitions(void)
+{
+    int i;
+
+    for (i=NUM_METADATA_CACHE_PARTITIONS-1;i>=0;i--)
+    {
+        LWLockRelease(FirstMetadataCacheLock + i);
+    }
+}
+
 /*
  *  Metadata cache exist
  */
@@ -542,9 +593,7 @@ SetMetadataBlockInfo(MetadataBlockInfoType type, char **infos, uint32_t num)
     BlockInfoEntry *entry;
     HTAB *htab = NULL;
 
-    RevertBlockInfoKey rkey;
-    RevertBlockInfoEntry *rentry;
-    HTAB *rhtab = NULL;
+    RevertBlockInfo *rmap = NULL;
 
     uint32_t *cur_idx = NULL;
 
@@ -552,19 +601,19 @@ SetMetadataBlockInfo(MetadataBlockInfoType type, char **infos, uint32_t num)
     {
     case METADATA_BLOCK_INFO_TYPE_HOSTS:
         htab = BlockHostsMap;
-        rhtab = RevertBlockHostsMap;
+        rmap = RevertBlockHostsMap;
         cur_idx = &MetadataCacheSharedDataInstance->cur_hosts_idx;
         break;
 
     case METADATA_BLOCK_INFO_TYPE_NAMES:
         htab = BlockNamesMap;
-        rhtab = RevertBlockNamesMap;
+        rmap = RevertBlockNamesMap;
         cur_idx = &MetadataCacheSharedDataInstance->cur_names_idx;
         break;
     
     case METADATA_BLOCK_INFO_TYPE_TOPOLOGYPATHS:
         htab = BlockTopologyPathsMap;
-        rhtab = RevertBlockTopologyPathsMap;
+        rmap = RevertBlockTopologyPathsMap;
         cur_idx = &MetadataCacheSharedDataInstance->cur_topologyPaths_idx;
         break;
 
@@ -582,16 +631,23 @@ SetMetadataBlockInfo(MetadataBlockInfoType type, char **infos, uint32_t num)
         memset(key.block_info, 0, MAX_BLOCK_INFO_LEN);
         snprintf(key.block_info, MAX_BLOCK_INFO_LEN, "%s", infos[i]);
         entry = (BlockInfoEntry *)hash_search(htab, (void *)&key, HASH_ENTER_NULL, &found);
+        if (NULL == entry)
+        {
+            elog(ERROR, "[MetadataCache] out of shared memory for hdfs block info %s", infos[i]);
+        }
 
         if (!found)
         {
+            if ((*cur_idx) >= MAX_HDFS_HOST_NUM)
+            {
+                hash_search(htab, (void *)&key, HASH_REMOVE, NULL);
+                elog(ERROR, "[MetadataCache] The number of hdfs block infos must little than %d", MAX_HDFS_HOST_NUM);
+            }
+
+            // fill the slot before its index is published
+            snprintf(rmap[(*cur_idx) + 1], MAX_BLOCK_INFO_LEN, "%s", infos[i]);
             (*cur_idx)++;
             entry->index = (*cur_idx);
-            
-            rkey.index = (*cur_idx);
-            rentry = hash_search(rhtab, (void *)&rkey, HASH_ENTER_NULL, &found);
-            memset(rentry->block_info, 0, MAX_BLOCK_INFO_LEN);
-            snprintf(rentry->block_info, MAX_BLOCK_INFO_LEN, "%s", infos[i]);
         }
         entry_idx = entry->index;
         result |= (entry_idx << (i * BLOCK_INFO_BIT_NUM));
@@ -609,24 +665,26 @@ GetMetadataBlockInfo(MetadataBlockInfoType type, uint64_t infos, int index)
 {
     Insist(index >= 0 && index < 4);
  
-    RevertBlockInfoKey rkey;
-    RevertBlockInfoEntry *rentry;
-    HTAB *rhtab = NULL;
+    RevertBlockInfo *rmap = NULL;
+    uint32_t cur_idx = 0;
     uint64_t mask;
-    bool found;
+    uint32_t rindex;
 
     switch (type)
     {
     case METADATA_BLOCK_INFO_TYPE_HOSTS:
-        rhtab = RevertBlockHostsMap;
+        rmap = RevertBlockHostsMap;
+        cur_idx = MetadataCacheSharedDataInstance->cur_hosts_idx;
         break;
 
     case METADATA_BLOCK_INFO_TYPE_NAMES:
-        rhtab = RevertBlockNamesMap;
+        rmap = RevertBlockNamesMap;
+        cur_idx = MetadataCacheSharedDataInstance->cur_names_idx;
         break;
     
     case METADATA_BLOCK_INFO_TYPE_TOPOLOGYPATHS:
-        rhtab = RevertBlockTopologyPathsMap;
+        rmap = RevertBlockTopologyPathsMap;
+        cur_idx = MetadataCacheSharedDataInstance->cur_topologyPaths_idx;
         break;
 
     default:
@@ -635,13 +693,12 @@ GetMetadataBlockInfo(MetadataBlockInfoType type, uint64_t infos, int index)
 
     mask = 0x000000000000ffff;
     mask = mask << (index * BLOCK_INFO_BIT_NUM);
-    rkey.index = (mask & infos) >> (index * BLOCK_INFO_BIT_NUM);
+    rindex = (mask & infos) >> (index * BLOCK_INFO_BIT_NUM);
 
-    rentry = (RevertBlockInfoEntry *)hash_search(rhtab, (void *)&rkey, HASH_FIND, &found);
-    if (!found) {
+    if (rindex == 0 || rindex > cur_idx) {
         return NULL;
     }
-    return rentry->block_info;
+    return rmap[rindex];
 }
 
 /*
@@ -661,14 +718,16 @@ BlockLocation *GetHdfsFileBlockLocations(const HdfsFileInfo *file_info, uint64_t
 
     MetadataCacheEntry *cache_entry = NULL;
     BlockLocation *locations = NULL;
+    LWLockId partition_lock = MetadataCachePartitionLock(file_info);
 
-    LWLockAcquire(MetadataCacheLock, LW_SHARED);
+    // the hit path only takes the partition lock of the file, in shared mode
+    LWLockAcquire(partition_lock, LW_SHARED);
 
     cache_entry = MetadataCacheExists(file_info);
     if (!cache_entry)
     {
         // Cache Not Hit
-        LWLockRelease(MetadataCacheLock); 
+        LWLockRelease(partition_lock); 
 
         elog(DEBUG1, "[MetadataCache] GetHdfsFileBlockLocations NOT HIT CACHE. filename:%s filesize:"INT64_FORMAT"", 
                                 file_info->filepath, 
@@ -694,7 +753,7 @@ BlockLocation *GetHdfsFileBlockLocations(const HdfsFileInfo *file_info, uint64_t
             locations = GetHdfsFileBlockLocationsFromCache(cache_entry, filesize, block_num);
             *hit_ratio = 1.0;    
 
-            LWLockRelease(MetadataCacheLock); 
+            LWLockRelease(partition_lock); 
         } 
         else 
         {
@@ -706,11 +765,13 @@ BlockLocation *GetHdfsFileBlockLocations(const HdfsFileInfo *file_info, uint64_t
             */
             
                 // re-fetch file's all block locations, because hdfs will get incorrect result when fetch partly
-                LWLockRelease(MetadataCacheLock); 
+                LWLockRelease(partition_lock); 
         
+                LWLockAcquire(partition_lock, LW_EXCLUSIVE);
                 LWLockAcquire(MetadataCacheLock, LW_EXCLUSIVE);
                 RemoveHdfsFileBlockLocations(file_info);
                 LWLockRelease(MetadataCacheLock); 
+                LWLockRelease(partition_lock); 
                 
                 locations = GetHdfsFileBlockLocationsNoCache(file_info, filesize, block_num);
                 *hit_ratio = 0;
@@ -730,6 +791,113 @@ BlockLocation *GetHdfsFileBlockLocations(const HdfsFileInfo *file_info, uint64_t
     return locations;
 }
 
+/*
+ *  Put the block locations of the files not fully cached yet into metadata cache,
+ *  fetching them from Hadoop HDFS with metadata_cache_prefetch_threads RPCs in flight
+ */
+void
+PrefetchHdfsFileBlockLocations(HdfsFileInfo **file_infos, uint64_t *filesizes, int nfiles)
+{
+    HdfsFileInfo **miss_infos;
+    char **miss_paths;
+    int64 *miss_sizes;
+    BlockLocation **miss_locations;
+    int *miss_block_nums;
+    int nmiss = 0;
+    int i;
+
+    if (nfiles <= 0 || metadata_cache_prefetch_threads <= 0)
+    {
+        return;
+    }
+
+    miss_infos = (HdfsFileInfo **) palloc(nfiles * sizeof(HdfsFileInfo *));
+    miss_paths = (char **) palloc(nfiles * sizeof(char *));
+    miss_sizes = (int64 *) palloc(nfiles * sizeof(int64));
+
+    // 1. collect the files the cache cannot answer
+    for (i=0;i<nfiles;i++)
+    {
+        MetadataCacheEntry *entry;
+        LWLockId partition_lock;
+        bool hit;
+
+        if (0 == filesizes[i])
+        {
+            continue;
+        }
+
+        partition_lock = MetadataCachePartitionLock(file_infos[i]);
+        LWLockAcquire(partition_lock, LW_SHARED);
+        entry = MetadataCacheExists(file_infos[i]);
+        hit = (entry != NULL && filesizes[i] <= entry->file_size);
+        LWLockRelease(partition_lock);
+
+        if (!hit)
+        {
+            miss_infos[nmiss] = file_infos[i];
+            miss_paths[nmiss] = file_infos[i]->filepath;
+            miss_sizes[nmiss] = filesizes[i];
+            nmiss++;
+        }
+    }
+
+    if (0 == nmiss)
+    {
+        goto done;
+    }
+
+    elog(DEBUG1, "[MetadataCache] PrefetchHdfsFileBlockLocations fetch %d of %d files with %d threads",
+                            nmiss,
+                            nfiles,
+                            metadata_cache_prefetch_threads);
+
+    // 2. fetch hdfs block locations
+    miss_locations = (BlockLocation **) palloc0(nmiss * sizeof(BlockLocation *));
+    miss_block_nums = (int *) palloc0(nmiss * sizeof(int));
+    HdfsGetFileBlockLocationsParallel(nmiss, miss_paths, miss_sizes, miss_locations,
+                                      miss_block_nums, metadata_cache_prefetch_threads);
+
+    // 3. insert fetch results into cache
+    for (i=0;i<nmiss;i++)
+    {
+        MetadataCacheEntry *entry;
+        LWLockId partition_lock;
+
+        if ((NULL == miss_locations[i]) || (0 == miss_block_nums[i]))
+        {
+            elog(DEBUG1, "[MetadataCache] PrefetchHdfsFileBlockLocations fetch hdfs block locatons fail. filename:%s filesize:"INT64_FORMAT" block_num:%d",
+                                miss_infos[i]->filepath,
+                                miss_sizes[i],
+                                miss_block_nums[i]);
+            continue;
+        }
+
+        partition_lock = MetadataCachePartitionLock(miss_infos[i]);
+        LWLockAcquire(partition_lock, LW_EXCLUSIVE);
+        LWLockAcquire(MetadataCacheLock, LW_EXCLUSIVE);
+
+        entry = MetadataCacheNew(miss_infos[i], miss_sizes[i], miss_locations[i], miss_block_nums[i]);
+        if (entry)
+        {
+            entry->last_access_time = entry->create_time = time(NULL);
+        }
+
+        LWLockRelease(MetadataCacheLock);
+        LWLockRelease(partition_lock);
+
+        HdfsFreeFileBlockLocations(miss_locations[i], miss_block_nums[i]);
+    }
+
+    pfree(miss_locations);
+    pfree(miss_block_nums);
+
+done:
+    pfree(miss_infos);
+    pfree(miss_paths);
+    pfree(miss_sizes);
+}
+
 /*
  *  Get hdfs file block locations from Hadoop HDFS and put the result into metadata cache
  */
@@ -739,6 +907,7 @@ GetHdfsFileBlockLocationsNoCache(const HdfsFileInfo *file_info, uint64_t filesiz
     BlockLocation *hdfs_locations = NULL; 
     BlockLocation *locations = NULL; 
     MetadataCacheEntry *entry = NULL;
+    LWLockId partition_lock;
 
     // 1. fetch hdfs block locations
     hdfs_locations = HdfsGetFileBlockLocations(file_info->filepath, filesize, block_num);
@@ -757,6 +926,8 @@ GetHdfsFileBlockLocationsNoCache(const HdfsFileInfo *file_info, uint64_t filesiz
                                 *block_num);
 
     // 2. insert fetch results into cache
+    partition_lock = MetadataCachePartitionLock(file_info);
+    LWLockAcquire(partition_lock, LW_EXCLUSIVE);
     LWLockAcquire(MetadataCacheLock, LW_EXCLUSIVE);
 
     // 3. generate result block locations
@@ -766,6 +937,7 @@ GetHdfsFileBlockLocationsNoCache(const HdfsFileInfo *file_info, uint64_t filesiz
     if (NULL == entry)
     {
         LWLockRelease(MetadataCacheLock);
+        LWLockRelease(partition_lock);
         elog(DEBUG1, "[MetadataCache] GetHdfsFileBlockLocationsNoCache put hdfs block locations info cache fail. filename:%s filesize:"INT64_FORMAT" block_num:%d",
                                 file_info->filepath, 
                                 filesize, 
@@ -775,6 +947,7 @@ GetHdfsFileBlockLocationsNoCache(const HdfsFileInfo *file_info, uint64_t filesiz
     entry->last_access_time = entry->create_time = time(NULL);
 
     LWLockRelease(MetadataCacheLock);
+    LWLockRelease(partition_lock);
 
 done:
     if (hdfs_locations)
@@ -882,6 +1055,7 @@ GetHdfsFileBlockLocationsFromCache(MetadataCacheEntry *entry, uint64_t filesize,
         k = NEXT_BLOCK_ID(k);
     }
 
+    // may race with other readers of the partition, any of the times will do
     entry->last_access_time = time(NULL);
 
     return locations;
@@ -1195,6 +1369,9 @@ DumpHdfsFileBlockLocations(BlockLocation *locations, int block_num)
 
 /*
  * Transfer hdfs block locations to cache format and put it into cache
+ *
+ * The caller holds the partition lock of the file and MetadataCacheLock
+ * exclusively. An entry cached meanwhile by another backend is replaced.
  */
 MetadataCacheEntry *
 MetadataCacheNew(const HdfsFileInfo *file_info, uint64_t filesize, BlockLocation *hdfs_locations, int block_num)
@@ -1206,6 +1383,8 @@ MetadataCacheNew(const HdfsFileInfo *file_info, uint64_t filesize, BlockLocation
     int i, j;
     MetadataCacheEntry *entry = NULL;
 
+    RemoveHdfsFileBlockLocations(file_info);
+
     if (block_num > FREE_BLOCK_NUM)
     {
         elog(DEBUG1, "[Metadata] MetadataCacheNew not enough free block. \
@@ -1254,6 +1433,9 @@ MetadataCacheNew(const HdfsFileInfo *file_info, uint64_t filesize, BlockLocation
 
 /*
  *  Remove entry from metadata cache
+ *
+ *  The caller holds the partition lock of the file and MetadataCacheLock
+ *  exclusively.
  */
 void 
 RemoveHdfsFileBlockLocations(const HdfsFileInfo *file_info)
@@ -1275,6 +1457,151 @@ RemoveHdfsFileBlockLocations(const HdfsFileInfo *file_info)
     }
 }
 
+/*
+ *  Block locations of the files of external tables
+ *
+ *  The files of hdfs and hive external tables have no relfilenode to key the
+ *  shared cache with, their block locations are cached in the backend keyed
+ *  by path instead. An entry is used while its file keeps the same length,
+ *  for at most hawq_metadata_cache_refresh_interval seconds.
+ */
+typedef struct ExtFileBlockLocationEntry
+{
+    char            filepath[MAXPGPATH];    /* hash key */
+    int64           file_size;
+    int             block_num;
+    BlockLocation   *locations;
+    TimestampTz     create_time;
+} ExtFileBlockLocationEntry;
+
+static HTAB *ExtFileBlockLocationCache = NULL;
+static MemoryContext ExtFileBlockLocationContext = NULL;
+
+static void
+ExtFileBlockLocationCacheInit(void)
+{
+    HASHCTL ctl;
+
+    ExtFileBlockLocationContext = AllocSetContextCreate(TopMemoryContext,
+                                                        "ExtFileBlockLocationCache",
+                                                        ALLOCSET_DEFAULT_MINSIZE,
+                                                        ALLOCSET_DEFAULT_INITSIZE,
+                                                        ALLOCSET_DEFAULT_MAXSIZE);
+
+    MemSet(&ctl, 0, sizeof(ctl));
+    ctl.keysize = MAXPGPATH;
+    ctl.entrysize = sizeof(ExtFileBlockLocationEntry);
+    ctl.hcxt = ExtFileBlockLocationContext;
+
+    ExtFileBlockLocationCache = hash_create("External File Block Location Cache",
+                                            1024, &ctl, HASH_ELEM | HASH_CONTEXT);
+}
+
+/*
+ *  Copy block locations, including the fields the shared cache does not keep
+ */
+static BlockLocation *
+CopyExtFileBlockLocations(const BlockLocation *src, int block_num)
+{
+    BlockLocation *locations = (BlockLocation *)palloc(sizeof(BlockLocation) * block_num);
+    int i, j;
+
+    for (i=0;i<block_num;i++)
+    {
+        locations[i] = src[i];
+        locations[i].hosts = (char **)palloc(sizeof(char *) * src[i].numOfNodes);
+        locations[i].names = (char **)palloc(sizeof(char *) * src[i].numOfNodes);
+        locations[i].topologyPaths = (char **)palloc(sizeof(char *) * src[i].numOfNodes);
+        for (j=0;j<src[i].numOfNodes;j++)
+        {
+            locations[i].hosts[j] = pstrdup(src[i].hosts[j]);
+            locations[i].names[j] = pstrdup(src[i].names[j]);
+            locations[i].topologyPaths[j] = pstrdup(src[i].topologyPaths[j]);
+        }
+    }
+
+    return locations;
+}
+
+/*
+ *  Return a palloc'd copy of the cached block locations of the external file
+ *  of length filesize, or NULL if they are not cached
+ */
+BlockLocation *
+GetExtFileBlockLocations(const char *filepath, int64 filesize, int *block_num)
+{
+    ExtFileBlockLocationEntry *entry;
+
+    if (!metadata_cache_enable || NULL == ExtFileBlockLocationCache ||
+        strlen(filepath) >= MAXPGPATH)
+    {
+        return NULL;
+    }
+
+    entry = (ExtFileBlockLocationEntry *)hash_search(ExtFileBlockLocationCache,
+                                                     (void *)filepath, HASH_FIND, NULL);
+    if (NULL == entry)
+    {
+        return NULL;
+    }
+
+    if (entry->file_size != filesize ||
+        TimestampDifferenceExceeds(entry->create_time, GetCurrentTimestamp(),
+                                   metadata_cache_refresh_interval * 1000))
+    {
+        elog(DEBUG1, "[MetadataCache] GetExtFileBlockLocations STALE. filename:%s filesize:"INT64_FORMAT"",
+                                filepath, filesize);
+
+        FreeHdfsFileBlockLocations(entry->locations, entry->block_num);
+        hash_search(ExtFileBlockLocationCache, (void *)filepath, HASH_REMOVE, NULL);
+        return NULL;
+    }
+
+    *block_num = entry->block_num;
+    return CopyExtFileBlockLocations(entry->locations, entry->block_num);
+}
+
+/*
+ *  Cache the block locations of the external file of length filesize
+ */
+void
+PutExtFileBlockLocations(const char *filepath, int64 filesize, const BlockLocation *locations, int block_num)
+{
+    ExtFileBlockLocationEntry *entry;
+    MemoryContext oldcontext;
+    bool found;
+
+    if (!metadata_cache_enable || block_num <= 0 || strlen(filepath) >= MAXPGPATH)
+    {
+        return;
+    }
+
+    if (NULL == ExtFileBlockLocationCache)
+    {
+        ExtFileBlockLocationCacheInit();
+    }
+    else if (hash_get_num_entries(ExtFileBlockLocationCache) >= metadata_cache_max_hdfs_file_num)
+    {
+        /* start over rather than keep track of the use of the entries */
+        MemoryContextDelete(ExtFileBlockLocationContext);
+        ExtFileBlockLocationCacheInit();
+    }
+
+    entry = (ExtFileBlockLocationEntry *)hash_search(ExtFileBlockLocationCache,
+                                                     (void *)filepath, HASH_ENTER, &found);
+    if (found)
+    {
+        FreeHdfsFileBlockLocations(entry->locations, entry->block_num);
+    }
+
+    oldcontext = MemoryContextSwitchTo(ExtFileBlockLocationContext);
+    entry->locations = CopyExtFileBlockLocations(locations, block_num);
+    MemoryContextSwitchTo(oldcontext);
+
+    entry->file_size = filesize;
+    entry->block_num = block_num;
+    entry->create_time = GetCurrentTimestamp();
+}
 
 /*
  *  Metadata Cache UDF
@@ -1288,6 +1615,7 @@ extern Datum gp_metadata_cache_clear(PG_FUNCTION_ARGS)
     bool found;
     long entry_num = 0;
 
+    MetadataCacheLockAllPartitions(LW_EXCLUSIVE);
     LWLockAcquire(MetadataCacheLock, LW_EXCLUSIVE);
     
     entry_num = hash_get_num_entries(MetadataCache);
@@ -1305,6 +1633,7 @@ extern Datum gp_metadata_cache_clear(PG_FUNCTION_ARGS)
     }
     
     LWLockRelease(MetadataCacheLock);
+    MetadataCacheUnlockAllPartitions();
 
     char message[1024] = {0};
     snprintf(message, 1024, "Metadata cache clear %ld items", entry_num);
@@ -1318,9 +1647,9 @@ extern Datum gp_metadata_cache_clear(PG_FUNCTION_ARGS)
  */
 extern Datum gp_metadata_cache_current_num(PG_FUNCTION_ARGS)
 {
-    LWLockAcquire(MetadataCacheLock, LW_SHARED);
+    MetadataCacheLockAllPartitions(LW_SHARED);
     int64 num = hash_get_num_entries(MetadataCache); 
-    LWLockRelease(MetadataCacheLock);
+    MetadataCacheUnlockAllPartitions();
 
     PG_RETURN_INT64(num);
 }
@@ -1355,9 +1684,11 @@ extern Datum gp_metadata_cache_exists(PG_FUNCTION_ARGS)
     HdfsFileInfo *file_info = CreateHdfsFileInfo(rnode, segno);
     InitMetadataCacheKey(&key, file_info);
 
-    LWLockAcquire(MetadataCacheLock, LW_SHARED);
+    LWLockId partition_lock = MetadataCachePartitionLock(file_info);
+
+    LWLockAcquire(partition_lock, LW_SHARED);
     entry = MetadataCacheExists(file_info);
-    LWLockRelease(MetadataCacheLock);
+    LWLockRelease(partition_lock);
 
     DestroyHdfsFileInfo(file_info);
 
@@ -1387,7 +1718,9 @@ extern Datum gp_metadata_cache_info(PG_FUNCTION_ARGS)
     InitMetadataCacheKey(&key, file_info);
 
     char message[1024] = {0};
-    LWLockAcquire(MetadataCacheLock, LW_SHARED);
+    LWLockId partition_lock = MetadataCachePartitionLock(file_info);
+
+    LWLockAcquire(partition_lock, LW_SHARED);
     entry = MetadataCacheExists(file_info);
     if (!entry)
     {
@@ -1404,7 +1737,7 @@ extern Datum gp_metadata_cache_info(PG_FUNCTION_ARGS)
                             entry->create_time); 
     }
 
-    LWLockRelease(MetadataCacheLock);
+    LWLockRelease(partition_lock);
 
     DestroyHdfsFileInfo(file_info);
     PG_RETURN_TEXT_P(cstring_to_text(message));    
@@ -1423,8 +1756,6 @@ extern Datum gp_metadata_cache_put_entry_for_test(PG_FUNCTION_ARGS)
     int4 start = PG_GETARG_INT32(3);
     int4 end = PG_GETARG_INT32(4);
 
-    LWLockAcquire(MetadataCacheLock, LW_EXCLUSIVE);
-
     int i;
     int4 stop = (start -end) / 10;
     int4 current = 0;
@@ -1438,15 +1769,23 @@ extern Datum gp_metadata_cache_put_entry_for_test(PG_FUNCTION_ARGS)
     	key.segno = i;
 
     	bool found;
+    	LWLockId partition_lock = MetadataCacheKeyPartitionLock(&key);
+
+    	LWLockAcquire(partition_lock, LW_EXCLUSIVE);
+    	LWLockAcquire(MetadataCacheLock, LW_EXCLUSIVE);
     	MetadataCacheEntry *entry = (MetadataCacheEntry *)hash_search(MetadataCache, (void *)&key, HASH_ENTER_NULL, &found);
         if(entry == NULL)
         {
+            LWLockRelease(MetadataCacheLock);
+            LWLockRelease(partition_lock);
             continue;
         }
         entry->file_size = 134217728;
         entry->block_num = 1;
 
         AllocMetadataBlock(entry->block_num, &entry->first_block_id, &entry->last_block_id);
+        LWLockRelease(MetadataCacheLock);
+        LWLockRelease(partition_lock);
 
     	current++;
     	success++;
@@ -1454,12 +1793,9 @@ extern Datum gp_metadata_cache_put_entry_for_test(PG_FUNCTION_ARGS)
     	if(current == stop)
     	{
     		current = 0;
-    		LWLockRelease(MetadataCacheLock);
     		pg_usleep(1 * USECS_PER_SEC);
-    	    LWLockAcquire(MetadataCacheLock, LW_EXCLUSIVE);
     	}
     }
-    LWLockRelease(MetadataCacheLock);
 
     char message[1024] = {0};
     snprintf(message, 1024, "Metadata cache successed putting %d entries. Failed putting %d entries.", success, end - start - success);
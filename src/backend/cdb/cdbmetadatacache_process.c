@@ -328,11 +328,11 @@ GenerateMetadataCacheLRUList()
     MetadataCacheEntry *entry;
     long cache_entry_num = 0;
 
-    LWLockAcquire(MetadataCacheLock, LW_EXCLUSIVE);
+    MetadataCacheLockAllPartitions(LW_SHARED);
     cache_entry_num = hash_get_num_entries(MetadataCache);
 
     if (cache_entry_num == 0) {
-        LWLockRelease(MetadataCacheLock);
+        MetadataCacheUnlockAllPartitions();
         return;
     }
 
@@ -360,7 +360,7 @@ GenerateMetadataCacheLRUList()
 
     pfree(entry_vector);
 
-    LWLockRelease(MetadataCacheLock);
+    MetadataCacheUnlockAllPartitions();
 }
 
 void
@@ -376,7 +376,7 @@ GenerateMetadataCacheRefreshList()
         MetadataCacheRefreshList = NULL;
     }
     
-    LWLockAcquire(MetadataCacheLock, LW_EXCLUSIVE);
+    MetadataCacheLockAllPartitions(LW_SHARED);
     
     hash_seq_init(&hstat, MetadataCache);
     while ((entry = (MetadataCacheEntry *)hash_seq_search(&hstat)) != NULL)
@@ -398,7 +398,7 @@ GenerateMetadataCacheRefreshList()
         }
     }
 
-    LWLockRelease(MetadataCacheLock);
+    MetadataCacheUnlockAllPartitions();
     
     elog(DEBUG1, "[MetadataCache] ProcessMetadataCacheRefresh, get refresh list:%d", list_length(MetadataCacheRefreshList));
 }
@@ -429,25 +429,34 @@ ProcessMetadataCacheCheck()
         }
 
         int total_remove_files = 0;
-        LWLockAcquire(MetadataCacheLock, LW_EXCLUSIVE);
 
         foreach(lc, MetadataCacheLRUList)
         {
             MetadataCacheCheckInfo *check_info = (MetadataCacheCheckInfo *)lfirst(lc);
+            LWLockId partition_lock;
+            bool done;
 
             rnode.spcNode = check_info->key.tablespace_oid;
             rnode.dbNode = check_info->key.database_oid;
             rnode.relNode = check_info->key.relation_oid;
 
             file_info = CreateHdfsFileInfo(rnode, check_info->key.segno);
+            partition_lock = MetadataCachePartitionLock(file_info);
+
+            LWLockAcquire(partition_lock, LW_EXCLUSIVE);
+            LWLockAcquire(MetadataCacheLock, LW_EXCLUSIVE);
             RemoveHdfsFileBlockLocations(file_info);
-            DestroyHdfsFileInfo(file_info);
             total_remove_files++;
 
             double cache_entry_ratio = ((double)hash_get_num_entries(MetadataCache)) / metadata_cache_max_hdfs_file_num;
 
-            if ((((double)FREE_BLOCK_NUM) / metadata_cache_block_capacity) >= metadata_cache_free_block_normal_ratio
-            		&& cache_entry_ratio < metadata_cache_reduce_ratio)
+            done = ((((double)FREE_BLOCK_NUM) / metadata_cache_block_capacity) >= metadata_cache_free_block_normal_ratio
+            		&& cache_entry_ratio < metadata_cache_reduce_ratio);
+            LWLockRelease(MetadataCacheLock);
+            LWLockRelease(partition_lock);
+            DestroyHdfsFileInfo(file_info);
+
+            if (done)
             {
                 break;
             }
@@ -455,8 +464,6 @@ ProcessMetadataCacheCheck()
     
         list_free_deep(MetadataCacheLRUList);
         MetadataCacheLRUList = NULL;
-
-        LWLockRelease(MetadataCacheLock);
             
         elog(DEBUG1, "[MetadataCache] ProcessMetadataCacheCheck, total remove files:%d", total_remove_files);
     }
@@ -487,6 +494,8 @@ ProcessMetadataCacheRefresh()
 
         hdfs_locations = HdfsGetFileBlockLocations(file_info->filepath, refresh_file->file_size, &block_num);
     
+        LWLockId partition_lock = MetadataCachePartitionLock(file_info);
+        LWLockAcquire(partition_lock, LW_EXCLUSIVE);
         LWLockAcquire(MetadataCacheLock, LW_EXCLUSIVE);
         if (!hdfs_locations)
         {
@@ -518,6 +527,7 @@ ProcessMetadataCacheRefresh()
             HdfsFreeFileBlockLocations(hdfs_locations, block_num);
         }
         LWLockRelease(MetadataCacheLock);
+        LWLockRelease(partition_lock);
 
         DestroyHdfsFileInfo(file_info);
     }
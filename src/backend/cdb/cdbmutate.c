@@ -166,15 +166,20 @@ allConstantValuesClause(Plan *node)
 	return true;
 }
 
-static void
-directDispatchCalculateHash(Plan *plan, GpPolicy *targetPolicy)
+/*
+ * Set the content a single row constant insert is sent to, on numsegs
+ * virtual segments.  Also used to retarget the kept plan of a prepared
+ * insert executed with other parameter values, see prepare.c.
+ */
+void
+directDispatchCalculateHash(Plan *plan, GpPolicy *targetPolicy, int numsegs)
 {
 	int i;
 	CdbHash *h=NULL;
 	ListCell *cell=NULL;
 	bool directDispatch;
 
-	h = makeCdbHash(GetPlannerSegmentNum(), HASH_FNV_1);
+	h = makeCdbHash(numsegs, HASH_FNV_1);
 	cdbhashinit(h);
 
 	/*
@@ -613,7 +618,8 @@ apply_motion(PlannerInfo *root, Plan *plan, Query *query)
 
 							if (root->config->gp_enable_direct_dispatch)
 							{
-								directDispatchCalculateHash(plan, targetPolicy);
+								directDispatchCalculateHash(plan, targetPolicy,
+															GetPlannerSegmentNum());
 								/* we now either have a hash-code, or we've marked the plan non-directed. */
 							}
 
@@ -0,0 +1,283 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*-------------------------------------------------------------------------
+ *
+ * cdbnuma.c
+ *	  Bind QEs to one NUMA node of their host.
+ *
+ * A QE which migrates across sockets ends up touching hash tables, sort
+ * arrays and interconnect buffers allocated on a remote node.  Once a QE
+ * knows its virtual segment, we pin all of its threads to the CPUs of one
+ * node and make the node preferred for its allocations, so the kernel's
+ * first-touch placement keeps executor memory local.
+ *
+ * The node is derived from the virtual segment index handed out by the
+ * resource manager, so the writer and the readers of one virtual segment,
+ * which exchange most of the interconnect traffic, share a node.
+ *
+ * There is no libnuma dependency; the topology is read from sysfs and
+ * the memory policy is set with the raw system call.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#ifdef __linux__
+#include <sched.h>
+#include <dirent.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "cdb/cdbnuma.h"
+#include "cdb/cdbvars.h"
+
+#if defined(__linux__) && defined(SYS_set_mempolicy) && defined(CPU_SETSIZE)
+#define HAVE_NUMA_BINDING 1
+#endif
+
+#ifdef HAVE_NUMA_BINDING
+
+/* from <numaif.h>, which we don't want to depend on */
+#ifndef MPOL_DEFAULT
+#define MPOL_DEFAULT	0
+#endif
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED	1
+#endif
+
+#define NUMA_SYSFS_PATH		"/sys/devices/system/node"
+#define NUMA_MAX_NODES		64
+
+/* online nodes of this host, read once; numa_num_nodes < 0 means unknown */
+static int	numa_num_nodes = -1;
+static int	numa_nodes[NUMA_MAX_NODES];
+
+/* node this process is bound to, or -1 */
+static int	numa_bound_node = -1;
+
+/* affinity before we bound the process, restored on unbind */
+static cpu_set_t numa_saved_cpus;
+
+static int	NumaReadList(const char *path, int *ids, int maxids);
+static bool NumaSetAffinity(cpu_set_t *cpus);
+
+
+/*
+ * NumaReadList
+ *
+ * Reads a sysfs list like "0-3,8,10-11" into ids, returns the number
+ * of ids read, or -1 if the file can't be read.
+ */
+static int
+NumaReadList(const char *path, int *ids, int maxids)
+{
+	FILE	   *fp;
+	char		buf[4096];
+	char	   *p;
+	int			n = 0;
+
+	fp = fopen(path, "r");
+	if (fp == NULL)
+		return -1;
+
+	if (fgets(buf, sizeof(buf), fp) == NULL)
+	{
+		fclose(fp);
+		return -1;
+	}
+	fclose(fp);
+
+	p = buf;
+	while (*p != '\0' && *p != '\n')
+	{
+		long		first;
+		long		last;
+		char	   *end;
+
+		first = strtol(p, &end, 10);
+		if (end == p)
+			break;
+		last = first;
+		p = end;
+
+		if (*p == '-')
+		{
+			p++;
+			last = strtol(p, &end, 10);
+			if (end == p)
+				break;
+			p = end;
+		}
+
+		for (; first <= last && n < maxids; first++)
+			ids[n++] = (int) first;
+
+		if (*p == ',')
+			p++;
+	}
+
+	return n;
+}
+
+/*
+ * NumaSetAffinity
+ *
+ * sched_setaffinity only moves the calling thread, so apply the mask to
+ * every thread of the process, including the interconnect threads which
+ * allocate the receive buffers.
+ */
+static bool
+NumaSetAffinity(cpu_set_t *cpus)
+{
+	DIR		   *dir;
+	struct dirent *de;
+	bool		ok = true;
+
+	if (sched_setaffinity(0, sizeof(cpu_set_t), cpus) < 0)
+		return false;
+
+	dir = opendir("/proc/self/task");
+	if (dir == NULL)
+		return true;
+
+	while ((de = readdir(dir)) != NULL)
+	{
+		pid_t		tid;
+
+		if (de->d_name[0] < '0' || de->d_name[0] > '9')
+			continue;
+
+		tid = (pid_t) atoi(de->d_name);
+		if (sched_setaffinity(tid, sizeof(cpu_set_t), cpus) < 0 && errno != ESRCH)
+			ok = false;
+	}
+	closedir(dir);
+
+	return ok;
+}
+
+#endif   /* HAVE_NUMA_BINDING */
+
+/*
+ * NumaBindQE
+ *
+ * Binds the process to the NUMA node of virtual segment qeIndex.  Rebinding
+ * to the node we are already on is a no-op, so this is cheap to call for
+ * every dispatched statement.  Nothing happens on hosts with a single node,
+ * and any failure leaves the process unbound; placement is only a
+ * performance hint.
+ */
+void
+NumaBindQE(int qeIndex)
+{
+#ifdef HAVE_NUMA_BINDING
+	char		path[MAXPGPATH];
+	int			cpuids[CPU_SETSIZE];
+	int			ncpus;
+	int			node;
+	int			i;
+	cpu_set_t	cpus;
+	unsigned long nodemask[NUMA_MAX_NODES / (8 * sizeof(unsigned long)) + 1];
+
+	if (!gp_enable_numa_affinity)
+	{
+		NumaUnbindQE();
+		return;
+	}
+
+	if (qeIndex < 0)
+		return;
+
+	if (numa_num_nodes < 0)
+	{
+		numa_num_nodes = NumaReadList(NUMA_SYSFS_PATH "/online",
+									  numa_nodes, NUMA_MAX_NODES);
+		if (numa_num_nodes < 0)
+			numa_num_nodes = 0;
+	}
+
+	if (numa_num_nodes < 2)
+		return;
+
+	node = numa_nodes[qeIndex % numa_num_nodes];
+	if (node == numa_bound_node)
+		return;
+
+	snprintf(path, sizeof(path), NUMA_SYSFS_PATH "/node%d/cpulist", node);
+	ncpus = NumaReadList(path, cpuids, CPU_SETSIZE);
+	if (ncpus <= 0)
+		return;
+
+	CPU_ZERO(&cpus);
+	for (i = 0; i < ncpus; i++)
+		CPU_SET(cpuids[i], &cpus);
+
+	if (numa_bound_node < 0 &&
+		sched_getaffinity(0, sizeof(cpu_set_t), &numa_saved_cpus) < 0)
+		return;
+
+	if (!NumaSetAffinity(&cpus))
+	{
+		elog(DEBUG1, "could not bind QE %d to NUMA node %d: %m", qeIndex, node);
+		if (numa_bound_node < 0)
+			NumaSetAffinity(&numa_saved_cpus);
+		else
+			NumaUnbindQE();
+		return;
+	}
+
+	/*
+	 * Prefer, rather than require, the node so we spill over to a remote one
+	 * instead of failing when the node runs out of memory.  The policy is per
+	 * thread; the other threads allocate locally by default, which is now
+	 * this node too.
+	 */
+	memset(nodemask, 0, sizeof(nodemask));
+	nodemask[node / (8 * sizeof(unsigned long))] |=
+		1UL << (node % (8 * sizeof(unsigned long)));
+	if (syscall(SYS_set_mempolicy, MPOL_PREFERRED, nodemask,
+				(unsigned long) NUMA_MAX_NODES + 1) < 0)
+		elog(DEBUG1, "could not set the preferred NUMA node to %d: %m", node);
+
+	elog(DEBUG1, "bound QE %d to NUMA node %d", qeIndex, node);
+	numa_bound_node = node;
+#endif
+}
+
+/*
+ * NumaUnbindQE
+ *
+ * Restores the affinity and memory policy the process had before
+ * NumaBindQE.
+ */
+void
+NumaUnbindQE(void)
+{
+#ifdef HAVE_NUMA_BINDING
+	if (numa_bound_node < 0)
+		return;
+
+	NumaSetAffinity(&numa_saved_cpus);
+	syscall(SYS_set_mempolicy, MPOL_DEFAULT, NULL, 0UL);
+	numa_bound_node = -1;
+#endif
+}
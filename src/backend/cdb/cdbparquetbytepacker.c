@@ -25,6 +25,11 @@
  */
 
 #include "postgres.h"
+
+#ifdef HAVE__GET_CPUID
+#include <cpuid.h>
+#endif
+
 #include "cdb/cdbparquetbytepacker.h"
 
 /* Currently these are Little Endian packer, which means
@@ -33,6 +38,8 @@ static void pack8Values1Bits(int32_t *in, int inPos, uint8_t* out, int outPos);
 static void pack8Values2Bits(int32_t *in, int inPos, uint8_t* out, int outPos);
 static void unpack8Values1Bits(uint8_t *in, int inPos, int32_t *out, int outPos);
 static void unpack8Values2Bits(uint8_t *in, int inPos, int32_t *out, int outPos);
+static void pack8ValuesAnyBits(int bitWidth, int32_t *in, int inPos, uint8_t* out, int outPos);
+static void unpack8ValuesAnyBits(int bitWidth, uint8_t *in, int inPos, int32_t *out, int outPos);
 
 #ifdef NOT_USED
 static void pack8Values3Bits(int32_t *in, int inPos, uint8_t* out, int outPos);
@@ -240,7 +247,8 @@ pack8Values(int bitWidth, int32_t *in, int inPos, uint8_t* out, int outPos)
 		break;
 #endif
 	default:
-		/*ereport error*/
+		Assert(bitWidth > 0 && bitWidth <= 32);
+		pack8ValuesAnyBits(bitWidth, in, inPos, out, outPos);
 		break;
 	}
 }
@@ -324,7 +332,8 @@ unpack8Values(int bitWidth, uint8_t *in, int inPos, int32_t *out, int outPos)
 		break;
 #endif
 	default:
-		/*ereport error*/
+		Assert(bitWidth > 0 && bitWidth <= 32);
+		unpack8ValuesAnyBits(bitWidth, in, inPos, out, outPos);
 		break;
 	}
 }
@@ -547,3 +556,185 @@ unpack8Values3Bits(uint8_t *in, int inPos, int32_t *out, int outPos)
         (((((int)in[ 2 + inPos]) & 255) >> 5) & 7);
 }
 #endif
+
+/*
+ * Pack 8 values of any bit width (up to 32), LSB first, for the widths
+ * without an unrolled packer above, e.g. the dictionary ids.
+ */
+void
+pack8ValuesAnyBits(int bitWidth, int32_t *in, int inPos, uint8_t* out, int outPos)
+{
+	uint64_t	mask = (((uint64_t) 1) << bitWidth) - 1;
+	uint64_t	buffer = 0;
+	int			bits = 0;
+
+	for (int i = 0; i < 8; i++)
+	{
+		buffer |= (((uint64_t) (uint32_t) in[i + inPos]) & mask) << bits;
+		bits += bitWidth;
+		while (bits >= 8)
+		{
+			out[outPos++] = (uint8_t) (buffer & 255);
+			buffer >>= 8;
+			bits -= 8;
+		}
+	}
+}
+
+/*
+ * Unpack 8 values of any bit width (up to 32), see pack8ValuesAnyBits.
+ */
+void
+unpack8ValuesAnyBits(int bitWidth, uint8_t *in, int inPos, int32_t *out, int outPos)
+{
+	uint64_t	mask = (((uint64_t) 1) << bitWidth) - 1;
+	uint64_t	buffer = 0;
+	int			bits = 0;
+
+	for (int i = 0; i < 8; i++)
+	{
+		while (bits < bitWidth)
+		{
+			buffer |= ((uint64_t) in[inPos++]) << bits;
+			bits += 8;
+		}
+		out[i + outPos] = (int32_t) (buffer & mask);
+		buffer >>= bitWidth;
+		bits -= bitWidth;
+	}
+}
+
+/*
+ * The scalar kernel of unpackGroups. The width is a constant in each of the
+ * unpackGroupsN functions below, so that the compiler unrolls the loop and
+ * the loads and shifts of each value are constants.
+ */
+static inline void
+unpackGroupsOfWidth(const int bitWidth, uint8_t *in, int32_t *out, int ngroups)
+{
+	const uint64_t mask = (((uint64_t) 1) << bitWidth) - 1;
+
+	for (int g = 0; g < ngroups; g++)
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			int			bit = i * bitWidth;
+			uint64_t	word = 0;
+
+			/* a value is in at most 5 bytes, all of them in its group */
+			memcpy(&word, in + (bit >> 3), ((bit & 7) + bitWidth + 7) >> 3);
+			out[i] = (int32_t) ((word >> (bit & 7)) & mask);
+		}
+		in += bitWidth;
+		out += 8;
+	}
+}
+
+#define UNPACK_GROUPS_KERNEL(w) \
+	static void \
+	unpackGroups##w(uint8_t *in, int32_t *out, int ngroups) \
+	{ \
+		unpackGroupsOfWidth(w, in, out, ngroups); \
+	}
+
+UNPACK_GROUPS_KERNEL(1)
+UNPACK_GROUPS_KERNEL(2)
+UNPACK_GROUPS_KERNEL(3)
+UNPACK_GROUPS_KERNEL(4)
+UNPACK_GROUPS_KERNEL(5)
+UNPACK_GROUPS_KERNEL(6)
+UNPACK_GROUPS_KERNEL(7)
+UNPACK_GROUPS_KERNEL(8)
+UNPACK_GROUPS_KERNEL(9)
+UNPACK_GROUPS_KERNEL(10)
+UNPACK_GROUPS_KERNEL(11)
+UNPACK_GROUPS_KERNEL(12)
+UNPACK_GROUPS_KERNEL(13)
+UNPACK_GROUPS_KERNEL(14)
+UNPACK_GROUPS_KERNEL(15)
+UNPACK_GROUPS_KERNEL(16)
+UNPACK_GROUPS_KERNEL(17)
+UNPACK_GROUPS_KERNEL(18)
+UNPACK_GROUPS_KERNEL(19)
+UNPACK_GROUPS_KERNEL(20)
+UNPACK_GROUPS_KERNEL(21)
+UNPACK_GROUPS_KERNEL(22)
+UNPACK_GROUPS_KERNEL(23)
+UNPACK_GROUPS_KERNEL(24)
+UNPACK_GROUPS_KERNEL(25)
+UNPACK_GROUPS_KERNEL(26)
+UNPACK_GROUPS_KERNEL(27)
+UNPACK_GROUPS_KERNEL(28)
+UNPACK_GROUPS_KERNEL(29)
+UNPACK_GROUPS_KERNEL(30)
+UNPACK_GROUPS_KERNEL(31)
+UNPACK_GROUPS_KERNEL(32)
+
+static void (*const unpackGroupsKernels[33]) (uint8_t *in, int32_t *out, int ngroups) = {
+	NULL,
+	unpackGroups1, unpackGroups2, unpackGroups3, unpackGroups4, unpackGroups5, unpackGroups6, unpackGroups7, unpackGroups8,
+	unpackGroups9, unpackGroups10, unpackGroups11, unpackGroups12, unpackGroups13, unpackGroups14, unpackGroups15, unpackGroups16,
+	unpackGroups17, unpackGroups18, unpackGroups19, unpackGroups20, unpackGroups21, unpackGroups22, unpackGroups23, unpackGroups24,
+	unpackGroups25, unpackGroups26, unpackGroups27, unpackGroups28, unpackGroups29, unpackGroups30, unpackGroups31, unpackGroups32
+};
+
+#if defined(__x86_64__) && defined(HAVE__GET_CPUID)
+
+static bool
+unpackAVX2Available(void)
+{
+	static int	available = -1;
+	unsigned int exx[4] = {0, 0, 0, 0};
+	unsigned int xcr0_lo;
+	unsigned int xcr0_hi;
+
+	if (available >= 0)
+		return available;
+
+	available = 0;
+
+	__get_cpuid(1, &exx[0], &exx[1], &exx[2], &exx[3]);
+	if ((exx[2] & (1 << 27)) == 0)		/* OSXSAVE */
+		return false;
+
+	/* the OS must save the ymm registers on context switch */
+	__asm__ __volatile__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+	if ((xcr0_lo & 0x6) != 0x6)
+		return false;
+
+	if (__get_cpuid_max(0, NULL) < 7)
+		return false;
+	__cpuid_count(7, 0, exx[0], exx[1], exx[2], exx[3]);
+
+	available = (exx[1] & (1 << 5)) != 0;	/* AVX2 */
+	return available;
+}
+
+#endif
+
+void
+unpackGroups(int bitWidth, uint8_t *in, int inputSize, int32_t *out, int ngroups)
+{
+	int			simdGroups = 0;
+
+	Assert(bitWidth > 0 && bitWidth <= 32);
+	Assert(ngroups * bitWidth <= inputSize);
+
+#if defined(__x86_64__) && defined(HAVE__GET_CPUID)
+	if (bitWidth <= UNPACK_AVX2_MAX_BIT_WIDTH && unpackAVX2Available())
+	{
+		/* the last value of a group is loaded 4 bytes from here */
+		int			lastLoadEnd = ((7 * bitWidth) >> 3) + 4;
+
+		if (inputSize >= lastLoadEnd)
+			simdGroups = Min(ngroups, (inputSize - lastLoadEnd) / bitWidth + 1);
+		if (simdGroups > 0)
+			unpackGroupsAVX2(bitWidth, in, out, simdGroups);
+	}
+#endif
+
+	if (simdGroups < ngroups)
+		unpackGroupsKernels[bitWidth](in + simdGroups * bitWidth,
+									  out + simdGroups * 8,
+									  ngroups - simdGroups);
+}
@@ -0,0 +1,69 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * cdbparquetbytepacker_avx2.c
+ *		AVX2 kernel of unpackGroups, one group of 8 values per iteration.
+ *
+ * Each lane loads the 4 bytes starting at the first byte of its value,
+ * shifts the value down and masks it, so the widths up to 25 bits are
+ * supported. This file must be compiled with -mavx2, and is only called
+ * when the cpu supports it.
+ */
+
+#include "postgres.h"
+#include "cdb/cdbparquetbytepacker.h"
+
+#if defined(__x86_64__)
+
+#include <immintrin.h>
+
+void
+unpackGroupsAVX2(int bitWidth, uint8_t *in, int32_t *out, int ngroups)
+{
+	int32_t		offsets[8];
+	int32_t		shifts[8];
+	__m256i		voffsets;
+	__m256i		vshifts;
+	__m256i		vmask;
+
+	Assert(bitWidth > 0 && bitWidth <= UNPACK_AVX2_MAX_BIT_WIDTH);
+
+	for (int i = 0; i < 8; i++)
+	{
+		offsets[i] = (i * bitWidth) >> 3;
+		shifts[i] = (i * bitWidth) & 7;
+	}
+	voffsets = _mm256_loadu_si256((const __m256i *) offsets);
+	vshifts = _mm256_loadu_si256((const __m256i *) shifts);
+	vmask = _mm256_set1_epi32((int32_t) ((1U << bitWidth) - 1));
+
+	for (int g = 0; g < ngroups; g++)
+	{
+		__m256i		v = _mm256_i32gather_epi32((const int *) in, voffsets, 1);
+
+		v = _mm256_and_si256(_mm256_srlv_epi32(v, vshifts), vmask);
+		_mm256_storeu_si256((__m256i *) out, v);
+
+		in += bitWidth;
+		out += 8;
+	}
+}
+
+#endif
@@ -33,15 +33,27 @@
 
 #include "snappy-c.h"
 #include "zlib.h"
+#include "lz4.h"
+#include "zstd.h"
 
 #define BUFFER_SCALE_FACTOR	1.2
 #define BUFFER_SIZE_LIMIT_BEFORE_SCALED ((Size) ((MaxAllocSize) * 1.0 / (BUFFER_SCALE_FACTOR))) 
 
 static void consume(ParquetColumnReader *columnReader);
+static bool readNextPage(ParquetColumnReader *columnReader);
+static void readLevelBlock(ParquetColumnReader *columnReader);
 static void readRepetitionAndDefinitionLevels(ParquetColumnReader *columnReader);
 static void decodeCurrentPage(ParquetColumnReader *columnReader);
+static void decompressPage(ParquetColumnReader *columnReader,
+						   ParquetPageHeader header, uint8_t *src, uint8_t *dst);
+static void readDictionaryPage(ParquetColumnReader *columnReader,
+							   ParquetPageHeader header, uint8_t *data);
+static void decodeDictionary(ParquetColumnReader *columnReader, int hawqTypeID);
+static Datum readDictionaryValue(ParquetColumnReader *columnReader, int hawqTypeID);
+static Datum readDeltaValues(ParquetColumnReader *columnReader, int64 *out, int n);
 
 static bool decodePlain(Datum *value, uint8_t **buffer, int hawqTypeID);
+static void skipPlain(uint8_t **buffer, int hawqTypeID);
 
 /* return size of PATH struct given number of points in it */
 static inline int get_path_size(int npts) { return offsetof(PATH, p[0]) + sizeof(Point) * npts; }
@@ -56,6 +68,13 @@ ParquetExecutorReadColumn(ParquetColumnReader *columnReader, File file)
 
 	int64 firstPageOffset = columnChunkMetadata->firstDataPage;
 
+	/* the dictionary page, if any, is right before the data pages */
+	if (columnChunkMetadata->dictionaryPageOffset > 0 &&
+		columnChunkMetadata->dictionaryPageOffset < firstPageOffset)
+	{
+		firstPageOffset = columnChunkMetadata->dictionaryPageOffset;
+	}
+
 	int64 columnChunkSize = columnChunkMetadata->totalSize;
 
 	if ( columnChunkSize > MaxAllocSize ) 
@@ -144,12 +163,10 @@ ParquetExecutorReadColumn(ParquetColumnReader *columnReader, File file)
 
 		buffer += header_size;
 
-		/*just process data page now*/
+		/*just process data page and dictionary page now*/
 		if(pageHeader->page_type != DATA_PAGE){
 			if(pageHeader->page_type == DICTIONARY_PAGE) {
-				ereport(ERROR, (errcode(ERRCODE_GP_INTERNAL_ERROR),
-								errmsg("HAWQ does not support dictionary page type resolver for Parquet format in column \'%s\' ",
-										columnChunkMetadata->colName)));
+				readDictionaryPage(columnReader, pageHeader, (uint8_t *) buffer);
 			}
 			buffer += pageHeader->compressed_page_size;
 			continue;
@@ -198,39 +215,87 @@ consume(ParquetColumnReader *columnReader)
 	/* make sure we have values to read in current page */
 	if (columnReader->currentPageValueRemained == 0)
 	{
-		if (columnReader->dataPageProcessed >= columnReader->dataPageNum)
+		if (!readNextPage(columnReader))
 		{
 			/* next r must be 0 when reached chunk end */
 			columnReader->repetitionLevel = 0;
 			return;
 		}
+	}
+
+	readRepetitionAndDefinitionLevels(columnReader);
+}
+
+/*
+ * Move to the next page of the chunk, return false at the end of the chunk.
+ */
+static bool
+readNextPage(ParquetColumnReader *columnReader)
+{
+	if (columnReader->dataPageProcessed >= columnReader->dataPageNum)
+		return false;
+
+	columnReader->currentPage = &columnReader->dataPages[columnReader->dataPageProcessed];
+	decodeCurrentPage(columnReader);
+
+	columnReader->currentPageValueRemained = columnReader->currentPage->header->num_values;
+	columnReader->dataPageProcessed++;
 
-		/* read next page */
-		columnReader->currentPage = &columnReader->dataPages[columnReader->dataPageProcessed];
-		decodeCurrentPage(columnReader);
+	columnReader->levelBlockSize = 0;
+	columnReader->levelBlockPos = 0;
+	return true;
+}
 
-		columnReader->currentPageValueRemained = columnReader->currentPage->header->num_values;
-		columnReader->dataPageProcessed++;
+/*
+ * Decode the next block of r/d levels of the current page.
+ */
+static void
+readLevelBlock(ParquetColumnReader *reader)
+{
+	ParquetDataPage page = reader->currentPage;
+	int n = Min(PARQUET_LEVEL_BLOCK_SIZE, reader->currentPageValueRemained);
+
+	if (page->repetition_level_reader &&
+		RLEDecoder_ReadInts(page->repetition_level_reader, reader->repetitionLevels, n) != n)
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERNAL_ERROR),
+				 errmsg("missing repetition levels in page %d of column \'%s\'",
+						reader->dataPageProcessed, reader->columnMetadata->colName)));
 	}
 
-	readRepetitionAndDefinitionLevels(columnReader);
+	if (page->definition_level_reader &&
+		RLEDecoder_ReadInts(page->definition_level_reader, reader->definitionLevels, n) != n)
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERNAL_ERROR),
+				 errmsg("missing definition levels in page %d of column \'%s\'",
+						reader->dataPageProcessed, reader->columnMetadata->colName)));
+	}
+
+	reader->levelBlockSize = n;
+	reader->levelBlockPos = 0;
 }
 
 static void
 readRepetitionAndDefinitionLevels(ParquetColumnReader *reader)
 {
+	if (reader->levelBlockPos == reader->levelBlockSize)
+	{
+		readLevelBlock(reader);
+	}
+
 	if (reader->currentPage->repetition_level_reader)
 	{
-		reader->repetitionLevel =
-			RLEDecoder_ReadInt(reader->currentPage->repetition_level_reader);
+		reader->repetitionLevel = reader->repetitionLevels[reader->levelBlockPos];
 	}
 
 	if (reader->currentPage->definition_level_reader)
 	{
-		reader->definitionLevel =
-			RLEDecoder_ReadInt(reader->currentPage->definition_level_reader);
+		reader->definitionLevel = reader->definitionLevels[reader->levelBlockPos];
 	}
 
+	reader->levelBlockPos++;
 	reader->currentPageValueRemained--;
 }
 
@@ -288,89 +353,8 @@ decodeCurrentPage(ParquetColumnReader *columnReader)
 			buf = (uint8_t *) columnReader->pageBuffer;
 		}
 
-		/*
-		 * call corresponding decompress routine
-		 */
-		switch (chunkmd->codec)
-		{
-			case SNAPPY:
-			{
-				size_t uncompressedLen;
-				if (snappy_uncompressed_length((char *) page->data,
-											   header->compressed_page_size,
-											   &uncompressedLen) != SNAPPY_OK)
-				{
-					ereport(ERROR,
-							(errcode(ERRCODE_GP_INTERNAL_ERROR),
-							 errmsg("invalid snappy compressed data for column %s, page number %d",
-									chunkmd->colName, columnReader->dataPageProcessed)));
-				}
-
-				Insist(uncompressedLen == header->uncompressed_page_size);
-
-				if (snappy_uncompress((char *) page->data,		header->compressed_page_size,
-									  (char *) buf,				&uncompressedLen) != SNAPPY_OK)
-				{
-					ereport(ERROR,
-							(errcode(ERRCODE_GP_INTERNAL_ERROR),
-							 errmsg("failed to decompress snappy data for column %s, page number %d, "
-									"uncompressed size %d, compressed size %d",
-									chunkmd->colName, columnReader->dataPageProcessed,
-									header->uncompressed_page_size, header->compressed_page_size)));
-				}
-				
-				page->data = buf;
-				break;
-			}
-			case GZIP:
-			{
-				int ret;
-				/* 15(default windowBits for deflate) + 16(ouput GZIP header/tailer) */
-				const int windowbits = 31;
-
-				z_stream stream;
-				stream.zalloc	= Z_NULL;
-				stream.zfree	= Z_NULL;
-				stream.opaque	= Z_NULL;
-				stream.avail_in	= header->compressed_page_size;
-				stream.next_in	= (Bytef *) page->data;
-				
-				ret = inflateInit2(&stream, windowbits);
-				if (ret != Z_OK)
-				{
-					ereport(ERROR,
-							(errcode(ERRCODE_GP_INTERNAL_ERROR),
-							 errmsg("zlib inflateInit2 failed: %s", stream.msg)));
-				}
-
-				size_t uncompressedLen = header->uncompressed_page_size;
-
-				stream.avail_out = uncompressedLen;
-				stream.next_out  = (Bytef *) buf;
-				ret = inflate(&stream, Z_FINISH);
-				if (ret != Z_STREAM_END)
-				{
-					ereport(ERROR,
-							(errcode(ERRCODE_GP_INTERNAL_ERROR),
-							 errmsg("zlib inflate failed: %s", stream.msg)));
-				
-				}
-				/* should fill all uncompressed_page_size bytes */
-				Assert(stream.avail_out == 0);
-
-				inflateEnd(&stream);
-
-				page->data = buf;
-				break;
-			}
-			case LZO:
-				/* TODO */
-				Insist(false);
-				break;
-			default:
-				Insist(false);
-				break;
-		}
+		decompressPage(columnReader, header, page->data, buf);
+		page->data = buf;
 	}
 
 	/*----------------------------------------------------------------
@@ -410,6 +394,42 @@ decodeCurrentPage(ParquetColumnReader *columnReader)
 				palloc0(sizeof(ByteBasedBitPackingDecoder));
 		BitPack_InitDecoder(page->bool_values_reader, buf, /*bitwidth=*/1);
 	}
+	else if (header->encoding == PLAIN_DICTIONARY)
+	{
+		/* dictionary ids = <1-byte bit width> + <RLE/bit-packed ids> */
+		int bit_width = *buf;
+		buf += 1;
+
+		if (columnReader->dictionaryData == NULL)
+		{
+			ereport(ERROR,
+					(errcode(ERRCODE_GP_INTERNAL_ERROR),
+					 errmsg("dictionary encoded page without dictionary page in column \'%s\'",
+							chunkmd->colName)));
+		}
+
+		page->dictionary_ids_reader = (RLEDecoder *) palloc0(sizeof(RLEDecoder));
+		RLEDecoder_Init(page->dictionary_ids_reader,
+						bit_width,
+						buf,
+						page->data + header->uncompressed_page_size - buf);
+	}
+	else if (header->encoding == DELTA_BINARY_PACKED)
+	{
+		if (chunkmd->type != INT32 && chunkmd->type != INT64)
+		{
+			ereport(ERROR,
+					(errcode(ERRCODE_GP_INTERNAL_ERROR),
+					 errmsg("delta encoded page in column \'%s\' of type %d",
+							chunkmd->colName, chunkmd->type)));
+		}
+
+		page->delta_values_reader = (DeltaDecoder *) palloc0(sizeof(DeltaDecoder));
+		DeltaDecoder_Init(page->delta_values_reader,
+						  chunkmd->type == INT64,
+						  buf,
+						  page->data + header->uncompressed_page_size - buf);
+	}
 	else
 	{
 		page->values_buffer = buf;
@@ -418,6 +438,256 @@ decodeCurrentPage(ParquetColumnReader *columnReader)
 	MemoryContextSwitchTo(oldContext);
 }
 
+/*
+ * Keep the dictionary page of the column chunk being read, decompressed in
+ * dictionaryBuffer if needed. The values are decoded by the first value
+ * read from the chunk, see decodeDictionary.
+ */
+static void
+readDictionaryPage(ParquetColumnReader *columnReader,
+				   ParquetPageHeader header, uint8_t *data)
+{
+	ColumnChunkMetadata_4C *chunkmd = columnReader->columnMetadata;
+
+	if (columnReader->dictionaryData != NULL)
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERNAL_ERROR),
+				 errmsg("more than one dictionary page in column \'%s\'",
+						chunkmd->colName)));
+	}
+
+	if (header->encoding != PLAIN && header->encoding != PLAIN_DICTIONARY)
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERNAL_ERROR),
+				 errmsg("HAWQ does not support dictionary page encoding %d in column \'%s\'",
+						header->encoding, chunkmd->colName)));
+	}
+
+	if (chunkmd->codec == UNCOMPRESSED)
+	{
+		columnReader->dictionaryData = data;
+	}
+	else
+	{
+		/* the dictionary is used by all the pages of the chunk, keep it apart */
+		if (columnReader->dictionaryBuffer == NULL)
+		{
+			columnReader->dictionaryBufferLen = header->uncompressed_page_size * BUFFER_SCALE_FACTOR;
+			columnReader->dictionaryBuffer = palloc0(columnReader->dictionaryBufferLen);
+		}
+		else if (columnReader->dictionaryBufferLen < header->uncompressed_page_size)
+		{
+			columnReader->dictionaryBufferLen = header->uncompressed_page_size * BUFFER_SCALE_FACTOR;
+			columnReader->dictionaryBuffer = repalloc(columnReader->dictionaryBuffer,
+													  columnReader->dictionaryBufferLen);
+		}
+
+		decompressPage(columnReader, header, data, (uint8_t *) columnReader->dictionaryBuffer);
+		columnReader->dictionaryData = (uint8_t *) columnReader->dictionaryBuffer;
+	}
+
+	columnReader->dictionaryNumValues = header->num_values;
+	columnReader->dictionaryDecoded = false;
+
+	pfree(header);
+}
+
+/*
+ * Decode the plain encoded values of the dictionary of the chunk being read
+ * into the dictionary array. The by-reference values point into the
+ * dictionary page data, which is kept until the chunk is finished.
+ */
+static void
+decodeDictionary(ParquetColumnReader *columnReader, int hawqTypeID)
+{
+	uint8_t *buf = columnReader->dictionaryData;
+	MemoryContext oldContext = MemoryContextSwitchTo(columnReader->memoryContext);
+
+	if (columnReader->dictionaryCapacity < columnReader->dictionaryNumValues)
+	{
+		if (columnReader->dictionary != NULL)
+			pfree(columnReader->dictionary);
+		columnReader->dictionaryCapacity = columnReader->dictionaryNumValues;
+		columnReader->dictionary = (Datum *) palloc(columnReader->dictionaryCapacity * sizeof(Datum));
+	}
+
+	for (int i = 0; i < columnReader->dictionaryNumValues; i++)
+	{
+		decodePlain(&columnReader->dictionary[i], &buf, hawqTypeID);
+	}
+	columnReader->dictionaryDecoded = true;
+
+	MemoryContextSwitchTo(oldContext);
+}
+
+/*
+ * Read the next dictionary id of the current page, return its value.
+ */
+static Datum
+readDictionaryValue(ParquetColumnReader *columnReader, int hawqTypeID)
+{
+	int id;
+
+	if (!columnReader->dictionaryDecoded)
+	{
+		decodeDictionary(columnReader, hawqTypeID);
+	}
+
+	id = RLEDecoder_ReadInt(columnReader->currentPage->dictionary_ids_reader);
+	if (id < 0 || id >= columnReader->dictionaryNumValues)
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERNAL_ERROR),
+				 errmsg("invalid dictionary id %d in column \'%s\', the dictionary has %d values",
+						id, columnReader->columnMetadata->colName,
+						columnReader->dictionaryNumValues)));
+	}
+
+	return columnReader->dictionary[id];
+}
+
+/*
+ * Read the next n delta encoded values of the current page into out, return
+ * the first one. The INT32 values are sign extended, as their Datum.
+ */
+static Datum
+readDeltaValues(ParquetColumnReader *columnReader, int64 *out, int n)
+{
+	if (DeltaDecoder_ReadValues(columnReader->currentPage->delta_values_reader, out, n) != n)
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERNAL_ERROR),
+				 errmsg("missing delta encoded values in page %d of column \'%s\'",
+						columnReader->dataPageProcessed,
+						columnReader->columnMetadata->colName)));
+	}
+
+	return (Datum) out[0];
+}
+
+/*
+ * Decompress the page data at `src` into `dst`, which should be large
+ * enough for uncompressed_page_size bytes.
+ */
+static void
+decompressPage(ParquetColumnReader *columnReader,
+			   ParquetPageHeader header, uint8_t *src, uint8_t *dst)
+{
+	ColumnChunkMetadata_4C *chunkmd = columnReader->columnMetadata;
+
+	switch (chunkmd->codec)
+	{
+		case SNAPPY:
+		{
+			size_t uncompressedLen;
+			if (snappy_uncompressed_length((char *) src,
+										   header->compressed_page_size,
+										   &uncompressedLen) != SNAPPY_OK)
+			{
+				ereport(ERROR,
+						(errcode(ERRCODE_GP_INTERNAL_ERROR),
+						 errmsg("invalid snappy compressed data for column %s, page number %d",
+								chunkmd->colName, columnReader->dataPageProcessed)));
+			}
+
+			Insist(uncompressedLen == header->uncompressed_page_size);
+
+			if (snappy_uncompress((char *) src,		header->compressed_page_size,
+								  (char *) dst,				&uncompressedLen) != SNAPPY_OK)
+			{
+				ereport(ERROR,
+						(errcode(ERRCODE_GP_INTERNAL_ERROR),
+						 errmsg("failed to decompress snappy data for column %s, page number %d, "
+								"uncompressed size %d, compressed size %d",
+								chunkmd->colName, columnReader->dataPageProcessed,
+								header->uncompressed_page_size, header->compressed_page_size)));
+			}
+			break;
+		}
+		case GZIP:
+		{
+			int ret;
+			/* 15(default windowBits for deflate) + 16(ouput GZIP header/tailer) */
+			const int windowbits = 31;
+
+			z_stream stream;
+			stream.zalloc	= Z_NULL;
+			stream.zfree	= Z_NULL;
+			stream.opaque	= Z_NULL;
+			stream.avail_in	= header->compressed_page_size;
+			stream.next_in	= (Bytef *) src;
+			
+			ret = inflateInit2(&stream, windowbits);
+			if (ret != Z_OK)
+			{
+				ereport(ERROR,
+						(errcode(ERRCODE_GP_INTERNAL_ERROR),
+						 errmsg("zlib inflateInit2 failed: %s", stream.msg)));
+			}
+
+			size_t uncompressedLen = header->uncompressed_page_size;
+
+			stream.avail_out = uncompressedLen;
+			stream.next_out  = (Bytef *) dst;
+			ret = inflate(&stream, Z_FINISH);
+			if (ret != Z_STREAM_END)
+			{
+				ereport(ERROR,
+						(errcode(ERRCODE_GP_INTERNAL_ERROR),
+						 errmsg("zlib inflate failed: %s", stream.msg)));
+			
+			}
+			/* should fill all uncompressed_page_size bytes */
+			Assert(stream.avail_out == 0);
+
+			inflateEnd(&stream);
+
+			break;
+		}
+		case LZ4_RAW:
+		{
+			int ret = LZ4_decompress_safe((char *) src, (char *) dst,
+										  header->compressed_page_size,
+										  header->uncompressed_page_size);
+			if (ret != header->uncompressed_page_size)
+			{
+				ereport(ERROR,
+						(errcode(ERRCODE_GP_INTERNAL_ERROR),
+						 errmsg("failed to decompress lz4 data for column %s, page number %d, "
+								"uncompressed size %d, compressed size %d",
+								chunkmd->colName, columnReader->dataPageProcessed,
+								header->uncompressed_page_size, header->compressed_page_size)));
+			}
+			break;
+		}
+		case ZSTD:
+		{
+			size_t ret = ZSTD_decompress(dst, header->uncompressed_page_size,
+										 src, header->compressed_page_size);
+			if (ZSTD_isError(ret) || ret != header->uncompressed_page_size)
+			{
+				ereport(ERROR,
+						(errcode(ERRCODE_GP_INTERNAL_ERROR),
+						 errmsg("failed to decompress zstd data for column %s, page number %d, "
+								"uncompressed size %d, compressed size %d: %s",
+								chunkmd->colName, columnReader->dataPageProcessed,
+								header->uncompressed_page_size, header->compressed_page_size,
+								ZSTD_isError(ret) ? ZSTD_getErrorName(ret) : "size mismatch")));
+			}
+			break;
+		}
+		case LZO:
+			/* TODO */
+			Insist(false);
+			break;
+		default:
+			Insist(false);
+			break;
+	}
+}
+
 /**
  * Read the value from a certain columnReader, the value will be embedded in value,
  * and if the value is null, the null field should be true
@@ -454,6 +724,14 @@ ParquetColumnReader_readValue(
 		{
 			*value = BoolGetDatum((bool) BitPack_ReadInt(columnReader->currentPage->bool_values_reader));
 		}
+		else if (columnReader->currentPage->dictionary_ids_reader != NULL)
+		{
+			*value = readDictionaryValue(columnReader, hawqTypeID);
+		}
+		else if (columnReader->currentPage->delta_values_reader != NULL)
+		{
+			*value = readDeltaValues(columnReader, columnReader->deltaValues, 1);
+		}
 		else
 		{
 			decodePlain(value, &(columnReader->currentPage->values_buffer), hawqTypeID);
@@ -469,6 +747,201 @@ ParquetColumnReader_readValue(
 	}
 }
 
+/**
+ * Read the next nvalues values of a certain columnReader, as that many calls
+ * of ParquetColumnReader_readValue would.
+ *
+ * For non-repeatable column, the definition levels and the dictionary ids
+ * are decoded a block at a time and the values of a block are decoded in a
+ * loop of their own.
+ */
+void
+ParquetColumnReader_readValues(
+		ParquetColumnReader *columnReader,
+		Datum *values,
+		bool *nulls,
+		int nvalues,
+		int hawqTypeID)
+{
+	int d = columnReader->columnMetadata->d;
+	int i = 0;
+
+	if (columnReader->columnMetadata->r > 0)
+	{
+		for (i = 0; i < nvalues; i++)
+			ParquetColumnReader_readValue(columnReader, values + i, nulls + i, hawqTypeID);
+		return;
+	}
+
+	while (i < nvalues)
+	{
+		ParquetDataPage page;
+		int		n;
+		int		nnotnull = 0;
+
+		if (columnReader->currentPageValueRemained == 0 &&
+			!readNextPage(columnReader))
+		{
+			break;
+		}
+		if (columnReader->levelBlockPos == columnReader->levelBlockSize)
+		{
+			readLevelBlock(columnReader);
+		}
+
+		page = columnReader->currentPage;
+		n = Min(nvalues - i, columnReader->levelBlockSize - columnReader->levelBlockPos);
+
+		/* current definition level is used to determine null value */
+		if (page->definition_level_reader)
+		{
+			int32 *levels = columnReader->definitionLevels + columnReader->levelBlockPos;
+
+			for (int k = 0; k < n; k++)
+			{
+				nulls[i + k] = levels[k] < d;
+				nnotnull += !nulls[i + k];
+			}
+			columnReader->definitionLevel = levels[n - 1];
+		}
+		else
+		{
+			memset(nulls + i, false, n * sizeof(bool));
+			nnotnull = n;
+		}
+
+		if (hawqTypeID == HAWQ_TYPE_BOOL)
+		{
+			for (int k = 0; k < n; k++)
+				if (!nulls[i + k])
+					values[i + k] = BoolGetDatum((bool) BitPack_ReadInt(page->bool_values_reader));
+		}
+		else if (page->dictionary_ids_reader != NULL)
+		{
+			int32 *ids = columnReader->dictionaryIds;
+			int j = 0;
+
+			if (!columnReader->dictionaryDecoded)
+			{
+				decodeDictionary(columnReader, hawqTypeID);
+			}
+
+			if (RLEDecoder_ReadInts(page->dictionary_ids_reader, ids, nnotnull) != nnotnull)
+			{
+				ereport(ERROR,
+						(errcode(ERRCODE_GP_INTERNAL_ERROR),
+						 errmsg("missing dictionary ids in page %d of column \'%s\'",
+								columnReader->dataPageProcessed,
+								columnReader->columnMetadata->colName)));
+			}
+
+			for (int k = 0; k < n; k++)
+			{
+				if (nulls[i + k])
+					continue;
+
+				if ((uint32) ids[j] >= (uint32) columnReader->dictionaryNumValues)
+				{
+					ereport(ERROR,
+							(errcode(ERRCODE_GP_INTERNAL_ERROR),
+							 errmsg("invalid dictionary id %d in column \'%s\', the dictionary has %d values",
+									ids[j], columnReader->columnMetadata->colName,
+									columnReader->dictionaryNumValues)));
+				}
+				values[i + k] = columnReader->dictionary[ids[j++]];
+			}
+		}
+		else if (page->delta_values_reader != NULL)
+		{
+			int64 *deltaValues = columnReader->deltaValues;
+			int j = 0;
+
+			readDeltaValues(columnReader, deltaValues, nnotnull);
+
+			for (int k = 0; k < n; k++)
+				if (!nulls[i + k])
+					values[i + k] = (Datum) deltaValues[j++];
+		}
+		else
+		{
+			for (int k = 0; k < n; k++)
+				if (!nulls[i + k])
+					decodePlain(values + i + k, &(page->values_buffer), hawqTypeID);
+		}
+
+		columnReader->levelBlockPos += n;
+		columnReader->currentPageValueRemained -= n;
+		i += n;
+	}
+}
+
+/**
+ * Skip the next nvalues values of a certain columnReader without returning them.
+ *
+ * For non-repeatable column, pages whose values are all skipped are neither
+ * decompressed nor decoded, the rest of the values are passed over by their
+ * r/d levels and plain length only.
+ */
+void
+ParquetColumnReader_skipValues(
+		ParquetColumnReader *columnReader,
+		int nvalues,
+		int hawqTypeID)
+{
+	if (columnReader->columnMetadata->r > 0)
+	{
+		Datum	value;
+		bool	null;
+
+		/* values of one record may span pages, read them one by one */
+		while (nvalues-- > 0)
+			ParquetColumnReader_readValue(columnReader, &value, &null, hawqTypeID);
+		return;
+	}
+
+	while (nvalues > 0)
+	{
+		if (columnReader->currentPageValueRemained == 0)
+		{
+			ParquetDataPage page;
+
+			if (columnReader->dataPageProcessed >= columnReader->dataPageNum)
+				break;
+
+			/* the whole next page is skipped, leave it compressed */
+			page = &columnReader->dataPages[columnReader->dataPageProcessed];
+			if (page->header->num_values <= nvalues)
+			{
+				nvalues -= page->header->num_values;
+				columnReader->dataPageProcessed++;
+				continue;
+			}
+		}
+		else if (columnReader->currentPageValueRemained <= nvalues)
+		{
+			/* the rest of the current page is skipped, next consume() moves on */
+			nvalues -= columnReader->currentPageValueRemained;
+			columnReader->currentPageValueRemained = 0;
+			continue;
+		}
+
+		consume(columnReader);
+
+		if (CurrentDefinitionLevel(columnReader) >= columnReader->columnMetadata->d)
+		{
+			if (hawqTypeID == HAWQ_TYPE_BOOL)
+				BitPack_ReadInt(columnReader->currentPage->bool_values_reader);
+			else if (columnReader->currentPage->dictionary_ids_reader != NULL)
+				RLEDecoder_ReadInt(columnReader->currentPage->dictionary_ids_reader);
+			else if (columnReader->currentPage->delta_values_reader != NULL)
+				readDeltaValues(columnReader, columnReader->deltaValues, 1);
+			else
+				skipPlain(&(columnReader->currentPage->values_buffer), hawqTypeID);
+		}
+		nvalues--;
+	}
+}
+
 static bool
 decodePlain(Datum *value, uint8_t **buffer, int hawqTypeID)
 {
@@ -602,6 +1075,62 @@ decodePlain(Datum *value, uint8_t **buffer, int hawqTypeID)
 }
 
 
+/*
+ * Move the buffer past a plain encoded value, see decodePlain for the layout
+ * of each type.
+ */
+static void
+skipPlain(uint8_t **buffer, int hawqTypeID)
+{
+	switch(hawqTypeID)
+	{
+		case HAWQ_TYPE_INT2:
+		case HAWQ_TYPE_INT4:
+		case HAWQ_TYPE_DATE:
+		case HAWQ_TYPE_FLOAT4:
+			(*buffer) += 4;
+			break;
+
+		case HAWQ_TYPE_MONEY:
+		case HAWQ_TYPE_INT8:
+		case HAWQ_TYPE_TIME:
+		case HAWQ_TYPE_TIMESTAMPTZ:
+		case HAWQ_TYPE_TIMESTAMP:
+		case HAWQ_TYPE_FLOAT8:
+			(*buffer) += 8;
+			break;
+
+		case HAWQ_TYPE_MACADDR:
+			(*buffer) += 4 + 6 * sizeof(char);
+			break;
+
+		/* BINARY = [length, data] */
+		case HAWQ_TYPE_NAME:
+		case HAWQ_TYPE_TIMETZ:
+		case HAWQ_TYPE_INTERVAL:
+		case HAWQ_TYPE_BYTE:
+		case HAWQ_TYPE_CHAR:
+		case HAWQ_TYPE_BPCHAR:
+		case HAWQ_TYPE_VARCHAR:
+		case HAWQ_TYPE_TEXT:
+		case HAWQ_TYPE_XML:
+		case HAWQ_TYPE_BIT:
+		case HAWQ_TYPE_VARBIT:
+		case HAWQ_TYPE_NUMERIC:
+		case HAWQ_TYPE_INET:
+		case HAWQ_TYPE_CIDR:
+		{
+			int datalen = /*le32toh(*/*((int32_t*)(*buffer))/*)*/;
+			(*buffer) += 4 + datalen;
+			break;
+		}
+
+		default:
+			Insist(false);
+			break;
+	}
+}
+
 /**
  * finish scan current column, free and reset column reader part
  */
@@ -633,6 +1162,17 @@ ParquetColumnReader_FinishedScanColumn(
 			pfree(page->bool_values_reader);
 		}
 
+		if (page->dictionary_ids_reader != NULL)
+		{
+			pfree(page->dictionary_ids_reader);
+		}
+
+		if (page->delta_values_reader != NULL)
+		{
+			DeltaDecoder_Free(page->delta_values_reader);
+			pfree(page->delta_values_reader);
+		}
+
 		/*
 		 * compressed repeatable column keeps each page's decompressed
 		 * content in page->data, which should be freed.
@@ -661,10 +1201,17 @@ ParquetColumnReader_FinishedScanColumn(
 		columnReader->geoval = NULL;
 	}
 
+	/* the dictionary data is in dataBuffer or dictionaryBuffer, both reused */
+	columnReader->dictionaryData = NULL;
+	columnReader->dictionaryNumValues = 0;
+	columnReader->dictionaryDecoded = false;
+
 	MemoryContextSwitchTo(oldContext);
 
 	columnReader->dataPageProcessed = 0;
 	columnReader->currentPageValueRemained = 0;
+	columnReader->levelBlockSize = 0;
+	columnReader->levelBlockPos = 0;
 }
 
 /*----------------------------------------------------------------
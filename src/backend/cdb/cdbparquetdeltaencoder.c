@@ -0,0 +1,507 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * cdbparquetdeltaencoder.c
+ *
+ *  Created on: Oct 14, 2026
+ */
+
+#include "postgres.h"
+
+#include <limits.h>
+
+#include "cdb/cdbparquetdeltaencoder.h"
+#include "cdb/cdbparquetbytepacker.h"
+
+#define DELTA_INIT_CAPACITY 1024
+
+/* the largest miniblock accepted from the writers of other systems */
+#define DELTA_MAX_MINIBLOCK_SIZE 8192
+
+static void writeBlock(DeltaEncoder *encoder);
+static int	writeUnsignedVarLong(uint8_t *out, uint64 value);
+static void packValues(int bitWidth, uint64 *in, int n, uint8_t *out);
+
+static void readBlockHeader(DeltaDecoder *decoder);
+static void readMiniblock(DeltaDecoder *decoder);
+static uint64 readUnsignedVarLong(DeltaDecoder *decoder);
+static void unpackValues(int bitWidth, uint8_t *in, int64 *out, int n);
+
+static inline uint64
+zigzagEncode(int64 value)
+{
+	return (((uint64) value) << 1) ^ (uint64) (value >> 63);
+}
+
+static inline int64
+zigzagDecode(uint64 value)
+{
+	return (int64) ((value >> 1) ^ (~(value & 1) + 1));
+}
+
+void
+DeltaEncoder_Init(DeltaEncoder *encoder, bool is64)
+{
+	encoder->is64			= is64;
+	encoder->totalCount		= 0;
+	encoder->firstValue		= 0;
+	encoder->previousValue	= 0;
+	encoder->numDeltas		= 0;
+	encoder->headerPos		= -1;
+
+	CapacityByteWriter_Init(&encoder->writer, /* capacity= */DELTA_INIT_CAPACITY);
+	encoder->writer.bufferPos = DELTA_HEADER_MAX_SIZE;
+}
+
+void
+DeltaEncoder_WriteValue(DeltaEncoder *encoder, int64 value)
+{
+	Assert(encoder->headerPos < 0);
+
+	if (encoder->totalCount == 0)
+	{
+		encoder->firstValue = value;
+	}
+	else if (encoder->is64)
+	{
+		encoder->deltas[encoder->numDeltas++] =
+				(int64) ((uint64) value - (uint64) encoder->previousValue);
+	}
+	else
+	{
+		encoder->deltas[encoder->numDeltas++] =
+				(int32) ((uint32) value - (uint32) encoder->previousValue);
+	}
+
+	encoder->previousValue = value;
+	encoder->totalCount++;
+
+	if (encoder->numDeltas == DELTA_BLOCK_SIZE)
+		writeBlock(encoder);
+}
+
+/*
+ * Write the pending deltas as a block: the min delta, the bit widths of the
+ * miniblocks and the miniblocks that have deltas. A miniblock is padded with
+ * zeros to DELTA_MINIBLOCK_SIZE values.
+ */
+static void
+writeBlock(DeltaEncoder *encoder)
+{
+	uint8_t		header[10 + DELTA_MINIBLOCK_COUNT];
+	uint8_t		packed[DELTA_MINIBLOCK_SIZE * 8];
+	uint64		values[DELTA_MINIBLOCK_SIZE];
+	uint8_t	   *bitWidths;
+	int64		minDelta;
+	int			len;
+
+	if (encoder->numDeltas == 0)
+		return;
+
+	minDelta = encoder->deltas[0];
+	for (int i = 1; i < encoder->numDeltas; i++)
+		minDelta = Min(minDelta, encoder->deltas[i]);
+
+	len = writeUnsignedVarLong(header, zigzagEncode(minDelta));
+	bitWidths = header + len;
+	len += DELTA_MINIBLOCK_COUNT;
+
+	for (int m = 0; m < DELTA_MINIBLOCK_COUNT; m++)
+	{
+		int		start = m * DELTA_MINIBLOCK_SIZE;
+		int		end = Min(start + DELTA_MINIBLOCK_SIZE, encoder->numDeltas);
+		uint64	bits = 0;
+
+		for (int i = start; i < end; i++)
+		{
+			uint64 v = (uint64) encoder->deltas[i] - (uint64) minDelta;
+
+			if (!encoder->is64)
+				v = (uint32) v;
+			bits |= v;
+		}
+
+		bitWidths[m] = 0;
+		while (bits != 0)
+		{
+			bitWidths[m]++;
+			bits >>= 1;
+		}
+	}
+
+	CapacityByteWriter_WriteMany(&encoder->writer, header, 0, len);
+
+	for (int m = 0; m * DELTA_MINIBLOCK_SIZE < encoder->numDeltas; m++)
+	{
+		int		start = m * DELTA_MINIBLOCK_SIZE;
+		int		end = Min(start + DELTA_MINIBLOCK_SIZE, encoder->numDeltas);
+
+		if (bitWidths[m] == 0)
+			continue;
+
+		MemSet(values, 0, sizeof(values));
+		for (int i = start; i < end; i++)
+		{
+			values[i - start] = (uint64) encoder->deltas[i] - (uint64) minDelta;
+			if (!encoder->is64)
+				values[i - start] = (uint32) values[i - start];
+		}
+
+		packValues(bitWidths[m], values, DELTA_MINIBLOCK_SIZE, packed);
+		CapacityByteWriter_WriteMany(&encoder->writer, packed, 0,
+									 DELTA_MINIBLOCK_SIZE / 8 * bitWidths[m]);
+	}
+
+	encoder->numDeltas = 0;
+}
+
+int
+DeltaEncoder_Flush(DeltaEncoder *encoder)
+{
+	uint8_t		header[DELTA_HEADER_MAX_SIZE];
+	int			len = 0;
+
+	if (encoder->headerPos >= 0)
+		return DeltaEncoder_Size(encoder);
+
+	writeBlock(encoder);
+
+	len += writeUnsignedVarLong(header + len, DELTA_BLOCK_SIZE);
+	len += writeUnsignedVarLong(header + len, DELTA_MINIBLOCK_COUNT);
+	len += writeUnsignedVarLong(header + len, encoder->totalCount);
+	len += writeUnsignedVarLong(header + len, zigzagEncode(encoder->firstValue));
+	Assert(len <= DELTA_HEADER_MAX_SIZE);
+
+	/* the header ends where the first block begins */
+	encoder->headerPos = DELTA_HEADER_MAX_SIZE - len;
+	memcpy(encoder->writer.buffer + encoder->headerPos, header, len);
+
+	return DeltaEncoder_Size(encoder);
+}
+
+uint8_t *
+DeltaEncoder_Data(DeltaEncoder *encoder)
+{
+	Assert(encoder->headerPos >= 0);
+
+	return encoder->writer.buffer + encoder->headerPos;
+}
+
+int
+DeltaEncoder_Size(DeltaEncoder *encoder)
+{
+	int			pending;
+
+	if (encoder->headerPos >= 0)
+		return encoder->writer.bufferPos - encoder->headerPos;
+
+	/* the block of the pending deltas takes at most 8 bytes per delta */
+	pending = encoder->numDeltas == 0 ? 0 :
+		10 + DELTA_MINIBLOCK_COUNT +
+		(encoder->is64 ? 8 : 4) * TYPEALIGN(DELTA_MINIBLOCK_SIZE, encoder->numDeltas);
+
+	return encoder->writer.bufferPos + pending;
+}
+
+void
+DeltaEncoder_Free(DeltaEncoder *encoder)
+{
+	pfree(encoder->writer.buffer);
+}
+
+static int
+writeUnsignedVarLong(uint8_t *out, uint64 value)
+{
+	int			len = 0;
+
+	while (value >= 0x80)
+	{
+		out[len++] = (uint8_t) (value | 0x80);
+		value >>= 7;
+	}
+	out[len++] = (uint8_t) value;
+
+	return len;
+}
+
+/*
+ * Bit pack n values, a multiple of 8, of bitWidth bits each from LSB to MSB.
+ */
+static void
+packValues(int bitWidth, uint64 *in, int n, uint8_t *out)
+{
+	int			bytes = n / 8 * bitWidth;
+	int			bit = 0;
+
+	Assert(n % 8 == 0);
+	MemSet(out, 0, bytes);
+
+	for (int i = 0; i < n; i++)
+	{
+		uint64	v = in[i];
+		int		left = bitWidth;
+
+		while (left > 0)
+		{
+			int		shift = bit & 7;
+			int		nbits = Min(8 - shift, left);
+
+			out[bit >> 3] |= (uint8_t) ((v & ((1 << nbits) - 1)) << shift);
+			v >>= nbits;
+			bit += nbits;
+			left -= nbits;
+		}
+	}
+}
+
+void
+DeltaDecoder_Init(DeltaDecoder *decoder, bool is64, uint8_t *in, int inputSize)
+{
+	int64		totalCount;
+
+	decoder->is64 = is64;
+	decoder->input = in;
+	decoder->inputPos = 0;
+	decoder->inputSize = inputSize;
+
+	decoder->blockSize = (int) readUnsignedVarLong(decoder);
+	decoder->miniblockCount = (int) readUnsignedVarLong(decoder);
+	totalCount = (int64) readUnsignedVarLong(decoder);
+	decoder->firstValue = zigzagDecode(readUnsignedVarLong(decoder));
+
+	if (decoder->blockSize <= 0 || decoder->blockSize % 128 != 0 ||
+		decoder->miniblockCount <= 0 ||
+		decoder->blockSize % decoder->miniblockCount != 0 ||
+		(decoder->blockSize / decoder->miniblockCount) % 32 != 0 ||
+		decoder->blockSize / decoder->miniblockCount > DELTA_MAX_MINIBLOCK_SIZE ||
+		totalCount < 0 || totalCount > INT_MAX)
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERNAL_ERROR),
+				 errmsg("invalid DELTA_BINARY_PACKED header: block size %d, %d miniblocks, %ld values",
+						decoder->blockSize, decoder->miniblockCount, (long) totalCount)));
+	}
+
+	decoder->miniblockSize = decoder->blockSize / decoder->miniblockCount;
+	decoder->valuesRemained = (int) totalCount;
+	decoder->firstValueRead = false;
+	decoder->deltasRemained = Max(decoder->valuesRemained - 1, 0);
+
+	decoder->minDelta = 0;
+	decoder->bitWidths = NULL;
+	decoder->miniblockIndex = decoder->miniblockCount;
+
+	decoder->previousValue = decoder->firstValue;
+	decoder->miniblockValues = (int64 *) palloc(decoder->miniblockSize * sizeof(int64));
+	decoder->packedValues = (int32_t *) palloc(decoder->miniblockSize * sizeof(int32_t));
+	decoder->miniblockValuesSize = 0;
+	decoder->miniblockValuesPos = 0;
+}
+
+int
+DeltaDecoder_ReadValues(DeltaDecoder *decoder, int64 *out, int n)
+{
+	int			i = 0;
+
+	n = Min(n, decoder->valuesRemained);
+
+	if (n > 0 && !decoder->firstValueRead)
+	{
+		out[i++] = decoder->firstValue;
+		decoder->firstValueRead = true;
+	}
+
+	while (i < n)
+	{
+		int			k;
+
+		if (decoder->miniblockValuesPos == decoder->miniblockValuesSize)
+			readMiniblock(decoder);
+
+		k = Min(n - i, decoder->miniblockValuesSize - decoder->miniblockValuesPos);
+		memcpy(out + i, decoder->miniblockValues + decoder->miniblockValuesPos, k * sizeof(int64));
+		decoder->miniblockValuesPos += k;
+		i += k;
+	}
+
+	decoder->valuesRemained -= n;
+	return n;
+}
+
+void
+DeltaDecoder_Free(DeltaDecoder *decoder)
+{
+	pfree(decoder->miniblockValues);
+	pfree(decoder->packedValues);
+}
+
+/*
+ * Read the min delta and the bit widths of the next block.
+ */
+static void
+readBlockHeader(DeltaDecoder *decoder)
+{
+	decoder->minDelta = zigzagDecode(readUnsignedVarLong(decoder));
+
+	if (decoder->inputPos + decoder->miniblockCount > decoder->inputSize)
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERNAL_ERROR),
+				 errmsg("DELTA_BINARY_PACKED data ends in a block header")));
+	}
+	decoder->bitWidths = decoder->input + decoder->inputPos;
+	decoder->inputPos += decoder->miniblockCount;
+	decoder->miniblockIndex = 0;
+}
+
+/*
+ * Unpack the deltas of the next miniblock and sum them up into its values.
+ * The padding of the last miniblock is not unpacked, nor required in the
+ * input.
+ */
+static void
+readMiniblock(DeltaDecoder *decoder)
+{
+	int			bitWidth;
+	int			n;
+	int			packedSize;
+	int64	   *values = decoder->miniblockValues;
+
+	if (decoder->deltasRemained == 0)
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERNAL_ERROR),
+				 errmsg("DELTA_BINARY_PACKED data has fewer values than its header")));
+	}
+
+	if (decoder->miniblockIndex == decoder->miniblockCount)
+		readBlockHeader(decoder);
+
+	bitWidth = decoder->bitWidths[decoder->miniblockIndex++];
+	n = Min(decoder->miniblockSize, decoder->deltasRemained);
+	packedSize = (n + 7) / 8 * bitWidth;
+
+	if (bitWidth > (decoder->is64 ? 64 : 32) ||
+		decoder->inputPos + packedSize > decoder->inputSize)
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERNAL_ERROR),
+				 errmsg("invalid DELTA_BINARY_PACKED miniblock of bit width %d", bitWidth)));
+	}
+
+	if (bitWidth == 0)
+	{
+		MemSet(values, 0, n * sizeof(int64));
+	}
+	else if (bitWidth <= 32)
+	{
+		int32_t	   *packed = decoder->packedValues;
+
+		unpackGroups(bitWidth, decoder->input + decoder->inputPos, packedSize,
+					 packed, (n + 7) / 8);
+		for (int i = 0; i < n; i++)
+			values[i] = (int64) (uint32) packed[i];
+	}
+	else
+	{
+		unpackValues(bitWidth, decoder->input + decoder->inputPos, values, n);
+	}
+
+	/* the bytes of a miniblock are those of all its values, padding included */
+	decoder->inputPos = Min(decoder->inputPos + decoder->miniblockSize / 8 * bitWidth,
+							decoder->inputSize);
+
+	if (decoder->is64)
+	{
+		uint64		v = (uint64) decoder->previousValue;
+
+		for (int i = 0; i < n; i++)
+		{
+			v += (uint64) decoder->minDelta + (uint64) values[i];
+			values[i] = (int64) v;
+		}
+	}
+	else
+	{
+		uint32		v = (uint32) decoder->previousValue;
+
+		for (int i = 0; i < n; i++)
+		{
+			v += (uint32) decoder->minDelta + (uint32) values[i];
+			values[i] = (int32) v;
+		}
+	}
+
+	decoder->previousValue = values[n - 1];
+	decoder->deltasRemained -= n;
+	decoder->miniblockValuesSize = n;
+	decoder->miniblockValuesPos = 0;
+}
+
+static uint64
+readUnsignedVarLong(DeltaDecoder *decoder)
+{
+	uint64		value = 0;
+	int			shift = 0;
+
+	for (;;)
+	{
+		uint8_t		b;
+
+		if (decoder->inputPos >= decoder->inputSize || shift > 63)
+		{
+			ereport(ERROR,
+					(errcode(ERRCODE_GP_INTERNAL_ERROR),
+					 errmsg("invalid varint in DELTA_BINARY_PACKED data")));
+		}
+
+		b = decoder->input[decoder->inputPos++];
+		value |= ((uint64) (b & 0x7F)) << shift;
+		if ((b & 0x80) == 0)
+			return value;
+		shift += 7;
+	}
+}
+
+/*
+ * Unpack n values of more than 32 bits each, packed from LSB to MSB.
+ */
+static void
+unpackValues(int bitWidth, uint8_t *in, int64 *out, int n)
+{
+	int			bit = 0;
+
+	for (int i = 0; i < n; i++)
+	{
+		uint64	v = 0;
+		int		got = 0;
+
+		while (got < bitWidth)
+		{
+			int		shift = bit & 7;
+			int		nbits = Min(8 - shift, bitWidth - got);
+
+			v |= ((uint64) ((in[bit >> 3] >> shift) & ((1 << nbits) - 1))) << got;
+			got += nbits;
+			bit += nbits;
+		}
+		out[i] = (int64) v;
+	}
+}
@@ -30,7 +30,6 @@
         Assert( (buffer) != NULL && \
                 (buffer)->Mode == PARQUET_FOOTER_BUFFERMODE_WRITE)
 
-void fillBufferFromFile(File file, char *filename, uint8_t *buffer, int size);
 void flushBufferToFile(File file, char *filename, uint8_t *buffer, int size);
 int  fillBufferFromTempFile(File file, uint8_t *buffer, int size);
 
@@ -115,6 +114,49 @@ ParquetFooterBuffer *createParquetFooterBuffer( File  datafile,
 	return res;
 }
 
+/*
+ * Create one parquet footer buffer for reading a footer already in memory.
+ * The buffer takes the footer, which is freed with the buffer, and never
+ * reads the file.
+ *
+ * @filename        The filename of the footer file.
+ * @footer          The palloc'd footer data.
+ * @footerlength    The total length of the footer data.
+ *
+ * Return created footer buffer instance.
+ */
+ParquetFooterBuffer *createParquetFooterBufferFromMemory( char    *filename,
+                                                          uint8_t *footer,
+                                                          int      footerlength)
+{
+	ParquetFooterBuffer *res = (ParquetFooterBuffer *)
+							   palloc0(sizeof(ParquetFooterBuffer));
+
+    res->Mode            = PARQUET_FOOTER_BUFFERMODE_READ;
+    res->FileHandler     = -1;
+    res->FileName        = (char *)palloc(sizeof(char)*(strlen(filename)+1));
+    strcpy(res->FileName, filename);
+    res->TmpFile         = -1;
+
+    /* All the footer is loaded, nothing left to read from the file. */
+    res->FooterLength    = footerlength;
+    res->FooterProcessed = footerlength;
+    res->Capacity        = footerlength;
+    res->ValidLen        = footerlength;
+    res->Cursor          = 0;
+    res->Head            = footer;
+
+    elog(DEBUG5, "Create parquet footer buffer from memory. "
+                 "INSTADDR=%p, "
+                 "FILENAME=%s, "
+                 "FOOTERLENGTH=%d",
+                 res,
+                 res->FileName,
+                 res->FooterLength );
+
+	return res;
+}
+
 /*
  * Free one parquet footer buffer.
  *
@@ -0,0 +1,398 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * cdbparquetfootercache.c
+ *
+ * The footer of a parquet segment file is read again by each scan of the
+ * file, read from HDFS a buffer at a time as it is deserialized. This cache
+ * keeps the bytes of the footers in the shared memory of the postmaster, so
+ * that the QEs of the host read the footer of a file once.
+ *
+ * A file is only appended to, and its footer written again at the end, so
+ * the bytes of the file up to a logical eof never change: a cached footer is
+ * the footer of the file at the eof it was read at, and is used only to
+ * read the file at that eof. The footer of a file is removed as the file is
+ * appended to, the footers of other eofs or of files dropped are evicted as
+ * the least recently used ones.
+ *
+ * The footers are the serialized thrift data, not the deserialized
+ * metadata: the metadata is palloc'd and pointer linked, and deserialized
+ * a row group at a time as the file is scanned, while the bytes are copied
+ * in and out as they are.
+ *
+ * The bytes of a cached footer, after the path of its file, are kept in a
+ * chain of fixed size chunks of the chunk array, as the blocks of the
+ * metadata cache (cdbmetadatacache.c) are. An entry of the hash table is
+ * found by the hash value of the path, and its path compared.
+ */
+#include "postgres.h"
+
+#include "access/hash.h"
+#include "cdb/cdbparquetfootercache.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/guc.h"
+#include "utils/hsearch.h"
+
+#define PARQUET_FOOTER_CACHE_CHUNK_SIZE		8192
+#define PARQUET_FOOTER_CACHE_CHUNK_DATA		(PARQUET_FOOTER_CACHE_CHUNK_SIZE - sizeof(int))
+
+/* a footer may take at most this part of the cache */
+#define PARQUET_FOOTER_CACHE_MAX_FOOTER_RATIO	4
+
+#define END_OF_CHUNK	-1
+
+typedef struct ParquetFooterCacheChunk
+{
+	int			next_chunk_id;
+	char		data[PARQUET_FOOTER_CACHE_CHUNK_DATA];
+} ParquetFooterCacheChunk;
+
+typedef struct ParquetFooterCacheEntry
+{
+	uint32		path_hash;		/* hash key */
+	SHM_QUEUE	lru_link;		/* in the LRU list, the most recent last */
+	int64		eof;
+	int			path_len;
+	int			footer_len;
+	int			chunk_num;
+	int			first_chunk_id;
+} ParquetFooterCacheEntry;
+
+typedef struct ParquetFooterCacheSharedData
+{
+	SHM_QUEUE	lru_list;
+	int			chunk_num;
+	int			free_chunk_num;
+	int			free_chunk_head;
+} ParquetFooterCacheSharedData;
+
+static ParquetFooterCacheSharedData	*ParquetFooterCacheShared = NULL;
+static HTAB							*ParquetFooterCache = NULL;
+static ParquetFooterCacheChunk		*ParquetFooterCacheChunkArray = NULL;
+
+static int	ParquetFooterCacheChunkNum(void);
+static void	RemoveParquetFooterCacheEntry(ParquetFooterCacheEntry *entry);
+static void	CopyToChunks(int *chunk_id, int *offset, const char *src, int len);
+static void	CopyFromChunks(int *chunk_id, int *offset, char *dst, int len);
+
+/*
+ * The number of chunks of the cache, 0 if the cache is off.
+ */
+static int
+ParquetFooterCacheChunkNum(void)
+{
+	return (int) (((int64) gp_parquet_footer_cache_size * 1024) /
+				  PARQUET_FOOTER_CACHE_CHUNK_SIZE);
+}
+
+/*
+ *  Estimate parquet footer cache shared memory size
+ *      - Footer cache hash size, at most an entry per chunk
+ *      - Footer cache shared structure size
+ *      - Footer cache chunk array size
+ */
+Size
+ParquetFooterCache_ShmemSize(void)
+{
+	Size		size;
+	int			chunk_num = ParquetFooterCacheChunkNum();
+
+	if (chunk_num == 0)
+		return 0;
+
+	size = hash_estimate_size((Size) chunk_num, sizeof(ParquetFooterCacheEntry));
+	size = add_size(size, sizeof(ParquetFooterCacheSharedData));
+	size = add_size(size, mul_size(chunk_num, sizeof(ParquetFooterCacheChunk)));
+
+	return size;
+}
+
+void
+ParquetFooterCache_ShmemInit(void)
+{
+	HASHCTL		info;
+	bool		found;
+	int			chunk_num = ParquetFooterCacheChunkNum();
+
+	if (chunk_num == 0)
+		return;
+
+	ParquetFooterCacheShared = (ParquetFooterCacheSharedData *)
+		ShmemInitStruct("Parquet Footer Cache Shared Data",
+						sizeof(ParquetFooterCacheSharedData), &found);
+
+	MemSet(&info, 0, sizeof(info));
+	info.keysize = sizeof(uint32);
+	info.entrysize = sizeof(ParquetFooterCacheEntry);
+	info.hash = tag_hash;
+
+	ParquetFooterCache = ShmemInitHash("Parquet Footer Cache",
+									   chunk_num, chunk_num,
+									   &info, HASH_ELEM | HASH_FUNCTION);
+
+	ParquetFooterCacheChunkArray = (ParquetFooterCacheChunk *)
+		ShmemInitStruct("Parquet Footer Cache Chunk Array",
+						mul_size(chunk_num, sizeof(ParquetFooterCacheChunk)),
+						&found);
+
+	if (ParquetFooterCacheShared == NULL || ParquetFooterCache == NULL ||
+		ParquetFooterCacheChunkArray == NULL)
+		elog(FATAL, "fail to allocate share memory for parquet footer cache");
+
+	if (found)
+		return;
+
+	SHMQueueInit(&ParquetFooterCacheShared->lru_list);
+	ParquetFooterCacheShared->chunk_num = chunk_num;
+	ParquetFooterCacheShared->free_chunk_num = chunk_num;
+	ParquetFooterCacheShared->free_chunk_head = 0;
+
+	for (int i = 0; i < chunk_num; i++)
+		ParquetFooterCacheChunkArray[i].next_chunk_id =
+			(i == chunk_num - 1) ? END_OF_CHUNK : i + 1;
+
+	elog(LOG, "parquet footer cache initialized, %d chunks", chunk_num);
+}
+
+bool
+ParquetFooterCache_Cacheable(int footerLen)
+{
+	if (ParquetFooterCache == NULL)
+		return false;
+
+	return footerLen / PARQUET_FOOTER_CACHE_CHUNK_DATA + 1 <=
+		ParquetFooterCacheShared->chunk_num / PARQUET_FOOTER_CACHE_MAX_FOOTER_RATIO;
+}
+
+uint8_t *
+ParquetFooterCache_Lookup(const char *filePath, int64 eof, int *footerLen)
+{
+	ParquetFooterCacheEntry *entry;
+	uint32		path_hash;
+	int			path_len = strlen(filePath);
+	char		path[MAXPGPATH];
+	uint8_t	   *footer = NULL;
+	int			chunk_id;
+	int			offset;
+
+	if (ParquetFooterCache == NULL || path_len >= MAXPGPATH)
+		return NULL;
+
+	path_hash = DatumGetUInt32(hash_any((const unsigned char *) filePath, path_len));
+
+	LWLockAcquire(ParquetFooterCacheLock, LW_EXCLUSIVE);
+
+	entry = (ParquetFooterCacheEntry *)
+		hash_search(ParquetFooterCache, &path_hash, HASH_FIND, NULL);
+
+	if (entry != NULL && entry->eof == eof && entry->path_len == path_len)
+	{
+		chunk_id = entry->first_chunk_id;
+		offset = 0;
+		CopyFromChunks(&chunk_id, &offset, path, path_len);
+
+		if (memcmp(path, filePath, path_len) == 0)
+		{
+			footer = (uint8_t *) palloc(entry->footer_len);
+			CopyFromChunks(&chunk_id, &offset, (char *) footer, entry->footer_len);
+			*footerLen = entry->footer_len;
+
+			/* move to the end of the LRU list */
+			SHMQueueDelete(&entry->lru_link);
+			SHMQueueInsertBefore(&ParquetFooterCacheShared->lru_list,
+								 &entry->lru_link);
+		}
+	}
+
+	LWLockRelease(ParquetFooterCacheLock);
+
+	elog(DEBUG3, "parquet footer cache %s for file '%s' eof " INT64_FORMAT,
+		 footer ? "hit" : "miss", filePath, eof);
+
+	return footer;
+}
+
+void
+ParquetFooterCache_Insert(const char *filePath, int64 eof,
+						  const uint8_t *footer, int footerLen)
+{
+	ParquetFooterCacheEntry *entry;
+	uint32		path_hash;
+	int			path_len = strlen(filePath);
+	int			chunk_num;
+	int			chunk_id;
+	int			offset;
+
+	if (!ParquetFooterCache_Cacheable(footerLen) || path_len >= MAXPGPATH)
+		return;
+
+	chunk_num = (path_len + footerLen + PARQUET_FOOTER_CACHE_CHUNK_DATA - 1) /
+		PARQUET_FOOTER_CACHE_CHUNK_DATA;
+	if (chunk_num > ParquetFooterCacheShared->chunk_num / PARQUET_FOOTER_CACHE_MAX_FOOTER_RATIO)
+		return;
+
+	path_hash = DatumGetUInt32(hash_any((const unsigned char *) filePath, path_len));
+
+	LWLockAcquire(ParquetFooterCacheLock, LW_EXCLUSIVE);
+
+	/* replace the footer of another eof, or of another file of the hash */
+	entry = (ParquetFooterCacheEntry *)
+		hash_search(ParquetFooterCache, &path_hash, HASH_FIND, NULL);
+	if (entry != NULL)
+		RemoveParquetFooterCacheEntry(entry);
+
+	/* evict the footers used least recently until the footer fits */
+	while (ParquetFooterCacheShared->free_chunk_num < chunk_num)
+	{
+		entry = (ParquetFooterCacheEntry *)
+			SHMQueueNext(&ParquetFooterCacheShared->lru_list,
+						 &ParquetFooterCacheShared->lru_list,
+						 offsetof(ParquetFooterCacheEntry, lru_link));
+		Insist(entry != NULL);
+		RemoveParquetFooterCacheEntry(entry);
+	}
+
+	entry = (ParquetFooterCacheEntry *)
+		hash_search(ParquetFooterCache, &path_hash, HASH_ENTER_NULL, NULL);
+	if (entry == NULL)
+	{
+		LWLockRelease(ParquetFooterCacheLock);
+		return;
+	}
+
+	entry->eof = eof;
+	entry->path_len = path_len;
+	entry->footer_len = footerLen;
+	entry->chunk_num = chunk_num;
+	entry->first_chunk_id = ParquetFooterCacheShared->free_chunk_head;
+
+	/* take the chunks off the head of the free list */
+	chunk_id = entry->first_chunk_id;
+	for (int i = 1; i < chunk_num; i++)
+		chunk_id = ParquetFooterCacheChunkArray[chunk_id].next_chunk_id;
+	ParquetFooterCacheShared->free_chunk_head =
+		ParquetFooterCacheChunkArray[chunk_id].next_chunk_id;
+	ParquetFooterCacheChunkArray[chunk_id].next_chunk_id = END_OF_CHUNK;
+	ParquetFooterCacheShared->free_chunk_num -= chunk_num;
+
+	chunk_id = entry->first_chunk_id;
+	offset = 0;
+	CopyToChunks(&chunk_id, &offset, filePath, path_len);
+	CopyToChunks(&chunk_id, &offset, (const char *) footer, footerLen);
+
+	SHMQueueInsertBefore(&ParquetFooterCacheShared->lru_list, &entry->lru_link);
+
+	LWLockRelease(ParquetFooterCacheLock);
+}
+
+void
+ParquetFooterCache_Invalidate(const char *filePath)
+{
+	ParquetFooterCacheEntry *entry;
+	uint32		path_hash;
+	int			path_len = strlen(filePath);
+
+	if (ParquetFooterCache == NULL || path_len >= MAXPGPATH)
+		return;
+
+	path_hash = DatumGetUInt32(hash_any((const unsigned char *) filePath, path_len));
+
+	/* another file of the hash is removed too, it is only read again */
+	LWLockAcquire(ParquetFooterCacheLock, LW_EXCLUSIVE);
+	entry = (ParquetFooterCacheEntry *)
+		hash_search(ParquetFooterCache, &path_hash, HASH_FIND, NULL);
+	if (entry != NULL)
+		RemoveParquetFooterCacheEntry(entry);
+	LWLockRelease(ParquetFooterCacheLock);
+}
+
+/*
+ * Give the chunks of the entry back to the free list, and remove the entry.
+ * The caller holds ParquetFooterCacheLock exclusively.
+ */
+static void
+RemoveParquetFooterCacheEntry(ParquetFooterCacheEntry *entry)
+{
+	int			last_chunk_id = entry->first_chunk_id;
+	uint32		path_hash = entry->path_hash;
+
+	while (ParquetFooterCacheChunkArray[last_chunk_id].next_chunk_id != END_OF_CHUNK)
+		last_chunk_id = ParquetFooterCacheChunkArray[last_chunk_id].next_chunk_id;
+
+	ParquetFooterCacheChunkArray[last_chunk_id].next_chunk_id =
+		ParquetFooterCacheShared->free_chunk_head;
+	ParquetFooterCacheShared->free_chunk_head = entry->first_chunk_id;
+	ParquetFooterCacheShared->free_chunk_num += entry->chunk_num;
+
+	SHMQueueDelete(&entry->lru_link);
+	hash_search(ParquetFooterCache, &path_hash, HASH_REMOVE, NULL);
+}
+
+/*
+ * Copy `len` bytes into the chunk chain, from `offset` of chunk `chunk_id`
+ * on, and advance them past the bytes.
+ */
+static void
+CopyToChunks(int *chunk_id, int *offset, const char *src, int len)
+{
+	while (len > 0)
+	{
+		int			n;
+
+		if (*offset == PARQUET_FOOTER_CACHE_CHUNK_DATA)
+		{
+			*chunk_id = ParquetFooterCacheChunkArray[*chunk_id].next_chunk_id;
+			*offset = 0;
+		}
+		Assert(*chunk_id != END_OF_CHUNK);
+
+		n = Min(len, (int) PARQUET_FOOTER_CACHE_CHUNK_DATA - *offset);
+		memcpy(ParquetFooterCacheChunkArray[*chunk_id].data + *offset, src, n);
+		*offset += n;
+		src += n;
+		len -= n;
+	}
+}
+
+/*
+ * Copy `len` bytes out of the chunk chain, as CopyToChunks does in.
+ */
+static void
+CopyFromChunks(int *chunk_id, int *offset, char *dst, int len)
+{
+	while (len > 0)
+	{
+		int			n;
+
+		if (*offset == PARQUET_FOOTER_CACHE_CHUNK_DATA)
+		{
+			*chunk_id = ParquetFooterCacheChunkArray[*chunk_id].next_chunk_id;
+			*offset = 0;
+		}
+		Assert(*chunk_id != END_OF_CHUNK);
+
+		n = Min(len, (int) PARQUET_FOOTER_CACHE_CHUNK_DATA - *offset);
+		memcpy(dst, ParquetFooterCacheChunkArray[*chunk_id].data + *offset, n);
+		*offset += n;
+		dst += n;
+		len -= n;
+	}
+}
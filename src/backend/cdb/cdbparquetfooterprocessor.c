@@ -27,6 +27,8 @@
 #include "cdb/cdbparquetfooterprocessor.h"
 #include "cdb/cdbparquetstoragewrite.h"
 #include "cdb/cdbparquetfooterserializer.h"
+#include "cdb/cdbparquetfootercache.h"
+#include "cdb/cdbparquetfooterbuffer.h"
 
 
 void writeParquetHeader(File dataFile, char *filePathName, int64 *fileLen, int64 *fileLen_uncompressed) {
@@ -103,6 +105,8 @@ void writeParquetFooter(File dataFile,
  * @return				whether the parquetMetadata be read out. If read out, return true,
  * 						else return false
  *
+ * The footer is looked up in the parquet footer cache first, and put into it
+ * once it is read from the file.
  * */
 bool readParquetFooter(File fileHandler, ParquetMetadata *parquetMetadata,
 		CompactProtocol **footerProtocol, int64 eof, char *filePathName) {
@@ -128,6 +132,15 @@ bool readParquetFooter(File fileHandler, ParquetMetadata *parquetMetadata,
 						 filePathName, eof)));
 	}
 
+	int cachedFooterLen;
+	uint8_t *footer = ParquetFooterCache_Lookup(filePathName, eof, &cachedFooterLen);
+	if (footer != NULL)
+	{
+		initDeserializeFooterFromMemory(footer, cachedFooterLen, filePathName,
+				parquetMetadata, footerProtocol);
+		return true;
+	}
+
 	/* get footer length*/
 	int64 footLengthIndex = FileSeek(fileHandler, eof - 8, SEEK_SET);
 	if (footLengthIndex != (eof - 8))
@@ -173,6 +186,18 @@ bool readParquetFooter(File fileHandler, ParquetMetadata *parquetMetadata,
 				 errdetail("%s", HdfsGetLastError())));
 	}
 
+	if (ParquetFooterCache_Cacheable(footerLen))
+	{
+		/* read all the footer at once, to cache it and deserialize it */
+		footer = (uint8_t *) palloc(footerLen);
+		fillBufferFromFile(fileHandler, filePathName, footer, footerLen);
+		ParquetFooterCache_Insert(filePathName, eof, footer, footerLen);
+
+		initDeserializeFooterFromMemory(footer, footerLen, filePathName,
+				parquetMetadata, footerProtocol);
+		return true;
+	}
+
 	initDeserializeFooter(fileHandler, footerLen, filePathName, parquetMetadata, footerProtocol);
 
 	return true;
@@ -83,6 +83,11 @@ readColumnMetadata(
 		CompactProtocol *prot,
 		struct ColumnChunkMetadata_4C *colChunk);
 
+static int
+readStatistics(
+		CompactProtocol *prot,
+		struct ColumnChunkMetadata_4C *colChunk);
+
 static void
 assignRDFromFieldToColumnChunk(
 		struct ColumnChunkMetadata_4C* columns,
@@ -110,6 +115,11 @@ writeColumnChunk(
 		struct ColumnChunkMetadata_4C *columnInfo,
 		CompactProtocol *prot);
 
+static int
+writeStatistics(
+		struct ColumnChunkMetadata_4C *columnInfo,
+		CompactProtocol *prot);
+
 static int
 writeSchemaElement_Single(
 		CompactProtocol *prot,
@@ -171,6 +181,25 @@ void initDeserializeFooter(
 	readParquetFileMetadata(parquetMetadata, *footerProtocol);
 }
 
+/*
+ *  Initialize deserialize footer from the footer in memory, which the footer
+ *  protocol takes
+ */
+void initDeserializeFooterFromMemory(
+		uint8_t *footer,
+		int footerLength,
+		char *fileName,
+		ParquetMetadata *parquetMetadata,
+		CompactProtocol **footerProtocol)
+{
+	*footerProtocol =
+			(struct CompactProtocol *)palloc0(sizeof(struct CompactProtocol));
+
+	initCompactProtocolFromMemory(*footerProtocol, fileName, footer, footerLength);
+
+	readParquetFileMetadata(parquetMetadata, *footerProtocol);
+}
+
 /*
  *  The initialize read method, read file metadata, but just read the first 4 parts,
  *  including version, schema information, number of rows, and rowgroup number, but
@@ -713,6 +742,10 @@ readColumnMetadata(
 	bool isset_total_compressed_size = false;
 	bool isset_data_page_offset = false;
 
+	colChunk->nullCount = -1;
+	colChunk->hasMinMax = 0;
+	colChunk->dictionaryPageOffset = 0;
+
 	while (true) {
 		xfer += readFieldBegin(prot, &ftype, &fid);
 		if (ftype == T_STOP) {
@@ -815,13 +848,12 @@ readColumnMetadata(
 			break;
 		case 11:
 			if (ftype == T_I64) {
-				xfer += skipType(prot, ftype);
+				xfer += readI64(prot, &(colChunk->dictionaryPageOffset));
 			}
 			break;
 		case 12:
-			/* Skip this optional field now */
 			if (ftype == T_STRUCT) {
-				xfer += skipType(prot, ftype);
+				xfer += readStatistics(prot, colChunk);
 			}
 			break;
 		case 13:
@@ -862,6 +894,74 @@ readColumnMetadata(
 	if (!isset_data_page_offset)
 		ereport(ERROR,
 				(errcode(ERRCODE_GP_INTERNAL_ERROR), errmsg("file metadata: row group column chunk first data page not set")));
+
+	/*the min/max values must be as wide as the plain encoded values of the column*/
+	if (colChunk->hasMinMax)
+	{
+		int width = colChunk->hasMinMax;
+		if (!(((colChunk->type == INT32 || colChunk->type == FLOAT) && width == 4) ||
+			  ((colChunk->type == INT64 || colChunk->type == DOUBLE) && width == 8)))
+			colChunk->hasMinMax = 0;
+	}
+	return xfer;
+}
+
+/**
+ * read the statistics of a column chunk. The min/max values are kept only if
+ * both are there with the same width of 4 or 8 bytes, hasMinMax is set to
+ * the width until readColumnMetadata checks it against the column type.
+ */
+int
+readStatistics(
+		CompactProtocol *prot,
+		struct ColumnChunkMetadata_4C *colChunk)
+{
+	uint32_t xfer = 0;
+	TType ftype;
+	int16_t fid;
+	char *value;
+	int32_t len;
+	int minLen = 0;
+	int maxLen = 0;
+
+	readStructBegin(prot);
+	while (true) {
+		xfer += readFieldBegin(prot, &ftype, &fid);
+		if (ftype == T_STOP) {
+			break;
+		}
+		switch (fid) {
+		case 1:
+		case 2:
+			if (ftype == T_STRING) {
+				xfer += readBinary(prot, &value, &len);
+				if (len == 4 || len == 8) {
+					if (fid == 1) {
+						memcpy(colChunk->maxValue, value, len);
+						maxLen = len;
+					} else {
+						memcpy(colChunk->minValue, value, len);
+						minLen = len;
+					}
+				}
+				if (len > 0)
+					pfree(value);
+			}
+			break;
+		case 3:
+			if (ftype == T_I64) {
+				xfer += readI64(prot, &(colChunk->nullCount));
+			}
+			break;
+		default:
+			xfer += skipType(prot, ftype);
+			break;
+		}
+	}
+	readStructEnd(prot);
+
+	if (minLen != 0 && minLen == maxLen)
+		colChunk->hasMinMax = minLen;
 	return xfer;
 }
 
@@ -1094,7 +1194,17 @@ writeColumnMetadata(
 	xfer += writeFieldBegin(prot, T_I64, 9);
 	xfer += writeI64(prot, columnInfo->firstDataPage);
 
-	/*write out index page offset and dictionary page offset. No need to write currently*/
+	/*write out dictionary page offset, there's no index page currently*/
+	if (columnInfo->dictionaryPageOffset > 0) {
+		xfer += writeFieldBegin(prot, T_I64, 11);
+		xfer += writeI64(prot, columnInfo->dictionaryPageOffset);
+	}
+
+	/*write out statistics*/
+	if (columnInfo->nullCount >= 0) {
+		xfer += writeFieldBegin(prot, T_STRUCT, 12);
+		xfer += writeStatistics(columnInfo, prot);
+	}
 
 	/*write out field stop identifier*/
 	xfer += writeFieldStop(prot);
@@ -1103,6 +1213,37 @@ writeColumnMetadata(
 	return xfer;
 }
 
+/**
+ * Write out the statistics of a column chunk, the min/max values are of the
+ * width of the plain encoded values of the column
+ */
+int
+writeStatistics(
+		struct ColumnChunkMetadata_4C *columnInfo,
+		CompactProtocol *prot)
+{
+	uint32_t xfer = 0;
+
+	xfer += writeStructBegin(prot);
+
+	if (columnInfo->hasMinMax) {
+		int width = (columnInfo->type == INT32 || columnInfo->type == FLOAT) ? 4 : 8;
+
+		xfer += writeFieldBegin(prot, T_STRING, 1);
+		xfer += writeBinary(prot, columnInfo->maxValue, width);
+		xfer += writeFieldBegin(prot, T_STRING, 2);
+		xfer += writeBinary(prot, columnInfo->minValue, width);
+	}
+
+	xfer += writeFieldBegin(prot, T_I64, 3);
+	xfer += writeI64(prot, columnInfo->nullCount);
+
+	xfer += writeFieldStop(prot);
+	xfer += writeStructEnd(prot);
+
+	return xfer;
+}
+
 int
 writeColumnChunk(
 		struct ColumnChunkMetadata_4C *columnInfo,
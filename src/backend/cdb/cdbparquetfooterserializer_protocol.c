@@ -59,6 +59,21 @@ void initCompactProtocol(CompactProtocol *protocol, File fileHandler,
 					PARQUET_FOOTER_BUFFER_CAPACITY_DEFAULT, mode);
 }
 
+/*
+ * Initialize a protocol to read the footer in memory, which the protocol
+ * takes.
+ */
+void initCompactProtocolFromMemory(CompactProtocol *protocol, char *fileName,
+		uint8_t *footer, int footerLength) {
+	protocol->lastFieldArrMaxSize = PARQUET_MAX_FIELD_DEPTH;
+	protocol->lastFieldArr =
+			(int16_t*) palloc0(sizeof(int16_t) * protocol->lastFieldArrMaxSize);
+	protocol->lastFieldArrSize = 0;
+
+	protocol->footerProcessor = createParquetFooterBufferFromMemory
+			(fileName, footer, footerLength);
+}
+
 void freeCompactProtocol(CompactProtocol *protocol) {
 	/* free the last field array*/
 	if (protocol->lastFieldArrMaxSize > 0) {
@@ -237,6 +252,15 @@ uint32_t readI64(CompactProtocol *prot, int64_t *i64) {
 }
 
 uint32_t readString(CompactProtocol *prot, char **str) {
+	int32_t len;
+	return readBinary(prot, str, &len);
+}
+
+/**
+ * Read a binary from the wire, the bytes are followed by a '\0' which is
+ * not counted in len.
+ */
+uint32_t readBinary(CompactProtocol *prot, char **str, int32_t *len) {
 	int32_t rsize = 0;
 	int32_t size = 0;
 	uint8_t *tmp = NULL;
@@ -246,6 +270,7 @@ uint32_t readString(CompactProtocol *prot, char **str) {
   int bufRet;
 
 	rsize += readVarint32(prot, &size);
+	*len = size;
 	/* Catch empty string case */
 	if (size == 0) {
 		*str = "";
@@ -34,6 +34,7 @@ static void writeOrAppendBitPackedRun(RLEEncoder *encoder);
 static void endPreviousBitPackedRun(RLEEncoder *encoder);
 
 static void readNextRun(RLEDecoder *decoder);
+static int  unpackBitPackedGroups(RLEDecoder *decoder, int32_t *out, int ngroups);
 
 void
 RLEEncoder_Init(RLEEncoder *encoder, int bitWidth)
@@ -234,6 +235,64 @@ RLEDecoder_Init(RLEDecoder *decoder, int bitWidth, uint8_t *in, int inputSize)
 	decoder->input		= in;
 	decoder->inputPos	= 0;
 	decoder->inputSize	= inputSize;
+	decoder->valueCount	= 0;
+	decoder->bitpackBufferSize	= 0;
+	decoder->bitpackBufferPos	= 0;
+}
+
+int
+RLEDecoder_ReadInts(RLEDecoder *decoder, int32_t *out, int n)
+{
+	int nread = 0;
+
+	while (nread < n)
+	{
+		int count;
+
+		if (decoder->valueCount == 0)
+		{
+			if (decoder->inputPos >= decoder->inputSize)
+				break;
+			readNextRun(decoder);
+			continue;
+		}
+
+		count = Min(decoder->valueCount, n - nread);
+
+		if (decoder->mode == MODE_RLE)
+		{
+			int32_t value = decoder->rleValue;
+
+			for (int i = 0; i < count; i++)
+				out[nread + i] = value;
+		}
+		else if (decoder->bitpackBufferPos < decoder->bitpackBufferSize)
+		{
+			/* the rest of the values ReadInt has unpacked */
+			count = Min(count, decoder->bitpackBufferSize - decoder->bitpackBufferPos);
+			memcpy(out + nread,
+				   decoder->bitpackBuffer + decoder->bitpackBufferPos,
+				   count * sizeof(int32_t));
+			decoder->bitpackBufferPos += count;
+		}
+		else if (count >= 8)
+		{
+			/* unpack the whole groups straight to the output */
+			count = unpackBitPackedGroups(decoder, out + nread, count / 8);
+		}
+		else
+		{
+			/* less than a group wanted, unpack it to the buffer */
+			decoder->bitpackBufferSize = unpackBitPackedGroups(decoder, decoder->bitpackBuffer, 1);
+			decoder->bitpackBufferPos = 0;
+			continue;
+		}
+
+		decoder->valueCount -= count;
+		nread += count;
+	}
+
+	return nread;
 }
 
 int 
@@ -252,7 +311,16 @@ RLEDecoder_ReadInt(RLEDecoder *decoder)
 			result = decoder->rleValue;
 			break;
 		case MODE_BITPACK:
-			result = decoder->bitpackBuffer[decoder->bitpackBufferSize - decoder->valueCount];
+			if (decoder->bitpackBufferPos == decoder->bitpackBufferSize)
+			{
+				/* the values of the run are a multiple of 8 at this point */
+				int ngroups = Min(decoder->valueCount / 8, BITPACK_RUN_MAX_GROUP_COUNT);
+
+				decoder->bitpackBufferSize =
+					unpackBitPackedGroups(decoder, decoder->bitpackBuffer, ngroups);
+				decoder->bitpackBufferPos = 0;
+			}
+			result = decoder->bitpackBuffer[decoder->bitpackBufferPos++];
 			break;
 		default:
 			/* TODO raise error */
@@ -266,7 +334,7 @@ RLEDecoder_ReadInt(RLEDecoder *decoder)
 void 
 readNextRun(RLEDecoder *decoder)
 {
-	int i, header, num_groups;
+	int header, num_groups;
 
 	if (decoder->inputPos >= decoder->inputSize)
 	{
@@ -291,17 +359,37 @@ readNextRun(RLEDecoder *decoder)
 			 */
 			num_groups = header >> 1;
 			decoder->valueCount = num_groups * 8;
-			decoder->bitpackBufferSize = decoder->valueCount;
 
-			for (i = 0; i < decoder->valueCount; i += 8)
-			{
-				unpack8Values(decoder->bitWidth,
-							  decoder->input,
-							  decoder->inputPos,
-							  decoder->bitpackBuffer,
-							  i);
-				decoder->inputPos += decoder->bitWidth;
-			}
+			/* the groups are unpacked as the values are read */
+			decoder->bitpackBufferSize = 0;
+			decoder->bitpackBufferPos = 0;
 			break;
 	}
 }
+
+/*
+ * Unpack the next `ngroups` groups of the current bit-packed-run to `out`,
+ * return the number of values unpacked.
+ */
+static int
+unpackBitPackedGroups(RLEDecoder *decoder, int32_t *out, int ngroups)
+{
+	int inputLeft = decoder->inputSize - decoder->inputPos;
+
+	if (ngroups * decoder->bitWidth > inputLeft)
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERNAL_ERROR),
+				 errmsg("bit-packed run of %d values exceeds the %d bytes left of RLE data",
+						decoder->valueCount, inputLeft)));
+	}
+
+	unpackGroups(decoder->bitWidth,
+				 decoder->input + decoder->inputPos,
+				 inputLeft,
+				 out,
+				 ngroups);
+	decoder->inputPos += ngroups * decoder->bitWidth;
+
+	return ngroups * 8;
+}
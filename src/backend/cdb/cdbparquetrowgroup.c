@@ -26,12 +26,25 @@
 
 #include "cdb/cdbparquetrowgroup.h"
 #include "cdb/cdbparquetfooterserializer.h"
+#include "access/nbtree.h"
 #include "utils/bloomfilter.h"
+#include "utils/date.h"
+#include "utils/guc.h"
+#include "cdb/cdbutil.h"
+#include "cdb/cdbvars.h"
+#include "utils/hawq_type_mapping.h"
+#include "utils/lsyscache.h"
+#include "utils/timestamp.h"
+#include "executor/nodeHash.h"
 
 static bool ParquetRowGroupReader_Select(FileSplit split,
                                          ParquetMetadata parquetMetadata,
                                          bool *rowGroupInfoProcessed);
 
+static bool ParquetRowGroupReader_Reject(List *filter,
+                                         struct BlockMetadata_4C *rowGroupMetadata,
+                                         int *hawqAttrToParquetColChunks);
+
 /*
  * Initialize the ExecutorReadGroup once.  Assumed to be zeroed out before the call.
  */
@@ -66,6 +79,7 @@ ParquetRowGroupReader_GetRowGroupInfo(
 	bool 					*projs,
 	TupleDesc 				hawqTupleDesc,
 	int 					*hawqAttrToParquetColChunks,
+	List					*filter,
 	bool                    toCloseFile)
 {
 	ParquetMetadata parquetMetadata;
@@ -94,7 +108,21 @@ ParquetRowGroupReader_GetRowGroupInfo(
 		storageRead->preRead = false;
 
 		if (ParquetRowGroupReader_Select(split, parquetMetadata, &rowGroupInfoProcessed))
-			break;
+		{
+			if (!ParquetRowGroupReader_Reject(filter, parquetMetadata->currentBlockMD,
+											  hawqAttrToParquetColChunks) &&
+				(gp_statistics_block_sampling_fraction >= 1.0 ||
+				 cdb_rand() < gp_statistics_block_sampling_fraction))
+				break;
+
+			/*
+			 * No row of the row group passes the qual, or ANALYZE does not
+			 * sample it, go on with the next one
+			 */
+			++storageRead->rowGroupProcessedCount;
+			++rowGroupIndex;
+			continue;
+		}
 
 		/* done with current split and pre-read the next rowgroup info */
 		if (rowGroupInfoProcessed) {
@@ -290,6 +318,7 @@ ParquetRowGroupReader_ScanNextTuple(
 			uint32_t hashkey = 0;
 			ListCell *hk;
 			int i = 0;
+			bool inRange = true;
 			foreach(hk, rfState->joinkeys)
 			{
 				AttrNumber attrno = (AttrNumber) lfirst(hk);
@@ -300,6 +329,14 @@ ParquetRowGroupReader_ScanNextTuple(
 				hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
 				keyval = values[attrno - 1];
 
+				/* the range check is cheaper than the hash */
+				if (rfState->ranges != NULL && !nulls[attrno - 1] &&
+					!RuntimeFilterRangeMatch(&rfState->ranges[i], keyval))
+				{
+					inRange = false;
+					break;
+				}
+
 				/* Evaluate expression */
 				hkey = DatumGetUInt32(
 						FunctionCall1(&rfState->hashfunctions[i], keyval));
@@ -307,7 +344,7 @@ ParquetRowGroupReader_ScanNextTuple(
 				i++;
 			}
 
-			if (!FindBloomFilter(rfState->bloomfilter, hashkey))
+			if (!inRange || !FindBloomFilter(rfState->bloomfilter, hashkey))
 			{
 				continue;
 			}
@@ -365,3 +402,240 @@ static bool ParquetRowGroupReader_Select(FileSplit split,
 
   return false;
 }
+
+/*
+ * Is the type of an attribute one of those with min/max statistics ?
+ */
+static bool
+ParquetRowGroupFilter_TypeSupported(Oid typeId)
+{
+	switch (typeId)
+	{
+	case HAWQ_TYPE_INT2:
+	case HAWQ_TYPE_INT4:
+	case HAWQ_TYPE_DATE:
+	case HAWQ_TYPE_INT8:
+#ifdef HAVE_INT64_TIMESTAMP
+	case HAWQ_TYPE_TIME:
+	case HAWQ_TYPE_TIMESTAMP:
+	case HAWQ_TYPE_TIMESTAMPTZ:
+#endif
+	case HAWQ_TYPE_FLOAT4:
+	case HAWQ_TYPE_FLOAT8:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/*
+ * The Datum of a min/max value of a column chunk, the value is plain encoded
+ * as written by updateColumnStatistics.
+ */
+static Datum
+ParquetRowGroupFilter_StatsValue(const char *value, Oid typeId)
+{
+	int32	i32;
+	int64	i64;
+	float4	f4;
+	float8	f8;
+
+	switch (typeId)
+	{
+	case HAWQ_TYPE_INT2:
+		memcpy(&i32, value, sizeof(i32));
+		return Int16GetDatum((int16) i32);
+	case HAWQ_TYPE_INT4:
+		memcpy(&i32, value, sizeof(i32));
+		return Int32GetDatum(i32);
+	case HAWQ_TYPE_DATE:
+		memcpy(&i32, value, sizeof(i32));
+		return DateADTGetDatum(i32);
+	case HAWQ_TYPE_INT8:
+		memcpy(&i64, value, sizeof(i64));
+		return Int64GetDatum(i64);
+#ifdef HAVE_INT64_TIMESTAMP
+	case HAWQ_TYPE_TIME:
+		memcpy(&i64, value, sizeof(i64));
+		return TimeADTGetDatum(i64);
+	case HAWQ_TYPE_TIMESTAMP:
+	case HAWQ_TYPE_TIMESTAMPTZ:
+		memcpy(&i64, value, sizeof(i64));
+		return TimestampGetDatum(i64);
+#endif
+	case HAWQ_TYPE_FLOAT4:
+		memcpy(&f4, value, sizeof(f4));
+		return Float4GetDatum(f4);
+	case HAWQ_TYPE_FLOAT8:
+		memcpy(&f8, value, sizeof(f8));
+		return Float8GetDatum(f8);
+	default:
+		elog(ERROR, "no parquet statistics for type %u", typeId);
+		return (Datum) 0;
+	}
+}
+
+/*
+ * Build the row group filter of a scan: the clauses of the qual comparing an
+ * attribute of a type with min/max statistics to a non-null constant with a
+ * btree operator. The other clauses are left to the qual. Returns NIL if
+ * gp_parquet_rowgroup_skipping is off.
+ */
+List *
+ParquetRowGroupReader_BuildFilter(
+	List		*qual,
+	TupleDesc	hawqTupleDesc)
+{
+	List	   *filter = NIL;
+	ListCell   *lc;
+
+	if (!gp_parquet_rowgroup_skipping)
+		return NIL;
+
+	foreach(lc, qual)
+	{
+		OpExpr	   *opexpr = (OpExpr *) lfirst(lc);
+		Var		   *var;
+		Const	   *con;
+		Oid			opno;
+		List	   *opclasses;
+		List	   *opstrats;
+		ListCell   *lco;
+		ListCell   *lcs;
+
+		if (!IsA(opexpr, OpExpr) || list_length(opexpr->args) != 2)
+			continue;
+
+		/* the attribute on the left, commute "constant op attribute" */
+		if (IsA(linitial(opexpr->args), Var) && IsA(lsecond(opexpr->args), Const))
+		{
+			var = (Var *) linitial(opexpr->args);
+			con = (Const *) lsecond(opexpr->args);
+			opno = opexpr->opno;
+		}
+		else if (IsA(linitial(opexpr->args), Const) && IsA(lsecond(opexpr->args), Var))
+		{
+			var = (Var *) lsecond(opexpr->args);
+			con = (Const *) linitial(opexpr->args);
+			opno = get_commutator(opexpr->opno);
+			if (!OidIsValid(opno))
+				continue;
+		}
+		else
+			continue;
+
+		if (var->varlevelsup != 0 ||
+			var->varattno <= 0 || var->varattno > hawqTupleDesc->natts ||
+			var->vartype != hawqTupleDesc->attrs[var->varattno - 1]->atttypid ||
+			!ParquetRowGroupFilter_TypeSupported(var->vartype) ||
+			con->constisnull)
+			continue;
+
+		get_op_btree_interpretation(opno, &opclasses, &opstrats);
+		forboth(lco, opclasses, lcs, opstrats)
+		{
+			Oid			opclass = lfirst_oid(lco);
+			int			rctype = lfirst_int(lcs);
+			int			strategy;
+			Oid			subtype;
+			bool		recheck;
+			Oid			cmpproc;
+			ParquetRowGroupFilterClause *clause;
+
+			/* not <>, and an opclass of the attribute type */
+			if (rctype < ROWCOMPARE_LT || rctype > ROWCOMPARE_GT ||
+				get_opclass_input_type(opclass) != var->vartype)
+				continue;
+
+			get_op_opclass_properties(opno, opclass, &strategy, &subtype, &recheck);
+			cmpproc = get_opclass_proc(opclass, subtype, BTORDER_PROC);
+			if (recheck || !OidIsValid(cmpproc))
+				continue;
+
+			clause = (ParquetRowGroupFilterClause *) palloc0(sizeof(ParquetRowGroupFilterClause));
+			clause->attno = var->varattno - 1;
+			clause->typeId = var->vartype;
+			clause->strategy = strategy;
+			clause->value = con->constvalue;
+			fmgr_info(cmpproc, &clause->cmpfunc);
+			filter = lappend(filter, clause);
+			break;
+		}
+
+		list_free(opclasses);
+		list_free(opstrats);
+	}
+
+	return filter;
+}
+
+/*
+ * Does no row of a row group pass the clauses of the filter ? The column
+ * chunks without statistics, from the files written before them, pass.
+ */
+static bool
+ParquetRowGroupReader_Reject(
+	List						*filter,
+	struct BlockMetadata_4C		*rowGroupMetadata,
+	int							*hawqAttrToParquetColChunks)
+{
+	ListCell   *lc;
+
+	foreach(lc, filter)
+	{
+		ParquetRowGroupFilterClause *clause = (ParquetRowGroupFilterClause *) lfirst(lc);
+		struct ColumnChunkMetadata_4C *chunkmd;
+		int			chunkIndex = 0;
+		int32		cmpmin;
+		int32		cmpmax;
+
+		for (int i = 0; i < clause->attno; i++)
+			chunkIndex += hawqAttrToParquetColChunks[i];
+		if (hawqAttrToParquetColChunks[clause->attno] != 1 ||
+			chunkIndex >= rowGroupMetadata->ColChunkCount)
+			continue;
+		chunkmd = &rowGroupMetadata->columns[chunkIndex];
+
+		/* the btree operators are strict, no null passes */
+		if (chunkmd->nullCount >= 0 && chunkmd->nullCount == chunkmd->valueCount)
+			return true;
+
+		if (!chunkmd->hasMinMax)
+			continue;
+
+		cmpmin = DatumGetInt32(FunctionCall2(&clause->cmpfunc,
+				ParquetRowGroupFilter_StatsValue(chunkmd->minValue, clause->typeId),
+				clause->value));
+		cmpmax = DatumGetInt32(FunctionCall2(&clause->cmpfunc,
+				ParquetRowGroupFilter_StatsValue(chunkmd->maxValue, clause->typeId),
+				clause->value));
+
+		switch (clause->strategy)
+		{
+		case BTLessStrategyNumber:
+			if (cmpmin >= 0)
+				return true;
+			break;
+		case BTLessEqualStrategyNumber:
+			if (cmpmin > 0)
+				return true;
+			break;
+		case BTEqualStrategyNumber:
+			if (cmpmin > 0 || cmpmax < 0)
+				return true;
+			break;
+		case BTGreaterEqualStrategyNumber:
+			if (cmpmax < 0)
+				return true;
+			break;
+		case BTGreaterStrategyNumber:
+			if (cmpmax <= 0)
+				return true;
+			break;
+		default:
+			break;
+		}
+	}
+
+	return false;
+}
@@ -27,20 +27,94 @@
 
 #include "postgres.h"
 
+#include <math.h>
+#include <pthread.h>
+
+
+#include "access/hash.h"
 #include "catalog/catquery.h"
+#include "cdb/cdbgang.h"			/* gp_pthread_create */
 #include "cdb/cdbparquetstoragewrite.h"
 #include "cdb/cdbparquetfooterserializer.h"
 #include "lib/stringinfo.h"
 #include "utils/cash.h"
 #include "utils/geo_decls.h"
+#include "utils/guc.h"
 #include "utils/date.h"
 #include "utils/numeric.h"
 #include "utils/xml.h"
 #include "utils/inet.h"
+#include "utils/atomic.h"
 
 #include "snappy-c.h"
 #include "zlib.h"
+#include "lz4.h"
+#include "zstd.h"
+
+
+static void initPlainValues(
+		ParquetColumnChunk chunk,
+		ParquetDataPage page);
+
+static void finalizePage(
+		ParquetColumnChunk chunk,
+		ParquetDataPage page,
+		StringInfo buf);
+
+static void serializePageHeader(
+		ParquetColumnChunk chunk,
+		ParquetDataPage page);
+
+static size_t compressedLengthBound(
+		int codec,
+		size_t len);
+
+static int compressPageData(
+		int codec,
+		int compresslevel,
+		const uint8_t *src,
+		size_t srclen,
+		uint8_t *dst,
+		size_t *dstlen,
+		const char **zmsg);
+
+static void reportCompressError(
+		int result,
+		const char *zmsg);
+
+static void compressPendingPages(
+		ParquetRowGroup rowgroup);
+
+static void *compressPagesThread(void *arg);
+
+static ParquetDictionary createDictionary(
+		ParquetColumnChunk chunk);
+
+static int addDictionaryValue(
+		ParquetColumnChunk chunk,
+		Datum value,
+		int *encoded_len);
 
+static int appendDictionaryId(
+		ParquetColumnChunk chunk,
+		int id);
+
+static int fallbackToPlain(
+		ParquetColumnChunk chunk);
+
+static void encodeDictionaryPage(
+		ParquetColumnChunk chunk);
+
+static void freeDictionary(
+		ParquetDictionary dict);
+
+static void growDictionarySlots(
+		ParquetDictionary dict);
+
+static int dictionaryBitWidth(int count);
+
+static bool deltaEncodable(int hawqTypeId);
+static int appendDeltaValue(ParquetColumnChunk chunk, Datum value);
 
 static void addDataPage(
 		ParquetColumnChunk columnChunk);
@@ -52,8 +126,7 @@ static int finalizeCurrentAndNewPage(
 		ParquetColumnChunk columnChunk);
 
 static void flushDataPage(
-		ParquetColumnChunk chunk,
-		int page_number);
+		ParquetDataPage page);
 
 static void initGroupType(
 		FileField_4C *field,
@@ -191,6 +264,10 @@ static int encodePlain(
 		int hawqTypeId,
 		int pageSizeLimit);
 
+static void updateColumnStatistics(
+		ColumnChunkMetadata chunkmd,
+		Datum value);
+
 static int approximatePageSize(ParquetDataPage page);
 
 static bool ensureBufferCapacity(ParquetDataPage page,
@@ -200,6 +277,36 @@ static bool ensureBufferCapacity(ParquetDataPage page,
 #define ENCODE_INVALID_VALUE	-1
 #define ENCODE_OUTOF_PAGE		-2
 
+/* results of compressPageData */
+#define COMPRESS_OK					0
+#define COMPRESS_SNAPPY_FAILED		1
+#define COMPRESS_DEFLATEINIT_FAILED	2
+#define COMPRESS_DEFLATE_FAILED		3
+#define COMPRESS_LZ4_FAILED			4
+#define COMPRESS_ZSTD_FAILED		5
+
+/*
+ * A page left for compressPendingPages to compress, see finalizePage.
+ */
+typedef struct PageCompressJob
+{
+	ParquetColumnChunk chunk;
+	ParquetDataPage	page;
+	int				codec;
+	int				compresslevel;
+	uint8_t			*dst;
+	size_t			dstlen;
+	int				result;
+	const char		*zmsg;
+} PageCompressJob;
+
+typedef struct PageCompressJobs
+{
+	PageCompressJob	*jobs;
+	int				njobs;
+	volatile int32	next;		/* the job to take by gp_atomic_add_32 */
+} PageCompressJobs;
+
 /**
  * generate hawq schema in to string. for example:
  *
@@ -922,17 +1029,18 @@ flushRowGroup(ParquetRowGroup rowgroup,
 	Assert(rowgroup != NULL);
 
 	/*
-	 * Write out column chunks one by one. For each chunk, we do the following:
-	 * 1. encode the last page.
-	 * 2. write out pages one by one.
-	 * 3. write out chunk's metadata after the last page.
+	 * Encode the last page of the column chunks, and compress the pages
+	 * left for the compress threads.
 	 */
 	for (int i = 0; i < rowgroup->columnChunkNumber; i++)
 	{
 		ParquetColumnChunk chunk	= &rowgroup->columnChunks[i];
-		ColumnChunkMetadata chunkmd	= chunk->columnChunkMetadata;
 
 		bytes_added += encodeCurrentPage(chunk);
+		if (chunk->dictionary != NULL && chunk->dictionary->count > 0)
+		{
+			encodeDictionaryPage(chunk);
+		}
 
 		/*----------------------------------------------------------------
 		 * recompute estimate chunk size based on uncompressed size (excludes header)
@@ -943,6 +1051,38 @@ flushRowGroup(ParquetRowGroup rowgroup,
 			parquetmd->estimateChunkSizes[i] += chunk->pages[pageno].header->uncompressed_page_size;
 		}
 		parquetmd->estimateChunkSizes[i] = (int) (parquetmd->estimateChunkSizes[i] * 1.05);
+	}
+
+	compressPendingPages(rowgroup);
+
+	/*
+	 * Write out column chunks one by one. For each chunk, we do the following:
+	 * 1. write out pages one by one.
+	 * 2. write out chunk's metadata after the last page.
+	 */
+	for (int i = 0; i < rowgroup->columnChunkNumber; i++)
+	{
+		ParquetColumnChunk chunk	= &rowgroup->columnChunks[i];
+		ColumnChunkMetadata chunkmd	= chunk->columnChunkMetadata;
+
+		/*----------------------------------------------------------------
+		 * write out the dictionary page before the data pages
+		 *----------------------------------------------------------------*/
+		if (chunk->dictionary != NULL && chunk->dictionary->count > 0)
+		{
+			chunkmd->dictionaryPageOffset = FileNonVirtualTell(rowgroup->parquetFile);
+			if (chunkmd->dictionaryPageOffset < 0)
+			{
+				ereport(ERROR,
+						(errcode_for_file_access(),
+						 errmsg("file tell position error for segment file: %s", strerror(errno)),
+						 errdetail("%s", HdfsGetLastError())));
+			}
+			flushDataPage(&chunk->dictionary->page);
+
+			chunkmd->pEncodings[3] = PLAIN_DICTIONARY;
+			chunkmd->EncodingCount = 4;
+		}
 
 		/*----------------------------------------------------------------
 		 * write out pages one by one
@@ -957,7 +1097,7 @@ flushRowGroup(ParquetRowGroup rowgroup,
 		}
 		for (int pageno = 0; pageno < chunk->pageNumber; ++pageno)
 		{
-			flushDataPage(chunk, pageno);
+			flushDataPage(&chunk->pages[pageno]);
 		}
 
 		/*----------------------------------------------------------------
@@ -1022,6 +1162,10 @@ freeRowGroup(ParquetRowGroup rowgroup)
 	for (int i = 0; i < rowgroup->columnChunkNumber; i++)
 	{
 		pfree(rowgroup->columnChunks[i].pages);
+		if (rowgroup->columnChunks[i].dictionary != NULL)
+		{
+			freeDictionary(rowgroup->columnChunks[i].dictionary);
+		}
 
 		/* chunk metadata should be kept util parquet_insert_finish */
 		rowgroup->columnChunks[i].columnChunkMetadata = NULL;
@@ -1067,15 +1211,19 @@ addSingleColumn(AppendOnlyEntry *catalog,
 		 * initialize ColumnChunkMetadata
 		 *----------------------------------------------------------------*/
 		chunkmd->EncodingCount			= 3;
-		chunkmd->pEncodings 			= palloc0(chunkmd->EncodingCount * sizeof(enum Encoding));
+		/* room for PLAIN_DICTIONARY, added if the chunk has a dictionary page */
+		chunkmd->pEncodings 			= palloc0(4 * sizeof(enum Encoding));
 		chunkmd->pEncodings[0] 			= RLE; /*set definition level encoding as RLE*/
 		chunkmd->pEncodings[1] 			= RLE; /*set repetition level encoding as RLE*/
 		chunkmd->pEncodings[2] 			= PLAIN; /*set data encoding as PLAIN*/
 		chunkmd->file_offset 			= 0;
 		chunkmd->firstDataPage 			= 0;
+		chunkmd->dictionaryPageOffset	= 0;
 		chunkmd->totalSize 				= 0;
 		chunkmd->totalUncompressedSize 	= 0;
 		chunkmd->valueCount 			= 0;
+		chunkmd->nullCount 				= 0;
+		chunkmd->hasMinMax 				= 0;
 
 		if (catalog->compresstype == NULL)
 		{
@@ -1091,6 +1239,15 @@ addSingleColumn(AppendOnlyEntry *catalog,
 			{
 				chunkmd->codec = GZIP;
 			}
+			else if (0 == strcmp(catalog->compresstype, "lz4"))
+			{
+				/* a bare LZ4 block, the LZ4 codec has a hadoop framing */
+				chunkmd->codec = LZ4_RAW;
+			}
+			else if (0 == strcmp(catalog->compresstype, "zstd"))
+			{
+				chunkmd->codec = ZSTD;
+			}
 #ifdef NOT_USED
 			else if (0 == strcmp(catalog->compresstype, "lzo"))
 			{
@@ -1129,17 +1286,31 @@ addSingleColumn(AppendOnlyEntry *catalog,
 		chunk->compresslevel				= catalog->compresslevel;
 		chunk->parquetFile					= parquetFile;
 
+		/* integers and timestamps are delta encoded, repeated columns stay plain */
+		chunk->useDelta						= gp_parquet_delta_encoding &&
+											  deltaEncodable(field->hawqTypeId) &&
+											  field->r == 0;
+		if (chunk->useDelta)
+			chunkmd->pEncodings[2]			= DELTA_BINARY_PACKED;
+
+		/* bool values are bit packed, repeated columns stay plain */
+		chunk->useDictionary				= gp_parquet_dictionary_encoding &&
+											  !chunk->useDelta &&
+											  field->type != BOOLEAN &&
+											  field->r == 0;
+		chunk->dictionary					= chunk->useDictionary ?
+											  createDictionary(chunk) : NULL;
+
 		*colIndex = *colIndex + 1;
 	}
 }
 
 /*
- * Write out a specified data page (page header + page data)
+ * Write out a specified page (page header + page data)
  */
 static void
-flushDataPage(ParquetColumnChunk chunk, int page_number)
+flushDataPage(ParquetDataPage page)
 {
-	ParquetDataPage page = &chunk->pages[page_number];
 	Assert(page != NULL);
 	Assert(page->finalized);
 	Assert(page->header_buffer != NULL);
@@ -1632,6 +1803,36 @@ encodeCurrentPage(ParquetColumnChunk chunk)
 		bytes_added += BitPack_Flush(current_page->bool_values);
 	}
 
+	if (current_page->delta_values != NULL)
+	{
+		bytes_added += DeltaEncoder_Flush(current_page->delta_values);
+	}
+
+	/*
+	 * dictionary ids = <1-byte bit width> + <RLE/bit-packed ids>. A page of
+	 * nulls written before the dictionary has any value is left plain.
+	 */
+	RLEEncoder *dictionary_ids = NULL;
+	if (current_page->dictionary_ids != NULL)
+	{
+		if (chunk->dictionary->count == 0)
+		{
+			Assert(current_page->dictionary_id_count == 0);
+			header->encoding = PLAIN;
+		}
+		else
+		{
+			dictionary_ids = palloc0(sizeof(RLEEncoder));
+			RLEEncoder_Init(dictionary_ids, current_page->dictionary_bit_width);
+			for (int i = 0; i < current_page->dictionary_id_count; i++)
+			{
+				RLEEncoder_WriteInt(dictionary_ids, current_page->dictionary_ids[i]);
+			}
+			RLEEncoder_Flush(dictionary_ids);
+			bytes_added += 1 + RLEEncoder_Size(dictionary_ids);
+		}
+	}
+
 	header->uncompressed_page_size += bytes_added;
 
 	/* we must make sure there is no empty page, since some compression algorithm
@@ -1681,6 +1882,32 @@ encodeCurrentPage(ParquetColumnChunk chunk)
 		pfree(current_page->bool_values->buffer);
 		pfree(current_page->bool_values);
 	}
+	else if (current_page->dictionary_ids != NULL)
+	{
+		if (dictionary_ids != NULL)
+		{
+			uint8_t bit_width = (uint8_t) current_page->dictionary_bit_width;
+			appendBinaryStringInfo(&buf, &bit_width, 1);
+			appendBinaryStringInfo(&buf,
+								   RLEEncoder_Data(dictionary_ids),
+								   RLEEncoder_Size(dictionary_ids));
+
+			pfree(dictionary_ids->writer.buffer);
+			pfree(dictionary_ids->packBuffer);
+			pfree(dictionary_ids);
+		}
+
+		pfree(current_page->dictionary_ids);
+	}
+	else if (current_page->delta_values != NULL)
+	{
+		appendBinaryStringInfo(&buf,
+							   DeltaEncoder_Data(current_page->delta_values),
+							   DeltaEncoder_Size(current_page->delta_values));
+
+		DeltaEncoder_Free(current_page->delta_values);
+		pfree(current_page->delta_values);
+	}
 	else
 	{
 		appendBinaryStringInfo(&buf,
@@ -1690,38 +1917,139 @@ encodeCurrentPage(ParquetColumnChunk chunk)
 		pfree(current_page->values_buffer);
 	}
 
+	finalizePage(chunk, current_page, &buf);
+
+	return bytes_added;
+}
+
+/*
+ * Compress the uncompressed page data in `buf` if needed, put it in
+ * page->data and the page header in page->header_buffer.
+ *
+ * With gp_parquet_compress_threads, the compression and the page header
+ * are left to compressPendingPages when the row group is flushed.
+ */
+static void
+finalizePage(ParquetColumnChunk chunk, ParquetDataPage page, StringInfo buf)
+{
+	ParquetPageHeader header = page->header;
+	ColumnChunkMetadata chunkmd = chunk->columnChunkMetadata;
+
 	/*----------------------------------------------------------------
-	 * Compress page data if needed, saved it to current_page->data.
+	 * Compress page data if needed, saved it to page->data.
 	 *----------------------------------------------------------------*/
-	switch (chunkmd->codec)
+	if (chunkmd->codec == UNCOMPRESSED)
 	{
-		case UNCOMPRESSED:
-		{
-			current_page->data = (uint8_t*) buf.data;
-			header->compressed_page_size = header->uncompressed_page_size;
-			break;
-		}
+		page->data = (uint8_t*) buf->data;
+		header->compressed_page_size = header->uncompressed_page_size;
+	}
+	else if (gp_parquet_compress_threads > 0)
+	{
+		page->data = (uint8_t*) buf->data;
+		page->compress_pending = true;
+		page->finalized = true;
+		return;
+	}
+	else
+	{
+		size_t compressedLen = compressedLengthBound(chunkmd->codec,
+													 header->uncompressed_page_size);
+		const char *zmsg = NULL;
+		int result;
+
+		page->data = (uint8_t *) palloc(compressedLen);
+		result = compressPageData(chunkmd->codec, chunk->compresslevel,
+								  (uint8_t *) buf->data, header->uncompressed_page_size,
+								  page->data, &compressedLen, &zmsg);
+		if (result != COMPRESS_OK)
+			reportCompressError(result, zmsg);
+
+		pfree(buf->data);
+		header->compressed_page_size = compressedLen;
+	}
+
+	serializePageHeader(chunk, page);
+	page->finalized = true;
+}
+
+/*
+ * All fields of page header are filled, convert to binary page header in
+ * thrift, and add the page to the sizes of its column chunk.
+ */
+static void
+serializePageHeader(ParquetColumnChunk chunk, ParquetDataPage page)
+{
+	ParquetPageHeader header = page->header;
+	ColumnChunkMetadata chunkmd = chunk->columnChunkMetadata;
+
+	uint8_t* header_buffer = NULL;
+	if (writePageMetadata(&header_buffer, (uint32_t *) &page->header_len,
+					  page->header) < 0)
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERNAL_ERROR),
+				 errmsg("failed to serialize page metadata using thrift for column: %s", chunkmd->colName)));
+	}
 
+	page->header_buffer = (uint8_t *) palloc0(page->header_len);
+	memcpy(page->header_buffer, header_buffer, page->header_len);
+
+	chunkmd->totalUncompressedSize	+= page->header_len + header->uncompressed_page_size;
+	chunkmd->totalSize				+= page->header_len + header->compressed_page_size;
+}
+
+/*
+ * The most bytes compressPageData may put out for `len` bytes.
+ */
+static size_t
+compressedLengthBound(int codec, size_t len)
+{
+	switch (codec)
+	{
 		case SNAPPY:
-		{
-			size_t compressedLen = snappy_max_compressed_length(header->uncompressed_page_size);
-			current_page->data = (uint8_t *) palloc(compressedLen);
+			return snappy_max_compressed_length(len);
 
-			if (snappy_compress(buf.data, header->uncompressed_page_size,
-								(char *)current_page->data, &compressedLen) == SNAPPY_OK)
-			{
-				pfree(buf.data);
-				header->compressed_page_size = compressedLen;
-			}
-			else
-			{
-				ereport(ERROR,
-					(errcode(ERRCODE_GP_INTERNAL_ERROR),
-					 errmsg("snappy compression failed: %s", (char *)current_page->data)));
-			}
+		case GZIP:
+			/*
+			 * deflateBound() of a stream with a memLevel other than the
+			 * default, plus the GZIP header/tailer.
+			 */
+			return len + ((len + 7) >> 3) + ((len + 63) >> 6) + 5 + 18;
 
-			break;
+		case LZ4_RAW:
+			return LZ4_compressBound(len);
+
+		case ZSTD:
+			return ZSTD_compressBound(len);
+
+		default:
+			Insist(false);	/* shouldn't get here */
+			return 0;
+	}
+}
+
+/*
+ * Compress `srclen` bytes of page data into `dst`, of compressedLengthBound
+ * bytes. On return *dstlen is the compressed length.
+ *
+ * This neither allocates memory with palloc nor reports errors, so it can
+ * run in the compress threads. A zlib or zstd error message, if any, is
+ * returned in *zmsg.
+ */
+static int
+compressPageData(int codec, int compresslevel, const uint8_t *src, size_t srclen,
+				 uint8_t *dst, size_t *dstlen, const char **zmsg)
+{
+	switch (codec)
+	{
+		case SNAPPY:
+		{
+			if (snappy_compress((const char *) src, srclen,
+								(char *) dst, dstlen) != SNAPPY_OK)
+				return COMPRESS_SNAPPY_FAILED;
+			return COMPRESS_OK;
 		}
+
 		case GZIP:
 		{
 			int ret;
@@ -1732,91 +2060,228 @@ encodeCurrentPage(ParquetColumnChunk chunk)
 			stream.zalloc	= Z_NULL;
 			stream.zfree	= Z_NULL;
 			stream.opaque	= Z_NULL;
-			stream.avail_in	= header->uncompressed_page_size;
-			stream.next_in	= (Bytef *) buf.data;
+			stream.avail_in	= srclen;
+			stream.next_in	= (Bytef *) src;
 
-			ret = deflateInit2(&stream, chunk->compresslevel, Z_DEFLATED,
+			ret = deflateInit2(&stream, compresslevel, Z_DEFLATED,
 							   windowbits, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY);
 			if (ret != Z_OK)
 			{
-				ereport(ERROR,
-						(errcode(ERRCODE_GP_INTERNAL_ERROR),
-						 errmsg("zlib deflateInit2 failed: %s", stream.msg)));
+				*zmsg = stream.msg;
+				return COMPRESS_DEFLATEINIT_FAILED;
 			}
 
-			size_t compressedLen = header->uncompressed_page_size;
-			current_page->data = (uint8_t *) palloc(compressedLen);
+			/* the output buffer is big enough for all the input */
+			stream.next_out = (Bytef *) dst;
+			stream.avail_out = *dstlen;
 
-			Bytef *out = (Bytef *) current_page->data;
-			int outlen = compressedLen;
-			
-			/* process until all inputs have been compressed */
-			do
+			ret = deflate(&stream, Z_FINISH);
+			if (ret != Z_STREAM_END)
 			{
-				stream.next_out = out;
-				stream.avail_out = outlen;
-
-				ret = deflate(&stream, Z_FINISH);
-				if (ret == Z_STREAM_END)
-					break;
-				if (ret == Z_OK)
-				{
-					/* out buffer is not big enough, extend 4096 byte at a time */
-					outlen = 4096;
-					current_page->data = repalloc(current_page->data, compressedLen + outlen);
-					out = current_page->data + compressedLen;
-					compressedLen += outlen;
-				}
-				else
-				{
-					deflateEnd(&stream);
-					ereport(ERROR,
-							(errcode(ERRCODE_GP_INTERNAL_ERROR),
-							 errmsg("zlib deflate failed: %s", stream.msg)));
-				}
-
-			} while (1);
-
-			compressedLen = stream.total_out;
+				*zmsg = stream.msg;
+				deflateEnd(&stream);
+				return COMPRESS_DEFLATE_FAILED;
+			}
+
+			*dstlen = stream.total_out;
 			deflateEnd(&stream);
+			return COMPRESS_OK;
+		}
 
-			pfree(buf.data);
-			header->compressed_page_size = compressedLen;
-			break;
+		case LZ4_RAW:
+		{
+			int ret = LZ4_compress_default((const char *) src, (char *) dst,
+										   srclen, *dstlen);
+			if (ret <= 0)
+				return COMPRESS_LZ4_FAILED;
+			*dstlen = ret;
+			return COMPRESS_OK;
 		}
-#ifdef NOT_USED
-		case LZO:
-			/* TODO*/
-			Insist(false);
+
+		case ZSTD:
+		{
+			/* ZSTD_compress() has a context of its own, fine in a thread */
+			size_t ret = ZSTD_compress(dst, *dstlen, src, srclen,
+									   compresslevel);
+			if (ZSTD_isError(ret))
+			{
+				*zmsg = ZSTD_getErrorName(ret);
+				return COMPRESS_ZSTD_FAILED;
+			}
+			*dstlen = ret;
+			return COMPRESS_OK;
+		}
+
+		default:
+			return COMPRESS_DEFLATE_FAILED;
+	}
+}
+
+static void
+reportCompressError(int result, const char *zmsg)
+{
+	switch (result)
+	{
+		case COMPRESS_SNAPPY_FAILED:
+			ereport(ERROR,
+					(errcode(ERRCODE_GP_INTERNAL_ERROR),
+					 errmsg("snappy compression failed")));
 			break;
-#endif
+
+		case COMPRESS_DEFLATEINIT_FAILED:
+			ereport(ERROR,
+					(errcode(ERRCODE_GP_INTERNAL_ERROR),
+					 errmsg("zlib deflateInit2 failed: %s", zmsg ? zmsg : "")));
+			break;
+
+		case COMPRESS_LZ4_FAILED:
+			ereport(ERROR,
+					(errcode(ERRCODE_GP_INTERNAL_ERROR),
+					 errmsg("lz4 compression failed")));
+			break;
+
+		case COMPRESS_ZSTD_FAILED:
+			ereport(ERROR,
+					(errcode(ERRCODE_GP_INTERNAL_ERROR),
+					 errmsg("zstd compression failed: %s", zmsg ? zmsg : "")));
+			break;
+
 		default:
-			Insist(false);	/* shouldn't get here */
+			ereport(ERROR,
+					(errcode(ERRCODE_GP_INTERNAL_ERROR),
+					 errmsg("zlib deflate failed: %s", zmsg ? zmsg : "")));
 			break;
 	}
+}
 
-	/*----------------------------------------------------------------
-	 * All fields of page header are filled, convert to binary page
-	 * header in thrift.
-	 *----------------------------------------------------------------*/
-	uint8_t* header_buffer = NULL;
-	if (writePageMetadata(&header_buffer, (uint32_t *) &current_page->header_len,
-					  current_page->header) < 0)
+/*
+ * Compress the pages of a row group that finalizePage left for the compress
+ * threads, then serialize their headers.
+ *
+ * The output buffers are allocated here, and the errors reported once the
+ * threads are joined, so the threads only compress. The backend compresses
+ * pages too while it waits, and alone if no thread can be created.
+ */
+static void
+compressPendingPages(ParquetRowGroup rowgroup)
+{
+	PageCompressJobs	compressJobs;
+	pthread_t			*threads;
+	int					nthreads = 0;
+	int					maxthreads;
+	int					i;
+
+	compressJobs.njobs = 0;
+	compressJobs.next = 0;
+	for (i = 0; i < rowgroup->columnChunkNumber; i++)
 	{
-		ereport(ERROR,
-				(errcode(ERRCODE_GP_INTERNAL_ERROR),
-				 errmsg("failed to serialize page metadata using thrift for column: %s", chunkmd->colName)));
+		ParquetColumnChunk chunk = &rowgroup->columnChunks[i];
+
+		if (chunk->dictionary != NULL && chunk->dictionary->page.compress_pending)
+			compressJobs.njobs++;
+		for (int pageno = 0; pageno < chunk->pageNumber; ++pageno)
+		{
+			if (chunk->pages[pageno].compress_pending)
+				compressJobs.njobs++;
+		}
 	}
 
-	current_page->header_buffer = (uint8_t *) palloc0(current_page->header_len);
-	memcpy(current_page->header_buffer, header_buffer, current_page->header_len);
+	if (compressJobs.njobs == 0)
+		return;
 
-	chunkmd->totalUncompressedSize	+= current_page->header_len + header->uncompressed_page_size;
-	chunkmd->totalSize				+= current_page->header_len + header->compressed_page_size;
-	
-	current_page->finalized = true;
+	compressJobs.jobs = (PageCompressJob *) palloc0(compressJobs.njobs * sizeof(PageCompressJob));
+	compressJobs.njobs = 0;
+	for (i = 0; i < rowgroup->columnChunkNumber; i++)
+	{
+		ParquetColumnChunk chunk = &rowgroup->columnChunks[i];
 
-	return bytes_added;
+		for (int pageno = -1; pageno < chunk->pageNumber; ++pageno)
+		{
+			ParquetDataPage page;
+			PageCompressJob *job;
+
+			if (pageno < 0)
+			{
+				if (chunk->dictionary == NULL)
+					continue;
+				page = &chunk->dictionary->page;
+			}
+			else
+				page = &chunk->pages[pageno];
+
+			if (!page->compress_pending)
+				continue;
+
+			job = &compressJobs.jobs[compressJobs.njobs++];
+			job->chunk = chunk;
+			job->page = page;
+			job->codec = chunk->columnChunkMetadata->codec;
+			job->compresslevel = chunk->compresslevel;
+			job->dstlen = compressedLengthBound(job->codec,
+												page->header->uncompressed_page_size);
+			job->dst = (uint8_t *) palloc(job->dstlen);
+		}
+	}
+
+	maxthreads = Min(gp_parquet_compress_threads, compressJobs.njobs - 1);
+	threads = (pthread_t *) palloc(Max(maxthreads, 1) * sizeof(pthread_t));
+	for (i = 0; i < maxthreads; i++)
+	{
+		if (gp_pthread_create(&threads[nthreads], compressPagesThread,
+							  &compressJobs, "compressPendingPages") != 0)
+			break;
+		nthreads++;
+	}
+
+	compressPagesThread(&compressJobs);
+
+	for (i = 0; i < nthreads; i++)
+		pthread_join(threads[i], NULL);
+	pfree(threads);
+
+	for (i = 0; i < compressJobs.njobs; i++)
+	{
+		PageCompressJob *job = &compressJobs.jobs[i];
+		ParquetDataPage page = job->page;
+
+		if (job->result != COMPRESS_OK)
+			reportCompressError(job->result, job->zmsg);
+
+		pfree(page->data);
+		page->data = job->dst;
+		page->header->compressed_page_size = job->dstlen;
+		page->compress_pending = false;
+
+		serializePageHeader(job->chunk, page);
+	}
+
+	pfree(compressJobs.jobs);
+}
+
+/*
+ * Compress the jobs not yet taken by another thread.
+ */
+static void *
+compressPagesThread(void *arg)
+{
+	PageCompressJobs *compressJobs = (PageCompressJobs *) arg;
+
+	for (;;)
+	{
+		int32 jobno = gp_atomic_add_32(&compressJobs->next, 1) - 1;
+		PageCompressJob *job;
+
+		if (jobno >= compressJobs->njobs)
+			break;
+
+		job = &compressJobs->jobs[jobno];
+		job->result = compressPageData(job->codec, job->compresslevel,
+									   job->page->data,
+									   job->page->header->uncompressed_page_size,
+									   job->dst, &job->dstlen, &job->zmsg);
+	}
+
+	return NULL;
 }
 
 static void
@@ -1834,6 +2299,7 @@ addDataPage(ParquetColumnChunk chunk)
 	chunk->currentPage = &chunk->pages[chunk->pageNumber];
 	chunk->currentPage->data = NULL;
 	chunk->currentPage->finalized = false;
+	chunk->currentPage->compress_pending = false;
 	chunk->currentPage->header = (ParquetPageHeader) palloc0(sizeof(PageMetadata_4C));
 	chunk->currentPage->header->page_type = DATA_PAGE;
 	chunk->currentPage->header->definition_level_encoding = RLE;
@@ -1860,29 +2326,56 @@ addDataPage(ParquetColumnChunk chunk)
 		chunk->currentPage->bool_values = palloc0(sizeof(ByteBasedBitPackingEncoder));
 		BitPack_InitEncoder(chunk->currentPage->bool_values, /*bitWidth=*/1);
 	}
+	else if (chunk->useDictionary)
+	{
+		chunk->currentPage->header->encoding = PLAIN_DICTIONARY;
+		chunk->currentPage->dictionary_id_capacity = 1024;
+		chunk->currentPage->dictionary_id_count = 0;
+		chunk->currentPage->dictionary_ids =
+				palloc(chunk->currentPage->dictionary_id_capacity * sizeof(int32_t));
+		chunk->currentPage->dictionary_bit_width =
+				dictionaryBitWidth(chunk->dictionary->count);
+	}
+	else if (chunk->useDelta)
+	{
+		chunk->currentPage->header->encoding = DELTA_BINARY_PACKED;
+		chunk->currentPage->delta_values = palloc0(sizeof(DeltaEncoder));
+		DeltaEncoder_Init(chunk->currentPage->delta_values,
+						  chunk->columnChunkMetadata->type == INT64);
+	}
 	else
 	{
-		int max_buffer_size = chunk->pageSizeLimit;
-		int min_buffer_size = 512;
-		if (chunk->estimateChunkSizeRemained > max_buffer_size)
-		{
-			chunk->currentPage->values_buffer_capacity = max_buffer_size;
-			chunk->estimateChunkSizeRemained -= max_buffer_size;
-		}
-		else if (chunk->estimateChunkSizeRemained < min_buffer_size)
-		{
-			chunk->currentPage->values_buffer_capacity = min_buffer_size;
-		}
-		else
-		{
-			chunk->currentPage->values_buffer_capacity = chunk->estimateChunkSizeRemained;
-		}
-		chunk->currentPage->values_buffer = palloc0(chunk->currentPage->values_buffer_capacity);
+		initPlainValues(chunk, chunk->currentPage);
 	}
 
 	chunk->pageNumber++;
 }
 
+/*
+ * Allocate the values_buffer of a plain encoded page, of the size estimated
+ * for the page.
+ */
+static void
+initPlainValues(ParquetColumnChunk chunk, ParquetDataPage page)
+{
+	int max_buffer_size = chunk->pageSizeLimit;
+	int min_buffer_size = 512;
+	if (chunk->estimateChunkSizeRemained > max_buffer_size)
+	{
+		page->values_buffer_capacity = max_buffer_size;
+		chunk->estimateChunkSizeRemained -= max_buffer_size;
+	}
+	else if (chunk->estimateChunkSizeRemained < min_buffer_size)
+	{
+		page->values_buffer_capacity = min_buffer_size;
+	}
+	else
+	{
+		page->values_buffer_capacity = chunk->estimateChunkSizeRemained;
+	}
+	page->values_buffer = palloc0(page->values_buffer_capacity);
+}
+
 int
 appendParquetColumnNull(ParquetColumnChunk columnChunk)
 {
@@ -1909,6 +2402,7 @@ appendParquetColumnNull(ParquetColumnChunk columnChunk)
 
 	columnChunk->currentPage->header->num_values++;
 	columnChunk->columnChunkMetadata->valueCount++;
+	columnChunk->columnChunkMetadata->nullCount++;
 	return bytes_added;
 }
 
@@ -1948,6 +2442,7 @@ appendParquetColumnValue(ParquetColumnChunk chunk,
 {
 	int bytes_added = 0;
 	int encoded_len = 0;
+	int dictionary_id = -1;
 
 	/*if page is null, initialize a new page*/
 	if ((chunk->pageNumber == 0) || (chunk->currentPage == NULL))
@@ -1955,30 +2450,53 @@ appendParquetColumnValue(ParquetColumnChunk chunk,
 		addDataPage(chunk);
 	}
 
-	encoded_len = encodePlain(value,
-							  chunk->currentPage,
-							  chunk->columnChunkMetadata->hawqTypeId,
-							  chunk->pageSizeLimit);
-
-	if (encoded_len == ENCODE_INVALID_VALUE)
+	if (chunk->useDictionary)
 	{
-		ereport(ERROR,
-				(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
-				 errmsg("value for column \"%s\" exceeds pagesize %d!",
-						chunk->columnChunkMetadata->colName, chunk->pageSizeLimit)));
+		dictionary_id = addDictionaryValue(chunk, value, &encoded_len);
+
+		/* the dictionary is full, go on with plain encoding */
+		if (dictionary_id < 0)
+			bytes_added += fallbackToPlain(chunk);
 	}
 
-	if (encoded_len == ENCODE_OUTOF_PAGE)
+	if (chunk->useDelta)
+	{
+		bytes_added += appendDeltaValue(chunk, value);
+	}
+	else if (dictionary_id >= 0)
+	{
+		/* the encoded length of a new dictionary value, 0 for a known one */
+		bytes_added += encoded_len;
+		bytes_added += appendDictionaryId(chunk, dictionary_id);
+	}
+	else
 	{
-		bytes_added += finalizeCurrentAndNewPage(chunk);
 		encoded_len = encodePlain(value,
 								  chunk->currentPage,
 								  chunk->columnChunkMetadata->hawqTypeId,
 								  chunk->pageSizeLimit);
 
-	}
+		if (encoded_len == ENCODE_INVALID_VALUE)
+		{
+			ereport(ERROR,
+					(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+					 errmsg("value for column \"%s\" exceeds pagesize %d!",
+							chunk->columnChunkMetadata->colName, chunk->pageSizeLimit)));
+		}
+
+		if (encoded_len == ENCODE_OUTOF_PAGE)
+		{
+			bytes_added += finalizeCurrentAndNewPage(chunk);
+			encoded_len = encodePlain(value,
+									  chunk->currentPage,
+									  chunk->columnChunkMetadata->hawqTypeId,
+									  chunk->pageSizeLimit);
 
-	bytes_added += encoded_len;
+		}
+
+		bytes_added += encoded_len;
+		chunk->currentPage->header->uncompressed_page_size += encoded_len;
+	}
 
 	if (chunk->currentPage->repetition_level != NULL)
 	{
@@ -1990,13 +2508,406 @@ appendParquetColumnValue(ParquetColumnChunk chunk,
 	}
 
 	chunk->currentPage->header->num_values++;
-	chunk->currentPage->header->uncompressed_page_size += encoded_len;
 
 	chunk->columnChunkMetadata->valueCount++;
+	updateColumnStatistics(chunk->columnChunkMetadata, value);
+
+	return bytes_added;
+}
+
+/*
+ * Create the dictionary of a column chunk. The dictionary values are plain
+ * encoded one after the other in the values_buffer of the dictionary page,
+ * an open addressing hash table of their ids finds the value already in the
+ * dictionary.
+ */
+static ParquetDictionary
+createDictionary(ParquetColumnChunk chunk)
+{
+	ParquetDictionary dict = palloc0(sizeof(struct ParquetDictionary_S));
+
+	dict->page.header = (ParquetPageHeader) palloc0(sizeof(PageMetadata_4C));
+	dict->page.header->page_type = DICTIONARY_PAGE;
+	dict->page.header->encoding = PLAIN;
+	dict->page.parquetFile = chunk->parquetFile;
+	dict->page.finalized = false;
+	dict->page.compress_pending = false;
+	dict->page.values_buffer_capacity = 512;
+	dict->page.values_buffer = palloc0(dict->page.values_buffer_capacity);
+
+	dict->count = 0;
+	dict->capacity = 1024;
+	dict->offsets = palloc(dict->capacity * sizeof(int));
+	dict->offsets[0] = 0;
+
+	dict->nslots = 1024;
+	dict->slots = palloc(dict->nslots * sizeof(int));
+	memset(dict->slots, -1, dict->nslots * sizeof(int));
+
+	return dict;
+}
+
+/*
+ * Double the hash table of a dictionary, the values are hashed again from
+ * their plain encoding.
+ */
+static void
+growDictionarySlots(ParquetDictionary dict)
+{
+	uint8_t *values = dict->page.values_buffer;
+
+	pfree(dict->slots);
+	dict->nslots *= 2;
+	dict->slots = palloc(dict->nslots * sizeof(int));
+	memset(dict->slots, -1, dict->nslots * sizeof(int));
+
+	for (int id = 0; id < dict->count; id++)
+	{
+		uint32 hash = DatumGetUInt32(hash_any(values + dict->offsets[id],
+											  dict->offsets[id + 1] - dict->offsets[id]));
+		int slot = hash & (dict->nslots - 1);
+
+		while (dict->slots[slot] >= 0)
+			slot = (slot + 1) & (dict->nslots - 1);
+		dict->slots[slot] = id;
+	}
+}
+
+/*
+ * Find the dictionary id of a value, the value is added to the dictionary
+ * if it is a new one.
+ *
+ * @encoded_len is set to the plain encoded length of a new value, to 0
+ * otherwise.
+ *
+ * Returns -1 if the value is not in the dictionary and the dictionary is
+ * full, that is it has MAX_PARQUET_DICTIONARY_VALUES values or the new value
+ * would make the dictionary page exceed pageSizeLimit.
+ */
+static int
+addDictionaryValue(ParquetColumnChunk chunk, Datum value, int *encoded_len)
+{
+	ParquetDictionary dict = chunk->dictionary;
+	ParquetDataPage page = &dict->page;
+	int			start = page->header->uncompressed_page_size;
+	int			len;
+	int			slot;
+	int			id;
+	uint32		hash;
+
+	*encoded_len = 0;
+
+	/* encode the value after the dictionary values, to look it up */
+	len = encodePlain(value, page, chunk->columnChunkMetadata->hawqTypeId,
+					  chunk->pageSizeLimit);
+	if (len < 0)
+		return -1;
+
+	hash = DatumGetUInt32(hash_any(page->values_buffer + start, len));
+	for (slot = hash & (dict->nslots - 1);
+		 dict->slots[slot] >= 0;
+		 slot = (slot + 1) & (dict->nslots - 1))
+	{
+		id = dict->slots[slot];
+		if (dict->offsets[id + 1] - dict->offsets[id] == len &&
+			memcmp(page->values_buffer + dict->offsets[id],
+				   page->values_buffer + start, len) == 0)
+		{
+			return id;
+		}
+	}
+
+	if (dict->count >= MAX_PARQUET_DICTIONARY_VALUES)
+		return -1;
+
+	/* a new value, keep it in the dictionary */
+	id = dict->count++;
+	dict->slots[slot] = id;
+	if (dict->count >= dict->capacity)
+	{
+		dict->capacity *= 2;
+		dict->offsets = repalloc(dict->offsets, dict->capacity * sizeof(int));
+	}
+	dict->offsets[dict->count] = start + len;
+	page->header->uncompressed_page_size += len;
+	page->header->num_values++;
+
+	/* keep the hash table at most half full */
+	if (dict->count * 2 > dict->nslots)
+		growDictionarySlots(dict);
+
+	*encoded_len = len;
+	return id;
+}
+
+/*
+ * Append a dictionary id to the current page, a new page is started if the
+ * current page is full.
+ *
+ * return uncompressed bytes added to current row group
+ */
+static int
+appendDictionaryId(ParquetColumnChunk chunk, int id)
+{
+	int bytes_added = 0;
+	ParquetDataPage page;
+
+	/* If page size exceeds limit, finalize current data page and add a new one*/
+	if (approximatePageSize(chunk->currentPage) >= chunk->pageSizeLimit)
+	{
+		bytes_added += finalizeCurrentAndNewPage(chunk);
+	}
+
+	page = chunk->currentPage;
+	Assert(page->dictionary_ids != NULL);
+
+	if (page->dictionary_id_count >= page->dictionary_id_capacity)
+	{
+		page->dictionary_id_capacity *= 2;
+		page->dictionary_ids = repalloc(page->dictionary_ids,
+				page->dictionary_id_capacity * sizeof(int32_t));
+	}
+	page->dictionary_ids[page->dictionary_id_count++] = id;
+
+	/* the ids of a page are encoded with the width of its largest id */
+	page->dictionary_bit_width = dictionaryBitWidth(chunk->dictionary->count);
+
+	return bytes_added;
+}
+
+/*
+ * The types whose values are delta encoded: the integers, and the dates,
+ * times and timestamps, which are integers too when HAVE_INT64_TIMESTAMP.
+ * Money is an INT64 too, but by reference.
+ */
+static bool
+deltaEncodable(int hawqTypeId)
+{
+	switch (hawqTypeId)
+	{
+		case HAWQ_TYPE_INT2:
+		case HAWQ_TYPE_INT4:
+		case HAWQ_TYPE_INT8:
+		case HAWQ_TYPE_DATE:
+			return true;
+#ifdef HAVE_INT64_TIMESTAMP
+		case HAWQ_TYPE_TIME:
+		case HAWQ_TYPE_TIMESTAMP:
+		case HAWQ_TYPE_TIMESTAMPTZ:
+			return true;
+#endif
+		default:
+			return false;
+	}
+}
+
+/*
+ * Add a value to the delta encoded values of the current page. The deltas
+ * are bit packed a block at a time, their size is counted for the row group
+ * when the page is finalized.
+ *
+ * return uncompressed bytes added to current row group
+ */
+static int
+appendDeltaValue(ParquetColumnChunk chunk, Datum value)
+{
+	int bytes_added = 0;
+	int64 v;
+
+	/* If page size exceeds limit, finalize current data page and add a new one*/
+	if (approximatePageSize(chunk->currentPage) >= chunk->pageSizeLimit)
+	{
+		bytes_added += finalizeCurrentAndNewPage(chunk);
+	}
+
+	switch (chunk->columnChunkMetadata->hawqTypeId)
+	{
+		case HAWQ_TYPE_INT2:
+			v = DatumGetInt16(value);
+			break;
+		case HAWQ_TYPE_INT4:
+			v = DatumGetInt32(value);
+			break;
+		case HAWQ_TYPE_DATE:
+			v = DatumGetDateADT(value);
+			break;
+		default:
+			v = DatumGetInt64(value);
+			break;
+	}
+
+	Assert(chunk->currentPage->delta_values != NULL);
+	DeltaEncoder_WriteValue(chunk->currentPage->delta_values, v);
 
 	return bytes_added;
 }
 
+/*
+ * The dictionary of a column chunk is full, the following values of the
+ * chunk are plain encoded. The pages already encoded with the dictionary
+ * keep it, the dictionary page is written at the flush of the row group.
+ *
+ * return uncompressed bytes added to current row group
+ */
+static int
+fallbackToPlain(ParquetColumnChunk chunk)
+{
+	ParquetDataPage page = chunk->currentPage;
+
+	chunk->useDictionary = false;
+
+	if (page->header->num_values > 0)
+		return finalizeCurrentAndNewPage(chunk);
+
+	/* the current page has no value yet, turn it into a plain page */
+	pfree(page->dictionary_ids);
+	page->dictionary_ids = NULL;
+	page->dictionary_id_count = 0;
+	page->header->encoding = PLAIN;
+	initPlainValues(chunk, page);
+
+	return 0;
+}
+
+/*
+ * Put the final dictionary page of a column chunk in its page->data, as
+ * encodeCurrentPage does for the data pages.
+ */
+static void
+encodeDictionaryPage(ParquetColumnChunk chunk)
+{
+	ParquetDataPage page = &chunk->dictionary->page;
+	StringInfoData buf;
+
+	Assert(chunk->dictionary->count > 0);
+	Assert(!page->finalized);
+
+	initStringInfoOfSize(&buf, page->header->uncompressed_page_size + 1);
+	appendBinaryStringInfo(&buf,
+						   page->values_buffer,
+						   page->header->uncompressed_page_size);
+	pfree(page->values_buffer);
+	page->values_buffer = NULL;
+
+	finalizePage(chunk, page, &buf);
+}
+
+/*
+ * Free a dictionary, its page is freed by flushDataPage once written out.
+ */
+static void
+freeDictionary(ParquetDictionary dict)
+{
+	if (!dict->page.finalized)
+	{
+		pfree(dict->page.header);
+		pfree(dict->page.values_buffer);
+	}
+	pfree(dict->offsets);
+	pfree(dict->slots);
+	pfree(dict);
+}
+
+/*
+ * The bit width of the dictionary ids of a dictionary of `count` values.
+ */
+static int
+dictionaryBitWidth(int count)
+{
+	return widthFromMaxInt(count > 2 ? count - 1 : 1);
+}
+
+#define UPDATE_MIN_MAX(chunkmd, ctype, val, lessthan)					\
+	do {																\
+		ctype	__min;													\
+		ctype	__max;													\
+		if (!(chunkmd)->hasMinMax)										\
+		{																\
+			memcpy((chunkmd)->minValue, &(val), sizeof(ctype));		\
+			memcpy((chunkmd)->maxValue, &(val), sizeof(ctype));		\
+			(chunkmd)->hasMinMax = 1;									\
+			break;														\
+		}																\
+		memcpy(&__min, (chunkmd)->minValue, sizeof(ctype));			\
+		memcpy(&__max, (chunkmd)->maxValue, sizeof(ctype));			\
+		if (lessthan((val), __min))										\
+			memcpy((chunkmd)->minValue, &(val), sizeof(ctype));		\
+		if (lessthan(__max, (val)))										\
+			memcpy((chunkmd)->maxValue, &(val), sizeof(ctype));		\
+	} while (0)
+
+#define NUMERIC_LT(a, b)	((a) < (b))
+/* NaN is larger than any other value, as in float4lt and float8lt */
+#define FLOAT_LT(a, b)		(isnan(b) ? !isnan(a) : (!isnan(a) && (a) < (b)))
+
+/*
+ * Update the min/max statistics of a column chunk with a non-null value.
+ *
+ * Only the fixed width numeric and date/time types, whose plain encoding is
+ * also the value itself, have min/max statistics. The values are kept as
+ * they are encoded, int2 is widened to int32 as in encodePlain.
+ */
+static void
+updateColumnStatistics(ColumnChunkMetadata chunkmd, Datum value)
+{
+	switch (chunkmd->hawqTypeId)
+	{
+	case HAWQ_TYPE_INT2:
+	{
+		int32 val = (int32) DatumGetInt16(value);
+		UPDATE_MIN_MAX(chunkmd, int32, val, NUMERIC_LT);
+		break;
+	}
+	case HAWQ_TYPE_INT4:
+	{
+		int32 val = DatumGetInt32(value);
+		UPDATE_MIN_MAX(chunkmd, int32, val, NUMERIC_LT);
+		break;
+	}
+	case HAWQ_TYPE_DATE:
+	{
+		int32 val = DatumGetDateADT(value);
+		UPDATE_MIN_MAX(chunkmd, int32, val, NUMERIC_LT);
+		break;
+	}
+	case HAWQ_TYPE_INT8:
+	{
+		int64 val = DatumGetInt64(value);
+		UPDATE_MIN_MAX(chunkmd, int64, val, NUMERIC_LT);
+		break;
+	}
+#ifdef HAVE_INT64_TIMESTAMP
+	case HAWQ_TYPE_TIME:
+	{
+		int64 val = DatumGetTimeADT(value);
+		UPDATE_MIN_MAX(chunkmd, int64, val, NUMERIC_LT);
+		break;
+	}
+	case HAWQ_TYPE_TIMESTAMP:
+	case HAWQ_TYPE_TIMESTAMPTZ:
+	{
+		int64 val = DatumGetTimestamp(value);
+		UPDATE_MIN_MAX(chunkmd, int64, val, NUMERIC_LT);
+		break;
+	}
+#endif
+	case HAWQ_TYPE_FLOAT4:
+	{
+		float4 val = DatumGetFloat4(value);
+		UPDATE_MIN_MAX(chunkmd, float4, val, FLOAT_LT);
+		break;
+	}
+	case HAWQ_TYPE_FLOAT8:
+	{
+		float8 val = DatumGetFloat8(value);
+		UPDATE_MIN_MAX(chunkmd, float8, val, FLOAT_LT);
+		break;
+	}
+	default:
+		break;
+	}
+}
+
 /*
  * Append null for field. 
  *
@@ -2353,5 +3264,11 @@ approximatePageSize(ParquetDataPage page)
 	if (page->definition_level != NULL)
 		size += RLEEncoder_Size(page->definition_level);
 
+	if (page->dictionary_ids != NULL)
+		size += 1 + (page->dictionary_id_count * page->dictionary_bit_width + 7) / 8;
+
+	if (page->delta_values != NULL)
+		size += DeltaEncoder_Size(page->delta_values);
+
 	return size;
 }
@@ -115,7 +115,9 @@ static bool collapseIndexes(PartitionIndexNode **partitionIndexNode,
 static void createIndexHashTables(void);
 static IndexInfo *populateIndexInfo(cqContext *pcqCtx, HeapTuple tuple,
 					Form_pg_index indForm);
-static Node *mergeIntervals(Node *intervalFst, Node *intervalSnd);
+static Node *collapseIntervals(Node *intervalFst, Node *intervalSnd);
+static List *appendInterval(List *intervals, Node *interval);
+static Node *disjunctIntervals(List *intervals);
 static void extractStartEndRange(Node *clause, Node **ppnodeStart, Node **ppnodeEnd);
 static void extractOpExprComponents(OpExpr *opexpr, Var **ppvar, Const **ppconst, Oid *opno);
 
@@ -930,7 +932,7 @@ get_relation_part_constraints(Oid rootOid, List **defaultLevels)
 	List *partkeys = rel_partition_keys_ordered(rootOid);
 	int nLevels = list_length(partkeys);
 
-	Node *allCons = NULL;
+	List *allCons = NIL;
 	for (int level = 0; level < nLevels; level++)
 	{
 		List *partKey = (List *) list_nth(partkeys, level);
@@ -956,24 +958,18 @@ get_relation_part_constraints(Oid rootOid, List **defaultLevels)
 			}
 
 			// OR them to current constraints
-			if (NULL == allCons)
-			{
-				allCons = partCons;
-			}
-			else
-			{
-				allCons = (Node *) mergeIntervals(allCons, partCons);
-			}
+			allCons = appendInterval(allCons, partCons);
 		}
 	}
 
-	if (NULL == allCons)
+	Node *result = disjunctIntervals(allCons);
+	if (NULL == result)
 	{
-		allCons = makeBoolConst(false /*value*/, false /*isnull*/);
+		result = makeBoolConst(false /*value*/, false /*isnull*/);
 	}
 
 	list_free(partkeys);
-	return allCons;
+	return result;
 }
 
 /*
@@ -1048,6 +1044,8 @@ generateLogicalIndexPred(LogicalIndexes *li,
 
 	if (list_length(entry->partList) > 0)
 	{
+		List *intervals = NIL;
+
 		/* populate the index information */
 		li->logicalIndexInfo[*curIdx]->partCons = NULL;
 		li->logicalIndexInfo[*curIdx]->logicalIndexOid = entry->logicalIndexOid;
@@ -1072,16 +1070,10 @@ generateLogicalIndexPred(LogicalIndexes *li,
 				conList = getPartConstraints(partOid, root, NIL /*partKey*/);
 	
 				/* OR them to current constraints */
-				if (li->logicalIndexInfo[*curIdx]->partCons)
-				{
-					li->logicalIndexInfo[*curIdx]->partCons = mergeIntervals(li->logicalIndexInfo[*curIdx]->partCons, conList);						
-				}
-				else
-				{
-					li->logicalIndexInfo[*curIdx]->partCons = conList;
-				}
+				intervals = appendInterval(intervals, conList);
 			}
 		}
+		li->logicalIndexInfo[*curIdx]->partCons = disjunctIntervals(intervals);
 
 		(*curIdx)++;
 		(*numLogicalIndexes)++;
@@ -1305,16 +1297,15 @@ dumpPartsIndexInfo(PartitionIndexNode *n, int level)
 }
 
 /*
- * 	mergeIntervals
- *   merge the two intervals by creating a disjunction of the given intervals, or collapsing
- *   them into one interval when possible
+ * 	collapseIntervals
+ *   collapse the two intervals into one interval when possible
  *   
  *   This function's arguments represent two range constraints, which the function attempts
  *   to collapse into one if they share a common boundary. If no collapse is possible, 
- *   the function returns a disjunction of the two intervals.
+ *   the function returns NULL.
  */
 static Node *
-mergeIntervals(Node *intervalFst, Node *intervalSnd)
+collapseIntervals(Node *intervalFst, Node *intervalSnd)
 {
 	Node *pnodeStart1 = NULL;
 	Node *pnodeEnd1 = NULL;
@@ -1381,7 +1372,52 @@ mergeIntervals(Node *intervalFst, Node *intervalSnd)
 			return (Node *) makeBoolConst(true /*value*/, false /*isnull*/);
 		}
 	}
-	return (Node *) make_orclause(list_make2(intervalFst, intervalSnd));
+	return NULL;
+}
+
+/*
+ * appendInterval
+ *   add the interval to the list of disjunct intervals, collapsing it into the
+ *   last one when they share a common boundary
+ *
+ *   The parts come in the order of their ranges, so a run of adjacent parts
+ *   collapses into one interval, and a gap between the ranges only starts a new
+ *   one. The OR of the intervals is kept flat instead of nested one level per
+ *   part, whose size and depth grow with the number of parts.
+ */
+static List *
+appendInterval(List *intervals, Node *interval)
+{
+	if (NIL != intervals)
+	{
+		Node *collapsed = collapseIntervals((Node *) llast(intervals), interval);
+		if (NULL != collapsed)
+		{
+			llast(intervals) = collapsed;
+			return intervals;
+		}
+	}
+	return lappend(intervals, interval);
+}
+
+/*
+ * disjunctIntervals
+ *   return the disjunction of the intervals, or NULL if there is none
+ */
+static Node *
+disjunctIntervals(List *intervals)
+{
+	if (NIL == intervals)
+	{
+		return NULL;
+	}
+	if (1 == list_length(intervals))
+	{
+		Node *interval = (Node *) linitial(intervals);
+		list_free(intervals);
+		return interval;
+	}
+	return (Node *) make_orclause(intervals);
 }
 
 /*
@@ -2797,6 +2797,39 @@ rel_get_leaf_children_relids(Oid relid)
 	return leaf_relids;
 }
 
+/*
+ * Return a hash set, in the current memory context, of the Oids of all
+ * leaf-level children of a root or interior partition.  Used instead of
+ * calling rel_is_leaf_partition() for each member of a big partition set,
+ * which does several catalog lookups per relation.
+ */
+HTAB *
+rel_get_leaf_partition_set(Oid relid)
+{
+	List *leaf_relids = rel_get_leaf_children_relids(relid);
+	HASHCTL hash_ctl;
+	HTAB *leaves;
+	ListCell *lc;
+
+	MemSet(&hash_ctl, 0, sizeof(hash_ctl));
+	hash_ctl.keysize = sizeof(Oid);
+	hash_ctl.entrysize = sizeof(Oid);
+	hash_ctl.hash = oid_hash;
+	hash_ctl.hcxt = CurrentMemoryContext;
+	leaves = hash_create("leaf partitions", Max(list_length(leaf_relids), 16),
+						 &hash_ctl, HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+
+	foreach(lc, leaf_relids)
+	{
+		Oid leaf = lfirst_oid(lc);
+
+		hash_search(leaves, &leaf, HASH_ENTER, NULL);
+	}
+	list_free(leaf_relids);
+
+	return leaves;
+}
+
 /* Return the pg_class Oids of the relations representing interior parts of the
  * PartitionNode tree headed by the argument PartitionNode.
  *
@@ -3472,6 +3505,175 @@ static bool compare_partn_opfuncid(PartitionNode *partnode,
 	return true;
 } /* end compare_partn_opfuncid */
 
+/*
+ * Hash index of the values of a single column partition-by-list
+ * PartitionNode, kept in PartitionListState.indexes.
+ */
+#define PARTITION_LIST_INDEX_MIN_RULES 8
+
+typedef struct PartitionListIndex
+{
+	PartitionNode *partnode;	/* hash key */
+	List	   *rules;			/* partnode->rules the index was built from */
+	Oid			typid;			/* type of the values */
+	bool		usable;			/* false if the type can't be hashed */
+	FmgrInfo	hashfunc;
+	FmgrInfo	eqfunc;
+	int			nvalues;
+	uint32		mask;			/* number of buckets - 1 */
+	int		   *buckets;		/* first value in each bucket, or -1 */
+	int		   *next;			/* next value in the same bucket, or -1 */
+	uint32	   *hashes;
+	Datum	   *values;
+	PartitionRule **valrules;	/* rule holding each value */
+	PartitionRule *nullrule;	/* rule holding the NULL value, if any */
+} PartitionListIndex;
+
+/*
+ * Build, or find, the hash index of the values of a single column
+ * partition-by-list PartitionNode.  Returns NULL if the values of the type
+ * can't be hashed, in which case the rules are searched one by one.
+ */
+static PartitionListIndex *
+getListPartitionIndex(PartitionNode *partnode, PartitionListState *ls, Oid typid)
+{
+	PartitionListIndex *idx;
+	MemoryContext oldcxt;
+	List *opname;
+	Oid opno;
+	Oid hashproc;
+	ListCell *lc;
+	bool found;
+	int nvalues = 0;
+	int nbuckets = 1;
+	int i;
+
+	if (ls->indexes == NULL)
+	{
+		HASHCTL ctl;
+
+		MemSet(&ctl, 0, sizeof(ctl));
+		ctl.keysize = sizeof(PartitionNode *);
+		ctl.entrysize = sizeof(PartitionListIndex);
+		ctl.hash = tag_hash;
+		ctl.hcxt = ls->index_cxt;
+		ls->indexes = hash_create("partition list index", 8, &ctl,
+								  HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+	}
+
+	idx = (PartitionListIndex *) hash_search(ls->indexes, &partnode,
+											 HASH_ENTER, &found);
+	if (found && idx->rules == partnode->rules && idx->typid == typid)
+		return idx->usable ? idx : NULL;
+
+	idx->rules = partnode->rules;
+	idx->typid = typid;
+	idx->usable = false;
+	idx->nvalues = 0;
+	idx->nullrule = NULL;
+
+	opname = list_make2(makeString("pg_catalog"), makeString("="));
+	opno = OpernameGetOprid(opname, typid, typid);
+	list_free_deep(opname);
+
+	hashproc = OidIsValid(opno) ? get_op_hash_function(opno) : InvalidOid;
+	if (!OidIsValid(hashproc))
+		return NULL;
+
+	foreach(lc, partnode->rules)
+	{
+		PartitionRule *rule = lfirst(lc);
+
+		nvalues += list_length(rule->parlistvalues);
+	}
+
+	while (nbuckets < nvalues * 2)
+		nbuckets <<= 1;
+
+	oldcxt = MemoryContextSwitchTo(ls->index_cxt);
+
+	fmgr_info(hashproc, &idx->hashfunc);
+	fmgr_info(get_opcode(opno), &idx->eqfunc);
+
+	idx->mask = nbuckets - 1;
+	idx->buckets = palloc(sizeof(int) * nbuckets);
+	idx->next = palloc(sizeof(int) * Max(nvalues, 1));
+	idx->hashes = palloc(sizeof(uint32) * Max(nvalues, 1));
+	idx->values = palloc(sizeof(Datum) * Max(nvalues, 1));
+	idx->valrules = palloc(sizeof(PartitionRule *) * Max(nvalues, 1));
+
+	MemoryContextSwitchTo(oldcxt);
+
+	/* the values, in the order the rules are searched in */
+	foreach(lc, partnode->rules)
+	{
+		PartitionRule *rule = lfirst(lc);
+		ListCell *lc2;
+
+		foreach(lc2, rule->parlistvalues)
+		{
+			Const *c = linitial((List *) lfirst(lc2));
+
+			Assert(IsA(c, Const));
+
+			if (c->constisnull)
+			{
+				if (idx->nullrule == NULL)
+					idx->nullrule = rule;
+				continue;
+			}
+
+			i = idx->nvalues++;
+			idx->values[i] = c->constvalue;
+			idx->valrules[i] = rule;
+			idx->hashes[i] = DatumGetUInt32(FunctionCall1(&idx->hashfunc,
+														  c->constvalue));
+		}
+	}
+
+	/*
+	 * Chain the values of each bucket, the earliest first so that a value
+	 * listed twice is found in the same rule as by the sequential search.
+	 */
+	for (i = 0; i < nbuckets; i++)
+		idx->buckets[i] = -1;
+	for (i = idx->nvalues - 1; i >= 0; i--)
+	{
+		uint32 b = idx->hashes[i] & idx->mask;
+
+		idx->next[i] = idx->buckets[b];
+		idx->buckets[b] = i;
+	}
+
+	idx->usable = true;
+	return idx;
+}
+
+/*
+ * Find the rule of a partition-by-list PartitionNode holding a value, with
+ * the index of its values.
+ */
+static PartitionRule *
+lookupListPartitionIndex(PartitionListIndex *idx, Datum value, bool isnull)
+{
+	uint32 hash;
+	int i;
+
+	if (isnull)
+		return idx->nullrule;
+
+	hash = DatumGetUInt32(FunctionCall1(&idx->hashfunc, value));
+
+	for (i = idx->buckets[hash & idx->mask]; i >= 0; i = idx->next[i])
+	{
+		if (idx->hashes[i] == hash &&
+			DatumGetBool(FunctionCall2(&idx->eqfunc, value, idx->values[i])))
+			return idx->valrules[i];
+	}
+
+	return NULL;
+}
+
 /*
  *	Given a partition-by-list PartitionNode, search for
  *	a part that matches the given datum value.
@@ -3505,6 +3707,8 @@ selectListPartition(PartitionNode *partnode, Datum *values, bool *isnull,
 		
 		ls->eqfuncs = palloc(sizeof(FmgrInfo) * natts);
 		ls->eqinit = palloc0(sizeof(bool) * natts);
+		ls->indexes = NULL;
+		ls->index_cxt = CurrentMemoryContext;
 		
 		if (accessMethods)
 			accessMethods->amstate[partnode->part->parlevel] = (void *)ls;
@@ -3515,7 +3719,42 @@ selectListPartition(PartitionNode *partnode, Datum *values, bool *isnull,
 	
 	*foundOid = InvalidOid;
 	
-	/* With LIST, we have no choice at the moment except to be exhaustive */
+	/*
+	 * A single column LIST partitioning with many values is searched with
+	 * a hash index of its values, built the first time we search it.  Only
+	 * when the lookup state is kept across calls, and the expression has the
+	 * type of the partitioning key, so that a hash of the type fits it.
+	 */
+	if (accessMethods && part->parnatts == 1 &&
+		list_length(partnode->rules) >= PARTITION_LIST_INDEX_MIN_RULES)
+	{
+		AttrNumber attno = part->paratts[0];
+		Oid typid = tupdesc->attrs[attno - 1]->atttypid;
+		PartitionListIndex *idx = NULL;
+
+		if (!OidIsValid(exprTypeOid) || exprTypeOid == typid)
+			idx = getListPartitionIndex(partnode, ls, typid);
+
+		if (idx)
+		{
+			PartitionRule *rule = lookupListPartitionIndex(idx, values[attno - 1],
+														   isnull[attno - 1]);
+
+			if (oldcxt)
+				MemoryContextSwitchTo(oldcxt);
+
+			if (rule == NULL)
+				return NULL;
+
+			*foundOid = rule->parchildrelid;
+			*prule = rule;
+
+			/* go to the next level */
+			return rule->children;
+		}
+	}
+
+	/* Otherwise, with LIST, we have no choice except to be exhaustive */
 	foreach(lc, partnode->rules)
 	{
 		PartitionRule *rule = lfirst(lc);
@@ -3851,22 +4090,34 @@ selectRangePartition(PartitionNode *partnode, Datum *values, bool *isnull,
 			rs->lefuncs_inverse[keyno].fn_oid = InvalidOid;
 		}
 
-		/*
-		 * Unrolling the rules into an array currently works for the
-		 * top level partition only
-		 */
-		if (partnode->part->parlevel == 0)
+		rs->rules_size = Max(list_length(rules), 1);
+		rs->rules = palloc(sizeof(PartitionRule *) * rs->rules_size);
+		rs->rules_node = NULL;
+		rs->rules_list = NIL;
+	}
+
+	/*
+	 * Unroll the rules into an array for the binary search.  The state is
+	 * shared by the PartitionNodes of a level, so this is redone when the
+	 * search moves to another one, which below the top level happens as
+	 * the parent rule changes.
+	 */
+	if (rs->rules_node != partnode || rs->rules_list != rules)
+	{
+		int i = 0;
+		ListCell *lc;
+
+		if (list_length(rules) > rs->rules_size)
 		{
-			int i = 0;
-			ListCell *lc;
-			
-			rs->rules = palloc(sizeof(PartitionRule *) * list_length(rules));
-			
-			foreach(lc, rules)
-			rs->rules[i++] = (PartitionRule *)lfirst(lc);
+			rs->rules_size = list_length(rules);
+			rs->rules = repalloc(rs->rules, sizeof(PartitionRule *) * rs->rules_size);
 		}
-		else
-			rs->rules = NULL;
+
+		foreach(lc, rules)
+			rs->rules[i++] = (PartitionRule *)lfirst(lc);
+
+		rs->rules_node = partnode;
+		rs->rules_list = rules;
 	}
 	
 	if (accessMethods && accessMethods->part_cxt)
@@ -3903,10 +4154,7 @@ selectRangePartition(PartitionNode *partnode, Datum *values, bool *isnull,
 		
 		mid = low + (high - low)/2;
 		
-		if (rs->rules)
-			rule = rs->rules[mid];
-		else
-			rule = (PartitionRule *)list_nth(rules, mid);
+		rule = rs->rules[mid];
 		
 		if (isnull[attno - 1])
 		{
@@ -3975,7 +4223,7 @@ selectRangePartition(PartitionNode *partnode, Datum *values, bool *isnull,
 				int ret;
 				
 				if (j != mid)
-					rule = (PartitionRule *)list_nth(rules, j);
+					rule = rs->rules[j];
 				
 				if (isnull[attno - 1])
 				{
@@ -4031,7 +4279,7 @@ selectRangePartition(PartitionNode *partnode, Datum *values, bool *isnull,
 				Datum d = values[attno - 1];
 				int ret;
 				
-				rule = (PartitionRule *)list_nth(rules, j);
+				rule = rs->rules[j];
 				
 				if (isnull[attno - 1])
 				{
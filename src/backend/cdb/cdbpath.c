@@ -30,6 +30,7 @@ extern "C" {
 #endif
 
 #include "catalog/pg_proc.h"    /* CDB_PROC_TIDTOI8 */
+#include "catalog/pg_statistic.h"   /* STATISTIC_KIND_MCV */
 #include "catalog/pg_type.h"    /* INT8OID */
 #include "miscadmin.h"          /* work_mem */
 #include "nodes/makefuncs.h"    /* makeFuncExpr() */
@@ -37,12 +38,16 @@ extern "C" {
 #include "optimizer/cost.h"     /* cpu_tuple_cost */
 #include "optimizer/pathnode.h" /* Path, pathnode_walker() */
 #include "optimizer/paths.h"    /* compare_pathkeys() */
+#include "optimizer/var.h"      /* pull_varnos() */
 
 #include "parser/parse_expr.h"	/* exprType() */
+#include "utils/lsyscache.h"    /* get_attstatsslot() */
+#include "utils/selfuncs.h"     /* examine_variable() */
 
 #include "cdb/cdbdef.h"         /* CdbSwap() */
 #include "cdb/cdbllize.h"       /* makeFlow() */
 #include "cdb/cdbhash.h"        /* isGreenplumDbHashable() */
+#include "cdb/cdbvars.h"        /* gp_redistribute_skew_threshold */
 
 #include "cdb/cdbpath.h"        /* me */
 
@@ -683,6 +688,128 @@ typedef struct
         bool            require_existing_order;
 } CdbpathMfjRel;
 
+/*
+ * cdbpath_skewed_key_hashes
+ *
+ * Returns the hashes of the hot keys of a path to be redistributed on a
+ * single column: its most common values, and NULL, whose frequency reaches
+ * gp_redistribute_skew_threshold.  NIL if there are none, or no statistics.
+ */
+static List *
+cdbpath_skewed_key_hashes(PlannerInfo *root, Path *path, CdbPathLocus locus)
+{
+    VariableStatData    vardata;
+    HeapTuple           statsTuple;
+    Node               *key = NULL;
+    CdbHash            *h;
+    List               *hashes = NIL;
+    ListCell           *cell;
+    Datum              *values;
+    int                 nvalues;
+    float4             *numbers;
+    int                 nnumbers;
+    int                 i;
+
+    if (CdbPathLocus_Degree(locus) != 1)
+        return NIL;
+
+    /* The key of the pathkey which belongs to this rel. */
+    foreach(cell, (List *) linitial(locus.partkey))
+    {
+        PathKeyItem    *item = (PathKeyItem *) lfirst(cell);
+
+        if (IsA(item->key, Var) &&
+            bms_is_subset(pull_varnos(item->key), path->parent->relids))
+        {
+            key = item->key;
+            break;
+        }
+    }
+    if (!key)
+        return NIL;
+
+    examine_variable(root, key, 0, &vardata);
+    statsTuple = getStatsTuple(&vardata);
+    if (!HeapTupleIsValid(statsTuple))
+    {
+        ReleaseVariableStats(vardata);
+        return NIL;
+    }
+
+    h = makeCdbHash(root->config->cdbpath_segments, HASH_FNV_1);
+
+    if (((Form_pg_statistic) GETSTRUCT(statsTuple))->stanullfrac >= gp_redistribute_skew_threshold)
+    {
+        cdbhashinit(h);
+        cdbhashnull(h);
+        hashes = lappend_int(hashes, (int) h->hash);
+    }
+
+    if (get_attstatsslot(statsTuple,
+                         vardata.atttype, vardata.atttypmod,
+                         STATISTIC_KIND_MCV, InvalidOid,
+                         &values, &nvalues, &numbers, &nnumbers))
+    {
+        for (i = 0; i < nvalues && i < nnumbers; i++)
+        {
+            if (numbers[i] < gp_redistribute_skew_threshold)
+                continue;
+
+            /* hashed as the Motion hashes the key, see evalHashKey() */
+            cdbhashinit(h);
+            cdbhash(h, values[i], vardata.vartype);
+            hashes = list_append_unique_int(hashes, (int) h->hash);
+        }
+        free_attstatsslot(vardata.atttype, values, nvalues, numbers, nnumbers);
+    }
+
+    pfree(h);
+    ReleaseVariableStats(vardata);
+
+    return hashes;
+}                               /* cdbpath_skewed_key_hashes */
+
+/*
+ * cdbpath_skew_split
+ *
+ * Both rels of a join are to be redistributed on the equijoin cols.  If one
+ * of them has hot keys, the rows with them would all go to a few segments.
+ * These rows are spread over all the segments instead, and the rows of the
+ * other rel with the same keys are broadcast, so that each of them still
+ * meets all the rows it joins with, once.  The other rel is replicated in
+ * part, it must be one which can be replicated in this join.
+ *
+ * Returns the hashes of the hot keys and sets *p_spread to the rel to
+ * spread, or returns NIL.
+ */
+static List *
+cdbpath_skew_split(PlannerInfo     *root,
+                   JoinType         jointype,
+                   CdbpathMfjRel   *large,
+                   CdbpathMfjRel   *small,
+                   CdbpathMfjRel  **p_spread)
+{
+    List   *hashes = NIL;
+
+    if (gp_redistribute_skew_threshold <= 0.0 ||
+        root->config->cdbpath_segments <= 1 ||
+        jointype == JOIN_LASJ_NOTIN)
+        return NIL;
+
+    if (small->ok_to_replicate)
+    {
+        hashes = cdbpath_skewed_key_hashes(root, large->path, large->move_to);
+        *p_spread = large;
+    }
+    if (!hashes && large->ok_to_replicate)
+    {
+        hashes = cdbpath_skewed_key_hashes(root, small->path, small->move_to);
+        *p_spread = small;
+    }
+
+    return hashes;
+}                               /* cdbpath_skew_split */
+
 CdbPathLocus
 cdbpath_motion_for_join(PlannerInfo    *root,
                         JoinType        jointype,           /* JOIN_INNER/FULL/LEFT/RIGHT/IN */
@@ -696,6 +823,8 @@ cdbpath_motion_for_join(PlannerInfo    *root,
 {
     CdbpathMfjRel   outer;
     CdbpathMfjRel   inner;
+    CdbpathMfjRel  *skewSpread = NULL;
+    List           *skewHashes = NIL;
 
     outer.path  = *p_outer_path;
     inner.path  = *p_inner_path;
@@ -919,7 +1048,7 @@ cdbpath_motion_for_join(PlannerInfo    *root,
                  small->bytes * root->config->cdbpath_segments < large->bytes + small->bytes)
             CdbPathLocus_MakeReplicated(&small->move_to);
 
-        /* Redistribute both rels on equijoin cols. */
+        /* Redistribute both rels on equijoin cols, splitting the hot keys. */
         else if (!small->require_existing_order &&
                  !large->require_existing_order &&
                  cdbpath_partkeys_from_preds(root,
@@ -927,7 +1056,7 @@ cdbpath_motion_for_join(PlannerInfo    *root,
                                              large->path,
                                              &large->move_to,
                                              &small->move_to))
-        {}
+            skewHashes = cdbpath_skew_split(root, jointype, large, small, &skewSpread);
 
         /* No usable equijoin preds, or couldn't consider the preferred motion.
          * Replicate one rel if possible.
@@ -982,6 +1111,28 @@ cdbpath_motion_for_join(PlannerInfo    *root,
     *p_outer_path = outer.path;
     *p_inner_path = inner.path;
 
+    /*
+     * The hot rows are not where the hash of their key says, the join is
+     * not partitioned on the key anymore.
+     */
+    if (skewHashes != NIL)
+    {
+        CdbpathMfjRel  *skewBroadcast = (skewSpread == &outer) ? &inner : &outer;
+
+        if (IsA(skewSpread->path, CdbMotionPath) &&
+            IsA(skewBroadcast->path, CdbMotionPath))
+        {
+            CdbPathLocus    locus;
+
+            ((CdbMotionPath *) skewSpread->path)->skewHashes = skewHashes;
+            ((CdbMotionPath *) skewBroadcast->path)->skewHashes = skewHashes;
+            ((CdbMotionPath *) skewBroadcast->path)->skewBroadcast = true;
+
+            CdbPathLocus_MakeStrewn(&locus);
+            return locus;
+        }
+    }
+
     /* Tell caller where the join will be done. */
     return cdbpathlocus_join(outer.path->locus, inner.path->locus);
 
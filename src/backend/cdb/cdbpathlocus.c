@@ -380,6 +380,37 @@ cdbpathlocus_from_exprs(struct PlannerInfo *root,
 }                               /* cdbpathlocus_from_exprs */
 
 
+/*
+ * cdbpathlocus_canonicalize
+ *
+ * Returns a locus equivalent to the given one, whose partkey is made of
+ * canonical pathkeys.  The scans of an appendrel's children are hashed on
+ * non-canonical pathkeys (see cdb_build_distribution_pathkeys), which can't
+ * be matched to join predicates.  A join of two children needs this to be
+ * seen as colocated.
+ */
+CdbPathLocus
+cdbpathlocus_canonicalize(struct PlannerInfo   *root,
+                          CdbPathLocus          locus)
+{
+    List           *exprs = NIL;
+    ListCell       *cell;
+
+    if (!CdbPathLocus_IsHashed(locus))
+        return locus;
+
+    foreach(cell, locus.partkey)
+    {
+        List           *pathkey = (List *)lfirst(cell);
+        PathKeyItem    *item = (PathKeyItem *)linitial(pathkey);
+
+        exprs = lappend(exprs, item->key);
+    }
+
+    return cdbpathlocus_from_exprs(root, exprs);
+}                               /* cdbpathlocus_canonicalize */
+
+
 /*
  * cdbpathlocus_from_subquery
  *
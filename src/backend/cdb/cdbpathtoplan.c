@@ -199,6 +199,10 @@ cdbpathtoplan_create_motion_plan(PlannerInfo   *root,
         motion = make_hashed_motion(subplan,
                                     hashExpr,
                                     false /* useExecutorVarFormat */);
+
+        /* Hot keys of a skewed join, see cdbpath_skew_split() */
+        motion->skewHashes = list_copy(path->skewHashes);
+        motion->skewBroadcast = path->skewBroadcast;
     }
     else
         Insist(0);
@@ -124,7 +124,9 @@ enum QueryContextDispatchingObjType
 	LangType,
 	TypeType,
 	OpType,
-	OpClassType
+	OpClassType,
+	PlugStorageSnapshotType,
+	PrefetchedRelationType	/* attributes and constraints already added */
 };
 typedef enum QueryContextDispatchingObjType QueryContextDispatchingObjType;
 
@@ -185,6 +187,9 @@ addOperatorToDispatchContext(QueryContextInfo *ctx, Oid opOid);
 static void
 WriteData(QueryContextInfo *cxt, const char *buffer, int size);
 
+static void
+EnableInMemHeapWithIndexScan(Oid relid, bool *enable, int *attrno);
+
 static void GetExtTableLocationsArray(HeapTuple tuple, TupleDesc exttab_desc, 
 									  Datum **array, int *array_size);
 static char* 
@@ -641,6 +646,8 @@ RebuildEmptyTable(QueryContextInfo *cxt)
 {
     Oid relid;
     char buffer[4];
+    bool indexOk;
+    int attrno;
 
     Relation rel;
     InMemHeapRelation inmemrel;
@@ -653,8 +660,9 @@ RebuildEmptyTable(QueryContextInfo *cxt)
     Assert(NULL == inmemrel);
 
     rel = heap_open(relid, AccessShareLock);
+    EnableInMemHeapWithIndexScan(relid, &indexOk, &attrno);
     inmemrel = InMemHeap_Create(relid, rel, TRUE, 10, AccessShareLock,
-            RelationGetRelationName(rel), FALSE, 0, INMEM_HEAP_MAPPING);
+            RelationGetRelationName(rel), indexOk, attrno, INMEM_HEAP_MAPPING);
     Assert(NULL != inmemrel);
 
 }
@@ -693,17 +701,60 @@ RebuildTablespaceLocation(QueryContextInfo *cxt)
 
 }
 
+/*
+ * The dispatched catalogs get a hash index on the key they are mostly
+ * looked up by on the QEs, the oid or the relation they describe.  Other
+ * keys of a lookup are checked on the tuples the index finds.
+ */
 static void
 EnableInMemHeapWithIndexScan(Oid relid, bool *enable, int *attrno)
 {
     Assert(NULL != enable && NULL != attrno);
 
+    *enable = true;
+
     switch(relid)
     {
+        case RelationRelationId:
+        case TypeRelationId:
+        case NamespaceRelationId:
+        case ProcedureRelationId:
+        case OperatorRelationId:
+        case OperatorClassRelationId:
+        case LanguageRelationId:
+        case AuthIdRelationId:
+            *attrno = ObjectIdAttributeNumber;
+            break;
         case AttributeRelationId:
-            *enable = true;
             *attrno = Anum_pg_attribute_attrelid;
             break;
+        case AttrDefaultRelationId:
+            *attrno = Anum_pg_attrdef_adrelid;
+            break;
+        case AttributeEncodingRelationId:
+            *attrno = Anum_pg_attribute_encoding_attrelid;
+            break;
+        case ConstraintRelationId:
+            *attrno = Anum_pg_constraint_conrelid;
+            break;
+        case GpPolicyRelationId:
+            *attrno = Anum_gp_policy_localoid;
+            break;
+        case AppendOnlyRelationId:
+            *attrno = Anum_pg_appendonly_relid;
+            break;
+        case ExtTableRelationId:
+            *attrno = Anum_pg_exttable_reloid;
+            break;
+        case AggregateRelationId:
+            *attrno = Anum_pg_aggregate_aggfnoid;
+            break;
+        case AccessMethodOperatorRelationId:
+            *attrno = Anum_pg_amop_amopclaid;
+            break;
+        case AccessMethodProcedureRelationId:
+            *attrno = Anum_pg_amproc_amopclaid;
+            break;
         default:
             *enable = false;
             *attrno = 0;
@@ -1047,6 +1098,9 @@ AddTupleWithToastsToContextInfo(QueryContextInfo *cxt, Oid relid,
     Assert(NULL != cxt);
     // first add this tuple
     AddTupleToContextInfo(cxt, relid, relname, tuple, contentid);
+    // most catalog tuples are not toasted, skip opening and deforming them
+    if (!HeapTupleHasExternal(tuple))
+        return;
     // add related toast tuples
     rel = heap_open(relid, AccessShareLock);
     Assert(NULL != rel);
@@ -1165,6 +1219,16 @@ alreadyAddedForDispatching(HTAB *rels, Oid objid, QueryContextDispatchingObjType
 }
 
 
+static bool
+isPrefetchedForDispatching(HTAB *rels, Oid relid) {
+    QueryContextDispatchingHashKey item;
+
+    item.objid = relid;
+    item.type = PrefetchedRelationType;
+
+    return hash_search(rels, &item, HASH_FIND, NULL) != NULL;
+}
+
 /*
  * collect pg_namespace tuples for oid.
  * add them to in-memory heap table for dispatcher
@@ -1234,6 +1298,10 @@ prepareDispatchedPlugStorageSnapshot(QueryContextInfo *cxt, MagmaSnapshot *snaps
         return;
     }
 
+    /* one snapshot for the statement, not one per dispatched relation */
+    if (alreadyAddedForDispatching(cxt->htab, InvalidOid, PlugStorageSnapshotType))
+        return;
+
     StringInfoData header;
     initStringInfo(&header);
 
@@ -1426,8 +1494,11 @@ prepareDispatchedCatalogAttribute(QueryContextInfo *cxt,
 
         if (attr->attnum > 0)
         {
-            /* check attribute type */
-            if (OidIsValid(attr->atttypid))
+            /*
+             * check attribute type, the row types of builtin relations are
+             * never dispatched
+             */
+            if (attr->atttypid >= FirstNormalObjectId)
                 prepareDispatchedCatalogCompositeType(cxt, attr->atttypid);
         }
 
@@ -1562,6 +1633,126 @@ static void prepareDispatchedCatalogConstraint(QueryContextInfo *cxt,
   caql_endscan(pcqCtx);
 }
 
+/*
+ * collect the tuples of a catalog which belong to one of the relations in
+ * the set, with one scan of the catalog.
+ */
+static void
+prefetchDispatchedCatalogTuples(QueryContextInfo *cxt, HTAB *relids,
+        Oid catalogid, const char *catalogname, AttrNumber relidattno)
+{
+    Relation rel;
+    HeapScanDesc scandesc;
+    HeapTuple tuple;
+
+    rel = heap_open(catalogid, AccessShareLock);
+    scandesc = heap_beginscan(rel, SnapshotNow, 0, NULL);
+    while (HeapTupleIsValid(tuple = heap_getnext(scandesc, ForwardScanDirection)))
+    {
+        bool isnull;
+        Oid relid = DatumGetObjectId(heap_getattr(tuple, relidattno,
+                RelationGetDescr(rel), &isnull));
+
+        if (isnull || !hash_search(relids, &relid, HASH_FIND, NULL))
+            continue;
+
+        if (catalogid == AttributeRelationId)
+        {
+            Form_pg_attribute attr = (Form_pg_attribute) GETSTRUCT(tuple);
+
+            /* as in prepareDispatchedCatalogAttribute */
+            if (attr->attnum > 0 && attr->atttypid >= FirstNormalObjectId)
+                prepareDispatchedCatalogCompositeType(cxt, attr->atttypid);
+
+            AddTupleToContextInfo(cxt, catalogid, catalogname, tuple,
+                    MASTER_CONTENT_ID);
+        }
+        else
+            AddTupleWithToastsToContextInfo(cxt, catalogid, catalogname, tuple,
+                    MASTER_CONTENT_ID);
+    }
+    heap_endscan(scandesc);
+    heap_close(rel, AccessShareLock);
+}
+
+/*
+ * collect the pg_attribute, pg_attribute_encoding and pg_constraint tuples
+ * of many relations at once, e.g. the partitions of a table.
+ *
+ * Each catalog is scanned once instead of with an index scan per relation,
+ * when there are enough relations for that to read fewer pages.  The
+ * relations are marked, for prepareDispatchedCatalogSingleRelation to skip
+ * those catalogs.
+ */
+#define PREFETCH_PAGES_PER_RELATION 4
+
+static void
+prefetchDispatchedCatalogRelations(QueryContextInfo *cxt, List *relids)
+{
+    HASHCTL hash_ctl;
+    HTAB *relidset;
+    Relation rel;
+    BlockNumber nblocks;
+    ListCell *lc;
+    int nrelids = 0;
+
+    rel = heap_open(AttributeRelationId, AccessShareLock);
+    nblocks = RelationGetNumberOfBlocks(rel);
+    heap_close(rel, AccessShareLock);
+
+    if ((double) list_length(relids) * PREFETCH_PAGES_PER_RELATION < nblocks)
+        return;
+
+    MemSet(&hash_ctl, 0, sizeof(hash_ctl));
+    hash_ctl.keysize = sizeof(Oid);
+    hash_ctl.entrysize = sizeof(Oid);
+    hash_ctl.hash = oid_hash;
+    hash_ctl.hcxt = CurrentMemoryContext;
+    relidset = hash_create("Query Context prefetched relations",
+            list_length(relids), &hash_ctl,
+            HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+
+    foreach(lc, relids)
+    {
+        Oid relid = lfirst_oid(lc);
+        QueryContextDispatchingHashKey item;
+
+        if (relid < FirstNormalObjectId)
+            continue;
+
+        /* relations added already have their attributes dispatched */
+        item.objid = relid;
+        item.type = RelationType;
+        if (hash_search(cxt->htab, &item, HASH_FIND, NULL))
+            continue;
+
+        hash_search(relidset, &relid, HASH_ENTER, NULL);
+        nrelids++;
+    }
+
+    if (nrelids > 0)
+    {
+        prefetchDispatchedCatalogTuples(cxt, relidset, AttributeRelationId,
+                "pg_attribute", Anum_pg_attribute_attrelid);
+        prefetchDispatchedCatalogTuples(cxt, relidset,
+                AttributeEncodingRelationId, "pg_attribute_encoding",
+                Anum_pg_attribute_encoding_attrelid);
+        prefetchDispatchedCatalogTuples(cxt, relidset, ConstraintRelationId,
+                "pg_constraint", Anum_pg_constraint_conrelid);
+
+        foreach(lc, relids)
+        {
+            Oid relid = lfirst_oid(lc);
+
+            if (hash_search(relidset, &relid, HASH_FIND, NULL))
+                alreadyAddedForDispatching(cxt->htab, relid,
+                        PrefetchedRelationType);
+        }
+    }
+
+    hash_destroy(relidset);
+}
+
 /*
  * parse fast_sequence for dispatch
  */
@@ -1580,6 +1771,7 @@ prepareDispatchedCatalogSingleRelation(QueryContextInfo *cxt, Oid relid,
         bool forInsert, List *segnos)
 {
     HeapTuple classtuple;
+    bool prefetched;
 
     Datum namespace, tablespace, toastrelid, relkind, relstorage, relname;
 
@@ -1604,6 +1796,9 @@ prepareDispatchedCatalogSingleRelation(QueryContextInfo *cxt, Oid relid,
         return;
     }
 
+    /* see prefetchDispatchedCatalogRelations */
+    prefetched = isPrefetchedForDispatching(cxt->htab, relid);
+
     /* find relid in pg_class */
     classtuple = SearchSysCache(RELOID, ObjectIdGetDatum(relid), 0, 0, 0);
 
@@ -1650,7 +1845,8 @@ prepareDispatchedCatalogSingleRelation(QueryContextInfo *cxt, Oid relid,
     prepareDispatchedCatalogTypeByRelation(cxt, relid, classtuple);
 
     /* collect pg_attribute info */
-    prepareDispatchedCatalogAttribute(cxt, relid);
+    if (!prefetched)
+        prepareDispatchedCatalogAttribute(cxt, relid);
 
     /* collect pg_attrdef info */
     /* Only INSERT statement will use column default value*/
@@ -1658,10 +1854,12 @@ prepareDispatchedCatalogSingleRelation(QueryContextInfo *cxt, Oid relid,
 		prepareDispatchedCatalogAttributeDefault(cxt, relid);
     }
     /* collect pg_attribute_encoding info */
-    prepareDispatchedCatalogAttributeEncoding(cxt, relid);
+    if (!prefetched)
+        prepareDispatchedCatalogAttributeEncoding(cxt, relid);
 
     /* collect pg_constraint info */
-    prepareDispatchedCatalogConstraint(cxt, relid);
+    if (!prefetched)
+        prepareDispatchedCatalogConstraint(cxt, relid);
 
     relkind = SysCacheGetAttr(RELOID, classtuple, Anum_pg_class_relkind, NULL);
 
@@ -2844,6 +3042,7 @@ prepareDispatchedCatalogRelation(QueryContextInfo *cxt, Oid relid,
     if (expandPartiton && rel_is_partitioned(relid))
     {
         children = find_all_inheritors(relid);
+        prefetchDispatchedCatalogRelations(cxt, children);
         foreach(child, children)
         {
             Oid myrelid = lfirst_oid(child);
@@ -0,0 +1,393 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*-------------------------------------------------------------------------
+ *
+ * cdbsampler.c
+ *	  Low frequency stack sampling profiler for the executor.
+ *
+ * When gp_profile_sample_hz is set, every QE samples its own call stack
+ * on SIGPROF while it executes a query, that is, at the given rate of
+ * consumed CPU time.  The samples are tagged with the plan node whose
+ * memory account is active, which is the node the executor is in.
+ *
+ * The signal handler only walks the frame pointers and counts the stack
+ * in a preallocated hash table; it neither allocates nor takes locks.
+ * When the query finishes, the stacks are symbolized and written in the
+ * folded format of flamegraph.pl to
+ *
+ *	  pg_log/profile_con<session>_cmd<command>_slice<slice>_seg<segment>_<pid>.folded
+ *
+ * so the profiles of all QEs of a query, or of many queries, are merged
+ * by concatenating the files.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include <dlfcn.h>
+#include <signal.h>
+#include <sys/time.h>
+#if !defined(pg_on_solaris) && !defined(_WIN32) && !defined(_WIN64)
+#include <execinfo.h>
+#endif
+#if defined(__linux__) && defined(__x86_64__)
+#include <ucontext.h>
+#endif
+
+#include "cdb/cdbsampler.h"
+#include "cdb/cdbvars.h"
+#include "miscadmin.h"
+#include "storage/fd.h"
+#include "utils/memaccounting.h"
+
+#define SAMPLER_MAX_DEPTH	48
+#define SAMPLER_MAX_STACKS	4096	/* power of 2 */
+
+/* frames of the signal handler itself and of the signal trampoline */
+#define SAMPLER_SKIP_FRAMES	2
+
+typedef struct SamplerStack
+{
+	uint32		hash;
+	int			depth;			/* 0 if the slot is free */
+	int			planNodeId;
+	MemoryOwnerType ownerType;
+	uint64		count;
+	void	   *frames[SAMPLER_MAX_DEPTH];	/* innermost first */
+} SamplerStack;
+
+static SamplerStack *samplerStacks = NULL;
+static volatile sig_atomic_t samplerActive = false;
+static void *samplerOwner = NULL;
+static uint64 samplerSamples = 0;
+static uint64 samplerDropped = 0;
+static bool samplerHandlerInstalled = false;
+
+static void sampler_handler(int signo, siginfo_t *info, void *context);
+static void sampler_write(void);
+static void sampler_append_frame(StringInfo buf, void *addr);
+static int	sampler_compare_lines(const void *a, const void *b);
+
+typedef struct SamplerLine
+{
+	char	   *stack;
+	uint64		count;
+} SamplerLine;
+
+/*
+ * cdbsampler_start
+ *		Starts sampling the stack for the query identified by owner.
+ *
+ * Nested queries, for example of functions called by the plan, are
+ * profiled as part of the outer one.
+ */
+void
+cdbsampler_start(void *owner)
+{
+	struct itimerval timer;
+	struct sigaction act;
+
+	if (samplerActive || gp_profile_sample_hz <= 0)
+		return;
+
+	if (samplerStacks == NULL)
+	{
+		void	   *frames[1];
+
+		samplerStacks = calloc(SAMPLER_MAX_STACKS, sizeof(SamplerStack));
+		if (samplerStacks == NULL)
+		{
+			elog(WARNING, "could not allocate memory for the stack sampler");
+			return;
+		}
+
+		/* backtrace() loads its unwinder on first use; not in the handler */
+		backtrace(frames, 1);
+	}
+
+	if (!samplerHandlerInstalled)
+	{
+		memset(&act, 0, sizeof(act));
+		act.sa_sigaction = sampler_handler;
+		act.sa_flags = SA_SIGINFO | SA_RESTART;
+		sigemptyset(&act.sa_mask);
+		if (sigaction(SIGPROF, &act, NULL) != 0)
+		{
+			elog(WARNING, "could not install the stack sampler: %m");
+			return;
+		}
+		samplerHandlerInstalled = true;
+	}
+
+	memset(samplerStacks, 0, SAMPLER_MAX_STACKS * sizeof(SamplerStack));
+	samplerSamples = 0;
+	samplerDropped = 0;
+	samplerOwner = owner;
+	samplerActive = true;
+
+	timer.it_interval.tv_sec = 0;
+	timer.it_interval.tv_usec = Max(1000000 / gp_profile_sample_hz, 1);
+	timer.it_value = timer.it_interval;
+	if (setitimer(ITIMER_PROF, &timer, NULL) != 0)
+	{
+		samplerActive = false;
+		elog(WARNING, "could not start the stack sampler timer: %m");
+	}
+}
+
+/*
+ * cdbsampler_stop
+ *		Stops sampling and writes the profile if owner started it.
+ */
+void
+cdbsampler_stop(void *owner)
+{
+	if (!samplerActive || owner != samplerOwner)
+		return;
+
+	cdbsampler_reset();
+	sampler_write();
+}
+
+/*
+ * cdbsampler_reset
+ *		Stops sampling, dropping the samples; used on abort.
+ */
+void
+cdbsampler_reset(void)
+{
+	struct itimerval timer;
+
+	if (!samplerActive)
+		return;
+
+	samplerActive = false;
+	samplerOwner = NULL;
+	memset(&timer, 0, sizeof(timer));
+	setitimer(ITIMER_PROF, &timer, NULL);
+}
+
+/*
+ * sampler_handler
+ *		SIGPROF handler counting the interrupted stack.
+ */
+static void
+sampler_handler(int signo, siginfo_t *info, void *context)
+{
+	int			save_errno = errno;
+	bool		save_ImmediateInterruptOK = ImmediateInterruptOK;
+	void	   *frames[SAMPLER_MAX_DEPTH + SAMPLER_SKIP_FRAMES];
+	void	  **stack = frames;
+	int			depth;
+	int			planNodeId = -1;
+	MemoryOwnerType ownerType = MEMORY_OWNER_TYPE_LogicalRoot;
+	uint32		hash;
+	int			i;
+	int			slot;
+
+	if (!samplerActive || stack_base_ptr == NULL)
+		return;
+
+	/* gp_backtrace() must not process interrupts in a signal handler */
+	ImmediateInterruptOK = false;
+	depth = gp_backtrace(frames + 1, SAMPLER_MAX_DEPTH + SAMPLER_SKIP_FRAMES - 1);
+	ImmediateInterruptOK = save_ImmediateInterruptOK;
+
+	/*
+	 * The frame walk starts in this handler and misses the interrupted
+	 * function, whose program counter is in the signal context.
+	 */
+#if defined(__linux__) && defined(__x86_64__)
+	if (depth >= SAMPLER_SKIP_FRAMES)
+	{
+		stack = frames + SAMPLER_SKIP_FRAMES;
+		stack[0] = (void *) ((ucontext_t *) context)->uc_mcontext.gregs[REG_RIP];
+		depth -= SAMPLER_SKIP_FRAMES - 1;
+	}
+#else
+	if (depth > SAMPLER_SKIP_FRAMES)
+	{
+		stack = frames + 1 + SAMPLER_SKIP_FRAMES;
+		depth -= SAMPLER_SKIP_FRAMES;
+	}
+#endif
+	else
+	{
+		errno = save_errno;
+		return;
+	}
+	depth = Min(depth, SAMPLER_MAX_DEPTH);
+
+	if (ActiveMemoryAccount != NULL)
+	{
+		planNodeId = ActiveMemoryAccount->planNodeId;
+		ownerType = ActiveMemoryAccount->ownerType;
+	}
+
+	hash = (uint32) planNodeId;
+	for (i = 0; i < depth; i++)
+		hash = (hash * 31) ^ (uint32) ((uintptr_t) stack[i] >> 2);
+
+	samplerSamples++;
+
+	/* open addressing; give up after a few probes, the table is full */
+	for (i = 0; i < 8; i++)
+	{
+		SamplerStack *s;
+
+		slot = (hash + i) & (SAMPLER_MAX_STACKS - 1);
+		s = &samplerStacks[slot];
+
+		if (s->depth == 0)
+		{
+			s->hash = hash;
+			s->depth = depth;
+			s->planNodeId = planNodeId;
+			s->ownerType = ownerType;
+			memcpy(s->frames, stack, depth * sizeof(void *));
+			s->count = 1;
+			break;
+		}
+		if (s->hash == hash && s->depth == depth && s->planNodeId == planNodeId &&
+			memcmp(s->frames, stack, depth * sizeof(void *)) == 0)
+		{
+			s->count++;
+			break;
+		}
+	}
+	if (i == 8)
+		samplerDropped++;
+
+	errno = save_errno;
+}
+
+/*
+ * sampler_append_frame
+ *		Appends the function name of a frame, like perf does.
+ */
+static void
+sampler_append_frame(StringInfo buf, void *addr)
+{
+	Dl_info		info;
+
+	/* return addresses point after the call, which may be another function */
+	if (dladdr((char *) addr - 1, &info) != 0 && info.dli_sname != NULL)
+		appendStringInfoString(buf, info.dli_sname);
+	else if (info.dli_fname != NULL)
+	{
+		const char *base = strrchr(info.dli_fname, '/');
+
+		appendStringInfo(buf, "[%s]", base ? base + 1 : info.dli_fname);
+	}
+	else
+		appendStringInfo(buf, "%p", addr);
+}
+
+static int
+sampler_compare_lines(const void *a, const void *b)
+{
+	return strcmp(((const SamplerLine *) a)->stack, ((const SamplerLine *) b)->stack);
+}
+
+/*
+ * sampler_write
+ *		Writes the counted stacks of the finished query.
+ *
+ * The handler counts the exact interrupted address, so stacks that differ
+ * only in the instruction within a function are merged here by name.
+ */
+static void
+sampler_write(void)
+{
+	char		fileName[MAXPGPATH];
+	StringInfoData buf;
+	SamplerLine *lines;
+	int			nlines = 0;
+	FILE	   *file;
+	int			i;
+	int			j;
+
+	if (samplerSamples == 0)
+		return;
+
+	snprintf(fileName, sizeof(fileName),
+			 "pg_log/profile_con%d_cmd%d_slice%d_seg%d_%d.folded",
+			 gp_session_id, gp_command_count, currentSliceId,
+			 GpIdentity.segindex, MyProcPid);
+
+	file = AllocateFile(fileName, "w");
+	if (file == NULL)
+	{
+		elog(WARNING, "could not write stack samples to \"%s\": %m", fileName);
+		return;
+	}
+
+	lines = palloc(SAMPLER_MAX_STACKS * sizeof(SamplerLine));
+	initStringInfo(&buf);
+	for (i = 0; i < SAMPLER_MAX_STACKS; i++)
+	{
+		SamplerStack *s = &samplerStacks[i];
+
+		if (s->depth == 0)
+			continue;
+
+		resetStringInfo(&buf);
+		appendStringInfo(&buf, "seg%d;slice%d", GpIdentity.segindex, currentSliceId);
+		if (s->planNodeId >= 0)
+		{
+			MemoryAccount account;
+
+			account.ownerType = s->ownerType;
+			appendStringInfo(&buf, ";%s %d",
+							 MemoryAccounting_GetAccountName(&account), s->planNodeId);
+		}
+		for (j = s->depth - 1; j >= 0; j--)
+		{
+			appendStringInfoChar(&buf, ';');
+			sampler_append_frame(&buf, s->frames[j]);
+		}
+		lines[nlines].stack = pstrdup(buf.data);
+		lines[nlines].count = s->count;
+		nlines++;
+	}
+
+	qsort(lines, nlines, sizeof(SamplerLine), sampler_compare_lines);
+	for (i = 0; i < nlines; i = j)
+	{
+		uint64		count = 0;
+
+		for (j = i; j < nlines && strcmp(lines[i].stack, lines[j].stack) == 0; j++)
+			count += lines[j].count;
+		fprintf(file, "%s " UINT64_FORMAT "\n", lines[i].stack, count);
+	}
+	if (samplerDropped > 0)
+		fprintf(file, "seg%d;slice%d;[dropped] " UINT64_FORMAT "\n",
+				GpIdentity.segindex, currentSliceId, samplerDropped);
+
+	FreeFile(file);
+	for (i = 0; i < nlines; i++)
+		pfree(lines[i].stack);
+	pfree(lines);
+	pfree(buf.data);
+
+	elog(DEBUG1, "wrote " UINT64_FORMAT " stack samples to \"%s\"",
+		 samplerSamples, fileName);
+}
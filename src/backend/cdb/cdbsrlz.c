@@ -38,6 +38,8 @@
 #include "libpq/pqformat.h"
 #include "cdb/cdbvars.h"
 #include "access/xact.h"
+#include "cdb/cdbgang.h"			/* gp_pthread_create */
+#include "utils/atomic.h"
 #include "catalog/pg_proc.h"
 #include "catalog/pg_namespace.h"
 #include "catalog/pg_tablespace.h"
@@ -53,12 +55,42 @@
 
 #include <lz4.h>
 #include <lz4hc.h>
+#include <pthread.h>
+
+/*
+ * With gp_dispatch_compress_threads, a serialized node larger than a chunk
+ * is compressed as independent LZ4 blocks of SRLZ_CHUNK_SIZE bytes of input
+ * on helper threads. The result then starts with SRLZ_CHUNKED_MAGIC in the
+ * place of the uncompressed size, followed by the uncompressed size, the
+ * number of chunks and the compressed size of each chunk.
+ */
+#define SRLZ_CHUNKED_MAGIC		(-1)
+#define SRLZ_CHUNK_SIZE			(256 * 1024)
+
+typedef struct CompressChunkJob
+{
+	const char *src;
+	int			srclen;
+	char	   *dst;
+	int			dstcap;
+	int			dstlen;			/* 0 if compression failed */
+} CompressChunkJob;
+
+typedef struct CompressChunkJobs
+{
+	CompressChunkJob *jobs;
+	int			njobs;
+	volatile int32 next;		/* the job to take by gp_atomic_add_32 */
+} CompressChunkJobs;
 
 char *WriteBackCatalogs = NULL;
 int32 WriteBackCatalogLen = 0;
 
 static char *compress_string(const char *src, int uncompressed_size, int *size);
 static char *uncompress_string(const char *src, int size, int * uncompressed_len);
+static char *compress_string_chunked(const char *src, int uncompressed_size, int *size);
+static char *uncompress_string_chunked(const char *src, int size, int *uncompressed_len);
+static void *compressChunksThread(void *arg);
 
 /*
  * compressBound doesn't exist in older zlibs, so let's use our own
@@ -189,13 +221,121 @@ compress_string(const char *src, int uncompressed_size, int *size)
 //
 //	*size = compressed_size + sizeof(int);
 //	elog(DEBUG2,"Compressed from %d to %d ", uncompressed_size, *size);
+  if (gp_dispatch_compress_threads > 0 && uncompressed_size > SRLZ_CHUNK_SIZE)
+    return compress_string_chunked(src, uncompressed_size, size);
+
   int compressed_size = LZ4_compressBound(uncompressed_size);
   char *result = palloc(compressed_size + sizeof(int));
   memcpy(result, &uncompressed_size, sizeof(int));  // save original size
-  *size = sizeof(int) + LZ4_compress_default(src, result + sizeof(int), uncompressed_size, compressed_size);
+  int len = LZ4_compress_default(src, result + sizeof(int), uncompressed_size, compressed_size);
+  if (len <= 0)
+    elog(ERROR, "Compression failed: uncompressed len %d", uncompressed_size);
+  *size = sizeof(int) + len;
 	return (char *)result;
 }
 
+/*
+ * Compress a string larger than SRLZ_CHUNK_SIZE a chunk at a time, the
+ * chunks taken by up to gp_dispatch_compress_threads helper threads and
+ * the backend. The threads only compress into the result buffer allocated
+ * beforehand, the chunks are then moved together in order.
+ */
+static char *
+compress_string_chunked(const char *src, int uncompressed_size, int *size)
+{
+	int			nchunks = (uncompressed_size + SRLZ_CHUNK_SIZE - 1) / SRLZ_CHUNK_SIZE;
+	int			headerlen = sizeof(int) * (3 + nchunks);
+	int			bound = LZ4_compressBound(SRLZ_CHUNK_SIZE);
+	CompressChunkJobs compressJobs;
+	pthread_t  *threads;
+	int			nthreads = 0;
+	int			maxthreads;
+	char	   *result;
+	char	   *pos;
+	int			header[3];
+	int			i;
+
+	result = palloc(headerlen + (Size) nchunks * bound);
+
+	compressJobs.jobs = (CompressChunkJob *) palloc(nchunks * sizeof(CompressChunkJob));
+	compressJobs.njobs = nchunks;
+	compressJobs.next = 0;
+	for (i = 0; i < nchunks; i++)
+	{
+		CompressChunkJob *job = &compressJobs.jobs[i];
+		int			offset = i * SRLZ_CHUNK_SIZE;
+
+		job->src = src + offset;
+		job->srclen = Min(SRLZ_CHUNK_SIZE, uncompressed_size - offset);
+		job->dst = result + headerlen + (Size) i * bound;
+		job->dstcap = bound;
+		job->dstlen = 0;
+	}
+
+	maxthreads = Min(gp_dispatch_compress_threads, nchunks - 1);
+	threads = (pthread_t *) palloc(Max(maxthreads, 1) * sizeof(pthread_t));
+	for (i = 0; i < maxthreads; i++)
+	{
+		if (gp_pthread_create(&threads[nthreads], compressChunksThread,
+							  &compressJobs, "compress_string_chunked") != 0)
+			break;
+		nthreads++;
+	}
+
+	compressChunksThread(&compressJobs);
+
+	for (i = 0; i < nthreads; i++)
+		pthread_join(threads[i], NULL);
+	pfree(threads);
+
+	/* the chunks only move toward the start of the buffer */
+	pos = result + headerlen;
+	for (i = 0; i < nchunks; i++)
+	{
+		CompressChunkJob *job = &compressJobs.jobs[i];
+
+		if (job->dstlen <= 0)
+			elog(ERROR, "Compression failed: uncompressed len %d", uncompressed_size);
+
+		memcpy(result + sizeof(header) + i * sizeof(int), &job->dstlen, sizeof(int));
+		memmove(pos, job->dst, job->dstlen);
+		pos += job->dstlen;
+	}
+	pfree(compressJobs.jobs);
+
+	header[0] = SRLZ_CHUNKED_MAGIC;
+	header[1] = uncompressed_size;
+	header[2] = nchunks;
+	memcpy(result, header, sizeof(header));
+
+	*size = pos - result;
+	return result;
+}
+
+/*
+ * Compress the chunks not yet taken by another thread.
+ */
+static void *
+compressChunksThread(void *arg)
+{
+	CompressChunkJobs *compressJobs = (CompressChunkJobs *) arg;
+
+	for (;;)
+	{
+		int32		jobno = gp_atomic_add_32(&compressJobs->next, 1) - 1;
+		CompressChunkJob *job;
+
+		if (jobno >= compressJobs->njobs)
+			break;
+
+		job = &compressJobs->jobs[jobno];
+		job->dstlen = LZ4_compress_default(job->src, job->dst,
+										   job->srclen, job->dstcap);
+	}
+
+	return NULL;
+}
+
 /*
  * Uncompress the binary string 
  */
@@ -222,7 +362,48 @@ uncompress_string(const char *src, int size, int *uncompressed_len)
 //		elog(ERROR,"Uncompress failed: %s (errno=%d compressed len %d, uncompressed %d)",
 //			 zError(status), status, size, *uncompressed_len);
   memcpy(uncompressed_len, src, sizeof(int));
+  if (*uncompressed_len == SRLZ_CHUNKED_MAGIC)
+    return uncompress_string_chunked(src, size, uncompressed_len);
+
   char *result = palloc(*uncompressed_len);
-  LZ4_decompress_safe(src + sizeof(int), result, size - sizeof(int), *uncompressed_len);
+  if (LZ4_decompress_safe(src + sizeof(int), result, size - sizeof(int),
+                          *uncompressed_len) != *uncompressed_len)
+    elog(ERROR, "Uncompress failed: compressed len %d, uncompressed %d",
+         size, *uncompressed_len);
 	return (char *)result;
 }
+
+/*
+ * Uncompress a string compressed by compress_string_chunked.
+ */
+static char *
+uncompress_string_chunked(const char *src, int size, int *uncompressed_len)
+{
+	int			header[3];
+	int			nchunks;
+	const char *pos;
+	char	   *result;
+
+	Assert(size >= sizeof(header));
+	memcpy(header, src, sizeof(header));
+	*uncompressed_len = header[1];
+	nchunks = header[2];
+
+	result = palloc(*uncompressed_len);
+	pos = src + sizeof(header) + nchunks * sizeof(int);
+	for (int i = 0; i < nchunks; i++)
+	{
+		int			offset = i * SRLZ_CHUNK_SIZE;
+		int			chunklen = Min(SRLZ_CHUNK_SIZE, *uncompressed_len - offset);
+		int			compressed;
+
+		memcpy(&compressed, src + sizeof(header) + i * sizeof(int), sizeof(int));
+		if (pos + compressed > src + size ||
+			LZ4_decompress_safe(pos, result + offset, compressed, chunklen) != chunklen)
+			elog(ERROR, "Uncompress failed: compressed len %d, uncompressed %d",
+				 size, *uncompressed_len);
+		pos += compressed;
+	}
+
+	return result;
+}
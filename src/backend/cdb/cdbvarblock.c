@@ -244,6 +244,60 @@ uint8* VarBlockMakerGetNextItemPtr(
 	return nextItemPtr;
 }
 
+/*
+ * Would VarBlockMakerGetNextItemPtr find room for an item of this length?
+ *
+ * This is the space check of VarBlockMakerGetNextItemPtr without its side
+ * effects, for callers that add one item to each of several VarBlocks and
+ * must know beforehand that all of them have room.
+ */
+bool VarBlockMakerItemFits(
+    VarBlockMaker        *varBlockMaker,
+    VarBlockByteLen      itemLen)
+{
+	int currentItemCount;
+	VarBlockByteLen newItemLenSum;
+	VarBlockByteLen offsetArrayLenRounded;
+	VarBlockByteLen newTotalLen;
+
+	Assert(varBlockMaker != NULL);
+	Assert(itemLen >= 0);
+
+	currentItemCount = varBlockMaker->currentItemCount;
+	if (currentItemCount >= varBlockMaker->maxItemCount)
+		return false;
+
+	newItemLenSum = varBlockMaker->currentItemLenSum + itemLen;
+
+	if (VarBlockGet_offsetsAreSmall(varBlockMaker->header) &&
+		varBlockMaker->nextItemPtr <= varBlockMaker->last2ByteOffsetPtr)
+	{
+		newTotalLen = VARBLOCK_HEADER_LEN +
+		              ((newItemLenSum + 1)/2)* 2 +
+					  currentItemCount * 2 + 2;
+
+		return (newTotalLen <= varBlockMaker->maxBufferLen);
+	}
+
+	/*
+	 * Large 3 byte offsets, either already or after the switch.
+	 */
+	if (VarBlockGet_offsetsAreSmall(varBlockMaker->header) &&
+		currentItemCount >= varBlockMaker->tempScratchSpaceLen /
+												VARBLOCK_BYTE_OFFSET_24_LEN)
+		return false;
+
+	offsetArrayLenRounded = (currentItemCount + 1) *
+							VARBLOCK_BYTE_OFFSET_24_LEN;
+	offsetArrayLenRounded = ((offsetArrayLenRounded + 1)/2)*2;
+
+	newTotalLen = VARBLOCK_HEADER_LEN +
+			      ((newItemLenSum + 1)/2)*2 +
+				  offsetArrayLenRounded;
+
+	return (newTotalLen <= varBlockMaker->maxBufferLen);
+}
+
 /*
  * Get the variable-length item count.
  */
@@ -148,6 +148,9 @@ int			Gp_interconnect_queue_depth=4;	/* max number of messages
 											 * waiting in rx-queue
 											 * before we drop.*/
 int			Gp_interconnect_snd_queue_depth=4;
+int			Gp_interconnect_buffer_budget=1024;	/* packet buffers of a
+												 * motion, per direction */
+int			Gp_interconnect_rtt_target_delay=1000;	/* usec of queueing */
 int			Gp_interconnect_timer_period=5;
 int			Gp_interconnect_timer_checking_period=20;
 int			Gp_interconnect_default_rtt=20;
@@ -155,6 +158,8 @@ int			Gp_interconnect_min_rto=20;
 int			Gp_interconnect_fc_method=INTERCONNECT_FC_METHOD_LOSS;
 int		    Gp_interconnect_transmit_timeout=3600;
 int			Gp_interconnect_min_retries_before_timeout=100;
+int			Gp_interconnect_io_batch_size=32;
+int			Gp_interconnect_rx_threads=1;
 
 int			Gp_interconnect_hash_multiplier=2;	/* sets the size of the hash table used by the UDP-IC */
 
@@ -168,10 +173,16 @@ bool gp_interconnect_full_crc=false; /* sanity check UDP data. */
 
 bool gp_interconnect_elide_setup=true; /* under some conditions we can eliminate the setup */
 
+bool gp_interconnect_defer_incoming=false; /* let receivers complete their incoming routes */
+
 bool gp_interconnect_log_stats=false; /* emit stats at log-level */
 
 bool gp_interconnect_cache_future_packets=true;
 
+bool gp_interconnect_local_shm=true; /* local peers use shared memory */
+bool gp_interconnect_compression=false; /* compress the tuple chunks */
+int gp_interconnect_compression_min_width=256; /* of the rows to compress */
+
 int			Gp_udp_bufsize_k; /* UPD recv buf size, in KB */
 
 #ifdef USE_ASSERT_CHECKING
@@ -219,6 +230,7 @@ double gp_hashagg_respill_bias = 1;
 
 bool        enable_adaptive_nestloop = true;
 double      gp_motion_cost_per_row = 0;
+double      gp_redistribute_skew_threshold = 0;
 int         gp_segments_for_planner = 0;
 
 int         gp_hashagg_default_nbatches = 32;
@@ -232,6 +244,17 @@ bool		gp_selectivity_damping_sigsort = true;
 int			gp_hashjoin_tuples_per_bucket = 5;
 int			gp_hashagg_groups_per_bucket = 5;
 int			gp_hashjoin_metadata_memory_percent = 20;
+int			gp_hashjoin_prefetch_distance = 16;
+int			gp_hashjoin_skew_memory_percent = 2;
+
+/* Threads that help a multi-key sort in memory */
+int			gp_mk_sort_threads = 0;
+
+/* Compiled regular expressions a backend keeps */
+int			gp_regex_cache_size = 256;
+
+/* Most sequence values a QE asks the sequence server for at once */
+int			gp_sequence_lease_max = 8192;
 
 
 /* default value to 0, which means we do not try to control number of spill batches */
@@ -256,6 +279,19 @@ bool		gp_enable_alter_table_inherit_cols = false;
 /* During insertion in a table with parquet partitions, require tuples to be sorted by partition key */
 bool		gp_parquet_insert_sort = true;
 
+/* Skip the parquet row groups rejected by the scan qual on their min/max statistics */
+bool		gp_parquet_rowgroup_skipping = true;
+
+/* Dictionary encode the parquet column chunks on insert */
+bool		gp_parquet_dictionary_encoding = true;
+
+/* Delta encode the parquet integer and timestamp column chunks on insert */
+bool		gp_parquet_delta_encoding = true;
+int			gp_parquet_compress_threads = 0;
+
+/* Size in kB of the shared memory cache of the parquet footers */
+int			gp_parquet_footer_cache_size = 32768;
+
 /* The following GUCs is for HAWQ 2.o */
 
 bool optimizer_enforce_hash_dist_policy;
@@ -270,6 +306,7 @@ bool balance_on_whole_query_level;
 bool output_hdfs_block_location;
 int max_filecount_notto_split_segment;
 int min_datasize_to_combine_segment;
+int cost_per_virtual_segment;
 int datalocality_algorithm_version;
 int hash_to_random_flag;
 int min_cost_for_each_query;
@@ -287,6 +324,7 @@ double metadata_cache_free_block_normal_ratio;
 int metadata_cache_max_hdfs_file_num;
 double metadata_cache_flush_ratio;
 double metadata_cache_reduce_ratio;
+int metadata_cache_prefetch_threads;
 
 char *metadata_cache_testfile;
 bool debug_fake_datalocality;
@@ -316,6 +354,8 @@ int    rm_master_port;
 int	   rm_segment_port;
 int	   rm_master_domain_port;
 bool   rm_enable_connpool;
+int    rm_reuse_registration_timeout;
+int    rm_resource_lease_timeout;
 int	   rm_connpool_sameaddr_buffersize;
 
 int    rm_nvseg_perquery_limit;
@@ -338,9 +378,14 @@ int		rm_stmt_nvseg;
 
 int		rm_min_resource_perseg;
 bool	rm_force_fifo_queue;
+int		rm_fair_queue_vseg_cost;			/* How many milliseconds one vseg
+											   of demand delays a query in
+											   weighted fair queuing. */
 bool	rm_force_alterqueue_cancel_queued_request;
 
 bool	rm_session_lease_heartbeat_enable;
+bool	rm_segment_heartbeat_compact;	/* Send heart-beats without segment
+										   status while it is not changed. */
 int     rm_session_lease_timeout; 			/* How many seconds to wait before
 											   expiring allocated resource. */
 int		rm_resource_allocation_timeout;		/* How may seconds to wait before
@@ -349,6 +394,9 @@ int		rm_resource_allocation_timeout;		/* How may seconds to wait before
 int		rm_resource_timeout;				/* How many seconds to wait before
 											   returning resource back to the
 											   resource broker. */
+int		rm_resource_forecast_period;		/* How many seconds the resource
+											   demand repeats in, 0 means no
+											   forecast. */
 int		rm_request_timeoutcheck_interval; 	/* How many seconds to wait before
 											   checking resource contexts for
 											   timeout. */
@@ -362,6 +410,10 @@ int		rm_segment_heartbeat_interval;		/* How many seconds to wait before
 											   sending another heart-beat to
 											   from a segment to resource
 											   manager. */
+int		rm_segment_heartbeat_max_interval;	/* How many seconds a segment can
+											   stretch the heart-beat interval
+											   to while its status is not
+											   changed. */
 int		rm_segment_heartbeat_timeout;		/* How many seconds to wait before
 											   setting down a segment that does
 											   not have heart-beat sent
@@ -383,9 +435,11 @@ double	rm_rejectrequest_nseg_limit;
 char   *rm_resourcepool_test_filename;
 
 bool	rm_enforce_cpu_enable;
+bool	rm_enforce_blkio_enable;
 char	*rm_enforce_cgrp_mnt_pnt;
 char	*rm_enforce_cgrp_hier_name;
 double	rm_enforce_cpu_weight;
+double	rm_enforce_blkio_weight;
 double	rm_enforce_core_vpratio;
 int		rm_enforce_cleanup_period;
 
@@ -438,8 +492,14 @@ int gp_segworker_relative_priority = PRIO_MAX;
 /* Max size of dispatched plans; 0 if no limit */
 int			gp_max_plan_size = 0;
 
+/* Read the clock at every Nth entry of an instrumented plan node */
+int			gp_instrument_timing_sample = 1;
+
 int gp_max_plan_slice = 0;
 
+/* Number of helper threads compressing large serialized nodes */
+int gp_dispatch_compress_threads = 0;
+
 /* Disable setting of tuple hints while reading */
 bool		gp_disable_tuple_hints = false;
 int		gp_hashagg_compress_spill_files = 0;
@@ -447,6 +507,9 @@ int		gp_hashagg_compress_spill_files = 0;
 int gp_workfile_compress_algorithm = 0;
 bool gp_workfile_checksumming = false;
 bool gp_workfile_caching = false;
+/* Number of spilling operators remembered per segment, 0 disables */
+int gp_workfile_spill_history_size = 1024;
+bool gp_workfile_spill_notice = false;
 int gp_workfile_caching_loglevel = DEBUG1;
 int gp_sessionstate_loglevel = DEBUG1;
 /* Maximum disk space to use for workfiles on a segment, in kilobytes */
@@ -457,6 +520,10 @@ double gp_workfile_limit_per_query = 0;
 int gp_workfile_limit_files_per_query = 0;
 bool gp_workfile_faultinject = false;
 int gp_workfile_bytes_to_checksum = 16;
+/* Number of helper threads writing the bfz workfiles, 0 for synchronous writes */
+int gp_workfile_async_writers = 0;
+/* Maximum size of a cross slice shared material passed in shared memory, in kilobytes */
+int gp_shareinput_shm_limit = 65536;
 
 /* The type of work files that HashJoin should use */
 int gp_workfile_type_hashjoin = 0;
@@ -464,6 +531,8 @@ int gp_workfile_type_hashjoin = 0;
 /* Gpmon */
 bool gp_enable_gpperfmon = false;
 int gp_gpperfmon_send_interval = 1;
+int gp_query_metrics_port = 0;
+int gp_profile_sample_hz = 0;
 
 /* Enable single-slice single-row inserts ?*/
 bool		gp_enable_fast_sri=true;
@@ -471,6 +540,12 @@ bool		gp_enable_fast_sri=true;
 /* Enable single-mirror pair dispatch. */
 bool		gp_enable_direct_dispatch=true;
 
+bool		gp_enable_snapshot_sharing=true;
+
+bool		gp_enable_segfile_catalog_cache=true;
+
+int			gp_appendonly_small_segfile_size=16384;
+
 /* Disable logging while creating mapreduce objects */
 bool        gp_mapreduce_define=false;
 
@@ -989,6 +1064,8 @@ gpvars_assign_gp_interconnect_fc_method(const char *newval, bool doit, GucSource
 		newmethod = INTERCONNECT_FC_METHOD_CAPACITY;
 	else if (!pg_strcasecmp("loss", newval))
 		newmethod = INTERCONNECT_FC_METHOD_LOSS;
+	else if (!pg_strcasecmp("rtt", newval))
+		newmethod = INTERCONNECT_FC_METHOD_RTT;
 	else
 		elog(ERROR, "Unknown interconnect flow control method. (current method is '%s')", gpvars_show_gp_interconnect_fc_method());
 
@@ -1009,6 +1086,8 @@ gpvars_show_gp_interconnect_fc_method(void)
 			return "CAPACITY";
 		case INTERCONNECT_FC_METHOD_LOSS:
 			return "LOSS";
+		case INTERCONNECT_FC_METHOD_RTT:
+			return "RTT";
 		default:
 			return "CAPACITY";
 	}
@@ -1203,8 +1203,8 @@ static void dispatcher_serialize_common_plan(DispatchData *data, CommonPlanConte
     // prepare common plan for QD execute
     data->newPlan = (CommonPlan *)palloc(sizeof(CommonPlan));
     data->newPlan->len = len;
-    data->newPlan->str = (char *)palloc(len);
-    memcpy(data->newPlan->str, val, len);
+    /* read only on both sides, no need for a second copy of a large plan */
+    data->newPlan->str = data->pQueryParms->serializedCommonPlan;
     univPlanFreeInstance(&ctx->univplan);
 
     data->queryDesc->newPlan = data->newPlan;
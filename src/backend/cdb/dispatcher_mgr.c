@@ -46,26 +46,53 @@
 typedef struct MyQueryExecutorGroup {
   List *qes;
   struct pollfd *fds;
+  struct MyQueryExecutor **pollQes; /* the executor of each of fds */
 } MyQueryExecutorGroup;
 
+/*
+ * Fill the poll array with the executors of the group not stopped yet, and
+ * return their number. The array only needs to be refilled after one of
+ * them stops.
+ */
+static int fillPollFds(MyQueryExecutorGroup *qeGrp) {
+  int nfds = 0;
+  ListCell *cell = NULL;
+  foreach (cell, qeGrp->qes) {
+    struct MyQueryExecutor *qe = lfirst(cell);
+    if (executormgr_isStopped(qe)) continue;
+    qeGrp->fds[nfds].fd = executormgr_getFd(qe);
+    qeGrp->fds[nfds].events = POLLIN;
+    qeGrp->pollQes[nfds] = qe;
+    ++nfds;
+  }
+  return nfds;
+}
+
 List *groupTaskRoundRobin(List *executors, int numPerThread) {
   double execNum = list_length(executors);
   double remainingExecNum = execNum;
   List *tasks = NIL;
   int threadNum = ceil(execNum / numPerThread);
 
+  /* index the executors, list_nth() per executor is quadratic */
+  void **execArray = palloc(Max(list_length(executors), 1) * sizeof(void *));
+  int execIdx = 0;
+  ListCell *lc = NULL;
+  foreach (lc, executors) execArray[execIdx++] = lfirst(lc);
+
   /* Create the List of List of info. */
   for (int i = 0; i < threadNum; ++i) {
     List *task = NIL;
     int avgNum = ceil(remainingExecNum / (threadNum - i));
     for (int j = 0; j < avgNum && remainingExecNum > 0; ++j) {
-      task = lappend(task, list_nth(executors, i + threadNum * j));
+      task = lappend(task, execArray[i + threadNum * j]);
       --remainingExecNum;
     }
 
     tasks = lappend(tasks, task);
   }
 
+  pfree(execArray);
   return tasks;
 }
 
@@ -75,10 +102,14 @@ List *makeQueryExecutorGroup(List *task, bool pollFd) {
   foreach (lc, task) {
     MyQueryExecutorGroup *g = palloc(sizeof(MyQueryExecutorGroup));
     g->qes = (List *)lfirst(lc);
-    if (pollFd)
+    if (pollFd) {
       g->fds = palloc0(sizeof(struct pollfd) * list_length(g->qes));
-    else
+      g->pollQes = palloc0(sizeof(struct MyQueryExecutor *) *
+                           list_length(g->qes));
+    } else {
       g->fds = NULL;
+      g->pollQes = NULL;
+    }
     qeGroup = lappend(qeGroup, g);
   }
   return qeGroup;
@@ -143,20 +174,17 @@ void mainDispatchFuncRun(struct MyQueryExecutorGroup *qeGrp,
     }
   }
 
+  int nfds = 0;
+  bool refillFds = true;
   while (true) {
     if (workermgr_should_query_stop(state)) {
       write_log("%s: query is canceled while polling executors.", __func__);
       goto error;
     }
 
-    int nfds = 0;
-    ListCell *cell = NULL;
-    foreach (cell, qeGrp->qes) {
-      myQe = lfirst(cell);
-      if (executormgr_isStopped(myQe)) continue;
-      qeGrp->fds[nfds].fd = executormgr_getFd(myQe);
-      qeGrp->fds[nfds].events = POLLIN;
-      ++nfds;
+    if (refillFds) {
+      nfds = fillPollFds(qeGrp);
+      refillFds = false;
     }
     if (nfds == 0) return;
 
@@ -182,16 +210,15 @@ void mainDispatchFuncRun(struct MyQueryExecutorGroup *qeGrp,
       continue;
     }
 
-    int idx = 0;
-    foreach (cell, qeGrp->qes) {
-      myQe = lfirst(cell);
-      if (executormgr_isStopped(myQe)) continue;
-      if (!(qeGrp->fds[idx++].revents & POLLIN)) continue;
+    for (int idx = 0; idx < nfds; ++idx) {
+      if (!(qeGrp->fds[idx].revents & POLLIN)) continue;
+      myQe = qeGrp->pollQes[idx];
       if (!executormgr_main_consumeData(myQe)) {
         catchProxyErr = false;
         write_log("%s: fail to consume data. ", __func__);
         goto error;
       }
+      if (executormgr_isStopped(myQe)) refillFds = true;
     }
   }
 
@@ -270,20 +297,17 @@ void proxyDispatchFuncRun(struct MyQueryExecutorGroup *qeGrp,
   }
   if (msgCopy) free(msgCopy);
 
+  int nfds = 0;
+  bool refillFds = true;
   while (true) {
     if (workermgr_should_query_stop(state)) {
       write_log("%s: query is canceled while polling executors.", __func__);
       goto error;
     }
 
-    int nfds = 0;
-    ListCell *cell = NULL;
-    foreach (cell, qeGrp->qes) {
-      myQe = lfirst(cell);
-      if (executormgr_isStopped(myQe)) continue;
-      qeGrp->fds[nfds].fd = executormgr_getFd(myQe);
-      qeGrp->fds[nfds].events = POLLIN;
-      ++nfds;
+    if (refillFds) {
+      nfds = fillPollFds(qeGrp);
+      refillFds = false;
     }
     if (nfds == 0) return;
 
@@ -314,15 +338,14 @@ void proxyDispatchFuncRun(struct MyQueryExecutorGroup *qeGrp,
         continue;
     }
 
-    int idx = 0;
-    foreach (cell, qeGrp->qes) {
-      myQe = lfirst(cell);
-      if (executormgr_isStopped(myQe)) continue;
-      if (!(qeGrp->fds[idx++].revents & POLLIN)) continue;
+    for (int idx = 0; idx < nfds; ++idx) {
+      if (!(qeGrp->fds[idx].revents & POLLIN)) continue;
+      myQe = qeGrp->pollQes[idx];
       if (!executormgr_proxy_consumeData(myQe)) {
         write_log("%s: fail to consume data. ", __func__);
         goto error;
       }
+      if (executormgr_isStopped(myQe)) refillFds = true;
     }
   }
 
@@ -338,12 +338,13 @@ static void mainDispatchEndEnv(MainDispatchData *data) {
   data->cdata.results = NULL;
 
   ListCell *cell = NULL;
-  int index = 0;
-  foreach (cell, data->metadata.mainDispatchTaskList) {
+  ListCell *segCell = NULL;
+  forboth (cell, data->metadata.mainDispatchTaskList, segCell,
+           data->metadata.taskPerSegment) {
     MyDispatchTask *task = lfirst(cell);
     executormgr_unbindExecutor(task->refQE);
     // free all segdesc which are only pure qes
-    List *taskPerSegment = list_nth(data->metadata.taskPerSegment, index);
+    List *taskPerSegment = lfirst(segCell);
     ListCell *lc = NULL;
     foreach (lc, taskPerSegment) {
       MyDispatchTask *qeTask = lfirst(lc);
@@ -351,7 +352,6 @@ static void mainDispatchEndEnv(MainDispatchData *data) {
       SegmentDatabaseDescriptor *desc = executormgr_getSegDesc(qeTask->refQE);
       cdbconn_termSegmentDescriptor(desc);
     }
-    ++index;
   }
 
   if (--DispatchInitCount == DISPATCH_INIT_VALUE)
@@ -372,6 +372,14 @@ static void proxyDispatchEndEnv(ProxyDispatchData *data) {
     MemoryContextResetAndDeleteChildren(DispatchDataContext);
 }
 
+static Segment **makeSegmentArray(List *segments) {
+  Segment **array = palloc(Max(list_length(segments), 1) * sizeof(Segment *));
+  ListCell *lc = NULL;
+  int i = 0;
+  foreach (lc, segments) array[i++] = lfirst(lc);
+  return array;
+}
+
 static void assignTasks(MainDispatchData *data) {
   sliceVec *sliceVector = NULL;
   int i;
@@ -403,6 +411,9 @@ static void assignTasks(MainDispatchData *data) {
   data->cdata.results = cdbdisp_makeDispatchResults(
       totalTaskNum, data->metadata.all_slices_num, false);
 
+  /* index the segments, list_nth() per task is quadratic in the vsegs */
+  Segment **segments = makeSegmentArray(data->resource->segments);
+
   for (i = 0; i < slice_num; i++) {
     Slice *slice = sliceVector[i].slice;
     bool is_writer = false;
@@ -424,7 +435,7 @@ static void assignTasks(MainDispatchData *data) {
       task->id.gang_member_num = list_length(data->resource->segments);
       task->id.command_count = gp_command_count;
       task->id.is_writer = is_writer;
-      task->segment = list_nth(data->resource->segments, task->id.id_in_slice);
+      task->segment = segments[task->id.id_in_slice];
       task->id.init = true;
       task->refDispatchData = data;
       poolmgr_put_item(data->metadata.dispatchTaskMap,
@@ -470,8 +481,7 @@ static void assignTasks(MainDispatchData *data) {
         task->id.gang_member_num = list_length(data->resource->segments);
         task->id.command_count = gp_command_count;
         task->id.is_writer = is_writer;
-        task->segment =
-            list_nth(data->resource->segments, task->id.id_in_slice);
+        task->segment = segments[task->id.id_in_slice];
         task->id.init = true;
         task->refDispatchData = data;
         poolmgr_put_item(data->metadata.dispatchTaskMap,
@@ -482,6 +492,7 @@ static void assignTasks(MainDispatchData *data) {
     }
   }
 
+  pfree(segments);
   pfree(sliceVector);
 }
 
@@ -496,13 +507,14 @@ static void gatherTaskPerSegment(List *item, List **mainDispatchTaskList) {
 }
 
 static void decodeQEDetails(MainDispatchData *data) {
-  int segNum = list_length(data->metadata.mainDispatchTaskList);
-  for (int i = 0; i < segNum; ++i) {
-    MyDispatchTask *perSegTask =
-        list_nth(data->metadata.mainDispatchTaskList, i);
+  ListCell *taskCell = NULL;
+  ListCell *segCell = NULL;
+  forboth (taskCell, data->metadata.mainDispatchTaskList, segCell,
+           data->metadata.taskPerSegment) {
+    MyDispatchTask *perSegTask = lfirst(taskCell);
     int4 *msg = (int4 *)(executormgr_getSegDesc(perSegTask->refQE)
                              ->conn->dispBuffer.data);
-    List *taskPerSegment = list_nth(data->metadata.taskPerSegment, i);
+    List *taskPerSegment = lfirst(segCell);
     int index = 0;
     ListCell *lc = NULL;
     foreach (lc, taskPerSegment) {
@@ -544,13 +556,14 @@ static void dispatcher_serialize_state(MainDispatchData *data) {
     }
   }
 
-  int segNum = list_length(data->metadata.mainDispatchTaskList);
-  for (int i = 0; i < segNum; ++i) {
+  ListCell *taskCell = NULL;
+  ListCell *segCell = NULL;
+  forboth (taskCell, data->metadata.mainDispatchTaskList, segCell,
+           data->metadata.taskPerSegment) {
     StringInfoData buf;
     initStringInfo(&buf);
-    MyDispatchTask *perSegTask =
-        list_nth(data->metadata.mainDispatchTaskList, i);
-    List *taskPerSegment = list_nth(data->metadata.taskPerSegment, i);
+    MyDispatchTask *perSegTask = lfirst(taskCell);
+    List *taskPerSegment = lfirst(segCell);
     ListCell *lc = NULL;
     foreach (lc, taskPerSegment) {
       MyDispatchTask *qeTask = lfirst(lc);
@@ -732,8 +745,8 @@ static void dispatcher_serialize_common_plan(MainDispatchData *data,
     // prepare common plan for QD execute
     data->newPlan = (CommonPlan *)palloc(sizeof(CommonPlan));
     data->newPlan->len = len;
-    data->newPlan->str = (char *)palloc(len);
-    memcpy(data->newPlan->str, val, len);
+    /* read only on both sides, no need for a second copy of a large plan */
+    data->newPlan->str = data->pQueryParms->serializedCommonPlan;
     univPlanFreeInstance(&ctx->univplan);
 
     data->queryDesc->newPlan = data->newPlan;
@@ -769,6 +782,8 @@ static void assignTasksForStmt(struct MainDispatchData *data) {
   data->cdata.results = cdbdisp_makeDispatchResults(
       totalTaskNum, data->metadata.all_slices_num, false);
 
+  Segment **segments = makeSegmentArray(data->resource->segments);
+
   for (int i = 0; i < data->metadata.slices[entryDBSegNum].taskNum; ++i) {
     MyDispatchTask *task = &data->metadata.slices[entryDBSegNum].task[i];
 
@@ -777,7 +792,7 @@ static void assignTasksForStmt(struct MainDispatchData *data) {
     task->id.gang_member_num = list_length(data->resource->segments);
     task->id.command_count = gp_command_count;
     task->id.is_writer = true;
-    task->segment = list_nth(data->resource->segments, i);
+    task->segment = segments[i];
     task->id.init = true;
     task->entryDB = task->segment->master;
     task->refDispatchData = data;
@@ -786,6 +801,7 @@ static void assignTasksForStmt(struct MainDispatchData *data) {
     executormgr_makeQueryExecutor(task->segment, task->id.is_writer, task,
                                   task->id.slice_id);
   }
+  pfree(segments);
 
   poolmgr_iterate_item_entry(
       data->metadata.dispatchTaskMap,
@@ -1157,9 +1173,8 @@ void mainDispatchRun(struct MainDispatchData *data, CommonPlanContext *ctx,
   bool hasError = false;
   PG_TRY();
   {
-    workermgr_submit_job(data->workerMgrState, tasks,
-                         (WorkerMgrTaskCallback)mainDispatchFuncConnect);
-    workermgr_wait_job(data->workerMgrState);
+    workermgr_run_job(data->workerMgrState, tasks,
+                      (WorkerMgrTaskCallback)mainDispatchFuncConnect);
   }
   PG_CATCH();
   {
@@ -1398,9 +1413,8 @@ void proxyDispatchPrepare(struct ProxyDispatchData *data) {
     struct WorkerMgrState *state =
         workermgr_create_workermgr_state(list_length(tasks));
 
-    workermgr_submit_job(state, tasks,
-                         (WorkerMgrTaskCallback)proxyDispatchFuncConnect);
-    workermgr_wait_job(state);
+    workermgr_run_job(state, tasks,
+                      (WorkerMgrTaskCallback)proxyDispatchFuncConnect);
   }
 
   if(proxyDispatchHasError(data)){
@@ -99,12 +99,23 @@ static bool executormgr_validate_conn(PGconn *conn) {
   return true;
 }
 
+/*
+ * A cached executor whose connection is found broken is taken out of the
+ * cache for good: release it instead of leaking its connection and segment,
+ * and keep cachedNum in step with what the pools really hold.
+ */
+static void executormgr_discardExecutor(SegmentDatabaseDescriptor *desc) {
+  executormgr_destory(desc);
+  --executorCache.cachedNum;
+}
+
 static SegmentDatabaseDescriptor *executormgr_allocate_any_executor(
     bool entryDb) {
   struct PoolMgrState *pool =
       entryDb ? executorCache.entryDbPool : executorCache.qePool;
   SegmentDatabaseDescriptor *desc = poolmgr_get_random_item(pool);
   while (desc != NULL && !executormgr_validate_conn(desc->conn)) {
+    executormgr_discardExecutor(desc);
     desc = poolmgr_get_random_item(pool);
   }
   return desc;
@@ -115,6 +126,7 @@ static SegmentDatabaseDescriptor *executormgr_allocate_executor_by_name(
   SegmentDatabaseDescriptor *desc =
       poolmgr_get_item_by_name(executorCache.qePool, name);
   while (desc != NULL && !executormgr_validate_conn(desc->conn)) {
+    executormgr_discardExecutor(desc);
     desc = poolmgr_get_item_by_name(executorCache.qePool, name);
   }
   return desc;
@@ -492,10 +504,13 @@ bool executormgr_hasCachedExecutor() { return executorCache.cachedNum > 0; }
 
 void executormgr_cleanCachedExecutor() {
   if (executormgr_hasCachedExecutor()) {
-    poolmgr_clean(executorCache.qePool,
-                  (PoolMgrIterateFilter)executormgr_cleanCachedExecutorFilter);
-    poolmgr_clean(executorCache.entryDbPool,
-                  (PoolMgrIterateFilter)executormgr_cleanCachedExecutorFilter);
+    executorCache.cachedNum -= poolmgr_clean(
+        executorCache.qePool,
+        (PoolMgrIterateFilter)executormgr_cleanCachedExecutorFilter);
+    executorCache.cachedNum -= poolmgr_clean(
+        executorCache.entryDbPool,
+        (PoolMgrIterateFilter)executormgr_cleanCachedExecutorFilter);
+    Assert(executorCache.cachedNum >= 0);
   }
 }
 
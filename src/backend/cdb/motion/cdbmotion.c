@@ -28,6 +28,8 @@
  */
 #include "postgres.h"
 
+#include <lz4.h>
+
 #include "miscadmin.h"
 #include "access/heapam.h"
 #include "cdb/cdbconn.h"
@@ -58,6 +60,9 @@ int			Gp_max_tuple_chunk_size;
 static uint8 s_eos_buffer[sizeof(TupleChunkListItemData) + 8];
 static TupleChunkListItem s_eos_chunk_data = (TupleChunkListItem)s_eos_buffer;
 
+/* chunks with less data are not worth compressing */
+#define TC_COMPRESS_MIN_SIZE 64
+
 /*
  * HELPER FUNCTION DECLARATIONS
  */
@@ -78,6 +83,8 @@ static void processIncomingChunks(MotionLayerState *mlStates,
 								  int16 srcRoute);
 
 static inline void reconstructTuple(MotionNodeEntry * pMNEntry, ChunkSorterEntry * pCSEntry);
+static void compressChunks(MotionNodeEntry * pMNEntry, TupleChunkList tcList);
+static TupleChunkListItem decompressChunk(TupleChunkListItem tcItem);
 
 /* Stats-function declarations. */
 static void statSendTuple(MotionLayerState *mlStates, MotionNodeEntry * pMNEntry, TupleChunkList tcList);
@@ -377,12 +384,30 @@ UpdateMotionLayerNode(MotionLayerState *mlStates, int16 motNodeID, bool preserve
 	pEntry->cleanedUp = false;
 	pEntry->stopped = false;
 	pEntry->moreNetWork = true;
+	pEntry->compress = false;
+	pEntry->compress_buf = NULL;
 
 
 	/* All done!  Go back to caller memory-context. */
 	MemoryContextSwitchTo(oldCtxt);
 }
 
+/*
+ * Compress the chunks sent by a motion node, whose rows are wide or sent to
+ * every receiver. Called from ExecInitMotion() on the sending side, the
+ * receivers decompress whatever chunk comes compressed.
+ */
+void
+SetMotionLayerNodeCompression(MotionLayerState *mlStates, int16 motNodeID, bool compress)
+{
+	MotionNodeEntry *pEntry = getMotionNodeEntry(mlStates, motNodeID, "SetMotionLayerNodeCompression");
+
+	pEntry->compress = compress;
+	if (compress && pEntry->compress_buf == NULL)
+		pEntry->compress_buf = MemoryContextAlloc(mlStates->motion_layer_mctx,
+												  Gp_max_tuple_chunk_size);
+}
+
 void
 setExpectedReceivers(MotionLayerState *mlStates, int16 motNodeID, int expectedReceivers)
 {
@@ -437,7 +462,12 @@ SendTuple(MotionLayerState *mlStates,
 	elog(DEBUG5, "Serializing HeapTuple for sending.");
 #endif
 
-	if (targetRoute != BROADCAST_SEGIDX)
+	/*
+	 * Serialize the tuple straight into the transmit buffer if it fits, a
+	 * broadcast tuple is then copied to the other connections. The chunks
+	 * to compress go through the chunk list.
+	 */
+	if (!pMNEntry->compress)
 	{
 		struct directTransportBuffer b;
 
@@ -470,6 +500,10 @@ SendTuple(MotionLayerState *mlStates,
 
 	SerializeTupleIntoChunks(tuple, &pMNEntry->ser_tup_info, &tcList);
 
+	/* a broadcast is compressed once, for all the receivers */
+	if (pMNEntry->compress)
+		compressChunks(pMNEntry, &tcList);
+
 	MemoryContextSwitchTo(oldCtxt);
 
 #ifdef AMS_VERBOSE_LOGGING
@@ -711,6 +745,7 @@ processIncomingChunks(MotionLayerState *mlStates,
 		}
 
 		/* Stick the chunk into the sorter. */
+		tcItem = decompressChunk(tcItem);
 		addChunkToSorter(mlStates, transportStates, pMNEntry, tcItem, motNodeID, srcRoute);
 
 		tcItem = tcNext;
@@ -990,6 +1025,10 @@ materializeChunk(TupleChunkListItem * tcItem)
 	Assert(tcItem != NULL);
 	Assert(*tcItem != NULL);
 
+	/* a decompressed chunk has its own storage already */
+	if ((*tcItem)->inplace == NULL)
+		return;
+
 	newItem = repalloc(*tcItem, sizeof(TupleChunkListItemData) + (*tcItem)->chunk_length);
 
 	memcpy(newItem->chunk_data, newItem->inplace, newItem->chunk_length);
@@ -1000,6 +1039,103 @@ materializeChunk(TupleChunkListItem * tcItem)
 	return;
 }
 
+/*
+ * Compress the data of the chunks of a tuple with LZ4, in place.
+ *
+ * A chunk is left as it is if it is small, or if compressing does not
+ * make it smaller.
+ */
+static void
+compressChunks(MotionNodeEntry * pMNEntry, TupleChunkList tcList)
+{
+	TupleChunkListItem tcItem;
+
+	Assert(pMNEntry->compress_buf != NULL);
+
+	for (tcItem = tcList->p_first; tcItem != NULL; tcItem = tcItem->p_next)
+	{
+		char	   *data = (char *) tcItem->chunk_data;
+		uint32		rawSize = tcItem->chunk_length - TUPLE_CHUNK_HEADER_SIZE;
+		TupleChunkType tcType;
+		int			size;
+
+		Assert(tcItem->inplace == NULL);
+
+		if (rawSize < TC_COMPRESS_MIN_SIZE)
+			continue;
+
+		GetChunkType(tcItem, &tcType);
+		if (tcType == TC_END_OF_STREAM || tcType == TC_EMPTY)
+			continue;
+
+		/* only keep it if it saves something after the length word */
+		size = LZ4_compress_default(data + TUPLE_CHUNK_HEADER_SIZE,
+									pMNEntry->compress_buf,
+									rawSize,
+									rawSize - sizeof(uint32) - 1);
+		if (size <= 0)
+			continue;
+
+		memcpy(data + TUPLE_CHUNK_HEADER_SIZE, &rawSize, sizeof(uint32));
+		memcpy(data + TUPLE_CHUNK_HEADER_SIZE + sizeof(uint32), pMNEntry->compress_buf, size);
+
+		tcItem->chunk_length = TUPLE_CHUNK_HEADER_SIZE + sizeof(uint32) + size;
+		SetChunkDataSize(data, sizeof(uint32) + size);
+		SetChunkType(data, tcType | TC_COMPRESSED_FLAG);
+	}
+}
+
+/*
+ * Decompress a received chunk, if it was compressed by compressChunks().
+ *
+ * The decompressed chunk has its own storage, the chunk received is freed.
+ */
+static TupleChunkListItem
+decompressChunk(TupleChunkListItem tcItem)
+{
+	TupleChunkListItem newItem;
+	char	   *data = GetChunkDataPtr(tcItem);
+	uint16		tcType;
+	uint32		rawSize;
+	int			size;
+
+	memcpy(&tcType, data + 2, sizeof(uint16));
+	if ((tcType & TC_COMPRESSED_FLAG) == 0)
+		return tcItem;
+
+	if (tcItem->chunk_length < TUPLE_CHUNK_HEADER_SIZE + sizeof(uint32))
+		ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+						errmsg("Interconnect error: compressed tuple chunk too short."),
+						errdetail("chunk length %u", tcItem->chunk_length)));
+
+	memcpy(&rawSize, data + TUPLE_CHUNK_HEADER_SIZE, sizeof(uint32));
+	if (rawSize > Gp_max_tuple_chunk_size)
+		ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+						errmsg("Interconnect error: compressed tuple chunk too large."),
+						errdetail("uncompressed length %u > max %d", rawSize, Gp_max_tuple_chunk_size)));
+
+	newItem = palloc(sizeof(TupleChunkListItemData) + TUPLE_CHUNK_HEADER_SIZE + rawSize);
+	newItem->p_next = NULL;
+	newItem->inplace = NULL;
+	newItem->chunk_length = TUPLE_CHUNK_HEADER_SIZE + rawSize;
+
+	size = LZ4_decompress_safe(data + TUPLE_CHUNK_HEADER_SIZE + sizeof(uint32),
+							   (char *) newItem->chunk_data + TUPLE_CHUNK_HEADER_SIZE,
+							   tcItem->chunk_length - TUPLE_CHUNK_HEADER_SIZE - sizeof(uint32),
+							   rawSize);
+	if (size != rawSize)
+		ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+						errmsg("Interconnect error: could not decompress tuple chunk."),
+						errdetail("decompressed %d of %u bytes", size, rawSize)));
+
+	SetChunkDataSize(newItem->chunk_data, rawSize);
+	SetChunkType(newItem->chunk_data, tcType & ~TC_COMPRESSED_FLAG);
+
+	pfree(tcItem);
+
+	return newItem;
+}
+
 /*
  * Add another tuple-chunk to the chunk sorter.  If the new chunk
  * completes another HeapTuple, that tuple will be deserialized and
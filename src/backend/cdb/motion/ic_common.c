@@ -434,11 +434,34 @@ SendTupleChunkToAMS(MotionLayerState *mlStates,
 	return (i < pEntry->numConns);
 }
 
+/*
+ * The first connection still interested in a broadcast, NULL if none is.
+ *
+ * A broadcast tuple is serialized into the buffer of this connection, and
+ * copied from there into the buffers of the others.
+ */
+static MotionConn *
+firstActiveConn(ChunkTransportStateEntry *pEntry)
+{
+	int			i;
+
+	for (i = 0; i < pEntry->numConns; i++)
+	{
+		if (pEntry->conns[i].stillActive)
+			return pEntry->conns + i;
+	}
+
+	return NULL;
+}
+
 /*
  * The fetches a direct pointer into our transmit buffers, along with
  * an indication as to how much data can be safely shoved into the
  * buffer (started at the pointed location).
  *
+ * For a broadcast, the buffer is the one of the first active connection,
+ * and the length is the space left in all the active connections.
+ *
  * This works a lot like SendTupleChunkToAMS().
  */
 void
@@ -458,10 +481,6 @@ getTransportDirectBuffer(ChunkTransportState *transportStates,
 	{
 		elog(FATAL, "getTransportDirectBuffer: inactive transport states");
 	}
-	else if (targetRoute == BROADCAST_SEGIDX)
-	{
-		elog(FATAL, "getTransportDirectBuffer: can't direct-transport to broadcast");
-	}
 
 	Assert(b != NULL);
 
@@ -469,6 +488,28 @@ getTransportDirectBuffer(ChunkTransportState *transportStates,
 	{
 		getChunkTransportState(transportStates, motNodeID, &pEntry);
 
+		if (targetRoute == BROADCAST_SEGIDX)
+		{
+			int			i;
+
+			conn = firstActiveConn(pEntry);
+			if (conn == NULL)
+				break;
+
+			b->pri = conn->pBuff + conn->msgSize;
+			b->prilen = Gp_max_packet_size - conn->msgSize;
+
+			/* the receivers get the same tuples, their buffers mostly match */
+			for (i = 0; i < pEntry->numConns; i++)
+			{
+				if (pEntry->conns[i].stillActive)
+					b->prilen = Min(b->prilen, Gp_max_packet_size - pEntry->conns[i].msgSize);
+			}
+
+			/* got buffer. */
+			return;
+		}
+
 		/* handle pt-to-pt message. Primary */
 		conn = pEntry->conns + targetRoute;
 		/* only send to interested connections */
@@ -494,9 +535,11 @@ getTransportDirectBuffer(ChunkTransportState *transportStates,
 }
 
 /*
- * The fetches a direct pointer into our transmit buffers, along with
- * an indication as to how much data can be safely shoved into the
- * buffer (started at the pointed location).
+ * Advance the direct buffer of getTransportDirectBuffer() beyond the
+ * message just serialized into it.
+ *
+ * For a broadcast, the message is copied from the first active connection
+ * to the others, so the tuple is serialized only once.
  *
  * This works a lot like SendTupleChunkToAMS().
  */
@@ -516,13 +559,43 @@ putTransportDirectBuffer(ChunkTransportState *transportStates,
 	{
 		elog(FATAL, "putTransportDirectBuffer: inactive transport states");
 	}
-	else if (targetRoute == BROADCAST_SEGIDX)
-	{
-		elog(FATAL, "putTransportDirectBuffer: can't direct-transport to broadcast");
-	}
 
 	getChunkTransportState(transportStates, motNodeID, &pEntry);
 
+	if (targetRoute == BROADCAST_SEGIDX)
+	{
+		MotionConn *src = firstActiveConn(pEntry);
+		int			i;
+
+		Assert(src != NULL);
+
+		for (i = 0; i < pEntry->numConns; i++)
+		{
+			conn = pEntry->conns + i;
+			if (!conn->stillActive)
+				continue;
+
+			if (conn != src)
+			{
+				Assert(conn->msgSize + length <= Gp_max_packet_size);
+				memcpy(conn->pBuff + conn->msgSize, src->pBuff + src->msgSize, length);
+			}
+		}
+
+		/* src last, the others copy from its current position */
+		for (i = 0; i < pEntry->numConns; i++)
+		{
+			conn = pEntry->conns + i;
+			if (conn->stillActive)
+			{
+				conn->msgSize += length;
+				conn->tupleCount++;
+			}
+		}
+
+		return;
+	}
+
 	/* handle pt-to-pt message. Primary */
 	conn = pEntry->conns + targetRoute;
 	/* only send to interested connections */
@@ -908,6 +981,7 @@ createChunkTransportState(ChunkTransportState *transportStates,
     pEntry->sendSlice = sendSlice;
     pEntry->recvSlice = recvSlice;
     pEntry->outgoingPortRetryCount = 0;
+	pEntry->stat_total_rx_wait_time = 0;
 
 	pEntry->conns = palloc0(pEntry->numConns * sizeof(pEntry->conns[0]));
 
@@ -0,0 +1,279 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*-------------------------------------------------------------------------
+ * ic_shm.c
+ *	   Shared memory packet rings of the UDP interconnect.
+ *
+ * When the sender and the receiver of a connection run on the same host,
+ * the packets of the connection are passed through a ring of packet slots
+ * in a POSIX shared memory segment. The packet with sequence number seq is
+ * in slot (seq - 1) % nslots, the same position as in the receive queue of
+ * the connection. The UDP datagram only carries the packet header, so the
+ * acknowledgments, the flow control, the retransmissions, the stop
+ * messages and the end of stream are handled as for any other connection.
+ *
+ * The flow control guarantees that a slot is not overwritten before the
+ * receiver has consumed its packet: the sender sends the packet seq only
+ * once the receiver has acknowledged the consumption of packet
+ * seq - Gp_interconnect_queue_depth.
+ *
+ * Both ends open the segment by a name derived from the connection, and
+ * whichever comes first creates it. Both ends unlink it at teardown.
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <netinet/in.h>
+
+#include "libpq/ip.h"
+#include "nodes/execnodes.h"
+#include "cdb/ml_ipc.h"
+#include "cdb/cdbvars.h"
+
+/* the addresses of the local interfaces, loaded once per process */
+#define IC_SHM_MAX_LOCAL_ADDRS (64)
+
+static struct sockaddr_storage localAddrs[IC_SHM_MAX_LOCAL_ADDRS];
+static int	numLocalAddrs = 0;
+static bool localAddrsLoaded = false;
+
+static void addLocalAddr(struct sockaddr *addr, struct sockaddr *netmask, void *cb_data);
+static bool sameHostAddr(const struct sockaddr *a, const struct sockaddr *b);
+
+/*
+ * addLocalAddr
+ * 		pg_foreach_ifaddr() callback, remember an interface address.
+ */
+static void
+addLocalAddr(struct sockaddr *addr, struct sockaddr *netmask, void *cb_data)
+{
+	if (addr == NULL || numLocalAddrs >= IC_SHM_MAX_LOCAL_ADDRS)
+		return;
+
+	if (addr->sa_family == AF_INET)
+		memcpy(&localAddrs[numLocalAddrs++], addr, sizeof(struct sockaddr_in));
+#ifdef HAVE_IPV6
+	else if (addr->sa_family == AF_INET6)
+		memcpy(&localAddrs[numLocalAddrs++], addr, sizeof(struct sockaddr_in6));
+#endif
+}
+
+/*
+ * sameHostAddr
+ * 		Compare two IP addresses, a V4-mapped IPv6 address is equal to its
+ * 		IPv4 address.
+ */
+static bool
+sameHostAddr(const struct sockaddr *a, const struct sockaddr *b)
+{
+	const uint8 *abytes;
+	const uint8 *bbytes;
+	int			alen;
+	int			blen;
+
+	if (a->sa_family == AF_INET)
+	{
+		abytes = (const uint8 *) &((const struct sockaddr_in *) a)->sin_addr;
+		alen = 4;
+	}
+#ifdef HAVE_IPV6
+	else if (a->sa_family == AF_INET6)
+	{
+		abytes = (const uint8 *) &((const struct sockaddr_in6 *) a)->sin6_addr;
+		alen = 16;
+		if (IN6_IS_ADDR_V4MAPPED(&((const struct sockaddr_in6 *) a)->sin6_addr))
+		{
+			abytes += 12;
+			alen = 4;
+		}
+	}
+#endif
+	else
+		return false;
+
+	if (b->sa_family == AF_INET)
+	{
+		bbytes = (const uint8 *) &((const struct sockaddr_in *) b)->sin_addr;
+		blen = 4;
+	}
+#ifdef HAVE_IPV6
+	else if (b->sa_family == AF_INET6)
+	{
+		bbytes = (const uint8 *) &((const struct sockaddr_in6 *) b)->sin6_addr;
+		blen = 16;
+		if (IN6_IS_ADDR_V4MAPPED(&((const struct sockaddr_in6 *) b)->sin6_addr))
+		{
+			bbytes += 12;
+			blen = 4;
+		}
+	}
+#endif
+	else
+		return false;
+
+	return alen == blen && memcmp(abytes, bbytes, alen) == 0;
+}
+
+/*
+ * icShmPeerIsLocal
+ * 		Is the interconnect listener address of a peer one of the addresses
+ * 		of this host ?
+ *
+ * The sender and the receiver of a connection both ask about the address of
+ * the other end, so they agree on whether the connection uses shared memory.
+ */
+bool
+icShmPeerIsLocal(const char *listenerAddr)
+{
+	struct addrinfo hint;
+	struct addrinfo *addrs = NULL;
+	bool		local = false;
+	int			i;
+
+	if (listenerAddr == NULL)
+		return false;
+
+	if (!localAddrsLoaded)
+	{
+		if (pg_foreach_ifaddr(addLocalAddr, NULL) < 0)
+		{
+			elog(LOG, "could not get the interface addresses of the host: %m");
+			numLocalAddrs = 0;
+		}
+		localAddrsLoaded = true;
+	}
+
+	MemSet(&hint, 0, sizeof(hint));
+	hint.ai_socktype = SOCK_DGRAM;
+	hint.ai_family = AF_UNSPEC;
+	hint.ai_flags = AI_NUMERICHOST;
+
+	if (pg_getaddrinfo_all(listenerAddr, NULL, &hint, &addrs) || !addrs)
+	{
+		if (addrs)
+			pg_freeaddrinfo_all(hint.ai_family, addrs);
+		return false;
+	}
+
+	for (i = 0; i < numLocalAddrs && !local; i++)
+		local = sameHostAddr(addrs->ai_addr, (struct sockaddr *) &localAddrs[i]);
+
+	pg_freeaddrinfo_all(hint.ai_family, addrs);
+
+	return local;
+}
+
+/*
+ * icShmRingAttach
+ * 		Map the packet ring of a connection, creating it if the other end has
+ * 		not done it yet.
+ *
+ * The name of the ring comes from the header of the connection, which is
+ * the same at both ends. Returns NULL if the ring cannot be mapped.
+ */
+ICShmRing *
+icShmRingAttach(icpkthdr *connInfo, int nslots, int slotSize)
+{
+	ICShmRing  *ring;
+	struct stat st;
+	void	   *base;
+	int			fd;
+
+	ring = (ICShmRing *) palloc0(sizeof(ICShmRing));
+	snprintf(ring->name, sizeof(ring->name), "/hawq_ic.%d.%u.%d.%d.%d",
+			 connInfo->sessionId, connInfo->icId, connInfo->motNodeId,
+			 connInfo->srcPid, connInfo->dstPid);
+	ring->nslots = nslots;
+	ring->slotSize = MAXALIGN(slotSize);
+	ring->size = (Size) ring->nslots * ring->slotSize;
+
+	fd = shm_open(ring->name, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+	if (fd < 0)
+	{
+		elog(LOG, "could not open interconnect shared memory \"%s\": %m", ring->name);
+		pfree(ring);
+		return NULL;
+	}
+
+	/* both ends set the same size, whichever comes first */
+	if (ftruncate(fd, ring->size) < 0 || fstat(fd, &st) < 0 ||
+		st.st_size != (off_t) ring->size)
+	{
+		elog(LOG, "could not size interconnect shared memory \"%s\" to %lu bytes: %m",
+			 ring->name, (unsigned long) ring->size);
+		close(fd);
+		shm_unlink(ring->name);
+		pfree(ring);
+		return NULL;
+	}
+
+	base = mmap(NULL, ring->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED)
+	{
+		elog(LOG, "could not map interconnect shared memory \"%s\": %m", ring->name);
+		shm_unlink(ring->name);
+		pfree(ring);
+		return NULL;
+	}
+
+	ring->base = (uint8 *) base;
+
+	return ring;
+}
+
+/*
+ * icShmRingDetach
+ * 		Unmap the packet ring of a connection and remove its name.
+ *
+ * The other end may have removed the name already.
+ */
+void
+icShmRingDetach(ICShmRing *ring)
+{
+	if (ring == NULL)
+		return;
+
+	if (munmap(ring->base, ring->size) < 0)
+		elog(LOG, "could not unmap interconnect shared memory \"%s\": %m", ring->name);
+
+	if (shm_unlink(ring->name) < 0 && errno != ENOENT)
+		elog(LOG, "could not remove interconnect shared memory \"%s\": %m", ring->name);
+
+	pfree(ring);
+}
+
+/*
+ * icShmRingPut
+ * 		Copy a packet into its slot.
+ */
+void
+icShmRingPut(ICShmRing *ring, icpkthdr *pkt)
+{
+	Assert(pkt->seq > 0);
+	Assert(pkt->len <= ring->slotSize);
+
+	memcpy(icShmRingSlot(ring, pkt->seq), pkt, pkt->len);
+}
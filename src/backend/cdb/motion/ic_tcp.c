@@ -167,6 +167,13 @@ static void sendRegisterMessage(ChunkTransportState *transportStates, ChunkTrans
 static bool readRegisterMessage(ChunkTransportState *transportStates,
 								MotionConn *conn);
 static MotionConn *acceptIncomingConnection(void);
+static void addIncomingInterest(ChunkTransportState *transportStates,
+								mpp_fd_set *rset, int *highsock);
+static int	completeIncomingConnections(ChunkTransportState *transportStates,
+										mpp_fd_set *rset, int n, int *incoming_count);
+static int	unregisteredRoutes(ChunkTransportStateEntry *pEntry);
+static void waitForIncomingRoutes(ChunkTransportState *transportStates,
+								  ChunkTransportStateEntry *pEntry, MotionConn *conn);
 
 static void flushInterconnectListenerBacklog(void);
 
@@ -1371,6 +1378,199 @@ acceptIncomingConnection(void)
     return conn;
 }                               /* acceptIncomingConnection */
 
+/*
+ * addIncomingInterest
+ *
+ * Add the listening socket, and the inbound connections still waiting for
+ * their registration message, to the read set of a select() call.
+ */
+static void
+addIncomingInterest(ChunkTransportState *transportStates,
+					mpp_fd_set *rset, int *highsock)
+{
+	ListCell   *cell;
+	MotionConn *conn;
+
+	if (TCP_listenerFd < 0)
+		elog(FATAL, "addIncomingInterest: bad listener");
+
+	MPP_FD_SET(TCP_listenerFd, rset);
+	*highsock = Max(*highsock, TCP_listenerFd);
+
+	foreach(cell, transportStates->incompleteConns)
+	{
+		conn = (MotionConn *)lfirst(cell);
+
+		if (conn->state != mcsRecvRegMsg || conn->sockfd < 0)
+			elog(FATAL, "addIncomingInterest: incomplete connection bad state or bad fd");
+
+		MPP_FD_SET(conn->sockfd, rset);
+		*highsock = Max(*highsock, conn->sockfd);
+	}
+}
+
+/*
+ * completeIncomingConnections
+ *
+ * Deal with the events select() reported in rset for the listening socket
+ * and the inbound connections awaiting registration: read the register
+ * messages that arrived, and accept the pending connection requests.  n is
+ * the number of events select() returned; the events dealt with are cleared
+ * from rset, and the number of events left over for other sockets is
+ * returned.  *incoming_count is advanced for every
+ * route that completed its registration.
+ */
+static int
+completeIncomingConnections(ChunkTransportState *transportStates,
+							mpp_fd_set *rset, int n, int *incoming_count)
+{
+	ListCell   *cell;
+	MotionConn *conn;
+
+	/*
+	 * check our connections that are accepted'd but no register
+	 * message. we don't know which motion node these apply to until
+	 * we actually receive the REGISTER message.  this is why they are
+	 * all in a single list.
+	 *
+	 * NOTE: we don't use foreach() here because we want to trim from the
+	 * list as we go.
+	 */
+	cell = list_head(transportStates->incompleteConns);
+	while (n > 0 && cell != NULL)
+	{
+		conn = (MotionConn *) lfirst(cell);
+
+		/*
+		 * we'll get the next cell ready now in case we need to delete
+		 * the cell that corresponds to our MotionConn
+		 */
+		cell = lnext(cell);
+
+		if (MPP_FD_ISSET(conn->sockfd, rset))
+		{
+			n--;
+			MPP_FD_CLR(conn->sockfd, rset);
+			if (readRegisterMessage(transportStates, conn))
+			{
+				/* We're done with this connection (either it is
+				 * bogus (and has been dropped), or we've added it to the appropriate
+				 * hash table) */
+				transportStates->incompleteConns = list_delete_ptr(transportStates->incompleteConns, conn);
+
+				/* is the connection ready ? */
+				if (conn->sockfd != -1)
+					(*incoming_count)++;
+
+				if (conn->pBuff)
+					pfree(conn->pBuff);
+				/* Free temporary MotionConn storage. */
+				pfree(conn);
+			}
+		}
+	}
+
+	/*
+	 * Someone tickling our listener port?  Accept pending connections.
+	 */
+	if (n > 0 && TCP_listenerFd >= 0 && MPP_FD_ISSET(TCP_listenerFd, rset))
+	{
+		n--;
+		MPP_FD_CLR(TCP_listenerFd, rset);
+		while ((conn = acceptIncomingConnection()) != NULL)
+		{
+			/* get the connection read for a subsequent call to ReadRegisterMessage() */
+			conn->state = mcsRecvRegMsg;
+			conn->msgSize = sizeof(RegisterMessage);
+			conn->msgPos = conn->pBuff;
+
+			transportStates->incompleteConns = lappend(transportStates->incompleteConns, conn);
+		}
+	}
+
+	return n;
+}
+
+/*
+ * unregisteredRoutes
+ *
+ * Number of the senders of a receiving motion node whose registration
+ * message has not been processed yet.  Unused (directed dispatch) entries of
+ * the sending slice never register and are not counted.
+ */
+static int
+unregisteredRoutes(ChunkTransportStateEntry *pEntry)
+{
+	int			i;
+	int			count = 0;
+
+	for (i = 0; i < pEntry->numConns; i++)
+	{
+		if (pEntry->conns[i].cdbProc == NULL &&
+			list_nth(pEntry->sendSlice->primaryProcesses, i) != NULL)
+			count++;
+	}
+
+	return count;
+}
+
+/*
+ * waitForIncomingRoutes
+ *
+ * When gp_interconnect_defer_incoming let SetupTCPInterconnect() return
+ * before all the senders had registered, the receiver completes their
+ * registration on first use of the route.  Wait until the sender of conn
+ * (or, if conn is NULL, every sender of the motion node) has registered.
+ */
+static void
+waitForIncomingRoutes(ChunkTransportState *transportStates,
+					  ChunkTransportStateEntry *pEntry, MotionConn *conn)
+{
+	GpMonotonicTime startTime;
+
+	gp_set_monotonic_begin_time(&startTime);
+
+	while (transportStates->pendingIncoming > 0 &&
+		   (conn ? conn->cdbProc == NULL : unregisteredRoutes(pEntry) > 0))
+	{
+		struct timeval timeout = tval;
+		mpp_fd_set	rset;
+		int			highsock = -1;
+		int			incoming_count = 0;
+		int			n;
+
+		ML_CHECK_FOR_INTERRUPTS(transportStates->teardownActive);
+
+		if (interconnect_setup_timeout > 0 &&
+			gp_get_elapsed_ms(&startTime) >= (uint64) interconnect_setup_timeout * 1000)
+			ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+							errmsg("Interconnect timeout: Unable to "
+								   "complete setup of incoming connections "
+								   "from slice%d within time limit.",
+								   pEntry->sendSlice->sliceIndex),
+							errdetail("%d incoming connections not registered.  "
+									  "gp_interconnect_setup_timeout = %d "
+									  "seconds.",
+									  unregisteredRoutes(pEntry),
+									  interconnect_setup_timeout)));
+
+		MPP_FD_ZERO(&rset);
+		addIncomingInterest(transportStates, &rset, &highsock);
+
+		n = select(highsock + 1, (fd_set *)&rset, NULL, NULL, &timeout);
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+							errmsg("Interconnect error: %m%s", "select")));
+		}
+
+		completeIncomingConnections(transportStates, &rset, n, &incoming_count);
+		transportStates->pendingIncoming -= incoming_count;
+	}
+}
+
 /* See ml_ipc.h */
 void
 SetupTCPInterconnect(EState *estate)
@@ -1384,6 +1584,7 @@ SetupTCPInterconnect(EState *estate)
 	int			outgoing_count = 0;
 	int			expectedTotalIncoming = 0;
 	int			expectedTotalOutgoing = 0;
+	bool		deferIncoming = gp_interconnect_defer_incoming;
     int         iteration = 0;
 	GpMonotonicTime startTime;
     StringInfoData  logbuf;
@@ -1411,6 +1612,7 @@ SetupTCPInterconnect(EState *estate)
 	estate->interconnect_context->teardownActive = false;
 	estate->interconnect_context->activated = false;
 	estate->interconnect_context->incompleteConns = NIL;
+	estate->interconnect_context->pendingIncoming = 0;
 	estate->interconnect_context->sliceTable = NULL;
 	estate->interconnect_context->sliceId = -1;
 
@@ -1487,9 +1689,15 @@ SetupTCPInterconnect(EState *estate)
 
 	/*
      * Loop until all connections are completed or time limit is exceeded.
+	 *
+	 * With gp_interconnect_defer_incoming we only wait for our outgoing
+	 * connections: the incoming routes that have not registered by then
+	 * are completed by the receiving motion node when it first reads from
+	 * them, so that this slice can start executing without waiting for all
+	 * the slices below it to be dispatched and set up.
 	 */
 	while (outgoing_count < expectedTotalOutgoing ||
-           incoming_count < expectedTotalIncoming)
+           (!deferIncoming && incoming_count < expectedTotalIncoming))
 	{                           /* select() loop */
 		struct timeval	timeout;
         mpp_fd_set		rset, wset, eset;
@@ -1619,7 +1827,7 @@ SetupTCPInterconnect(EState *estate)
 
         /* Break out of select() loop if completed all connections. */
         if (outgoing_count == expectedTotalOutgoing &&
-            incoming_count == expectedTotalIncoming)
+            (deferIncoming || incoming_count == expectedTotalIncoming))
             break;
 
         /*
@@ -1760,67 +1968,14 @@ SetupTCPInterconnect(EState *estate)
 		}
 
 		/*
-		 * check our connections that are accepted'd but no register
-		 * message. we don't know which motion node these apply to until
-		 * we actually receive the REGISTER message.  this is why they are
-		 * all in a single list.
-		 *
-		 * NOTE: we don't use foreach() here because we want to trim from the
-		 * list as we go.
+		 * Complete the registration of inbound connections, and accept
+		 * new ones.
 		 *
 		 * We used to bail out of the while loop when incoming_count hit expectedTotalIncoming, but
 		 * that causes problems if some connections are left over -- better to just process them
 		 * here.
 		 */
-		cell = list_head(estate->interconnect_context->incompleteConns);
-		while (n > 0 && cell != NULL)
-		{
-			conn = (MotionConn *) lfirst(cell);
-
-			/*
-			 * we'll get the next cell ready now in case we need to delete
-			 * the cell that corresponds to our MotionConn
-			 */
-			cell = lnext(cell);
-
-			if (MPP_FD_ISSET(conn->sockfd, &rset))
-			{
-                n--;
-                if (readRegisterMessage(estate->interconnect_context, conn))
-                {
-					/* We're done with this connection (either it is
-					 * bogus (and has been dropped), or we've added it to the appropriate
-					 * hash table) */
-                    estate->interconnect_context->incompleteConns = list_delete_ptr(estate->interconnect_context->incompleteConns, conn);
-
-					/* is the connection ready ? */
-					if (conn->sockfd != -1)
-						incoming_count++;
-
-					if (conn->pBuff)
-						pfree(conn->pBuff);
-                    /* Free temporary MotionConn storage. */
-                    pfree(conn);
-                }
-			}
-		}
-
-        /*
-         * Someone tickling our listener port?  Accept pending connections.
-         */
-        if (MPP_FD_ISSET(TCP_listenerFd, &rset))
-		{
-			n--;
-            while ((conn = acceptIncomingConnection()) != NULL)
-            {
-				/* get the connection read for a subsequent call to ReadRegisterMessage() */
-				conn->state = mcsRecvRegMsg;
-				conn->msgSize = sizeof(RegisterMessage);
-				conn->msgPos = conn->pBuff;
-
-				estate->interconnect_context->incompleteConns = lappend(estate->interconnect_context->incompleteConns, conn);
-            }
-		}
+		n = completeIncomingConnections(estate->interconnect_context, &rset, n, &incoming_count);
 
 		/*
          * Check our outgoing connections.
@@ -1892,8 +2047,14 @@ SetupTCPInterconnect(EState *estate)
 	 * up. These connections should be closed out here. It would
 	 * obviously be better if we could avoid these connections in the
 	 * first place!
+	 *
+	 * If some incoming routes are left for the receivers to complete,
+	 * the incomplete connections are theirs to process.
 	 */
-	if (list_length(estate->interconnect_context->incompleteConns) != 0)
+	estate->interconnect_context->pendingIncoming = expectedTotalIncoming - incoming_count;
+
+	if (estate->interconnect_context->pendingIncoming == 0 &&
+		list_length(estate->interconnect_context->incompleteConns) != 0)
 	{
         if (gp_log_interconnect >= GPVARS_VERBOSITY_DEBUG)
             elog(DEBUG2, "Incomplete connections after known connections done, cleaning %d",
@@ -1927,8 +2088,9 @@ SetupTCPInterconnect(EState *estate)
         if (gp_log_interconnect >= GPVARS_VERBOSITY_VERBOSE ||
             elapsed_ms >= 0.1 * 1000 * interconnect_setup_timeout)
             elog(LOG, "SetupInterconnect+" UINT64_FORMAT "ms: Activated %d incoming, "
-                 "%d outgoing routes.",
-                 elapsed_ms, incoming_count, outgoing_count);
+                 "%d outgoing routes, %d incoming routes deferred.",
+                 elapsed_ms, incoming_count, outgoing_count,
+                 estate->interconnect_context->pendingIncoming);
     }
 }                               /* SetupInterconnect */
 
@@ -2521,6 +2683,10 @@ doSendStopMessageTCP(ChunkTransportState *transportStates, int16 motNodeID)
 		elog(DEBUG3, "Interconnect needs no more input from slice%d; notifying senders to stop.",
 			 motNodeID);
 
+	/* senders we haven't heard from yet have to be told too */
+	if (transportStates->pendingIncoming > 0)
+		waitForIncomingRoutes(transportStates, pEntry, NULL);
+
 	/*
 	 * Note: we're only concerned with receivers here.
 	 */
@@ -2576,6 +2742,9 @@ RecvTupleChunkFromTCP(ChunkTransportState *transportStates,
 	getChunkTransportState(transportStates, motNodeID, &pEntry);
 	conn = pEntry->conns + srcRoute;
 
+	if (conn->cdbProc == NULL && transportStates->pendingIncoming > 0)
+		waitForIncomingRoutes(transportStates, pEntry, conn);
+
 	return RecvTupleChunk(conn, transportStates->teardownActive);
 }
 
@@ -2593,7 +2762,9 @@ RecvTupleChunkFromAnyTCP(MotionLayerState *mlStates,
 	int			n,
 		i,
 		index;
+	int			highsock;
 	bool		skipSelect = false;
+	GpMonotonicTime startTime;
 
 
 
@@ -2603,6 +2774,10 @@ RecvTupleChunkFromAnyTCP(MotionLayerState *mlStates,
 
 	getChunkTransportState(transportStates, motNodeID, &pEntry);
 	pMNEntry = getMotionNodeEntry(mlStates, motNodeID, "RecvTupleChunkFromAny");
+
+	if (transportStates->pendingIncoming > 0)
+		gp_set_monotonic_begin_time(&startTime);
+
 	do
 	{
 		struct timeval timeout = tval;
@@ -2635,7 +2810,12 @@ RecvTupleChunkFromAnyTCP(MotionLayerState *mlStates,
 		if (skipSelect)
 			break;
 
-		n = select(pEntry->highReadSock + 1, (fd_set *)&rset, NULL, NULL, &timeout);
+		/* Some senders may still have to register; listen for them too. */
+		highsock = pEntry->highReadSock;
+		if (transportStates->pendingIncoming > 0)
+			addIncomingInterest(transportStates, &rset, &highsock);
+
+		n = select(highsock + 1, (fd_set *)&rset, NULL, NULL, &timeout);
 		pMNEntry->sel_rd_wait += (tval.tv_sec - timeout.tv_sec) * 1000000 + (tval.tv_usec - timeout.tv_usec);
 		if (n < 0)
 		{
@@ -2645,6 +2825,28 @@ RecvTupleChunkFromAnyTCP(MotionLayerState *mlStates,
 							errmsg("Interconnect error receiving an incoming packet."),
 			                errdetail("%m%s", "select")));
 		}
+
+		if (transportStates->pendingIncoming > 0)
+		{
+			int			incoming_count = 0;
+
+			n = completeIncomingConnections(transportStates, &rset, n, &incoming_count);
+			transportStates->pendingIncoming -= incoming_count;
+
+			if (n == 0 && interconnect_setup_timeout > 0 &&
+				gp_get_elapsed_ms(&startTime) >= (uint64) interconnect_setup_timeout * 1000 &&
+				unregisteredRoutes(pEntry) > 0)
+				ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+								errmsg("Interconnect timeout: Unable to "
+									   "complete setup of incoming connections "
+									   "from slice%d within time limit.",
+									   motNodeID),
+								errdetail("%d incoming connections not registered.  "
+										  "gp_interconnect_setup_timeout = %d "
+										  "seconds.",
+										  unregisteredRoutes(pEntry),
+										  interconnect_setup_timeout)));
+		}
 #ifdef AMS_VERBOSE_LOGGING
 		elog(DEBUG5, "RecvTupleChunkFromAny() select() returned %d ready sockets", n);
 #endif
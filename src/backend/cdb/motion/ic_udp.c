@@ -37,6 +37,7 @@
 #include <pthread.h>
 
 #include "access/transam.h"
+#include "executor/instrument.h"
 #include "nodes/execnodes.h"
 #include "nodes/pg_list.h"
 #include "nodes/print.h"
@@ -152,6 +153,12 @@ timeoutArray[] =
 /* 1/4 sec in msec */
 #define RX_THREAD_POLL_TIMEOUT (250)
 
+/* max number of packets sent by one sendmmsg or received by one recvmmsg */
+#define UDPIC_MAX_IO_BATCH (64)
+
+/* max number of receive threads, see Gp_interconnect_rx_threads */
+#define UDPIC_MAX_RX_THREADS (8)
+
 /*
  * Flags definitions for flag-field of UDP-messages
  *
@@ -165,6 +172,13 @@ timeoutArray[] =
 #define UDPIC_FLAGS_DISORDER    		(32)
 #define UDPIC_FLAGS_DUPLICATE   		(64)
 #define UDPIC_FLAGS_CAPACITY    		(128)
+#define UDPIC_FLAGS_SHM					(256)	/* the packet is in the shared memory ring */
+#define UDPIC_FLAGS_ECN					(512)	/* the receiver got a packet marked CE */
+
+/* the ECN codepoints of the IP TOS / traffic class byte */
+#define UDPIC_ECN_MASK					(0x03)
+#define UDPIC_ECN_ECT0					(0x02)
+#define UDPIC_ECN_CE					(0x03)
 
 /*
  * ConnHtabBin
@@ -362,10 +376,19 @@ struct SendBufferPool
 	/* The number of buffers sender already used. */
 	int count;
 
+	/* The maximal number of buffers of one connection, see creditWindow(). */
+	int connMaxCount;
+
 	/* The free buffer list at the sender side. */
 	ICBufferList freeList;
+
+	/* The slab the buffers are allocated from. */
+	MemoryContext cxt;
 };
 
+/* The number of send buffers in a block of the send buffer slab. */
+#define SND_BUFFER_SLAB_BLOCK_BUFFERS 8
+
 /*
  * The sender side buffer pool.
  */
@@ -394,6 +417,9 @@ struct SendControlInfo
 	/* slow start threshold */
 	float ssthresh;
 
+	/* last time the window was reduced by the rtt method */
+	uint64 lastReduceTime;
+
 };
 
 /*
@@ -440,10 +466,15 @@ struct UDPSignal
 typedef struct ICGlobalControlInfo ICGlobalControlInfo;
 struct ICGlobalControlInfo
 {
-	/* The background thread handle. */
-	pthread_t threadHandle;
+	/*
+	 * The background thread handles, one per receive socket. rxFds[0] is the
+	 * listener socket, the others are bound to the same port.
+	 */
+	pthread_t threadHandles[UDPIC_MAX_RX_THREADS];
+	int rxFds[UDPIC_MAX_RX_THREADS];
+	int numRxThreads;
 
-	/* flag showing whether the thread is created. */
+	/* flag showing whether the threads are created. */
 	bool threadCreated;
 
 	/* The lock protecting eno field. */
@@ -456,6 +487,7 @@ struct ICGlobalControlInfo
 
 	uint64 lastExpirationCheckTime;
 	uint64 lastDeadlockCheckTime;
+	uint64 lastStopCheckTime;
 
 	/* Used to decide whether to retransmit for capacity based FC. */
 	uint64 lastPacketSendTime;
@@ -474,6 +506,18 @@ struct ICGlobalControlInfo
 	/* Am I a sender? */
 	bool isSender;
 
+	/*
+	 * The socket of the sending motion node. It is kept open across
+	 * statements, so a sender does not bind a new port for every query;
+	 * the acks of the past queries are told apart by their icId.
+	 */
+	int txfd;
+	int txfdFamily;
+	uint16 txport;
+
+	/* are the packets of txfd marked ECN capable ? */
+	bool txEct;
+
 	/* Global connection htab for both sending connections and
 	 * receiving connections. Protected by the lock in this data structure.
 	 */
@@ -516,6 +560,7 @@ static ICGlobalControlInfo ic_control_info;
  * MAX_EXPIRATION_PERIOD      - max expiration period in us
  * MIN_EXPIRATION_PERIOD      - min expiration period in us
  * MAX_TIME_NO_TIMER_CHECKING - max time without checking timer
+ * MAX_TIME_NO_STOP_CHECKING  - max time a sender goes without looking for stop messages
  * DEADLOCK_CHECKING_TIME     - deadlock checking time
  *
  * MAX_SEQS_IN_DISORDER_ACK   - max number of sequences that can be transmitted in a
@@ -572,10 +617,18 @@ static ICGlobalControlInfo ic_control_info;
 #define MIN_EXPIRATION_PERIOD (Gp_interconnect_min_rto * 1000) /* default: 20ms */
 
 #define MAX_TIME_NO_TIMER_CHECKING (50 * 1000) /* 50ms */
+#define MAX_TIME_NO_STOP_CHECKING (5 * 1000) /* 5ms */
 #define DEADLOCK_CHECKING_TIME  (512 * 1000) /* 512ms */
 
 #define MAX_SEQS_IN_DISORDER_ACK (4)
 
+/* the flow control methods using the congestion window of the sender */
+#define CWND_BASED_FC() (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS || \
+						 Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_RTT)
+
+/* the rtt method does not reduce the window below this fraction at once */
+#define RTT_FC_MAX_DECREASE (0.5)
+
 /*
  * UnackQueueRing
  *
@@ -646,6 +699,10 @@ typedef struct AckSendParam
  * totalBuffers              - total buffers available when sending packets.
  * bufferCountingTime        - counting times when compute totalBuffers.
  * retransmits               - the number of packet retransmits.
+ * timeoutRetransmits        - the retransmits due to an expired packet.
+ * ecnMarkedPktNum           - packets received with the CE mark.
+ * ecnEchoNum                - acks received echoing a CE mark.
+ * cwndReductions            - reductions of the window by the rtt method.
  * mismatchNum               - the number of mismatched packets received.
  * crcErrors                 - the number of crc errors.
  * sndPktNum                 - the number of packets sent by sender.
@@ -665,6 +722,10 @@ typedef struct ICStatistics
 	uint64	totalBuffers;
 	uint64	bufferCountingTime;
 	int32	retransmits;
+	int32	timeoutRetransmits;
+	int32	ecnMarkedPktNum;
+	int32	ecnEchoNum;
+	int32	cwndReductions;
 	int32	startupCachedPktNum;
 	int32	mismatchNum;
 	int32	crcErrors;
@@ -702,7 +763,9 @@ static void resetRxThreadError(void);
 static void getSockAddr(struct sockaddr_storage * peer, socklen_t * peer_len, const char * listenerAddr, int listenerPort);
 static void setXmitSocketOptions(int txfd);
 static uint32 setSocketBufferSize(int fd, int type, int expectedSize, int leastSize);
-static void setupUDPListeningSocket(int *listenerSocketFd, uint16 *listenerPort, int *txFamily);
+static void setupUDPListeningSocket(int *listenerSocketFd, uint16 *listenerPort, int *txFamily, bool reusePort);
+static int setupUDPRxSocket(int listenerSocketFd);
+static void setRecvECNOptions(int fd, int family);
 static ChunkTransportStateEntry *startOutgoingUDPConnections(ChunkTransportState *transportStates,
 															 Slice *sendSlice,
 															 int *pOutgoingCount);
@@ -780,6 +843,9 @@ static void doSendStopMessageUDP(ChunkTransportState *transportStates, int16 mot
 static bool dispatcherAYT(void);
 
 static void *rxThreadFunc(void *arg);
+static inline bool rxThreadShutdown(void);
+static void joinRxThreads(void);
+static void closeRxSockets(int first);
 
 static bool handleMismatch(icpkthdr *pkt, struct sockaddr_storage *peer, int peer_len);
 static void inline handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now);
@@ -794,8 +860,16 @@ static inline void prepareXmit(MotionConn *conn);
 static inline void addCRC(icpkthdr *pkt);
 static inline bool checkCRC(icpkthdr *pkt);
 static void sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn);
+static int receivePackets(int fd, icpkthdr **pkts, int nbufs, struct sockaddr_storage *peers, socklen_t *peerlens, int *lens, bool *ce);
+static void handleRxPacket(icpkthdr **ppkt, int read_count, struct sockaddr_storage *peer, socklen_t peerlen, bool ce);
 static void sendOnce(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, ICBuffer *buf, MotionConn * conn);
+static void sendBatch(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, ICBuffer **bufs, int nbufs, MotionConn *conn);
+static inline int ioBatchSize(void);
 static inline uint64 computeExpirationPeriod(MotionConn *conn, uint32 retry);
+static void reduceCwnd(MotionConn *conn, float factor, uint64 now);
+static void adjustCwndByDelay(MotionConn *conn, uint64 ackTime, uint64 now);
+static inline uint64 pacingInterval(MotionConn *conn);
+static void setSocketECT(int fd, int family, bool on);
 
 static ICBuffer *getSndBuffer(MotionConn *conn);
 static void initSndBufferPool();
@@ -816,6 +890,7 @@ static bool waitOnCondition(int timeout_us, pthread_cond_t *cond, pthread_mutex_
 
 static inline void logPkt(char *prefix, icpkthdr *pkt);
 static void aggregateStatistics(ChunkTransportStateEntry *pEntry);
+static void logMotionStatistics(ChunkTransportStateEntry *pEntry, bool isSender);
 
 static inline bool pollAcks(ChunkTransportState *transportStates, int fd, int timeout);
 
@@ -1207,9 +1282,12 @@ resetRxThreadError()
 /*
  * setupUDPListeningSocket
  * 		Setup udp listening socket.
+ *
+ * If reusePort is set, other sockets may be bound to the port later, see
+ * setupUDPRxSocket().
  */
 static void
-setupUDPListeningSocket(int *listenerSocketFd, uint16 *listenerPort, int *txFamily)
+setupUDPListeningSocket(int *listenerSocketFd, uint16 *listenerPort, int *txFamily, bool reusePort)
 {
 	int					errnoSave;
 	int					fd = -1;
@@ -1314,6 +1392,20 @@ setupUDPListeningSocket(int *listenerSocketFd, uint16 *listenerPort, int *txFami
 			continue;
 		}
 
+#ifdef SO_REUSEPORT
+		if (reusePort)
+		{
+			int		on = 1;
+
+			fun = "setsockopt(SO_REUSEPORT)";
+			if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) < 0)
+			{
+				closesocket(fd);
+				continue;
+			}
+		}
+#endif
+
 		fun = "bind";
 		elog(DEBUG1,"bind addrlen %d fam %d",rp->ai_addrlen,rp->ai_addr->sa_family);
 		if (bind(fd, rp->ai_addr, rp->ai_addrlen) == 0)
@@ -1353,6 +1445,7 @@ setupUDPListeningSocket(int *listenerSocketFd, uint16 *listenerPort, int *txFami
 		*listenerPort = ntohs(((struct sockaddr_in *)&our_addr)->sin_port);
 
 	setXmitSocketOptions(fd);
+	setRecvECNOptions(fd, our_addr.ss_family);
 
 	return;
 
@@ -1367,6 +1460,81 @@ error:
 	return;
 }
 
+/*
+ * setupUDPRxSocket
+ * 		Setup one more receive socket bound to the address of the listener
+ * 		socket, which must have been set up with reusePort.
+ *
+ * The kernel hashes the address of the sender to pick one of the sockets
+ * bound to the port, so the packets of a connection always arrive at the
+ * same socket, in order.
+ *
+ * Returns the socket, or -1 if it cannot be set up, the caller then does
+ * with the sockets it has.
+ */
+static int
+setupUDPRxSocket(int listenerSocketFd)
+{
+#ifdef SO_REUSEPORT
+	struct sockaddr_storage addr;
+	socklen_t	addrlen = sizeof(addr);
+	const char *fun;
+	int			fd = -1;
+	int			on = 1;
+
+	fun = "getsockname";
+	if (getsockname(listenerSocketFd, (struct sockaddr *) &addr, &addrlen) < 0)
+		goto error;
+
+	fun = "socket";
+	fd = socket(addr.ss_family, SOCK_DGRAM, 0);
+	if (fd < 0)
+		goto error;
+
+	fun = "fcntl(O_NONBLOCK)";
+	if (!pg_set_noblock(fd))
+		goto error;
+
+	fun = "setsockopt(SO_REUSEPORT)";
+	if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) < 0)
+		goto error;
+
+	fun = "bind";
+	if (bind(fd, (struct sockaddr *) &addr, addrlen) < 0)
+		goto error;
+
+	setXmitSocketOptions(fd);
+	setRecvECNOptions(fd, addr.ss_family);
+
+	return fd;
+
+error:
+	elog(LOG, "could not set up interconnect receive socket, %s: %m", fun);
+	if (fd >= 0)
+		closesocket(fd);
+#endif
+	return -1;
+}
+
+/*
+ * setRecvECNOptions
+ * 		Ask for the ECN codepoints of the packets received through a socket,
+ * 		see receivePackets().
+ */
+static void
+setRecvECNOptions(int fd, int family)
+{
+	int		on = 1;
+
+#ifdef IP_RECVTOS
+	setsockopt(fd, IPPROTO_IP, IP_RECVTOS, &on, sizeof(on));
+#endif
+#if defined(HAVE_IPV6) && defined(IPV6_RECVTCLASS)
+	if (family == AF_INET6)
+		setsockopt(fd, IPPROTO_IPV6, IPV6_RECVTCLASS, &on, sizeof(on));
+#endif
+}
+
 /*
  * InitMutex
  * 		Initialize mutex.
@@ -1388,8 +1556,9 @@ initMutex(pthread_mutex_t *mutex)
 void
 InitMotionUDP(int *listenerSocketFd, uint16 *listenerPort)
 {
-	int pthread_err;
+	int pthread_err = 0;
 	int txFamily = -1;
+	int i;
 
 	/* attributes of the thread we're creating */
 	pthread_attr_t t_atts;
@@ -1409,6 +1578,10 @@ InitMotionUDP(int *listenerSocketFd, uint16 *listenerPort)
 	initMutex(&ic_control_info.lock);
 	pthread_cond_init(&ic_control_info.cond, NULL);
 	ic_control_info.shutdown = 0;
+	ic_control_info.txfd = -1;
+	ic_control_info.txfdFamily = 0;
+	ic_control_info.txport = 0;
+	ic_control_info.txEct = false;
 
 	old = MemoryContextSwitchTo(ic_control_info.memContext);
 
@@ -1420,7 +1593,19 @@ InitMotionUDP(int *listenerSocketFd, uint16 *listenerPort)
 	/*
 	 * setup listening socket.
 	 */
-	setupUDPListeningSocket(listenerSocketFd, listenerPort, &txFamily);
+	setupUDPListeningSocket(listenerSocketFd, listenerPort, &txFamily,
+							Gp_interconnect_rx_threads > 1);
+
+	ic_control_info.rxFds[0] = *listenerSocketFd;
+	ic_control_info.numRxThreads = 1;
+	while (ic_control_info.numRxThreads < Min(Gp_interconnect_rx_threads, UDPIC_MAX_RX_THREADS))
+	{
+		int		fd = setupUDPRxSocket(*listenerSocketFd);
+
+		if (fd < 0)
+			break;
+		ic_control_info.rxFds[ic_control_info.numRxThreads++] = fd;
+	}
 
 #if defined(__darwin__) && !defined(IC_USE_PTHREAD_SYNCHRONIZATION)
 	setupUDPSignal(&ic_control_info.usig);
@@ -1448,7 +1633,7 @@ InitMotionUDP(int *listenerSocketFd, uint16 *listenerPort)
 	initMutex(&trans_proto_stats.lock);
 #endif
 
-	/* Start up our rx-thread */
+	/* Start up our rx-threads, one per receive socket */
 
 	/* save ourselves some memory: the defaults for thread stack
 	 * size are large (1M+) */
@@ -1460,10 +1645,16 @@ InitMotionUDP(int *listenerSocketFd, uint16 *listenerPort)
 #else
 	pthread_attr_setstacksize(&t_atts, Max(PTHREAD_STACK_MIN, (128*1024)));
 #endif
-	pthread_err = pthread_create(&ic_control_info.threadHandle, &t_atts, rxThreadFunc, NULL);
+	for (i = 0; i < ic_control_info.numRxThreads; i++)
+	{
+		pthread_err = pthread_create(&ic_control_info.threadHandles[i], &t_atts,
+									 rxThreadFunc, &ic_control_info.rxFds[i]);
+		if (pthread_err != 0)
+			break;
+	}
 
 	pthread_attr_destroy(&t_atts);
-	if (pthread_err != 0)
+	if (i == 0)
 	{
 		ic_control_info.threadCreated = false;
 		ereport(FATAL, (errcode(ERRCODE_INTERNAL_ERROR),
@@ -1471,10 +1662,52 @@ InitMotionUDP(int *listenerSocketFd, uint16 *listenerPort)
 						errdetail("pthread_create() failed with err %d", pthread_err)));
 	}
 
+	/* the sockets without a thread would not be drained */
+	if (i < ic_control_info.numRxThreads)
+	{
+		elog(LOG, "udp-ic: created %d of %d receive threads, pthread_create() failed with err %d",
+			 i, ic_control_info.numRxThreads, pthread_err);
+		closeRxSockets(i);
+	}
+
 	ic_control_info.threadCreated = true;
 	return;
 }
 
+/*
+ * closeRxSockets
+ * 		Close the receive sockets from the first-th on, the listener socket
+ * 		is closed by the caller of CleanupMotionUDP().
+ */
+static void
+closeRxSockets(int first)
+{
+	int		i;
+
+	for (i = Max(first, 1); i < ic_control_info.numRxThreads; i++)
+	{
+		closesocket(ic_control_info.rxFds[i]);
+		ic_control_info.rxFds[i] = -1;
+	}
+	ic_control_info.numRxThreads = Max(first, 1);
+}
+
+/*
+ * joinRxThreads
+ * 		Wait for the rx-threads to exit after the shutdown flag was set, and
+ * 		clear the flag.
+ */
+static void
+joinRxThreads(void)
+{
+	int		i;
+
+	for (i = 0; i < ic_control_info.numRxThreads; i++)
+		pthread_join(ic_control_info.threadHandles[i], NULL);
+
+	ic_control_info.shutdown = 0;
+}
+
 /*
  * CleanupMotionUDP
  * 		Clean up UDP specific stuff such as cursor ic hash table, thread etc.
@@ -1497,7 +1730,9 @@ CleanupMotionUDP(void)
 
 	if(ic_control_info.threadCreated)
 	{
-		pthread_join(ic_control_info.threadHandle, NULL);
+		joinRxThreads();
+		closeRxSockets(1);
+		ic_control_info.threadCreated = false;
 	}
 
 	elog(DEBUG2, "udp-ic: receiver thread shutdown.");
@@ -1518,6 +1753,14 @@ CleanupMotionUDP(void)
 	pfree(snd_control_info.ackBuffer);
 	snd_control_info.ackBuffer = NULL;
 
+	/* close the socket of the sending motion nodes */
+	if (ic_control_info.txfd >= 0)
+		closesocket(ic_control_info.txfd);
+	ic_control_info.txfd = -1;
+
+	/* the send buffer slab goes away with the interconnect memory context */
+	snd_buffer_pool.cxt = NULL;
+
 	MemoryContextDelete(ic_control_info.memContext);
 
 #if defined(__darwin__) && !defined(IC_USE_PTHREAD_SYNCHRONIZATION)
@@ -1865,6 +2108,11 @@ static inline void
 setAckSendParam(AckSendParam *param, MotionConn *conn, int32 flags, uint32 seq, uint32 extraSeq)
 {
 	memcpy(&param->msg, (char *)&conn->conn_info, sizeof(icpkthdr));
+	if (conn->ecnEcho)
+	{
+		flags |= UDPIC_FLAGS_ECN;
+		conn->ecnEcho = false;
+	}
 	param->msg.flags = flags;
 	param->msg.seq = seq;
 	param->msg.extraSeq = extraSeq;
@@ -1894,6 +2142,12 @@ sendAck(MotionConn *conn, int32 flags, uint32 seq, uint32 extraSeq)
 
 	memcpy(&msg, (char *)&conn->conn_info, sizeof(msg));
 
+	if (conn->ecnEcho)
+	{
+		flags |= UDPIC_FLAGS_ECN;
+		conn->ecnEcho = false;
+	}
+
 	msg.flags = flags;
 	msg.seq = seq;
 	msg.extraSeq = extraSeq;
@@ -2258,6 +2512,30 @@ setXmitSocketOptions(int txfd)
 
 }
 
+/*
+ * setSocketECT
+ * 		Mark the packets sent through a socket as ECN capable, or stop it.
+ *
+ * With the rtt flow control method, the switches may mark the packets CE
+ * instead of dropping them when their queues build up.
+ */
+static void
+setSocketECT(int fd, int family, bool on)
+{
+	int		tos = (on ? UDPIC_ECN_ECT0 : 0);
+
+#ifdef IP_TOS
+	if (setsockopt(fd, IPPROTO_IP, IP_TOS, &tos, sizeof(tos)) < 0 &&
+		family == AF_INET)
+		elog(LOG, "could not set the ECN codepoint of the interconnect socket: %m");
+#endif
+#if defined(HAVE_IPV6) && defined(IPV6_TCLASS)
+	if (family == AF_INET6 &&
+		setsockopt(fd, IPPROTO_IPV6, IPV6_TCLASS, &tos, sizeof(tos)) < 0)
+		elog(LOG, "could not set the ECN codepoint of the interconnect socket: %m");
+#endif
+}
+
 #ifdef USE_ASSERT_CHECKING
 
 /*
@@ -2588,6 +2866,98 @@ computeExpirationPeriod(MotionConn *conn, uint32 retry)
     }
 }
 
+/*
+ * reduceCwnd
+ * 		Multiply the congestion window by factor, at most once per RTT.
+ *
+ * Used by the rtt flow control method on a CE mark, a packet loss or a
+ * queueing delay above gp_interconnect_rtt_target_delay. The signals of
+ * the same congestion episode arrive within an RTT, only the first counts.
+ */
+static void
+reduceCwnd(MotionConn *conn, float factor, uint64 now)
+{
+	if (now - snd_control_info.lastReduceTime < conn->rtt)
+		return;
+
+	snd_control_info.cwnd = Max(snd_control_info.cwnd * factor, snd_control_info.minCwnd);
+	snd_control_info.ssthresh = snd_control_info.cwnd;
+	snd_control_info.lastReduceTime = now;
+	ic_statistics.cwndReductions++;
+}
+
+/*
+ * adjustCwndByDelay
+ * 		Adjust the congestion window from the RTT sample of an acked packet.
+ *
+ * The queueing delay is the sample less the smallest RTT seen on the
+ * connection. Below the target delay the window grows as with the loss
+ * method, above it the window is reduced in proportion to the excess, so
+ * the senders of an incast back off before the switch drops packets.
+ */
+static void
+adjustCwndByDelay(MotionConn *conn, uint64 ackTime, uint64 now)
+{
+	uint64 target = (uint64) Gp_interconnect_rtt_target_delay;
+	uint64 delay;
+
+	if (ackTime < conn->minRtt)
+		conn->minRtt = ackTime;
+	delay = ackTime - conn->minRtt;
+
+	if (delay > target)
+	{
+		float excess = (float) (delay - target) / (float) delay;
+
+		reduceCwnd(conn, 1 - RTT_FC_MAX_DECREASE * excess, now);
+		return;
+	}
+
+	if (snd_control_info.cwnd < snd_control_info.ssthresh)
+		snd_control_info.cwnd += 1;
+	else
+		snd_control_info.cwnd += 1/snd_control_info.cwnd;
+	snd_control_info.cwnd = Min(snd_control_info.cwnd, snd_buffer_pool.maxCount);
+}
+
+/*
+ * pacingInterval
+ * 		The time between two packets of a connection with the rtt method.
+ *
+ * A window of packets is spread over an RTT instead of being sent as a
+ * burst, which is what overflows the switch buffers under incast.
+ */
+static inline uint64
+pacingInterval(MotionConn *conn)
+{
+	return (uint64) (conn->rtt / Max(snd_control_info.cwnd, 1));
+}
+
+/*
+ * creditWindow
+ * 		The window of each connection of a motion node, in packets.
+ *
+ * A motion node with nconns connections in one direction uses up to
+ * depth buffers per connection. If that is more than
+ * gp_interconnect_buffer_budget, which happens with many segments, the
+ * windows are shrunk to fit the budget, down to 2 packets since the
+ * receiver acknowledges every other consumed packet.
+ *
+ * Both ends compute the receive window from the size of the sending slice,
+ * so they agree on it without any message.
+ */
+static int
+creditWindow(int depth, int nconns)
+{
+	int window = depth;
+
+	if (Gp_interconnect_buffer_budget > 0 && nconns > 0 &&
+		(int64) depth * nconns > Gp_interconnect_buffer_budget)
+		window = Max(Min(2, depth), Gp_interconnect_buffer_budget / nconns);
+
+	return Min(window, depth);
+}
+
 /*
  * initSndBufferPool
  * 		Initialize the send buffer pool.
@@ -2598,9 +2968,19 @@ computeExpirationPeriod(MotionConn *conn, uint32 retry)
 static void
 initSndBufferPool(SendBufferPool *p)
 {
+	/* the buffers of an interconnect that was not torn down are lost anyway */
+	if (p->cxt != NULL)
+		MemoryContextDelete(p->cxt);
+
+	p->cxt = SlabContextCreate(ic_control_info.memContext,
+							   "SndBufferPool",
+							   Gp_max_packet_size + sizeof(ICBuffer),
+							   SND_BUFFER_SLAB_BLOCK_BUFFERS);
+
 	icBufferListInit(&p->freeList, ICBufferListType_Primary);
 	p->count = 0;
 	p->maxCount = (Gp_interconnect_snd_queue_depth == 1 ? 1 : 0);
+	p->connMaxCount = Gp_interconnect_snd_queue_depth;
 }
 
 /*
@@ -2613,6 +2993,12 @@ cleanSndBufferPool(SendBufferPool *p)
     icBufferListFree(&p->freeList);
 	p->count = 0;
 	p->maxCount = 0;
+
+	if (p->cxt != NULL)
+	{
+		MemoryContextDelete(p->cxt);
+		p->cxt = NULL;
+	}
 }
 
 /*
@@ -2636,8 +3022,8 @@ getSndBuffer(MotionConn *conn)
 	/* Capacity based flow control does not use shared buffers */
 	if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_CAPACITY)
 	{
-		Assert(icBufferListLength(&conn->unackQueue) + icBufferListLength(&conn->sndQueue) <= Gp_interconnect_snd_queue_depth);
-		if (icBufferListLength(&conn->unackQueue) + icBufferListLength(&conn->sndQueue) >= Gp_interconnect_snd_queue_depth)
+		Assert(icBufferListLength(&conn->unackQueue) + icBufferListLength(&conn->sndQueue) <= snd_buffer_pool.connMaxCount);
+		if (icBufferListLength(&conn->unackQueue) + icBufferListLength(&conn->sndQueue) >= snd_buffer_pool.connMaxCount)
 			return NULL;
 	}
 
@@ -2649,7 +3035,8 @@ getSndBuffer(MotionConn *conn)
 	{
 		if (snd_buffer_pool.count < snd_buffer_pool.maxCount)
 		{
-			ret = (ICBuffer *) palloc0(Gp_max_packet_size + sizeof(ICBuffer));
+			ret = (ICBuffer *) MemoryContextAllocZero(snd_buffer_pool.cxt,
+													  Gp_max_packet_size + sizeof(ICBuffer));
 			snd_buffer_pool.count++;
 			ret->conn = NULL;
 			ret->nRetry = 0;
@@ -2788,7 +3175,7 @@ setupUDPSignal(UDPSignal *sig)
 	Assert(sig != NULL);
 
 	uint16 port;
-	setupUDPListeningSocket(&sig->fd, &port, &sig->txFamily);
+	setupUDPListeningSocket(&sig->fd, &port, &sig->txFamily, false);
 	sig->port = port;
 	getSockAddr(&sig->peer, &sig->peer_len, "127.0.0.1", port);
 	sig->sigId = NULL;
@@ -2957,6 +3344,16 @@ startOutgoingUDPConnections(ChunkTransportState *transportStates,
 									   list_length(recvSlice->primaryProcesses));
 
 	Assert(pEntry && pEntry->valid);
+
+	/*
+	 * The receivers grant each sender of our slice the same window, and
+	 * our send buffers are shared out among the receivers.
+	 */
+	pEntry->streamWindow = creditWindow(Gp_interconnect_queue_depth,
+										list_length(sendSlice->primaryProcesses));
+	snd_buffer_pool.connMaxCount = creditWindow(Gp_interconnect_snd_queue_depth,
+												list_length(recvSlice->primaryProcesses));
+
 	/*
 	 * Setup a MotionConn entry for each of our outbound connections.
 	 * Request a connection to each receiving backend's listening port.
@@ -2973,10 +3370,10 @@ startOutgoingUDPConnections(ChunkTransportState *transportStates,
 			conn->cdbProc = cdbProc;
 			icBufferListInit(&conn->sndQueue, ICBufferListType_Primary);
 			icBufferListInit(&conn->unackQueue, ICBufferListType_Primary);
-			conn->capacity = Gp_interconnect_queue_depth;
+			conn->capacity = pEntry->streamWindow;
 
 			/* send buffer pool must be initialized before this. */
-			snd_buffer_pool.maxCount += Gp_interconnect_snd_queue_depth;
+			snd_buffer_pool.maxCount += snd_buffer_pool.connMaxCount;
 			snd_control_info.cwnd += 1;
 			conn->curBuff = getSndBuffer(conn);
 
@@ -2985,6 +3382,8 @@ startOutgoingUDPConnections(ChunkTransportState *transportStates,
 
 			conn->rtt = DEFAULT_RTT;
 			conn->dev = DEFAULT_DEV;
+			conn->minRtt = MAX_RTT;
+			conn->pacingNextTime = 0;
 			conn->deadlockCheckBeginTime = 0;
 			conn->tupleCount = 0;
 			conn->msgSize = sizeof(conn->conn_info);
@@ -3003,10 +3402,22 @@ startOutgoingUDPConnections(ChunkTransportState *transportStates,
 		conn++;
 	}
 
-	pEntry->txfd = -1;
-	pEntry->txport = 0;
-	setupUDPListeningSocket(&pEntry->txfd, &port, &pEntry->txfd_family);
-	pEntry->txport = port;
+	if (ic_control_info.txfd < 0)
+	{
+		setupUDPListeningSocket(&ic_control_info.txfd, &port, &ic_control_info.txfdFamily, false);
+		ic_control_info.txport = port;
+		ic_control_info.txEct = false;
+	}
+
+	if (ic_control_info.txEct != (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_RTT))
+	{
+		ic_control_info.txEct = !ic_control_info.txEct;
+		setSocketECT(ic_control_info.txfd, ic_control_info.txfdFamily, ic_control_info.txEct);
+	}
+
+	pEntry->txfd = ic_control_info.txfd;
+	pEntry->txfd_family = ic_control_info.txfdFamily;
+	pEntry->txport = ic_control_info.txport;
 
 	return pEntry;
 
@@ -3201,6 +3612,11 @@ setupOutgoingUDPConnection(ChunkTransportState *transportStates, ChunkTransportS
 	conn->conn_info.sessionId = gp_session_id;
 	conn->conn_info.icId = gp_interconnect_id;
 
+	/* a receiver on this host reads the packets from shared memory */
+	conn->shmRing = NULL;
+	if (gp_interconnect_local_shm && icShmPeerIsLocal(cdbProc->listenerAddr))
+		conn->shmRing = icShmRingAttach(&conn->conn_info, Gp_interconnect_queue_depth, Gp_max_packet_size);
+
 	connAddHash(&ic_control_info.connHtab, conn);
 
 	/*
@@ -3421,6 +3837,9 @@ SetupUDPInterconnect_Internal(EState *estate)
 		Assert(pEntry);
 		Assert(pEntry->valid);
 
+		/* the window we grant each sender, see creditWindow() */
+		pEntry->streamWindow = creditWindow(Gp_interconnect_queue_depth, numProcs);
+
 		for (i=0; i < pEntry->numConns; i++)
 		{
 			conn = &pEntry->conns[i];
@@ -3431,7 +3850,7 @@ SetupUDPInterconnect_Internal(EState *estate)
 				numValidProcs++;
 
 				/* update the max buffer count of our rx buffer pool.  */
-				rx_buffer_pool.maxCount += Gp_interconnect_queue_depth;
+				rx_buffer_pool.maxCount += pEntry->streamWindow;
 
 				/* rx_buffer_queue */
 				conn->pkt_q_size = 0;
@@ -3463,6 +3882,22 @@ SetupUDPInterconnect_Internal(EState *estate)
 				conn->conn_info.icId = gp_interconnect_id;
 				conn->conn_info.flags = UDPIC_FLAGS_RECEIVER_TO_SENDER;
 
+				/*
+				 * A sender on this host puts its packets into the shared
+				 * memory ring, which must be there before any of them is
+				 * acknowledged.
+				 */
+				conn->shmRing = NULL;
+				if (gp_interconnect_local_shm && icShmPeerIsLocal(conn->cdbProc->listenerAddr))
+				{
+					conn->shmRing = icShmRingAttach(&conn->conn_info, Gp_interconnect_queue_depth, Gp_max_packet_size);
+					if (conn->shmRing == NULL)
+						ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+										errmsg("Interconnect error: could not set up the shared memory for the connection from seg%d",
+											   conn->cdbProc->contentid),
+										errhint("Set gp_interconnect_local_shm to off to use the sockets only.")));
+				}
+
 				connAddHash(&ic_control_info.connHtab, conn);
 			}
 		}
@@ -3476,6 +3911,7 @@ SetupUDPInterconnect_Internal(EState *estate)
 	snd_control_info.cwnd = 0;
 	snd_control_info.minCwnd = 0;
 	snd_control_info.ssthresh = 0;
+	snd_control_info.lastReduceTime = 0;
 
 	/* Initiate outgoing connections. */
 	if (mySlice->parentIndex != -1)
@@ -3486,6 +3922,7 @@ SetupUDPInterconnect_Internal(EState *estate)
 		ic_control_info.lastExpirationCheckTime = getCurrentTime();
 		ic_control_info.lastPacketSendTime = ic_control_info.lastExpirationCheckTime;
 		ic_control_info.lastDeadlockCheckTime = ic_control_info.lastExpirationCheckTime;
+		ic_control_info.lastStopCheckTime = ic_control_info.lastExpirationCheckTime;
 
 		sendingChunkTransportState = startOutgoingUDPConnections(estate->interconnect_context, mySlice, &expectedTotalOutgoing);
 		n = sendingChunkTransportState->numConns;
@@ -3739,8 +4176,7 @@ TeardownUDPInterconnect_Internal(ChunkTransportState *transportStates,
     		/* now it is safe to remove. */
     		pEntry = removeChunkTransportState(transportStates, mySlice->sliceIndex);
 
-    		if (pEntry->txfd >= 0)
-    			closesocket(pEntry->txfd);
+    		/* the socket is kept for the next statements */
     		pEntry->txfd = -1;
     		pEntry->txfd_family = 0;
 
@@ -3761,10 +4197,15 @@ TeardownUDPInterconnect_Internal(ChunkTransportState *transportStates,
 					icBufferListReturn(&conn->unackQueue, Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_CAPACITY ? false : true);
 
 					connDelHash(&ic_control_info.connHtab, conn);
+
+					icShmRingDetach(conn->shmRing);
+					conn->shmRing = NULL;
 				}
 				avgRtt = avgRtt / pEntry->numConns;
 				avgDev = avgDev / pEntry->numConns;
 
+				logMotionStatistics(pEntry, true);
+
 				/* free all send side buffers */
 				cleanSndBufferPool(&snd_buffer_pool);
     		}
@@ -3816,13 +4257,15 @@ TeardownUDPInterconnect_Internal(ChunkTransportState *transportStates,
 				 * below ... so we can safely discard data queued in both
 				 * directions
 				 */
+				logMotionStatistics(pEntry, false);
+
 				for (i = 0; i < pEntry->numConns; i++)
 				{
 					conn = pEntry->conns + i;
 					if (conn->cdbProc == NULL)
 						continue;
 
-					rx_buffer_pool.maxCount -= Gp_interconnect_queue_depth;
+					rx_buffer_pool.maxCount -= pEntry->streamWindow;
 
 					/* out of memory has occurred, break out */
 					if (!conn->pkt_q)
@@ -3842,6 +4285,9 @@ TeardownUDPInterconnect_Internal(ChunkTransportState *transportStates,
 					/* free up the packet queue */
 					pfree(conn->pkt_q);
 					conn->pkt_q = NULL;
+
+					icShmRingDetach(conn->shmRing);
+					conn->shmRing = NULL;
 				}
 				pfree(pEntry->conns);
 				pEntry->conns = NULL;
@@ -3883,7 +4329,8 @@ TeardownUDPInterconnect_Internal(ChunkTransportState *transportStates,
 			"UNACK_QUEUE_RING_SLOTS_NUM %d TIMER_SPAN %d DEFAULT_RTT %d "
 			"forceEOS %d, gp_interconnect_id %d ic_id_last_teardown %d "
 			"snd_buffer_pool.count %d snd_buffer_pool.maxCount %d snd_sock_bufsize %d recv_sock_bufsize %d "
-			"snd_pkt_count %d retransmits %d crc_errors %d"
+			"snd_pkt_count %d retransmits %d timeout_retransmits %d crc_errors %d"
+			" ecn_marked_pkt_num %d ecn_echo_num %d cwnd_reductions %d"
 			" recv_pkt_count %d recv_ack_num %d"
 			" recv_queue_size_avg %f"
 			" capacity_avg %f"
@@ -3896,7 +4343,8 @@ TeardownUDPInterconnect_Internal(ChunkTransportState *transportStates,
 			UNACK_QUEUE_RING_SLOTS_NUM, TIMER_SPAN, DEFAULT_RTT,
 			forceEOS, transportStates->sliceTable->ic_instance_id, rx_control_info.lastTornIcId,
 			snd_buffer_pool.count, snd_buffer_pool.maxCount, ic_control_info.socketSendBufferSize, ic_control_info.socketRecvBufferSize,
-			ic_statistics.sndPktNum, ic_statistics.retransmits, ic_statistics.crcErrors,
+			ic_statistics.sndPktNum, ic_statistics.retransmits, ic_statistics.timeoutRetransmits, ic_statistics.crcErrors,
+			ic_statistics.ecnMarkedPktNum, ic_statistics.ecnEchoNum, ic_statistics.cwndReductions,
 			ic_statistics.recvPktNum, ic_statistics.recvAckNum,
 			(double)((double)ic_statistics.totalRecvQueueSize)/((double)ic_statistics.recvQueueSizeCountingTime),
 			(double)((double)ic_statistics.totalCapacity)/((double)ic_statistics.capacityCountingTime),
@@ -3972,6 +4420,25 @@ prepareRxConnForRead(MotionConn *conn)
 
 	Assert(conn->pkt_q[conn->pkt_q_head] != NULL);
 	conn->pBuff = conn->pkt_q[conn->pkt_q_head];
+
+	/* only the header came through the socket, read the packet in place */
+	if (((icpkthdr *)conn->pBuff)->flags & UDPIC_FLAGS_SHM)
+	{
+		icpkthdr *hdr = (icpkthdr *)conn->pBuff;
+		icpkthdr *pkt = icShmRingSlot(conn->shmRing, hdr->seq);
+
+		if (pkt->seq != hdr->seq || pkt->len < sizeof(icpkthdr) || pkt->len > conn->shmRing->slotSize)
+		{
+			pthread_mutex_unlock(&ic_control_info.lock);
+			ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+							errmsg("Interconnect error: bad packet in the shared memory ring"),
+							errdetail("header seq %d, ring seq %d len %d, route %d",
+									  hdr->seq, pkt->seq, pkt->len, conn->route)));
+		}
+
+		conn->pBuff = (uint8 *)pkt;
+	}
+
 	conn->msgPos = conn->pBuff;
 	conn->msgSize = ((icpkthdr *)conn->pBuff)->len;
 	conn->recvBytes = conn->msgSize;
@@ -3991,6 +4458,7 @@ receiveChunksUDP(ChunkTransportState *pTransportStates, ChunkTransportStateEntry
 	bool		directed = false;
 	MotionConn *rxconn = NULL;
 	TupleChunkListItem	tcItem=NULL;
+	uint64		waitStart = 0;
 
 #ifdef AMS_VERBOSE_LOGGING
 	elog(DEBUG5, "receivechunksUDP: motnodeid %d", motNodeID);
@@ -4033,6 +4501,14 @@ receiveChunksUDP(ChunkTransportState *pTransportStates, ChunkTransportStateEntry
 		{
 			Assert(rxconn->pBuff);
 
+			if (waitStart != 0)
+			{
+				uint64		waited = getCurrentTime() - waitStart;
+
+				pEntry->stat_total_rx_wait_time += waited;
+				pgWaitUsage.interconnect_time += waited;
+			}
+
 			pthread_mutex_unlock(&ic_control_info.lock);
 
 			elog(DEBUG2, "got data with length %d", rxconn->recvBytes);
@@ -4048,6 +4524,9 @@ receiveChunksUDP(ChunkTransportState *pTransportStates, ChunkTransportStateEntry
 		retries++;
 
 		/* 2. Wait for data to become ready */
+		if (waitStart == 0)
+			waitStart = getCurrentTime();
+
 		if (waitOnCondition(MAIN_THREAD_COND_TIMEOUT, &ic_control_info.cond, &ic_control_info.lock))
 		{
 			continue; /* success ! */
@@ -4330,6 +4809,11 @@ aggregateStatistics(ChunkTransportStateEntry *pEntry)
 	pEntry->stat_count_resent = 0;
 	pEntry->stat_max_resent = 0;
 	pEntry->stat_count_dropped = 0;
+	pEntry->stat_count_pkts_sent = 0;
+	pEntry->stat_count_pkts_recvd = 0;
+	pEntry->stat_count_disordered = 0;
+	pEntry->stat_count_duplicated = 0;
+	pEntry->stat_total_fc_wait_time = 0;
 
 	int connNo;
 	for (connNo = 0; connNo < pEntry->numConns; connNo++)
@@ -4343,9 +4827,46 @@ aggregateStatistics(ChunkTransportStateEntry *pEntry)
 		pEntry->stat_count_resent += conn->stat_count_resent;
 		pEntry->stat_max_resent = Max(pEntry->stat_max_resent, conn->stat_max_resent);
 		pEntry->stat_count_dropped += conn->stat_count_dropped;
+		pEntry->stat_count_pkts_sent += conn->stat_count_pkts_sent;
+		pEntry->stat_count_pkts_recvd += conn->stat_count_pkts_recvd;
+		pEntry->stat_count_disordered += conn->stat_count_disordered;
+		pEntry->stat_count_duplicated += conn->stat_count_duplicated;
+		pEntry->stat_total_fc_wait_time += conn->stat_total_fc_wait_time;
 	}
 }
 
+/*
+ * logMotionStatistics
+ * 		Log the statistics of one motion node at teardown.
+ *
+ * The per-motion counterpart of the "Interconnect State" message, also
+ * logged at LOG level when gp_interconnect_log_stats is on.
+ */
+static void
+logMotionStatistics(ChunkTransportStateEntry *pEntry, bool isSender)
+{
+	uint64		avgAckTime = 0;
+
+	aggregateStatistics(pEntry);
+
+	if (pEntry->stat_count_acks > 0)
+		avgAckTime = pEntry->stat_total_ack_time / pEntry->stat_count_acks;
+
+	elog((gp_interconnect_log_stats ? LOG : DEBUG1), "Interconnect Motion State: "
+		 "motion %d %s conns %d "
+		 "pkts_sent " UINT64_FORMAT " pkts_recvd " UINT64_FORMAT
+		 " retransmits " UINT64_FORMAT " disordered " UINT64_FORMAT
+		 " duplicated " UINT64_FORMAT " dropped " UINT64_FORMAT
+		 " ack_time avg/max " UINT64_FORMAT "/" UINT64_FORMAT
+		 " fc_wait_time " UINT64_FORMAT " rx_wait_time " UINT64_FORMAT,
+		 pEntry->motNodeId, isSender ? "sender" : "receiver", pEntry->numConns,
+		 pEntry->stat_count_pkts_sent, pEntry->stat_count_pkts_recvd,
+		 pEntry->stat_count_resent, pEntry->stat_count_disordered,
+		 pEntry->stat_count_duplicated, pEntry->stat_count_dropped,
+		 avgAckTime, pEntry->stat_max_ack_time,
+		 pEntry->stat_total_fc_wait_time, pEntry->stat_total_rx_wait_time);
+}
+
 /*
  * logPkt
  * 		Log a packet.
@@ -4386,7 +4907,7 @@ handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now)
 
 	buf = icBufferListDelete(&ackConn->unackQueue, buf);
 
-	if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+	if (CWND_BASED_FC())
 	{
 		buf = icBufferListDelete(&unack_queue_ring.slots[buf->unackQueueRingSlot], buf);
 		unack_queue_ring.numOutStanding--;
@@ -4419,11 +4940,16 @@ handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now)
 	        	buf->conn->dev = newDEV;
 
 	        	/* adjust the conjestion control window. */
-	        	if (snd_control_info.cwnd < snd_control_info.ssthresh)
-	        		snd_control_info.cwnd += 1;
+	        	if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_RTT)
+	        		adjustCwndByDelay(buf->conn, ackTime, now);
 	        	else
-	        		snd_control_info.cwnd += 1/snd_control_info.cwnd;
-	        	snd_control_info.cwnd = Min(snd_control_info.cwnd, snd_buffer_pool.maxCount);
+	        	{
+	        		if (snd_control_info.cwnd < snd_control_info.ssthresh)
+	        			snd_control_info.cwnd += 1;
+	        		else
+	        			snd_control_info.cwnd += 1/snd_control_info.cwnd;
+	        		snd_control_info.cwnd = Min(snd_control_info.cwnd, snd_buffer_pool.maxCount);
+	        	}
 	        }
 		}
 	}
@@ -4571,6 +5097,14 @@ handleAcks(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntr
 			if (pkt->flags & UDPIC_FLAGS_NAK)
 				continue;
 
+			/* the receiver saw a CE mark, the path is congested */
+			if (pkt->flags & UDPIC_FLAGS_ECN)
+			{
+				ic_statistics.ecnEchoNum++;
+				if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_RTT)
+					reduceCwnd(ackConn, RTT_FC_MAX_DECREASE, now);
+			}
+
 			while (true)
 			{
 				if (pkt->flags & UDPIC_FLAGS_CAPACITY)
@@ -4738,6 +5272,30 @@ prepareXmit(MotionConn *conn)
 	}
 }
 
+/*
+ * xmitPacket
+ * 		The datagram to send for a packet.
+ *
+ * If the packet is in the shared memory ring of the connection, only its
+ * header is sent, flagged with UDPIC_FLAGS_SHM. It is built in *hdr.
+ */
+static inline icpkthdr *
+xmitPacket(MotionConn *conn, ICBuffer *buf, icpkthdr *hdr)
+{
+	if (conn->shmRing == NULL)
+		return buf->pkt;
+
+	memcpy(hdr, buf->pkt, sizeof(icpkthdr));
+	hdr->len = sizeof(icpkthdr);
+	hdr->flags |= UDPIC_FLAGS_SHM;
+	hdr->crc = 0;
+
+	if (gp_interconnect_full_crc)
+		addCRC(hdr);
+
+	return hdr;
+}
+
 /*
  * sendOnce
  * 		Send a packet.
@@ -4746,6 +5304,8 @@ static void
 sendOnce(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, ICBuffer *buf, MotionConn * conn)
 {
 	int32			n;
+	icpkthdr		hdr;
+	icpkthdr	   *pkt;
 
 #ifdef USE_ASSERT_CHECKING
 	if (testmode_inject_fault(gp_udpic_dropxmit_percent))
@@ -4757,8 +5317,10 @@ sendOnce(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry,
 	}
 #endif
 
+	pkt = xmitPacket(conn, buf, &hdr);
+
 xmit_retry:
-	n = sendto(pEntry->txfd, buf->pkt, buf->pkt->len, 0,
+	n = sendto(pEntry->txfd, pkt, pkt->len, 0,
 			   (struct sockaddr *)&conn->peer, conn->peer_len);
 	if (n < 0)
 	{
@@ -4787,11 +5349,11 @@ xmit_retry:
 		/* not reached */
 	}
 
-	if (n != buf->pkt->len)
+	if (n != pkt->len)
 	{
 		if (DEBUG1 >= log_min_messages)
 			write_log("Interconnect error writing an outgoing packet [seq %d]: short transmit (given %d sent %d) during sendto() call."
-				  "For Remote Connection: contentId=%d at %s", buf->pkt->seq, buf->pkt->len, n,
+				  "For Remote Connection: contentId=%d at %s", pkt->seq, pkt->len, n,
 				  conn->remoteContentId,
 				  conn->remoteHostAndPort);
 	#ifdef AMS_VERBOSE_LOGGING
@@ -4802,6 +5364,122 @@ xmit_retry:
 	return;
 }
 
+/*
+ * ioBatchSize
+ * 		Max number of packets sent or received by one system call.
+ *
+ * The faults of the test mode are injected into sendto() and recvfrom(),
+ * so the test mode sends and receives one packet at a time.
+ */
+static inline int
+ioBatchSize(void)
+{
+#ifdef USE_ASSERT_CHECKING
+	if (udp_testmode)
+		return 1;
+#endif
+
+#if defined(HAVE_SENDMMSG) && defined(HAVE_RECVMMSG)
+	return Min(Gp_interconnect_io_batch_size, UDPIC_MAX_IO_BATCH);
+#else
+	return 1;
+#endif
+}
+
+/*
+ * sendBatch
+ * 		Send the packets of a connection with as few sendmmsg() calls as
+ * 		possible.
+ *
+ * The errors are handled as sendOnce does: if the socket buffer is full,
+ * the packets not sent yet are left to the retransmission.
+ */
+static void
+sendBatch(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, ICBuffer **bufs, int nbufs, MotionConn *conn)
+{
+#ifdef HAVE_SENDMMSG
+	struct mmsghdr	msgs[UDPIC_MAX_IO_BATCH];
+	struct iovec	iovs[UDPIC_MAX_IO_BATCH];
+	icpkthdr		hdrs[UDPIC_MAX_IO_BATCH];
+	int				nmsgs = 0;
+	int				sent = 0;
+	int				i;
+
+	Assert(nbufs <= UDPIC_MAX_IO_BATCH);
+
+	if (nbufs == 1)
+	{
+		sendOnce(transportStates, pEntry, bufs[0], conn);
+		return;
+	}
+
+	MemSet(msgs, 0, sizeof(struct mmsghdr) * nbufs);
+	for (i = 0; i < nbufs; i++)
+	{
+		icpkthdr   *pkt = xmitPacket(conn, bufs[i], &hdrs[i]);
+
+		iovs[i].iov_base = pkt;
+		iovs[i].iov_len = pkt->len;
+		msgs[i].msg_hdr.msg_name = &conn->peer;
+		msgs[i].msg_hdr.msg_namelen = conn->peer_len;
+		msgs[i].msg_hdr.msg_iov = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+	nmsgs = nbufs;
+
+	while (sent < nmsgs)
+	{
+		int			n;
+
+		n = sendmmsg(pEntry->txfd, msgs + sent, nmsgs - sent, 0);
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				continue;
+
+			if (errno == EAGAIN) /* no space ? not an error. */
+				return;
+
+			/* the first packet is lost, it is retransmitted as well */
+			if (errno == EPERM)
+			{
+				ereport(LOG,
+						(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+						 errmsg("Interconnect error writing an outgoing packet: %m"),
+						 errdetail("error during sendmmsg() for Remote Connection: contentId=%d at %s",
+								   conn->remoteContentId, conn->remoteHostAndPort)));
+				sent++;
+				continue;
+			}
+
+			ereport(ERROR, (errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+							errmsg("Interconnect error writing an outgoing packet: %m"),
+							errdetail("error during sendmmsg() call (error:%d).\n"
+									  "For Remote Connection: contentId=%d at %s",
+									  errno, conn->remoteContentId,
+									  conn->remoteHostAndPort)));
+			/* not reached */
+		}
+
+		for (i = sent; i < sent + n; i++)
+		{
+			if (msgs[i].msg_len != iovs[i].iov_len && DEBUG1 >= log_min_messages)
+				write_log("Interconnect error writing an outgoing packet [seq %d]: short transmit (given %d sent %d) during sendmmsg() call."
+						  "For Remote Connection: contentId=%d at %s", bufs[i]->pkt->seq, (int) iovs[i].iov_len, msgs[i].msg_len,
+						  conn->remoteContentId,
+						  conn->remoteHostAndPort);
+		}
+
+		sent += n;
+	}
+#else
+	int			i;
+
+	for (i = 0; i < nbufs; i++)
+		sendOnce(transportStates, pEntry, bufs[i], conn);
+#endif
+}
+
 
 /*
  * handleStopMsgs
@@ -4911,11 +5589,15 @@ handleStopMsgs(ChunkTransportState *transportStates, ChunkTransportStateEntry *p
 static void
 sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn)
 {
+	ICBuffer   *batch[UDPIC_MAX_IO_BATCH];
+	int			nbatch = 0;
+	int			batchSize = ioBatchSize();
+
 	while (conn->capacity > 0 && icBufferListLength(&conn->sndQueue) > 0)
 	{
 		ICBuffer *buf = NULL;
 
-		if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS && (icBufferListLength(&conn->unackQueue) > 0
+		if (CWND_BASED_FC() && (icBufferListLength(&conn->unackQueue) > 0
 				&& unack_queue_ring.numSharedOutStanding >= (snd_control_info.cwnd - snd_control_info.minCwnd)))
 			break;
 
@@ -4923,9 +5605,21 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 		if (conn->state == mcsSetupOutgoingConnection && icBufferListLength(&conn->unackQueue) >= 1)
 			break;
 
+		uint64 now = getCurrentTime();
+
+		/*
+		 * The rtt method paces the packets, the ones held back are sent
+		 * when an ack comes or by checkExceptions().
+		 */
+		if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_RTT)
+		{
+			if (icBufferListLength(&conn->unackQueue) > 0 && now < conn->pacingNextTime)
+				break;
+			conn->pacingNextTime = Max(conn->pacingNextTime, now) + pacingInterval(conn);
+		}
+
 		buf = icBufferListPop(&conn->sndQueue);
 
-		uint64 now = getCurrentTime();
 		buf->sentTime = now;
 		buf->unackQueueRingSlot = -1;
 		buf->nRetry = 0;
@@ -4934,7 +5628,7 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 
 		icBufferListAppend(&conn->unackQueue, buf);
 
-		if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+		if (CWND_BASED_FC())
 		{
 			unack_queue_ring.numOutStanding++;
 			if (icBufferListLength(&conn->unackQueue) > 1)
@@ -4944,20 +5638,33 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 		}
 
 		/*
-		 * Note the place of sendOnce here.
+		 * Note the place of sendBatch here.
 		 * If we send before appending it to the unack queue and
 		 * putting it into unack queue ring, and there is a
-		 * network error occurred in the sendOnce function, error
+		 * network error occurred in the sendBatch function, error
 		 * message will be output. In the time of error message output,
 		 * interrupts is potentially checked, if there is a pending query cancel,
 		 * it will lead to a dangled buffer (memory leak).
+		 *
+		 * The buffers are sent by batches of ioBatchSize(), with one
+		 * system call per batch.
 		 */
 #ifdef TRANSFER_PROTOCOL_STATS
 		updateStats(TPE_DATA_PKT_SEND, conn, buf->pkt);
 #endif
 
-		sendOnce(transportStates, pEntry, buf, conn);
+		/* the retransmissions only send the header again */
+		if (conn->shmRing != NULL)
+			icShmRingPut(conn->shmRing, buf->pkt);
+
+		batch[nbatch++] = buf;
+		if (nbatch == batchSize)
+		{
+			sendBatch(transportStates, pEntry, batch, nbatch, conn);
+			nbatch = 0;
+		}
 		ic_statistics.sndPktNum++;
+		conn->stat_count_pkts_sent++;
 
 #ifdef AMS_VERBOSE_LOGGING
 		logPkt("SEND PKT DETAIL", buf->pkt);
@@ -4965,6 +5672,9 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 
 		buf->conn->sentSeq = buf->pkt->seq;
 	}
+
+	if (nbatch > 0)
+		sendBatch(transportStates, pEntry, batch, nbatch, conn);
 }
 
 /*
@@ -5102,7 +5812,7 @@ handleAckForDisorderPkt(ChunkTransportState *transportStates, ChunkTransportStat
 			/* this is a lost packet, retransmit */
 
 			buf->nRetry++;
-			if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+			if (CWND_BASED_FC())
 			{
 				buf = icBufferListDelete(&unack_queue_ring.slots[buf->unackQueueRingSlot], buf);
 				putIntoUnackQueueRing(&unack_queue_ring, buf,
@@ -5152,6 +5862,8 @@ handleAckForDisorderPkt(ChunkTransportState *transportStates, ChunkTransportStat
 		snd_control_info.ssthresh = Max(snd_control_info.cwnd/2, snd_control_info.minCwnd);
 		snd_control_info.cwnd = snd_control_info.ssthresh;
 	}
+	else if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_RTT)
+		reduceCwnd(conn, RTT_FC_MAX_DECREASE, now);
 #ifdef AMS_VERBOSE_LOGGING
 	write_log("After DISORDER: sndQ %d unackQ %d", icBufferListLength(&conn->sndQueue), icBufferListLength(&conn->unackQueue));
 	if (gp_log_interconnect >= GPVARS_VERBOSITY_DEBUG)
@@ -5271,6 +5983,7 @@ checkExpiration(ChunkTransportState *transportStates, ChunkTransportStateEntry *
 
 			retransmits++;
 			ic_statistics.retransmits++;
+			ic_statistics.timeoutRetransmits++;
 			curBuf->conn->stat_count_resent++;
 			curBuf->conn->stat_max_resent = Max(curBuf->conn->stat_max_resent, curBuf->conn->stat_count_resent);
 
@@ -5405,6 +6118,7 @@ static inline void
 updateRetransmitStatistics(MotionConn *conn)
 {
 	ic_statistics.retransmits++;
+	ic_statistics.timeoutRetransmits++;
 	conn->stat_count_resent++;
 	conn->stat_max_resent = Max(conn->stat_max_resent, conn->stat_count_resent);
 }
@@ -5449,9 +6163,14 @@ checkExceptions(ChunkTransportState *transportStates, ChunkTransportStateEntry *
 		checkExpirationCapacityFC(transportStates, pEntry, conn, timeout);
 	}
 
-	if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+	if (CWND_BASED_FC())
 	{
 		uint64 now = getCurrentTime();
+
+		/* send the packets held back by the pacing */
+		if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_RTT)
+			sendBuffers(transportStates, pEntry, conn);
+
 		if(now - ic_control_info.lastExpirationCheckTime > TIMER_CHECKING_PERIOD)
 		{
 			checkExpiration(transportStates, pEntry, conn, now);
@@ -5488,7 +6207,7 @@ computeTimeout(MotionConn *conn, int retry)
     if (buf->nRetry == 0 && retry == 0)
     	return 0;
 
-    if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+    if (CWND_BASED_FC())
         return TIMER_CHECKING_PERIOD;
 
     /* for capacity based flow control */
@@ -5518,6 +6237,7 @@ SendChunkUDP(MotionLayerState *mlStates,
 	int		retry = 0;
 	bool	doCheckExpiration = false;
 	bool	gotStops = false;
+	bool	waited = false;
 
 	Assert(conn->msgSize > 0);
 
@@ -5553,6 +6273,22 @@ SendChunkUDP(MotionLayerState *mlStates,
 	else
 		doCheckExpiration = (now - ic_control_info.lastExpirationCheckTime) > MAX_TIME_NO_TIMER_CHECKING ? true : false;
 
+	/*
+	 * A sender which does not run short of buffers only reads the acks when
+	 * checking the expiration, or never with the capacity based flow control.
+	 * Look for the stop messages of the receivers at least every
+	 * MAX_TIME_NO_STOP_CHECKING, so that a LIMIT satisfied above stops the
+	 * scans of this slice soon after: the stopped connections are closed by
+	 * handleStopMsgs() and the motion is squelched once none is left.
+	 */
+	if (!doCheckExpiration && (now - ic_control_info.lastStopCheckTime) > MAX_TIME_NO_STOP_CHECKING)
+	{
+		ic_control_info.lastStopCheckTime = now;
+		if (pollAcks(transportStates, pEntry->txfd, 0) &&
+			handleAcks(transportStates, pEntry))
+			gotStops = true;
+	}
+
 	/* get a new buffer */
 	conn->curBuff = NULL;
 	conn->pBuff = NULL;
@@ -5564,6 +6300,8 @@ SendChunkUDP(MotionLayerState *mlStates,
 	{
 		int timeout =  (doCheckExpiration ? 0 : computeTimeout(conn, retry));
 
+		waited = true;
+
 		if (pollAcks(transportStates, pEntry->txfd, timeout))
 		{
 			if (handleAcks(transportStates, pEntry))
@@ -5581,6 +6319,10 @@ SendChunkUDP(MotionLayerState *mlStates,
 		doCheckExpiration = false;
 	}
 
+	/* the time blocked on the flow control, for EXPLAIN ANALYZE */
+	if (waited)
+		conn->stat_total_fc_wait_time += getCurrentTime() - now;
+
 	conn->pBuff = (uint8 *) conn->curBuff->pkt;
 
 	if (gotStops)
@@ -5735,6 +6477,8 @@ SendEosUDP(MotionLayerState *mlStates,
 		}
 	}
 
+	aggregateStatistics(pEntry);
+
 	if (gp_log_interconnect >= GPVARS_VERBOSITY_DEBUG)
 		elog(DEBUG1, "SendEosUDP leaving, activeCount %d", activeCount);
 
@@ -6008,6 +6752,15 @@ handleDataPacket(MotionConn *conn, icpkthdr *pkt, struct sockaddr_storage *peer,
 		return false;
 	}
 
+	/* the sender and the receiver must agree on the shared memory ring */
+	if ((pkt->flags & UDPIC_FLAGS_SHM) && conn->shmRing == NULL)
+	{
+		if (DEBUG1 >= log_min_messages)
+			write_log("dropped shared memory packet on a connection without ring, seq %d srcpid %d dstpid %d",
+					  pkt->seq, pkt->srcPid, pkt->dstPid);
+		return false;
+	}
+
 	/*
 	 * when we're not doing a full-setup on every
 	 * statement, we've got to update the peer info --
@@ -6095,6 +6848,7 @@ handleDataPacket(MotionConn *conn, icpkthdr *pkt, struct sockaddr_storage *peer,
 	if (pkt->seq < conn->conn_info.seq)
 	{
 		ic_statistics.duplicatedPktNum++;
+		conn->stat_count_duplicated++;
 		if (DEBUG3 >= log_min_messages)
 			write_log("dropped ack ? ignored data packet w/ cmd %d conn->cmd %d node %d route %d seq %d expected %d flags 0x%x",
 					  pkt->icId, conn->conn_info.icId, pkt->motNodeId,
@@ -6140,6 +6894,7 @@ handleDataPacket(MotionConn *conn, icpkthdr *pkt, struct sockaddr_storage *peer,
 	if (conn->pkt_q[pos] == NULL)
 	{
 		conn->pkt_q[pos] = (uint8 *)pkt;
+		conn->stat_count_pkts_recvd++;
 		if (pos == conn->pkt_q_head)
 		{
 		#ifdef AMS_VERBOSE_LOGGING
@@ -6180,6 +6935,7 @@ handleDataPacket(MotionConn *conn, icpkthdr *pkt, struct sockaddr_storage *peer,
 
 			/* send an ack for out-of-order packet */
 			ic_statistics.disorderedPktNum++;
+			conn->stat_count_disordered++;
 			handleDisorderPacket(conn, pos, headSeq + conn->pkt_q_size, pkt);
 		}
 	}
@@ -6190,6 +6946,7 @@ handleDataPacket(MotionConn *conn, icpkthdr *pkt, struct sockaddr_storage *peer,
 
 		setAckSendParam(param, conn, UDPIC_FLAGS_DUPLICATE | conn->conn_info.flags, pkt->seq, conn->conn_info.seq - 1);
 		ic_statistics.duplicatedPktNum++;
+		conn->stat_count_duplicated++;
 		return false;
 	}
 
@@ -6220,9 +6977,26 @@ handleDataPacket(MotionConn *conn, icpkthdr *pkt, struct sockaddr_storage *peer,
 	return true;
 }
 
+/*
+ * rxThreadShutdown
+ * 		Has the main thread asked the rx-threads to exit ?
+ *
+ * The flag is left set until all the threads have seen it, the main thread
+ * clears it once it has joined them.
+ */
+static inline bool
+rxThreadShutdown(void)
+{
+	return *((volatile uint32 *) &ic_control_info.shutdown) != 0;
+}
+
 /*
  * rxThreadFunc
- * 		Main function of the receive background thread.
+ * 		Main function of a receive background thread, arg points to the
+ * 		socket it drains.
+ *
+ * All the threads hand the packets to the main thread the same way, under
+ * ic_control_info.lock, which protects the connections and the buffer pool.
  *
  * NOTE: This function MUST NOT contain elog or ereport statements.
  * elog is NOT thread-safe.  Developers should instead use something like:
@@ -6235,19 +7009,29 @@ handleDataPacket(MotionConn *conn, icpkthdr *pkt, struct sockaddr_storage *peer,
 static void *
 rxThreadFunc(void *arg)
 {
-	icpkthdr *pkt=NULL;
+	int		rxfd = *(int *) arg;
+	icpkthdr *pkts[UDPIC_MAX_IO_BATCH];
+	struct sockaddr_storage peers[UDPIC_MAX_IO_BATCH];
+	socklen_t peerlens[UDPIC_MAX_IO_BATCH];
+	int		lens[UDPIC_MAX_IO_BATCH];
+	bool	ce[UDPIC_MAX_IO_BATCH];
 	bool	skip_poll=false;
+	int		i;
 
 	gp_set_thread_sigmasks();
 
+	for (i = 0; i < UDPIC_MAX_IO_BATCH; i++)
+		pkts[i] = NULL;
+
 	for (;;)
 	{
 		struct pollfd nfd;
 		int		n;
+		int		nbufs;
 
 		/* check shutdown condition*/
 
-		if (compare_and_swap_32(&ic_control_info.shutdown, 1, 0))
+		if (rxThreadShutdown())
 		{
 			if (DEBUG1 >= log_min_messages)
 			{
@@ -6256,29 +7040,33 @@ rxThreadFunc(void *arg)
 			break;
 		}
 
-		/* Try to get a buffer */
-		if (pkt == NULL)
+		/* Try to get the buffers, the packets of a batch are received into */
+		n = ioBatchSize();
+		pthread_mutex_lock(&ic_control_info.lock);
+		for (nbufs = 0; nbufs < n; nbufs++)
 		{
-			pthread_mutex_lock(&ic_control_info.lock);
-			pkt = getRxBuffer(&rx_buffer_pool);
-			pthread_mutex_unlock(&ic_control_info.lock);
+			if (pkts[nbufs] == NULL)
+				pkts[nbufs] = getRxBuffer(&rx_buffer_pool);
+			if (pkts[nbufs] == NULL)
+				break;
+		}
+		pthread_mutex_unlock(&ic_control_info.lock);
 
-			if (pkt == NULL)
-			{
-				setRxThreadError(ENOMEM);
-				continue;
-			}
+		if (nbufs == 0)
+		{
+			setRxThreadError(ENOMEM);
+			continue;
 		}
 
 		if (!skip_poll)
 		{
 			/* Do we have inbound traffic to handle ?*/
-			nfd.fd = UDP_listenerFd;
+			nfd.fd = rxfd;
 			nfd.events = POLLIN;
 
 			n = poll(&nfd, 1, RX_THREAD_POLL_TIMEOUT);
 
-			if (compare_and_swap_32(&ic_control_info.shutdown, 1, 0))
+			if (rxThreadShutdown())
 			{
 				if (DEBUG1 >= log_min_messages)
 				{
@@ -6312,17 +7100,11 @@ rxThreadFunc(void *arg)
 			/* we've got something interesting to read */
 			/* handle incoming */
 			/* ready to read on our socket */
-			MotionConn *conn = NULL;
-			int read_count = 0;
+			int nrecv;
 
-			struct sockaddr_storage peer;
-			socklen_t peerlen;
+			nrecv = receivePackets(rxfd, pkts, nbufs, peers, peerlens, lens, ce);
 
-			peerlen = sizeof(peer);
-			read_count = recvfrom(UDP_listenerFd, (char *)pkt, Gp_max_packet_size, 0,
-								  (struct sockaddr *)&peer, &peerlen);
-
-			if (compare_and_swap_32(&ic_control_info.shutdown, 1, 0))
+			if (rxThreadShutdown())
 			{
 				if (DEBUG1 >= log_min_messages)
 				{
@@ -6331,10 +7113,7 @@ rxThreadFunc(void *arg)
 				break;
 			}
 
-			if (DEBUG5 >= log_min_messages)
-				write_log("received inbound len %d", read_count);
-
-			if (read_count < 0)
+			if (nrecv < 0)
 			{
 				skip_poll = false;
 
@@ -6353,115 +7132,268 @@ rxThreadFunc(void *arg)
 				continue;
 			}
 
-			if (read_count < sizeof(icpkthdr))
-			{
-				if (DEBUG1 >= log_min_messages)
-					write_log("Interconnect error: short conn receive (%d)", read_count);
-				continue;
-			}
-
-			/* when we get a "good" recvfrom() result, we can skip poll() until we get a bad one. */
-			skip_poll = true;
-
-			/* length must be >= 0 */
-			if (pkt->len < 0)
-			{
-				if (DEBUG3 >= log_min_messages)
-					write_log("received inbound with negative length");
-				continue;
-			}
-
-			if (pkt->len != read_count)
+			for (i = 0; i < nrecv; i++)
 			{
-				if (DEBUG3 >= log_min_messages)
-					write_log("received inbound packet [%d], short: read %d bytes, pkt->len %d", pkt->seq, read_count, pkt->len);
-				continue;
-			}
+				if (DEBUG5 >= log_min_messages)
+					write_log("received inbound len %d", lens[i]);
 
-			/*
-			 * check the CRC of the payload.
-			 */
-			if (gp_interconnect_full_crc)
-			{
-				if (!checkCRC(pkt))
+				if (lens[i] < sizeof(icpkthdr))
 				{
-					gp_atomic_add_32(&ic_statistics.crcErrors, 1);
-					if (DEBUG2 >= log_min_messages)
-						write_log("received network data error, dropping bad packet, user data unaffected.");
+					if (DEBUG1 >= log_min_messages)
+						write_log("Interconnect error: short conn receive (%d)", lens[i]);
 					continue;
 				}
+
+				/* when we get a "good" recvfrom() result, we can skip poll() until we get a bad one. */
+				skip_poll = true;
+
+				handleRxPacket(&pkts[i], lens[i], &peers[i], peerlens[i], ce[i]);
 			}
+		}
 
-			#ifdef AMS_VERBOSE_LOGGING
-				logPkt("GOT MESSAGE", pkt);
-			#endif
+		/* pthread_yield(); */
+	}
 
-			AckSendParam param;
-			memset(&param, 0, sizeof(AckSendParam));
+	/* Before retrun, we release the packets. */
+	pthread_mutex_lock(&ic_control_info.lock);
+	for (i = 0; i < UDPIC_MAX_IO_BATCH; i++)
+	{
+		if (pkts[i])
+		{
+			freeRxBuffer(&rx_buffer_pool, pkts[i]);
+			pkts[i] = NULL;
+		}
+	}
+	pthread_mutex_unlock(&ic_control_info.lock);
 
-			/*
-			 * Get the connection for the pkt.
-			 *
-			 * 	The connection hash table should be locked until
-			 * 	finishing the processing of the packet to avoid
-			 *  the connection addition/removal from the hash table
-			 *  during the mean time.
-			 */
+	/* nothing to return */
+	return NULL;
+}
+
+/*
+ * The control message buffer of a received packet, large enough for its
+ * IP TOS or IPv6 traffic class.
+ */
+typedef union ECNControlBuffer
+{
+	struct cmsghdr	align;
+	char			buf[CMSG_SPACE(sizeof(int))];
+} ECNControlBuffer;
 
-			pthread_mutex_lock(&ic_control_info.lock);
-			conn = findConnByHeader(&ic_control_info.connHtab, pkt);
+/*
+ * receivedCE
+ * 		Does the control message of a received packet carry the CE
+ * 		codepoint ?
+ *
+ * NOTE: This function MUST NOT contain elog or ereport statements.
+ */
+static bool
+receivedCE(struct msghdr *msg)
+{
+	struct cmsghdr *cmsg;
 
-			if (conn != NULL)
-			{
-				/* Handling a regular packet */
-				if (handleDataPacket(conn, pkt, &peer, &peerlen, &param))
-					pkt = NULL;
-				ic_statistics.recvPktNum++;
-			}
-			else
-			{
-				/*
-				 * There may have two kinds of Mismatched packets:
-				 *    a) Past packets from previous command after I was torn down
-				 *    b) Future packets from current command before my connections are built.
-				 *
-				 * The handling logic is to "Ack the past and Nak the future".
-				 */
-				if ((pkt->flags & UDPIC_FLAGS_RECEIVER_TO_SENDER) == 0)
-				{
-					if (DEBUG1 >= log_min_messages)
-						write_log("mismatched packet received, seq %d, srcpid %d, dstpid %d, icid %d, sid %d", pkt->seq, pkt->srcPid, pkt->dstPid, pkt->icId, pkt->sessionId);
+	for (cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL; cmsg = CMSG_NXTHDR(msg, cmsg))
+	{
+		int		tos = 0;
 
-				#ifdef AMS_VERBOSE_LOGGING
-					logPkt("Got a Mismatched Packet", pkt);
-				#endif
+		if (cmsg->cmsg_level == IPPROTO_IP &&
+			(cmsg->cmsg_type == IP_TOS
+#ifdef IP_RECVTOS
+			 || cmsg->cmsg_type == IP_RECVTOS
+#endif
+			))
+			tos = *(unsigned char *) CMSG_DATA(cmsg);
+#if defined(HAVE_IPV6) && defined(IPV6_TCLASS)
+		else if (cmsg->cmsg_level == IPPROTO_IPV6 && cmsg->cmsg_type == IPV6_TCLASS)
+			memcpy(&tos, CMSG_DATA(cmsg), sizeof(tos));
+#endif
+		else
+			continue;
 
-					if (handleMismatch(pkt, &peer, peerlen))
-						pkt = NULL;
-					ic_statistics.mismatchNum++;
-				}
-			}
-			pthread_mutex_unlock(&ic_control_info.lock);
+		return (tos & UDPIC_ECN_MASK) == UDPIC_ECN_CE;
+	}
+
+	return false;
+}
 
-			/* real ack sending is after lock release to decrease the lock holding time. */
-			if (param.msg.len != 0)
-				sendAckWithParam(&param);
+/*
+ * receivePackets
+ * 		Receive up to nbufs packets from a receive socket, with one
+ * 		recvmmsg() call where available.
+ *
+ * Returns the number of packets received, their lengths and senders are
+ * set in lens, peers and peerlens, and whether they were marked CE by the
+ * network in ce. Returns -1 and sets errno on error, as recvfrom() does.
+ *
+ * NOTE: This function MUST NOT contain elog or ereport statements.
+ */
+static int
+receivePackets(int fd, icpkthdr **pkts, int nbufs, struct sockaddr_storage *peers, socklen_t *peerlens, int *lens, bool *ce)
+{
+	ECNControlBuffer cbufs[UDPIC_MAX_IO_BATCH];
+	struct iovec	iovs[UDPIC_MAX_IO_BATCH];
+	struct msghdr	msg;
+	int				n;
+	int				i;
+
+	Assert(nbufs <= UDPIC_MAX_IO_BATCH);
+
+#if defined(HAVE_RECVMMSG)
+	if (nbufs > 1)
+	{
+		struct mmsghdr	msgs[UDPIC_MAX_IO_BATCH];
+
+		MemSet(msgs, 0, sizeof(struct mmsghdr) * nbufs);
+		for (i = 0; i < nbufs; i++)
+		{
+			iovs[i].iov_base = pkts[i];
+			iovs[i].iov_len = Gp_max_packet_size;
+			msgs[i].msg_hdr.msg_name = &peers[i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(peers[i]);
+			msgs[i].msg_hdr.msg_iov = &iovs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+			msgs[i].msg_hdr.msg_control = cbufs[i].buf;
+			msgs[i].msg_hdr.msg_controllen = sizeof(cbufs[i].buf);
 		}
 
-		/* pthread_yield(); */
+		/* the socket is non-blocking, only the packets already queued are returned */
+		n = recvmmsg(fd, msgs, nbufs, 0, NULL);
+		for (i = 0; i < n; i++)
+		{
+			lens[i] = msgs[i].msg_len;
+			peerlens[i] = msgs[i].msg_hdr.msg_namelen;
+			ce[i] = receivedCE(&msgs[i].msg_hdr);
+		}
+
+		return n;
+	}
+#endif
+
+	MemSet(&msg, 0, sizeof(msg));
+	iovs[0].iov_base = pkts[0];
+	iovs[0].iov_len = Gp_max_packet_size;
+	msg.msg_name = &peers[0];
+	msg.msg_namelen = sizeof(peers[0]);
+	msg.msg_iov = &iovs[0];
+	msg.msg_iovlen = 1;
+	msg.msg_control = cbufs[0].buf;
+	msg.msg_controllen = sizeof(cbufs[0].buf);
+
+	lens[0] = recvmsg(fd, &msg, 0);
+	if (lens[0] < 0)
+		return -1;
+
+	peerlens[0] = msg.msg_namelen;
+	ce[0] = receivedCE(&msg);
+
+	return 1;
+}
+
+/*
+ * handleRxPacket
+ * 		Handle a packet received by the rx thread.
+ *
+ * *ppkt is set to NULL if the packet is kept by its connection, the buffer
+ * can be reused otherwise.
+ *
+ * NOTE: This function MUST NOT contain elog or ereport statements.
+ */
+static void
+handleRxPacket(icpkthdr **ppkt, int read_count, struct sockaddr_storage *peer, socklen_t peerlen, bool ce)
+{
+	icpkthdr   *pkt = *ppkt;
+	MotionConn *conn = NULL;
+
+	/* length must be >= 0 */
+	if (pkt->len < 0)
+	{
+		if (DEBUG3 >= log_min_messages)
+			write_log("received inbound with negative length");
+		return;
 	}
 
-	/* Before retrun, we release the packet. */
-	if (pkt)
+	if (pkt->len != read_count)
 	{
-		pthread_mutex_lock(&ic_control_info.lock);
-		freeRxBuffer(&rx_buffer_pool, pkt);
-		pkt = NULL;
-		pthread_mutex_unlock(&ic_control_info.lock);
+		if (DEBUG3 >= log_min_messages)
+			write_log("received inbound packet [%d], short: read %d bytes, pkt->len %d", pkt->seq, read_count, pkt->len);
+		return;
 	}
 
-	/* nothing to return */
-	return NULL;
+	/*
+	 * check the CRC of the payload.
+	 */
+	if (gp_interconnect_full_crc)
+	{
+		if (!checkCRC(pkt))
+		{
+			gp_atomic_add_32(&ic_statistics.crcErrors, 1);
+			if (DEBUG2 >= log_min_messages)
+				write_log("received network data error, dropping bad packet, user data unaffected.");
+			return;
+		}
+	}
+
+	#ifdef AMS_VERBOSE_LOGGING
+		logPkt("GOT MESSAGE", pkt);
+	#endif
+
+	AckSendParam param;
+	memset(&param, 0, sizeof(AckSendParam));
+
+	/*
+	 * Get the connection for the pkt.
+	 *
+	 * 	The connection hash table should be locked until
+	 * 	finishing the processing of the packet to avoid
+	 *  the connection addition/removal from the hash table
+	 *  during the mean time.
+	 */
+
+	pthread_mutex_lock(&ic_control_info.lock);
+	conn = findConnByHeader(&ic_control_info.connHtab, pkt);
+
+	if (conn != NULL)
+	{
+		/* the CE mark is echoed by the next ack to the sender */
+		if (ce)
+		{
+			conn->ecnEcho = true;
+			ic_statistics.ecnMarkedPktNum++;
+		}
+
+		/* Handling a regular packet */
+		if (handleDataPacket(conn, pkt, peer, &peerlen, &param))
+			*ppkt = NULL;
+		ic_statistics.recvPktNum++;
+	}
+	else
+	{
+		/*
+		 * There may have two kinds of Mismatched packets:
+		 *    a) Past packets from previous command after I was torn down
+		 *    b) Future packets from current command before my connections are built.
+		 *
+		 * The handling logic is to "Ack the past and Nak the future".
+		 */
+		if ((pkt->flags & UDPIC_FLAGS_RECEIVER_TO_SENDER) == 0)
+		{
+			if (DEBUG1 >= log_min_messages)
+				write_log("mismatched packet received, seq %d, srcpid %d, dstpid %d, icid %d, sid %d", pkt->seq, pkt->srcPid, pkt->dstPid, pkt->icId, pkt->sessionId);
+
+		#ifdef AMS_VERBOSE_LOGGING
+			logPkt("Got a Mismatched Packet", pkt);
+		#endif
+
+			if (handleMismatch(pkt, peer, peerlen))
+				*ppkt = NULL;
+			ic_statistics.mismatchNum++;
+		}
+	}
+	pthread_mutex_unlock(&ic_control_info.lock);
+
+	/* real ack sending is after lock release to decrease the lock holding time. */
+	if (param.msg.len != 0)
+		sendAckWithParam(&param);
 }
 
 /*
@@ -6942,8 +7874,9 @@ WaitInterconnectQuitUDP(void)
 
 	if (ic_control_info.threadCreated)
 	{
+		/* the other threads see the flag within RX_THREAD_POLL_TIMEOUT */
 		SendDummyPacket();
-		pthread_join(ic_control_info.threadHandle, NULL);
+		joinRxThreads();
 	}
 	ic_control_info.threadCreated = false;
 }
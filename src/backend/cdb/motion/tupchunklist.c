@@ -31,6 +31,7 @@
 #include "cdb/cdbmotion.h"
 #include "cdb/tupser.h"
 #include "lib/stringinfo.h"
+#include "utils/memutils.h"
 
 
 /* Appends a TupleChunkListItem to the end of a TupleChunkList.  The list's
@@ -59,44 +60,43 @@ appendChunkToTCList(TupleChunkList tcList, TupleChunkListItem tcItem)
 	}
 }
 
-static int gp_interconnect_chunk_cache=10;
+/* The number of items in a block of the chunk-list-item slab. */
+#define TC_ITEM_SLAB_BLOCK_ITEMS 8
 
+/*
+ * Returns a full-size item.  The slab is created in the current memory
+ * context on first use, and is deleted by destroyChunkCache().
+ */
 TupleChunkListItem
 getChunkFromCache(TupleChunkListCache *cache)
 {
 	TupleChunkListItem item;
 
-	if (cache->items != NULL)
-	{
-		item = cache->items;
-		cache->items = item->p_next;
-		cache->len = cache->len - 1;
-	}
-	else
+	if (cache->cxt == NULL)
 	{
-		item = (TupleChunkListItem)
-			palloc(sizeof(TupleChunkListItemData) + Gp_max_tuple_chunk_size);
+		cache->cxt = SlabContextCreate(CurrentMemoryContext,
+									   "TupleChunkListCache",
+									   sizeof(TupleChunkListItemData) + Gp_max_tuple_chunk_size,
+									   TC_ITEM_SLAB_BLOCK_ITEMS);
 	}
 
+	item = (TupleChunkListItem) MemoryContextAlloc(cache->cxt,
+			sizeof(TupleChunkListItemData) + Gp_max_tuple_chunk_size);
+
 	MemSetAligned(item, 0, sizeof(TupleChunkListItemData) + 4);
 
 	return item;
 }
 
-static void
-putChunkToCache(TupleChunkListCache *cache, TupleChunkListItem item)
+/* Frees the slab of a cache, along with any item still allocated from it */
+void
+destroyChunkCache(TupleChunkListCache *cache)
 {
-	if (cache->len > gp_interconnect_chunk_cache)
-	{
-		pfree(item);
-	}
-	else
+	if (cache->cxt != NULL)
 	{
-		item->p_next = cache->items;
-		cache->items = item;
-		cache->len = cache->len + 1;
+		MemoryContextDelete(cache->cxt);
+		cache->cxt = NULL;
 	}
-	return;
 }
 
 void
@@ -112,10 +112,8 @@ clearTCList(TupleChunkListCache *cache, TupleChunkList tcList)
 	{
 		tcNext = tcItem->p_next;
 
-		if (cache != NULL)
-			putChunkToCache(cache, tcItem);
-		else
-			pfree(tcItem);
+		/* an item of the cache goes back on the freelist of its slab */
+		pfree(tcItem);
 
 		tcItem = tcNext;
 	}
@@ -153,8 +153,7 @@ InitSerTupInfo(TupleDesc tupdesc, SerTupInfo * pSerInfo)
 	/* Store the tuple-descriptor so we can use it later. */
 	pSerInfo->tupdesc = tupdesc;
 
-	pSerInfo->chunkCache.len = 0;
-	pSerInfo->chunkCache.items = NULL;
+	pSerInfo->chunkCache.cxt = NULL;
 
 	/*
 	 * If we have some attributes, go ahead and prepare the information for
@@ -293,14 +292,7 @@ CleanupSerTupInfo(SerTupInfo * pSerInfo)
 
 	pSerInfo->tupdesc = NULL;
 
-	while (pSerInfo->chunkCache.items != NULL)
-	{
-		TupleChunkListItem item;
-
-		item = pSerInfo->chunkCache.items;
-		pSerInfo->chunkCache.items = item->p_next;
-		pfree(item);
-	}
+	destroyChunkCache(&pSerInfo->chunkCache);
 }
 
 /*
@@ -1055,6 +1047,7 @@ CvtChunksToHeapTup(TupleChunkList tcList, SerTupInfo * pSerInfo)
 	int			i;
 	HeapTuple	htup;
 	TupleChunkType tcType;
+	bool		inplace;
 
 	AssertArg(tcList != NULL);
 	AssertArg(tcList->p_first != NULL);
@@ -1087,8 +1080,12 @@ CvtChunksToHeapTup(TupleChunkList tcList, SerTupInfo * pSerInfo)
 	 *
 	 * We know roughly how much space we'll need, allocate all in one go.
 	 *
+	 * A tuple of one chunk is read in place, from the receive buffer: the
+	 * StringInfo only points to the chunk data.
 	 */
-	initStringInfoOfSize(&serData, tcList->num_chunks * tcList->max_chunk_length);
+	inplace = (tcList->num_chunks == 1);
+	if (!inplace)
+		initStringInfoOfSize(&serData, tcList->num_chunks * tcList->max_chunk_length);
 
 	i = 0;
 	do
@@ -1142,9 +1139,17 @@ CvtChunksToHeapTup(TupleChunkList tcList, SerTupInfo * pSerInfo)
 		}
 
 		/* Copy this chunk into the tuple data.  Don't include the header! */
-		appendBinaryStringInfo(&serData,
-							   (const char *) GetChunkDataPtr(tcItem) + TUPLE_CHUNK_HEADER_SIZE,
-							   tcItem->chunk_length - TUPLE_CHUNK_HEADER_SIZE);
+		if (inplace)
+		{
+			serData.data = (char *) GetChunkDataPtr(tcItem) + TUPLE_CHUNK_HEADER_SIZE;
+			serData.len = tcItem->chunk_length - TUPLE_CHUNK_HEADER_SIZE;
+			serData.maxlen = serData.len;
+			serData.cursor = 0;
+		}
+		else
+			appendBinaryStringInfo(&serData,
+								   (const char *) GetChunkDataPtr(tcItem) + TUPLE_CHUNK_HEADER_SIZE,
+								   tcItem->chunk_length - TUPLE_CHUNK_HEADER_SIZE);
 
 		/* Go to the next chunk. */
 		tcItem = tcItem->p_next;
@@ -1152,8 +1157,12 @@ CvtChunksToHeapTup(TupleChunkList tcList, SerTupInfo * pSerInfo)
 	}
 	while (tcItem != NULL);
 
-	/* we've finished with the TCList, free it now. */
-	clearTCList(NULL, tcList);
+	/*
+	 * we've finished with the TCList, free it now. The chunk read in place
+	 * may be in the list item, it is freed once the tuple is built.
+	 */
+	if (!inplace)
+		clearTCList(NULL, tcList);
 
 	{
 		TupSerHeader *tshp;
@@ -1185,7 +1194,10 @@ CvtChunksToHeapTup(TupleChunkList tcList, SerTupInfo * pSerInfo)
 				htup = DeserializeTuple(pSerInfo, &serData);
 
 				/* Free up memory we used. */
-				pfree(serData.data);
+				if (inplace)
+					clearTCList(NULL, tcList);
+				else
+					pfree(serData.data);
 				return htup;
 			}
 
@@ -1250,7 +1262,10 @@ CvtChunksToHeapTup(TupleChunkList tcList, SerTupInfo * pSerInfo)
 	}
 
 	/* Free up memory we used. */
-	pfree(serData.data);
+	if (inplace)
+		clearTCList(NULL, tcList);
+	else
+		pfree(serData.data);
 
 	return htup;
 }
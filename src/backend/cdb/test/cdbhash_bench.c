@@ -0,0 +1,229 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include "cmockery.h"
+#include "bench.h"
+
+#include "../cdbhash.c"
+
+/*
+ * Micro-benchmarks of the hashing done for every row that is redistributed
+ * or inserted into a hash distributed table.  Every key is synthetic and
+ * generated in memory, so only the hashing and the reduction to a bucket
+ * are measured.
+ */
+
+#define BENCH_NKEYS 4096		/* power of 2, keys are picked by masking */
+#define BENCH_BATCH 1024		/* rows per call of the batched functions */
+
+typedef struct HashBenchState
+{
+	CdbHash		hash;
+	int64		int8keys[BENCH_NKEYS];
+	Datum		int4datums[BENCH_NKEYS];
+	Datum		int8datums[BENCH_NKEYS];
+	NameData	namekeys[BENCH_NKEYS];
+	char		bytes[1024];
+	size_t		nbytes;
+} HashBenchState;
+
+/* Like makeCdbHash(), without the palloc and the DEBUG4 message. */
+static void
+bench_init_hash(CdbHash *h, int numsegs)
+{
+	h->hash = 0;
+	h->numsegs = numsegs;
+	h->hashalg = HASH_FNV_1;
+	h->hashfn = &fnv1_32_buf;
+	h->reducealg = ispowof2(numsegs) ? REDUCE_BITMASK : REDUCE_LAZYMOD;
+	h->rrindex = 0;
+}
+
+/* xorshift64, for reproducible keys without calling out of the SUT */
+static uint64
+bench_next_random(uint64 *seed)
+{
+	*seed ^= *seed << 13;
+	*seed ^= *seed >> 7;
+	*seed ^= *seed << 17;
+	return *seed;
+}
+
+static HashBenchState *
+bench_make_state(int numsegs, size_t nbytes)
+{
+	HashBenchState *state = malloc(sizeof(HashBenchState));
+	uint64		seed = 0x9e3779b97f4a7c15ULL;
+	int			i;
+
+	bench_init_hash(&state->hash, numsegs);
+	for (i = 0; i < BENCH_NKEYS; i++)
+	{
+		state->int8keys[i] = (int64) bench_next_random(&seed);
+		state->int4datums[i] = Int32GetDatum((int32) i);
+		state->int8datums[i] = Int64GetDatum(state->int8keys[i]);
+		snprintf(NameStr(state->namekeys[i]), NAMEDATALEN, "customer_%d", i);
+	}
+	for (i = 0; i < sizeof(state->bytes); i++)
+		state->bytes[i] = 'a' + bench_next_random(&seed) % 26;
+	state->nbytes = nbytes;
+
+	return state;
+}
+
+void
+bench__cdbhash__int4(uint64_t iterations, void *arg)
+{
+	HashBenchState *state = arg;
+	uint64_t	i;
+
+	for (i = 0; i < iterations; i++)
+	{
+		cdbhashinit(&state->hash);
+		cdbhash(&state->hash, Int32GetDatum((int32) i), INT4OID);
+		benchmark_keep(cdbhashreduce(&state->hash));
+	}
+}
+
+void
+bench__cdbhash__int8(uint64_t iterations, void *arg)
+{
+	HashBenchState *state = arg;
+	uint64_t	i;
+
+	for (i = 0; i < iterations; i++)
+	{
+		cdbhashinit(&state->hash);
+		cdbhash(&state->hash, Int64GetDatum(state->int8keys[i & (BENCH_NKEYS - 1)]), INT8OID);
+		benchmark_keep(cdbhashreduce(&state->hash));
+	}
+}
+
+void
+bench__cdbhash__int4_int8(uint64_t iterations, void *arg)
+{
+	HashBenchState *state = arg;
+	uint64_t	i;
+
+	for (i = 0; i < iterations; i++)
+	{
+		cdbhashinit(&state->hash);
+		cdbhash(&state->hash, Int32GetDatum((int32) i), INT4OID);
+		cdbhash(&state->hash, Int64GetDatum(state->int8keys[i & (BENCH_NKEYS - 1)]), INT8OID);
+		benchmark_keep(cdbhashreduce(&state->hash));
+	}
+}
+
+void
+bench__cdbhash__name(uint64_t iterations, void *arg)
+{
+	HashBenchState *state = arg;
+	uint64_t	i;
+
+	for (i = 0; i < iterations; i++)
+	{
+		cdbhashinit(&state->hash);
+		cdbhash(&state->hash, NameGetDatum(&state->namekeys[i & (BENCH_NKEYS - 1)]), NAMEOID);
+		benchmark_keep(cdbhashreduce(&state->hash));
+	}
+}
+
+/*
+ * The batched functions, one iteration per row as above.  The batches start
+ * at multiples of BENCH_BATCH, so they never run past the end of the keys.
+ */
+void
+bench__cdbhash_batch__int4_int8(uint64_t iterations, void *arg)
+{
+	HashBenchState *state = arg;
+	uint32		hashes[BENCH_BATCH];
+	unsigned int segs[BENCH_BATCH];
+	uint64_t	i;
+
+	for (i = 0; i < iterations; i += BENCH_BATCH)
+	{
+		int			nrows = Min(BENCH_BATCH, iterations - i);
+		int			first = i & (BENCH_NKEYS - 1);
+
+		cdbhashinit_batch(&state->hash, hashes, nrows);
+		cdbhash_batch(&state->hash, hashes, nrows,
+					  &state->int4datums[first], NULL, INT4OID);
+		cdbhash_batch(&state->hash, hashes, nrows,
+					  &state->int8datums[first], NULL, INT8OID);
+		cdbhashreduce_batch(&state->hash, hashes, nrows, segs);
+		benchmark_keep(segs[nrows - 1]);
+	}
+}
+
+void
+bench__cdbhash_batch__int8(uint64_t iterations, void *arg)
+{
+	HashBenchState *state = arg;
+	uint32		hashes[BENCH_BATCH];
+	unsigned int segs[BENCH_BATCH];
+	uint64_t	i;
+
+	for (i = 0; i < iterations; i += BENCH_BATCH)
+	{
+		int			nrows = Min(BENCH_BATCH, iterations - i);
+		int			first = i & (BENCH_NKEYS - 1);
+
+		cdbhashinit_batch(&state->hash, hashes, nrows);
+		cdbhash_batch(&state->hash, hashes, nrows,
+					  &state->int8datums[first], NULL, INT8OID);
+		cdbhashreduce_batch(&state->hash, hashes, nrows, segs);
+		benchmark_keep(segs[nrows - 1]);
+	}
+}
+
+/* The hashing of text, varchar and bytea keys, without the detoasting */
+void
+bench__fnv1_32_buf(uint64_t iterations, void *arg)
+{
+	HashBenchState *state = arg;
+	uint64_t	i;
+
+	for (i = 0; i < iterations; i++)
+		benchmark_keep(fnv1_32_buf(state->bytes, state->nbytes, FNV1_32_INIT));
+}
+
+int
+main(int argc, char* argv[])
+{
+	benchmark_parse_arguments(argc, argv);
+
+	const Benchmark benchmarks[] = {
+		benchmark(bench__cdbhash__int4, bench_make_state(16, 0)),
+		/* numsegs that's not a power of 2 reduces with a modulo */
+		named_benchmark("bench__cdbhash__int4_lazymod", bench__cdbhash__int4,
+						bench_make_state(12, 0)),
+		benchmark(bench__cdbhash__int8, bench_make_state(16, 0)),
+		benchmark(bench__cdbhash__int4_int8, bench_make_state(16, 0)),
+		benchmark(bench__cdbhash__name, bench_make_state(16, 0)),
+		benchmark(bench__cdbhash_batch__int8, bench_make_state(16, 0)),
+		benchmark(bench__cdbhash_batch__int4_int8, bench_make_state(16, 0)),
+		named_benchmark("bench__fnv1_32_buf_16", bench__fnv1_32_buf,
+						bench_make_state(16, 16)),
+		named_benchmark("bench__fnv1_32_buf_256", bench__fnv1_32_buf,
+						bench_make_state(16, 256)),
+	};
+	return run_benchmarks(benchmarks);
+}
@@ -0,0 +1,269 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include "cmockery.h"
+
+#include "c.h"
+#include "../cdbhash.c"
+
+#define NROWS 100
+
+static void
+init_hash(CdbHash *h, int numsegs)
+{
+	h->hash = 0;
+	h->numsegs = numsegs;
+	h->hashalg = HASH_FNV_1;
+	h->hashfn = &fnv1_32_buf;
+	h->reducealg = ispowof2(numsegs) ? REDUCE_BITMASK : REDUCE_LAZYMOD;
+	h->rrindex = 0;
+}
+
+/* xorshift64, so that every run hashes the same values */
+static uint64
+next_random(uint64 *seed)
+{
+	*seed ^= *seed << 13;
+	*seed ^= *seed >> 7;
+	*seed ^= *seed << 17;
+	return *seed;
+}
+
+/*
+ * Hash a column of values with cdbhash_batch() and with cdbhash(), every
+ * fifth row being null, and check that both give the same hashes.
+ */
+static void
+check_batch_matches(Oid typid, Datum *values)
+{
+	CdbHash		h;
+	uint32		hashes[NROWS];
+	bool		isnull[NROWS];
+	int			i;
+
+	init_hash(&h, 16);
+	for (i = 0; i < NROWS; i++)
+		isnull[i] = (i % 5 == 4);
+
+	cdbhashinit_batch(&h, hashes, NROWS);
+	cdbhash_batch(&h, hashes, NROWS, values, isnull, typid);
+
+	for (i = 0; i < NROWS; i++)
+	{
+		cdbhashinit(&h);
+		if (isnull[i])
+			cdbhashnull(&h);
+		else
+			cdbhash(&h, values[i], typid);
+		assert_int_equal(hashes[i], h.hash);
+	}
+
+	/* and without a null array */
+	cdbhashinit_batch(&h, hashes, NROWS);
+	cdbhash_batch(&h, hashes, NROWS, values, NULL, typid);
+
+	for (i = 0; i < NROWS; i++)
+	{
+		cdbhashinit(&h);
+		cdbhash(&h, values[i], typid);
+		assert_int_equal(hashes[i], h.hash);
+	}
+}
+
+void
+test__cdbhash_batch__IntegerTypesMatchCdbhash(void **state)
+{
+	Datum		values[NROWS];
+	uint64		seed = 0x9e3779b97f4a7c15ULL;
+	int			i;
+
+	for (i = 0; i < NROWS; i++)
+		values[i] = Int16GetDatum((int16) next_random(&seed));
+	check_batch_matches(INT2OID, values);
+
+	for (i = 0; i < NROWS; i++)
+		values[i] = Int32GetDatum((int32) next_random(&seed));
+	check_batch_matches(INT4OID, values);
+
+	for (i = 0; i < NROWS; i++)
+		values[i] = Int64GetDatum((int64) next_random(&seed));
+	check_batch_matches(INT8OID, values);
+
+	for (i = 0; i < NROWS; i++)
+		values[i] = ObjectIdGetDatum((Oid) next_random(&seed));
+	check_batch_matches(OIDOID, values);
+	check_batch_matches(REGCLASSOID, values);
+}
+
+void
+test__cdbhash_batch__DateTimeTypesMatchCdbhash(void **state)
+{
+	Datum		values[NROWS];
+	uint64		seed = 0x2545f4914f6cdd1dULL;
+	int			i;
+
+	for (i = 0; i < NROWS; i++)
+		values[i] = DateADTGetDatum((DateADT) next_random(&seed));
+	check_batch_matches(DATEOID, values);
+
+#ifdef HAVE_INT64_TIMESTAMP
+	for (i = 0; i < NROWS; i++)
+		values[i] = TimestampGetDatum((Timestamp) next_random(&seed));
+	check_batch_matches(TIMESTAMPOID, values);
+	check_batch_matches(TIMESTAMPTZOID, values);
+	check_batch_matches(TIMEOID, values);
+#endif
+}
+
+void
+test__cdbhash_batch__ByteTypesMatchCdbhash(void **state)
+{
+	Datum		values[NROWS];
+	uint64		seed = 0x853c49e6748fea9bULL;
+	int			i;
+
+	for (i = 0; i < NROWS; i++)
+		values[i] = BoolGetDatum(next_random(&seed) & 1);
+	check_batch_matches(BOOLOID, values);
+
+	for (i = 0; i < NROWS; i++)
+		values[i] = CharGetDatum((char) next_random(&seed));
+	check_batch_matches(CHAROID, values);
+}
+
+/* a type without a kernel goes through hashDatum() */
+void
+test__cdbhash_batch__NameMatchesCdbhash(void **state)
+{
+	NameData	names[NROWS];
+	Datum		values[NROWS];
+	int			i;
+
+	for (i = 0; i < NROWS; i++)
+	{
+		snprintf(NameStr(names[i]), NAMEDATALEN, "customer_%d", i);
+		values[i] = NameGetDatum(&names[i]);
+	}
+	check_batch_matches(NAMEOID, values);
+}
+
+/* the hash of a row carries over from one key column to the next */
+void
+test__cdbhash_batch__MultipleColumnsMatchCdbhash(void **state)
+{
+	CdbHash		h;
+	uint32		hashes[NROWS];
+	Datum		int4values[NROWS];
+	Datum		int8values[NROWS];
+	bool		isnull[NROWS];
+	unsigned int segs[NROWS];
+	uint64		seed = 0xda3e39cb94b95bdbULL;
+	int			i;
+
+	init_hash(&h, 16);
+	for (i = 0; i < NROWS; i++)
+	{
+		int4values[i] = Int32GetDatum((int32) next_random(&seed));
+		int8values[i] = Int64GetDatum((int64) next_random(&seed));
+		isnull[i] = (i % 7 == 0);
+	}
+
+	cdbhashinit_batch(&h, hashes, NROWS);
+	cdbhash_batch(&h, hashes, NROWS, int4values, NULL, INT4OID);
+	cdbhash_batch(&h, hashes, NROWS, int8values, isnull, INT8OID);
+	cdbhashreduce_batch(&h, hashes, NROWS, segs);
+
+	for (i = 0; i < NROWS; i++)
+	{
+		cdbhashinit(&h);
+		cdbhash(&h, int4values[i], INT4OID);
+		if (isnull[i])
+			cdbhashnull(&h);
+		else
+			cdbhash(&h, int8values[i], INT8OID);
+		assert_int_equal(hashes[i], h.hash);
+		assert_int_equal(segs[i], cdbhashreduce(&h));
+	}
+}
+
+void
+test__cdbhashreduce_batch__LazyModMatchesCdbhashreduce(void **state)
+{
+	CdbHash		h;
+	uint32		hashes[NROWS];
+	unsigned int segs[NROWS];
+	uint64		seed = 0x5851f42d4c957f2dULL;
+	int			i;
+
+	init_hash(&h, 12);
+	assert_int_equal(h.reducealg, REDUCE_LAZYMOD);
+	for (i = 0; i < NROWS; i++)
+		hashes[i] = (uint32) next_random(&seed);
+
+	cdbhashreduce_batch(&h, hashes, NROWS, segs);
+
+	for (i = 0; i < NROWS; i++)
+	{
+		h.hash = hashes[i];
+		assert_int_equal(segs[i], cdbhashreduce(&h));
+	}
+}
+
+void
+test__cdbhashnokey_batch__MatchesCdbhashnokey(void **state)
+{
+	CdbHash		h;
+	uint32		hashes[NROWS];
+	int			i;
+
+	init_hash(&h, 16);
+	h.rrindex = 0xfffffff0;		/* wraps around within the batch */
+
+	cdbhashinit_batch(&h, hashes, NROWS);
+	cdbhashnokey_batch(&h, hashes, NROWS);
+	assert_int_equal(h.rrindex, (uint32) (0xfffffff0 + NROWS));
+
+	h.rrindex = 0xfffffff0;
+	for (i = 0; i < NROWS; i++)
+	{
+		cdbhashinit(&h);
+		cdbhashnokey(&h);
+		assert_int_equal(hashes[i], h.hash);
+	}
+}
+
+int
+main(int argc, char* argv[])
+{
+	cmockery_parse_arguments(argc, argv);
+
+	const UnitTest tests[] = {
+		unit_test(test__cdbhash_batch__IntegerTypesMatchCdbhash),
+		unit_test(test__cdbhash_batch__DateTimeTypesMatchCdbhash),
+		unit_test(test__cdbhash_batch__ByteTypesMatchCdbhash),
+		unit_test(test__cdbhash_batch__NameMatchesCdbhash),
+		unit_test(test__cdbhash_batch__MultipleColumnsMatchCdbhash),
+		unit_test(test__cdbhashreduce_batch__LazyModMatchesCdbhashreduce),
+		unit_test(test__cdbhashnokey_batch__MatchesCdbhashnokey),
+	};
+	return run_tests(tests);
+}
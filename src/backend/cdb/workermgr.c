@@ -71,6 +71,8 @@ static void	workermgr_init_thread_iterator(WorkerMgrState *state, WorkerMgrThrea
 static WorkerMgrThread *workermgr_get_thread_iterator(WorkerMgrState *state, WorkerMgrThreadIterator *iterator);
 static void *workermgr_thread_func(void *arg);
 static void workermgr_join(WorkerMgrState *state);
+static bool workermgr_start_threads(WorkerMgrState *state, List *tasks,
+									WorkerMgrTaskCallback func, int first);
 
 
 /*
@@ -104,17 +106,76 @@ bool
 workermgr_submit_job(WorkerMgrState *state,
 					List *tasks,
 					WorkerMgrTaskCallback func)
+{
+	return workermgr_start_threads(state, tasks, func, 0);
+}
+
+/*
+ * workermgr_run_job
+ *	Run the job and wait for it to finish. The first task runs on the
+ *	calling thread, which would only wait for the threads otherwise, so a
+ *	job of one task creates no thread at all.
+ */
+bool
+workermgr_run_job(WorkerMgrState *state,
+				  List *tasks,
+				  WorkerMgrTaskCallback func)
+{
+	WorkerMgrThread		*first;
+
+	if (state->threads_num == 0)
+		return true;
+
+	first = &state->threads[0];
+	first->state = state;
+	first->task = (Task) linitial(tasks);
+	first->func = func;
+
+	if (!workermgr_start_threads(state, tasks, func, 1))
+		return false;
+
+	PG_TRY();
+	{
+		func(first->task, state);
+	}
+	PG_CATCH();
+	{
+		state->cancel = true;
+		workermgr_join(state);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	workermgr_wait_job(state);
+	return true;
+}
+
+/*
+ * workermgr_start_threads
+ *	Start a thread for each task from the first-th one.
+ */
+static bool
+workermgr_start_threads(WorkerMgrState *state,
+						List *tasks,
+						WorkerMgrTaskCallback func,
+						int first)
 {
 	WorkerMgrThreadIterator		thread_iterator;
 	WorkerMgrThread				*worker_mgr_thread;
+	ListCell	*lc = list_head(tasks);
 	int		i = 0;
 
 	workermgr_init_thread_iterator(state, &thread_iterator);
 	while ((worker_mgr_thread = workermgr_get_thread_iterator(state, &thread_iterator)) != NULL)
 	{
+		Task	task = (Task) lfirst(lc);
+
+		lc = lnext(lc);
+		if (i++ < first)
+			continue;
+
 		worker_mgr_thread->state = state;
-		worker_mgr_thread->task = (Task) list_nth(tasks, i);
-		i++;
+		worker_mgr_thread->task = task;
 		worker_mgr_thread->func = func;
 
 #ifdef FAULT_INJECTOR
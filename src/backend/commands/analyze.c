@@ -124,6 +124,10 @@ bool			gp_statistics_use_fkeys = FALSE;
 int				gp_statistics_blocks_target = 25;
 double			gp_statistics_ndistinct_scaling_ratio_threshold = 0.10;
 double			gp_statistics_sampling_threshold = 10000;
+int				gp_statistics_dependency_columns = 0;
+bool			gp_statistics_skip_unchanged = false;
+double			gp_statistics_block_sampling_factor = 0;
+double			gp_statistics_block_sampling_fraction = 1.0;
 const int gp_external_table_default_number_of_pages = 1000;
 const int gp_external_table_default_number_of_tuples = 1000000;
 
@@ -139,6 +143,7 @@ typedef struct AttributeStatistics
 	ArrayType  	*mcv;		/* most common values */
 	ArrayType	*freq;		/* frequencies of most common values */
 	ArrayType	*hist;		/* equi-depth histogram bounds */
+	ArrayType	*deps;		/* dependencies of other attributes on this one */
 } AttributeStatistics;
 
 /**
@@ -173,6 +178,7 @@ static void gp_statistics_estimate_reltuples_relpages_parquet(Relation rel, floa
 static void gp_statistics_estimate_reltuples_relpages_orc(Relation rel, float4 *reltuples, float4 *relpages);
 static void gp_statistics_estimate_reltuples_relpages_external(Relation rel, float4 *relTuples, float4 *relPages);
 static void analyzeEstimateReltuplesRelpages(Oid relationOid, float4 *relTuples, float4 *relPages, bool rootonly);
+static bool analyzeStatisticsUnchanged(Relation relation, List *lAttributeNames, float4 relTuples, float4 relPages);
 static void analyzeEstimateIndexpages(Oid relationOid, Oid indexOid, float4 *indexPages);
 static void analyzeEstimateMagmaIndexpages(Oid relationOid, Relation rel, float4 reltuples,
                                            float4 *indexPages, float4 relPages, int2vector *indKeyVector);
@@ -216,6 +222,13 @@ static void analyzeComputeNDistinctBySample(Oid relationOid,
 static float4 analyzeComputeNDistinctAbsolute(Oid sampleTableOid, 
 		float4 sampleTableRelTuples, 
 		const char *attributeName);
+static ArrayType *analyzeComputeDependencies(Oid relationOid,
+		Oid sampleTableOid,
+		const char *attributeName,
+		List *lDependencyNames);
+static float4 analyzeComputeDependencyDegree(Oid sampleTableOid,
+		const char *attributeName,
+		const char *dependentName);
 static float4 analyzeComputeNRepeating(Oid relationOid, 
 		const char *attributeName);
 static float4 analyzeNullCount(Oid sampleTableOid, Oid relationOid, const char *attributeName, bool mergeStats);
@@ -1129,6 +1142,7 @@ static void analyzeRelation(Relation relation, List *lAttributeNames, bool rooto
 	float4 estimatedRelPages = 0.0;
 	float4 sampleTableRelTuples = 0.0;
 	List	*indexOidList = NIL;
+	List	*lDependencyNames = NIL;
 	ListCell	*lc = NULL;
 	StringInfoData location;
 	
@@ -1149,6 +1163,19 @@ static void analyzeRelation(Relation relation, List *lAttributeNames, bool rooto
 	
 	elog(elevel, "ANALYZE estimated reltuples=%f, relpages=%f for table %s", estimatedRelTuples, estimatedRelPages, RelationGetRelationName(relation));
 
+	/**
+	 * An append-only or parquet table only changes by appends and truncation. If it has
+	 * not changed since its statistics were computed, there is no need to scan it again.
+	 * Partitioned event tables then only get their new leaf partitions analyzed, while
+	 * their root statistics are merged from the statistics of the leaves.
+	 */
+	if (gp_statistics_skip_unchanged &&
+		analyzeStatisticsUnchanged(relation, lAttributeNames, estimatedRelTuples, estimatedRelPages))
+	{
+		elog(elevel, "ANALYZE skipping table %s because it has not changed since its last ANALYZE.", RelationGetRelationName(relation));
+		return;
+	}
+
 	/* Step 2: update the pg_class entry. */
 	updateReltuplesRelpagesInCatalog(relationOid, estimatedRelTuples, estimatedRelPages);
 	
@@ -1295,6 +1322,28 @@ static void analyzeRelation(Relation relation, List *lAttributeNames, bool rooto
 		pfree((void *) sampleTableName);
 	}
 	
+	/**
+	 * Determine the attributes among which functional dependencies are collected.
+	 */
+	if (gp_statistics_dependency_columns > 1)
+	{
+		foreach (le, lAttributeNames)
+		{
+			const char *attributeName = (const char *) lfirst(le);
+
+			if (list_length(lDependencyNames) >= gp_statistics_dependency_columns)
+				break;
+			if (isOrderedAndHashable(relationOid, attributeName))
+				lDependencyNames = lappend(lDependencyNames, (void *) attributeName);
+		}
+
+		if (list_length(lDependencyNames) < 2)
+		{
+			list_free(lDependencyNames);
+			lDependencyNames = NIL;
+		}
+	}
+
 	/**
 	 * Step 4: ANALYZE attributes, one at a time.
 	 */
@@ -1307,6 +1356,13 @@ static void analyzeRelation(Relation relation, List *lAttributeNames, bool rooto
 			analyzeComputeAttributeStatistics(relationOid, lAttributeName, estimatedRelTuples, sampleTableOid, sampleTableRelTuples, false /*mergeStats*/, &stats);
 		else
 			analyzeComputeAttributeStatistics(relationOid, lAttributeName, estimatedRelTuples, relationOid, estimatedRelTuples, false /*mergeStats*/, &stats);
+		if (list_member_ptr(lDependencyNames, (void *) lAttributeName))
+		{
+			elog(elevel, "ANALYZE computing dependencies on attribute %s", lAttributeName);
+			stats.deps = analyzeComputeDependencies(relationOid,
+													sampleTableRequired ? sampleTableOid : relationOid,
+													lAttributeName, lDependencyNames);
+		}
 		updateAttributeStatisticsInCatalog(relationOid, lAttributeName, &stats);
 	}
 
@@ -1367,6 +1423,43 @@ static void analyzeRelation(Relation relation, List *lAttributeNames, bool rooto
 	return;
 }
 
+/**
+ * Whether the statistics of an append-only or parquet table are still those of its contents.
+ * The number of tuples of such tables is exact, and their size only grows with appends,
+ * so the table is unchanged if the catalog still holds the reltuples and relpages estimated
+ * now, and every attribute to analyze has statistics.
+ * Input:
+ * 	relation - relation
+ * 	lAttributeNames - attributes to analyze
+ * 	relTuples, relPages - estimated from the segment files of the relation
+ */
+static bool analyzeStatisticsUnchanged(Relation relation, List *lAttributeNames, float4 relTuples, float4 relPages)
+{
+	Oid			relationOid = RelationGetRelid(relation);
+	ListCell   *le = NULL;
+
+	if (!RelationIsAoRows(relation) && !RelationIsParquet(relation))
+		return false;
+
+	if (relation->rd_rel->reltuples != relTuples ||
+		relation->rd_rel->relpages != (int32) relPages)
+		return false;
+
+	foreach (le, lAttributeNames)
+	{
+		const char *attributeName = (const char *) lfirst(le);
+		AttrNumber	attnum = get_attnum(relationOid, attributeName);
+		HeapTuple	statsTuple = get_att_stats(relationOid, attnum);
+
+		if (!HeapTupleIsValid(statsTuple))
+			return false;
+
+		heap_freetuple(statsTuple);
+	}
+
+	return true;
+}
+
 /**
  * Generates a table name for the auxiliary sample table that may be created during ANALYZE.
  * This is not super random. However, this should be sufficient for our purpose.
@@ -1674,6 +1767,34 @@ static Oid buildSampleTable(Oid relationOid,
 			                        spiCallback_getProcessedAsFloat4, sampleTableRelTuples);
 
 	} else {
+		char		relstorage = get_rel_relstorage(relationOid);
+		float4		blockFraction = 1.0;
+
+		/*
+		 * The scans of append-only and parquet tables can skip whole blocks
+		 * and row groups without reading them. Rows are then taken from a
+		 * random subset of the blocks, read in larger numbers than needed so
+		 * that the sample is spread over many blocks.
+		 */
+		if (gp_statistics_block_sampling_factor > 0 &&
+			(relstorage == RELSTORAGE_AOROWS || relstorage == RELSTORAGE_PARQUET))
+		{
+			blockFraction = Min(1.0, randomThreshold * gp_statistics_block_sampling_factor);
+			randomThreshold = Min(1.0, randomThreshold / blockFraction);
+		}
+
+		if (blockFraction < 1.0)
+		{
+			resetStringInfo(&str);
+			appendStringInfo(&str, "set gp_statistics_block_sampling_fraction = %.38f", blockFraction);
+			spiExecuteWithCallback(str.data, false /*readonly*/, 0 /*tcount */,
+					NULL, NULL);
+			resetStringInfo(&str);
+
+			elog(elevel, "ANALYZE sampling %f of the blocks of table %s.%s",
+					blockFraction, quote_identifier(schemaName), quote_identifier(tableName));
+		}
+
 		appendStringInfo(&str, "create table %s.%s as (select ",
 				quote_identifier(sampleSchemaName),
 				quote_identifier(sampleTableName));
@@ -1702,6 +1823,13 @@ static Oid buildSampleTable(Oid relationOid,
 
 		spiExecuteWithCallback(str.data, false /*readonly*/, 0 /*tcount */,
 				spiCallback_getProcessedAsFloat4, sampleTableRelTuples);
+
+		/* the statistics queries read the whole sample table */
+		if (blockFraction < 1.0)
+		{
+			spiExecuteWithCallback("reset gp_statistics_block_sampling_fraction", false /*readonly*/, 0 /*tcount */,
+					NULL, NULL);
+		}
 	}
 	pfree(str.data);
 		
@@ -2144,6 +2272,92 @@ static float4 analyzeComputeNDistinctAbsolute(Oid sampleTableOid,
 	return ndistinct;
 }
 
+/**
+ * Compute how much the values of an attribute determine the values of other attributes.
+ * Input:
+ * 	relationOid - relation's oid
+ * 	sampleTableOid - oid of the sample table, or of the relation itself
+ * 	attributeName - attribute
+ * 	lDependencyNames - attributes among which dependencies are collected
+ * Output:
+ * 	array of pairs of the attribute number of another attribute and the degree to which
+ * 	it depends on this one, see STATISTIC_KIND_DEPENDENCY.
+ */
+static ArrayType *analyzeComputeDependencies(Oid relationOid,
+											 Oid sampleTableOid,
+											 const char *attributeName,
+											 List *lDependencyNames)
+{
+	Datum	   *values = NULL;
+	int			nvalues = 0;
+	ListCell   *le = NULL;
+	ArrayType  *result = NULL;
+
+	values = (Datum *) palloc(sizeof(Datum) * 2 * list_length(lDependencyNames));
+
+	foreach (le, lDependencyNames)
+	{
+		const char *dependentName = (const char *) lfirst(le);
+		float4		degree = 0.0;
+
+		if (dependentName == attributeName)
+			continue;
+
+		degree = analyzeComputeDependencyDegree(sampleTableOid, attributeName, dependentName);
+		elog(elevel, "ANALYZE attribute %s depends on attribute %s by %f.", dependentName, attributeName, degree);
+
+		values[nvalues++] = Float4GetDatum((float4) get_attnum(relationOid, dependentName));
+		values[nvalues++] = Float4GetDatum(degree);
+	}
+
+	result = construct_array(values, nvalues, FLOAT4OID, sizeof(float4), true, 'i');
+	pfree(values);
+
+	return result;
+}
+
+/**
+ * Compute the fraction of the rows with a non-null value of an attribute whose group of equal
+ * values of the attribute has a single value of another attribute.
+ * Input:
+ * 	sampleTableOid - oid of the sample table, or of the relation itself
+ * 	attributeName - attribute
+ * 	dependentName - other attribute
+ * Output:
+ * 	degree to which dependentName depends on attributeName, between 0 and 1.
+ */
+static float4 analyzeComputeDependencyDegree(Oid sampleTableOid,
+											 const char *attributeName,
+											 const char *dependentName)
+{
+	StringInfoData str;
+	float4	degree = 0.0;
+
+	const char *sampleSchemaName = NULL;
+	const char *sampleTableName = NULL;
+
+	sampleSchemaName = get_namespace_name(get_rel_namespace(sampleTableOid)); /* must be pfreed */
+	sampleTableName = get_rel_name(sampleTableOid); /* must be pfreed */
+
+	initStringInfo(&str);
+	appendStringInfo(&str, "select coalesce((sum(case when Tb.n = 1 then Tb.f else 0 end)::float8 / sum(Tb.f)::float8)::float4, 0.0::float4) "
+			"from (select count(*) as f, count(distinct Ta.%s) as n from %s.%s as Ta where Ta.%s is not null group by Ta.%s) as Tb",
+			quote_identifier(dependentName),
+			quote_identifier(sampleSchemaName),
+			quote_identifier(sampleTableName),
+			quote_identifier(attributeName),
+			quote_identifier(attributeName));
+
+	spiExecuteWithCallback(str.data, false /*readonly*/, 0 /*tcount */,
+							spiCallback_getSingleResultRowColumnAsFloat4, &degree);
+
+	pfree(str.data);
+	pfree((void *) sampleTableName);
+	pfree((void *) sampleSchemaName);
+
+	return degree;
+}
+
 /**
  * Compute the number of repeating values in a relation.
  * Input:
@@ -2916,6 +3130,7 @@ static void analyzeComputeAttributeStatistics(Oid relationOid,
 	stats->mcv = NULL;
 	stats->freq = NULL;
 	stats->hist = NULL;
+	stats->deps = NULL;
 		
 	if (isNotNull(relationOid, attributeName))
 	{
@@ -3116,8 +3331,15 @@ static void updateAttributeStatisticsInCatalog(Oid relationOid, const char *attr
 	/* correlation */
 	values[Anum_pg_statistic_stakind3 - 1] = Int16GetDatum((int2) 0); /* we do not compute correlation anymore */
 	
-	/* an extra slot */
-	values[Anum_pg_statistic_stakind4 - 1] = Int16GetDatum((int2) 0);
+	/* dependencies of other attributes */
+	if (stats->deps)
+	{
+		values[Anum_pg_statistic_stakind4 - 1] = Int16GetDatum(STATISTIC_KIND_DEPENDENCY);
+	}
+	else
+	{
+		values[Anum_pg_statistic_stakind4 - 1] = Int16GetDatum((int2) 0);
+	}
 	
 	/* staops .. which correspond to operators. Sigh.. */
 	if (stats->mcv)
@@ -3158,8 +3380,16 @@ static void updateAttributeStatisticsInCatalog(Oid relationOid, const char *attr
 	values[Anum_pg_statistic_stanumbers2 - 1] = 0;
 	nulls[Anum_pg_statistic_stanumbers3 - 1] = true;
 	values[Anum_pg_statistic_stanumbers3 - 1] = 0;
-	nulls[Anum_pg_statistic_stanumbers4 - 1] = true;
-	values[Anum_pg_statistic_stanumbers4 - 1] = 0;
+
+	if (stats->deps)
+	{
+		values[Anum_pg_statistic_stanumbers4 - 1] = PointerGetDatum(stats->deps);
+	}
+	else
+	{
+		nulls[Anum_pg_statistic_stanumbers4 - 1] = true;
+		values[Anum_pg_statistic_stanumbers4 - 1] = 0;
+	}
 
 	/* Now working on stavalues */
 	if (stats->mcv)
@@ -2471,7 +2471,7 @@ CopyTo(CopyState cstate)
 				TupleTableSlot	*slot = MakeSingleTupleTableSlot(tupDesc);
 				MemTupleBinding *mt_bind = create_memtuple_binding(tupDesc);
 
-				aoscandesc = appendonly_beginscan(rel, ActiveSnapshot, 0, NULL);
+				aoscandesc = appendonly_beginscan(rel, ActiveSnapshot, 0, NULL, NULL);
 				aoscandesc->splits = GetFileSplitsOfSegment(cstate->splits,rel->rd_id, GetQEIndex());
 
 
@@ -7065,6 +7065,16 @@ copy_in_error_callback(void *arg)
 	StringInfoData copy_of_line_buf;
 	char buffer[20];
 
+	/*
+	 * A data error in single row error handling mode only rejects the row,
+	 * and just the message of it is logged (see COPY_HANDLE_ERROR).  Don't
+	 * copy and format the line for a context nobody sees, that is most of
+	 * the work of rejecting a row.
+	 */
+	if (cstate->errMode != ALL_OR_NOTHING &&
+		ERRCODE_TO_CATEGORY(geterrcode()) == ERRCODE_DATA_EXCEPTION)
+		return;
+
 	initStringInfo(&copy_of_line_buf);
 	appendStringInfoString(&copy_of_line_buf, cstate->line_buf.data);
 
@@ -7348,14 +7358,37 @@ scanCSVLine(CopyState cstate, const char *s, char eol, char escapec, char quotec
 	else
 		/* safe to scroll byte by byte */
 	{	
-		for ( ; *s != eol && s < end ; s++)
+		const char *eolloc = memchr(s, eol, len);
+		const char *scanend = eolloc ? eolloc : end;
+
+		/*
+		 * Fast path: when this piece of the line has no escape char, and we
+		 * are not right after one, each quote char just toggles in_quote. So
+		 * we can jump from quote to quote instead of looking at every byte.
+		 * (escapec is '\0' when it is the same as quotec.)
+		 */
+		if (!cstate->last_was_esc && memchr(s, escapec, scanend - s) == NULL)
 		{
-			if (cstate->in_quote && *s == escapec)
-				cstate->last_was_esc = !cstate->last_was_esc;
-			if (*s == quotec && !cstate->last_was_esc)
+			const char *q = s;
+
+			while ((q = memchr(q, quotec, scanend - q)) != NULL)
+			{
 				cstate->in_quote = !cstate->in_quote;
-			if (*s != escapec)
-				cstate->last_was_esc = false;
+				q++;
+			}
+			s = scanend;
+		}
+		else
+		{
+			for ( ; *s != eol && s < end ; s++)
+			{
+				if (cstate->in_quote && *s == escapec)
+					cstate->last_was_esc = !cstate->last_was_esc;
+				if (*s == quotec && !cstate->last_was_esc)
+					cstate->in_quote = !cstate->in_quote;
+				if (*s != escapec)
+					cstate->last_was_esc = false;
+			}
 		}
 	}
 
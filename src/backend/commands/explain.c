@@ -1801,6 +1801,18 @@ explain_outNode(StringInfo str,
 							"Merge Key",
 							str, indent, es);
 
+				/* Hot keys of a skewed join */
+				if (pMotion->skewHashes != NIL)
+				{
+					int			i;
+
+					for (i = 0; i < indent; i++)
+						appendStringInfoString(str, "  ");
+					appendStringInfo(str, "  Skew Keys: %d %s\n",
+									 list_length(pMotion->skewHashes),
+									 pMotion->skewBroadcast ? "broadcast" : "spread");
+				}
+
                 /* Descending into a new slice. */
                 if (sliceTable)
                     es->currentSlice = (Slice *)list_nth(sliceTable->slices,
@@ -22,22 +22,32 @@
 #include "catalog/pg_type.h"
 #include "cdb/cdbfilesystemcredential.h"
 #include "cdb/cdblink.h"
+#include "cdb/cdbmutate.h"
+#include "cdb/cdbpartition.h"
+#include "cdb/cdbvars.h"
 #include "commands/explain.h"
 #include "commands/prepare.h"
 #include "executor/executor.h"
 #include "funcapi.h"
 #include "miscadmin.h"
 #include "nodes/nodeFuncs.h"
+#include "optimizer/clauses.h"
+#include "optimizer/planner.h"
 #include "parser/analyze.h"
 #include "parser/parse_coerce.h"
 #include "parser/parse_expr.h"
 #include "parser/parse_type.h"
+#include "parser/parsetree.h"
 #include "rewrite/rewriteHandler.h"
 #include "tcop/pquery.h"
 #include "tcop/tcopprot.h"
 #include "tcop/utility.h"
 #include "utils/builtins.h"
+#include "utils/datum.h"
+#include "utils/inval.h"
+#include "utils/lsyscache.h"
 #include "utils/memutils.h"
+#include "utils/syscache.h"
 #include "postmaster/identity.h"
 #include "commands/tablespace.h"
 #include "catalog/catalog.h"
@@ -202,7 +212,7 @@ ExecuteQuery(ExecuteStmt *stmt, const char *queryString,
 			query->intoClause = copyObject(stmt->into);
 		}
 		
-		stmt_list = pg_plan_queries(query_list, paramLI, true, QRL_ONCE);
+		stmt_list = PlanPreparedStatement(entry, query_list, paramLI);
 	}
 
 	/*
@@ -434,6 +444,10 @@ StorePreparedStatement(const char *stmt_name,
 	entry->context = entrycxt;
 	entry->prepare_time = GetCurrentStatementStartTimestamp();
 	entry->from_sql = from_sql;
+	entry->plan_context = NULL;
+	entry->plan = NULL;
+	entry->plan_params = NULL;
+	entry->plan_generation = 0;
 
 	MemoryContextSwitchTo(oldcxt);
 }
@@ -635,6 +649,258 @@ DropPreparedStatement(const char *stmt_name, bool showError)
 	}
 }
 
+/*
+ * Plan reuse of prepared statements.
+ *
+ * A prepared statement is planned again at every execution, as the plan
+ * carries the resource and the splits of that execution, and it is planned
+ * for the parameter values given. With gp_enable_prepared_plan_cache, the plan
+ * of a SELECT is kept, and the next execution with the same parameter values
+ * reuses it through refineCachedPlan(), which allocates new resource and
+ * splits and plans again only if the number of virtual segments changes.
+ *
+ * The plan of a single row INSERT into a hash distributed table is kept too,
+ * and reused for any parameter values: they are put in its constant target
+ * list and hashed on the dispatcher to send it to the one virtual segment
+ * the row belongs to.
+ *
+ * Kept plans are discarded on any relcache invalidation, which includes the
+ * statistics updated by ANALYZE, on changes of functions and statistics, and
+ * on changes of configuration parameters, by bumping the generation below.
+ */
+bool		gp_enable_prepared_plan_cache = false;
+
+static uint64 prepared_plan_generation = 1;
+static bool prepared_plan_callbacks_registered = false;
+
+static void
+PreparedPlanInvalCallback(Datum arg, Oid relid)
+{
+	InvalidatePreparedPlans();
+}
+
+/*
+ * Discard the kept plans of all prepared statements.
+ */
+void
+InvalidatePreparedPlans(void)
+{
+	prepared_plan_generation++;
+}
+
+/*
+ * Check whether the two sets of parameter values are the same.
+ */
+static bool
+ParamListEqual(ParamListInfo a, ParamListInfo b)
+{
+	int			numa = a ? a->numParams : 0;
+	int			numb = b ? b->numParams : 0;
+	int			i;
+
+	if (numa != numb)
+		return false;
+
+	for (i = 0; i < numa; i++)
+	{
+		ParamExternData *pa = &a->params[i];
+		ParamExternData *pb = &b->params[i];
+		int16		typLen;
+		bool		typByVal;
+
+		if (pa->ptype != pb->ptype || pa->isnull != pb->isnull)
+			return false;
+		if (pa->isnull || !OidIsValid(pa->ptype))
+			continue;
+
+		get_typlenbyval(pa->ptype, &typLen, &typByVal);
+		if (!datumIsEqual(pa->value, pb->value, typByVal, typLen))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Check whether a plan is of a single row INSERT of constants, sent to the
+ * one virtual segment its distribution key hashes to.
+ */
+static bool
+IsSingleRowInsertPlan(PlannedStmt *plan)
+{
+	Plan	   *top = plan->planTree;
+
+	return IsA(top, Result) &&
+		top->lefttree == NULL &&
+		top->qual == NIL &&
+		((Result *) top)->resconstantqual == NULL &&
+		((Result *) top)->hashFilter &&
+		top->directDispatch.isDirectDispatch &&
+		plan->nMotionNodes == 0 &&
+		plan->nInitPlans == 0 &&
+		plan->subplans == NIL &&
+		list_length(plan->resultRelations) == 1;
+}
+
+/*
+ * Put the values of the parameters in the kept plan of a single row INSERT,
+ * and send it to the virtual segment they hash to.  The target list of the
+ * plan is all constants; the ones computed from the parameters are computed
+ * again from the target list of the query.  Returns false if the plan cannot
+ * be used for these values.
+ */
+static bool
+RebindSingleRowInsert(PlannedStmt *plan, Query *query, ParamListInfo params)
+{
+	RangeTblEntry *rte;
+	GpPolicy   *policy;
+	PlannerInfo *root;
+	ListCell   *lc;
+
+	if (!IsSingleRowInsertPlan(plan))
+		return false;
+
+	rte = rt_fetch(query->resultRelation, query->rtable);
+	if (rel_is_partitioned(rte->relid))
+		return false;
+
+	root = makeNode(PlannerInfo);
+	root->glob = makeNode(PlannerGlobal);
+	root->glob->boundParams = params;
+
+	foreach(lc, plan->planTree->targetlist)
+	{
+		TargetEntry *tle = (TargetEntry *) lfirst(lc);
+		TargetEntry *qtle = get_tle_by_resno(query->targetList, tle->resno);
+		Node	   *expr;
+
+		if (!IsA(tle->expr, Const))
+			return false;
+
+		/* columns left out of the INSERT are the same for any parameters */
+		if (qtle == NULL)
+			continue;
+
+		expr = eval_const_expressions(root, (Node *) copyObject(qtle->expr));
+		if (!IsA(expr, Const) ||
+			((Const *) expr)->consttype != ((Const *) tle->expr)->consttype)
+			return false;
+		tle->expr = (Expr *) expr;
+	}
+
+	policy = GpPolicyFetch(CurrentMemoryContext, rte->relid);
+	if (policy == NULL || policy->ptype != POLICYTYPE_PARTITIONED)
+		return false;
+
+	freeListAndNull(&plan->planTree->directDispatch.contentIds);
+	directDispatchCalculateHash(plan->planTree, policy, plan->planner_segments);
+
+	return plan->planTree->directDispatch.isDirectDispatch;
+}
+
+/*
+ * Plan the copied query_list of the prepared statement for the parameter
+ * values, reusing the plan of the last execution when possible.
+ */
+List *
+PlanPreparedStatement(PreparedStatement *stmt, List *query_list,
+					  ParamListInfo params)
+{
+	Query	   *query;
+	List	   *stmt_list;
+	PlannedStmt *plan;
+	MemoryContext oldcxt;
+
+	if (!gp_enable_prepared_plan_cache ||
+		Gp_role != GP_ROLE_DISPATCH ||
+		(stmt->sourceTag != T_SelectStmt && stmt->sourceTag != T_InsertStmt) ||
+		list_length(query_list) != 1)
+		return pg_plan_queries(query_list, params, true, QRL_ONCE);
+
+	query = (Query *) linitial(query_list);
+	if ((query->commandType != CMD_SELECT && query->commandType != CMD_INSERT) ||
+		query->intoClause != NULL ||
+		query->utilityStmt != NULL)
+		return pg_plan_queries(query_list, params, true, QRL_ONCE);
+
+	if (!prepared_plan_callbacks_registered)
+	{
+		CacheRegisterRelcacheCallback(PreparedPlanInvalCallback, (Datum) 0);
+		CacheRegisterSyscacheCallback(PROCOID, PreparedPlanInvalCallback, (Datum) 0);
+		CacheRegisterSyscacheCallback(STATRELATT, PreparedPlanInvalCallback, (Datum) 0);
+		prepared_plan_callbacks_registered = true;
+	}
+
+	/* Pick up the invalidations sent since the last execution. */
+	AcceptInvalidationMessages();
+
+	if (stmt->plan != NULL &&
+		stmt->plan_generation == prepared_plan_generation)
+	{
+		bool		reuse = false;
+
+		ActiveSnapshot = CopySnapshot(GetTransactionSnapshot());
+
+		plan = (PlannedStmt *) copyObject(stmt->plan);
+		if (ParamListEqual(stmt->plan_params, params))
+			reuse = true;
+		else if (query->commandType == CMD_INSERT)
+			reuse = RebindSingleRowInsert(plan, query, params);
+
+		if (reuse)
+		{
+			plan = refineCachedPlan(plan, query, 0, params);
+
+			elog(DEBUG1, "reuse plan of prepared statement \"%s\"", stmt->stmt_name);
+
+			return list_make1(plan);
+		}
+	}
+
+	stmt_list = pg_plan_queries(query_list, params, true, QRL_ONCE);
+
+	/* Forget the old plan, and keep the new one if it can be refined. */
+	if (stmt->plan_context != NULL)
+	{
+		MemoryContextDelete(stmt->plan_context);
+		stmt->plan_context = NULL;
+		stmt->plan = NULL;
+		stmt->plan_params = NULL;
+	}
+
+	plan = (PlannedStmt *) linitial(stmt_list);
+	if (!IsA(plan, PlannedStmt) ||
+		plan->planTree == NULL ||
+		plan->planTree->dispatch != DISPATCH_PARALLEL ||
+		plan->resource == NULL)
+		return stmt_list;
+	if (query->commandType == CMD_INSERT && !IsSingleRowInsertPlan(plan))
+		return stmt_list;
+
+	stmt->plan_context = AllocSetContextCreate(stmt->context,
+											   "PreparedPlan",
+											   ALLOCSET_SMALL_MINSIZE,
+											   ALLOCSET_SMALL_INITSIZE,
+											   ALLOCSET_DEFAULT_MAXSIZE);
+	oldcxt = MemoryContextSwitchTo(stmt->plan_context);
+
+	stmt->plan = (PlannedStmt *) copyObject(plan);
+
+	/*
+	 * The resource is freed at the end of this execution, keep only its life
+	 * for refineCachedPlan() to allocate the new one.
+	 */
+	stmt->plan->resource = makeNode(QueryResource);
+	stmt->plan->resource->life = plan->resource->life;
+
+	stmt->plan_params = copyParamList(params);
+	stmt->plan_generation = prepared_plan_generation;
+
+	MemoryContextSwitchTo(oldcxt);
+
+	return stmt_list;
+}
+
 /*
  * Implements the 'EXPLAIN EXECUTE' utility statement.
  */
@@ -104,6 +104,8 @@ typedef struct SeqTableData
 	int64		cached;			/* last value already cached for nextval */
 	/* if last != cached, we have not used up all the cached values */
 	int64		increment;		/* copy of sequence's increment field */
+	TransactionId lease_xid;	/* xact in which a QE last asked for values */
+	int64		lease;			/* number of values it asked for */
 } SeqTableData;
 
 typedef SeqTableData *SeqTable;
@@ -127,12 +129,14 @@ static void process_owned_by(Relation seqrel, List *owned_by);
 
 static void
 cdb_sequence_nextval(Relation   seqrel,
+                     int64      nvalues,
                      int64     *plast,
                      int64     *pcached,
                      int64     *pincrement,
                      bool      *seq_overflow);
 static void
 cdb_sequence_nextval_proxy(Relation seqrel,
+                           int64    nvalues,
                            int64   *plast,
                            int64   *pcached,
                            int64   *pincrement,
@@ -850,19 +854,35 @@ nextval_internal(Oid relid)
 				 errmsg("permission denied for sequence %s",
 						RelationGetRelationName(seqrel))));
 
-    /* Update the sequence object. */
-    if (Gp_role == GP_ROLE_EXECUTE)
-        cdb_sequence_nextval_proxy(seqrel,
-                                   &elm->last,
-                                   &elm->cached,
-                                   &elm->increment,
-                                   &is_overflow);
-    else
-        cdb_sequence_nextval(seqrel,
-                             &elm->last,
-                             &elm->cached,
-                             &elm->increment,
-                             &is_overflow);
+	/* Update the sequence object. */
+	if (Gp_role == GP_ROLE_EXECUTE)
+	{
+		/*
+		 * Each of these is a round trip to the sequence server, so a QE
+		 * that keeps using up its values in the same transaction asks for
+		 * twice as many every time, up to gp_sequence_lease_max.  The
+		 * values it doesn't use are lost, as with CACHE.
+		 */
+		if (elm->lease_xid == elm->xid)
+			elm->lease = Min(elm->lease * 2, (int64) gp_sequence_lease_max);
+		else
+			elm->lease = 1;
+		elm->lease_xid = elm->xid;
+
+		cdb_sequence_nextval_proxy(seqrel,
+								   elm->lease,
+								   &elm->last,
+								   &elm->cached,
+								   &elm->increment,
+								   &is_overflow);
+	}
+	else
+		cdb_sequence_nextval(seqrel,
+							 1,
+							 &elm->last,
+							 &elm->cached,
+							 &elm->increment,
+							 &is_overflow);
 	last_used_seq = elm;
 
     relation_close(seqrel, NoLock);
@@ -870,8 +890,13 @@ nextval_internal(Oid relid)
 }
 
 
+/*
+ * Fetch the next value of a sequence, and cache the following ones: the
+ * CACHE of the sequence, or nvalues if that is more.
+ */
 void
 cdb_sequence_nextval(Relation   seqrel,
+                     int64      nvalues,
                      int64     *plast,
                      int64     *pcached,
                      int64     *pincrement,
@@ -907,7 +932,7 @@ cdb_sequence_nextval(Relation   seqrel,
 	incby = seq->increment_by;
 	maxv = seq->max_value;
 	minv = seq->min_value;
-	fetch = cache = seq->cache_value;
+	fetch = cache = Max(seq->cache_value, nvalues);
 	log = seq->log_cnt;
 
 	if (!seq->is_called)
@@ -1404,6 +1429,8 @@ init_sequence(Oid relid, SeqTable *p_elm, Relation *p_rel)
 		elm->xid = InvalidTransactionId;
 		/* increment is set to 0 until we do read_info (see currval) */
 		elm->last = elm->cached = elm->increment = 0;
+		elm->lease_xid = InvalidTransactionId;
+		elm->lease = 0;
 		elm->next = seqtab;
 		seqtab = elm;
 	}
@@ -1880,6 +1907,7 @@ cdb_sequence_relation_term(Relation seqrel)
  */
 void
 cdb_sequence_nextval_proxy(Relation	seqrel,
+                           int64    nvalues,
                            int64   *plast,
                            int64   *pcached,
                            int64   *pincrement,
@@ -1889,6 +1917,7 @@ cdb_sequence_nextval_proxy(Relation	seqrel,
 	sendSequenceRequest(GetSeqServerFD(),
 						seqrel,
     					gp_session_id,
+						nvalues,
     					plast,
     					pcached,
     					pincrement,
@@ -1905,6 +1934,7 @@ cdb_sequence_nextval_server(Oid    tablespaceid,
                             Oid    dbid,
                             Oid    relid,
                             bool   istemp,
+                            int64  nvalues,
                             int64 *plast,
                             int64 *pcached,
                             int64 *pincrement,
@@ -1924,7 +1954,7 @@ cdb_sequence_nextval_server(Oid    tablespaceid,
     /* CDB TODO: Catch errors. */
 
     /* Update the sequence object. */
-    cdb_sequence_nextval(seqrel, plast, pcached, pincrement, poverflow);
+    cdb_sequence_nextval(seqrel, nvalues, plast, pcached, pincrement, poverflow);
 
     /* Cleanup. */
     cdb_sequence_relation_term(seqrel);
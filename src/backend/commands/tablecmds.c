@@ -8185,7 +8185,7 @@ ATRewriteTable(AlteredTableInfo *tab, Oid OIDNewHeap)
 
 			mt_bind = (newrel ? aoInsertDesc->mt_bind : create_memtuple_binding(newTupDesc));
 
-			aoscan = appendonly_beginscan(oldrel, SnapshotNow, 0, NULL);
+			aoscan = appendonly_beginscan(oldrel, SnapshotNow, 0, NULL, NULL);
 		  aoscan->splits = GetFileSplitsOfSegment(tab->scantable_splits,
 		          oldrel->rd_id, GetQEIndex());
 			/*
@@ -17621,7 +17621,7 @@ split_rows(Relation intoa, Relation intob, Relation temprel, List *splits, int s
 		heapscan = heap_beginscan(temprel, SnapshotNow, 0, NULL);
 	else if (RelationIsAoRows(temprel))
 	{
-		aoscan = appendonly_beginscan(temprel, SnapshotNow, 0, NULL);
+		aoscan = appendonly_beginscan(temprel, SnapshotNow, 0, NULL, NULL);
 		aoscan->splits = splits;
 	}
 	else if (RelationIsParquet(temprel))
@@ -960,6 +960,32 @@ lazy_truncate_heap(Relation onerel, LVRelStats *vacrelstats)
  */
 typedef FileSegTotals *(*GetFileSegTotalsCallback)(Relation rel,
                                                Snapshot snapshot);
+
+/*
+ * Tell the user when the segment files of an append only relation are so
+ * small on average that the scans pay mostly for opening files and for the
+ * file system metadata. Appends never merge segment files, only a rewrite of
+ * the relation does.
+ */
+static void
+report_small_segfiles(Relation rel, int totalfilesegs, int64 totalbytes)
+{
+	int64		avgbytes;
+
+	if (gp_appendonly_small_segfile_size <= 0 || totalfilesegs <= 1)
+		return;
+
+	avgbytes = totalbytes / totalfilesegs;
+	if (avgbytes >= (int64) gp_appendonly_small_segfile_size * 1024)
+		return;
+
+	ereport(NOTICE,
+			(errmsg("\"%s\" has %d segment files of only " INT64_FORMAT " bytes on average",
+					RelationGetRelationName(rel), totalfilesegs, avgbytes),
+			 errhint("Rewrite it with ALTER TABLE ... SET WITH (REORGANIZE=true) "
+					 "to merge them into fewer, larger files.")));
+}
+
 static void vacuum_appendonly_internal(Relation aorel, void *vacrelstats, bool isVacFull,
                                   GetFileSegTotalsCallback callback)
 {
@@ -981,6 +1007,7 @@ static void vacuum_appendonly_internal(Relation aorel, void *vacrelstats, bool i
 
 	/* get statistics from the pg_aoseg table */
 	fstotal = callback(aorel, SnapshotNow);
+	report_small_segfiles(aorel, fstotal->totalfilesegs, fstotal->totalbytes);
 
 	/* calculate the values we care about */
 	eof = (double)fstotal->totalbytes;
@@ -1086,6 +1113,7 @@ vacuum_parquet_rel(Relation parquetrel, void *vacrelstats, bool isVacFull)
 
 	/* get statistics from the pg_aoseg table */
 	fstotal = GetParquetSegFilesTotals(parquetrel, SnapshotNow);
+	report_small_segfiles(parquetrel, fstotal->totalfilesegs, fstotal->totalbytes);
 
 	/* calculate the values we care about */
 	eof = (double)fstotal->totalbytes;
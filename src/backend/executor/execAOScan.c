@@ -65,15 +65,25 @@ BeginScanAppendOnlyRelation(ScanState *scanState)
 	Assert(IsA(scanState, TableScanState) ||
 		   IsA(scanState, DynamicTableScanState));
 	AppendOnlyScanState *node = (AppendOnlyScanState *)scanState;
+	int			ncol;
+	bool	   *proj;
 	
 	Assert(node->ss.scan_state == SCAN_INIT ||
 		   node->ss.scan_state == SCAN_DONE);
 	Assert(node->aos_ScanDesc == NULL);
 
+	/* the columns needed, with column groups only their groups are read */
+	ncol = node->ss.ss_currentRelation->rd_att->natts;
+	proj = palloc0(sizeof(bool) * ncol);
+	GetNeededColumnsForScan((Node *)scanState->ps.plan->targetlist, proj, ncol);
+	GetNeededColumnsForScan((Node *)scanState->ps.plan->qual, proj, ncol);
+
 	node->aos_ScanDesc = appendonly_beginscan(
 			node->ss.ss_currentRelation, 
 			node->ss.ps.state->es_snapshot, 
-			0, NULL);
+			0, NULL, proj);
+
+	pfree(proj);
 
 	node->aos_ScanDesc->splits = scanState->splits;
 	node->ss.scan_state = SCAN_SCAN;
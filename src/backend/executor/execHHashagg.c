@@ -46,11 +46,13 @@
 #include "executor/execWorkfile.h"
 #include "storage/bfz.h"
 #include "utils/datum.h"
+#include "utils/fmgroids.h"
 #include "utils/memutils.h"
 #include "utils/lsyscache.h"
 #include "utils/elog.h"
 #include "cdb/memquota.h"
 #include "utils/workfile_mgr.h"
+#include "utils/vmem_tracker.h"
 
 #include "access/hash.h"
 
@@ -125,6 +127,20 @@ typedef enum InputRecordType
 #define BUCKET_IDX(hashtable, hashkey) \
 		(((hashkey) >> (hashtable)->pshift) & ((hashtable)->nbuckets - 1))
 
+/*
+ * Slot of the open-addressing table where the probe for a hash key starts.
+ * The multiplicative hash takes its high bits from all the bits of the key,
+ * as the keys of a reloaded batch file share their low bits.
+ */
+#define SLOT_IDX(hashtable, hashkey) \
+		((uint32) ((hashkey) * 0x9E3779B1U) >> (hashtable)->slot_shift)
+
+/* The open-addressing table grows, or is full, at 3/4 of its slots used */
+#define SLOTS_MAX_ENTRIES(hashtable) ((hashtable)->nslots / 4 * 3)
+
+#define MIN_NSLOTS 16
+#define MIN_NSLOTS_SHIFT (32 - 4)
+
 
 /* Methods that handle batch files */
 static SpillSet *createSpillSet(unsigned branching_factor, unsigned parent_hash_bit);
@@ -143,13 +159,24 @@ static void *readHashEntry(AggState *aggstate,
 /* Methods for hash table */
 static uint32 calc_hash_value(AggState* aggstate, TupleTableSlot *inputslot);
 static void spill_hash_table(AggState *aggstate);
+static bool grow_hash_table_mem(HashAggTable *hashtable);
+static bool agg_hash_request_spill(void *arg);
 static void expand_hash_table(AggState *aggstate);
+static bool expand_agg_hash_slots(AggState *aggstate);
+static bool agg_hash_key_inlinable(AggState *aggstate);
 static void init_agg_hash_iter(HashAggTable* ht);
 static HashAggEntry *lookup_agg_hash_entry(AggState *aggstate, void *input_record,
 										   InputRecordType input_type, int32 input_size,
 										   uint32 hashkey, unsigned parent_hash_bit, bool *p_isnew);
+static HashAggEntry *lookup_agg_hash_slot(AggState *aggstate, void *input_record,
+										  InputRecordType input_type, int32 input_size,
+										  uint32 hashkey, bool *p_isnew);
 static void agg_hash_table_stat_upd(HashAggTable *ht);
 static void reset_agg_hash_table(AggState *aggstate);
+static void check_stream_reduction(AggState *aggstate);
+
+/* Bytes of transition values the tuples passed through may take */
+#define PASSTHROUGH_MPOOL_RESET_SIZE (64 * 1024)
 static bool agg_hash_reload(AggState *aggstate);
 static inline void *mpool_cxt_alloc(void *manager, Size len);
 
@@ -409,6 +436,98 @@ setGroupAggs(HashAggTable *hashtable, MemTupleBinding *mt_bind, HashAggEntry *en
 	}
 }
 
+/*
+ * Function: getInputAttr
+ *
+ * Get the value of an attribute of the input record.
+ */
+static inline Datum
+getInputAttr(AggState *aggstate, void *input_record, InputRecordType input_type,
+			 AttrNumber att, bool *isnull)
+{
+	Datum datum = 0;
+
+	*isnull = false;
+	switch(input_type)
+	{
+		case INPUT_RECORD_TUPLE:
+			datum = slot_getattr((TupleTableSlot *)input_record, att, isnull);
+			break;
+		case INPUT_RECORD_GROUP_AND_AGGS:
+			datum = memtuple_getattr((MemTuple)input_record,
+									 aggstate->hashslot->tts_mt_bind, att, isnull);
+			break;
+		default:
+			insist_log(false, "invalid record type %d", input_type);
+	}
+
+	return datum;
+}
+
+/*
+ * Function: groupKeysMatch
+ *
+ * Whether the grouping keys of the input record are those of the given
+ * entry tuple. NULLs match in group keys.
+ */
+static bool
+groupKeysMatch(AggState *aggstate, void *input_record,
+			   InputRecordType input_type, MemTuple mtup)
+{
+	Agg *agg = (Agg*)aggstate->ss.ps.plan;
+	MemTupleBinding *mt_bind = aggstate->hashslot->tts_mt_bind;
+	int i;
+
+	for (i = 0; i < agg->numCols; i++)
+	{
+		AttrNumber	att = agg->grpColIdx[i];
+		Datum input_datum;
+		Datum entry_datum;
+		bool input_isNull;
+		bool entry_isNull = false;
+
+		input_datum = getInputAttr(aggstate, input_record, input_type, att, &input_isNull);
+		entry_datum = memtuple_getattr(mtup, mt_bind, att, &entry_isNull);
+
+		if ( !input_isNull && !entry_isNull &&
+			 (DatumGetBool(FunctionCall2(&aggstate->eqfunctions[i],
+										 input_datum,
+										 entry_datum)) ) )
+			continue; /* Both non-NULL and equal. */
+		if (!(input_isNull && entry_isNull))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Function: makeHashAggEntry
+ *
+ * Allocate a new hash agg entry for the input record, or return NULL if no
+ * enough memory is available.
+ */
+static inline HashAggEntry *
+makeHashAggEntry(AggState *aggstate, void *input_record,
+				 InputRecordType input_type, int32 input_size, uint32 hashkey)
+{
+	HashAggEntry *entry = NULL;
+
+	switch(input_type)
+	{
+		case INPUT_RECORD_TUPLE:
+			entry = makeHashAggEntryForInput(aggstate, (TupleTableSlot *)input_record, hashkey);
+			break;
+		case INPUT_RECORD_GROUP_AND_AGGS:
+			entry = makeHashAggEntryForGroup(aggstate, input_record, input_size, hashkey);
+			break;
+		default:
+			insist_log(false, "invalid record type %d", input_type);
+	}
+
+	return entry;
+}
+
 /*
  * Function: lookup_agg_hash_entry
  *
@@ -434,20 +553,27 @@ lookup_agg_hash_entry(AggState *aggstate,
 {
 	HashAggEntry *entry;
 	HashAggTable *hashtable = aggstate->hhashtable;
-	MemTupleBinding *mt_bind = aggstate->hashslot->tts_mt_bind;
 	ExprContext *tmpcontext = aggstate->tmpcontext; /* per input tuple context */
-	Agg *agg = (Agg*)aggstate->ss.ps.plan;
 	MemoryContext oldcxt;
 	unsigned int bucket_idx;
 	uint64 bloomval;			/* bloom filter value */
    
-	Assert(mt_bind != NULL);
+	Assert(aggstate->hashslot->tts_mt_bind != NULL);
 	Assert(parent_hash_bit == hashtable->pshift);
 
 	if (p_isnew != NULL)
 		*p_isnew = false;
 
 	oldcxt = MemoryContextSwitchTo(tmpcontext->ecxt_per_tuple_memory);
+
+	if (hashtable->open_addressing)
+	{
+		entry = lookup_agg_hash_slot(aggstate, input_record, input_type,
+									 input_size, hashkey, p_isnew);
+		(void) MemoryContextSwitchTo(oldcxt);
+		return entry;
+	}
+
 	bucket_idx = BUCKET_IDX(hashtable, hashkey);
 	bloomval = BLOOMVAL(hashkey);
 	entry = (0 == (hashtable->bloom[bucket_idx] & bloomval) ? NULL :
@@ -461,48 +587,10 @@ lookup_agg_hash_entry(AggState *aggstate,
 	 */
 	while (entry != NULL)
 	{
-		MemTuple mtup = (MemTuple) entry->tuple_and_aggs;
-		int i;
-		bool match = true;
-
-		if (hashkey != entry->hashvalue)
-		{
-			entry = entry->next;
-			continue;
-		}
-		
-		for (i = 0; match && i < agg->numCols; i++)
-		{
-			AttrNumber	att = agg->grpColIdx[i];
-			Datum input_datum = 0;
-			Datum entry_datum = 0;
-			bool input_isNull = false;
-			bool entry_isNull = false;
-				
-			switch(input_type)
-			{
-				case INPUT_RECORD_TUPLE:
-					input_datum = slot_getattr((TupleTableSlot *)input_record, att, &input_isNull);
-					break;
-				case INPUT_RECORD_GROUP_AND_AGGS:
-					input_datum = memtuple_getattr((MemTuple)input_record, mt_bind, att, &input_isNull);
-					break;
-				default:
-					insist_log(false, "invalid record type %d", input_type);
-			}
-
-			entry_datum = memtuple_getattr(mtup, mt_bind, att, &entry_isNull);
-
-			if ( !input_isNull && !entry_isNull &&
-				 (DatumGetBool(FunctionCall2(&aggstate->eqfunctions[i],
-											 input_datum,
-											 entry_datum)) ) )
-				continue; /* Both non-NULL and equal. */
-			match = (input_isNull && entry_isNull);/* NULLs match in group keys. */
-		}
-		
 		/* Break if found an existing matching entry. */
-		if (match)
+		if (hashkey == entry->hashvalue &&
+			groupKeysMatch(aggstate, input_record, input_type,
+						   (MemTuple) entry->tuple_and_aggs))
 			break;
 
 		entry = entry->next;
@@ -511,17 +599,8 @@ lookup_agg_hash_entry(AggState *aggstate,
 	if (entry == NULL)
 	{
 		/* Create a new matching entry. */
-		switch(input_type)
-		{
-			case INPUT_RECORD_TUPLE:
-				entry = makeHashAggEntryForInput(aggstate, (TupleTableSlot *)input_record, hashkey);
-				break;
-			case INPUT_RECORD_GROUP_AND_AGGS:
-				entry = makeHashAggEntryForGroup(aggstate, input_record, input_size, hashkey);
-				break;
-			default:
-				insist_log(false, "invalid record type %d", input_type);
-		}
+		entry = makeHashAggEntry(aggstate, input_record, input_type,
+								 input_size, hashkey);
 			
 		if (entry != NULL)
 		{
@@ -553,6 +632,117 @@ lookup_agg_hash_entry(AggState *aggstate,
 	return entry;
 }
 
+/*
+ * Function: lookup_agg_hash_slot
+ *
+ * lookup_agg_hash_entry for the open-addressing table. The probe starts at
+ * the SLOT_IDX of the hash key and scans the slots linearly up to a free
+ * one. The hash values, and the inline grouping keys, kept in the slots
+ * are compared with the input before any entry is, so that the slots of
+ * other groups cost no access to their entries.
+ *
+ * Returns NULL if there is no matching entry and no room to create one,
+ * be it memory for the entry, or a free slot once the table cannot grow.
+ */
+static HashAggEntry *
+lookup_agg_hash_slot(AggState *aggstate, void *input_record,
+					 InputRecordType input_type, int32 input_size,
+					 uint32 hashkey, bool *p_isnew)
+{
+	HashAggTable *hashtable = aggstate->hhashtable;
+	Agg *agg = (Agg*)aggstate->ss.ps.plan;
+	HashAggSlot *slot;
+	HashAggEntry *entry;
+	Datum input_key = 0;
+	bool input_isnull = false;
+	uint32 idx;
+
+	if (hashtable->inline_key)
+		input_key = getInputAttr(aggstate, input_record, input_type,
+								 agg->grpColIdx[0], &input_isnull);
+
+	for (idx = SLOT_IDX(hashtable, hashkey); ;
+		 idx = (idx + 1) & (hashtable->nslots - 1))
+	{
+		slot = &hashtable->slots[idx];
+
+		if (slot->entry == NULL)
+			break;
+		if (slot->hashvalue != hashkey)
+			continue;
+
+		if (hashtable->inline_key)
+		{
+			if (slot->keyisnull ? input_isnull :
+				(!input_isnull && slot->key == input_key))
+				return slot->entry;
+		}
+		else if (groupKeysMatch(aggstate, input_record, input_type,
+								(MemTuple) slot->entry->tuple_and_aggs))
+			return slot->entry;
+	}
+
+	/* No matching entry: slot is the free one where the new entry goes. */
+	if (hashtable->num_entries >= SLOTS_MAX_ENTRIES(hashtable))
+	{
+		if (!hashtable->expandable || !expand_agg_hash_slots(aggstate))
+			return NULL;
+
+		for (idx = SLOT_IDX(hashtable, hashkey);
+			 hashtable->slots[idx].entry != NULL;
+			 idx = (idx + 1) & (hashtable->nslots - 1))
+			;
+		slot = &hashtable->slots[idx];
+	}
+
+	entry = makeHashAggEntry(aggstate, input_record, input_type,
+							 input_size, hashkey);
+	if (entry == NULL)
+		return NULL;
+
+	slot->entry = entry;
+	slot->hashvalue = hashkey;
+	slot->keyisnull = input_isnull;
+	slot->key = input_key;
+
+	hashtable->num_ht_groups++;
+	hashtable->num_entries++;
+
+	*p_isnew = true; /* created a new entry */
+
+	return entry;
+}
+
+/*
+ * Function: agg_hash_key_inlinable
+ *
+ * Whether the grouping key can be kept in the slots of the open-addressing
+ * table: a single column of a pass-by-value type, whose equality is that of
+ * its Datums.
+ */
+static bool
+agg_hash_key_inlinable(AggState *aggstate)
+{
+	Agg *agg = (Agg*)aggstate->ss.ps.plan;
+
+	if (agg->numCols != 1)
+		return false;
+
+	switch (aggstate->eqfunctions[0].fn_oid)
+	{
+		case F_BOOLEQ:
+		case F_CHAREQ:
+		case F_INT2EQ:
+		case F_INT4EQ:
+		case F_INT8EQ:
+		case F_OIDEQ:
+		case F_DATE_EQ:
+			return true;
+		default:
+			return false;
+	}
+}
+
 /* Function: calcHashAggTableSizes
  *
  * Check if the current memory quota is enough to handle the aggregation
@@ -790,8 +980,25 @@ create_agg_hash_table(AggState *aggstate)
 	/* Initialize the hash buckets */
 	hashtable->nbuckets = hashtable->hats.nbuckets;
 	hashtable->total_buckets = hashtable->nbuckets;
-	hashtable->buckets = (HashAggEntry **)palloc0(hashtable->nbuckets * sizeof(HashAggEntry *));
-	hashtable->bloom = (uint64 *)palloc0(hashtable->nbuckets * sizeof(uint64));
+	hashtable->open_addressing = gp_hashagg_linear_probing;
+	if (hashtable->open_addressing)
+	{
+		/* Start with two slots per bucket; the slots grow as they fill up */
+		hashtable->nslots = MIN_NSLOTS;
+		hashtable->slot_shift = MIN_NSLOTS_SHIFT;
+		while (hashtable->nslots / 2 < hashtable->nbuckets)
+		{
+			hashtable->nslots *= 2;
+			hashtable->slot_shift--;
+		}
+		hashtable->slots = (HashAggSlot *)palloc0(hashtable->nslots * sizeof(HashAggSlot));
+		hashtable->inline_key = agg_hash_key_inlinable(aggstate);
+	}
+	else
+	{
+		hashtable->buckets = (HashAggEntry **)palloc0(hashtable->nbuckets * sizeof(HashAggEntry *));
+		hashtable->bloom = (uint64 *)palloc0(hashtable->nbuckets * sizeof(uint64));
+	}
 
 	hashtable->pshift = 0;
 	hashtable->expandable = true;
@@ -814,9 +1021,12 @@ create_agg_hash_table(AggState *aggstate)
 
 	hashtable->max_mem = 1024.0 * operatorMemKB;
 	hashtable->mem_for_metadata = sizeof(HashAggTable)
-		+ hashtable->nbuckets * sizeof(HashAggEntry *)
-		+ hashtable->nbuckets * sizeof(uint64)
 		+ sizeof(GroupKeysAndAggs);
+	if (hashtable->open_addressing)
+		hashtable->mem_for_metadata += hashtable->nslots * sizeof(HashAggSlot);
+	else
+		hashtable->mem_for_metadata += hashtable->nbuckets * sizeof(HashAggEntry *)
+			+ hashtable->nbuckets * sizeof(uint64);
 	hashtable->mem_wanted = hashtable->mem_for_metadata;
 	hashtable->mem_used = hashtable->mem_for_metadata;
 
@@ -912,6 +1122,13 @@ agg_hash_initial_pass(AggState *aggstate)
 	 */
 	hashtable->pass = 0;
 
+	/*
+	 * Let the runaway cleaner ask us to spill rather than cancel the query.
+	 * A streaming hash table doesn't spill, it streams out its groups anyway.
+	 */
+	if (!streaming)
+		RunawayCleaner_RegisterSpillCallback(agg_hash_request_spill, hashtable);
+
 	while(true)
 	{
 		HashKey hashkey;
@@ -927,6 +1144,21 @@ agg_hash_initial_pass(AggState *aggstate)
 
 		Gpmon_M_Incr(GpmonPktFromAggState(aggstate), GPMON_QEXEC_M_ROWSIN);
 
+		if (hashtable->spill_requested)
+		{
+			hashtable->spill_requested = false;
+
+			if (GET_TOTAL_USED_SIZE(hashtable) > hashtable->mem_used)
+				hashtable->mem_used = GET_TOTAL_USED_SIZE(hashtable);
+
+			/* CDB: Report statistics for EXPLAIN ANALYZE. */
+			if (!hashtable->is_spilling && aggstate->ss.ps.instrument)
+				agg_hash_table_stat_upd(hashtable);
+
+			elog(HHA_MSG_LVL, "HashAgg: spilling on request of the runaway cleaner");
+			spill_hash_table(aggstate);
+		}
+
 		if (aggstate->hashslot->tts_tupleDescriptor == NULL)
 		{
 			int size;
@@ -950,7 +1182,18 @@ agg_hash_initial_pass(AggState *aggstate)
 		hashkey = calc_hash_value(aggstate, outerslot);
 		entry = lookup_agg_hash_entry(aggstate, (void *)outerslot,
 									  INPUT_RECORD_TUPLE, 0, hashkey, 0, &isNew);
-		
+
+		/*
+		 * Before the first spill, try to take the free memory of the segment
+		 * rather than spilling.
+		 */
+		if (entry == NULL && !streaming && !hashtable->is_spilling &&
+			grow_hash_table_mem(hashtable))
+		{
+			entry = lookup_agg_hash_entry(aggstate, (void *)outerslot,
+										  INPUT_RECORD_TUPLE, 0, hashkey, 0, &isNew);
+		}
+
 		if (entry == NULL)
 		{
 			if (GET_TOTAL_USED_SIZE(hashtable) > hashtable->mem_used)
@@ -969,6 +1212,7 @@ agg_hash_initial_pass(AggState *aggstate)
 			{
 				Assert(tuple_remaining);
 				hashtable->prev_slot = outerslot;
+				check_stream_reduction(aggstate);
 				break;
 			}
 
@@ -1005,6 +1249,7 @@ agg_hash_initial_pass(AggState *aggstate)
 		{
 			Assert(tuple_remaining);
 			ExecClearTuple(aggstate->hashslot);
+			check_stream_reduction(aggstate);
 			break;
 		}
 
@@ -1012,6 +1257,10 @@ agg_hash_initial_pass(AggState *aggstate)
 		outerslot = ExecProcNode(outerPlanState(aggstate));
 	}
 
+	if (!streaming)
+		RunawayCleaner_UnregisterSpillCallback(agg_hash_request_spill, hashtable);
+	hashtable->spill_requested = false;
+
 	if (GET_TOTAL_USED_SIZE(hashtable) > hashtable->mem_used)
 		hashtable->mem_used = GET_TOTAL_USED_SIZE(hashtable);
 
@@ -1300,6 +1549,8 @@ obtain_spill_set(HashAggTable *hashtable)
 		{
 			hashtable->curr_spill_file->spill_set->level =
 				hashtable->curr_spill_file->parent_spill_set->level + 1;
+			hashtable->max_spill_level = Max(hashtable->max_spill_level,
+				hashtable->curr_spill_file->spill_set->level);
 			hashtable->curr_spill_file->spill_set->parent_spill_file =
 				hashtable->curr_spill_file;
 		}
@@ -1424,6 +1675,73 @@ read_spill_set(AggState *aggstate)
  * write bucket 1, (#batches + 1), (2 * #batches + 1), ... to the batch 1;
  * and etc.
  */
+/*
+ * Function: spillHashEntry
+ *
+ * Write a hash entry to the given spill file.
+ */
+static inline void
+spillHashEntry(AggState *aggstate, SpillFile *spill_file, HashAggEntry *entry)
+{
+	HashAggTable *hashtable = aggstate->hhashtable;
+	int32 written_bytes;
+
+	written_bytes = writeHashEntry(aggstate, spill_file->file_info, entry);
+	spill_file->file_info->ntuples++;
+	spill_file->file_info->total_bytes += written_bytes;
+
+	hashtable->num_spill_groups++;
+
+	Gpmon_M_Incr(GpmonPktFromAggState(aggstate), GPMON_AGG_SPILLTUPLE);
+	Gpmon_M_Add(GpmonPktFromAggState(aggstate), GPMON_AGG_SPILLBYTE, written_bytes);
+
+	Gpmon_M_Incr(GpmonPktFromAggState(aggstate), GPMON_AGG_CURRSPILLPASS_TUPLE);
+	Gpmon_M_Add(GpmonPktFromAggState(aggstate), GPMON_AGG_CURRSPILLPASS_BYTE, written_bytes);
+}
+
+/*
+ * Function: grow_hash_table_mem
+ *
+ * Grow the memory of the hash table beyond its quota from the free memory
+ * of the segment. Returns false if the hash table should spill.
+ */
+static bool
+grow_hash_table_mem(HashAggTable *hashtable)
+{
+	int64 growth = VmemTracker_GetOperatorMemoryGrowth((int64) hashtable->max_mem,
+													   (int64) hashtable->mem_grown);
+	if (growth <= 0)
+		return false;
+
+	hashtable->max_mem += growth;
+	hashtable->mem_grown += growth;
+
+	elog(DEBUG1, "HashAgg: grow memory of hash table to %.0f bytes "
+		 "with %.0f bytes beyond quota",
+		 hashtable->max_mem, hashtable->mem_grown);
+
+	return true;
+}
+
+/*
+ * Function: agg_hash_request_spill
+ *
+ * Spill callback of the runaway cleaner, registered during the initial pass:
+ * the next input tuple spills the groups in the hash table. Once spilling,
+ * the hash table doesn't grow beyond its quota anymore.
+ */
+static bool
+agg_hash_request_spill(void *arg)
+{
+	HashAggTable *hashtable = (HashAggTable *) arg;
+
+	if (hashtable->num_entries == 0)
+		return false;
+
+	hashtable->spill_requested = true;
+	return true;
+}
+
 static void
 spill_hash_table(AggState *aggstate)
 {
@@ -1442,7 +1760,7 @@ spill_hash_table(AggState *aggstate)
 	/* Spill set does not have a workfile_set. Use existing or create new one as needed */
 	if (hashtable->work_set == NULL)
 	{
-		hashtable->work_set = workfile_mgr_create_set(BFZ, true /* can_be_reused */, &aggstate->ss.ps, NULL_SNAPSHOT);
+		hashtable->work_set = workfile_mgr_create_set(BFZ, true /* can_be_reused */, &aggstate->ss.ps, workfile_mgr_snapshot(&aggstate->ss.ps));
 		hashtable->work_set->metadata.buckets = hashtable->nbuckets;
 		if (gp_workfile_caching)
 		{
@@ -1481,6 +1799,10 @@ spill_hash_table(AggState *aggstate)
 			CheckSendPlanStateGpmonPkt(&aggstate->ss.ps);
 		}
 
+		/* The slots are written in a single pass below. */
+		if (hashtable->open_addressing)
+			continue;
+
 		for (bucket_no = file_no; bucket_no < hashtable->nbuckets;
 			 bucket_no += spill_set->num_spill_files)
 		{
@@ -1496,25 +1818,34 @@ spill_hash_table(AggState *aggstate)
 				entry = spill_entry->next;
 
 				if (spill_entry != NULL)
-				{
-					int32 written_bytes;
-					
-					written_bytes = writeHashEntry(aggstate, spill_file->file_info, spill_entry);
-					spill_file->file_info->ntuples++;
-					spill_file->file_info->total_bytes += written_bytes;
+					spillHashEntry(aggstate, spill_file, spill_entry);
+			}
 
-					hashtable->num_spill_groups++;
+			hashtable->buckets[bucket_no] = NULL;
+		}
+	}
 
-					Gpmon_M_Incr(GpmonPktFromAggState(aggstate), GPMON_AGG_SPILLTUPLE);
-					Gpmon_M_Add(GpmonPktFromAggState(aggstate), GPMON_AGG_SPILLBYTE, written_bytes);
+	/*
+	 * An entry goes to the spill file of the buckets it would be in, in the
+	 * chained table.
+	 */
+	if (hashtable->open_addressing)
+	{
+		unsigned slot_no;
 
-					Gpmon_M_Incr(GpmonPktFromAggState(aggstate), GPMON_AGG_CURRSPILLPASS_TUPLE);
-					Gpmon_M_Add(GpmonPktFromAggState(aggstate), GPMON_AGG_CURRSPILLPASS_BYTE, written_bytes);
-				}
-			}
+		for (slot_no = 0; slot_no < hashtable->nslots; slot_no++)
+		{
+			HashAggEntry *entry = hashtable->slots[slot_no].entry;
 
-			hashtable->buckets[bucket_no] = NULL;
+			if (entry == NULL)
+				continue;
+
+			file_no = (entry->hashvalue >> hashtable->pshift) %
+				spill_set->num_spill_files;
+			spillHashEntry(aggstate, &spill_set->spill_files[file_no], entry);
 		}
+
+		MemSet(hashtable->slots, 0, hashtable->nslots * sizeof(HashAggSlot));
 	}
 
 	/* Reset the buffer */
@@ -1611,6 +1942,63 @@ expand_hash_table(AggState *aggstate)
 }
 
 
+/*
+ * Function: expand_agg_hash_slots
+ *
+ * Double the slots of the open-addressing table, and rehash its entries.
+ * Returns false, and marks the table not expandable, if there is not
+ * enough memory for them.
+ */
+static bool
+expand_agg_hash_slots(AggState *aggstate)
+{
+	HashAggTable *hashtable = aggstate->hhashtable;
+	HashAggSlot *old_slots = hashtable->slots;
+	unsigned old_nslots = hashtable->nslots;
+	double mem_needed = (double) old_nslots * sizeof(HashAggSlot);
+	unsigned i;
+
+	/* The new slots are allocated before the old ones are freed */
+	if (2 * mem_needed > AVAIL_MEM(hashtable) || hashtable->slot_shift <= 1)
+	{
+		elog(HHA_MSG_LVL, "HashAgg: cannot grow the number of slots!");
+		elog(HHA_MSG_LVL, "HashAgg: mem needed = %.0f available = %.0f; nslots = %u",
+			 2 * mem_needed, AVAIL_MEM(hashtable), hashtable->nslots);
+		hashtable->expandable = false;
+		return false;
+	}
+	elog(HHA_MSG_LVL, "Growing the hash table to %u slots with " INT64_FORMAT " entries",
+		 hashtable->nslots * 2, hashtable->num_entries);
+
+	hashtable->nslots *= 2;
+	hashtable->slot_shift--;
+	hashtable->mem_for_metadata += mem_needed;
+	hashtable->mem_wanted = Max(hashtable->mem_wanted, hashtable->mem_for_metadata);
+
+	hashtable->slots = (HashAggSlot *)
+		MemoryContextAllocZero(GetMemoryChunkContext(old_slots),
+							   hashtable->nslots * sizeof(HashAggSlot));
+
+	for (i = 0; i < old_nslots; i++)
+	{
+		uint32 idx;
+
+		if (old_slots[i].entry == NULL)
+			continue;
+
+		for (idx = SLOT_IDX(hashtable, old_slots[i].hashvalue);
+			 hashtable->slots[idx].entry != NULL;
+			 idx = (idx + 1) & (hashtable->nslots - 1))
+			;
+		hashtable->slots[idx] = old_slots[i];
+	}
+
+	pfree(old_slots);
+	hashtable->num_expansions++;
+
+	return true;
+}
+
 /*
  * Create and open state file holding metadata. Used for workfile re-using.
  */
@@ -1725,6 +2113,25 @@ agg_hash_table_stat_upd(HashAggTable *ht)
 
     char hostname[SEGMENT_IDENTITY_NAME_LENGTH];
     gethostname(hostname,SEGMENT_IDENTITY_NAME_LENGTH);
+
+    /* The chains of an open-addressing table are its runs of used slots */
+    if (ht->open_addressing)
+    {
+        int             runlength = 0;
+
+        for (i = 0; i <= ht->nslots; i++)
+        {
+            if (i < ht->nslots && ht->slots[i].entry != NULL)
+                runlength++;
+            else if (runlength > 0)
+            {
+                cdbexplain_agg_upd(&ht->chainlength, runlength, i - runlength, hostname);
+                runlength = 0;
+            }
+        }
+        return;
+    }
+
     for (i = 0; i < ht->nbuckets; i++)
     {
         HashAggEntry   *entry = ht->buckets[i];
@@ -1745,7 +2152,8 @@ agg_hash_table_stat_upd(HashAggTable *ht)
  * Initialize the HashAggTable's (one and only) entry iterator. */
 void init_agg_hash_iter(HashAggTable* hashtable)
 {
-	Assert( hashtable != NULL && hashtable->buckets != NULL && hashtable->nbuckets > 0 );
+	Assert( hashtable != NULL && (hashtable->open_addressing ? hashtable->slots != NULL :
+		   (hashtable->buckets != NULL && hashtable->nbuckets > 0)) );
 	
 	hashtable->curr_bucket_idx = -1;
 	hashtable->next_entry = NULL;
@@ -1768,14 +2176,26 @@ agg_hash_iter(AggState *aggstate)
 	SpillSet *spill_set = hashtable->spill_set;
 	MemoryContext oldcxt;
 
-	Assert( hashtable != NULL && hashtable->buckets != NULL && hashtable->nbuckets > 0 );
+	Assert( hashtable != NULL && (hashtable->open_addressing ? hashtable->slots != NULL :
+		   (hashtable->buckets != NULL && hashtable->nbuckets > 0)) );
 
 	if (hashtable->curr_spill_file != NULL)
 		spill_set = hashtable->curr_spill_file->spill_set;
 	
 	oldcxt = MemoryContextSwitchTo(hashtable->entry_cxt);
 
-	while (entry == NULL &&
+	while (entry == NULL && hashtable->open_addressing &&
+		   hashtable->nslots > ++ hashtable->curr_bucket_idx)
+	{
+		entry = hashtable->slots[hashtable->curr_bucket_idx].entry;
+		if (entry != NULL)
+		{
+			Assert(entry->is_primodial);
+			break;
+		}
+	}
+
+	while (entry == NULL && !hashtable->open_addressing &&
 		   hashtable->nbuckets > ++ hashtable->curr_bucket_idx)
 	{
 		entry = hashtable->buckets[hashtable->curr_bucket_idx];
@@ -1847,6 +2267,48 @@ readHashEntry(AggState *aggstate, BatchFileInfo *file_info,
 	return tuple_and_aggs;
 }
 
+/*
+ * Called when a streaming hash table is full.  If its groups merged less than
+ * gp_hashagg_stream_min_reduction of the input tuples since it was reset, the
+ * upper stage gains little from this one, so the rest of the input tuples are
+ * passed through as groups of their own rather than looked up in the hash
+ * table.
+ *
+ * Aggregates with an ORDER BY or DISTINCT, and grouping extensions, are not
+ * passed through.
+ */
+static void
+check_stream_reduction(AggState *aggstate)
+{
+	HashAggTable *hashtable = aggstate->hhashtable;
+	Agg		   *agg = (Agg *) aggstate->ss.ps.plan;
+	uint64		ntuples = hashtable->num_tuples - hashtable->fill_first_tuple;
+	int			aggno;
+
+	Assert(agg->streaming);
+
+	if (gp_hashagg_stream_min_reduction <= 0 || ntuples == 0 ||
+		agg->inputHasGrouping)
+		return;
+
+	if ((double) hashtable->num_ht_groups / ntuples <=
+		1.0 - gp_hashagg_stream_min_reduction)
+		return;
+
+	for (aggno = 0; aggno < aggstate->numaggs; aggno++)
+	{
+		if (aggstate->peragg[aggno].numSortCols > 0)
+			return;
+	}
+
+	elog(HHA_MSG_LVL,
+		 "HashAgg: " INT64_FORMAT " groups from " INT64_FORMAT
+		 " tuples, passing the rest of the tuples through",
+		 hashtable->num_ht_groups, ntuples);
+
+	hashtable->passthrough = true;
+}
+
 /* Function: agg_hash_stream
  *
  * Call agg_hash_initial_pass (again) to load more input tuples
@@ -1854,6 +2316,9 @@ readHashEntry(AggState *aggstate, BatchFileInfo *file_info,
  * of a multiphase hashed aggregation to avoid spilling to 
  * file.
  *
+ * Once the hash table passes tuples through, it is left empty and
+ * agg_hash_passthrough() returns the rest of the input tuples.
+ *
  * Return true, if all input tuples have been consumed, else
  * return false (call me again).
  */
@@ -1866,10 +2331,75 @@ agg_hash_stream(AggState *aggstate)
 		"HashAgg: streaming");
 
 	reset_agg_hash_table(aggstate);
+
+	if (aggstate->hhashtable->passthrough)
+		return true;
 	
 	return agg_hash_initial_pass(aggstate);
 }
 
+/* Function: agg_hash_passthrough
+ *
+ * Read the next input tuple of a hash table that passes tuples through,
+ * and compute its aggregates as a group of its own into pergroup.
+ *
+ * Return the input tuple, or NULL if all input tuples have been consumed.
+ */
+TupleTableSlot *
+agg_hash_passthrough(AggState *aggstate, AggStatePerGroup pergroup)
+{
+	HashAggTable *hashtable = aggstate->hhashtable;
+	ExprContext *tmpcontext = aggstate->tmpcontext;
+	TupleTableSlot *outerslot;
+
+	Assert(hashtable->passthrough);
+
+	/* The tuple the full hash table had no room for is already counted in. */
+	if (hashtable->prev_slot != NULL)
+	{
+		outerslot = hashtable->prev_slot;
+		hashtable->prev_slot = NULL;
+	}
+	else
+	{
+		outerslot = ExecProcNode(outerPlanState(aggstate));
+		if (TupIsNull(outerslot))
+		{
+			/* CDB: Report statistics for EXPLAIN ANALYZE. */
+			if (aggstate->ss.ps.instrument)
+				appendStringInfo(aggstate->ss.ps.cdbexplainbuf,
+								 INT64_FORMAT " of " INT64_FORMAT
+								 " input rows passed through without aggregation.\n",
+								 hashtable->num_passthru_tuples,
+								 hashtable->num_tuples);
+			return NULL;
+		}
+
+		Gpmon_M_Incr(GpmonPktFromAggState(aggstate), GPMON_QEXEC_M_ROWSIN);
+	}
+
+	/*
+	 * The transition values of the previous tuples have been returned, free
+	 * them once they take some room.
+	 */
+	if (mpool_total_bytes_allocated(hashtable->group_buf) > PASSTHROUGH_MPOOL_RESET_SIZE)
+		mpool_reset(hashtable->group_buf);
+	ResetExprContext(tmpcontext);
+
+	MemSet(pergroup, 0, aggstate->numaggs * sizeof(AggStatePerGroupData));
+	initialize_aggregates(aggstate, aggstate->peragg, pergroup,
+						  &(aggstate->mem_manager));
+
+	tmpcontext->ecxt_scantuple = outerslot;
+	advance_aggregates(aggstate, pergroup, &(aggstate->mem_manager));
+
+	hashtable->num_tuples++;
+	hashtable->num_passthru_tuples++;
+	hashtable->num_output_groups++;
+
+	return outerslot;
+}
+
 /*
  * Function: agg_hash_load
  *
@@ -2305,11 +2835,17 @@ void reset_agg_hash_table(AggState *aggstate)
 		"HashAgg: resetting " INT64_FORMAT "-entry hash table",
 		hashtable->num_ht_groups);
 	
-	MemSet(hashtable->buckets, 0, hashtable->nbuckets * sizeof(HashAggEntry*));
-	MemSet(hashtable->bloom, 0, hashtable->nbuckets * sizeof(uint64));
+	if (hashtable->open_addressing)
+		MemSet(hashtable->slots, 0, hashtable->nslots * sizeof(HashAggSlot));
+	else
+	{
+		MemSet(hashtable->buckets, 0, hashtable->nbuckets * sizeof(HashAggEntry*));
+		MemSet(hashtable->bloom, 0, hashtable->nbuckets * sizeof(uint64));
+	}
 	hashtable->num_ht_groups = 0;
 	hashtable->num_entries = 0;
 	hashtable->pshift = 0;
+	hashtable->fill_first_tuple = hashtable->num_tuples;
 
 	CdbCellBuf_Reset(&(hashtable->entry_buf));
 	mpool_reset(hashtable->group_buf);
@@ -2346,8 +2882,13 @@ void destroy_agg_hash_table(AggState *aggstate)
 		reset_agg_hash_table(aggstate);
 
 		/* destroy_batches(aggstate->hhashtable); */
-		pfree(aggstate->hhashtable->buckets);
-		pfree(aggstate->hhashtable->bloom);
+		if (aggstate->hhashtable->open_addressing)
+			pfree(aggstate->hhashtable->slots);
+		else
+		{
+			pfree(aggstate->hhashtable->buckets);
+			pfree(aggstate->hhashtable->bloom);
+		}
 		if (aggstate->hhashtable->hashkey_buf)
 			pfree(aggstate->hhashtable->hashkey_buf);
 
@@ -2356,6 +2897,11 @@ void destroy_agg_hash_table(AggState *aggstate)
 		if (NULL != aggstate->hhashtable->work_set)
 		{
 			agg_hash_close_state_file(aggstate->hhashtable);
+			workfile_mgr_report_spill(aggstate->hhashtable->work_set,
+									  aggstate->ss.ps.instrument,
+									  aggstate->hhashtable->num_batches,
+									  aggstate->hhashtable->max_spill_level,
+									  (int64) aggstate->hhashtable->mem_wanted);
 			workfile_mgr_close_set(aggstate->hhashtable->work_set);
 		}
 
@@ -119,6 +119,7 @@
 #include "cdb/dispatcher_new.h"
 #include "cdb/cdbexplain.h"             /* cdbexplain_sendExecStats() */
 #include "cdb/cdbplan.h"
+#include "cdb/cdbsampler.h"
 #include "cdb/cdbsrlz.h"
 #include "cdb/cdbsubplan.h"
 #include "cdb/cdbvars.h"
@@ -529,6 +530,10 @@ ExecutorStart(QueryDesc *queryDesc, int eflags)
         estate->es_crosscheck_snapshot = queryDesc->crosscheck_snapshot;
         estate->es_instrument = queryDesc->doInstrument;
         estate->showstatctx = queryDesc->showstatctx;
+        if (estate->es_instrument || gp_query_metrics_port > 0)
+            MemSet(&pgWaitUsage, 0, sizeof(pgWaitUsage));
+        if (gp_profile_sample_hz > 0 && Gp_role == GP_ROLE_EXECUTE)
+            cdbsampler_start(queryDesc);
         
         /*
          * Shared input info is needed when ROLE_EXECUTE or sequential plan
@@ -667,6 +672,8 @@ ExecutorStart(QueryDesc *queryDesc, int eflags)
                 /* Should we collect statistics for EXPLAIN ANALYZE? */
                 estate->es_instrument = sliceTable->doInstrument;
                 queryDesc->doInstrument = sliceTable->doInstrument;
+                if (estate->es_instrument)
+                    MemSet(&pgWaitUsage, 0, sizeof(pgWaitUsage));
             }
             
             /* InitPlan() will acquire locks by walking the entire plan
@@ -1542,6 +1549,11 @@ ExecutorEnd(QueryDesc *queryDesc)
 		queryDesc->gpmon_pkt = NULL;
 	}
 
+	if (gp_query_metrics_port > 0 && Gp_role == GP_ROLE_DISPATCH)
+		gpmon_export_query_metrics("done", queryDesc->es_processed);
+
+	cdbsampler_stop(queryDesc);
+
 	/* Reset queryDesc fields that no longer point to anything */
 	queryDesc->tupDesc = NULL;
 	queryDesc->estate = NULL;
@@ -117,6 +117,11 @@ BeginScanParquetRelation(ScanState *scanState)
 	/* push down Bloom filter */
 	node->opaque->scandesc->rfState = scanState->runtimeFilter;
 
+	/* push down the qual clauses checked against the row group statistics */
+	node->opaque->scandesc->rowGroupFilter = ParquetRowGroupReader_BuildFilter(
+			node->ss.ps.plan->qual,
+			RelationGetDescr(node->ss.ss_currentRelation));
+
 	node->opaque->scandesc->splits = scanState->splits;
 	node->ss.scan_state = SCAN_SCAN;
 }
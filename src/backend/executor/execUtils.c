@@ -84,6 +84,7 @@
 #include "cdb/cdbdispatchresult.h"
 #include "cdb/ml_ipc.h"
 #include "cdb/cdbmotion.h"
+#include "cdb/cdbsampler.h"
 #include "cdb/cdbsreh.h"
 #include "cdb/memquota.h"
 #include "cdb/cdbsrlz.h"
@@ -428,6 +429,30 @@ FreeExecutorState(EState *estate)
 		MemoryContextDelete(estate->es_query_cxt);
 }
 
+/*
+ * CreatePerTupleMemoryContext
+ *		Create the per-tuple memory context of an ExprContext.
+ *
+ * Per-tuple memory is reset after each tuple and hardly ever pfree'd piece
+ * by piece, so it is served from an ArenaContext unless
+ * gp_enable_arena_memory is off.
+ */
+static MemoryContext
+CreatePerTupleMemoryContext(MemoryContext parent)
+{
+	if (gp_enable_arena_memory)
+		return ArenaContextCreate(parent,
+								  "ExprContext",
+								  ALLOCSET_DEFAULT_INITSIZE,
+								  ALLOCSET_DEFAULT_MAXSIZE);
+
+	return AllocSetContextCreate(parent,
+								 "ExprContext",
+								 ALLOCSET_DEFAULT_MINSIZE,
+								 ALLOCSET_DEFAULT_INITSIZE,
+								 ALLOCSET_DEFAULT_MAXSIZE);
+}
+
 /* ----------------
  *		CreateExprContext
  *
@@ -463,11 +488,7 @@ CreateExprContext(EState *estate)
 	 * Create working memory for expression evaluation in this context.
 	 */
 	econtext->ecxt_per_tuple_memory =
-	    AllocSetContextCreate(estate->es_query_cxt,
-							  "ExprContext",
-							  ALLOCSET_DEFAULT_MINSIZE,
-							  ALLOCSET_DEFAULT_INITSIZE,
-							  ALLOCSET_DEFAULT_MAXSIZE);
+		CreatePerTupleMemoryContext(estate->es_query_cxt);
 
 	econtext->ecxt_param_exec_vals = estate->es_param_exec_vals;
 	econtext->ecxt_param_list_info = estate->es_param_list_info;
@@ -534,11 +555,7 @@ CreateStandaloneExprContext(void)
 	 * Create working memory for expression evaluation in this context.
 	 */
 	econtext->ecxt_per_tuple_memory =
-		AllocSetContextCreate(CurrentMemoryContext,
-							  "ExprContext",
-							  ALLOCSET_DEFAULT_MINSIZE,
-							  ALLOCSET_DEFAULT_INITSIZE,
-							  ALLOCSET_DEFAULT_MAXSIZE);
+		CreatePerTupleMemoryContext(CurrentMemoryContext);
 
 	econtext->ecxt_param_exec_vals = NULL;
 	econtext->ecxt_param_list_info = NULL;
@@ -2286,6 +2303,11 @@ void mppExecutorCleanup(QueryDesc *queryDesc)
 		queryDesc->gpmon_pkt = NULL;
 	}
 
+	if (gp_query_metrics_port > 0 && Gp_role == GP_ROLE_DISPATCH)
+		gpmon_export_query_metrics("error", estate->es_processed);
+
+	cdbsampler_stop(queryDesc);
+
 	/* Workfile manager per-query resource accounting */
 	WorkfileQueryspace_ReleaseEntry();
 
@@ -266,10 +266,13 @@ ExecWorkFile_Write(ExecWorkFile *workfile,
 
 			break;
 		case BFZ:
+			{}
+			bfz_t *bfz_file = (bfz_t *)workfile->file;
+			int64 size_on_disk = 0;
 
 			PG_TRY();
 			{
-				bfz_append((bfz_t *)workfile->file, data, size);
+				bfz_append(bfz_file, data, size);
 			}
 			PG_CATCH();
 			{
@@ -283,13 +286,20 @@ ExecWorkFile_Write(ExecWorkFile *workfile,
 			}
 			PG_END_TRY();
 
-			/* bfz_append always adds to the file size */
-			workfile->size += size;
+			/*
+			 * Account for what the file takes on disk, the compressed blocks
+			 * written and the buffer. It is at most what was reserved, but
+			 * for the few bytes a block of incompressible data or with a
+			 * checksum takes more; these are left to
+			 * ExecWorkFile_AdjustBFZSize when the file is done.
+			 */
+			size_on_disk = Min(bfz_append_size(bfz_file) - workfile->size, size);
+			workfile->size += size_on_disk;
 			if ((workfile->flags & EXEC_WORKFILE_LIMIT_SIZE))
 			{
-				WorkfileDiskspace_Commit(size, size, true /* update_query_size */);
+				WorkfileDiskspace_Commit(size_on_disk, size, true /* update_query_size */);
 			}
-			workfile_update_in_progress_size(workfile, size);
+			workfile_update_in_progress_size(workfile, size_on_disk);
 
 			break;
 		default:
@@ -621,6 +631,25 @@ ExecWorkFile_Restart(ExecWorkFile *workfile)
 	}
 }
 
+/*
+ * Hint that the file is to be read soon, so that the kernel reads it ahead.
+ * Only bfz does something with it.
+ */
+void
+ExecWorkFile_Prefetch(ExecWorkFile *workfile)
+{
+	Assert(workfile != NULL);
+
+	switch(workfile->fileType)
+	{
+	case BFZ:
+		bfz_prefetch((bfz_t *) workfile->file);
+		break;
+	default:
+		break;
+	}
+}
+
 /*
  * Returns the size of the underlying file, as tracked by this API
  */
@@ -729,8 +758,12 @@ ExecWorkFile_AdjustBFZSize(ExecWorkFile *workfile, int64 file_size)
 		/* Actual file on disk is bigger than expected. This can happen when:
 		 *  - added checksums to an uncompressed file
 		 *  - closing empty or very small compressed file (zlib header overhead larger than saved space)
+		 *  - lz4 or zstd file of incompressible data, each block stored as it is
+		 *    after its length
 		 */
-		Assert( (bfz_file->has_checksum && bfz_file->compression_index == 0) || (bfz_file->compression_index > 0 && workfile->size < BFZ_BUFFER_SIZE));
+		Assert( (bfz_file->has_checksum && bfz_file->compression_index == 0) ||
+				(bfz_file->compression_index > 0 && workfile->size < BFZ_BUFFER_SIZE) ||
+				(bfz_file->compression_index > bfz_string_to_compression("zlib")));
 
 		/*
 		 * If we're already under disk full, don't try to reserve, as it will
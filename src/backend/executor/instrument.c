@@ -35,8 +35,11 @@
 #include <unistd.h>
 
 #include "executor/instrument.h"
+#include "cdb/cdbvars.h"
 #include "utils/guc.h"
 
+WaitUsage	pgWaitUsage;
+
 /* Allocate new instrumentation structure(s) */
 Instrumentation *
 InstrAlloc(int n)
@@ -49,14 +52,28 @@ InstrAlloc(int n)
 	return instr;
 }
 
-/* Entry to a plan node */
+/*
+ * Entry to a plan node
+ *
+ * With gp_instrument_timing_sample > 1 only the first entry of a cycle and
+ * every Nth one after it read the clock, and InstrEndLoop scales the time of
+ * the sampled entries up to all of them.
+ */
 void
 InstrStartNode(Instrumentation *instr)
 {
-	if (INSTR_TIME_IS_ZERO(instr->starttime))
-		INSTR_TIME_SET_CURRENT(instr->starttime);
-	else
+	if (!INSTR_TIME_IS_ZERO(instr->starttime))
+	{
 		elog(DEBUG2, "InstrStartNode called twice in a row");
+		return;
+	}
+
+	instr->ncalls += 1;
+	if (instr->running && gp_instrument_timing_sample > 1 &&
+		((uint64) instr->ncalls) % gp_instrument_timing_sample != 0)
+		return;
+
+	INSTR_TIME_SET_CURRENT(instr->starttime);
 }
 
 /* Exit from a plan node */
@@ -70,12 +87,15 @@ InstrStopNode(Instrumentation *instr, double nTuples)
 
 	if (INSTR_TIME_IS_ZERO(instr->starttime))
 	{
-		elog(DEBUG2, "InstrStopNode called without start");
+		/* an entry InstrStartNode did not sample */
+		if (!instr->running || gp_instrument_timing_sample <= 1)
+			elog(DEBUG2, "InstrStopNode called without start");
 		return;
 	}
 
 	INSTR_TIME_SET_CURRENT(endtime);
 	INSTR_TIME_ACCUM_DIFF(instr->counter, endtime, instr->starttime);
+	instr->nsampled += 1;
 
 	/* Is this the first tuple of this cycle? */
 	if (!instr->running)
@@ -105,6 +125,16 @@ InstrEndLoop(Instrumentation *instr)
 	/* Accumulate per-cycle statistics into totals */
 	totaltime = INSTR_TIME_GET_DOUBLE(instr->counter);
 
+	/*
+	 * Scale the sampled entries up to all of them. The first one is always
+	 * timed and often does the startup work of the node, so it is kept out
+	 * of the average.
+	 */
+	if (instr->nsampled > 1 && instr->ncalls > instr->nsampled)
+		totaltime = instr->firsttuple +
+			(totaltime - instr->firsttuple) *
+			(instr->ncalls - 1) / (instr->nsampled - 1);
+
     /* CDB: Report startup time from only the first cycle. */
     if (instr->nloops == 0)
         instr->startup = instr->firsttuple;
@@ -125,4 +155,6 @@ InstrEndLoop(Instrumentation *instr)
 	INSTR_TIME_SET_ZERO(instr->counter);
 	instr->firsttuple = 0;
 	instr->tuplecount = 0;
+	instr->ncalls = 0;
+	instr->nsampled = 0;
 }
@@ -174,6 +174,7 @@ static Bitmapset *find_unaggregated_cols(AggState *aggstate);
 static bool find_unaggregated_cols_walker(Node *node, Bitmapset **colnos);
 static TupleTableSlot *agg_retrieve_direct(AggState *aggstate);
 static TupleTableSlot *agg_retrieve_hash_table(AggState *aggstate);
+static TupleTableSlot *agg_retrieve_hash_passthrough(AggState *aggstate);
 static void ExecAggExplainEnd(PlanState *planstate, struct StringInfoData *buf);
 static int count_extra_agg_slots(Node *node);
 static bool count_extra_agg_slots_walker(Node *node, int *count);
@@ -1080,7 +1081,15 @@ ExecAgg(AggState *node)
 		 */
 		for (;;)
 		{
-			if (!node->hhashtable->is_spilling)
+			if (node->hhashtable->state == HASHAGG_PASSTHROUGH)
+			{
+				tuple = agg_retrieve_hash_passthrough(node);
+				if (tuple != NULL)
+					return tuple;
+
+				node->hhashtable->state = HASHAGG_END_OF_PASSES;
+			}
+			else if (!node->hhashtable->is_spilling)
 			{
 				tuple = agg_retrieve_hash_table(node);
 				node->agg_done = false; /* Not done 'til batches used up. */
@@ -1125,6 +1134,8 @@ ExecAgg(AggState *node)
 					Assert(streaming);
 					if ( !agg_hash_stream(node) )
 						node->hhashtable->state = HASHAGG_END_OF_PASSES;
+					else if ( node->hhashtable->passthrough )
+						node->hhashtable->state = HASHAGG_PASSTHROUGH;
 					continue;
 
 				case HASHAGG_BEFORE_FIRST_PASS:
@@ -1812,6 +1823,44 @@ agg_retrieve_hash_table(AggState *aggstate)
 	return NULL;
 }
 
+/*
+ * ExecAgg for a streaming hashed case that no longer aggregates: return each
+ * input tuple as a group of its own.
+ */
+static TupleTableSlot *
+agg_retrieve_hash_passthrough(AggState *aggstate)
+{
+	ExprContext *econtext = aggstate->ss.ps.ps_ExprContext;
+	Agg		   *node = (Agg *) aggstate->ss.ps.plan;
+	TupleTableSlot *outerslot;
+
+	/* The per-Aggref working state of the tuple passed through */
+	if (aggstate->perpassthru == NULL)
+		aggstate->perpassthru = (AggStatePerGroup)
+			MemoryContextAllocZero(aggstate->ss.ps.state->es_query_cxt,
+								   sizeof(AggStatePerGroupData) * aggstate->numaggs);
+
+	while ((outerslot = agg_hash_passthrough(aggstate, aggstate->perpassthru)) != NULL)
+	{
+		ResetExprContext(econtext);
+
+		finalize_aggregates(aggstate, aggstate->perpassthru);
+
+		econtext->ecxt_scantuple = outerslot;
+		econtext->group_id = node->rollupGSTimes;
+		econtext->grouping = node->grouping;
+
+		if (ExecQual(aggstate->ss.ps.qual, econtext, false))
+		{
+			Gpmon_M_Incr_Rows_Out(GpmonPktFromAggState(aggstate));
+			CheckSendPlanStateGpmonPkt(&aggstate->ss.ps);
+			return ExecProject(aggstate->ss.ps.ps_ProjInfo, NULL);
+		}
+	}
+
+	return NULL;
+}
+
 /*
  * getAggType
  *   Get the aggType for the given Agg node.
@@ -60,8 +60,10 @@
 #include "cdb/cdbvars.h"
 #include "executor/execdebug.h"
 #include "executor/nodeAppend.h"
+#include "executor/nodeExternalscan.h"
 
 static bool exec_append_initialize_next(AppendState *appendstate);
+static void exec_append_open_ahead(AppendState *appendstate);
 
 
 /* ----------------------------------------------------------------
@@ -123,6 +125,31 @@ exec_append_initialize_next(AppendState *appendstate)
 	}
 }
 
+/* ----------------------------------------------------------------
+ *		exec_append_open_ahead
+ *
+ *		Has the subplan after the current one open its external data
+ *		source, so that the external server sends its data while the
+ *		current subplan is read.  Only done once the Append executes: the
+ *		gangs initialize the nodes of every slice, not just their own.
+ * ----------------------------------------------------------------
+ */
+static void
+exec_append_open_ahead(AppendState *appendstate)
+{
+	int			nextplan = appendstate->as_whichplan + 1;
+	PlanState  *subnode;
+
+	appendstate->as_aheadplan = nextplan;
+
+	if (nextplan > appendstate->as_lastplan)
+		return;
+
+	subnode = appendstate->appendplans[nextplan];
+	if (subnode != NULL && IsA(subnode, ExternalScanState))
+		ExecExternalScanOpenAhead((ExternalScanState *) subnode);
+}
+
 static bool append_need_prj(Append *node)
 {
 	ListCell *lc;
@@ -283,6 +310,7 @@ ExecInitAppend(Append *node, EState *estate, int eflags)
 	 * return the result from the first subplan's initialization
 	 */
 	appendstate->as_whichplan = appendstate->as_firstplan;
+	appendstate->as_aheadplan = -1;
 	exec_append_initialize_next(appendstate);
 
 	initGpmonPktForAppend((Plan *)node, &appendstate->ps.gpmon_pkt, estate);
@@ -322,6 +350,11 @@ ExecAppend(AppendState *node)
 
 		Assert(subnode != NULL);
 
+		if (gp_external_open_ahead &&
+			node->as_aheadplan <= node->as_whichplan &&
+			ScanDirectionIsForward(node->ps.state->es_direction))
+			exec_append_open_ahead(node);
+
 		/*
 		 * get a tuple from the subplan
 		 */
@@ -445,6 +478,7 @@ ExecReScanAppend(AppendState *node, ExprContext *exprCtxt)
 		}
 	}
 	node->as_whichplan = node->as_firstplan;
+	node->as_aheadplan = -1;
 	exec_append_initialize_next(node);
 }
 
@@ -210,7 +210,7 @@ static void OpenAOScanRelation(AppendOnlyScanState *node)
 	node->aos_ScanDesc = appendonly_beginscan(
 			node->ss.ss_currentRelation, 
 			node->ss.ps.state->es_snapshot, 
-			0, NULL);
+			0, NULL, NULL);
 	node->ss.scan_state = SCAN_SCAN;
 }
 
@@ -53,7 +53,6 @@
 #include "parser/parsetree.h"
 #include "optimizer/var.h"
 
-static TupleTableSlot *ExternalNext(ExternalScanState *node);
 
 /* ----------------------------------------------------------------
 *						Scan Support
@@ -65,7 +64,7 @@ static TupleTableSlot *ExternalNext(ExternalScanState *node);
 *		This is a workhorse for ExecExtScan
 * ----------------------------------------------------------------
 */
-static TupleTableSlot *
+TupleTableSlot *
 ExternalNext(ExternalScanState *node)
 {
 	FileScanDesc scandesc;
@@ -530,6 +529,28 @@ ExecStopExternalScan(ExternalScanState *node)
 }
 
 
+/* ----------------------------------------------------------------
+*		ExecExternalScanOpenAhead
+*
+*		Opens the external data source of a scan its parent reads next,
+*		so that the data is on its way once the scan is asked for its
+*		first tuple.  Custom formatters open their sources themselves,
+*		and are left alone.
+* ----------------------------------------------------------------
+*/
+void
+ExecExternalScanOpenAhead(ExternalScanState *node)
+{
+	FileScanDesc fileScanDesc = node->ess_ScanDesc;
+
+	if (fileScanDesc == NULL ||
+		fileScanDesc->fs_formatter_type == ExternalTableType_Invalid ||
+		fileScanDesc->fs_formatter_type == ExternalTableType_PLUG)
+		return;
+
+	external_open_ahead(fileScanDesc);
+}
+
 /* ----------------------------------------------------------------
 *						Join Support
 * ----------------------------------------------------------------
@@ -45,6 +45,7 @@
 #include <limits.h>
 
 #include "access/hash.h"
+#include "catalog/pg_type.h"
 #include "executor/execdebug.h"
 #include "executor/hashjoin.h"
 #include "executor/instrument.h"
@@ -59,9 +60,12 @@
 #include "resourcemanager/utils/simplestring.h"
 #include "cdb/cdbexplain.h"
 #include "cdb/cdbvars.h"
+#include "utils/vmem_tracker.h"
 
 static void ExecHashIncreaseNumBatches(HashJoinTable hashtable);
+static bool ExecHashGrowSpaceAllowed(HashJoinTable hashtable);
 static void ExecHashTableExplainEnd(PlanState *planstate, struct StringInfoData *buf);
+static uint64 ExecHashTableMemoryWanted(HashJoinTable hashtable);
 static void
 ExecHashTableExplainBatches(HashJoinTable   hashtable,
                             StringInfo      buf,
@@ -70,6 +74,16 @@ ExecHashTableExplainBatches(HashJoinTable   hashtable,
                             const char     *title);
 static void ExecHashTableReallocBatchData(HashJoinTable hashtable, int new_nbatch);
 static int ExecChoosePrimeNBuckets(int nbuckets);
+static void *ExecHashDenseAlloc(HashJoinTable hashtable, Size size);
+static void ExecHashSpillIfFull(HashState *hashState, HashJoinTable hashtable,
+								HashJoinBatchData *batch);
+static void ExecHashBuildSkewHash(HashJoinTable hashtable, Hash *node);
+static void ExecHashSkewTableInsert(HashState *hashState,
+									HashJoinTable hashtable,
+									TupleTableSlot *slot,
+									uint32 hashvalue,
+									int bucketNumber);
+static void ExecHashRemoveNextSkewBucket(HashJoinTable hashtable);
 
 void ExecChooseHashTableSize(double ntuples, int tupwidth,
 						int *numbuckets,
@@ -83,6 +97,14 @@ void ExecChooseHashTableSize(double ntuples, int tupwidth,
 /* Amount of metadata memory required per bucket */
 #define MD_MEM_PER_BUCKET (sizeof(HashJoinTuple) + sizeof(uint64))
 
+/*
+ * Percentage of the skew memory its buckets may take, and the memory a
+ * bucket takes with its two slots and its place in skewBucketNums.
+ */
+#define SKEW_HASH_MEM_PERCENT 20
+#define SKEW_MEM_PER_BUCKET \
+	(2 * sizeof(HashSkewBucket *) + SKEW_BUCKET_OVERHEAD + sizeof(int))
+
 /* ----------------------------------------------------------------
  *		ExecHash
  *
@@ -137,6 +159,12 @@ MultiExecHash(HashState *node)
             ""); // tableName
 #endif
 
+	/*
+	 * Let the runaway cleaner ask us to spill while we load the hash table,
+	 * rather than cancel the query.
+	 */
+	RunawayCleaner_RegisterSpillCallback(ExecHashRequestSpill, hashtable);
+
 	/*
 	 * get all inner tuples and insert into the hash table (or temp files)
 	 */
@@ -154,7 +182,14 @@ MultiExecHash(HashState *node)
 
 		if (ExecHashGetHashValue(node, hashtable, econtext, hashkeys, node->hs_keepnull, &hashvalue, &hashkeys_null))
 		{
-			ExecHashTableInsert(node, hashtable, slot, hashvalue);
+			int			bucketNumber;
+
+			bucketNumber = ExecHashGetSkewBucket(hashtable, hashvalue);
+			if (bucketNumber != INVALID_SKEW_BUCKET_NO)
+				ExecHashSkewTableInsert(node, hashtable, slot, hashvalue,
+										bucketNumber);
+			else
+				ExecHashTableInsert(node, hashtable, slot, hashvalue);
 			/* Insert hash values into Bloom filter */
 			if (node->hashtable->bloomfilter != NULL && node->hashtable->bloomfilter->isCreated)
 			{
@@ -168,6 +203,7 @@ MultiExecHash(HashState *node)
 			node->hs_hashkeys_null = true;
 			if (node->hs_quit_if_hashkeys_null)
 			{
+				RunawayCleaner_UnregisterSpillCallback(ExecHashRequestSpill, hashtable);
 				ExecSquelchNode(outerNode);
 				return NULL;
 			}
@@ -175,6 +211,9 @@ MultiExecHash(HashState *node)
 
 	}
 
+	RunawayCleaner_UnregisterSpillCallback(ExecHashRequestSpill, hashtable);
+	hashtable->spillRequested = false;
+
 	/* Now we have set up all the initial batches & primary overflow batches. */
 	hashtable->nbatch_outstart = hashtable->nbatch;
 
@@ -327,6 +366,12 @@ ExecHashTableCreate(HashState *hashState, HashJoinState *hjstate, List *hashOper
 	 */
 	hashtable = (HashJoinTable)palloc0(sizeof(HashJoinTableData));
 	hashtable->buckets = NULL;
+	hashtable->chunks = NULL;
+	hashtable->skewEnabled = false;
+	hashtable->skewBucket = NULL;
+	hashtable->skewBucketLen = 0;
+	hashtable->nSkewBuckets = 0;
+	hashtable->skewBucketNums = NULL;
 	hashtable->bloomfilter = NULL;
 	hashtable->curbatch = 0;
 	hashtable->growEnabled = true;
@@ -390,6 +435,7 @@ ExecHashTableCreate(HashState *hashState, HashJoinState *hjstate, List *hashOper
 	nbatch = hashtable->nbatch;
 	hashtable->nbatch_original = nbatch;
 	hashtable->nbatch_outstart = nbatch;
+	hashtable->nbuckets_original = nbuckets;
 
 
 #ifdef HJDEBUG
@@ -468,6 +514,15 @@ ExecHashTableCreate(HashState *hashState, HashJoinState *hjstate, List *hashOper
 	hashtable->buckets = (HashJoinTuple *)
 		palloc0(nbuckets * sizeof(HashJoinTuple));
 
+	/*
+	 * Keep the inner tuples of the most common outer keys out of the batch
+	 * files, when there are any.  With a single key only, whose hash value
+	 * is the one of the planner's values.  The batches saved for workfile
+	 * caching would miss them, so not then.
+	 */
+	if (nbatch > 1 && nkeys == 1 && workfile_set == NULL && !gp_workfile_caching)
+		ExecHashBuildSkewHash(hashtable, node);
+
 	MemoryContextSwitchTo(oldcxt);
 
 
@@ -490,6 +545,7 @@ ExecHashTableCreate(HashState *hashState, HashJoinState *hjstate, List *hashOper
 
 		int size = UpperPowerTwo(hjstate->estimatedInnerNum);
 		hashtable->bloomfilter = InitBloomFilter(min(size, max_size));
+		hashtable->keyranges = ExecHashInitKeyRanges(hjstate->hj_InnerHashKeys);
 		MemoryContextSwitchTo(oldcxt);
 	}
 
@@ -752,6 +808,16 @@ ExecHashTableDestroy(HashState *hashState, HashJoinTable hashtable)
 
 	if (hashtable->work_set != NULL)
 	{
+		/* the batches doubled this many times after the inner scan started */
+		int			depth = 0;
+
+		while ((hashtable->nbatch_original << depth) < hashtable->nbatch)
+			depth++;
+
+		workfile_mgr_report_spill(hashtable->work_set,
+								  hashtable->hjstate ? hashtable->hjstate->js.ps.instrument : NULL,
+								  hashtable->nbatch, depth,
+								  hashtable->stats ? ExecHashTableMemoryWanted(hashtable) : 0);
 		workfile_mgr_close_set(hashtable->work_set);
 		hashtable->work_set = NULL;
 	}
@@ -766,6 +832,50 @@ ExecHashTableDestroy(HashState *hashState, HashJoinTable hashtable)
 	END_MEMORY_ACCOUNT();
 }
 
+/*
+ * ExecHashGrowSpaceAllowed
+ *		try to grow the memory of the hash table beyond its quota from the
+ *		free memory of the segment, instead of spilling a batch.
+ */
+static bool
+ExecHashGrowSpaceAllowed(HashJoinTable hashtable)
+{
+	int64		growth;
+
+	growth = VmemTracker_GetOperatorMemoryGrowth(hashtable->spaceAllowed,
+												 hashtable->spaceGrown);
+	if (growth <= 0)
+		return false;
+
+	hashtable->spaceAllowed += growth;
+	hashtable->spaceGrown += growth;
+
+	elog(DEBUG1, "HashJoin: grow memory of hash table to " INT64_FORMAT " bytes "
+		 "with " INT64_FORMAT " bytes beyond quota",
+		 (int64) hashtable->spaceAllowed, (int64) hashtable->spaceGrown);
+
+	return true;
+}
+
+/*
+ * ExecHashRequestSpill
+ *		spill callback of the runaway cleaner, registered while the hash
+ *		table is loaded: the next tuple inserted into the in-memory batch
+ *		gives up the memory grown beyond the quota and doubles the number
+ *		of batches.
+ */
+bool
+ExecHashRequestSpill(void *arg)
+{
+	HashJoinTable hashtable = (HashJoinTable) arg;
+
+	if (!hashtable->growEnabled || hashtable->nbatch > INT_MAX / 2)
+		return false;
+
+	hashtable->spillRequested = true;
+	return true;
+}
+
 /*
  * ExecHashIncreaseNumBatches
  *		increase the original number of batches in order to reduce
@@ -783,6 +893,7 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 	long		nfreed;
 	Size        spaceFreed = 0;
 	HashJoinTableStats *stats = hashtable->stats;
+	HashMemoryChunk oldchunks;
 
 	/* do nothing if we've decided to shut off growth */
 	if (!hashtable->growEnabled)
@@ -820,39 +931,46 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 	Assert(hashtable->nbatch == nbatch);
 
 	/*
-	 * Scan through the existing hash table entries and dump out any that are
-	 * no longer of the current batch.
+	 * Scan through the chunks of the hash table and dump out any tuples that
+	 * are no longer of the current batch.  The tuples we keep are copied into
+	 * new chunks and relinked into empty buckets, so that the space of the
+	 * dumped tuples is really given back.
 	 */
 	ninmemory = nfreed = 0;
 
-	for (i = 0; i < hashtable->nbuckets; i++)
-	{
-		HashJoinTuple prevtuple;
-		HashJoinTuple tuple;
+	memset(hashtable->buckets, 0, hashtable->nbuckets * sizeof(HashJoinTuple));
+	oldchunks = hashtable->chunks;
+	hashtable->chunks = NULL;
 
-		prevtuple = NULL;
-		tuple = hashtable->buckets[i];
+	while (oldchunks != NULL)
+	{
+		HashMemoryChunk nextchunk = oldchunks->next;
+		Size		idx = 0;
 
-		while (tuple != NULL)
+		while (idx < oldchunks->used)
 		{
-			/* save link in case we delete */
-			HashJoinTuple nexttuple = tuple->next;
+			HashJoinTuple tuple = (HashJoinTuple) (HASH_CHUNK_DATA(oldchunks) + idx);
+			Size		spaceTuple;
 			int			bucketno;
 			int			batchno;
 
+			spaceTuple = HJTUPLE_OVERHEAD + memtuple_get_size(HJTUPLE_MINTUPLE(tuple), NULL);
+
 			ninmemory++;
 			ExecHashGetBucketAndBatch(hashtable, tuple->hashvalue,
 					&bucketno, &batchno);
-			Assert(bucketno == i);
 			if (batchno == curbatch)
 			{
 				/* keep tuple */
-				prevtuple = tuple;
+				HashJoinTuple copyTuple;
+
+				copyTuple = (HashJoinTuple) ExecHashDenseAlloc(hashtable, spaceTuple);
+				memcpy(copyTuple, tuple, spaceTuple);
+				copyTuple->next = hashtable->buckets[bucketno];
+				hashtable->buckets[bucketno] = copyTuple;
 			}
 			else
 			{
-				Size    spaceTuple;
-
 				/* dump it out */
 				Assert(batchno > curbatch);
 				Assert(batchno >= hashtable->hjstate->nbatch_loaded_state);
@@ -861,26 +979,21 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 						hashtable,
 						&hashtable->batches[batchno]->innerside,
 						hashtable->bfCxt);
-				/* and remove from hash table */
-				if (prevtuple)
-					prevtuple->next = nexttuple;
-				else
-					hashtable->buckets[i] = nexttuple;
-				/* prevtuple doesn't change */
 
 				hashtable->totalTuples--;
 
-				spaceTuple = HJTUPLE_OVERHEAD + memtuple_get_size(HJTUPLE_MINTUPLE(tuple), NULL); 
 				spaceFreed += spaceTuple;
 				if (stats)
 					stats->batchstats[batchno].spillspace_in += spaceTuple;
 
-				pfree(tuple);
 				nfreed++;
 			}
 
-			tuple = nexttuple;
+			idx += MAXALIGN(spaceTuple);
 		}
+
+		pfree(oldchunks);
+		oldchunks = nextchunk;
 	}
 
 #ifdef HJDEBUG
@@ -921,6 +1034,132 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 
 }
 
+/*
+ * ExecHashIncreaseNumBuckets
+ *		give a hash table that got many more inner tuples than the planner
+ *		estimated the number of buckets they need
+ *
+ * This is only done when there is a single batch, since the batch number
+ * of a tuple depends on nbuckets as well.  The new buckets come out of the
+ * metadata memory, as when the hash table is sized.  The tuples stay where
+ * they are in the chunks, and are just relinked.
+ */
+void
+ExecHashIncreaseNumBuckets(HashJoinTable hashtable)
+{
+	double		dbuckets;
+	int			nbuckets;
+	HashMemoryChunk chunk;
+
+	if (hashtable->nbatch != 1 ||
+		hashtable->totalTuples <= 2.0 * hashtable->nbuckets * gp_hashjoin_tuples_per_bucket)
+		return;
+
+	dbuckets = ceil(hashtable->totalTuples / gp_hashjoin_tuples_per_bucket);
+	dbuckets = Min(dbuckets, INT_MAX / 32);
+	if (gp_hashjoin_metadata_memory_percent > 0)
+	{
+		double		md_mem = (double) hashtable->spaceAllowed *
+			gp_hashjoin_metadata_memory_percent / 100;
+
+		dbuckets = Min(dbuckets, md_mem / MD_MEM_PER_BUCKET);
+	}
+
+	nbuckets = ExecChoosePrimeNBuckets((int) dbuckets);
+	if (nbuckets <= hashtable->nbuckets || nbuckets > dbuckets)
+		return;
+
+#ifdef HJDEBUG
+	elog(LOG, "Increasing number of buckets from %d to %d for %.0f tuples",
+		 hashtable->nbuckets, nbuckets, hashtable->totalTuples);
+#endif
+
+	pfree(hashtable->buckets);
+	hashtable->buckets = (HashJoinTuple *)
+		MemoryContextAllocZero(hashtable->batchCxt, nbuckets * sizeof(HashJoinTuple));
+	hashtable->nbuckets = nbuckets;
+
+	for (chunk = hashtable->chunks; chunk != NULL; chunk = chunk->next)
+	{
+		Size		idx = 0;
+
+		while (idx < chunk->used)
+		{
+			HashJoinTuple tuple = (HashJoinTuple) (HASH_CHUNK_DATA(chunk) + idx);
+			int			bucketno;
+			int			batchno;
+
+			ExecHashGetBucketAndBatch(hashtable, tuple->hashvalue,
+									  &bucketno, &batchno);
+			Assert(batchno == 0);
+			tuple->next = hashtable->buckets[bucketno];
+			hashtable->buckets[bucketno] = tuple;
+
+			idx += MAXALIGN(HJTUPLE_OVERHEAD +
+							memtuple_get_size(HJTUPLE_MINTUPLE(tuple), NULL));
+		}
+	}
+}
+
+/*
+ * ExecHashDenseAlloc
+ *		allocate space for a hash join tuple in the chunks of the current
+ *		batch.
+ *
+ * The space is only given back by resetting the batchCxt, or by moving the
+ * tuples to new chunks as ExecHashIncreaseNumBatches does.
+ */
+static void *
+ExecHashDenseAlloc(HashJoinTable hashtable, Size size)
+{
+	HashMemoryChunk chunk;
+	char	   *ptr;
+
+	size = MAXALIGN(size);
+
+	/* a large tuple gets a chunk of its own, behind the current chunk */
+	if (size > HASH_CHUNK_THRESHOLD)
+	{
+		chunk = (HashMemoryChunk) MemoryContextAlloc(hashtable->batchCxt,
+													 HASH_CHUNK_HEADER_SIZE + size);
+		chunk->ntuples = 1;
+		chunk->maxlen = size;
+		chunk->used = size;
+
+		if (hashtable->chunks != NULL)
+		{
+			chunk->next = hashtable->chunks->next;
+			hashtable->chunks->next = chunk;
+		}
+		else
+		{
+			chunk->next = NULL;
+			hashtable->chunks = chunk;
+		}
+
+		return HASH_CHUNK_DATA(chunk);
+	}
+
+	/* start a new chunk when the current one is full */
+	chunk = hashtable->chunks;
+	if (chunk == NULL || chunk->maxlen - chunk->used < size)
+	{
+		chunk = (HashMemoryChunk) MemoryContextAlloc(hashtable->batchCxt,
+													 HASH_CHUNK_HEADER_SIZE + HASH_CHUNK_SIZE);
+		chunk->ntuples = 0;
+		chunk->maxlen = HASH_CHUNK_SIZE;
+		chunk->used = 0;
+		chunk->next = hashtable->chunks;
+		hashtable->chunks = chunk;
+	}
+
+	ptr = HASH_CHUNK_DATA(chunk) + chunk->used;
+	chunk->used += size;
+	chunk->ntuples++;
+
+	return ptr;
+}
+
 /*
  * Re-allocate the batch data array when the number of batches increases
  */
@@ -1013,32 +1252,14 @@ ExecHashTableInsert(HashState *hashState, HashJoinTable hashtable,
 		 */
 		HashJoinTuple hashTuple;
 
-		hashTuple = (HashJoinTuple) MemoryContextAlloc(hashtable->batchCxt,
-				hashTupleSize);
+		hashTuple = (HashJoinTuple) ExecHashDenseAlloc(hashtable, hashTupleSize);
 		hashTuple->hashvalue = hashvalue;
 		memcpy(HJTUPLE_MINTUPLE(hashTuple), tuple, memtuple_get_size(tuple, NULL)); 
 		hashTuple->next = hashtable->buckets[bucketno];
 		hashtable->buckets[bucketno] = hashTuple;
 		hashtable->totalTuples += 1;
 
-		/* Double the number of batches when too much data in hash table. */
-		if (batch->innerspace > hashtable->spaceAllowed ||
-			batch->innertuples > UINT_MAX/2)
-		{
-			ExecHashIncreaseNumBatches(hashtable);
-
-			if (ps && ps->instrument)
-			{
-				ps->instrument->workfileCreated = true;
-			}
-
-			/* Gpmon stuff */
-			if(ps)
-			{
-				Gpmon_M_Set(&ps->gpmon_pkt, GPMON_HASH_SPILLBATCH, hashtable->nbatch);
-				CheckSendPlanStateGpmonPkt(ps);
-			}
-		}
+		ExecHashSpillIfFull(hashState, hashtable, batch);
 	}
 	else
 	{
@@ -1056,6 +1277,275 @@ ExecHashTableInsert(HashState *hashState, HashJoinTable hashtable,
 	END_MEMORY_ACCOUNT();
 }
 
+/*
+ * ExecHashSpillIfFull
+ *		double the number of batches when too much data in hash table,
+ *		unless the free memory of the segment can hold it, or when the
+ *		runaway cleaner asked us to spill; then we also go back to our
+ *		quota.
+ */
+static void
+ExecHashSpillIfFull(HashState *hashState, HashJoinTable hashtable,
+					HashJoinBatchData *batch)
+{
+	PlanState  *ps = &hashState->ps;
+
+	if (hashtable->spillRequested)
+	{
+		hashtable->spaceAllowed -= hashtable->spaceGrown;
+		hashtable->spaceGrown = 0;
+	}
+
+	if (hashtable->spillRequested ||
+		(batch->innerspace > hashtable->spaceAllowed &&
+		 !ExecHashGrowSpaceAllowed(hashtable)) ||
+		batch->innertuples > UINT_MAX/2)
+	{
+		hashtable->spillRequested = false;
+
+		ExecHashIncreaseNumBatches(hashtable);
+
+		if (ps->instrument)
+		{
+			ps->instrument->workfileCreated = true;
+		}
+
+		/* Gpmon stuff */
+		Gpmon_M_Set(&ps->gpmon_pkt, GPMON_HASH_SPILLBATCH, hashtable->nbatch);
+		CheckSendPlanStateGpmonPkt(ps);
+	}
+}
+
+/*
+ * ExecHashBuildSkewHash
+ *		set up the skew table for the most common values of the outer key
+ *
+ * They come from the planner, most common first.  As many of them are
+ * used as the skew memory has room for the buckets of.
+ */
+static void
+ExecHashBuildSkewHash(HashJoinTable hashtable, Hash *node)
+{
+	int			nvalues = list_length(node->skewValues);
+	int			mcvsToUse;
+	int			nbuckets;
+	ListCell   *lc;
+
+	if (nvalues == 0 || gp_hashjoin_skew_memory_percent <= 0)
+		return;
+
+	hashtable->spaceAllowedSkew =
+		hashtable->spaceAllowed * gp_hashjoin_skew_memory_percent / 100;
+
+	mcvsToUse = Min(nvalues,
+					hashtable->spaceAllowedSkew * SKEW_HASH_MEM_PERCENT / 100 /
+					SKEW_MEM_PER_BUCKET);
+	if (mcvsToUse <= 0)
+		return;
+
+	/* a power of 2 at least twice the values, to keep the probes short */
+	nbuckets = 2;
+	while (nbuckets <= mcvsToUse)
+		nbuckets <<= 1;
+	nbuckets <<= 1;
+
+	hashtable->skewBucket = (HashSkewBucket **)
+		MemoryContextAllocZero(hashtable->batchCxt,
+							   nbuckets * sizeof(HashSkewBucket *));
+	hashtable->skewBucketNums = (int *)
+		MemoryContextAllocZero(hashtable->batchCxt, mcvsToUse * sizeof(int));
+	hashtable->skewBucketLen = nbuckets;
+	hashtable->spaceUsedSkew = nbuckets * sizeof(HashSkewBucket *) +
+		mcvsToUse * sizeof(int);
+
+	foreach(lc, node->skewValues)
+	{
+		Const	   *value = (Const *) lfirst(lc);
+		uint32		hashvalue;
+		int			bucket;
+
+		if (hashtable->nSkewBuckets >= mcvsToUse)
+			break;
+
+		Assert(IsA(value, Const));
+		if (value->constisnull)
+			continue;
+
+		/* the hash value of a single key, see ExecHashGetHashValue */
+		hashvalue = DatumGetUInt32(FunctionCall1(&hashtable->hashfunctions[0],
+												 value->constvalue));
+
+		bucket = hashvalue & (nbuckets - 1);
+		while (hashtable->skewBucket[bucket] != NULL &&
+			   hashtable->skewBucket[bucket]->hashvalue != hashvalue)
+			bucket = (bucket + 1) & (nbuckets - 1);
+
+		/* two values of the same hash value share a bucket */
+		if (hashtable->skewBucket[bucket] != NULL)
+			continue;
+
+		hashtable->skewBucket[bucket] = (HashSkewBucket *)
+			MemoryContextAlloc(hashtable->batchCxt, sizeof(HashSkewBucket));
+		hashtable->skewBucket[bucket]->hashvalue = hashvalue;
+		hashtable->skewBucket[bucket]->tuples = NULL;
+		hashtable->skewBucketNums[hashtable->nSkewBuckets++] = bucket;
+		hashtable->spaceUsedSkew += SKEW_BUCKET_OVERHEAD;
+	}
+
+	hashtable->skewEnabled = hashtable->nSkewBuckets > 0;
+
+#ifdef HJDEBUG
+	elog(LOG, "HJ: %d skew buckets of %d for %d common values",
+		 hashtable->nSkewBuckets, nbuckets, nvalues);
+#endif
+}
+
+/*
+ * ExecHashGetSkewBucket
+ *		the skew bucket of a hash value, or INVALID_SKEW_BUCKET_NO if it
+ *		is not the hash value of a common value of the outer key.
+ */
+int
+ExecHashGetSkewBucket(HashJoinTable hashtable, uint32 hashvalue)
+{
+	int			bucket;
+
+	if (!hashtable->skewEnabled)
+		return INVALID_SKEW_BUCKET_NO;
+
+	bucket = hashvalue & (hashtable->skewBucketLen - 1);
+	while (hashtable->skewBucket[bucket] != NULL &&
+		   hashtable->skewBucket[bucket]->hashvalue != hashvalue)
+		bucket = (bucket + 1) & (hashtable->skewBucketLen - 1);
+
+	if (hashtable->skewBucket[bucket] != NULL)
+		return bucket;
+
+	return INVALID_SKEW_BUCKET_NO;
+}
+
+/*
+ * ExecHashSkewTableInsert
+ *		insert an inner tuple into the skew table
+ *
+ * The skew tuples count in the first batch, for its memory and for the
+ * thresholds of spilling it.  The buckets of the least common values are
+ * moved to the main table when the tuples outgrow the skew memory.
+ */
+static void
+ExecHashSkewTableInsert(HashState *hashState, HashJoinTable hashtable,
+						TupleTableSlot *slot, uint32 hashvalue,
+						int bucketNumber)
+{
+	MemTuple	tuple = ExecFetchSlotMemTuple(slot, false);
+	HashJoinBatchData *batch = hashtable->batches[hashtable->curbatch];
+	HashJoinTuple hashTuple;
+	int			hashTupleSize;
+
+	START_MEMORY_ACCOUNT(hashState->ps.plan->memoryAccount);
+	{
+	hashTupleSize = HJTUPLE_OVERHEAD + memtuple_get_size(tuple, NULL);
+	hashTuple = (HashJoinTuple) MemoryContextAlloc(hashtable->batchCxt,
+												   hashTupleSize);
+	hashTuple->hashvalue = hashvalue;
+	memcpy(HJTUPLE_MINTUPLE(hashTuple), tuple, memtuple_get_size(tuple, NULL));
+	hashTuple->next = hashtable->skewBucket[bucketNumber]->tuples;
+	hashtable->skewBucket[bucketNumber]->tuples = hashTuple;
+
+	batch->innertuples++;
+	batch->innerspace += hashTupleSize;
+	hashtable->totalTuples += 1;
+	hashtable->spaceUsedSkew += hashTupleSize;
+
+	while (hashtable->skewEnabled &&
+		   hashtable->spaceUsedSkew > hashtable->spaceAllowedSkew)
+		ExecHashRemoveNextSkewBucket(hashtable);
+
+	ExecHashSpillIfFull(hashState, hashtable, batch);
+	}
+	END_MEMORY_ACCOUNT();
+}
+
+/*
+ * ExecHashRemoveNextSkewBucket
+ *		move the bucket of the least common value left in the skew table to
+ *		the main table, or to its batch file.
+ *
+ * The buckets are removed in the reverse order of their creation: none of
+ * the buckets left was placed beyond it in the probe sequence, so leaving
+ * its slot empty breaks no probe chain.
+ */
+static void
+ExecHashRemoveNextSkewBucket(HashJoinTable hashtable)
+{
+	int			bucketToRemove;
+	HashSkewBucket *bucket;
+	HashJoinBatchData *skewbatch = hashtable->batches[hashtable->curbatch];
+	HashJoinTuple hashTuple;
+	int			bucketno;
+	int			batchno;
+
+	bucketToRemove = hashtable->skewBucketNums[hashtable->nSkewBuckets - 1];
+	bucket = hashtable->skewBucket[bucketToRemove];
+
+	/* all the tuples of the bucket have its hash value */
+	ExecHashGetBucketAndBatch(hashtable, bucket->hashvalue, &bucketno, &batchno);
+
+	hashTuple = bucket->tuples;
+	while (hashTuple != NULL)
+	{
+		HashJoinTuple nextHashTuple = hashTuple->next;
+		MemTuple	tuple = HJTUPLE_MINTUPLE(hashTuple);
+		Size		hashTupleSize;
+
+		hashTupleSize = HJTUPLE_OVERHEAD + memtuple_get_size(tuple, NULL);
+
+		if (batchno == hashtable->curbatch)
+		{
+			HashJoinTuple copyTuple;
+
+			copyTuple = (HashJoinTuple) ExecHashDenseAlloc(hashtable, hashTupleSize);
+			memcpy(copyTuple, hashTuple, hashTupleSize);
+			copyTuple->next = hashtable->buckets[bucketno];
+			hashtable->buckets[bucketno] = copyTuple;
+		}
+		else
+		{
+			HashJoinBatchData *batch = hashtable->batches[batchno];
+
+			Assert(batchno > hashtable->curbatch);
+			ExecHashJoinSaveTuple(NULL, tuple, hashTuple->hashvalue, hashtable,
+								  &batch->innerside, hashtable->bfCxt);
+
+			skewbatch->innertuples--;
+			skewbatch->innerspace -= hashTupleSize;
+			batch->innertuples++;
+			batch->innerspace += hashTupleSize;
+			hashtable->totalTuples--;
+		}
+
+		hashtable->spaceUsedSkew -= hashTupleSize;
+		pfree(hashTuple);
+		hashTuple = nextHashTuple;
+	}
+
+	hashtable->skewBucket[bucketToRemove] = NULL;
+	hashtable->nSkewBuckets--;
+	hashtable->spaceUsedSkew -= SKEW_BUCKET_OVERHEAD;
+	pfree(bucket);
+
+	/* Without buckets there is no point probing the skew table any more */
+	if (hashtable->nSkewBuckets == 0)
+	{
+		hashtable->skewEnabled = false;
+		pfree(hashtable->skewBucket);
+		pfree(hashtable->skewBucketNums);
+		hashtable->skewBucket = NULL;
+		hashtable->skewBucketNums = NULL;
+		hashtable->spaceUsedSkew = 0;
+	}
+}
+
 /*
  * ExecHashGetHashValue
  *		Compute the hash value for a tuple
@@ -1116,6 +1606,10 @@ ExecHashGetHashValue(HashState *hashState, HashJoinTable hashtable,
 		if (!isNull)
 		{
 			*hashkeys_null = false;
+
+			/* CDB: widen the range of the inner keys for the runtime filter */
+			if (hashtable->keyranges != NULL && hashkeys == hashState->hashkeys)
+				ExecHashAddKeyRange(&hashtable->keyranges[i], keyval);
 		}
 
 		/*
@@ -1160,6 +1654,119 @@ ExecHashGetHashValue(HashState *hashState, HashJoinTable hashtable,
 	return result;
 }
 
+/*
+ * The integer value of a join key, for the ranges of the runtime filter.
+ */
+static int64
+RuntimeFilterKeyValue(Oid type, Datum value)
+{
+	switch (type)
+	{
+		case INT2OID:
+			return DatumGetInt16(value);
+		case INT4OID:
+		case DATEOID:
+			return DatumGetInt32(value);
+		default:
+			Assert(type == INT8OID);
+			return DatumGetInt64(value);
+	}
+}
+
+/*
+ * RuntimeFilterRangeType
+ *		Return true if a range of the runtime filter can be kept for a join
+ *		key of this type.
+ */
+bool
+RuntimeFilterRangeType(Oid type)
+{
+	return type == INT2OID || type == INT4OID ||
+		   type == INT8OID || type == DATEOID;
+}
+
+/*
+ * ExecHashInitKeyRanges
+ *		Set up the ranges of the inner hash keys kept next to the Bloom
+ *		filter of the hash table. Returns NULL if no key has an integer type.
+ */
+RuntimeFilterRange *
+ExecHashInitKeyRanges(List *hashkeys)
+{
+	RuntimeFilterRange *ranges;
+	ListCell   *hk;
+	bool		any = false;
+	int			i = 0;
+
+	ranges = (RuntimeFilterRange *)
+		palloc0(list_length(hashkeys) * sizeof(RuntimeFilterRange));
+
+	foreach(hk, hashkeys)
+	{
+		Oid			type = exprType((Node *) ((ExprState *) lfirst(hk))->expr);
+
+		ranges[i].empty = true;
+		if (RuntimeFilterRangeType(type))
+		{
+			ranges[i].innertype = type;
+			any = true;
+		}
+		i++;
+	}
+
+	if (!any)
+	{
+		pfree(ranges);
+		return NULL;
+	}
+
+	return ranges;
+}
+
+/*
+ * ExecHashAddKeyRange
+ *		Widen the range of an inner key to a non-null value.
+ */
+void
+ExecHashAddKeyRange(RuntimeFilterRange *range, Datum value)
+{
+	int64		v;
+
+	if (!OidIsValid(range->innertype))
+		return;
+
+	v = RuntimeFilterKeyValue(range->innertype, value);
+	if (range->empty)
+	{
+		range->min = range->max = v;
+		range->empty = false;
+	}
+	else if (v < range->min)
+		range->min = v;
+	else if (v > range->max)
+		range->max = v;
+}
+
+/*
+ * RuntimeFilterRangeMatch
+ *		Check a non-null outer key value against the range of the inner
+ *		key. Returns false if no inner tuple can match it.
+ */
+bool
+RuntimeFilterRangeMatch(RuntimeFilterRange *range, Datum value)
+{
+	int64		v;
+
+	if (!OidIsValid(range->innertype) || !OidIsValid(range->outertype))
+		return true;
+
+	if (range->empty)
+		return false;
+
+	v = RuntimeFilterKeyValue(range->outertype, value);
+	return v >= range->min && v <= range->max;
+}
+
 /*
  * ExecHashGetBucketAndBatch
  *		Determine the bucket number and batch number for a hash value
@@ -1222,13 +1829,17 @@ ExecScanHashBucket(HashState *hashState, HashJoinState *hjstate,
 	 * hj_CurTuple is NULL to start scanning a new bucket, or the address of
 	 * the last tuple returned from the current bucket.
 	 */
-	if (hashTuple == NULL)
+	if (hashTuple != NULL)
 	{
-		hashTuple = hashtable->buckets[hjstate->hj_CurBucketNo];
+		hashTuple = hashTuple->next;
+	}
+	else if (hjstate->hj_CurSkewBucketNo != INVALID_SKEW_BUCKET_NO)
+	{
+		hashTuple = hashtable->skewBucket[hjstate->hj_CurSkewBucketNo]->tuples;
 	}
 	else
 	{
-		hashTuple = hashTuple->next;
+		hashTuple = hashtable->buckets[hjstate->hj_CurBucketNo];
 	}
 
 	while (hashTuple != NULL)
@@ -1286,6 +1897,14 @@ ExecHashTableReset(HashState *hashState, HashJoinTable hashtable)
 	 * reinitialize the context for a new pass.
 	 */
 	MemoryContextReset(hashtable->batchCxt);
+	hashtable->chunks = NULL;
+
+	/* The skew table was only for the first batch, and is gone with it */
+	hashtable->skewEnabled = false;
+	hashtable->skewBucket = NULL;
+	hashtable->skewBucketNums = NULL;
+	hashtable->nSkewBuckets = 0;
+	hashtable->spaceUsedSkew = 0;
 	oldcxt = MemoryContextSwitchTo(hashtable->batchCxt);
 
 	/* Reallocate and reinitialize the hash bucket headers. */
@@ -1348,6 +1967,35 @@ ExecHashTableExplainInit(HashState *hashState, HashJoinState *hjstate,
 }                               /* ExecHashTableExplainInit */
 
 
+/*
+ * ExecHashTableMemoryWanted
+ *      How much work_mem would have sufficed to hold all inner tuples in
+ *      memory, from the batch statistics.
+ */
+static uint64
+ExecHashTableMemoryWanted(HashJoinTable hashtable)
+{
+    HashJoinTableStats *stats = hashtable->stats;
+    uint64      workmemwanted = 0;
+    int         i;
+
+    Assert(stats);
+
+    /* Space actually taken by hash rows in completed batches... */
+    for (i = 0; i <= stats->endedbatch; i++)
+        workmemwanted += stats->batchstats[i].hashspace_final;
+
+    /* ... plus workfile size for original batches not reached, plus... */
+    for (; i < hashtable->nbatch_original; i++)
+        workmemwanted += stats->batchstats[i].innerfilesize;
+
+    /* ... rows spilled to unreached oflo batches, in case quitting early */
+    for (; i < stats->nbatchstats; i++)
+        workmemwanted += stats->batchstats[i].spillspace_in;
+
+    return workmemwanted;
+}
+
 /*
  * ExecHashTableExplainEnd
  *      Called before ExecutorEnd to finish EXPLAIN ANALYZE reporting.
@@ -1407,19 +2055,7 @@ ExecHashTableExplainEnd(PlanState *planstate, struct StringInfoData *buf)
     /* How much work_mem would suffice to hold all inner tuples in memory? */
     if (hashtable->nbatch > 1)
     {
-        uint64  workmemwanted = 0;
-
-        /* Space actually taken by hash rows in completed batches... */
-        for (i = 0; i <= stats->endedbatch; i++)
-            workmemwanted += stats->batchstats[i].hashspace_final;
-
-        /* ... plus workfile size for original batches not reached, plus... */
-        for (; i < hashtable->nbatch_original; i++)
-            workmemwanted += stats->batchstats[i].innerfilesize;
-
-        /* ... rows spilled to unreached oflo batches, in case quitting early */
-        for (; i < stats->nbatchstats; i++)
-            workmemwanted += stats->batchstats[i].spillspace_in;
+        uint64  workmemwanted = ExecHashTableMemoryWanted(hashtable);
 
         /*
          * Sometimes workfiles are used even though all the data would fit
@@ -1481,6 +2117,25 @@ ExecHashTableExplainEnd(PlanState *planstate, struct StringInfoData *buf)
         appendStringInfoChar(buf, '\n');
     }
 
+    /* Report how the hash table was adapted to the inner side it got. */
+    if (hashtable->nbatch_folded > 0)
+    {
+        appendStringInfo(buf,
+                         "Inner side fit in memory, loaded %d planned batches"
+                         " back into one.",
+                         hashtable->nbatch_folded);
+        appendStringInfoChar(buf, '\n');
+    }
+    if (hashtable->nbuckets != hashtable->nbuckets_original)
+    {
+        appendStringInfo(buf,
+                         "Increased hash buckets from %d to %d"
+                         " for the inner rows.",
+                         hashtable->nbuckets_original,
+                         hashtable->nbuckets);
+        appendStringInfoChar(buf, '\n');
+    }
+
     /* Report Bloom filter statistics. */
     if (hjstate->js.ps.lefttree->type ==  T_TableScanState &&
             ((ScanState*)hjstate->js.ps.lefttree)->runtimeFilter != NULL &&
@@ -1495,6 +2150,26 @@ ExecHashTableExplainEnd(PlanState *planstate, struct StringInfoData *buf)
                         bf->nTested == 0 ? 0 : (float)((float)(bf->nTested - bf->nMatched)/(float)(bf->nTested)));
         appendStringInfoChar(buf, '\n');
     }
+    else if (hashtable->bloomfilter != NULL && hashtable->bloomfilter->nTested > 0)
+    {
+        /* the outer tuples from another slice, see ExecHashJoinOuterFilter */
+        BloomFilter bf = hashtable->bloomfilter;
+        appendStringInfo(buf, "Bloom filter on outer tuples, inner table row number:%d, "
+                        "outer table checked row number:%d, "
+                        "outer table filtered row number:%d, filtered rate:%.3f",
+                        bf->nInserted, bf->nTested, bf->nTested - bf->nMatched,
+                        (float)((float)(bf->nTested - bf->nMatched)/(float)(bf->nTested)));
+        appendStringInfoChar(buf, '\n');
+    }
+
+    /* the outer tuples of later batches, see ExecHashJoinSpillFilter */
+    if (hjstate->hj_spillFiltered > 0)
+    {
+        appendStringInfo(buf, "Bloom filter dropped " INT64_FORMAT " outer tuples "
+                         "instead of spilling them to later batches",
+                         hjstate->hj_spillFiltered);
+        appendStringInfoChar(buf, '\n');
+    }
 
 }                               /* ExecHashTableExplainEnd */
 
@@ -39,21 +39,46 @@
 #include "executor/instrument.h"        /* Instrumentation */
 #include "executor/nodeHash.h"
 #include "executor/nodeHashjoin.h"
+#include "parser/parse_expr.h"
 #include "utils/faultinjector.h"
 #include "utils/memutils.h"
+#include "utils/vmem_tracker.h"
 
 #include "cdb/cdbvars.h"
 #include "miscadmin.h" /* work_mem */
 
 #define EMPTY_WORKFILE_NAME "empty_workfile"
 
+/*
+ * Smallest in-memory hash table, buckets and tuples, whose probes read the
+ * outer tuples ahead to prefetch the buckets. A smaller one stays in the CPU
+ * caches anyway, and copying the tuples into the ring would not pay off.
+ */
+#define HJ_PREFETCH_MIN_TABLE_SIZE	(4 * 1024 * 1024)
+
+#ifdef __GNUC__
+#define hj_prefetch(addr)	__builtin_prefetch((addr), 0, 3)
+#else
+#define hj_prefetch(addr)	((void) 0)
+#endif
+
 static TupleTableSlot *ExecHashJoinOuterGetTuple(PlanState *outerNode,
 						  HashJoinState *hjstate,
 						  uint32 *hashvalue);
+static TupleTableSlot *ExecHashJoinOuterFetchTuple(PlanState *outerNode,
+						  HashJoinState *hjstate,
+						  uint32 *hashvalue);
+static TupleTableSlot *ExecHashJoinOuterPrefetchTuple(PlanState *outerNode,
+						  HashJoinState *hjstate,
+						  uint32 *hashvalue);
+static void ExecHashJoinResetPrefetch(HashJoinState *hjstate);
+static bool ExecHashJoinSpillFilter(HashJoinState *hjstate, PlanState *outerNode,
+									uint32 hashvalue);
 static TupleTableSlot *ExecHashJoinGetSavedTuple(HashJoinBatchSide *side,
 						  uint32 *hashvalue,
 						  TupleTableSlot *tupleSlot);
 static int	ExecHashJoinNewBatch(HashJoinState *hjstate);
+static void ExecHashJoinAdaptTable(HashJoinState *hjstate);
 static bool isNotDistinctJoin(List *qualList);
 static bool ExecHashJoinLoadBatchFiles(HashJoinTable hashtable);
 
@@ -218,9 +243,10 @@ ExecHashJoin(HashJoinState *node)
 		node->hj_HashTable = hashtable;
 
         /*
-         * CDB: Offer extra info for EXPLAIN ANALYZE.
+         * CDB: Offer extra info for EXPLAIN ANALYZE.  The spill history
+         * wants the batch statistics too, to tell the memory a spill needed.
          */
-        if (estate->es_instrument)
+        if (estate->es_instrument || gp_workfile_spill_history_size > 0)
             ExecHashTableExplainInit(hashNode, node, hashtable);
 
 
@@ -300,6 +326,13 @@ ExecHashJoin(HashJoinState *node)
 			return NULL;
 		}
 
+		/*
+		 * Now that the size of the inner side is known, rather than the
+		 * planner's estimate of it, adapt the hash table to it.
+		 */
+		if (gp_hashjoin_adaptive && !node->cached_workfiles_loaded)
+			ExecHashJoinAdaptTable(node);
+
 		/*
 		 * We just scanned the entire inner side and built the hashtable
 		 * (and its overflow batches). Check here and remember if the inner
@@ -337,6 +370,14 @@ ExecHashJoin(HashJoinState *node)
 		 */
 		node->hj_OuterNotEmpty = false;
 
+		/*
+		 * Read the outer tuples ahead if the first batch of the hash table
+		 * does not fit in the CPU caches.
+		 */
+		node->hj_PrefetchActive = node->hj_PrefetchDistance > 0 &&
+			(double) hashtable->nbuckets * sizeof(HashJoinTuple) +
+			hashtable->batches[0]->innerspace >= HJ_PREFETCH_MIN_TABLE_SIZE;
+
 	} /* if (hashtable == NULL) */
 
 	/*
@@ -387,6 +428,8 @@ ExecHashJoin(HashJoinState *node)
 			node->hj_CurHashValue = hashvalue;
 			ExecHashGetBucketAndBatch(hashtable, hashvalue,
 									  &node->hj_CurBucketNo, &batchno);
+			node->hj_CurSkewBucketNo = ExecHashGetSkewBucket(hashtable,
+															 hashvalue);
 			node->hj_CurTuple = NULL;
 
 			/*
@@ -405,9 +448,12 @@ ExecHashJoin(HashJoinState *node)
 
 			/*
 			 * Now we've got an outer tuple and the corresponding hash bucket,
-			 * but this tuple may not belong to the current batch.
+			 * but this tuple may not belong to the current batch.  The ones
+			 * of a skew bucket are joined in the first batch.
 			 */
-			if (batchno != hashtable->curbatch && !node->cached_workfiles_found)
+			if (batchno != hashtable->curbatch &&
+				node->hj_CurSkewBucketNo == INVALID_SKEW_BUCKET_NO &&
+				!node->cached_workfiles_found)
 			{
 				/*
 				 * Need to postpone this outer tuple to a later batch. Save it
@@ -416,6 +462,11 @@ ExecHashJoin(HashJoinState *node)
 				Assert(batchno != 0);
 				Assert(batchno > hashtable->curbatch);
 				Assert(batchno >= node->nbatch_loaded_state);
+				if (!ExecHashJoinSpillFilter(node, outerNode, hashvalue))
+				{
+					node->hj_NeedNewOuter = true;
+					continue;
+				}
 				ExecHashJoinSaveTuple(&node->js.ps, ExecFetchSlotMemTuple(outerTupleSlot, false),
 									  hashvalue,
 									  hashtable,
@@ -680,8 +731,31 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 
 	hjstate->hj_CurHashValue = 0;
 	hjstate->hj_CurBucketNo = 0;
+	hjstate->hj_CurSkewBucketNo = INVALID_SKEW_BUCKET_NO;
 	hjstate->hj_CurTuple = NULL;
 
+	/*
+	 * The ring of the outer tuples read ahead. Its slots are not in the
+	 * tuple table, as their number is set by gp_hashjoin_prefetch_distance.
+	 */
+	hjstate->hj_PrefetchDistance = gp_hashjoin_prefetch_distance;
+	hjstate->hj_PrefetchActive = false;
+	hjstate->hj_PrefetchSlots = NULL;
+	hjstate->hj_PrefetchHashValues = NULL;
+	if (hjstate->hj_PrefetchDistance > 0)
+	{
+		int			i;
+
+		hjstate->hj_PrefetchSlots = (TupleTableSlot **)
+			palloc(hjstate->hj_PrefetchDistance * sizeof(TupleTableSlot *));
+		hjstate->hj_PrefetchHashValues = (uint32 *)
+			palloc(hjstate->hj_PrefetchDistance * sizeof(uint32));
+		for (i = 0; i < hjstate->hj_PrefetchDistance; i++)
+			hjstate->hj_PrefetchSlots[i] =
+				MakeSingleTupleTableSlot(ExecGetResultType(outerPlanState(hjstate)));
+	}
+	ExecHashJoinResetPrefetch(hjstate);
+
 	/*
 	 * Deconstruct the hash clauses into outer and inner argument values, so
 	 * that we can evaluate those subexpressions separately.  Also make a list
@@ -793,6 +867,18 @@ ExecEndHashJoin(HashJoinState *node)
 	ExecClearTuple(node->hj_OuterTupleSlot);
 	ExecClearTuple(node->hj_HashTupleSlot);
 
+	if (node->hj_PrefetchSlots != NULL)
+	{
+		int			i;
+
+		for (i = 0; i < node->hj_PrefetchDistance; i++)
+			ExecDropSingleTupleTableSlot(node->hj_PrefetchSlots[i]);
+		pfree(node->hj_PrefetchSlots);
+		pfree(node->hj_PrefetchHashValues);
+		node->hj_PrefetchSlots = NULL;
+		node->hj_PrefetchHashValues = NULL;
+	}
+
 	/*
 	 * clean up subtrees
 	 */
@@ -804,7 +890,10 @@ ExecEndHashJoin(HashJoinState *node)
 
 /*
  * Create runtime filter state for scan node.
- * TODO: how to pass it across motion
+ *
+ * Only a scan of this slice gets one. The outer tuples from another slice
+ * are checked on arrival instead, see ExecHashJoinOuterFilter: the
+ * interconnect has no way back to the sending slice.
  */
 static RuntimeFilterState*
 CreateRuntimeFilterState(HashJoinState *hjstate, ProjectionInfo* projInfo)
@@ -851,6 +940,19 @@ CreateRuntimeFilterState(HashJoinState *hjstate, ProjectionInfo* projInfo)
 		}
 		i++;
 	}
+	if (hjstate->hj_HashTable->keyranges != NULL)
+	{
+		int			j = 0;
+
+		rf->ranges = (RuntimeFilterRange *) palloc(i * sizeof(RuntimeFilterRange));
+		memcpy(rf->ranges, hjstate->hj_HashTable->keyranges, i * sizeof(RuntimeFilterRange));
+		foreach(hk, hjstate->hj_OuterHashKeys)
+		{
+			Oid			type = exprType((Node *) ((ExprState *) lfirst(hk))->expr);
+
+			rf->ranges[j++].outertype = RuntimeFilterRangeType(type) ? type : InvalidOid;
+		}
+	}
 	rf->hashfunctions = (FmgrInfo *) palloc(i * sizeof(FmgrInfo));
 	memcpy(rf->hashfunctions, hjstate->hj_HashTable->hashfunctions, i*sizeof(FmgrInfo));
 	size_t size = offsetof(BloomFilterData, data) + hjstate->hj_HashTable->bloomfilter->data_size;
@@ -866,6 +968,245 @@ _exit:
 	return rf;
 }
 
+/*
+ * ExecHashJoinOuterFilter
+ *
+ * Check an outer tuple which does not come from a scan of this slice,
+ * typically one received from a motion, against the Bloom filter of the
+ * hash table. Returns false if it cannot match, so that it is dropped
+ * before it is probed, or spilled to a batch file. Like the runtime filter
+ * of a scan, the check stops if it filters too few tuples.
+ */
+static bool
+ExecHashJoinOuterFilter(HashJoinState *hjstate, PlanState *outerNode,
+						uint32 hashvalue)
+{
+	BloomFilter bf = hjstate->hj_HashTable->bloomfilter;
+
+	if (bf == NULL || !bf->isCreated || hjstate->hj_stopOuterFilter ||
+		outerNode->type == T_TableScanState)
+		return true;
+
+	if (!hjstate->hj_checkedOuterFilter &&
+		bf->nTested >= hawq_hashjoin_bloomfilter_sampling_number)
+	{
+		double real_ratio = ((double) bf->nMatched) / bf->nTested;
+
+		if (real_ratio > hawq_hashjoin_bloomfilter_ratio)
+		{
+			hjstate->hj_stopOuterFilter = true;
+			elog(DEBUG3, "Stop using Bloom filter on outer tuples, since for first %d tuples, "
+						 "the pass ratio is %.3f, which exceeds the %.3f",
+						 hawq_hashjoin_bloomfilter_sampling_number, real_ratio, hawq_hashjoin_bloomfilter_ratio);
+			return true;
+		}
+		hjstate->hj_checkedOuterFilter = true;
+	}
+
+	return FindBloomFilter(bf, hashvalue);
+}
+
+/*
+ * ExecHashJoinSpillFilter
+ *
+ * Check an outer tuple that is about to be saved to the batch file of a
+ * later batch against the Bloom filter of the hash table. Returns false if
+ * it cannot match, so that it is dropped instead of spilled. Unlike
+ * ExecHashJoinOuterFilter and the runtime filter of the scan, this check
+ * does not stop when most tuples pass: a probe of the filter costs much less
+ * than writing the tuple to a batch file and reading it back.
+ */
+static bool
+ExecHashJoinSpillFilter(HashJoinState *hjstate, PlanState *outerNode,
+						uint32 hashvalue)
+{
+	BloomFilter bf = hjstate->hj_HashTable->bloomfilter;
+
+	if (bf == NULL || !bf->isCreated)
+		return true;
+
+	/* The tuple was already checked on its way in. */
+	if (outerNode->type == T_TableScanState)
+	{
+		RuntimeFilterState *rf = ((ScanState *) outerNode)->runtimeFilter;
+
+		if (rf != NULL && rf->hasRuntimeFilter && !rf->stopRuntimeFilter)
+			return true;
+	}
+	else if (!hjstate->hj_stopOuterFilter)
+		return true;
+
+	if (ProbeBloomFilter(bf, hashvalue))
+		return true;
+
+	hjstate->hj_spillFiltered++;
+	return false;
+}
+
+/*
+ * ExecHashJoinOuterFetchTuple
+ *
+ *		get the next outer tuple of the first pass from the outer plan
+ *		node, skipping the tuples that cannot match.
+ *
+ * Returns a null slot at the end of the outer relation. On success, the
+ * tuple's hash value is stored at *hashvalue.
+ */
+static TupleTableSlot *
+ExecHashJoinOuterFetchTuple(PlanState *outerNode,
+		HashJoinState *hjstate,
+		uint32 *hashvalue)
+{
+	HashJoinTable hashtable = hjstate->hj_HashTable;
+	HashState  *hashState = (HashState *) innerPlanState(hjstate);
+	TupleTableSlot *slot;
+	ExprContext    *econtext;
+
+	for (;;)
+	{
+		/*
+		 * Check to see if first outer tuple was already fetched by
+		 * ExecHashJoin() and not used yet.
+		 */
+		slot = hjstate->hj_FirstOuterTupleSlot;
+		if (!TupIsNull(slot))
+			hjstate->hj_FirstOuterTupleSlot = NULL;
+		else
+		{
+                slot = ExecProcNode(outerNode);
+		}
+
+		if (TupIsNull(slot))
+			break;
+
+		/*
+		 * We have to compute the tuple's hash value.
+		 */
+		econtext = hjstate->js.ps.ps_ExprContext;
+		econtext->ecxt_outertuple = slot;
+
+		bool hashkeys_null = false;
+		bool keep_nulls = (hjstate->js.jointype == JOIN_LEFT) ||
+				(hjstate->js.jointype == JOIN_LASJ) ||
+				(hjstate->js.jointype == JOIN_LASJ_NOTIN) ||
+				hjstate->hj_nonequijoin;
+		if (ExecHashGetHashValue(hashState, hashtable, econtext,
+					hjstate->hj_OuterHashKeys,
+					keep_nulls,
+					hashvalue,
+					&hashkeys_null
+					))
+		{
+			/* remember outer relation is not empty for possible rescan */
+			hjstate->hj_OuterNotEmpty = true;
+
+			if (!ExecHashJoinOuterFilter(hjstate, outerNode, *hashvalue))
+				continue;
+
+			return slot;
+		}
+		/*
+		 * That tuple couldn't match because of a NULL, so discard it
+		 * and continue with the next one.
+		 */
+	} /* for (;;) */
+
+	return NULL;
+}
+
+/*
+ * ExecHashJoinOuterPrefetchTuple
+ *
+ *		get the next outer tuple of the first pass, reading the outer
+ *		relation ahead.
+ *
+ * The next hj_PrefetchDistance outer tuples are copied into a ring of slots,
+ * and the memory each of them is to probe is prefetched in two steps: its
+ * bucket head as it enters the ring, and then, once the head is in the cache,
+ * the first tuple of its bucket, when it is half way through the ring. The
+ * probe of a hash table much larger than the CPU caches then finds both in
+ * the cache, instead of stalling on two cache misses per outer tuple.
+ *
+ * The tuples are returned in the order they are read, so that the join
+ * behaves as without the lookahead, and those of later batches are spilled
+ * to their batch files by the caller as usual.
+ */
+static TupleTableSlot *
+ExecHashJoinOuterPrefetchTuple(PlanState *outerNode,
+		HashJoinState *hjstate,
+		uint32 *hashvalue)
+{
+	HashJoinTable hashtable = hjstate->hj_HashTable;
+	int			distance = hjstate->hj_PrefetchDistance;
+	int			bucketno;
+	int			batchno;
+	int			pos;
+
+	/* Fill the ring */
+	while (!hjstate->hj_PrefetchOuterDone &&
+		   hjstate->hj_PrefetchCount < distance)
+	{
+		TupleTableSlot *slot;
+		uint32		fetchedvalue;
+
+		slot = ExecHashJoinOuterFetchTuple(outerNode, hjstate, &fetchedvalue);
+		if (TupIsNull(slot))
+		{
+			hjstate->hj_PrefetchOuterDone = true;
+			break;
+		}
+
+		pos = (hjstate->hj_PrefetchHead + hjstate->hj_PrefetchCount) % distance;
+		ExecCopySlot(hjstate->hj_PrefetchSlots[pos], slot);
+		hjstate->hj_PrefetchHashValues[pos] = fetchedvalue;
+		hjstate->hj_PrefetchCount++;
+
+		ExecHashGetBucketAndBatch(hashtable, fetchedvalue, &bucketno, &batchno);
+		if (batchno == hashtable->curbatch)
+			hj_prefetch(&hashtable->buckets[bucketno]);
+	}
+
+	if (hjstate->hj_PrefetchCount == 0)
+		return NULL;
+
+	/* The bucket head of the tuple half way through the ring was prefetched */
+	if (hjstate->hj_PrefetchCount > distance / 2)
+	{
+		pos = (hjstate->hj_PrefetchHead + distance / 2) % distance;
+		ExecHashGetBucketAndBatch(hashtable, hjstate->hj_PrefetchHashValues[pos],
+								  &bucketno, &batchno);
+		if (batchno == hashtable->curbatch &&
+			hashtable->buckets[bucketno] != NULL)
+			hj_prefetch(hashtable->buckets[bucketno]);
+	}
+
+	pos = hjstate->hj_PrefetchHead;
+	hjstate->hj_PrefetchHead = (pos + 1) % distance;
+	hjstate->hj_PrefetchCount--;
+
+	*hashvalue = hjstate->hj_PrefetchHashValues[pos];
+	return hjstate->hj_PrefetchSlots[pos];
+}
+
+/*
+ * ExecHashJoinResetPrefetch
+ *
+ *		empty the ring of the outer tuples read ahead, for a new scan of
+ *		the outer relation.
+ */
+static void
+ExecHashJoinResetPrefetch(HashJoinState *hjstate)
+{
+	int			i;
+
+	for (i = 0; hjstate->hj_PrefetchSlots != NULL && i < hjstate->hj_PrefetchDistance; i++)
+		ExecClearTuple(hjstate->hj_PrefetchSlots[i]);
+
+	hjstate->hj_PrefetchOuterDone = false;
+	hjstate->hj_PrefetchHead = 0;
+	hjstate->hj_PrefetchCount = 0;
+}
+
 /*
  * ExecHashJoinOuterGetTuple
  *
@@ -885,9 +1226,6 @@ ExecHashJoinOuterGetTuple(PlanState *outerNode,
 	HashJoinTable hashtable = hjstate->hj_HashTable;
 	int			curbatch = hashtable->curbatch;
 	TupleTableSlot *slot;
-	ExprContext    *econtext;
-
-	HashState *hashState = (HashState *) innerPlanState(hjstate);
 
 	/* initialize bloom filter for scan node */
 	if (hashtable->bloomfilter != NULL &&
@@ -927,51 +1265,12 @@ ExecHashJoinOuterGetTuple(PlanState *outerNode,
 	 * and we're not loading from cached workfiles.  */
 	if (curbatch == 0 && !hjstate->cached_workfiles_loaded)
 	{
-		for (;;)
-		{
-			/*
-			 * Check to see if first outer tuple was already fetched by
-			 * ExecHashJoin() and not used yet.
-			 */
-			slot = hjstate->hj_FirstOuterTupleSlot;
-			if (!TupIsNull(slot))
-				hjstate->hj_FirstOuterTupleSlot = NULL;
-			else
-			{
-                slot = ExecProcNode(outerNode);
-			}
-
-			if (TupIsNull(slot))
-				break;
-
-			/*
-			 * We have to compute the tuple's hash value.
-			 */
-			econtext = hjstate->js.ps.ps_ExprContext;
-			econtext->ecxt_outertuple = slot;
-
-			bool hashkeys_null = false;
-			bool keep_nulls = (hjstate->js.jointype == JOIN_LEFT) ||
-					(hjstate->js.jointype == JOIN_LASJ) ||
-					(hjstate->js.jointype == JOIN_LASJ_NOTIN) ||
-					hjstate->hj_nonequijoin;
-			if (ExecHashGetHashValue(hashState, hashtable, econtext,
-						hjstate->hj_OuterHashKeys,
-						keep_nulls,
-						hashvalue,
-						&hashkeys_null
-						))
-			{
-				/* remember outer relation is not empty for possible rescan */
-				hjstate->hj_OuterNotEmpty = true;
-
-				return slot;
-			}
-			/*
-			 * That tuple couldn't match because of a NULL, so discard it
-			 * and continue with the next one.
-			 */
-		} /* for (;;) */
+		if (hjstate->hj_PrefetchActive)
+			slot = ExecHashJoinOuterPrefetchTuple(outerNode, hjstate, hashvalue);
+		else
+			slot = ExecHashJoinOuterFetchTuple(outerNode, hjstate, hashvalue);
+		if (!TupIsNull(slot))
+			return slot;
 
 		/*
 		 * We have just reached the end of the first pass. Write out the first
@@ -1034,6 +1333,94 @@ ExecHashJoinOuterGetTuple(PlanState *outerNode,
 	return NULL;
 }
 
+/*
+ * ExecHashJoinAdaptTable
+ *		adapt the hash table to the inner side that was actually read
+ *
+ * When the planner overestimated the inner side, the batches it planned
+ * may all fit in memory after all.  They are then loaded back into the
+ * hash table, so that no outer tuple has to be spilled.  When it
+ * underestimated it, the single batch gets more buckets.
+ *
+ * The inner batch files are kept when workfile caching is on, to be saved
+ * for reuse at the end, so the batches are left alone then.
+ */
+static void
+ExecHashJoinAdaptTable(HashJoinState *hjstate)
+{
+	HashJoinTable hashtable = hjstate->hj_HashTable;
+	HashState  *hashState = (HashState *) innerPlanState(hjstate);
+	int			nbatch = hashtable->nbatch;
+
+	Assert(hashtable->curbatch == 0);
+
+	if (nbatch > 1 && !gp_workfile_caching)
+	{
+		Size		space = hashtable->batches[0]->innerspace;
+		int			i;
+
+		for (i = 1; i < nbatch; i++)
+		{
+			HashJoinBatchSide *innerside = &hashtable->batches[i]->innerside;
+
+			space += innerside->total_space +
+				(Size) innerside->total_tuples * HJTUPLE_OVERHEAD;
+		}
+
+		if (space <= hashtable->spaceAllowed)
+		{
+			/*
+			 * With a single batch every tuple read back stays in memory.
+			 * Should the estimate still be short, the table just spills
+			 * again as it would have.
+			 */
+			hashtable->nbatch = 1;
+			hashtable->nbatch_original = 1;
+			hashtable->nbatch_outstart = 1;
+			hashtable->nbatch_folded = nbatch;
+
+			RunawayCleaner_RegisterSpillCallback(ExecHashRequestSpill, hashtable);
+
+			for (i = 1; i < nbatch; i++)
+			{
+				HashJoinBatchData *batch = hashtable->batches[i];
+				TupleTableSlot *slot;
+				uint32		hashvalue;
+
+				if (batch->innerside.workfile == NULL)
+					continue;
+
+				if (!ExecWorkFile_Rewind(batch->innerside.workfile))
+					ereport(ERROR, (errcode_for_file_access(),
+						errmsg("could not access temporary file")));
+
+				for (;;)
+				{
+					CHECK_FOR_INTERRUPTS();
+
+					slot = ExecHashJoinGetSavedTuple(&batch->innerside,
+													 &hashvalue,
+													 hjstate->hj_HashTupleSlot);
+					if (!slot)
+						break;
+
+					ExecHashTableInsert(hashState, hashtable, slot, hashvalue);
+				}
+
+				workfile_mgr_close_file(hashtable->work_set, batch->innerside.workfile, true);
+				batch->innerside.workfile = NULL;
+				batch->innerside.total_tuples = 0;
+				batch->innerside.total_space = 0;
+			}
+
+			RunawayCleaner_UnregisterSpillCallback(ExecHashRequestSpill, hashtable);
+			hashtable->spillRequested = false;
+		}
+	}
+
+	ExecHashIncreaseNumBuckets(hashtable);
+}
+
 /*
  * ExecHashJoinNewBatch
  *		switch to a new hashjoin batch
@@ -1174,6 +1561,8 @@ start_over:
 			}
 		}
 
+		RunawayCleaner_RegisterSpillCallback(ExecHashRequestSpill, hashtable);
+
 	    for (;;)
 	    {
 		    CHECK_FOR_INTERRUPTS();
@@ -1192,6 +1581,9 @@ start_over:
 		    hashtable->totalTuples += 1;
 	    }
 
+		RunawayCleaner_UnregisterSpillCallback(ExecHashRequestSpill, hashtable);
+		hashtable->spillRequested = false;
+
 	    /*
 	     * after we build the hash table, the inner batch file is no longer
 	     * needed.
@@ -1233,7 +1625,15 @@ start_over:
 						errmsg("could not access temporary file")));
 		}
 	}
-	
+
+	/*
+	 * Have the kernel read the next inner batch file ahead while this batch
+	 * is probed, rewinding the batch files does it for the current one.
+	 */
+	if (curbatch + 1 < hashtable->nbatch &&
+		hashtable->batches[curbatch + 1]->innerside.workfile != NULL)
+		ExecWorkFile_Prefetch(hashtable->batches[curbatch + 1]->innerside.workfile);
+
     return curbatch;
 }
 
@@ -1267,7 +1667,7 @@ ExecHashJoinSaveTuple(PlanState *ps, MemTuple tuple, uint32 hashvalue,
 		hashtable->work_set = workfile_mgr_create_set(gp_workfile_type_hashjoin,
 				true, /* can_be_reused */
 				&hashtable->hjstate->js.ps,
-				NULL_SNAPSHOT);
+				workfile_mgr_snapshot(&hashtable->hjstate->js.ps));
 
 		/* First time spilling. Before creating any spill files, create a metadata file */
 		hashtable->state_file = workfile_mgr_create_fileno(hashtable->work_set, WORKFILE_NUM_HASHJOIN_METADATA);
@@ -1303,6 +1703,7 @@ ExecHashJoinSaveTuple(PlanState *ps, MemTuple tuple, uint32 hashvalue,
 	}
 
 	batchside->total_tuples++;
+	batchside->total_space += memtuple_get_size(tuple, NULL);
 
 	if(ps)
 	{
@@ -1412,12 +1813,14 @@ ExecReScanHashJoin(HashJoinState *node, ExprContext *exprCtxt)
 	/* Always reset intra-tuple state */
 	node->hj_CurHashValue = 0;
 	node->hj_CurBucketNo = 0;
+	node->hj_CurSkewBucketNo = INVALID_SKEW_BUCKET_NO;
 	node->hj_CurTuple = NULL;
 
 	node->js.ps.ps_OuterTupleSlot = NULL;
 	node->hj_NeedNewOuter = true;
 	node->hj_MatchedOuter = false;
 	node->hj_FirstOuterTupleSlot = NULL;
+	ExecHashJoinResetPrefetch(node);
 
 	/*
 	 * if chgParam of subnode is not null then plan will be re-scanned by
@@ -1455,12 +1858,14 @@ static void ReleaseHashTable(HashJoinState *node)
 	/* Always reset intra-tuple state */
 	node->hj_CurHashValue = 0;
 	node->hj_CurBucketNo = 0;
+	node->hj_CurSkewBucketNo = INVALID_SKEW_BUCKET_NO;
 	node->hj_CurTuple = NULL;
 
 	node->js.ps.ps_OuterTupleSlot = NULL;
 	node->hj_NeedNewOuter = true;
 	node->hj_MatchedOuter = false;
 	node->hj_FirstOuterTupleSlot = NULL;	
+	ExecHashJoinResetPrefetch(node);
 
 	ExecHashJoinResetWorkfileState(node);
 }
@@ -247,9 +247,15 @@ ExecIndexReScan(IndexScanState *node, ExprContext *exprCtxt)
 
 	if (!(IsA(node->ss.ps.plan, OrcIndexOnlyScan) || IsA(node->ss.ps.plan, OrcIndexScan)))
 		initScanDesc(node);
-	else
-		orcBeginIndexOnlyScan(node, ((IndexScan*)(node->ss.ps.plan))->indexid,
-													((IndexScan*)(node->ss.ps.plan))->idxColummns);
+	else if (node->scandesc != NULL && node->iss_NumRuntimeKeys != 0)
+	{
+		/*
+		 * The quals pushed to the orc index reader can't be changed, read
+		 * the index again with the new keys, see OrcIndexNext().
+		 */
+		orcEndIndexOnlyScan(node);
+		node->scandesc = NULL;
+	}
 
 	estate = node->ss.ps.state;
 	econtext = node->iss_RuntimeContext;		/* context for runtime keys */
@@ -302,8 +308,14 @@ ExecIndexReScan(IndexScanState *node, ExprContext *exprCtxt)
 	/* reset index scan */
 	if (!(IsA(node->ss.ps.plan, OrcIndexOnlyScan) || IsA(node->ss.ps.plan, OrcIndexScan)))
 		index_rescan(node->iss_ScanDesc, node->iss_ScanKeys);
-	else
+	else if (node->scandesc != NULL)
+	{
+		/*
+		 * Rewind the open reader, instead of fetching the index files and
+		 * their footers from hdfs again at each rescan.
+		 */
 		orcIndexOnlyReScan(node);
+	}
 
 	Gpmon_M_Incr(GpmonPktFromIndexScanState(node), GPMON_INDEXSCAN_RESCAN); 
 	CheckSendPlanStateGpmonPkt(&node->ss.ps);
@@ -54,6 +54,8 @@ static void ExecMaterialExplainEnd(PlanState *planstate, struct StringInfoData *
 static void ExecChildRescan(MaterialState *node, ExprContext *exprCtxt);
 static void DestroyTupleStore(MaterialState *node);
 static void ExecMaterialResetWorkfileState(MaterialState *node);
+static void ExecMaterialBuildRescanCache(MaterialState *node);
+static TupleTableSlot *ExecMaterialNextCached(MaterialState *node, TupleTableSlot *slot);
 static void mkLockFileForWriter(int size, int share_id, char * name);
 
 /* ----------------------------------------------------------------
@@ -158,7 +160,7 @@ ExecMaterial(MaterialState *node)
 				/* Don't try to cache when running under a ShareInputScan node */
 				bool can_reuse = (ma->share_type == SHARE_NOTSHARED);
 
-				work_set = workfile_mgr_create_set(BUFFILE, can_reuse, &node->ss.ps, NULL_SNAPSHOT);
+				work_set = workfile_mgr_create_set(BUFFILE, can_reuse, &node->ss.ps, workfile_mgr_snapshot(&node->ss.ps));
 				isWriter = true;
 			}
 
@@ -263,6 +265,9 @@ ExecMaterial(MaterialState *node)
 	 */
 	slot = node->ss.ps.ps_ResultTupleSlot;
 
+	if (node->rescan_values != NULL && forward)
+		return ExecMaterialNextCached(node, slot);
+
 	if(forward)
 		eof_tuplestore = (tsa == NULL) || !ntuplestore_acc_advance(tsa, 1);
 	else
@@ -380,6 +385,13 @@ ExecInitMaterial(Material *node, EState *estate, int eflags)
 	matstate->ts_destroyed = false;
 	ExecMaterialResetWorkfileState(matstate);
 
+	matstate->rescan_cache_ok = node->share_type == SHARE_NOTSHARED &&
+		(eflags & (EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK)) == 0;
+	matstate->rescan_values = NULL;
+	matstate->rescan_isnull = NULL;
+	matstate->rescan_nrows = 0;
+	matstate->rescan_next = 0;
+
 	/*
 	 * Miscellaneous initialization
 	 *
@@ -604,6 +616,16 @@ DestroyTupleStore(MaterialState *node)
 	Assert(NULL != node->ts_state);
 	Assert(NULL != node->ts_state->matstore);
 
+	/* the cached values point into the tuplestore */
+	if (node->rescan_values)
+	{
+		pfree(node->rescan_values);
+		pfree(node->rescan_isnull);
+		node->rescan_values = NULL;
+		node->rescan_isnull = NULL;
+		node->rescan_nrows = 0;
+	}
+
 	ntuplestore_destroy_accessor((NTupleStoreAccessor *) node->ts_pos);
 	ntuplestore_destroy(node->ts_state->matstore);
 	if(node->ts_markpos)
@@ -695,6 +717,11 @@ ExecMaterialReScan(MaterialState *node, ExprContext *exprCtxt)
 		else
 		{
 			ntuplestore_acc_seek_bof((NTupleStoreAccessor *) node->ts_pos);
+
+			if (node->rescan_values == NULL && node->rescan_cache_ok &&
+				node->eof_underlying)
+				ExecMaterialBuildRescanCache(node);
+			node->rescan_next = 0;
 		}
 	}
 	else
@@ -704,6 +731,121 @@ ExecMaterialReScan(MaterialState *node, ExprContext *exprCtxt)
 	}
 }
 
+/*
+ * ExecMaterialBuildRescanCache
+ *		Deform the rows of the tuplestore once, for the rescans.
+ *
+ * A Material node that is rescanned, like the inner side of a nested loop,
+ * otherwise deforms every stored tuple again on every pass.  When the
+ * tuplestore holds all the rows of the subplan in memory, their values are
+ * put into an array per column, and the passes return them as virtual
+ * tuples.  Values passed by reference point into the tuplestore's pages,
+ * which stay in memory.  This uses more memory than the tuples, so it is
+ * only done if the arrays fit in the operator's memory next to the pages;
+ * otherwise the rescans read the tuplestore as before.
+ */
+static void
+ExecMaterialBuildRescanCache(MaterialState *node)
+{
+	NTupleStore *ts = node->ts_state->matstore;
+	NTupleStoreAccessor *tsa = (NTupleStoreAccessor *) node->ts_pos;
+	TupleTableSlot *slot = node->ss.ss_ScanTupleSlot;
+	MemoryContext oldcxt;
+	Size		storebytes;
+	Size		cachebytes;
+	int			natts = slot->tts_tupleDescriptor->natts;
+	int			nrows = 0;
+	int			row;
+	int			col;
+
+	/* tried once, whether it works out or not */
+	node->rescan_cache_ok = false;
+
+	if (natts == 0 || !ntuplestore_in_memory(ts, &storebytes))
+		return;
+
+	ntuplestore_acc_seek_bof(tsa);
+	while (ntuplestore_acc_advance(tsa, 1))
+		nrows++;
+	ntuplestore_acc_seek_bof(tsa);
+
+	if (nrows == 0)
+		return;
+
+	cachebytes = mul_size(mul_size(nrows, natts), sizeof(Datum) + sizeof(bool));
+	if (add_size(storebytes, cachebytes) >
+		(Size) PlanStateOperatorMemKB((PlanState *) node) * 1024)
+		return;
+
+	oldcxt = MemoryContextSwitchTo(node->ss.ps.state->es_query_cxt);
+	node->rescan_values = palloc(mul_size(mul_size(nrows, natts), sizeof(Datum)));
+	node->rescan_isnull = palloc(mul_size(mul_size(nrows, natts), sizeof(bool)));
+	MemoryContextSwitchTo(oldcxt);
+
+	for (row = 0; row < nrows && ntuplestore_acc_advance(tsa, 1); row++)
+	{
+		Datum	   *values;
+		bool	   *isnull;
+
+		ntuplestore_acc_current_tupleslot(tsa, slot);
+		slot_getallattrs(slot);
+		values = slot_get_values(slot);
+		isnull = slot_get_isnull(slot);
+
+		for (col = 0; col < natts; col++)
+		{
+			node->rescan_values[col * nrows + row] = values[col];
+			node->rescan_isnull[col * nrows + row] = isnull[col];
+		}
+	}
+	Assert(row == nrows);
+
+	ExecClearTuple(slot);
+	ntuplestore_acc_seek_bof(tsa);
+
+	node->rescan_nrows = nrows;
+}
+
+/*
+ * ExecMaterialNextCached
+ *		Return the next row of the values deformed for rescans.
+ */
+static TupleTableSlot *
+ExecMaterialNextCached(MaterialState *node, TupleTableSlot *slot)
+{
+	int			nrows = node->rescan_nrows;
+	int			row = node->rescan_next;
+	int			natts = slot->tts_tupleDescriptor->natts;
+	Datum	   *values;
+	bool	   *isnull;
+	int			col;
+
+	ExecClearTuple(slot);
+
+	if (row >= nrows)
+	{
+		if (!node->ss.ps.delayEagerFree)
+			ExecEagerFreeMaterial(node);
+		return NULL;
+	}
+
+	values = slot_get_values(slot);
+	isnull = slot_get_isnull(slot);
+	for (col = 0; col < natts; col++)
+	{
+		values[col] = node->rescan_values[col * nrows + row];
+		isnull[col] = node->rescan_isnull[col * nrows + row];
+	}
+	ExecStoreVirtualTuple(slot);
+
+	node->rescan_next++;
+
+	Gpmon_M_Incr_Rows_Out(GpmonPktFromMaterialState(node));
+	CheckSendPlanStateGpmonPkt(&node->ss.ps);
+
+	return slot;
+}
+
 void
 initGpmonPktForMaterial(Plan *planNode, gpmon_packet_t *gpmon_pkt, EState *estate)
 {
@@ -28,10 +28,10 @@
 
 #include "access/heapam.h"
 #include "nodes/execnodes.h" /* Slice, SliceTable */
-#include "cdb/cdbheap.h"
 #include "cdb/cdblink.h"
 #include "cdb/cdbmotion.h"
 #include "cdb/cdbvars.h"
+#include "postmaster/identity.h"
 #include "cdb/cdbhash.h"
 #include "cdb/cdbdatalocality.h"
 #include "executor/executor.h"
@@ -71,12 +71,16 @@
  */
 typedef struct CdbTupleHeapInfo
 {
-	/* Next tuple from this sender */
+	/* Next tuple from this sender, NULL once the sender is at EOS */
     HeapTuple	tuple;
 
     /* Which sender did this tuple come from? */
 	int			sourceRouteId;
 
+	/* The first sort key of the tuple, fetched once on receipt */
+	Datum		datum1;
+	bool		isnull1;
+
 } CdbTupleHeapInfo;
 
 /*
@@ -106,6 +110,27 @@ typedef struct CdbMergeComparatorContext
 	MemTupleBinding    *mt_bind;
 } CdbMergeComparatorContext;
 
+/*
+ * CdbMergeTree
+ *
+ * The tournament tree of losers that merges the senders' streams for the
+ * sorted receiver.  Leaf i holds the next tuple of the i'th sender, and
+ * internal node n (1..nleaves-1) the leaf that lost the match played there,
+ * its children being nodes 2n and 2n+1, where node nleaves+i is leaf i.
+ * losers[0] is the overall winner, the leaf whose tuple goes out next.
+ *
+ * Replacing the winner's tuple by its successor only replays the matches
+ * on the path from its leaf to the root, one comparison per level, where a
+ * binary heap needs two.
+ */
+typedef struct CdbMergeTree
+{
+	int			nleaves;
+	int		   *losers;			/* array [0..nleaves-1] of leaf indexes */
+	CdbTupleHeapInfo *leaves;	/* array [0..nleaves-1] */
+	CdbMergeComparatorContext *ctx;
+} CdbMergeTree;
+
 static CdbMergeComparatorContext *
 CdbMergeComparator_CreateContext(TupleDesc      tupDesc,
                                  int            numSortCols,
@@ -128,6 +153,10 @@ static void execMotionSortedReceiverFirstTime(MotionState * node);
 
 static int
 CdbMergeComparator(void *lhs, void *rhs, void *context);
+static void CdbMergeTree_GetKey(CdbMergeComparatorContext *ctx,
+								CdbTupleHeapInfo *info);
+static void CdbMergeTree_Build(CdbMergeTree *tree);
+static void CdbMergeTree_Replay(CdbMergeTree *tree, int leaf);
 static uint32 evalHashKey(ExprContext *econtext, List *hashkeys, List *hashtypes, CdbHash * h);
 
 static void doSendEndOfStream(Motion * motion, MotionState * node);
@@ -246,6 +275,52 @@ setMotionStatsForGpmon(MotionState *node)
 				transportEntry->stat_count_dropped);
 }
 
+/*
+ * ExecMotionExplainEnd
+ *      Called before ExecutorEnd to report the interconnect statistics of a
+ *      receiving motion for EXPLAIN ANALYZE.
+ *
+ * Only the receiving end of a motion is reported by EXPLAIN ANALYZE, the
+ * statistics of the senders (acks, retransmits, the time blocked on the flow
+ * control) are logged at interconnect teardown, see gp_interconnect_log_stats.
+ */
+void
+ExecMotionExplainEnd(PlanState *planstate, struct StringInfoData *buf)
+{
+	MotionState *node = (MotionState *) planstate;
+	MotionLayerState *mlStates = (MotionLayerState *) node->ps.state->motionlayer_context;
+	ChunkTransportState *transportStates = node->ps.state->interconnect_context;
+	int			motionId = ((Motion *) node->ps.plan)->motionID;
+	MotionNodeEntry *mlEntry;
+	ChunkTransportStateEntry *transportEntry;
+
+	if (mlStates == NULL || transportStates == NULL ||
+		motionId <= 0 || motionId > transportStates->size ||
+		!transportStates->states[motionId - 1].valid)
+		return;
+
+	mlEntry = getMotionNodeEntry(mlStates, motionId, "ExecMotionExplainEnd");
+	transportEntry = &transportStates->states[motionId - 1];
+
+	appendStringInfo(buf,
+					 "Interconnect recv " UINT64_FORMAT " bytes in " UINT64_FORMAT
+					 " chunks",
+					 mlEntry->stat_total_bytes_recvd,
+					 mlEntry->stat_total_chunks_recvd);
+
+	if (Gp_interconnect_type == INTERCONNECT_TYPE_UDP)
+		appendStringInfo(buf,
+						 ", " UINT64_FORMAT " packets, " UINT64_FORMAT
+						 " out-of-order, " UINT64_FORMAT " duplicate, "
+						 UINT64_FORMAT " dropped, waited %.3f ms for data",
+						 transportEntry->stat_count_pkts_recvd,
+						 transportEntry->stat_count_disordered,
+						 transportEntry->stat_count_duplicated,
+						 transportEntry->stat_count_dropped,
+						 (double) transportEntry->stat_total_rx_wait_time / 1000.0);
+
+	appendStringInfoChar(buf, '.');
+}
 
 /* ----------------------------------------------------------------
  *		ExecMotion
@@ -708,22 +783,23 @@ execMotionSortedReceiver_mk(MotionState * node)
     return slot;
 }
     
-/* Sorted receiver using CdbHeap */
+/* Sorted receiver using the tournament tree of losers */
 static TupleTableSlot *
 execMotionSortedReceiver(MotionState * node)
 {
 	TupleTableSlot *slot;
-    CdbHeap        *hp = (CdbHeap *) node->tupleheap;
+    CdbMergeTree   *tree = (CdbMergeTree *) node->tupleheap;
 	HeapTuple	tuple,
 				inputTuple;
 	Motion	   *motion = (Motion *) node->ps.plan;
 	ReceiveReturnCode recvRC;
 	CdbTupleHeapInfo *tupHeapInfo;
+	int			winner;
 
 	AssertState(motion->motionType == MOTIONTYPE_FIXED &&
 			motion->numOutputSegs <= 1 &&
 			motion->sendSorted &&
-			hp != NULL);
+			tree != NULL);
 
 	/* Notify senders and return EOS if caller doesn't want any more data. */
     if (node->stopRequested)
@@ -735,21 +811,22 @@ execMotionSortedReceiver(MotionState * node)
 		return NULL;
 	}
 
-	/* On first call, fill the priority queue with each sender's first tuple. */
+	/* On first call, fill the tree with each sender's first tuple. */
 	if (!node->tupleheapReady)
 	{
 		execMotionSortedReceiverFirstTime(node);
 	}
 
     /*
-     * Delete from the priority queue the element that we fetched last
-     * time.  Receive and insert the next tuple from that same sender.
+     * Replace the tuple that we returned last time by the next tuple from
+     * that same sender, and replay its matches.
      */
     else
 	{
-        /* Old element is still at the head of the pq. */
-        AssertState(NULL != (tupHeapInfo = CdbHeap_Min(CdbTupleHeapInfo, hp)) &&
-                    tupHeapInfo->tuple == NULL &&
+        winner = tree->losers[0];
+        tupHeapInfo = &tree->leaves[winner];
+
+        AssertState(tupHeapInfo->tuple == NULL &&
                     tupHeapInfo->sourceRouteId == node->routeIdNext);
 
         /* Receive the successor of the tuple that we returned last time. */
@@ -759,15 +836,11 @@ execMotionSortedReceiver(MotionState * node)
 							   &inputTuple,
 							   node->routeIdNext);
 
-        /* Substitute it in the pq for its predecessor. */
+		/* At EOS, the sender's leaf stays empty and loses every match. */
 		if (recvRC == GOT_TUPLE)
 		{
-            CdbTupleHeapInfo info;
-
-            info.tuple = inputTuple;
-            info.sourceRouteId = node->routeIdNext;
-
-            CdbHeap_DeleteMinAndInsert(hp, &info);
+            tupHeapInfo->tuple = inputTuple;
+            CdbMergeTree_GetKey(tree->ctx, tupHeapInfo);
 
             node->numTuplesFromAMS++;
 
@@ -789,13 +862,15 @@ execMotionSortedReceiver(MotionState * node)
 #endif
 		}
 
-        /* At EOS, drop this sender from the priority queue. */
-        else if (!CdbHeap_IsEmpty(hp))
-            CdbHeap_DeleteMin(hp);
+        CdbMergeTree_Replay(tree, winner);
 	}
 
-    /* Finished if all senders have returned EOS. */
-    if (CdbHeap_IsEmpty(hp))
+    /*
+     * Our next result tuple, with lowest key among all senders, is now
+     * the winner of the tree.  Finished if all senders have returned EOS.
+     */
+	tupHeapInfo = &tree->leaves[tree->losers[0]];
+    if (tupHeapInfo->tuple == NULL)
     {
         Assert(node->numTuplesFromAMS == node->numTuplesToParent);
 		Assert(node->numTuplesFromChild == 0);
@@ -804,19 +879,13 @@ execMotionSortedReceiver(MotionState * node)
     }
 
     /*
-     * Our next result tuple, with lowest key among all senders, is now
-     * at the head of the priority queue.  Get it from there.
-     *
-     * We transfer ownership of the tuple from the pq element to
-     * our caller, but the pq element itself will remain in place
-     * until the next time we are called, to avoid an unnecessary
-     * rearrangement of the priority queue.
+     * We transfer ownership of the tuple from the tree to our caller.  The
+     * leaf is refilled the next time we are called.
      */
-	tupHeapInfo = CdbHeap_Min(CdbTupleHeapInfo, hp);	
     tuple = tupHeapInfo->tuple;
 	node->routeIdNext = tupHeapInfo->sourceRouteId;
 
-    /* Zap dangling tuple ptr for safety. PQ element doesn't own it anymore. */
+    /* Zap dangling tuple ptr for safety. The leaf doesn't own it anymore. */
     tupHeapInfo->tuple = NULL;
 
     /* Update counters. */
@@ -852,7 +921,7 @@ void
 execMotionSortedReceiverFirstTime(MotionState * node)
 {
 	HeapTuple	inputTuple;
-    CdbHeap    *hp = (CdbHeap *) node->tupleheap;
+    CdbMergeTree *tree = (CdbMergeTree *) node->tupleheap;
 	Motion	   *motion = (Motion *) node->ps.plan;
 	int			iSegIdx;
     int         n = 0;
@@ -864,13 +933,20 @@ execMotionSortedReceiverFirstTime(MotionState * node)
 	Assert(sendSlice->sliceIndex == motion->motionID);
 
 	/*
-	 * We need to get a tuple from every sender, and stick it into the heap.
+	 * We need to get a tuple from every sender, and stick it into its leaf.
 	 */
 	foreach_with_count(lcProcess, sendSlice->primaryProcesses, iSegIdx)
 	{
+        CdbTupleHeapInfo *info;
+
 		if ( lfirst(lcProcess) == NULL)
 			continue; /* skip this one: we are not receiving from it */
 
+        Assert(n < tree->nleaves);
+        info = &tree->leaves[n++];
+        info->tuple = NULL;
+        info->sourceRouteId = iSegIdx;
+
 		/*
 		 * another place where we are mapping segid space to routeid space. so
 		 * route[x] = inputSegIdx[x] now.
@@ -881,12 +957,8 @@ execMotionSortedReceiverFirstTime(MotionState * node)
 
 		if (recvRC == GOT_TUPLE)
 		{
-            CdbTupleHeapInfo   *infoArray = (CdbTupleHeapInfo *)hp->slotArray;
-            CdbTupleHeapInfo   *info = &infoArray[n];
-            n++;
-
             info->tuple = inputTuple;
-            info->sourceRouteId = iSegIdx;
+            CdbMergeTree_GetKey(tree->ctx, info);
 
             node->numTuplesFromAMS++;
 
@@ -910,11 +982,15 @@ execMotionSortedReceiverFirstTime(MotionState * node)
 	}
 	Assert(iSegIdx == node->numInputSegs);
 
-    /*
-     * Rearrange the infoArray to satisfy the heap property.
-     * This is quicker than inserting the initial elements one by one.
-     */
-    CdbHeap_Heapify(hp, n);
+    /* Senders we don't receive from keep empty leaves. */
+    for (; n < tree->nleaves; n++)
+    {
+        tree->leaves[n].tuple = NULL;
+        tree->leaves[n].sourceRouteId = -1;
+    }
+
+    /* Play all the matches, quicker than replaying them leaf by leaf. */
+    CdbMergeTree_Build(tree);
 
 	node->tupleheapReady = true;
 }                               /* execMotionSortedReceiverFirstTime */
@@ -1116,6 +1192,9 @@ ExecInitMotion(Motion * node, EState *estate, int eflags)
 		 */
 		motionstate->cdbhash = makeCdbHash(node->numOutputSegs, HASH_FNV_1);
 
+		/* the senders start spreading the hot rows at different segments */
+		motionstate->skewNextSegIdx = Max(GetQEIndex(), 0) % node->numOutputSegs;
+
 #ifdef MEASURE_MOTION_TIME
 		/*
 		 * Create buckets to hold counts of tuples hashing to each
@@ -1133,6 +1212,7 @@ ExecInitMotion(Motion * node, EState *estate, int eflags)
         else
         {
             CdbMergeComparatorContext  *mcContext;
+            CdbMergeTree               *tree;
 
             /* Allocate context object for the key comparator. */
             mcContext = CdbMergeComparator_CreateContext(tupDesc,
@@ -1140,12 +1220,14 @@ ExecInitMotion(Motion * node, EState *estate, int eflags)
                     node->sortColIdx,
                     node->sortOperators);
 
-            /* Create the priority queue structure. */
-            motionstate->tupleheap = CdbHeap_Create(CdbMergeComparator,
-                    mcContext,
-                    motionstate->numInputSegs,
-                    sizeof(CdbTupleHeapInfo),
-                    NULL);
+            /* Create the tournament tree, one leaf per sender. */
+            tree = (CdbMergeTree *) palloc0(sizeof(CdbMergeTree));
+            tree->nleaves = Max(motionstate->numInputSegs, 1);
+            tree->losers = (int *) palloc0(tree->nleaves * sizeof(int));
+            tree->leaves = (CdbTupleHeapInfo *)
+                palloc0(tree->nleaves * sizeof(CdbTupleHeapInfo));
+            tree->ctx = mcContext;
+            motionstate->tupleheap = tree;
         }
     }
 
@@ -1158,6 +1240,16 @@ ExecInitMotion(Motion * node, EState *estate, int eflags)
 			tupDesc, 
 			PlanStateOperatorMemKB((PlanState *) motionstate));
 
+	/* CDB: Offer the interconnect statistics of the receiver for EXPLAIN ANALYZE. */
+	if (estate->es_instrument && motionstate->mstype == MOTIONSTATE_RECV)
+		motionstate->ps.cdbexplainfun = ExecMotionExplainEnd;
+
+	/* compress the chunks of the wide rows, see gp_interconnect_compression */
+	if (motionstate->mstype == MOTIONSTATE_SEND && gp_interconnect_compression &&
+		node->plan.plan_width >= gp_interconnect_compression_min_width)
+		SetMotionLayerNodeCompression(motionstate->ps.state->motionlayer_context,
+									  node->motionID, true);
+
 	
 #ifdef CDB_MOTION_DEBUG
     motionstate->outputFunArray = (Oid *)palloc(tupDesc->natts * sizeof(Oid));
@@ -1293,9 +1385,11 @@ ExecEndMotion(MotionState * node)
             destroy_motion_mk_heap(node);
         else
         {
-            CdbHeap *hp = (CdbHeap *) node->tupleheap;
-            CdbMergeComparator_DestroyContext(hp->comparatorContext);
-            CdbHeap_Destroy(hp);
+            CdbMergeTree *tree = (CdbMergeTree *) node->tupleheap;
+            CdbMergeComparator_DestroyContext(tree->ctx);
+            pfree(tree->losers);
+            pfree(tree->leaves);
+            pfree(tree);
         }
         node->tupleheap = NULL;
 	}
@@ -1361,7 +1455,19 @@ CdbMergeComparator(void *lhs, void *rhs, void *context)
     sortColIdx      = ctx->sortColIdx;
     tupDesc         = ctx->tupDesc;
 
-    for (nkey = 0; nkey < numSortCols; nkey++)
+    /* The first key was fetched when the tuples were received. */
+    {
+        int32       compare;
+
+        compare = ApplySortFunction(&sortFunctions[0],
+                                    sortFnKinds[0],
+                                    linfo->datum1, linfo->isnull1,
+                                    rinfo->datum1, rinfo->isnull1);
+        if (compare != 0)
+            return compare;
+    }
+
+    for (nkey = 1; nkey < numSortCols; nkey++)
     {
         AttrNumber  attno = sortColIdx[nkey];
         Datum       datum1,
@@ -1392,6 +1498,86 @@ CdbMergeComparator(void *lhs, void *rhs, void *context)
 }
                                /* CdbMergeComparator */
 
+/* Fetch the first sort key of a tuple that has just been received. */
+static void
+CdbMergeTree_GetKey(CdbMergeComparatorContext *ctx, CdbTupleHeapInfo *info)
+{
+    AttrNumber  attno = ctx->sortColIdx[0];
+
+    if (is_heaptuple_memtuple(info->tuple))
+        info->datum1 = memtuple_getattr((MemTuple) info->tuple, ctx->mt_bind,
+                                        attno, &info->isnull1);
+    else
+        info->datum1 = heap_getattr(info->tuple, attno, ctx->tupDesc,
+                                    &info->isnull1);
+}
+
+/* Does leaf a go out before leaf b?  An empty leaf never does. */
+static inline bool
+CdbMergeTree_Beats(CdbMergeTree *tree, int a, int b)
+{
+    CdbTupleHeapInfo *ainfo = &tree->leaves[a];
+    CdbTupleHeapInfo *binfo = &tree->leaves[b];
+
+    if (ainfo->tuple == NULL)
+        return false;
+    if (binfo->tuple == NULL)
+        return true;
+    return CdbMergeComparator(ainfo, binfo, tree->ctx) < 0;
+}
+
+/* Play every match of the tree, from the bottom up. */
+static void
+CdbMergeTree_Build(CdbMergeTree *tree)
+{
+    int         nleaves = tree->nleaves;
+    int        *winners = (int *) palloc(2 * nleaves * sizeof(int));
+    int         n;
+
+    for (n = 0; n < nleaves; n++)
+        winners[nleaves + n] = n;
+
+    for (n = nleaves - 1; n > 0; n--)
+    {
+        int         a = winners[2 * n];
+        int         b = winners[2 * n + 1];
+
+        if (CdbMergeTree_Beats(tree, b, a))
+        {
+            winners[n] = b;
+            tree->losers[n] = a;
+        }
+        else
+        {
+            winners[n] = a;
+            tree->losers[n] = b;
+        }
+    }
+
+    tree->losers[0] = nleaves > 1 ? winners[1] : 0;
+    pfree(winners);
+}
+
+/* Replay the matches of a leaf whose tuple has changed, up to the root. */
+static void
+CdbMergeTree_Replay(CdbMergeTree *tree, int leaf)
+{
+    int         winner = leaf;
+    int         n;
+
+    for (n = (tree->nleaves + leaf) / 2; n > 0; n /= 2)
+    {
+        if (CdbMergeTree_Beats(tree, tree->losers[n], winner))
+        {
+            int         loser = winner;
+
+            winner = tree->losers[n];
+            tree->losers[n] = loser;
+        }
+    }
+    tree->losers[0] = winner;
+}
+
 
 /* Create context object for use by CdbMergeComparator */
 CdbMergeComparatorContext *
@@ -1606,6 +1792,7 @@ doSendTuple(Motion * motion, MotionState * node, TupleTableSlot *outerTupleSlot)
 		 * we assign it to an int16. See below. */
 		targetRoute = motion->outputSegIdx[hval];
 
+
 		/* see MPP-2099, let's not run into this one again! NOTE: the
 		 * definition of BROADCAST_SEGIDX is key here, it *cannot* be
 		 * a valid route which our map (above) will *ever* return.
@@ -1614,6 +1801,24 @@ doSendTuple(Motion * motion, MotionState * node, TupleTableSlot *outerTupleSlot)
 		 * makeDefaultSegIdxArray() in cdbmutate.c (it is the trivial
 		 * map, and is passed around our system a fair amount!). */
 		Assert(targetRoute != BROADCAST_SEGIDX);
+
+		/*
+		 * The rows of a hot key of a skewed join are spread round robin on
+		 * one side of the join, and broadcast on the other, see
+		 * cdbpath_skew_split(). Both sides compare the hash of the key, so
+		 * they make the same choice for the keys which join.
+		 */
+		if (motion->skewHashes != NIL &&
+			list_member_int(motion->skewHashes, (int) node->cdbhash->hash))
+		{
+			if (motion->skewBroadcast)
+				targetRoute = BROADCAST_SEGIDX;
+			else
+			{
+				targetRoute = motion->outputSegIdx[node->skewNextSegIdx];
+				node->skewNextSegIdx = (node->skewNextSegIdx + 1) % motion->numOutputSegs;
+			}
+		}
 	}
 	else /* ExplicitRedistribute */
 	{
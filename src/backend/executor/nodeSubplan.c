@@ -48,12 +48,20 @@
 #include "cdb/cdbsrlz.h"
 #include "cdb/cdbdisp.h"
 #include "cdb/ml_ipc.h"
+#include "lib/dllist.h"
 #include "lib/stringinfo.h"
+#include "miscadmin.h"
 #include "nodes/makefuncs.h"
 #include "optimizer/clauses.h"
+#include "optimizer/walkers.h"
+#include "parser/parse_expr.h"
+#include "parser/parse_oper.h"
 #include "utils/array.h"
+#include "utils/datum.h"
+#include "utils/hsearch.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
+#include "utils/syscache.h"
 #include "cdb/dispatcher.h"
 #include "cdb/dispatcher_new.h"
 
@@ -72,6 +80,58 @@ static bool findPartialMatch(TupleHashTable hashtable, TupleTableSlot *slot);
 static bool slotAllNulls(TupleTableSlot *slot);
 static bool slotNoNulls(TupleTableSlot *slot);
 
+/*
+ * The results of a correlated subplan, by the values of its parameters.
+ *
+ * An EXISTS or expression subplan whose plan depends on nothing but the
+ * parameters its parent passes returns the same result for the same values,
+ * so it is only run once for each distinct set of them.  The least recently
+ * used results are dropped to stay within work_mem.
+ */
+typedef struct SubPlanCacheItem
+{
+	Dlelem		lru;			/* in the LRU list, most recently used first */
+	struct SubPlanCacheItem *next;	/* next item of the same hash value */
+	uint32		hash;
+	Size		size;			/* memory accounted to the item */
+	Datum		result;
+	bool		resultnull;
+	Datum	   *keys;			/* the parameter values */
+	bool	   *keynulls;
+} SubPlanCacheItem;
+
+typedef struct SubPlanCacheBucket
+{
+	uint32		hash;			/* hash key - must be first */
+	SubPlanCacheItem *items;
+} SubPlanCacheBucket;
+
+typedef struct SubPlanCache
+{
+	MemoryContext cxt;			/* holds the cache and all its items */
+	HTAB	   *table;			/* SubPlanCacheBucket by hash value */
+	Dllist		lru;
+	int			nkeys;
+	int16	   *keylen;
+	bool	   *keybyval;
+	FmgrInfo   *eqfunctions;
+	FmgrInfo   *hashfunctions;
+	int16		resultlen;
+	bool		resultbyval;
+	Size		memUsed;
+	Size		memLimit;
+	uint32		hash;			/* of the parameters last looked up */
+} SubPlanCache;
+
+static bool subplan_is_volatile(PlannedStmt *stmt, Plan *plan);
+static SubPlanCache *SubPlanCacheCreate(SubPlanState *node, PlannedStmt *stmt,
+										Plan *plan);
+static bool SubPlanCacheLookup(SubPlanCache *cache, ExprContext *econtext,
+							   List *parParam, Datum *result, bool *isNull);
+static void SubPlanCacheInsert(SubPlanCache *cache, ExprContext *econtext,
+							   List *parParam, Datum result, bool isNull);
+static void SubPlanCacheEvict(SubPlanCache *cache);
+
 
 /* ----------------------------------------------------------------
  *		ExecSubPlan
@@ -262,6 +322,15 @@ ExecScanSubPlan(SubPlanState *node,
 		planstate->chgParam = bms_add_member(planstate->chgParam, paramid);
 	}
 
+	/* Nothing to run if the subplan has been run with these values */
+	if (node->resultcache &&
+		SubPlanCacheLookup(node->resultcache, econtext, subplan->parParam,
+						   &result, isNull))
+	{
+		MemoryContextSwitchTo(oldcontext);
+		return result;
+	}
+
 	/*
 	 * Now that we've set up its parameters, we can reset the subplan.
 	 */
@@ -439,11 +508,334 @@ ExecScanSubPlan(SubPlanState *node,
 		result = makeArrayResult(astate, oldcontext);
 	}
 
+	if (node->resultcache)
+		SubPlanCacheInsert(node->resultcache, econtext, subplan->parParam,
+						   result, *isNull);
+
 	MemoryContextSwitchTo(oldcontext);
 
 	return result;
 }
 
+/*
+ * subplan_is_volatile: does a plan, or any subplan it runs, call a volatile
+ * function?
+ */
+static bool
+subplan_is_volatile_walker(Node *node, PlannedStmt *stmt)
+{
+	if (node == NULL)
+		return false;
+
+	if (IsA(node, SubPlan) &&
+		subplan_is_volatile(stmt, exec_subplan_get_plan(stmt, (SubPlan *) node)))
+		return true;
+
+	return plan_tree_walker(node, subplan_is_volatile_walker, stmt);
+}
+
+static bool
+subplan_is_volatile(PlannedStmt *stmt, Plan *plan)
+{
+	return check_volatile_functions((Node *) plan, NULL) ||
+		subplan_is_volatile_walker((Node *) plan, stmt);
+}
+
+/*
+ * SubPlanCacheCreate: set up the result cache of a subplan, or return NULL
+ * if its results can't be cached.
+ */
+static SubPlanCache *
+SubPlanCacheCreate(SubPlanState *node, PlannedStmt *stmt, Plan *plan)
+{
+	SubPlan    *subplan = (SubPlan *) node->xprstate.expr;
+	SubPlanCache *cache;
+	MemoryContext cxt;
+	MemoryContext oldcxt;
+	Bitmapset  *parParams = NULL;
+	HASHCTL		hash_ctl;
+	ListCell   *l;
+	bool		dependsOnParams;
+	int			i;
+
+	if (!gp_enable_subplan_cache || subplan->useHashTable ||
+		subplan->setParam != NIL || subplan->parParam == NIL)
+		return NULL;
+
+	/*
+	 * The result of the other sublinks also depends on their lefthand
+	 * expressions, which are not parameters.
+	 */
+	if (subplan->subLinkType != EXISTS_SUBLINK &&
+		subplan->subLinkType != NOT_EXISTS_SUBLINK &&
+		subplan->subLinkType != EXPR_SUBLINK)
+		return NULL;
+
+	/*
+	 * Nor may the plan use any param but those its parent passes, such as
+	 * the ones of a subplan it is nested in.
+	 */
+	foreach(l, subplan->parParam)
+		parParams = bms_add_member(parParams, lfirst_int(l));
+	dependsOnParams = !bms_is_empty(plan->extParam) &&
+		bms_is_subset(plan->extParam, parParams);
+	bms_free(parParams);
+
+	if (!dependsOnParams || subplan_is_volatile(stmt, plan))
+		return NULL;
+
+	cxt = AllocSetContextCreate(CurrentMemoryContext,
+								"Subplan Result Cache Context",
+								ALLOCSET_DEFAULT_MINSIZE,
+								ALLOCSET_DEFAULT_INITSIZE,
+								ALLOCSET_DEFAULT_MAXSIZE);
+	oldcxt = MemoryContextSwitchTo(cxt);
+
+	cache = (SubPlanCache *) palloc0(sizeof(SubPlanCache));
+	cache->cxt = cxt;
+	cache->nkeys = list_length(node->args);
+	cache->keylen = (int16 *) palloc(cache->nkeys * sizeof(int16));
+	cache->keybyval = (bool *) palloc(cache->nkeys * sizeof(bool));
+	cache->eqfunctions = (FmgrInfo *) palloc(cache->nkeys * sizeof(FmgrInfo));
+	cache->hashfunctions = (FmgrInfo *) palloc(cache->nkeys * sizeof(FmgrInfo));
+
+	/* The parameters are compared and hashed by their type's equality */
+	i = 0;
+	foreach(l, node->args)
+	{
+		Oid			typid = exprType((Node *) ((ExprState *) lfirst(l))->expr);
+		Operator	optup;
+		Oid			eq_opr;
+		Oid			hash_function;
+
+		optup = equality_oper(typid, true);
+		if (optup == NULL)
+			break;
+		eq_opr = oprid(optup);
+		fmgr_info(oprfuncid(optup), &cache->eqfunctions[i]);
+		ReleaseOperator(optup);
+
+		hash_function = get_op_hash_function(eq_opr);
+		if (!OidIsValid(hash_function))
+			break;
+		fmgr_info(hash_function, &cache->hashfunctions[i]);
+
+		get_typlenbyval(typid, &cache->keylen[i], &cache->keybyval[i]);
+		i++;
+	}
+
+	if (i < cache->nkeys)
+	{
+		MemoryContextSwitchTo(oldcxt);
+		MemoryContextDelete(cxt);
+		return NULL;
+	}
+
+	if (subplan->subLinkType == EXPR_SUBLINK)
+		get_typlenbyval(subplan->firstColType, &cache->resultlen,
+						&cache->resultbyval);
+	else
+	{
+		cache->resultlen = sizeof(bool);
+		cache->resultbyval = true;
+	}
+
+	MemSet(&hash_ctl, 0, sizeof(hash_ctl));
+	hash_ctl.keysize = sizeof(uint32);
+	hash_ctl.entrysize = sizeof(SubPlanCacheBucket);
+	hash_ctl.hash = tag_hash;
+	hash_ctl.hcxt = cxt;
+	cache->table = hash_create("Subplan Result Cache", 256, &hash_ctl,
+							   HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+	DLInitList(&cache->lru);
+	cache->memLimit = (Size) work_mem * 1024L;
+
+	MemoryContextSwitchTo(oldcxt);
+
+	return cache;
+}
+
+/*
+ * SubPlanCacheLookup: find the result the subplan returned for the current
+ * values of its parameters.  Returns false if it is not cached.
+ */
+static bool
+SubPlanCacheLookup(SubPlanCache *cache, ExprContext *econtext,
+				   List *parParam, Datum *result, bool *isNull)
+{
+	ParamExecData *prms = econtext->ecxt_param_exec_vals;
+	SubPlanCacheBucket *bucket;
+	SubPlanCacheItem *item;
+	MemoryContext oldcxt;
+	uint32		hash = 0;
+	ListCell   *l;
+	int			i;
+
+	/* hash and compare in the short-lived context of the parent */
+	oldcxt = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+	i = 0;
+	foreach(l, parParam)
+	{
+		ParamExecData *prm = &prms[lfirst_int(l)];
+
+		/* rotate hash left 1 bit at each step, as for TupleHashTables */
+		hash = (hash << 1) | ((hash & 0x80000000) ? 1 : 0);
+		if (!prm->isnull)
+			hash ^= DatumGetUInt32(FunctionCall1(&cache->hashfunctions[i],
+												 prm->value));
+		i++;
+	}
+	cache->hash = hash;
+
+	bucket = (SubPlanCacheBucket *) hash_search(cache->table, &hash,
+												HASH_FIND, NULL);
+
+	for (item = bucket ? bucket->items : NULL; item; item = item->next)
+	{
+		bool		match = true;
+
+		i = 0;
+		foreach(l, parParam)
+		{
+			ParamExecData *prm = &prms[lfirst_int(l)];
+
+			if (item->keynulls[i] || prm->isnull)
+				match = item->keynulls[i] && prm->isnull;
+			else
+				match = DatumGetBool(FunctionCall2(&cache->eqfunctions[i],
+												   item->keys[i],
+												   prm->value));
+			if (!match)
+				break;
+			i++;
+		}
+		if (match)
+			break;
+	}
+
+	MemoryContextSwitchTo(oldcxt);
+
+	if (item == NULL)
+		return false;
+
+	DLMoveToFront(&item->lru);
+	*result = item->result;
+	*isNull = item->resultnull;
+	return true;
+}
+
+/*
+ * SubPlanCacheInsert: remember the result of the subplan for the values of
+ * its parameters SubPlanCacheLookup() has just missed.
+ */
+static void
+SubPlanCacheInsert(SubPlanCache *cache, ExprContext *econtext,
+				   List *parParam, Datum result, bool isNull)
+{
+	ParamExecData *prms = econtext->ecxt_param_exec_vals;
+	SubPlanCacheBucket *bucket;
+	SubPlanCacheItem *item;
+	MemoryContext oldcxt;
+	Size		itemsize;
+	Size		size;
+	bool		found;
+	ListCell   *l;
+	int			i;
+
+	itemsize = MAXALIGN(sizeof(SubPlanCacheItem)) +
+		cache->nkeys * (sizeof(Datum) + sizeof(bool));
+
+	/* the item, the values it copies and its bucket */
+	size = itemsize + sizeof(SubPlanCacheBucket);
+	i = 0;
+	foreach(l, parParam)
+	{
+		ParamExecData *prm = &prms[lfirst_int(l)];
+
+		if (!prm->isnull && !cache->keybyval[i])
+			size += datumGetSize(prm->value, false, cache->keylen[i]);
+		i++;
+	}
+	if (!isNull && !cache->resultbyval)
+		size += datumGetSize(result, false, cache->resultlen);
+
+	if (size > cache->memLimit)
+		return;
+
+	while (cache->memUsed + size > cache->memLimit)
+		SubPlanCacheEvict(cache);
+
+	oldcxt = MemoryContextSwitchTo(cache->cxt);
+
+	item = (SubPlanCacheItem *) palloc(itemsize);
+	item->keys = (Datum *) ((char *) item + MAXALIGN(sizeof(SubPlanCacheItem)));
+	item->keynulls = (bool *) (item->keys + cache->nkeys);
+
+	i = 0;
+	foreach(l, parParam)
+	{
+		ParamExecData *prm = &prms[lfirst_int(l)];
+
+		item->keynulls[i] = prm->isnull;
+		item->keys[i] = prm->isnull ? (Datum) 0 :
+			datumCopy(prm->value, cache->keybyval[i], cache->keylen[i]);
+		i++;
+	}
+	item->result = isNull ? (Datum) 0 :
+		datumCopy(result, cache->resultbyval, cache->resultlen);
+	item->resultnull = isNull;
+	item->hash = cache->hash;
+	item->size = size;
+
+	bucket = (SubPlanCacheBucket *) hash_search(cache->table, &item->hash,
+												HASH_ENTER, &found);
+	if (!found)
+		bucket->items = NULL;
+	item->next = bucket->items;
+	bucket->items = item;
+
+	DLInitElem(&item->lru, item);
+	DLAddHead(&cache->lru, &item->lru);
+	cache->memUsed += size;
+
+	MemoryContextSwitchTo(oldcxt);
+}
+
+/*
+ * SubPlanCacheEvict: drop the least recently used result.
+ */
+static void
+SubPlanCacheEvict(SubPlanCache *cache)
+{
+	Dlelem	   *elem = DLRemTail(&cache->lru);
+	SubPlanCacheItem *item = (SubPlanCacheItem *) DLE_VAL(elem);
+	SubPlanCacheBucket *bucket;
+	SubPlanCacheItem **prev;
+	int			i;
+
+	bucket = (SubPlanCacheBucket *) hash_search(cache->table, &item->hash,
+												HASH_FIND, NULL);
+	Assert(bucket != NULL);
+
+	for (prev = &bucket->items; *prev != item; prev = &(*prev)->next)
+		;
+	*prev = item->next;
+	if (bucket->items == NULL)
+		hash_search(cache->table, &item->hash, HASH_REMOVE, NULL);
+
+	for (i = 0; i < cache->nkeys; i++)
+	{
+		if (!item->keynulls[i] && !cache->keybyval[i])
+			pfree(DatumGetPointer(item->keys[i]));
+	}
+	if (!item->resultnull && !cache->resultbyval)
+		pfree(DatumGetPointer(item->result));
+
+	cache->memUsed -= item->size;
+	pfree(item);
+}
+
 /*
  * buildSubPlanHash: load hash table by scanning subplan output.
  */
@@ -685,6 +1077,7 @@ ExecInitSubPlan(SubPlanState *node, EState *estate, int eflags)
 	node->keyColIdx = NULL;
 	node->eqfunctions = NULL;
 	node->hashfunctions = NULL;
+	node->resultcache = NULL;
     node->cdbextratextbuf = NULL;
 
 	/*
@@ -735,6 +1128,9 @@ ExecInitSubPlan(SubPlanState *node, EState *estate, int eflags)
 
 	node->needShutdown = true;	/* now we need to shutdown the subplan */
 
+	node->resultcache = SubPlanCacheCreate(node, estate->es_plannedstmt,
+										   subplanplan);
+
 	/*
 	 * If this plan is un-correlated or undirect correlated one and want to
 	 * set params for parent plan then mark parameters as needing evaluation.
@@ -1441,6 +1837,12 @@ ExecSetParamPlan(SubPlanState *node, ExprContext *econtext, QueryDesc *gbl_query
 void
 ExecEndSubPlan(SubPlanState *node)
 {
+	if (node->resultcache)
+	{
+		MemoryContextDelete(node->resultcache->cxt);
+		node->resultcache = NULL;
+	}
+
 	if (node->needShutdown)
 	{
 		ExecEndPlan(node->planstate, node->sub_estate);
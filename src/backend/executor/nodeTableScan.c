@@ -94,6 +94,10 @@ FreeScanRuntimefilterState(RuntimeFilterState* rfstate)
 	{
 		pfree(rfstate->hashfunctions);
 	}
+	if (rfstate->ranges != NULL)
+	{
+		pfree(rfstate->ranges);
+	}
 	pfree(rfstate);
 }
 
@@ -236,8 +236,34 @@ typedef struct WindowStatePerLevelData
 	FrameBufferEntry *curr_entry_buf;
 	FrameBufferEntry *trail_entry_buf;
 	FrameBufferEntry *lead_entry_buf;
+
+	/*
+	 * The entries of the frame buffer aggregated by the two stacks of
+	 * computeTransValuesIncrementally(), in the order of the buffer.
+	 *
+	 * The front stack holds the entries from inc_front_pos[inc_front_top - 1]
+	 * up to inc_front_pos[0], and the back stack the inc_back_count entries
+	 * from inc_back_first up to inc_last, which is the last entry of both.
+	 */
+	NTupleStorePos *inc_front_pos;
+	int inc_front_top;
+	int inc_front_size;
+	int inc_back_count;
+	NTupleStorePos inc_back_first;
+	NTupleStorePos inc_last;
 } WindowStatePerLevelData;
 
+/*
+ * IncrementalTransValue -- a transition value aggregated from a run of
+ * entries of the frame buffer.
+ */
+typedef struct IncrementalTransValue
+{
+	Datum value;
+	bool valueIsNull;
+	bool noTransValue;
+} IncrementalTransValue;
+
 /* 
  * WindowStatePerFunctionData
  */
@@ -316,6 +342,15 @@ typedef struct WindowStatePerFunctionData
 	 * so far.
 	 */
 	uint64              numNotNulls;
+
+	/*
+	 * For an aggregate without an inverse preliminary function, the
+	 * values of the front stack and of the back stack of its level. The
+	 * value inc_front[i] combines the entries from inc_front_pos[i] up to
+	 * inc_front_pos[0], and inc_back all the entries of the back stack.
+	 */
+	IncrementalTransValue *inc_front;
+	IncrementalTransValue inc_back;
 } WindowStatePerFunctionData;
 
 #define FRAME_TRAIL_ROWS 	0
@@ -550,6 +585,7 @@ static ExprState *make_eq_exprstate(WindowState *wstate,
 static bool exec_eq_exprstate(WindowState *wstate, ExprState *eq_exprstate);
 static void setEmptyFrame(WindowStatePerLevel level_state,
 						  WindowState *wstate);
+static void clearIncrementalState(WindowStatePerLevel level_state);
 
 /*
  * initFrameBuffer -- initialize the frame buffer.
@@ -704,6 +740,7 @@ resetFrameBuffers(WindowState *wstate)
 				ntuplestore_destroy_accessor(level_state->lead_reader);
 
 			level_state->frame_buffer = resetFrameBuffer(level_state->frame_buffer);
+			clearIncrementalState(level_state);
 
 			/* (Re)create accessors */
 			level_state->trail_reader =
@@ -1833,6 +1870,422 @@ freeTransValue(Datum *transValue,
 	*noTransValue = true;
 }
 
+/*
+ * requiresFrameScan -- return true if the value of the given function
+ * is computed by computeTransValuesThroughScan.
+ */
+static bool
+requiresFrameScan(WindowStatePerFunction funcstate)
+{
+	return !(funcstate->trivial_frame ||
+			 funcstate->winpeercount ||
+			 (funcstate->isAgg && OidIsValid(funcstate->invprelimfn_oid)) ||
+			 !funcstate->isAgg);
+}
+
+/*
+ * initIncrementalTransValue -- set a value of the two stacks of
+ * computeTransValuesIncrementally to the initial value of the aggregate.
+ */
+static void
+initIncrementalTransValue(WindowStatePerFunction funcstate,
+						  WindowState *wstate,
+						  IncrementalTransValue *inc_value)
+{
+	inc_value->value =
+		datumCopyWithMemManager(0, funcstate->aggInitValue,
+								funcstate->aggTranstypeByVal,
+								funcstate->aggTranstypeLen,
+								&(wstate->mem_manager));
+	inc_value->valueIsNull = funcstate->aggInitValueIsNull;
+	inc_value->noTransValue = funcstate->aggInitValueIsNull;
+}
+
+/*
+ * freeIncrementalTransValue -- release the space of a value of the two stacks.
+ */
+static void
+freeIncrementalTransValue(WindowStatePerFunction funcstate,
+						  IncrementalTransValue *inc_value)
+{
+	freeTransValue(&inc_value->value,
+				   funcstate->aggTranstypeByVal,
+				   &inc_value->valueIsNull,
+				   &inc_value->noTransValue,
+				   true);
+}
+
+/*
+ * combineIncrementalTransValue -- combine the given value into a transition
+ * value through the preliminary function of the aggregate.
+ */
+static void
+combineIncrementalTransValue(WindowStatePerFunction funcstate,
+							 WindowState *wstate,
+							 Datum *transValue,
+							 bool *transValueIsNull,
+							 bool *noTransValue,
+							 Datum value,
+							 bool valueIsNull)
+{
+	ExprContext *econtext = wstate->ps.ps_ExprContext;
+	FunctionCallInfoData fcinfo;
+
+	fcinfo.arg[1] = value;
+	fcinfo.argnull[1] = valueIsNull;
+
+	*transValue =
+		invoke_agg_trans_func(&(funcstate->prelimfn),
+							  funcstate->prelimfn.fn_nargs - 1,
+							  *transValue,
+							  noTransValue,
+							  transValueIsNull,
+							  funcstate->aggTranstypeByVal,
+							  funcstate->aggTranstypeLen,
+							  &fcinfo, (void *)wstate,
+							  econtext->ecxt_per_tuple_memory,
+							  &(wstate->mem_manager));
+}
+
+/*
+ * clearIncrementalState -- empty the two stacks of the given level.
+ */
+static void
+clearIncrementalState(WindowStatePerLevel level_state)
+{
+	ListCell *lc;
+
+	foreach(lc, level_state->level_funcs)
+	{
+		WindowStatePerFunction funcstate = (WindowStatePerFunction)
+			lfirst(lc);
+		int i;
+
+		if (!requiresFrameScan(funcstate))
+			continue;
+
+		for (i = 0; i < level_state->inc_front_top; i++)
+			freeIncrementalTransValue(funcstate, &funcstate->inc_front[i]);
+		if (level_state->inc_back_count > 0)
+			freeIncrementalTransValue(funcstate, &funcstate->inc_back);
+	}
+
+	level_state->inc_front_top = 0;
+	level_state->inc_back_count = 0;
+}
+
+/*
+ * flipIncrementalStacks -- move the entries of the back stack from 'start'
+ * on into the front stack, which is empty.
+ *
+ * The entries are read backward from the last one, so that each value
+ * pushed into the front stack combines its entry with the entries after it.
+ *
+ * Return false if an entry could not be read from the frame buffer.
+ */
+static bool
+flipIncrementalStacks(WindowStatePerLevel level_state,
+					  WindowState *wstate,
+					  NTupleStorePos *start)
+{
+	WindowFrameBuffer buffer = level_state->frame_buffer;
+	NTupleStoreAccessor *reader = buffer->reader;
+	FrameBufferEntry *entry = level_state->curr_entry_buf;
+	NTupleStorePos from;
+	NTupleStorePos pos;
+	ListCell *lc;
+	bool found = true;
+
+	Assert(level_state->inc_front_top == 0 &&
+		   level_state->inc_back_count > 0);
+
+	if (ntuplestore_compare_pos(buffer->tuplestore,
+								&level_state->inc_back_first, start) < 0)
+		from = *start;
+	else
+		from = level_state->inc_back_first;
+
+	if (ntuplestore_compare_pos(buffer->tuplestore,
+								&from, &level_state->inc_last) <= 0)
+	{
+		found = ntuplestore_acc_seek(reader, &level_state->inc_last);
+
+		while (found)
+		{
+			int top = level_state->inc_front_top;
+
+			ntuplestore_acc_tell(reader, &pos);
+			found = getCurrentValue(reader, level_state, entry);
+			if (!found)
+				break;
+
+			/* Grow the front stack if it is full. */
+			if (top == level_state->inc_front_size)
+			{
+				int new_size = (top == 0 ? 64 : top * 2);
+
+				if (top == 0)
+					level_state->inc_front_pos = (NTupleStorePos *)
+						MemoryContextAlloc(wstate->transcontext,
+										   new_size * sizeof(NTupleStorePos));
+				else
+					level_state->inc_front_pos = (NTupleStorePos *)
+						repalloc(level_state->inc_front_pos,
+								 new_size * sizeof(NTupleStorePos));
+
+				foreach(lc, level_state->level_funcs)
+				{
+					WindowStatePerFunction funcstate = (WindowStatePerFunction)
+						lfirst(lc);
+
+					if (!requiresFrameScan(funcstate))
+						continue;
+
+					if (top == 0)
+						funcstate->inc_front = (IncrementalTransValue *)
+							MemoryContextAlloc(wstate->transcontext,
+											   new_size * sizeof(IncrementalTransValue));
+					else
+						funcstate->inc_front = (IncrementalTransValue *)
+							repalloc(funcstate->inc_front,
+									 new_size * sizeof(IncrementalTransValue));
+				}
+
+				level_state->inc_front_size = new_size;
+			}
+
+			foreach(lc, level_state->level_funcs)
+			{
+				WindowStatePerFunction funcstate = (WindowStatePerFunction)
+					lfirst(lc);
+				IncrementalTransValue *inc_value;
+				WindowValue *value;
+
+				if (!requiresFrameScan(funcstate))
+					continue;
+
+				value = (WindowValue *)list_nth(entry->func_values,
+												funcstate->serial_index);
+				Assert(value);
+
+				inc_value = &funcstate->inc_front[top];
+				initIncrementalTransValue(funcstate, wstate, inc_value);
+				combineIncrementalTransValue(funcstate, wstate,
+											 &inc_value->value,
+											 &inc_value->valueIsNull,
+											 &inc_value->noTransValue,
+											 value->value,
+											 value->valueIsNull);
+				if (top > 0)
+					combineIncrementalTransValue(funcstate, wstate,
+												 &inc_value->value,
+												 &inc_value->valueIsNull,
+												 &inc_value->noTransValue,
+												 funcstate->inc_front[top - 1].value,
+												 funcstate->inc_front[top - 1].valueIsNull);
+			}
+
+			level_state->inc_front_pos[top] = pos;
+			level_state->inc_front_top++;
+
+			if (ntuplestore_compare_pos(buffer->tuplestore, &pos, &from) == 0)
+				break;
+
+			found = ntuplestore_acc_advance(reader, -1);
+		}
+
+		ntuplestore_acc_set_invalid(reader);
+	}
+
+	/* The back stack is now empty. */
+	foreach(lc, level_state->level_funcs)
+	{
+		WindowStatePerFunction funcstate = (WindowStatePerFunction)
+			lfirst(lc);
+
+		if (!requiresFrameScan(funcstate))
+			continue;
+
+		freeIncrementalTransValue(funcstate, &funcstate->inc_back);
+	}
+	level_state->inc_back_count = 0;
+
+	return found;
+}
+
+/*
+ * computeTransValuesIncrementally -- aggregate the entries of the frame
+ * buffer between the trailing and the leading edges into the final
+ * transition values, for the functions of computeTransValuesThroughScan
+ * that all have a preliminary function.
+ *
+ * 'trail_reader' points to the first entry of the frame. Both edges
+ * of a frame only move forward, so the entries are kept in two stacks
+ * from one row to the next. The entries that enter the frame at the
+ * leading edge are combined into the value of the back stack. The entries
+ * that leave the frame at the trailing edge are popped from the front
+ * stack, whose values each combine their entry with the entries after it;
+ * when the front stack runs empty, the back stack is moved into it. The
+ * value of the frame combines the top of the front stack and the back
+ * stack. Each entry is thus read at most twice, instead of once for every
+ * row whose frame covers it.
+ *
+ * The final transition values are expected to be set to the initial value.
+ */
+static void
+computeTransValuesIncrementally(WindowStatePerLevel level_state,
+								WindowState *wstate)
+{
+	WindowFrameBuffer buffer = level_state->frame_buffer;
+	NTupleStoreAccessor *reader = buffer->reader;
+	FrameBufferEntry *entry = level_state->curr_entry_buf;
+	NTupleStorePos start;
+	NTupleStorePos end;
+	NTupleStorePos pos;
+	ListCell *lc;
+	bool found;
+
+	if (!ntuplestore_acc_tell(level_state->trail_reader, &start))
+		return;
+
+	if (ntuplestore_acc_tell(level_state->lead_reader, &end))
+	{
+		if (ntuplestore_compare_pos(buffer->tuplestore, &end, &start) < 0)
+			return;
+	}
+	else
+	{
+		found = ntuplestore_acc_seek_last(reader);
+		Assert(found);
+		ntuplestore_acc_tell(reader, &end);
+	}
+
+	/* If an edge has moved backward, start over. */
+	if (level_state->inc_front_top + level_state->inc_back_count > 0 &&
+		(ntuplestore_compare_pos(buffer->tuplestore, &start,
+								 level_state->inc_front_top > 0 ?
+								 &level_state->inc_front_pos[level_state->inc_front_top - 1] :
+								 &level_state->inc_back_first) < 0 ||
+		 ntuplestore_compare_pos(buffer->tuplestore, &end,
+								 &level_state->inc_last) < 0))
+		clearIncrementalState(level_state);
+
+	/* Pop the entries before the trailing edge. */
+	while (level_state->inc_front_top > 0 &&
+		   ntuplestore_compare_pos(buffer->tuplestore,
+								   &level_state->inc_front_pos[level_state->inc_front_top - 1],
+								   &start) < 0)
+	{
+		foreach(lc, level_state->level_funcs)
+		{
+			WindowStatePerFunction funcstate = (WindowStatePerFunction)
+				lfirst(lc);
+
+			if (!requiresFrameScan(funcstate))
+				continue;
+
+			freeIncrementalTransValue(funcstate,
+									  &funcstate->inc_front[level_state->inc_front_top - 1]);
+		}
+		level_state->inc_front_top--;
+	}
+
+	if (level_state->inc_front_top == 0 &&
+		level_state->inc_back_count > 0 &&
+		ntuplestore_compare_pos(buffer->tuplestore,
+								&level_state->inc_back_first, &start) < 0)
+	{
+		if (!flipIncrementalStacks(level_state, wstate, &start))
+			clearIncrementalState(level_state);
+	}
+
+	/* Push the entries up to the leading edge into the back stack. */
+	if (level_state->inc_front_top + level_state->inc_back_count > 0 &&
+		!ntuplestore_acc_seek(reader, &level_state->inc_last))
+		clearIncrementalState(level_state);
+
+	if (level_state->inc_front_top + level_state->inc_back_count > 0)
+		found = ntuplestore_acc_advance(reader, 1);
+	else
+		found = ntuplestore_acc_seek(reader, &start);
+
+	while (found)
+	{
+		ntuplestore_acc_tell(reader, &pos);
+		if (ntuplestore_compare_pos(buffer->tuplestore, &pos, &end) > 0)
+			break;
+
+		found = getCurrentValue(reader, level_state, entry);
+		Assert(found);
+
+		foreach(lc, level_state->level_funcs)
+		{
+			WindowStatePerFunction funcstate = (WindowStatePerFunction)
+				lfirst(lc);
+			WindowValue *value;
+
+			if (!requiresFrameScan(funcstate))
+				continue;
+
+			value = (WindowValue *)list_nth(entry->func_values,
+											funcstate->serial_index);
+			Assert(value);
+
+			if (level_state->inc_back_count == 0)
+				initIncrementalTransValue(funcstate, wstate,
+										  &funcstate->inc_back);
+			combineIncrementalTransValue(funcstate, wstate,
+										 &funcstate->inc_back.value,
+										 &funcstate->inc_back.valueIsNull,
+										 &funcstate->inc_back.noTransValue,
+										 value->value,
+										 value->valueIsNull);
+		}
+
+		if (level_state->inc_back_count == 0)
+			level_state->inc_back_first = pos;
+		level_state->inc_back_count++;
+		level_state->inc_last = pos;
+
+		found = ntuplestore_acc_advance(reader, 1);
+	}
+
+	ntuplestore_acc_set_invalid(reader);
+
+	/* Combine the two stacks into the final transition values. */
+	foreach(lc, level_state->level_funcs)
+	{
+		WindowStatePerFunction funcstate = (WindowStatePerFunction)
+			lfirst(lc);
+
+		if (!requiresFrameScan(funcstate))
+			continue;
+
+		if (level_state->inc_front_top > 0)
+		{
+			IncrementalTransValue *top_value =
+				&funcstate->inc_front[level_state->inc_front_top - 1];
+
+			combineIncrementalTransValue(funcstate, wstate,
+										 &funcstate->final_aggTransValue,
+										 &funcstate->final_aggTransValueIsNull,
+										 &funcstate->final_aggNoTransValue,
+										 top_value->value,
+										 top_value->valueIsNull);
+		}
+
+		if (level_state->inc_back_count > 0)
+			combineIncrementalTransValue(funcstate, wstate,
+										 &funcstate->final_aggTransValue,
+										 &funcstate->final_aggTransValueIsNull,
+										 &funcstate->final_aggNoTransValue,
+										 funcstate->inc_back.value,
+										 funcstate->inc_back.valueIsNull);
+
+		funcstate->final_aggShouldFree = true;
+	}
+}
+
 /*
  * computeTransValuesThroughScan -- compute transition values
  * for those functions in the given level whose aggregate values
@@ -1852,6 +2305,7 @@ computeTransValuesThroughScan(WindowStatePerLevel level_state,
 	ExprContext *econtext = wstate->ps.ps_ExprContext;
 	FunctionCallInfoData fcinfo;
 	NTupleStorePos orig_pos;
+	bool incremental = gp_enable_incremental_window_agg;
 
 	has_tuples = hasTuplesInFrame(level_state, wstate);
 
@@ -1888,6 +2342,13 @@ computeTransValuesThroughScan(WindowStatePerLevel level_state,
 			(funcstate->isAgg && OidIsValid(funcstate->invprelimfn_oid)) ||
 			!funcstate->isAgg)
 			continue;
+
+		/*
+		 * The entries can be aggregated incrementally only if they can be
+		 * combined through the preliminary function.
+		 */
+		if (!OidIsValid(funcstate->prelimfn_oid))
+			incremental = false;
 		
 		freeTransValue(&funcstate->final_aggTransValue,
 					   funcstate->aggTranstypeByVal,
@@ -1908,8 +2369,12 @@ computeTransValuesThroughScan(WindowStatePerLevel level_state,
 	if (has_tuples)
 	{
 		bool include_last_agg = false;
+
+		if (incremental)
+			computeTransValuesIncrementally(level_state, wstate);
 				
-		while (ntuplestore_acc_tell(level_state->trail_reader, NULL))
+		while (!incremental &&
+			   ntuplestore_acc_tell(level_state->trail_reader, NULL))
 		{
 			if (ntuplestore_acc_tell(level_state->lead_reader, NULL) &&
 				ntuplestore_acc_is_before(level_state->lead_reader,
@@ -393,6 +393,13 @@ CConfigParamMapping::SConfigMappingElem CConfigParamMapping::m_elem[] =
 		GPOS_WSZ_LIT("Enable parallel execution for UNION/UNION ALL queries.")
 		},
 
+		{
+		EopttraceParallel,
+		&optimizer_parallel,
+		false, // m_fNegate
+		GPOS_WSZ_LIT("Enable plan optimization with multiple optimizer workers.")
+		},
+
 		{
 		EopttraceArrayConstraints,
 		&optimizer_array_constraints,
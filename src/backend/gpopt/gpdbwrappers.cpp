@@ -43,10 +43,99 @@
 #include "gpopt/gpdbwrappers.h"
 
 #include "executor/execdesc.h"
+#include "tcop/tcopprot.h"
+
+#include <pthread.h>
+
+//---------------------------------------------------------------------------
+//	@class:
+//		CCatalogAccess
+//
+//	@doc:
+//		Broker of the calls into GPDB. GPDB functions are not thread safe,
+//		so when the optimizer runs with several workers their calls are
+//		serialized through a mutex; nested calls of the thread holding it
+//		pass through. A call made on the stack of a worker thread checks
+//		the stack depth relative to its own stack rather than to the one
+//		of PostgresMain
+//
+//---------------------------------------------------------------------------
+class CCatalogAccess
+{
+	private:
+
+		// mutex serializing the calls
+		static pthread_mutex_t m_mutex;
+
+		// thread holding the mutex
+		static pthread_t m_owner;
+
+		// nesting level of the calls of the holding thread
+		static gpos::ULONG m_ulDepth;
+
+		// stack base to restore, if it was switched
+		char *m_szStackBasePrev;
+
+		// private copy ctor
+		CCatalogAccess(const CCatalogAccess &);
+
+	public:
+
+		// ctor
+		CCatalogAccess()
+			:
+			m_szStackBasePrev(NULL)
+		{
+			pthread_t self = pthread_self();
+			if (0 < m_ulDepth && pthread_equal(m_owner, self))
+			{
+				m_ulDepth++;
+				return;
+			}
+
+			(void) pthread_mutex_lock(&m_mutex);
+			m_owner = self;
+			m_ulDepth = 1;
+
+			long lStackDepth = (long) (stack_base_ptr - (char *) this);
+			if (0 > lStackDepth)
+			{
+				lStackDepth = -lStackDepth;
+			}
+
+			if (NULL != stack_base_ptr && lStackDepth > max_stack_depth * 1024L)
+			{
+				m_szStackBasePrev = stack_base_ptr;
+				stack_base_ptr = (char *) this;
+			}
+		}
+
+		// dtor
+		~CCatalogAccess()
+		{
+			if (1 < m_ulDepth)
+			{
+				m_ulDepth--;
+				return;
+			}
+
+			if (NULL != m_szStackBasePrev)
+			{
+				stack_base_ptr = m_szStackBasePrev;
+			}
+			m_ulDepth = 0;
+			(void) pthread_mutex_unlock(&m_mutex);
+		}
+};
+
+pthread_mutex_t CCatalogAccess::m_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_t CCatalogAccess::m_owner;
+gpos::ULONG CCatalogAccess::m_ulDepth = 0;
 
 #define GP_WRAP_START	\
 	sigjmp_buf local_sigjmp_buf;	\
 	{	\
+		CCatalogAccess ca;	\
 		CAutoExceptionStack aes((void **) &PG_exception_stack, (void**) &error_context_stack);	\
 		if (0 == sigsetjmp(local_sigjmp_buf, 0))	\
 		{	\
@@ -824,6 +913,20 @@ gpdb::HtAttrStats
 	return NULL;
 }
 
+float4
+gpdb::FpDependencyDegree
+	(
+	Query *pquery
+	)
+{
+	GP_WRAP_START;
+	{
+		return query_dependency_degree(pquery);
+	}
+	GP_WRAP_END;
+	return 0.0;
+}
+
 Oid
 gpdb::OidCommutatorOp
 	(
@@ -2841,6 +2944,20 @@ gpdb::PexprEvaluate
 	return NULL;
 }
 
+bool
+gpdb::FHasVolatileFunc
+	(
+	Node *pnode
+	)
+{
+	GP_WRAP_START;
+	{
+		return contain_volatile_functions(pnode);
+	}
+	GP_WRAP_END;
+	return false;
+}
+
 // interpret the value of "With oids" option from a list of defelems
 bool
 gpdb::FInterpretOidsOption
@@ -2931,4 +3048,27 @@ gpdb::UlLeafPartitions
 	return 0;
 }
 
+void
+gpdb::RegisterMDCacheInvalidationCallbacks
+	(
+	CacheCallbackFunction func
+	)
+{
+	GP_WRAP_START;
+	{
+		// relations, including their stats in pg_class
+		CacheRegisterRelcacheCallback(func, (Datum) 0);
+
+		// types, functions, operators, aggregates, casts and column stats
+		CacheRegisterSyscacheCallback(TYPEOID, func, (Datum) 0);
+		CacheRegisterSyscacheCallback(PROCOID, func, (Datum) 0);
+		CacheRegisterSyscacheCallback(OPEROID, func, (Datum) 0);
+		CacheRegisterSyscacheCallback(AGGFNOID, func, (Datum) 0);
+		CacheRegisterSyscacheCallback(CASTSOURCETARGET, func, (Datum) 0);
+		CacheRegisterSyscacheCallback(STATRELATT, func, (Datum) 0);
+		return;
+	}
+	GP_WRAP_END;
+}
+
 // EOF
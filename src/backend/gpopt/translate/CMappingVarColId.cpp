@@ -190,6 +190,36 @@ CMappingVarColId::Insert
 	GPOS_ASSERT(fResult);
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CMappingVarColId::InsertShared
+//
+//	@doc:
+//		Insert an entry of another mapping allocated in the same memory pool.
+//		Keys and values are immutable once inserted, so the new entry shares
+//		them with the original one instead of copying the column name
+//
+//---------------------------------------------------------------------------
+void
+CMappingVarColId::InsertShared
+	(
+	const CGPDBAttOptCol *pgpdbattoptcol
+	)
+{
+	CGPDBAttInfo *pgpdbattinfo = const_cast<CGPDBAttInfo *>(pgpdbattoptcol->Pgpdbattinfo());
+	CGPDBAttOptCol *pgpdbattoptcolShared = const_cast<CGPDBAttOptCol *>(pgpdbattoptcol);
+
+	pgpdbattinfo->AddRef();
+	pgpdbattoptcolShared->AddRef();
+
+#ifdef GPOS_DEBUG
+	BOOL fResult =
+#endif // GPOS_DEBUG
+			m_pmvcmap->FInsert(pgpdbattinfo, pgpdbattoptcolShared);
+
+	GPOS_ASSERT(fResult);
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CMappingVarColId::LoadTblColumns
@@ -487,23 +517,11 @@ CMappingVarColId::PmapvarcolidCopy
 	while (mvcmi.FAdvance())
 	{
 		const CGPDBAttOptCol *pgpdbattoptcol = mvcmi.Pt();
-		const CGPDBAttInfo *pgpdbattinfo = pgpdbattoptcol->Pgpdbattinfo();
-		const COptColInfo *poptcolinfo = pgpdbattoptcol->Poptcolinfo();
 
-		if (pgpdbattinfo->UlQueryLevel() <= ulQueryLevel)
+		if (pgpdbattoptcol->Pgpdbattinfo()->UlQueryLevel() <= ulQueryLevel)
 		{
 			// include all variables defined at same query level or before
-			CGPDBAttInfo *pgpdbattinfoNew = GPOS_NEW(m_pmp) CGPDBAttInfo(pgpdbattinfo->UlQueryLevel(), pgpdbattinfo->UlVarNo(), pgpdbattinfo->IAttNo());
-			COptColInfo *poptcolinfoNew = GPOS_NEW(m_pmp) COptColInfo(poptcolinfo->UlColId(), GPOS_NEW(m_pmp) CWStringConst(m_pmp, poptcolinfo->PstrColName()->Wsz()));
-			pgpdbattinfoNew->AddRef();
-			CGPDBAttOptCol *pgpdbattoptcolNew = GPOS_NEW(m_pmp) CGPDBAttOptCol(pgpdbattinfoNew, poptcolinfoNew);
-
-			// insert into hashmap
-#ifdef GPOS_DEBUG
-			BOOL fResult =
-#endif // GPOS_DEBUG
-					pmapvarcolid->m_pmvcmap->FInsert(pgpdbattinfoNew, pgpdbattoptcolNew);
-			GPOS_ASSERT(fResult);
+			pmapvarcolid->InsertShared(pgpdbattoptcol);
 		}
 	}
 
@@ -532,6 +550,13 @@ CMappingVarColId::PmapvarcolidCopy
 	while (mvcmi.FAdvance())
 	{
 		const CGPDBAttOptCol *pgpdbattoptcol = mvcmi.Pt();
+		if (pmp == m_pmp)
+		{
+			// the copy lives as long as the original, share the entries
+			pmapvarcolid->InsertShared(pgpdbattoptcol);
+			continue;
+		}
+
 		const CGPDBAttInfo *pgpdbattinfo = pgpdbattoptcol->Pgpdbattinfo();
 		const COptColInfo *poptcolinfo = pgpdbattoptcol->Poptcolinfo();
 
@@ -584,14 +609,20 @@ CMappingVarColId::PmapvarcolidRemap
 		const CGPDBAttInfo *pgpdbattinfo = pgpdbattoptcol->Pgpdbattinfo();
 		const COptColInfo *poptcolinfo = pgpdbattoptcol->Poptcolinfo();
 
-		CGPDBAttInfo *pgpdbattinfoNew = GPOS_NEW(pmp) CGPDBAttInfo(pgpdbattinfo->UlQueryLevel(), pgpdbattinfo->UlVarNo(), pgpdbattinfo->IAttNo());
 		ULONG ulColId = poptcolinfo->UlColId();
 		ULONG *pulColIdNew = phmulul->PtLookup(&ulColId);
 		if (NULL != pulColIdNew)
 		{
 			ulColId = *pulColIdNew;
 		}
-		
+		else if (pmp == m_pmp)
+		{
+			// column is not remapped, share the entry
+			pmapvarcolid->InsertShared(pgpdbattoptcol);
+			continue;
+		}
+
+		CGPDBAttInfo *pgpdbattinfoNew = GPOS_NEW(pmp) CGPDBAttInfo(pgpdbattinfo->UlQueryLevel(), pgpdbattinfo->UlVarNo(), pgpdbattinfo->IAttNo());
 		COptColInfo *poptcolinfoNew = GPOS_NEW(pmp) COptColInfo(ulColId, GPOS_NEW(pmp) CWStringConst(pmp, poptcolinfo->PstrColName()->Wsz()));
 		pgpdbattinfoNew->AddRef();
 		CGPDBAttOptCol *pgpdbattoptcolNew = GPOS_NEW(pmp) CGPDBAttOptCol(pgpdbattinfoNew, poptcolinfoNew);
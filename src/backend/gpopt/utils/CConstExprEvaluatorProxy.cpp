@@ -79,6 +79,50 @@ CConstExprEvaluatorProxy::CEmptyMappingColIdVar::PvarFromDXLNodeScId
 	return NULL;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CConstExprEvaluatorProxy::PconstEvaluate
+//
+//	@doc:
+//		Evaluate the translated constant expression 'pexpr'. Constants and
+//		binary compatible casts of constants, which are most of the partition
+//		bounds ORCA asks about, are folded directly; anything else goes
+//		through the executor. Returns NULL if the result is not a Const.
+//
+//---------------------------------------------------------------------------
+Const *
+CConstExprEvaluatorProxy::PconstEvaluate
+	(
+	Expr *pexpr
+	)
+{
+	if (IsA(pexpr, Const))
+	{
+		return (Const *) gpdb::PvCopyObject(pexpr);
+	}
+
+	if (IsA(pexpr, RelabelType) && IsA(((RelabelType *) pexpr)->arg, Const))
+	{
+		RelabelType *prelabel = (RelabelType *) pexpr;
+		Const *pconst = (Const *) gpdb::PvCopyObject(prelabel->arg);
+		pconst->consttype = prelabel->resulttype;
+		pconst->consttypmod = prelabel->resulttypmod;
+		return pconst;
+	}
+
+	Expr *pexprResult = gpdb::PexprEvaluate(pexpr, gpdb::OidExprType((Node *) pexpr));
+	if (!IsA(pexprResult, Const))
+	{
+		#ifdef GPOS_DEBUG
+		elog(NOTICE, "Expression did not evaluate to Const, but to an expression of type %d", nodeTag(pexprResult));
+		#endif
+		gpdb::GPDBFree(pexprResult);
+		return NULL;
+	}
+
+	return (Const *) pexprResult;
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CConstExprEvaluatorProxy::EvaluateExpr
@@ -95,25 +139,50 @@ CConstExprEvaluatorProxy::PdxlnEvaluateExpr
 	)
 {
 	// Translate DXL -> GPDB Expr
-	int resultNodeTag = -1;
 	Expr *pexpr = m_trdxl2scalar.PexprFromDXLNodeScalar(pdxlnExpr, &m_emptymapcidvar);
 	GPOS_ASSERT(NULL != pexpr);
 
-	// Evaluate the expression
-	Expr *pexprResult = gpdb::PexprEvaluate(pexpr, gpdb::OidExprType((Node *)pexpr));
+	// the same partition bounds and casts are evaluated over and over during
+	// partition elimination, so the values of expressions without volatile
+	// functions are remembered for the rest of the optimization
+	CHAR *szExpr = NULL;
+	Const *pconstCached = NULL;
+	if (!gpdb::FHasVolatileFunc((Node *) pexpr))
+	{
+		szExpr = gpdb::SzNodeToString(pexpr);
+		pconstCached = m_phmszconst->PtLookup(szExpr);
+	}
 
-	if (!IsA(pexprResult, Const))
+	Const *pconstResult = pconstCached;
+	if (NULL == pconstResult)
 	{
-		#ifdef GPOS_DEBUG
-		elog(NOTICE, "Expression did not evaluate to Const, but to an expression of type %d", resultNodeTag);
-		#endif
-		GPOS_RAISE(gpdxl::ExmaConstExprEval, gpdxl::ExmiConstExprEvalNonConst);
+		pconstResult = PconstEvaluate(pexpr);
+		if (NULL == pconstResult)
+		{
+			GPOS_RAISE(gpdxl::ExmaConstExprEval, gpdxl::ExmiConstExprEvalNonConst);
+		}
 	}
 
-	Const *pconstResult = (Const *)pexprResult;
 	CDXLDatum *pdxldatum = CTranslatorScalarToDXL::Pdxldatum(m_pmp, m_pmda, pconstResult);
 	CDXLNode *pdxlnResult = GPOS_NEW(m_pmp) CDXLNode(m_pmp, GPOS_NEW(m_pmp) CDXLScalarConstValue(m_pmp, pdxldatum));
-	gpdb::GPDBFree(pexprResult);
+
+	if (NULL != pconstCached)
+	{
+		gpdb::GPDBFree(szExpr);
+	}
+	else if (NULL != szExpr)
+	{
+		// the cache takes ownership of the text and the value
+#ifdef GPOS_DEBUG
+		BOOL fResult =
+#endif // GPOS_DEBUG
+				m_phmszconst->FInsert(szExpr, pconstResult);
+		GPOS_ASSERT(fResult);
+	}
+	else
+	{
+		gpdb::GPDBFree(pconstResult);
+	}
 	gpdb::GPDBFree(pexpr);
 
 	return pdxlnResult;
@@ -53,6 +53,7 @@
 
 #include "gpos/_api.h"
 #include "gpos/common/CAutoP.h"
+#include "gpos/common/CWallClock.h"
 #include "gpos/error/CErrorHandlerStandard.h"
 #include "gpos/error/CLoggerStream.h"
 #include "gpos/io/COstreamFile.h"
@@ -137,7 +138,8 @@ const ULONG rgulExpectedOptFallback[] =
 		gpopt::ExmiInvalidPlanAlternative,		// chosen plan id is outside range of possible plans
 		gpopt::ExmiUnsupportedOp,				// unsupported operator
 		gpopt::ExmiUnsupportedPred,				// unsupported predicate
-		gpopt::ExmiUnsupportedCompositePartKey	// composite partitioning keys
+		gpopt::ExmiUnsupportedCompositePartKey,	// composite partitioning keys
+		gpopt::ExmiNoPlanFound					// no complete plan within the optimization time budget
 	};
 
 // array of DXL minor exception types that trigger expected fallback to the planner
@@ -156,6 +158,10 @@ const ULONG rgulExpectedDXLErrors[] =
 		gpdxl::ExmiQuery2DXLNotNullViolation,	// not null violation
 	};
 
+// the metadata cache is valid until a catalog change is seen
+BOOL COptTasks::m_fMDCacheInvalid = false;
+BOOL COptTasks::m_fMDCacheCallbacksRegistered = false;
+
 
 //---------------------------------------------------------------------------
 //	@function:
@@ -565,6 +571,59 @@ COptTasks::PvMDScCmp
 	return NULL;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::InvalidateMDCache
+//
+//	@doc:
+//		Called on the invalidation of relcache or the syscaches the metadata
+//		objects are translated from. The metadata cache is reset before the
+//		next optimization, as the callback may run in the middle of one
+//
+//---------------------------------------------------------------------------
+void
+COptTasks::InvalidateMDCache
+	(
+	Datum, // arg
+	Oid // oid
+	)
+{
+	m_fMDCacheInvalid = true;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::InitMDCache
+//
+//	@doc:
+//		Initialize the metadata cache. The cache is kept across queries unless
+//		optimizer_release_mdcache is set, so it is reset if the catalog has
+//		changed since it was filled
+//
+//---------------------------------------------------------------------------
+void
+COptTasks::InitMDCache()
+{
+	if (!m_fMDCacheCallbacksRegistered)
+	{
+		gpdb::RegisterMDCacheInvalidationCallbacks(InvalidateMDCache);
+		m_fMDCacheCallbacksRegistered = true;
+	}
+
+	if (m_fMDCacheInvalid && CMDCache::FInitialized())
+	{
+		CMDCache::Shutdown();
+	}
+	m_fMDCacheInvalid = false;
+
+	if (!CMDCache::FInitialized())
+	{
+		CMDCache::Init();
+	}
+}
+
+
 //---------------------------------------------------------------------------
 //	@function:
 //		COptTasks::Execute
@@ -797,19 +856,51 @@ COptTasks::PdrgPssLoad
 	return pdrgpss;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::PdrgPssTimeBudget
+//
+//	@doc:
+//		Build a search strategy made of a single stage that applies all
+//		xforms and ends after the given number of milliseconds; the engine
+//		then extracts the best plan found so far
+//
+//---------------------------------------------------------------------------
+DrgPss *
+COptTasks::PdrgPssTimeBudget
+	(
+	IMemoryPool *pmp,
+	ULONG ulTimeBudget
+	)
+{
+	CXformSet *pxfs = GPOS_NEW(pmp) CXformSet(pmp);
+	pxfs->Union(CXformFactory::Pxff()->PxfsExploration());
+	pxfs->Union(CXformFactory::Pxff()->PxfsImplementation());
+
+	DrgPss *pdrgpss = GPOS_NEW(pmp) DrgPss(pmp);
+	pdrgpss->Append(GPOS_NEW(pmp) CSearchStage(pxfs, ulTimeBudget, CCost(0.0)));
+
+	elog(DEBUG2, "\n[OPT]: Using search strategy bounded by %u ms", ulTimeBudget);
+
+	return pdrgpss;
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		COptTasks::PoconfCreate
 //
 //	@doc:
-//		Create the optimizer configuration
+//		Create the optimizer configuration; the conjuncts of a filter on
+//		columns depending on each other are damped at least as much as
+//		their dependency degree implies
 //
 //---------------------------------------------------------------------------
 COptimizerConfig *
 COptTasks::PoconfCreate
 	(
 	IMemoryPool *pmp,
-	ICostModel *pcm
+	ICostModel *pcm,
+	DOUBLE dDependencyDegree
 	)
 {
 	// get chosen plan number, cost threshold
@@ -817,7 +908,7 @@ COptTasks::PoconfCreate
 	ULLONG ullSamples = (ULLONG) optimizer_samples_number;
 	DOUBLE dCostThreshold = (DOUBLE) optimizer_cost_threshold;
 
-	DOUBLE dDampingFactorFilter = (DOUBLE) optimizer_damping_factor_filter;
+	DOUBLE dDampingFactorFilter = std::min((DOUBLE) optimizer_damping_factor_filter, 1.0 - dDependencyDegree);
 	DOUBLE dDampingFactorJoin = (DOUBLE) optimizer_damping_factor_join;
 	DOUBLE dDampingFactorGroupBy = (DOUBLE) optimizer_damping_factor_groupby;
 
@@ -1009,17 +1100,25 @@ COptTasks::PvOptimizeTask
 	// initially assume no unexpected failure
 	poctx->m_fUnexpectedFailure = false;
 
-	AUTO_MEM_POOL(amp);
+	// the memo and the plan space are shared by the workers of a parallel optimization
+	CAutoMemoryPool amp(CAutoMemoryPool::ElcExc, CMemoryPoolManager::EatTracker, optimizer_parallel /* fThreadSafe */);
 	IMemoryPool *pmp = amp.Pmp();
 
 	// initialize metadata cache
-	if (!CMDCache::FInitialized())
+	InitMDCache();
+
+	// load search strategy, a strategy file keeps the time thresholds of its stages
+	DrgPss *pdrgpss = PdrgPssLoad(pmp, optimizer_search_strategy_path);
+	if (NULL == pdrgpss && 0 < optimizer_time_budget)
 	{
-		CMDCache::Init();
+		pdrgpss = PdrgPssTimeBudget(pmp, (ULONG) optimizer_time_budget);
 	}
 
-	// load search strategy
-	DrgPss *pdrgpss = PdrgPssLoad(pmp, optimizer_search_strategy_path);
+	// wall-clock time of the translation, search and plan translation stages
+	CWallClock timer;
+	ULONG ulTranslateTime = 0;
+	ULONG ulSearchTime = 0;
+	ULONG ulPlanTime = 0;
 
 	CBitSet *pbsTraceFlags = NULL;
 	CBitSet *pbsEnabled = NULL;
@@ -1069,7 +1168,8 @@ COptTasks::PvOptimizeTask
 							);
 
 			ICostModel *pcm = Pcm(pmp, ulSegmentsForCosting);
-			COptimizerConfig *pocconf = PoconfCreate(pmp, pcm);
+			DOUBLE dDependencyDegree = (DOUBLE) gpdb::FpDependencyDegree((Query*) poctx->m_pquery);
+			COptimizerConfig *pocconf = PoconfCreate(pmp, pcm, dDependencyDegree);
 			CConstExprEvaluatorProxy ceevalproxy(pmp, &mda);
 			IConstExprEvaluator *pceeval =
 					GPOS_NEW(pmp) CConstExprEvaluatorDXL(pmp, &mda, &ceevalproxy);
@@ -1079,6 +1179,9 @@ COptTasks::PvOptimizeTask
 			DrgPdxln *pdrgpdxlnCTE = ptrquerytodxl->PdrgpdxlnCTE();
 			GPOS_ASSERT(NULL != pdrgpdxlnQueryOutput);
 
+			ulTranslateTime = timer.UlElapsedMS();
+			timer.Restart();
+
 			BOOL fMasterOnly = !optimizer_enable_motions ||
 						(!optimizer_enable_motions_masteronly_queries && !ptrquerytodxl->FHasDistributedTables());
 			CAutoTraceFlag atf(EopttraceDisableMotions, fMasterOnly);
@@ -1098,6 +1201,9 @@ COptTasks::PvOptimizeTask
 									pocconf
 									);
 
+			ulSearchTime = timer.UlElapsedMS();
+			timer.Restart();
+
 			if (poctx->m_fSerializePlanDXL)
 			{
 				// serialize DXL to xml
@@ -1114,6 +1220,13 @@ COptTasks::PvOptimizeTask
 				poctx->m_pplstmt = (PlannedStmt *) gpdb::PvCopyObject(Pplstmt(pmp, &mda, pdxlnPlan, poctx->m_pquery->canSetTag));
 			}
 
+			ulPlanTime = timer.UlElapsedMS();
+			if (optimizer_print_optimization_stats)
+			{
+				elog(LOG, "[OPT]: Query to DXL translation: %u ms, search: %u ms, DXL to plan translation: %u ms",
+					 ulTranslateTime, ulSearchTime, ulPlanTime);
+			}
+
 			CStatisticsConfig *pstatsconf = pocconf->Pstatsconf();
 			pdrgmdidCol = GPOS_NEW(pmp) DrgPmdid(pmp);
 			pstatsconf->CollectMissingStatsColumns(pdrgmdidCol);
@@ -1271,7 +1384,7 @@ COptTasks::PvOptimizeMinidumpTask
 	}
 
 	ICostModel *pcm = Pcm(pmp, ulSegmentsForCosting);
-	COptimizerConfig *pocconf = PoconfCreate(pmp, pcm);
+	COptimizerConfig *pocconf = PoconfCreate(pmp, pcm, 0.0 /* dDependencyDegree */);
 	CDXLNode *pdxlnResult = NULL;
 
 	GPOS_TRY
@@ -1565,13 +1678,9 @@ COptTasks::PvEvalExprFromDXLTask
 	GPOS_ASSERT(NULL != pdxlnInput);
 
 	CDXLNode *pdxlnResult = NULL;
-	BOOL fReleaseCache = false;
-	// initialize metadata cache
-	if (!CMDCache::FInitialized())
-	{
-		CMDCache::Init();
-		fReleaseCache = true;
-	}
+	// initialize metadata cache, release it after evaluation if it is new
+	BOOL fReleaseCache = !CMDCache::FInitialized();
+	InitMDCache();
 
 	GPOS_TRY
 	{
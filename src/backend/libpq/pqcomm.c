@@ -113,7 +113,13 @@ static char sock_path[MAXPGPATH];
 
 #define PQ_BUFFER_SIZE 8192
 
-static char PqSendBuffer[PQ_BUFFER_SIZE];
+/*
+ * The send buffer is larger, so that a big query result goes out in a few
+ * large writes rather than one secure_write() per 8kB.
+ */
+#define PQ_SEND_BUFFER_SIZE 65536
+
+static char PqSendBuffer[PQ_SEND_BUFFER_SIZE];
 static int	PqSendPointer;		/* Next index to store a byte in PqSendBuffer */
 
 static char PqRecvBuffer[PQ_BUFFER_SIZE];
@@ -1333,10 +1339,10 @@ internal_putbytes(const char *s, size_t len)
 	while (len > 0)
 	{
 		/* If buffer is full, then flush it out */
-		if (PqSendPointer >= PQ_BUFFER_SIZE)
+		if (PqSendPointer >= PQ_SEND_BUFFER_SIZE)
 			if (internal_flush())
 				return EOF;
-		amount = PQ_BUFFER_SIZE - PqSendPointer;
+		amount = PQ_SEND_BUFFER_SIZE - PqSendPointer;
 		if (amount > len)
 			amount = len;
 		memcpy(PqSendBuffer + PqSendPointer, s, amount);
@@ -96,6 +96,24 @@ pq_beginmessage(StringInfo buf, char msgtype)
 	buf->cursor = msgtype;
 }
 
+/* --------------------------------
+ *		pq_beginmessage_reuse	- initialize for sending a message, reusing
+ *		the buffer of a previous one
+ *
+ * The buffer must have been initialized with initStringInfo, and is only
+ * reset, so that sending many messages of similar size, such as the
+ * DataRows of a query result, doesn't allocate memory for each one.
+ * --------------------------------
+ */
+void
+pq_beginmessage_reuse(StringInfo buf, char msgtype)
+{
+	resetStringInfo(buf);
+
+	/* see pq_beginmessage */
+	buf->cursor = msgtype;
+}
+
 /* --------------------------------
  *		pq_sendbyte		- append a raw byte to a StringInfo buffer
  * --------------------------------
@@ -349,6 +367,18 @@ pq_endmessage(StringInfo buf)
 	buf->data = NULL;
 }
 
+/* --------------------------------
+ *		pq_endmessage_reuse	- send the completed message to the frontend,
+ *		keeping the buffer for the next pq_beginmessage_reuse
+ * --------------------------------
+ */
+void
+pq_endmessage_reuse(StringInfo buf)
+{
+	/* msgtype was saved in cursor field */
+	(void) pq_putmessage(buf->cursor, buf->data, buf->len);
+}
+
 
 /* --------------------------------
  *		pq_begintypsend		- initialize for constructing a bytea result
@@ -0,0 +1,322 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*-------------------------------------------------------------------------
+ *
+ * rangercache.c
+ *	cache of the privilege decisions of the ranger plugin service
+ *
+ * A decision is cached for hawq_rps_cache_timeout seconds, in the backend
+ * that asked for it and in shared memory for the other backends of the
+ * master.  Both caches are set associative: a key can only be in one set
+ * of RANGER_CACHE_WAYS entries, and the least recently used entry of the
+ * set is replaced.
+ *
+ * When RPS reports a new policy version every cached decision is dropped,
+ * by bumping the generation the entries are checked against.  The local
+ * caches use the generation in shared memory, so they are invalidated too.
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/hash.h"
+#include "postmaster/identity.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/acl.h"
+#include "utils/guc.h"
+#include "utils/memutils.h"
+#include "utils/rangercache.h"
+#include "utils/timestamp.h"
+
+#define RANGER_CACHE_WAYS 4
+
+/* number of decisions a backend keeps for itself */
+#define RANGER_LOCAL_CACHE_SIZE 256
+
+typedef struct RangerCacheEntry
+{
+	uint32		hash;
+	int			keylen;			/* 0 if the entry is free */
+	uint32		generation;
+	bool		allowed;
+	TimestampTz expires;
+	uint64		lastused;
+	char		key[RANGER_CACHE_KEY_LEN];
+} RangerCacheEntry;
+
+typedef struct RangerCache
+{
+	int			nsets;
+	uint32		generation;		/* entries of other generations are stale */
+	int64		policyVersion;	/* last reported by RPS, 0 if unknown */
+	uint64		clock;			/* ticks at every use of an entry */
+	RangerCacheEntry entries[1];	/* VARIABLE LENGTH ARRAY */
+} RangerCache;
+
+static RangerCache *sharedCache = NULL;
+static LWLockId *sharedCacheLock = NULL;
+
+static RangerCache *localCache = NULL;
+
+static int
+RangerCacheSets(int nentries)
+{
+	return (nentries + RANGER_CACHE_WAYS - 1) / RANGER_CACHE_WAYS;
+}
+
+static Size
+RangerCacheSize(int nsets)
+{
+	return add_size(offsetof(RangerCache, entries),
+					mul_size(sizeof(RangerCacheEntry),
+							 mul_size(nsets, RANGER_CACHE_WAYS)));
+}
+
+/*
+ * The shared cache only lives on the master and the standby, where the
+ * privileges are checked.
+ */
+static bool
+RangerCacheShared(void)
+{
+	return rps_cache_size > 0 && (AmIMaster() || AmIStandby()) &&
+		strcasecmp(acl_type, HAWQ_ACL_TYPE_RANGER) == 0;
+}
+
+Size
+RangerCache_ShmemSize(void)
+{
+	if (!RangerCacheShared())
+		return 0;
+
+	return add_size(sizeof(LWLockId),
+					RangerCacheSize(RangerCacheSets(rps_cache_size)));
+}
+
+void
+RangerCache_ShmemInit(void)
+{
+	bool		found;
+	int			nsets;
+
+	if (!RangerCacheShared())
+		return;
+
+	nsets = RangerCacheSets(rps_cache_size);
+
+	sharedCacheLock = ShmemInitStruct("Ranger Cache Lock", sizeof(LWLockId),
+									  &found);
+	if (!found)
+		*sharedCacheLock = LWLockAssign();
+
+	sharedCache = ShmemInitStruct("Ranger Cache", RangerCacheSize(nsets),
+								  &found);
+	if (!sharedCache)
+		elog(FATAL, "could not initialize ranger decision cache");
+
+	if (!found)
+	{
+		memset(sharedCache, 0, RangerCacheSize(nsets));
+		sharedCache->nsets = nsets;
+	}
+}
+
+static RangerCache *
+RangerCacheLocal(void)
+{
+	if (localCache == NULL)
+	{
+		int			nsets = RangerCacheSets(RANGER_LOCAL_CACHE_SIZE);
+
+		localCache = MemoryContextAllocZero(TopMemoryContext,
+											RangerCacheSize(nsets));
+		localCache->nsets = nsets;
+	}
+	return localCache;
+}
+
+/*
+ * The cache whose generation and policy version are authoritative: the
+ * shared one, or the backend's own when there is none.
+ */
+static RangerCache *
+RangerCacheOwner(void)
+{
+	return sharedCache ? sharedCache : RangerCacheLocal();
+}
+
+static RangerCacheEntry *
+RangerCacheFind(RangerCache *cache, uint32 hash, const char *key, int keylen,
+				uint32 generation, TimestampTz now)
+{
+	RangerCacheEntry *set = &cache->entries[(hash % cache->nsets) * RANGER_CACHE_WAYS];
+	int			i;
+
+	for (i = 0; i < RANGER_CACHE_WAYS; i++)
+	{
+		RangerCacheEntry *entry = &set[i];
+
+		if (entry->keylen == keylen && entry->hash == hash &&
+			entry->generation == generation && entry->expires > now &&
+			memcmp(entry->key, key, keylen) == 0)
+		{
+			entry->lastused = ++cache->clock;
+			return entry;
+		}
+	}
+	return NULL;
+}
+
+static void
+RangerCachePut(RangerCache *cache, uint32 hash, const char *key, int keylen,
+			   uint32 generation, bool allowed, TimestampTz expires)
+{
+	RangerCacheEntry *set = &cache->entries[(hash % cache->nsets) * RANGER_CACHE_WAYS];
+	RangerCacheEntry *victim = NULL;
+	int			i;
+
+	for (i = 0; i < RANGER_CACHE_WAYS; i++)
+	{
+		RangerCacheEntry *entry = &set[i];
+
+		/* the same key, a free entry or a stale one are taken first */
+		if ((entry->keylen == keylen && entry->hash == hash &&
+			 memcmp(entry->key, key, keylen) == 0) ||
+			entry->keylen == 0 || entry->generation != generation)
+		{
+			victim = entry;
+			break;
+		}
+		if (victim == NULL || entry->lastused < victim->lastused)
+			victim = entry;
+	}
+
+	victim->hash = hash;
+	victim->keylen = keylen;
+	victim->generation = generation;
+	victim->allowed = allowed;
+	victim->expires = expires;
+	victim->lastused = ++cache->clock;
+	memcpy(victim->key, key, keylen);
+}
+
+/*
+ * Look up the decision for a key, in the backend's cache and then in the
+ * shared one.  Returns false if it is not cached, or no longer valid.
+ */
+bool
+RangerCacheLookup(const char *key, int keylen, bool *allowed)
+{
+	RangerCache *local;
+	RangerCacheEntry *entry;
+	TimestampTz now;
+	uint32		hash;
+	uint32		generation;
+	bool		found = false;
+
+	if (rps_cache_timeout <= 0 || keylen > RANGER_CACHE_KEY_LEN)
+		return false;
+
+	hash = DatumGetUInt32(hash_any((const unsigned char *) key, keylen));
+	now = GetCurrentTimestamp();
+	local = RangerCacheLocal();
+
+	if (sharedCache)
+		LWLockAcquire(*sharedCacheLock, LW_EXCLUSIVE);
+
+	generation = RangerCacheOwner()->generation;
+
+	entry = RangerCacheFind(local, hash, key, keylen, generation, now);
+	if (entry == NULL && sharedCache)
+	{
+		entry = RangerCacheFind(sharedCache, hash, key, keylen, generation, now);
+		if (entry)
+			RangerCachePut(local, hash, key, keylen, generation,
+						   entry->allowed, entry->expires);
+	}
+	if (entry)
+	{
+		*allowed = entry->allowed;
+		found = true;
+	}
+
+	if (sharedCache)
+		LWLockRelease(*sharedCacheLock);
+
+	return found;
+}
+
+/*
+ * Remember a decision RPS has just made.
+ */
+void
+RangerCacheInsert(const char *key, int keylen, bool allowed)
+{
+	TimestampTz expires;
+	uint32		hash;
+	uint32		generation;
+
+	if (rps_cache_timeout <= 0 || keylen > RANGER_CACHE_KEY_LEN)
+		return;
+
+	hash = DatumGetUInt32(hash_any((const unsigned char *) key, keylen));
+	expires = TimestampTzPlusMilliseconds(GetCurrentTimestamp(),
+										  rps_cache_timeout * 1000);
+
+	if (sharedCache)
+		LWLockAcquire(*sharedCacheLock, LW_EXCLUSIVE);
+
+	generation = RangerCacheOwner()->generation;
+
+	RangerCachePut(RangerCacheLocal(), hash, key, keylen, generation,
+				   allowed, expires);
+	if (sharedCache)
+		RangerCachePut(sharedCache, hash, key, keylen, generation,
+					   allowed, expires);
+
+	if (sharedCache)
+		LWLockRelease(*sharedCacheLock);
+}
+
+/*
+ * Note the policy version a response of RPS was made with.  A change drops
+ * every cached decision.
+ */
+void
+RangerCacheSetPolicyVersion(int64 version)
+{
+	RangerCache *owner = RangerCacheOwner();
+
+	if (sharedCache)
+		LWLockAcquire(*sharedCacheLock, LW_EXCLUSIVE);
+
+	if (owner->policyVersion != version)
+	{
+		elog(LOG, "ranger policy version changed from " INT64_FORMAT
+			 " to " INT64_FORMAT ", dropping cached decisions",
+			 owner->policyVersion, version);
+		owner->policyVersion = version;
+		owner->generation++;
+	}
+
+	if (sharedCache)
+		LWLockRelease(*sharedCacheLock);
+}
@@ -25,6 +25,7 @@
  *-------------------------------------------------------------------------
  */
 #include "utils/rangerrest.h"
+#include "utils/rangercache.h"
 #include "utils/hsearch.h"
 #include "cdb/cdbvars.h"
 
@@ -91,6 +92,12 @@ static int parse_ranger_response(char* buffer, List *result_list)
 		return -1;
 	}
 
+	/* a new policy version makes the cached decisions stale */
+	struct json_object *versionObj = NULL;
+	if (json_object_object_get_ex(response, "policyVersion", &versionObj) &&
+		json_object_get_type(versionObj) == json_type_int)
+		RangerCacheSetPolicyVersion(json_object_get_int64(versionObj));
+
 	struct json_object *accessObj = NULL;
 	if (!json_object_object_get_ex(response, "access", &accessObj))
 	{
@@ -497,15 +504,88 @@ static int call_ranger_rest(CURL_HANDLE curl_handle, const char* request)
 	return ret;
 }
 
+/*
+ * Build the key of a check in the decision cache: everything the decision
+ * of RPS depends on, each part ended by a '\0' that no name contains.
+ */
+static void build_ranger_cache_key(StringInfo key, RangerRequestJsonArgs *arg,
+	const char *client_ip)
+{
+	ListCell *cell;
+
+	resetStringInfo(key);
+	appendBinaryStringInfo(key, arg->user, strlen(arg->user) + 1);
+	appendBinaryStringInfo(key, client_ip, strlen(client_ip) + 1);
+	appendBinaryStringInfo(key, AclObjectKindStr[arg->kind],
+		strlen(AclObjectKindStr[arg->kind]) + 1);
+	appendBinaryStringInfo(key, arg->object, strlen(arg->object) + 1);
+	foreach(cell, arg->actions)
+	{
+		char *action = (char *) lfirst(cell);
+		appendBinaryStringInfo(key, action, strlen(action) + 1);
+	}
+}
+
 /*
  * check privilege(s) from ranger
+ *
+ * The decisions found in the cache are not asked again, all the others are
+ * sent to ranger in one request and cached.
+ *
  * @param	request_list	List of RangerRequestJsonArgs
  * @param	result_list		List of RangerPrivilegeResults
  * @return	0 get response from ranger and parse success; -1 other error
  */
 int check_privilege_from_ranger(List *request_list, List *result_list)
 {
-	json_object* jrequest = create_ranger_request_json(request_list, result_list);
+	List *miss_requests = request_list;
+	List *miss_results = result_list;
+	List *miss_keys = NIL;
+	bool use_cache = rps_cache_timeout > 0;
+
+	if (use_cache)
+	{
+		char remote_host[HOST_BUFFER_SIZE];
+		StringInfoData key;
+		ListCell *req;
+		ListCell *res;
+
+		getClientIP(remote_host);
+		initStringInfo(&key);
+		miss_requests = NIL;
+		miss_results = NIL;
+		forboth(req, request_list, res, result_list)
+		{
+			RangerRequestJsonArgs *arg_ptr = (RangerRequestJsonArgs *) lfirst(req);
+			RangerPrivilegeResults *result_ptr = (RangerPrivilegeResults *) lfirst(res);
+			bool allowed;
+
+			build_ranger_cache_key(&key, arg_ptr, remote_host);
+			if (RangerCacheLookup(key.data, key.len, &allowed))
+			{
+				result_ptr->result = allowed ? RANGERCHECK_OK : RANGERCHECK_NO_PRIV;
+				continue;
+			}
+
+			/* tells apart the results the response does not mention */
+			result_ptr->result = RANGERCHECK_UNKNOWN;
+			miss_requests = lappend(miss_requests, arg_ptr);
+			miss_results = lappend(miss_results, result_ptr);
+			StringInfo miss_key = makeStringInfo();
+			appendBinaryStringInfo(miss_key, key.data, key.len);
+			miss_keys = lappend(miss_keys, miss_key);
+		}
+		pfree(key.data);
+
+		elog(RANGER_LOG, "%d of %d privilege checks found in ranger decision cache",
+			list_length(request_list) - list_length(miss_requests),
+			list_length(request_list));
+
+		if (miss_requests == NIL)
+			return 0;
+	}
+
+	json_object* jrequest = create_ranger_request_json(miss_requests, miss_results);
 	Assert(jrequest != NULL);
 
 	const char *request = json_object_to_json_string(jrequest);
@@ -523,7 +603,7 @@ int check_privilege_from_ranger(List *request_list, List *result_list)
 	json_object_put(jrequest);
 
 	/* parse the JSON-format result */
-	int ret = parse_ranger_response(curl_context_ranger.response.buffer, result_list);
+	int ret = parse_ranger_response(curl_context_ranger.response.buffer, miss_results);
 	if (ret < 0)
 	{
 		elog(ERROR, "parse ranger response failed, ranger response content is %s",
@@ -535,5 +615,27 @@ int check_privilege_from_ranger(List *request_list, List *result_list)
 		curl_context_ranger.response.response_size = 0;
 	}
 
+	if (use_cache)
+	{
+		ListCell *res;
+		ListCell *k;
+
+		forboth(res, miss_results, k, miss_keys)
+		{
+			RangerPrivilegeResults *result_ptr = (RangerPrivilegeResults *) lfirst(res);
+			StringInfo miss_key = (StringInfo) lfirst(k);
+
+			if (result_ptr->result == RANGERCHECK_UNKNOWN)
+				result_ptr->result = RANGERCHECK_NO_PRIV;
+			else
+				RangerCacheInsert(miss_key->data, miss_key->len,
+					result_ptr->result == RANGERCHECK_OK);
+			pfree(miss_key->data);
+		}
+		list_free(miss_requests);
+		list_free(miss_results);
+		list_free_deep(miss_keys);
+	}
+
 	return ret;
 }
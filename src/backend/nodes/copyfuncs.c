@@ -1079,6 +1079,7 @@ _copyHash(Hash *from)
 	/*
 	 * copy remainder of node
 	 */
+	COPY_NODE_FIELD(skewValues);
 
 	return newnode;
 }
@@ -1149,6 +1150,8 @@ _copyMotion(Motion *from)
 
 	COPY_NODE_FIELD(hashExpr);
 	COPY_NODE_FIELD(hashDataTypes);
+	COPY_NODE_FIELD(skewHashes);
+	COPY_SCALAR_FIELD(skewBroadcast);
 
 	COPY_SCALAR_FIELD(numOutputSegs);
 	COPY_POINTER_FIELD(outputSegIdx, from->numOutputSegs * sizeof(int));
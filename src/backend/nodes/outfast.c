@@ -1022,6 +1022,7 @@ _outHash(StringInfo str, Hash *node)
 
 	_outPlanInfo(str, (Plan *) node);
     WRITE_BOOL_FIELD(rescannable);          /*CDB*/
+	WRITE_NODE_FIELD(skewValues);
 }
 
 static void
@@ -1036,6 +1037,8 @@ _outMotion(StringInfo str, Motion *node)
 
 	WRITE_LIST_FIELD(hashExpr);
 	WRITE_LIST_FIELD(hashDataTypes);
+	WRITE_LIST_FIELD(skewHashes);
+	WRITE_BOOL_FIELD(skewBroadcast);
 
 	WRITE_INT_FIELD(numOutputSegs);
 	WRITE_INT_ARRAY(outputSegIdx, numOutputSegs, int);
@@ -1882,6 +1885,8 @@ _outCdbMotionPath(StringInfo str, CdbMotionPath *node)
     _outPathInfo(str, &node->path);
 
     WRITE_NODE_FIELD(subpath);
+    WRITE_NODE_FIELD(skewHashes);
+    WRITE_BOOL_FIELD(skewBroadcast);
 }
 
 static void
@@ -1005,6 +1005,7 @@ _outHash(StringInfo str, Hash *node)
 
 	_outPlanInfo(str, (Plan *) node);
     WRITE_BOOL_FIELD(rescannable);          /*CDB*/
+	WRITE_NODE_FIELD(skewValues);
 }
 
 static void
@@ -1021,6 +1022,8 @@ _outMotion(StringInfo str, Motion *node)
 
 	WRITE_NODE_FIELD(hashExpr);
 	WRITE_NODE_FIELD(hashDataTypes);
+	WRITE_NODE_FIELD(skewHashes);
+	WRITE_BOOL_FIELD(skewBroadcast);
 
 	WRITE_INT_FIELD(numOutputSegs);
 	appendStringInfoLiteral(str, " :outputSegIdx");
@@ -1927,6 +1930,8 @@ _outCdbMotionPath(StringInfo str, CdbMotionPath *node)
     _outPathInfo(str, &node->path);
 
     WRITE_NODE_FIELD(subpath);
+    WRITE_NODE_FIELD(skewHashes);
+    WRITE_BOOL_FIELD(skewBroadcast);
 }
 
 static void
@@ -3682,6 +3682,7 @@ _readHash(const char ** str)
 
 	readPlanInfo(str, (Plan *)local_node);
     READ_BOOL_FIELD(rescannable);           /*CDB*/
+	READ_NODE_FIELD(skewValues);
 
 	READ_DONE();
 }
@@ -3726,6 +3727,8 @@ _readMotion(const char ** str)
 
 	READ_NODE_FIELD(hashExpr);
 	READ_NODE_FIELD(hashDataTypes);
+	READ_NODE_FIELD(skewHashes);
+	READ_BOOL_FIELD(skewBroadcast);
 
 	READ_INT_FIELD(numOutputSegs);
 	READ_INT_ARRAY(outputSegIdx, numOutputSegs, int);
@@ -33,12 +33,20 @@
  */
 #include "postgres.h"
 
+#include "access/skey.h"                /* BTEqualStrategyNumber */
+#include "commands/tablecmds.h"         /* RelationBuildPartitionDescByOid */
 #include "miscadmin.h"                  /* CHECK_FOR_INTERRUPTS */
+#include "optimizer/cost.h"
 #include "optimizer/joininfo.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/paths.h"
+#include "optimizer/prep.h"             /* adjust_appendrel_attrs */
+#include "parser/parsetree.h"           /* rt_fetch */
+#include "utils/lsyscache.h"
 
 #include "cdb/cdbdef.h"                 /* CdbSwap */
+#include "cdb/cdbpartition.h"
+#include "cdb/cdbpathlocus.h"
 
 
 static List *make_rels_by_clause_joins(PlannerInfo *root,
@@ -55,6 +63,12 @@ cdb_add_subquery_join_paths(PlannerInfo    *root,
 					        JoinType        jointype,
 					        JoinType        swapjointype,
 					        List           *restrictlist);
+static void try_partitionwise_join(PlannerInfo *root,
+					   RelOptInfo *joinrel,
+					   RelOptInfo *rel1,
+					   RelOptInfo *rel2,
+					   JoinType jointype,
+					   List *restrictlist);
 static bool has_join_restriction(PlannerInfo *root, RelOptInfo *rel);
 static bool has_legal_joinclause(PlannerInfo *root, RelOptInfo *rel);
 
@@ -574,6 +588,9 @@ make_join_rel(PlannerInfo *root, RelOptInfo *rel1, RelOptInfo *rel2)
     {
         add_paths_to_joinrel(root, joinrel, rel1, rel2, jointype, restrictlist);
         add_paths_to_joinrel(root, joinrel, rel2, rel1, swapjointype, restrictlist);
+
+        /* CDB: Consider joining the tables one pair of partitions at a time. */
+        try_partitionwise_join(root, joinrel, rel1, rel2, jointype, restrictlist);
     }
 
 	bms_free(joinrelids);
@@ -686,6 +703,353 @@ cdb_add_subquery_join_paths(PlannerInfo    *root,
 }                               /* cdb_add_subquery_join_paths */
 
 
+/*
+ * find_partition_appinfo
+ *	  Returns the AppendRelInfo of the leaf partition 'childoid' of the
+ *	  appendrel 'rel', or NULL if it is not a member of it.
+ */
+static AppendRelInfo *
+find_partition_appinfo(PlannerInfo *root, RelOptInfo *rel, Oid childoid)
+{
+	ListCell   *l;
+
+	foreach(l, root->append_rel_list)
+	{
+		AppendRelInfo *appinfo = (AppendRelInfo *) lfirst(l);
+
+		if (appinfo->parent_relid == rel->relid &&
+			planner_rt_fetch(appinfo->child_relid, root)->relid == childoid)
+			return appinfo;
+	}
+	return NULL;
+}
+
+/*
+ * have_partkey_equijoin
+ *	  Is there a join clause equating column 'attno1' of rel1 with column
+ *	  'attno2' of rel2, by the equality operator of the partitioning opclass?
+ */
+static bool
+have_partkey_equijoin(RelOptInfo *rel1, AttrNumber attno1,
+					  RelOptInfo *rel2, AttrNumber attno2,
+					  Oid opclass, List *restrictlist)
+{
+	Oid			eqop = get_opclass_member(opclass, InvalidOid,
+										  BTEqualStrategyNumber);
+	ListCell   *l;
+
+	if (!OidIsValid(eqop))
+		return false;
+
+	foreach(l, restrictlist)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(l);
+		OpExpr	   *clause = (OpExpr *) rinfo->clause;
+		Var		   *leftvar;
+		Var		   *rightvar;
+
+		if (!IsA(clause, OpExpr) ||
+			clause->opno != eqop ||
+			list_length(clause->args) != 2)
+			continue;
+
+		leftvar = (Var *) linitial(clause->args);
+		rightvar = (Var *) lsecond(clause->args);
+		if (!IsA(leftvar, Var) || !IsA(rightvar, Var) ||
+			leftvar->varlevelsup != 0 || rightvar->varlevelsup != 0)
+			continue;
+
+		if (leftvar->varno == rel2->relid)
+			CdbSwap(Var *, leftvar, rightvar);
+
+		if (leftvar->varno == rel1->relid && leftvar->varattno == attno1 &&
+			rightvar->varno == rel2->relid && rightvar->varattno == attno2)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * partition_rules_match
+ *	  Do two partitions hold the same range or list of partitioning keys?
+ */
+static bool
+partition_rules_match(PartitionRule *rule1, PartitionRule *rule2)
+{
+	return rule1->parisdefault == rule2->parisdefault &&
+		rule1->parrangestartincl == rule2->parrangestartincl &&
+		rule1->parrangeendincl == rule2->parrangeendincl &&
+		equal(rule1->parrangestart, rule2->parrangestart) &&
+		equal(rule1->parrangeend, rule2->parrangeend) &&
+		equal(rule1->parlistvalues, rule2->parlistvalues);
+}
+
+/*
+ * match_partitions
+ *	  Pair up the partitions of rel1 and rel2 that can hold joining rows.
+ *
+ * Returns a List of two element Lists, the AppendRelInfos of a partition of
+ * rel1 and of the partition of rel2 with the same bounds.  Returns NIL
+ * unless rel1 and rel2 are partitioned alike, on one level, and the join
+ * equates their partitioning keys.
+ */
+static List *
+match_partitions(PlannerInfo *root, RelOptInfo *rel1, RelOptInfo *rel2,
+				 List *restrictlist)
+{
+	RangeTblEntry *rte1;
+	RangeTblEntry *rte2;
+	PartitionNode *pn1;
+	PartitionNode *pn2;
+	List	   *rules1;
+	List	   *rules2;
+	List	   *pairs = NIL;
+	ListCell   *l1;
+	int			i;
+
+	if (rel1->reloptkind != RELOPT_BASEREL ||
+		rel2->reloptkind != RELOPT_BASEREL ||
+		rel1->rtekind != RTE_RELATION ||
+		rel2->rtekind != RTE_RELATION)
+		return NIL;
+
+	rte1 = planner_rt_fetch(rel1->relid, root);
+	rte2 = planner_rt_fetch(rel2->relid, root);
+	if (!rte1->inh || !rte2->inh ||
+		!rel_is_partitioned(rte1->relid) ||
+		!rel_is_partitioned(rte2->relid))
+		return NIL;
+
+	pn1 = RelationBuildPartitionDescByOid(rte1->relid, false);
+	pn2 = RelationBuildPartitionDescByOid(rte2->relid, false);
+	if (!pn1 || !pn2 ||
+		num_partition_levels(pn1) != 1 ||
+		num_partition_levels(pn2) != 1 ||
+		pn1->part->parkind != pn2->part->parkind ||
+		pn1->part->parnatts != pn2->part->parnatts ||
+		list_length(pn1->rules) != list_length(pn2->rules) ||
+		(pn1->default_part == NULL) != (pn2->default_part == NULL))
+		return NIL;
+
+	for (i = 0; i < pn1->part->parnatts; i++)
+	{
+		if (pn1->part->parclass[i] != pn2->part->parclass[i] ||
+			!have_partkey_equijoin(rel1, pn1->part->paratts[i],
+								   rel2, pn2->part->paratts[i],
+								   pn1->part->parclass[i], restrictlist))
+			return NIL;
+	}
+
+	rules1 = list_copy(pn1->rules);
+	rules2 = list_copy(pn2->rules);
+	if (pn1->default_part)
+	{
+		rules1 = lappend(rules1, pn1->default_part);
+		rules2 = lappend(rules2, pn2->default_part);
+	}
+
+	foreach(l1, rules1)
+	{
+		PartitionRule *rule1 = (PartitionRule *) lfirst(l1);
+		PartitionRule *rule2 = NULL;
+		AppendRelInfo *appinfo1;
+		AppendRelInfo *appinfo2;
+		ListCell   *l2;
+
+		foreach(l2, rules2)
+		{
+			if (partition_rules_match(rule1, (PartitionRule *) lfirst(l2)))
+			{
+				rule2 = (PartitionRule *) lfirst(l2);
+				break;
+			}
+		}
+		if (!rule2)
+			return NIL;
+		rules2 = list_delete_ptr(rules2, rule2);
+
+		appinfo1 = find_partition_appinfo(root, rel1, rule1->parchildrelid);
+		appinfo2 = find_partition_appinfo(root, rel2, rule2->parchildrelid);
+		if (!appinfo1 || !appinfo2)
+			return NIL;
+
+		pairs = lappend(pairs, list_make2(appinfo1, appinfo2));
+	}
+
+	return pairs;
+}
+
+/*
+ * build_partition_join_rel
+ *	  Builds the join of two partitions, and its paths.
+ *
+ * The join clauses are those of the joinrel of their tables, and its output
+ * has the same columns in the same order, so that the joins of all the pairs
+ * of partitions can be appended as the joinrel.  It is not added to the
+ * list of joinrels, no other join is made from it.  Returns NULL if no path
+ * could be made.
+ */
+static RelOptInfo *
+build_partition_join_rel(PlannerInfo *root,
+						 RelOptInfo *joinrel,
+						 AppendRelInfo *appinfo1,
+						 AppendRelInfo *appinfo2,
+						 JoinType jointype,
+						 List *restrictlist)
+{
+	RelOptInfo *childrel1 = find_base_rel(root, appinfo1->child_relid);
+	RelOptInfo *childrel2 = find_base_rel(root, appinfo2->child_relid);
+	RelOptInfo *childjoinrel;
+	List	   *childrestrictlist;
+	Node	   *node;
+
+	childjoinrel = makeNode(RelOptInfo);
+	childjoinrel->reloptkind = RELOPT_JOINREL;
+	childjoinrel->relids = bms_union(childrel1->relids, childrel2->relids);
+	childjoinrel->rtekind = RTE_JOIN;
+	childjoinrel->width = joinrel->width;
+
+	node = adjust_appendrel_attrs(root, (Node *) joinrel->reltargetlist, appinfo1);
+	node = adjust_appendrel_attrs(root, node, appinfo2);
+	childjoinrel->reltargetlist = (List *) node;
+
+	node = adjust_appendrel_attrs(root, (Node *) restrictlist, appinfo1);
+	node = adjust_appendrel_attrs(root, node, appinfo2);
+	childrestrictlist = (List *) node;
+
+	set_joinrel_size_estimates(root, childjoinrel, childrel1, childrel2,
+							   jointype, childrestrictlist);
+
+	add_paths_to_joinrel(root, childjoinrel, childrel1, childrel2,
+						 jointype, childrestrictlist);
+	add_paths_to_joinrel(root, childjoinrel, childrel2, childrel1,
+						 jointype, childrestrictlist);
+
+	if (!childjoinrel->pathlist)
+		return NULL;
+
+	set_cheapest(root, childjoinrel);
+	return childjoinrel;
+}
+
+/*
+ * The paths of a partition are hashed on non-canonical pathkeys, which are
+ * not matched to the join clauses.  Make them canonical, so that the join of
+ * two partitions distributed alike is seen to need no motion.
+ */
+static void
+canonicalize_partition_loci(PlannerInfo *root, RelOptInfo *childrel)
+{
+	ListCell   *l;
+
+	foreach(l, childrel->pathlist)
+	{
+		Path	   *path = (Path *) lfirst(l);
+
+		path->locus = cdbpathlocus_canonicalize(root, path->locus);
+	}
+}
+
+static CdbVisitOpt
+partition_join_motion_walker(Path *path, void *context)
+{
+	if (IsA(path, CdbMotionPath))
+		return CdbVisit_Success;
+	return CdbVisit_Walk;
+}
+
+/* The cheapest path of a join of partitions that has no motion, if any. */
+static Path *
+cheapest_path_without_motion(RelOptInfo *childjoinrel)
+{
+	Path	   *cheapest = NULL;
+	ListCell   *l;
+
+	foreach(l, childjoinrel->pathlist)
+	{
+		Path	   *path = (Path *) lfirst(l);
+
+		if (cheapest && compare_path_costs(path, cheapest, TOTAL_COST) >= 0)
+			continue;
+		if (pathnode_walk_node(path, partition_join_motion_walker, NULL) == CdbVisit_Walk)
+			cheapest = path;
+	}
+	return cheapest;
+}
+
+/*
+ * try_partitionwise_join
+ *	  CDB: If rel1 and rel2 are partitioned alike, and are joined on their
+ *	  partitioning keys, consider appending the joins of each pair of their
+ *	  matching partitions.
+ *
+ * Each of those joins works on the rows of one partition, e.g. it builds a
+ * much smaller hash table, which is less likely to spill.  The pairs are
+ * only used if each of them can be joined without motion, else the Append
+ * would need slices for each partition.
+ */
+static void
+try_partitionwise_join(PlannerInfo *root,
+					   RelOptInfo *joinrel,
+					   RelOptInfo *rel1,
+					   RelOptInfo *rel2,
+					   JoinType jointype,
+					   List *restrictlist)
+{
+	List	   *pairs;
+	List	   *subpaths = NIL;
+	ListCell   *l;
+
+	if (!root->config->gp_enable_partitionwise_join ||
+		jointype != JOIN_INNER ||
+		rel1->dedup_info ||
+		rel2->dedup_info)
+		return;
+
+	pairs = match_partitions(root, rel1, rel2, restrictlist);
+	if (!pairs)
+		return;
+
+	foreach(l, pairs)
+	{
+		List	   *pair = (List *) lfirst(l);
+		AppendRelInfo *appinfo1 = (AppendRelInfo *) linitial(pair);
+		AppendRelInfo *appinfo2 = (AppendRelInfo *) lsecond(pair);
+		RelOptInfo *childrel1 = find_base_rel(root, appinfo1->child_relid);
+		RelOptInfo *childrel2 = find_base_rel(root, appinfo2->child_relid);
+		RelOptInfo *childjoinrel;
+		Path	   *path;
+
+		/*
+		 * A partition rejected by constraint exclusion has an Append path
+		 * with no members, and no row of the other partition joins to it.
+		 */
+		if ((IsA(childrel1->cheapest_total_path, AppendPath) &&
+			 ((AppendPath *) childrel1->cheapest_total_path)->subpaths == NIL) ||
+			(IsA(childrel2->cheapest_total_path, AppendPath) &&
+			 ((AppendPath *) childrel2->cheapest_total_path)->subpaths == NIL))
+			continue;
+
+		canonicalize_partition_loci(root, childrel1);
+		canonicalize_partition_loci(root, childrel2);
+
+		childjoinrel = build_partition_join_rel(root, joinrel,
+												appinfo1, appinfo2,
+												jointype, restrictlist);
+		if (!childjoinrel)
+			return;
+
+		path = cheapest_path_without_motion(childjoinrel);
+		if (!path)
+			return;
+
+		subpaths = lappend(subpaths, path);
+	}
+
+	add_path(root, joinrel, (Path *) create_append_path(root, joinrel, subpaths));
+}
+
+
 /*
  * have_join_order_restriction
  *		Detect whether the two relations should be joined to satisfy
@@ -41,6 +41,7 @@
 
 #include "access/hd_work_mgr.h"
 #include "catalog/catquery.h"
+#include "catalog/pg_statistic.h"
 #include "catalog/pg_type.h"    /* INT8OID */
 #include "nodes/makefuncs.h"
 #include "executor/execHHashagg.h"
@@ -60,7 +61,9 @@
 #include "parser/parsetree.h"
 #include "parser/parse_oper.h"     /* ordering_oper_opid */
 #include "utils/acl.h"
+#include "utils/datum.h"
 #include "utils/lsyscache.h"
+#include "utils/selfuncs.h"
 
 #include "cdb/cdbgroup.h"       /* adapt_flow_to_targetlist() */
 #include "cdb/cdblink.h"        /* getgphostCount() */
@@ -3211,6 +3214,75 @@ decide_use_runtime_filter(HashPath* path, JoinType type)
 	}
 }
 
+/*
+ * The most common values of the outer key of a hash join, most common
+ * first, for the executor to keep their inner tuples in memory while the
+ * other batches spill.  Only the outer key of a single hash clause has
+ * statistics we can use, and the values must be of the type the hash
+ * function of the clause takes.  NIL if they are too rare to matter.
+ */
+#define SKEW_MIN_OUTER_FRACTION 0.01
+
+static List *
+hashjoin_skew_values(PlannerInfo *root, List *hashclauses)
+{
+	OpExpr	   *clause;
+	VariableStatData vardata;
+	HeapTuple	statsTuple;
+	Datum	   *values;
+	int			nvalues;
+	float4	   *numbers;
+	int			nnumbers;
+	Oid			lefttype;
+	Oid			righttype;
+	List	   *result = NIL;
+
+	if (gp_hashjoin_skew_memory_percent <= 0 || list_length(hashclauses) != 1)
+		return NIL;
+
+	clause = (OpExpr *) linitial(hashclauses);
+	if (!IsA(clause, OpExpr) || list_length(clause->args) != 2)
+		return NIL;
+
+	op_input_types(clause->opno, &lefttype, &righttype);
+
+	examine_variable(root, (Node *) linitial(clause->args), 0, &vardata);
+	statsTuple = getStatsTuple(&vardata);
+
+	if (HeapTupleIsValid(statsTuple) &&
+		vardata.vartype == lefttype && lefttype == righttype &&
+		get_attstatsslot(statsTuple, vardata.atttype, vardata.atttypmod,
+						 STATISTIC_KIND_MCV, InvalidOid,
+						 &values, &nvalues, &numbers, &nnumbers))
+	{
+		double		frac = 0;
+		int16		typlen;
+		bool		typbyval;
+		int			i;
+
+		for (i = 0; i < nnumbers; i++)
+			frac += numbers[i];
+
+		if (frac >= SKEW_MIN_OUTER_FRACTION)
+		{
+			get_typlenbyval(vardata.atttype, &typlen, &typbyval);
+
+			for (i = 0; i < nvalues; i++)
+				result = lappend(result,
+								 makeConst(vardata.atttype, vardata.atttypmod,
+										   typlen,
+										   datumCopy(values[i], typbyval, typlen),
+										   false, typbyval));
+		}
+
+		free_attstatsslot(vardata.atttype, values, nvalues, numbers, nnumbers);
+	}
+
+	ReleaseVariableStats(vardata);
+
+	return result;
+}
+
 static HashJoin *
 create_hashjoin_plan(CreatePlanContext *ctx,
 					 HashPath *best_path,
@@ -3269,6 +3341,7 @@ create_hashjoin_plan(CreatePlanContext *ctx,
 	 * Build the hash node and hash join node.
 	 */
 	hash_plan = make_hash(inner_plan);
+	hash_plan->skewValues = hashjoin_skew_values(ctx->root, hashclauses);
 
 	join_plan = make_hashjoin(tlist,
 							  joinclauses,
@@ -4252,6 +4325,7 @@ make_hash(Plan *lefttree)
 	plan->righttree = NULL;
 
     node->rescannable = false;              /* CDB (unused for now) */
+	node->skewValues = NIL;
 
 	return node;
 }
@@ -5260,6 +5334,21 @@ make_limit(Plan *lefttree, Node *limitOffset, Node *limitCount,
 	node->limitOffset = limitOffset;
 	node->limitCount = limitCount;
 
+	/*
+	 * CDB: a Result that only projects the rows of its subplan, as the one
+	 * computing the target list over the Sort of an ORDER BY, returns as
+	 * many rows as it reads. Look through it so that the Sort under it still
+	 * keeps the top-N rows in memory instead of sorting all of its input.
+	 */
+	while (IsA(lefttree, Result) &&
+		   lefttree->lefttree != NULL &&
+		   lefttree->qual == NIL &&
+		   lefttree->initPlan == NIL &&
+		   ((Result *) lefttree)->resconstantqual == NULL &&
+		   !((Result *) lefttree)->hashFilter &&
+		   !expression_returns_set((Node *) lefttree->targetlist))
+		lefttree = lefttree->lefttree;
+
 	/* CDB */ /* pass limit struct to sort */
 	if (IsA(lefttree, Sort) && gp_enable_sort_limit)
 	{
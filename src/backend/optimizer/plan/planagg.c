@@ -34,6 +34,8 @@
 #include "postgres.h"
 
 #include "catalog/pg_aggregate.h"
+#include "catalog/pg_class.h"
+#include "catalog/pg_proc.h"
 #include "catalog/pg_type.h"
 #include "nodes/makefuncs.h"
 #include "optimizer/clauses.h"
@@ -45,6 +47,7 @@
 #include "parser/parse_clause.h"
 #include "parser/parse_expr.h"
 #include "parser/parsetree.h"
+#include "utils/fmgroids.h"
 #include "utils/lsyscache.h"
 #include "utils/syscache.h"
 
@@ -69,6 +72,8 @@ static ScanDirection match_agg_to_index_col(MinMaxAggInfo *info,
 static void make_agg_subplan(PlannerInfo *root, MinMaxAggInfo *info);
 static Node *replace_aggs_with_params_mutator(Node *node, List **context);
 static Oid	fetch_agg_sort_op(Oid aggfnoid);
+static bool find_nonstar_count_walker(Node *node, void *context);
+static Node *replace_count_with_tupcount_mutator(Node *node, Oid *relid);
 
 
 /*
@@ -218,6 +223,117 @@ optimize_minmax_aggregates(PlannerInfo *root, List *tlist, Path *best_path)
 	return plan;
 }
 
+/*
+ * optimize_segfile_count - answer count(*) from the segment file catalog
+ *
+ * The pg_aoseg_* and pg_paqseg_* tables on master record the number of
+ * tuples of every segment file of an append only or parquet table, so an
+ * unfiltered count(*) without grouping needs no scan at all.  If the query is
+ * such a count, return a Result plan computing each count(*) by
+ * get_ao_tupcount(), otherwise NULL.
+ *
+ * The count is not folded into a constant, since a cached plan may be
+ * executed again: get_ao_tupcount() sums the tuple counts seen by the
+ * snapshot of each execution.
+ */
+Plan *
+optimize_segfile_count(PlannerInfo *root, List *tlist)
+{
+	Query	   *parse = root->parse;
+	FromExpr   *jtnode;
+	RangeTblRef *rtr;
+	RangeTblEntry *rte;
+	RelOptInfo *rel;
+	char		relstorage;
+	Plan	   *plan;
+
+	if (!root->config->gp_enable_segfile_count || !parse->hasAggs)
+		return NULL;
+
+	if (parse->groupClause || parse->havingQual || parse->hasSubLinks ||
+		parse->windowClause || parse->rowMarks || parse->setOperations)
+		return NULL;
+
+	/* Exactly one table, without any qual */
+	jtnode = parse->jointree;
+	if (list_length(jtnode->fromlist) != 1 || jtnode->quals != NULL)
+		return NULL;
+	jtnode = linitial(jtnode->fromlist);
+	if (!IsA(jtnode, RangeTblRef))
+		return NULL;
+	rtr = (RangeTblRef *) jtnode;
+	rte = rt_fetch(rtr->rtindex, parse->rtable);
+	if (rte->rtekind != RTE_RELATION || rte->inh)
+		return NULL;
+	rel = find_base_rel(root, rtr->rtindex);
+	if (rel->baserestrictinfo != NIL)
+		return NULL;
+
+	relstorage = get_rel_relstorage(rte->relid);
+	if (relstorage != RELSTORAGE_AOROWS && relstorage != RELSTORAGE_PARQUET)
+		return NULL;
+
+	/* Every aggregate must be a plain count(*) */
+	if (find_nonstar_count_walker((Node *) tlist, NULL))
+		return NULL;
+
+	tlist = (List *) replace_count_with_tupcount_mutator((Node *) tlist,
+														 &rte->relid);
+
+	plan = (Plan *) make_result(tlist, NULL, NULL);
+	plan->startup_cost = 0;
+	plan->total_cost = cpu_operator_cost;
+	plan->plan_rows = 1;
+
+	return plan;
+}
+
+/*
+ * find_nonstar_count_walker
+ *		Returns TRUE if an aggregate other than count(*) is found.
+ */
+static bool
+find_nonstar_count_walker(Node *node, void *context)
+{
+	if (node == NULL)
+		return false;
+	if (IsA(node, Aggref))
+	{
+		Aggref	   *aggref = (Aggref *) node;
+
+		Assert(aggref->agglevelsup == 0);
+		if (aggref->aggdistinct || aggref->aggorder != NULL)
+			return true;
+		if (aggref->aggfnoid == COUNT_STAR_OID)
+			return false;
+		if (aggref->aggfnoid == COUNT_ANY_OID && aggref->aggstar)
+			return false;
+		return true;
+	}
+	Assert(!IsA(node, SubLink));
+	return expression_tree_walker(node, find_nonstar_count_walker, context);
+}
+
+static Node *
+replace_count_with_tupcount_mutator(Node *node, Oid *relid)
+{
+	if (node == NULL)
+		return NULL;
+	if (IsA(node, Aggref))
+	{
+		Const	   *relarg = makeConst(OIDOID, -1, sizeof(Oid),
+									   ObjectIdGetDatum(*relid),
+									   false, true);
+
+		return (Node *) makeFuncExpr(F_GET_AO_TUPCOUNT_OID, INT8OID,
+									 list_make1(relarg),
+									 COERCE_EXPLICIT_CALL);
+	}
+	Assert(!IsA(node, SubLink));
+	return expression_tree_mutator(node, replace_count_with_tupcount_mutator,
+								   (void *) relid);
+}
+
 /*
  * find_minmax_aggs_walker
  *		Recursively scan the Aggref nodes in an expression tree, and check
@@ -505,6 +505,7 @@ PlannerConfig *DefaultPlannerConfig(void)
 	c1->enable_mergejoin = enable_mergejoin;
 	c1->enable_hashjoin = enable_hashjoin;
 	c1->gp_enable_hashjoin_size_heuristic = gp_enable_hashjoin_size_heuristic;
+	c1->gp_enable_partitionwise_join = gp_enable_partitionwise_join;
 	c1->gp_enable_fallback_plan = gp_enable_fallback_plan;
 	c1->gp_enable_predicate_propagation = gp_enable_predicate_propagation;
 	c1->mpp_trying_fallback_plan = false;
@@ -512,6 +513,7 @@ PlannerConfig *DefaultPlannerConfig(void)
 
 	c1->gp_enable_multiphase_agg = gp_enable_multiphase_agg;
 	c1->gp_enable_preunique = gp_enable_preunique;
+	c1->gp_enable_segfile_count = gp_enable_segfile_count;
 	c1->gp_eager_preunique = gp_eager_preunique;
 	c1->gp_enable_sequential_window_plans = gp_enable_sequential_window_plans;
 	c1->gp_hashagg_streambottom = gp_hashagg_streambottom;
@@ -2018,8 +2018,15 @@ grouping_planner(PlannerInfo *root, double tuple_fraction)
 			group_context.pcurrent_pathkeys = &current_pathkeys;
 			group_context.querynode_changed = &querynode_changed;
 
-			/* within_agg_planner calls cdb_grouping_planner */
-			if (has_within)
+			/*
+			 * A count(*) of an append only table needs no scan, see
+			 * optimize_segfile_count.  Otherwise, within_agg_planner calls
+			 * cdb_grouping_planner.
+			 */
+			result_plan = optimize_segfile_count(root, tlist);
+			if (result_plan != NULL)
+				mark_plan_entry(result_plan);
+			else if (has_within)
 				result_plan = within_agg_planner(root,
 												 &agg_counts,
 												 &group_context);
@@ -840,6 +840,7 @@ expand_inherited_rtentry(PlannerInfo *root, RangeTblEntry *rte, Index rti)
 	List	   *inhOIDs;
 	List	   *appinfos;
 	ListCell   *l;
+	HTAB	   *leaves = NULL;
 
 	/* Does RT entry allow inheritance? */
 	if (!rte->inh)
@@ -899,6 +900,10 @@ expand_inherited_rtentry(PlannerInfo *root, RangeTblEntry *rte, Index rti)
 	else
 		lockmode = AccessShareLock;
 
+	/* the leaves of a partitioned table, found at once */
+	if (rel_is_partitioned(parentOID))
+		leaves = rel_get_leaf_partition_set(parentOID);
+
 	/* Scan the inheritance set and expand it */
 	appinfos = NIL;
 	foreach(l, inhOIDs)
@@ -922,7 +927,8 @@ expand_inherited_rtentry(PlannerInfo *root, RangeTblEntry *rte, Index rti)
 		/*
 		 * show root and leaf partitions
 		 */
-		if (rel_is_partitioned(parentOID) && !rel_is_leaf_partition(childOID))
+		if (leaves != NULL &&
+			hash_search(leaves, &childOID, HASH_FIND, NULL) == NULL)
 		{
 			continue;
 		}
@@ -964,6 +970,9 @@ expand_inherited_rtentry(PlannerInfo *root, RangeTblEntry *rte, Index rti)
 			heap_close(newrelation, rel_needs_long_lock(childOID) ? NoLock: lockmode);
 	}
 
+	if (leaves != NULL)
+		hash_destroy(leaves);
+
 	heap_close(oldrelation, NoLock);
 
 	/*
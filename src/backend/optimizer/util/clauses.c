@@ -808,6 +808,51 @@ bool check_volatile_functions(Node *node, void *context) {
   return plan_tree_walker(node, check_volatile_functions, context);
 }
 
+bool check_mutable_functions(Node *node, void *context) {
+  if (node == NULL) return false;
+  if (IsA(node, FuncExpr)) {
+    FuncExpr *expr = (FuncExpr *)node;
+
+    if (func_volatile(expr->funcid) != PROVOLATILE_IMMUTABLE) return true;
+    /* else fall through to check args */
+  }
+  if (IsA(node, OpExpr)) {
+    OpExpr *expr = (OpExpr *)node;
+
+    if (op_volatile(expr->opno) != PROVOLATILE_IMMUTABLE) return true;
+    /* else fall through to check args */
+  }
+  if (IsA(node, DistinctExpr)) {
+    DistinctExpr *expr = (DistinctExpr *)node;
+
+    if (op_volatile(expr->opno) != PROVOLATILE_IMMUTABLE) return true;
+    /* else fall through to check args */
+  }
+  if (IsA(node, ScalarArrayOpExpr)) {
+    ScalarArrayOpExpr *expr = (ScalarArrayOpExpr *)node;
+
+    if (op_volatile(expr->opno) != PROVOLATILE_IMMUTABLE) return true;
+    /* else fall through to check args */
+  }
+  if (IsA(node, NullIfExpr)) {
+    NullIfExpr *expr = (NullIfExpr *)node;
+
+    if (op_volatile(expr->opno) != PROVOLATILE_IMMUTABLE) return true;
+    /* else fall through to check args */
+  }
+  if (IsA(node, RowCompareExpr)) {
+    /* RowCompare probably can't have mutable ops, but check anyway */
+    RowCompareExpr *rcexpr = (RowCompareExpr *)node;
+    ListCell *opid;
+
+    foreach (opid, rcexpr->opnos) {
+      if (op_volatile(lfirst_oid(opid)) != PROVOLATILE_IMMUTABLE) return true;
+    }
+    /* else fall through to check args */
+  }
+  return plan_tree_walker(node, check_mutable_functions, context);
+}
+
 /*****************************************************************************
  *		Check clauses for volatile functions
  *****************************************************************************/
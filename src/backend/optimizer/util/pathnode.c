@@ -1525,9 +1525,14 @@ create_append_path(PlannerInfo *root, RelOptInfo *rel, List *subpaths)
 				subpath = cdbpath_create_motion_path(root, subpath, NIL, false, singleQE);
 			}
 			
-			/* Transform subpath locus into the appendrel's space for comparison. */
+			/*
+			 * Transform subpath locus into the appendrel's space for comparison.
+			 * The subpaths of a joinrel are joins of its partitions, whose
+			 * targetlists match the joinrel's (see try_partitionwise_join).
+			 */
 			if (subpath->parent == rel ||
-				subpath->parent->reloptkind != RELOPT_OTHER_MEMBER_REL)
+				(subpath->parent->reloptkind != RELOPT_OTHER_MEMBER_REL &&
+				 rel->reloptkind != RELOPT_JOINREL))
 				projectedlocus = subpath->locus;
 			else
 				projectedlocus =
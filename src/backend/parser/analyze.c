@@ -3778,7 +3778,8 @@ static List *fillin_encoding(List *list) {
       bool need_free_arg = false;
       arg = defGetString(el, &need_free_arg);
       if (pg_strcasecmp("none", arg) == 0) foundCompressTypeNone = true;
-      if (pg_strcasecmp("snappy", arg) == 0) snappyCompressType = true;
+      if (pg_strcasecmp("snappy", arg) == 0 || pg_strcasecmp("lz4", arg) == 0)
+        snappyCompressType = true;
       if (need_free_arg) {
         pfree(arg);
         arg = NULL;
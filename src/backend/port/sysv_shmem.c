@@ -50,6 +50,13 @@ typedef int IpcMemoryId;		/* shared memory ID returned by shmget(2) */
 unsigned long UsedShmemSegID = 0;
 void	   *UsedShmemSegAddr = NULL;
 
+#ifdef SHM_HUGETLB
+/* set once the kernel refused a huge page segment, so we don't retry */
+static bool huge_pages_unavailable = false;
+
+static Size GetHugePageSize(void);
+#endif
+
 static void *InternalIpcMemoryCreate(IpcMemoryKey memKey, Size size);
 static void IpcMemoryDetach(int status, Datum shmaddr);
 static void IpcMemoryDelete(int status, Datum shmId);
@@ -57,6 +64,40 @@ static PGShmemHeader *PGSharedMemoryAttach(IpcMemoryKey key,
 					 IpcMemoryId *shmid);
 
 
+#ifdef SHM_HUGETLB
+/*
+ * GetHugePageSize
+ *
+ * Returns the kernel's default huge page size, which is what SHM_HUGETLB
+ * segments are made of.  Assume 2MB if /proc/meminfo doesn't tell.
+ */
+static Size
+GetHugePageSize(void)
+{
+	Size		hugepagesize = 2 * 1024 * 1024;
+	FILE	   *fp;
+	char		buf[128];
+	unsigned long sz;
+
+	fp = fopen("/proc/meminfo", "r");
+	if (fp == NULL)
+		return hugepagesize;
+
+	while (fgets(buf, sizeof(buf), fp) != NULL)
+	{
+		if (sscanf(buf, "Hugepagesize: %lu kB", &sz) == 1)
+		{
+			if (sz > 0)
+				hugepagesize = (Size) sz * 1024;
+			break;
+		}
+	}
+	fclose(fp);
+
+	return hugepagesize;
+}
+#endif
+
 /*
  *	InternalIpcMemoryCreate(memKey, size)
  *
@@ -68,14 +109,56 @@ static PGShmemHeader *PGSharedMemoryAttach(IpcMemoryKey key,
  *
  * If we fail with a failure code other than collision-with-existing-segment,
  * print out an error and abort.  Other types of errors are not recoverable.
+ *
+ * If gp_huge_pages is set, we first ask for a segment backed by huge pages,
+ * which spares the TLB on large shared_buffers.  That needs the postmaster
+ * to be in vm.hugetlb_shm_group and enough pages reserved in
+ * vm.nr_hugepages; if the kernel refuses, we fall back to regular pages.
  */
 static void *
 InternalIpcMemoryCreate(IpcMemoryKey memKey, Size size)
 {
-	IpcMemoryId shmid;
+	IpcMemoryId shmid = -1;
 	void	   *memAddress;
 
-	shmid = shmget(memKey, size, IPC_CREAT | IPC_EXCL | IPCProtection);
+#ifdef SHM_HUGETLB
+	if (gp_huge_pages && !huge_pages_unavailable)
+	{
+		Size		hugepagesize = GetHugePageSize();
+		Size		hugesize = size;
+
+		/* older kernels insist on a multiple of the huge page size */
+		if (hugesize % hugepagesize != 0)
+			hugesize += hugepagesize - (hugesize % hugepagesize);
+
+		shmid = shmget(memKey, hugesize,
+					   IPC_CREAT | IPC_EXCL | IPCProtection | SHM_HUGETLB);
+
+		if (shmid < 0)
+		{
+			/* Fail quietly on a collision, same as below */
+			if (errno == EEXIST || errno == EACCES
+#ifdef EIDRM
+				|| errno == EIDRM
+#endif
+				)
+				return NULL;
+
+			ereport(LOG,
+					(errmsg("could not create shared memory segment backed by huge pages, using regular pages: %m"),
+					 errdetail("Failed system call was shmget(key=%lu, size=%lu, 0%o).",
+							   (unsigned long) memKey, (unsigned long) hugesize,
+							   IPC_CREAT | IPC_EXCL | IPCProtection | SHM_HUGETLB)));
+			huge_pages_unavailable = true;
+		}
+		else
+			elog(DEBUG1, "created shared memory segment of %lu bytes backed by %lu byte huge pages",
+				 (unsigned long) hugesize, (unsigned long) hugepagesize);
+	}
+#endif
+
+	if (shmid < 0)
+		shmid = shmget(memKey, size, IPC_CREAT | IPC_EXCL | IPCProtection);
 
 	if (shmid < 0)
 	{
@@ -170,6 +170,7 @@ void
 sendSequenceRequest(int     sockfd, 
 					Relation seqrel,
                     int     session_id,
+                    int64   nvalues,
 					int64  *plast, 
                     int64  *pcached,
 			 		int64  *pincrement,
@@ -208,6 +209,7 @@ sendSequenceRequest(int     sockfd,
 	request.seq_oid = htonl(seq_oid);
 	request.isTemp = htonl(isTemp);
     request.session_id = htonl(session_id);
+	request.nvalues = htonl((uint32_t) nvalues);
 	request.endCookie = SEQ_SERVER_REQUEST_END;
 
 	/*
@@ -807,6 +809,7 @@ processSequenceRequest(int sockfd )
 	nextValRequest.seq_oid      = ntohl(nextValRequest.seq_oid);
 	nextValRequest.isTemp       = ntohl(nextValRequest.isTemp);
     nextValRequest.session_id   = ntohl(nextValRequest.session_id);
+	nextValRequest.nvalues      = ntohl(nextValRequest.nvalues);
 	
 	elog(DEBUG5, "Received nextval request for dbid: %ld tablespaceid: %ld seqoid: "
 				  "%ld isTemp: %s session_id: %ld",
@@ -828,6 +831,7 @@ processSequenceRequest(int sockfd )
 									nextValRequest.dbid,
 									nextValRequest.seq_oid,
 									nextValRequest.isTemp,
+									nextValRequest.nvalues,
 									&plast,
 									&pcached,
 									&pincrement,
@@ -487,6 +487,16 @@ int cleanupQD2RMComm(void)
                     elog(WARNING, "%s", errorbuf);
                 }
             }
+            else if ( QD2RM_ResourceSets[i]->QD_Conn_ID != INVALID_CONNID )
+            {
+            	/* The connection kept registered after returning resource. */
+            	errorbuf[0] = '\0';
+                res = unregisterConnectionInRM(i, errorbuf, sizeof(errorbuf));
+                if ( res != FUNC_RETURN_OK )
+                {
+                    elog(WARNING, "%s", errorbuf);
+                }
+            }
         }
     }
     pthread_mutex_unlock(&ResourceSetsMutex);
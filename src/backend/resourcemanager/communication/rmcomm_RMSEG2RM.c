@@ -42,10 +42,13 @@ void sentIMAliveCleanUp(AsyncCommMessageHandlerContext context);
  * Request:
  *         |<----------- 64 bits (8 bytes) ----------->|
  *         +----------+--------------------------------+
- *         |  TDC     |  BDC     |     Reserved        |
+ *         |  TDC     |  BDC     |     Status          |
  * 		   +----------+----------+---------------------+
+ *         |          RM start timestamp               |
+ * 		   +-------------------------------------------+
  *         |                                           |
- *         |             Machine ID info               |
+ *         |    Segment status, only if status is      |
+ *         |          IMALIVE_STATUS_FULL              |
  *         |                                           |
  * 		   +-------------------------------------------+     _____ 64bit aligned
  *
@@ -72,21 +75,45 @@ int sendIMAlive(int  *errorcode,
 	RPCRequestHeadIMAliveData requesthead;
 	requesthead.TmpDirCount 	  = getDQueueLength(&DRMGlobalInstance->LocalHostTempDirectories);
 	requesthead.TmpDirBrokenCount = DRMGlobalInstance->LocalHostStat->FailedTmpDirNum;
-	requesthead.Reserved		  = 0;
 	requesthead.RMStartTimestamp  = DRMGlobalInstance->ResourceManagerStartTime;
 
+	/*
+	 * The segment status is sent only until the master accepts it, after that
+	 * the master only needs to know the segment is alive.
+	 */
+	if ( !DRMGlobalInstance->SendIMAlive )
+	{
+		requesthead.Status = IMALIVE_STATUS_POSTMASTER_DOWN;
+	}
+	else if ( rm_segment_heartbeat_compact &&
+			  DRMGlobalInstance->HeartBeatAcknowledged )
+	{
+		requesthead.Status = IMALIVE_STATUS_UNCHANGED;
+	}
+	else
+	{
+		requesthead.Status = IMALIVE_STATUS_FULL;
+	}
+
 	appendSMBVar(&tosend, requesthead);
-	appendSelfMaintainBuffer(&tosend,
-							 (char *)(DRMGlobalInstance->LocalHostStat),
-							 offsetof(SegStatData, Info) +
-							 DRMGlobalInstance->LocalHostStat->Info.Size);
+	if ( requesthead.Status == IMALIVE_STATUS_FULL )
+	{
+		appendSelfMaintainBuffer(&tosend,
+								 (char *)(DRMGlobalInstance->LocalHostStat),
+								 offsetof(SegStatData, Info) +
+								 DRMGlobalInstance->LocalHostStat->Info.Size);
+	}
 
 	/* Set content to send and add to AsyncComm framework. */
 	AsyncCommMessageHandlerContext context =
 			rm_palloc0(AsyncCommContext,
 					   sizeof(AsyncCommMessageHandlerContextData));
 	context->inMessage				 = false;
-	context->UserData  				 = NULL;
+	/* Remember which segment status is sent, it may change before response. */
+	context->UserData  				 = requesthead.Status == IMALIVE_STATUS_FULL ?
+									   (void *)(uintptr_t)
+									   (DRMGlobalInstance->LocalHostStatVersion + 1) :
+									   NULL;
 	context->MessageRecvReadyHandler = NULL;
 	context->MessageRecvedHandler 	 = receivedIMAliveResponse;
 	context->MessageSendReadyHandler = NULL;
@@ -145,10 +172,23 @@ void receivedIMAliveResponse(AsyncCommMessageHandlerContext  context,
 					  "heart-beat request.");
 		switchIMAliveSendingTarget();
 	}
+	else if ( response->Result == RMSEG_STATUS_BAD_HOSTINFO )
+	{
+		/* The master does not know this segment status, send it at once. */
+		elog(LOG, "Segment's resource manager is asked for full heart-beat.");
+		DRMGlobalInstance->HeartBeatAcknowledged = false;
+		DRMGlobalInstance->HeartBeatLastSentTime = 0;
+		resetHeartBeatInterval();
+	}
 	else
 	{
-		/* Should always be a FUNC_RETURN_OK result. */
 		Assert(response->Result == FUNC_RETURN_OK);
+		if ( context->UserData != NULL &&
+			 (uintptr_t)(context->UserData) ==
+			 DRMGlobalInstance->LocalHostStatVersion + 1 )
+		{
+			DRMGlobalInstance->HeartBeatAcknowledged = true;
+		}
 		elog(DEBUG5, "Segment's resource manager gets response of heart-beat "
 					 "request successfully.");
 	}
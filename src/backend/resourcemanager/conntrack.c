@@ -23,6 +23,7 @@
 #include "communication/rmcomm_QD_RM_Protocol.h"
 
 void cutReferenceOfConnTrackAndCommBuffer(AsyncCommMessageHandlerContext context);
+static int getRequestPriority(uint16_t messageid);
 void removeResourceRequestInConnHavingRequestsInternal(int32_t 	 connid,
 													   List    **requests);
 
@@ -486,6 +487,35 @@ void cutReferenceOfConnTrackAndCommBuffer(AsyncCommMessageHandlerContext context
 	}
 }
 
+/*
+ * Requests are served in the order of their priority. Returning resource
+ * comes first, its resource can be dispatched to the queries acquiring in the
+ * same loop; then the other requests of the query path. RMSEG heartbeats, DDL
+ * and status requests come last, so that a burst of them does not add to the
+ * latency of the queries.
+ */
+#define REQUEST_PRIORITY_RETURN		0
+#define REQUEST_PRIORITY_QUERY		1
+#define REQUEST_PRIORITY_OTHER		2
+#define REQUEST_PRIORITY_COUNT		3
+
+static int getRequestPriority(uint16_t messageid)
+{
+	switch( messageid )
+	{
+	case REQUEST_QD_RETURN_RESOURCE:
+	case REQUEST_QD_CONNECTION_UNREG:
+		return REQUEST_PRIORITY_RETURN;
+	case REQUEST_QD_CONNECTION_REG:
+	case REQUEST_QD_CONNECTION_REG_OID:
+	case REQUEST_QD_ACQUIRE_RESOURCE:
+	case REQUEST_QD_ACQUIRE_RESOURCE_QUOTA:
+		return REQUEST_PRIORITY_QUERY;
+	default:
+		return REQUEST_PRIORITY_OTHER;
+	}
+}
+
 /*
  * The main processing loop for all computations.
  */
@@ -494,16 +524,31 @@ void processSubmittedRequests(void)
 	ConnectionTrack  ct    		= NULL;
 
 	MEMORY_CONTEXT_SWITCH_TO(PCONTEXT)
-	while( list_length(PCONTRACK->ConnHavingRequests) > 0 )
+	for ( int priority = 0 ; priority < REQUEST_PRIORITY_COUNT ; ++priority )
 	{
-		ct = (ConnectionTrack)lfirst(list_head(PCONTRACK->ConnHavingRequests));
-		PCONTRACK->ConnHavingRequests = list_delete_first(PCONTRACK->ConnHavingRequests);
-		RMMessageHandlerType handler = getMessageHandler(ct->MessageID);
-		Assert(handler != NULL);
-		if ( !handler((void **)&ct) )
+		List *lowerpriority = NULL;
+
+		while( list_length(PCONTRACK->ConnHavingRequests) > 0 )
 		{
-			PCONTRACK->ConnToRetry = lappend(PCONTRACK->ConnToRetry, ct);
+			ct = (ConnectionTrack)lfirst(list_head(PCONTRACK->ConnHavingRequests));
+			PCONTRACK->ConnHavingRequests = list_delete_first(PCONTRACK->ConnHavingRequests);
+
+			/* Leave it to the pass of its priority. */
+			if ( getRequestPriority(ct->MessageID) != priority )
+			{
+				lowerpriority = lappend(lowerpriority, ct);
+				continue;
+			}
+
+			RMMessageHandlerType handler = getMessageHandler(ct->MessageID);
+			Assert(handler != NULL);
+			if ( !handler((void **)&ct) )
+			{
+				PCONTRACK->ConnToRetry = lappend(PCONTRACK->ConnToRetry, ct);
+			}
 		}
+
+		PCONTRACK->ConnHavingRequests = lowerpriority;
 	}
 
 	if ( list_length(PCONTRACK->ConnToRetry) > 0 )
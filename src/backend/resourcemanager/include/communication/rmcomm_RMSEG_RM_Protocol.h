@@ -35,8 +35,9 @@
  * Request format:
  *		uint16_t tmp dir count
  *		uint16_t tmp dir broken count
- *		uint32_t reserved
- *		MachineIdData machine info
+ *		uint32_t status
+ *		uint64_t resource manager start timestamp
+ *		SegStatData segment status, only if status is IMALIVE_STATUS_FULL
  *
  * Response format:
  *		uint32_t result code
@@ -45,10 +46,19 @@
 RPC_PROTOCOL_STRUCT_BEGIN(RPCRequestHeadIMAlive)
 	uint16_t	TmpDirCount;
 	uint16_t	TmpDirBrokenCount;
-	uint32_t	Reserved;
+	uint32_t	Status;
 	uint64_t	RMStartTimestamp;
 RPC_PROTOCOL_STRUCT_END(RPCRequestHeadIMAlive)
 
+/*
+ * A segment sends its full status until the master has accepted it, then only
+ * tells it is alive and nothing changed. IMALIVE_STATUS_POSTMASTER_DOWN tells
+ * the local postmaster can not be reached.
+ */
+#define IMALIVE_STATUS_FULL				0
+#define IMALIVE_STATUS_UNCHANGED		1
+#define IMALIVE_STATUS_POSTMASTER_DOWN	2
+
 RPC_PROTOCOL_STRUCT_BEGIN(RPCResponseIMAlive)
 	uint32_t	Result;
 	uint32_t	Reserved;
@@ -118,6 +118,8 @@ bool handleRMRequestQuotaControl(void **arg);
 
 int refreshLocalHostInstance(void);
 void checkLocalPostmasterStatus(void);
+void stretchHeartBeatInterval(void);
+void resetHeartBeatInterval(void);
 
 /*-----------------------------------------------------------------------------
  * Dynamic resource manager overall APIs
@@ -211,6 +213,10 @@ struct DynRMGlobalData{
     
     uint64_t				 LocalHostLastUpdateTime;
     uint64_t				 HeartBeatLastSentTime;
+    int32_t					 HeartBeatInterval;	  /* Current interval in sec. */
+    /* Whether the master has accepted the current LocalHostStat. */
+    bool					 HeartBeatAcknowledged;
+    uint32_t				 LocalHostStatVersion;
     uint64_t				 TmpDirLastCheckTime;
     int32_t					 SegmentMemoryMB;
     double					 SegmentCore;
@@ -332,6 +332,11 @@ struct DynResourceQueueManagerData {
     bool	 				 hasResourceProblem[RESPROBLEM_COUNT];
 
     int						 ActualMinGRMContainerPerSeg;
+
+    /* Peak demand of each time slot in the last resource forecast period.    */
+    int						 ForecastSlotCount;
+    double					*ForecastPeakCore;	/* Peak core demand.          */
+    uint64_t				*ForecastSlotTime;	/* Last record time in second.*/
 };
 typedef struct DynResourceQueueManagerData *DynResourceQueueManager;
 typedef struct DynResourceQueueManagerData  DynResourceQueueManagerData;
@@ -358,6 +363,17 @@ void timeoutDeadResourceAllocation(void);
 void timeoutQueuedRequest(void);
 void refreshMemoryCoreRatioLimits(void);
 void refreshMemoryCoreRatioWaterMark(void);
+
+/* The length of one time slot of resource forecast history in second. */
+#define RESOURCE_FORECAST_SLOT_SECONDS	60
+
+/* Record the resource demand for forecasting the next period. */
+void markResourceForecast(uint64_t curmicrosec, double core);
+/*
+ * Get the peak core demand recorded one forecast period ago from now till the
+ * idle resource timeout, 0 if no history is recorded.
+ */
+double getResourceForecastCore(uint64_t curmicrosec);
 /*
  * APIs for resource queue loading, creating, etc.
  */
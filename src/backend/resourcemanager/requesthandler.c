@@ -606,6 +606,114 @@ sendresponse:
 	return true;
 }
 
+/*
+ * Set one segment down because probing it, or its own heart-beat, tells its
+ * postmaster can not be reached. The next full heart-beat sets it up again.
+ */
+static void setSegResDownByProbing(SegResource segres, char *hostname)
+{
+	/*--------------------------------------------------------------------------
+	 * This call makes resource manager able to adjust queue and mem/core
+	 * trackers' capacity.
+	 *--------------------------------------------------------------------------
+	 */
+	setSegResHAWQAvailability(segres, RESOURCE_SEG_STATUS_UNAVAILABLE);
+
+	/* Make resource pool remove unused containers */
+	returnAllGRMResourceFromSegment(segres);
+	/* Set the host down in gp_segment_configuration table */
+	segres->Stat->StatusDesc |= SEG_STATUS_FAILED_PROBING_SEGMENT;
+	if (Gp_role != GP_ROLE_UTILITY)
+	{
+		SimpStringPtr description = build_segment_status_description(segres->Stat);
+		update_segment_status(segres->Stat->Info.ID + REGISTRATION_ORDER_OFFSET,
+							  SEGMENT_STATUS_DOWN,
+							  (description->Len > 0)?description->Str:"");
+		add_segment_history_row(segres->Stat->Info.ID + REGISTRATION_ORDER_OFFSET,
+								hostname,
+								description->Str);
+
+		freeSimpleStringContent(description);
+		rm_pfree(PCONTEXT, description);
+	}
+}
+
+/*
+ * Handle a heart-beat without segment status, see IMALIVE_STATUS_UNCHANGED and
+ * IMALIVE_STATUS_POSTMASTER_DOWN. The segment is found by the address it
+ * connects from, which its full heart-beats add to the segment addresses.
+ */
+static void handleRMSEGRequestIMAliveCompact(ConnectionTrack 	   conntrack,
+											 RPCRequestHeadIMAlive header)
+{
+	char	   *clientip  = conntrack->CommBuffer->ClientAddrDotStr;
+	int			res		  = FUNC_RETURN_OK;
+	int32_t		segid	  = SEGSTAT_ID_INVALID;
+	SegResource	segres	  = NULL;
+
+	res = getSegIDByHostName(clientip, strlen(clientip), &segid);
+	if ( res != FUNC_RETURN_OK )
+	{
+		res = getSegIDByHostAddr((uint8_t *)clientip, strlen(clientip), &segid);
+	}
+	if ( res == FUNC_RETURN_OK )
+	{
+		segres = getSegResource(segid);
+		Assert(segres != NULL);
+	}
+
+	if ( header->Status == IMALIVE_STATUS_POSTMASTER_DOWN )
+	{
+		if ( segres != NULL && IS_SEGSTAT_FTSAVAILABLE(segres->Stat) )
+		{
+			setSegResDownByProbing(segres, clientip);
+			refreshResourceQueueCapacity(false);
+			refreshActualMinGRMContainerPerSeg();
+
+			elog(LOG, "resource manager sets host %s from up to down "
+					  "due to its heart-beat reporting postmaster down.",
+					  clientip);
+		}
+		res = FUNC_RETURN_OK;
+	}
+	else if ( segres != NULL &&
+			  segres->Stat->RMStartTimestamp == header->RMStartTimestamp &&
+			  (segres->Stat->StatusDesc & (SEG_STATUS_HEARTBEAT_TIMEOUT |
+										   SEG_STATUS_FAILED_PROBING_SEGMENT |
+										   SEG_STATUS_COMMUNICATION_ERROR |
+										   SEG_STATUS_RM_RESET)) == 0 )
+	{
+		/* Nothing changed, the segment is only known alive. */
+		segres->LastUpdateTime = gettime_microsec();
+		res = FUNC_RETURN_OK;
+	}
+	else
+	{
+		/*
+		 * The segment is unknown, restarted or set down, only a full heart-beat
+		 * can update it.
+		 */
+		elog(RMLOG, "resource manager asks host %s for a full heart-beat.",
+					clientip);
+		res = RMSEG_STATUS_BAD_HOSTINFO;
+	}
+
+	RPCResponseIMAliveData response;
+	response.Result   = res;
+	response.Reserved = 0;
+	buildResponseIntoConnTrack(conntrack,
+						 	   (char *)&response,
+							   sizeof(response),
+							   conntrack->MessageMark1,
+							   conntrack->MessageMark2,
+							   RESPONSE_RM_IMALIVE);
+
+	conntrack->ResponseSent = false;
+	MEMORY_CONTEXT_SWITCH_TO(PCONTEXT)
+	PCONTRACK->ConnToSend = lappend(PCONTRACK->ConnToSend, conntrack);
+	MEMORY_CONTEXT_SWITCH_BACK
+}
+
 /*
  * Handle I AM ALIVE request.
  */
@@ -614,16 +722,28 @@ bool handleRMSEGRequestIMAlive(void **arg)
 	ConnectionTrack conntrack = (ConnectionTrack)(*arg);
 	elog(RMLOG, "resource manager receives segment heart-beat information.");
 
-	SelfMaintainBufferData machinereport;
-	initializeSelfMaintainBuffer(&machinereport,PCONTEXT);
+	RPCRequestHeadIMAlive compacthead = SMBUFF_HEAD(RPCRequestHeadIMAlive,
+													&(conntrack->MessageBuff));
+	if ( compacthead->Status != IMALIVE_STATUS_FULL )
+	{
+		handleRMSEGRequestIMAliveCompact(conntrack, compacthead);
+		return true;
+	}
+
 	SegStat segstat = (SegStat)(SMBUFF_CONTENT(&(conntrack->MessageBuff)) +
 								sizeof(RPCRequestHeadIMAliveData));
 
-	generateSegStatReport(segstat, &machinereport);
+	/* Building the report is not cheap, do it only when it is logged. */
+	if ( RMLOG >= log_min_messages )
+	{
+		SelfMaintainBufferData machinereport;
+		initializeSelfMaintainBuffer(&machinereport,PCONTEXT);
+		generateSegStatReport(segstat, &machinereport);
 
-	elog(RMLOG, "resource manager received segment machine information, %s",
-				SMBUFF_CONTENT(&machinereport));
-	destroySelfMaintainBuffer(&machinereport);
+		elog(RMLOG, "resource manager received segment machine information, %s",
+					SMBUFF_CONTENT(&machinereport));
+		destroySelfMaintainBuffer(&machinereport);
+	}
 
 	char*    		fts_client_ip     = NULL;
 	uint32_t 		fts_client_ip_len = 0;
@@ -1118,31 +1238,7 @@ bool handleRMRequestSegmentIsDown(void **arg)
 				/* IN THIS CASE, the segment is considered as down. */
 				if (res != FUNC_RETURN_OK)
 				{
-					/*----------------------------------------------------------
-					 * This call makes resource manager able to adjust queue and
-					 * mem/core trackers' capacity.
-					 *----------------------------------------------------------
-					 */
-					setSegResHAWQAvailability(segres,
-											  RESOURCE_SEG_STATUS_UNAVAILABLE);
-
-					/* Make resource pool remove unused containers */
-					returnAllGRMResourceFromSegment(segres);
-					/* Set the host down in gp_segment_configuration table */
-					segres->Stat->StatusDesc |= SEG_STATUS_FAILED_PROBING_SEGMENT;
-					if (Gp_role != GP_ROLE_UTILITY)
-					{
-						SimpStringPtr description = build_segment_status_description(segres->Stat);
-						update_segment_status(segres->Stat->Info.ID + REGISTRATION_ORDER_OFFSET,
-											  SEGMENT_STATUS_DOWN,
-											  (description->Len > 0)?description->Str:"");
-						add_segment_history_row(segres->Stat->Info.ID + REGISTRATION_ORDER_OFFSET,
-												hostname,
-												description->Str);
-
-						freeSimpleStringContent(description);
-						rm_pfree(PCONTEXT, description);
-					}
+					setSegResDownByProbing(segres, hostname);
 
 					/* Set the host down. */
 					elog(LOG, "resource manager sets host %s from up to down "
@@ -252,6 +252,12 @@ int refreshLocalHostInstance(void)
 		DRMGlobalInstance->LocalHostStat = rm_palloc0(PCONTEXT, localsegstat.Cursor+1);
 		memcpy(DRMGlobalInstance->LocalHostStat, localsegstat.Buffer, localsegstat.Cursor+1);
 
+		/* Present the changed status to resource manager server at once. */
+		DRMGlobalInstance->LocalHostStatVersion++;
+		DRMGlobalInstance->HeartBeatAcknowledged = false;
+		resetHeartBeatInterval();
+		DRMGlobalInstance->HeartBeatLastSentTime = 0;
+
 		SelfMaintainBufferData machinereport;
 		initializeSelfMaintainBuffer(&machinereport,PCONTEXT);
 		generateSegStatReport(DRMGlobalInstance->LocalHostStat, &machinereport);
@@ -277,6 +283,18 @@ int refreshLocalHostInstance(void)
 	return FUNC_RETURN_OK;
 }
 
+/*
+ * Stop the normal heart-beat as the local postmaster can not be reached. With
+ * compact heart-beat, the master is told so at once.
+ */
+static void setLocalPostmasterDown(void)
+{
+	DRMGlobalInstance->SendIMAlive = false;
+	DRMGlobalInstance->HeartBeatAcknowledged = false;
+	resetHeartBeatInterval();
+	DRMGlobalInstance->HeartBeatLastSentTime = 0;
+}
+
 /**
  * HAWQ RM server asks HAWQ RM segment if it is alive.
  */
@@ -304,7 +322,7 @@ bool handleRMSEGRequestRUAlive(void **arg)
 						  libpqres,
 						  PQerrorMessage(conn));
 				/* Don't send IMAlive anymore */
-				DRMGlobalInstance->SendIMAlive = false;
+				setLocalPostmasterDown();
 			}
 			else
 			{
@@ -365,7 +383,7 @@ void checkLocalPostmasterStatus(void)
 				  PQerrorMessage(conn));
 		/* Don't send IMAlive anymore */
 		if ( DRMGlobalInstance->SendIMAlive ) {
-			DRMGlobalInstance->SendIMAlive = false;
+			setLocalPostmasterDown();
 			elog(LOG, "Segment postmaster is unhealthy, "
 					  "resource manager pauses sending heart-beat.");
 		}
@@ -373,6 +391,10 @@ void checkLocalPostmasterStatus(void)
 	else {
 		if ( !DRMGlobalInstance->SendIMAlive ) {
 			DRMGlobalInstance->SendIMAlive = true;
+			/* The master has set this segment down, it needs full status. */
+			DRMGlobalInstance->HeartBeatAcknowledged = false;
+			resetHeartBeatInterval();
+			DRMGlobalInstance->HeartBeatLastSentTime = 0;
 			elog(LOG, "Segment postmaster is healthy, "
 					  "resource manager restore sending heat-beat again.");
 		}
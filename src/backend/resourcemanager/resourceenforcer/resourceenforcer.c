@@ -19,10 +19,11 @@
 
 /*
  * resourceenforcer.c
- *     CPU usage enforcement for HAWQ.
+ *     CPU and disk I/O usage enforcement for HAWQ.
  *
  * We leverage CGroup so as to make sure a query will not go
- * beyond its allowed CPU usage quota.
+ * beyond its allowed CPU usage quota, and gets disk I/O bandwidth
+ * in proportion to its quota when the disks are contended.
  */
 
 #include <unistd.h>
@@ -45,6 +46,10 @@
 
 
 #define	ENFORCER_MESSAGE_HEAD "Resource enforcer"
+
+/* The range of blkio.weight accepted by the kernel */
+#define BLKIO_WEIGHT_MIN	10
+#define BLKIO_WEIGHT_MAX	1000
 /* #define DEBUG_GHASH 1 */
 
 static char *getCGroupPath(const char *cgroup_name, const char *sub_system);
@@ -116,6 +121,20 @@ int MoveToCGroup(uint32 pid, const char *cgroup_name)
 			}
 		}
 
+		if (rm_enforce_blkio_enable)
+		{
+			res = createCGroup(cgroup_name, "blkio");
+
+			if (res != FUNC_RETURN_OK)
+			{
+				write_log("%s fails to create BLKIO CGroup %s",
+				          ENFORCER_MESSAGE_HEAD,
+				          cgroup_name);
+
+				return res;
+			}
+		}
+
 		cgi = (CGroupInfo *)malloc(sizeof(CGroupInfo));
 		if (cgi == NULL)
 		{
@@ -238,6 +257,21 @@ int MoveToCGroup(uint32 pid, const char *cgroup_name)
 		}
 	}
 
+	/* Process CGroup for blkio sub-system */
+	if (rm_enforce_blkio_enable)
+	{
+		res = setCGroupProcess(cgroup_name, "blkio", pid);
+
+		if (res != FUNC_RETURN_OK)
+		{
+			write_log("%s fails to add PID %d to BLKIO CGroup %s",
+			          ENFORCER_MESSAGE_HEAD,
+			          pid,
+			          cgroup_name);
+			goto exit;
+		}
+	}
+
 	return FUNC_RETURN_OK;
 
 exit:
@@ -343,6 +377,7 @@ int SetupWeightCGroup(uint32 pid, const char *cgroup_name, SegmentResource *reso
 	Assert(resource->vcore > 0.0);
 
 	int32		cpu_weight = -1;
+	int32		blkio_weight = -1;
 
 	int			res = FUNC_RETURN_OK;
 
@@ -411,6 +446,42 @@ int SetupWeightCGroup(uint32 pid, const char *cgroup_name, SegmentResource *reso
 	#endif
 	}
 
+	/*
+	 * Process CGroup for blkio sub-system. The I/O weight follows the same
+	 * vcore quota as the CPU weight, so that a query of a queue having a
+	 * smaller share gets less disk bandwidth when the disks are contended.
+	 */
+	if (rm_enforce_blkio_enable)
+	{
+		double weight = resource->vcore * rm_enforce_blkio_weight;
+		blkio_weight = weight < BLKIO_WEIGHT_MIN ?
+					   BLKIO_WEIGHT_MIN :
+					   (weight > BLKIO_WEIGHT_MAX ? BLKIO_WEIGHT_MAX : (int32)weight);
+
+		CGroupInfo *cgi = (CGroupInfo *)(cgroup->Value);
+		if (blkio_weight != cgi->vdisk_current)
+		{
+			res = setCGroupWeightInt32(cgroup_name,
+						   "blkio",
+						   "blkio.weight",
+						   blkio_weight);
+
+			if (res == FUNC_RETURN_OK)
+			{
+				cgi->vdisk_current = blkio_weight;
+			}
+			else
+			{
+				write_log("%s fails to set weight %d for BLKIO CGroup %s",
+				          ENFORCER_MESSAGE_HEAD,
+				          blkio_weight,
+				          cgroup_name);
+
+				return res;
+			}
+		}
+	}
+
 	return FUNC_RETURN_OK;
 }
 
@@ -450,16 +521,35 @@ int CleanUpCGroupAtRuntime(void)
 			}
 			else if (cgi->to_be_deleted > 1)
 			{
-				res = deleteCGroup(cgi->name, "cpu");
+				if (rm_enforce_cpu_enable)
+				{
+					res = deleteCGroup(cgi->name, "cpu");
+
+					if (res == RESENFORCER_ERROR_INSUFFICIENT_MEMORY)
+					{
+						write_log("%s fails to remove CPU CGroup directory %s "
+						          "due to out of memory",
+						          ENFORCER_MESSAGE_HEAD,
+						          cgi->name);
 
-				if (res == RESENFORCER_ERROR_INSUFFICIENT_MEMORY)
+						return RESENFORCER_ERROR_INSUFFICIENT_MEMORY;
+					}
+				}
+
+				if (rm_enforce_blkio_enable &&
+					(!rm_enforce_cpu_enable || res == FUNC_RETURN_OK))
 				{
-					write_log("%s fails to remove CPU CGroup directory %s "
-					          "due to out of memory",
-					          ENFORCER_MESSAGE_HEAD,
-					          cgi->name);
+					res = deleteCGroup(cgi->name, "blkio");
 
-					return RESENFORCER_ERROR_INSUFFICIENT_MEMORY;
+					if (res == RESENFORCER_ERROR_INSUFFICIENT_MEMORY)
+					{
+						write_log("%s fails to remove BLKIO CGroup directory %s "
+						          "due to out of memory",
+						          ENFORCER_MESSAGE_HEAD,
+						          cgi->name);
+
+						return RESENFORCER_ERROR_INSUFFICIENT_MEMORY;
+					}
 				}
 
 				if (res == FUNC_RETURN_OK)
@@ -857,6 +947,10 @@ bool isCGroupEnabled(const char *sub_system)
 	{
 		return rm_enforce_cpu_enable;
 	}
+	else if (strcasecmp(sub_system, "blkio") == 0)
+	{
+		return rm_enforce_blkio_enable;
+	}
 	else
 	{
 		write_log("%s fails to check CGroup enablement "
@@ -919,13 +1013,28 @@ void *cgroupService(void *arg)
 
 	gp_set_thread_sigmasks();
 
-	res = CleanUpCGroupAtStartup("cpu");
-	if (res != FUNC_RETURN_OK)
+	if (rm_enforce_cpu_enable)
 	{
-		write_log("%s fails to CleanUpCGroupAtStartup, "
-		          "cgroupService thread will quit",
-		          ENFORCER_MESSAGE_HEAD);
-		return NULL;
+		res = CleanUpCGroupAtStartup("cpu");
+		if (res != FUNC_RETURN_OK)
+		{
+			write_log("%s fails to CleanUpCGroupAtStartup, "
+			          "cgroupService thread will quit",
+			          ENFORCER_MESSAGE_HEAD);
+			return NULL;
+		}
+	}
+
+	if (rm_enforce_blkio_enable)
+	{
+		res = CleanUpCGroupAtStartup("blkio");
+		if (res != FUNC_RETURN_OK)
+		{
+			write_log("%s fails to CleanUpCGroupAtStartup for blkio, "
+			          "cgroupService thread will quit",
+			          ENFORCER_MESSAGE_HEAD);
+			return NULL;
+		}
 	}
 
 	g_ghash_cgroup = createGHash(GHASH_SLOT_VOLUME_DEFAULT,
@@ -1021,13 +1130,16 @@ void *cgroupService(void *arg)
 
 void initCGroupThreads(void)
 {
-	/* We don't initialize CGroup thread if CPU enforcement is not enabled*/
-	if (!rm_enforce_cpu_enable)
+	/*
+	 * We don't initialize CGroup thread if neither CPU nor disk I/O
+	 * enforcement is enabled
+	 */
+	if (!rm_enforce_cpu_enable && !rm_enforce_blkio_enable)
 	{
 		return;
 	}
 
-	/* Initialize queue for CPU enforcement tasks */
+	/* Initialize queue for CPU and disk I/O enforcement tasks */
 	g_queue_cgroup = queue_create();
 
 	if (g_queue_cgroup == NULL)
@@ -833,6 +833,9 @@ int initializeDRMInstance(MCTYPE context)
 
 	DRMGlobalInstance->LocalHostLastUpdateTime	= 0;
 	DRMGlobalInstance->HeartBeatLastSentTime    = 0;
+	DRMGlobalInstance->HeartBeatInterval		= rm_segment_heartbeat_interval;
+	DRMGlobalInstance->HeartBeatAcknowledged	= false;
+	DRMGlobalInstance->LocalHostStatVersion		= 0;
 	DRMGlobalInstance->TmpDirLastCheckTime      = 0;
 	DRMGlobalInstance->LocalHostStat			= NULL;
 	
@@ -2035,6 +2038,10 @@ int generateAllocRequestToBroker(void)
 
 	bool hasWorkload = mctrack->TotalUsed.MemoryMB +
 					   mctrack->TotalRequest.MemoryMB > 0;
+
+	/* The demand expected soon based on the last forecast period. */
+	double forecastcore = getResourceForecastCore(gettime_microsec());
+	hasWorkload = hasWorkload || forecastcore > 0;
 	if ( !hasWorkload )
 	{
 		/* Check if resource manager has workload recently. */
@@ -2170,6 +2177,27 @@ int generateAllocRequestToBroker(void)
 
 	elog(RMLOG, "Resource manager now needs %d GRM containers.", reqcore);
 
+	/*
+	 * Acquire the resource for the forecast demand before the queries come,
+	 * bounded by the maximum capacity of the queues. This is triggered only
+	 * when no resource are waited for.
+	 */
+	if ( forecastcore > 0 && mctrack->TotalPending.Core <= 0 )
+	{
+		double forecastcap = PRESPOOL->GRMTotal.Core * PQUEMGR->GRMQueueMaxCapacity;
+		forecastcore = forecastcore < forecastcap ? forecastcore : forecastcap;
+		int32_t forecastreqcore = ceil(forecastcore - mctrack->TotalAllocated.Core);
+		if ( forecastreqcore > reqcore )
+		{
+			elog(LOG, "Resource manager pre-acquires %d GRM containers for "
+					  "forecast demand of %lf cores.",
+					  forecastreqcore,
+					  forecastcore);
+			reqcore = forecastreqcore;
+			reqmem  = reqcore * mctrack->MemCoreRatio;
+		}
+	}
+
 	/*
 	 * Check if should raise water level to deal with resource fragment or
 	 * resource uneven problems. We trigger this logic only when no resource
@@ -196,14 +196,26 @@ int MainHandlerLoop_RMSEG(void)
 			checkLocalPostmasterStatus();
 		}
 
-		if ( DRMGlobalInstance->SendIMAlive )
+		/*
+		 * With compact heart-beat, a down postmaster is reported in heart-beat
+		 * instead of stopping it, see IMALIVE_STATUS_POSTMASTER_DOWN.
+		 */
+		if ( DRMGlobalInstance->SendIMAlive || rm_segment_heartbeat_compact )
 		{
 			 if (DRMGlobalInstance->LocalHostStat != NULL &&
 			     curtime - DRMGlobalInstance->HeartBeatLastSentTime >
-				 1000000LL * rm_segment_heartbeat_interval )
+				 1000000LL * DRMGlobalInstance->HeartBeatInterval )
 			 {
 				 sendIMAlive(&errorcode, errorbuf, sizeof(errorbuf));
 				 DRMGlobalInstance->HeartBeatLastSentTime = gettime_microsec();
+				 if ( DRMGlobalInstance->SendIMAlive )
+				 {
+					 stretchHeartBeatInterval();
+				 }
+				 else
+				 {
+					 resetHeartBeatInterval();
+				 }
 			 }
 		}
 
@@ -286,4 +298,48 @@ void switchIMAliveSendingTarget(void)
 		elog(LOG, "segment will send heart-beat to %s from now on",
 				  DRMGlobalInstance->SendToStandby ? "standby" : "master");
 	}
+
+	/* The new target should know this segment as soon as possible. */
+	DRMGlobalInstance->HeartBeatAcknowledged = false;
+	resetHeartBeatInterval();
+}
+
+/*
+ * Double the heart-beat interval after one heart-beat is sent, so that the
+ * segment whose status does not change sends less heart-beat. The interval is
+ * capped by hawq_rm_segment_heartbeat_max_interval and always keeps less than
+ * half of hawq_rm_segment_heartbeat_timeout, thus the segment is never set
+ * down because of the stretched interval.
+ */
+void stretchHeartBeatInterval(void)
+{
+	int32_t maxinterval = rm_segment_heartbeat_max_interval;
+
+	if ( maxinterval > rm_segment_heartbeat_timeout / 2 )
+	{
+		maxinterval = rm_segment_heartbeat_timeout / 2;
+	}
+
+	if ( maxinterval <= rm_segment_heartbeat_interval )
+	{
+		DRMGlobalInstance->HeartBeatInterval = rm_segment_heartbeat_interval;
+		return;
+	}
+
+	DRMGlobalInstance->HeartBeatInterval =
+		DRMGlobalInstance->HeartBeatInterval * 2 > maxinterval ?
+		maxinterval :
+		DRMGlobalInstance->HeartBeatInterval * 2;
+
+	elog(DEBUG3, "Segment resource manager sends next heart-beat in %d seconds.",
+				 DRMGlobalInstance->HeartBeatInterval);
+}
+
+/*
+ * Go back to the configured heart-beat interval, the segment status changes or
+ * the resource manager server may not know the segment.
+ */
+void resetHeartBeatInterval(void)
+{
+	DRMGlobalInstance->HeartBeatInterval = rm_segment_heartbeat_interval;
 }
@@ -2344,6 +2344,28 @@ void freeGRMContainerSet(GRMContainerSet ctns)
 	Assert( ctns->Containers == NULL );
 	rm_pfree(PCONTEXT, ctns);
 }
+/*
+ * The preferred host of a query request with the data size it scans there.
+ */
+typedef struct PreferredHostOrder
+{
+	uint32_t	Index;
+	int64_t		ScanSizeMB;
+} PreferredHostOrder;
+
+static int comparePreferredHostOrder(const void *a, const void *b)
+{
+	const PreferredHostOrder *pa = (const PreferredHostOrder *)a;
+	const PreferredHostOrder *pb = (const PreferredHostOrder *)b;
+
+	/* The host having more data goes first, ties keep the passed order. */
+	if ( pa->ScanSizeMB != pb->ScanSizeMB )
+	{
+		return pa->ScanSizeMB > pb->ScanSizeMB ? -1 : 1;
+	}
+	return pa->Index < pb->Index ? -1 : (pa->Index > pb->Index ? 1 : 0);
+}
+
 /**
  * THE MAIN FUNCTION for acquiring resource from resource pool.
  */
@@ -2422,8 +2444,33 @@ int allocateResourceFromResourcePoolIOBytes2(int32_t 	 nodecount,
 	{
 		elog(RMLOG, "Resource manager tries to find host based on locality data.");
 
-		for ( uint32_t i = 0 ; i < preferredcount ; ++i )
+		/*
+		 * Try the preferred hosts in the descending order of the data size the
+		 * query scans there, so that the few vsegs go to the hosts saving the
+		 * most remote reads.
+		 */
+		PreferredHostOrder *order = NULL;
+		if ( preferredcount > 0 )
+		{
+			order = rm_palloc(PCONTEXT,
+							  sizeof(PreferredHostOrder) * preferredcount);
+			for ( uint32_t k = 0 ; k < preferredcount ; ++k )
+			{
+				order[k].Index 		= k;
+				order[k].ScanSizeMB = preferredscansize == NULL ?
+									  0 :
+									  preferredscansize[k];
+			}
+			qsort(order,
+				  preferredcount,
+				  sizeof(PreferredHostOrder),
+				  comparePreferredHostOrder);
+		}
+
+		for ( uint32_t k = 0 ; k < preferredcount ; ++k )
 		{
+			uint32_t i = order[k].Index;
+
 			/*
 			 * Get machine identified by HDFS host name. The HDFS host names does
 			 * not have to be a YARN or HAWQ FTS recognized host name. Therefore,
@@ -2525,6 +2572,11 @@ int allocateResourceFromResourcePoolIOBytes2(int32_t 	 nodecount,
 				break;
 			}
 		}
+
+		if ( order != NULL )
+		{
+			rm_pfree(PCONTEXT, order);
+		}
 	}
 
 	/*--------------------------------------------------------------------------
@@ -3540,6 +3592,16 @@ void timeoutIdleGRMResourceToRB(void)
 			retcore = PQUEMGR->RatioTrackers[i]->TotalAllocated.Core;
 		}
 
+		/* Keep the resource for the forecast demand. */
+		double forecastcore = i == 0 ?
+							  getResourceForecastCore(gettime_microsec()) :
+							  0;
+		if ( forecastcore > 0 &&
+			 retcore > PQUEMGR->RatioTrackers[i]->TotalAllocated.Core - forecastcore )
+		{
+			retcore = PQUEMGR->RatioTrackers[i]->TotalAllocated.Core - forecastcore;
+		}
+
 		/* If no need to return the resource. */
 		if ( retcore <= 0 )
 		{
@@ -3564,7 +3626,9 @@ void timeoutIdleGRMResourceToRB(void)
 			timeoutIdleGRMResourceToRBByRatio(i,
 										   	  retcontnum,
 											  &realretcontnum,
-											  mark->ClusterVCore > 0 ? PQUEMGR->ActualMinGRMContainerPerSeg : 0 );
+											  mark->ClusterVCore > 0 || forecastcore > 0 ?
+											  PQUEMGR->ActualMinGRMContainerPerSeg :
+											  0 );
 			if ( realretcontnum > 0 )
 			{
 				/* Notify resource queue manager to minus allocated resource.*/
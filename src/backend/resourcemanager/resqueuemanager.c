@@ -74,7 +74,8 @@ char RSQTBLAttrNames[RSQ_TBL_ATTR_COUNT]
  */
 static char RSQDDLValueAllocationPolicy[RSQ_ALLOCATION_POLICY_COUNT]
 									   [RESOURCE_QUEUE_DDL_POLICY_LENGTH_MAX] = {
-	"even"
+	"even",
+	"wfq"
 };
 
 /*
@@ -111,7 +112,8 @@ int computeQueryQuota_EVEN(DynResourceQueueTrack	track,
 int32_t min(int32_t a, int32_t b);
 int32_t max(int32_t a, int32_t b);
 computeQueryQuotaByPolicy AllocationPolicy[RSQ_ALLOCATION_POLICY_COUNT] = {
-	computeQueryQuota_EVEN
+	computeQueryQuota_EVEN,
+	computeQueryQuota_EVEN	/* WFQ computes the quota as EVEN does. */
 };
 
 /*------------------------------------------
@@ -120,11 +122,17 @@ computeQueryQuotaByPolicy AllocationPolicy[RSQ_ALLOCATION_POLICY_COUNT] = {
 typedef int (* dispatchResourceToQueriesByPolicy )(DynResourceQueueTrack);
 
 int dispatchResourceToQueries_EVEN(DynResourceQueueTrack track);
+int dispatchResourceToQueries_WFQ(DynResourceQueueTrack track);
 
 dispatchResourceToQueriesByPolicy DispatchPolicy[RSQ_ALLOCATION_POLICY_COUNT] = {
-	dispatchResourceToQueries_EVEN
+	dispatchResourceToQueries_EVEN,
+	dispatchResourceToQueries_WFQ
 };
 
+int dispatchResourceToSelectedQueries(DynResourceQueueTrack track,
+									  DQueue			    todisp,
+									  int				    availsegnum);
+
 void dispatchResourceToQueriesInOneQueue(DynResourceQueueTrack track);
 
 /* Functions for operating resource queue tracker instance. */
@@ -256,6 +264,21 @@ void initializeResourceQueueManager(void)
     }
 
     PQUEMGR->ActualMinGRMContainerPerSeg = rm_min_resource_perseg;
+
+    /* Initialize resource forecast history. */
+    PQUEMGR->ForecastSlotCount = rm_resource_forecast_period /
+    							 RESOURCE_FORECAST_SLOT_SECONDS;
+    PQUEMGR->ForecastPeakCore  = NULL;
+    PQUEMGR->ForecastSlotTime  = NULL;
+    if ( PQUEMGR->ForecastSlotCount > 0 )
+    {
+    	PQUEMGR->ForecastPeakCore = rm_palloc0(PCONTEXT,
+    										   sizeof(double) *
+											   PQUEMGR->ForecastSlotCount);
+    	PQUEMGR->ForecastSlotTime = rm_palloc0(PCONTEXT,
+    										   sizeof(uint64_t) *
+											   PQUEMGR->ForecastSlotCount);
+    }
 }
 
 /*
@@ -2454,9 +2477,81 @@ void refreshMemoryCoreRatioLevelUsage(uint64_t curmicrosec)
 									 curmicrosec,
 									 mctrack->TotalUsed.MemoryMB,
 									 mctrack->TotalUsed.Core);
+
+		/* Only one memory/core ratio is supported now. */
+		if ( i == 0 )
+		{
+			markResourceForecast(curmicrosec,
+								 mctrack->TotalUsed.Core +
+								 mctrack->TotalRequest.Core);
+		}
 	}
 }
 
+void markResourceForecast(uint64_t curmicrosec, double core)
+{
+	if ( PQUEMGR->ForecastSlotCount <= 0 )
+	{
+		return;
+	}
+
+	/* Each slot records the peak demand in the latest pass of the slot. */
+	uint64_t cursec  = curmicrosec / 1000000;
+	int		 slotidx = (cursec / RESOURCE_FORECAST_SLOT_SECONDS) %
+					   PQUEMGR->ForecastSlotCount;
+
+	if ( cursec - PQUEMGR->ForecastSlotTime[slotidx] >=
+		 RESOURCE_FORECAST_SLOT_SECONDS )
+	{
+		PQUEMGR->ForecastPeakCore[slotidx] = core;
+	}
+	else if ( PQUEMGR->ForecastPeakCore[slotidx] < core )
+	{
+		PQUEMGR->ForecastPeakCore[slotidx] = core;
+	}
+	PQUEMGR->ForecastSlotTime[slotidx] = cursec;
+}
+
+double getResourceForecastCore(uint64_t curmicrosec)
+{
+	if ( PQUEMGR->ForecastSlotCount <= 0 )
+	{
+		return 0;
+	}
+
+	/*
+	 * Check the slots from now until the idle resource timeout. The resource
+	 * acquired for the forecast demand is not returned before, neither is the
+	 * resource kept for the demand seen within the timeout.
+	 */
+	uint64_t cursec    = curmicrosec / 1000000;
+	int		 slotcount = rm_resource_timeout / RESOURCE_FORECAST_SLOT_SECONDS + 1;
+	double	 peak	   = 0;
+
+	slotcount = slotcount < PQUEMGR->ForecastSlotCount ?
+				slotcount :
+				PQUEMGR->ForecastSlotCount;
+
+	for ( int i = 0 ; i < slotcount ; ++i )
+	{
+		uint64_t slotsec = cursec + i * RESOURCE_FORECAST_SLOT_SECONDS;
+		int		 slotidx = (slotsec / RESOURCE_FORECAST_SLOT_SECONDS) %
+						   PQUEMGR->ForecastSlotCount;
+
+		/* Skip the slots not recorded in the last period. */
+		if ( PQUEMGR->ForecastSlotTime[slotidx] == 0 ||
+			 cursec - PQUEMGR->ForecastSlotTime[slotidx] >
+			 rm_resource_forecast_period + RESOURCE_FORECAST_SLOT_SECONDS )
+		{
+			continue;
+		}
+		peak = peak > PQUEMGR->ForecastPeakCore[slotidx] ?
+			   peak :
+			   PQUEMGR->ForecastPeakCore[slotidx];
+	}
+	return peak;
+}
+
 void markMemoryCoreRatioWaterMark(DQueue 		marks,
 								  uint64_t 		curmicrosec,
 								  int32_t 		memmb,
@@ -4081,32 +4176,182 @@ int dispatchResourceToQueries_EVEN(DynResourceQueueTrack track)
 		availsegnum -= conn->StatNVSeg <= 0 ? conn->SegNumMin : conn->SegNumEqual;
 	}
 
-	DQueueNode pnode = getDQueueContainerHead(&todisp);
-	int fullcount = 0;
-	while(availsegnum > 0)
+	return dispatchResourceToSelectedQueries(track, &todisp, availsegnum);
+}
+
+/*
+ * The waiting query and its virtual finish time in weighted fair queuing.
+ */
+typedef struct WFQWaitingQueryData
+{
+	DQueueNode			Node;
+	ConnectionTrack		Conn;
+	int32_t				SegNumEqual;	/* Minimum vseg number in queue quota.*/
+	uint64_t			FinishTime;		/* Virtual finish time in us.		  */
+} WFQWaitingQueryData;
+
+typedef WFQWaitingQueryData *WFQWaitingQuery;
+
+static int compareWFQWaitingQuery(const void *a, const void *b)
+{
+	WFQWaitingQuery qa = (WFQWaitingQuery)a;
+	WFQWaitingQuery qb = (WFQWaitingQuery)b;
+
+	if ( qa->FinishTime != qb->FinishTime )
 	{
-		ConnectionTrack conn = (ConnectionTrack)(pnode->Data);
-		if ( conn->StatNVSeg == 0 && conn->SegNum > conn->SegNumActual )
+		return qa->FinishTime < qb->FinishTime ? -1 : 1;
+	}
+	/* Same finish time, the earlier the request comes, the earlier it runs. */
+	if ( qa->Conn->ResRequestTime != qb->Conn->ResRequestTime )
+	{
+		return qa->Conn->ResRequestTime < qb->Conn->ResRequestTime ? -1 : 1;
+	}
+	return 0;
+}
+
+/*
+ * Dispatching allocated resource to queuing queries in weighted fair queuing.
+ *
+ * Each waiting query is tagged with a virtual finish time, that is when its
+ * resource request was received plus hawq_rm_fair_queue_vseg_cost ms for each
+ * vseg of its minimum demand. The queries are dispatched in the order of
+ * the finish time, so that a short query does not wait behind a long one
+ * received a little earlier. A query not fitting in the left resource is
+ * skipped until its finish time is reached, after that no later query can take
+ * the resource before it, thus the large queries are not starved.
+ */
+int dispatchResourceToQueries_WFQ(DynResourceQueueTrack track)
+{
+	/* Check how many segments are available to dispatch. */
+	int availsegnum = trunc((track->TotalAllocated.MemoryMB -
+							 track->TotalUsed.MemoryMB) /
+					  	  	track->QueueInfo->SegResourceQuotaMemoryMB);
+	int counter = 0;
+	int segmincounter = 0;
+	int waitingcount = track->QueryResRequests.NodeCount;
+	uint64_t curtime = gettime_microsec();
+
+	if ( waitingcount == 0 )
+	{
+		return FUNC_RETURN_OK;
+	}
+
+	WFQWaitingQuery waiting = rm_palloc(PCONTEXT,
+										sizeof(WFQWaitingQueryData) * waitingcount);
+	int idx = 0;
+	DQUEUE_LOOP_BEGIN(&(track->QueryResRequests), iter, ConnectionTrack, conntrack)
+		waiting[idx].Node		 = iter;
+		waiting[idx].Conn		 = conntrack;
+		waiting[idx].SegNumEqual = conntrack->StatNVSeg <= 0 ?
+								   conntrack->SegNumMin :
+								   conntrack->SegNumEqual;
+		waiting[idx].FinishTime  = conntrack->ResRequestTime +
+								   1000LL * rm_fair_queue_vseg_cost *
+								   waiting[idx].SegNumEqual;
+		idx++;
+	DQUEUE_LOOP_END
+
+	qsort(waiting, waitingcount, sizeof(WFQWaitingQueryData), compareWFQWaitingQuery);
+
+	/* Select the queries to run, the selected ones are moved to the front. */
+	for ( int i = 0 ; i < waitingcount ; ++i )
+	{
+		if ( counter + track->NumOfRunningQueries >= track->QueueInfo->ParallelCount )
 		{
-			conn->SegNumActual++;
-			availsegnum--;
-			fullcount=0;
+			elog(RMLOG, "parallel count limit is encountered, to run %d more",
+						counter);
+			break;
 		}
-		else
+
+		if ( segmincounter + waiting[i].SegNumEqual > availsegnum )
+		{
+			if ( waiting[i].FinishTime <= curtime )
+			{
+				elog(RMLOG, "resource allocated is up, available vseg num %d, "
+							"to run %d more, connection %d is due",
+							availsegnum,
+							counter,
+							waiting[i].Conn->ConnID);
+				break;
+			}
+			continue;
+		}
+
+		segmincounter += waiting[i].SegNumEqual;
+		waiting[counter++] = waiting[i];
+	}
+
+	if ( counter == 0 )
+	{
+		rm_pfree(PCONTEXT, waiting);
+		detectAndDealWithDeadLock(track);
+		return FUNC_RETURN_OK; /* Expect requests are processed in next loop. */
+	}
+
+	/* Dispatch segments */
+	DQueueData todisp;
+	initializeDQueue(&todisp, PCONTEXT);
+	for ( int i = 0 ; i < counter ; ++i )
+	{
+		ConnectionTrack conn = removeDQueueNode(&(track->QueryResRequests),
+												waiting[i].Node);
+		conn->SegNumActual = conn->SegNumMin;
+		insertDQueueTailNode(&todisp, conn);
+		availsegnum -= waiting[i].SegNumEqual;
+	}
+	rm_pfree(PCONTEXT, waiting);
+
+	return dispatchResourceToSelectedQueries(track, &todisp, availsegnum);
+}
+
+/*
+ * Dispatching allocated resource to the queries selected by the policy.
+ * The queries in todisp have got their minimum vseg number, the left
+ * availsegnum vsegs are handed out to the queries expecting more. The queries
+ * not dispatched successfully are returned to the head of the queue.
+ */
+int dispatchResourceToSelectedQueries(DynResourceQueueTrack track,
+									  DQueue			    todisp,
+									  int				    availsegnum)
+{
+	int counter = todisp->NodeCount;
+
+	/*
+	 * Hand out the left vsegs one by one to the queries expecting more in
+	 * round robin. The queries having got all they expect leave the round, so
+	 * that one more vseg costs the same however many queries are dispatched.
+	 */
+	ConnectionTrack *expanding = rm_palloc(PCONTEXT,
+										   sizeof(ConnectionTrack) * counter);
+	int expandingcount = 0;
+	DQUEUE_LOOP_BEGIN(todisp, iter, ConnectionTrack, conn)
+		if ( conn->StatNVSeg == 0 && conn->SegNum > conn->SegNumActual )
 		{
-			fullcount++;
+			expanding[expandingcount++] = conn;
 		}
-		if ( fullcount == counter )
+	DQUEUE_LOOP_END
+
+	while( availsegnum > 0 && expandingcount > 0 )
+	{
+		int leftcount = 0;
+		for ( int i = 0 ; i < expandingcount && availsegnum > 0 ; ++i )
 		{
-			break;
+			ConnectionTrack conn = expanding[i];
+			conn->SegNumActual++;
+			availsegnum--;
+			if ( conn->SegNum > conn->SegNumActual )
+			{
+				expanding[leftcount++] = conn;
+			}
 		}
-		pnode = pnode->Next == NULL ? getDQueueContainerHead(&todisp) : pnode->Next;
+		expandingcount = leftcount;
 	}
+	rm_pfree(PCONTEXT, expanding);
 
 	/* Actually allocate segments from hosts in resource pool and send response.*/
 	for ( int processidx = 0 ; processidx < counter ; ++processidx )
 	{
-		ConnectionTrack conn = removeDQueueHeadNode(&todisp);
+		ConnectionTrack conn = removeDQueueHeadNode(todisp);
 		elog(DEBUG3, "resource manager tries to dispatch resource to connection %d. "
 		   		  	 "Expect (%d MB, %lf CORE) x %d(max %d min %d) segment(s). "
 		   		  	 "Original vseg %d(min %d). "
@@ -4220,22 +4465,22 @@ int dispatchResourceToQueries_EVEN(DynResourceQueueTrack track)
 			/* Decide whether continue to process next query request. */
 			if ( rm_force_fifo_queue )
 			{
-				insertDQueueHeadNode(&todisp, conn);
+				insertDQueueHeadNode(todisp, conn);
 				break;
 			}
 			else
 			{
-				insertDQueueTailNode(&todisp, conn);
+				insertDQueueTailNode(todisp, conn);
 			}
 		}
 	}
 
 	/* Return the request not completed yet. */
-	while( todisp.NodeCount > 0 ) {
-		ConnectionTrack conn = (ConnectionTrack)(removeDQueueTailNode(&todisp));
+	while( todisp->NodeCount > 0 ) {
+		ConnectionTrack conn = (ConnectionTrack)(removeDQueueTailNode(todisp));
 		insertDQueueHeadNode(&(track->QueryResRequests), (void *)conn);
 	}
-	cleanDQueue(&todisp);
+	cleanDQueue(todisp);
 
 	return FUNC_RETURN_OK;
 }
@@ -4422,10 +4667,16 @@ void detectAndDealWithDeadLock(DynResourceQueueTrack track)
 		return;
 	}
 
+	/*
+	 * Cancel the requests from the tail having in-use resource until the head
+	 * request can be satisfied. The requests skipped hold no resource, they
+	 * are not checked again in the next round.
+	 */
+	DQueueNode tail = getDQueueContainerTail(&(track->QueryResRequests));
 	while((availmemorymb < expmemorymb || availcore < expcore) &&
-		  track->QueryResRequests.NodeCount > 0 )
+		  track->QueryResRequests.NodeCount > 0 &&
+		  tail != NULL )
 	{
-		DQueueNode tail = getDQueueContainerTail(&(track->QueryResRequests));
 		SessionTrack strack = NULL;
 		while(tail != NULL)
 		{
@@ -4439,9 +4690,11 @@ void detectAndDealWithDeadLock(DynResourceQueueTrack track)
 		}
 		if ( tail != NULL )
 		{
+			DQueueNode cancelnode = tail;
+			tail = tail->Prev;
 			ConnectionTrack canceltrack = (ConnectionTrack)
 										  removeDQueueNode(&(track->QueryResRequests),
-												  	  	   tail);
+												  	  	   cancelnode);
 
 			snprintf(errorbuf, sizeof(errorbuf),
 					 "session "INT64_FORMAT" deadlock is detected",
@@ -0,0 +1,357 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+# 
+#   http://www.apache.org/licenses/LICENSE-2.0
+# 
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""
+Replay a trace of queries against a running resource manager and report the
+queueing delay, the utilization and the fairness it achieves.
+
+Every query of the trace registers a connection for its user, acquires
+resource the way the QD does, holds it for its duration, returns it and
+unregisters.  The acquire call blocks while the resource manager queues the
+request, so the time it takes is the queueing delay of the real scheduling
+code in resqueuemanager.c and resourcepool.c.  A background thread sends the
+resource heartbeats of the active connections like the QD does.
+
+To evaluate a queue configuration offline, start HAWQ with
+hawq_rm_respool_test_file pointing at a file of synthetic hosts, one
+"hostname,port,ip,..." line per host as loadHostInformationIntoResourcePool()
+expects.  The resource manager then takes these hosts as alive and needs no
+segments or heartbeats from them.  Create the roles and queues to evaluate
+and replay the trace with the roles as users.
+
+The trace is a CSV file with one query per line:
+
+    arrival_seconds,user,duration_seconds[,max_vseg[,min_vseg[,vseg_memory_mb]]]
+
+or is generated with --synthetic.  --speedup divides all the times of the
+trace, so hours of production load can be replayed in minutes; the delays
+are reported in the replay's seconds.
+"""
+
+import json
+import math
+import random
+import socket
+import struct
+import sys
+import threading
+import time
+from optparse import OptionParser
+
+REQUEST_QD_CONNECTION_REG = 257
+REQUEST_QD_CONNECTION_UNREG = 258
+REQUEST_QD_ACQUIRE_RESOURCE = 259
+REQUEST_QD_RETURN_RESOURCE = 260
+REQUEST_QD_REFRESH_RESOURCE = 264
+RESPONSE_OFFSET = 2048
+
+MESSAGE_HEAD = '<8sBBHI'
+MESSAGE_HEAD_SIZE = struct.calcsize(MESSAGE_HEAD)
+
+
+def pad64(content):
+    return content + b'\0' * ((8 - len(content) % 8) % 8)
+
+
+def recvall(conn, size):
+    data = b''
+    while len(data) < size:
+        chunk = conn.recv(size - len(data))
+        if not chunk:
+            raise IOError('connection closed by resource manager')
+        data += chunk
+    return data
+
+
+class ResourceManager(object):
+    """Synchronous RPCs to the resource manager, one connection per call."""
+
+    def __init__(self, opts):
+        self.opts = opts
+
+    def connect(self):
+        if self.opts.socktype == 'domain':
+            conn = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+            conn.connect(self.opts.sockdomainfile)
+        else:
+            conn = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+            conn.connect((self.opts.sockserver, int(self.opts.sockport)))
+        return conn
+
+    def call(self, msgid, content):
+        conn = self.connect()
+        try:
+            conn.sendall(struct.pack(MESSAGE_HEAD, b'MSGSTART', 0x80, 0,
+                                     msgid, len(content)) +
+                         content + b'MSGENDS!')
+            (mark, _, _, respid, size) = struct.unpack(
+                MESSAGE_HEAD, recvall(conn, MESSAGE_HEAD_SIZE))
+            if mark != b'MSGSTART' or respid != msgid + RESPONSE_OFFSET:
+                raise IOError('unexpected response %d to request %d' %
+                              (respid, msgid))
+            response = recvall(conn, size)
+            recvall(conn, 8)
+            return response
+        finally:
+            conn.close()
+
+    @staticmethod
+    def check(response):
+        (result,) = struct.unpack('<I', response[:4])
+        if result != 0:
+            text = response[8:].split(b'\0')[0].decode('utf-8', 'replace')
+            raise IOError('error %d %s' % (result, text))
+
+    def register(self, user):
+        response = self.call(REQUEST_QD_CONNECTION_REG,
+                             pad64(user.encode('utf-8') + b'\0'))
+        self.check(response)
+        return struct.unpack('<Ii', response[:8])[1]
+
+    def unregister(self, connid):
+        self.check(self.call(REQUEST_QD_CONNECTION_UNREG,
+                             struct.pack('<II', connid, 0)))
+
+    def acquire(self, sessionid, connid, query):
+        request = struct.pack('<qIIIIiIIIIIq', sessionid, connid, 0,
+                              query['max_vseg'], query['min_vseg'], 1,
+                              self.opts.vseg_per_seg, self.opts.vseg_limit,
+                              query['vseg_memory_mb'],
+                              query['max_vseg'] if query['vseg_memory_mb'] else 0,
+                              0, 0)
+        response = self.call(REQUEST_QD_ACQUIRE_RESOURCE, request)
+        self.check(response)
+        (_, _, segcount, segmemory, segcore) = struct.unpack('<IIIId',
+                                                             response[:24])
+        return (segcount, segmemory, segcore)
+
+    def release(self, connid):
+        self.check(self.call(REQUEST_QD_RETURN_RESOURCE,
+                             struct.pack('<II', connid, 0)))
+
+    def heartbeat(self, connids):
+        content = struct.pack('<iI', len(connids), 0)
+        content += b''.join(struct.pack('<i', c) for c in connids)
+        self.call(REQUEST_QD_REFRESH_RESOURCE, pad64(content))
+
+
+################################################################################
+# Trace and replay.
+################################################################################
+def load_trace(opts):
+    trace = []
+    if opts.synthetic:
+        rnd = random.Random(opts.seed)
+        users = opts.users.split(',')
+        arrival = 0.0
+        for i in range(opts.synthetic):
+            arrival += rnd.expovariate(opts.rate)
+            trace.append({'arrival': arrival,
+                          'user': rnd.choice(users),
+                          'duration': rnd.expovariate(1.0 / opts.mean_duration),
+                          'max_vseg': opts.max_vseg, 'min_vseg': 1,
+                          'vseg_memory_mb': 0})
+        return trace
+
+    with open(opts.trace) as f:
+        for line in f:
+            line = line.strip()
+            if not line or line.startswith('#'):
+                continue
+            fields = [x.strip() for x in line.split(',')]
+            trace.append({'arrival': float(fields[0]),
+                          'user': fields[1],
+                          'duration': float(fields[2]),
+                          'max_vseg': int(fields[3]) if len(fields) > 3 else opts.max_vseg,
+                          'min_vseg': int(fields[4]) if len(fields) > 4 else 1,
+                          'vseg_memory_mb': int(fields[5]) if len(fields) > 5 else 0})
+    trace.sort(key=lambda q: q['arrival'])
+    return trace
+
+
+class Replay(object):
+
+    def __init__(self, opts, trace):
+        self.opts = opts
+        self.rm = ResourceManager(opts)
+        self.trace = trace
+        self.lock = threading.Lock()
+        self.active = set()
+        self.done = False
+        self.results = []
+
+    def run_query(self, index, query, start):
+        speedup = self.opts.speedup
+        delay = start + query['arrival'] / speedup - time.time()
+        if delay > 0:
+            time.sleep(delay)
+
+        record = {'user': query['user'], 'submitted': time.time() - start}
+        connid = None
+        try:
+            connid = self.rm.register(query['user'])
+            with self.lock:
+                self.active.add(connid)
+            before = time.time()
+            (segcount, segmemory, segcore) = self.rm.acquire(
+                self.opts.session_base + index, connid, query)
+            record['wait'] = time.time() - before
+            record['segments'] = segcount
+            record['memory_mb'] = segcount * segmemory
+            record['core'] = segcount * segcore
+            time.sleep(query['duration'] / speedup)
+            record['hold'] = query['duration'] / speedup
+            self.rm.release(connid)
+        except (IOError, socket.error) as e:
+            record['error'] = str(e)
+        finally:
+            if connid is not None:
+                with self.lock:
+                    self.active.discard(connid)
+                try:
+                    self.rm.unregister(connid)
+                except (IOError, socket.error):
+                    pass
+        record['finished'] = time.time() - start
+        with self.lock:
+            self.results.append(record)
+
+    def send_heartbeats(self):
+        while not self.done:
+            with self.lock:
+                connids = sorted(self.active)
+            if connids:
+                try:
+                    self.rm.heartbeat(connids)
+                except (IOError, socket.error):
+                    pass
+            time.sleep(1)
+
+    def run(self):
+        start = time.time()
+        heartbeat = threading.Thread(target=self.send_heartbeats)
+        heartbeat.daemon = True
+        heartbeat.start()
+        threads = [threading.Thread(target=self.run_query, args=(i, q, start))
+                   for (i, q) in enumerate(self.trace)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        self.done = True
+        return time.time() - start
+
+
+################################################################################
+# Report.
+################################################################################
+def percentile(values, fraction):
+    if not values:
+        return 0.0
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * fraction))]
+
+
+def jain_index(values):
+    """1 when all values are equal, 1/n when one user gets everything."""
+    if not values or sum(x * x for x in values) == 0:
+        return 1.0
+    return sum(values) ** 2 / (len(values) * sum(x * x for x in values))
+
+
+def report(opts, results, elapsed):
+    ok = [r for r in results if 'error' not in r]
+    waits = [r['wait'] for r in ok]
+    summary = {
+        'queries': len(results),
+        'errors': len(results) - len(ok),
+        'elapsed_s': elapsed,
+        'wait_s': {'avg': sum(waits) / len(waits) if waits else 0.0,
+                   'p50': percentile(waits, 0.5),
+                   'p90': percentile(waits, 0.9),
+                   'p99': percentile(waits, 0.99),
+                   'max': max(waits) if waits else 0.0},
+        'users': {},
+    }
+
+    if opts.cluster_memory_mb:
+        used = sum(r['memory_mb'] * r['hold'] for r in ok)
+        summary['memory_utilization'] = used / (opts.cluster_memory_mb * elapsed)
+
+    slowdowns = []
+    for user in sorted(set(r['user'] for r in results)):
+        mine = [r for r in ok if r['user'] == user]
+        # bounded slowdown, so that very short queries do not dominate
+        floor = opts.slowdown_floor / opts.speedup
+        slow = [(r['wait'] + r['hold']) / max(r['hold'], floor) for r in mine]
+        entry = {'queries': len([r for r in results if r['user'] == user]),
+                 'avg_wait_s': sum(r['wait'] for r in mine) / len(mine) if mine else 0.0,
+                 'avg_slowdown': sum(slow) / len(slow) if slow else 0.0}
+        summary['users'][user] = entry
+        if slow:
+            slowdowns.append(entry['avg_slowdown'])
+    summary['fairness'] = jain_index(slowdowns)
+
+    print('queries %d errors %d elapsed %.1f s' %
+          (summary['queries'], summary['errors'], elapsed))
+    print('queueing delay s avg %.3f p50 %.3f p90 %.3f p99 %.3f max %.3f' %
+          tuple(summary['wait_s'][k] for k in ('avg', 'p50', 'p90', 'p99', 'max')))
+    if 'memory_utilization' in summary:
+        print('memory utilization %.1f%%' % (summary['memory_utilization'] * 100))
+    print('fairness (Jain index of the users\' slowdowns) %.3f' % summary['fairness'])
+    for (user, entry) in sorted(summary['users'].items()):
+        print('  %-20s queries %5d avg wait %8.3f s avg slowdown %6.2f' %
+              (user, entry['queries'], entry['avg_wait_s'], entry['avg_slowdown']))
+
+    if opts.output:
+        with open(opts.output, 'w') as f:
+            json.dump({'summary': summary, 'queries': results}, f, indent=1)
+
+
+def parseCLIArgs():
+    parser = OptionParser(usage="Replay a query trace against HAWQ RM.")
+    parser.add_option("-t", "--socktype", dest="socktype", action="store", default="domain", help="Set socket connection type : domain or inet, default is domain")
+    parser.add_option("-S", "--server", dest="sockserver", action="store", default="localhost", help="Set socket server address, default is localhost")
+    parser.add_option("-P", "--port", dest="sockport", action="store", type="int", default=5438, help="Set socket server port, default is 5438")
+    parser.add_option("-D", "--domainfile", dest="sockdomainfile", action="store", default="/tmp/.s.PGSQL.5436", help="Set domain socket file name, default is /tmp/.s.PGSQL.5436")
+    parser.add_option("--trace", dest="trace", help="CSV trace of the queries to replay")
+    parser.add_option("--synthetic", dest="synthetic", type="int", default=0, help="Generate this many queries instead of reading a trace")
+    parser.add_option("--users", dest="users", default="gpadmin", help="Comma separated users of the synthetic queries")
+    parser.add_option("--rate", dest="rate", type="float", default=1.0, help="Synthetic arrivals per second, default 1")
+    parser.add_option("--mean-duration", dest="mean_duration", type="float", default=10.0, help="Mean synthetic query duration in seconds, default 10")
+    parser.add_option("--seed", dest="seed", type="int", default=0, help="Random seed of the synthetic trace")
+    parser.add_option("--max-vseg", dest="max_vseg", type="int", default=6, help="Default maximum virtual segments per query, default 6")
+    parser.add_option("--vseg-per-seg", dest="vseg_per_seg", type="int", default=6, help="hawq_rm_nvseg_perquery_perseg_limit to send, default 6")
+    parser.add_option("--vseg-limit", dest="vseg_limit", type="int", default=512, help="hawq_rm_nvseg_perquery_limit to send, default 512")
+    parser.add_option("--speedup", dest="speedup", type="float", default=1.0, help="Divide all trace times by this factor")
+    parser.add_option("--slowdown-floor", dest="slowdown_floor", type="float", default=1.0, help="Minimum trace seconds of a query when computing slowdowns, default 1")
+    parser.add_option("--session-base", dest="session_base", type="int", default=1000000, help="First session id used for the queries")
+    parser.add_option("--cluster-memory-mb", dest="cluster_memory_mb", type="float", default=0, help="Total memory of the cluster, to report utilization")
+    parser.add_option("--output", dest="output", help="Write the summary and all queries as JSON")
+    (options, args) = parser.parse_args()
+    if not options.trace and not options.synthetic:
+        parser.error("need --trace or --synthetic")
+    return (options, args)
+
+
+# Main entry
+if __name__ == '__main__':
+    (opts, args) = parseCLIArgs()
+    trace = load_trace(opts)
+    replay = Replay(opts, trace)
+    elapsed = replay.run()
+    report(opts, replay.results, elapsed)
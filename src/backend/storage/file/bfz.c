@@ -21,6 +21,7 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <pthread.h>
 #include "storage/bfz.h"
 #include "storage/fd.h"
 #include "miscadmin.h"
@@ -31,6 +32,7 @@
 #include "utils/workfile_mgr.h"
 #include "storage/fd.h"
 #include "postmaster/primary_mirror_mode.h"
+#include "cdb/cdbgang.h"		/* gp_pthread_create */
 
 typedef pg_crc32 BFZ_CHECKSUM_TYPE;
 
@@ -54,9 +56,47 @@ static const struct{
 {
     {{"none", "false", "no", "off", "0", 0}, bfz_nothing_init},
     {{"zlib", 0}, bfz_zlib_init},
+    {{"lz4", 0}, bfz_lz4_init},
+    {{"zstd", 0}, bfz_zstd_init},
     {{0}}
 };
 
+/*
+ * Async writers.
+ *
+ * The helper threads of a backend write the blocks of all its bfz files,
+ * each at the offset the file had when the block was handed over, so the
+ * blocks of a file may be written in any order. A block is copied into a
+ * buffer of the pool, and the compression algorithm goes on with the next
+ * one while it is written; the backend waits only when all the buffers are
+ * in flight. The threads never call elog or palloc: the errno of a failed
+ * write is kept in the bfz_t, and reported by the next bfz_write_fully or
+ * bfz_async_wait of the file.
+ *
+ * The threads and the pool are started with the first file written when
+ * gp_workfile_async_writers is set, and last as long as the backend.
+ */
+typedef struct BfzAsyncBlock
+{
+	struct BfzAsyncBlock *next;	/* in the free list or in the queue */
+	bfz_t	   *bfz;
+	int			fd;
+	int64		offset;
+	int			len;
+	char		data[BFZ_ASYNC_BLOCK_SIZE];
+} BfzAsyncBlock;
+
+static pthread_mutex_t bfzAsyncMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t bfzAsyncQueued = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t bfzAsyncDone = PTHREAD_COND_INITIALIZER;
+static BfzAsyncBlock *bfzAsyncFree = NULL;
+static BfzAsyncBlock *bfzAsyncQueueHead = NULL;
+static BfzAsyncBlock *bfzAsyncQueueTail = NULL;
+static pthread_t bfzAsyncThreads[BFZ_MAX_ASYNC_WRITERS];
+static int	bfzAsyncNumThreads = 0;
+
+static bool bfz_async_start(void);
+
 static bfz_t *bfz_create_internal(bfz_t * bfz_handle, const char *fileName, bool open_existing, bool delOnClose, int compress);
 
 const char *
@@ -153,6 +193,10 @@ write_bfz_buffer(bfz_t *bfz, bool isLast)
 	PG_TRY();
 	{
 		fs->write_ex(bfz, fs->buffer, fs->buffer_pointer - fs->buffer);
+
+		/* the async writes of the file fail here, at the latest */
+		if (isLast)
+			bfz_async_wait(bfz, true);
 	}
 	PG_CATCH();
 	{
@@ -414,6 +458,11 @@ bfz_create_internal(bfz_t *bfz_handle, const char *fileName, bool open_existing,
 	
 	fs = bfz_handle->freeable_stuff;
 	bfz_handle->tot_bytes = 0;
+	bfz_handle->disk_bytes = 0;
+
+	if (!open_existing && gp_workfile_async_writers > 0 &&
+		compress != BFZ_COMPRESSION_ZLIB)
+		bfz_handle->async = bfz_async_start();
 
 	if (open_existing)
 	{
@@ -541,6 +590,8 @@ bfz_scan_begin(bfz_t * thiz)
 	fs = thiz->freeable_stuff;
 	fs->buffer_pointer = fs->buffer_end = fs->buffer;
 
+	bfz_prefetch(thiz);
+
 	if (gp_workfile_faultinject)
 	{
 		thiz->chosenBlockNo = (((double)random()) / ((double)MAX_RANDOM_VALUE)) * thiz->numBlocks;
@@ -630,6 +681,226 @@ bfz_read_ex(bfz_t * thiz, char *buffer, int size)
 	return orig_size - size;
 }
 
+/*
+ * Ask the kernel to read the file ahead, as it is about to be scanned.
+ */
+void
+bfz_prefetch(bfz_t * thiz)
+{
+	Assert(thiz->fd != -1);
+
+#if defined(HAVE_DECL_POSIX_FADVISE) && defined(POSIX_FADV_WILLNEED)
+	(void) posix_fadvise(thiz->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+	(void) posix_fadvise(thiz->fd, 0, 0, POSIX_FADV_WILLNEED);
+#endif
+}
+
+/*
+ * The helper thread: write the queued blocks, first queued first.
+ */
+static void *
+bfz_async_writer(void *arg)
+{
+	gp_set_thread_sigmasks();
+
+	pthread_mutex_lock(&bfzAsyncMutex);
+	for (;;)
+	{
+		BfzAsyncBlock *block;
+		int			done = 0;
+		int			err = 0;
+
+		if (bfzAsyncQueueHead == NULL)
+		{
+			pthread_cond_wait(&bfzAsyncQueued, &bfzAsyncMutex);
+			continue;
+		}
+
+		block = bfzAsyncQueueHead;
+		bfzAsyncQueueHead = block->next;
+		if (bfzAsyncQueueHead == NULL)
+			bfzAsyncQueueTail = NULL;
+		pthread_mutex_unlock(&bfzAsyncMutex);
+
+		while (done < block->len)
+		{
+			ssize_t		i = pwrite(block->fd, block->data + done,
+								   block->len - done, block->offset + done);
+
+			if (i < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				err = errno;
+				break;
+			}
+			if (i == 0)
+			{
+				err = ENOSPC;
+				break;
+			}
+			done += i;
+		}
+
+		pthread_mutex_lock(&bfzAsyncMutex);
+		if (err != 0 && block->bfz->async_errno == 0)
+			block->bfz->async_errno = err;
+		block->bfz->async_pending--;
+		Assert(block->bfz->async_pending >= 0);
+		block->bfz = NULL;
+		block->next = bfzAsyncFree;
+		bfzAsyncFree = block;
+		pthread_cond_broadcast(&bfzAsyncDone);
+	}
+	pthread_mutex_unlock(&bfzAsyncMutex);
+
+	return NULL;
+}
+
+/*
+ * Start the async writers up to gp_workfile_async_writers, with their
+ * buffers. Returns false if there is none, the files are then written
+ * synchronously.
+ */
+static bool
+bfz_async_start(void)
+{
+	while (bfzAsyncNumThreads < gp_workfile_async_writers)
+	{
+		BfzAsyncBlock *blocks;
+		int			pthread_err;
+		int			i;
+
+		blocks = (BfzAsyncBlock *) malloc(BFZ_ASYNC_BLOCKS_PER_WRITER * sizeof(BfzAsyncBlock));
+		if (blocks == NULL)
+		{
+			elog(LOG, "could not allocate the buffers of a workfile writer thread");
+			break;
+		}
+
+		pthread_err = gp_pthread_create(&bfzAsyncThreads[bfzAsyncNumThreads],
+										bfz_async_writer, NULL, "bfz_async_start");
+		if (pthread_err != 0)
+		{
+			elog(LOG, "could not create a workfile writer thread (error %d)", pthread_err);
+			free(blocks);
+			break;
+		}
+		bfzAsyncNumThreads++;
+
+		pthread_mutex_lock(&bfzAsyncMutex);
+		for (i = 0; i < BFZ_ASYNC_BLOCKS_PER_WRITER; i++)
+		{
+			blocks[i].bfz = NULL;
+			blocks[i].next = bfzAsyncFree;
+			bfzAsyncFree = &blocks[i];
+		}
+		pthread_mutex_unlock(&bfzAsyncMutex);
+	}
+
+	return bfzAsyncNumThreads > 0;
+}
+
+static void
+bfz_async_report_error(int err)
+{
+	errno = err;
+	ereport(ERROR,
+			(errcode(ERRCODE_IO_ERROR),
+			errmsg("could not write to temporary file: %m")));
+}
+
+/*
+ * Write size bytes at the end of the file, all of them or elog(ERROR).
+ * The compression algorithms other than zlib write their blocks through
+ * it, handed to the async writers if the file has them.
+ */
+void
+bfz_write_fully(bfz_t * thiz, const char *buffer, int size)
+{
+	Assert(thiz->mode == BFZ_MODE_APPEND);
+
+	if (thiz->async && size <= BFZ_ASYNC_BLOCK_SIZE)
+	{
+		BfzAsyncBlock *block;
+		int			err;
+
+		pthread_mutex_lock(&bfzAsyncMutex);
+		while ((err = thiz->async_errno) == 0 && bfzAsyncFree == NULL)
+			pthread_cond_wait(&bfzAsyncDone, &bfzAsyncMutex);
+		if (err != 0)
+		{
+			pthread_mutex_unlock(&bfzAsyncMutex);
+			bfz_async_report_error(err);
+		}
+		block = bfzAsyncFree;
+		bfzAsyncFree = block->next;
+		pthread_mutex_unlock(&bfzAsyncMutex);
+
+		memcpy(block->data, buffer, size);
+		block->bfz = thiz;
+		block->fd = thiz->fd;
+		block->offset = thiz->disk_bytes;
+		block->len = size;
+		block->next = NULL;
+
+		pthread_mutex_lock(&bfzAsyncMutex);
+		thiz->async_pending++;
+		if (bfzAsyncQueueTail != NULL)
+			bfzAsyncQueueTail->next = block;
+		else
+			bfzAsyncQueueHead = block;
+		bfzAsyncQueueTail = block;
+		pthread_cond_signal(&bfzAsyncQueued);
+		pthread_mutex_unlock(&bfzAsyncMutex);
+
+		thiz->disk_bytes += size;
+		return;
+	}
+
+	while (size)
+	{
+		ssize_t		i = pwrite(thiz->fd, buffer, size, thiz->disk_bytes);
+
+		if (i < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			ereport(ERROR,
+					(errcode(ERRCODE_IO_ERROR),
+					errmsg("could not write to temporary file: %m")));
+		}
+		if (i == 0)
+			bfz_async_report_error(ENOSPC);
+		buffer += i;
+		size -= i;
+		thiz->disk_bytes += i;
+	}
+}
+
+/*
+ * Wait for the async writes of the file. A failed one is reported if
+ * canReportError, the close_ex of the compression algorithms call this
+ * with false before closing the file.
+ */
+void
+bfz_async_wait(bfz_t * thiz, bool canReportError)
+{
+	int			err;
+
+	if (!thiz->async)
+		return;
+
+	pthread_mutex_lock(&bfzAsyncMutex);
+	while (thiz->async_pending > 0)
+		pthread_cond_wait(&bfzAsyncDone, &bfzAsyncMutex);
+	err = thiz->async_errno;
+	pthread_mutex_unlock(&bfzAsyncMutex);
+
+	if (err != 0 && canReportError)
+		bfz_async_report_error(err);
+}
+
 ssize_t
 readAndRetry(int fd, void *buffer, size_t size)
 {
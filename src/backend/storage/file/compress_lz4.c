@@ -0,0 +1,162 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/* compress_lz4.c */
+
+#include "postgres.h"
+
+#include "c.h"
+#include <unistd.h>
+#include <storage/bfz.h>
+#include <storage/fd.h>
+#include <lz4.h>
+
+/*
+ * This file implements bfz compression algorithm "lz4".
+ *
+ * Each buffer given to write_ex is compressed on its own into a block of
+ * the file: an int32 length followed by the LZ4 data. A buffer that does
+ * not compress is stored as it is, with the negated length, so a block is
+ * never larger than BFZ_BUFFER_SIZE plus the length. read_ex gives back the
+ * buffers as they were written, which the checksumming relies on.
+ */
+
+struct bfz_lz4_freeable_stuff
+{
+	struct bfz_freeable_stuff super;
+	char		compressed[LZ4_COMPRESSBOUND(BFZ_BUFFER_SIZE)];
+};
+
+/*
+ * bfz_lz4_close_ex
+ *  Close a file and freeing up descriptor, buffers etc.
+ *
+ *  This is also called from an xact end callback, hence it should
+ *  not contain any elog(ERROR) calls.
+ */
+static void
+bfz_lz4_close_ex(bfz_t * thiz)
+{
+	struct bfz_lz4_freeable_stuff *fs = (void *) thiz->freeable_stuff;
+
+	bfz_async_wait(thiz, false);
+	gp_retry_close(thiz->fd);
+	thiz->fd = -1;
+	free(fs);
+	thiz->freeable_stuff = NULL;
+}
+
+static int
+lz4_read_fully(bfz_t * thiz, char *buffer, int size)
+{
+	int			orig_size = size;
+
+	while (size)
+	{
+		int			i = readAndRetry(thiz->fd, buffer, size);
+
+		if (i < 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_IO_ERROR),
+					errmsg("could not read from temporary file: %m")));
+		if (i == 0)
+			break;
+		buffer += i;
+		size -= i;
+	}
+	return orig_size - size;
+}
+
+static void
+bfz_lz4_write_ex(bfz_t * thiz, const char *buffer, int size)
+{
+	struct bfz_lz4_freeable_stuff *fs = (void *) thiz->freeable_stuff;
+	int32		len;
+
+	Assert(size >= 0 && size <= BFZ_BUFFER_SIZE);
+
+	/* the last buffer of a file may be empty, a block of 0 is not valid */
+	if (size == 0)
+		return;
+
+	/* the block is put together after its length, and written at once */
+	len = LZ4_compress_default(buffer, fs->compressed + sizeof(len), size,
+							   sizeof(fs->compressed) - sizeof(len));
+	if (len <= 0 || len >= size)
+	{
+		len = -size;
+		memcpy(fs->compressed + sizeof(len), buffer, size);
+	}
+	memcpy(fs->compressed, &len, sizeof(len));
+	bfz_write_fully(thiz, fs->compressed, sizeof(len) + Abs(len));
+}
+
+static int
+bfz_lz4_read_ex(bfz_t * thiz, char *buffer, int size)
+{
+	struct bfz_lz4_freeable_stuff *fs = (void *) thiz->freeable_stuff;
+	int32		len;
+	int			i;
+
+	i = lz4_read_fully(thiz, (char *) &len, sizeof(len));
+	if (i == 0)
+		return 0;
+
+	if (i != sizeof(len) || len == 0 ||
+		len > (int32) sizeof(fs->compressed) || -len > size)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("invalid lz4 block in temporary file")));
+
+	if (len < 0)
+	{
+		if (lz4_read_fully(thiz, buffer, -len) != -len)
+			ereport(ERROR,
+					(errcode(ERRCODE_DATA_CORRUPTED),
+					 errmsg("unexpected end of temporary file")));
+		return -len;
+	}
+
+	if (lz4_read_fully(thiz, fs->compressed, len) != len)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("unexpected end of temporary file")));
+
+	i = LZ4_decompress_safe(fs->compressed, buffer, len, size);
+	if (i <= 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("invalid lz4 block in temporary file")));
+	return i;
+}
+
+void
+bfz_lz4_init(bfz_t * thiz)
+{
+	struct bfz_lz4_freeable_stuff *fs = malloc(sizeof *fs);
+
+	if (!fs)
+		ereport(ERROR,
+			(errcode(ERRCODE_OUT_OF_MEMORY),
+			 errmsg("out of memory")));
+
+	thiz->freeable_stuff = &fs->super;
+	fs->super.read_ex = bfz_lz4_read_ex;
+	fs->super.write_ex = bfz_lz4_write_ex;
+	fs->super.close_ex = bfz_lz4_close_ex;
+}
@@ -40,6 +40,7 @@
 static void
 bfz_nothing_close_ex(bfz_t * thiz)
 {
+	bfz_async_wait(thiz, false);
 	gp_retry_close(thiz->fd);
 	thiz->fd = -1;
 	free(thiz->freeable_stuff);
@@ -70,17 +71,7 @@ bfz_nothing_read_ex(bfz_t * thiz, char *buffer, int size)
 static void
 bfz_nothing_write_ex(bfz_t * bfz, const char *buffer, int size)
 {
-	while (size)
-	{
-		int			i = writeAndRetry(bfz->fd, buffer, size);
-
-		if (i < 0)
-			ereport(ERROR,
-					(errcode(ERRCODE_IO_ERROR),
-					errmsg("could not write to temporary file: %m")));
-		buffer += i;
-		size -= i;
-	}
+	bfz_write_fully(bfz, buffer, size);
 }
 
 void
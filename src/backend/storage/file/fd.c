@@ -66,7 +66,9 @@
 #include <fcntl.h>
 
 #include "access/xact.h"
+#include "executor/instrument.h"
 #include "cdb/cdbfilerep.h"
+#include "cdb/cdbgang.h"		/* gp_pthread_create */
 #include "cdb/cdbfilesystemcredential.h"
 #include "cdb/cdbvars.h"
 #include "miscadmin.h"
@@ -82,6 +84,7 @@
 #include "utils/faultinjector.h"
 
 #include "utils/memutils.h"
+#include "utils/atomic.h"
 
 #include "catalog/catalog.h"
 #include "catalog/catquery.h"
@@ -3358,18 +3361,40 @@ FileClose(File file) {
 
 int
 FileRead(File file, char *buffer, int amount) {
+	instr_time	start;
+	int			result;
+
+	INSTR_TIME_SET_CURRENT(start);
 	if (IsLocalPath(VfdCache[file].fileName))
-		return LocalFileRead(file, buffer, amount);
+	{
+		result = LocalFileRead(file, buffer, amount);
+		WAIT_USAGE_ACCUM(local_io_time, start);
+	}
 	else
-		return HdfsFileRead(file, buffer, amount);
+	{
+		result = HdfsFileRead(file, buffer, amount);
+		WAIT_USAGE_ACCUM(hdfs_io_time, start);
+	}
+	return result;
 }
 
 int
 FileWrite(File file, const char *buffer, int amount) {
+	instr_time	start;
+	int			result;
+
+	INSTR_TIME_SET_CURRENT(start);
 	if (IsLocalPath(VfdCache[file].fileName))
-		return LocalFileWrite(file, buffer, amount);
+	{
+		result = LocalFileWrite(file, buffer, amount);
+		WAIT_USAGE_ACCUM(local_io_time, start);
+	}
 	else
-		return HdfsFileWrite(file, buffer, amount);
+	{
+		result = HdfsFileWrite(file, buffer, amount);
+		WAIT_USAGE_ACCUM(hdfs_io_time, start);
+	}
+	return result;
 }
 
 /*
@@ -3479,6 +3504,137 @@ TestFileValid(File file)
     return FileIsValid(file);
 }
 
+/*
+ * Read-ahead handles.
+ *
+ * A read-ahead handle opens an open file a second time, so a helper thread
+ * can read it while the virtual file descriptor is used, or closed by the
+ * LRU, by the backend. FileReadAheadRead neither allocates memory nor
+ * reports errors. For a hdfs file, the filesystem was loaded when the file
+ * was opened, so its read and seek functions are only looked up.
+ *
+ * The handle is opened and closed by the backend, and is read by a single
+ * thread at a time.
+ */
+typedef struct FileReadAheadData
+{
+	int			fd;				/* kernel fd of a local file, else -1 */
+	char	   *protocol;		/* malloc'd */
+	hdfsFS		fs;
+	hdfsFile	hFile;
+	int64		position;		/* of hFile */
+} FileReadAheadData;
+
+/*
+ * Open a read-ahead handle of a file, NULL if it cannot be opened.
+ */
+FileReadAhead
+FileOpenReadAhead(File file)
+{
+	FileReadAheadData *readAhead;
+	char	   *fileName;
+
+	Assert(FileIsValid(file));
+	fileName = VfdCache[file].fileName;
+
+	readAhead = (FileReadAheadData *) malloc(sizeof(FileReadAheadData));
+	if (readAhead == NULL)
+		return NULL;
+	readAhead->fd = -1;
+	readAhead->protocol = NULL;
+	readAhead->fs = NULL;
+	readAhead->hFile = NULL;
+	readAhead->position = 0;
+
+	if (IsLocalPath(fileName))
+	{
+		readAhead->fd = BasicOpenFile(fileName, O_RDONLY | PG_BINARY, 0);
+		if (readAhead->fd < 0)
+		{
+			free(readAhead);
+			return NULL;
+		}
+	}
+	else
+	{
+		char	   *protocol;
+
+		if (!HdfsBasicOpenFile(fileName, O_RDONLY, 0, &protocol,
+							   &readAhead->fs, &readAhead->hFile))
+		{
+			free(readAhead);
+			return NULL;
+		}
+		readAhead->protocol = strdup(protocol);
+		if (readAhead->protocol == NULL)
+		{
+			HdfsCloseFile(protocol, readAhead->fs, readAhead->hFile);
+			pfree(protocol);
+			free(readAhead);
+			return NULL;
+		}
+		pfree(protocol);
+	}
+
+	return readAhead;
+}
+
+/*
+ * Read amount bytes at offset with a read-ahead handle, returns the number
+ * of bytes read, or -1 with errno set.
+ */
+int
+FileReadAheadRead(FileReadAhead readAhead, char *buffer, int amount, int64 offset)
+{
+	int			returnCode;
+
+	if (readAhead->fd >= 0)
+	{
+		do
+		{
+			returnCode = pread(readAhead->fd, buffer, amount, offset);
+		} while (returnCode < 0 && errno == EINTR);
+
+		return returnCode;
+	}
+
+	if (readAhead->position != offset)
+	{
+		if (HdfsSeek(readAhead->protocol, readAhead->fs, readAhead->hFile, offset) != 0)
+		{
+			readAhead->position = -1;
+			return -1;
+		}
+		readAhead->position = offset;
+	}
+
+	returnCode = HdfsRead(readAhead->protocol, readAhead->fs, readAhead->hFile,
+						  buffer, amount);
+	if (returnCode >= 0)
+		readAhead->position += returnCode;
+	else
+		readAhead->position = -1;
+
+	return returnCode;
+}
+
+/*
+ * Close a read-ahead handle, no helper thread may be reading it.
+ */
+void
+FileCloseReadAhead(FileReadAhead readAhead)
+{
+	if (readAhead->fd >= 0)
+		close(readAhead->fd);
+	else if (HdfsCloseFile(readAhead->protocol, readAhead->fs, readAhead->hFile) != 0)
+		elog(LOG, "could not close the read-ahead handle of a file: %s",
+			 HdfsGetLastError());
+
+	if (readAhead->protocol)
+		free(readAhead->protocol);
+	free(readAhead);
+}
+
 bool
 HdfsPathExist(char *path)
 {
@@ -3750,6 +3906,116 @@ HdfsGetFileBlockLocations(const char *path, int64 length, int *block_num)
     return HdfsGetFileBlockLocations2(path, 0, length, block_num);
 }
 
+/*
+ * The namenode RPC fetching the block locations of one file.  The threads
+ * only call libhdfs3, the connection and the path are resolved beforehand.
+ */
+typedef struct HdfsBlockLocationJob
+{
+	hdfsFS		fs;
+	char		relative_path[MAXPGPATH + 1];
+	int64		length;
+	BlockLocation *locations;	/* allocated by libhdfs3, NULL on failure */
+	int			block_num;
+} HdfsBlockLocationJob;
+
+typedef struct HdfsBlockLocationJobs
+{
+	HdfsBlockLocationJob *jobs;
+	int32		njobs;
+	volatile int32 next;		/* next job to take */
+} HdfsBlockLocationJobs;
+
+/*
+ * Run the jobs not yet taken by another thread.
+ */
+static void *
+HdfsGetFileBlockLocationsThread(void *arg)
+{
+	HdfsBlockLocationJobs *blockJobs = (HdfsBlockLocationJobs *) arg;
+
+	for (;;)
+	{
+		int32		jobno = gp_atomic_add_32(&blockJobs->next, 1) - 1;
+		HdfsBlockLocationJob *job;
+
+		if (jobno >= blockJobs->njobs)
+			break;
+
+		job = &blockJobs->jobs[jobno];
+		if (job->fs != NULL)
+			job->locations = hdfsGetFileBlockLocations(job->fs, job->relative_path,
+													   0, job->length, &job->block_num);
+	}
+
+	return NULL;
+}
+
+/*
+ * HdfsGetFileBlockLocationsParallel
+ *		Fetch the block locations of several files, with up to nthreads
+ *		namenode RPCs in flight.
+ *
+ * locations[i] and block_nums[i] get what HdfsGetFileBlockLocations would
+ * return for paths[i]; free the locations with HdfsFreeFileBlockLocations.
+ */
+void
+HdfsGetFileBlockLocationsParallel(int nfiles, char **paths, int64 *lengths,
+								  BlockLocation **locations, int *block_nums,
+								  int nthreads)
+{
+	HdfsBlockLocationJobs blockJobs;
+	pthread_t  *threads;
+	int			maxthreads;
+	int			numthreads = 0;
+	int			i;
+
+	if (nfiles <= 0)
+		return;
+
+	blockJobs.jobs = (HdfsBlockLocationJob *) palloc0(nfiles * sizeof(HdfsBlockLocationJob));
+	blockJobs.njobs = nfiles;
+	blockJobs.next = 0;
+	for (i = 0; i < nfiles; i++)
+	{
+		HdfsBlockLocationJob *job = &blockJobs.jobs[i];
+		char	   *protocol;
+
+		if (HdfsParsePath(paths[i], &protocol, NULL, NULL, NULL) || (NULL == protocol))
+			elog(ERROR, "cannot get protocol for path: %s", paths[i]);
+		pfree(protocol);
+
+		job->fs = HdfsGetConnection(paths[i], false);
+		if (NULL == ConvertToUnixPath(paths[i], job->relative_path, sizeof(job->relative_path)))
+			elog(ERROR, "cannot convert to unix path for path: %s", paths[i]);
+		job->length = lengths[i];
+	}
+
+	/* this thread takes jobs too */
+	maxthreads = Min(nthreads, nfiles) - 1;
+	threads = (pthread_t *) palloc(Max(maxthreads, 1) * sizeof(pthread_t));
+	for (i = 0; i < maxthreads; i++)
+	{
+		if (gp_pthread_create(&threads[numthreads], HdfsGetFileBlockLocationsThread,
+							  &blockJobs, "HdfsGetFileBlockLocationsParallel") != 0)
+			break;
+		numthreads++;
+	}
+
+	HdfsGetFileBlockLocationsThread(&blockJobs);
+
+	for (i = 0; i < numthreads; i++)
+		pthread_join(threads[i], NULL);
+	pfree(threads);
+
+	for (i = 0; i < nfiles; i++)
+	{
+		locations[i] = blockJobs.jobs[i].locations;
+		block_nums[i] = blockJobs.jobs[i].block_num;
+	}
+	pfree(blockJobs.jobs);
+}
+
 /*
  *  TDE UDF
  *
@@ -63,9 +63,12 @@
 #include "cdb/memquota.h"
 #include "executor/spi.h"
 #include "utils/workfile_mgr.h"
+#include "utils/rangercache.h"
 #include "cdb/cdbmetadatacache.h"
+#include "cdb/cdbparquetfootercache.h"
 #include "cdb/cdbtmpdir.h"
 #include "utils/session_state.h"
+#include "utils/memaccounting_snapshot.h"
 
 #include "resourcemanager/dynrm.h"
 
@@ -182,6 +185,10 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
             elog(LOG, "Metadata Cache Share Memory Size : %lu", MetadataCache_ShmemSize());
         }
 
+		size = add_size(size, RangerCache_ShmemSize());
+
+		size = add_size(size, ParquetFooterCache_ShmemSize());
+
 		
 #ifdef FAULT_INJECTOR
 		size = add_size(size, FaultInjector_ShmemSize());
@@ -217,6 +224,9 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 		/* Consider the size of the SessionState array */
 		size = add_size(size, SessionState_ShmemSize());
 
+		/* and the published memory account trees */
+		size = add_size(size, MemoryAccounting_ShmemSize());
+
 		/*
 		 * Create the shmem segment
 		 */
@@ -305,6 +315,8 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
     {
         MetadataCache_ShmemInit();
     }
+	RangerCache_ShmemInit();
+	ParquetFooterCache_ShmemInit();
 
 	if (!IsUnderPostmaster)
 	{
@@ -314,6 +326,8 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 
 	/* Initialize SessionState shared memory array */
 	SessionState_ShmemInit();
+	/* Initialize the published memory account trees */
+	MemoryAccounting_ShmemInit();
 	/* Initialize vmem protection */
 	GPMemoryProtect_ShmemInit();
 
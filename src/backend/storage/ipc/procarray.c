@@ -37,6 +37,7 @@
 #include "access/twophase.h"
 #include "miscadmin.h"
 #include "storage/procarray.h"
+#include "utils/atomic.h"
 #include "utils/combocid.h"
 #include "utils/guc.h"
 #include "utils/memutils.h"
@@ -60,6 +61,45 @@ typedef struct ProcArrayStruct
 
 static ProcArrayStruct *procArray;
 
+/*
+ * The last snapshot computed by any backend, published for the backends
+ * taking a snapshot before any transaction has left the running set.
+ *
+ * xactCompletionCount is advanced, while holding ProcArrayLock exclusively,
+ * whenever a transaction whose outcome others may see stops running.  A
+ * snapshot computed under ProcArrayLock at count N is still exact as long as
+ * the count stays N: the transactions started since have xids beyond its
+ * xmax, so they are taken as running anyway.  Transactions that made no
+ * XLOG entries do not advance the count, their xids appear nowhere in the
+ * database, so whether a snapshot takes them as running makes no difference.
+ *
+ * The snapshot is a seqlock: seq is odd while a backend writes it, and
+ * readers recheck seq after the copy.  Unlike the one computed by the
+ * publisher, the published xip[] includes the xid of the publisher.
+ */
+typedef struct SharedSnapshotStruct
+{
+	volatile int32 xactCompletionCount;
+	volatile int32 seq;
+
+	bool		valid;
+	int32		completionCount;	/* xactCompletionCount it is exact for */
+	TransactionId xmax;
+	TransactionId globalxmin;
+	int			xcnt;
+	int32		subxcnt;		/* -1 if some subxids overflowed */
+	TransactionId *xip;			/* maxProcs entries */
+	TransactionId *subxip;		/* maxProcs * PGPROC_MAX_CACHED_SUBXIDS */
+} SharedSnapshotStruct;
+
+static SharedSnapshotStruct *sharedSnapshot;
+
+static bool GetSnapshotDataFromShared(Snapshot snapshot, bool serializable,
+						  TransactionId myxid);
+static void PublishSharedSnapshot(Snapshot snapshot, int count, int subcount,
+					  TransactionId xmax, TransactionId globalxmin,
+					  int32 completionCount);
+
 
 #ifdef XIDCACHE_DEBUG
 
@@ -96,6 +136,13 @@ ProcArrayShmemSize(void)
 	size = add_size(size, mul_size(sizeof(PGPROC *),
 								 add_size(MaxBackends, max_prepared_xacts)));
 
+	/* the shared snapshot and its xid arrays */
+	size = MAXALIGN(size);
+	size = add_size(size, MAXALIGN(sizeof(SharedSnapshotStruct)));
+	size = add_size(size, mul_size(sizeof(TransactionId),
+								 mul_size(add_size(MaxBackends, max_prepared_xacts),
+										  PGPROC_MAX_CACHED_SUBXIDS + 1)));
+
 	return size;
 }
 
@@ -119,6 +166,31 @@ CreateSharedProcArray(void)
 		procArray->numProcs = 0;
 		procArray->maxProcs = MaxBackends + max_prepared_xacts;
 	}
+
+	sharedSnapshot = (SharedSnapshotStruct *)
+		((char *) procArray +
+		 MAXALIGN(offsetof(ProcArrayStruct, procs) +
+				  sizeof(PGPROC *) * (MaxBackends + max_prepared_xacts)));
+
+	if (!found)
+	{
+		MemSet(sharedSnapshot, 0, sizeof(SharedSnapshotStruct));
+		sharedSnapshot->xip = (TransactionId *)
+			((char *) sharedSnapshot + MAXALIGN(sizeof(SharedSnapshotStruct)));
+		sharedSnapshot->subxip = sharedSnapshot->xip + procArray->maxProcs;
+	}
+}
+
+/*
+ * ProcArrayInvalidateSharedSnapshot -- stop the backends from reusing the
+ * shared snapshot, because a transaction left the running set.
+ *
+ * The caller holds ProcArrayLock exclusively.
+ */
+void
+ProcArrayInvalidateSharedSnapshot(void)
+{
+	gp_atomic_add_32(&sharedSnapshot->xactCompletionCount, 1);
 }
 
 /*
@@ -173,6 +245,8 @@ ProcArrayRemove(PGPROC *proc, bool isCommit)
 		{
 			arrayP->procs[index] = arrayP->procs[arrayP->numProcs - 1];
 			arrayP->numProcs--;
+			/* a prepared transaction may leave the running set */
+			ProcArrayInvalidateSharedSnapshot();
 			LWLockRelease(ProcArrayLock);
 			return;
 		}
@@ -509,6 +583,7 @@ GetSnapshotData(Snapshot snapshot, bool serializable)
 	int			index;
 	int			count = 0;
 	int			subcount = 0;
+	int32		completionCount;
 
 	Assert(snapshot != NULL);
 
@@ -553,6 +628,10 @@ GetSnapshotData(Snapshot snapshot, bool serializable)
 		 "GetSnapshotData setting globalxmin and xmin to %u", 
 	 	 xmin);
 
+	if (gp_enable_snapshot_sharing &&
+		GetSnapshotDataFromShared(snapshot, serializable, xmin))
+		return snapshot;
+
 	/*
 	 * It is sufficient to get shared lock on ProcArrayLock, even if
 	 * we are computing a serializable snapshot and therefore will be
@@ -667,6 +746,9 @@ GetSnapshotData(Snapshot snapshot, bool serializable)
 	if (serializable)
 		MyProc->xmin = TransactionXmin = xmin;
 
+	/* stable, it only advances under ProcArrayLock held exclusively */
+	completionCount = sharedSnapshot->xactCompletionCount;
+
 	LWLockRelease(ProcArrayLock);
 
 	/*
@@ -688,9 +770,153 @@ GetSnapshotData(Snapshot snapshot, bool serializable)
 
 	snapshot->curcid = GetCurrentCommandId();
 
+	if (gp_enable_snapshot_sharing)
+		PublishSharedSnapshot(snapshot, count, subcount, xmax, globalxmin,
+							  completionCount);
+
 	return snapshot;
 }
 
+/*
+ * GetSnapshotDataFromShared -- GetSnapshotData from the shared snapshot,
+ * without taking ProcArrayLock.
+ *
+ * Returns false if the shared snapshot is not exact any more, or is being
+ * written, or our xid is beyond its xmax.
+ */
+static bool
+GetSnapshotDataFromShared(Snapshot snapshot, bool serializable,
+						  TransactionId myxid)
+{
+	volatile SharedSnapshotStruct *shared = sharedSnapshot;
+	int32		seq;
+	int32		completionCount;
+	TransactionId xmin = myxid;
+	TransactionId xmax;
+	TransactionId globalxmin;
+	int			xcnt;
+	int32		subxcnt;
+	int			count = 0;
+	int			i;
+
+	/* our subxids would have to be taken out of the shared ones too */
+	if (MyProc->subxids.nxids > 0 || MyProc->subxids.overflowed)
+		return false;
+
+	seq = gp_atomic_add_32(&shared->seq, 0);
+	if (seq & 1)
+		return false;
+
+	completionCount = shared->completionCount;
+	if (!shared->valid ||
+		completionCount != gp_atomic_add_32(&shared->xactCompletionCount, 0))
+		return false;
+
+	xmax = shared->xmax;
+	globalxmin = shared->globalxmin;
+	xcnt = shared->xcnt;
+	subxcnt = shared->subxcnt;
+	if (!TransactionIdPrecedes(myxid, xmax) ||
+		xcnt < 0 || xcnt > procArray->maxProcs ||
+		subxcnt > procArray->maxProcs * PGPROC_MAX_CACHED_SUBXIDS)
+		return false;
+
+	for (i = 0; i < xcnt; i++)
+	{
+		TransactionId xid = shared->xip[i];
+
+		if (TransactionIdEquals(xid, myxid))
+			continue;
+
+		if (TransactionIdPrecedes(xid, xmin))
+			xmin = xid;
+
+		snapshot->xip[count] = xid;
+		count++;
+	}
+	if (subxcnt > 0)
+		memcpy(snapshot->subxip, shared->subxip,
+			   subxcnt * sizeof(TransactionId));
+
+	/* the copy is torn if a backend published meanwhile */
+	if (gp_atomic_add_32(&shared->seq, 0) != seq)
+		return false;
+
+	if (serializable)
+	{
+		/*
+		 * Advertise our xmin before checking again that no transaction ended:
+		 * a transaction ending later sees it when computing its horizons.
+		 */
+		MyProc->xmin = TransactionXmin = xmin;
+		if (gp_atomic_add_32(&shared->xactCompletionCount, 0) != completionCount)
+		{
+			MyProc->xmin = TransactionXmin = InvalidTransactionId;
+			return false;
+		}
+	}
+
+	if (TransactionIdPrecedes(xmin, globalxmin))
+		globalxmin = xmin;
+
+	RecentGlobalXmin = globalxmin;
+	RecentXmin = xmin;
+
+	snapshot->xmin = xmin;
+	snapshot->xmax = xmax;
+	snapshot->xcnt = count;
+	snapshot->subxcnt = subxcnt;
+
+	snapshot->curcid = GetCurrentCommandId();
+
+	return true;
+}
+
+/*
+ * PublishSharedSnapshot -- publish the snapshot just computed by
+ * GetSnapshotData, with our own xids added.
+ *
+ * Skipped if another backend is publishing one right now.
+ */
+static void
+PublishSharedSnapshot(Snapshot snapshot, int count, int subcount,
+					  TransactionId xmax, TransactionId globalxmin,
+					  int32 completionCount)
+{
+	volatile SharedSnapshotStruct *shared = sharedSnapshot;
+	int32		seq = shared->seq;
+	int			nxids = MyProc->subxids.nxids;
+
+	if (!TransactionIdIsNormal(MyProc->xid) || (seq & 1) ||
+		!compare_and_swap_32((uint32 *) &shared->seq, seq, seq + 1))
+		return;
+
+	shared->valid = true;
+	shared->completionCount = completionCount;
+	shared->xmax = xmax;
+
+	if (TransactionIdIsNormal(MyProc->xmin) &&
+		TransactionIdPrecedes(MyProc->xmin, globalxmin))
+		globalxmin = MyProc->xmin;
+	shared->globalxmin = globalxmin;
+
+	memcpy(shared->xip, snapshot->xip, count * sizeof(TransactionId));
+	shared->xip[count] = MyProc->xid;
+	shared->xcnt = count + 1;
+
+	if (subcount < 0 || MyProc->subxids.overflowed)
+		shared->subxcnt = -1;
+	else
+	{
+		memcpy(shared->subxip, snapshot->subxip, subcount * sizeof(TransactionId));
+		memcpy(shared->subxip + subcount, MyProc->subxids.xids,
+			   nxids * sizeof(TransactionId));
+		shared->subxcnt = subcount + nxids;
+	}
+
+	gp_atomic_add_32(&shared->seq, 1);
+}
+
 /*
  * MPP: Special code to update the command id in the SharedLocalSnapshot
  * when we are in SERIALIZABLE isolation mode.
@@ -983,6 +1209,8 @@ XidCacheRemoveRunningXids(TransactionId xid, int nxids, TransactionId *xids)
 			elog(WARNING, "did not find subXID %u in MyProc", anxid);
 	}
 
+	ProcArrayInvalidateSharedSnapshot();
+
 	for (j = MyProc->subxids.nxids - 1; j >= 0; j--)
 	{
 		if (TransactionIdEquals(MyProc->subxids.xids[j], xid))
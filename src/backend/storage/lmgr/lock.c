@@ -43,6 +43,7 @@
 #include "utils/ps_status.h"
 #include "utils/testutils.h"
 #include "executor/execdesc.h"
+#include "executor/instrument.h"
 #include "utils/resscheduler.h"
 #include "storage/procarray.h"
 
@@ -1304,8 +1305,11 @@ WaitOnLock(LOCALLOCK *locallock, ResourceOwner owner)
 	LOCKMETHODID lockmethodid = LOCALLOCK_LOCKMETHOD(*locallock);
 	LockMethod	lockMethodTable = LockMethods[lockmethodid];
 	char	   * volatile new_status = NULL;
+	instr_time	wait_start;
 	Assert(!locallock->isFake);
 
+	INSTR_TIME_SET_CURRENT(wait_start);
+
 	LOCK_PRINT("WaitOnLock: sleeping on lock",
 			   locallock->lock, locallock->tag.mode);
 
@@ -1383,6 +1387,7 @@ WaitOnLock(LOCALLOCK *locallock, ResourceOwner owner)
 	PG_END_TRY();
 
 	awaitedLock = NULL;
+	WAIT_USAGE_ACCUM(lock_time, wait_start);
 
 	/* Report change to non-waiting status */
 	pgstat_report_waiting(false);
@@ -1337,6 +1337,9 @@ smgrDoDeleteActions(
 
 	PersistentFileSysObjStateChangeResult *stateChangeResults;
 
+	bool batchLocked;
+	bool persistentObjLockIsHeldByMe = false;
+
 	if (*listCount == 0)
 		stateChangeResults = NULL;
 	else
@@ -1346,7 +1349,21 @@ smgrDoDeleteActions(
 
 	/*
 	 * First pass does the initial State-Changes.
+	 *
+	 * A transaction that touched many relations has a State-Change for each
+	 * of their files.  Take the persistent locks once, in the order of
+	 * WRITE_PERSISTENT_STATE_ORDERED_LOCK, for the whole pass rather than
+	 * around every State-Change, which then sees them held by us.
 	 */
+	batchLocked = (*listCount > 1 && !Persistent_BeforePersistenceWork());
+	if (batchLocked)
+	{
+		CHECKPOINT_START_LOCK;
+		persistentObjLockIsHeldByMe = LWLockHeldByMe(PersistentObjLock);
+		if (!persistentObjLockIsHeldByMe)
+			LWLockAcquire(PersistentObjLock, LW_EXCLUSIVE);
+	}
+
 	entryIndex = 0;
 	current = *list;
 	while (true)
@@ -1438,6 +1455,13 @@ smgrDoDeleteActions(
 
 	}
 
+	if (batchLocked)
+	{
+		if (!persistentObjLockIsHeldByMe)
+			LWLockRelease(PersistentObjLock);
+		CHECKPOINT_START_UNLOCK;
+	}
+
 	/*
 	 * Make the above State-Changes permanent.
 	 */
@@ -86,6 +86,7 @@
 #include "tcop/tcopprot.h"
 #include "tcop/utility.h"
 #include "utils/flatfiles.h"
+#include "utils/catcache.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/ps_status.h"
@@ -102,6 +103,7 @@
 #include "cdb/cdbfilesystemcredential.h"
 #include "cdb/cdbquerycontextdispatching.h"
 #include "cdb/ml_ipc.h"
+#include "cdb/cdbnuma.h"
 #include "utils/guc.h"
 #include "utils/faultinjector.h"
 #include "access/twophase.h"
@@ -1216,9 +1218,14 @@ exec_mpp_query(const char *query_string,
     	}
 	*/
 
+    	/* Keep the QE and its memory on the NUMA node of its virtual segment */
+    	NumaBindQE(GetQEIndex());
+
     	ShowCGroupEnablementInformation("cpu");
+    	ShowCGroupEnablementInformation("blkio");
 
-    	if ( isCGroupEnabled("cpu") && isCGroupSetup("cpu") )
+    	if ( (isCGroupEnabled("cpu") && isCGroupSetup("cpu")) ||
+    		 (isCGroupEnabled("blkio") && isCGroupSetup("blkio")) )
     	{
     		int res = FUNC_RETURN_OK;
     		char errorbuf[ERRORMESSAGE_SIZE];
@@ -2613,7 +2620,10 @@ exec_bind_message(StringInfo input_message)
 		qContext = PortalGetHeapMemory(portal);
 		oldContext = MemoryContextSwitchTo(qContext);
 		query_list_copy = copyObject(pstmt->query_list); /* planner scribbles on query tree */
-		stmt_list = pg_plan_queries(query_list_copy, params, true, QRL_ONCE);
+		if (*pstmt->stmt_name)
+			stmt_list = PlanPreparedStatement(pstmt, query_list_copy, params);
+		else
+			stmt_list = pg_plan_queries(query_list_copy, params, true, QRL_ONCE);
 		MemoryContextSwitchTo(oldContext);
 	}
 
@@ -3294,6 +3304,9 @@ finish_xact_command(void)
 		/* Cancel any active statement timeout before committing */
 		disable_sig_alarm(true);
 
+		/* Leave our catalog caches for the next backends, if no one did */
+		AtEOXact_CatCacheInitFile();
+
 		/* Now commit the command */
 		ereport(DEBUG3,
 				(errmsg_internal("CommitTransactionCommand")));
@@ -46,6 +46,8 @@
 #include "utils/faultinjector.h"
 #include "utils/memutils.h"
 #include "utils/resscheduler.h"
+#include "utils/timestamp.h"
+#include "storage/ipc.h"
 #include "commands/vacuum.h"
 #include "commands/tablecmds.h"
 #include "commands/queue.h"
@@ -86,10 +88,33 @@ typedef struct QueryResourceItem {
   bool alive;
   int resource_id;
   bool allocateSucceed;
+  Oid user_oid;
+  int slice_size;
 } QueryResourceItem;
 
 static List *GlobalQueryResources = NIL;
 
+/*
+ * The resource context the session keeps registered in resource manager after
+ * a query returned its resource, for the next query of the user to acquire
+ * resource without registering again (hawq_rm_reuse_registration_timeout).
+ */
+static int KeptResourceId = -1;
+static Oid KeptResourceUser = InvalidOid;
+static TimestampTz KeptResourceTime = 0;
+
+/*
+ * The resource context whose allocated resource the session keeps after a
+ * query, for the next query of the user needing no more slices and accepting
+ * as many virtual segments to run without a round trip to resource manager
+ * (hawq_rm_resource_lease_timeout).
+ */
+static int LeasedResourceId = -1;
+static Oid LeasedResourceUser = InvalidOid;
+static int LeasedResourceSliceSize = 0;
+static TimestampTz LeasedResourceTime = 0;
+static bool LeasedResourceExitRegistered = false;
+
 static void ProcessQuery(Portal portal, /* Resource queueing need SQL, so we pass portal. */
 			 PlannedStmt *stmt,
              ParamListInfo params,
@@ -111,7 +136,15 @@ static int64 DoPortalRunFetch(Portal portal,
 				 DestReceiver *dest);
 static void DoPortalRewind(Portal portal);
 
-static void AddToGlobalQueryResources(int resourceId, QueryResourceLife life);
+static int TakeLeasedResource(Oid userOid, int sliceSize,
+							  int maxTargetSegNum, int minTargetSegNum);
+static void ReturnResourceContext(int resourceId, Oid userOid);
+static void ReturnLeasedResourceOnExit(int code, Datum arg);
+static void AddToGlobalQueryResources(int resourceId, QueryResourceLife life,
+									  Oid userOid, int sliceSize);
+static int RegisterResourceContext(Oid userOid);
+static int TakeKeptResourceContext(Oid userOid);
+static void ReleaseResourceContextInRM(int resourceId);
 static void RemoveFromGlobalQueryResources(int resourceId, QueryResourceLife life);
 static void SetResourcesAllocatedSucceed(int resourceId, QueryResourceLife life);
 static int compare_segment(const void *e1, const void *e2);
@@ -755,6 +788,8 @@ AllocateResource(QueryResourceLife   life,
 
 	int ret;
 	int resourceId = -1;
+	bool reused;
+	Oid useridoid;
 	static char errorbuf[1024];
 
 	QDResourceContext rescontext = NULL;
@@ -771,42 +806,60 @@ AllocateResource(QueryResourceLife   life,
 	if (life == QRL_INHERIT)
 		return InheritateResource();
 
-	/* Create new resource context. */
-	ret = createNewResourceContext(&resourceId);
-	if ( ret == FUNC_RETURN_OK )
+	useridoid = GetUserId();
+	Assert( useridoid != InvalidOid);
+
+	/* Run on the resource leased by the last query if it fits. */
+	resourceId = TakeLeasedResource(useridoid,
+									slice_size,
+									max_target_segment_num,
+									min_target_segment_num);
+	if (resourceId >= 0)
 	{
-		elog(DEBUG3, "Created new resource context for this session indexed %d",
-					 resourceId);
-	}
-	else {
-		Assert( ret == COMM2RM_CLIENT_FULL_RESOURCECONTEXT);
-		elog(ERROR, "Too many resource contexts in this session.");
+		AddToGlobalQueryResources(resourceId, life, useridoid, slice_size);
+		ret = FUNC_RETURN_OK;
 	}
 
-	/* Register connection. */
-	uint64_t useridoid = GetUserId();
-	Assert( useridoid != InvalidOid);
-	ret = registerConnectionInRMByOID(resourceId,
-									  useridoid,
-									  errorbuf,
-									  sizeof(errorbuf));
-	if (ret != FUNC_RETURN_OK)
+	while (resourceId < 0)
 	{
-		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR), errmsg("%s",errorbuf)));
+		/* Reuse the registered connection of the last query, or register. */
+		resourceId = TakeKeptResourceContext(useridoid);
+		reused = (resourceId >= 0);
+		if (!reused)
+		{
+			resourceId = RegisterResourceContext(useridoid);
+		}
+
+		AddToGlobalQueryResources(resourceId, life, useridoid, slice_size);
+		/* Acquire resource. */
+		ret = acquireResourceFromRM(resourceId,
+									gp_session_id,
+									slice_size,
+									iobytes,
+									vol_info,
+									vol_info_size,
+									max_target_segment_num,
+									min_target_segment_num,
+									errorbuf,
+									sizeof(errorbuf));
+
+		/*
+		 * Resource manager may have timed out the kept connection, or lost it
+		 * in a restart, register again.
+		 */
+		if (ret == FUNC_RETURN_OK || !reused ||
+			(ret != CONNTRACK_NO_CONNID && ret != REQUESTHANDLER_WRONG_CONNSTAT))
+		{
+			break;
+		}
+
+		elog(LOG, "resource context %d kept registered is not usable, %s",
+				  resourceId, errorbuf);
+		RemoveFromGlobalQueryResources(resourceId, life);
+		ReleaseResourceContextInRM(resourceId);
+		resourceId = -1;
 	}
 
-	AddToGlobalQueryResources(resourceId, life);
-	/* Acquire resource. */
-	ret = acquireResourceFromRM(resourceId,
-								gp_session_id,
-								slice_size,
-								iobytes,
-								vol_info,
-								vol_info_size,
-								max_target_segment_num,
-								min_target_segment_num,
-								errorbuf,
-								sizeof(errorbuf));
 	if (ret != FUNC_RETURN_OK) {
 		RemoveFromGlobalQueryResources(resourceId, life);
 		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR), errmsg("%s",errorbuf)));
@@ -925,8 +978,198 @@ AutoFreeResource(QueryResource *resource)
 	FreeResource(resource);
 }
 
+/*
+ * Create a new resource context and register it in resource manager for the
+ * user, returns the index of the resource context.
+ */
+static int
+RegisterResourceContext(Oid userOid)
+{
+	int resourceId = -1;
+	int ret;
+	static char errorbuf[1024];
+
+	/* Create new resource context. */
+	ret = createNewResourceContext(&resourceId);
+	if ( ret == FUNC_RETURN_OK )
+	{
+		elog(DEBUG3, "Created new resource context for this session indexed %d",
+					 resourceId);
+	}
+	else {
+		Assert( ret == COMM2RM_CLIENT_FULL_RESOURCECONTEXT);
+		elog(ERROR, "Too many resource contexts in this session.");
+	}
+
+	/* Register connection. */
+	ret = registerConnectionInRMByOID(resourceId,
+									  userOid,
+									  errorbuf,
+									  sizeof(errorbuf));
+	if (ret != FUNC_RETURN_OK)
+	{
+		releaseResourceContext(resourceId);
+		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR), errmsg("%s",errorbuf)));
+	}
+
+	return resourceId;
+}
+
+/*
+ * Take the resource context kept registered for the user, or -1 if there is
+ * none kept for the user in hawq_rm_reuse_registration_timeout. A resource
+ * context kept for another user or for longer is unregistered.
+ */
+static int
+TakeKeptResourceContext(Oid userOid)
+{
+	int resourceId = KeptResourceId;
+
+	if (resourceId < 0)
+	{
+		return -1;
+	}
+	KeptResourceId = -1;
+
+	if (KeptResourceUser == userOid &&
+		!TimestampDifferenceExceeds(KeptResourceTime, GetCurrentTimestamp(),
+									rm_reuse_registration_timeout * 1000))
+	{
+		elog(DEBUG3, "Reuse resource context %d kept registered", resourceId);
+		return resourceId;
+	}
+
+	ReleaseResourceContextInRM(resourceId);
+	return -1;
+}
+
+/*
+ * Unregister the resource context, which holds no resource, and release it.
+ * Resource manager times out a connection that fails to unregister.
+ */
+static void
+ReleaseResourceContextInRM(int resourceId)
+{
+	char errorbuf[1024];
+
+	if (unregisterConnectionInRM(resourceId,
+								 errorbuf,
+								 sizeof(errorbuf)) != FUNC_RETURN_OK)
+	{
+		elog(LOG, "%s", errorbuf);
+	}
+	releaseResourceContext(resourceId);
+}
+
+/*
+ * Take the resource leased for the user, or -1 if there is none leased for the
+ * user in hawq_rm_resource_lease_timeout, or the leased resource has too few
+ * slices or a virtual segment number out of the range the query asks for. A
+ * leased resource not taken is returned to resource manager.
+ */
+static int
+TakeLeasedResource(Oid userOid, int sliceSize,
+				   int maxTargetSegNum, int minTargetSegNum)
+{
+	int resourceId = LeasedResourceId;
+	QDResourceContext rescontext = NULL;
+
+	if (resourceId < 0)
+	{
+		return -1;
+	}
+	LeasedResourceId = -1;
+
+	getAllocatedResourceContext(resourceId, &rescontext);
+	if (rescontext != NULL &&
+		LeasedResourceUser == userOid &&
+		LeasedResourceSliceSize >= sliceSize &&
+		(maxTargetSegNum <= 0 ||
+		 (rescontext->QD_SegCount >= minTargetSegNum &&
+		  rescontext->QD_SegCount <= maxTargetSegNum)) &&
+		!TimestampDifferenceExceeds(LeasedResourceTime, GetCurrentTimestamp(),
+									rm_resource_lease_timeout * 1000))
+	{
+		elog(DEBUG3, "Reuse resource leased in resource context %d", resourceId);
+		return resourceId;
+	}
+
+	ReturnResourceContext(resourceId, LeasedResourceUser);
+	return -1;
+}
+
+/*
+ * Return the resource of the resource context to resource manager, then keep
+ * the connection registered for the next query of the user, or unregister it.
+ */
 static void
-AddToGlobalQueryResources(int resourceId, QueryResourceLife life)
+ReturnResourceContext(int resourceId, Oid userOid)
+{
+	int		ret;
+	char	errorbuf[1024];
+
+	ret = returnResource(resourceId,
+						 errorbuf,
+						 sizeof(errorbuf));
+	if (ret != FUNC_RETURN_OK)
+	{
+		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR), errmsg("%s",errorbuf)));
+	}
+
+	/*
+	 * Keep the connection registered for the next query, in place of the one
+	 * kept for the last query.
+	 */
+	if (rm_reuse_registration_timeout > 0 && OidIsValid(userOid))
+	{
+		if (KeptResourceId >= 0)
+		{
+			ReleaseResourceContextInRM(KeptResourceId);
+		}
+		KeptResourceId = resourceId;
+		KeptResourceUser = userOid;
+		KeptResourceTime = GetCurrentTimestamp();
+	}
+	else
+	{
+		ret = unregisterConnectionInRM(resourceId,
+									   errorbuf,
+									   sizeof(errorbuf));
+		if ( ret != FUNC_RETURN_OK )
+		{
+			ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR), errmsg("%s",errorbuf)));
+		}
+
+		releaseResourceContext(resourceId);
+	}
+}
+
+/*
+ * Return the leased resource as the session exits, the communication with
+ * resource manager would otherwise return it with a warning.
+ */
+static void
+ReturnLeasedResourceOnExit(int code, Datum arg)
+{
+	char errorbuf[1024];
+
+	if (LeasedResourceId < 0)
+	{
+		return;
+	}
+
+	if (returnResource(LeasedResourceId,
+					   errorbuf,
+					   sizeof(errorbuf)) != FUNC_RETURN_OK)
+	{
+		elog(LOG, "%s", errorbuf);
+	}
+	LeasedResourceId = -1;
+}
+
+static void
+AddToGlobalQueryResources(int resourceId, QueryResourceLife life, Oid userOid,
+						  int sliceSize)
 {
   ListCell *lc;
   QueryResourceItem *newItem;
@@ -946,6 +1189,8 @@ AddToGlobalQueryResources(int resourceId, QueryResourceLife life)
        * found, no need to add.
        */
       qri->alive = true;
+      qri->user_oid = userOid;
+      qri->slice_size = sliceSize;
       return;
     }
   }
@@ -962,6 +1207,8 @@ AddToGlobalQueryResources(int resourceId, QueryResourceLife life)
    * the allocateSucceed can be set true by using SetResourcesAllocatedSucceed()
    */
   newItem->allocateSucceed = false;
+  newItem->user_oid = userOid;
+  newItem->slice_size = sliceSize;
   GlobalQueryResources = lappend(GlobalQueryResources, newItem);
   MemoryContextSwitchTo(old);
 }
@@ -1025,9 +1272,9 @@ void
 FreeResource(QueryResource *resource)
 {
 	ListCell	*lc;
-	int			ret;
-	char		errorbuf[1024];
 	bool __MAYBE_UNUSED found = false;
+	Oid			userOid = InvalidOid;
+	int			sliceSize = 0;
 
 	if (!resource)
 	{
@@ -1047,30 +1294,42 @@ FreeResource(QueryResource *resource)
 		{
 			Assert(qri->alive);
 			qri->alive = false;
+			userOid = qri->user_oid;
+			sliceSize = qri->slice_size;
 			found = true;
 		}
 	}
 
 	Assert(found);
 
-	ret = returnResource(resource->resource_id,
-						 errorbuf,
-						 sizeof(errorbuf));
-	if (ret != FUNC_RETURN_OK)
+	/*
+	 * Lease the resource of the query for the next one, in place of the one
+	 * leased by the last query.
+	 */
+	if (rm_resource_lease_timeout > 0 &&
+		resource->life == QRL_ONCE &&
+		OidIsValid(userOid))
 	{
-		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR), errmsg("%s",errorbuf)));
-	}
+		if (LeasedResourceId >= 0)
+		{
+			ReturnResourceContext(LeasedResourceId, LeasedResourceUser);
+		}
+		LeasedResourceId = resource->resource_id;
+		LeasedResourceUser = userOid;
+		LeasedResourceSliceSize = sliceSize;
+		LeasedResourceTime = GetCurrentTimestamp();
 
-	ret = unregisterConnectionInRM(resource->resource_id,
-								   errorbuf,
-								   sizeof(errorbuf));
-	if ( ret != FUNC_RETURN_OK )
+		if (!LeasedResourceExitRegistered)
+		{
+			on_proc_exit(ReturnLeasedResourceOnExit, 0);
+			LeasedResourceExitRegistered = true;
+		}
+	}
+	else
 	{
-		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR), errmsg("%s",errorbuf)));
+		ReturnResourceContext(resource->resource_id, userOid);
 	}
 
-	releaseResourceContext(resource->resource_id);
-
 	FreeSegment(resource->master);
 
 	foreach(lc, resource->segments)
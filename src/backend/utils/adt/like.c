@@ -26,11 +26,15 @@
 #define LIKE_TRUE						1
 #define LIKE_FALSE						0
 #define LIKE_ABORT						(-1)
+#define LIKE_NOT_LITERAL				(-2)
 
 
 static int	MatchText(char *t, int tlen, char *p, int plen);
 static int	MatchTextIC(char *t, int tlen, char *p, int plen);
 static int	MatchBytea(char *t, int tlen, char *p, int plen);
+static int	LiteralMatchText(char *t, int tlen, char *p, int plen);
+static int	TextLikeMatch(char *t, int tlen, char *p, int plen);
+static int	ByteaLikeMatch(char *t, int tlen, char *p, int plen);
 static text *do_like_escape(text *, text *);
 
 static int	MBMatchText(char *t, int tlen, char *p, int plen);
@@ -117,6 +121,121 @@ wchareq(char *p1, char *p2)
 #define BYTEA_NextChar(p, plen) ((p)++, (plen)--)
 #define BYTEA_CopyAdvChar(dst, src, srclen) (*(dst)++ = *(src)++, (srclen)--)
 
+/*
+ * match_literal - match a string without wildcards
+ *
+ * Returns true if t holds lit, at its start if anchor_start and at its end
+ * if anchor_end, comparing bytes.  The caller makes sure byte positions are
+ * character positions: t is bytea, or in a single byte encoding or UTF8.
+ */
+bool
+match_literal(const char *t, int tlen, const char *lit, int litlen,
+			  bool anchor_start, bool anchor_end)
+{
+	const char *last;
+
+	if (litlen > tlen)
+		return false;
+
+	if (anchor_start && anchor_end)
+		return tlen == litlen && memcmp(t, lit, litlen) == 0;
+	if (anchor_start)
+		return memcmp(t, lit, litlen) == 0;
+	if (anchor_end)
+		return memcmp(t + tlen - litlen, lit, litlen) == 0;
+	if (litlen == 0)
+		return true;
+
+	/* find the first byte with memchr(), then compare the rest */
+	last = t + tlen - litlen;
+	while (t <= last)
+	{
+		t = memchr(t, lit[0], last - t + 1);
+		if (t == NULL)
+			return false;
+		if (memcmp(t + 1, lit + 1, litlen - 1) == 0)
+			return true;
+		t++;
+	}
+	return false;
+}
+
+/*
+ * LiteralMatchText - LIKE for a pattern that is a string, with at most a
+ * leading and a trailing %, which is searched for without MatchText().
+ *
+ * Returns LIKE_TRUE or LIKE_FALSE, or LIKE_NOT_LITERAL for other patterns.
+ */
+static int
+LiteralMatchText(char *t, int tlen, char *p, int plen)
+{
+	bool		anchor_start = true;
+	bool		anchor_end = true;
+	int			i;
+
+	while (plen > 0 && *p == '%')
+	{
+		anchor_start = false;
+		p++;
+		plen--;
+	}
+	while (plen > 0 && p[plen - 1] == '%')
+	{
+		anchor_end = false;
+		plen--;
+	}
+
+	for (i = 0; i < plen; i++)
+	{
+		if (p[i] == '%' || p[i] == '_' || p[i] == '\\')
+			return LIKE_NOT_LITERAL;
+	}
+
+	return match_literal(t, tlen, p, plen, anchor_start, anchor_end) ?
+		LIKE_TRUE : LIKE_FALSE;
+}
+
+/*
+ * TextLikeMatch - LIKE for text in the database encoding
+ */
+static int
+TextLikeMatch(char *t, int tlen, char *p, int plen)
+{
+	int			result;
+
+	if (pg_database_encoding_max_length() == 1)
+	{
+		result = LiteralMatchText(t, tlen, p, plen);
+		if (result == LIKE_NOT_LITERAL)
+			result = MatchText(t, tlen, p, plen);
+	}
+	else
+	{
+		result = LIKE_NOT_LITERAL;
+		if (GetDatabaseEncoding() == PG_UTF8)
+			result = LiteralMatchText(t, tlen, p, plen);
+		if (result == LIKE_NOT_LITERAL)
+			result = MBMatchText(t, tlen, p, plen);
+	}
+
+	return result;
+}
+
+/*
+ * ByteaLikeMatch - LIKE for bytea
+ */
+static int
+ByteaLikeMatch(char *t, int tlen, char *p, int plen)
+{
+	int			result;
+
+	result = LiteralMatchText(t, tlen, p, plen);
+	if (result == LIKE_NOT_LITERAL)
+		result = MatchBytea(t, tlen, p, plen);
+
+	return result;
+}
+
 
 /*
  *	interface routines called by the function manager
@@ -138,10 +257,7 @@ namelike(PG_FUNCTION_ARGS)
 	p = VARDATA(pat);
 	plen = (VARSIZE(pat) - VARHDRSZ);
 
-	if (pg_database_encoding_max_length() == 1)
-		result = (MatchText(s, slen, p, plen) == LIKE_TRUE);
-	else
-		result = (MBMatchText(s, slen, p, plen) == LIKE_TRUE);
+	result = (TextLikeMatch(s, slen, p, plen) == LIKE_TRUE);
 
 	PG_RETURN_BOOL(result);
 }
@@ -162,10 +278,7 @@ namenlike(PG_FUNCTION_ARGS)
 	p = VARDATA(pat);
 	plen = (VARSIZE(pat) - VARHDRSZ);
 
-	if (pg_database_encoding_max_length() == 1)
-		result = (MatchText(s, slen, p, plen) != LIKE_TRUE);
-	else
-		result = (MBMatchText(s, slen, p, plen) != LIKE_TRUE);
+	result = (TextLikeMatch(s, slen, p, plen) != LIKE_TRUE);
 
 	PG_RETURN_BOOL(result);
 }
@@ -186,10 +299,7 @@ textlike(PG_FUNCTION_ARGS)
 	p = VARDATA(pat);
 	plen = (VARSIZE(pat) - VARHDRSZ);
 
-	if (pg_database_encoding_max_length() == 1)
-		result = (MatchText(s, slen, p, plen) == LIKE_TRUE);
-	else
-		result = (MBMatchText(s, slen, p, plen) == LIKE_TRUE);
+	result = (TextLikeMatch(s, slen, p, plen) == LIKE_TRUE);
 
 	PG_RETURN_BOOL(result);
 }
@@ -210,10 +320,7 @@ textnlike(PG_FUNCTION_ARGS)
 	p = VARDATA(pat);
 	plen = (VARSIZE(pat) - VARHDRSZ);
 
-	if (pg_database_encoding_max_length() == 1)
-		result = (MatchText(s, slen, p, plen) != LIKE_TRUE);
-	else
-		result = (MBMatchText(s, slen, p, plen) != LIKE_TRUE);
+	result = (TextLikeMatch(s, slen, p, plen) != LIKE_TRUE);
 
 	PG_RETURN_BOOL(result);
 }
@@ -234,7 +341,7 @@ bytealike(PG_FUNCTION_ARGS)
 	p = VARDATA(pat);
 	plen = (VARSIZE(pat) - VARHDRSZ);
 
-	result = (MatchBytea(s, slen, p, plen) == LIKE_TRUE);
+	result = (ByteaLikeMatch(s, slen, p, plen) == LIKE_TRUE);
 
 	PG_RETURN_BOOL(result);
 }
@@ -255,7 +362,7 @@ byteanlike(PG_FUNCTION_ARGS)
 	p = VARDATA(pat);
 	plen = (VARSIZE(pat) - VARHDRSZ);
 
-	result = (MatchBytea(s, slen, p, plen) != LIKE_TRUE);
+	result = (ByteaLikeMatch(s, slen, p, plen) != LIKE_TRUE);
 
 	PG_RETURN_BOOL(result);
 }
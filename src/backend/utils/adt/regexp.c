@@ -29,7 +29,9 @@
  */
 #include "postgres.h"
 
+#include "access/hash.h"
 #include "catalog/pg_type.h"
+#include "cdb/cdbvars.h"
 #include "funcapi.h"
 #include "regex/regex.h"
 #include "utils/builtins.h"
@@ -75,8 +77,8 @@ typedef struct regexp_matches_ctx
  * the array, dropping the entry at the end of the array if necessary to
  * make room.  (This might seem to be weighting the new entry too heavily,
  * but if we insert new entries further back, we'll be unable to adjust to
- * a sudden shift in the query mix where we are presented with MAX_CACHED_RES
- * never-before-seen items used circularly.  We ought to be able to handle
+ * a sudden shift in the query mix where we are presented with
+ * gp_regex_cache_size never-before-seen items used circularly.  We ought to be able to handle
  * that case, so we have to insert at the front.)
  *
  * Knuth mentions a variant strategy in which a used item is moved up just
@@ -86,25 +88,28 @@ typedef struct regexp_matches_ctx
  * A reusable pattern that isn't used at least as often as non-reusable
  * patterns are seen will "fail to keep up" and will drop off the end of the
  * cache.  With move-to-front, a reusable pattern is guaranteed to stay in
- * the cache as long as it's used at least once in every MAX_CACHED_RES uses.
+ * the cache as long as it's used at least once in every gp_regex_cache_size
+ * uses.
+ *
+ * The cache lives as long as the backend, so a QE reused by later queries
+ * keeps their patterns too.  Generated queries can use many distinct
+ * patterns, so it holds gp_regex_cache_size of them; each entry keeps the
+ * hash of its pattern, to scan a long list without comparing patterns.
  */
 
-/* this is the maximum number of cached regular expressions */
-#ifndef MAX_CACHED_RES
-#define MAX_CACHED_RES	32
-#endif
-
 /* this structure describes one cached regular expression */
 typedef struct cached_re_str
 {
 	char	   *cre_pat;		/* original RE (not null terminated!) */
 	int			cre_pat_len;	/* length of original RE, in bytes */
+	uint32		cre_pat_hash;	/* hash_any() of the original RE */
 	int			cre_flags;		/* compile flags: extended,icase etc */
 	regex_t		cre_re;			/* the compiled regular expression */
 } cached_re_str;
 
 static int	num_res = 0;		/* # of cached re's */
-static cached_re_str re_array[MAX_CACHED_RES];	/* cached re's */
+static int	max_res = 0;		/* allocated length of re_array */
+static cached_re_str *re_array = NULL;	/* cached re's */
 
 
 /* Local functions */
@@ -134,6 +139,7 @@ RE_compile_and_cache(text *text_re, int cflags)
 {
 	int			text_re_len = VARSIZE_ANY_EXHDR(text_re);
 	char	   *text_re_val = VARDATA_ANY(text_re);
+	uint32		text_re_hash;
 	pg_wchar   *pattern;
 	int			pattern_len;
 	int			i;
@@ -141,6 +147,9 @@ RE_compile_and_cache(text *text_re, int cflags)
 	cached_re_str re_temp;
 	char		errMsg[100];
 
+	text_re_hash = DatumGetUInt32(hash_any((unsigned char *) text_re_val,
+										   text_re_len));
+
 	/*
 	 * Look for a match among previously compiled REs.	Since the data
 	 * structure is self-organizing with most-used entries at the front, our
@@ -148,7 +157,8 @@ RE_compile_and_cache(text *text_re, int cflags)
 	 */
 	for (i = 0; i < num_res; i++)
 	{
-		if (re_array[i].cre_pat_len == text_re_len &&
+		if (re_array[i].cre_pat_hash == text_re_hash &&
+			re_array[i].cre_pat_len == text_re_len &&
 			re_array[i].cre_flags == cflags &&
 			memcmp(re_array[i].cre_pat, text_re_val, text_re_len) == 0)
 		{
@@ -211,16 +221,35 @@ RE_compile_and_cache(text *text_re, int cflags)
 	}
 	memcpy(re_temp.cre_pat, text_re_val, text_re_len);
 	re_temp.cre_pat_len = text_re_len;
+	re_temp.cre_pat_hash = text_re_hash;
 	re_temp.cre_flags = cflags;
 
+	/* The storage array grows with gp_regex_cache_size */
+	if (max_res < gp_regex_cache_size)
+	{
+		cached_re_str *new_array;
+
+		new_array = realloc(re_array, gp_regex_cache_size * sizeof(cached_re_str));
+		if (new_array == NULL)
+		{
+			pg_regfree(&re_temp.cre_re);
+			free(re_temp.cre_pat);
+			ereport(ERROR,
+					(errcode(ERRCODE_OUT_OF_MEMORY),
+					 errmsg("out of memory")));
+		}
+		re_array = new_array;
+		max_res = gp_regex_cache_size;
+	}
+
 	/*
 	 * Okay, we have a valid new item in re_temp; insert it into the storage
-	 * array.  Discard last entry if needed.
+	 * array.  Discard the last entries if needed, more than one when
+	 * gp_regex_cache_size has been lowered.
 	 */
-	if (num_res >= MAX_CACHED_RES)
+	while (num_res >= Max(gp_regex_cache_size, 1))
 	{
 		--num_res;
-		Assert(num_res < MAX_CACHED_RES);
 		pg_regfree(&re_array[num_res].cre_re);
 		free(re_array[num_res].cre_pat);
 	}
@@ -310,6 +339,59 @@ RE_execute(regex_t *re, char *dat, int dat_len,
 	return match;
 }
 
+/*
+ * RE_literal_match - match a RE that is a literal string
+ *
+ * Returns TRUE if the RE is a string of ordinary characters, optionally
+ * anchored with ^ and $, and sets *match to whether dat matches it.  Such
+ * REs need neither compiling nor the conversion of the data to pg_wchar.
+ * Only done with the default compile options, and when byte positions in
+ * the data are character positions.
+ */
+static bool
+RE_literal_match(text *text_re, char *dat, int dat_len, int cflags,
+				 bool *match)
+{
+	char	   *lit = VARDATA_ANY(text_re);
+	int			litlen = VARSIZE_ANY_EXHDR(text_re);
+	bool		anchor_start = false;
+	bool		anchor_end = false;
+	int			i;
+
+	if (cflags != regex_flavor ||
+		(pg_database_encoding_max_length() != 1 &&
+		 GetDatabaseEncoding() != PG_UTF8))
+		return false;
+
+	if (litlen > 0 && lit[0] == '^')
+	{
+		anchor_start = true;
+		lit++;
+		litlen--;
+	}
+	if (litlen > 0 && lit[litlen - 1] == '$')
+	{
+		anchor_end = true;
+		litlen--;
+	}
+
+	/* characters that are not special in any flavor, and outside brackets */
+	for (i = 0; i < litlen; i++)
+	{
+		unsigned char c = (unsigned char) lit[i];
+
+		if (IS_HIGHBIT_SET(c) ||
+			(c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+			(c >= '0' && c <= '9'))
+			continue;
+		if (c == '\0' || strchr(" !\"#%&',-/:;<=>@_`~", c) == NULL)
+			return false;
+	}
+
+	*match = match_literal(dat, dat_len, lit, litlen, anchor_start, anchor_end);
+	return true;
+}
+
 /*
  * RE_compile_and_execute - compile and execute a RE
  *
@@ -329,6 +411,11 @@ RE_compile_and_execute(text *text_re, char *dat, int dat_len,
 					   int cflags, int nmatch, regmatch_t *pmatch)
 {
 	regex_t    *re;
+	bool		match;
+
+	/* A plain string is just searched for */
+	if (nmatch == 0 && RE_literal_match(text_re, dat, dat_len, cflags, &match))
+		return match;
 
 	/* Compile RE */
 	re = RE_compile_and_cache(text_re, cflags);
@@ -2820,6 +2820,59 @@ estimate_hash_bucketsize(PlannerInfo *root, Node *hashkey, double nbuckets)
 	return (Selectivity) estfract;
 }
 
+/*
+ * query_dependency_degree
+ *
+ * The strongest functional dependency, as collected by ANALYZE, between two
+ * columns of a base relation that are both referenced by the WHERE clause of
+ * the query; 0 if there is none.  The new optimizer only knows of correlated
+ * predicates through the damping of the selectivities of their conjuncts,
+ * which is derived from this.
+ */
+float4
+query_dependency_degree(Query *query)
+{
+	List	   *vars;
+	ListCell   *lc1;
+	ListCell   *lc2;
+	float4		result = 0;
+
+	if (query->jointree == NULL || query->jointree->quals == NULL)
+		return 0;
+
+	vars = pull_var_clause(query->jointree->quals, false);
+
+	foreach(lc1, vars)
+	{
+		Var		   *var1 = (Var *) lfirst(lc1);
+		RangeTblEntry *rte;
+
+		if (var1->varattno <= 0)
+			continue;
+
+		rte = rt_fetch(var1->varno, query->rtable);
+		if (rte->rtekind != RTE_RELATION)
+			continue;
+
+		for_each_cell(lc2, lnext(lc1))
+		{
+			Var		   *var2 = (Var *) lfirst(lc2);
+
+			if (var2->varno != var1->varno ||
+				var2->varattno <= 0 ||
+				var2->varattno == var1->varattno)
+				continue;
+
+			result = Max(result, get_attdependency(rte->relid, var1->varattno, var2->varattno));
+			result = Max(result, get_attdependency(rte->relid, var2->varattno, var1->varattno));
+		}
+	}
+
+	list_free(vars);
+
+	return result;
+}
+
 
 /*-------------------------------------------------------------------------
  *
@@ -14,18 +14,24 @@
  */
 #include "postgres.h"
 
+#include <unistd.h>
+
 #include "access/genam.h"
 #include "access/hash.h"
 #include "access/heapam.h"
 #include "access/relscan.h"
 #include "access/sysattr.h"
+#include "access/transam.h"
 #include "access/valid.h"
+#include "access/xact.h"
 #include "catalog/pg_operator.h"
 #include "catalog/pg_type.h"
 #include "miscadmin.h"
 #ifdef CATCACHE_STATS
 #include "storage/ipc.h"		/* for on_proc_exit */
 #endif
+#include "storage/fd.h"
+#include "storage/lwlock.h"
 #include "utils/builtins.h"
 #include "utils/fmgroids.h"
 #include "utils/inval.h"
@@ -69,6 +75,12 @@
 /* Cache management header --- pointer is NULL until created */
 static CatCacheHeader *CCacheHdr = NULL;
 
+/*
+ * This counter counts catcache inval events received since backend startup,
+ * to tell whether the catcache init file we write could be obsolete.
+ */
+static long catcacheInvalsReceived = 0L;
+
 
 static uint32 CatalogCacheComputeHashValue(CatCache *cache, int nkeys,
 							 ScanKey cur_skey);
@@ -452,6 +464,8 @@ CatalogCacheIdInvalidate(int cacheId,
 	Assert(ItemPointerIsValid(pointer));
 	CACHE1_elog(DEBUG2, "CatalogCacheIdInvalidate: called");
 
+	catcacheInvalsReceived++;
+
 	/*
 	 * inspect caches to find the proper cache
 	 */
@@ -668,6 +682,8 @@ ResetCatalogCaches(void)
 
 	CACHE1_elog(DEBUG2, "ResetCatalogCaches called");
 
+	catcacheInvalsReceived++;
+
 	for (cache = CCacheHdr->ch_caches; cache; cache = cache->cc_next)
 		ResetCatalogCache(cache);
 
@@ -1734,3 +1750,362 @@ PrintCatCacheListLeakWarning(CatCList *list, const char *resOwnerName)
 		 list->my_cache->cc_relname, list->my_cache->id,
 		 list, list->refcount, resOwnerName);
 }
+
+
+/*
+ *		Catalog cache init file
+ *
+ * The positive entries of a backend's catcaches on database-local catalogs
+ * are saved in CATCACHE_INIT_FILENAME in the database directory, so that
+ * the backends started later, e.g., the QEs forked for every new gang, can
+ * warm start with them instead of reading every catalog tuple they need from
+ * the catalogs again.  Loaded entries are ordinary catcache entries from then
+ * on: invalidation messages drop them like any other.
+ *
+ * The file is kept consistent the same way as the relcache init file: any
+ * transaction that commits catcache invalidations removes it, both before and
+ * after sending the SI messages, and a backend renames a newly written file
+ * into place only if it has seen no catcache invalidation since it collected
+ * the entries.  Caches on shared catalogs are left out, since transactions in
+ * other databases do not remove our file.
+ */
+
+#define CATCACHE_INIT_FILENAME	"pg_catcache.init"
+#define CATCACHE_INIT_FILEMAGIC	0x573269	/* version ID value */
+
+/* Don't bother writing the init file for fewer entries than this */
+#define CATCACHE_INIT_FILE_MIN_TUPLES	100
+
+/* Whether this backend loaded the init file or already tried to write one */
+static bool catcacheInitFileDone = false;
+
+static bool write_catcache_init_item(const void *data, Size len, FILE *fp);
+static bool read_catcache_init_item(void *data, Size len, FILE *fp);
+
+static bool
+write_catcache_init_item(const void *data, Size len, FILE *fp)
+{
+	return fwrite(data, 1, len, fp) == len;
+}
+
+static bool
+read_catcache_init_item(void *data, Size len, FILE *fp)
+{
+	return fread(data, 1, len, fp) == len;
+}
+
+/*
+ * LoadCatalogCacheInitFile
+ *		Enters the entries of the catcache init file of our database into the
+ *		catcaches, if there is such a file.
+ *
+ * Must be called in a transaction, after the backend has joined the SI
+ * message queue, so that it cannot miss the invalidation of anything it
+ * loads.  Nothing is entered if the file turns out to be broken.
+ */
+void
+LoadCatalogCacheInitFile(void)
+{
+	FILE	   *fp;
+	char		initfilename[MAXPGPATH];
+	int			magic;
+	CatCache  **caches;
+	HeapTuple  *tuples;
+	int			ntuples = 0;
+	int			maxtuples = 1024;
+	bool		failed = false;
+	MemoryContext oldcxt;
+
+	if (!gp_catcache_init_file)
+		return;
+
+	snprintf(initfilename, sizeof(initfilename), "%s/%s",
+			 DatabasePath, CATCACHE_INIT_FILENAME);
+
+	fp = AllocateFile(initfilename, PG_BINARY_R);
+	if (fp == NULL)
+		return;
+
+	/* Whether or not it works out, there's no point in writing a new file */
+	catcacheInitFileDone = true;
+
+	if (!read_catcache_init_item(&magic, sizeof(magic), fp) ||
+		magic != CATCACHE_INIT_FILEMAGIC)
+	{
+		FreeFile(fp);
+		return;
+	}
+
+	oldcxt = MemoryContextSwitchTo(CacheMemoryContext);
+
+	caches = (CatCache **) palloc(maxtuples * sizeof(CatCache *));
+	tuples = (HeapTuple *) palloc(maxtuples * sizeof(HeapTuple));
+
+	/*
+	 * Read all the entries before entering any of them, to guard against
+	 * truncated files.
+	 */
+	for (;;)
+	{
+		int			cacheId;
+		CatCache   *cache;
+		HeapTuple	tuple;
+		uint32		len;
+
+		if (!read_catcache_init_item(&cacheId, sizeof(cacheId), fp))
+		{
+			failed = true;
+			break;
+		}
+
+		/* The end marker */
+		if (cacheId < 0)
+			break;
+
+		for (cache = CCacheHdr->ch_caches; cache; cache = cache->cc_next)
+		{
+			if (cache->id == cacheId)
+				break;
+		}
+
+		if (cache == NULL || cache->cc_relisshared ||
+			!read_catcache_init_item(&len, sizeof(len), fp) ||
+			!AllocSizeIsValid(HEAPTUPLESIZE + len))
+		{
+			failed = true;
+			break;
+		}
+
+		tuple = (HeapTuple) palloc(HEAPTUPLESIZE + len);
+		tuple->t_len = len;
+		tuple->t_data = (HeapTupleHeader) ((char *) tuple + HEAPTUPLESIZE);
+
+		if (!read_catcache_init_item(&tuple->t_self, sizeof(tuple->t_self), fp) ||
+			!read_catcache_init_item(tuple->t_data, len, fp))
+		{
+			pfree(tuple);
+			failed = true;
+			break;
+		}
+
+		if (ntuples >= maxtuples)
+		{
+			maxtuples *= 2;
+			caches = (CatCache **) repalloc(caches, maxtuples * sizeof(CatCache *));
+			tuples = (HeapTuple *) repalloc(tuples, maxtuples * sizeof(HeapTuple));
+		}
+
+		caches[ntuples] = cache;
+		tuples[ntuples] = tuple;
+		ntuples++;
+	}
+
+	FreeFile(fp);
+	MemoryContextSwitchTo(oldcxt);
+
+	if (failed)
+	{
+		elog(LOG, "ignoring broken catalog cache init file \"%s\"", initfilename);
+		unlink(initfilename);
+	}
+
+	for (int i = 0; i < ntuples; i++)
+	{
+		CatCache   *cache = caches[i];
+
+		if (!failed)
+		{
+			uint32		hashValue;
+
+			if (cache->cc_tupdesc == NULL)
+				CatalogCacheInitializeCache(cache);
+
+			hashValue = CatalogCacheComputeTupleHashValue(cache, tuples[i]);
+			CatalogCacheCreateEntry(cache, tuples[i], hashValue,
+									HASH_INDEX(hashValue, cache->cc_nbuckets),
+									false);
+		}
+
+		pfree(tuples[i]);
+	}
+
+	pfree(caches);
+	pfree(tuples);
+}
+
+/*
+ * AtEOXact_CatCacheInitFile
+ *		Writes the catcache init file of our database from our catcaches, if
+ *		no backend did since the file was last removed.
+ *
+ * Called before committing a command.  Only this backend's first transaction
+ * with enough cached entries tries, and only if it did not change anything:
+ * otherwise the caches could hold our own changes, which are not committed
+ * yet.
+ */
+void
+AtEOXact_CatCacheInitFile(void)
+{
+	FILE	   *fp;
+	char		tempfilename[MAXPGPATH];
+	char		finalfilename[MAXPGPATH];
+	int			magic = CATCACHE_INIT_FILEMAGIC;
+	int			endMarker = -1;
+	long		savedInvalsReceived;
+	bool		failed = false;
+	CatCache   *cache;
+
+	if (!gp_catcache_init_file || catcacheInitFileDone ||
+		CCacheHdr == NULL || CCacheHdr->ch_ntup < CATCACHE_INIT_FILE_MIN_TUPLES ||
+		!IsTransactionState() ||
+		TransactionIdIsValid(GetCurrentTransactionIdIfAny()))
+		return;
+
+	catcacheInitFileDone = true;
+
+	snprintf(finalfilename, sizeof(finalfilename), "%s/%s",
+			 DatabasePath, CATCACHE_INIT_FILENAME);
+
+	/* Some other backend got here first */
+	if (access(finalfilename, F_OK) == 0)
+		return;
+
+	/*
+	 * Our entries are only as recent as the SI messages we have seen; note
+	 * how many invalidations we got so far, so that we can tell below if
+	 * anything we write might be obsolete already.
+	 */
+	AcceptInvalidationMessages();
+	savedInvalsReceived = catcacheInvalsReceived;
+
+	/*
+	 * We must write a temporary file and rename it into place. Otherwise,
+	 * another backend starting at about the same time might crash trying to
+	 * read the partially-complete file.
+	 */
+	snprintf(tempfilename, sizeof(tempfilename), "%s/%s.%d",
+			 DatabasePath, CATCACHE_INIT_FILENAME, MyProcPid);
+
+	unlink(tempfilename);		/* in case it exists w/wrong permissions */
+
+	fp = AllocateFile(tempfilename, PG_BINARY_W);
+	if (fp == NULL)
+	{
+		ereport(WARNING,
+				(errcode_for_file_access(),
+				 errmsg("could not create catalog cache init file \"%s\": %m",
+						tempfilename)));
+		return;
+	}
+
+	failed = !write_catcache_init_item(&magic, sizeof(magic), fp);
+
+	for (cache = CCacheHdr->ch_caches; cache && !failed; cache = cache->cc_next)
+	{
+		if (cache->cc_relisshared || cache->cc_ntup == 0)
+			continue;
+
+		for (int i = 0; i < cache->cc_nbuckets && !failed; i++)
+		{
+			Dlelem	   *elt;
+
+			for (elt = DLGetHead(&cache->cc_bucket[i]); elt; elt = DLGetSucc(elt))
+			{
+				CatCTup    *ct = (CatCTup *) DLE_VAL(elt);
+
+				if (ct->dead || ct->negative)
+					continue;
+
+				if (!write_catcache_init_item(&cache->id, sizeof(cache->id), fp) ||
+					!write_catcache_init_item(&ct->tuple.t_len, sizeof(ct->tuple.t_len), fp) ||
+					!write_catcache_init_item(&ct->tuple.t_self, sizeof(ct->tuple.t_self), fp) ||
+					!write_catcache_init_item(ct->tuple.t_data, ct->tuple.t_len, fp))
+				{
+					failed = true;
+					break;
+				}
+			}
+		}
+	}
+
+	if (!failed)
+		failed = !write_catcache_init_item(&endMarker, sizeof(endMarker), fp);
+
+	if (FreeFile(fp) || failed)
+	{
+		ereport(WARNING,
+				(errcode_for_file_access(),
+				 errmsg("could not write catalog cache init file \"%s\": %m",
+						tempfilename)));
+		unlink(tempfilename);
+		return;
+	}
+
+	/*
+	 * This mustn't run concurrently with CatalogCacheInitFileInvalidate, so
+	 * grab the same serialization lock as the relcache init file.
+	 */
+	LWLockAcquire(RelCacheInitLock, LW_EXCLUSIVE);
+
+	/* Make sure we have seen all incoming SI messages */
+	AcceptInvalidationMessages();
+
+	if (catcacheInvalsReceived == savedInvalsReceived)
+	{
+		if (rename(tempfilename, finalfilename) < 0)
+			unlink(tempfilename);
+	}
+	else
+	{
+		/* Delete the already-obsolete temp file */
+		unlink(tempfilename);
+	}
+
+	LWLockRelease(RelCacheInitLock);
+}
+
+/*
+ * CatalogCacheInitFileInvalidate
+ *		Removes the catcache init file during commit of a transaction that
+ *		sends catcache invalidations.
+ *
+ * Like RelationCacheInitFileInvalidate(), this is called both before and
+ * after sending the SI messages, for the same reasons.
+ */
+void
+CatalogCacheInitFileInvalidate(bool beforeSend)
+{
+	char		initfilename[MAXPGPATH];
+
+	snprintf(initfilename, sizeof(initfilename), "%s/%s",
+			 DatabasePath, CATCACHE_INIT_FILENAME);
+
+	if (beforeSend)
+	{
+		/* no interlock needed here */
+		unlink(initfilename);
+	}
+	else
+	{
+		/* Interlock against AtEOXact_CatCacheInitFile renaming a new file */
+		LWLockAcquire(RelCacheInitLock, LW_EXCLUSIVE);
+		unlink(initfilename);
+		LWLockRelease(RelCacheInitLock);
+	}
+}
+
+/*
+ * CatalogCacheInitFileRemove
+ *		Removes the catcache init file of a database during postmaster
+ *		startup, along with the relcache init file.
+ */
+void
+CatalogCacheInitFileRemove(const char *dbPath)
+{
+	char		initfilename[MAXPGPATH];
+
+	snprintf(initfilename, sizeof(initfilename), "%s/%s",
+			 dbPath, CATCACHE_INIT_FILENAME);
+	unlink(initfilename);
+	/* ignore any error, since it might not be there at all */
+}
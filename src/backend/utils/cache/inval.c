@@ -166,6 +166,9 @@ typedef struct TransInvalidationInfo
 	/* init file must be invalidated? */
 	bool		RelcacheInitFileInval;
 
+	/* catcache init file must be invalidated? */
+	bool		CatcacheInitFileInval;
+
 } TransInvalidationInfo;
 
 /*
@@ -192,8 +195,8 @@ static int	cache_callback_count = 0;
 
 /* info values for 2PC callback */
 #define TWOPHASE_INFO_MSG			0	/* SharedInvalidationMessage */
-#define TWOPHASE_INFO_FILE_BEFORE	1	/* relcache file inval */
-#define TWOPHASE_INFO_FILE_AFTER	2	/* relcache file inval */
+#define TWOPHASE_INFO_FILE_BEFORE	1	/* relcache/catcache file inval */
+#define TWOPHASE_INFO_FILE_AFTER	2	/* relcache/catcache file inval */
 
 static void PersistInvalidationMessage(SharedInvalidationMessage *msg);
 static void PrepareForRelcacheInvalidation(Oid relid, HeapTuple tuple);
@@ -468,6 +471,9 @@ RegisterCatcacheInvalidation(int cacheId,
 {
 	AddCatcacheInvalidationMessage(&transInvalInfo->CurrentCmdInvalidMsgs,
 								   cacheId, hashValue, tuplePtr, dbId, action);
+
+	/* Any catcache entry may be in the catcache init file */
+	transInvalInfo->CatcacheInitFileInval = true;
 }
 
 /*
@@ -899,7 +905,8 @@ AtPrepare_Inval(void)
 	 * Relcache init file invalidation requires processing both before and
 	 * after we send the SI messages.
 	 */
-	if (transInvalInfo->RelcacheInitFileInval)
+	if (transInvalInfo->RelcacheInitFileInval ||
+		transInvalInfo->CatcacheInitFileInval)
 		RegisterTwoPhaseRecord(TWOPHASE_RM_INVAL_ID, TWOPHASE_INFO_FILE_BEFORE,
 							   NULL, 0);
 
@@ -909,7 +916,8 @@ AtPrepare_Inval(void)
 	ProcessInvalidationMessages(&transInvalInfo->PriorCmdInvalidMsgs,
 								PersistInvalidationMessage);
 
-	if (transInvalInfo->RelcacheInitFileInval)
+	if (transInvalInfo->RelcacheInitFileInval ||
+		transInvalInfo->CatcacheInitFileInval)
 		RegisterTwoPhaseRecord(TWOPHASE_RM_INVAL_ID, TWOPHASE_INFO_FILE_AFTER,
 							   NULL, 0);
 }
@@ -982,9 +990,11 @@ inval_twophase_postcommit(TransactionId xid, uint16 info,
 			break;
 		case TWOPHASE_INFO_FILE_BEFORE:
 			RelationCacheInitFileInvalidate(true);
+			CatalogCacheInitFileInvalidate(true);
 			break;
 		case TWOPHASE_INFO_FILE_AFTER:
 			RelationCacheInitFileInvalidate(false);
+			CatalogCacheInitFileInvalidate(false);
 			break;
 		default:
 			Assert(false);
@@ -1032,6 +1042,8 @@ AtEOXact_Inval(bool isCommit)
 		 */
 		if (transInvalInfo->RelcacheInitFileInval)
 			RelationCacheInitFileInvalidate(true);
+		if (transInvalInfo->CatcacheInitFileInval)
+			CatalogCacheInitFileInvalidate(true);
 
 		AppendInvalidationMessages(&transInvalInfo->PriorCmdInvalidMsgs,
 								   &transInvalInfo->CurrentCmdInvalidMsgs);
@@ -1043,6 +1055,8 @@ AtEOXact_Inval(bool isCommit)
 		{
 			RelationCacheInitFileInvalidate(false);
 		}
+		if (transInvalInfo->CatcacheInitFileInval)
+			CatalogCacheInitFileInvalidate(false);
 
 	}
 	else if (transInvalInfo != NULL)
@@ -1097,6 +1111,8 @@ AtEOSubXact_Inval(bool isCommit)
 		/* Pending relcache inval becomes parent's problem too */
 		if (myInfo->RelcacheInitFileInval)
 			myInfo->parent->RelcacheInitFileInval = true;
+		if (myInfo->CatcacheInitFileInval)
+			myInfo->parent->CatcacheInitFileInval = true;
 
 		/* Pop the transaction state stack */
 		transInvalInfo = myInfo->parent;
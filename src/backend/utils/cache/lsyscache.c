@@ -2978,6 +2978,45 @@ get_attdistinct(Oid relid, AttrNumber attnum)
 	return result;
 }
 
+/*
+ * get_attdependency
+ *
+ *	  Given the table and attribute numbers of two columns, get the degree to
+ *	  which the values of the first one determine those of the second one.
+ *	  Return zero if no data available.
+ */
+float4
+get_attdependency(Oid relid, AttrNumber attnum, AttrNumber depattnum)
+{
+	HeapTuple	tp;
+	float4	   *numbers = NULL;
+	int			nnumbers = 0;
+	int			i;
+	float4		result = 0;
+
+	tp = get_att_stats(relid, attnum);
+	if (!HeapTupleIsValid(tp))
+		return 0;
+
+	if (get_attstatsslot(tp, InvalidOid, 0,
+						 STATISTIC_KIND_DEPENDENCY, InvalidOid,
+						 NULL, NULL, &numbers, &nnumbers))
+	{
+		for (i = 0; i + 1 < nnumbers; i += 2)
+		{
+			if ((AttrNumber) numbers[i] == depattnum)
+			{
+				result = numbers[i + 1];
+				break;
+			}
+		}
+		free_attstatsslot(InvalidOid, NULL, 0, numbers, nnumbers);
+	}
+
+	heap_freetuple(tp);
+	return result;
+}
+
 /*
  * get_attstatsslot
  *
@@ -34,8 +34,13 @@
 
 #include "utils/memutils.h"
 
+#include "access/xact.h"
 #include "cdb/cdbvars.h"
+#include "executor/instrument.h"
+#include "lib/stringinfo.h"
 #include "miscadmin.h"
+#include "utils/json.h"
+#include "utils/timestamp.h"
 
 /* Extern stuff */
 extern const char * show_session_authorization(void);
@@ -56,6 +61,13 @@ struct  {
 	struct sockaddr_in gxaddr;
 } gpmon = {0};
 
+/* Socket for the per-query JSON events, see gpmon_export_query_metrics() */
+static struct {
+	int		sock;
+	int		port;
+	struct sockaddr_in addr;
+} qmetrics = {-1, 0};
+
 int64 gpmon_tick = 0;
 
 void gpmon_sig_handler(int sig);
@@ -120,6 +132,80 @@ void gpmon_init(void)
 	gpmon.pid = pid;
 }
 
+/*
+ * gpmon_export_query_metrics
+ *    Send a one line JSON event describing the query that just finished to
+ *    the collector listening on gp_query_metrics_port.
+ *
+ * The event is a single non-blocking UDP datagram, so a missing or slow
+ * collector never holds up the query; such events are simply lost.  The
+ * wait times are the ones the dispatcher itself spent, the per-slice ones
+ * are only available from EXPLAIN ANALYZE.
+ */
+void
+gpmon_export_query_metrics(const char *status, uint64 processed)
+{
+	StringInfoData buf;
+	TimestampTz start = GetCurrentStatementStartTimestamp();
+	long		secs;
+	int			usecs;
+	const char *username;
+	char	   *dbname;
+
+	Assert(Gp_role == GP_ROLE_DISPATCH);
+
+	if (qmetrics.sock < 0 || qmetrics.port != gp_query_metrics_port)
+	{
+		if (qmetrics.sock < 0)
+		{
+			qmetrics.sock = socket(AF_INET, SOCK_DGRAM, 0);
+			if (qmetrics.sock < 0)
+			{
+				elog(WARNING, "gpmon: cannot create query metrics socket (%m)");
+				return;
+			}
+			if (fcntl(qmetrics.sock, F_SETFL, O_NONBLOCK) == -1 ||
+				fcntl(qmetrics.sock, F_SETFD, FD_CLOEXEC) == -1)
+				elog(WARNING, "gpmon: cannot set up query metrics socket (%m)");
+		}
+		memset(&qmetrics.addr, 0, sizeof(qmetrics.addr));
+		qmetrics.addr.sin_family = AF_INET;
+		qmetrics.addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+		qmetrics.addr.sin_port = htons(gp_query_metrics_port);
+		qmetrics.port = gp_query_metrics_port;
+	}
+
+	TimestampDifference(start, GetCurrentTimestamp(), &secs, &usecs);
+
+	username = show_session_authorization();
+	dbname = get_database_name(MyDatabaseId);
+
+	initStringInfo(&buf);
+	appendStringInfo(&buf, "{\"event\":\"query\",\"status\":\"%s\",\"session\":%d,\"command\":%d,\"user\":",
+					 status, gp_session_id, gp_command_count);
+	escape_json(&buf, username ? username : "");
+	appendStringInfoString(&buf, ",\"database\":");
+	escape_json(&buf, dbname ? dbname : "");
+	appendStringInfo(&buf, ",\"start\":");
+	escape_json(&buf, timestamptz_to_str(start));
+	appendStringInfo(&buf, ",\"duration_ms\":%.3f,\"rows\":" UINT64_FORMAT,
+					 secs * 1000.0 + usecs / 1000.0, processed);
+	appendStringInfo(&buf, ",\"hdfs_io_ms\":%.3f,\"local_io_ms\":%.3f"
+					 ",\"interconnect_ms\":%.3f,\"lock_ms\":%.3f}\n",
+					 pgWaitUsage.hdfs_io_time / 1000.0,
+					 pgWaitUsage.local_io_time / 1000.0,
+					 pgWaitUsage.interconnect_time / 1000.0,
+					 pgWaitUsage.lock_time / 1000.0);
+
+	/* Dropped datagrams are expected when no collector keeps up, don't warn */
+	(void) sendto(qmetrics.sock, buf.data, buf.len, 0,
+				  (struct sockaddr *) &qmetrics.addr, sizeof(qmetrics.addr));
+
+	pfree(buf.data);
+	if (dbname)
+		pfree(dbname);
+}
+
 /**
  * This method adds a key-value entry to the gpmon text file. The format it uses is:
  * <VALUE_LENGTH> <KEY>\n
@@ -17,20 +17,72 @@
  * under the License.
  */
 
+#include "postgres.h"
+
+#ifdef HAVE__GET_CPUID
+#include <cpuid.h>
+#endif
+
 #include "utils/bloomfilter.h"
 #include "utils/elog.h"
 #include "utils/palloc.h"
 #include "lib/stringinfo.h"
 #include <assert.h>
 
-const static uint32_t HASH_SEEDS[8] = { 0x14EBCDFFU,
+const uint32_t BloomFilterHashSeeds[NUM_BUCKET_WORDS] = { 0x14EBCDFFU,
         0x2A1C1A99U, 0x85CB78FBU, 0x6E8F82DDU, 0xF8464DFFU, 0x1028FEADU,
         0x74F04A4DU, 0x1832DB75U };
 
-static uint32_t getBucketIdx(uint32_t hash, uint32_t mask)
+#if defined(__x86_64__) && defined(HAVE__GET_CPUID)
+
+static bool
+bloomAVX2Available(void)
+{
+    static int  available = -1;
+    unsigned int exx[4] = {0, 0, 0, 0};
+    unsigned int xcr0_lo;
+    unsigned int xcr0_hi;
+
+    if (available >= 0)
+        return available;
+
+    available = 0;
+
+    __get_cpuid(1, &exx[0], &exx[1], &exx[2], &exx[3]);
+    if ((exx[2] & (1 << 27)) == 0)      /* OSXSAVE */
+        return false;
+
+    /* the OS must save the ymm registers on context switch */
+    __asm__ __volatile__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    if ((xcr0_lo & 0x6) != 0x6)
+        return false;
+
+    if (__get_cpuid_max(0, NULL) < 7)
+        return false;
+    __cpuid_count(7, 0, exx[0], exx[1], exx[2], exx[3]);
+
+    available = (exx[1] & (1 << 5)) != 0;   /* AVX2 */
+    return available;
+}
+
+#endif
+
+/*
+ * Check whether all the bits of a value are set in its bucket.
+ */
+static inline bool bucketContains(BloomFilter bf, uint32_t value)
 {
-    /* use Knuth's multiplicative hash */
-    return ((uint64_t) (hash) * 2654435769ul >> 32) & mask;
+    uint32_t bucket_idx = BloomFilterBucketIdx(value, bf->data_mask);
+    for (int i = 0; i < NUM_BUCKET_WORDS; ++i)
+    {
+        BucketWord hval = (BloomFilterHashSeeds[i] * value) >> (32 - LOG_BUCKET_WORD_BITS);
+        hval = 1U << hval;
+        if (!(bf->data[bucket_idx][i] & hval))
+        {
+            return false;
+        }
+    }
+    return true;
 }
 
 /*
@@ -72,14 +124,14 @@ BloomFilter InitBloomFilter(int memory_size)
  */
 void InsertBloomFilter(BloomFilter bf, uint32_t value)
 {
-    uint32_t bucket_idx = getBucketIdx(value, bf->data_mask);
+    uint32_t bucket_idx = BloomFilterBucketIdx(value, bf->data_mask);
     uint32_t new_bucket[8];
     for (int i = 0; i < NUM_BUCKET_WORDS; ++i) {
         /*
          * Multiply-shift hashing proposed by Dietzfelbinger et al.
          * hash a value universally into 5 bits using the random odd seed.
          */
-        new_bucket[i] = (HASH_SEEDS[i] * value) >> (32 - LOG_BUCKET_WORD_BITS);
+        new_bucket[i] = (BloomFilterHashSeeds[i] * value) >> (32 - LOG_BUCKET_WORD_BITS);
         new_bucket[i] = 1U << new_bucket[i];
         bf->data[bucket_idx][i] |= new_bucket[i];
     }
@@ -91,20 +143,57 @@ void InsertBloomFilter(BloomFilter bf, uint32_t value)
 bool FindBloomFilter(BloomFilter bf, uint32_t value)
 {
     bf->nTested++;
-    uint32_t bucket_idx = getBucketIdx(value, bf->data_mask);
-    for (int i = 0; i < NUM_BUCKET_WORDS; ++i)
+    if (!bucketContains(bf, value))
     {
-        BucketWord hval = (HASH_SEEDS[i] * value) >> (32 - LOG_BUCKET_WORD_BITS);
-        hval = 1U << hval;
-        if (!(bf->data[bucket_idx][i] & hval))
-        {
-            return false;
-        }
+        return false;
     }
     bf->nMatched++;
     return true;
 }
 
+/*
+ * Check whether a value is in this Bloom filter or not, like FindBloomFilter,
+ * but without counting it in the tested and matched numbers that decide
+ * whether the filter is worth applying.
+ */
+bool ProbeBloomFilter(BloomFilter bf, uint32_t value)
+{
+    return bucketContains(bf, value);
+}
+
+/*
+ * Check n values at once, setting found[i] to whether values[i] is in this
+ * Bloom filter, and return the number of values found.
+ *
+ * The buckets of the values BLOOM_PREFETCH_DISTANCE ahead are prefetched, so
+ * that the scattered loads of a large filter overlap instead of stalling one
+ * after the other. The AVX2 kernel tests the 8 words of a bucket at once.
+ */
+int FindBloomFilterBatch(BloomFilter bf, const uint32_t *values, int n, bool *found)
+{
+    int matched = 0;
+
+#if defined(__x86_64__) && defined(HAVE__GET_CPUID)
+    if (bloomAVX2Available())
+        matched = FindBloomFilterBatchAVX2(bf, values, n, found);
+    else
+#endif
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            if (i + BLOOM_PREFETCH_DISTANCE < n)
+                __builtin_prefetch(bf->data[BloomFilterBucketIdx(values[i + BLOOM_PREFETCH_DISTANCE],
+                                                                 bf->data_mask)]);
+            found[i] = bucketContains(bf, values[i]);
+            matched += found[i];
+        }
+    }
+
+    bf->nTested += n;
+    bf->nMatched += matched;
+    return matched;
+}
+
 void PrintBloomFilter(BloomFilter bf)
 {
     StringInfo bfinfo = makeStringInfo();
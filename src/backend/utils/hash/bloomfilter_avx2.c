@@ -0,0 +1,68 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * bloomfilter_avx2.c
+ *		AVX2 kernel of FindBloomFilterBatch.
+ *
+ * The 8 words of a bucket are tested at once: the 8 bits of a value are
+ * computed in the lanes of a register from the seeds of the words, and
+ * tested against the bucket loaded in another. This file must be compiled
+ * with -mavx2, and is only called when the cpu supports it.
+ */
+
+#include "postgres.h"
+#include "utils/bloomfilter.h"
+
+#if defined(__x86_64__)
+
+#include <immintrin.h>
+
+int
+FindBloomFilterBatchAVX2(BloomFilter bf, const uint32_t *values, int n, bool *found)
+{
+	__m256i		seeds = _mm256_loadu_si256((const __m256i *) BloomFilterHashSeeds);
+	__m256i		ones = _mm256_set1_epi32(1);
+	int			matched = 0;
+
+	for (int i = 0; i < n; i++)
+	{
+		uint32_t	bucket_idx = BloomFilterBucketIdx(values[i], bf->data_mask);
+		__m256i		bits;
+		__m256i		bucket;
+
+		if (i + BLOOM_PREFETCH_DISTANCE < n)
+			__builtin_prefetch(bf->data[BloomFilterBucketIdx(values[i + BLOOM_PREFETCH_DISTANCE],
+															 bf->data_mask)]);
+
+		bits = _mm256_mullo_epi32(seeds, _mm256_set1_epi32((int32_t) values[i]));
+		bits = _mm256_srli_epi32(bits, 32 - LOG_BUCKET_WORD_BITS);
+		bits = _mm256_sllv_epi32(ones, bits);
+
+		bucket = _mm256_loadu_si256((const __m256i *) bf->data[bucket_idx]);
+
+		/* all the bits are set if none is set in ~bucket & bits */
+		found[i] = _mm256_testc_si256(bucket, bits);
+		matched += found[i];
+	}
+
+	return matched;
+}
+
+#endif
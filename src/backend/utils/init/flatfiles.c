@@ -331,6 +331,7 @@ write_database_file(Relation drel, bool startup)
 			char *dbpath = GetDatabasePath(datoid, dattablespace);
 
 			RelationCacheInitFileRemove(dbpath);
+			CatalogCacheInitFileRemove(dbpath);
 			pfree(dbpath);
 		}
 	}
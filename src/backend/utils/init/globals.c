@@ -117,11 +117,22 @@ int			statement_mem = 256000;
  * do not enforce per-query memory limit
  */
 int			gp_vmem_limit_per_query = 0;
+/*
+ * gp_operator_mem_grow_limit set to 0 means an operator
+ * spills once it exceeds its memory quota
+ */
+int			gp_operator_mem_grow_limit = 0;
+/*
+ * Memory blocks of at least gp_huge_page_alloc_threshold kB are advised
+ * to be backed by transparent huge pages; 0 disables it
+ */
+int			gp_huge_page_alloc_threshold = 0;
 int			maintenance_work_mem = 65536;
 
 /* Primary determinants of sizes of shared-memory structures: */
 int			NBuffers = 4096;
 int			MaxBackends = 200;
+bool		gp_huge_pages = false;
 int			SegMaxBackends = 1280;
 
 int			gp_workfile_max_entries = 8192; /* Number of unique entries we can hold in the workfile directory */
@@ -627,6 +627,10 @@ InitPostgres(const char *in_dbname, Oid dboid, const char *username,
 	 */
 	RelationCacheInitializePhase2();
 
+	/* Warm up the catcaches with what earlier backends saved for us */
+	if (!bootstrap)
+		LoadCatalogCacheInitFile();
+
 	/*
 	 * Figure out our postgres user id, and see if we are a superuser.
 	 *
@@ -39,6 +39,7 @@
 #include "pg_config_manual.h"
 
 #ifdef GPFXDIST
+#include <signal.h>
 #include <gpfxdist.h>
 #endif
 
@@ -65,6 +66,10 @@ struct fstream_t
 	int 			buffer_cur_size; /* number of bytes in buffer currently */
 	const char*		ferror; 		 /* error string */
 	struct fstream_options options;
+#ifdef GPFXDIST
+	struct gpfxdist_spool_t* spool;	 /* transformations started ahead, by file index, or NULL */
+	char*			spooled;		 /* output file of the current transformation, if spooled */
+#endif
 };
 
 /*
@@ -199,6 +204,9 @@ fstream_get_error(fstream_t*fs)
  * server. That is because it may be inside a quote. We have to carefully parse
  * the data from the start in order to find the last unquoted newline.
  *
+ * This runs over every block gpfdist serves, so the spans which contain no
+ * quote character are skipped with memchr instead of byte by byte. So are the
+ * quoted spans, when the escape character is the quote character itself.
  */
 static char*
 scan_csv_records(char *p, char *q, int one, fstream_t *fs)
@@ -212,7 +220,53 @@ scan_csv_records(char *p, char *q, int one, fstream_t *fs)
 
 	while (p < q)
 	{
-		int ch = *p++;
+		int ch;
+
+		if (!in_quote && qc != '\n')
+		{
+			/* every newline before the next quote ends a record */
+			char *quote = memchr(p, qc, q - p);
+			char *end = quote ? quote : q;
+			char *nl;
+
+			while ((nl = memchr(p, '\n', end - p)) != NULL)
+			{
+				line_number++;
+				p = nl + 1;
+				last_record_loc = p;
+				fs->line_number = line_number;
+				if (one)
+					return last_record_loc;
+			}
+
+			if (!quote)
+				break;
+			p = quote + 1;
+			in_quote = 1;
+			continue;
+		}
+
+		if (in_quote && qc == xc && qc != '\n')
+		{
+			/* the quote can only be closed by the next quote character */
+			char *quote = memchr(p, qc, q - p);
+			char *end = quote ? quote : q;
+			char *nl;
+
+			while ((nl = memchr(p, '\n', end - p)) != NULL)
+			{
+				line_number++;
+				p = nl + 1;
+			}
+
+			if (!quote)
+				break;
+			p = quote + 1;
+			in_quote = 0;
+			continue;
+		}
+
+		ch = *p++;
 
 		if (ch == '\n')
 			line_number++;
@@ -244,6 +298,87 @@ scan_csv_records(char *p, char *q, int one, fstream_t *fs)
 }
 
 /* close the file stream */
+#ifdef GPFXDIST
+/*
+ * Start the transformation of file i ahead, if parallel transformations are
+ * in use and there is such a file.  If it can't be started it will simply be
+ * streamed when its turn comes.
+ */
+static void spool_start(fstream_t* fs, int i)
+{
+	int response_code;
+	const char	*response_string;
+
+	if (!fs->spool || i <= fs->fidx || i >= fs->glob.gl_pathc)
+		return;
+
+	if (gfile_spool(&fs->spool[i], fs->glob.gl_pathv[i], fs->options.transform,
+					&response_code, &response_string))
+	{
+		gfile_printf_then_putc_newline("fstream unable to start transformation ahead for file %s",
+									   fs->glob.gl_pathv[i]);
+	}
+}
+
+/*
+ * A transformation that does heavy work on each data file would load only
+ * one cpu when the files are transformed one after the other.  With PARALLEL
+ * set we start the transformations of the next files as soon as the first
+ * file is open, each writing to a temporary file, and read their output in
+ * file order when their turn comes.  More of them are started as files are
+ * finished, so that up to that many are running at once.
+ */
+static void spool_init(fstream_t* fs)
+{
+	struct gpfxdist_t* transform = fs->options.transform;
+	int i;
+
+	if (!transform || transform->pass_paths || fs->options.forwrite ||
+		transform->parallel <= 1 || fs->glob.gl_pathc <= 1)
+		return;
+
+	fs->spool = gfile_malloc(sizeof *fs->spool * fs->glob.gl_pathc);
+	if (!fs->spool)
+		return;
+
+	memset(fs->spool, 0, sizeof *fs->spool * fs->glob.gl_pathc);
+	for (i = fs->fidx + 1; i < fs->fidx + transform->parallel; i++)
+		spool_start(fs, i);
+}
+
+/*
+ * Stop the transformations still running ahead, and remove their output.
+ */
+static void spool_cleanup(fstream_t* fs)
+{
+	apr_pool_t* mp = fs->options.transform->mp;
+	int i;
+
+	if (fs->spooled)
+	{
+		apr_file_remove(fs->spooled, mp);
+		fs->spooled = NULL;
+	}
+
+	if (!fs->spool)
+		return;
+
+	for (i = fs->fidx + 1; i < fs->glob.gl_pathc; i++)
+	{
+		if (fs->spool[i].outfilename)
+		{
+			apr_proc_kill(&fs->spool[i].proc, SIGTERM);
+			gfile_spool_wait(&fs->spool[i]);
+			apr_file_remove(fs->spool[i].outfilename, mp);
+			fs->spool[i].outfilename = NULL;
+		}
+	}
+
+	gfile_free(fs->spool);
+	fs->spool = NULL;
+}
+#endif
+
 void fstream_close(fstream_t* fs)
 {
 #ifdef GPFXDIST
@@ -255,6 +390,9 @@ void fstream_close(fstream_t* fs)
 		apr_file_remove(fs->options.transform->tempfilename, fs->options.transform->mp);
 		fs->options.transform->tempfilename = NULL;
 	}
+
+	if (fs->options.transform)
+		spool_cleanup(fs);
 #endif
 
 	if(fs->buffer)
@@ -573,6 +711,10 @@ fstream_open(const char *path, const struct fstream_options *options,
 		fs->compressed_size += gfile_get_compressed_size(&fs->fd);
 	}
 
+#ifdef GPFXDIST
+	spool_init(fs);
+#endif
+
 	fs->line_number = 1;
 	fs->skip_header_line = options->header;
 
@@ -608,6 +750,7 @@ static int nextFile(fstream_t*fs)
 	int response_code;
 	const char	*response_string;
 	struct gpfxdist_t* transform = fs->options.transform;
+	const char* fpath;
 
 	fs->compressed_position += gfile_get_compressed_size(&fs->fd);
 	gfile_close(&fs->fd);
@@ -615,11 +758,40 @@ static int nextFile(fstream_t*fs)
 	fs->line_number = 1;
 	fs->fidx++;
 
+#ifdef GPFXDIST
+	if (fs->spooled)
+	{
+		apr_file_remove(fs->spooled, transform->mp);
+		fs->spooled = NULL;
+	}
+#endif
+
 	if (fs->fidx < fs->glob.gl_pathc)
 	{
 		fs->skip_header_line = fs->options.header;
+		fpath = fs->glob.gl_pathv[fs->fidx];
 
-		if (gfile_open(&fs->fd, fs->glob.gl_pathv[fs->fidx], GFILE_OPEN_FOR_READ, 
+#ifdef GPFXDIST
+		/*
+		 * keep the same number of transformations running ahead, and read the
+		 * output of this file's one if it was started ahead.
+		 */
+		if (fs->spool)
+		{
+			spool_start(fs, fs->fidx + transform->parallel - 1);
+
+			if (fs->spool[fs->fidx].outfilename)
+			{
+				gfile_spool_wait(&fs->spool[fs->fidx]);
+				fs->spooled = fs->spool[fs->fidx].outfilename;
+				fs->spool[fs->fidx].outfilename = NULL;
+				fpath = fs->spooled;
+				transform = NULL;
+			}
+		}
+#endif
+
+		if (gfile_open(&fs->fd, fpath, GFILE_OPEN_FOR_READ, 
 					   &response_code, &response_string, transform))
 		{
 			gfile_printf_then_putc_newline("fstream unable to open file %s",
@@ -1026,6 +1198,11 @@ int fstream_rewind(fstream_t *fs)
 	const char*	response_string;
 	struct gpfxdist_t* transform = fs->options.transform;
 
+#ifdef GPFXDIST
+	if (transform)
+		spool_cleanup(fs);
+#endif
+
 	fs->fidx = 0;
 	fs->foff = 0;
 	fs->line_number = 1;
@@ -1044,5 +1221,10 @@ int fstream_rewind(fstream_t *fs)
 		fs->ferror = "unable to open file";
 		return -1;
 	}
+
+#ifdef GPFXDIST
+	spool_init(fs);
+#endif
+
 	return 0;
 }
@@ -533,11 +533,16 @@ subprocess_open_failed(int* response_code, const char** response_string, char* r
 	return 1;
 }
 
+/*
+ * Start the transformation of fpath as process proc.  Its standard output
+ * goes to outfile if not NULL, else to a pipe for reading.
+ */
 static int 
-subprocess_open(gfile_t* fd, const char* fpath, int for_write, int* rcode, const char** rstring)
+subprocess_start(struct gpfxdist_t* transform, apr_proc_t* proc, const char* fpath,
+				 int for_write, apr_file_t* outfile, int* rcode, const char** rstring)
 {
-	apr_pool_t*     mp     = fd->transform->mp;
-	char*           cmd    = fd->transform->cmd;
+	apr_pool_t*     mp     = transform->mp;
+	char*           cmd    = transform->cmd;
 	apr_procattr_t* pattr;
 	char**          tokens;
 	apr_status_t    rv;
@@ -574,8 +579,16 @@ subprocess_open(gfile_t* fd, const char* fpath, int for_write, int* rcode, const
 		{
 			return subprocess_open_failed(rcode, rstring, "subprocess_open: apr_procattr_io_set (full,no,no) failed");
 		}
-		fd->transform->for_write = 1;
 	} 
+	else if (outfile)
+	{
+		/* readable external table, child writing its output ahead to a file */
+
+		if ((rv = apr_procattr_child_out_set(pattr, outfile, NULL)) != APR_SUCCESS) 
+		{
+			return subprocess_open_failed(rcode, rstring, "subprocess_open: apr_procattr_child_out_set failed");
+		}
+	}
 	else 
 	{
 		/* readable external table, so child will be writing to standard output */
@@ -584,15 +597,14 @@ subprocess_open(gfile_t* fd, const char* fpath, int for_write, int* rcode, const
 		{
 			return subprocess_open_failed(rcode, rstring, "subprocess_open: apr_procattr_io_set (no,full,no) failed");
 		}
-		fd->transform->for_write = 0;
 	}
 
 	/* setup child stderr */
-	if (fd->transform->errfile)
+	if (transform->errfile)
 	{
 		/* redirect stderr to a file to be sent to server when we're finished */
 
-		errfile = fd->transform->errfile;
+		errfile = transform->errfile;
 
 		if ((rv = apr_procattr_child_err_set(pattr, errfile, NULL)) !=  APR_SUCCESS)
 		{
@@ -613,7 +625,7 @@ subprocess_open(gfile_t* fd, const char* fpath, int for_write, int* rcode, const
 	}
 
 	/* finally... start the child process */
-	if ((rv = apr_proc_create(&fd->transform->proc, tokens[0], (const char* const*)tokens, NULL, pattr, mp)) != APR_SUCCESS) 
+	if ((rv = apr_proc_create(proc, tokens[0], (const char* const*)tokens, NULL, pattr, mp)) != APR_SUCCESS) 
 	{
 		return subprocess_open_failed(rcode, rstring, "subprocess_open: apr_proc_create failed");
 	}
@@ -621,6 +633,81 @@ subprocess_open(gfile_t* fd, const char* fpath, int for_write, int* rcode, const
 	return 0;
 }
 
+static int 
+subprocess_open(gfile_t* fd, const char* fpath, int for_write, int* rcode, const char** rstring)
+{
+	fd->transform->for_write = for_write ? 1 : 0;
+
+	return subprocess_start(fd->transform, &fd->transform->proc, fpath, for_write, NULL, rcode, rstring);
+}
+
+/*
+ * Start the transformation of fpath ahead of its turn, with its output going
+ * to a new temporary file, whose name is left in spool->outfilename.
+ */
+int
+gfile_spool(struct gpfxdist_spool_t* spool, const char* fpath, struct gpfxdist_t* transform,
+			int* rcode, const char** rstring)
+{
+	apr_pool_t*  mp = transform->mp;
+	apr_file_t*  f = NULL;
+	const char*  tempdir = NULL;
+	char*        tempfilename = NULL;
+	apr_status_t rv;
+	int          failed;
+
+	spool->outfilename = NULL;
+
+	if ((rv = apr_temp_dir_get(&tempdir, mp)) != APR_SUCCESS)
+	{
+		return subprocess_open_failed(rcode, rstring, "gfile_spool: apr_temp_dir_get failed");
+	}
+
+	tempfilename = apr_pstrcat(mp, tempdir, "/transformXXXXXX", NULL);
+	if ((rv = apr_file_mktemp(&f, tempfilename, APR_CREATE|APR_WRITE|APR_EXCL, mp)) != APR_SUCCESS)
+	{
+		return subprocess_open_failed(rcode, rstring, "gfile_spool: apr_file_mktemp failed");
+	}
+
+	failed = subprocess_start(transform, &spool->proc, fpath, 0, f, rcode, rstring);
+
+	/* the child has its own copy of the file now */
+	apr_file_close(f);
+
+	if (failed)
+	{
+		apr_file_remove(tempfilename, mp);
+		return 1;
+	}
+
+	spool->outfilename = tempfilename;
+	return 0;
+}
+
+/*
+ * Wait for a transformation started by gfile_spool to finish, and return its
+ * exit status like close_subprocess does.
+ */
+int
+gfile_spool_wait(struct gpfxdist_spool_t* spool)
+{
+	int             st;
+	apr_exit_why_e  why;
+	apr_status_t    rv;
+
+	rv = apr_proc_wait(&spool->proc, &st, &why, APR_WAIT);
+	if (APR_STATUS_IS_CHILD_DONE(rv)) 
+	{
+		gfile_printf_then_putc_newline("gfile_spool_wait: done: why = %d, exit status = %d", why, st);
+		return st;
+	} 
+	else 
+	{
+		gfile_printf_then_putc_newline("gfile_spool_wait: notdone");
+		return 1;
+	}
+}
+
 
 static ssize_t 
 read_subprocess(gfile_t *fd, void *ptr, size_t len)
@@ -63,6 +63,7 @@
 #include "cdb/executormgr_new.h"
 #include "cdb/tupchunk.h"
 #include "commands/async.h"
+#include "commands/prepare.h"
 #include "commands/vacuum.h"
 #include "commands/variable.h"
 #include "executor/executor.h"          /* TupOutputState, TupleDesc */
@@ -334,6 +335,7 @@ int			Test_safefswritesize_override = 0;
 bool        Master_mirroring_administrator_disable = false;
 bool		gp_appendonly_verify_block_checksums = false;
 bool 		gp_appendonly_verify_write_block = false;
+int			gp_appendonly_read_ahead_buffers = 0;
 bool		gp_heap_require_relhasoids_match = true;
 bool 		gp_local_distributed_cache_stats = false;
 bool		Debug_xlog_insert_print = false;
@@ -364,6 +366,8 @@ char* 		memory_profiler_dataset_id = "none";
 char* 		memory_profiler_query_id = "none";
 int 		memory_profiler_dataset_size = 0;
 bool 		gp_dump_memory_usage = FALSE;
+int			gp_memory_account_publish_interval = 0;
+int			gp_memory_alloc_sample_interval = 0;
 
 #define VERIFY_CHECKPOINT_INTERVAL_DEFAULT 180
 int         verify_checkpoint_interval =
@@ -621,6 +625,8 @@ show_allow_system_table_mods(void);
 bool   pxf_enable_filter_pushdown = true;
 bool   pxf_enable_stat_collection = true;
 int    pxf_stat_max_fragments = 100;
+int    pxf_prefetch_fragments = 0;
+int    pxf_fragments_cache_ttl = 0;
 bool   pxf_enable_locality_optimizations = true;
 bool   pxf_isilon = false; /* temporary GUC */
 int    pxf_service_port = 51200; /* temporary GUC */
@@ -648,6 +654,9 @@ bool hawq_init_with_magma = false;
 // enable cache read for magma
 bool magma_cache_read = true;
 
+// enable cache read for append only and parquet tables
+bool ao_cache_read = false;
+
 // enable magma share memory
 char *magma_enable_shm = "ON";
 int magma_shm_limit_per_block;
@@ -684,14 +693,25 @@ bool		enable_nestloop = false;
 bool		enable_mergejoin = false;
 bool		enable_hashjoin = true;
 bool        gp_enable_hashjoin_size_heuristic = false;
+bool		gp_enable_partitionwise_join = true;
 bool		gp_enable_fallback_plan = true;
 bool        gp_enable_predicate_propagation = false;
 bool		constraint_exclusion = false;
 bool		gp_enable_multiphase_agg = true;
 bool		gp_enable_preunique = TRUE;
+bool		gp_enable_segfile_count = true;
 bool		gp_eager_preunique = FALSE;
 bool		gp_enable_sequential_window_plans = FALSE;
+bool		gp_enable_incremental_window_agg = true;
 bool 		gp_hashagg_streambottom = true;
+bool		gp_hashagg_linear_probing = false;
+bool		gp_enable_subplan_cache = true;
+bool		gp_hashjoin_adaptive = true;
+bool		gp_external_open_ahead = true;
+double		gp_hashagg_stream_min_reduction = 0.1;
+bool		gp_enable_arena_memory = true;
+bool		gp_enable_numa_affinity = false;
+bool		gp_catcache_init_file = true;
 bool		gp_enable_agg_distinct = true;
 bool		gp_enable_dqa_pruning = true;
 bool		gp_eager_dqa_pruning = FALSE;
@@ -719,7 +739,7 @@ int             optimizer_cost_model;
 bool		optimizer_print_query;
 bool		optimizer_print_plan;
 bool		optimizer_print_xform;
-bool		optimizer_release_mdcache = true; /* Make sure we release MDCache between queries by default */
+bool		optimizer_release_mdcache = false; /* MDCache is kept between queries and reset on catalog changes */
 bool		optimizer_disable_xform_result_printing;
 bool		optimizer_print_memo_after_exploration;
 bool		optimizer_print_memo_after_implementation;
@@ -793,6 +813,7 @@ int		optimizer_parts_to_force_sort_on_insert;
 int		optimizer_join_arity_for_associativity_commutativity;
 int		optimizer_array_expansion_threshold;
 int		optimizer_join_order_threshold;
+int		optimizer_time_budget;
 bool		optimizer_analyze_root_partition;
 bool		optimizer_analyze_midlevel_partition;
 bool		optimizer_enable_constant_expression_evaluation;
@@ -813,6 +834,7 @@ bool		optimizer_enable_derive_stats_all_groups;
 bool		optimizer_explain_show_status;
 bool		optimizer_prefer_scalar_dqa_multistage_agg;
 bool		optimizer_parallel_union;
+bool		optimizer_parallel;
 bool		optimizer_array_constraints;
 
 /* fallback in ranger ACL check */
@@ -832,6 +854,8 @@ bool gp_called_by_pgdump = false;
 char   *acl_type;
 int    rps_addr_port;
 int    rps_check_local_interval;
+int    rps_cache_timeout;
+int    rps_cache_size;
 
 char	   *pg_cloud_clustername = NULL;
 
@@ -1246,6 +1270,17 @@ static struct config_bool ConfigureNamesBool[] =
 		&gp_enable_hashjoin_size_heuristic,
 		false, NULL, NULL
 	},
+	{
+		{"gp_enable_partitionwise_join", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables joining the matching partitions of two tables "
+						 "partitioned alike one pair at a time."),
+			gettext_noop("If true, planner considers appending the joins of each "
+						 "pair of partitions that can be joined without motion, "
+						 "instead of joining the whole tables.")
+		},
+		&gp_enable_partitionwise_join,
+		true, NULL, NULL
+	},
 	{
 		{"gp_enable_fallback_plan", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Plan types which are not enabled may be used when a "
@@ -1264,6 +1299,17 @@ static struct config_bool ConfigureNamesBool[] =
 		&gp_enable_direct_dispatch,
 		true, NULL, NULL
 	},
+	{
+		{"gp_enable_prepared_plan_cache", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Reuse the plan of a prepared SELECT executed again with "
+						 "the same parameter values, or of a prepared single row "
+						 "INSERT with any values."),
+			gettext_noop("The plan is discarded on catalog, statistics or "
+						 "configuration changes.")
+		},
+		&gp_enable_prepared_plan_cache,
+		false, NULL, NULL
+	},
 	{
 		{"gp_enable_predicate_propagation", PGC_USERSET, QUERY_TUNING_OTHER,
 			gettext_noop("When two expressions are equivalent (such as with "
@@ -1294,6 +1340,17 @@ static struct config_bool ConfigureNamesBool[] =
 		&gp_workfile_caching,
 		false, NULL, NULL
 	},
+
+	{
+		{"gp_workfile_spill_notice", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Raises a notice for every operator that spills to workfiles."),
+			gettext_noop("The notice tells how much operator memory would have "
+						 "avoided the spill."),
+			GUC_GPDB_ADDOPT
+		},
+		&gp_workfile_spill_notice,
+		false, NULL, NULL
+	},
 	{
 		{"force_bitmap_table_scan", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Forces bitmap table scan instead of bitmap heap/ao/aoco scan."),
@@ -1915,6 +1972,26 @@ static struct config_bool ConfigureNamesBool[] =
 		false, NULL, NULL
 	},
 
+	{
+		{"gp_enable_snapshot_sharing", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Reuse the snapshot taken by another backend if no transaction has ended since."),
+			gettext_noop("Such snapshots are taken without scanning the process array under ProcArrayLock."),
+            GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE
+		},
+		&gp_enable_snapshot_sharing,
+		true, NULL, NULL
+	},
+
+	{
+		{"gp_enable_segfile_catalog_cache", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Cache the segment file catalog rows of append only tables on the master."),
+			gettext_noop("The cached rows are reused until a transaction that changed them ends."),
+            GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE
+		},
+		&gp_enable_segfile_catalog_cache,
+		true, NULL, NULL
+	},
+
 	{
 		{"gp_enable_tablespace_auto_mkdir", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Enable tablespace code to create empty directory if necessary"),
@@ -1935,6 +2012,17 @@ static struct config_bool ConfigureNamesBool[] =
 		true, NULL, NULL
 	},
 
+	{
+		{"gp_enable_segfile_count", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enable answering count(*) of append only tables from their segment file catalog."),
+			gettext_noop("If true, planner answers a count(*) of an append only or parquet table "
+						 "without filter or grouping from the tuple counts in pg_aoseg, "
+						 "without scanning the table.")
+		},
+		&gp_enable_segfile_count,
+		true, NULL, NULL
+	},
+
 	{
 		{"gp_eager_preunique", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Experimental feature: 2-phase duplicate removal - cost override."),
@@ -1955,6 +2043,17 @@ static struct config_bool ConfigureNamesBool[] =
 		true, NULL, NULL
 	},
 
+	{
+		{"gp_enable_incremental_window_agg", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables incremental evaluation of sliding window frames."),
+			gettext_noop("Aggregates without an inverse preliminary function, such as "
+						 "min and max, keep the value of the frame from one row to the next "
+						 "instead of scanning the whole frame for each row.")
+		},
+		&gp_enable_incremental_window_agg,
+		true, NULL, NULL
+	},
+
 	{
 		{"gp_hashagg_recalc_density", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("(Obsolete) Executor can recalculate grouping density based on pre-spill real density."),
@@ -2085,6 +2184,57 @@ static struct config_bool ConfigureNamesBool[] =
 		true, NULL, NULL
 	},
 
+	{
+		{"gp_enable_arena_memory", PGC_USERSET, RESOURCES_MEM,
+			gettext_noop("Serve per-tuple memory from bump-pointer arena contexts."),
+			gettext_noop("Arena contexts don't reclaim pfree'd space before they are reset."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_enable_arena_memory,
+		true, NULL, NULL
+	},
+
+	{
+		{"gp_catcache_init_file", PGC_SIGHUP, RESOURCES_MEM,
+			gettext_noop("Warm start the catalog caches of new backends from an init file."),
+			gettext_noop("A backend saves its catalog cache entries in the database directory "
+						 "for the backends started later, until a catalog change removes the file."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE
+		},
+		&gp_catcache_init_file,
+		true, NULL, NULL
+	},
+
+	{
+		{"gp_enable_numa_affinity", PGC_USERSET, RESOURCES_MEM,
+			gettext_noop("Bind each QE to the NUMA node of its virtual segment."),
+			gettext_noop("Keeps executor memory and interconnect buffers on the node the QE runs on."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_enable_numa_affinity,
+		false, NULL, NULL
+	},
+
+	{
+		{"gp_huge_pages", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Try to back the shared memory segment with huge pages."),
+			gettext_noop("Falls back to regular pages if the kernel cannot supply enough huge pages."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE
+		},
+		&gp_huge_pages,
+		false, NULL, NULL
+	},
+
+	{
+		{"gp_runaway_spill_first", PGC_SIGHUP, RESOURCES_MEM,
+			gettext_noop("Ask the spilling operators of a runaway session to release memory before canceling it."),
+			gettext_noop("The session is canceled if it runs away again without having reduced its vmem."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE
+		},
+		&gp_runaway_spill_first,
+		true, NULL, NULL
+	},
+
 	{
 		{"gp_parquet_insert_sort", PGC_USERSET, RESOURCES_MEM,
 			gettext_noop("Enable sorting of tuples during insertion in parquet partitioned tables."),
@@ -2096,6 +2246,36 @@ static struct config_bool ConfigureNamesBool[] =
 		true, NULL, NULL
 	},
 
+	{
+		{"gp_parquet_rowgroup_skipping", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enable skipping the parquet row groups which the scan qual rejects by their min/max statistics."),
+			NULL,
+			GUC_GPDB_ADDOPT
+		},
+		&gp_parquet_rowgroup_skipping,
+		true, NULL, NULL
+	},
+
+	{
+		{"gp_parquet_dictionary_encoding", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Enable dictionary encoding of the parquet column chunks, falling back to plain encoding when the dictionary is full."),
+			NULL,
+			GUC_GPDB_ADDOPT
+		},
+		&gp_parquet_dictionary_encoding,
+		true, NULL, NULL
+	},
+
+	{
+		{"gp_parquet_delta_encoding", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Enable delta encoding of the parquet integer, date, time and timestamp column chunks, instead of dictionary encoding."),
+			NULL,
+			GUC_GPDB_ADDOPT
+		},
+		&gp_parquet_delta_encoding,
+		true, NULL, NULL
+	},
+
 	{
 		{"gp_enable_mk_sort", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Enable multi-key sort."),
@@ -2141,6 +2321,50 @@ static struct config_bool ConfigureNamesBool[] =
 		true, NULL, NULL
 	},
 
+	{
+		{"gp_hashagg_linear_probing", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Use an open-addressing hash table with linear probing for hashagg"),
+			gettext_noop("The table keeps the hash value, and a single fixed-width grouping key, of each group "
+						 "in place of the chains of buckets."),
+			GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_hashagg_linear_probing,
+		false, NULL, NULL
+	},
+
+	{
+		{"gp_enable_subplan_cache", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Cache the results of correlated subqueries by their parameter values."),
+			gettext_noop("A correlated EXISTS or scalar subquery without volatile functions "
+						 "is only run once for each distinct set of outer values, as long "
+						 "as its cached results fit in work_mem."),
+			GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_enable_subplan_cache,
+		true, NULL, NULL
+	},
+
+	{
+		{"gp_hashjoin_adaptive", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Adapt the hash table of a hashjoin to the size its inner side actually has."),
+			gettext_noop("Once the inner side is read, its spilled batches are loaded back into memory "
+						 "if they all fit, and a table with too few buckets for its tuples gets more."),
+			GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_hashjoin_adaptive,
+		true, NULL, NULL
+	},
+
+	{
+		{"gp_external_open_ahead", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Have an Append open the external source of its next subplan while it reads the current one."),
+			gettext_noop("The external server then sends the data of the next table while the current one is read."),
+			GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_external_open_ahead,
+		true, NULL, NULL
+	},
+
 	{
 		{"gp_enable_motion_deadlock_sanity", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Enable verbose check at planning time."),
@@ -2394,6 +2618,17 @@ static struct config_bool ConfigureNamesBool[] =
 		true, NULL, NULL
 	},
 
+	{
+		{"gp_interconnect_defer_incoming", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Let a slice start executing before the slices sending to it have connected."),
+			gettext_noop("Only applies to the TCP interconnect; the incoming connections "
+						 "of a motion node are completed when it first reads from them."),
+            GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_interconnect_defer_incoming,
+		false, NULL, NULL
+	},
+
 	{
 		{"gp_interconnect_log_stats", PGC_USERSET, QUERY_TUNING_OTHER,
 			gettext_noop("Emit statistics from the UDP-IC at the end of every statement."),
@@ -2413,6 +2648,26 @@ static struct config_bool ConfigureNamesBool[] =
 		true, NULL, NULL
 	},
 
+	{
+		{"gp_interconnect_local_shm", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Pass the UDP interconnect packets between processes on the same host through shared memory."),
+			NULL,
+			GUC_GPDB_ADDOPT
+		},
+		&gp_interconnect_local_shm,
+		true, NULL, NULL
+	},
+
+	{
+		{"gp_interconnect_compression", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Compress the tuple chunks of the motions of wide rows with LZ4."),
+			gettext_noop("See gp_interconnect_compression_min_width."),
+			GUC_GPDB_ADDOPT
+		},
+		&gp_interconnect_compression,
+		false, NULL, NULL
+	},
+
 	{
 		{"gp_version_mismatch_error", PGC_USERSET, QUERY_TUNING_OTHER,
 			gettext_noop("QD/QE version string mismatches reported as an error"),
@@ -3147,6 +3402,15 @@ static struct config_bool ConfigureNamesBool[] =
 		true, NULL, NULL
 	},
 
+	{
+		{"gp_statistics_skip_unchanged", PGC_USERSET, STATS_ANALYZE,
+			gettext_noop("ANALYZE skips the append-only and parquet tables not changed since their last ANALYZE."),
+			gettext_noop("The root statistics of a partitioned table are still merged from all its leaves.")
+		},
+		&gp_statistics_skip_unchanged,
+		false, NULL, NULL
+	},
+
 	{
 		{"gp_eager_hashtable_release", PGC_USERSET, DEPRECATED_OPTIONS,
 			gettext_noop("This guc determines if a hash-join eagerly releases its hash table."),
@@ -3593,7 +3857,7 @@ static struct config_bool ConfigureNamesBool[] =
 			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE
 		},
 		&optimizer_release_mdcache,
-		true, NULL, NULL
+		false, NULL, NULL
 	},
 
 	{
@@ -4496,6 +4760,15 @@ static struct config_bool ConfigureNamesBool[] =
 		false, NULL, NULL
 	},
 
+	{
+		{"hawq_re_blkio_enable", PGC_POSTMASTER, RESOURCES_MGM,
+		 gettext_noop("Enables BLKIO sub-system for resource enforcement."),
+		 NULL
+		},
+		&rm_enforce_blkio_enable,
+		false, NULL, NULL
+	},
+
 	{
 		{"hawq_rm_force_fifo_queuing", PGC_POSTMASTER, RESOURCES_MGM,
 		 gettext_noop("force to execute query in queue in a fifo sequence."),
@@ -4532,6 +4805,15 @@ static struct config_bool ConfigureNamesBool[] =
 		true, NULL, NULL
 	},
 
+	{
+		{"hawq_rm_segment_heartbeat_compact", PGC_POSTMASTER, RESOURCES_MGM,
+		 gettext_noop("send segment heart-beats without segment status while it is not changed."),
+		 gettext_noop("A segment also reports its postmaster down in its heart-beats then.")
+		},
+		&rm_segment_heartbeat_compact,
+		true, NULL, NULL
+	},
+
 	{
 		{"optimizer_prefer_scalar_dqa_multistage_agg", PGC_USERSET, DEVELOPER_OPTIONS,
 		 gettext_noop("Prefer multistage aggregates for scalar distinct qualified aggregate in the optimizer."),
@@ -4552,6 +4834,15 @@ static struct config_bool ConfigureNamesBool[] =
 		false, NULL, NULL
 	},
 
+	{
+		{"optimizer_parallel", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enable plan optimization with multiple optimizer workers."),
+			gettext_noop("The accesses of the workers to the catalog are serialized.")
+		},
+		&optimizer_parallel,
+		false, NULL, NULL
+	},
+
 	{
 		{"optimizer_array_constraints", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Allows the optimizer's constraint framework to derive array constraints."),
@@ -4592,6 +4883,16 @@ static struct config_bool ConfigureNamesBool[] =
     false, NULL, NULL
   },
 
+  {
+    {"ao_cache_read", PGC_USERSET, QUERY_TUNING_OTHER,
+      gettext_noop("Enable cache read for append only and parquet tables"),
+      gettext_noop("The results of read only queries are cached until "
+                   "the tables they read are written to.")
+    },
+    &ao_cache_read,
+    false, NULL, NULL
+  },
+
   {
     {"hawq_init_with_hdfs", PGC_USERSET, CLIENT_CONN_STATEMENT,
       gettext_noop("choose whether init cluster with hdfs."),
@@ -5041,6 +5342,16 @@ static struct config_int ConfigureNamesInt[] =
 		DEFAULT_FS_SAFE_WRITE_SIZE, 0, INT_MAX, NULL, NULL
 	},
 
+	{
+		{"gp_appendonly_read_ahead_buffers", PGC_USERSET, RESOURCES,
+			gettext_noop("Number of large reads of an append-only segment file done ahead by a helper thread."),
+			gettext_noop("Zero reads the segment files synchronously."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_appendonly_read_ahead_buffers,
+		0, 0, 2, NULL, NULL
+	},
+
 	{
 		{"gp_safefswritesize", PGC_BACKEND, RESOURCES,
 			gettext_noop("Minimum FS safe write size."),
@@ -5167,6 +5478,27 @@ static struct config_int ConfigureNamesInt[] =
 		0, 0, INT_MAX / 2, NULL, NULL
 	},
 
+	{
+		{"gp_operator_mem_grow_limit", PGC_USERSET, RESOURCES_MEM,
+		 	gettext_noop("Sets the maximum memory a hash operator may take beyond its quota "
+						 "from the free memory of the segment before spilling."),
+		 	NULL,
+			GUC_UNIT_KB | GUC_GPDB_ADDOPT
+		},
+		&gp_operator_mem_grow_limit,
+		0, 0, INT_MAX / 2, NULL, NULL
+	},
+
+	{
+		{"gp_huge_page_alloc_threshold", PGC_USERSET, RESOURCES_MEM,
+		 	gettext_noop("Sets the size from which memory blocks are advised to use transparent huge pages."),
+		 	gettext_noop("0 disables the advice."),
+			GUC_UNIT_KB | GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_huge_page_alloc_threshold,
+		0, 0, INT_MAX / 2, NULL, NULL
+	},
+
 	{
 		{"gp_max_plan_size", PGC_SUSET, RESOURCES_MEM,
 		 	gettext_noop("Sets the maximum size of a plan to be dispatched."),
@@ -5177,6 +5509,38 @@ static struct config_int ConfigureNamesInt[] =
 		0, 0, MAX_KILOBYTES, NULL, NULL
 	},
 
+	{
+		{"gp_instrument_timing_sample", PGC_USERSET, STATS_MONITORING,
+			gettext_noop("Times only every Nth execution of an instrumented plan node."),
+			gettext_noop("The node times are scaled up from the sampled ones. "
+						 "1 times every execution."),
+			GUC_GPDB_ADDOPT
+		},
+		&gp_instrument_timing_sample,
+		1, 1, INT_MAX, NULL, NULL
+	},
+
+	{
+		{"gp_query_metrics_port", PGC_SUSET, STATS_MONITORING,
+			gettext_noop("Sends a JSON event for every finished query to this UDP port on localhost."),
+			gettext_noop("A local collector agent is expected to forward the events. "
+						 "0 disables the events."),
+		},
+		&gp_query_metrics_port,
+		0, 0, 65535, NULL, NULL
+	},
+
+	{
+		{"gp_profile_sample_hz", PGC_SUSET, STATS_MONITORING,
+			gettext_noop("Samples the call stack of every QE this many times per second of CPU time."),
+			gettext_noop("The stacks of each query are written in folded format to "
+						 "pg_log/profile_*.folded of the segments. 0 disables sampling."),
+			GUC_GPDB_ADDOPT
+		},
+		&gp_profile_sample_hz,
+		0, 0, 1000, NULL, NULL
+	},
+
 	{
     {"gp_max_plan_slice", PGC_USERSET, RESOURCES_MEM,
       gettext_noop("Sets the maximum slice number of a plan to be dispatched."),
@@ -5187,6 +5551,15 @@ static struct config_int ConfigureNamesInt[] =
     36, 0, INT_MAX, NULL, NULL
   },
 
+	{
+		{"gp_dispatch_compress_threads", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Number of threads that help compress a large plan before it is dispatched."),
+			gettext_noop("Zero compresses the plan on the backend only.")
+		},
+		&gp_dispatch_compress_threads,
+		0, 0, 32, NULL, NULL
+	},
+
 	{
 		{"gp_max_partition_level", PGC_SUSET, PRESET_OPTIONS,
 		 	gettext_noop("Sets the maximum number of levels allowed when creating a partitioned table."),
@@ -5283,6 +5656,16 @@ static struct config_int ConfigureNamesInt[] =
 		8192, 32, INT_MAX, NULL, NULL
 	},
 
+	{
+		{"gp_workfile_spill_history_size", PGC_POSTMASTER, RESOURCES,
+			gettext_noop("Sets the number of spilling operators remembered on each segment."),
+			gettext_noop("The history is shown by workfile.gp_workfile_spill_history. "
+						 "0 disables it.")
+		},
+		&gp_workfile_spill_history_size,
+		1024, 0, 100000, NULL, NULL
+	},
+
 	{
 		{"max_files_per_process", PGC_POSTMASTER, RESOURCES_KERNEL,
 			gettext_noop("Sets the maximum number of simultaneously open files for each server process."),
@@ -5302,6 +5685,26 @@ static struct config_int ConfigureNamesInt[] =
 		3000000, 0, INT_MAX, NULL, NULL,
 	},
 
+	{
+		{"gp_workfile_async_writers", PGC_USERSET, RESOURCES,
+			gettext_noop("Number of helper threads writing the blocks of the bfz workfiles."),
+			gettext_noop("0 for synchronous writes. Workfiles compressed with zlib are always written synchronously."),
+			GUC_GPDB_ADDOPT | GUC_NOT_IN_SAMPLE
+		},
+		&gp_workfile_async_writers,
+		0, 0, BFZ_MAX_ASYNC_WRITERS, NULL, NULL,
+	},
+
+	{
+		{"gp_shareinput_shm_limit", PGC_USERSET, RESOURCES,
+			gettext_noop("Maximum size of a cross slice shared scan passed to its readers in shared memory."),
+			gettext_noop("Larger results, and results that spill, are passed through workfiles. 0 always uses workfiles."),
+			GUC_GPDB_ADDOPT | GUC_UNIT_KB
+		},
+		&gp_shareinput_shm_limit,
+		65536, 0, MAX_KILOBYTES, NULL, NULL,
+	},
+
 #ifdef LOCK_DEBUG
 	{
 		{"trace_lock_oidmin", PGC_SUSET, DEVELOPER_OPTIONS,
@@ -5750,6 +6153,16 @@ static struct config_int ConfigureNamesInt[] =
 	  262144, 2048, INT_MAX, NULL, NULL
 	},
 
+	{
+		{"gp_appendonly_small_segfile_size", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Sets the average segment file size below which VACUUM suggests rewriting an append only table."),
+			gettext_noop("Zero disables the suggestion."),
+			GUC_UNIT_KB
+		},
+		&gp_appendonly_small_segfile_size,
+		16384, 0, MAX_KILOBYTES, NULL, NULL
+	},
+
 	{
 		{"test_appendonly_version_default", PGC_USERSET, APPENDONLY_TABLES,
 		 gettext_noop("Align append-only blocks to 64 bits."),
@@ -5760,6 +6173,26 @@ static struct config_int ConfigureNamesInt[] =
 		AORelationVersion_GetLatest(), 0, INT_MAX, NULL, NULL
 	},
 
+	{
+		{"gp_parquet_compress_threads", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Number of threads that help compress the pages of a parquet row group when it is written out."),
+			gettext_noop("Zero compresses the pages as they are filled."),
+			GUC_GPDB_ADDOPT
+		},
+		&gp_parquet_compress_threads,
+		0, 0, 32, NULL, NULL
+	},
+
+	{
+		{"gp_parquet_footer_cache_size", PGC_POSTMASTER, APPENDONLY_TABLES,
+			gettext_noop("Sets the size of the shared memory that caches the footers of the parquet files read."),
+			gettext_noop("Zero reads the footer of a parquet file from the file at each scan."),
+			GUC_UNIT_KB
+		},
+		&gp_parquet_footer_cache_size,
+		32768, 0, MAX_KILOBYTES, NULL, NULL
+	},
+
 	{
 		{"gp_external_max_segs", PGC_USERSET, EXTERNAL_TABLES,
 			gettext_noop("Maximum number of segments that connect to a single gpfdist URL."),
@@ -5799,6 +6232,36 @@ static struct config_int ConfigureNamesInt[] =
         2, 1, 4096, NULL, NULL
 	},
 
+	{
+		{"gp_interconnect_buffer_budget", PGC_USERSET, GP_ARRAY_TUNING,
+            gettext_noop("Sets the maximum number of packet buffers of a motion in each direction in the UDP interconnect"),
+            gettext_noop("The queue of each connection is shrunk to fit, 0 means no limit."),
+			GUC_GPDB_ADDOPT
+        },
+        &Gp_interconnect_buffer_budget,
+        1024, 0, INT_MAX, NULL, NULL
+	},
+
+	{
+		{"gp_interconnect_rtt_target_delay", PGC_USERSET, GP_ARRAY_TUNING,
+            gettext_noop("Sets the queueing delay (in us) above which the rtt flow control method of the UDP interconnect slows down"),
+            NULL,
+			GUC_GPDB_ADDOPT
+        },
+        &Gp_interconnect_rtt_target_delay,
+        1000, 100, 200000, NULL, NULL
+	},
+
+	{
+		{"gp_interconnect_compression_min_width", PGC_USERSET, GP_ARRAY_TUNING,
+            gettext_noop("Sets the planned row width (in bytes) from which the motions are compressed, when gp_interconnect_compression is on"),
+            NULL,
+			GUC_GPDB_ADDOPT
+        },
+        &gp_interconnect_compression_min_width,
+        256, 0, INT_MAX, NULL, NULL
+	},
+
 	{
 		{"gp_interconnect_timer_period", PGC_USERSET, GP_ARRAY_TUNING,
             gettext_noop("Sets the timer period (in ms) for UDP interconnect"),
@@ -5859,6 +6322,27 @@ static struct config_int ConfigureNamesInt[] =
         100, 1, 4096, NULL, NULL
 	},
 
+	{
+		{"gp_interconnect_io_batch_size", PGC_USERSET, GP_ARRAY_TUNING,
+            gettext_noop("Sets the max number of packets sent or received by one system call in the UDP interconnect."),
+            gettext_noop("1 sends and receives one packet per system call."),
+			GUC_GPDB_ADDOPT
+        },
+        &Gp_interconnect_io_batch_size,
+        32, 1, 64, NULL, NULL
+	},
+
+	{
+		{"gp_interconnect_rx_threads", PGC_BACKEND, GP_ARRAY_TUNING,
+            gettext_noop("Sets the number of receive threads of the UDP interconnect."),
+            gettext_noop("Each thread has its own socket bound to the listener port, "
+                         "the kernel spreads the senders across them."),
+			GUC_GPDB_ADDOPT
+        },
+        &Gp_interconnect_rx_threads,
+        1, 1, 8, NULL, NULL
+	},
+
 	{
 		{"gp_udp_bufsize_k", PGC_BACKEND, GP_ARRAY_TUNING,
             gettext_noop("Sets recv buf size of UDP interconnect, for testing."),
@@ -6130,6 +6614,57 @@ static struct config_int ConfigureNamesInt[] =
 		20, 0, INT_MAX, NULL, NULL
 	},
 
+	{
+		{"gp_hashjoin_prefetch_distance", PGC_USERSET, GP_ARRAY_TUNING,
+		 gettext_noop("Number of outer tuples Hashjoin reads ahead to prefetch the hash buckets they probe."),
+		 gettext_noop("Applies to hashtables larger than the CPU caches. Set to 0 to disable prefetching."),
+		 GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_hashjoin_prefetch_distance,
+		16, 0, 256, NULL, NULL
+	},
+
+	{
+		{"gp_hashjoin_skew_memory_percent", PGC_USERSET, GP_ARRAY_TUNING,
+		 gettext_noop("Percentage of the operator memory of a spilling Hashjoin that holds the inner tuples of the most common outer keys."),
+		 gettext_noop("The outer tuples with those keys are joined in the first batch rather than spilled. Set to 0 to disable it."),
+		 GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_hashjoin_skew_memory_percent,
+		2, 0, 100, NULL, NULL
+	},
+
+	{
+		{"gp_mk_sort_threads", PGC_USERSET, QUERY_TUNING_METHOD,
+		 gettext_noop("Number of threads that help a multi-key sort sort its tuples in memory."),
+		 gettext_noop("Applies to sorts on pass-by-value keys. Zero sorts in the backend alone."),
+		 GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_mk_sort_threads,
+		0, 0, 32, NULL, NULL
+	},
+
+	{
+		{"gp_regex_cache_size", PGC_USERSET, QUERY_TUNING_METHOD,
+		 gettext_noop("Number of compiled regular expressions a backend keeps for later queries."),
+		 gettext_noop("The least recently used one is dropped when a new one does not fit."),
+		 GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_regex_cache_size,
+		256, 1, 65536, NULL, NULL
+	},
+
+	{
+		{"gp_sequence_lease_max", PGC_USERSET, QUERY_TUNING_METHOD,
+		 gettext_noop("Most values of a sequence a segment asks the master for at once."),
+		 gettext_noop("A segment asks for twice as many values each time it uses them up in a transaction. "
+					  "The values it does not use are skipped."),
+		 GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_sequence_lease_max,
+		8192, 1, 1048576, NULL, NULL
+	},
+
 	{
 		{"gp_hashagg_groups_per_bucket", PGC_USERSET, GP_ARRAY_TUNING,
 		 gettext_noop("Target density of hashtable used by Hashagg during execution"),
@@ -6335,6 +6870,15 @@ static struct config_int ConfigureNamesInt[] =
 		&gp_statistics_blocks_target,
 		25, 1, 1000, NULL, NULL
 	},
+	{
+		{"gp_statistics_dependency_columns", PGC_USERSET, STATS_ANALYZE,
+			gettext_noop("Sets the number of columns of a table among which ANALYZE collects functional dependencies."),
+			gettext_noop("The first columns analyzed are taken; 0 or 1 turns off the collection. "
+						 "The cost of ANALYZE grows with the square of this number.")
+		},
+		&gp_statistics_dependency_columns,
+		0, 0, 32, NULL, NULL
+	},
 	{
 		{"gp_perfmon_segment_interval", PGC_POSTMASTER, STATS,
 			gettext_noop("Interval (in ms) between sending segment statistics to perfmon."),
@@ -6516,6 +7060,17 @@ static struct config_int ConfigureNamesInt[] =
 		10, 0, INT_MAX, NULL, NULL
 	},
 
+	{
+		{"optimizer_time_budget", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Sets the wall-clock time the optimizer may spend searching for a plan."),
+			gettext_noop("When the budget is exhausted, the best plan found so far is used. "
+						 "A value of 0 turns off the limit."),
+			GUC_UNIT_MS
+		},
+		&optimizer_time_budget,
+		0, 0, INT_MAX, NULL, NULL
+	},
+
 	{
 		{"information_schema_namespace_oid", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("the oid of information_schema namespace"),
@@ -6535,6 +7090,27 @@ static struct config_int ConfigureNamesInt[] =
 		0, 0, INT_MAX, NULL, NULL
 	},
 
+	{
+		{"gp_memory_account_publish_interval", PGC_SUSET, RESOURCES_MEM,
+			gettext_noop("Sets the minimum time between two publications of a process's memory accounts."),
+			gettext_noop("Running processes publish their memory accounting tree for "
+						 "session_state.memory_account_snapshot while they grow. Zero disables publishing."),
+			GUC_UNIT_MS | GUC_GPDB_ADDOPT
+		},
+		&gp_memory_account_publish_interval,
+		0, 0, INT_MAX, NULL, NULL
+	},
+
+	{
+		{"gp_memory_alloc_sample_interval", PGC_SUSET, DEVELOPER_OPTIONS,
+			gettext_noop("Logs every Nth memory allocation of a process with its call stack."),
+			gettext_noop("Zero disables the sampling."),
+			GUC_GPDB_ADDOPT | GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE
+		},
+		&gp_memory_alloc_sample_interval,
+		0, 0, INT_MAX, NULL, NULL
+	},
+
 	{
 		{"optimizer_segments", PGC_USERSET, QUERY_TUNING_METHOD,
             gettext_noop("Number of segments to be considered by the optimizer during costing, or 0 to take the actual number of segments."),
@@ -6575,6 +7151,27 @@ static struct config_int ConfigureNamesInt[] =
 		100, 1, INT_MAX, NULL, NULL
 	},
 
+	{
+		{"pxf_prefetch_fragments", PGC_USERSET, EXTERNAL_TABLES,
+			gettext_noop("Number of fragments a segment fetches from PXF ahead of the fragment it is reading."),
+			gettext_noop("Zero fetches the fragments one after the other."),
+			GUC_GPDB_ADDOPT
+		},
+		&pxf_prefetch_fragments,
+		0, 0, 16, NULL, NULL
+	},
+
+	{
+		{"pxf_fragments_cache_ttl", PGC_USERSET, EXTERNAL_TABLES,
+			gettext_noop("Sets the time for which the master reuses the fragments the PXF Fragmenter returned for an external table."),
+			gettext_noop("Zero disables the cache. Files added to or removed from the external data "
+						 "within that time may not be seen by the queries of the session."),
+			GUC_UNIT_S
+		},
+		&pxf_fragments_cache_ttl,
+		0, 0, INT_MAX / 1000, NULL, NULL
+	},
+
 	{
 		{"pxf_service_port", PGC_POSTMASTER, EXTERNAL_TABLES,
 			gettext_noop("PXF service port"),
@@ -6612,6 +7209,24 @@ static struct config_int ConfigureNamesInt[] =
 		300, 1, 65535, NULL, NULL
 	},
 
+	{
+		{"hawq_rps_cache_timeout", PGC_SIGHUP, PRESET_OPTIONS,
+			gettext_noop("seconds (0 to disable) a privilege decision of RPS is cached"),
+			NULL
+		},
+		&rps_cache_timeout,
+		5, 0, 3600, NULL, NULL
+	},
+
+	{
+		{"hawq_rps_cache_size", PGC_POSTMASTER, PRESET_OPTIONS,
+			gettext_noop("number of privilege decisions of RPS cached in shared memory"),
+			NULL
+		},
+		&rps_cache_size,
+		1024, 0, 1048576, NULL, NULL
+	},
+
 	{
 		{"hawq_segment_address_port", PGC_POSTMASTER, PRESET_OPTIONS,
 			gettext_noop("segment address port number"),
@@ -6726,6 +7341,16 @@ static struct config_int ConfigureNamesInt[] =
 			128, 1, 2048 ,NULL, NULL
 	},
 
+	{
+			{"cost_per_virtual_segment", PGC_USERSET, DEVELOPER_OPTIONS,
+				gettext_noop("Sets the plan cost to use one more virtual segment for, 0 sizes by data size only"),
+				NULL,
+				GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE
+			},
+			&cost_per_virtual_segment,
+			0, 0, INT_MAX ,NULL, NULL
+	},
+
 	{
 			{"min_cost_for_each_query", PGC_USERSET, DEVELOPER_OPTIONS,
 				gettext_noop("Sets min cost(MB) for each query which is utilized by RM"),
@@ -6825,6 +7450,28 @@ static struct config_int ConfigureNamesInt[] =
 		2, 0, 65535, NULL, NULL
 	},
 
+	{
+		{"hawq_rm_reuse_registration_timeout", PGC_USERSET, RESOURCES_MGM,
+			gettext_noop("Seconds a session keeps its connection registered in "
+						 "resource manager for the next query after a query "
+						 "returns its resource."),
+			gettext_noop("0 unregisters the connection as the resource is returned.")
+		},
+		&rm_reuse_registration_timeout,
+		0, 0, 65535, NULL, NULL
+	},
+
+	{
+		{"hawq_rm_resource_lease_timeout", PGC_USERSET, RESOURCES_MGM,
+			gettext_noop("Seconds a session keeps the resource of a query to run "
+						 "the next query fitting in it without acquiring "
+						 "resource from resource manager."),
+			gettext_noop("0 returns the resource as the query ends.")
+		},
+		&rm_resource_lease_timeout,
+		0, 0, 65535, NULL, NULL
+	},
+
 	{
 		{"hawq_rm_session_lease_timeout", PGC_POSTMASTER, RESOURCES_MGM,
 			gettext_noop("timeout for closing a session lease if dispatcher does "
@@ -6853,6 +7500,17 @@ static struct config_int ConfigureNamesInt[] =
 		300, -1, 65535, NULL, NULL
 	},
 
+	{
+		{"hawq_rm_resource_forecast_period", PGC_POSTMASTER, RESOURCES_MGM,
+			gettext_noop("period in seconds the resource demand repeats in, resource "
+						 "manager acquires resource ahead of the demand seen one "
+						 "period ago. 0 disables the forecast."),
+			NULL
+		},
+		&rm_resource_forecast_period,
+		0, 0, 604800, NULL, NULL
+	},
+
 	{
 		{"hawq_rm_nocluster_timeout", PGC_POSTMASTER, RESOURCES_MGM,
 			gettext_noop("timeout for having enough number of segments registered."),
@@ -6902,6 +7560,27 @@ static struct config_int ConfigureNamesInt[] =
 		30, 1, 65535, NULL, NULL
 	},
 
+	{
+		{"hawq_rm_segment_heartbeat_max_interval", PGC_POSTMASTER, RESOURCES_MGM,
+			gettext_noop("maximum interval a segment stretches its heart-beat "
+						 "interval to while its status is not changed."),
+			gettext_noop("0 means always sending heart-beat at the interval "
+						 "hawq_rm_segment_heartbeat_interval.")
+		},
+		&rm_segment_heartbeat_max_interval,
+		0, 0, 65535, NULL, NULL
+	},
+
+	{
+		{"hawq_rm_fair_queue_vseg_cost", PGC_POSTMASTER, RESOURCES_MGM,
+			gettext_noop("milliseconds one virtual segment of demand delays a query "
+						 "in the resource queues of allocation policy wfq."),
+			NULL
+		},
+		&rm_fair_queue_vseg_cost,
+		1000, 0, 3600000, NULL, NULL
+	},
+
 	{
 		{"hawq_rm_segment_tmpdir_detect_interval", PGC_POSTMASTER, RESOURCES_MGM,
 			gettext_noop("interval for detecting segment local temporary directories."),
@@ -7022,6 +7701,15 @@ static struct config_int ConfigureNamesInt[] =
 		&metadata_cache_max_hdfs_file_num,
 		524288, 32768, 8388608, NULL, NULL
 	},
+	{
+		{
+			"hawq_metadata_cache_prefetch_threads", PGC_USERSET, DEVELOPER_OPTIONS,
+				gettext_noop("Sets the number of threads fetching the block locations not in metadata cache while planning a query."),
+				gettext_noop("0 fetches them one by one while the splits are allocated.")
+		},
+		&metadata_cache_prefetch_threads,
+		8, 0, 64, NULL, NULL
+	},
 
 	{
 		{"share_input_scan_wait_lockfile_timeout", PGC_USERSET, DEVELOPER_OPTIONS,
@@ -7238,6 +7926,19 @@ static struct config_real ConfigureNamesReal[] =
 		0, 0, DBL_MAX, NULL, NULL
 	},
 
+	{
+		{"gp_redistribute_skew_threshold", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Sets the frequency of a join key above which its rows "
+						 "are not redistributed to a single segment."),
+			gettext_noop("If >0, when both rels of a join are redistributed, the "
+						 "rows of one rel whose key is a most common value at least "
+						 "this frequent are spread over all the segments, and the "
+						 "rows of the other rel with these keys are broadcast.")
+		},
+		&gp_redistribute_skew_threshold,
+		0, 0, 1, NULL, NULL
+	},
+
 	{
 		{"gp_hashagg_rewrite_limit", PGC_USERSET, QUERY_TUNING_OTHER,
             gettext_noop("(Obsolete) Planner will not choose hashed aggregation if "
@@ -7249,6 +7950,17 @@ static struct config_real ConfigureNamesReal[] =
 		2.0, 1.0, 100.0, NULL, NULL
 	},
 
+	{
+		{"gp_hashagg_stream_min_reduction", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Sets the fraction of rows a streaming bottom stage hashagg must merge to keep aggregating."),
+			gettext_noop("When a full hash table has merged fewer input rows, the rest of the "
+						 "input streams through without aggregation. Zero disables this."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_hashagg_stream_min_reduction,
+		0.1, 0.0, 1.0, NULL, NULL
+	},
+
 	{
 		{"gp_analyze_relative_error", PGC_USERSET, STATS_ANALYZE,
 		 gettext_noop("target relative error fraction for row sampling during analyze"),
@@ -7277,6 +7989,23 @@ static struct config_real ConfigureNamesReal[] =
 		&gp_statistics_ndistinct_scaling_ratio_threshold,
 		0.10, 0.001, 1.0, NULL, NULL
 	},
+	{
+		{"gp_statistics_block_sampling_factor", PGC_USERSET, STATS_ANALYZE,
+			gettext_noop("Sets how many times more rows than needed ANALYZE reads from random blocks of append-only and parquet tables."),
+			gettext_noop("The other blocks are not read. A value of 0 samples rows from the whole table.")
+		},
+		&gp_statistics_block_sampling_factor,
+		0.0, 0.0, DBL_MAX, NULL, NULL
+	},
+	{
+		{"gp_statistics_block_sampling_fraction", PGC_USERSET, STATS_ANALYZE,
+			gettext_noop("Fraction of the blocks of append-only and parquet tables read by a scan."),
+			NULL,
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_statistics_block_sampling_fraction,
+		1.0, 0.0, 1.0, NULL, NULL
+	},
 	{
 		{"gp_statistics_sampling_threshold", PGC_USERSET, STATS_ANALYZE,
 			gettext_noop("Only tables larger than this size will be sampled."),
@@ -7376,6 +8105,15 @@ static struct config_real ConfigureNamesReal[] =
 		1024.0, 0.0, INT_MAX, NULL, NULL
 	},
 
+	{
+		{"hawq_re_blkio_weight",PGC_POSTMASTER, RESOURCES_MGM,
+			gettext_noop("Sets the block I/O weight of one virtual core in HAWQ for resource enforcement."),
+			gettext_noop("The weight is bounded to the range 10 to 1000 accepted by blkio.weight.")
+		},
+		&rm_enforce_blkio_weight,
+		100.0, 0.0, 1000.0, NULL, NULL
+	},
+
 	{
 		{"hawq_re_vcore_pcore_ratio",PGC_POSTMASTER, RESOURCES_MGM,
 			gettext_noop("Sets the weight to map virtual cores to physical cores in HAWQ for resource enforcement."),
@@ -7631,7 +8369,7 @@ static struct config_string ConfigureNamesString[] =
 	{
 		{"gp_workfile_compress_algorithm", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Specify the compression algorithm that work files in the query executor use."),
-			gettext_noop("Valid values are \"NONE\", \"ZLIB\"."),
+			gettext_noop("Valid values are \"NONE\", \"ZLIB\", \"LZ4\", \"ZSTD\"."),
 			GUC_GPDB_ADDOPT
 		},
 		&gp_workfile_compress_algorithm_str,
@@ -8403,7 +9141,7 @@ static struct config_string ConfigureNamesString[] =
 	{
 		{"gp_interconnect_fc_method", PGC_USERSET, GP_ARRAY_TUNING,
 		 gettext_noop("Sets the flow control method used for UDP interconnect."),
-		 gettext_noop("Valid values are \"capacity\" and \"loss\"."),
+		 gettext_noop("Valid values are \"capacity\", \"loss\" and \"rtt\"."),
 		 GUC_GPDB_ADDOPT
 		},
 		&gp_interconnect_fc_method_str,
@@ -9793,6 +10531,9 @@ ResetAllOptions(void)
 		if (gconf->flags & GUC_REPORT)
 			ReportGUCOption(gconf);
 	}
+
+	/* Plans of prepared statements may depend on the reset values */
+	InvalidatePreparedPlans();
 }
 
 
@@ -10121,6 +10862,10 @@ AtEOXact_GUC(bool isCommit, bool isSubXact)
 		/* Report new value if we changed it */
 		if (changed && (gconf->flags & GUC_REPORT))
 			ReportGUCOption(gconf);
+
+		/* Plans of prepared statements may depend on the old value */
+		if (changed)
+			InvalidatePreparedPlans();
 	}
 
 	/*
@@ -11186,6 +11931,10 @@ set_config_option(const char *name, const char *value,
 	if (changeVal && (record->flags & GUC_REPORT))
 		ReportGUCOption(record);
 
+	/* Plans of prepared statements may depend on the old value */
+	if (changeVal)
+		InvalidatePreparedPlans();
+
 	return true;
 }
 
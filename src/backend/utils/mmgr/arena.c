@@ -0,0 +1,682 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*-------------------------------------------------------------------------
+ *
+ * arena.c
+ *    A bump-pointer implementation of the abstract MemoryContext type,
+ *    for memory which is released as a whole.
+ *
+ * An ArenaContext hands out chunks from the active block one after another,
+ * with no size classes and no freelists.  pfree() doesn't reclaim the space
+ * of a chunk, and repalloc() grows a chunk in place only if it is the last
+ * one of the active block.  Resetting the context releases all blocks but
+ * the keeper block, which is simply rewound.
+ *
+ * This suits contexts that are reset often and in which chunks are seldom
+ * freed one by one, such as the per-tuple memory of the executor.  Don't use
+ * it for memory that relies on pfree() to stay bounded.
+ *
+ * Every chunk still begins with a StandardChunkHeader, so that pfree(),
+ * repalloc(), GetMemoryChunkSpace() and GetMemoryChunkContext() accept the
+ * chunks, but they all share the SharedChunkHeader embedded in the context.
+ * Memory accounting is done per block: a block is charged to the memory
+ * account active when it was obtained (for the keeper block, when it was
+ * first used since the last reset).
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "utils/memutils.h"
+#include "utils/memaccounting.h"
+
+/* Define this to detail debug alloc information */
+/* #define HAVE_ALLOCINFO */
+
+#ifdef CDB_PALLOC_CALLER_ID
+#define CDB_MCXT_WHERE(context) (context)->callerFile, (context)->callerLine
+#else
+#define CDB_MCXT_WHERE(context) __FILE__, __LINE__
+#endif
+
+/*
+ * ArenaBlock
+ *		An ArenaBlock is the unit of memory that is obtained by arena.c
+ *		from malloc().  Chunks are carved off it from freeptr up.
+ */
+typedef struct ArenaBlockData
+{
+	ArenaBlock	next;			/* next block in arena's blocks list */
+	char	   *freeptr;		/* start of free space in this block */
+	char	   *endptr;			/* end of space in this block */
+
+	/* Which account is charged for this block, NULL if none */
+	struct MemoryAccount *memoryAccount;
+	uint16		memoryAccountGeneration;
+} ArenaBlockData;
+
+typedef StandardChunkHeader ArenaChunkData;
+typedef ArenaChunkData *ArenaChunk;
+
+#define ARENA_BLOCKHDRSZ	MAXALIGN(sizeof(ArenaBlockData))
+#define ARENA_CHUNKHDRSZ	STANDARDCHUNKHEADERSIZE
+
+#define ArenaPointerGetChunk(ptr) \
+					((ArenaChunk)(((char *)(ptr)) - ARENA_CHUNKHDRSZ))
+#define ArenaChunkGetPointer(chk) \
+					((void *)(((char *)(chk)) + ARENA_CHUNKHDRSZ))
+
+/*
+ * These functions implement the MemoryContext API for Arena contexts.
+ */
+static void *ArenaAlloc(MemoryContext context, Size size);
+static void ArenaFree(MemoryContext context, void *pointer);
+static void *ArenaRealloc(MemoryContext context, void *pointer, Size size);
+static void ArenaInit(MemoryContext context);
+static void ArenaReset(MemoryContext context);
+static void ArenaDelete(MemoryContext context);
+static Size ArenaGetChunkSpace(MemoryContext context, void *pointer);
+static bool ArenaIsEmpty(MemoryContext context);
+static void ArenaStats(MemoryContext context, uint64 *nBlocks, uint64 *nChunks,
+		uint64 *currentAvailable, uint64 *allAllocated, uint64 *allFreed, uint64 *maxHeld);
+static void ArenaReleaseAccounting(MemoryContext context);
+static void ArenaUpdateGeneration(MemoryContext context);
+
+#ifdef MEMORY_CONTEXT_CHECKING
+static void ArenaCheck(MemoryContext context);
+#endif
+
+/*
+ * This is the virtual function table for Arena contexts.
+ */
+static MemoryContextMethods ArenaMethods = {
+	ArenaAlloc,
+	ArenaFree,
+	ArenaRealloc,
+	ArenaInit,
+	ArenaReset,
+	ArenaDelete,
+	ArenaGetChunkSpace,
+	ArenaIsEmpty,
+	ArenaStats,
+	ArenaReleaseAccounting,
+	ArenaUpdateGeneration,
+#ifdef MEMORY_CONTEXT_CHECKING
+	ArenaCheck
+#endif
+};
+
+
+/* ----------
+ * Debug macros
+ * ----------
+ */
+#ifdef HAVE_ALLOCINFO
+#define ArenaAllocInfo(_cxt, _chunk) \
+			fprintf(stderr, "ArenaAlloc: %s: %p, %lu\n", \
+				(_cxt)->header.name, (_chunk), (unsigned long)(_chunk)->size)
+#else
+#define ArenaAllocInfo(_cxt, _chunk)
+#endif
+
+
+/*
+ * ArenaChargeBlock
+ *		Charge the block to the active memory account, unless it is
+ *		charged already.
+ */
+static inline void
+ArenaChargeBlock(ArenaContext *arena, ArenaBlock block)
+{
+	if (block->memoryAccount == NULL && ActiveMemoryAccount != NULL)
+	{
+		block->memoryAccount = ActiveMemoryAccount;
+		block->memoryAccountGeneration = MemoryAccountingCurrentGeneration;
+		MemoryAccounting_Allocate(ActiveMemoryAccount, (MemoryContext) arena,
+								  block->endptr - (char *) block);
+	}
+}
+
+/*
+ * ArenaNewBlock
+ *		Obtain a block with room for a chunk of chunk_size bytes.
+ *
+ * A chunk too large for the next regular block gets a block of its own,
+ * which is linked behind the active block so that the space remaining in
+ * the active block isn't lost.
+ */
+static ArenaBlock
+ArenaNewBlock(ArenaContext *arena, Size chunk_size)
+{
+	ArenaBlock	block;
+	Size		required = chunk_size + ARENA_BLOCKHDRSZ + ARENA_CHUNKHDRSZ;
+	Size		blksize;
+	bool		dedicated = false;
+
+	blksize = arena->nextBlockSize;
+	if (required > blksize / 4)
+	{
+		/* a quarter of the block at most, or the active block is cut short */
+		blksize = required;
+		dedicated = true;
+	}
+	else
+	{
+		arena->nextBlockSize <<= 1;
+		if (arena->nextBlockSize > arena->maxBlockSize)
+			arena->nextBlockSize = arena->maxBlockSize;
+	}
+
+	block = (ArenaBlock) gp_malloc(blksize);
+	if (block == NULL)
+		MemoryContextError(ERRCODE_OUT_OF_MEMORY,
+						   &arena->header, CDB_MCXT_WHERE(&arena->header),
+						   "Out of memory.  Failed on request of size %lu bytes.",
+						   (unsigned long) chunk_size);
+
+	block->freeptr = ((char *) block) + ARENA_BLOCKHDRSZ;
+	block->endptr = ((char *) block) + blksize;
+	block->memoryAccount = NULL;
+	block->memoryAccountGeneration = 0;
+
+	if (dedicated && arena->blocks != NULL)
+	{
+		block->next = arena->blocks->next;
+		arena->blocks->next = block;
+	}
+	else
+	{
+		block->next = arena->blocks;
+		arena->blocks = block;
+	}
+
+	/* the first regular block becomes the keeper */
+	if (!dedicated && arena->keeper == NULL)
+		arena->keeper = block;
+
+	MemoryContextNoteAlloc(&arena->header, blksize);
+	ArenaChargeBlock(arena, block);
+
+	return block;
+}
+
+
+/*
+ * Public routines
+ */
+
+
+/*
+ * ArenaContextCreate
+ *		Create a new Arena context.
+ *
+ * parent: parent context, or NULL if top-level context
+ * name: name of context (for debugging --- string will be copied)
+ * initBlockSize: initial allocation block size, also that of the keeper
+ * maxBlockSize: maximum allocation block size
+ *
+ * The keeper block is obtained on first use rather than right away, so
+ * creating a context that is never used costs nothing but the node.
+ */
+MemoryContext
+ArenaContextCreate(MemoryContext parent,
+				   const char *name,
+				   Size initBlockSize,
+				   Size maxBlockSize)
+{
+	ArenaContext *arena;
+
+	/* Do the type-independent part of context creation */
+	arena = (ArenaContext *) MemoryContextCreate(T_ArenaContext,
+												 sizeof(ArenaContext),
+												 &ArenaMethods,
+												 parent,
+												 name);
+
+	/*
+	 * Make sure alloc parameters are reasonable, and save them.
+	 *
+	 * We somewhat arbitrarily enforce a minimum 1K block size.
+	 */
+	initBlockSize = MAXALIGN(initBlockSize);
+	if (initBlockSize < 1024)
+		initBlockSize = 1024;
+	maxBlockSize = MAXALIGN(maxBlockSize);
+	if (maxBlockSize < initBlockSize)
+		maxBlockSize = initBlockSize;
+	arena->initBlockSize = initBlockSize;
+	arena->maxBlockSize = maxBlockSize;
+	arena->nextBlockSize = initBlockSize;
+
+	arena->sharedHeader.context = (MemoryContext) arena;
+	arena->sharedHeader.memoryAccount = NULL;
+	arena->sharedHeader.memoryAccountGeneration = MemoryAccountingCurrentGeneration;
+
+	arena->isReset = true;
+
+	return (MemoryContext) arena;
+}
+
+/*
+ * ArenaInit
+ *		Context-type-specific initialization routine.
+ *
+ * This is called by MemoryContextCreate() after setting up the
+ * generic MemoryContext fields and before linking the new context
+ * into the context tree.  We must do whatever is needed to make the
+ * new context minimally valid for deletion.  We must *not* risk
+ * failure --- thus, for example, allocating more memory is not cool.
+ */
+static void
+ArenaInit(MemoryContext context)
+{
+	/*
+	 * Since MemoryContextCreate already zeroed the context node, we don't
+	 * have to do anything here: it's already OK.
+	 */
+}
+
+/*
+ * ArenaReleaseAccounting
+ *		Release the accounting of all blocks, without freeing them.
+ *
+ * This is called by ArenaReset() and ArenaDelete(), and may be called
+ * several times in a row: a block is released only once.
+ */
+static void
+ArenaReleaseAccounting(MemoryContext context)
+{
+	ArenaContext *arena = (ArenaContext *) context;
+	ArenaBlock	block;
+
+	for (block = arena->blocks; block != NULL; block = block->next)
+	{
+		if (block->memoryAccount != NULL)
+		{
+			MemoryAccounting_Free(block->memoryAccount,
+								  block->memoryAccountGeneration, context,
+								  block->endptr - (char *) block);
+			block->memoryAccount = NULL;
+		}
+	}
+}
+
+/*
+ * ArenaUpdateGeneration
+ *		Move the accounting of all blocks to the RolloverMemoryAccount in
+ *		the current generation.
+ */
+static void
+ArenaUpdateGeneration(MemoryContext context)
+{
+	ArenaContext *arena = (ArenaContext *) context;
+	ArenaBlock	block;
+
+	for (block = arena->blocks; block != NULL; block = block->next)
+	{
+		if (block->memoryAccount != NULL)
+		{
+			block->memoryAccount = RolloverMemoryAccount;
+			block->memoryAccountGeneration = MemoryAccountingCurrentGeneration;
+		}
+	}
+
+	arena->sharedHeader.memoryAccountGeneration = MemoryAccountingCurrentGeneration;
+}
+
+/*
+ * ArenaReset
+ *		Frees all memory which is allocated in the given arena.
+ *
+ * The keeper block is kept and rewound, so a context which is reset after
+ * each tuple doesn't go back to malloc() as long as a tuple's memory fits
+ * there.  The keeper is the first regular block the arena obtained.
+ */
+static void
+ArenaReset(MemoryContext context)
+{
+	ArenaContext *arena = (ArenaContext *) context;
+	ArenaBlock	block;
+
+	Assert(IsA(arena, ArenaContext));
+
+	/* Nothing to do if no pallocs since startup or last reset */
+	if (arena->isReset)
+		return;
+
+#ifdef MEMORY_CONTEXT_CHECKING
+	/* Check for corruption before freeing */
+	ArenaCheck(context);
+#endif
+
+	ArenaReleaseAccounting(context);
+
+	block = arena->blocks;
+	arena->blocks = arena->keeper;
+
+	while (block != NULL)
+	{
+		ArenaBlock	next = block->next;
+
+		if (block == arena->keeper)
+		{
+			char	   *datastart = ((char *) block) + ARENA_BLOCKHDRSZ;
+
+#ifdef CLOBBER_FREED_MEMORY
+			/* Wipe freed memory for debugging purposes */
+			memset(datastart, 0x7F, block->freeptr - datastart);
+#endif
+			block->freeptr = datastart;
+			block->next = NULL;
+		}
+		else
+		{
+			size_t		freesz = block->endptr - (char *) block;
+
+			MemoryContextNoteFree(&arena->header, freesz);
+
+#ifdef CLOBBER_FREED_MEMORY
+			/* Wipe freed memory for debugging purposes */
+			memset(block, 0x7F, block->freeptr - ((char *) block));
+#endif
+			gp_free2(block, freesz);
+		}
+		block = next;
+	}
+
+	/* Reset block size allocation sequence, too */
+	arena->nextBlockSize = arena->initBlockSize;
+	arena->nchunks = 0;
+	arena->isReset = true;
+}
+
+/*
+ * ArenaDelete
+ *		Frees all memory which is allocated in the given arena,
+ *		in preparation for deletion of the arena.
+ *
+ * Unlike ArenaReset, this *must* free all resources of the arena.
+ * But note we are not responsible for deleting the context node itself.
+ */
+static void
+ArenaDelete(MemoryContext context)
+{
+	ArenaContext *arena = (ArenaContext *) context;
+	ArenaBlock	block = arena->blocks;
+
+	Assert(IsA(arena, ArenaContext));
+
+	ArenaReleaseAccounting(context);
+
+	arena->blocks = NULL;
+	arena->keeper = NULL;
+
+	while (block != NULL)
+	{
+		ArenaBlock	next = block->next;
+		size_t		freesz = block->endptr - (char *) block;
+
+		MemoryContextNoteFree(&arena->header, freesz);
+
+#ifdef CLOBBER_FREED_MEMORY
+		/* Wipe freed memory for debugging purposes */
+		memset(block, 0x7F, block->freeptr - ((char *) block));
+#endif
+		gp_free2(block, freesz);
+		block = next;
+	}
+
+	arena->nchunks = 0;
+	arena->isReset = true;
+}
+
+/*
+ * ArenaAlloc
+ *		Returns pointer to allocated memory of given size; memory is added
+ *		to the arena.
+ */
+static void *
+ArenaAlloc(MemoryContext context, Size size)
+{
+	ArenaContext *arena = (ArenaContext *) context;
+	ArenaBlock	block = arena->blocks;
+	ArenaChunk	chunk;
+	Size		chunk_size = MAXALIGN(size);
+
+	Assert(IsA(arena, ArenaContext));
+
+	/* the keeper is not charged while it is rewound */
+	if (arena->isReset && block != NULL)
+		ArenaChargeBlock(arena, block);
+
+	if (block == NULL ||
+		(Size) (block->endptr - block->freeptr) < chunk_size + ARENA_CHUNKHDRSZ)
+		block = ArenaNewBlock(arena, chunk_size);
+
+	chunk = (ArenaChunk) block->freeptr;
+	block->freeptr += chunk_size + ARENA_CHUNKHDRSZ;
+	Assert(block->freeptr <= block->endptr);
+
+	chunk->sharedHeader = &arena->sharedHeader;
+	chunk->size = chunk_size;
+#ifdef MEMORY_CONTEXT_CHECKING
+	chunk->requested_size = size;
+	/* set mark to catch clobber of "unused" space */
+	if (size < chunk_size)
+		((char *) ArenaChunkGetPointer(chunk))[size] = 0x7E;
+#endif
+#ifdef CDB_PALLOC_TAGS
+	chunk->prev_chunk = NULL;
+	chunk->next_chunk = NULL;
+#endif
+
+	arena->nchunks++;
+	arena->isReset = false;
+
+	ArenaAllocInfo(arena, chunk);
+	return ArenaChunkGetPointer(chunk);
+}
+
+/*
+ * ArenaFree
+ *		The space of a chunk is not reclaimed before the arena is reset.
+ */
+static void
+ArenaFree(MemoryContext context, void *pointer)
+{
+#ifdef MEMORY_CONTEXT_CHECKING
+	ArenaChunk	chunk = ArenaPointerGetChunk(pointer);
+
+	/* Test for someone scribbling on unused space in chunk */
+	if (chunk->requested_size < chunk->size)
+		if (((char *) pointer)[chunk->requested_size] != 0x7E)
+			elog(WARNING, "detected write past chunk end in %s %p",
+				 context->name, chunk);
+#endif
+}
+
+/*
+ * ArenaRealloc
+ *		Returns new pointer to allocated memory of given size; this memory
+ *		is added to the arena.  Memory associated with given pointer is
+ *		copied into the new memory.
+ *
+ * The last chunk of the active block is grown in place, which makes
+ * repeatedly enlarged buffers, such as a StringInfo, cheap.
+ */
+static void *
+ArenaRealloc(MemoryContext context, void *pointer, Size size)
+{
+	ArenaContext *arena = (ArenaContext *) context;
+	ArenaChunk	chunk = ArenaPointerGetChunk(pointer);
+	ArenaBlock	block = arena->blocks;
+	Size		oldsize = chunk->size;
+	Size		chunk_size = MAXALIGN(size);
+	void	   *newPointer;
+
+	Assert(IsA(arena, ArenaContext));
+
+	if (chunk_size <= oldsize ||
+		((char *) pointer + oldsize == block->freeptr &&
+		 (Size) (block->endptr - (char *) pointer) >= chunk_size))
+	{
+		if (chunk_size > oldsize)
+		{
+			block->freeptr = (char *) pointer + chunk_size;
+			chunk->size = chunk_size;
+		}
+#ifdef MEMORY_CONTEXT_CHECKING
+		chunk->requested_size = size;
+		/* set mark to catch clobber of "unused" space */
+		if (size < chunk->size)
+			((char *) pointer)[size] = 0x7E;
+#endif
+		return pointer;
+	}
+
+	newPointer = ArenaAlloc(context, size);
+	memcpy(newPointer, pointer, oldsize);
+
+	return newPointer;
+}
+
+/*
+ * ArenaGetChunkSpace
+ *		Given a currently-allocated chunk, determine the total space
+ *		it occupies (including all memory-allocation overhead).
+ */
+static Size
+ArenaGetChunkSpace(MemoryContext context, void *pointer)
+{
+	ArenaChunk	chunk = ArenaPointerGetChunk(pointer);
+
+	return chunk->size + ARENA_CHUNKHDRSZ;
+}
+
+/*
+ * ArenaIsEmpty
+ *		Is an arena empty of any allocated space?
+ */
+static bool
+ArenaIsEmpty(MemoryContext context)
+{
+	ArenaContext *arena = (ArenaContext *) context;
+
+	return arena->isReset;
+}
+
+/*
+ * ArenaStats
+ *		Returns stats about memory consumption of an ArenaContext.
+ *
+ *	Input parameters:
+ *		context: the context of interest
+ *
+ *	Output parameters:
+ *		nBlocks: number of blocks in the context
+ *		nChunks: number of chunks allocated since the last reset
+ *
+ *		currentAvailable: free space across all blocks
+ *
+ *		allAllocated: total bytes allocated during lifetime
+ *		allFreed: total bytes that was freed during lifetime
+ *		maxHeld: maximum bytes held during lifetime
+ */
+static void
+ArenaStats(MemoryContext context, uint64 *nBlocks, uint64 *nChunks,
+		uint64 *currentAvailable, uint64 *allAllocated, uint64 *allFreed, uint64 *maxHeld)
+{
+	ArenaContext *arena = (ArenaContext *) context;
+	ArenaBlock	block;
+
+	Assert(IsA(arena, ArenaContext));
+
+	*nBlocks = 0;
+	*currentAvailable = 0;
+	for (block = arena->blocks; block != NULL; block = block->next)
+	{
+		(*nBlocks)++;
+		*currentAvailable += block->endptr - block->freeptr;
+	}
+
+	*nChunks = arena->nchunks;
+	*allAllocated = arena->header.allBytesAlloc;
+	*allFreed = arena->header.allBytesFreed;
+	*maxHeld = arena->header.maxBytesHeld;
+}
+
+
+#ifdef MEMORY_CONTEXT_CHECKING
+/*
+ * ArenaCheck
+ *		Walk through chunks and check consistency of memory.
+ *
+ * NOTE: report errors as WARNING, *not* ERROR or FATAL.  Otherwise you'll
+ * find yourself in an infinite loop when trouble occurs, because this
+ * routine will be entered again when elog cleanup tries to release memory!
+ */
+static void
+ArenaCheck(MemoryContext context)
+{
+	ArenaContext *arena = (ArenaContext *) context;
+	const char *name = arena->header.name;
+	ArenaBlock	block;
+
+	for (block = arena->blocks; block != NULL; block = block->next)
+	{
+		char	   *bpoz = ((char *) block) + ARENA_BLOCKHDRSZ;
+
+		if (block->freeptr < bpoz || block->freeptr > block->endptr)
+		{
+			elog(WARNING, "problem in arena %s: corrupt header in block %p",
+				 name, block);
+			continue;
+		}
+
+		while (bpoz < block->freeptr)
+		{
+			ArenaChunk	chunk = (ArenaChunk) bpoz;
+
+			if (chunk->sharedHeader != &arena->sharedHeader)
+			{
+				elog(WARNING, "problem in arena %s: bogus sharedHeader in block %p, chunk %p",
+					 name, block, chunk);
+				break;
+			}
+
+			if (chunk->requested_size > chunk->size ||
+				bpoz + ARENA_CHUNKHDRSZ + chunk->size > block->freeptr)
+			{
+				elog(WARNING, "problem in arena %s: bogus size in block %p, chunk %p",
+					 name, block, chunk);
+				break;
+			}
+
+			if (chunk->requested_size < chunk->size &&
+				((char *) ArenaChunkGetPointer(chunk))[chunk->requested_size] != 0x7E)
+				elog(WARNING, "problem in arena %s: detected write past chunk end in block %p, chunk %p",
+					 name, block, chunk);
+
+			bpoz += ARENA_CHUNKHDRSZ + chunk->size;
+		}
+	}
+}
+#endif   /* MEMORY_CONTEXT_CHECKING */
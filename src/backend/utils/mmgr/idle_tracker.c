@@ -190,6 +190,12 @@ IdleTracker_DeactivateProcess()
 		Assert(0 <= MySessionState->activeProcessCount);
 		isProcessActive = false;
 
+		/* The session is idle; its next command may be asked to spill afresh */
+		if (0 == MySessionState->activeProcessCount)
+		{
+			MySessionState->sessionVmemSpill = 0;
+		}
+
 		/* Save the point where we reduced the activeProcessCount */
 		deactivationVersion = *CurrentVersion;
 		/*
@@ -96,6 +96,11 @@ MemoryContext MemoryAccountMemoryContext = NULL;
 MemoryContext QueryContext = NULL;
 MemoryContext PortalContext = NULL;
 
+/* Allocations left until the next one is sampled by gp_memory_alloc_sample_interval */
+static int allocationsUntilSample = 0;
+/* True while a sample is logged, so its own allocations are not sampled */
+static bool samplingAllocation = false;
+
 
 /*****************************************************************************
  *	  EXPORTED ROUTINES														 *
@@ -934,6 +939,18 @@ MemoryContextContainsGenericAllocation(MemoryContext context, void *pointer)
 	header = (StandardChunkHeader *)
 		((char *) pointer - STANDARDCHUNKHEADERSIZE);
 
+	/* All the chunks of an ArenaContext share the same sharedHeader */
+	if (IsA(context, ArenaContext))
+	{
+		return header->sharedHeader == &((ArenaContext *) context)->sharedHeader;
+	}
+
+	/* So do all the chunks of a SlabContext */
+	if (IsA(context, SlabContext))
+	{
+		return header->sharedHeader == &((SlabContext *) context)->sharedHeader;
+	}
+
 	AllocSet set = (AllocSet)context;
 
 	if (header->sharedHeader == set->sharedHeaderList ||
@@ -1060,6 +1077,41 @@ MemoryContextCreate(NodeTag tag, Size size,
 	return node;
 }
 
+/*
+ * MemoryContextSampleAllocation
+ *		Logs every gp_memory_alloc_sample_interval-th allocation with its
+ *		call site, memory account and stack, to find allocation hot spots.
+ *
+ * Nothing is logged for allocations made while logging, in a critical
+ * section or in ErrorContext, all of which the error machinery needs for
+ * itself.
+ */
+static void
+MemoryContextSampleAllocation(MemoryContext context, Size size,
+		const char *sfile, const char *sfunc, int sline)
+{
+	if (--allocationsUntilSample > 0)
+		return;
+
+	allocationsUntilSample = gp_memory_alloc_sample_interval;
+
+	if (samplingAllocation || CritSectionCount > 0 ||
+		context == ErrorContext || ErrorContext == NULL)
+		return;
+
+	samplingAllocation = true;
+
+	ereport(LOG,
+			(errmsg("sampled allocation of %lu bytes in memory context \"%s\" charged to %s at %s:%d (%s)",
+					(unsigned long) size, context->name,
+					ActiveMemoryAccount != NULL ?
+						MemoryAccounting_GetAccountName(ActiveMemoryAccount) : "no account",
+					sfile, sline, sfunc),
+			 errprintstack(true)));
+
+	samplingAllocation = false;
+}
+
 /*
  * MemoryContextAlloc
  *		Allocate space within the specified context.
@@ -1089,6 +1141,10 @@ MemoryContextAllocImpl(MemoryContext context, Size size, const char* sfile, cons
 				(unsigned long)size);
 
 	ret = (*context->methods.alloc) (context, size);
+
+	if (gp_memory_alloc_sample_interval > 0)
+		MemoryContextSampleAllocation(context, size, sfile, sfunc, sline);
+
 #ifdef PGTRACE_ENABLED
 	header = (StandardChunkHeader *)
 		((char *) ret - STANDARDCHUNKHEADERSIZE);
@@ -1130,6 +1186,9 @@ MemoryContextAllocZeroImpl(MemoryContext context, Size size, const char* sfile,
 
 	MemSetAligned(ret, 0, size);
 
+	if (gp_memory_alloc_sample_interval > 0)
+		MemoryContextSampleAllocation(context, size, sfile, sfunc, sline);
+
 #ifdef PGTRACE_ENABLED
 	header = (StandardChunkHeader *)
 		((char *) ret - STANDARDCHUNKHEADERSIZE);
@@ -1172,6 +1231,9 @@ MemoryContextAllocZeroAlignedImpl(MemoryContext context, Size size, const char*
 
 	MemSetLoop(ret, 0, size);
 
+	if (gp_memory_alloc_sample_interval > 0)
+		MemoryContextSampleAllocation(context, size, sfile, sfunc, sline);
+
 #ifdef PGTRACE_ENABLED
 	header = (StandardChunkHeader *)
 		((char *) ret - STANDARDCHUNKHEADERSIZE);
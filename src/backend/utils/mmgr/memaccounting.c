@@ -28,6 +28,10 @@
 #include "cdb/cdbvars.h"
 #include "access/xact.h"
 #include "miscadmin.h"
+#include "storage/backendid.h"
+#include "storage/ipc.h"
+#include "storage/shmem.h"
+#include "utils/memaccounting_snapshot.h"
 #include "utils/vmem_tracker.h"
 
 #define MEMORY_REPORT_FILE_NAME_LENGTH 255
@@ -119,6 +123,16 @@ MemoryAccountToLog(MemoryAccount *memoryAccount, void *context,
 static void
 SaveMemoryBufToDisk(struct StringInfoData *memoryBuf, char *prefix);
 
+static CdbVisitOpt
+MemoryAccountToSnapshot(MemoryAccount *memoryAccount, void *context,
+		uint32 depth, uint32 parentWalkSerial, uint32 curWalkSerial);
+
+static void
+ClearMemoryAccountSnapshot(void);
+
+static void
+MemoryAccountSnapshotShmemExit(int code, Datum arg);
+
 /*****************************************************************************
  * Global memory accounting variables
  */
@@ -185,6 +199,19 @@ uint64 MemoryAccountingPeakBalance = 0;
  */
 uint16 MemoryAccountingCurrentGeneration = 0;
 
+/*
+ * Published memory account trees, one slot per backend, indexed by
+ * MyBackendId - 1
+ */
+static MemoryAccountSnapshot *MemoryAccountSnapshots = NULL;
+int MemoryAccountSnapshotCount = 0;
+
+/* This process's slot in MemoryAccountSnapshots, once it published anything */
+static MemoryAccountSnapshot *MyMemoryAccountSnapshot = NULL;
+
+/* When this process last published its memory account tree */
+static TimestampTz lastMemoryAccountPublishTime = 0;
+
 /******************************************/
 /********** Public interface **************/
 
@@ -219,6 +246,10 @@ MemoryAccounting_Reset()
 		MemoryAccounting_ResetPeakBalance();
 	}
 
+	/* The published tree is gone, and the next one should be out promptly */
+	ClearMemoryAccountSnapshot();
+	lastMemoryAccountPublishTime = 0;
+
 	InitMemoryAccounting();
 }
 
@@ -657,6 +688,140 @@ MemoryAccounting_SaveToLog()
 	return totalWalked;
 }
 
+/*
+ * MemoryAccounting_ShmemSize
+ *		Returns the size of the shared memory for the published memory
+ *		account trees
+ */
+Size
+MemoryAccounting_ShmemSize()
+{
+	return mul_size(sizeof(MemoryAccountSnapshot), MaxBackends);
+}
+
+/*
+ * MemoryAccounting_ShmemInit
+ *		Allocates the shared memory slots for the published memory account
+ *		trees
+ */
+void
+MemoryAccounting_ShmemInit()
+{
+	bool found = false;
+	Size size = MemoryAccounting_ShmemSize();
+
+	MemoryAccountSnapshots = (MemoryAccountSnapshot *)
+			ShmemInitStruct("Memory Account Snapshots", size, &found);
+
+	Assert(found || !IsUnderPostmaster);
+
+	if (!found)
+	{
+		MemSet(MemoryAccountSnapshots, 0, size);
+	}
+
+	MemoryAccountSnapshotCount = MaxBackends;
+}
+
+/*
+ * MemoryAccounting_PublishSnapshot
+ *		Copies the current memory accounting tree into this process's shared
+ *		memory slot, so that other sessions can see who owns how much memory
+ *		while the query is still running. Does nothing if the last copy is
+ *		younger than gp_memory_account_publish_interval.
+ *
+ * This is called while reserving vmem, i.e., in the middle of an allocation,
+ * so it must neither allocate nor error out.
+ */
+void
+MemoryAccounting_PublishSnapshot()
+{
+	if (gp_memory_account_publish_interval <= 0 || NULL == MemoryAccountSnapshots ||
+			NULL == MemoryAccountTreeLogicalRoot ||
+			MyBackendId < 1 || MyBackendId > MemoryAccountSnapshotCount)
+	{
+		return;
+	}
+
+	TimestampTz now = GetCurrentTimestamp();
+
+	if (!TimestampDifferenceExceeds(lastMemoryAccountPublishTime, now,
+			gp_memory_account_publish_interval))
+	{
+		return;
+	}
+
+	lastMemoryAccountPublishTime = now;
+
+	if (NULL == MyMemoryAccountSnapshot)
+	{
+		MyMemoryAccountSnapshot = &MemoryAccountSnapshots[MyBackendId - 1];
+		on_shmem_exit(MemoryAccountSnapshotShmemExit, 0);
+	}
+
+	volatile MemoryAccountSnapshot *snapshot = MyMemoryAccountSnapshot;
+
+	/* Readers retry while the change count is odd */
+	snapshot->changeCount++;
+
+	snapshot->pid = MyProcPid;
+	snapshot->sessionId = gp_session_id;
+	snapshot->commandCount = gp_command_count;
+	snapshot->segindex = GpIdentity.segindex;
+	snapshot->sliceId = currentSliceId;
+	snapshot->publishTime = now;
+	snapshot->vmemReserved = VmemTracker_GetReservedVmemBytes();
+	snapshot->peakBalance = MemoryAccountingPeakBalance;
+	snapshot->nentries = 0;
+
+	uint32 totalWalked = 0;
+	MemoryAccountWalkNode(MemoryAccountTreeLogicalRoot, MemoryAccountToSnapshot,
+			(MemoryAccountSnapshot *) snapshot, 0, &totalWalked, totalWalked);
+	snapshot->totalAccounts = totalWalked;
+
+	snapshot->changeCount++;
+	Assert((snapshot->changeCount & 1) == 0);
+}
+
+/*
+ * MemoryAccounting_ReadSnapshot
+ *		Copies the published memory account tree of a slot.
+ *
+ * slot: index of the slot, between 0 and MemoryAccountSnapshotCount - 1
+ * copy: where to copy the snapshot
+ *
+ * Returns false if the slot holds no published tree.
+ */
+bool
+MemoryAccounting_ReadSnapshot(int slot, MemoryAccountSnapshot *copy)
+{
+	Assert(slot >= 0 && slot < MemoryAccountSnapshotCount);
+
+	volatile MemoryAccountSnapshot *snapshot = &MemoryAccountSnapshots[slot];
+
+	/*
+	 * Follow the owner's change count protocol to get a consistent copy,
+	 * as pgstat_read_current_status() does for the backend status entries.
+	 */
+	for (;;)
+	{
+		uint32 saveChangeCount = snapshot->changeCount;
+
+		memcpy(copy, (MemoryAccountSnapshot *) snapshot, sizeof(MemoryAccountSnapshot));
+
+		if (saveChangeCount == snapshot->changeCount &&
+				(saveChangeCount & 1) == 0)
+		{
+			break;
+		}
+
+		/* Make sure we can break out of loop if stuck... */
+		CHECK_FOR_INTERRUPTS();
+	}
+
+	return copy->pid != 0;
+}
+
 /*****************************************************************************
  *	  PRIVATE ROUTINES FOR MEMORY ACCOUNTING								 *
  *****************************************************************************/
@@ -674,6 +839,7 @@ static void
 InitializeMemoryAccount(MemoryAccount *newAccount, long maxLimit, MemoryOwnerType ownerType, MemoryAccount *parentAccount)
 {
 	newAccount->ownerType = ownerType;
+	newAccount->planNodeId = -1;
 
 	/*
 	 * Maximum targeted allocation for an owner. Peak usage can be
@@ -998,6 +1164,77 @@ SerializeMemoryAccount(MemoryAccount *memoryAccount, void *context, uint32 depth
     return CdbVisit_Walk;
 }
 
+/**
+ * MemoryAccountToSnapshot:
+ * 		A visitor function that copies a memory account into the shared memory
+ * 		snapshot of this process. Called from the walker to publish the whole
+ * 		tree. Accounts beyond MEMORY_ACCOUNT_SNAPSHOT_MAX_ENTRIES are only
+ * 		counted.
+ *
+ * memoryAccount: The memory account to publish
+ * context: The MemoryAccountSnapshot to fill
+ * depth: The depth in the tree for current node. Not used.
+ * parentWalkSerial: parent node's "walk serial"
+ * curWalkSerial: current node's "walk serial"
+ */
+static CdbVisitOpt
+MemoryAccountToSnapshot(MemoryAccount *memoryAccount, void *context, uint32 depth,
+		uint32 parentWalkSerial, uint32 curWalkSerial)
+{
+	if (memoryAccount == NULL) return CdbVisit_Walk;
+
+	MemoryAccountSnapshot *snapshot = (MemoryAccountSnapshot *) context;
+
+	if (snapshot->nentries < MEMORY_ACCOUNT_SNAPSHOT_MAX_ENTRIES)
+	{
+		MemoryAccountSnapshotEntry *entry = &snapshot->entries[snapshot->nentries];
+
+		entry->ownerType = memoryAccount->ownerType;
+		entry->planNodeId = memoryAccount->planNodeId;
+		entry->parentSerial = parentWalkSerial;
+		entry->quota = memoryAccount->maxLimit;
+		entry->peak = memoryAccount->peak;
+		entry->balance = memoryAccount->allocated - memoryAccount->freed;
+
+		snapshot->nentries++;
+	}
+
+	return CdbVisit_Walk;
+}
+
+/*
+ * ClearMemoryAccountSnapshot
+ *		Empties this process's published memory account tree, if any
+ */
+static void
+ClearMemoryAccountSnapshot()
+{
+	volatile MemoryAccountSnapshot *snapshot = MyMemoryAccountSnapshot;
+
+	if (NULL == snapshot)
+	{
+		return;
+	}
+
+	snapshot->changeCount++;
+	snapshot->pid = 0;
+	snapshot->nentries = 0;
+	snapshot->totalAccounts = 0;
+	snapshot->changeCount++;
+}
+
+/*
+ * MemoryAccountSnapshotShmemExit
+ *		Process exit callback to leave the snapshot slot empty for the next
+ *		backend using it
+ */
+static void
+MemoryAccountSnapshotShmemExit(int code, Datum arg)
+{
+	ClearMemoryAccountSnapshot();
+	MyMemoryAccountSnapshot = NULL;
+}
+
 /*
  * InitMemoryAccounting
  *		Internal method that should only be used to initialize a memory accounting
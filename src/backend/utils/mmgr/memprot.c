@@ -32,6 +32,7 @@
 #include <unistd.h>
 #include <sys/file.h>
 #include <sys/time.h>
+#include <sys/mman.h>
 
 #ifdef HAVE_SYS_IPC_H
 #include <sys/ipc.h>
@@ -341,6 +342,36 @@ static void gp_failed_to_alloc(MemoryAllocationStatus ec, int en, int sz)
 	}
 }
 
+/*
+ * Transparent huge pages come in 2MB; only the fully covered, aligned
+ * part of a block can be backed by them.
+ */
+#define HUGE_PAGE_ALIGN		(2 * 1024 * 1024)
+
+/*
+ * Advises the kernel to back a large block with transparent huge pages,
+ * which cuts TLB misses when hash tables and sort arrays are probed at
+ * random.  This is only a hint: the kernel ignores it if THP is disabled.
+ */
+static void
+gp_advise_huge_pages(void *ptr, int64 sz)
+{
+#ifdef MADV_HUGEPAGE
+	uintptr_t	start;
+	uintptr_t	end;
+
+	if (ptr == NULL || gp_huge_page_alloc_threshold <= 0 ||
+		sz < ((int64) gp_huge_page_alloc_threshold) * 1024L)
+		return;
+
+	start = TYPEALIGN(HUGE_PAGE_ALIGN, (uintptr_t) ptr);
+	end = TYPEALIGN_DOWN(HUGE_PAGE_ALIGN, (uintptr_t) ptr + sz);
+
+	if (start < end)
+		(void) madvise((void *) start, end - start, MADV_HUGEPAGE);
+#endif
+}
+
 /* Reserves vmem from vmem tracker and allocates memory by calling malloc/calloc */
 static void *gp_malloc_internal(int64 sz1, int64 sz2, bool ismalloc)
 {
@@ -402,10 +433,14 @@ void *gp_malloc(int64 sz)
 
 	if(gp_mp_inited)
 	{
-		return gp_malloc_internal(sz, 0, true);
+		ret = gp_malloc_internal(sz, 0, true);
+	}
+	else
+	{
+		ret = malloc(sz);
 	}
 
-	ret = malloc(sz);
+	gp_advise_huge_pages(ret, sz);
 	return ret;
 }
 
@@ -433,6 +468,8 @@ void *gp_realloc(void *ptr, int64 sz, int64 newsz)
 	if(!gp_mp_inited)
 	{
 		ret = realloc(ptr, newsz);
+		if (newsz > sz)
+			gp_advise_huge_pages(ret, newsz);
 		return ret;
 	}
 
@@ -463,6 +500,8 @@ void *gp_realloc(void *ptr, int64 sz, int64 newsz)
 			return NULL;
 		}
 
+		if (newsz > sz)
+			gp_advise_huge_pages(ret, newsz);
 		return ret;
 	}
 
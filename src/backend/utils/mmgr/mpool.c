@@ -85,11 +85,16 @@ mpool_create(MemoryContext parent,
 	MPool *mpool = MemoryContextAlloc(parent, sizeof(MPool));
 	Assert(parent != NULL);
 	mpool->parent = parent;
-	mpool->context = AllocSetContextCreate(parent, 
-										   name,
-										   ALLOCSET_DEFAULT_MINSIZE,
-										   ALLOCSET_DEFAULT_INITSIZE,
-										   ALLOCSET_DEFAULT_MAXSIZE);
+
+	/*
+	 * The pool never frees its blocks one by one, so obtain them from an
+	 * arena: it has no freelists to keep, and a reset keeps the first block.
+	 * Arena blocks are made big enough to hold several pool blocks each.
+	 */
+	mpool->context = ArenaContextCreate(parent,
+										name,
+										16 * MPOOL_BLOCK_SIZE,
+										ALLOCSET_DEFAULT_MAXSIZE);
 	mpool_init(mpool);
 
 	return mpool;
@@ -50,6 +50,9 @@ extern int32 VmemTracker_ConvertVmemMBToChunks(int mb);
 /* The runaway detector activates if the used vmem exceeds this percentage of the vmem quota */
 int	runaway_detector_activation_percent = 95;
 
+/* A runaway session is first asked to spill, and is only canceled if that didn't help */
+bool gp_runaway_spill_first = true;
+
 /* The last number of chunks for segment vmem quota */
 static int lastSegmentVmemQuotaChunks = -1;
 
@@ -275,6 +278,19 @@ RedZoneHandler_FlagTopConsumer()
 
 			/* Save the command count currently running in the runaway session */
 			maxActiveVmemSessionState->commandCountRunaway = gp_command_count;
+
+			/*
+			 * Ask the session to spill rather than cancel it, unless it was
+			 * asked before and still holds as much vmem as it did back then.
+			 */
+			maxActiveVmemSessionState->runawaySpill = gp_runaway_spill_first &&
+					(0 == maxActiveVmemSessionState->sessionVmemSpill ||
+					 maxActiveVmemSessionState->sessionVmem < maxActiveVmemSessionState->sessionVmemSpill);
+
+			if (maxActiveVmemSessionState->runawaySpill)
+			{
+				maxActiveVmemSessionState->sessionVmemSpill = maxActiveVmemSessionState->sessionVmem;
+			}
 		}
 		else
 		{
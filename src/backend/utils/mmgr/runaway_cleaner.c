@@ -27,6 +27,10 @@
  *	 cleanup is finished, the runaway cleaner also informs the red zone handler
  *	 so that a new runaway session can be chosen if necessary.
  *
+ *	 If the red-zone handler decided to let the session spill, the runaway
+ *	 cleaner asks the operators of the process which can spill to release
+ *	 their memory instead of canceling the query.
+ *
  *-------------------------------------------------------------------------
  */
 
@@ -37,6 +41,8 @@
 #include "utils/session_state.h"
 #include "utils/faultinjector.h"
 #include "miscadmin.h"
+#include "access/xact.h"
+#include "utils/memutils.h"
 
 /* External dependencies within the runaway cleanup framework */
 extern bool vmemTrackerInited;
@@ -61,6 +67,18 @@ static EventVersion beginCleanupRunawayVersion = 0;
 /* The runaway version for which this process finished cleaning up */
 static EventVersion endCleanupRunawayVersion = 0;
 
+/* An operator of this process that can spill, see RunawaySpillCallback */
+typedef struct RunawaySpillCallbackItem
+{
+	struct RunawaySpillCallbackItem *next;
+	RunawaySpillCallback callback;
+	void *arg;
+	/* The subtransaction the operator was created in */
+	SubTransactionId subid;
+} RunawaySpillCallbackItem;
+
+static RunawaySpillCallbackItem *spillCallbacks = NULL;
+
 void RunawayCleaner_Init(void);
 void RunawayCleaner_StartCleanup(void);
 bool RunawayCleaner_IsCleanupInProgress(void);
@@ -109,9 +127,144 @@ RunawayCleaner_ShouldStartRunawayCleanup()
 
 	return false;
 }
+/*
+ * Registers an operator that can release memory by spilling when its session
+ * runs away. The operator must unregister before it is destroyed; on abort,
+ * the registrations of the aborted (sub)transaction are dropped.
+ */
+void
+RunawayCleaner_RegisterSpillCallback(RunawaySpillCallback callback, void *arg)
+{
+	RunawaySpillCallbackItem *item = (RunawaySpillCallbackItem *)
+			MemoryContextAlloc(TopMemoryContext, sizeof(RunawaySpillCallbackItem));
+
+	item->callback = callback;
+	item->arg = arg;
+	item->subid = GetCurrentSubTransactionId();
+	item->next = spillCallbacks;
+	spillCallbacks = item;
+}
+
+/*
+ * Unregisters an operator registered by RunawayCleaner_RegisterSpillCallback
+ */
+void
+RunawayCleaner_UnregisterSpillCallback(RunawaySpillCallback callback, void *arg)
+{
+	RunawaySpillCallbackItem *item = spillCallbacks;
+	RunawaySpillCallbackItem *prev = NULL;
+
+	while (NULL != item)
+	{
+		if (item->callback == callback && item->arg == arg)
+		{
+			if (NULL == prev)
+			{
+				spillCallbacks = item->next;
+			}
+			else
+			{
+				prev->next = item->next;
+			}
+
+			pfree(item);
+			return;
+		}
+
+		prev = item;
+		item = item->next;
+	}
+}
+
+/*
+ * Drops all spill callbacks at the end of a transaction. Operators of
+ * committed transactions have unregistered already, so this only matters
+ * after an abort, where the executor nodes are not shut down one by one.
+ */
+void
+AtEOXact_RunawaySpillCallbacks()
+{
+	while (NULL != spillCallbacks)
+	{
+		RunawaySpillCallbackItem *item = spillCallbacks;
+
+		spillCallbacks = item->next;
+		pfree(item);
+	}
+}
+
+/*
+ * At subtransaction commit, the spill callbacks are handed over to the
+ * parent. At subtransaction abort, they are dropped.
+ */
+void
+AtEOSubXact_RunawaySpillCallbacks(bool isCommit, SubTransactionId mySubid,
+								  SubTransactionId parentSubid)
+{
+	RunawaySpillCallbackItem *item = spillCallbacks;
+	RunawaySpillCallbackItem *prev = NULL;
+
+	while (NULL != item)
+	{
+		RunawaySpillCallbackItem *next = item->next;
+
+		if (item->subid == mySubid)
+		{
+			if (isCommit)
+			{
+				item->subid = parentSubid;
+			}
+			else
+			{
+				if (NULL == prev)
+				{
+					spillCallbacks = next;
+				}
+				else
+				{
+					prev->next = next;
+				}
+
+				pfree(item);
+				item = next;
+				continue;
+			}
+		}
+
+		prev = item;
+		item = next;
+	}
+}
+
+/*
+ * Asks all the operators of this process that can spill to do so.
+ * Returns the number of operators that agreed.
+ */
+static int
+RunawayCleaner_RequestSpill()
+{
+	RunawaySpillCallbackItem *item;
+	int spilling = 0;
+
+	for (item = spillCallbacks; NULL != item; item = item->next)
+	{
+		if (item->callback(item->arg))
+		{
+			spilling++;
+		}
+	}
+
+	return spilling;
+}
+
 /*
  * Starts a runaway cleanup by triggering an ERROR if the VMEM tracker is active
  * and a commit is not already in progress. Otherwise, it marks the process as clean
+ *
+ * If the red-zone handler chose to let the session spill for this runaway
+ * event, we ask the operators to spill and mark the process clean instead.
+ * The red-zone handler cancels the session at a later runaway event if the
+ * spilling didn't bring its vmem usage down.
  */
 void
 RunawayCleaner_StartCleanup()
@@ -139,6 +292,18 @@ RunawayCleaner_StartCleanup()
 			/* Super user is terminated only when it's the primary runaway consumer (i.e., the top consumer) */
 			(!superuser() || MySessionState->runawayStatus == RunawayStatus_PrimaryRunawaySession))
 		{
+			if (MySessionState->runawaySpill)
+			{
+				int spilling = RunawayCleaner_RequestSpill();
+
+				elog(LOG, "Asked %d operators to spill instead of canceling query because of high VMEM usage. Used: %dMB, available %dMB, red zone: %dMB",
+						spilling, VmemTracker_ConvertVmemChunksToMB(MySessionState->sessionVmem),
+						VmemTracker_GetAvailableVmemMB(), RedZoneHandler_GetRedZoneLimitMB());
+
+				RunawayCleaner_RunawayCleanupDoneForProcess(true /* ignoredCleanup */);
+				return;
+			}
+
 #ifdef FAULT_INJECTOR
 	FaultInjector_InjectFaultIfSet(
 			RunawayCleanup,
@@ -188,6 +353,7 @@ RunawayCleaner_RunawayCleanupDoneForSession()
 		MySessionState->runawayStatus = RunawayStatus_NotRunaway;
 		MySessionState->sessionVmemRunaway = 0;
 		MySessionState->commandCountRunaway = 0;
+		MySessionState->runawaySpill = false;
 
 		/*
 		 * Reset the exclusive runaway detector flag so that
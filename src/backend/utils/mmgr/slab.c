@@ -0,0 +1,746 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*-------------------------------------------------------------------------
+ *
+ * slab.c
+ *    A slab implementation of the abstract MemoryContext type, for
+ *    chunks of one fixed size that are allocated and freed one by one.
+ *
+ * A SlabContext carves its blocks into chunks of the size given at creation
+ * time.  A freed chunk goes onto the freelist of its own block, and chunks
+ * are handed out from blocks that are already in use before a new block is
+ * obtained, so that live chunks stay packed together.  A block whose chunks
+ * are all free is returned to malloc(), except for one, which is kept
+ * aside so that a context hovering around a block boundary doesn't go back
+ * to malloc() for every other chunk.
+ *
+ * The chunks start on a cache line boundary.  A chunk smaller than a cache
+ * line is padded to a power of 2, so that no chunk straddles two lines;
+ * larger chunks are padded to a multiple of the cache line size.
+ *
+ * Every chunk begins with a StandardChunkHeader, so that pfree(),
+ * repalloc() and GetMemoryChunkSpace() accept the chunks.  All chunks share
+ * the SharedChunkHeader embedded in the context, and are preceded by a
+ * pointer to their block.  repalloc() cannot grow a chunk beyond the chunk
+ * size of the context.  Memory accounting is done per block: a block is
+ * charged to the memory account active when it was obtained.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "utils/memutils.h"
+#include "utils/memaccounting.h"
+
+/* Define this to detail debug alloc information */
+/* #define HAVE_ALLOCINFO */
+
+#ifdef CDB_PALLOC_CALLER_ID
+#define CDB_MCXT_WHERE(context) (context)->callerFile, (context)->callerLine
+#else
+#define CDB_MCXT_WHERE(context) __FILE__, __LINE__
+#endif
+
+/* The chunks are aligned on this boundary */
+#define SLAB_CACHE_LINE_SIZE	64
+
+/*
+ * SlabBlock
+ *		A SlabBlock is the unit of memory that is obtained by slab.c from
+ *		malloc().  Its chunks are handed out from the freelist first, then
+ *		from unusedptr up.
+ */
+typedef struct SlabBlockData
+{
+	SlabBlock	prev;			/* previous block in its list */
+	SlabBlock	next;			/* next block in its list */
+	char	   *freehead;		/* first free chunk of the freelist */
+	char	   *unusedptr;		/* first chunk never handed out */
+	int			nfree;			/* number of free chunks in this block */
+
+	/* Which account is charged for this block, NULL if none */
+	struct MemoryAccount *memoryAccount;
+	uint16		memoryAccountGeneration;
+} SlabBlockData;
+
+#define SLAB_BLOCKHDRSZ		MAXALIGN(sizeof(SlabBlockData))
+#define SLAB_BLOCKPTRSZ		MAXALIGN(sizeof(SlabBlock))
+#define SLAB_CHUNKHDRSZ		(SLAB_BLOCKPTRSZ + STANDARDCHUNKHEADERSIZE)
+
+/* The first chunk of a block, on a cache line boundary */
+#define SlabBlockGetFirstChunk(block) \
+	((char *) TYPEALIGN(SLAB_CACHE_LINE_SIZE, ((char *) (block)) + SLAB_BLOCKHDRSZ))
+
+#define SlabChunkGetHeader(chk) \
+	((StandardChunkHeader *) (((char *) (chk)) + SLAB_BLOCKPTRSZ))
+#define SlabChunkGetPointer(chk) \
+	((void *) (((char *) (chk)) + SLAB_CHUNKHDRSZ))
+#define SlabPointerGetChunk(ptr) \
+	(((char *) (ptr)) - SLAB_CHUNKHDRSZ)
+#define SlabPointerGetHeader(ptr) \
+	((StandardChunkHeader *) (((char *) (ptr)) - STANDARDCHUNKHEADERSIZE))
+
+/* The block a chunk belongs to */
+#define SlabChunkBlock(chk)		(*(SlabBlock *) (chk))
+
+/* A free chunk links to the next free chunk of its block in its data space */
+#define SlabChunkNextFree(chk)	(*(char **) SlabChunkGetPointer(chk))
+
+/*
+ * These functions implement the MemoryContext API for Slab contexts.
+ */
+static void *SlabAlloc(MemoryContext context, Size size);
+static void SlabFree(MemoryContext context, void *pointer);
+static void *SlabRealloc(MemoryContext context, void *pointer, Size size);
+static void SlabInit(MemoryContext context);
+static void SlabReset(MemoryContext context);
+static void SlabDelete(MemoryContext context);
+static Size SlabGetChunkSpace(MemoryContext context, void *pointer);
+static bool SlabIsEmpty(MemoryContext context);
+static void SlabStats(MemoryContext context, uint64 *nBlocks, uint64 *nChunks,
+		uint64 *currentAvailable, uint64 *allAllocated, uint64 *allFreed, uint64 *maxHeld);
+static void SlabReleaseAccounting(MemoryContext context);
+static void SlabUpdateGeneration(MemoryContext context);
+
+#ifdef MEMORY_CONTEXT_CHECKING
+static void SlabCheck(MemoryContext context);
+#endif
+
+/*
+ * This is the virtual function table for Slab contexts.
+ */
+static MemoryContextMethods SlabMethods = {
+	SlabAlloc,
+	SlabFree,
+	SlabRealloc,
+	SlabInit,
+	SlabReset,
+	SlabDelete,
+	SlabGetChunkSpace,
+	SlabIsEmpty,
+	SlabStats,
+	SlabReleaseAccounting,
+	SlabUpdateGeneration,
+#ifdef MEMORY_CONTEXT_CHECKING
+	SlabCheck
+#endif
+};
+
+
+/* ----------
+ * Debug macros
+ * ----------
+ */
+#ifdef HAVE_ALLOCINFO
+#define SlabAllocInfo(_cxt, _chunk) \
+			fprintf(stderr, "SlabAlloc: %s: %p, %lu\n", \
+				(_cxt)->header.name, (_chunk), (unsigned long)(_cxt)->chunkSize)
+#else
+#define SlabAllocInfo(_cxt, _chunk)
+#endif
+
+
+/*
+ * SlabBlockPush
+ *		Link the block at the head of a list of blocks.
+ */
+static inline void
+SlabBlockPush(SlabBlock *list, SlabBlock block)
+{
+	block->prev = NULL;
+	block->next = *list;
+	if (*list != NULL)
+		(*list)->prev = block;
+	*list = block;
+}
+
+/*
+ * SlabBlockUnlink
+ *		Unlink the block from a list of blocks.
+ */
+static inline void
+SlabBlockUnlink(SlabBlock *list, SlabBlock block)
+{
+	if (block->prev != NULL)
+		block->prev->next = block->next;
+	else
+		*list = block->next;
+	if (block->next != NULL)
+		block->next->prev = block->prev;
+	block->prev = NULL;
+	block->next = NULL;
+}
+
+/*
+ * SlabNewBlock
+ *		Obtain a block and link it at the head of the blocks with free chunks.
+ */
+static SlabBlock
+SlabNewBlock(SlabContext *slab)
+{
+	SlabBlock	block = (SlabBlock) gp_malloc(slab->blockSize);
+
+	if (block == NULL)
+		MemoryContextError(ERRCODE_OUT_OF_MEMORY,
+						   &slab->header, CDB_MCXT_WHERE(&slab->header),
+						   "Out of memory.  Failed on request of size %lu bytes.",
+						   (unsigned long) slab->chunkSize);
+
+	block->freehead = NULL;
+	block->unusedptr = SlabBlockGetFirstChunk(block);
+	block->nfree = slab->chunksPerBlock;
+	block->memoryAccount = NULL;
+	block->memoryAccountGeneration = 0;
+
+	SlabBlockPush(&slab->blocks, block);
+
+	MemoryContextNoteAlloc(&slab->header, slab->blockSize);
+
+	if (ActiveMemoryAccount != NULL)
+	{
+		block->memoryAccount = ActiveMemoryAccount;
+		block->memoryAccountGeneration = MemoryAccountingCurrentGeneration;
+		MemoryAccounting_Allocate(ActiveMemoryAccount, (MemoryContext) slab,
+								  slab->blockSize);
+	}
+
+	return block;
+}
+
+/*
+ * SlabFreeBlock
+ *		Return an unlinked block to malloc().
+ */
+static void
+SlabFreeBlock(SlabContext *slab, SlabBlock block)
+{
+	if (block->memoryAccount != NULL)
+	{
+		MemoryAccounting_Free(block->memoryAccount,
+							  block->memoryAccountGeneration, (MemoryContext) slab,
+							  slab->blockSize);
+		block->memoryAccount = NULL;
+	}
+
+	MemoryContextNoteFree(&slab->header, slab->blockSize);
+
+#ifdef CLOBBER_FREED_MEMORY
+	/* Wipe freed memory for debugging purposes */
+	memset(block, 0x7F, slab->blockSize);
+#endif
+	gp_free2(block, slab->blockSize);
+}
+
+
+/*
+ * Public routines
+ */
+
+
+/*
+ * SlabContextCreate
+ *		Create a new Slab context.
+ *
+ * parent: parent context, or NULL if top-level context
+ * name: name of context (for debugging --- string will be copied)
+ * chunkSize: size of every chunk allocated in the context
+ * chunksPerBlock: number of chunks in a block
+ *
+ * No block is obtained before the first allocation.
+ */
+MemoryContext
+SlabContextCreate(MemoryContext parent,
+				  const char *name,
+				  Size chunkSize,
+				  int chunksPerBlock)
+{
+	SlabContext *slab;
+	Size		fullChunkSize;
+
+	/* Do the type-independent part of context creation */
+	slab = (SlabContext *) MemoryContextCreate(T_SlabContext,
+											   sizeof(SlabContext),
+											   &SlabMethods,
+											   parent,
+											   name);
+
+	/*
+	 * Pad the chunks to a power of 2 up to the cache line size, and to a
+	 * multiple of it beyond.  A free chunk must hold its freelist link.
+	 */
+	fullChunkSize = SLAB_CHUNKHDRSZ + MAXALIGN(Max(chunkSize, sizeof(char *)));
+	if (fullChunkSize < SLAB_CACHE_LINE_SIZE)
+	{
+		Size		pow2 = MAXIMUM_ALIGNOF;
+
+		while (pow2 < fullChunkSize)
+			pow2 <<= 1;
+		fullChunkSize = pow2;
+	}
+	else
+		fullChunkSize = TYPEALIGN(SLAB_CACHE_LINE_SIZE, fullChunkSize);
+
+	if (chunksPerBlock < 1)
+		chunksPerBlock = 1;
+
+	slab->fullChunkSize = fullChunkSize;
+	slab->chunkSize = fullChunkSize - SLAB_CHUNKHDRSZ;
+	slab->chunksPerBlock = chunksPerBlock;
+	/* leave room to align the first chunk on a cache line */
+	slab->blockSize = SLAB_BLOCKHDRSZ + SLAB_CACHE_LINE_SIZE +
+		chunksPerBlock * fullChunkSize;
+
+	slab->sharedHeader.context = (MemoryContext) slab;
+	slab->sharedHeader.memoryAccount = NULL;
+	slab->sharedHeader.memoryAccountGeneration = MemoryAccountingCurrentGeneration;
+
+	return (MemoryContext) slab;
+}
+
+/*
+ * SlabInit
+ *		Context-type-specific initialization routine.
+ *
+ * This is called by MemoryContextCreate() after setting up the
+ * generic MemoryContext fields and before linking the new context
+ * into the context tree.  We must do whatever is needed to make the
+ * new context minimally valid for deletion.  We must *not* risk
+ * failure --- thus, for example, allocating more memory is not cool.
+ */
+static void
+SlabInit(MemoryContext context)
+{
+	/*
+	 * Since MemoryContextCreate already zeroed the context node, we don't
+	 * have to do anything here: it's already OK.
+	 */
+}
+
+/*
+ * SlabReleaseAccounting
+ *		Release the accounting of all blocks, without freeing them.
+ */
+static void
+SlabReleaseAccounting(MemoryContext context)
+{
+	SlabContext *slab = (SlabContext *) context;
+	SlabBlock	lists[3] = {slab->blocks, slab->fullBlocks, slab->emptyBlock};
+	SlabBlock	block;
+	int			i;
+
+	for (i = 0; i < lengthof(lists); i++)
+	{
+		for (block = lists[i]; block != NULL; block = block->next)
+		{
+			if (block->memoryAccount != NULL)
+			{
+				MemoryAccounting_Free(block->memoryAccount,
+									  block->memoryAccountGeneration, context,
+									  slab->blockSize);
+				block->memoryAccount = NULL;
+			}
+		}
+	}
+}
+
+/*
+ * SlabUpdateGeneration
+ *		Move the accounting of all blocks to the RolloverMemoryAccount in
+ *		the current generation.
+ */
+static void
+SlabUpdateGeneration(MemoryContext context)
+{
+	SlabContext *slab = (SlabContext *) context;
+	SlabBlock	lists[3] = {slab->blocks, slab->fullBlocks, slab->emptyBlock};
+	SlabBlock	block;
+	int			i;
+
+	for (i = 0; i < lengthof(lists); i++)
+	{
+		for (block = lists[i]; block != NULL; block = block->next)
+		{
+			if (block->memoryAccount != NULL)
+			{
+				block->memoryAccount = RolloverMemoryAccount;
+				block->memoryAccountGeneration = MemoryAccountingCurrentGeneration;
+			}
+		}
+	}
+
+	slab->sharedHeader.memoryAccountGeneration = MemoryAccountingCurrentGeneration;
+}
+
+/*
+ * SlabReset
+ *		Frees all memory which is allocated in the given slab.
+ *
+ * Unlike an AllocSet, a slab keeps no block over a reset: slab contexts
+ * live long and are seldom reset.
+ */
+static void
+SlabReset(MemoryContext context)
+{
+	SlabContext *slab = (SlabContext *) context;
+	SlabBlock	lists[3];
+	int			i;
+
+	Assert(IsA(slab, SlabContext));
+
+#ifdef MEMORY_CONTEXT_CHECKING
+	/* Check for corruption before freeing */
+	SlabCheck(context);
+#endif
+
+	lists[0] = slab->blocks;
+	lists[1] = slab->fullBlocks;
+	lists[2] = slab->emptyBlock;
+
+	slab->blocks = NULL;
+	slab->fullBlocks = NULL;
+	slab->emptyBlock = NULL;
+
+	for (i = 0; i < lengthof(lists); i++)
+	{
+		SlabBlock	block = lists[i];
+
+		while (block != NULL)
+		{
+			SlabBlock	next = block->next;
+
+			SlabFreeBlock(slab, block);
+			block = next;
+		}
+	}
+
+	slab->nchunks = 0;
+}
+
+/*
+ * SlabDelete
+ *		Frees all memory which is allocated in the given slab,
+ *		in preparation for deletion of the slab.
+ *
+ * We are not responsible for deleting the context node itself.
+ */
+static void
+SlabDelete(MemoryContext context)
+{
+	SlabReset(context);
+}
+
+/*
+ * SlabAlloc
+ *		Returns pointer to allocated memory of given size; memory is added
+ *		to the slab.
+ *
+ * Blocks with free chunks are tried first, then the empty block kept
+ * aside, and only then a new block is obtained.
+ */
+static void *
+SlabAlloc(MemoryContext context, Size size)
+{
+	SlabContext *slab = (SlabContext *) context;
+	SlabBlock	block = slab->blocks;
+	StandardChunkHeader *header;
+	char	   *chunk;
+
+	Assert(IsA(slab, SlabContext));
+
+	if (size > slab->chunkSize)
+		elog(ERROR, "invalid memory alloc request size %lu in slab \"%s\" of %lu byte chunks",
+			 (unsigned long) size, slab->header.name, (unsigned long) slab->chunkSize);
+
+	if (block == NULL)
+	{
+		if (slab->emptyBlock != NULL)
+		{
+			block = slab->emptyBlock;
+			slab->emptyBlock = NULL;
+			SlabBlockPush(&slab->blocks, block);
+		}
+		else
+			block = SlabNewBlock(slab);
+	}
+
+	Assert(block->nfree > 0);
+
+	if (block->freehead != NULL)
+	{
+		chunk = block->freehead;
+		block->freehead = SlabChunkNextFree(chunk);
+	}
+	else
+	{
+		chunk = block->unusedptr;
+		block->unusedptr += slab->fullChunkSize;
+		SlabChunkBlock(chunk) = block;
+	}
+
+	/* move a block that became full out of the way */
+	if (--block->nfree == 0)
+	{
+		SlabBlockUnlink(&slab->blocks, block);
+		SlabBlockPush(&slab->fullBlocks, block);
+	}
+
+	header = SlabChunkGetHeader(chunk);
+	header->sharedHeader = &slab->sharedHeader;
+	header->size = slab->chunkSize;
+#ifdef MEMORY_CONTEXT_CHECKING
+	header->requested_size = size;
+	/* set mark to catch clobber of "unused" space */
+	if (size < slab->chunkSize)
+		((char *) SlabChunkGetPointer(chunk))[size] = 0x7E;
+#endif
+#ifdef CDB_PALLOC_TAGS
+	header->prev_chunk = NULL;
+	header->next_chunk = NULL;
+#endif
+
+	slab->nchunks++;
+
+	SlabAllocInfo(slab, chunk);
+	return SlabChunkGetPointer(chunk);
+}
+
+/*
+ * SlabFree
+ *		Puts the chunk on the freelist of its block.
+ */
+static void
+SlabFree(MemoryContext context, void *pointer)
+{
+	SlabContext *slab = (SlabContext *) context;
+	char	   *chunk = SlabPointerGetChunk(pointer);
+	SlabBlock	block = SlabChunkBlock(chunk);
+
+	Assert(IsA(slab, SlabContext));
+	Assert(block->nfree < slab->chunksPerBlock);
+
+#ifdef MEMORY_CONTEXT_CHECKING
+	{
+		StandardChunkHeader *header = SlabPointerGetHeader(pointer);
+
+		/* Test for someone scribbling on unused space in chunk */
+		if (header->requested_size < header->size)
+			if (((char *) pointer)[header->requested_size] != 0x7E)
+				elog(WARNING, "detected write past chunk end in %s %p",
+					 context->name, chunk);
+	}
+#endif
+
+#ifdef CLOBBER_FREED_MEMORY
+	/* Wipe freed memory for debugging purposes */
+	memset(pointer, 0x7F, slab->chunkSize);
+#endif
+
+	SlabChunkNextFree(chunk) = block->freehead;
+	block->freehead = chunk;
+
+	/* a full block has room again */
+	if (block->nfree++ == 0)
+	{
+		SlabBlockUnlink(&slab->fullBlocks, block);
+		SlabBlockPush(&slab->blocks, block);
+	}
+
+	/* keep one empty block aside, give the others back */
+	if (block->nfree == slab->chunksPerBlock)
+	{
+		SlabBlockUnlink(&slab->blocks, block);
+		if (slab->emptyBlock == NULL)
+			slab->emptyBlock = block;
+		else
+			SlabFreeBlock(slab, block);
+	}
+
+	slab->nchunks--;
+}
+
+/*
+ * SlabRealloc
+ *		Returns the chunk itself if the new size fits in a chunk of the
+ *		slab; larger sizes cannot be served by a slab.
+ */
+static void *
+SlabRealloc(MemoryContext context, void *pointer, Size size)
+{
+	SlabContext *slab = (SlabContext *) context;
+
+	Assert(IsA(slab, SlabContext));
+
+	if (size > slab->chunkSize)
+		elog(ERROR, "invalid memory alloc request size %lu in slab \"%s\" of %lu byte chunks",
+			 (unsigned long) size, slab->header.name, (unsigned long) slab->chunkSize);
+
+#ifdef MEMORY_CONTEXT_CHECKING
+	{
+		StandardChunkHeader *header = SlabPointerGetHeader(pointer);
+
+		header->requested_size = size;
+		/* set mark to catch clobber of "unused" space */
+		if (size < slab->chunkSize)
+			((char *) pointer)[size] = 0x7E;
+	}
+#endif
+
+	return pointer;
+}
+
+/*
+ * SlabGetChunkSpace
+ *		Given a currently-allocated chunk, determine the total space
+ *		it occupies (including all memory-allocation overhead).
+ */
+static Size
+SlabGetChunkSpace(MemoryContext context, void *pointer)
+{
+	SlabContext *slab = (SlabContext *) context;
+
+	return slab->fullChunkSize;
+}
+
+/*
+ * SlabIsEmpty
+ *		Is a slab empty of any allocated space?
+ */
+static bool
+SlabIsEmpty(MemoryContext context)
+{
+	SlabContext *slab = (SlabContext *) context;
+
+	return slab->nchunks == 0;
+}
+
+/*
+ * SlabStats
+ *		Returns stats about memory consumption of a SlabContext.
+ *
+ *	Input parameters:
+ *		context: the context of interest
+ *
+ *	Output parameters:
+ *		nBlocks: number of blocks in the context
+ *		nChunks: number of chunks in use
+ *
+ *		currentAvailable: space of the free chunks across all blocks
+ *
+ *		allAllocated: total bytes allocated during lifetime
+ *		allFreed: total bytes that was freed during lifetime
+ *		maxHeld: maximum bytes held during lifetime
+ */
+static void
+SlabStats(MemoryContext context, uint64 *nBlocks, uint64 *nChunks,
+		uint64 *currentAvailable, uint64 *allAllocated, uint64 *allFreed, uint64 *maxHeld)
+{
+	SlabContext *slab = (SlabContext *) context;
+	SlabBlock	lists[3] = {slab->blocks, slab->fullBlocks, slab->emptyBlock};
+	SlabBlock	block;
+	int			i;
+
+	Assert(IsA(slab, SlabContext));
+
+	*nBlocks = 0;
+	*currentAvailable = 0;
+	for (i = 0; i < lengthof(lists); i++)
+	{
+		for (block = lists[i]; block != NULL; block = block->next)
+		{
+			(*nBlocks)++;
+			*currentAvailable += (uint64) block->nfree * slab->chunkSize;
+		}
+	}
+
+	*nChunks = slab->nchunks;
+	*allAllocated = slab->header.allBytesAlloc;
+	*allFreed = slab->header.allBytesFreed;
+	*maxHeld = slab->header.maxBytesHeld;
+}
+
+
+#ifdef MEMORY_CONTEXT_CHECKING
+/*
+ * SlabCheck
+ *		Walk through blocks and check consistency of memory.
+ *
+ * NOTE: report errors as WARNING, *not* ERROR or FATAL.  Otherwise you'll
+ * find yourself in an infinite loop when trouble occurs, because this
+ * routine will be entered again when elog cleanup tries to release memory!
+ */
+static void
+SlabCheck(MemoryContext context)
+{
+	SlabContext *slab = (SlabContext *) context;
+	const char *name = slab->header.name;
+	SlabBlock	lists[3] = {slab->blocks, slab->fullBlocks, slab->emptyBlock};
+	SlabBlock	block;
+	uint64		nused = 0;
+	int			i;
+
+	for (i = 0; i < lengthof(lists); i++)
+	{
+		for (block = lists[i]; block != NULL; block = block->next)
+		{
+			char	   *first = SlabBlockGetFirstChunk(block);
+			char	   *end = first + slab->chunksPerBlock * slab->fullChunkSize;
+			char	   *chunk;
+			int			nfree = (end - block->unusedptr) / slab->fullChunkSize;
+
+			if (block->unusedptr < first || block->unusedptr > end ||
+				block->nfree < 0 || block->nfree > slab->chunksPerBlock ||
+				(i == 1 && block->nfree != 0) ||
+				(i == 2 && block->nfree != slab->chunksPerBlock))
+			{
+				elog(WARNING, "problem in slab %s: corrupt header in block %p",
+					 name, block);
+				continue;
+			}
+
+			for (chunk = block->freehead; chunk != NULL; chunk = SlabChunkNextFree(chunk))
+			{
+				if (chunk < first || chunk >= block->unusedptr ||
+					(chunk - first) % slab->fullChunkSize != 0 ||
+					SlabChunkBlock(chunk) != block)
+				{
+					elog(WARNING, "problem in slab %s: bogus freelist in block %p, chunk %p",
+						 name, block, chunk);
+					break;
+				}
+
+				/* don't loop forever on a cycle */
+				if (++nfree > slab->chunksPerBlock)
+					break;
+			}
+
+			if (nfree != block->nfree)
+				elog(WARNING, "problem in slab %s: block %p has %d free chunks, expected %d",
+					 name, block, nfree, block->nfree);
+
+			nused += slab->chunksPerBlock - block->nfree;
+		}
+	}
+
+	if (nused != slab->nchunks)
+		elog(WARNING, "problem in slab %s: found %lu chunks in use, expected %lu",
+			 name, (unsigned long) nused, (unsigned long) slab->nchunks);
+}
+#endif   /* MEMORY_CONTEXT_CHECKING */
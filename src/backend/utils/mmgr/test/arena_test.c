@@ -0,0 +1,246 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include "cmockery.h"
+
+#include "c.h"
+#include "postgres.h"
+#include "nodes/nodes.h"
+#include "../arena.c"
+
+#define ARENA_BLOCK_SIZE 8192
+
+extern MemoryAccount *MemoryAccountTreeLogicalRoot;
+extern MemoryAccount *TopMemoryAccount;
+extern MemoryAccount *MemoryAccountMemoryAccount;
+
+/*
+ * This method will emulate the real ExceptionalCondition
+ * function by re-throwing the exception, essentially falling
+ * back to the next available PG_CATCH();
+ */
+void
+_ExceptionalCondition()
+{
+     PG_RE_THROW();
+}
+
+/*
+ * This method sets up MemoryContext tree as well as
+ * the basic MemoryAccount data structures.
+ */
+void SetupMemoryDataStructures(void **state)
+{
+	MemoryContextInit();
+}
+
+/*
+ * This method cleans up MemoryContext tree and
+ * the MemoryAccount data structures.
+ */
+void TeardownMemoryDataStructures(void **state)
+{
+	MemoryContextReset(TopMemoryContext); /* TopMemoryContext deletion is not supported */
+
+	/* These are needed to be NULL for calling MemoryContextInit() */
+	TopMemoryContext = NULL;
+	CurrentMemoryContext = NULL;
+
+	/*
+	 * Memory accounts related variables need to be NULL before we
+	 * try to setup memory account data structure again during the
+	 * execution of the next test.
+	 */
+	MemoryAccountTreeLogicalRoot = NULL;
+	TopMemoryAccount = NULL;
+	MemoryAccountMemoryAccount = NULL;
+	RolloverMemoryAccount = NULL;
+	SharedChunkHeadersMemoryAccount = NULL;
+	ActiveMemoryAccount = NULL;
+	AlienExecutorMemoryAccount = NULL;
+	MemoryAccountMemoryContext = NULL;
+}
+
+/*
+ * Chunks are carved off the active block one after another
+ */
+void
+test__ArenaAlloc__BumpsPointer(void **state)
+{
+	MemoryContext context = ArenaContextCreate(TopMemoryContext, "test",
+			ARENA_BLOCK_SIZE, ARENA_BLOCK_SIZE);
+	ArenaContext *arena = (ArenaContext *) context;
+
+	char *first = MemoryContextAlloc(context, 10);
+	char *second = MemoryContextAlloc(context, 20);
+
+	assert_true(arena->blocks != NULL && arena->blocks == arena->keeper);
+	assert_true(second == first + MAXALIGN(10) + ARENA_CHUNKHDRSZ);
+	assert_true(arena->blocks->freeptr == second + MAXALIGN(20));
+	assert_true(arena->nchunks == 2);
+
+	assert_true(GetMemoryChunkContext(first) == context);
+	assert_true(MemoryContextContains(context, second));
+	assert_true(MemoryContextContainsGenericAllocation(context, second));
+	assert_false(MemoryContextContainsGenericAllocation(TopMemoryContext, second));
+
+	MemoryContextDelete(context);
+}
+
+/*
+ * Resetting the context rewinds the keeper block and frees the others
+ */
+void
+test__ArenaReset__RewindsKeeper(void **state)
+{
+	MemoryContext context = ArenaContextCreate(TopMemoryContext, "test",
+			ARENA_BLOCK_SIZE, ARENA_BLOCK_SIZE);
+	ArenaContext *arena = (ArenaContext *) context;
+
+	void *first = MemoryContextAlloc(context, 100);
+
+	/* fill up the keeper so that more blocks are needed */
+	for (int i = 0; i < 100; i++)
+	{
+		MemoryContextAlloc(context, 1000);
+	}
+
+	assert_true(arena->blocks != arena->keeper);
+	assert_false(MemoryContextIsEmpty(context));
+
+	MemoryContextReset(context);
+
+	assert_true(arena->blocks == arena->keeper);
+	assert_true(arena->keeper->next == NULL);
+	assert_true(arena->nchunks == 0);
+	assert_true(MemoryContextIsEmpty(context));
+	assert_true(context->allBytesAlloc - context->allBytesFreed == ARENA_BLOCK_SIZE);
+
+	assert_true(MemoryContextAlloc(context, 100) == first);
+
+	MemoryContextDelete(context);
+}
+
+/*
+ * A chunk too large for a regular block gets a block of its own, behind
+ * the active block
+ */
+void
+test__ArenaAlloc__LargeAllocInDedicatedBlock(void **state)
+{
+	MemoryContext context = ArenaContextCreate(TopMemoryContext, "test",
+			ARENA_BLOCK_SIZE, ARENA_BLOCK_SIZE);
+	ArenaContext *arena = (ArenaContext *) context;
+
+	char *small = MemoryContextAlloc(context, 10);
+	ArenaBlock active = arena->blocks;
+	char *large = MemoryContextAlloc(context, ARENA_BLOCK_SIZE);
+
+	assert_true(arena->blocks == active);
+	assert_true(active->next != NULL);
+	assert_true(large == ((char *) active->next) + ARENA_BLOCKHDRSZ + ARENA_CHUNKHDRSZ);
+	assert_true(active->next->freeptr == active->next->endptr);
+
+	/* the active block is still used */
+	assert_true(MemoryContextAlloc(context, 10) == small + MAXALIGN(10) + ARENA_CHUNKHDRSZ);
+
+	MemoryContextDelete(context);
+}
+
+/*
+ * The last chunk of the active block grows in place, others are copied
+ */
+void
+test__ArenaRealloc__GrowsLastChunkInPlace(void **state)
+{
+	MemoryContext context = ArenaContextCreate(TopMemoryContext, "test",
+			ARENA_BLOCK_SIZE, ARENA_BLOCK_SIZE);
+
+	char *first = MemoryContextAlloc(context, 16);
+	strcpy(first, "arena");
+
+	char *grown = repalloc(first, 64);
+	assert_true(grown == first);
+	assert_true(GetMemoryChunkSpace(grown) == 64 + ARENA_CHUNKHDRSZ);
+
+	MemoryContextAlloc(context, 16);
+
+	char *moved = repalloc(grown, 128);
+	assert_true(moved != grown);
+	assert_true(strcmp(moved, "arena") == 0);
+
+	/* shrinking never moves */
+	assert_true(repalloc(moved, 8) == moved);
+
+	MemoryContextDelete(context);
+}
+
+/*
+ * Blocks are charged to the active memory account, and released on reset
+ */
+void
+test__ArenaReset__ReleasesAccounting(void **state)
+{
+	MemoryAccount *newActiveAccount = MemoryAccounting_CreateAccount(0, MEMORY_OWNER_TYPE_Exec_Hash);
+	MemoryAccount *oldActiveAccount = MemoryAccounting_SwitchAccount(newActiveAccount);
+
+	MemoryContext context = ArenaContextCreate(TopMemoryContext, "test",
+			ARENA_BLOCK_SIZE, ARENA_BLOCK_SIZE);
+
+	uint64 prevOutstanding = MemoryAccountingOutstandingBalance;
+	uint64 prevBalance = newActiveAccount->allocated - newActiveAccount->freed;
+
+	MemoryContextAlloc(context, 100);
+	MemoryContextAlloc(context, 100);
+
+	assert_true(newActiveAccount->allocated - newActiveAccount->freed ==
+			prevBalance + ARENA_BLOCK_SIZE);
+	assert_true(MemoryAccountingOutstandingBalance == prevOutstanding + ARENA_BLOCK_SIZE);
+
+	MemoryContextReset(context);
+
+	assert_true(newActiveAccount->allocated - newActiveAccount->freed == prevBalance);
+	assert_true(MemoryAccountingOutstandingBalance == prevOutstanding);
+
+	/* the keeper is charged again once it is used again */
+	MemoryContextAlloc(context, 100);
+	assert_true(MemoryAccountingOutstandingBalance == prevOutstanding + ARENA_BLOCK_SIZE);
+
+	MemoryContextDelete(context);
+
+	MemoryAccounting_SwitchAccount(oldActiveAccount);
+}
+
+int 
+main(int argc, char* argv[]) 
+{
+        cmockery_parse_arguments(argc, argv);
+
+        const UnitTest tests[] = {
+			unit_test_setup_teardown(test__ArenaAlloc__BumpsPointer, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+			unit_test_setup_teardown(test__ArenaReset__RewindsKeeper, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+			unit_test_setup_teardown(test__ArenaAlloc__LargeAllocInDedicatedBlock, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+			unit_test_setup_teardown(test__ArenaRealloc__GrowsLastChunkInPlace, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+			unit_test_setup_teardown(test__ArenaReset__ReleasesAccounting, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+        };
+        return run_tests(tests);
+}
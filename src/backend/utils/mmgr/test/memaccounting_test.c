@@ -1607,6 +1607,82 @@ test__MemoryAccounting_SaveToFile__GeneratesCorrectString(void **state)
     pfree(newAccount);
 }
 
+/*
+ * Tests if the MemoryAccounting_PublishSnapshot copies the memory accounting
+ * tree into the snapshot slot of this backend, no more often than
+ * gp_memory_account_publish_interval, and if MemoryAccounting_Reset clears it.
+ */
+void
+test__MemoryAccounting_PublishSnapshot__CopiesTree(void **state)
+{
+	MemoryAccountSnapshot slot;
+	MemoryAccountSnapshot copy;
+
+	MemSet(&slot, 0, sizeof(slot));
+	MemoryAccountSnapshots = &slot;
+	MemoryAccountSnapshotCount = 1;
+	MyBackendId = 1;
+	gp_memory_account_publish_interval = 1000;
+
+	/* ActiveMemoryAccount should be Top at this point */
+	MemoryAccount *newAccount = CreateMemoryAccountImpl(0, MEMORY_OWNER_TYPE_Exec_Hash, ActiveMemoryAccount);
+	newAccount->planNodeId = 3;
+
+	MemoryAccounting_SwitchAccount(newAccount);
+
+	void * dummy = palloc(NEW_ALLOC_SIZE);
+
+	will_return(GetCurrentTimestamp, 1);
+	expect_any(TimestampDifferenceExceeds, start_time);
+	expect_any(TimestampDifferenceExceeds, stop_time);
+	expect_value(TimestampDifferenceExceeds, msec, 1000);
+	will_return(TimestampDifferenceExceeds, true);
+	expect_value(on_shmem_exit, function, MemoryAccountSnapshotShmemExit);
+	expect_any(on_shmem_exit, arg);
+	will_be_called(on_shmem_exit);
+
+	MemoryAccounting_PublishSnapshot();
+
+	/* Root, Top, X_Hash, X_Alien, MemAcc, Rollover, SharedHeader */
+	assert_true(slot.changeCount == 2);
+	assert_true(slot.totalAccounts == 7);
+	assert_true(slot.nentries == 7);
+	assert_true(slot.entries[0].ownerType == MEMORY_OWNER_TYPE_LogicalRoot);
+	assert_true(slot.entries[0].parentSerial == 0);
+	assert_true(slot.entries[0].planNodeId == -1);
+	assert_true(slot.entries[2].ownerType == MEMORY_OWNER_TYPE_Exec_Hash);
+	assert_true(slot.entries[2].parentSerial == 1);
+	assert_true(slot.entries[2].planNodeId == 3);
+	assert_true(slot.entries[2].peak == newAccount->peak);
+	assert_true(slot.entries[2].balance == newAccount->allocated - newAccount->freed);
+
+	assert_true(MemoryAccounting_ReadSnapshot(0, &copy));
+	assert_true(copy.pid == MyProcPid);
+	assert_true(copy.nentries == 7);
+
+	/* Too early for another publication */
+	will_return(GetCurrentTimestamp, 2);
+	expect_any(TimestampDifferenceExceeds, start_time);
+	expect_any(TimestampDifferenceExceeds, stop_time);
+	expect_any(TimestampDifferenceExceeds, msec);
+	will_return(TimestampDifferenceExceeds, false);
+
+	MemoryAccounting_PublishSnapshot();
+	assert_true(slot.changeCount == 2);
+
+	pfree(dummy);
+
+	MemoryAccounting_Reset();
+
+	assert_true(slot.changeCount == 4);
+	assert_false(MemoryAccounting_ReadSnapshot(0, &copy));
+
+	MemoryAccountSnapshots = NULL;
+	MemoryAccountSnapshotCount = 0;
+	MyMemoryAccountSnapshot = NULL;
+	gp_memory_account_publish_interval = 0;
+}
+
 int
 main(int argc, char* argv[])
 {
@@ -1645,6 +1721,7 @@ main(int argc, char* argv[])
         		unit_test_setup_teardown(test__MemoryAccounting_ToString__Validate, SetupMemoryDataStructures, TeardownMemoryDataStructures),
         		unit_test_setup_teardown(test__MemoryAccounting_SaveToLog__GeneratesCorrectString, SetupMemoryDataStructures, TeardownMemoryDataStructures),
         		unit_test_setup_teardown(test__MemoryAccounting_SaveToFile__GeneratesCorrectString, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+        		unit_test_setup_teardown(test__MemoryAccounting_PublishSnapshot__CopiesTree, SetupMemoryDataStructures, TeardownMemoryDataStructures),
         };
         return run_tests(tests);
 }
@@ -83,6 +83,7 @@ InitFakeSessionState(int activeProcessCount, int cleanupCountdown, RunawayStatus
 	MySessionState->sessionId = 1234;
 	MySessionState->sessionVmem = vmem;
 	MySessionState->spinLock = 0;
+	MySessionState->runawaySpill = false;
 }
 
 
@@ -208,6 +209,80 @@ test__RunawayCleaner_StartCleanup__StartsCleanupIfPossible(void **state)
 	RunawayCleaner_StartCleanup();
 }
 
+/* Number of times fakeSpillCallback was called */
+static int fakeSpillCallbackCount = 0;
+
+/* A spill callback of an operator that always agrees to spill */
+static bool
+fakeSpillCallback(void *arg)
+{
+	assert_true(arg == &fakeSpillCallbackCount);
+	fakeSpillCallbackCount++;
+	return true;
+}
+
+/*
+ * Checks if RunawayCleaner_StartCleanup() asks the registered operators to
+ * spill and marks the process clean instead of erroring out if the red-zone
+ * handler chose to let the session spill
+ */
+void
+test__RunawayCleaner_StartCleanup__SpillsInsteadOfCanceling(void **state)
+{
+	InitFakeSessionState(2 /* activeProcessCount */,
+			2 /* cleanupCountdown */,
+			RunawayStatus_PrimaryRunawaySession /* runawayStatus */, 2 /* pinCount */, 12345 /* vmem */);
+	MySessionState->runawaySpill = true;
+
+	static EventVersion fakeLatestRunawayVersion = 10;
+	latestRunawayVersion = &fakeLatestRunawayVersion;
+	*latestRunawayVersion = 10;
+
+	/* Valid isRunawayDetector is necessary for Assert */
+	static uint32 fakeIsRunawayDetector = 1;
+	isRunawayDetector = &fakeIsRunawayDetector;
+
+	beginCleanupRunawayVersion = 1;
+	endCleanupRunawayVersion = 1;
+	activationVersion = 0;
+	deactivationVersion = 0;
+	isProcessActive = true;
+
+	/* Make sure the cleanup goes through */
+	vmemTrackerInited = true;
+	CritSectionCount = 0;
+	InterruptHoldoffCount = 0;
+	gp_command_count = 1;
+	will_return(superuser, false);
+
+	static RunawaySpillCallbackItem fakeItem;
+	fakeItem.callback = fakeSpillCallback;
+	fakeItem.arg = &fakeSpillCallbackCount;
+	fakeItem.subid = 1;
+	fakeItem.next = NULL;
+	spillCallbacks = &fakeItem;
+	fakeSpillCallbackCount = 0;
+
+	will_return(VmemTracker_ConvertVmemChunksToMB, 12345);
+	expect_value(VmemTracker_ConvertVmemChunksToMB, chunks, 12345);
+	will_return(VmemTracker_GetAvailableVmemMB, 0);
+	will_return(RedZoneHandler_GetRedZoneLimitMB, 0);
+	EXPECT_ELOG(LOG);
+	CHECK_FOR_RUNAWAY_CLEANUP_MEMORY_LOGGING();
+
+	/* No ereport(ERROR) is expected */
+	RunawayCleaner_StartCleanup();
+
+	spillCallbacks = NULL;
+
+	assert_true(fakeSpillCallbackCount == 1);
+	/* The process is marked clean for this runaway event */
+	assert_true(beginCleanupRunawayVersion == *latestRunawayVersion);
+	assert_true(endCleanupRunawayVersion == beginCleanupRunawayVersion);
+	assert_true(MySessionState->cleanupCountdown == 1);
+	assert_true(MySessionState->runawayStatus == RunawayStatus_PrimaryRunawaySession);
+}
+
 /*
  * Checks if RunawayCleaner_StartCleanup() ignores cleanup if in critical section
  */
@@ -572,6 +647,7 @@ main(int argc, char* argv[])
             	unit_test(test__RunawayCleaner_StartCleanup__IgnoresNonRunaway),
             	unit_test(test__RunawayCleaner_StartCleanup__IgnoresDuplicateCleanup),
             	unit_test(test__RunawayCleaner_StartCleanup__StartsCleanupIfPossible),
+            	unit_test(test__RunawayCleaner_StartCleanup__SpillsInsteadOfCanceling),
             	unit_test(test__RunawayCleaner_StartCleanup__IgnoresCleanupInCriticalSection),
             	unit_test(test__RunawayCleaner_StartCleanup__IgnoresCleanupInHoldoffInterrupt),
             	unit_test(test__RunawayCleaner_RunawayCleanupDoneForProcess__IgnoresCleanupIfNotRequired),
@@ -0,0 +1,282 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include "cmockery.h"
+
+#include "c.h"
+#include "postgres.h"
+#include "nodes/nodes.h"
+#include "../slab.c"
+
+#define SLAB_CHUNK_SIZE 100
+#define SLAB_CHUNKS_PER_BLOCK 4
+
+extern MemoryAccount *MemoryAccountTreeLogicalRoot;
+extern MemoryAccount *TopMemoryAccount;
+extern MemoryAccount *MemoryAccountMemoryAccount;
+
+/*
+ * This method will emulate the real ExceptionalCondition
+ * function by re-throwing the exception, essentially falling
+ * back to the next available PG_CATCH();
+ */
+void
+_ExceptionalCondition()
+{
+     PG_RE_THROW();
+}
+
+/*
+ * This method sets up MemoryContext tree as well as
+ * the basic MemoryAccount data structures.
+ */
+void SetupMemoryDataStructures(void **state)
+{
+	MemoryContextInit();
+}
+
+/*
+ * This method cleans up MemoryContext tree and
+ * the MemoryAccount data structures.
+ */
+void TeardownMemoryDataStructures(void **state)
+{
+	MemoryContextReset(TopMemoryContext); /* TopMemoryContext deletion is not supported */
+
+	/* These are needed to be NULL for calling MemoryContextInit() */
+	TopMemoryContext = NULL;
+	CurrentMemoryContext = NULL;
+
+	/*
+	 * Memory accounts related variables need to be NULL before we
+	 * try to setup memory account data structure again during the
+	 * execution of the next test.
+	 */
+	MemoryAccountTreeLogicalRoot = NULL;
+	TopMemoryAccount = NULL;
+	MemoryAccountMemoryAccount = NULL;
+	RolloverMemoryAccount = NULL;
+	SharedChunkHeadersMemoryAccount = NULL;
+	ActiveMemoryAccount = NULL;
+	AlienExecutorMemoryAccount = NULL;
+	MemoryAccountMemoryContext = NULL;
+}
+
+/*
+ * Chunks are padded to the cache line size and start on a cache line
+ */
+void
+test__SlabContextCreate__AlignsChunks(void **state)
+{
+	MemoryContext context = SlabContextCreate(TopMemoryContext, "test",
+			SLAB_CHUNK_SIZE, SLAB_CHUNKS_PER_BLOCK);
+	SlabContext *slab = (SlabContext *) context;
+
+	assert_true(slab->chunkSize >= SLAB_CHUNK_SIZE);
+	assert_true(slab->fullChunkSize % SLAB_CACHE_LINE_SIZE == 0);
+
+	char *first = MemoryContextAlloc(context, SLAB_CHUNK_SIZE);
+	char *second = MemoryContextAlloc(context, 10);
+
+	assert_true((uintptr_t) SlabPointerGetChunk(first) % SLAB_CACHE_LINE_SIZE == 0);
+	assert_true(second == first + slab->fullChunkSize);
+	assert_true(GetMemoryChunkSpace(second) == slab->fullChunkSize);
+
+	assert_true(GetMemoryChunkContext(first) == context);
+	assert_true(MemoryContextContains(context, second));
+	assert_true(MemoryContextContainsGenericAllocation(context, second));
+	assert_false(MemoryContextContainsGenericAllocation(TopMemoryContext, second));
+
+	/* small chunks are padded to a power of 2 */
+	MemoryContext small = SlabContextCreate(TopMemoryContext, "small", 1, SLAB_CHUNKS_PER_BLOCK);
+	Size fullChunkSize = ((SlabContext *) small)->fullChunkSize;
+	assert_true((fullChunkSize & (fullChunkSize - 1)) == 0);
+
+	MemoryContextDelete(small);
+	MemoryContextDelete(context);
+}
+
+/*
+ * A freed chunk is reused first, and a full block that gets a free chunk
+ * is used before any other block
+ */
+void
+test__SlabFree__ReusesFreedChunk(void **state)
+{
+	MemoryContext context = SlabContextCreate(TopMemoryContext, "test",
+			SLAB_CHUNK_SIZE, SLAB_CHUNKS_PER_BLOCK);
+	SlabContext *slab = (SlabContext *) context;
+	void *chunks[SLAB_CHUNKS_PER_BLOCK + 1];
+
+	for (int i = 0; i < SLAB_CHUNKS_PER_BLOCK + 1; i++)
+	{
+		chunks[i] = MemoryContextAlloc(context, SLAB_CHUNK_SIZE);
+	}
+
+	SlabBlock first = SlabChunkBlock(SlabPointerGetChunk(chunks[0]));
+	assert_true(slab->fullBlocks == first);
+	assert_true(slab->blocks != first);
+	assert_true(slab->nchunks == SLAB_CHUNKS_PER_BLOCK + 1);
+
+	pfree(chunks[1]);
+	assert_true(slab->blocks == first);
+	assert_true(slab->fullBlocks == NULL);
+
+	assert_true(MemoryContextAlloc(context, SLAB_CHUNK_SIZE) == chunks[1]);
+	assert_true(slab->fullBlocks == first);
+
+	MemoryContextDelete(context);
+}
+
+/*
+ * One block without chunks in use is kept aside, the others are freed
+ */
+void
+test__SlabFree__KeepsOneEmptyBlock(void **state)
+{
+	MemoryContext context = SlabContextCreate(TopMemoryContext, "test",
+			SLAB_CHUNK_SIZE, SLAB_CHUNKS_PER_BLOCK);
+	SlabContext *slab = (SlabContext *) context;
+	void *chunks[2 * SLAB_CHUNKS_PER_BLOCK];
+
+	for (int i = 0; i < 2 * SLAB_CHUNKS_PER_BLOCK; i++)
+	{
+		chunks[i] = MemoryContextAlloc(context, SLAB_CHUNK_SIZE);
+	}
+
+	assert_true(context->allBytesAlloc - context->allBytesFreed == 2 * slab->blockSize);
+
+	SlabBlock kept = SlabChunkBlock(SlabPointerGetChunk(chunks[0]));
+	for (int i = 0; i < SLAB_CHUNKS_PER_BLOCK; i++)
+	{
+		pfree(chunks[i]);
+	}
+
+	assert_true(slab->emptyBlock == kept);
+	assert_true(context->allBytesAlloc - context->allBytesFreed == 2 * slab->blockSize);
+
+	for (int i = SLAB_CHUNKS_PER_BLOCK; i < 2 * SLAB_CHUNKS_PER_BLOCK; i++)
+	{
+		pfree(chunks[i]);
+	}
+
+	assert_true(slab->emptyBlock == kept);
+	assert_true(slab->blocks == NULL && slab->fullBlocks == NULL);
+	assert_true(context->allBytesAlloc - context->allBytesFreed == slab->blockSize);
+	assert_true(MemoryContextIsEmpty(context));
+
+	/* the kept block is used again */
+	void *chunk = MemoryContextAlloc(context, SLAB_CHUNK_SIZE);
+	assert_true(SlabChunkBlock(SlabPointerGetChunk(chunk)) == kept);
+	assert_true(slab->emptyBlock == NULL);
+
+	MemoryContextDelete(context);
+}
+
+/*
+ * Chunks are reallocated in place, but cannot grow beyond the chunk size
+ */
+void
+test__SlabRealloc__StaysInChunk(void **state)
+{
+	MemoryContext context = SlabContextCreate(TopMemoryContext, "test",
+			SLAB_CHUNK_SIZE, SLAB_CHUNKS_PER_BLOCK);
+	SlabContext *slab = (SlabContext *) context;
+
+	char *chunk = MemoryContextAlloc(context, 10);
+	assert_true(repalloc(chunk, slab->chunkSize) == chunk);
+
+	/* Expect an error */
+	will_be_called(elog_start);
+	expect_any(elog_start, filename);
+	expect_any(elog_start, lineno);
+	expect_any(elog_start, funcname);
+	will_be_called_with_sideeffect(elog_finish, &_ExceptionalCondition, NULL);
+	expect_value(elog_finish, elevel, ERROR);
+	expect_any(elog_finish, fmt);
+
+	bool errorThrown = false;
+	PG_TRY();
+	{
+		repalloc(chunk, slab->chunkSize + 1);
+	}
+	PG_CATCH();
+	{
+		errorThrown = true;
+	}
+	PG_END_TRY();
+
+	assert_true(errorThrown);
+
+	MemoryContextDelete(context);
+}
+
+/*
+ * Blocks are charged to the active memory account, and released on reset
+ */
+void
+test__SlabReset__ReleasesAccounting(void **state)
+{
+	MemoryAccount *newActiveAccount = MemoryAccounting_CreateAccount(0, MEMORY_OWNER_TYPE_Exec_Hash);
+	MemoryAccount *oldActiveAccount = MemoryAccounting_SwitchAccount(newActiveAccount);
+
+	MemoryContext context = SlabContextCreate(TopMemoryContext, "test",
+			SLAB_CHUNK_SIZE, SLAB_CHUNKS_PER_BLOCK);
+	SlabContext *slab = (SlabContext *) context;
+
+	uint64 prevOutstanding = MemoryAccountingOutstandingBalance;
+	uint64 prevBalance = newActiveAccount->allocated - newActiveAccount->freed;
+
+	for (int i = 0; i < SLAB_CHUNKS_PER_BLOCK + 1; i++)
+	{
+		MemoryContextAlloc(context, SLAB_CHUNK_SIZE);
+	}
+
+	assert_true(newActiveAccount->allocated - newActiveAccount->freed ==
+			prevBalance + 2 * slab->blockSize);
+	assert_true(MemoryAccountingOutstandingBalance == prevOutstanding + 2 * slab->blockSize);
+
+	MemoryContextReset(context);
+
+	assert_true(newActiveAccount->allocated - newActiveAccount->freed == prevBalance);
+	assert_true(MemoryAccountingOutstandingBalance == prevOutstanding);
+	assert_true(slab->nchunks == 0);
+	assert_true(context->allBytesAlloc == context->allBytesFreed);
+
+	MemoryContextDelete(context);
+
+	MemoryAccounting_SwitchAccount(oldActiveAccount);
+}
+
+int 
+main(int argc, char* argv[]) 
+{
+        cmockery_parse_arguments(argc, argv);
+
+        const UnitTest tests[] = {
+			unit_test_setup_teardown(test__SlabContextCreate__AlignsChunks, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+			unit_test_setup_teardown(test__SlabFree__ReusesFreedChunk, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+			unit_test_setup_teardown(test__SlabFree__KeepsOneEmptyBlock, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+			unit_test_setup_teardown(test__SlabRealloc__StaysInChunk, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+			unit_test_setup_teardown(test__SlabReset__ReleasesAccounting, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+        };
+        return run_tests(tests);
+}
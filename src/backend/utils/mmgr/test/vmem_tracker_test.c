@@ -193,6 +193,7 @@ test__VmemTracker_ReserveVmem__FailForInvalidSize(void **state)
  * 1. Cache satisfiable reservations use cache
  * 2. Insufficient cache triggers new reservation (i.e., increase cache)
  * 3. Freeing would leave unused cache, that can be reused later
+ * 4. Freeing keeps one unused chunk reserved, unless nothing is in use
  */
 void
 test__VmemTracker_ReserveVmem__CacheSanity(void **state)
@@ -205,7 +206,7 @@ test__VmemTracker_ReserveVmem__CacheSanity(void **state)
 	assert_true(0 == trackedVmemChunks);
 
 #ifdef USE_ASSERT_CHECKING
-	will_return_count(MemoryProtection_IsOwnerThread, true, 6);
+	will_return_count(MemoryProtection_IsOwnerThread, true, 9);
 #endif
 
 	int64 prevTrackedBytes = trackedBytes;
@@ -243,21 +244,29 @@ test__VmemTracker_ReserveVmem__CacheSanity(void **state)
 	VmemTracker_ReserveVmem(twoChunkBytes + 1);
 	assert_true(5 == trackedVmemChunks);
 
-	/* Free one chunk. */
+	/* Free one chunk, which is kept in reserve */
+	VmemTracker_ReleaseVmem(oneChunkBytes);
+	assert_true(5 == trackedVmemChunks);
+
+	/* Free one more chunk, the first one is released now */
 	VmemTracker_ReleaseVmem(oneChunkBytes);
 	assert_true(4 == trackedVmemChunks);
 
 	VmemTracker_ReserveVmem(oneChunkBytes / 2);
 	assert_true(4 == trackedVmemChunks);
 
-	/* Still not reserving any additional chunks */
-	VmemTracker_ReserveVmem(oneChunkBytes / 2 - 1);
+	/* Still not reserving any additional chunks, the reserve is used */
+	VmemTracker_ReserveVmem(oneChunkBytes + oneChunkBytes / 2 - 1);
 	assert_true(4 == trackedVmemChunks);
 
 	will_be_called(RedZoneHandler_DetectRunawaySession);
 	/* 1 more byte, and we need a new chunk */
 	VmemTracker_ReserveVmem(1);
 	assert_true(5 == trackedVmemChunks);
+
+	/* Nothing is kept in reserve once nothing is in use */
+	VmemTracker_ReleaseVmem(trackedBytes);
+	assert_true(0 == trackedVmemChunks);
 }
 
 /*
@@ -36,6 +36,7 @@
 #include "utils/faultinjection.h"
 #include "utils/vmem_tracker.h"
 #include "utils/session_state.h"
+#include "utils/memaccounting_snapshot.h"
 
 #include <sys/sysctl.h>
 
@@ -546,6 +547,50 @@ VmemTracker_GetAvailableQueryVmemMB()
 	}
 }
 
+/*
+ * Returns how many bytes an operator having the memory quota of quotaBytes,
+ * grownBytes of which were grown before, may grow its quota by instead of
+ * spilling, or 0 if it should spill.
+ *
+ * The quota is doubled, as long as the growth stays below
+ * gp_operator_mem_grow_limit and at least the same amount of vmem is left
+ * free on the segment, and for the query if it is limited, for the others.
+ * The grown memory is given back as the operator frees it.
+ */
+int64
+VmemTracker_GetOperatorMemoryGrowth(int64 quotaBytes, int64 grownBytes)
+{
+	int64 limitBytes = ((int64) gp_operator_mem_grow_limit) * 1024L;
+	int64 growBytes = quotaBytes;
+
+	if (!vmemTrackerInited || limitBytes <= 0 || growBytes <= 0)
+	{
+		return 0;
+	}
+
+	if (grownBytes + growBytes > limitBytes)
+	{
+		growBytes = limitBytes - grownBytes;
+		if (growBytes <= 0)
+		{
+			return 0;
+		}
+	}
+
+	if (CHUNKS_TO_BYTES(VmemTracker_GetNonNegativeAvailableVmemChunks()) < 2 * growBytes)
+	{
+		return 0;
+	}
+
+	if (maxChunksPerQuery > 0 &&
+		CHUNKS_TO_BYTES(VmemTracker_GetNonNegativeAvailableQueryChunks()) < 2 * growBytes)
+	{
+		return 0;
+	}
+
+	return growBytes;
+}
+
 /*
  * Reserve newly_requested bytes from the vmem system.
  *
@@ -592,6 +637,12 @@ VmemTracker_ReserveVmem(int64 newlyRequestedBytes)
 		 */
 		ReportOOMConsumption();
 
+		/* Growing is when the memory accounts are worth looking at */
+		if (gp_memory_account_publish_interval > 0)
+		{
+			MemoryAccounting_PublishSnapshot();
+		}
+
 		int32 needChunk = newszChunk - trackedVmemChunks;
 		status = VmemTracker_ReserveVmemChunks(needChunk);
 	}
@@ -609,7 +660,11 @@ VmemTracker_ReserveVmem(int64 newlyRequestedBytes)
  * Releases toBeFreedRequested bytes from the vmem system.
  *
  * For performance reason this method accumulates free requests until it has
- * enough bytes to free a whole chunk.
+ * enough bytes to free a whole chunk.  Beyond that, one chunk is kept in
+ * reserve while the process still uses any: otherwise a process whose usage
+ * hovers around a chunk boundary, e.g., allocating and freeing a block for
+ * every tuple, would reserve and release a chunk in the shared counters each
+ * time, and check for runaway sessions along with it.
  */
 void
 VmemTracker_ReleaseVmem(int64 toBeFreedRequested)
@@ -638,6 +693,12 @@ VmemTracker_ReleaseVmem(int64 toBeFreedRequested)
 
 	int newszChunk = trackedBytes >> chunkSizeInBits;
 
+	if (newszChunk > 0)
+	{
+		/* keep one chunk in reserve */
+		newszChunk++;
+	}
+
 	if (newszChunk < trackedVmemChunks)
 	{
 		int reduction = trackedVmemChunks - newszChunk;
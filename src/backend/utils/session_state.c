@@ -91,6 +91,8 @@ SessionState_Acquire(int sessionId)
 				0 == acquired->spinLock &&
 				0 == acquired->sessionVmemRunaway &&
 				0 == acquired->commandCountRunaway &&
+				!acquired->runawaySpill &&
+				0 == acquired->sessionVmemSpill &&
 				!acquired->isModifiedSessionId);
 
 		AllSessionStateEntries->freeList = acquired->next;
@@ -104,6 +106,8 @@ SessionState_Acquire(int sessionId)
 		acquired->runawayStatus = RunawayStatus_NotRunaway;
 		acquired->sessionVmemRunaway = 0;
 		acquired->commandCountRunaway = 0;
+		acquired->runawaySpill = false;
+		acquired->sessionVmemSpill = 0;
 		acquired->pinCount = 0;
 		acquired->sessionVmem = 0;
 		acquired->cleanupCountdown = CLEANUP_COUNTDOWN_BEFORE_RUNAWAY;
@@ -178,6 +182,8 @@ SessionState_Release(SessionState *acquired)
 		acquired->runawayStatus = RunawayStatus_NotRunaway;
 		acquired->sessionVmemRunaway = 0;
 		acquired->commandCountRunaway = 0;
+		acquired->runawaySpill = false;
+		acquired->sessionVmemSpill = 0;
 		acquired->cleanupCountdown = CLEANUP_COUNTDOWN_BEFORE_RUNAWAY;
 		acquired->activeProcessCount = 0;
 
@@ -140,6 +140,7 @@
 #include "utils/tuplesort_mk.h"
 #include "utils/string_wrapper.h"
 #include "utils/faultinjector.h"
+#include "utils/vmem_tracker.h"
 
 #include "cdb/cdbvars.h"
 
@@ -224,6 +225,7 @@ struct Tuplesortstate_mk
     bool		randomAccess;	/* did caller request random access? */
 
     long 		memAllowed;
+    bool		spillRequested;	/* runaway cleaner asked us to go to tape */
 
     int		maxTapes;	/* number of tapes (Knuth's T) */
     int		tapeRange;	/* maxTapes-1 (Knuth's P) */
@@ -331,6 +333,7 @@ struct Tuplesortstate_mk
      * "logical" and "actual" tape numbers straight!
      */
     int	Level;			/* Knuth's l */
+    int	maxLevel;		/* highest Level reached, i.e., the merge passes */
     int	destTape;		/* current output tape (Knuth's j, less 1) */
     int   	*tp_fib;		/* Target Fibonacci run counts (A[]) */
     int   	*tp_runs;		/* # of real runs on each tape */
@@ -473,6 +476,7 @@ static inline bool LACKMEM_WITH_ESTIMATE(Tuplesortstate_mk *state)
 
 static Tuplesortstate_mk *tuplesort_begin_common(ScanState * ss, int workMem, bool randomAccess, bool allocmemtuple);
 static void puttuple_common(Tuplesortstate_mk *state, MKEntry *e); 
+static bool tuplesort_request_spill_mk(void *arg);
 static void selectnewtape_mk(Tuplesortstate_mk *state);
 static void mergeruns(Tuplesortstate_mk *state);
 static void beginmerge(Tuplesortstate_mk *state);
@@ -501,6 +505,8 @@ static void readtup_datum(Tuplesortstate_mk *state, TuplesortPos_mk *pos, MKEntr
 
 static void tupsort_prepare_char(MKEntry *a, bool isChar);
 static int tupsort_compare_char(MKEntry *v1, MKEntry *v2, MKLvContext *lvctxt, MKContext *mkContext);
+static inline uint64 tupsort_normalized_key(const char *p, int len);
+static inline int bcTruelen(char *p, int len);
 
 static Datum tupsort_fetch_datum_mtup(MKEntry *a, MKContext *mkctxt, MKLvContext *lvctxt, bool *isNullOut);
 static Datum tupsort_fetch_datum_itup(MKEntry *a, MKContext *mkctxt, MKLvContext *lvctxt, bool *isNullOut);
@@ -512,6 +518,8 @@ static void tuplesort_inmem_limit_insert(Tuplesortstate_mk *state, MKEntry *e);
 static void tuplesort_inmem_nolimit_insert(Tuplesortstate_mk * state, MKEntry * e);
 static void tuplesort_heap_insert(Tuplesortstate_mk *state, MKEntry *e);
 static void tuplesort_limit_sort(Tuplesortstate_mk *state);
+static uint64 tuplesort_memwanted_mk(Tuplesortstate_mk *state);
+static bool tuplesort_parallel_sortable(Tuplesortstate_mk *state);
 
 static void tupsort_refcnt(void *vp, int ref); 
 
@@ -594,6 +602,8 @@ tuplesort_begin_common(ScanState * ss, int workMem, bool randomAccess, bool allo
         /* workMem must be large enough for the minimal memtuples array */
         if (LACKMEM_WITH_ESTIMATE(state))
             elog(ERROR, "insufficient memory allowed for sort");
+
+        RunawayCleaner_RegisterSpillCallback(tuplesort_request_spill_mk, state);
     } 
 
     /*
@@ -678,6 +688,7 @@ create_mksort_context(
     mkctxt->cpfr = tupsort_cpfr;
     mkctxt->freeTup = freeTupleFn;
     mkctxt->estimatedExtraForPrep = 0;
+    mkctxt->inWorker = false;
 
     lc_guess_strxfrm_scaling_factor(&mkctxt->strxfrmScaleFactor, &mkctxt->strxfrmConstantFactor);
 
@@ -729,6 +740,13 @@ create_mksort_context(
                 else if (sinfo->fmgrinfo.fn_addr == bttextcmp)
                     sinfo->lvtype = MKLV_TYPE_TEXT;
             }
+            else
+            {
+                if(sinfo->fmgrinfo.fn_addr == bpcharcmp)
+                    sinfo->lvtype = MKLV_TYPE_CHAR_C;
+                else if (sinfo->fmgrinfo.fn_addr == bttextcmp)
+                    sinfo->lvtype = MKLV_TYPE_TEXT_C;
+            }
         }
         else
         {
@@ -964,6 +982,8 @@ tuplesort_end_mk(Tuplesortstate_mk *state)
 {
     long		spaceUsed;
 
+    RunawayCleaner_UnregisterSpillCallback(tuplesort_request_spill_mk, state);
+
     if (state->tapeset)
         spaceUsed = LogicalTapeSetBlocks(state->tapeset);
     else
@@ -990,6 +1010,9 @@ tuplesort_end_mk(Tuplesortstate_mk *state)
 
     if (state->work_set)
     {
+    	workfile_mgr_report_spill(state->work_set, state->instrument,
+    			state->currentRun, state->maxLevel,
+    			tuplesort_memwanted_mk(state));
     	workfile_mgr_close_set(state->work_set);
     }
 
@@ -1005,6 +1028,38 @@ tuplesort_end_mk(Tuplesortstate_mk *state)
     MemoryContextDelete(state->sortcontext);
 }
 
+/*
+ * tuplesort_memwanted_mk
+ *
+ * Estimate the memory that would have sorted all tuples in memory, 0 if the
+ * sort did not spill.
+ */
+static uint64
+tuplesort_memwanted_mk(Tuplesortstate_mk *state)
+{
+	if (state->numTuplesInMem == 0 || state->numTuplesInMem >= state->totalNumTuples)
+		return 0;
+
+	uint64 mem_for_metadata = sizeof(Tuplesortstate_mk) +
+		state->arraySizeBeforeSpill * sizeof(MKEntry);
+	double tupleRatio = ((double)state->totalNumTuples) / ((double)state->numTuplesInMem);
+
+	/*
+	 * The memwanted is summed up of the following:
+	 * (1) metadata 
+	 * (2) the array size
+	 * (3) the prorated number of bytes for all tuples, estimated from
+	 *     the memUsedBeforeSpill. Note that because of our memory allocation
+	 *     algorithm, the used memory for tuples may be much larger than
+	 *     the actual bytes needed for tuples.
+	 * (4) the prorated number of bytes for extra space needed.
+	 */
+	return sizeof(Tuplesortstate_mk) /* (1) */ +
+		state->totalNumTuples * sizeof(MKEntry) /* (2) */ +
+		(uint64)(tupleRatio * (double)(state->memUsedBeforeSpill - mem_for_metadata)) /* (3) */ +
+		(uint64)(tupleRatio * (double)state->mkctxt.estimatedExtraForPrep) /* (4) */ ;
+}
+
 /*
  * tuplesort_finalize_stats_mk
  *
@@ -1027,28 +1082,8 @@ tuplesort_finalize_stats_mk(Tuplesortstate_mk *state)
 
 		if (state->numTuplesInMem < state->totalNumTuples)
 		{
-			uint64 mem_for_metadata = sizeof(Tuplesortstate_mk) +
-				state->arraySizeBeforeSpill * sizeof(MKEntry);
-			double tupleRatio = ((double)state->totalNumTuples) / ((double)state->numTuplesInMem);
-
-			/*
-			 * The memwanted is summed up of the following:
-			 * (1) metadata 
-			 * (2) the array size
-			 * (3) the prorated number of bytes for all tuples, estimated from
-			 *     the memUsedBeforeSpill. Note that because of our memory allocation
-			 *     algorithm, the used memory for tuples may be much larger than
-			 *     the actual bytes needed for tuples.
-			 * (4) the prorated number of bytes for extra space needed.
-			 */
-			uint64 memwanted = 
-				sizeof(Tuplesortstate_mk) /* (1) */ +
-				state->totalNumTuples * sizeof(MKEntry) /* (2) */ +
-				(uint64)(tupleRatio * (double)(state->memUsedBeforeSpill - mem_for_metadata)) /* (3) */ +
-				(uint64)(tupleRatio * (double)state->mkctxt.estimatedExtraForPrep) /* (4) */ ;
-			
 			state->instrument->workmemwanted =
-				Max(state->instrument->workmemwanted, memwanted);
+				Max(state->instrument->workmemwanted, tuplesort_memwanted_mk(state));
 		}
 
 		state->statsFinalized = true;
@@ -1190,6 +1225,24 @@ grow_unsorted_array(Tuplesortstate_mk *state)
 }
 
 
+/*
+ * Runaway cleaner callback: ask an in-memory sort to switch to tape-based
+ * operation on the next incoming tuple instead of growing its array.
+ * Only an unbounded sort still accumulating input can do that.
+ */
+static bool
+tuplesort_request_spill_mk(void *arg)
+{
+    Tuplesortstate_mk *state = (Tuplesortstate_mk *) arg;
+
+    if (state->status != TSS_INITIAL || state->mkheap != NULL ||
+        state->mkctxt.limit != 0 || state->entry_count == 0)
+        return false;
+
+    state->spillRequested = true;
+    return true;
+}
+
 /*
  * Shared code for tuple and datum cases.
  */
@@ -1215,10 +1268,16 @@ puttuple_common(Tuplesortstate_mk *state, MKEntry *e)
              * room to store the incoming tuple, and then we'll switch to
              * tape-based operation.
              */
-            if (!state->mkheap && state->entry_count >= state->entry_allocsize - 1) 
+            if (state->spillRequested && !state->mkheap && state->entry_count > 0)
+            {
+            	/* Runaway cleaner asked us to stop growing, go to tape now */
+            	growSucceed = false;
+            }
+            else if (!state->mkheap && state->entry_count >= state->entry_allocsize - 1) 
             {
             	growSucceed = grow_unsorted_array(state);
             }
+            state->spillRequested = false;
 
             /* full sort? */
             if (state->mkctxt.limit == 0)
@@ -1282,6 +1341,9 @@ tuplesort_performsort_mk(Tuplesortstate_mk *state)
 {
     MemoryContext oldcontext = MemoryContextSwitchTo(state->sortcontext);
 
+    /* No more input, nothing left that a spill could save */
+    RunawayCleaner_UnregisterSpillCallback(tuplesort_request_spill_mk, state);
+
     if (trace_sort)
         PG_TRACE(tuplesort__perform__sort);
 
@@ -1292,10 +1354,13 @@ tuplesort_performsort_mk(Tuplesortstate_mk *state)
              * We were able to accumulate all the tuples within the allowed
              * amount of memory.  Just qsort 'em and we're done.
              */
-            if(state->mkctxt.limit == 0)
-                mk_qsort(state->entries, state->entry_count, &state->mkctxt);
-            else
+            if(state->mkctxt.limit != 0)
                 tuplesort_limit_sort(state);
+            else if (tuplesort_parallel_sortable(state))
+                mk_qsort_parallel(state->entries, state->entry_count, &state->mkctxt,
+                                  gp_mk_sort_threads);
+            else
+                mk_qsort(state->entries, state->entry_count, &state->mkctxt);
 
             state->pos.current = 0;
             state->pos.eof_reached = false;
@@ -1754,7 +1819,7 @@ inittapes_mk(Tuplesortstate_mk *state, const char* rwfile_prefix)
      */
     if(!rwfile_prefix)
     {
-        state->work_set = workfile_mgr_create_set(BUFFILE, can_be_reused, ps, NULL_SNAPSHOT);
+        state->work_set = workfile_mgr_create_set(BUFFILE, can_be_reused, ps, workfile_mgr_snapshot(ps));
         state->tapeset_state_file = workfile_mgr_create_fileno(state->work_set, WORKFILE_NUM_MKSORT_METADATA);
 
         ExecWorkFile *tape_file = workfile_mgr_create_fileno(state->work_set, WORKFILE_NUM_MKSORT_TAPESET);
@@ -1866,6 +1931,7 @@ selectnewtape_mk(Tuplesortstate_mk *state)
 
     /* Step D4: increase level */
     state->Level++;
+    state->maxLevel = Max(state->maxLevel, state->Level);
     a = state->tp_fib[0];
     for (j = 0; j < state->tapeRange; j++)
     {
@@ -2983,7 +3049,23 @@ int tupsort_compare_datum(MKEntry *v1, MKEntry *v2, MKLvContext *lvctxt, MKConte
                 int result = (i1 < i2) ? -1 : ((i1 == i2) ? 0 : 1);
                 return (lvctxt->sortfnkind == SORTFUNC_CMP) ? result : -result;
             }
+        case MKLV_TYPE_CHAR_C:
+        case MKLV_TYPE_TEXT_C:
+            if (v1->nkey != v2->nkey)
+            {
+                int result = (v1->nkey < v2->nkey) ? -1 : 1;
+                return (lvctxt->sortfnkind == SORTFUNC_CMP) ? result : -result;
+            }
+            return inlineApplySortFunction(&lvctxt->fmgrinfo, lvctxt->sortfnkind,
+                    v1->d, false,
+                    v2->d, false
+                    );
         default:
+            if (v1->nkey != v2->nkey)
+            {
+                int result = (v1->nkey < v2->nkey) ? -1 : 1;
+                return (lvctxt->sortfnkind == SORTFUNC_CMP) ? result : -result;
+            }
             return tupsort_compare_char(v1, v2, lvctxt, context);
     }
 
@@ -3190,10 +3272,63 @@ void tupsort_prepare(MKEntry *a, MKContext *mkctxt, int lv)
     else
         mke_set_null(a, lvctxt->nullfirst);
 
-    if (lvctxt->lvtype == MKLV_TYPE_CHAR)
-        tupsort_prepare_char(a, true);
-    else if (lvctxt->lvtype == MKLV_TYPE_TEXT)
-        tupsort_prepare_char(a, false);
+    if (isnull)
+        return;
+
+    switch (lvctxt->lvtype)
+    {
+        case MKLV_TYPE_CHAR:
+        case MKLV_TYPE_TEXT:
+            {
+                refcnt_locale_str *p;
+
+                tupsort_prepare_char(a, lvctxt->lvtype == MKLV_TYPE_CHAR);
+
+                p = (refcnt_locale_str *) DatumGetPointer(a->d);
+                a->nkey = tupsort_normalized_key(p->data + p->xfrm_pos,
+                                                 strlen(p->data + p->xfrm_pos));
+                break;
+            }
+        case MKLV_TYPE_CHAR_C:
+        case MKLV_TYPE_TEXT_C:
+            {
+                char *p;
+                int len;
+                void *tofree;
+
+                varattrib_untoast_ptr_len(a->d, &p, &len, &tofree);
+                if (lvctxt->lvtype == MKLV_TYPE_CHAR_C)
+                    len = bcTruelen(p, len);
+
+                a->nkey = tupsort_normalized_key(p, len);
+
+                if (tofree)
+                    pfree(tofree);
+                break;
+            }
+        default:
+            break;
+    }
+}
+
+/*
+ * The normalized key of the `len` bytes at p: the first bytes loaded
+ * big-endian, zero padded.  As the strings compared hold no '\0', a key
+ * which is a prefix of another has the smaller normalized key, as it sorts
+ * first.
+ */
+static inline uint64 tupsort_normalized_key(const char *p, int len)
+{
+    uint64 nkey = 0;
+    int i;
+
+    for (i = 0; i < (int) sizeof(uint64); i++)
+    {
+        nkey <<= 8;
+        if (i < len)
+            nkey |= (unsigned char) p[i];
+    }
+    return nkey;
 }
 
 /* "True" length (not counting trailing blanks) of a BpChar */
@@ -3516,6 +3651,45 @@ static void tuplesort_heap_insert(Tuplesortstate_mk *state, MKEntry *e)
     }
 }
 
+/*
+ * Can the in-memory sort be split across gp_mk_sort_threads threads?
+ *
+ * The threads compare and prepare the entries with no memory allocated,
+ * no error raised, and nothing shared written. That holds for keys of
+ * pass-by-value types, fetched from memtuples and compared by built-in
+ * functions, in a sort that neither discards nor checks duplicates.
+ */
+static bool tuplesort_parallel_sortable(Tuplesortstate_mk *state)
+{
+    MKContext *mkctxt = &state->mkctxt;
+    int lv;
+
+    if (gp_mk_sort_threads <= 0 || state->entry_count < MKQS_PARALLEL_MIN_ENTRIES)
+        return false;
+
+    if (mkctxt->unique || mkctxt->enforceUnique || mkctxt->limit != 0)
+        return false;
+
+    if (mkctxt->fetchForPrep != NULL && mkctxt->fetchForPrep != tupsort_fetch_datum_mtup)
+        return false;
+
+    for (lv = 0; lv < mkctxt->total_lv; lv++)
+    {
+        MKLvContext *lvctxt = &mkctxt->lvctxt[lv];
+
+        if (!lvctxt->typByVal ||
+            lvctxt->lvtype == MKLV_TYPE_CHAR ||
+            lvctxt->lvtype == MKLV_TYPE_TEXT)
+            return false;
+
+        if (lvctxt->lvtype == MKLV_TYPE_NONE &&
+            lvctxt->fmgrinfo.fn_oid >= FirstBootstrapObjectId)
+            return false;
+    }
+
+    return true;
+}
+
 static void tuplesort_limit_sort(Tuplesortstate_mk *state)
 {
     Assert(state->mkctxt.limit > 0);
@@ -27,9 +27,14 @@
  */
 
 #include "postgres.h"
+
+#include <pthread.h>
+
 #include "utils/tuplesort.h"
 #include "utils/tuplesort_mk.h"
+#include "utils/atomic.h"
 
+#include "cdb/cdbgang.h"			/* gp_pthread_create */
 #include "miscadmin.h"
 
 #ifdef MKQSORT_VERIFY 
@@ -275,7 +280,9 @@ void mk_qsort_impl(MKEntry *a, int left, int right, int lv, bool lvdown, MKConte
 	Assert(ctxt);
 	Assert(lv < ctxt->total_lv);
 
-    CHECK_FOR_INTERRUPTS();
+	/* A thread cannot longjmp out of the sort; see mk_qsort_parallel */
+	if (!ctxt->inWorker)
+		CHECK_FOR_INTERRUPTS();
 
 	if(right <= left)
 		return;
@@ -341,6 +348,181 @@ void mk_qsort_impl(MKEntry *a, int left, int right, int lv, bool lvdown, MKConte
 #endif
 }
 
+/*
+ * A range of entries that mk_qsort_impl would recurse into, left to sort
+ * by a thread of mk_qsort_parallel.
+ */
+typedef struct MKQSortTask
+{
+	int left;
+	int right;
+	int lv;
+	bool lvdown;
+	bool seenNull;
+} MKQSortTask;
+
+typedef struct MKQSortTasks
+{
+	MKEntry *a;
+	MKContext *ctxt;
+	MKQSortTask *tasks;
+	int ntasks;
+	volatile int32 next;		/* the task to take by gp_atomic_add_32 */
+} MKQSortTasks;
+
+/* Ranges per thread, so that the threads finish about the same time */
+#define MKQS_TASKS_PER_THREAD 8
+
+static int mkqs_task_size(const MKQSortTask *task)
+{
+	return task->right - task->left + 1;
+}
+
+static int mkqs_task_cmp_size_desc(const void *a, const void *b)
+{
+	return mkqs_task_size((const MKQSortTask *) b) - mkqs_task_size((const MKQSortTask *) a);
+}
+
+/*
+ * Sort the ranges not yet taken by another thread.
+ */
+static void *mk_qsort_worker(void *arg)
+{
+	MKQSortTasks *tasks = (MKQSortTasks *) arg;
+
+	for (;;)
+	{
+		int32 taskno = gp_atomic_add_32(&tasks->next, 1) - 1;
+		MKQSortTask *task;
+
+		if (taskno >= tasks->ntasks)
+			break;
+
+		task = &tasks->tasks[taskno];
+		mk_qsort_impl(tasks->a, task->left, task->right, task->lv, task->lvdown,
+					  tasks->ctxt, task->seenNull);
+	}
+
+	return NULL;
+}
+
+/*
+ * mk_qsort on up to nthreads threads besides the backend.
+ *
+ * The backend partitions the array the way mk_qsort_impl does, always the
+ * largest range first, until there are MKQS_TASKS_PER_THREAD ranges per
+ * thread. The ranges are independent, so the threads then sort them with
+ * mk_qsort_impl, with the backend taking ranges too, and nothing is left to
+ * merge. The result is the order mk_qsort gives.
+ *
+ * The threads must not allocate memory, raise an error or service an
+ * interrupt: the caller only calls this for keys that are compared and
+ * prepared without any of those (see tuplesort_parallel_sortable), and
+ * ctxt->inWorker keeps mk_qsort_impl from checking for interrupts until
+ * the threads are joined. The backend sorts alone if no thread can be
+ * created.
+ */
+void mk_qsort_parallel(MKEntry *a, int n, MKContext *ctxt, int nthreads)
+{
+	MKContext workerctxt;
+	MKQSortTasks tasks;
+	pthread_t *threads;
+	int maxtasks = MKQS_TASKS_PER_THREAD * (nthreads + 1);
+	int mintask = n / maxtasks;
+	int nstarted = 0;
+	int i;
+
+	Assert(nthreads > 0 && n > maxtasks);
+	Assert(!ctxt->unique && !ctxt->enforceUnique && ctxt->limit == 0);
+
+	/* Each split replaces a range by up to 3 */
+	tasks.tasks = (MKQSortTask *) palloc((maxtasks + 2) * sizeof(MKQSortTask));
+	tasks.tasks[0].left = 0;
+	tasks.tasks[0].right = n - 1;
+	tasks.tasks[0].lv = 0;
+	tasks.tasks[0].lvdown = true;
+	tasks.tasks[0].seenNull = false;
+	tasks.ntasks = 1;
+
+	while (tasks.ntasks + 2 <= maxtasks)
+	{
+		MKQSortTask task;
+		int largest = 0;
+		int lastInLow;
+		int firstInHigh;
+
+		CHECK_FOR_INTERRUPTS();
+
+		for (i = 1; i < tasks.ntasks; i++)
+		{
+			if (mkqs_task_size(&tasks.tasks[i]) > mkqs_task_size(&tasks.tasks[largest]))
+				largest = i;
+		}
+
+		task = tasks.tasks[largest];
+		if (mkqs_task_size(&task) <= Max(mintask, 1))
+			break;
+
+		if (task.lvdown)
+			mk_prepare_array(a, task.left, task.right, task.lv, ctxt);
+
+		mk_qsort_part3(a, task.left, task.right, task.lv, ctxt, &lastInLow, &firstInHigh);
+
+		tasks.tasks[largest].right = lastInLow;
+		tasks.tasks[largest].lvdown = false;
+
+		/* The middle range is equal at lv, and sorted at the last level */
+		if (task.lv < ctxt->total_lv - 1)
+		{
+			MKQSortTask *middle = &tasks.tasks[tasks.ntasks++];
+
+			middle->left = lastInLow + 1;
+			middle->right = firstInHigh - 1;
+			middle->lv = task.lv + 1;
+			middle->lvdown = true;
+			middle->seenNull = task.seenNull || mke_is_null(a + lastInLow + 1);
+		}
+
+		tasks.tasks[tasks.ntasks] = task;
+		tasks.tasks[tasks.ntasks].left = firstInHigh;
+		tasks.tasks[tasks.ntasks].lvdown = false;
+		tasks.ntasks++;
+	}
+
+	/* The largest ranges first */
+	qsort(tasks.tasks, tasks.ntasks, sizeof(MKQSortTask), mkqs_task_cmp_size_desc);
+
+	workerctxt = *ctxt;
+	workerctxt.inWorker = true;
+	tasks.a = a;
+	tasks.ctxt = &workerctxt;
+	tasks.next = 0;
+
+	nthreads = Min(nthreads, tasks.ntasks - 1);
+	threads = (pthread_t *) palloc(Max(nthreads, 1) * sizeof(pthread_t));
+	for (i = 0; i < nthreads; i++)
+	{
+		if (gp_pthread_create(&threads[nstarted], mk_qsort_worker,
+							  &tasks, "mk_qsort_parallel") != 0)
+			break;
+		nstarted++;
+	}
+
+	mk_qsort_worker(&tasks);
+
+	for (i = 0; i < nstarted; i++)
+		pthread_join(threads[i], NULL);
+
+	pfree(threads);
+	pfree(tasks.tasks);
+
+	CHECK_FOR_INTERRUPTS();
+
+#ifdef MKQSORT_VERIFY 
+	mkqsort_verify(a, 0, n - 1, ctxt);
+#endif
+}
+
 #ifdef MKQSORT_VERIFY 
 static int mkqsort_comp_entry_all_lv(MKEntry *a, MKEntry *b, MKContext *mkctxt)
 {
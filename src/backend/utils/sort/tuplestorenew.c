@@ -22,13 +22,20 @@
  */
 
 #include "postgres.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "access/heapam.h"
+#include "access/xact.h"
 #include "executor/instrument.h"
 #include "executor/execWorkfile.h"
 #include "utils/tuplestorenew.h"
 #include "utils/memutils.h"
 
-#include "cdb/cdbvars.h"                /* currentSliceId */
+#include "cdb/cdbvars.h"                /* currentSliceId, gp_shareinput_shm_limit */
 
 
 typedef struct NTupleStorePageHeader
@@ -160,6 +167,26 @@ static inline void update_page_slot_entry(NTupleStorePage *page, int len)
 	nts_page_set_dirty(page, true);
 }
 
+/*
+ * Shared memory copy of the pages of a reader writer store.
+ *
+ * When the writer has kept all its pages in memory, it copies them into a
+ * POSIX shared memory segment named after the share instead of writing them
+ * to the workfile, and the readers map the segment and read the pages from
+ * it. A writer that spilled, or that has lobs, uses the workfiles as before.
+ *
+ * The struct lives in TopMemoryContext, so that the end of transaction
+ * callback can release the segment if the store is never destroyed.
+ */
+typedef struct NTupleStoreShm
+{
+	char name[MAXPGPATH];	/* name of the segment */
+	bool isWriter;			/* true if we created the segment */
+	char *base;				/* mapped pages, NULL if not mapped */
+	Size size;				/* mapped size */
+	long nblocks;			/* number of pages in the segment */
+} NTupleStoreShm;
+
 /* tuple store type */
 #define NTS_NOT_READERWRITER 1
 #define NTS_IS_WRITER 2
@@ -188,6 +215,9 @@ struct NTupleStore
 	ExecWorkFile *plobfile;  /* underlying backed file for lobs (entries does not fit one page) */
 	int64     lobbytes;  /* number of bytes written to lob file */
 
+	char *shm_name;		/* segment name of a reader writer store, NULL otherwise */
+	NTupleStoreShm *shm;	/* shared memory copy of the pages, if any */
+
 	List *accessors;    /* all current accessors of the store */
 	bool fwacc; 		/* if I had already has a write acc */
 
@@ -226,6 +256,11 @@ struct NTupleStoreAccessor
 
 static void ntuplestore_init_reader(NTupleStore *store, int maxBytes);
 static void ntuplestore_create_spill_files(NTupleStore *nts);
+static NTupleStoreShm *nts_shm_register(const char *name);
+static void nts_shm_release(NTupleStoreShm *shm);
+static void XCallBack_NTupleStoreShm(XactEvent ev, void *vp);
+static bool nts_shm_publish(NTupleStore *ts);
+static void nts_shm_attach(NTupleStore *store);
 
 void ntuplestore_setinstrument(NTupleStore *st, struct Instrumentation *instr)
 {
@@ -331,15 +366,27 @@ static bool ntsReadBlock(NTupleStore *ts, int blockn, NTupleStorePage *page)
 {
 	long diskblockn = blockn - ts->first_ondisk_blockn;
 
-	if(!ts->pfile)
-		return false;
-	
-	Assert(ts->first_ondisk_blockn >= 0);
-	Assert(ts && diskblockn >= 0 && page);
-	if(ExecWorkFile_Seek(ts->pfile, diskblockn * BLCKSZ, SEEK_SET) != 0 ||
-			ExecWorkFile_Read(ts->pfile, page, BLCKSZ) != BLCKSZ)
+	if(ts->shm && ts->shm->base)
 	{
-		return false;
+		/* reader of a store published in shared memory */
+		Assert(ts->rwflag == NTS_IS_READER && blockn >= 0 && page);
+		if(blockn >= ts->shm->nblocks)
+			return false;
+
+		memcpy(page, ts->shm->base + (Size) blockn * BLCKSZ, BLCKSZ);
+	}
+	else
+	{
+		if(!ts->pfile)
+			return false;
+
+		Assert(ts->first_ondisk_blockn >= 0);
+		Assert(ts && diskblockn >= 0 && page);
+		if(ExecWorkFile_Seek(ts->pfile, diskblockn * BLCKSZ, SEEK_SET) != 0 ||
+				ExecWorkFile_Read(ts->pfile, page, BLCKSZ) != BLCKSZ)
+		{
+			return false;
+		}
 	}
 
 	Assert(nts_page_blockn(page) == blockn); 
@@ -650,6 +697,15 @@ ntuplestore_destroy(NTupleStore *ts)
 		ts->work_set = NULL;
 	}
 
+	if(ts->shm)
+	{
+		UnregisterXactCallbackOnce(XCallBack_NTupleStoreShm, ts->shm);
+		nts_shm_release(ts->shm);
+		ts->shm = NULL;
+	}
+	if(ts->shm_name)
+		pfree(ts->shm_name);
+
 	pfree(ts);
 }
 
@@ -665,6 +721,9 @@ ntuplestore_create(int maxBytes)
 	store->plobfile = NULL;
 	store->lobbytes = 0;
 
+	store->shm_name = NULL;
+	store->shm = NULL;
+
 	store->work_set = NULL;
 	store->cached_workfiles_found = false;
 	store->cached_workfiles_loaded = false;
@@ -725,6 +784,9 @@ ntuplestore_create_readerwriter(const char *filename, int maxBytes, bool isWrite
 		store->plobfile = ExecWorkFile_Create(filenamelob, BUFFILE,
 				true /* delOnClose */, 0 /* compressType */ );
 		store->lobbytes = 0;
+
+		store->shm_name = (char *) palloc(MAXPGPATH);
+		snprintf(store->shm_name, MAXPGPATH, "/hawq_%s", filename);
 	}
 	else
 	{
@@ -735,6 +797,11 @@ ntuplestore_create_readerwriter(const char *filename, int maxBytes, bool isWrite
 		store->cached_workfiles_loaded = false;
 		store->workfiles_created = false;
 
+		store->shm_name = (char *) palloc(MAXPGPATH);
+		snprintf(store->shm_name, MAXPGPATH, "/hawq_%s", filename);
+		store->shm = NULL;
+		nts_shm_attach(store);
+
 		store->pfile = ExecWorkFile_Open(filenameprefix, BUFFILE,
 				false /* delOnClose */,
 				0 /* compressType */);
@@ -883,6 +950,10 @@ ntuplestore_flush(NTupleStore *ts)
 	Assert(ts->rwflag != NTS_IS_READER || !"Flush attempted for Reader");
 	Assert(ts->pfile);
 
+	/* the readers of a store published in shared memory do not need the file */
+	if(ts->rwflag == NTS_IS_WRITER && nts_shm_publish(ts))
+		return;
+
 	while(p)
 	{
 		if(nts_page_is_dirty(p) && nts_page_slot_cnt(p) > 0)
@@ -902,6 +973,188 @@ ntuplestore_flush(NTupleStore *ts)
 	}
 }
 
+/*
+ * Allocate the shared memory state of a store, released at the end of the
+ * transaction unless the store is destroyed first.
+ */
+static NTupleStoreShm *
+nts_shm_register(const char *name)
+{
+	NTupleStoreShm *shm;
+
+	shm = (NTupleStoreShm *) MemoryContextAllocZero(TopMemoryContext, sizeof(NTupleStoreShm));
+	strlcpy(shm->name, name, sizeof(shm->name));
+
+	RegisterXactCallbackOnce(XCallBack_NTupleStoreShm, shm);
+
+	return shm;
+}
+
+/* Unmap the segment, and remove its name if we created it */
+static void
+nts_shm_release(NTupleStoreShm *shm)
+{
+	if(shm->base && munmap(shm->base, shm->size) < 0)
+		elog(LOG, "could not unmap tuplestore shared memory \"%s\": %m", shm->name);
+
+	if(shm->isWriter && shm_unlink(shm->name) < 0 && errno != ENOENT)
+		elog(LOG, "could not remove tuplestore shared memory \"%s\": %m", shm->name);
+
+	pfree(shm);
+}
+
+static void
+XCallBack_NTupleStoreShm(XactEvent ev, void *vp)
+{
+	nts_shm_release((NTupleStoreShm *) vp);
+}
+
+/*
+ * Copy the pages of a writer into a shared memory segment, instead of
+ * flushing them to the workfile.  Returns false if the store has spilled,
+ * has lobs, or is larger than gp_shareinput_shm_limit, or if the segment
+ * cannot be created; the caller then writes the workfile.
+ */
+static bool
+nts_shm_publish(NTupleStore *ts)
+{
+	NTupleStorePage *p;
+	NTupleStoreShm *shm;
+	long nblocks = 0;
+	long i;
+	Size size;
+	char *base;
+	int fd;
+	int err;
+
+	Assert(ts->rwflag == NTS_IS_WRITER && ts->shm_name);
+
+	if(gp_shareinput_shm_limit <= 0 || ts->lobbytes > 0 || ts->shm)
+		return false;
+
+	/*
+	 * The pages must all still be in memory: a page written out on eviction
+	 * leaves a hole in the block numbers of the in memory list.  Only the
+	 * last page may be empty, and the file would not have it either.
+	 */
+	for(p = ts->first_page; p && nts_page_slot_cnt(p) > 0; p = nts_page_next(p))
+	{
+		if(nts_page_blockn(p) != nblocks)
+			return false;
+		++nblocks;
+	}
+	if(p && nts_page_blockn(p) != nblocks)
+		return false;
+
+	if(nblocks == 0 || nblocks > gp_shareinput_shm_limit / (BLCKSZ / 1024))
+		return false;
+
+	size = (Size) nblocks * BLCKSZ;
+	shm = nts_shm_register(ts->shm_name);
+
+	fd = shm_open(shm->name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+	if(fd < 0)
+	{
+		elog(LOG, "could not create tuplestore shared memory \"%s\": %m", shm->name);
+		UnregisterXactCallbackOnce(XCallBack_NTupleStoreShm, shm);
+		nts_shm_release(shm);
+		return false;
+	}
+	shm->isWriter = true;
+
+	/*
+	 * Reserve the pages up front, so that a full /dev/shm fails here
+	 * rather than with a SIGBUS during the copy.
+	 */
+	err = posix_fallocate(fd, 0, size);
+	if(err != 0)
+	{
+		errno = err;
+		elog(LOG, "could not size tuplestore shared memory \"%s\" to %lu bytes: %m",
+			 shm->name, (unsigned long) size);
+		close(fd);
+		UnregisterXactCallbackOnce(XCallBack_NTupleStoreShm, shm);
+		nts_shm_release(shm);
+		return false;
+	}
+
+	base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if(base == MAP_FAILED)
+	{
+		elog(LOG, "could not map tuplestore shared memory \"%s\": %m", shm->name);
+		UnregisterXactCallbackOnce(XCallBack_NTupleStoreShm, shm);
+		nts_shm_release(shm);
+		return false;
+	}
+
+	/* the copies are clean, the pages of the writer stay dirty */
+	for(p = ts->first_page, i = 0; i < nblocks; p = nts_page_next(p), ++i)
+	{
+		NTupleStorePage *copy = (NTupleStorePage *) (base + (Size) i * BLCKSZ);
+
+		memcpy(copy, p, BLCKSZ);
+		nts_page_set_dirty(copy, false);
+	}
+
+	if(munmap(base, size) < 0)
+		elog(LOG, "could not unmap tuplestore shared memory \"%s\": %m", shm->name);
+
+	shm->nblocks = nblocks;
+	ts->shm = shm;
+
+	elog(DEBUG1, "tuplestore published %ld pages in shared memory \"%s\"", nblocks, shm->name);
+
+	return true;
+}
+
+/*
+ * Map the shared memory copy of the pages of the writer, if it published
+ * one.  Otherwise the reader reads the workfile.
+ */
+static void
+nts_shm_attach(NTupleStore *store)
+{
+	NTupleStoreShm *shm;
+	struct stat st;
+	char *base;
+	int fd;
+
+	Assert(store->shm_name && !store->shm);
+
+	fd = shm_open(store->shm_name, O_RDONLY, 0);
+	if(fd < 0)
+	{
+		if(errno != ENOENT)
+			elog(LOG, "could not open tuplestore shared memory \"%s\": %m", store->shm_name);
+		return;
+	}
+
+	if(fstat(fd, &st) < 0 || st.st_size <= 0 || st.st_size % BLCKSZ != 0)
+	{
+		elog(LOG, "invalid tuplestore shared memory \"%s\"", store->shm_name);
+		close(fd);
+		return;
+	}
+
+	shm = nts_shm_register(store->shm_name);
+
+	base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(base == MAP_FAILED)
+	{
+		elog(LOG, "could not map tuplestore shared memory \"%s\": %m", store->shm_name);
+		UnregisterXactCallbackOnce(XCallBack_NTupleStoreShm, shm);
+		nts_shm_release(shm);
+		return;
+	}
+
+	shm->base = base;
+	shm->size = st.st_size;
+	shm->nblocks = st.st_size / BLCKSZ;
+	store->shm = shm;
+}
+
 NTupleStoreAccessor* 
 ntuplestore_create_accessor(NTupleStore *ts, bool isWriter)
 {
@@ -1193,6 +1446,21 @@ void ntuplestore_trim(NTupleStore *ts, NTupleStorePos *pos)
 	nts_pin_page(ts, ts->first_page);
 }
 
+/*
+ * Returns true if all the pages of a store are in memory, and none of its
+ * entries went to the lob file, setting *bytes to the memory of the pages.
+ * The entries then stay where they are in memory, until the store is reset
+ * or destroyed.
+ */
+bool ntuplestore_in_memory(NTupleStore *ts, Size *bytes)
+{
+	if(ts->pfile || ts->plobfile || ts->rwflag != NTS_NOT_READERWRITER)
+		return false;
+
+	*bytes = (Size) ts->page_cnt * sizeof(NTupleStorePage);
+	return true;
+}
+
 int ntuplestore_compare_pos(NTupleStore *ts, NTupleStorePos *pos1, NTupleStorePos *pos2)
 {
 	if(pos1->blockn < pos2->blockn)
@@ -29,13 +29,17 @@
 #include <unistd.h>
 #include <sys/stat.h>
 
+#include "access/filesplit.h"
+#include "catalog/pg_class.h"
 #include "catalog/pg_proc.h"
 #include "cdb/cdbvars.h"
 #include "cdb/cdbsrlz.h"
 #include "libpq/libpq.h"
+#include "executor/instrument.h"
 #include "miscadmin.h"
 #include "nodes/print.h"
 #include "optimizer/walkers.h"
+#include "parser/parsetree.h"
 #include "postmaster/primary_mirror_mode.h"
 #include "utils/atomic.h"
 #include "utils/builtins.h"
@@ -56,6 +60,7 @@ typedef struct workset_info
 	ExecWorkFileType file_type;
 	workfile_set_snapshot snapshot;
 	NodeTag nodeType;
+	int plan_node_id;
 	TimestampTz session_start_time;
 	uint64 operator_work_mem;
 	char *dir_path;
@@ -67,7 +72,9 @@ typedef struct workset_info
 static workfile_set *workfile_mgr_lookup_set(PlanState *ps);
 static bool workfile_mgr_is_reusable(PlanState *ps);
 static bool workfile_mgr_is_cacheable_plan(PlanState *ps);
-static workfile_set_hashkey_t workfile_mgr_hash_key(workfile_set_plan *plan);
+static workfile_set_hashkey_t workfile_mgr_hash_key(workfile_set_plan *plan, workfile_set_snapshot snapshot);
+static Oid workfile_mgr_scan_relid(PlanState *ps);
+static CdbVisitOpt PlanSnapshotWalker(PlanState *ps, void *context);
 static workfile_set_plan *workfile_mgr_serialize_plan(PlanState *ps);
 static void workfile_mgr_free_plan(workfile_set_plan *splan);
 static void workfile_mgr_save_plan(workfile_set *work_set, workfile_set_plan *sf_plan);
@@ -126,6 +133,8 @@ workfile_mgr_cache_init(void)
 	 * to track disk space usage
 	 */
 	WorkfileDiskspace_Init();
+
+	WorkfileSpillHistory_Init();
 }
 
 /*
@@ -145,7 +154,8 @@ Size
 workfile_mgr_shmem_size(void)
 {
 	return Cache_SharedMemSize(gp_workfile_max_entries, sizeof(workfile_set)) +
-			WorkfileDiskspace_ShMemSize() + WorkfileQueryspace_ShMemSize();
+			WorkfileDiskspace_ShMemSize() + WorkfileQueryspace_ShMemSize() +
+			WorkfileSpillHistory_ShMemSize();
 }
 
 
@@ -219,6 +229,7 @@ workfile_mgr_create_set(enum ExecWorkFileType type, bool can_be_reused, PlanStat
 	set_info.file_type = type;
 	set_info.snapshot = snapshot;
 	set_info.nodeType = node_type;
+	set_info.plan_node_id = (plan != NULL) ? plan->plan_node_id : -1;
 	set_info.can_be_reused = can_be_reused && workfile_mgr_is_reusable(ps);
 	set_info.dir_path = dir_path;
 	set_info.session_start_time = GetCurrentTimestamp();
@@ -252,13 +263,13 @@ workfile_mgr_create_set(enum ExecWorkFileType type, bool can_be_reused, PlanStat
 		Assert(nodeTag(plan) >= T_Plan && nodeTag(plan) < T_PlanInvalItem);
 
 		workfile_set_plan *s_plan = workfile_mgr_serialize_plan(ps);
-		work_set->key = workfile_mgr_hash_key(s_plan);
+		work_set->key = workfile_mgr_hash_key(s_plan, work_set->metadata.snapshot);
 		workfile_mgr_save_plan(work_set, s_plan);
 		workfile_mgr_free_plan(s_plan);
 	}
 
-	elog(gp_workfile_caching_loglevel, "new spill file set. key=0x%x can_be_reused=%d prefix=%s opMemKB=" INT64_FORMAT,
-			work_set->key, work_set->can_be_reused, work_set->path, work_set->metadata.operator_work_mem);
+	elog(gp_workfile_caching_loglevel, "new spill file set. key=0x%x snapshot=0x%x can_be_reused=%d prefix=%s opMemKB=" INT64_FORMAT,
+			work_set->key, work_set->metadata.snapshot, work_set->can_be_reused, work_set->path, work_set->metadata.operator_work_mem);
 
 	return work_set;
 }
@@ -361,6 +372,7 @@ workfile_mgr_populate_set(const void *resource, const void *param)
 	workset_info *set_info = (workset_info *) param;
 
 	work_set->metadata.operator_work_mem = set_info->operator_work_mem;
+	work_set->metadata.snapshot = set_info->snapshot;
 	work_set->set_plan = NULL;
 
 	if (!set_info->on_disk)
@@ -379,12 +391,16 @@ workfile_mgr_populate_set(const void *resource, const void *param)
 		work_set->node_type = set_info->nodeType;
 		work_set->metadata.type = set_info->file_type;
 		work_set->metadata.bfz_compress_type = gp_workfile_compress_algorithm;
-		work_set->metadata.snapshot = set_info->snapshot;
 		work_set->metadata.num_leaf_files = 0;
 		work_set->slice_id = currentSliceId;
 		work_set->session_id = gp_session_id;
 		work_set->command_count = gp_command_count;
 		work_set->session_start_time = set_info->session_start_time;
+		work_set->plan_node_id = set_info->plan_node_id;
+		work_set->spilled_size = 0L;
+		work_set->spill_batches = 0;
+		work_set->spill_depth = 0;
+		work_set->spill_memory_wanted = 0L;
 
 		/* If workfile caching is disabled, nothing should be re-used, so override whatever the caller says */
 		work_set->can_be_reused = gp_workfile_caching && set_info->can_be_reused;
@@ -491,6 +507,7 @@ workfile_mgr_is_reusable(PlanState *ps)
  *    a non-immutable function
  *  - external table scan
  *  - share input scan (because of synchronization issues)
+ *  - scan of a table that is not append-only, or dynamic scan
  *
  * Returns CdbVisit_Failure if it finds an offending node
  */
@@ -527,6 +544,39 @@ PlanNonCacheableWalker(PlanState *ps,
 		return CdbVisit_Failure;
 	}
 
+	/*
+	 * The snapshot of a set only covers the file splits of append-only
+	 * tables, see workfile_mgr_snapshot. The other tables, and the
+	 * partitions picked at run time by the dynamic scans, may change
+	 * without it.
+	 */
+	switch (nodeTag(ps->plan))
+	{
+		case T_SeqScan:
+		case T_AppendOnlyScan:
+		case T_TableScan:
+		case T_ParquetScan:
+		case T_IndexScan:
+		case T_BitmapHeapScan:
+		case T_BitmapTableScan:
+		case T_TidScan:
+			if (!OidIsValid(workfile_mgr_scan_relid(ps)))
+			{
+				return CdbVisit_Failure;
+			}
+			break;
+		case T_DynamicTableScan:
+		case T_DynamicIndexScan:
+		case T_MagmaIndexScan:
+		case T_MagmaIndexOnlyScan:
+		case T_MagmaBitmapScan:
+		case T_OrcIndexScan:
+		case T_OrcIndexOnlyScan:
+			return CdbVisit_Failure;
+		default:
+			break;
+	}
+
 	/* Check qual and target list of the node for any non-cacheable functions */
 	List *qual = ps->plan->qual;
 	List *tlist = ps->plan->targetlist;
@@ -614,6 +664,7 @@ workfile_mgr_lookup_set(PlanState *ps)
 	workset_info set_info;
 	set_info.dir_path = NULL;
 	set_info.operator_work_mem = get_operator_work_mem(ps);
+	set_info.snapshot = workfile_mgr_snapshot(ps);
 	set_info.on_disk = false;
 
 	CacheEntry *localEntry = acquire_entry_retry(workfile_mgr_cache, &set_info);
@@ -632,7 +683,7 @@ workfile_mgr_lookup_set(PlanState *ps)
 
 	Assert(s_plan != NULL);
 	local_work_set->set_plan = s_plan;
-	local_work_set->key = workfile_mgr_hash_key(s_plan);
+	local_work_set->key = workfile_mgr_hash_key(s_plan, local_work_set->metadata.snapshot);
 
 	CacheEntry *cachedEntry = Cache_Lookup(workfile_mgr_cache, localEntry);
 
@@ -887,6 +938,11 @@ workfile_mgr_close_set(workfile_set *work_set)
 
 	CacheEntry *cache_entry = CACHE_ENTRY_HEADER(work_set);
 
+	if (!Cache_IsCached(cache_entry) && work_set->spilled_size > 0)
+	{
+		WorkfileSpillHistory_Add(work_set);
+	}
+
 	if (Cache_IsCached(cache_entry))
 	{
 		/* Workset came from cache. Just release it, nothing to do */
@@ -941,13 +997,113 @@ workfile_mgr_cleanup(void)
 }
 
 /*
- * Create a hash value based on a workfile_set_plan's signature.
+ * Create a hash value based on a workfile_set_plan's signature and the
+ * snapshot of the tables it reads.
  */
 static workfile_set_hashkey_t
-workfile_mgr_hash_key(workfile_set_plan *plan)
+workfile_mgr_hash_key(workfile_set_plan *plan, workfile_set_snapshot snapshot)
 {
 	int key_len = plan->serialized_plan_len;
-	return tag_hash(plan->serialized_plan, key_len);
+	workfile_set_hashkey_t key = tag_hash(plan->serialized_plan, key_len);
+
+	return key ^ (snapshot + 0x9e3779b9 + (key << 6) + (key >> 2));
+}
+
+/*
+ * Returns the relation scanned by a scan node that reads file splits of an
+ * append-only, parquet or orc table, InvalidOid for any other node.
+ */
+static Oid
+workfile_mgr_scan_relid(PlanState *ps)
+{
+	switch (nodeTag(ps->plan))
+	{
+		case T_SeqScan:
+		case T_AppendOnlyScan:
+		case T_TableScan:
+		case T_ParquetScan:
+		case T_IndexScan:
+		case T_BitmapHeapScan:
+		case T_BitmapTableScan:
+		case T_TidScan:
+			{
+				Index scanrelid = ((Scan *) ps->plan)->scanrelid;
+				Oid relid = getrelid(scanrelid, ps->state->es_range_table);
+
+				if (relstorage_is_ao(get_rel_relstorage(relid)))
+				{
+					return relid;
+				}
+			}
+			return InvalidOid;
+		default:
+			return InvalidOid;
+	}
+}
+
+/*
+ * Walker function adding the relation and the file splits read on this
+ * segment by each scan of a subtree to the StringInfo in context.
+ */
+static CdbVisitOpt
+PlanSnapshotWalker(PlanState *ps, void *context)
+{
+	StringInfo buf = (StringInfo) context;
+	Oid relid = workfile_mgr_scan_relid(ps);
+
+	if (OidIsValid(relid))
+	{
+		PlannedStmt *stmt = ps->state->es_plannedstmt;
+		List *splits = (NULL == stmt) ? NIL :
+				GetFileSplitsOfSegment(stmt->scantable_splits, relid, GetQEIndex());
+		int nsplits = list_length(splits);
+		ListCell *lc = NULL;
+
+		appendBinaryStringInfo(buf, (const char *) &relid, sizeof(relid));
+		appendBinaryStringInfo(buf, (const char *) &nsplits, sizeof(nsplits));
+
+		foreach(lc, splits)
+		{
+			FileSplit split = (FileSplit) lfirst(lc);
+
+			appendBinaryStringInfo(buf, (const char *) &split->segno, sizeof(split->segno));
+			appendBinaryStringInfo(buf, (const char *) &split->logiceof, sizeof(split->logiceof));
+			appendBinaryStringInfo(buf, (const char *) &split->offsets, sizeof(split->offsets));
+			appendBinaryStringInfo(buf, (const char *) &split->lengths, sizeof(split->lengths));
+		}
+	}
+
+	return CdbVisit_Walk;
+}
+
+/*
+ * Computes the snapshot of the tables read by a subplan, a hash of the
+ * relations it scans and of the file splits of each of them it reads on
+ * this segment, with their logical eofs. The tables are append-only, so
+ * a table that was written to since a set was spilled has another
+ * snapshot.
+ *
+ * Returns NULL_SNAPSHOT when workfile caching is off, as nothing is reused.
+ */
+workfile_set_snapshot
+workfile_mgr_snapshot(PlanState *ps)
+{
+	StringInfoData buf;
+	workfile_set_snapshot snapshot;
+
+	if (!gp_workfile_caching || NULL == ps)
+	{
+		return NULL_SNAPSHOT;
+	}
+
+	initStringInfo(&buf);
+	planstate_walk_node(ps, PlanSnapshotWalker, &buf);
+
+	snapshot = tag_hash(buf.data, buf.len);
+	pfree(buf.data);
+
+	/* Keep NULL_SNAPSHOT for the sets without one */
+	return (snapshot == NULL_SNAPSHOT) ? 1 : snapshot;
 }
 
 /*
@@ -1039,7 +1195,8 @@ workfile_set_equivalent(const void *virtual_resource, const void *physical_resou
 	workfile_set *virtual_workset = (workfile_set *) virtual_resource;
 	workfile_set *physical_workset = (workfile_set *) physical_resource;
 
-	if (virtual_workset->key != physical_workset->key)
+	if (virtual_workset->key != physical_workset->key ||
+			virtual_workset->metadata.snapshot != physical_workset->metadata.snapshot)
 	{
 		return false;
 	}
@@ -1154,6 +1311,58 @@ workfile_update_in_progress_size(ExecWorkFile *workfile, int64 size)
 	{
 		workfile->work_set->in_progress_size += size;
 		Assert(workfile->work_set->in_progress_size >= 0);
+		if (size > 0)
+		{
+			workfile->work_set->spilled_size += size;
+		}
+	}
+}
+
+/*
+ * Records how an operator spilled into a workfile set, before closing it.
+ *   batches is the number of batches or runs the input was split into
+ *   depth is how many times a batch was split again, or the merge passes
+ *   memory_wanted is the operator memory that would have avoided the spill
+ *
+ * Also sets the spilled bytes reported by EXPLAIN ANALYZE when instr is not
+ * NULL, and raises the notice asked for by gp_workfile_spill_notice.
+ */
+void
+workfile_mgr_report_spill(workfile_set *work_set, Instrumentation *instr,
+		int batches, int depth, int64 memory_wanted)
+{
+	Assert(NULL != work_set);
+
+	if (work_set->spilled_size == 0)
+	{
+		return;
+	}
+
+	work_set->spill_batches = batches;
+	work_set->spill_depth = depth;
+	work_set->spill_memory_wanted = memory_wanted;
+
+	if (NULL != instr)
+	{
+		instr->workfilespilled = Max(instr->workfilespilled, (double) work_set->spilled_size);
+	}
+
+	if (gp_workfile_spill_notice)
+	{
+		StringInfo operator_name = get_name_from_nodeType(work_set->node_type);
+
+		ereport(NOTICE,
+				(errmsg("%s (plan node %d) spilled " INT64_FORMAT " kB to workfiles "
+						"in %d batches on segment %d",
+						operator_name->data, work_set->plan_node_id,
+						work_set->spilled_size / 1024, batches, GpIdentity.segindex),
+				 memory_wanted > 0 ?
+				 errhint("About " INT64_FORMAT " kB of operator memory would have avoided the spill, "
+						 UINT64_FORMAT " kB were available.",
+						 memory_wanted / 1024, work_set->metadata.operator_work_mem / 1024) : 0));
+
+		pfree(operator_name->data);
+		pfree(operator_name);
 	}
 }
 
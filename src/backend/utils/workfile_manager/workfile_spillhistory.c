@@ -0,0 +1,160 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*-------------------------------------------------------------------------
+ *
+ * workfile_spillhistory.c
+ *	 History of the operators that spilled to workfiles on a segment
+ *
+ * Every workfile set that spilled adds a record when it is closed to a ring
+ * of gp_workfile_spill_history_size records in shared memory. The records
+ * tell which operator of which query spilled, how much it wrote, in how
+ * many batches and passes, and how much operator memory would have avoided
+ * the spill. The gp_workfile_mgr module shows the ring of all segments as
+ * the workfile.gp_workfile_spill_history view, and
+ * workfile.gp_workfile_spill_history_save() appends it to a table.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include <postgres.h>
+#include "storage/shmem.h"
+#include "storage/spin.h"
+#include "cdb/cdbvars.h"
+#include "utils/workfile_mgr.h"
+#include "miscadmin.h"
+
+/* Name to identify the WorkfileSpillHistory shared memory area by */
+#define WORKFILE_SPILLHISTORY_SHMEM_NAME "WorkfileSpillHistory"
+
+typedef struct WorkfileSpillHistory
+{
+	slock_t		lock;
+	/* number of records ever added; the next one goes to next % size */
+	uint64		next;
+	WorkfileSpillRecord records[1];		/* VARIABLE LENGTH ARRAY */
+} WorkfileSpillHistory;
+
+static WorkfileSpillHistory *spill_history = NULL;
+
+/*
+ * Initialize shared memory area for the WorkfileSpillHistory module
+ */
+void
+WorkfileSpillHistory_Init(void)
+{
+	bool attach = false;
+
+	if (gp_workfile_spill_history_size == 0)
+	{
+		return;
+	}
+
+	/* Allocate or attach to shared memory area */
+	spill_history = (WorkfileSpillHistory *) ShmemInitStruct(WORKFILE_SPILLHISTORY_SHMEM_NAME,
+			WorkfileSpillHistory_ShMemSize(),
+			&attach);
+
+	if (!attach)
+	{
+		SpinLockInit(&spill_history->lock);
+		spill_history->next = 0;
+	}
+}
+
+/*
+ * Returns the amount of shared memory needed for the WorkfileSpillHistory module
+ */
+Size
+WorkfileSpillHistory_ShMemSize(void)
+{
+	if (gp_workfile_spill_history_size == 0)
+	{
+		return 0;
+	}
+
+	return add_size(offsetof(WorkfileSpillHistory, records),
+			mul_size(gp_workfile_spill_history_size, sizeof(WorkfileSpillRecord)));
+}
+
+/*
+ * Adds the spilling workfile set that is being closed to the history
+ */
+void
+WorkfileSpillHistory_Add(workfile_set *work_set)
+{
+	Assert(NULL != work_set);
+
+	if (NULL == spill_history)
+	{
+		return;
+	}
+
+	WorkfileSpillRecord record;
+
+	record.end_time = GetCurrentTimestamp();
+	record.session_id = work_set->session_id;
+	record.command_count = work_set->command_count;
+	record.slice_id = work_set->slice_id;
+	record.plan_node_id = work_set->plan_node_id;
+	record.node_type = work_set->node_type;
+	record.no_files = work_set->no_files;
+	record.batches = work_set->spill_batches;
+	record.depth = work_set->spill_depth;
+	record.operator_work_mem = work_set->metadata.operator_work_mem;
+	record.spilled_size = work_set->spilled_size;
+	record.memory_wanted = work_set->spill_memory_wanted;
+
+	SpinLockAcquire(&spill_history->lock);
+	spill_history->records[spill_history->next % gp_workfile_spill_history_size] = record;
+	spill_history->next++;
+	SpinLockRelease(&spill_history->lock);
+}
+
+/*
+ * Copies the records of the history, oldest first, into a palloc-ed array
+ * and returns their number
+ */
+int
+WorkfileSpillHistory_Read(WorkfileSpillRecord **records)
+{
+	*records = NULL;
+	if (NULL == spill_history)
+	{
+		return 0;
+	}
+
+	WorkfileSpillRecord *copy = palloc(gp_workfile_spill_history_size * sizeof(WorkfileSpillRecord));
+	int count = 0;
+
+	SpinLockAcquire(&spill_history->lock);
+	uint64 first = 0;
+	if (spill_history->next > gp_workfile_spill_history_size)
+	{
+		first = spill_history->next - gp_workfile_spill_history_size;
+	}
+	for (uint64 i = first; i < spill_history->next; i++)
+	{
+		copy[count++] = spill_history->records[i % gp_workfile_spill_history_size];
+	}
+	SpinLockRelease(&spill_history->lock);
+
+	*records = copy;
+	return count;
+}
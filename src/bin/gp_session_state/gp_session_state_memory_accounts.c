@@ -0,0 +1,180 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * ---------------------------------------------------------------------
+ *
+ * The dynamically linked library created from this source can be reference by
+ * creating a function in psql that references it. For example,
+ *
+ * CREATE FUNCTION gp_session_state_memory_accounts_f()
+ *	RETURNS SETOF record
+ *	AS '$libdir/gp_session_state', 'gp_session_state_memory_accounts'
+ *	LANGUAGE C VOLATILE;
+ */
+
+#include "postgres.h"
+#include "funcapi.h"
+#include "utils/builtins.h"
+#include "utils/memaccounting_snapshot.h"
+#include "miscadmin.h"
+
+/* The number of columns as defined in memory_account_snapshot view */
+#define NUM_MEMORY_ACCOUNT_SNAPSHOT_ELEM 13
+
+Datum gp_session_state_memory_accounts(PG_FUNCTION_ARGS);
+
+PG_FUNCTION_INFO_V1(gp_session_state_memory_accounts);
+
+/* Where we are in the published snapshots between calls */
+typedef struct MemoryAccountsScanState
+{
+	/* The next slot to copy once the current snapshot is exhausted */
+	int nextSlot;
+	/* The next entry of the current snapshot to return */
+	int nextEntry;
+	MemoryAccountSnapshot snapshot;
+} MemoryAccountsScanState;
+
+/*
+ * Function returning the memory accounts published by each process of this
+ * segment
+ */
+Datum
+gp_session_state_memory_accounts(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	MemoryAccountsScanState *scanState;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		/* create a function context for cross-call persistence */
+		funcctx = SRF_FIRSTCALL_INIT();
+
+		/* Switch to memory context appropriate for multiple function calls */
+		MemoryContext oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		/* Build a tuple descriptor for our result type. */
+		TupleDesc tupdesc = CreateTemplateTupleDesc(NUM_MEMORY_ACCOUNT_SNAPSHOT_ELEM, false /* hasoid */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 1, "segid",
+				INT4OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 2, "pid",
+				INT4OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 3, "sessionid",
+				INT4OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 4, "command_cnt",
+				INT4OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 5, "slice_id",
+				INT4OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 6, "publish_time",
+				TIMESTAMPTZOID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 7, "account_id",
+				INT4OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 8, "parent_id",
+				INT4OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 9, "account_name",
+				TEXTOID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 10, "plan_node_id",
+				INT4OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 11, "quota_bytes",
+				INT8OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 12, "peak_bytes",
+				INT8OID, -1 /* typmod */, 0 /* attdim */);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 13, "current_bytes",
+				INT8OID, -1 /* typmod */, 0 /* attdim */);
+
+		Assert(NUM_MEMORY_ACCOUNT_SNAPSHOT_ELEM == 13);
+
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+		scanState = (MemoryAccountsScanState *) palloc0(sizeof(*scanState));
+		funcctx->user_fctx = scanState;
+
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	scanState = (MemoryAccountsScanState *) funcctx->user_fctx;
+
+	/* Advance to the next published snapshot with entries left */
+	while (scanState->nextEntry >= scanState->snapshot.nentries)
+	{
+		if (scanState->nextSlot >= MemoryAccountSnapshotCount)
+		{
+			/* Reached the end of the slot array, we're done */
+			SRF_RETURN_DONE(funcctx);
+		}
+
+		if (!MemoryAccounting_ReadSnapshot(scanState->nextSlot, &scanState->snapshot))
+		{
+			scanState->snapshot.nentries = 0;
+		}
+
+		scanState->nextSlot++;
+		scanState->nextEntry = 0;
+	}
+
+	MemoryAccountSnapshot *snapshot = &scanState->snapshot;
+	MemoryAccountSnapshotEntry *entry = &snapshot->entries[scanState->nextEntry];
+
+	/* MemoryAccounting_GetAccountName() only looks at the owner type */
+	MemoryAccount account;
+	MemSet(&account, 0, sizeof(account));
+	account.type = T_MemoryAccount;
+	account.ownerType = entry->ownerType;
+
+	Datum		values[NUM_MEMORY_ACCOUNT_SNAPSHOT_ELEM];
+	bool		nulls[NUM_MEMORY_ACCOUNT_SNAPSHOT_ELEM];
+	MemSet(nulls, 0, sizeof(nulls));
+
+	values[0] = Int32GetDatum(snapshot->segindex);
+	values[1] = Int32GetDatum(snapshot->pid);
+	values[2] = Int32GetDatum(snapshot->sessionId);
+	values[3] = Int32GetDatum(snapshot->commandCount);
+	values[4] = Int32GetDatum(snapshot->sliceId);
+	values[5] = TimestampTzGetDatum(snapshot->publishTime);
+	values[6] = Int32GetDatum(scanState->nextEntry);
+	values[7] = Int32GetDatum(entry->parentSerial);
+	values[8] = DirectFunctionCall1(textin,
+			CStringGetDatum(MemoryAccounting_GetAccountName(&account)));
+	values[9] = Int32GetDatum(entry->planNodeId);
+	nulls[9] = (entry->planNodeId < 0);
+	values[10] = Int64GetDatum((int64) entry->quota);
+	values[11] = Int64GetDatum((int64) entry->peak);
+	values[12] = Int64GetDatum((int64) entry->balance);
+
+	scanState->nextEntry++;
+
+	HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+	Datum result = HeapTupleGetDatum(tuple);
+	SRF_RETURN_NEXT(funcctx, result);
+}
@@ -45,11 +45,15 @@
 /* The number of columns as defined in gp_workfile_mgr_diskspace view */
 #define NUM_USED_DISKSPACE_ELEM 2
 
+/* The number of columns as defined in gp_workfile_spill_history view */
+#define NUM_SPILL_HISTORY_ELEM 14
+
 static char *gp_workfile_operator_name(NodeTag node_type);
 
 Datum gp_workfile_mgr_cache_stats(PG_FUNCTION_ARGS);
 Datum gp_workfile_mgr_cache_entries(PG_FUNCTION_ARGS);
 Datum gp_workfile_mgr_used_diskspace(PG_FUNCTION_ARGS);
+Datum gp_workfile_mgr_spill_history(PG_FUNCTION_ARGS);
 
 PG_FUNCTION_INFO_V1(gp_workfile_mgr_cache_stats);
 
@@ -302,6 +306,129 @@ gp_workfile_mgr_used_diskspace(PG_FUNCTION_ARGS)
 	PG_RETURN_DATUM(result);
 }
 
+/* Cross-call state of gp_workfile_mgr_spill_history */
+typedef struct SpillHistoryContext
+{
+	WorkfileSpillRecord *records;
+	int count;
+	int next;
+} SpillHistoryContext;
+
+PG_FUNCTION_INFO_V1(gp_workfile_mgr_spill_history);
+
+/*
+ * Function returning the operators that spilled on one segment, oldest first
+ */
+Datum
+gp_workfile_mgr_spill_history(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	SpillHistoryContext *history;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		funcctx = SRF_FIRSTCALL_INIT();
+
+		MemoryContext oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		/*
+		 * Build a tuple descriptor for our result type
+		 * The number and type of attributes have to match the definition of the
+		 * view gp_workfile_spill_history
+		 */
+		TupleDesc tupdesc = CreateTemplateTupleDesc(NUM_SPILL_HISTORY_ELEM, false);
+
+		TupleDescInitEntry(tupdesc, (AttrNumber) 1, "segid",
+				INT4OID, -1 /* typmod */, 0 /* attdim */);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 2, "sessionid",
+				INT4OID, -1 /* typmod */, 0 /* attdim */);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 3, "commandid",
+				INT4OID, -1 /* typmod */, 0 /* attdim */);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 4, "slice",
+				INT4OID, -1 /* typmod */, 0 /* attdim */);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 5, "plan_node_id",
+				INT4OID, -1 /* typmod */, 0 /* attdim */);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 6, "optype",
+				TEXTOID, -1 /* typmod */, 0 /* attdim */);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 7, "end_time",
+				TIMESTAMPTZOID, -1 /* typmod */, 0 /* attdim */);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 8, "workmem",
+				INT8OID, -1 /* typmod */, 0 /* attdim */);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 9, "spilled_bytes",
+				INT8OID, -1 /* typmod */, 0 /* attdim */);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 10, "numfiles",
+				INT4OID, -1 /* typmod */, 0 /* attdim */);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 11, "batches",
+				INT4OID, -1 /* typmod */, 0 /* attdim */);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 12, "depth",
+				INT4OID, -1 /* typmod */, 0 /* attdim */);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 13, "memory_wanted",
+				INT8OID, -1 /* typmod */, 0 /* attdim */);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 14, "memory_wanted_ratio",
+				FLOAT8OID, -1 /* typmod */, 0 /* attdim */);
+
+		Assert(NUM_SPILL_HISTORY_ELEM == 14);
+
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+		history = (SpillHistoryContext *) palloc(sizeof(*history));
+		history->count = WorkfileSpillHistory_Read(&history->records);
+		history->next = 0;
+		funcctx->user_fctx = history;
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	history = (SpillHistoryContext *) funcctx->user_fctx;
+
+	if (history->next >= history->count)
+	{
+		SRF_RETURN_DONE(funcctx);
+	}
+
+	WorkfileSpillRecord *record = &history->records[history->next++];
+
+	Datum		values[NUM_SPILL_HISTORY_ELEM];
+	bool		nulls[NUM_SPILL_HISTORY_ELEM];
+	MemSet(nulls, 0, sizeof(nulls));
+
+	values[0] = Int32GetDatum(GetQEIndex());
+	values[1] = Int32GetDatum(record->session_id);
+	values[2] = Int32GetDatum(record->command_count);
+	values[3] = Int32GetDatum(record->slice_id);
+	values[4] = Int32GetDatum(record->plan_node_id);
+	values[5] = CStringGetTextDatum(gp_workfile_operator_name(record->node_type));
+	values[6] = TimestampTzGetDatum(record->end_time);
+	values[7] = Int64GetDatum(record->operator_work_mem);
+	values[8] = Int64GetDatum(record->spilled_size);
+	values[9] = Int32GetDatum(record->no_files);
+	values[10] = Int32GetDatum(record->batches);
+	values[11] = Int32GetDatum(record->depth);
+
+	/* The operators that do not estimate it leave the memory wanted unknown */
+	if (record->memory_wanted > 0)
+	{
+		values[12] = Int64GetDatum(record->memory_wanted);
+	}
+	else
+	{
+		nulls[12] = true;
+	}
+
+	if (record->memory_wanted > 0 && record->operator_work_mem > 0)
+	{
+		values[13] = Float8GetDatum((double) record->memory_wanted / (double) record->operator_work_mem);
+	}
+	else
+	{
+		nulls[13] = true;
+	}
+
+	HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+	Datum result = HeapTupleGetDatum(tuple);
+	SRF_RETURN_NEXT(funcctx, result);
+}
+
 /*
  * Converts from a NodeTag id to an operator name. Only for operators
  * supported by the workfile manager.
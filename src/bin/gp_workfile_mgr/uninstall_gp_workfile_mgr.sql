@@ -5,6 +5,10 @@ BEGIN;
 
 DROP FUNCTION gp_workfile_mgr_test_allsegs(text);
 DROP FUNCTION gp_workfile_mgr_test(text);
+DROP FUNCTION gp_workfile_spill_history_save();
+DROP TABLE spill_history;
+DROP VIEW gp_workfile_spill_history;
+DROP FUNCTION gp_workfile_mgr_spill_history();
 
 DROP SCHEMA workfile;
 
@@ -269,6 +269,7 @@ struct request_t {
     char* command;    /* command associated with transform */
     int paths; /* 1 if filename passed to transform should contain paths to data
                   files */
+    int parallel; /* number of transforms to run at once, one per data file */
     const char* errfilename; /* name of temporary file holding stderr to send to
                                 server */
     apr_file_t* errfile; /* temporary file holding stderr to send to server */
@@ -1555,6 +1556,7 @@ static int session_attach(request_t* r) {
 
       fstream_options.transform->cmd = r->trans.command;
       fstream_options.transform->pass_paths = r->trans.paths;
+      fstream_options.transform->parallel = r->trans.parallel;
       fstream_options.transform->for_write = fstream_options.forwrite;
       fstream_options.transform->mp = pool;
       fstream_options.transform->errfile = r->trans.errfile;
@@ -3208,6 +3210,7 @@ static int request_set_transform(request_t* r) {
   extern int transform_content_paths(struct transform * tr);
   extern char* transform_safe(struct transform * tr);
   extern regex_t* transform_saferegex(struct transform * tr);
+  extern int transform_parallel(struct transform * tr);
 
   struct transform* tr;
   char* safe;
@@ -3267,6 +3270,7 @@ static int request_set_transform(request_t* r) {
    */
   r->trans.command = transform_command(tr);
   r->trans.paths = transform_content_paths(tr);
+  r->trans.parallel = transform_parallel(tr);
 
   /*
    * if safe regex is specified, check that the path matches it
@@ -39,6 +39,7 @@ struct gpfxdist_t
 	char*		cmd;		/* transformation command */
 	int			for_write;	/* 1 if writing to subprocess, 0 if reading from subprocess */
 	int			pass_paths; /* 1 if subprocess expects filename to contain paths to data files, 0 otherwise */
+	int			parallel;	/* number of subprocesses to run at once, one per data file */
 
 	apr_pool_t* mp;			/* apache portable runtime memory pool */
 	apr_proc_t	proc;		/* apache portable runtime child process structure */
@@ -47,4 +48,19 @@ struct gpfxdist_t
 	apr_file_t* errfile;	/* APR handle for errfilename */
 };
 
+/*
+ * A transformation started ahead of its turn, which writes the output for
+ * its data file to a temporary file rather than to a pipe.  gfile_spool()
+ * starts it and gfile_spool_wait() waits for it to finish.
+ */
+struct gpfxdist_spool_t
+{
+	apr_proc_t	proc;		/* apache portable runtime child process structure */
+	char*		outfilename; /* name of temporary file containing stdout output, NULL if not started */
+};
+
+int gfile_spool(struct gpfxdist_spool_t* spool, const char* fpath, struct gpfxdist_t* transform,
+				int* response_code, const char** response_string);
+int gfile_spool_wait(struct gpfxdist_spool_t* spool);
+
 #endif
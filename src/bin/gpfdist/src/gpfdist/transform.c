@@ -397,6 +397,7 @@ dump_transform(struct transform* tr)
 	printf("  CONTENTS: %s\n", tr->content == TR_FN_DATA ? "data" : (tr->content == TR_FN_PATHS ? "paths" : "unknown"));
 	if (tr->safe)
 		printf("  SAFE: %s\n", tr->safe);
+	printf("  PARALLEL: %d\n", tr->parallel);
 }
 
 void
@@ -535,6 +536,13 @@ error_safe_not_valid_regex(struct parsestate* psp, struct keyvalue* trkv, struct
 	return 1;
 }
 
+int
+error_invalid_parallel_for_transformation(struct parsestate* psp, struct keyvalue* trkv, struct keyvalue* kv)
+{
+    char* fmt = ERRFMT "transformation '%s': invalid PARALLEL (expected a number of processes from 1 to 64)\n";
+    return format_key1(psp, fmt, trkv->key, kv->keymark);
+}
+
 
 /*
  * transform validation and construction
@@ -646,6 +654,27 @@ validate_transform(struct parsestate* psp, struct transform* tr, struct mapping*
 			return error_safe_not_valid_regex(psp, tr->kv, kv, &(tr->saferegex), rc);
 	}
 
+    kv = find_keyvalue(map->kvlist, "PARALLEL");
+    if (kv) 
+	{
+		char* end = NULL;
+		long  n;
+
+		if (kv->type != KV_SCALAR)
+			return error_invalid_parallel_for_transformation(psp, tr->kv, kv);
+
+		n = strtol(kv->scalar, &end, 10);
+		if (end == kv->scalar || *end || n < 1 || n > TR_MAX_PARALLEL)
+			return error_invalid_parallel_for_transformation(psp, tr->kv, kv);
+
+		tr->parallel = (int) n;
+	}
+	else
+	{
+		/* one transformation at a time when parallel is not specified */
+		tr->parallel = 1;
+	}
+
     return 0;
 }
 
@@ -799,4 +828,10 @@ transform_saferegex(struct transform* tr)
 	return &(tr->saferegex);
 }
 
+int
+transform_parallel(struct transform* tr)
+{
+	return tr->parallel;
+}
+
 #endif
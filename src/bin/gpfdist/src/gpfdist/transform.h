@@ -192,6 +192,8 @@ struct transform
 #define TR_ER_CONSOLE 1
 #define TR_ER_SERVER  2
     int               errs;             /* where stderr output should go (console or server) */
+#define TR_MAX_PARALLEL 64
+    int               parallel;         /* number of transformation processes to run at once */
 };
 
 struct parsestate
@@ -226,6 +228,7 @@ int error_content_not_scalar(struct parsestate* psp, struct keyvalue* trkv, stru
 int error_invalid_content_for_transformation(struct parsestate* psp, struct keyvalue* trkv, struct keyvalue* kv);
 int error_safe_not_scalar(struct parsestate* psp, struct keyvalue* trkv, struct keyvalue* kv);
 int error_safe_not_valid_regex(struct parsestate* psp, struct keyvalue* trkv, struct keyvalue* kv, regex_t* r, int rc);
+int error_invalid_parallel_for_transformation(struct parsestate* psp, struct keyvalue* trkv, struct keyvalue* kv);
 
 
 /*
@@ -261,5 +264,6 @@ int transform_stderr_server(struct transform* tr);
 int transform_content_paths(struct transform* tr);
 char* transform_safe(struct transform* tr);
 regex_t* transform_saferegex(struct transform* tr);
+int transform_parallel(struct transform* tr);
 
 #endif
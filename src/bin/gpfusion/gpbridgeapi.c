@@ -26,6 +26,23 @@
 #include "access/pxfutils.h"
 #include "cdb/cdbvars.h"
 #include "cdb/cdbfilesystemcredential.h"
+#include "utils/guc.h"
+
+/*
+ * Bytes buffered for each fragment fetched ahead of the scan,
+ * before its transfer is paused
+ */
+#define PREFETCH_BUFFER_SIZE (1024 * 1024)
+
+/*
+ * A fragment that follows the current one, fetched on its own connection
+ */
+typedef struct
+{
+	ListCell* fragment;
+	CHURL_HEADERS churl_headers;
+	CHURL_HANDLE churl_handle;
+} prefetched_fragment;
 
 typedef struct
 {
@@ -35,6 +52,7 @@ typedef struct
 	StringInfoData uri;
 	ListCell* current_fragment;
 	StringInfoData write_file_name;
+	List* prefetched; /* prefetched_fragment, in fragment order */
 } gphadoop_context;
 
 void	gpbridge_check_inside_extproto(PG_FUNCTION_ARGS, const char* func_name);
@@ -43,13 +61,20 @@ bool	gpbridge_first_call(PG_FUNCTION_ARGS);
 int		gpbridge_cleanup(PG_FUNCTION_ARGS);
 void	cleanup_churl_handle(gphadoop_context* context);
 void	cleanup_churl_headers(gphadoop_context* context);
+void	cleanup_prefetched_fragments(gphadoop_context* context);
 void	cleanup_gphd_uri(gphadoop_context* context);
 void	cleanup_context(PG_FUNCTION_ARGS, gphadoop_context* context);
 gphadoop_context*	create_context(PG_FUNCTION_ARGS);
-void	add_querydata_to_http_header(gphadoop_context* context, PG_FUNCTION_ARGS);
+void	add_querydata_to_http_header(gphadoop_context* context,
+									 CHURL_HEADERS headers, PG_FUNCTION_ARGS);
 void	append_churl_header_if_exists(gphadoop_context* context,
 									  const char* key, const char* value);
 void    set_current_fragment_headers(gphadoop_context* context);
+void    set_fragment_headers(gphadoop_context* context,
+							 CHURL_HEADERS headers, ListCell* fragment);
+void	prefetch_fragments(gphadoop_context* context, PG_FUNCTION_ARGS);
+void	read_prefetched_fragments(gphadoop_context* context);
+bool	next_prefetched_fragment(gphadoop_context* context);
 void	gpbridge_import_start(PG_FUNCTION_ARGS);
 void	gpbridge_export_start(PG_FUNCTION_ARGS);
 PxfServer* get_pxf_server(GPHDUri* gphd_uri, const Relation rel);
@@ -120,6 +145,7 @@ int gpbridge_cleanup(PG_FUNCTION_ARGS)
 	if (!context)
 		return 0;
 
+	cleanup_prefetched_fragments(context);
 	cleanup_churl_handle(context);
 	cleanup_churl_headers(context);
 	cleanup_gphd_uri(context);
@@ -140,6 +166,26 @@ void cleanup_churl_headers(gphadoop_context* context)
 	context->churl_headers = NULL;
 }
 
+/*
+ * Drop the fragments fetched ahead but not read,
+ * e.g. when a LIMIT ends the scan early
+ */
+void cleanup_prefetched_fragments(gphadoop_context* context)
+{
+	ListCell* lc = NULL;
+
+	foreach(lc, context->prefetched)
+	{
+		prefetched_fragment* prefetched = (prefetched_fragment*)lfirst(lc);
+
+		/* don't check the response of a transfer that is not read */
+		churl_cleanup(prefetched->churl_handle, true);
+		churl_headers_cleanup(prefetched->churl_headers);
+	}
+	list_free_deep(context->prefetched);
+	context->prefetched = NIL;
+}
+
 void cleanup_gphd_uri(gphadoop_context* context)
 {
 	if (context->gphd_uri == NULL)
@@ -174,10 +220,11 @@ gphadoop_context* create_context(PG_FUNCTION_ARGS)
  * These values are the context of the query and used
  * by the remote component.
  */
-void add_querydata_to_http_header(gphadoop_context* context, PG_FUNCTION_ARGS)
+void add_querydata_to_http_header(gphadoop_context* context,
+								  CHURL_HEADERS headers, PG_FUNCTION_ARGS)
 {
 	PxfInputData inputData = {0};
-	inputData.headers = context->churl_headers;
+	inputData.headers = headers;
 	inputData.gphduri = context->gphd_uri;
 	inputData.rel = EXTPROTOCOL_GET_RELATION(fcinfo);
 	inputData.quals = EXTPROTOCOL_GET_SCANQUALS(fcinfo);
@@ -213,33 +260,43 @@ void append_churl_header_if_exists(gphadoop_context* context, const char* key, c
  */
 void set_current_fragment_headers(gphadoop_context* context)
 {
-	FragmentData* frag_data = (FragmentData*)lfirst(context->current_fragment);
+	set_fragment_headers(context, context->churl_headers, context->current_fragment);
+}
+
+/*
+ * Change the headers with the information of the given fragment,
+ * as in set_current_fragment_headers.
+ */
+void set_fragment_headers(gphadoop_context* context,
+						  CHURL_HEADERS headers, ListCell* fragment)
+{
+	FragmentData* frag_data = (FragmentData*)lfirst(fragment);
 	elog(DEBUG2, "pxf: set_current_fragment_source_name: source_name %s, index %s, has user data: %s ",
 		 frag_data->source_name, frag_data->index, frag_data->user_data ? "TRUE" : "FALSE");
 
-	churl_headers_override(context->churl_headers, "X-GP-DATA-DIR", frag_data->source_name);
-	churl_headers_override(context->churl_headers, "X-GP-DATA-FRAGMENT", frag_data->index);
-	churl_headers_override(context->churl_headers, "X-GP-FRAGMENT-METADATA", frag_data->fragment_md);
+	churl_headers_override(headers, "X-GP-DATA-DIR", frag_data->source_name);
+	churl_headers_override(headers, "X-GP-DATA-FRAGMENT", frag_data->index);
+	churl_headers_override(headers, "X-GP-FRAGMENT-METADATA", frag_data->fragment_md);
 
 	if (frag_data->user_data)
 	{
-		churl_headers_override(context->churl_headers, "X-GP-FRAGMENT-USER-DATA", frag_data->user_data);
+		churl_headers_override(headers, "X-GP-FRAGMENT-USER-DATA", frag_data->user_data);
 	}
 	else
 	{
-		churl_headers_remove(context->churl_headers, "X-GP-FRAGMENT-USER-DATA", true);
+		churl_headers_remove(headers, "X-GP-FRAGMENT-USER-DATA", true);
 	}
 
 	if (frag_data->profile)
 	{
 		/* if current fragment has optimal profile set it*/
-		churl_headers_override(context->churl_headers, "X-GP-PROFILE", frag_data->profile);
+		churl_headers_override(headers, "X-GP-PROFILE", frag_data->profile);
 		elog(DEBUG2, "pxf: set_current_fragment_headers: using profile: %s", frag_data->profile);
 
 	} else if (context->gphd_uri->profile)
 	{
 		/* if current fragment doesn't have any optimal profile, set to use profile from url */
-		churl_headers_override(context->churl_headers, "X-GP-PROFILE", context->gphd_uri->profile);
+		churl_headers_override(headers, "X-GP-PROFILE", context->gphd_uri->profile);
 		elog(DEBUG2, "pxf: set_current_fragment_headers: using profile: %s", context->gphd_uri->profile);
 	}
 	/* if there is no profile passed in url, we expect to have accessor+fragmenter+resolver so no action needed by this point */
@@ -254,7 +311,7 @@ void gpbridge_import_start(PG_FUNCTION_ARGS)
 	context->current_fragment = list_head(context->gphd_uri->fragments);
 	build_uri_for_read(context);
 	context->churl_headers = churl_headers_init();
-	add_querydata_to_http_header(context, fcinfo);
+	add_querydata_to_http_header(context, context->churl_headers, fcinfo);
 
 	set_current_fragment_headers(context);
 
@@ -263,6 +320,77 @@ void gpbridge_import_start(PG_FUNCTION_ARGS)
 
 	/* read some bytes to make sure the connection is established */
 	churl_read_check_connectivity(context->churl_handle);
+
+	prefetch_fragments(context, fcinfo);
+}
+
+/*
+ * Open connections for the fragments following the current one, so that
+ * the PXF service prepares and sends them while the current fragment is
+ * read. Keeps pxf_prefetch_fragments of them open.
+ */
+void prefetch_fragments(gphadoop_context* context, PG_FUNCTION_ARGS)
+{
+	ListCell* fragment = context->current_fragment;
+
+	if (context->prefetched != NIL)
+		fragment = ((prefetched_fragment*)llast(context->prefetched))->fragment;
+
+	while (list_length(context->prefetched) < pxf_prefetch_fragments &&
+		   (fragment = lnext(fragment)) != NULL)
+	{
+		prefetched_fragment* prefetched = palloc0(sizeof(prefetched_fragment));
+
+		prefetched->fragment = fragment;
+		prefetched->churl_headers = churl_headers_init();
+		add_querydata_to_http_header(context, prefetched->churl_headers, fcinfo);
+		set_fragment_headers(context, prefetched->churl_headers, fragment);
+
+		prefetched->churl_handle = churl_init_download(context->uri.data,
+													   prefetched->churl_headers);
+		context->prefetched = lappend(context->prefetched, prefetched);
+	}
+}
+
+/*
+ * Move data of the prefetched fragments from the network to their
+ * bounded buffers, without waiting.
+ */
+void read_prefetched_fragments(gphadoop_context* context)
+{
+	ListCell* lc = NULL;
+
+	foreach(lc, context->prefetched)
+	{
+		prefetched_fragment* prefetched = (prefetched_fragment*)lfirst(lc);
+		churl_read_prefetch(prefetched->churl_handle, PREFETCH_BUFFER_SIZE);
+	}
+}
+
+/*
+ * Make the first prefetched fragment the current one.
+ * Returns false if the next fragment was not prefetched.
+ */
+bool next_prefetched_fragment(gphadoop_context* context)
+{
+	prefetched_fragment* prefetched = NULL;
+
+	if (context->prefetched == NIL)
+		return false;
+
+	prefetched = (prefetched_fragment*)linitial(context->prefetched);
+	context->prefetched = list_delete_first(context->prefetched);
+	Assert(prefetched->fragment == context->current_fragment);
+
+	/* the response of the previous fragment was already checked */
+	churl_cleanup(context->churl_handle, true);
+	churl_headers_cleanup(context->churl_headers);
+
+	context->churl_handle = prefetched->churl_handle;
+	context->churl_headers = prefetched->churl_headers;
+
+	pfree(prefetched);
+	return true;
 }
 
 void gpbridge_export_start(PG_FUNCTION_ARGS)
@@ -288,7 +416,7 @@ void gpbridge_export_start(PG_FUNCTION_ARGS)
 	free_datanode_rest_server(rest_server);
 
 	context->churl_headers = churl_headers_init();
-	add_querydata_to_http_header(context, fcinfo);
+	add_querydata_to_http_header(context, context->churl_headers, fcinfo);
 
 	context->churl_handle = churl_init_upload(context->uri.data,
 											  context->churl_headers);
@@ -426,13 +554,21 @@ size_t gpbridge_read(PG_FUNCTION_ARGS)
 		if (context->current_fragment == NULL)
 			return 0;
 
-		set_current_fragment_headers(context);
-		churl_download_restart(context->churl_handle, context->uri.data, context->churl_headers);
+		if (!next_prefetched_fragment(context))
+		{
+			/* not fetched ahead, reuse the connection of the previous fragment */
+			set_current_fragment_headers(context);
+			churl_download_restart(context->churl_handle, context->uri.data, context->churl_headers);
+		}
 
 		/* read some bytes to make sure the connection is established */
 		churl_read_check_connectivity(context->churl_handle);
+
+		prefetch_fragments(context, fcinfo);
 	}
 
+	read_prefetched_fragments(context);
+
 	return n;
 }
 
@@ -227,6 +227,67 @@ static inline Oid getTypeOidFromJavaEnumOrdinal(int8 enumType)
 	return 0;
 }
 
+/*
+ * Decode a fixed length binary column value without calling the type's
+ * receive function. The values are in network byte order, the same way
+ * boolrecv, int2recv, int4recv, int8recv, float4recv and float8recv read
+ * them. Returns false for any other type.
+ */
+static inline bool readFixedLengthDatum(Oid typeid, char* data, Datum *value)
+{
+	switch (typeid)
+	{
+		case BOOLOID:
+			*value = BoolGetDatum(data[0] != 0);
+			return true;
+		case INT2OID:
+		{
+			uint16 n16;
+			memcpy(&n16, data, sizeof(uint16));
+			*value = Int16GetDatum((int16) ntohs(n16));
+			return true;
+		}
+		case INT4OID:
+		{
+			uint32 n32;
+			memcpy(&n32, data, sizeof(uint32));
+			*value = Int32GetDatum((int32) ntohl(n32));
+			return true;
+		}
+		case FLOAT4OID:
+		{
+			union
+			{
+				float4	f;
+				uint32	i;
+			} swap;
+			memcpy(&swap.i, data, sizeof(uint32));
+			swap.i = ntohl(swap.i);
+			*value = Float4GetDatum(swap.f);
+			return true;
+		}
+		case INT8OID:
+		case FLOAT8OID:
+		{
+			union
+			{
+				float8	f;
+				int64	i;
+			} swap;
+			uint32 h32;
+			uint32 l32;
+			memcpy(&h32, data, sizeof(uint32));
+			memcpy(&l32, data + 4, sizeof(uint32));
+			swap.i = ntohl(h32);
+			swap.i <<= 32;
+			swap.i |= ntohl(l32);
+			*value = (typeid == INT8OID) ? Int64GetDatum(swap.i) : Float8GetDatum(swap.f);
+			return true;
+		}
+	}
+	return false;
+}
+
 /*
  * Helper to determine the size of the null byte array
  */
@@ -722,7 +783,13 @@ gpdbwritableformatter_import(PG_FUNCTION_ARGS)
 				myData->outlen[i] = tupdesc->attrs[i]->attlen;
             }
 
-			if (isBinaryFormatType(tupdesc->attrs[i]->atttypid))
+			if (readFixedLengthDatum(tupdesc->attrs[i]->atttypid,
+									 data_buf+bufidx,
+									 &myData->values[i]))
+			{
+				/* decoded in place, no receive function call per value */
+			}
+			else if (isBinaryFormatType(tupdesc->attrs[i]->atttypid))
 			{
 				StringInfoData tmpbuf;
 				tmpbuf.data   = data_buf+bufidx;
@@ -167,6 +167,14 @@ static int	disable_dollar_quoting = 0;
 static int	dump_inserts = 0;
 static int	column_inserts = 0;
 
+/*
+ * --parallel-location: the segments write the table data to external tables
+ * there, instead of it going through the master into the archive.
+ */
+static char *parallel_location = NULL;
+static const char *parallel_format = "csv";
+static const char *parallel_compress = NULL;
+
 /* flag indicating whether or not this GP database supports partitioning */
 static bool gp_partitioning_available = false;
 
@@ -393,6 +401,9 @@ main(int argc, char **argv)
 		{"post-data-schema-only", no_argument, &postDataSchemaOnly, 1},
 		{"function-oids", required_argument, NULL, 3},
 		{"relation-oids", required_argument, NULL, 4},
+		{"parallel-location", required_argument, NULL, 5},
+		{"parallel-format", required_argument, NULL, 6},
+		{"parallel-compress", required_argument, NULL, 7},
 		/* END MPP ADDITION */
 		{NULL, 0, NULL, 0}
 	};
@@ -603,6 +614,18 @@ main(int argc, char **argv)
 				include_everything = false;
 				break;
 
+			case 5:
+				parallel_location = strdup(optarg);
+				break;
+
+			case 6:
+				parallel_format = strdup(optarg);
+				break;
+
+			case 7:
+				parallel_compress = strdup(optarg);
+				break;
+
 			default:
 				fprintf(stderr, _("Try \"%s --help\" for more information.\n"), progname);
 				exit(1);
@@ -650,6 +673,50 @@ main(int argc, char **argv)
 		exit(1);
 	}
 
+	if (parallel_location)
+	{
+		size_t		len = strlen(parallel_location);
+
+		while (len > 0 && parallel_location[len - 1] == '/')
+			parallel_location[--len] = '\0';
+
+		if (strncmp(parallel_location, "hdfs://", 7) != 0 &&
+			strncmp(parallel_location, "gpfdist://", 10) != 0)
+		{
+			write_msg(NULL, "parallel location \"%s\" must be an hdfs:// or gpfdist:// URL\n",
+					  parallel_location);
+			exit(1);
+		}
+		if (strcmp(parallel_format, "csv") != 0 &&
+			strcmp(parallel_format, "text") != 0 &&
+			strcmp(parallel_format, "orc") != 0)
+		{
+			write_msg(NULL, "invalid parallel format \"%s\" specified\n", parallel_format);
+			exit(1);
+		}
+		if (strcmp(parallel_format, "orc") == 0 &&
+			strncmp(parallel_location, "hdfs://", 7) != 0)
+		{
+			write_msg(NULL, "parallel format \"orc\" requires an hdfs:// location\n");
+			exit(1);
+		}
+		if (parallel_compress && strcmp(parallel_format, "orc") != 0)
+		{
+			write_msg(NULL, "option --parallel-compress requires --parallel-format=orc\n");
+			exit(1);
+		}
+		if (dump_inserts || oids)
+		{
+			write_msg(NULL, "option --parallel-location cannot be used with --inserts/--column-inserts (-d, -D) or OID (-o) options\n");
+			exit(1);
+		}
+	}
+	else if (parallel_compress || strcmp(parallel_format, "csv") != 0)
+	{
+		write_msg(NULL, "options --parallel-format and --parallel-compress require --parallel-location\n");
+		exit(1);
+	}
+
 	/* open the output file */
 	switch (format[0])
 	{
@@ -966,6 +1033,10 @@ help(const char *progname)
 	printf(_("  --no-gp-syntax              dump without Greenplum Database syntax (default if postgresql)\n"));
 	printf(_("  --function-oids             dump only function(s) of given list of oids\n"));
 	printf(_("  --relation-oids             dump only relation(s) of given list of oids\n"));
+	printf(_("  --parallel-location=URL     have the segments write table data to the\n"
+			 "                              hdfs:// or gpfdist:// URL, in parallel\n"));
+	printf(_("  --parallel-format=FORMAT    format of the parallel data: csv, text or orc\n"));
+	printf(_("  --parallel-compress=TYPE    compression of orc parallel data\n"));
 	/* END MPP ADDITION */
 
 	printf(_("\nConnection options:\n"));
@@ -1513,6 +1584,127 @@ dumpTableData_insert(Archive *fout, void *dcontext)
 	return 1;
 }
 
+/*
+ * Append the definition of the external table a table's data is exported
+ * to or imported from with --parallel-location.  Its columns are the
+ * table's undropped ones, in the order fmtCopyColumnList() lists them.
+ */
+static void
+appendParallelExtTable(PQExpBuffer q, const TableInfo *tbinfo, bool writable,
+					   const char *extname, Archive *fout)
+{
+	PQExpBuffer location = createPQExpBuffer();
+	const char *nspname = tbinfo->dobj.namespace->dobj.name;
+	const char *relname = tbinfo->dobj.name;
+	bool		needComma = false;
+	int			j;
+
+	/*
+	 * The data of a table goes to its own directory (or gpfdist file) under
+	 * the location, named after the table when that needs no quoting in a
+	 * URL.
+	 */
+	if (strspn(nspname, "abcdefghijklmnopqrstuvwxyz0123456789_") == strlen(nspname) &&
+		strspn(relname, "abcdefghijklmnopqrstuvwxyz0123456789_") == strlen(relname))
+		appendPQExpBuffer(location, "%s/%s.%s",
+						  parallel_location, nspname, relname);
+	else
+		appendPQExpBuffer(location, "%s/table_%u",
+						  parallel_location, tbinfo->dobj.catId.oid);
+
+	appendPQExpBuffer(q, "CREATE %sEXTERNAL TEMP TABLE %s (",
+					  writable ? "WRITABLE " : "", extname);
+	for (j = 0; j < tbinfo->numatts; j++)
+	{
+		if (tbinfo->attisdropped[j])
+			continue;
+		if (needComma)
+			appendPQExpBuffer(q, ", ");
+		appendPQExpBuffer(q, "%s ", fmtId(tbinfo->attnames[j]));
+		appendPQExpBuffer(q, "%s", tbinfo->atttypnames[j]);
+		needComma = true;
+	}
+	appendPQExpBuffer(q, ") LOCATION (");
+	appendStringLiteralAH(q, location->data, fout);
+	appendPQExpBuffer(q, ") FORMAT '%s'", parallel_format);
+	if (parallel_compress)
+	{
+		appendPQExpBuffer(q, " (compresstype ");
+		appendStringLiteralAH(q, parallel_compress, fout);
+		appendPQExpBuffer(q, ")");
+	}
+
+	destroyPQExpBuffer(location);
+}
+
+/*
+ *	Dump a table's contents with --parallel-location.  The segments write
+ *	the rows to a writable external table in the dump's transaction, so
+ *	they see the same snapshot as the rest of the dump, and the archive
+ *	only gets the commands that load them back, in parallel too.
+ */
+static int
+dumpTableData_parallel(Archive *fout, void *dcontext)
+{
+	TableDataInfo *tdinfo = (TableDataInfo *) dcontext;
+	TableInfo  *tbinfo = tdinfo->tdtable;
+	const char *classname = tbinfo->dobj.name;
+	const char *column_list = fmtCopyColumnList(tbinfo);
+	char	   *select_list;
+	PQExpBuffer q = createPQExpBuffer();
+	char		extname[NAMEDATALEN];
+
+	/* no undropped columns, nothing to export */
+	if (column_list[0] == '\0')
+	{
+		destroyPQExpBuffer(q);
+		return 1;
+	}
+	column_list = strdup(column_list);
+
+	if (g_verbose)
+		write_msg(NULL, "exporting contents of table %s\n", classname);
+
+	selectSourceSchema(tbinfo->dobj.namespace->dobj.name);
+
+	snprintf(extname, sizeof(extname), "pg_dump_ext_%u", tbinfo->dobj.catId.oid);
+	appendParallelExtTable(q, tbinfo, true, extname, fout);
+	do_sql_command(g_conn, q->data);
+
+	/* the column list without its parentheses */
+	select_list = strdup(column_list + 1);
+	select_list[strlen(select_list) - 1] = '\0';
+
+	resetPQExpBuffer(q);
+	appendPQExpBuffer(q, "INSERT INTO %s SELECT %s ", extname, select_list);
+	appendPQExpBuffer(q, "FROM ONLY %s",
+					  fmtQualifiedId(tbinfo->dobj.namespace->dobj.name,
+									 classname));
+	do_sql_command(g_conn, q->data);
+
+	resetPQExpBuffer(q);
+	appendPQExpBuffer(q, "DROP EXTERNAL TABLE %s", extname);
+	do_sql_command(g_conn, q->data);
+
+	/* the commands that load the rows back */
+	snprintf(extname, sizeof(extname), "pg_restore_ext_%u", tbinfo->dobj.catId.oid);
+	resetPQExpBuffer(q);
+	appendParallelExtTable(q, tbinfo, false, extname, fout);
+	appendPQExpBuffer(q, ";\n");
+	archputs(q->data, fout);
+
+	resetPQExpBuffer(q);
+	appendPQExpBuffer(q, "INSERT INTO %s %s ", fmtId(classname), column_list);
+	appendPQExpBuffer(q, "SELECT * FROM %s;\n", extname);
+	appendPQExpBuffer(q, "DROP EXTERNAL TABLE %s;\n\n\n", extname);
+	archputs(q->data, fout);
+
+	free((void *) column_list);
+	free(select_list);
+	destroyPQExpBuffer(q);
+	return 1;
+}
+
 
 /*
  * dumpTableData -
@@ -1528,7 +1720,13 @@ dumpTableData(Archive *fout, TableDataInfo *tdinfo)
 	DataDumperPtr dumpFn;
 	char	   *copyStmt;
 
-	if (!dump_inserts)
+	if (parallel_location && tbinfo->relstorage != RELSTORAGE_EXTERNAL)
+	{
+		/* The segments export, restore using INSERT ... SELECT */
+		dumpFn = dumpTableData_parallel;
+		copyStmt = NULL;
+	}
+	else if (!dump_inserts)
 	{
 		/* Dump/restore using COPY */
 		dumpFn = dumpTableData_copy;
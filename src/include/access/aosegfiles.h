@@ -104,6 +104,19 @@ typedef struct FileSegTotals
 	int64		totalbytesuncompressed; /* the sum of all 'eofuncompressed' values */
 } FileSegTotals;
 
+/*
+ * One row of the segment file catalog (pg_aoseg_* or pg_paqseg_*) of an
+ * append only relation, see GetSegfileCatalogEntries.
+ */
+typedef struct SegfileCatalogEntry
+{
+	int			segno;
+	int64		eof;
+	int64		tupcount;
+	int64		varblockcount;		/* always 0 for parquet */
+	int64		eof_uncompressed;	/* InvalidUncompressedEof if null */
+} SegfileCatalogEntry;
+
 typedef enum
 {
 	SegfileNoLock,
@@ -157,6 +170,9 @@ GetSegFilesTotals(Relation parentrel, Snapshot appendOnlyMetaDataSnapshot);
 
 extern int64 GetAOTotalBytes(Relation parentrel, Snapshot appendOnlyMetaDataSnapshot);
 
+extern SegfileCatalogEntry *
+GetSegfileCatalogEntries(Relation segrel, bool isAoRows, Snapshot snapshot, int *nentries);
+
 extern void FreeAllSegFileInfo(FileSegInfo **allSegInfo,
 							   int totalSegFiles);
 
@@ -182,4 +198,7 @@ get_ao_compression_ratio_name(PG_FUNCTION_ARGS);
 extern Datum 
 get_ao_compression_ratio_oid(PG_FUNCTION_ARGS);
 
+extern Datum
+get_ao_tupcount_oid(PG_FUNCTION_ARGS);
+
 #endif   /* AOSEGFILES_H */
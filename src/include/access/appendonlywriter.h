@@ -78,6 +78,7 @@ typedef struct AOSegfileStatus
 	bool			isfull;	   		/* if true - never insert into this segno *
 									 * anymore 								  */
 	bool			needCheck;		/* need to check if the segfile contain unexpected garbage data */
+	uint32			checkGeneration; /* bumped whenever needCheck is set */
 	/* The following fields is for HAWQ 2.0 */
 	int segno;	/* The segment file number of this file */
 	int next;	/* The index of the next AOSegfileStatus */
@@ -113,11 +114,28 @@ typedef struct AORelHashEntryData
 typedef AORelHashEntryData	*AORelHashEntry;
 
 
+/*
+ * Versions of the segment file catalogs (pg_aoseg_*, pg_paqseg_*, ...).
+ *
+ * Each slot covers the segment file catalogs whose oid hashes to it and packs
+ * a counter, bumped whenever a transaction that changed one of them ends, in
+ * the high 32 bits with the xid of that transaction in the low 32 bits. The
+ * transactional bumps happen while ProcArrayLock is held exclusively, so a
+ * snapshot that sees the recorded xid as completed sees every change counted
+ * by the version. Backends use this to validate the segment file catalog rows
+ * they cache, see GetSegfileCatalogEntries.
+ */
+#define AOSEG_VERSION_SLOTS 1024
+
+#define SegfileVersionCounter(version)	((uint32) ((version) >> 32))
+#define SegfileVersionXid(version)		((TransactionId) ((version) & 0xFFFFFFFF))
+
 typedef struct AppendOnlyWriterData
 {
 	int		num_existing_aorels; /* Current # of recorded entries for AO relations */
 	int num_existing_segfilestatus;	/* Current # of recorded segment status for AO relations */
 	int head_free_segfilestatus;
+	uint64	segfile_versions[AOSEG_VERSION_SLOTS]; /* see above */
 } AppendOnlyWriterData;
 extern AppendOnlyWriterData	*AppendOnlyWriter;
 
@@ -136,6 +154,11 @@ extern void AORelRemoveHashEntryOnCommit(Oid relid);
 extern void AtCommit_AppendOnly(bool isSubTransaction);
 extern void AtAbort_AppendOnly(bool isSubTransaction);
 extern void AtEOXact_AppendOnly(void);
+extern void AORelNoteSegfileChange(Oid segrelid, bool visibleNow);
+extern bool AORelSegfileChangedLocally(Oid segrelid);
+extern uint64 AORelGetSegfileVersion(Oid segrelid);
+extern void AORelAdvanceSegfileVersions(TransactionId xid);
+extern void AORelInvalidateSegfileVersions(void);
 
 extern void ValidateAppendOnlyMetaDataSnapshot(
 	Snapshot *appendOnlyMetaDataSnapshot);
@@ -106,6 +106,7 @@ extern FileScanDesc external_beginscan(ExternalScan *extScan,
 extern void external_rescan(FileScanDesc scan);
 extern void external_endscan(FileScanDesc scan);
 extern void external_stopscan(FileScanDesc scan);
+extern void external_open_ahead(FileScanDesc scan);
 extern ExternalSelectDesc external_getnext_init(PlanState *state,
                                                 ExternalScanState *es_state);
 extern bool external_getnext(FileScanDesc scan,
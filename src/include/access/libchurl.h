@@ -127,6 +127,7 @@ size_t churl_write(CHURL_HANDLE handle, const char* buf, size_t bufsize);
  * Receive up to max_size into buf
  */
 size_t churl_read(CHURL_HANDLE handle, char* buf, size_t max_size);
+void churl_read_prefetch(CHURL_HANDLE handle, size_t max_buffered);
 /*
  * Check connectivity by reading some bytes and checking response
  */
@@ -191,6 +191,8 @@ extern uint32 compute_memtuple_size(MemTupleBinding *pbind, Datum *values, bool
 extern MemTuple memtuple_copy_to(MemTuple mtup, MemTupleBinding *pbind, MemTuple dest, uint32 *destlen);
 extern MemTuple memtuple_form_to(MemTupleBinding *pbind, Datum *values, bool *isnull, MemTuple dest, uint32 *destlen, bool inline_toast);
 extern void memtuple_deform(MemTuple mtup, MemTupleBinding *pbind, Datum *datum, bool *isnull);
+/* Deform the attributes from `from' up to `to', excluded, 0 based */
+extern void memtuple_getattrs(MemTuple mtup, MemTupleBinding *pbind, int from, int to, Datum *datum, bool *isnull);
 
 extern Oid MemTupleGetOid(MemTuple mtup, MemTupleBinding *pbind);
 extern void MemTupleSetOid(MemTuple mtup, MemTupleBinding *pbind, Oid oid);
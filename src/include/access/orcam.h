@@ -98,6 +98,8 @@ extern OrcScanDescData* orcBeginRead(Relation rel, Snapshot snapshot,
                                      TupleDesc desc, List* fileSplits,
                                      bool* colToReads, void* pushDown);
 extern void orcReadNext(OrcScanDescData* scanData, TupleTableSlot* slot);
+extern int orcReadNextBatch(OrcScanDescData* scanData, TupleDesc tupleDesc,
+                            int maxRows, Datum** values, bool** nulls);
 extern void orcEndRead(OrcScanDescData* scanData);
 extern void orcResetRead(OrcScanDescData* scanData);
 
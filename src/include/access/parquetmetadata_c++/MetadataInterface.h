@@ -30,12 +30,12 @@
 
 typedef enum CompressionCodecName
 {
-	UNCOMPRESSED, SNAPPY, GZIP, LZO
+	UNCOMPRESSED, SNAPPY, GZIP, LZO, BROTLI, LZ4, ZSTD, LZ4_RAW
 } CompressionCodecName;
 
 typedef enum Encoding
 {
-	PLAIN, GROUP_VAR_INT, PLAIN_DICTIONARY, RLE, BIT_PACKED
+	PLAIN, GROUP_VAR_INT, PLAIN_DICTIONARY, RLE, BIT_PACKED, DELTA_BINARY_PACKED
 } Encoding;// Encoding;
 
 typedef enum PrimitiveTypeName
@@ -102,6 +102,9 @@ typedef struct ColumnChunkMetadata_4C
 	int64_t file_offset;
 
 	int64_t firstDataPage;
+
+	/* Byte offset of the dictionary page, before the first data page, 0 if there is none */
+	int64_t dictionaryPageOffset;
 	long valueCount;
 
     /* total byte size of all compressed pages in this column chunk (including the headers) */
@@ -110,6 +113,20 @@ typedef struct ColumnChunkMetadata_4C
     /* total byte size of all uncompressed pages in this column chunk (including the headers) */
 	int64_t totalUncompressedSize;
 
+	/*
+	 * statistics of the column chunk, written in the footer only. nullCount
+	 * is -1 if the file has no statistics for the column chunk.
+	 */
+	int64_t nullCount;
+	/*
+	 * whether minValue and maxValue are set, they are for the fixed width
+	 * numeric and date/time columns only and as plain encoded: 4 bytes for
+	 * INT32 and FLOAT, 8 bytes for INT64 and DOUBLE.
+	 */
+	int hasMinMax;
+	char minValue[8];
+	char maxValue[8];
+
 } ColumnChunkMetadata_4C;
 
 /* rowgroup metadata */
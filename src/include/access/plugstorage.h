@@ -167,6 +167,12 @@ typedef struct PlugStorageData
 	/* The following two fields are for parameterized index scan */
 	IndexRuntimeKeyInfo*    runtime_key_info;
 	int                     num_run_time_keys;
+	/* For getnext_batch, the column vectors a batch of rows is read into */
+	int                     ps_batch_max_rows;
+	int                     ps_batch_num_rows;
+	bool                   *ps_batch_proj;
+	Datum                 **ps_batch_values;
+	bool                  **ps_batch_nulls;
 } PlugStorageData;
 
 typedef PlugStorageData *PlugStorage;
@@ -239,6 +245,19 @@ bool InvokePlugStorageFormatGetNext(FmgrInfo *func,
                                     ScanState *scanState,
                                     TupleTableSlot *tupTableSlot);
 
+/*
+ * Reads up to maxRows rows into values[i] and nulls[i] for the columns i
+ * of proj, and returns the number of rows read, 0 at the end of the scan.
+ * The pass-by-reference values live until the next batch is read.
+ */
+int InvokePlugStorageFormatGetNextBatch(FmgrInfo *func,
+                                        FileScanDesc fileScanDesc,
+                                        ScanState *scanState,
+                                        int maxRows,
+                                        bool *proj,
+                                        Datum **values,
+                                        bool **nulls);
+
 void InvokePlugStorageFormatReScan(FmgrInfo *func,
                                    FileScanDesc fileScanDesc,
                                    ScanState* scanState,
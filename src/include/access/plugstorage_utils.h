@@ -39,6 +39,7 @@ typedef struct PlugStorageScanFuncs
 	FmgrInfo *beginscan;
 	FmgrInfo *getnext_init;
 	FmgrInfo *getnext;
+	FmgrInfo *getnext_batch;	/* optional, NULL if rows are read one by one */
 	FmgrInfo *rescan;
 	FmgrInfo *endscan;
 	FmgrInfo *stopscan;
@@ -0,0 +1,52 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * pxffragmentscache.h
+ *
+ * Session cache of the responses of the PXF Fragmenter, used by the QD to
+ * avoid fragmenting the same external data for every query.
+ */
+
+#ifndef _PXF_FRAGMENTS_CACHE_H_
+#define _PXF_FRAGMENTS_CACHE_H_
+
+#include "postgres.h"
+
+/*
+ * Returns the cached Fragmenter response for the key, or NULL if there is
+ * none or it is older than pxf_fragments_cache_ttl. The response is owned
+ * by the cache and stays valid until the next call of a function of this
+ * module.
+ */
+extern const char *PxfFragmentsCacheLookup(const char *key);
+
+/*
+ * Cache the Fragmenter response for the key, which is only valid as long as
+ * the external table relid is not altered or dropped.
+ */
+extern void PxfFragmentsCacheInsert(Oid relid, const char *key, const char *response);
+
+/*
+ * Remove the responses cached for the external table relid, or all of them
+ * if relid is InvalidOid.
+ */
+extern void PxfFragmentsCacheInvalidate(Oid relid);
+
+#endif /* _PXF_FRAGMENTS_CACHE_H_ */
@@ -57,6 +57,7 @@ typedef struct sDataFragment
 	char *fragment_md; /* fragment meta data (start, end, length, etc.) */
 	char *user_data;
 	char *profile;
+	int64 length; /* fragment length in bytes, 0 if the fragmenter does not report it */
 } DataFragment;
 
 /*
@@ -72,7 +73,7 @@ extern List* get_datanode_rest_servers(GPHDUri *hadoop_uri, ClientContext* clien
 extern void free_datanode_rest_servers(List *srvrs);
 extern void free_datanode_rest_server(PxfServer* srv);
 extern PxfFragmentStatsElem *get_fragments_statistics(GPHDUri* hadoop_uri, ClientContext *cl_context);
-extern List* get_data_fragment_list(GPHDUri *hadoop_uri,  ClientContext* client_context);
+extern List* get_data_fragment_list(GPHDUri *hadoop_uri,  ClientContext* client_context, Oid relid, char *filterstr);
 extern void free_fragment(DataFragment *fragment);
 extern List* get_external_metadata(GPHDUri* hadoop_uri, char *profile, char *pattern, ClientContext *client_context, Oid dboid);
 extern List* get_and_cache_external_metadata(GPHDUri* hadoop_uri, char *profile, char *pattern, ClientContext *client_context, Oid dboid);
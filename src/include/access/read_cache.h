@@ -28,6 +28,7 @@ extern void InitReadCache(void);
 extern Size ReadCacheShmemSize(void);
 
 extern void ReadCacheHashEntryReviseOnCommit(Oid relid, bool dropTable);
+extern void ReadCacheHashEntryRevise(Oid relid);
 extern void AtEOXact_ReadCache(bool commit);
 
 extern void resetReadCache(bool enable);
@@ -205,6 +205,7 @@ extern XLogRecPtr XLogLastChangeTrackedLoc(void);
 extern uint32 XLogLastInsertTotalLen(void);
 extern uint32 XLogLastInsertDataLen(void);
 extern void XLogFlush(XLogRecPtr RecPtr);
+extern void XLogFlushCommit(XLogRecPtr RecPtr);
 
 extern void xlog_redo(XLogRecPtr beginLoc __attribute__((unused)), XLogRecPtr lsn __attribute__((unused)), XLogRecord *record);
 extern void xlog_desc(StringInfo buf, XLogRecPtr beginLoc, XLogRecord *record);
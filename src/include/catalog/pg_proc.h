@@ -9896,6 +9896,10 @@ DESCR("show append only table compression ratio");
 DATA(insert OID = 7172 ( get_ao_compression_ratio  PGNSP PGUID 12 f f f f v 1 701 f "25" _null_ _null_ _null_ get_ao_compression_ratio_name - _null_ r ));
 DESCR("show append only table compression ratio");
 
+/* get_ao_tupcount(oid) => int8 */ 
+DATA(insert OID = 7186 ( get_ao_tupcount  PGNSP PGUID 12 f f t f s 1 20 f "26" _null_ _null_ _null_ get_ao_tupcount_oid - _null_ r ));
+DESCR("total number of tuples of an append only or parquet table, from its segment file catalog");
+
 /* gp_update_ao_master_stats(oid) => float8 */ 
 DATA(insert OID = 7173 ( gp_update_ao_master_stats  PGNSP PGUID 12 f f f f v 1 701 f "26" _null_ _null_ _null_ gp_update_ao_master_stats_oid - _null_ m ));
 DESCR("append only tables utility function");
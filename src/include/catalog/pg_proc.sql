@@ -5231,6 +5231,8 @@
 
  CREATE FUNCTION get_ao_compression_ratio(text) RETURNS float8 LANGUAGE internal VOLATILE READS SQL DATA AS 'get_ao_compression_ratio_name' WITH (OID=7172, DESCRIPTION="show append only table compression ratio");
 
+ CREATE FUNCTION get_ao_tupcount(oid) RETURNS int8 LANGUAGE internal STABLE STRICT READS SQL DATA AS 'get_ao_tupcount_oid' WITH (OID=7186, DESCRIPTION="total number of tuples of an append only or parquet table, from its segment file catalog");
+
  CREATE FUNCTION gp_update_ao_master_stats(oid) RETURNS float8 LANGUAGE internal VOLATILE MODIFIES SQL DATA AS 'gp_update_ao_master_stats_oid' WITH (OID=7173, DESCRIPTION="append only tables utility function");
 
  CREATE FUNCTION gp_update_ao_master_stats(text) RETURNS float8 LANGUAGE internal VOLATILE MODIFIES SQL DATA AS 'gp_update_ao_master_stats_name' WITH (OID=7174, DESCRIPTION="append only tables utility function");
@@ -150,6 +150,7 @@ DATA(insert OID = 6055 ( "pg_default" 9800   "20"    "50%"  "50%"  2 "even" "mem
  */
 enum RESOURCE_QUEUE_ALLOCATION_POLICY_INDEX {
 	RSQ_ALLOCATION_POLICY_EVEN = 0,
+	RSQ_ALLOCATION_POLICY_WFQ,
 
 	RSQ_ALLOCATION_POLICY_COUNT
 };
@@ -268,6 +268,17 @@ typedef FormData_pg_statistic *Form_pg_statistic;
  */
 #define STATISTIC_KIND_CORRELATION	3
 
+/*
+ * A "dependency" slot describes how much the values of this column determine
+ * the values of other columns of the relation.  staop and stavalues are not
+ * used.  stanumbers contains pairs of entries: the attribute number of the
+ * other column, and the fraction of the rows, among the rows with a non-null
+ * value in this column, whose group of equal values has a single value in
+ * the other column.  The fraction is 1 for a functional dependency and gets
+ * lower as the columns are independent.  This is a GPDB-private kind.
+ */
+#define STATISTIC_KIND_DEPENDENCY	10001
+
 
 /* TIDYCAT_BEGINFAKEDEF
 
@@ -67,6 +67,14 @@
 #define DEFAULT_FS_SAFE_WRITE_SIZE			 (0)
 #define DEFAULT_SPLIT_WRITE_SIZE (appendonly_split_write_size_mb * 1024 * 1024)
 
+/*
+ * Number of column groups of a row of natts columns with groupsize columns
+ * per group, a groupsize of 0 means a single group.
+ */
+#define AppendOnlyColumnGroupCount(natts, groupsize) \
+	((groupsize) <= 0 || (natts) <= (groupsize) ? 1 : \
+	 ((natts) + (groupsize) - 1) / (groupsize))
+
 /*
  * AppendOnlyInsertDescData is used for inserting data into append-only
  * relations. It serves an equivalent purpose as AppendOnlyScanDescData
@@ -120,6 +128,17 @@ typedef struct AppendOnlyInsertDescData
 
 	QueryContextDispatchingSendBack sendback;
 
+	/*
+	 * Column groups, see the columngroupsize storage option. With more than
+	 * one group, each row is split into one memtuple per group and the
+	 * groups have a VarBlock each instead of varBlockMaker.
+	 */
+	int				numColumnGroups;
+	int				columnGroupSize;
+	struct AppendOnlyColumnGroupWrite *columnGroups;
+	Datum			*groupValues;
+	bool			*groupIsnull;
+
 } AppendOnlyInsertDescData;
 
 typedef AppendOnlyInsertDescData *AppendOnlyInsertDesc;
@@ -209,6 +228,18 @@ typedef struct AppendOnlyScanDescData
 	List *splits;
 
 	bool toCloseFile;
+
+	/*
+	 * Column groups, see the columngroupsize storage option. The blocks of a
+	 * row range come one after the other, executorReadBlock has the block
+	 * of the first group and groupReadBlocks those of the others. Only the
+	 * blocks of the groups in groupNeeded are decompressed and deformed.
+	 */
+	int			numColumnGroups;
+	int			columnGroupSize;
+	bool		*groupNeeded;
+	AppendOnlyExecutorReadBlock	*groupReadBlocks;
+	int			groupRowIndex;		/* next row of the current blocks */
 }	AppendOnlyScanDescData;
 
 typedef AppendOnlyScanDescData *AppendOnlyScanDesc;
@@ -221,7 +252,8 @@ typedef AppendOnlyScanDescData *AppendOnlyScanDesc;
 extern AppendOnlyScanDesc appendonly_beginscan(Relation relation,
 											   Snapshot appendOnlyMetaDataSnapshot,
 											   int nkeys, 
-											   ScanKey key);
+											   ScanKey key,
+											   bool *proj);
 extern void appendonly_rescan(AppendOnlyScanDesc scan, ScanKey key);
 extern void appendonly_endscan(AppendOnlyScanDesc scan);
 extern MemTuple appendonly_getnext(AppendOnlyScanDesc scan, 
@@ -25,6 +25,10 @@
  * The client is given direct access to large read buffer for reading
  * buffers efficiency.
  *
+ * When gp_appendonly_read_ahead_buffers is set, the large reads that follow
+ * the current one are done ahead by a helper thread, into buffers of their
+ * own that take turns as the large read memory.
+ *
  *-------------------------------------------------------------------------
  */
 #ifndef CDBBUFFEREDREAD_H
@@ -89,6 +93,11 @@ typedef struct BufferedRead
 	bool				haveTemporaryLimitInEffect;
 	int64				temporaryLimitFileLen;
 
+	/*
+	 * Read-ahead of the current file, NULL when reading synchronously.
+	 */
+	struct BufferedReadAhead *readAhead;
+
 } BufferedRead;
 
 /*
@@ -208,5 +217,10 @@ extern void BufferedReadCompleteFile(
 extern void BufferedReadFinish(
     BufferedRead *bufferedRead);
 
+/*
+ * Stop the read-ahead left behind by an aborted scan.
+ */
+extern void AtEOXact_BufferedRead(void);
+
 #endif   /* CDBBUFFEREDREAD_H */
 
@@ -109,6 +109,46 @@ extern unsigned int cdbhashreduce(CdbHash *h);
  */
 extern unsigned int magichashreduce(CdbHash *h, int *map, int nmap);
 
+/*
+ * Batched versions of the above, for a column of nrows values at a time.
+ * hashes[i] is the hash of row i, and ends up the same as hashing the row
+ * with the functions above.  isnull may be NULL when no value is null.
+ */
+extern void cdbhashinit_batch(CdbHash *h, uint32 *hashes, int nrows);
+extern void cdbhash_batch(CdbHash *h, uint32 *hashes, int nrows,
+						  const Datum *values, const bool *isnull, Oid typid);
+extern void cdbhashnokey_batch(CdbHash *h, uint32 *hashes, int nrows);
+extern void cdbhashreduce_batch(CdbHash *h, const uint32 *hashes, int nrows,
+								unsigned int *segs);
+extern void magichashreduce_batch(CdbHash *h, const uint32 *hashes, int nrows,
+								  int *map, int nmap, unsigned int *segs);
+
+/*
+ * The fixed width types cdbhash_batch() hashes without hashDatum(), by the
+ * integer hashDatum() would hash.  The ones up to CDBHASH_AVX2_MAX_KERNEL
+ * have an AVX2 kernel.
+ */
+typedef enum CdbHashBatchKernel
+{
+	CDBHASH_KERNEL_NONE = 0,
+	CDBHASH_KERNEL_INT2,		/* as an int64 */
+	CDBHASH_KERNEL_INT4,		/* as an int64 */
+	CDBHASH_KERNEL_INT8,
+	CDBHASH_KERNEL_OID,			/* as an int64 */
+	CDBHASH_KERNEL_DATE,		/* as an int32 */
+	CDBHASH_KERNEL_BOOL,
+	CDBHASH_KERNEL_CHAR
+} CdbHashBatchKernel;
+
+#define CDBHASH_AVX2_MAX_KERNEL CDBHASH_KERNEL_DATE
+
+/*
+ * The AVX2 kernel of cdbhash_batch(), see cdbhash_avx2.c.  Returns the
+ * number of leading rows it hashed.
+ */
+extern int cdbhash_batch_avx2(uint32 *hashes, int nrows, const Datum *values,
+							  const bool *isnull, CdbHashBatchKernel kernel);
+
 extern void InitJumpHashMap();
 extern int *get_jump_hash_map(int bucketNum);
 
@@ -199,6 +199,20 @@ struct ICBuffer
 };
 
 
+/*
+ * ICShmRing
+ * 		shared memory packet ring of a UDP-IC connection between two
+ * 		processes on the same host, see ic_shm.c.
+ */
+typedef struct ICShmRing
+{
+	char		name[64];		/* name of the POSIX shared memory object */
+	int			nslots;
+	int			slotSize;
+	Size		size;
+	uint8	   *base;
+} ICShmRing;
+
 /*
  * Structure used for keeping track of a pt-to-pt connection between two
  * Cdb Entities (either QE or QD).
@@ -225,6 +239,13 @@ struct MotionConn
 	uint64 dev;
 	uint64 deadlockCheckBeginTime;
 
+	/* smallest rtt seen and time the next packet may be sent, rtt flow control */
+	uint64 minRtt;
+	uint64 pacingNextTime;
+
+	/* the receiver got a packet marked CE, which the next ack reports */
+	bool ecnEcho;
+
 
 	ICBuffer *curBuff;
 
@@ -279,6 +300,9 @@ struct MotionConn
 	int			pkt_q_tail;
 	uint8		**pkt_q;
 
+	/* packet ring if the peer is on the same host, NULL otherwise */
+	ICShmRing	*shmRing;
+
 	/* Statistics info for this connection */
 
 	uint64 stat_total_ack_time;
@@ -288,6 +312,11 @@ struct MotionConn
 	uint64 stat_count_resent;
 	uint64 stat_max_resent;
 	uint64 stat_count_dropped;
+	uint64 stat_count_pkts_sent;
+	uint64 stat_count_pkts_recvd;
+	uint64 stat_count_disordered;
+	uint64 stat_count_duplicated;
+	uint64 stat_total_fc_wait_time;	/* usecs waiting for a send buffer */
 
 };
 
@@ -327,6 +356,9 @@ typedef struct ChunkTransportStateEntry
 	int			txfd_family;
 	unsigned short txport;
 
+	/* packets a sender may have unconsumed on each connection */
+	int			streamWindow;
+
 	bool		sendingEos;
 
 	/* Statistics info for this motion on the interconnect level */
@@ -337,6 +369,12 @@ typedef struct ChunkTransportStateEntry
 	uint64 stat_count_resent;
 	uint64 stat_max_resent;
 	uint64 stat_count_dropped;
+	uint64 stat_count_pkts_sent;
+	uint64 stat_count_pkts_recvd;
+	uint64 stat_count_disordered;
+	uint64 stat_count_duplicated;
+	uint64 stat_total_fc_wait_time;	/* usecs waiting for a send buffer */
+	uint64 stat_total_rx_wait_time;	/* usecs the receiver waited for data */
 
 }	ChunkTransportStateEntry;
 
@@ -435,6 +473,10 @@ typedef struct MotionNodeEntry
 	bool            moreNetWork;
 	bool            stopped;
 
+	/* Compress the chunks we send, and the buffer to compress them into. */
+	bool            compress;
+	char           *compress_buf;
+
 	/*
 	 * PER-MOTION-NODE STATISTICS
 	 */
@@ -515,6 +557,9 @@ typedef struct ChunkTransportState
 	bool		teardownActive;
 	List	   *incompleteConns;
 
+	/* TCP-IC: incoming routes left for the receivers to register. */
+	int			pendingIncoming;
+
 	/* slice table stuff. */
 	struct SliceTable  *sliceTable;
 	int			sliceId;
@@ -23,6 +23,7 @@
 #include "utils/palloc.h"
 #include "storage/fd.h"
 #include "storage/itemptr.h"
+#include "storage/lwlock.h"
 #include "cdb/cdbdoublylinked.h"
 #include "hdfs/hdfs.h"
 #include "cdb/cdbmetadatacache_internal.h"
@@ -43,6 +44,21 @@ Size MetadataCache_ShmemSize(void);
 
 void MetadataCache_ShmemInit(void);
 
+/*
+ *  Metadata Cache Locking
+ *
+ *  An entry of the cache and the chain of blocks it owns are protected by the
+ *  partition lock of its key. The free list of the block array and the block
+ *  info tables are protected by MetadataCacheLock, which is always taken after
+ *  the partition locks. A scan of the whole cache takes all the partition
+ *  locks, in order.
+ */
+LWLockId MetadataCachePartitionLock(const HdfsFileInfo *file_info);
+
+void MetadataCacheLockAllPartitions(LWLockMode mode);
+
+void MetadataCacheUnlockAllPartitions(void);
+
 /*
  * Metadata Cache User Interfaces
  */
@@ -52,6 +68,8 @@ void DestroyHdfsFileInfo(HdfsFileInfo *file_info);
 
 BlockLocation *GetHdfsFileBlockLocations(const HdfsFileInfo *file_info, uint64_t filesize, int *block_num, double *hit_ratio);
 
+void PrefetchHdfsFileBlockLocations(HdfsFileInfo **file_infos, uint64_t *filesizes, int nfiles);
+
 void FreeHdfsFileBlockLocations(BlockLocation *locations, int block_num);
 
 void DumpHdfsFileBlockLocations(BlockLocation *locations, int block_num);
@@ -60,6 +78,13 @@ void RemoveHdfsFileBlockLocations(const HdfsFileInfo *file_info);
 
 MetadataCacheEntry *MetadataCacheNew(const HdfsFileInfo *file_info, uint64_t filesize, BlockLocation *hdfs_locations, int block_num);
 
+/*
+ * Backend local cache of the block locations of external table files
+ */
+BlockLocation *GetExtFileBlockLocations(const char *filepath, int64 filesize, int *block_num);
+
+void PutExtFileBlockLocations(const char *filepath, int64 filesize, const BlockLocation *locations, int block_num);
+
 /*
  *  Metadata Cache Test User Interfaces
  */
@@ -82,6 +82,9 @@ extern void InitMotionLayerNode(MotionLayerState *mlStates, int16 motNodeID);
 extern void UpdateMotionLayerNode(MotionLayerState *mlStates, int16 motNodeID, bool preserveOrder,
 								  TupleDesc tupDesc, uint64 operatorMemKB);
 
+/* Compress the tuple chunks sent by a motion node. */
+extern void SetMotionLayerNodeCompression(MotionLayerState *mlStates, int16 motNodeID, bool compress);
+
 /* Cleanup of each motion node in execution plan (normal termination). */
 extern void EndMotionLayerNode(MotionLayerState *mlStates, int16 motNodeID, bool flushCommLayer);
 
@@ -32,6 +32,8 @@
 #include "nodes/relation.h"
 
 extern Plan *apply_motion(struct PlannerInfo *root, Plan *plan, Query *query);
+extern void directDispatchCalculateHash(Plan *plan, struct GpPolicy *targetPolicy,
+									   int numsegs);
 
 extern Motion *make_union_motion(Plan *lefttree,
 		                                int destSegIndex, bool useExecutorVarFormat);
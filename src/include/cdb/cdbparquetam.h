@@ -86,6 +86,9 @@ typedef struct ParquetScanDescData {
 	bool toCloseFile; // identify if it's ready to close segment file
 
 	RuntimeFilterState *rfState; /* Bloom filter */
+
+	/* clauses of the qual skipping row groups by their statistics */
+	List *rowGroupFilter;
 } ParquetScanDescData;
 
 typedef ParquetScanDescData *ParquetScanDesc;
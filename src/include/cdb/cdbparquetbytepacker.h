@@ -86,4 +86,16 @@ extern uint8_t *BitPack_Data(ByteBasedBitPackingEncoder *encoder);
 extern void pack8Values(int bitWidth, int32_t *in, int inPos, uint8_t* out, int outPos);
 extern void unpack8Values(int bitWidth, uint8_t *in, int inPos, int32_t *out, int outPos);
 
+/*
+ * Unpack `ngroups` groups of 8 values of `bitWidth` bits (1 to 32) from
+ * `in` to `out`. `inputSize` is the number of bytes readable from `in`, at
+ * least ngroups * bitWidth: the AVX2 kernel is used for the groups that
+ * leave it room to load a few bytes past their end.
+ */
+extern void unpackGroups(int bitWidth, uint8_t *in, int inputSize, int32_t *out, int ngroups);
+
+/* the AVX2 kernel of unpackGroups, see cdbparquetbytepacker_avx2.c */
+#define UNPACK_AVX2_MAX_BIT_WIDTH 25
+extern void unpackGroupsAVX2(int bitWidth, uint8_t *in, int32_t *out, int ngroups);
+
 #endif /* CDBPARQUETBYTEPACKER_H_ */
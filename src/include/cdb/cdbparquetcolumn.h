@@ -31,6 +31,9 @@
 
 #define DAFAULT_DATAPAGE_NUM_PER_COLUMNCHUNK 10
 
+/* the r/d levels and dictionary ids are decoded this many at a time */
+#define PARQUET_LEVEL_BLOCK_SIZE 1024
+
 /*
  * we call it CurrentDefinitionLevel because definition level is used to
  * determine whether the current value is null, the MACRO is used before
@@ -60,6 +63,21 @@ typedef struct ParquetColumnReader
     int                             repetitionLevel;
     int                             definitionLevel;
 
+    /*
+     * The r/d levels of the current page, decoded a block at a time.
+     * `levelBlockPos` is the next level to consume in the block.
+     */
+    int32                           repetitionLevels[PARQUET_LEVEL_BLOCK_SIZE];
+    int32                           definitionLevels[PARQUET_LEVEL_BLOCK_SIZE];
+    int                             levelBlockSize;
+    int                             levelBlockPos;
+
+    /* dictionary ids of a block of values, see ParquetColumnReader_readValues */
+    int32                           dictionaryIds[PARQUET_LEVEL_BLOCK_SIZE];
+
+    /* delta decoded values of a block, see ParquetColumnReader_readValues */
+    int64                           deltaValues[PARQUET_LEVEL_BLOCK_SIZE];
+
     /*
      * dataBuffer stores column chunk's raw data read from file.
      * This buffer is reused accross multiple row group.
@@ -81,6 +99,20 @@ typedef struct ParquetColumnReader
     char                            *pageBuffer;
     int32                           pageBufferLen;
 
+    /*
+     * The dictionary page of the chunk, NULL if the chunk has none. For a
+     * compressed column it is decompressed into `dictionaryBuffer`, which is
+     * reused across row groups. The values are decoded once per chunk into
+     * `dictionary`, at the first value read since the type is known then.
+     */
+    uint8_t                         *dictionaryData;
+    int                             dictionaryNumValues;
+    bool                            dictionaryDecoded;
+    Datum                           *dictionary;
+    int                             dictionaryCapacity;
+    char                            *dictionaryBuffer;
+    int32                           dictionaryBufferLen;
+
 	/*buffer reused for embedded type, avoid palloc each time for each tuple*/
     void                            *geoval;
 } ParquetColumnReader;
@@ -93,6 +125,12 @@ extern void ParquetExecutorReadColumn(
 extern void ParquetColumnReader_readValue(ParquetColumnReader *columnReader,
 		Datum *value, bool *null, int hawqTypeID);
 
+extern void ParquetColumnReader_readValues(ParquetColumnReader *columnReader,
+		Datum *values, bool *nulls, int nvalues, int hawqTypeID);
+
+extern void ParquetColumnReader_skipValues(ParquetColumnReader *columnReader,
+		int nvalues, int hawqTypeID);
+
 extern void ParquetColumnReader_readPoint(ParquetColumnReader readers[], Datum *value, bool *null);
 extern void ParquetColumnReader_readLSEG(ParquetColumnReader readers[], Datum *value, bool *null);
 extern void ParquetColumnReader_readPATH(ParquetColumnReader readers[], Datum *value, bool *null);
@@ -0,0 +1,155 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * cdbparquetdeltaencoder.h
+ *
+ *  Created on: Oct 14, 2026
+ */
+
+#ifndef CDBPARQUETDELTAENCODER_H_
+#define CDBPARQUETDELTAENCODER_H_
+
+#include "cdb/cdbparquetbitstreamutils.h"
+
+#define DELTA_BLOCK_SIZE			128
+#define DELTA_MINIBLOCK_COUNT		4
+#define DELTA_MINIBLOCK_SIZE		32	/* DELTA_BLOCK_SIZE / DELTA_MINIBLOCK_COUNT */
+
+/* room for the 3 unsigned varints and the zigzag varint of the header */
+#define DELTA_HEADER_MAX_SIZE		32
+
+/*
+ * Encodes int32 or int64 values with the DELTA_BINARY_PACKED encoding of
+ * parquet, according to the following grammar:
+ *
+ * delta-binary-packed := <header> <block>*
+ * header := <block size in values> <miniblock count in a block> <total value count> <first value>
+ * block := <min delta> <bit widths of the miniblocks> <miniblocks>
+ * min delta := zigzag varint, the smallest delta of the block
+ * bit widths of the miniblocks := 1 byte per miniblock
+ * miniblocks := for each miniblock, the (delta - min delta) of its values
+ *               bit packed back to back, from LSB to MSB
+ *
+ * The sizes and the count of the header are unsigned varints, the first
+ * value a zigzag varint. The deltas of INT32 values wrap at 32 bits.
+ *
+ * Each block of deltas is a frame of reference, and a miniblock takes only
+ * the bit width of its largest value over the min delta: a column of
+ * regularly increasing values, as a timestamp of fixed interval, has deltas
+ * of width 0 and takes a few bytes per block.
+ */
+typedef struct DeltaEncoder
+{
+	bool	is64;			/* INT64 values, INT32 otherwise */
+
+	int		totalCount;
+	int64	firstValue;
+	int64	previousValue;
+
+	/* the deltas of the block not written yet */
+	int64	deltas[DELTA_BLOCK_SIZE];
+	int		numDeltas;
+
+	/*
+	 * The blocks are written after DELTA_HEADER_MAX_SIZE bytes, where the
+	 * header goes at DeltaEncoder_Flush, right before the first block.
+	 */
+	CapacityByteWriter	writer;
+	int		headerPos;
+} DeltaEncoder;
+
+typedef struct DeltaDecoder
+{
+	bool	is64;
+
+	/* input buffer, contains encoded values */
+	uint8_t	*input;
+	int		inputPos;
+	int		inputSize;
+
+	int		blockSize;
+	int		miniblockCount;
+	int		miniblockSize;
+
+	/* values not read yet, the first value included */
+	int		valuesRemained;
+	bool	firstValueRead;
+	int64	firstValue;
+
+	/* deltas not unpacked yet */
+	int		deltasRemained;
+
+	/* the current block */
+	int64	minDelta;
+	uint8_t	*bitWidths;
+	int		miniblockIndex;
+
+	/* the values of the current miniblock, unpacked a miniblock at a time */
+	int64	previousValue;
+	int64	*miniblockValues;
+	int32_t	*packedValues;
+	int		miniblockValuesSize;
+	int		miniblockValuesPos;
+} DeltaDecoder;
+
+/*-----------------------------------------
+ * encoder API
+ * ----------------------------------------*/
+
+extern void DeltaEncoder_Init(DeltaEncoder *encoder, bool is64);
+
+extern void DeltaEncoder_WriteValue(DeltaEncoder *encoder, int64 value);
+
+/*
+ * Write the pending deltas and the header, return the size of the encoded
+ * data. No value can be written after it.
+ */
+extern int DeltaEncoder_Flush(DeltaEncoder *encoder);
+
+/*
+ * Return buffer of encoded data. DeltaEncoder_Flush must be called before
+ * this procedure.
+ */
+extern uint8_t *DeltaEncoder_Data(DeltaEncoder *encoder);
+
+/*
+ * Get the size of the encoded data, after DeltaEncoder_Flush. Before it,
+ * this is an upper bound of the size the values written so far take.
+ */
+extern int DeltaEncoder_Size(DeltaEncoder *encoder);
+
+extern void DeltaEncoder_Free(DeltaEncoder *encoder);
+
+/*-----------------------------------------
+ * decoder API
+ * ----------------------------------------*/
+
+extern void DeltaDecoder_Init(DeltaDecoder *decoder, bool is64, uint8_t *in, int inputSize);
+
+/*
+ * Read the next `n` values into `out`, the INT32 values sign extended. The
+ * deltas are unpacked and summed up a miniblock at a time. Return the number
+ * of values read, less than `n` only at the end of the input.
+ */
+extern int DeltaDecoder_ReadValues(DeltaDecoder *decoder, int64 *out, int n);
+
+extern void DeltaDecoder_Free(DeltaDecoder *decoder);
+
+#endif /* CDBPARQUETDELTAENCODER_H_ */
@@ -69,8 +69,14 @@ ParquetFooterBuffer *createParquetFooterBuffer( File  dataFile,
 												int   capacity,
 												int   mode);
 
+ParquetFooterBuffer *createParquetFooterBufferFromMemory( char    *filename,
+                                                          uint8_t *footer,
+                                                          int      footerlength);
+
 void freeParquetFooterBuffer( ParquetFooterBuffer *buffer);
 
+void fillBufferFromFile(File file, char *filename, uint8_t *buffer, int size);
+
 int  prepareFooterBufferForwardReading( ParquetFooterBuffer  *buffer,
                                         int                   length,
                                         uint8_t             **ptr);
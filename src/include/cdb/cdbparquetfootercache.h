@@ -0,0 +1,63 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * cdbparquetfootercache.h
+ *
+ * Shared memory cache of the footers of the parquet segment files, so that
+ * the QEs of a host read the footer of a file once for all scans.
+ */
+
+#ifndef CDBPARQUETFOOTERCACHE_H
+#define CDBPARQUETFOOTERCACHE_H
+
+#include "postgres.h"
+
+/*
+ * Parquet Footer Cache Share Memory Init
+ */
+Size ParquetFooterCache_ShmemSize(void);
+
+void ParquetFooterCache_ShmemInit(void);
+
+/*
+ * Whether a footer of `footerLen` bytes is to be cached.
+ */
+bool ParquetFooterCache_Cacheable(int footerLen);
+
+/*
+ * Returns a palloc'd copy of the footer of the file whose logical eof is
+ * `eof`, and its length in *footerLen, or NULL if it is not cached.
+ */
+uint8_t *ParquetFooterCache_Lookup(const char *filePath, int64 eof, int *footerLen);
+
+/*
+ * Cache the `footerLen` bytes of `footer`, the footer of the file whose
+ * logical eof is `eof`. If the cache is full, the footers used least
+ * recently are evicted.
+ */
+void ParquetFooterCache_Insert(const char *filePath, int64 eof,
+							   const uint8_t *footer, int footerLen);
+
+/*
+ * Remove the footer of the file, as it is appended to.
+ */
+void ParquetFooterCache_Invalidate(const char *filePath);
+
+#endif /* CDBPARQUETFOOTERCACHE_H */
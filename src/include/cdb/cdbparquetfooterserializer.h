@@ -43,6 +43,15 @@ initDeserializeFooter(
 		ParquetMetadata *parquetMetadata,
 		CompactProtocol **footerProtocol);
 
+/* Initialize deserialize footer already read into memory */
+void
+initDeserializeFooterFromMemory(
+		uint8_t *footer,
+		int footerLength,
+		char *fileName,
+		ParquetMetadata *parquetMetadata,
+		CompactProtocol **footerProtocol);
+
 /* Get next row group metadata information */
 void
 readNextRowGroupInfo(
@@ -91,6 +91,9 @@ typedef struct CompactProtocol{
 void initCompactProtocol(CompactProtocol *protocol, File fileHandler, char *fileName,
 		int64 footerIndex, int mode);
 
+void initCompactProtocolFromMemory(CompactProtocol *protocol, char *fileName,
+		uint8_t *footer, int footerLength);
+
 void freeCompactProtocol(CompactProtocol *protocol);
 
 /**
@@ -114,6 +117,7 @@ uint32_t readI16(CompactProtocol *prot, int16_t *i16);
 uint32_t readI32(CompactProtocol *prot, int32_t *i32);
 uint32_t readI64(CompactProtocol *prot, int64_t *i64);
 uint32_t readString(CompactProtocol *prot, char **str);
+uint32_t readBinary(CompactProtocol *prot, char **str, int32_t *len);
 uint32_t skipType(CompactProtocol *prot, TType type);
 
 
@@ -133,10 +133,13 @@ typedef struct RLEDecoder
     int rleValue;
 
     /*
-     * for bit-packed-run, we unpacked all values in a buffer
+     * for bit-packed-run, the values are unpacked in a buffer up to
+     * BITPACK_RUN_MAX_VALUE_COUNT at a time, `inputPos` is at the groups
+     * not unpacked yet.
      */
     int bitpackBuffer[BITPACK_RUN_MAX_VALUE_COUNT];
     int bitpackBufferSize;
+    int bitpackBufferPos;
 
 } RLEDecoder;
 
@@ -174,4 +177,11 @@ extern void RLEDecoder_Init(RLEDecoder *decoder, int bitWidth, uint8_t *in, int
 
 extern int  RLEDecoder_ReadInt(RLEDecoder *decoder);
 
+/*
+ * Read the next `n` values into `out`. The rle-runs are copied, and the
+ * bit-packed-runs unpacked, a run at a time. Return the number of values
+ * read, less than `n` only at the end of the input.
+ */
+extern int  RLEDecoder_ReadInts(RLEDecoder *decoder, int32_t *out, int n);
+
 #endif /* CDBPARQUETRLEENCODER_H_ */
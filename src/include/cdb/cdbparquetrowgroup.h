@@ -33,6 +33,8 @@
 #include "access/filesplit.h"
 #include "access/htup.h"
 #include "executor/tuptable.h"
+#include "fmgr.h"
+#include "access/skey.h"
 #include "nodes/execnodes.h"
 
 typedef struct ParquetRowGroupReader
@@ -47,6 +49,26 @@ typedef struct ParquetRowGroupReader
 	ItemPointerData 	cdb_fake_ctid;
 } ParquetRowGroupReader;
 
+/*
+ * A clause "column op constant" of the scan qual, with a btree comparison
+ * operator. The row groups whose min/max statistics show that no row passes
+ * one of the clauses are skipped.
+ */
+typedef struct ParquetRowGroupFilterClause
+{
+	int				attno;		/* 0-based attribute of the relation */
+	Oid				typeId;		/* type of the attribute */
+	StrategyNumber	strategy;	/* BTLessStrategyNumber ... BTGreaterStrategyNumber */
+	Datum			value;
+	FmgrInfo		cmpfunc;	/* btree order of the attribute and the constant */
+} ParquetRowGroupFilterClause;
+
+/* build the row group filter of a scan from its qual */
+List *
+ParquetRowGroupReader_BuildFilter(
+	List					*qual,
+	TupleDesc				hawqTupleDesc);
+
 /* read row group initialization*/
 void
 ParquetRowGroupReader_Init(
@@ -58,7 +80,7 @@ ParquetRowGroupReader_Init(
 bool ParquetRowGroupReader_GetRowGroupInfo(
     FileSplit split, ParquetStorageRead *storageRead,
     ParquetRowGroupReader *rowGroupReader, bool *projs, TupleDesc hawqTupleDesc,
-    int *hawqAttrToParquetColChunks, bool toCloseFile);
+    int *hawqAttrToParquetColChunks, List *filter, bool toCloseFile);
 
 /* Get contents of row group*/
 void
@@ -35,6 +35,7 @@
 #include "utils/hawq_type_mapping.h"
 #include "utils/relcache.h"
 #include "cdb/cdbparquetrleencoder.h"
+#include "cdb/cdbparquetdeltaencoder.h"
 #include "cdb/cdbparquetbytepacker.h"
 #include "cdb/cdbparquetfooterprocessor.h"
 
@@ -56,9 +57,13 @@ typedef struct FileField_4C* ParquetFileField;
 #define DEFAULT_ROWGROUP_COUNT	20
 #define DEFAULT_DATAPAGE_COUNT	1
 
+/* the most distinct values in the dictionary of a column chunk */
+#define MAX_PARQUET_DICTIONARY_VALUES	65536
+
 typedef struct ParquetDataPage_S    *ParquetDataPage;
 typedef struct ParquetColumnChunk_S *ParquetColumnChunk;
 typedef struct ParquetRowGroup_S    *ParquetRowGroup;
+typedef struct ParquetDictionary_S  *ParquetDictionary;
 
 struct ParquetDataPage_S
 {
@@ -79,6 +84,21 @@ struct ParquetDataPage_S
 	uint8_t						*values_buffer;
     int                         values_buffer_capacity; /* palloced size for values_buffer */
 
+	/*
+	 * For dictionary encoded pages, the dictionary ids of the values. They
+	 * are RLE/bit-packed when the page is finalized, with the bit width of
+	 * the dictionary size then.
+	 */
+	int32_t						*dictionary_ids;
+	int							dictionary_id_count;
+	int							dictionary_id_capacity;
+	int							dictionary_bit_width;	/* bit width of the ids so far */
+	RLEDecoder					*dictionary_ids_reader;
+
+	/* For delta encoded pages, the values as DELTA_BINARY_PACKED blocks. */
+	DeltaEncoder				*delta_values;
+	DeltaDecoder				*delta_values_reader;
+
     /*
      * For write, this is the page data to write, may be compressed.
      * For read, this is the page data to read, may be decompressed.
@@ -95,9 +115,33 @@ struct ParquetDataPage_S
 	fully populated and any compression is done.*/
 	bool 						finalized;
 
+	/*
+	 * If true, the finalized page is left for the compress threads: data is
+	 * the uncompressed page data, and header_buffer is not filled yet.
+	 */
+	bool						compress_pending;
+
 	File 						parquetFile;
 };
 
+/*
+ * The dictionary of a column chunk. The distinct values are plain encoded
+ * back to back in the values_buffer of the dictionary page, the value of id
+ * i is at offsets[i], of length offsets[i + 1] - offsets[i]. The ids are
+ * found by an open addressing hash table of the encoded values.
+ */
+struct ParquetDictionary_S
+{
+	struct ParquetDataPage_S	page;		/* the dictionary page */
+
+	int							*offsets;	/* count + 1 offsets */
+	int							count;
+	int							capacity;	/* allocated size of offsets */
+
+	int							*slots;		/* ids, -1 for an empty slot */
+	int							nslots;		/* a power of 2 */
+};
+
 struct ParquetColumnChunk_S
 {
 	ColumnChunkMetadata 		columnChunkMetadata;
@@ -126,6 +170,17 @@ struct ParquetColumnChunk_S
     char    					*compresstype;
     int     					compresslevel;
 
+	/*
+	 * The dictionary of the chunk, NULL if the chunk is plain encoded. Once
+	 * the dictionary is full, useDictionary is cleared and the rest of the
+	 * values are plain encoded.
+	 */
+	ParquetDictionary			dictionary;
+	bool						useDictionary;
+
+	/* The values of the chunk are delta encoded, see deltaEncodable. */
+	bool						useDelta;
+
 	File 						parquetFile;
 };
 
@@ -61,7 +61,10 @@ typedef struct PartitionRangeState
 	FmgrInfo *ltfuncs_inverse; /* comparator partRule < expr */
 	FmgrInfo *lefuncs_inverse; /* comparator partRule <= expr */
 	int last_rule; /* cache offset to the last rule and test if it matches */
-	PartitionRule **rules;
+	PartitionRule **rules; /* rules of rules_node, as an array */
+	int rules_size; /* allocated length of rules */
+	PartitionNode *rules_node; /* node whose rules are in rules, or NULL */
+	List *rules_list; /* the rules list of rules_node they came from */
 } PartitionRangeState;
 
 /* likewise, for list */
@@ -69,6 +72,8 @@ typedef struct PartitionListState
 {
 	FmgrInfo *eqfuncs;
 	bool *eqinit;
+	HTAB *indexes; /* hash index of the values of each PartitionNode */
+	MemoryContext index_cxt; /* where the indexes live */
 } PartitionListState;
 
 /* likewise, for hash */
@@ -193,6 +198,9 @@ get_parts(Oid relid, int2 level, Oid parent, bool inctemplate,
 extern List *
 rel_get_leaf_children_relids(Oid relid);
 
+extern HTAB *
+rel_get_leaf_partition_set(Oid relid);
+
 extern Oid 
 rel_partition_get_root(Oid relid);
 
@@ -240,6 +240,9 @@ CdbPathLocus
 cdbpathlocus_from_exprs(struct PlannerInfo     *root,
                         List                   *hash_on_exprs);
 CdbPathLocus
+cdbpathlocus_canonicalize(struct PlannerInfo   *root,
+                          CdbPathLocus          locus);
+CdbPathLocus
 cdbpathlocus_from_subquery(struct PlannerInfo  *root,
                            struct Plan         *subqplan,
                            Index                subqrelid);
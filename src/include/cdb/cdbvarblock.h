@@ -308,6 +308,15 @@ extern uint8* VarBlockMakerGetNextItemPtr(
     VarBlockMaker        *varBlockMaker,
     VarBlockByteLen      itemLen);
 
+/*
+ * Would VarBlockMakerGetNextItemPtr find room for an item of this length?
+ *
+ * Unlike VarBlockMakerGetNextItemPtr, the VarBlock is not changed.
+ */
+extern bool VarBlockMakerItemFits(
+    VarBlockMaker        *varBlockMaker,
+    VarBlockByteLen      itemLen);
+
 /*
  * Get the variable-length item count.
  */
@@ -437,6 +437,7 @@ extern const char *gpvars_show_gp_interconnect_type(void);
 
 #define INTERCONNECT_FC_METHOD_CAPACITY (0)
 #define INTERCONNECT_FC_METHOD_LOSS     (2)
+#define INTERCONNECT_FC_METHOD_RTT      (3)
 
 extern int Gp_interconnect_fc_method;
 
@@ -465,6 +466,28 @@ extern int	Gp_interconnect_queue_depth;
  *
  */
 extern int	Gp_interconnect_snd_queue_depth;
+
+/*
+ * Parameter Gp_interconnect_buffer_budget
+ *
+ * The number of packet buffers a motion node may use for all its
+ * connections in one direction. When the queue depths times the number of
+ * connections exceed it, the window of each connection is shrunk.
+ * Zero disables the limit.
+ *
+ * This guc is specific to the UDP-interconnect.
+ */
+extern int	Gp_interconnect_buffer_budget;
+
+/*
+ * Parameter Gp_interconnect_rtt_target_delay
+ *
+ * With the "rtt" flow control method, the queueing delay, in microseconds,
+ * above which a sender reduces its congestion window.
+ *
+ * This guc is specific to the UDP-interconnect.
+ */
+extern int	Gp_interconnect_rtt_target_delay;
 extern int	Gp_interconnect_timer_period;
 extern int	Gp_interconnect_timer_checking_period;
 extern int	Gp_interconnect_default_rtt;
@@ -472,6 +495,28 @@ extern int	Gp_interconnect_min_rto;
 extern int  Gp_interconnect_transmit_timeout;
 extern int	Gp_interconnect_min_retries_before_timeout;
 
+/*
+ * Parameter Gp_interconnect_io_batch_size
+ *
+ * The max number of packets sent by one sendmmsg() call, or received by
+ * one recvmmsg() call, where the platform has them.
+ *
+ * This guc is specific to the UDP-interconnect.
+ */
+extern int	Gp_interconnect_io_batch_size;
+
+/*
+ * Parameter Gp_interconnect_rx_threads
+ *
+ * The number of receive threads of a process, each with its own socket
+ * bound to the listener port with SO_REUSEPORT. The kernel hashes the
+ * address of the sender to pick the socket, so the packets of a connection
+ * are always received by the same thread.
+ *
+ * This guc is specific to the UDP-interconnect.
+ */
+extern int	Gp_interconnect_rx_threads;
+
 /* UDP recv buf size in KB.  For testing */
 extern int 	Gp_udp_bufsize_k;
 
@@ -509,6 +554,15 @@ extern bool gp_interconnect_full_crc;
  */
 extern bool gp_interconnect_elide_setup;
 
+/*
+ * Parameter gp_interconnect_defer_incoming
+ *
+ * With the TCP interconnect, don't wait in SetupInterconnect for the senders
+ * of our receiving motion nodes to connect: each receiving motion node
+ * completes the registration of its senders when it first reads from them.
+ */
+extern bool gp_interconnect_defer_incoming;
+
 /*
  * Parameter gp_interconnect_log_stats
  *
@@ -518,6 +572,24 @@ extern bool gp_interconnect_log_stats;
 
 extern bool gp_interconnect_cache_future_packets;
 
+/*
+ * Parameter gp_interconnect_local_shm
+ *
+ * Pass the packets of the UDP-IC between two processes on the same host
+ * through shared memory, only the packet headers go through the socket.
+ */
+extern bool gp_interconnect_local_shm;
+
+/*
+ * Parameters gp_interconnect_compression and
+ * gp_interconnect_compression_min_width
+ *
+ * Compress the tuple chunks of the motions whose planned row width is at
+ * least gp_interconnect_compression_min_width bytes, with LZ4.
+ */
+extern bool gp_interconnect_compression;
+extern int gp_interconnect_compression_min_width;
+
 #define UNDEF_SEGMENT -2
 
 /*
@@ -580,6 +652,15 @@ extern bool gp_enable_fast_sri;
 /* Enable single-mirror pair dispatch. */
 extern bool gp_enable_direct_dispatch;
 
+/* Reuse the snapshot taken by another backend while no transaction ended. */
+extern bool gp_enable_snapshot_sharing;
+
+/* Keep the segment file catalog rows of append only tables in backend memory. */
+extern bool gp_enable_segfile_catalog_cache;
+
+/* Average segment file size (KB) below which VACUUM suggests a rewrite. */
+extern int	gp_appendonly_small_segfile_size;
+
 /* Name of pseudo-function to access any table as if it was randomly distributed. */
 #define GP_DIST_RANDOM_NAME "GP_DIST_RANDOM"
 
@@ -647,6 +728,15 @@ extern bool enable_adaptive_nestloop;
  */
 extern double   gp_motion_cost_per_row;
 
+/*
+ * "gp_redistribute_skew_threshold"
+ *
+ * If >0, a join which redistributes both its rels spreads the rows of the
+ * keys of one rel at least this frequent over all the segments, and
+ * broadcasts the rows of the other rel with the same keys.
+ */
+extern double   gp_redistribute_skew_threshold;
+
 /*
  * "gp_segments_for_planner"
  *
@@ -690,6 +780,31 @@ extern int gp_hashagg_groups_per_bucket;
  */
 extern int gp_hashjoin_metadata_memory_percent;
 
+/*
+ * Number of outer tuples a HashJoin reads ahead of the probe, to prefetch
+ * the buckets of a hash table larger than the CPU caches. 0 disables it.
+ */
+extern int gp_hashjoin_prefetch_distance;
+
+/*
+ * Percentage of the operator memory of a spilling HashJoin that keeps the
+ * inner tuples of the most common outer keys in memory, so that the outer
+ * tuples with those keys are not spilled. 0 disables it.
+ */
+extern int gp_hashjoin_skew_memory_percent;
+
+/*
+ * A HashJoin adapts its hash table to the inner side it actually read: it
+ * takes back spilled batches that fit in memory, and adds buckets.
+ */
+extern bool gp_hashjoin_adaptive;
+
+/*
+ * An Append opens the external source of its next subplan while it reads
+ * the current one, so that the external servers overlap their sending.
+ */
+extern bool gp_external_open_ahead;
+
 /*
  * Damping of selectivities of clauses which pertain to the same base
  * relation; compensates for undetected correlation
@@ -821,6 +936,11 @@ extern int gp_distinct_grouping_sets_threshold;
  */
 extern bool gp_enable_preunique;
 
+/* Answer an unfiltered count(*) of an append only or parquet table from the
+ * tuple counts of its segment files, instead of scanning it.
+ */
+extern bool gp_enable_segfile_count;
+
 /* If gp_enable_preunique is true, then  apply the associated optimzation
  * in an "eager" fashion.  In effect, this setting overrides the cost-
  * based decision whether to use a 2-phase approach to duplicate removal.
@@ -835,6 +955,11 @@ extern bool gp_eager_preunique;
  */
 extern bool gp_enable_sequential_window_plans;
 
+/* May the Window node aggregate a sliding frame incrementally, for
+ * aggregates without an inverse preliminary function?
+ */
+extern bool gp_enable_incremental_window_agg;
+
 /* May Greenplum dump statistics for all segments as a huge ugly string
  * during EXPLAIN ANALYZE?
  *
@@ -861,6 +986,15 @@ extern bool gp_enable_sort_distinct;
 extern bool gp_enable_mk_sort;
 extern bool gp_enable_motion_mk_sort;
 
+/* Number of threads that help an in-memory MK sort, 0 sorts in the backend */
+extern int gp_mk_sort_threads;
+
+/* Number of compiled regular expressions a backend keeps, see regexp.c */
+extern int gp_regex_cache_size;
+
+/* Most values of a sequence a QE asks for in one request, see sequence.c */
+extern int gp_sequence_lease_max;
+
 #ifdef USE_ASSERT_CHECKING
 extern bool gp_mk_sort_check;
 #endif
@@ -916,9 +1050,18 @@ extern int gp_segworker_relative_priority;
 /*  Max size of dispatched plans; 0 if no limit */
 extern int gp_max_plan_size;
 
+/* Read the clock at every Nth entry of an instrumented plan node */
+extern int gp_instrument_timing_sample;
+
 // max slice number of dispatched plan; 0 if no limit
 extern int gp_max_plan_slice;
 
+/*
+ * Number of threads that help compress the serialized plans and query
+ * trees larger than a chunk; 0 to compress them on the backend only.
+ */
+extern int gp_dispatch_compress_threads;
+
 /* The maximum number of times on average that the hybrid hashed aggregation
  * algorithm will plan to spill an input row to disk before including it in
  * an aggregation.  Increasing this parameter will cause the planner to choose
@@ -935,6 +1078,23 @@ extern bool gp_hashagg_recalc_density;
 /* If we use two stage hashagg, we can stream the bottom half */
 extern bool gp_hashagg_streambottom;
 
+/* A streaming bottom stage hashagg whose full hash table merged less than this
+ * fraction of its input rows passes the rest of the rows through */
+extern double gp_hashagg_stream_min_reduction;
+
+/* Hybrid hashed aggregation uses an open-addressing table, probed linearly,
+ * instead of the chains of its buckets */
+extern bool gp_hashagg_linear_probing;
+
+/* Correlated subplans cache their results by the values of their parameters */
+extern bool gp_enable_subplan_cache;
+
+/* Per-tuple memory contexts are bump-pointer arenas */
+extern bool gp_enable_arena_memory;
+
+/* QEs are bound to the NUMA node of their virtual segment */
+extern bool gp_enable_numa_affinity;
+
 /* The default number of batches to use when the hybrid hashed aggregation
  * algorithm (re-)spills in-memory groups to disk.
  */
@@ -973,6 +1133,18 @@ extern bool		gp_statistics_use_fkeys;
 extern int 		gp_statistics_blocks_target;
 extern double	gp_statistics_ndistinct_scaling_ratio_threshold;
 extern double	gp_statistics_sampling_threshold;
+extern int		gp_statistics_dependency_columns;
+
+/* Skip the append-only and parquet tables unchanged since their last ANALYZE */
+extern bool		gp_statistics_skip_unchanged;
+extern double	gp_statistics_block_sampling_factor;
+
+/*
+ * Fraction of the blocks of append-only tables and of the row groups of
+ * parquet tables that a scan reads, the others are skipped at random. Only
+ * set by ANALYZE while it builds a sample table.
+ */
+extern double	gp_statistics_block_sampling_fraction;
 
 /* Analyze tools */
 extern int gp_motion_slice_noop;
@@ -988,12 +1160,20 @@ extern bool gpvars_assign_gp_enable_gpperfmon(bool newval, bool doit, GucSource
 extern bool gpvars_assign_gp_gpperfmon_send_interval(int newval, bool doit, GucSource source);
 extern bool gp_enable_gpperfmon;
 extern int gp_gpperfmon_send_interval;
+/* UDP port on localhost that receives a JSON event per finished query; 0 disables */
+extern int gp_query_metrics_port;
+/* Stack samples per second of CPU time taken by every QE; 0 disables */
+extern int gp_profile_sample_hz;
 extern bool force_bitmap_table_scan;
 
 extern int gp_hashagg_compress_spill_files;
 extern int gp_workfile_compress_algorithm;
 extern bool gp_workfile_checksumming;
 extern bool gp_workfile_caching;
+/* Spilling operators remembered per segment in the spill history; 0 disables */
+extern int gp_workfile_spill_history_size;
+/* Notice for every spilling operator with the memory that would have avoided it */
+extern bool gp_workfile_spill_notice;
 extern double gp_workfile_limit_per_segment;
 extern double gp_workfile_limit_per_query;
 extern int gp_workfile_limit_files_per_query;
@@ -1001,6 +1181,8 @@ extern int gp_workfile_caching_loglevel;
 extern int gp_sessionstate_loglevel;
 extern bool gp_workfile_faultinject;
 extern int gp_workfile_bytes_to_checksum;
+extern int gp_workfile_async_writers;
+extern int gp_shareinput_shm_limit;
 /* The type of work files that HashJoin should use */
 extern int gp_workfile_type_hashjoin;
 
@@ -1157,6 +1339,7 @@ extern double metadata_cache_free_block_normal_ratio;
 extern int metadata_cache_max_hdfs_file_num;
 extern double metadata_cache_flush_ratio;
 extern double metadata_cache_reduce_ratio;
+extern int metadata_cache_prefetch_threads;
 
 extern char *metadata_cache_testfile;
 extern bool debug_fake_datalocality;
@@ -1184,6 +1367,18 @@ extern int	   rm_master_domain_port;
 extern int     rm_master_port;
 extern int	   rm_segment_port;
 extern bool	   rm_enable_connpool;
+/*
+ * Seconds a session keeps its connection registered in resource manager after
+ * a query returned its resource, to acquire the resource of the next query
+ * without registering again. 0 unregisters at once.
+ */
+extern int	   rm_reuse_registration_timeout;
+/*
+ * Seconds a session keeps the resource allocated for a query, to run the next
+ * query needing no more slices and as many virtual segments on it without
+ * acquiring resource again. 0 returns the resource at once.
+ */
+extern int	   rm_resource_lease_timeout;
 extern int	   rm_connpool_sameaddr_buffersize;
 
 extern char   *rm_global_rm_type;
@@ -1208,13 +1403,16 @@ extern int	   rm_min_resource_perseg;
 
 extern int     rm_session_lease_timeout;
 extern bool    rm_session_lease_heartbeat_enable;
+extern bool    rm_segment_heartbeat_compact;
 
 extern int 	   rm_resource_allocation_timeout;
 extern int	   rm_resource_timeout;
+extern int	   rm_resource_forecast_period;
 extern int	   rm_segment_heartbeat_timeout;
 extern int	   rm_request_timeoutcheck_interval;
 extern int	   rm_session_lease_heartbeat_interval;
 extern int	   rm_segment_heartbeat_interval;
+extern int	   rm_segment_heartbeat_max_interval;
 extern int	   rm_segment_config_refresh_interval;
 extern int	   rm_segment_tmpdir_detect_interval;
 
@@ -1225,6 +1423,7 @@ extern int	   rm_nvseg_variance_among_seg_limit;
 extern int	   rm_container_batch_limit;
 extern char   *rm_resourcepool_test_filename;
 extern bool	   rm_force_fifo_queue;
+extern int	   rm_fair_queue_vseg_cost;
 extern bool	   rm_force_alterqueue_cancel_queued_request;
 
 extern bool	   rm_enforce_cpu_enable;
@@ -1258,6 +1457,7 @@ extern int	   rm_nvseg_variance_among_seg_respool_limit;
 
 extern int max_filecount_notto_split_segment;
 extern int min_datasize_to_combine_segment;
+extern int cost_per_virtual_segment;
 extern int datalocality_algorithm_version;
 extern int min_cost_for_each_query;
 
@@ -343,6 +343,19 @@ extern TupleChunkListItem RecvTupleChunk(MotionConn *conn, bool inTeardown);
 
 extern void markUDPConnInactive(MotionConn *conn);
 
+/* shared memory packet rings of the UDP-IC, see ic_shm.c */
+extern bool icShmPeerIsLocal(const char *listenerAddr);
+extern ICShmRing *icShmRingAttach(icpkthdr *connInfo, int nslots, int slotSize);
+extern void icShmRingDetach(ICShmRing *ring);
+extern void icShmRingPut(ICShmRing *ring, icpkthdr *pkt);
+
+/* the slot of the packet seq */
+static inline icpkthdr *
+icShmRingSlot(ICShmRing *ring, uint32 seq)
+{
+	return (icpkthdr *) (ring->base + (Size) ((seq - 1) % ring->nslots) * ring->slotSize);
+}
+
 extern void CleanupMotionTCP(void);
 extern void CleanupMotionUDP(void);
 extern void WaitInterconnectQuitUDP(void);
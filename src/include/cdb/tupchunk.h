@@ -61,6 +61,13 @@ typedef enum TupleChunkType
 
 #define TUPLE_CHUNK_HEADER_SIZE 4
 
+/*
+ * Set in the type of a chunk whose data is compressed with LZ4. The data of
+ * such a chunk is the uint32 length of the uncompressed data, followed by
+ * the compressed data. See compressChunks() in cdbmotion.c.
+ */
+#define TC_COMPRESSED_FLAG		0x100
+
 /* see MPP-2099, let's not run into this one again! NOTE: the
  * definition of BROADCAST_SEGIDX is *key*.
  *
@@ -104,13 +104,16 @@ extern TupleChunkListItem makeTupleChunkListItem(TupleChunkType chunkType,
 /* Add another item to the end of a tuple chunk list. */
 extern void appendChunkToTCList(TupleChunkList tcList, TupleChunkListItem tcItem);
 
-/* Provide a chunk-list-item cache */
+/*
+ * Provide a chunk-list-item cache: full-size items are allocated from a
+ * slab, which keeps the freed items for reuse.
+ */
 typedef struct {
-	int len;
-	TupleChunkListItem items;
+	MemoryContext cxt;		/* slab of full-size items, NULL until first use */
 } TupleChunkListCache;
 
 extern TupleChunkListItem getChunkFromCache(TupleChunkListCache *cache);
+extern void destroyChunkCache(TupleChunkListCache *cache);
 
 /* Remove the contents of a TupleChunkList, and reset its state to "empty." */
 extern void clearTCList(TupleChunkListCache *cache, TupleChunkList tcList);
@@ -39,6 +39,9 @@ extern void workermgr_free_workermgr_state(struct WorkerMgrState *state);
 extern bool workermgr_submit_job(struct WorkerMgrState *state,
 								List *tasks,
 								WorkerMgrTaskCallback func);
+extern bool workermgr_run_job(struct WorkerMgrState *state,
+							 List *tasks,
+							 WorkerMgrTaskCallback func);
 extern void	workermgr_wait_job(struct WorkerMgrState *state);
 extern void	workermgr_cancel_job(struct WorkerMgrState *state);
 extern void workermgr_terminate_job(struct WorkerMgrState *state);
@@ -43,8 +43,16 @@ typedef struct
 	TimestampTz prepare_time;	/* the time when the stmt was prepared */
 	bool		from_sql;		/* stmt prepared via SQL, not FE/BE protocol? */
 	MemoryContext context;		/* context containing this query */
+
+	/* GPDB: plan of the last execution, kept for reuse (see prepare.c) */
+	MemoryContext plan_context;	/* context containing the plan, or NULL */
+	PlannedStmt *plan;			/* plan of the only query, or NULL */
+	ParamListInfo plan_params;	/* parameter values it is planned with */
+	uint64		plan_generation;	/* plan cache generation it is planned in */
 } PreparedStatement;
 
+extern bool gp_enable_prepared_plan_cache;
+
 
 /* Utility statements PREPARE, EXECUTE, DEALLOCATE, EXPLAIN EXECUTE */
 extern void PrepareQuery(PrepareStmt *stmt, const char *queryString);
@@ -73,4 +81,9 @@ extern TupleDesc FetchPreparedStatementResultDesc(PreparedStatement *stmt);
 extern bool PreparedStatementReturnsTuples(PreparedStatement *stmt);
 extern List *FetchPreparedStatementTargetList(PreparedStatement *stmt);
 
+/* Reuse of the plans of prepared statements */
+extern List *PlanPreparedStatement(PreparedStatement *stmt, List *query_list,
+					  ParamListInfo params);
+extern void InvalidatePreparedPlans(void);
+
 #endif   /* PREPARE_H */
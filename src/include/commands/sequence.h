@@ -134,6 +134,7 @@ cdb_sequence_nextval_server(Oid    tablespaceid,
                             Oid    dbid,
                             Oid    relid,
                             bool   istemp,
+                            int64  nvalues,
                             int64 *plast,
                             int64 *pcached,
                             int64 *pincrement,
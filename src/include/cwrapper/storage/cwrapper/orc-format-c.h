@@ -105,6 +105,21 @@ __attribute__((weak)) bool ORCFormatNextORCFormatWithRowIdC(ORCFormatC *fmt, con
                                       uint64_t *lens, bool *nulls,
                                       uint64_t *rowId) {}
 
+// Read the next rows as column vectors, at most maxRows of them. For each
+// column read nulls[i] points at the null flags of the rows and values[i]
+// at their values: an array of the C type for bool, int2, int4, int8,
+// float4, float8, date, time and timestamp, as ORCFormatNextORCFormatC
+// returns them, and an array of pointers to the values for the others, with
+// their lengths in lens[i]. The entries of the other columns are set to
+// NULL. The vectors are valid until the next call. Returns the number of
+// rows, 0 at the end of the scan and -1 if the library does not read in
+// batches.
+__attribute__((weak)) int ORCFormatNextBatchORCFormatC(ORCFormatC *fmt, int maxRows,
+                                 const char **values, const uint64_t **lens,
+                                 const bool **nulls) {
+  return -1;
+}
+
 __attribute__((weak)) void ORCFormatRescanORCFormatC(ORCFormatC *fmt) {}
 
 __attribute__((weak)) void ORCFormatEndORCFormatC(ORCFormatC *fmt) {}
@@ -124,6 +139,17 @@ __attribute__((weak)) void ORCFormatInsertORCFormatBufferC(ORCFormatC *fmt, int
 __attribute__((weak)) void ORCFormatInsertORCFormatC(ORCFormatC *fmt, int *datatypes, char **values,
                                uint64_t *lens, unsigned char **nullBitmap,
                                int32_t **dims, bool *isNull) {}
+// Insert numRows rows given as column vectors: nulls[i] holds the null
+// flags of the rows and values[i] their values, as ORCFormatInsertORCFormatC
+// takes them: an array of the C type for bool, char, int2, int4, int8,
+// float4, float8, date and time, of seconds and nanoseconds for timestamp,
+// and an array of pointers to the values for the others. Returns false if
+// the library does not insert in batches, nothing is inserted then.
+__attribute__((weak)) bool ORCFormatInsertBatchORCFormatC(ORCFormatC *fmt, int *datatypes,
+                                    int numRows, char **values,
+                                    bool **nulls) {
+  return false;
+}
 __attribute__((weak)) void ORCFormatEndInsertORCFormatC(ORCFormatC *fmt) {}
 __attribute__((weak)) void ORCFormatEndInsertORCFormatFileC(ORCFormatC *fmt, int64_t *eof,
                                       int64_t *uncompressedEof) {}
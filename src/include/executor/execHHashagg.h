@@ -68,6 +68,22 @@ typedef struct HashAggEntry
 
 typedef HashAggEntry* HashAggBucket;
 
+/* A slot of the open-addressing Agg hash table.
+ *
+ * Each slot in use points to the HashAggEntry of a group, and keeps its hash
+ * value, so that a probe compares the entries only when the hash values are
+ * equal. When the grouping key is a single column of a fixed-width type
+ * whose equality is that of its Datums, the key is kept in the slot as well,
+ * and the entries are not compared at all.
+ */
+typedef struct HashAggSlot
+{
+	HashAggEntry   *entry;	/* NULL if the slot is free */
+	HashKey			hashvalue;
+	bool			keyisnull;
+	Datum			key;	/* grouping key, if the table has inline_key */
+} HashAggSlot;
+
 /* A SpillFile controls access to a temporary file used to hold  
  * transition tuples spilled from the hash table in order to free 
  * up space.
@@ -164,6 +180,7 @@ typedef enum HashAggState
 	HASHAGG_IN_A_PASS,
 	HASHAGG_BETWEEN_PASSES,
 	HASHAGG_STREAMING,
+	HASHAGG_PASSTHROUGH,
 	HASHAGG_END_OF_PASSES
 } HashAggState;
 
@@ -185,6 +202,17 @@ typedef struct HashAggTable
 	HashAggEntry  **buckets;
 	uint64 *bloom;
 
+	/*
+	 * Open-addressing table, instead of the buckets when gp_hashagg_linear_probing
+	 * is set. nbuckets is still the number of buckets the spill files are
+	 * sized for.
+	 */
+	bool open_addressing;
+	bool inline_key;	/* the grouping key is kept in the slots */
+	unsigned nslots;	/* power of 2 */
+	unsigned slot_shift;	/* 32 - log2(nslots) */
+	HashAggSlot *slots;
+
 	/* hashkey bitshift amount to determine bucket - used when spilling */
 	unsigned pshift;
 
@@ -214,7 +242,7 @@ typedef struct HashAggTable
 	GroupKeysAndAggs   *groupaggs;
 
 	/* Variables during iteration */
-	int curr_bucket_idx;
+	int curr_bucket_idx; /* or slot index, in an open-addressing table */
 	HashAggEntry *next_entry;
 
 	/* buffer for calculating the hashkey */
@@ -224,6 +252,7 @@ typedef struct HashAggTable
 	HashAggTableSizes   hats;
 
 	double max_mem; /* Maximum available memory */
+	double mem_grown; /* The part of max_mem grown beyond the quota */
 	double mem_for_metadata; /* Current memory usage for metadata */
 	double mem_wanted; /* The desirable work_mem */
 	double mem_used; /* The maxinum amount of used memory. */
@@ -236,17 +265,29 @@ typedef struct HashAggTable
 	uint64 num_entries; /* number of currently in-memory groups/entries */
 	uint64 num_spill_groups; /* number of spilled groups */
 	uint32 num_overflows; /* number of times hash table overflows */
+	uint32 max_spill_level; /* deepest level of spill files, 0 if none respilled */
 	uint32 num_expansions; /* number of times hash table is expanded */
 	uint64 total_buckets; /* total number of buckets allocated */
 	bool is_spilling; /* indicate that spilling happened for this batch. */
+	bool spill_requested; /* the runaway cleaner asked us to spill */
 	bool expandable;  /* hash table buckets still have space to grow */
 	struct TupleTableSlot *prev_slot; /* a slot that is read previously. */
+
+	/*
+	 * A streaming hash table stops aggregating when grouping barely reduces
+	 * its input, see gp_hashagg_stream_min_reduction.
+	 */
+	uint64 fill_first_tuple; /* num_tuples when the hash table was reset */
+	bool passthrough; /* rows are passed through as single row groups */
+	uint64 num_passthru_tuples; /* number of rows passed through */
     CdbExplain_Agg      chainlength;
 } HashAggTable;
 
 extern HashAggTable *create_agg_hash_table(AggState *aggstate);
 extern bool agg_hash_initial_pass(AggState *aggstate);
 extern bool agg_hash_stream(AggState *aggstate);
+extern struct TupleTableSlot *agg_hash_passthrough(AggState *aggstate,
+												   AggStatePerGroup pergroup);
 extern bool agg_hash_next_pass(AggState *aggstate);
 extern bool agg_hash_continue_pass(AggState *aggstate);
 extern void destroy_agg_hash_table(AggState *aggstate);
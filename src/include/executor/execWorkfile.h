@@ -160,6 +160,7 @@ void ExecWorkFile_Flush(ExecWorkFile *workfile);
 int64 ExecWorkFile_GetSize(ExecWorkFile *workfile);
 int64 ExecWorkFile_Suspend(ExecWorkFile *workfile);
 void ExecWorkFile_Restart(ExecWorkFile *workfile);
+void ExecWorkFile_Prefetch(ExecWorkFile *workfile);
 char * ExecWorkFile_GetFileName(ExecWorkFile *workfile);
 void ExecWorkfile_SetWorkset(ExecWorkFile *workfile, struct workfile_set *work_set);
 
@@ -60,6 +60,9 @@ struct StringInfoData;                  /* #include "lib/stringinfo.h" */
  * "hashCxt", while storage that is only wanted for the current batch is
  * allocated in the "batchCxt".  By resetting the batchCxt at the end of
  * each batch, we free all the per-batch storage reliably and without tedium.
+ * The tuples of the current batch are packed one after another into large
+ * chunks of the batchCxt, rather than palloc'd one by one, so that they pay
+ * neither a chunk header nor the power of 2 rounding of the allocator.
  *
  * During first scan of inner relation, we get its tuples from executor.
  * If nbatch > 1 then tuples that don't belong in first batch get saved
@@ -96,6 +99,48 @@ typedef struct HashJoinTupleData
 #define HJTUPLE_MINTUPLE(hjtup)  \
 	((MemTuple) ((char *) (hjtup) + HJTUPLE_OVERHEAD))
 
+/*
+ * A chunk of memory holding hash join tuples, MAXALIGN'd one after another.
+ * Tuples larger than HASH_CHUNK_THRESHOLD get a chunk of their own, so that
+ * they don't waste the rest of a shared chunk.
+ */
+typedef struct HashMemoryChunkData
+{
+	int			ntuples;		/* number of tuples stored in this chunk */
+	Size		maxlen;			/* size of the data area */
+	Size		used;			/* bytes of the data area already used */
+	struct HashMemoryChunkData *next;	/* next chunk of the batch */
+	/* Tuple data follows on a MAXALIGN boundary */
+} HashMemoryChunkData;
+
+typedef struct HashMemoryChunkData *HashMemoryChunk;
+
+#define HASH_CHUNK_SIZE			(32 * 1024L)
+#define HASH_CHUNK_THRESHOLD	(HASH_CHUNK_SIZE / 4)
+#define HASH_CHUNK_HEADER_SIZE	MAXALIGN(sizeof(HashMemoryChunkData))
+#define HASH_CHUNK_DATA(hc)		((char *) (hc) + HASH_CHUNK_HEADER_SIZE)
+
+/*
+ * The skew table holds, for the first batch of a join that spills, the
+ * inner tuples whose hash value is that of one of the most common values
+ * of the outer key, as the planner found them in the statistics.  The
+ * outer tuples with those hash values are joined right away rather than
+ * written to the batch files, which is most of the outer side when it is
+ * skewed.  It is an open addressing table of skewBucketLen slots, at least
+ * twice as many as the values.  When it grows beyond spaceAllowedSkew the
+ * buckets of the least common values are moved to the main table, in the
+ * reverse order of their creation so that no probe chain gets broken.
+ * The skew table lives in the batchCxt, and goes away with the first batch.
+ */
+typedef struct HashSkewBucket
+{
+	uint32		hashvalue;		/* common hash value */
+	struct HashJoinTupleData *tuples;	/* linked list of inner-relation tuples */
+} HashSkewBucket;
+
+#define SKEW_BUCKET_OVERHEAD  MAXALIGN(sizeof(HashSkewBucket))
+#define INVALID_SKEW_BUCKET_NO	(-1)
+
 
 /* Statistics collection workareas for EXPLAIN ANALYZE */
 typedef struct HashJoinBatchStats
@@ -141,6 +186,7 @@ typedef struct HashJoinBatchSide
 	 */
 	ExecWorkFile *workfile;
 	int total_tuples;
+	Size total_space;		/* bytes of the tuples written to the file */
 } HashJoinBatchSide;
 
 
@@ -169,16 +215,31 @@ typedef struct HashJoinTableData
 	struct HashJoinTupleData **buckets;
 
 	BloomFilter bloomfilter;
+	struct RuntimeFilterRange *keyranges;	/* CDB: range of the inner keys */
 
 	/* buckets array is per-batch storage, as are all the tuples */
 
+	HashMemoryChunk chunks;		/* chunks holding the tuples of the batch */
+
+	bool		skewEnabled;	/* are we using skew optimization? */
+	HashSkewBucket **skewBucket;	/* hashtable of skew buckets */
+	int			skewBucketLen;	/* size of skewBucket array (a power of 2!) */
+	int			nSkewBuckets;	/* number of active skew buckets */
+	int		   *skewBucketNums; /* array indexes of active skew buckets */
+	Size		spaceUsedSkew;	/* skew hashtable's current space usage */
+	Size		spaceAllowedSkew;	/* upper limit for skew hashtable */
+
 	int			nbatch;			/* number of batches */
 	int			curbatch;		/* current batch #; 0 during 1st pass */
 
 	int			nbatch_original;	/* nbatch when we started inner scan */
 	int			nbatch_outstart;	/* nbatch when we started outer scan */
+	int			nbatch_folded;	/* nbatch before the inner side was loaded
+								 * back into one batch, or 0 */
+	int			nbuckets_original;	/* nbuckets when we started inner scan */
 
 	bool		growEnabled;	/* flag to shut off nbatch increases */
+	bool		spillRequested;	/* runaway cleaner asked us to spill */
 
 	double		totalTuples;	/* # tuples obtained from inner plan */
 
@@ -200,6 +261,7 @@ typedef struct HashJoinTableData
 	bool	   *hashStrict;		/* is each hash join operator strict? */
 
 	Size		spaceAllowed;	/* upper limit for space used */
+	Size		spaceGrown;		/* part of spaceAllowed grown beyond quota */
 
 	MemoryContext hashCxt;		/* context for whole-hash-join storage */
 	MemoryContext batchCxt;		/* context for this-batch-only storage */
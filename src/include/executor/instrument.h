@@ -45,6 +45,8 @@ typedef struct Instrumentation
 	instr_time	counter;		/* Accumulated runtime for this node */
 	double		firsttuple;		/* Time for first tuple of this cycle */
 	double		tuplecount;		/* Tuples emitted so far this cycle */
+	double		ncalls;			/* Node entries so far this cycle */
+	double		nsampled;		/* ... of which were timed */
 	/* Accumulated statistics across all completed cycles: */
 	double		startup;		/* Max row Total startup time (in seconds) */
 	double		startupLast;		/* Slowest Total startup time (in seconds) */
@@ -55,6 +57,7 @@ typedef struct Instrumentation
     double		execmemused;    /* CDB: executor memory used (bytes) */
     double		workmemused;    /* CDB: work_mem actually used (bytes) */
     double		workmemwanted;  /* CDB: work_mem to avoid scratch i/o (bytes) */
+    double		workfilespilled;    /* CDB: bytes written to workfiles */
 	instr_time	firststart;		/* CDB: Start time of first iteration of node */
 	instr_time	firststartLast;		/* CDB: Start time of first iteration of node which is slowest*/
 	bool		workfileReused; /* TRUE if cached workfiles reused in this node */
@@ -63,6 +66,30 @@ typedef struct Instrumentation
     struct CdbExplain_NodeSummary  *cdbNodeSummary; /* stats from all qExecs */
 } Instrumentation;
 
+/*
+ * CDB: Time the backend spent blocked during the current query, in
+ * microseconds. ExecutorStart resets it when EXPLAIN ANALYZE statistics are
+ * collected, and cdbexplain reports it per slice.
+ */
+typedef struct WaitUsage
+{
+	uint64		hdfs_io_time;		/* reading and writing HDFS files */
+	uint64		local_io_time;		/* reading and writing local files (workfiles) */
+	uint64		interconnect_time;	/* waiting for interconnect data */
+	uint64		lock_time;			/* waiting for heavyweight locks */
+} WaitUsage;
+
+extern WaitUsage pgWaitUsage;
+
+/* Add the time since 'start' to the 'field' of pgWaitUsage. */
+#define WAIT_USAGE_ACCUM(field, start) \
+	do { \
+		instr_time	wait_end_; \
+		INSTR_TIME_SET_CURRENT(wait_end_); \
+		INSTR_TIME_SUBTRACT(wait_end_, (start)); \
+		pgWaitUsage.field += INSTR_TIME_GET_MICROSEC(wait_end_); \
+	} while (0)
+
 extern Instrumentation *InstrAlloc(int n);
 extern void InstrStartNode(Instrumentation *instr);
 extern void InstrStopNode(Instrumentation *instr, double nTuples);
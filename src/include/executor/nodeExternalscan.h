@@ -30,8 +30,10 @@
 extern int	ExecCountSlotsExternalScan(ExternalScan *node);
 extern ExternalScanState *ExecInitExternalScan(ExternalScan *node, EState *estate, int eflags);
 extern TupleTableSlot *ExecExternalScan(ExternalScanState *node);
+extern TupleTableSlot *ExternalNext(ExternalScanState *node);
 extern void ExecEndExternalScan(ExternalScanState *node);
 extern void ExecStopExternalScan(ExternalScanState *node);
+extern void ExecExternalScanOpenAhead(ExternalScanState *node);
 extern void ExecExternalReScan(ExternalScanState *node, ExprContext *exprCtxt);
 extern void ExecEagerFreeExternalScan(ExternalScanState *node);
 
@@ -46,6 +46,7 @@ extern void ExecReScanHash(HashState *node, ExprContext *exprCtxt);
 
 extern HashJoinTable ExecHashTableCreate(HashState *hashState, HashJoinState *hjstate, List *hashOperators, uint64 operatorMemKB, workfile_set * sfs);
 extern void ExecHashTableDestroy(HashState *hashState, HashJoinTable hashtable);
+extern bool ExecHashRequestSpill(void *arg);
 extern void ExecHashTableInsert(HashState *hashState, HashJoinTable hashtable,
 					struct TupleTableSlot *slot,
 					uint32 hashvalue);
@@ -55,13 +56,19 @@ extern bool ExecHashGetHashValue(HashState *hashState, HashJoinTable hashtable,
 					 bool keep_nulls,
 					 uint32 *hashvalue,
 					 bool *hashkeys_null);
+extern bool RuntimeFilterRangeType(Oid type);
+extern RuntimeFilterRange *ExecHashInitKeyRanges(List *hashkeys);
+extern void ExecHashAddKeyRange(RuntimeFilterRange *range, Datum value);
+extern bool RuntimeFilterRangeMatch(RuntimeFilterRange *range, Datum value);
 extern void ExecHashGetBucketAndBatch(HashJoinTable hashtable,
 						  uint32 hashvalue,
 						  int *bucketno,
 						  int *batchno);
+extern int ExecHashGetSkewBucket(HashJoinTable hashtable, uint32 hashvalue);
 extern HashJoinTuple ExecScanHashBucket(HashState *hashState, HashJoinState *hjstate,
 				   ExprContext *econtext);
 extern void ExecHashTableReset(HashState *hashState, HashJoinTable hashtable);
+extern void ExecHashIncreaseNumBuckets(HashJoinTable hashtable);
 extern void ExecHashTableExplainInit(HashState *hashState, HashJoinState *hjstate,
                                      HashJoinTable  hashtable);
 extern void ExecHashTableExplainBatchEnd(HashState *hashState, HashJoinTable hashtable);
@@ -21,6 +21,7 @@ extern void ExecEndMotion(MotionState *node);
 extern void ExecReScanMotion(MotionState *node, ExprContext *exprCtxt);
 
 extern void ExecStopMotion(MotionState *node);
+extern void ExecMotionExplainEnd(PlanState *planstate, struct StringInfoData *buf);
 
 extern bool isMotionRedistribute(const Motion *m);
 extern bool isMotionGather(const Motion *m);
@@ -77,6 +77,7 @@ extern void gpmon_qlog_query_error(gpmon_packet_t *gpmonPacket);
 extern void gpmon_qlog_query_canceling(gpmon_packet_t *gpmonPacket);
 extern void gpmon_send(gpmon_packet_t*);
 extern void gpmon_gettmid(apr_int32_t*);
+extern void gpmon_export_query_metrics(const char *status, uint64 processed);
 
 /* ------------------------------------------------------------------
          FSINFO
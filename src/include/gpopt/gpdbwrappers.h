@@ -34,6 +34,7 @@
 #include "postgres.h"
 #include "access/attnum.h"
 #include "utils/faultinjector.h"
+#include "utils/inval.h"
 
 // fwd declarations
 typedef struct SysScanDescData *SysScanDesc;
@@ -207,6 +208,9 @@ namespace gpdb {
 	// attribute statistics
 	HeapTuple HtAttrStats(Oid relid, AttrNumber attnum);
 
+	// strongest dependency between the columns filtered by the query
+	float4 FpDependencyDegree(Query *pquery);
+
 	// function oids
 	List *PlFunctionOids(void);
 
@@ -635,6 +639,9 @@ namespace gpdb {
 	// returns the result of evaluating 'pexpr' as an Expr. Caller keeps ownership of 'pexpr'
 	// and takes ownership of the result 
 	Expr *PexprEvaluate(Expr *pexpr, Oid oidResultType);
+
+	// does the given expression contain volatile functions
+	bool FHasVolatileFunc(Node *pnode);
 	
 	// interpret the value of "With oids" option from a list of defelems
 	bool FInterpretOidsOption(List *plOptions);
@@ -657,6 +664,10 @@ namespace gpdb {
 	// requests version for object from MD Versioning component
 	void MdVerRequestVersion(Oid key, uint64 *ddl_version, uint64 *dml_version);
 
+	// register the callback for the catalog changes metadata cache objects
+	// are translated from
+	void RegisterMDCacheInvalidationCallbacks(CacheCallbackFunction func);
+
 } //namespace gpdb
 
 #define ForEach(cell, l)	\
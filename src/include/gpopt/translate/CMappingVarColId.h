@@ -109,6 +109,10 @@ namespace gpdxl
 			// insert mapping entry
 			void Insert(ULONG, ULONG, INT, ULONG, CWStringBase *pstr);
 
+			// insert an entry of another mapping in the same memory pool,
+			// sharing its key and value instead of copying them
+			void InsertShared(const CGPDBAttOptCol *pgpdbattoptcol);
+
 			// no copy constructor
 			CMappingVarColId(const CMappingVarColId &);
 
@@ -35,9 +35,13 @@
 
 #include "gpopt/eval/IConstDXLNodeEvaluator.h"
 #include "gpopt/mdcache/CMDAccessor.h"
+#include "gpopt/translate/CCTEListEntry.h"
 #include "gpopt/translate/CMappingColIdVar.h"
 #include "gpopt/translate/CTranslatorDXLToScalar.h"
 
+// fwd decl
+struct Const;
+
 namespace gpdxl
 {
 	class CDXLNode;
@@ -102,6 +106,16 @@ namespace gpdxl
 			// translator for the DXL input -> GPDB Expr
 			CTranslatorDXLToScalar m_trdxl2scalar;
 
+			// hash map from the text of an evaluated expression to its value
+			typedef CHashMap<CHAR, Const, UlHashSz, FEqualSz, CleanupNULL, CleanupNULL> HMSzConst;
+
+			// values of the expressions evaluated so far; the keys and
+			// values are palloc'd in the optimizer memory context
+			HMSzConst *m_phmszconst;
+
+			// evaluate the translated expression, without the executor if possible
+			Const *PconstEvaluate(Expr *pexpr);
+
 		public:
 			// ctor
 			CConstExprEvaluatorProxy
@@ -115,12 +129,14 @@ namespace gpdxl
 				m_pmda(pmda),
 				m_trdxl2scalar(m_pmp, m_pmda, 0)
 			{
+				m_phmszconst = GPOS_NEW(m_pmp) HMSzConst(m_pmp);
 			}
 
 			// dtor
 			virtual
 			~CConstExprEvaluatorProxy()
 			{
+				m_phmszconst->Release();
 			}
 
 			// evaluate given constant expressionand return the DXL representation of the result.
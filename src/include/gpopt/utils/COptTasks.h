@@ -180,6 +180,22 @@ class COptTasks
 			SOptimizeMinidumpContext *PoptmdpConvert(void *pv);
 		};
 
+		// is the metadata cache out of date because of catalog changes
+		static
+		BOOL m_fMDCacheInvalid;
+
+		// are the invalidation callbacks of metadata cache registered
+		static
+		BOOL m_fMDCacheCallbacksRegistered;
+
+		// invalidation callback marking the metadata cache out of date
+		static
+		void InvalidateMDCache(Datum arg, Oid oid);
+
+		// initialize the metadata cache, reset it first if it is out of date
+		static
+		void InitMDCache();
+
 		// execute a task given the argument
 		static
 		void Execute ( void *(*pfunc) (void *), void *pfuncArg);
@@ -218,7 +234,7 @@ class COptTasks
 
 		// create optimizer configuration object
 		static
-		COptimizerConfig *PoconfCreate(IMemoryPool *pmp, ICostModel *pcm);
+		COptimizerConfig *PoconfCreate(IMemoryPool *pmp, ICostModel *pcm, DOUBLE dDependencyDegree);
 
 		// optimize a query to a physical DXL
 		static
@@ -236,6 +252,10 @@ class COptTasks
 		static
 		DrgPss *PdrgPssLoad(IMemoryPool *pmp, char *szPath);
 
+		// search strategy of a single stage bounded by the optimization time budget
+		static
+		DrgPss *PdrgPssTimeBudget(IMemoryPool *pmp, ULONG ulTimeBudget);
+
 		// allocate memory for string
 		static
 		CHAR *SzAllocate(IMemoryPool *pmp, ULONG ulSize);
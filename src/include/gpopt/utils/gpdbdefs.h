@@ -45,6 +45,7 @@ extern "C" {
 #include "executor/nodeMotion.h"
 #include "parser/parsetree.h"
 #include "utils/lsyscache.h"
+#include "utils/syscache.h"
 #include "utils/datum.h"
 #include "utils/array.h"
 #include "utils/builtins.h"
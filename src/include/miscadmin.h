@@ -198,6 +198,7 @@ extern PGDLLIMPORT char *DataDir;
 extern PGDLLIMPORT int NBuffers;
 extern int	MaxBackends;
 extern int	SegMaxBackends;
+extern bool gp_huge_pages;
 extern int	MaxConnections;
 extern int gp_workfile_max_entries;
 extern int gp_mdver_max_entries;
@@ -310,6 +311,8 @@ extern PGDLLIMPORT int max_work_mem;
 extern PGDLLIMPORT int maintenance_work_mem;
 extern PGDLLIMPORT int statement_mem;
 extern PGDLLIMPORT int gp_vmem_limit_per_query;
+extern PGDLLIMPORT int gp_operator_mem_grow_limit;
+extern PGDLLIMPORT int gp_huge_page_alloc_threshold;
 
 extern int	VacuumCostPageHit;
 extern int	VacuumCostPageMiss;
@@ -1043,6 +1043,8 @@ typedef struct SubPlanState
 	AttrNumber *keyColIdx;                /* control data for hash tables */
 	FmgrInfo   *eqfunctions;        /* comparison functions for hash tables */
 	FmgrInfo   *hashfunctions;        /* lookup data for hash functions */
+	/* this is used when caching the results of a correlated subselect: */
+	struct SubPlanCache *resultcache;	/* results by parameter values */
     struct StringInfoData  *cdbextratextbuf;    /* to pass text to cdbexplain */
 } SubPlanState;
 
@@ -1417,6 +1419,7 @@ typedef struct AppendState
         int                        as_whichplan;
         int                        as_firstplan;
         int                        as_lastplan;
+        int                        as_aheadplan;        /* CDB: last subplan opened ahead */
 } AppendState;
 
 /*
@@ -1504,6 +1507,22 @@ typedef enum
 	TableTypeInvalid,
 } TableType;
 
+/*
+ * Range of the inner values of an integer join key, kept next to the Bloom
+ * filter of a hash join, see ExecHashGetHashValue.
+ * 	innertype: type of the inner key, InvalidOid if no range is kept
+ * 	outertype: type of the outer key, InvalidOid if it is not checked
+ * 	empty: no non-null inner value was seen
+ */
+typedef struct RuntimeFilterRange
+{
+	Oid innertype;
+	Oid outertype;
+	bool empty;
+	int64 min;
+	int64 max;
+} RuntimeFilterRange;
+
 /*
  * Runtime filter information passed down to scan.
  * 	hasRuntimeFilter: if this runtime filter has a created Bloom filter
@@ -1511,6 +1530,7 @@ typedef enum
  * 	joinkeys: column position of join keys
  *	hashfunctions: hash functions to hash join key
  *	bloomfilter: BloomFilter instance
+ *	ranges: value range of each join key, NULL if none is kept
  */
 typedef struct RuntimeFilterState
 {
@@ -1520,6 +1540,7 @@ typedef struct RuntimeFilterState
 	List* joinkeys;
 	FmgrInfo *hashfunctions;
 	BloomFilter bloomfilter;
+	RuntimeFilterRange *ranges;
 } RuntimeFilterState;
 
 /* ----------------
@@ -2114,6 +2135,8 @@ typedef struct MergeJoinState
  *                                                                (NULL if table not built yet)
  *                hj_CurHashValue                        hash value for current outer tuple
  *                hj_CurBucketNo                        bucket# for current outer tuple
+ *                hj_CurSkewBucketNo                skew bucket# for current outer tuple,
+ *                                                                or INVALID_SKEW_BUCKET_NO
  *                hj_CurTuple                                last inner tuple matched to current outer
  *                                                                tuple, or NULL if starting search
  *                                                                (CurHashValue, CurBucketNo and CurTuple are
@@ -2144,6 +2167,7 @@ typedef struct HashJoinState
         HashJoinTable hj_HashTable;
         uint32                hj_CurHashValue;
         int                        hj_CurBucketNo;
+        int                        hj_CurSkewBucketNo;
         HashJoinTuple hj_CurTuple;
         List           *hj_OuterHashKeys;                /* list of ExprState nodes */
         List           *hj_InnerHashKeys;                /* list of ExprState nodes */
@@ -2171,6 +2195,19 @@ typedef struct HashJoinState
         int nbatch_loaded_state;
         bool useRuntimeFilter;
         int  estimatedInnerNum;
+        /* CDB: Bloom filter check of the outer tuples from a motion */
+        bool hj_stopOuterFilter;
+        bool hj_checkedOuterFilter;
+        /* CDB: outer tuples of later batches dropped by the Bloom filter */
+        int64 hj_spillFiltered;
+        /* CDB: ring of the outer tuples read ahead to prefetch their buckets */
+        int  hj_PrefetchDistance;       /* size of the ring, 0 if disabled */
+        bool hj_PrefetchActive;         /* hash table large enough to prefetch */
+        bool hj_PrefetchOuterDone;      /* read the last outer tuple */
+        int  hj_PrefetchHead;           /* position of the next tuple to probe */
+        int  hj_PrefetchCount;          /* number of tuples in the ring */
+        struct TupleTableSlot **hj_PrefetchSlots;
+        uint32 *hj_PrefetchHashValues;
 
 } HashJoinState;
 
@@ -2216,6 +2253,13 @@ typedef struct MaterialState
         void                *share_lk_ctxt;
 
         bool                cached_workfiles_found;  /* true if found matching and usable cached workfiles */
+
+        /* the rows of the tuplestore, deformed for rescans, see nodeMaterial.c */
+        bool                rescan_cache_ok;     /* no backward scan or mark/restore */
+        Datum               *rescan_values;      /* rescan_nrows values per column, or NULL */
+        bool                *rescan_isnull;
+        int                 rescan_nrows;
+        int                 rescan_next;         /* next row to return */
 } MaterialState;
 
 /* ----------------
@@ -2599,6 +2643,7 @@ typedef struct MotionState
         bool sentEndOfStream;       /* set when end-of-stream has successfully been sent */
         List *hashExpr;             /* state struct used for evaluating the hash expressions */
         struct CdbHash *cdbhash;    /* hash api object */
+        int skewNextSegIdx;         /* next output segment of a spread hot row */
 
         /* For Motion recv */
         void *tupleheap;            /* data structure for match merge in sorted motion node */
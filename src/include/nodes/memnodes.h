@@ -104,6 +104,8 @@ typedef struct MemoryContextData
 	((context) != NULL && \
 	 ( IsA((context), AllocSetContext) || \
        IsA((context), AsetDirectContext) || \
+       IsA((context), ArenaContext) || \
+       IsA((context), SlabContext) || \
        IsA((context), MPoolContext) ))
 
 
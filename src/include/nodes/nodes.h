@@ -344,6 +344,8 @@ typedef enum NodeTag
 	T_SerializedMemoryAccount,
 
     T_AsetDirectContext = 610,                                      /*CDB*/
+    T_ArenaContext,
+    T_SlabContext,
 
 	/*
 	 * TAGS FOR VALUE NODES (value.h)
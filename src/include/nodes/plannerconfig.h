@@ -47,6 +47,7 @@ typedef struct PlannerConfig
 	bool		enable_mergejoin;
 	bool		enable_hashjoin;
 	bool        gp_enable_hashjoin_size_heuristic;
+	bool		gp_enable_partitionwise_join;
 	bool		gp_enable_fallback_plan;
 	bool        gp_enable_predicate_propagation;
 	bool		mpp_trying_fallback_plan;
@@ -55,6 +56,7 @@ typedef struct PlannerConfig
 
 	bool		gp_enable_multiphase_agg;
 	bool		gp_enable_preunique;
+	bool		gp_enable_segfile_count;
 	bool		gp_eager_preunique;
 	bool		gp_enable_sequential_window_plans;
 	bool 		gp_hashagg_streambottom;
@@ -1114,6 +1114,9 @@ typedef struct Hash
 {
 	Plan		plan;
     bool        rescannable;            /* CDB: true => save rows for rescan */
+	List	   *skewValues;		/* CDB: Consts of the most common values of
+								 * the outer join key, most common first, or
+								 * NIL */
 	/* all other info is in the parent HashJoin node */
 } Hash;
 
@@ -1180,6 +1183,14 @@ typedef struct Motion
 	List		*hashExpr;			/* list of hash expressions */
 	List		*hashDataTypes;	    /* list of hash expr data type oids */
 
+	/*
+	 * For Hash, the hashes of the hot keys of a skewed join, see
+	 * cdbpath_skew_split(). The rows with one of these hashes are either
+	 * spread over the output segments or broadcast to all of them.
+	 */
+	List		*skewHashes;		/* integer list of hash values */
+	bool		skewBroadcast;		/* broadcast rather than spread them */
+
 	/* Output segments */
 	int 	  	numOutputSegs;		/* number of seg indexes in outputSegIdx array, 0 for broadcast */
 	int 	 	*outputSegIdx; 	 	/* array of output segindexes */
@@ -902,6 +902,10 @@ typedef struct CdbMotionPath
 {
 	Path		path;
     Path	   *subpath;
+
+    /* hot keys of a skewed redistribution, see Motion */
+    List       *skewHashes;
+    bool        skewBroadcast;
 } CdbMotionPath;
 
 /*
@@ -56,6 +56,7 @@ extern bool enable_nestloop;
 extern bool enable_mergejoin;
 extern bool enable_hashjoin;
 extern bool gp_enable_hashjoin_size_heuristic;          /*CDB*/
+extern bool gp_enable_partitionwise_join;               /*CDB*/
 extern bool gp_enable_fallback_plan;
 extern bool gp_enable_predicate_propagation;
 
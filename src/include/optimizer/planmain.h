@@ -97,6 +97,7 @@ extern void query_planner(PlannerInfo *root, List *tlist,
  */
 extern Plan *optimize_minmax_aggregates(PlannerInfo *root, List *tlist,
 						   Path *best_path);
+extern Plan *optimize_segfile_count(PlannerInfo *root, List *tlist);
 
 /*
  * prototype for plan/plangroupexp.c
@@ -29,6 +29,19 @@
 
 #define BFZ_BUFFER_SIZE		(1<<14)
 
+/* Index of zlib in the compression algorithms, see bfz.c */
+#define BFZ_COMPRESSION_ZLIB	1
+
+/*
+ * The blocks that the compression algorithms write to the file with
+ * bfz_write_fully are handed to helper threads when gp_workfile_async_writers
+ * is set, through a pool of buffers of BFZ_ASYNC_BLOCK_SIZE bytes: room for
+ * a buffer and the length that lz4 and zstd put before it.
+ */
+#define BFZ_MAX_ASYNC_WRITERS		8
+#define BFZ_ASYNC_BLOCKS_PER_WRITER	16
+#define BFZ_ASYNC_BLOCK_SIZE		(BFZ_BUFFER_SIZE + 64)
+
 struct bfz;
 
 struct bfz_freeable_stuff
@@ -80,14 +93,33 @@ typedef struct bfz
 
 	int64 tot_bytes;
 
+	/*
+	 * Bytes written to the file through bfz_write_fully, the offset of the
+	 * next block. zlib writes the file itself, this stays 0 for it.
+	 */
+	int64 disk_bytes;
+
+	/*
+	 * Set if the blocks are written by the async writers. The number of
+	 * blocks of the file that they have not written yet, and the errno of
+	 * the first one that failed, are protected by the mutex of the writers.
+	 */
+	bool async;
+	int async_pending;
+	int async_errno;
+
 }	bfz_t;
 
 /* These functions are internal to bfz. */
 extern void bfz_nothing_init(bfz_t * thiz);
 extern void bfz_zlib_init(bfz_t * thiz);
+extern void bfz_lz4_init(bfz_t * thiz);
+extern void bfz_zstd_init(bfz_t * thiz);
 extern void bfz_lzop_init(bfz_t * thiz);
 extern void bfz_write_ex(bfz_t * thiz, const char *buffer, int size);
 extern int	bfz_read_ex(bfz_t * thiz, char *buffer, int size);
+extern void bfz_write_fully(bfz_t * thiz, const char *buffer, int size);
+extern void bfz_async_wait(bfz_t * thiz, bool canReportError);
 
 /* These functions are interface to bfz. */
 extern const char *bfz_compression_to_string(int compress);
@@ -97,6 +129,7 @@ extern bfz_t *bfz_create(const char *filePrefix, bool delOnClose, int compress);
 extern bfz_t *bfz_open(const char *fileName, bool delOnClose, int compress);
 extern int64 bfz_append_end(bfz_t * thiz);
 extern void bfz_scan_begin(bfz_t * thiz);
+extern void bfz_prefetch(bfz_t * thiz);
 extern void bfz_close(bfz_t * thiz, bool unreg, bool canReportError);
 extern ssize_t readAndRetry(int fd, void *buffer, size_t size);
 extern ssize_t writeAndRetry(int fd, const void *buffer, size_t size);
@@ -107,6 +140,23 @@ bfz_totalbytes(bfz_t * bfz)
 	return bfz->tot_bytes;
 }
 
+/*
+ * What the file takes on disk so far while appending to it: the blocks
+ * written, compressed, and the buffer not written yet. For zlib, which
+ * compresses as a stream, the bytes appended are all that is known.
+ */
+static inline int64
+bfz_append_size(bfz_t * bfz)
+{
+	struct bfz_freeable_stuff *fs = bfz->freeable_stuff;
+
+	Assert(bfz->mode == BFZ_MODE_APPEND);
+	Assert(fs != NULL);
+	if (bfz->compression_index == BFZ_COMPRESSION_ZLIB)
+		return bfz->tot_bytes + (fs->buffer_pointer - fs->buffer);
+	return bfz->disk_bytes + (fs->buffer_pointer - fs->buffer);
+}
+
 static inline void
 bfz_append(bfz_t * thiz, const char *buffer, int size)
 {
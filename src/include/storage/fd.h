@@ -211,8 +211,22 @@ extern BlockLocation *HdfsGetFileBlockLocations2(const char *path, int64 offset,
 
 extern void HdfsFreeFileBlockLocations(BlockLocation *locations, int block_num);
 
+extern void HdfsGetFileBlockLocationsParallel(int nfiles, char **paths, int64 *lengths,
+								  BlockLocation **locations, int *block_nums,
+								  int nthreads);
+
 extern FileName FileGetName(File file);
 
+/*
+ * A second handle of an open file, outside of the virtual file descriptors,
+ * whose reads can be done by a helper thread.
+ */
+typedef struct FileReadAheadData *FileReadAhead;
+
+extern FileReadAhead FileOpenReadAhead(File file);
+extern int FileReadAheadRead(FileReadAhead readAhead, char *buffer, int amount, int64 offset);
+extern void FileCloseReadAhead(FileReadAhead readAhead);
+
 extern int IsLocalPath(const char *filename);
 
 /* secure enabled hdfs */
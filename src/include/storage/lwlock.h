@@ -37,6 +37,12 @@
 /* Number of partitions of the MD Versioning hashtable */
 #define NUM_MDVERSIONING_PARTITIONS 256
 
+/* Number of partitions of the HDFS metadata cache hashtable */
+#define NUM_METADATA_CACHE_PARTITIONS 16
+
+/* Number of partitions of the append only writer hashtable entries */
+#define NUM_AOSEGFILE_PARTITIONS 16
+
 /*
  * We have a number of predefined LWLocks, plus a bunch of LWLocks that are
  * dynamically assigned (e.g., for shared buffers).  The LWLock structures
@@ -87,6 +93,7 @@ typedef enum LWLockId
 	PersistentObjLock,
 	ReadCacheLock,
 	MetadataCacheLock,
+	ParquetFooterCacheLock,
 	TmpDirInfoLock,
 	FileRepShmemLock,
 	FileRepAckShmemLock,	
@@ -101,7 +108,9 @@ typedef enum LWLockId
 	FirstWorkfileMgrLock,
 	FirstWorkfileQuerySpaceLock = FirstWorkfileMgrLock + NUM_WORKFILEMGR_PARTITIONS,
 	FirstMDVersioningLock = FirstWorkfileQuerySpaceLock + NUM_WORKFILE_QUERYSPACE_PARTITIONS,
-	FirstBufMappingLock = FirstMDVersioningLock + NUM_MDVERSIONING_PARTITIONS,
+	FirstMetadataCacheLock = FirstMDVersioningLock + NUM_MDVERSIONING_PARTITIONS,
+	FirstAOSegFileLock = FirstMetadataCacheLock + NUM_METADATA_CACHE_PARTITIONS,
+	FirstBufMappingLock = FirstAOSegFileLock + NUM_AOSEGFILE_PARTITIONS,
 	FirstLockMgrLock = FirstBufMappingLock + NUM_BUFFER_PARTITIONS,
 	SessionStateLock = FirstLockMgrLock + NUM_LOCK_PARTITIONS,
 	
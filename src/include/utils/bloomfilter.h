@@ -48,10 +48,32 @@ typedef struct BloomFilterData
 } BloomFilterData;
 typedef BloomFilterData *BloomFilter;
 
+/*
+ * A bucket is 32 bytes, so a probe touches a single cache line (or two if
+ * the filter is not aligned), and the 8 words of a bucket make one AVX2
+ * register. Each value sets one bit in every word of its bucket, the bit
+ * taken from the value by the multiply-shift hashing of the seed of the word.
+ */
+extern const uint32_t BloomFilterHashSeeds[NUM_BUCKET_WORDS];
+
+/* The number of values ahead whose buckets are prefetched by batch probes */
+#define BLOOM_PREFETCH_DISTANCE 8
+
+static inline uint32_t
+BloomFilterBucketIdx(uint32_t hash, uint32_t mask)
+{
+    /* use Knuth's multiplicative hash */
+    return ((uint64_t) (hash) * 2654435769ul >> 32) & mask;
+}
+
 extern int64_t UpperPowerTwo(int64_t v);
 extern BloomFilter InitBloomFilter(int memory_size);
 extern void InsertBloomFilter(BloomFilter bf, uint32_t value);
 extern bool FindBloomFilter(BloomFilter bf, uint32_t value);
+extern bool ProbeBloomFilter(BloomFilter bf, uint32_t value);
+extern int FindBloomFilterBatch(BloomFilter bf, const uint32_t *values, int n, bool *found);
+/* the AVX2 kernel of FindBloomFilterBatch, see bloomfilter_avx2.c */
+extern int FindBloomFilterBatchAVX2(BloomFilter bf, const uint32_t *values, int n, bool *found);
 extern void PrintBloomFilter(BloomFilter bf);
 extern void DestroyBloomFilter(BloomFilter bf);
 
@@ -811,6 +811,8 @@ extern Datum bytealike(PG_FUNCTION_ARGS);
 extern Datum byteanlike(PG_FUNCTION_ARGS);
 extern Datum like_escape(PG_FUNCTION_ARGS);
 extern Datum like_escape_bytea(PG_FUNCTION_ARGS);
+extern bool match_literal(const char *t, int tlen, const char *lit, int litlen,
+			  bool anchor_start, bool anchor_end);
 
 /* oracle_compat.c */
 extern Datum lower(PG_FUNCTION_ARGS);
@@ -1170,6 +1172,16 @@ extern Datum snappy_destructor(PG_FUNCTION_ARGS);
 extern Datum snappy_compress_internal(PG_FUNCTION_ARGS);
 extern Datum snappy_decompress_internal(PG_FUNCTION_ARGS);
 extern Datum snappy_validator(PG_FUNCTION_ARGS);
+extern Datum zstd_constructor(PG_FUNCTION_ARGS);
+extern Datum zstd_destructor(PG_FUNCTION_ARGS);
+extern Datum zstd_compress_internal(PG_FUNCTION_ARGS);
+extern Datum zstd_decompress_internal(PG_FUNCTION_ARGS);
+extern Datum zstd_validator(PG_FUNCTION_ARGS);
+extern Datum lz4_constructor(PG_FUNCTION_ARGS);
+extern Datum lz4_destructor(PG_FUNCTION_ARGS);
+extern Datum lz4_compress_internal(PG_FUNCTION_ARGS);
+extern Datum lz4_decompress_internal(PG_FUNCTION_ARGS);
+extern Datum lz4_validator(PG_FUNCTION_ARGS);
 
 extern Datum zlib_constructor(PG_FUNCTION_ARGS);
 extern Datum zlib_destructor(PG_FUNCTION_ARGS);
@@ -158,6 +158,9 @@ typedef struct catcacheheader
 } CatCacheHeader;
 
 
+/* Should backends save and load their catcaches in an init file? */
+extern bool gp_catcache_init_file;
+
 /* this extern duplicates utils/memutils.h... */
 extern PGDLLIMPORT MemoryContext CacheMemoryContext;
 
@@ -188,6 +191,11 @@ extern void PrepareToInvalidateCacheTuple(Relation relation,
 							  SysCacheInvalidateAction action,
 						   void (*function) (int, uint32, ItemPointer, Oid, SysCacheInvalidateAction));
 
+extern void LoadCatalogCacheInitFile(void);
+extern void AtEOXact_CatCacheInitFile(void);
+extern void CatalogCacheInitFileInvalidate(bool beforeSend);
+extern void CatalogCacheInitFileRemove(const char *dbPath);
+
 extern void PrintCatCacheLeakWarning(HeapTuple tuple, const char *resOwnerName);
 extern void PrintCatCacheListLeakWarning(CatCList *list, const char *resOwnerName);
 
@@ -177,6 +177,7 @@ extern bool Master_mirroring_administrator_disable;
 extern bool gp_local_distributed_cache_stats;
 extern bool gp_appendonly_verify_block_checksums;
 extern bool gp_appendonly_verify_write_block;
+extern int	gp_appendonly_read_ahead_buffers;
 extern bool gp_heap_require_relhasoids_match;
 extern bool	Debug_xlog_insert_print;
 extern bool	Debug_persistent_print;
@@ -453,6 +454,7 @@ extern int optimizer_parts_to_force_sort_on_insert;
 extern int optimizer_join_arity_for_associativity_commutativity;
 extern int optimizer_array_expansion_threshold;
 extern int optimizer_join_order_threshold;
+extern int optimizer_time_budget;
 extern bool optimizer_analyze_root_partition;
 extern bool optimizer_analyze_midlevel_partition;
 extern bool optimizer_enable_constant_expression_evaluation;
@@ -474,6 +476,7 @@ extern bool optimizer_enable_derive_stats_all_groups;
 extern bool optimizer_explain_show_status;
 extern bool optimizer_prefer_scalar_dqa_multistage_agg;
 extern bool optimizer_parallel_union;
+extern bool optimizer_parallel;
 extern bool optimizer_array_constraints;
 
 /* Timeout for shareinputscan writer/reader wait for lock files */
@@ -502,6 +505,10 @@ extern char	   *pg_cloud_clustername;
 /* interval of checking local RPS */
 extern int     rps_check_local_interval;
 
+/* seconds a decision of RPS is cached, and how many are kept in shmem */
+extern int     rps_cache_timeout;
+extern int     rps_cache_size;
+
 /*
  * During insertion in a table with parquet partitions,
  * require tuples to be sorted by partition key.
@@ -511,6 +518,36 @@ extern int     rps_check_local_interval;
  */
 extern bool gp_parquet_insert_sort;
 
+/*
+ * Skip the parquet row groups whose min/max statistics show that no row
+ * passes the scan qual.
+ */
+extern bool gp_parquet_rowgroup_skipping;
+
+/*
+ * Dictionary encode the values of the parquet column chunks, until the
+ * dictionary of a chunk is full.
+ */
+extern bool gp_parquet_dictionary_encoding;
+
+/*
+ * Encode the values of the parquet integer, date, time and timestamp column
+ * chunks as bit-packed blocks of deltas (DELTA_BINARY_PACKED).
+ */
+extern bool gp_parquet_delta_encoding;
+
+/*
+ * Number of threads that help compress the pages of a parquet row group
+ * when it is written out, 0 to compress them as the pages are filled.
+ */
+extern int	gp_parquet_compress_threads;
+
+/*
+ * Size in kB of the shared memory that caches the footers of the parquet
+ * segment files read on the host, 0 not to cache them.
+ */
+extern int	gp_parquet_footer_cache_size;
+
 #if USE_EMAIL
 extern char  *gp_email_smtp_server;
 extern char  *gp_email_smtp_userid;
@@ -533,6 +570,8 @@ extern char   *gp_snmp_debug_log;
 extern bool   pxf_enable_filter_pushdown; /* turn pushdown logic on/off     */
 extern bool   pxf_enable_stat_collection; /* turn off stats collection if needed */
 extern int    pxf_stat_max_fragments; /* max fragments to be sampled during analyze */
+extern int    pxf_prefetch_fragments; /* fragments a segment fetches ahead of its scan */
+extern int    pxf_fragments_cache_ttl; /* seconds the master reuses a Fragmenter response */
 extern bool   pxf_enable_locality_optimizations; /* turn locality optimization in the data allocation algorithm on/off     */
 /*
  * Is Isilon the target storage system ?
@@ -580,6 +619,7 @@ extern int orc_update_delete_work_mem;
 extern char *orc_enable_no_limit_numeric;
 
 extern bool magma_cache_read;
+extern bool ao_cache_read;
 extern char *magma_enable_shm;
 extern int magma_shm_limit_per_block;
 
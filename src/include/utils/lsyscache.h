@@ -139,6 +139,7 @@ extern Oid	getBaseTypeAndTypmod(Oid typid, int32 *typmod);
 extern int32 get_typavgwidth(Oid typid, int32 typmod);
 extern int32 get_attavgwidth(Oid relid, AttrNumber attnum);
 extern float4 get_attdistinct(Oid relid, AttrNumber attnum);
+extern float4 get_attdependency(Oid relid, AttrNumber attnum, AttrNumber depattnum);
 extern HeapTuple get_att_stats(Oid relid, AttrNumber attnum);
 extern bool get_attstatsslot(HeapTuple statstuple,
 				 Oid atttype, int32 atttypmod,
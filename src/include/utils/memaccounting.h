@@ -73,6 +73,18 @@ extern int memory_profiler_dataset_size;
  */
 extern bool gp_dump_memory_usage;
 
+/*
+ * Minimum interval in milliseconds between two publications of a process's
+ * memory account tree into shared memory. 0 disables publishing.
+ */
+extern int gp_memory_account_publish_interval;
+
+/*
+ * Log every Nth allocation of a process along with its call stack. 0 disables
+ * the sampling.
+ */
+extern int gp_memory_alloc_sample_interval;
+
 /*
  * Each memory account can assume one of the following memory
  * owner types
@@ -173,6 +185,9 @@ typedef struct MemoryAccount {
 	NodeTag type;
 	MemoryOwnerType ownerType;
 
+	/* plan_node_id of the operator owning this account, -1 if none */
+	int planNodeId;
+
 	uint64 allocated;
 	uint64 freed;
 	uint64 peak;
@@ -261,7 +276,9 @@ typedef struct SerializedMemoryAccount {
 		Assert(NULL == ((PlanState *)execState)->plan->memoryAccount || \
 		AlienExecutorMemoryAccount == ((PlanState *)execState)->plan->memoryAccount || \
 		curMemoryAccount == ((PlanState *)execState)->plan->memoryAccount);\
-		((PlanState *)execState)->plan->memoryAccount = curMemoryAccount;
+		((PlanState *)execState)->plan->memoryAccount = curMemoryAccount;\
+		if (AlienExecutorMemoryAccount != curMemoryAccount)\
+			curMemoryAccount->planNodeId = ((PlanState *)execState)->plan->plan_node_id;
 
 extern struct MemoryAccount*
 MemoryAccounting_CreateAccount(long maxLimit, enum MemoryOwnerType ownerType);
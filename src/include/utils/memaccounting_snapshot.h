@@ -0,0 +1,90 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*-------------------------------------------------------------------------
+ *
+ * memaccounting_snapshot.h
+ *	  The memory accounting trees that running processes publish in shared
+ *	  memory, so that other sessions can inspect them.
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef MEMACCOUNTING_SNAPSHOT_H
+#define MEMACCOUNTING_SNAPSHOT_H
+
+#include "utils/memaccounting.h"
+#include "utils/timestamp.h"
+
+/* At most this many accounts of a process are published in its snapshot */
+#define MEMORY_ACCOUNT_SNAPSHOT_MAX_ENTRIES 64
+
+/* A memory account as published in shared memory */
+typedef struct MemoryAccountSnapshotEntry
+{
+	MemoryOwnerType ownerType;
+	int planNodeId;
+	/* Walk serial of the parent; equal to the entry's own index for a root */
+	uint32 parentSerial;
+	uint64 quota;
+	uint64 peak;
+	uint64 balance;
+} MemoryAccountSnapshotEntry;
+
+/*
+ * The memory account tree of one process as of publishTime, one per backend
+ * in shared memory. The owning process increments changeCount before and
+ * after every update, so readers must retry their copy as long as it is odd
+ * or has changed while copying (the same protocol as PgBackendStatus).
+ */
+typedef struct MemoryAccountSnapshot
+{
+	uint32 changeCount;
+
+	int pid;	/* 0 if the slot holds no snapshot */
+	int sessionId;
+	int commandCount;
+	int segindex;
+	int sliceId;
+	TimestampTz publishTime;
+
+	int64 vmemReserved;
+	uint64 peakBalance;
+
+	/* Number of accounts in the tree; only the first entries are kept */
+	int totalAccounts;
+	int nentries;
+	MemoryAccountSnapshotEntry entries[MEMORY_ACCOUNT_SNAPSHOT_MAX_ENTRIES];
+} MemoryAccountSnapshot;
+
+/* Number of slots, one per backend */
+extern int MemoryAccountSnapshotCount;
+
+extern Size
+MemoryAccounting_ShmemSize(void);
+
+extern void
+MemoryAccounting_ShmemInit(void);
+
+extern void
+MemoryAccounting_PublishSnapshot(void);
+
+extern bool
+MemoryAccounting_ReadSnapshot(int slot, MemoryAccountSnapshot *copy);
+
+#endif   /* MEMACCOUNTING_SNAPSHOT_H */
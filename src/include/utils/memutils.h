@@ -194,6 +194,59 @@ typedef struct AllocSetContext
 
 typedef AllocSetContext *AllocSet;
 
+typedef struct ArenaBlockData *ArenaBlock;		/* forward reference */
+
+/*
+ * ArenaContext is a bump-pointer implementation of MemoryContext for memory
+ * that is released in bulk, such as per-tuple memory.  Chunks are carved off
+ * the active block one after another and pfree() does not reclaim them; the
+ * space comes back only when the context is reset or deleted.
+ *
+ * All chunks point to the one SharedChunkHeader embedded in the context.
+ * Memory accounting is done per block instead of per chunk.
+ */
+typedef struct ArenaContext
+{
+	MemoryContextData header;	/* Standard memory-context fields */
+	ArenaBlock	blocks;			/* head of list of blocks, the active one */
+	bool		isReset;		/* T = no space alloced since last reset */
+	Size		initBlockSize;	/* initial block size */
+	Size		maxBlockSize;	/* maximum block size */
+	Size		nextBlockSize;	/* next block size to allocate */
+	ArenaBlock	keeper;			/* keep this block over resets */
+	uint64		nchunks;		/* chunks allocated since last reset */
+
+	/* The sharedHeader of all chunks of this context */
+	SharedChunkHeader sharedHeader;
+} ArenaContext;
+
+typedef struct SlabBlockData *SlabBlock;		/* forward reference */
+
+/*
+ * SlabContext is an implementation of MemoryContext for chunks of a single
+ * size, allocated and freed one by one.  Freed chunks go onto a freelist in
+ * their block and chunks are aligned on cache lines.  Chunks cannot grow
+ * beyond chunkSize.
+ *
+ * All chunks point to the one SharedChunkHeader embedded in the context.
+ * Memory accounting is done per block instead of per chunk.
+ */
+typedef struct SlabContext
+{
+	MemoryContextData header;	/* Standard memory-context fields */
+	SlabBlock	blocks;			/* blocks with free chunks and chunks in use */
+	SlabBlock	fullBlocks;		/* blocks without free chunks */
+	SlabBlock	emptyBlock;		/* a block without chunks in use, or NULL */
+	Size		chunkSize;		/* data space of a chunk */
+	Size		fullChunkSize;	/* chunk size including header and padding */
+	Size		blockSize;		/* block size */
+	int			chunksPerBlock;	/* number of chunks in a block */
+	uint64		nchunks;		/* chunks in use */
+
+	/* The sharedHeader of all chunks of this context */
+	SharedChunkHeader sharedHeader;
+} SlabContext;
+
 /*
  * Standard top-level memory contexts.
  *
@@ -249,6 +302,13 @@ extern bool MemoryContextContainsGenericAllocation(MemoryContext context, void *
 /* Functions called only by context-type-specific memory managers... */
 extern void MemoryContextNoteAlloc(MemoryContext context, Size nbytes);
 extern void MemoryContextNoteFree(MemoryContext context, Size nbytes);
+
+/* in aset.c */
+extern bool MemoryAccounting_Allocate(struct MemoryAccount* memoryAccount,
+		struct MemoryContextData *context, Size allocatedSize);
+extern bool MemoryAccounting_Free(struct MemoryAccount* memoryAccount,
+		uint16 memoryAccountGeneration, struct MemoryContextData *context,
+		Size allocatedSize);
 #ifdef _MSC_VER
 __declspec(noreturn)
 #endif
@@ -279,6 +339,18 @@ extern MemoryContext AllocSetContextCreate(MemoryContext parent,
 					  Size initBlockSize,
 					  Size maxBlockSize);
 
+/* arena.c */
+extern MemoryContext ArenaContextCreate(MemoryContext parent,
+					  const char *name,
+					  Size initBlockSize,
+					  Size maxBlockSize);
+
+/* slab.c */
+extern MemoryContext SlabContextCreate(MemoryContext parent,
+					  const char *name,
+					  Size chunkSize,
+					  int chunksPerBlock);
+
 /* mpool.c */
 typedef struct MPool MPool;
 extern MPool *mpool_create(MemoryContext parent,
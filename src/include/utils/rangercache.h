@@ -0,0 +1,43 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*-------------------------------------------------------------------------
+ *
+ * rangercache.h
+ *	cache of the privilege decisions of the ranger plugin service
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef RANGERCACHE_H
+#define RANGERCACHE_H
+
+/*
+ * A key is the user, client address, object kind, object and privileges of
+ * a check, longer keys are not cached.
+ */
+#define RANGER_CACHE_KEY_LEN 512
+
+extern Size RangerCache_ShmemSize(void);
+extern void RangerCache_ShmemInit(void);
+
+extern bool RangerCacheLookup(const char *key, int keylen, bool *allowed);
+extern void RangerCacheInsert(const char *key, int keylen, bool allowed);
+extern void RangerCacheSetPolicyVersion(int64 version);
+
+#endif   /* RANGERCACHE_H */
@@ -296,6 +296,7 @@ typedef struct StdRdOptions
 	int 		stripesize; 	/* stripe size (ORC rels only) */
 	int 		rowindexstride;	/* row index stride (ORC rels only) */
 	int 		compressblocksize;  /* compressblocksize in native orc, different from blocksize (ORC rels only) */
+	int			columngroupsize;	/* columns per column group, 0 for none (AO row rels only) */
 } StdRdOptions;
 
 #define HEAP_MIN_FILLFACTOR			10
@@ -324,6 +325,15 @@ typedef struct TidycatOptions
 	((relation)->rd_options ? \
 	 ((StdRdOptions *) (relation)->rd_options)->fillfactor : (defaultff))
 
+/*
+ * RelationGetColumnGroupSize
+ *		Returns the number of columns per column group of an append-only row
+ *		relation, 0 if its rows are not split into column groups.
+ */
+#define RelationGetColumnGroupSize(relation) \
+	((relation)->rd_options ? \
+	 ((StdRdOptions *) (relation)->rd_options)->columngroupsize : 0)
+
 /*
  * RelationGetTargetPageUsage
  *		Returns the relation's desired space usage per page in bytes.
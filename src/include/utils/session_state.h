@@ -66,6 +66,17 @@ typedef struct SessionState
 	 */
 	int commandCountRunaway;
 
+	/*
+	 * Is the current runaway event served by spilling rather than canceling?
+	 */
+	bool runawaySpill;
+
+	/*
+	 * The amount of Vmem used by the session when it was last asked to spill
+	 * instead of being canceled, or 0 if it wasn't since it was last idle
+	 */
+	int sessionVmemSpill;
+
 	/* How many QEs are not blocked in ReadCommand */
 	int activeProcessCount;
 
@@ -62,6 +62,15 @@ typedef struct MKEntry
      */
     Datum d;
 
+    /**
+     * Normalized key of the text levels: the first bytes of the key (of its
+     *   strxfrm form when the collation is not C), loaded big-endian and zero
+     *   padded, so that comparing two of them as integers orders them as the
+     *   keys unless they are equal.  Only the entries that tie on it go to the
+     *   full comparison.  Set by tupsort_prepare.
+     */
+    uint64 nkey;
+
     /**
      * Ptr to the tuple that contains this entry's key.  Is a void * to provide polymorphism: it could be a memtuple, heaptuple, or really anything that has multi-key behavior!
      *   Deciphering of this field is done by the functions that are passed when the multi-key heap is prepared
@@ -230,6 +239,8 @@ typedef enum MKLvType
     MKLV_TYPE_INT32, /* this level contains int32 values */
     MKLV_TYPE_CHAR,  /* this level contains char (blank padded) values */
     MKLV_TYPE_TEXT,  /* this level contains text values */
+    MKLV_TYPE_CHAR_C, /* char (blank padded) values, C collation */
+    MKLV_TYPE_TEXT_C, /* text values, C collation */
 } MKLvType;
 
 typedef struct MKLvContext
@@ -305,6 +316,9 @@ typedef struct MKContext {
 
     /* enforce Unique, for index build */
     bool enforceUnique;
+
+    /* Sorting on a thread of mk_qsort_parallel: no interrupt is serviced */
+    bool inWorker;
 } MKContext;
 
 /**
@@ -341,6 +355,11 @@ static inline void mk_qsort(MKEntry* a, int n, MKContext *ctxt)
     mk_qsort_impl(a, 0, n-1, 0, true, ctxt, false);
 }
 
+/* Fewest entries for which an in-memory sort is split across threads */
+#define MKQS_PARALLEL_MIN_ENTRIES 65536
+
+extern void mk_qsort_parallel(MKEntry *a, int n, MKContext *ctxt, int nthreads);
+
 /* MK Heap stuff */
 typedef bool (*MKFlagPtrReader) (void *ctxt, MKEntry *e);
 typedef struct MKHeapReader
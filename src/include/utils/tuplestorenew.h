@@ -53,6 +53,7 @@ extern void ntuplestore_reset(NTupleStore *ts);
 extern void ntuplestore_flush(NTupleStore *ts);
 extern void ntuplestore_destroy(NTupleStore *ts);
 extern void ntuplestore_trim(NTupleStore* ts, NTupleStorePos *pos);
+extern bool ntuplestore_in_memory(NTupleStore *ts, Size *bytes);
 extern int ntuplestore_compare_pos(NTupleStore *ts, NTupleStorePos *pos1, NTupleStorePos *pos2);
 
 /* Tuple store accessor method 
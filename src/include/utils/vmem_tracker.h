@@ -46,7 +46,17 @@ typedef enum MemoryAllocationStatus
 
 typedef int64 EventVersion;
 
+/*
+ * Callback of an operator that can release memory by spilling to disk.
+ * It is called when the session runs away, and returns true if the
+ * operator will spill.  As it runs from CHECK_FOR_INTERRUPTS(), the
+ * callback must not spill itself, only ask the operator to spill on its
+ * next input tuple.
+ */
+typedef bool (*RunawaySpillCallback) (void *arg);
+
 extern int runaway_detector_activation_percent;
+extern bool gp_runaway_spill_first;
 
 extern int32 VmemTracker_ConvertVmemChunksToMB(int chunks);
 extern int32 VmemTracker_ConvertVmemMBToChunks(int mb);
@@ -61,6 +71,7 @@ extern int32 VmemTracker_GetVmemLimitChunks(void);
 extern int32 VmemTracker_GetAvailableVmemMB(void);
 extern int64 VmemTracker_GetAvailableVmemBytes(void);
 extern int32 VmemTracker_GetAvailableQueryVmemMB(void);
+extern int64 VmemTracker_GetOperatorMemoryGrowth(int64 quotaBytes, int64 grownBytes);
 extern void VmemTracker_ShmemInit(void);
 extern void VmemTracker_Init(void);
 extern void VmemTracker_Shutdown(void);
@@ -81,6 +92,11 @@ extern bool RedZoneHandler_IsVmemRedZone(void);
 extern void RedZoneHandler_DetectRunawaySession(void);
 extern void RunawayCleaner_RunawayCleanupDoneForSession(void);
 extern void RunawayCleaner_RunawayCleanupDoneForProcess(bool ignoredCleanup);
+extern void RunawayCleaner_RegisterSpillCallback(RunawaySpillCallback callback, void *arg);
+extern void RunawayCleaner_UnregisterSpillCallback(RunawaySpillCallback callback, void *arg);
+extern void AtEOXact_RunawaySpillCallbacks(void);
+extern void AtEOSubXact_RunawaySpillCallbacks(bool isCommit, SubTransactionId mySubid,
+											  SubTransactionId parentSubid);
 extern void RedZoneHandler_LogVmemUsageOfAllSessions(void);
 
 extern void IdleTracker_ActivateProcess(void);
@@ -57,10 +57,15 @@
 #define WORKFILE_NUM_TUPLESTORE_LOB 2
 
 
-/* Placeholder snapshot type */
+/*
+ * Snapshot of the tables read by the subplan of a workfile set: a hash of
+ * the relations and of the file splits their scans read on this segment,
+ * see workfile_mgr_snapshot. A set is only reused by a subplan with the same
+ * snapshot, so appending to a table invalidates the sets built from it.
+ */
 typedef uint32 workfile_set_snapshot;
 
-/* placeholder snapshot information */
+/* no snapshot, for the sets that are not reused */
 #define NULL_SNAPSHOT 0
 
 typedef struct workfile_set_plan
@@ -146,8 +151,39 @@ typedef struct workfile_set
 	/* Set to true during operator execution once set is complete */
 	bool complete;
 
+	/* Plan node of the operator creating the workfile set, -1 if none */
+	int plan_node_id;
+
+	/* Bytes written to the files of the set while it was created */
+	int64 spilled_size;
+
+	/* Spilling details set by the operator, see workfile_mgr_report_spill */
+	int32 spill_batches;
+	int32 spill_depth;
+	int64 spill_memory_wanted;
+
 } workfile_set;
 
+/*
+ * One operator that spilled, as kept in the spill history of a segment,
+ * see workfile_spillhistory.c
+ */
+typedef struct WorkfileSpillRecord
+{
+	TimestampTz end_time;
+	int session_id;
+	int command_count;
+	int slice_id;
+	int plan_node_id;
+	NodeTag node_type;
+	uint32 no_files;
+	int32 batches;
+	int32 depth;
+	int64 operator_work_mem;
+	int64 spilled_size;
+	int64 memory_wanted;
+} WorkfileSpillRecord;
+
 /* The key for an entry stored in the Queryspace Hashtable */
 typedef struct Queryspace_HashKey
 {
@@ -179,6 +215,7 @@ typedef struct QueryspaceDesc
 workfile_set *workfile_mgr_create_set(enum ExecWorkFileType type, bool can_be_reused,
 		PlanState *ps, workfile_set_snapshot snapshot);
 workfile_set *workfile_mgr_find_set(PlanState *ps);
+workfile_set_snapshot workfile_mgr_snapshot(PlanState *ps);
 void workfile_mgr_close_set(workfile_set *work_set);
 void workfile_mgr_cleanup(void);
 bool workfile_mgr_can_reuse(workfile_set *work_set, PlanState *ps);
@@ -189,6 +226,8 @@ Cache *workfile_mgr_get_cache(void);
 int32 workfile_mgr_clear_cache(int seg_id);
 int64 workfile_mgr_evict(int64 size_requested);
 void workfile_update_in_progress_size(ExecWorkFile *workfile, int64 size);
+void workfile_mgr_report_spill(workfile_set *work_set, struct Instrumentation *instr,
+		int batches, int depth, int64 memory_wanted);
 
 /* Workfile File operations */
 ExecWorkFile *workfile_mgr_create_file(workfile_set *work_set);
@@ -223,6 +262,12 @@ QueryspaceDesc *WorkfileQueryspace_InitEntry(int session_id, int command_count);
 void WorkfileQueryspace_ReleaseEntry(void);
 bool WorkfileQueryspace_AddWorkfile(void);
 
+/* Workfile spill history operations */
+void WorkfileSpillHistory_Init(void);
+Size WorkfileSpillHistory_ShMemSize(void);
+void WorkfileSpillHistory_Add(workfile_set *work_set);
+int WorkfileSpillHistory_Read(WorkfileSpillRecord **records);
+
 /* Serialization functions */
 void outfuncs_workfile_mgr_init(List *rtable);
 void outfuncs_workfile_mgr_end(void);
@@ -2504,8 +2504,9 @@ PLyList_FromArray(PLyDatumToOb *arg, Datum d)
 	ArrayType  *array = DatumGetArrayTypeP(d);
 	PLyDatumToOb *elm = arg->elm;
 	PyObject   *list;
+	Datum	   *elems;
+	bool	   *nulls;
 	int			length;
-	int			lbound;
 	int			i;
 
 	if (ARR_NDIM(array) == 0)
@@ -2517,29 +2518,34 @@ PLyList_FromArray(PLyDatumToOb *arg, Datum d)
 			  errmsg("cannot convert multidimensional array to Python list"),
 			  errdetail("PL/Python only supports one-dimensional arrays.")));
 
-	length = ARR_DIMS(array)[0];
-	lbound = ARR_LBOUND(array)[0];
+	/*
+	 * Take the elements apart in a single pass: array_ref() has to walk the
+	 * array from its start for variable length elements, or when there are
+	 * nulls, which made large arrays quadratic to convert.  Arrays are how
+	 * a function is handed the values of many rows at once, so they can be
+	 * large.
+	 */
+	deconstruct_array(array, elm->typoid, elm->typlen, elm->typbyval,
+					  elm->typalign, &elems, &nulls, &length);
+
 	list = PyList_New(length);
+	if (list == NULL)
+		PLy_elog(ERROR, "could not create new Python list");
 
 	for (i = 0; i < length; i++)
 	{
-		Datum		elem;
-		bool		isnull;
-		int			offset;
-
-		offset = lbound + i;
-		elem = array_ref(array, 1, &offset, arg->typlen,
-						 elm->typlen, elm->typbyval, elm->typalign,
-						 &isnull);
-		if (isnull)
+		if (nulls[i])
 		{
 			Py_INCREF(Py_None);
 			PyList_SET_ITEM(list, i, Py_None);
 		}
 		else
-			PyList_SET_ITEM(list, i, elm->func(elm, elem));
+			PyList_SET_ITEM(list, i, elm->func(elm, elems[i]));
 	}
 
+	pfree(elems);
+	pfree(nulls);
+
 	return list;
 }
 
@@ -2785,6 +2791,7 @@ static Datum
 PLySequence_ToArray(PLyObToDatum *arg, int32 typmod, PyObject *plrv)
 {
 	ArrayType  *array;
+	PyObject   *seq;
 	int			i;
 	Datum	   *elems;
 	bool	   *nulls;
@@ -2796,13 +2803,18 @@ PLySequence_ToArray(PLyObToDatum *arg, int32 typmod, PyObject *plrv)
 	if (!PySequence_Check(plrv))
 		PLy_elog(ERROR, "return value of function with array return type is not a Python sequence");
 
-	len = PySequence_Length(plrv);
-	elems = palloc(sizeof(*elems) * len);
-	nulls = palloc(sizeof(*nulls) * len);
+	/* a list or tuple as it is, without a new object for each item */
+	seq = PySequence_Fast(plrv, "return value of function with array return type is not a Python sequence");
+	if (seq == NULL)
+		PLy_elog(ERROR, NULL);
+
+	len = PySequence_Fast_GET_SIZE(seq);
+	elems = palloc(sizeof(*elems) * Max(len, 1));
+	nulls = palloc(sizeof(*nulls) * Max(len, 1));
 
 	for (i = 0; i < len; i++)
 	{
-		PyObject   *obj = PySequence_GetItem(plrv, i);
+		PyObject   *obj = PySequence_Fast_GET_ITEM(seq, i);
 
 		if (obj == Py_None)
 			nulls[i] = true;
@@ -2816,12 +2828,13 @@ PLySequence_ToArray(PLyObToDatum *arg, int32 typmod, PyObject *plrv)
 			 */
 			elems[i] = arg->elm->func(arg->elm, -1, obj);
 		}
-		Py_XDECREF(obj);
 	}
 
+	Py_DECREF(seq);
+
 	lbs = 1;
 	array = construct_md_array(elems, nulls, 1, &len, &lbs,
-							   get_element_type(arg->typoid), arg->elm->typlen, arg->elm->typbyval, arg->elm->typalign);
+							   arg->elm->typoid, arg->elm->typlen, arg->elm->typbyval, arg->elm->typalign);
 	return PointerGetDatum(array);
 }
 
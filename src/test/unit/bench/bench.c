@@ -0,0 +1,135 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench.h"
+
+#define BENCH_MAX_REPETITIONS 100
+
+volatile uint64_t benchmark_sink = 0;
+
+static double bench_min_time_ms = 200.0;	/* per repetition */
+static int	bench_repetitions = 5;
+static const char *bench_filter = NULL;
+
+static double
+bench_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static double
+bench_time_ns(const Benchmark *b, uint64_t iterations)
+{
+	double		start = bench_now_ns();
+
+	b->function(iterations, b->state);
+	return bench_now_ns() - start;
+}
+
+static int
+bench_cmp_double(const void *a, const void *b)
+{
+	double		x = *(const double *) a;
+	double		y = *(const double *) b;
+
+	return (x > y) - (x < y);
+}
+
+/*
+ * Accepted arguments:
+ *   --filter=<substring>   only run the benchmarks whose name contains it
+ *   --min-time=<ms>        minimum duration of one repetition (default 200)
+ *   --repetitions=<n>      number of measured repetitions (default 5)
+ */
+void
+benchmark_parse_arguments(int argc, char *argv[])
+{
+	int			i;
+
+	for (i = 1; i < argc; i++)
+	{
+		if (strncmp(argv[i], "--filter=", 9) == 0)
+			bench_filter = argv[i] + 9;
+		else if (strncmp(argv[i], "--min-time=", 11) == 0)
+			bench_min_time_ms = atof(argv[i] + 11);
+		else if (strncmp(argv[i], "--repetitions=", 14) == 0)
+			bench_repetitions = atoi(argv[i] + 14);
+		else
+			fprintf(stderr, "unrecognized argument \"%s\"\n", argv[i]);
+	}
+
+	if (bench_min_time_ms <= 0)
+		bench_min_time_ms = 1;
+	if (bench_repetitions < 1)
+		bench_repetitions = 1;
+	if (bench_repetitions > BENCH_MAX_REPETITIONS)
+		bench_repetitions = BENCH_MAX_REPETITIONS;
+}
+
+/*
+ * Run each benchmark first with a growing number of iterations until one run
+ * takes a tenth of the minimum time, which also warms up caches and branch
+ * predictors, then size the measured runs from that estimate.
+ */
+int
+run_benchmarks_(const Benchmark *benchmarks, size_t count)
+{
+	size_t		i;
+
+	for (i = 0; i < count; i++)
+	{
+		const Benchmark *b = &benchmarks[i];
+		double		samples[BENCH_MAX_REPETITIONS];
+		double		target_ns = bench_min_time_ms * 1e6;
+		double		elapsed;
+		uint64_t	iterations = 1;
+		int			r;
+
+		if (bench_filter != NULL && strstr(b->name, bench_filter) == NULL)
+			continue;
+
+		while ((elapsed = bench_time_ns(b, iterations)) < target_ns / 10 &&
+			   iterations < (UINT64_MAX / 2))
+			iterations *= 2;
+
+		if (elapsed < target_ns)
+			iterations = (uint64_t) (iterations * (target_ns / (elapsed > 0 ? elapsed : 1)));
+		if (iterations == 0)
+			iterations = 1;
+
+		for (r = 0; r < bench_repetitions; r++)
+			samples[r] = bench_time_ns(b, iterations) / iterations;
+
+		qsort(samples, bench_repetitions, sizeof(double), bench_cmp_double);
+
+		printf("BENCH %s %.2f ns/op %.2f min %llu iterations\n",
+			   b->name, samples[bench_repetitions / 2], samples[0],
+			   (unsigned long long) iterations);
+		fflush(stdout);
+	}
+
+	return 0;
+}
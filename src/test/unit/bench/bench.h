@@ -0,0 +1,63 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * A minimal micro-benchmark driver for backend hot paths.
+ *
+ * Benchmarks are built like the cmockery unit tests: a <name>_bench.c file
+ * next to the <name>_test.c one includes the source under test and is linked
+ * against the real and mocked backend objects.  Each benchmark function runs
+ * the measured code the given number of times; the driver picks the number
+ * of iterations, repeats the measurement and prints one line per benchmark:
+ *
+ *   BENCH <name> <median ns/op> ns/op <min ns/op> min <iterations> iterations
+ *
+ * bench_compare.py compares two such outputs to spot regressions.
+ */
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef void (*BenchmarkFunction) (uint64_t iterations, void *state);
+
+typedef struct Benchmark
+{
+	const char *name;
+	BenchmarkFunction function;
+	void	   *state;			/* passed to every run of function */
+} Benchmark;
+
+#define benchmark(f, state) { #f, f, state }
+/* For running one function with several states */
+#define named_benchmark(name, f, state) { name, f, state }
+
+/*
+ * Results must be fed into benchmark_sink so that the compiler can't drop
+ * the measured code as dead.
+ */
+extern volatile uint64_t benchmark_sink;
+#define benchmark_keep(x) (benchmark_sink += (uint64_t) (x))
+
+extern void benchmark_parse_arguments(int argc, char *argv[]);
+extern int	run_benchmarks_(const Benchmark *benchmarks, size_t count);
+
+#define run_benchmarks(b) run_benchmarks_(b, sizeof(b) / sizeof((b)[0]))
+
+#endif   /* BENCH_H */
@@ -0,0 +1,80 @@
+#!/usr/bin/env python
+#
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+#
+"""
+Compare two outputs of the micro-benchmarks (the BENCH lines printed by
+"make bench") and report the benchmarks that got slower or faster than the
+given threshold.  Exits with status 1 if any benchmark regressed, so that it
+can gate a change to a hot path.
+
+    bench_compare.py [--threshold=PCT] baseline.out current.out
+"""
+
+import optparse
+import sys
+
+
+def parse_results(path):
+    results = {}
+    with open(path) as f:
+        for line in f:
+            fields = line.split()
+            if len(fields) >= 3 and fields[0] == 'BENCH':
+                results[fields[1]] = float(fields[2])
+    return results
+
+
+def main():
+    parser = optparse.OptionParser(
+        usage='usage: %prog [--threshold=PCT] baseline current')
+    parser.add_option('--threshold', type='float', default=5.0,
+                      help='percentage of change to report (default 5)')
+    (options, args) = parser.parse_args()
+    if len(args) != 2:
+        parser.error('need a baseline and a current results file')
+
+    baseline = parse_results(args[0])
+    current = parse_results(args[1])
+    regressed = False
+
+    for name in sorted(current):
+        if name not in baseline:
+            print('%-50s %12.2f ns/op (new)' % (name, current[name]))
+            continue
+        old = baseline[name]
+        new = current[name]
+        change = (new - old) / old * 100.0 if old > 0 else 0.0
+        if change > options.threshold:
+            status = 'SLOWER'
+            regressed = True
+        elif change < -options.threshold:
+            status = 'faster'
+        else:
+            status = ''
+        print('%-50s %12.2f -> %12.2f ns/op %+7.1f%% %s' %
+              (name, old, new, change, status))
+
+    for name in sorted(set(baseline) - set(current)):
+        print('%-50s missing from current results' % name)
+
+    return 1 if regressed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,47 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Definitions shared by gpnetbenchClient and gpnetbenchServer for the
+ * UDP_IC experiment, which loads the network the way the UDP interconnect
+ * does: every stream keeps a window of unacknowledged packets in flight and
+ * retransmits the ones whose ack doesn't arrive in time.
+ */
+#ifndef GPNETBENCH_H
+#define GPNETBENCH_H
+
+#include <stdint.h>
+
+#define UDP_IC_MAGIC	0x6770696e
+#define UDP_IC_MAX_PACKET	(63 * 1024)
+
+/*
+ * Header at the start of every data packet.  The server sends the header
+ * back as the ack, so the client can match it without keeping state per
+ * packet beyond its window.
+ */
+typedef struct UdpIcHeader
+{
+	uint32_t	magic;
+	uint32_t	stream;			/* index of the sending stream */
+	uint32_t	seq;			/* sequence number within the stream */
+	uint32_t	len;			/* length of the packet including this header */
+} UdpIcHeader;
+
+#endif   /* GPNETBENCH_H */
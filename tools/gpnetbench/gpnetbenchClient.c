@@ -27,12 +27,39 @@
 #include <unistd.h>
 #include <time.h>
 #include <sys/time.h>
+#include <poll.h>
+
+#include "gpnetbench.h"
 
 #define INIT_RETRIES 5
+
+/* Latencies are counted in buckets of LATENCY_BUCKET_US up to the last one */
+#define LATENCY_BUCKET_US 10
+#define LATENCY_BUCKETS 100000
+
+/* A packet of a UDP_IC stream that has been sent but not acked yet */
+typedef struct UdpIcPending
+{
+	uint32_t	seq;
+	int			inuse;
+	double		firstSent;		/* for the latency */
+	double		lastSent;		/* for the retransmit timeout */
+} UdpIcPending;
+
+typedef struct UdpIcStream
+{
+	struct sockaddr_in address;
+	uint32_t	nextSeq;
+	int			inFlight;
+	UdpIcPending *pending;		/* indexed by seq modulo the window */
+} UdpIcStream;
+
 void usage(void);
 void send_buffer(int fd, char* buffer, int bytes);
 void print_headers(void);
 double subtractTimeOfDay(struct timeval* begin, struct timeval* end);
+int run_udp_ic(char* hostnames, int serverPort, int duration, int bytesBufSize,
+			   int streams, int window, int timeoutMs, int displayHeaders);
 
 int main(int argc, char** argv)
 {
@@ -46,7 +73,11 @@ int main(int argc, char** argv)
 	double actual_duration;
 	char* hostname = NULL;
 	char* sendBuffer = NULL;
-	int kilobytesBufSize = 32;
+	int kilobytesBufSize = 0;
+	char* experiment = "TCP_STREAM";
+	int streams = 1;
+	int window = 4;
+	int timeoutMs = 20;
 	int bytesBufSize;
 	struct sockaddr_in address;
 	struct hostent* host_entry;
@@ -58,7 +89,7 @@ int main(int argc, char** argv)
     struct timeval beginTimeDetails;
     struct timeval endTimeDetails;
 
-	while ((c = getopt (argc, argv, "p:l:b:P:H:f:t:h")) != -1)
+	while ((c = getopt (argc, argv, "p:l:b:P:H:f:t:F:w:T:h")) != -1)
 	{
 		switch (c)
 		{
@@ -83,7 +114,16 @@ int main(int argc, char** argv)
 				// backward compat
 				break;
 			case 't':
-				// backward compat
+				experiment = optarg;
+				break;
+			case 'F':
+				streams = atoi(optarg);
+				break;
+			case 'w':
+				window = atoi(optarg);
+				break;
+			case 'T':
+				timeoutMs = atoi(optarg);
 				break;
 			case 'h':
 			case '?':
@@ -113,7 +153,33 @@ int main(int argc, char** argv)
 		return 1;
 	}
 
+	if (strcmp(experiment, "UDP_IC") == 0)
+	{
+		// the interconnect's default gp_max_packet_size is 8KB
+		if (kilobytesBufSize == 0)
+			kilobytesBufSize = 8;
+		if (kilobytesBufSize < 1 || kilobytesBufSize * 1024 > UDP_IC_MAX_PACKET)
+		{
+			fprintf(stdout, "packet size must be between 1 and %d KB\n", UDP_IC_MAX_PACKET / 1024);
+			return 1;
+		}
+		if (streams < 1 || streams > 1024 || window < 1 || window > 1024)
+		{
+			fprintf(stdout, "streams and window must be between 1 and 1024\n");
+			return 1;
+		}
+		if (timeoutMs < 1)
+		{
+			fprintf(stdout, "retransmit timeout must be at least 1 ms\n");
+			return 1;
+		}
+		return run_udp_ic(hostname, serverPort, duration, kilobytesBufSize * 1024,
+						  streams, window, timeoutMs, displayHeaders);
+	}
+
 	// validate a sensible value for buffer size
+	if (kilobytesBufSize == 0)
+		kilobytesBufSize = 32;
 	if (kilobytesBufSize < 1 || kilobytesBufSize > 10240)
 	{
 		fprintf(stdout, "buffer size for sending must be between 1 and 10240 KB\n");
@@ -176,15 +242,22 @@ int main(int argc, char** argv)
 
 void usage()
 {
-	fprintf(stdout, "usage: gpnetbench -p PORT -H HOST [-l SECONDS] [-t EXPERIMENT] [-f UNITS] [-P HEADERS] [-b KB] [-h]\n");
+	fprintf(stdout, "usage: gpnetbench -p PORT -H HOST [-l SECONDS] [-t EXPERIMENT] [-f UNITS] [-P HEADERS] [-b KB]\n");
+	fprintf(stdout, "                  [-F STREAMS] [-w WINDOW] [-T MS] [-h]\n");
 	fprintf(stdout, "where\n");
 	fprintf(stdout, "       PORT is the port to connect to for the server\n");
 	fprintf(stdout, "       HOST is the hostname to connect to for the server\n");
 	fprintf(stdout, "       SECONDS is the number of seconds to sample the network, where the default is 60\n");
-	fprintf(stdout, "       EXPERIMENT is the experiment name to run, where the default is TCP_STREAM\n");
+	fprintf(stdout, "       EXPERIMENT is the experiment name to run, TCP_STREAM (the default) or UDP_IC\n");
 	fprintf(stdout, "       UNITS is the output units, where the default is M megabytes\n");
 	fprintf(stdout, "       HEADERS is 0 (don't) or 1 (do) display headers in the output\n");
 	fprintf(stdout, "       KB is the size of the send buffer in kilobytes, where the default is 32\n");
+	fprintf(stdout, "          (the size of the packets for UDP_IC, where the default is 8)\n");
+	fprintf(stdout, "UDP_IC only, against gpnetbenchServer -u:\n");
+	fprintf(stdout, "       HOST can be a comma separated list, the streams are spread over the hosts\n");
+	fprintf(stdout, "       STREAMS is the number of concurrent streams, where the default is 1\n");
+	fprintf(stdout, "       WINDOW is the number of unacked packets per stream, where the default is 4\n");
+	fprintf(stdout, "       MS is the retransmit timeout in milliseconds, where the default is 20\n");
 
 	fprintf(stdout, "       -h shows this help message\n");
 }
@@ -237,3 +310,188 @@ void print_headers()
 	printf("n/a   n/a      bytes    secs.    MBytes/sec\n");
 }
 
+static double now_seconds(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static double latency_percentile(unsigned int* histogram, unsigned int count, double fraction)
+{
+	unsigned int target = (unsigned int) (count * fraction);
+	unsigned int seen = 0;
+	int i;
+
+	for (i = 0; i < LATENCY_BUCKETS; i++)
+	{
+		seen += histogram[i];
+		if (seen > target)
+			return (i + 1) * LATENCY_BUCKET_US / 1000.0;
+	}
+	return LATENCY_BUCKETS * LATENCY_BUCKET_US / 1000.0;
+}
+
+static void send_packet(int fd, UdpIcStream* stream, int streamIndex, uint32_t seq,
+						char* buffer, int bytes)
+{
+	UdpIcHeader* header = (UdpIcHeader *) buffer;
+
+	header->magic = UDP_IC_MAGIC;
+	header->stream = streamIndex;
+	header->seq = seq;
+	header->len = bytes;
+
+	// a full socket buffer is handled like a lost packet, by the retransmit
+	(void) sendto(fd, buffer, bytes, 0, (struct sockaddr *) &stream->address,
+				  sizeof(stream->address));
+}
+
+/*
+ * The UDP_IC experiment: keep a window of packets in flight on every stream,
+ * retransmit the ones not acked within the timeout and measure the
+ * throughput of acked data and the latency from the first send to the ack.
+ */
+int run_udp_ic(char* hostnames, int serverPort, int duration, int bytesBufSize,
+			   int streams, int window, int timeoutMs, int displayHeaders)
+{
+	int socketFd;
+	int i;
+	int nhosts = 0;
+	struct sockaddr_in hosts[64];
+	char* host;
+	char* hostList = strdup(hostnames);
+	char* sendBuffer = malloc(bytesBufSize);
+	char ackBuffer[sizeof(UdpIcHeader)];
+	UdpIcStream* stream = calloc(streams, sizeof(UdpIcStream));
+	unsigned int* histogram = calloc(LATENCY_BUCKETS, sizeof(unsigned int));
+	unsigned int acked = 0;
+	unsigned int sent = 0;
+	unsigned int retransmits = 0;
+	unsigned int duplicates = 0;
+	double timeout = timeoutMs / 1000.0;
+	double start;
+	double end;
+	double now;
+	double latencySum = 0;
+	double megaBytesPerSecond;
+
+	memset(sendBuffer, 0, bytesBufSize);
+
+	for (host = strtok(hostList, ","); host && nhosts < 64; host = strtok(NULL, ","))
+	{
+		struct hostent* host_entry = gethostbyname(host);
+
+		if (!host_entry)
+		{
+			fprintf(stdout, "could not resolve host %s\n", host);
+			return 1;
+		}
+		memset(&hosts[nhosts], 0, sizeof(struct sockaddr_in));
+		hosts[nhosts].sin_family = AF_INET;
+		memcpy((char *)&hosts[nhosts].sin_addr, (char *)host_entry->h_addr, host_entry->h_length);
+		hosts[nhosts].sin_port = htons(serverPort);
+		nhosts++;
+	}
+
+	socketFd = socket(PF_INET, SOCK_DGRAM, 0);
+	if (socketFd < 0)
+	{
+		fprintf(stdout, "socket call failed\n");
+		return 1;
+	}
+
+	for (i = 0; i < streams; i++)
+	{
+		stream[i].address = hosts[i % nhosts];
+		stream[i].pending = calloc(window, sizeof(UdpIcPending));
+	}
+
+	start = now_seconds();
+	end = start + duration;
+	while ((now = now_seconds()) < end)
+	{
+		struct pollfd pfd;
+		int s;
+
+		// fill the windows, and resend what timed out
+		for (s = 0; s < streams; s++)
+		{
+			UdpIcStream* st = &stream[s];
+
+			for (i = 0; i < window; i++)
+			{
+				UdpIcPending* p = &st->pending[i];
+
+				if (p->inuse && now - p->lastSent > timeout)
+				{
+					send_packet(socketFd, st, s, p->seq, sendBuffer, bytesBufSize);
+					p->lastSent = now;
+					retransmits++;
+				}
+			}
+			while (st->inFlight < window)
+			{
+				UdpIcPending* p = &st->pending[st->nextSeq % window];
+
+				p->seq = st->nextSeq++;
+				p->inuse = 1;
+				p->firstSent = p->lastSent = now;
+				send_packet(socketFd, st, s, p->seq, sendBuffer, bytesBufSize);
+				st->inFlight++;
+				sent++;
+			}
+		}
+
+		pfd.fd = socketFd;
+		pfd.events = POLLIN;
+		if (poll(&pfd, 1, 1) <= 0)
+			continue;
+
+		// drain the acks that arrived
+		while (recv(socketFd, ackBuffer, sizeof(ackBuffer), MSG_DONTWAIT) == sizeof(ackBuffer))
+		{
+			UdpIcHeader* header = (UdpIcHeader *) ackBuffer;
+			UdpIcPending* p;
+			double latencyUs;
+			int bucket;
+
+			if (header->magic != UDP_IC_MAGIC || header->stream >= (uint32_t) streams)
+				continue;
+			p = &stream[header->stream].pending[header->seq % window];
+			if (!p->inuse || p->seq != header->seq)
+			{
+				duplicates++;
+				continue;
+			}
+
+			latencyUs = (now_seconds() - p->firstSent) * 1000000.0;
+			bucket = (int) (latencyUs / LATENCY_BUCKET_US);
+			histogram[bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1]++;
+			latencySum += latencyUs;
+
+			p->inuse = 0;
+			stream[header->stream].inFlight--;
+			acked++;
+		}
+	}
+	end = now_seconds();
+
+	megaBytesPerSecond = acked * (double) bytesBufSize / (1024.0 * 1024.0) / (end - start);
+
+	if (displayHeaders)
+	{
+		printf("         Packet  Elapsed                       Latency ms\n");
+		printf("Streams  Size    Time    Throughput  Packets    avg     p50     p90     p99  Retrans    Dups\n");
+		printf("         bytes   secs.   MBytes/sec  acked\n");
+	}
+	printf("%-8d %-7d %-7.2f %-11.2f %-10u %-7.3f %-7.3f %-7.3f %-7.3f %-8u %u\n",
+		   streams, bytesBufSize, end - start, megaBytesPerSecond, acked,
+		   acked ? latencySum / acked / 1000.0 : 0.0,
+		   latency_percentile(histogram, acked, 0.50),
+		   latency_percentile(histogram, acked, 0.90),
+		   latency_percentile(histogram, acked, 0.99),
+		   retransmits, duplicates);
+	return 0;
+}
@@ -26,10 +26,13 @@
 #include <netdb.h>
 #include <unistd.h>
 
+#include "gpnetbench.h"
+
 #define SERVER_APPLICATION_RECEIVE_BUF_SIZE 65536
 char* receiveBuffer = NULL;
 
 void handleIncomingConnection(int fd);
+void handleUdpPackets(int fd, int lossPercent);
 
 void usage(void);
 
@@ -43,9 +46,11 @@ int main(int argc, char** argv)
 	socklen_t socket_length;
 	int c;
 	int serverPort = 0;
+	int udp = 0;
+	int lossPercent = 0;
 	int pid;
      
-	while ((c = getopt (argc, argv, "hp:")) != -1)
+	while ((c = getopt (argc, argv, "hp:uL:")) != -1)
 	{
 		switch (c)
 		{
@@ -55,6 +60,12 @@ int main(int argc, char** argv)
 			case 'p':
 				serverPort = atoi(optarg);
 				break;
+			case 'u':
+				udp = 1;
+				break;
+			case 'L':
+				lossPercent = atoi(optarg);
+				break;
 			case '?':
 			default:
 				usage();
@@ -69,6 +80,12 @@ int main(int argc, char** argv)
 		return 1;
 	}
 
+	if (lossPercent < 0 || lossPercent > 100)
+	{
+		fprintf(stdout, "loss percentage must be between 0 and 100\n");
+		return 1;
+	}
+
 	receiveBuffer = malloc(SERVER_APPLICATION_RECEIVE_BUF_SIZE);
 	if (!receiveBuffer)
 	{
@@ -76,7 +93,7 @@ int main(int argc, char** argv)
 		return 1;
 	}
 
-	socketFd = socket(PF_INET, SOCK_STREAM, 0); 
+	socketFd = socket(PF_INET, udp ? SOCK_DGRAM : SOCK_STREAM, 0); 
 
 	if (socketFd < 0)
 	{ 
@@ -103,6 +120,19 @@ int main(int argc, char** argv)
 		return 1;
 	}
 
+	if (udp)
+	{
+		pid = fork();
+		if (pid < 0)
+		{
+			perror("error forking process for udp server");
+			return 1;
+		}
+		if (pid == 0)
+			handleUdpPackets(socketFd, lossPercent);
+		return 0;
+	}
+
 	retVal = listen(socketFd, SOMAXCONN);
   	if (retVal < 0)
 	{
@@ -148,7 +178,10 @@ int main(int argc, char** argv)
 
 void usage()
 {
-	fprintf(stdout, "usage: gpnetbenchServer -p PORT [-h]\n");
+	fprintf(stdout, "usage: gpnetbenchServer -p PORT [-u [-L PERCENT]] [-h]\n");
+	fprintf(stdout, "where\n");
+	fprintf(stdout, "       -u serves the UDP_IC experiment instead of TCP_STREAM\n");
+	fprintf(stdout, "       PERCENT is the share of UDP packets dropped on receipt, where the default is 0\n");
 }
 
 void handleIncomingConnection(int fd)
@@ -167,3 +200,33 @@ void handleIncomingConnection(int fd)
 		}
 	}
 }
+
+/*
+ * Ack every packet of the UDP_IC experiment by sending its header back,
+ * except for the share of them that is dropped to simulate a lossy network.
+ */
+void handleUdpPackets(int fd, int lossPercent)
+{
+	ssize_t bytes;
+	struct sockaddr_in client;
+	socklen_t clientLength;
+	UdpIcHeader *header = (UdpIcHeader *) receiveBuffer;
+
+	srandom(getpid());
+
+	while (1)
+	{
+		clientLength = sizeof(client);
+		bytes = recvfrom(fd, receiveBuffer, SERVER_APPLICATION_RECEIVE_BUF_SIZE, 0,
+						 (struct sockaddr *) &client, &clientLength);
+		if (bytes < (ssize_t) sizeof(UdpIcHeader) || header->magic != UDP_IC_MAGIC)
+			continue;
+
+		if (lossPercent > 0 && random() % 100 < lossPercent)
+			continue;
+
+		if (sendto(fd, header, sizeof(UdpIcHeader), 0,
+				   (struct sockaddr *) &client, clientLength) < 0)
+			perror("error sending ack");
+	}
+}
@@ -0,0 +1,306 @@
+#!/usr/bin/env python
+#
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+#
+"""
+TPC-DS performance regression harness.
+
+    tpcds_perf.py gen     --scale=N --parallel=P --datadir=DIR
+    tpcds_perf.py load    --datadir=DIR --dbname=DB --storage=ao|parquet|orc
+    tpcds_perf.py run     --dbname=DB --queries=DIR --concurrency=C --output=FILE
+    tpcds_perf.py compare baseline.json current.json [--threshold=PCT]
+
+"gen" runs parallel_dsdgen, "load" creates the tpcds.sql schema in the
+chosen storage format and copies the generated files in, "run" executes the
+query files of a directory in C concurrent streams and writes the per-query
+timings and plan shapes as JSON, and "compare" reports the queries that got
+slower or changed plan between two such files.
+
+The query text is not shipped, as the TPC-DS query templates are not part of
+tools/tpcds.  Generate the 99 queries with dsqgen from the TPC-DS kit into
+one file per query.  Every stream runs all of them, starting at a different
+query like the throughput test of the specification does.
+"""
+
+import glob
+import json
+import optparse
+import os
+import re
+import subprocess
+import sys
+import threading
+import time
+
+STORAGE_OPTIONS = {
+    'ao': "with (appendonly=true, orientation=row)",
+    'parquet': "with (appendonly=true, orientation=parquet)",
+    'orc': "format 'orc'",
+}
+
+
+def psql_args(options, extra):
+    args = ['psql', '-X', '-v', 'ON_ERROR_STOP=1', '-d', options.dbname]
+    if options.host:
+        args += ['-h', options.host]
+    if options.port:
+        args += ['-p', str(options.port)]
+    return args + extra
+
+
+def run_psql(options, sql, extra=None, stdin=None):
+    """Run sql in psql and return its standard output, raise on failure."""
+    args = psql_args(options, ['-q', '-A', '-t'] + (extra or []))
+    if stdin is None:
+        proc = subprocess.Popen(args, stdin=subprocess.PIPE,
+                                stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                                universal_newlines=True)
+        out, err = proc.communicate(sql)
+    else:
+        proc = subprocess.Popen(args + ['-c', sql], stdin=stdin,
+                                stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                                universal_newlines=True)
+        out, err = proc.communicate()
+    if proc.returncode != 0:
+        raise RuntimeError(err.strip() or 'psql failed')
+    return out
+
+
+def do_gen(options, args):
+    if not options.scale or not options.datadir:
+        raise RuntimeError('gen needs --scale and --datadir')
+    children = [str(i) for i in range(1, options.parallel + 1)]
+    subprocess.check_call(['parallel_dsdgen', str(options.scale),
+                           str(options.parallel), options.datadir] + children)
+
+
+def default_schema():
+    """tpcds.sql in the source tree, or next to the installed script."""
+    here = os.path.dirname(os.path.abspath(__file__))
+    for path in (os.path.join(here, 'tools', 'tpcds.sql'),
+                 os.path.join(here, 'tpcds.sql')):
+        if os.path.exists(path):
+            return path
+    return 'tpcds.sql'
+
+
+def schema_sql(options):
+    """The tpcds.sql tables, without the primary keys and in the storage."""
+    with open(options.schema) as f:
+        sql = f.read()
+    sql = re.sub(r',\s*primary key\s*\([^)]*\)', '', sql, flags=re.I)
+    with_clause = STORAGE_OPTIONS[options.storage]
+    sql = re.sub(r'\n\);', '\n) %s;' % with_clause, sql)
+    tables = re.findall(r'create table (\w+)', sql, flags=re.I)
+    drops = ''.join('drop table if exists %s;\n' % t for t in tables)
+    return drops + sql, tables
+
+
+def do_load(options, args):
+    if not options.datadir:
+        raise RuntimeError('load needs --datadir')
+    if options.storage not in STORAGE_OPTIONS:
+        raise RuntimeError('unknown storage "%s"' % options.storage)
+
+    sql, tables = schema_sql(options)
+    run_psql(options, sql)
+
+    for table in tables:
+        files = sorted(glob.glob(os.path.join(options.datadir, table, '*.dat')))
+        start = time.time()
+        for path in files:
+            with open(path) as f:
+                run_psql(options,
+                         "copy %s from stdin with delimiter '|' null ''" % table,
+                         stdin=f)
+        if files:
+            print('loaded %-25s %4d files %8.1f s' %
+                  (table, len(files), time.time() - start))
+    run_psql(options, 'analyze;')
+
+
+def plan_shape(options, query):
+    """The node types of the plan of query, indented by depth."""
+    shape = []
+    for line in run_psql(options, 'explain ' + query.strip().rstrip(';')).splitlines():
+        if '(cost=' not in line:
+            continue
+        depth = len(line) - len(line.lstrip())
+        node = line.split('(cost=')[0].strip()
+        if node.startswith('->'):
+            node = node[2:].strip()
+        # drop the relation and the motion's sender:receiver counts
+        node = re.sub(r'\s+(on|using)\s.*$|\s+\d+:\d+.*$', '', node)
+        shape.append('%d %s' % (depth, node))
+    return shape
+
+
+def time_query(options, query):
+    """Return the server side time of query in ms, from psql's \\timing."""
+    args = psql_args(options, ['-q', '-o', '/dev/null'])
+    proc = subprocess.Popen(args, stdin=subprocess.PIPE,
+                            stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                            universal_newlines=True)
+    out, err = proc.communicate('\\timing on\n' + query)
+    if proc.returncode != 0:
+        raise RuntimeError(err.strip())
+    return sum(float(m) for m in re.findall(r'^Time: ([0-9.]+) ms', out, re.M))
+
+
+def run_stream(options, stream, queries, results, lock):
+    names = sorted(queries)
+    offset = stream % len(names)
+    for name in names[offset:] + names[:offset]:
+        try:
+            elapsed = time_query(options, queries[name])
+            error = None
+        except RuntimeError as e:
+            elapsed = None
+            error = str(e)
+        with lock:
+            entry = results.setdefault(name, {'times_ms': [], 'errors': []})
+            if error is None:
+                entry['times_ms'].append(elapsed)
+            else:
+                entry['errors'].append(error)
+        print('stream %d %-20s %s' %
+              (stream, name, error and 'ERROR' or '%.1f ms' % elapsed))
+        sys.stdout.flush()
+
+
+def median(values):
+    values = sorted(values)
+    if not values:
+        return None
+    mid = len(values) // 2
+    if len(values) % 2:
+        return values[mid]
+    return (values[mid - 1] + values[mid]) / 2.0
+
+
+def do_run(options, args):
+    if not options.queries or not options.output:
+        raise RuntimeError('run needs --queries and --output')
+    queries = {}
+    for path in sorted(glob.glob(os.path.join(options.queries, '*.sql'))):
+        with open(path) as f:
+            queries[os.path.splitext(os.path.basename(path))[0]] = f.read()
+    if not queries:
+        raise RuntimeError('no *.sql files in %s' % options.queries)
+
+    results = {}
+    lock = threading.Lock()
+    start = time.time()
+    for iteration in range(options.iterations):
+        threads = [threading.Thread(target=run_stream,
+                                    args=(options, s, queries, results, lock))
+                   for s in range(options.concurrency)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+    elapsed = time.time() - start
+
+    for name, entry in results.items():
+        entry['median_ms'] = median(entry['times_ms'])
+        try:
+            entry['shape'] = plan_shape(options, queries[name])
+        except RuntimeError:
+            entry['shape'] = []
+
+    report = {
+        'version': run_psql(options, 'select version();').strip(),
+        'concurrency': options.concurrency,
+        'iterations': options.iterations,
+        'elapsed_s': elapsed,
+        'queries': results,
+    }
+    with open(options.output, 'w') as f:
+        json.dump(report, f, indent=1, sort_keys=True)
+    print('%d queries in %.1f s, results in %s' %
+          (len(results), elapsed, options.output))
+
+
+def do_compare(options, args):
+    if len(args) != 2:
+        raise RuntimeError('compare needs a baseline and a current file')
+    with open(args[0]) as f:
+        baseline = json.load(f)['queries']
+    with open(args[1]) as f:
+        current = json.load(f)['queries']
+
+    regressed = False
+    for name in sorted(current):
+        new = current[name]
+        old = baseline.get(name)
+        if new.get('errors'):
+            print('%-20s ERROR %s' % (name, new['errors'][0].splitlines()[0]))
+            regressed = True
+            continue
+        if old is None or not old.get('median_ms') or new['median_ms'] is None:
+            print('%-20s %10.1f ms (new)' % (name, new['median_ms'] or 0))
+            continue
+        change = (new['median_ms'] - old['median_ms']) / old['median_ms'] * 100
+        status = ''
+        if change > options.threshold:
+            status = 'SLOWER'
+            regressed = True
+        elif change < -options.threshold:
+            status = 'faster'
+        if old.get('shape') and new.get('shape') and old['shape'] != new['shape']:
+            status += ' plan changed'
+        print('%-20s %10.1f -> %10.1f ms %+7.1f%% %s' %
+              (name, old['median_ms'], new['median_ms'], change, status))
+    return 1 if regressed else 0
+
+
+def main():
+    parser = optparse.OptionParser(usage=__doc__.strip().split('\n\n')[1])
+    parser.add_option('--scale', type='int', help='scale factor in GB')
+    parser.add_option('--parallel', type='int', default=4,
+                      help='dsdgen processes (default 4)')
+    parser.add_option('--datadir', help='directory of the generated data')
+    parser.add_option('--schema', default=default_schema(),
+                      help='schema file (default tpcds.sql of the kit)')
+    parser.add_option('--storage', default='ao', help='ao, parquet or orc')
+    parser.add_option('--dbname', default=os.environ.get('PGDATABASE', 'postgres'))
+    parser.add_option('--host')
+    parser.add_option('--port', type='int')
+    parser.add_option('--queries', help='directory of one .sql file per query')
+    parser.add_option('--concurrency', type='int', default=1,
+                      help='concurrent query streams (default 1)')
+    parser.add_option('--iterations', type='int', default=1,
+                      help='times every stream runs the queries (default 1)')
+    parser.add_option('--output', help='JSON file for the results of run')
+    parser.add_option('--threshold', type='float', default=10.0,
+                      help='percentage of change compare reports (default 10)')
+    (options, args) = parser.parse_args()
+
+    commands = {'gen': do_gen, 'load': do_load, 'run': do_run,
+                'compare': do_compare}
+    if not args or args[0] not in commands:
+        parser.error('need one of %s' % ', '.join(sorted(commands)))
+    try:
+        return commands[args[0]](options, args[1:]) or 0
+    except (RuntimeError, subprocess.CalledProcessError, IOError) as e:
+        sys.stderr.write('tpcds_perf: %s\n' % e)
+        return 2
+
+
+if __name__ == '__main__':
+    sys.exit(main())